@@ -109,6 +109,36 @@
  */
 #define DEFENDER_RESPONSE_REPORT_ID_FIELD_LENGTH    ( sizeof( DEFENDER_RESPONSE_REPORT_ID_FIELD ) - 1 )
 
+/**
+ * @brief Report format configuration defaults to JSON if not defined.
+ */
+#ifndef democonfigDEVICE_METRICS_REPORT_USE_CBOR
+    #define democonfigDEVICE_METRICS_REPORT_USE_CBOR    0
+#endif
+
+/**
+ * @brief The Device Defender topics and APIs for the configured report format.
+ */
+#if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 )
+    #define DEFENDER_REPORT_PUBLISH_TOPIC                  DEFENDER_API_CBOR_PUBLISH( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_PUBLISH_TOPIC_LENGTH           DEFENDER_API_LENGTH_CBOR_PUBLISH( THING_NAME_LENGTH )
+    #define DEFENDER_REPORT_ACCEPTED_TOPIC                 DEFENDER_API_CBOR_ACCEPTED( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_ACCEPTED_TOPIC_LENGTH          DEFENDER_API_LENGTH_CBOR_ACCEPTED( THING_NAME_LENGTH )
+    #define DEFENDER_REPORT_REJECTED_TOPIC                 DEFENDER_API_CBOR_REJECTED( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_REJECTED_TOPIC_LENGTH          DEFENDER_API_LENGTH_CBOR_REJECTED( THING_NAME_LENGTH )
+    #define DEFENDER_REPORT_ACCEPTED_API                   DefenderCborReportAccepted
+    #define DEFENDER_REPORT_REJECTED_API                   DefenderCborReportRejected
+#else
+    #define DEFENDER_REPORT_PUBLISH_TOPIC                  DEFENDER_API_JSON_PUBLISH( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_PUBLISH_TOPIC_LENGTH           DEFENDER_API_LENGTH_JSON_PUBLISH( THING_NAME_LENGTH )
+    #define DEFENDER_REPORT_ACCEPTED_TOPIC                 DEFENDER_API_JSON_ACCEPTED( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_ACCEPTED_TOPIC_LENGTH          DEFENDER_API_LENGTH_JSON_ACCEPTED( THING_NAME_LENGTH )
+    #define DEFENDER_REPORT_REJECTED_TOPIC                 DEFENDER_API_JSON_REJECTED( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_REJECTED_TOPIC_LENGTH          DEFENDER_API_LENGTH_JSON_REJECTED( THING_NAME_LENGTH )
+    #define DEFENDER_REPORT_ACCEPTED_API                   DefenderJsonReportAccepted
+    #define DEFENDER_REPORT_REJECTED_API                   DefenderJsonReportRejected
+#endif
+
 /**
  * @brief The maximum number of times to run the loop in this demo.
  *
@@ -209,8 +239,10 @@ static ReportStatus_t xReportStatus;
 
 /**
  * @brief Buffer for generating the Device Defender report.
+ *
+ * The same buffer is reused for every report.
  */
-static char pcDeviceMetricsJsonReport[ democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE ];
+static uint8_t pucDeviceMetricsReport[ democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE ];
 
 /**
  * @brief Report ID sent in the defender report.
@@ -276,10 +308,32 @@ static bool prvUnsubscribeFromDefenderTopics( void );
  */
 static bool prvPublishDeviceMetricsReport( size_t xReportLength );
 
+#if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 )
+
+/**
+ * @brief Find the report ID in a CBOR response from the AWS IoT Device Defender
+ * Service.
+ *
+ * The response is a map whose values are integers, strings, arrays or maps,
+ * all of definite length. Values of keys other than the report ID are skipped
+ * without being decoded.
+ *
+ * @param[in] pucResponse The defender response.
+ * @param[in] xResponseLength Length of the defender response.
+ * @param[out] pulOutReportId The report ID found in the response.
+ *
+ * @return true if the report ID is found;
+ * false if the response is malformed or has no report ID.
+ */
+    static bool prvCborFindReportId( const uint8_t * pucResponse,
+                                     size_t xResponseLength,
+                                     uint32_t * pulOutReportId );
+#endif
+
 /**
  * @brief Validate the response received from the AWS IoT Device Defender Service.
  *
- * This functions checks that a valid JSON is received and the report ID
+ * This functions checks that a valid response is received and the report ID
  * is same as was sent in the published report.
  *
  * @param[in] pcDefenderResponse The defender response to validate.
@@ -293,6 +347,249 @@ static bool prvValidateDefenderResponse( const char * pcDefenderResponse,
 
 /*-----------------------------------------------------------*/
 
+#if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 )
+
+/**
+ * @brief Read the head of a CBOR data item.
+ *
+ * @param[in] pucBuffer The buffer holding the data item.
+ * @param[in] xBufferLength Length of the buffer.
+ * @param[in,out] pxOffset Offset of the data item, advanced past the head.
+ * @param[out] pucOutMajorType The major type of the data item.
+ * @param[out] pulOutArgument The argument of the data item.
+ *
+ * @return true if the head is read;
+ * false if it is truncated or uses an encoding that is not supported.
+ */
+    static bool prvCborReadHead( const uint8_t * pucBuffer,
+                                 size_t xBufferLength,
+                                 size_t * pxOffset,
+                                 uint8_t * pucOutMajorType,
+                                 uint32_t * pulOutArgument )
+    {
+        bool xStatus = true;
+        uint8_t ucAdditional;
+        size_t xArgumentLength = 0U;
+        size_t uxIdx;
+        uint32_t ulArgument = 0UL;
+
+        if( *pxOffset >= xBufferLength )
+        {
+            xStatus = false;
+        }
+        else
+        {
+            *pucOutMajorType = ( uint8_t ) ( pucBuffer[ *pxOffset ] >> 5 );
+            ucAdditional = ( uint8_t ) ( pucBuffer[ *pxOffset ] & 0x1FU );
+            *pxOffset += 1U;
+
+            if( ucAdditional < 24U )
+            {
+                ulArgument = ucAdditional;
+            }
+            else if( ucAdditional <= 26U )
+            {
+                /* 24, 25 and 26 are followed by 1, 2 and 4 bytes. */
+                xArgumentLength = ( size_t ) 1U << ( ucAdditional - 24U );
+            }
+            else
+            {
+                /* 64 bit arguments and indefinite lengths are not expected in
+                 * a response. */
+                xStatus = false;
+            }
+        }
+
+        if( ( xStatus == true ) && ( xArgumentLength > 0U ) )
+        {
+            if( ( xBufferLength - *pxOffset ) < xArgumentLength )
+            {
+                xStatus = false;
+            }
+            else
+            {
+                for( uxIdx = 0; uxIdx < xArgumentLength; uxIdx++ )
+                {
+                    ulArgument = ( ulArgument << 8 ) | pucBuffer[ *pxOffset + uxIdx ];
+                }
+
+                *pxOffset += xArgumentLength;
+            }
+        }
+
+        if( xStatus == true )
+        {
+            *pulOutArgument = ulArgument;
+        }
+
+        return xStatus;
+    }
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Skip a CBOR data item, including any items nested in it.
+ *
+ * @param[in] pucBuffer The buffer holding the data item.
+ * @param[in] xBufferLength Length of the buffer.
+ * @param[in,out] pxOffset Offset of the data item, advanced past it.
+ *
+ * @return true if the data item is skipped;
+ * false if it is malformed.
+ */
+    static bool prvCborSkipItem( const uint8_t * pucBuffer,
+                                 size_t xBufferLength,
+                                 size_t * pxOffset )
+    {
+        bool xStatus = true;
+        uint32_t ulPendingItems = 1UL;
+        uint8_t ucMajorType;
+        uint32_t ulArgument;
+
+        /* Nested items are counted instead of recursing, so the stack usage
+         * does not depend on the response. */
+        while( ( xStatus == true ) && ( ulPendingItems > 0UL ) )
+        {
+            xStatus = prvCborReadHead( pucBuffer, xBufferLength, pxOffset, &ucMajorType, &ulArgument );
+            ulPendingItems--;
+
+            if( xStatus == true )
+            {
+                switch( ucMajorType )
+                {
+                    case 2U: /* Byte string. */
+                    case 3U: /* Text string. */
+
+                        if( ( xBufferLength - *pxOffset ) < ulArgument )
+                        {
+                            xStatus = false;
+                        }
+                        else
+                        {
+                            *pxOffset += ulArgument;
+                        }
+
+                        break;
+
+                    case 4U: /* Array. */
+                    case 5U: /* Map. */
+
+                        /* The items must at least have a head each. */
+                        if( ( ( xBufferLength - *pxOffset ) / ( ( ucMajorType == 5U ) ? 2U : 1U ) ) < ulArgument )
+                        {
+                            xStatus = false;
+                        }
+                        else
+                        {
+                            ulPendingItems += ( ucMajorType == 5U ) ? ( ulArgument * 2UL ) : ulArgument;
+                        }
+
+                        break;
+
+                    case 6U: /* Tag, followed by the tagged item. */
+                        ulPendingItems++;
+                        break;
+
+                    default: /* Integers and simple values. */
+                        break;
+                }
+            }
+        }
+
+        return xStatus;
+    }
+/*-----------------------------------------------------------*/
+
+    static bool prvCborFindReportId( const uint8_t * pucResponse,
+                                     size_t xResponseLength,
+                                     uint32_t * pulOutReportId )
+    {
+        bool xStatus = false;
+        bool xFound = false;
+        size_t xOffset = 0U;
+        uint8_t ucMajorType;
+        uint32_t ulPairs;
+        uint32_t ulLength;
+        uint32_t ulIdx;
+
+        /* The response must be a map. */
+        xStatus = prvCborReadHead( pucResponse, xResponseLength, &xOffset, &ucMajorType, &ulPairs );
+
+        if( ( xStatus == true ) && ( ucMajorType != 5U ) )
+        {
+            xStatus = false;
+        }
+
+        for( ulIdx = 0; ( xStatus == true ) && ( xFound == false ) && ( ulIdx < ulPairs ); ulIdx++ )
+        {
+            xStatus = prvCborReadHead( pucResponse, xResponseLength, &xOffset, &ucMajorType, &ulLength );
+
+            if( ( xStatus == true ) &&
+                ( ( ucMajorType != 3U ) || ( ( xResponseLength - xOffset ) < ulLength ) ) )
+            {
+                /* Keys of the response are text strings. */
+                xStatus = false;
+            }
+
+            if( xStatus == true )
+            {
+                if( ( ulLength == DEFENDER_RESPONSE_REPORT_ID_FIELD_LENGTH ) &&
+                    ( memcmp( &( pucResponse[ xOffset ] ),
+                              DEFENDER_RESPONSE_REPORT_ID_FIELD,
+                              DEFENDER_RESPONSE_REPORT_ID_FIELD_LENGTH ) == 0 ) )
+                {
+                    xOffset += ulLength;
+                    xStatus = prvCborReadHead( pucResponse, xResponseLength, &xOffset, &ucMajorType, pulOutReportId );
+                    xFound = ( xStatus == true ) && ( ucMajorType == 0U );
+                }
+                else
+                {
+                    xOffset += ulLength;
+                    xStatus = prvCborSkipItem( pucResponse, xResponseLength, &xOffset );
+                }
+            }
+        }
+
+        return xFound;
+    }
+/*-----------------------------------------------------------*/
+
+    static bool prvValidateDefenderResponse( const char * pcDefenderResponse,
+                                             size_t xDefenderResponseLength )
+    {
+        bool xStatus = false;
+        uint32_t ulReportIdInResponse;
+
+        configASSERT( pcDefenderResponse != NULL );
+
+        if( prvCborFindReportId( ( const uint8_t * ) pcDefenderResponse,
+                                 xDefenderResponseLength,
+                                 &( ulReportIdInResponse ) ) == false )
+        {
+            LogError( ( "%s key not found in the %u byte CBOR response from the "
+                        "AWS IoT Device Defender Service.",
+                        DEFENDER_RESPONSE_REPORT_ID_FIELD,
+                        ( unsigned int ) xDefenderResponseLength ) );
+        }
+        else if( ulReportIdInResponse == ulReportId )
+        {
+            LogInfo( ( "A valid response with report ID %u received from the "
+                       "AWS IoT Device Defender Service.", ulReportId ) );
+            xStatus = true;
+        }
+        else
+        {
+            LogError( ( "Unexpected %s found in the response from the AWS"
+                        "IoT Device Defender Service. Expected: %u, Found: %u.",
+                        DEFENDER_RESPONSE_REPORT_ID_FIELD,
+                        ulReportId,
+                        ulReportIdInResponse ) );
+        }
+
+        return xStatus;
+    }
+
+#else /* if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 ) */
+
 static bool prvValidateDefenderResponse( const char * pcDefenderResponse,
                                          size_t xDefenderResponseLength )
 {
@@ -361,6 +658,8 @@ static bool prvValidateDefenderResponse( const char * pcDefenderResponse,
 
     return xStatus;
 }
+
+#endif /* if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 ) */
 /*-----------------------------------------------------------*/
 
 static void prvPublishCallback( MQTTContext_t * pxMqttContext,
@@ -399,7 +698,7 @@ static void prvPublishCallback( MQTTContext_t * pxMqttContext,
 
         if( xStatus == DefenderSuccess )
         {
-            if( xApi == DefenderJsonReportAccepted )
+            if( xApi == DEFENDER_REPORT_ACCEPTED_API )
             {
                 /* Check if the response is valid and is for the report we
                  * published. If so, report was accepted. */
@@ -408,13 +707,11 @@ static void prvPublishCallback( MQTTContext_t * pxMqttContext,
 
                 if( xValidationResult == true )
                 {
-                    LogInfo( ( "The defender report was accepted by the service. Response: %.*s.",
-                               ( int ) pxPublishInfo->payloadLength,
-                               ( const char * ) pxPublishInfo->pPayload ) );
+                    LogInfo( ( "The defender report was accepted by the service." ) );
                     xReportStatus = ReportStatusAccepted;
                 }
             }
-            else if( xApi == DefenderJsonReportRejected )
+            else if( xApi == DEFENDER_REPORT_REJECTED_API )
             {
                 /* Check if the response is valid and is for the report we
                  * published. If so, report was rejected. */
@@ -423,9 +720,7 @@ static void prvPublishCallback( MQTTContext_t * pxMqttContext,
 
                 if( xValidationResult == true )
                 {
-                    LogError( ( "The defender report was rejected by the service. Response: %.*s.",
-                                ( int ) pxPublishInfo->payloadLength,
-                                ( const char * ) pxPublishInfo->pPayload ) );
+                    LogError( ( "The defender report was rejected by the service." ) );
                     xReportStatus = ReportStatusRejected;
                 }
             }
@@ -461,18 +756,50 @@ static bool prvCollectDeviceMetrics( void )
     UBaseType_t uxNumTasksRunning;
     TaskStatus_t pxTaskStatus = { 0 };
     TaskStatus_t * pxTaskStatusArray = NULL;
+    bool xListsChanged = true;
 
-    /* Collect bytes and packets sent and received. */
-    eStatus = eGetNetworkStats( &( xNetworkStats ) );
+    /* Take one snapshot of the network metrics, from which all the network
+     * metrics of this report are read. */
+    eStatus = eUpdateMetrics( &( xListsChanged ) );
 
     if( eStatus != eMetricsCollectorSuccess )
     {
-        LogError( ( "xGetNetworkStats failed. Status: %d.",
+        LogError( ( "eUpdateMetrics failed. Status: %d.",
                     eStatus ) );
     }
 
-    /* Collect a list of open TCP ports. */
+    /* Collect bytes and packets sent and received. */
     if( eStatus == eMetricsCollectorSuccess )
+    {
+        eStatus = eGetNetworkStats( &( xNetworkStats ) );
+
+        if( eStatus != eMetricsCollectorSuccess )
+        {
+            LogError( ( "xGetNetworkStats failed. Status: %d.",
+                        eStatus ) );
+        }
+    }
+
+    /* The port and connection arrays still hold the lists of the previous
+     * report if they did not change since then, so they are only collected
+     * again when they changed. xDeviceMetrics.pusOpenTcpPortsArray is NULL
+     * until the arrays are filled by a successful collection. */
+    if( ( eStatus == eMetricsCollectorSuccess ) &&
+        ( xListsChanged == false ) &&
+        ( xDeviceMetrics.pusOpenTcpPortsArray != NULL ) )
+    {
+        LogDebug( ( "Open ports and connections unchanged since the last report." ) );
+        uxNumOpenTcpPorts = xDeviceMetrics.xOpenTcpPortsArrayLength;
+        uxNumOpenUdpPorts = xDeviceMetrics.xOpenUdpPortsArrayLength;
+        uxNumEstablishedConnections = xDeviceMetrics.xEstablishedConnectionsArrayLength;
+    }
+    else
+    {
+        xListsChanged = true;
+    }
+
+    /* Collect a list of open TCP ports. */
+    if( ( eStatus == eMetricsCollectorSuccess ) && ( xListsChanged == true ) )
     {
         eStatus = eGetOpenTcpPorts( &( pusOpenTcpPorts[ 0 ] ),
                                     democonfigOPEN_TCP_PORTS_ARRAY_SIZE,
@@ -486,7 +813,7 @@ static bool prvCollectDeviceMetrics( void )
     }
 
     /* Collect a list of open UDP ports. */
-    if( eStatus == eMetricsCollectorSuccess )
+    if( ( eStatus == eMetricsCollectorSuccess ) && ( xListsChanged == true ) )
     {
         eStatus = eGetOpenUdpPorts( &( pusOpenUdpPorts[ 0 ] ),
                                     democonfigOPEN_UDP_PORTS_ARRAY_SIZE,
@@ -500,7 +827,7 @@ static bool prvCollectDeviceMetrics( void )
     }
 
     /* Collect a list of established connections. */
-    if( eStatus == eMetricsCollectorSuccess )
+    if( ( eStatus == eMetricsCollectorSuccess ) && ( xListsChanged == true ) )
     {
         eStatus = eGetEstablishedConnections( &( pxEstablishedConnections[ 0 ] ),
                                               democonfigESTABLISHED_CONNECTIONS_ARRAY_SIZE,
@@ -578,6 +905,10 @@ static bool prvCollectDeviceMetrics( void )
     }
     else
     {
+        /* The arrays may hold partially collected lists, so collect them
+         * again for the next report. */
+        xDeviceMetrics.pusOpenTcpPortsArray = NULL;
+
         /* Free pxTaskStatusArray if we allocated it but did not add it to the
          * xDeviceMetrics struct. */
         if( pxTaskStatusArray != NULL )
@@ -597,24 +928,33 @@ static bool prvGenerateDeviceMetricsReport( size_t * pxOutReportLength )
 
     /* Generate the metrics report in the format expected by the AWS IoT Device
      * Defender Service. */
-    eReportBuilderStatus = eGenerateJsonReport( &( pcDeviceMetricsJsonReport[ 0 ] ),
-                                                democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE,
-                                                &( xDeviceMetrics ),
-                                                democonfigDEVICE_METRICS_REPORT_MAJOR_VERSION,
-                                                democonfigDEVICE_METRICS_REPORT_MINOR_VERSION,
-                                                ulReportId,
-                                                pxOutReportLength );
+    #if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 )
+        eReportBuilderStatus = eGenerateCborReport( &( pucDeviceMetricsReport[ 0 ] ),
+                                                    democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE,
+                                                    &( xDeviceMetrics ),
+                                                    democonfigDEVICE_METRICS_REPORT_MAJOR_VERSION,
+                                                    democonfigDEVICE_METRICS_REPORT_MINOR_VERSION,
+                                                    ulReportId,
+                                                    pxOutReportLength );
+    #else
+        eReportBuilderStatus = eGenerateJsonReport( ( char * ) &( pucDeviceMetricsReport[ 0 ] ),
+                                                    democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE,
+                                                    &( xDeviceMetrics ),
+                                                    democonfigDEVICE_METRICS_REPORT_MAJOR_VERSION,
+                                                    democonfigDEVICE_METRICS_REPORT_MINOR_VERSION,
+                                                    ulReportId,
+                                                    pxOutReportLength );
+    #endif
 
     if( eReportBuilderStatus != eReportBuilderSuccess )
     {
-        LogError( ( "GenerateJsonReport failed. Status: %d.",
+        LogError( ( "Generating the report failed. Status: %d.",
                     eReportBuilderStatus ) );
     }
     else
     {
-        LogDebug( ( "Generated Report: %.*s.",
-                    *pxOutReportLength,
-                    &( pcDeviceMetricsJsonReport[ 0 ] ) ) );
+        LogDebug( ( "Generated a report of %u bytes.",
+                    ( unsigned int ) *pxOutReportLength ) );
         xStatus = true;
     }
 
@@ -628,28 +968,28 @@ static bool prvSubscribeToDefenderTopics( void )
 
     /* Subscribe to defender topic for responses for accepted reports. */
     xStatus = xSubscribeToTopic( &xMqttContext,
-                                 DEFENDER_API_JSON_ACCEPTED( democonfigTHING_NAME ),
-                                 DEFENDER_API_LENGTH_JSON_ACCEPTED( THING_NAME_LENGTH ) );
+                                 DEFENDER_REPORT_ACCEPTED_TOPIC,
+                                 DEFENDER_REPORT_ACCEPTED_TOPIC_LENGTH );
 
     if( xStatus == false )
     {
         LogError( ( "Failed to subscribe to defender topic: %.*s.",
-                    DEFENDER_API_LENGTH_JSON_ACCEPTED( THING_NAME_LENGTH ),
-                    DEFENDER_API_JSON_ACCEPTED( democonfigTHING_NAME ) ) );
+                    DEFENDER_REPORT_ACCEPTED_TOPIC_LENGTH,
+                    DEFENDER_REPORT_ACCEPTED_TOPIC ) );
     }
 
     if( xStatus == true )
     {
         /* Subscribe to defender topic for responses for rejected reports. */
         xStatus = xSubscribeToTopic( &xMqttContext,
-                                     DEFENDER_API_JSON_REJECTED( democonfigTHING_NAME ),
-                                     DEFENDER_API_LENGTH_JSON_REJECTED( THING_NAME_LENGTH ) );
+                                     DEFENDER_REPORT_REJECTED_TOPIC,
+                                     DEFENDER_REPORT_REJECTED_TOPIC_LENGTH );
 
         if( xStatus == false )
         {
             LogError( ( "Failed to subscribe to defender topic: %.*s.",
-                        DEFENDER_API_LENGTH_JSON_REJECTED( THING_NAME_LENGTH ),
-                        DEFENDER_API_JSON_REJECTED( democonfigTHING_NAME ) ) );
+                        DEFENDER_REPORT_REJECTED_TOPIC_LENGTH,
+                        DEFENDER_REPORT_REJECTED_TOPIC ) );
         }
     }
 
@@ -663,15 +1003,15 @@ static bool prvUnsubscribeFromDefenderTopics( void )
 
     /* Unsubscribe from defender accepted topic. */
     xStatus = xUnsubscribeFromTopic( &xMqttContext,
-                                     DEFENDER_API_JSON_ACCEPTED( democonfigTHING_NAME ),
-                                     DEFENDER_API_LENGTH_JSON_ACCEPTED( THING_NAME_LENGTH ) );
+                                     DEFENDER_REPORT_ACCEPTED_TOPIC,
+                                     DEFENDER_REPORT_ACCEPTED_TOPIC_LENGTH );
 
     if( xStatus == true )
     {
         /* Unsubscribe from defender rejected topic. */
         xStatus = xUnsubscribeFromTopic( &xMqttContext,
-                                         DEFENDER_API_JSON_REJECTED( democonfigTHING_NAME ),
-                                         DEFENDER_API_LENGTH_JSON_REJECTED( THING_NAME_LENGTH ) );
+                                         DEFENDER_REPORT_REJECTED_TOPIC,
+                                         DEFENDER_REPORT_REJECTED_TOPIC_LENGTH );
     }
 
     return xStatus;
@@ -681,9 +1021,9 @@ static bool prvUnsubscribeFromDefenderTopics( void )
 static bool prvPublishDeviceMetricsReport( size_t xReportLength )
 {
     return xPublishToTopic( &xMqttContext,
-                            DEFENDER_API_JSON_PUBLISH( democonfigTHING_NAME ),
-                            DEFENDER_API_LENGTH_JSON_PUBLISH( THING_NAME_LENGTH ),
-                            &( pcDeviceMetricsJsonReport[ 0 ] ),
+                            DEFENDER_REPORT_PUBLISH_TOPIC,
+                            DEFENDER_REPORT_PUBLISH_TOPIC_LENGTH,
+                            ( const char * ) &( pucDeviceMetricsReport[ 0 ] ),
                             xReportLength );
 }
 /*-----------------------------------------------------------*/
@@ -757,9 +1097,10 @@ void prvDefenderDemoTask( void * pvParameters )
         /******************** Subscribe to Defender topics. *******************/
 
         /* Attempt to subscribe to the AWS IoT Device Defender topics.
-         * Since this demo is using JSON, in prvSubscribeToDefenderTopics() we
-         * subscribe to the topics to which accepted and rejected responses are
-         * received from after publishing a JSON report.
+         * In prvSubscribeToDefenderTopics() we subscribe to the topics to which
+         * accepted and rejected responses are received from after publishing a
+         * report in the format selected by
+         * #democonfigDEVICE_METRICS_REPORT_USE_CBOR.
          *
          * This demo uses a constant #democonfigTHING_NAME known at compile time
          * therefore we use macros to assemble defender topic strings.
@@ -803,7 +1144,9 @@ void prvDefenderDemoTask( void * pvParameters )
          * Device Defender service. This demo uses the functions declared in
          * in metrics_collector.h to collect network metrics. For this demo, the
          * implementation of these functions are in metrics_collector.c and
-         * collects metrics using tcp_netstat utility for FreeRTOS+TCP. */
+         * collects metrics using tcp_netstat utility for FreeRTOS+TCP. The
+         * open ports and connections are only copied again when they changed
+         * since the last report. */
         if( xStatus == true )
         {
             LogInfo( ( "Collecting device metrics..." ) );
@@ -817,8 +1160,9 @@ void prvDefenderDemoTask( void * pvParameters )
 
         /********************** Generate defender report. *********************/
 
-        /* The data needs to be incorporated into a JSON formatted report,
-         * which follows the format expected by the Device Defender service.
+        /* The data needs to be incorporated into a CBOR or JSON formatted
+         * report, which follows the format expected by the Device Defender
+         * service.
          * This format is documented here:
          * https://docs.aws.amazon.com/iot/latest/developerguide/detect-device-side-metrics.html
          */
@@ -843,10 +1187,10 @@ void prvDefenderDemoTask( void * pvParameters )
         /********************** Publish defender report. **********************/
 
         /* The report is then published to the Device Defender service. This report
-         * is published to the MQTT topic for publishing JSON reports. As before,
-         * we use the defender library macros to create the topic string, though
-         * #Defender_GetTopic could be used if the Thing name is acquired at
-         * run time */
+         * is published to the MQTT topic for publishing reports in the selected
+         * format. As before, we use the defender library macros to create the
+         * topic string, though #Defender_GetTopic could be used if the Thing
+         * name is acquired at run time */
         if( xStatus == true )
         {
             LogInfo( ( "Publishing Device Defender report..." ) );
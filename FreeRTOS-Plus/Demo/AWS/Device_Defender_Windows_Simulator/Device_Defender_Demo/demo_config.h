@@ -275,6 +275,14 @@ extern void vLoggingPrintf( const char * pcFormatString,
  */
 #define democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE      1000
 
+/**
+ * @brief Set to 1 to send the device defender report in CBOR instead of JSON.
+ *
+ * A CBOR report is smaller than the equivalent JSON report and is cheaper to
+ * generate, which makes it a better fit for constrained devices.
+ */
+#define democonfigDEVICE_METRICS_REPORT_USE_CBOR         1
+
 /**
  * @brief Major version number of the device defender report.
  */
@@ -48,22 +48,91 @@
 
 /* Interface include. */
 #include "metrics_collector.h"
+
+/**
+ * @brief The two latest snapshots of the FreeRTOS+TCP metrics.
+ *
+ * eUpdateMetrics() writes each new snapshot over the older one, so that it
+ * can be compared against the previous one to find out whether the port and
+ * connection lists changed.
+ */
+static MetricsType_t xSnapshots[ 2 ];
+
+/**
+ * @brief Index in #xSnapshots of the latest snapshot.
+ */
+static size_t uxCurrentSnapshot = 0U;
+
+/**
+ * @brief pdTRUE once #xSnapshots holds a snapshot.
+ */
+static BaseType_t xSnapshotValid = pdFALSE;
 /*-----------------------------------------------------------*/
 
-eMetricsCollectorStatus eGetNetworkStats( NetworkStats_t * pxOutNetworkStats )
+/**
+ * @brief Check whether two snapshots have the same open ports and
+ * established connections.
+ *
+ * @param[in] pxA The first snapshot.
+ * @param[in] pxB The second snapshot.
+ *
+ * @return pdTRUE if the lists are equal; pdFALSE otherwise.
+ */
+static BaseType_t prvListsEqual( const MetricsType_t * pxA,
+                                 const MetricsType_t * pxB );
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvListsEqual( const MetricsType_t * pxA,
+                                 const MetricsType_t * pxB )
 {
-    eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
+    BaseType_t xEqual = pdTRUE;
+    size_t uxIdx;
 
-    MetricsType_t xMetrics = { 0 };
-    BaseType_t xMetricsStatus = 0;
+    if( ( pxA->xTCPPortList.uxCount != pxB->xTCPPortList.uxCount ) ||
+        ( pxA->xUDPPortList.uxCount != pxB->xUDPPortList.uxCount ) ||
+        ( pxA->xTCPSocketList.uxCount != pxB->xTCPSocketList.uxCount ) )
+    {
+        xEqual = pdFALSE;
+    }
+    else if( ( memcmp( pxA->xTCPPortList.usTCPPortList,
+                       pxB->xTCPPortList.usTCPPortList,
+                       pxA->xTCPPortList.uxCount * sizeof( uint16_t ) ) != 0 ) ||
+             ( memcmp( pxA->xUDPPortList.usUDPPortList,
+                       pxB->xUDPPortList.usUDPPortList,
+                       pxA->xUDPPortList.uxCount * sizeof( uint16_t ) ) != 0 ) )
+    {
+        xEqual = pdFALSE;
+    }
+    else
+    {
+        /* Compare the connections field by field as the entries may contain
+         * padding. */
+        for( uxIdx = 0; ( uxIdx < pxA->xTCPSocketList.uxCount ) && ( xEqual == pdTRUE ); uxIdx++ )
+        {
+            if( ( pxA->xTCPSocketList.xTCPList[ uxIdx ].usLocalPort != pxB->xTCPSocketList.xTCPList[ uxIdx ].usLocalPort ) ||
+                ( pxA->xTCPSocketList.xTCPList[ uxIdx ].ulRemoteIP != pxB->xTCPSocketList.xTCPList[ uxIdx ].ulRemoteIP ) ||
+                ( pxA->xTCPSocketList.xTCPList[ uxIdx ].usRemotePort != pxB->xTCPSocketList.xTCPList[ uxIdx ].usRemotePort ) )
+            {
+                xEqual = pdFALSE;
+            }
+        }
+    }
 
-    configASSERT( pxOutNetworkStats != NULL );
+    return xEqual;
+}
+/*-----------------------------------------------------------*/
 
-    /* Start with everything as zero. */
-    memset( pxOutNetworkStats, 0, sizeof( NetworkStats_t ) );
+eMetricsCollectorStatus eUpdateMetrics( bool * pxOutListsChanged )
+{
+    eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
+    BaseType_t xMetricsStatus = 0;
+    size_t uxNextSnapshot = uxCurrentSnapshot ^ 1U;
+    bool xListsChanged = true;
 
-    /* Get metrics from FreeRTOS+TCP tcp_netstat utility. */
-    xMetricsStatus = vGetMetrics( &xMetrics );
+    /* Get metrics from FreeRTOS+TCP tcp_netstat utility. The older snapshot
+     * is overwritten so the latest one remains valid if this fails. */
+    memset( &( xSnapshots[ uxNextSnapshot ] ), 0, sizeof( MetricsType_t ) );
+    xMetricsStatus = vGetMetrics( &( xSnapshots[ uxNextSnapshot ] ) );
 
     if( xMetricsStatus != 0 )
     {
@@ -72,20 +141,64 @@ eMetricsCollectorStatus eGetNetworkStats( NetworkStats_t * pxOutNetworkStats )
         eStatus = eMetricsCollectorCollectionFailed;
     }
 
+    if( eStatus == eMetricsCollectorSuccess )
+    {
+        if( ( xSnapshotValid == pdTRUE ) &&
+            ( prvListsEqual( &( xSnapshots[ uxCurrentSnapshot ] ),
+                             &( xSnapshots[ uxNextSnapshot ] ) ) == pdTRUE ) )
+        {
+            xListsChanged = false;
+        }
+
+        uxCurrentSnapshot = uxNextSnapshot;
+        xSnapshotValid = pdTRUE;
+
+        LogDebug( ( "Metrics snapshot taken. Port and connection lists %s.",
+                    xListsChanged ? "changed" : "unchanged" ) );
+    }
+
+    if( pxOutListsChanged != NULL )
+    {
+        *pxOutListsChanged = xListsChanged;
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
+
+eMetricsCollectorStatus eGetNetworkStats( NetworkStats_t * pxOutNetworkStats )
+{
+    eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
+    const MetricsType_t * pxMetrics = NULL;
+
+
+    configASSERT( pxOutNetworkStats != NULL );
+
+    /* Start with everything as zero. */
+    memset( pxOutNetworkStats, 0, sizeof( NetworkStats_t ) );
+
+    /* Read from the latest snapshot, taking one if there is none yet. */
+    if( xSnapshotValid == pdFALSE )
+    {
+        eStatus = eUpdateMetrics( NULL );
+    }
+
+    pxMetrics = &( xSnapshots[ uxCurrentSnapshot ] );
+
     /* Fill our response with values gotten from FreeRTOS+TCP. */
     if( eStatus == eMetricsCollectorSuccess )
     {
         LogDebug( ( "Network stats read. Bytes received: %lu, packets received: %lu, "
                     "bytes sent: %lu, packets sent: %lu.",
-                    ( unsigned long ) xMetrics.xInput.uxByteCount,
-                    ( unsigned long ) xMetrics.xInput.uxPacketCount,
-                    ( unsigned long ) xMetrics.xOutput.uxByteCount,
-                    ( unsigned long ) xMetrics.xOutput.uxPacketCount ) );
-
-        pxOutNetworkStats->uxBytesReceived = xMetrics.xInput.uxByteCount;
-        pxOutNetworkStats->uxPacketsReceived = xMetrics.xInput.uxPacketCount;
-        pxOutNetworkStats->uxBytesSent = xMetrics.xOutput.uxByteCount;
-        pxOutNetworkStats->uxPacketsSent = xMetrics.xOutput.uxPacketCount;
+                    ( unsigned long ) pxMetrics->xInput.uxByteCount,
+                    ( unsigned long ) pxMetrics->xInput.uxPacketCount,
+                    ( unsigned long ) pxMetrics->xOutput.uxByteCount,
+                    ( unsigned long ) pxMetrics->xOutput.uxPacketCount ) );
+
+        pxOutNetworkStats->uxBytesReceived = pxMetrics->xInput.uxByteCount;
+        pxOutNetworkStats->uxPacketsReceived = pxMetrics->xInput.uxPacketCount;
+        pxOutNetworkStats->uxBytesSent = pxMetrics->xOutput.uxByteCount;
+        pxOutNetworkStats->uxPacketsSent = pxMetrics->xOutput.uxPacketCount;
     }
 
     return eStatus;
@@ -97,40 +210,37 @@ eMetricsCollectorStatus eGetOpenTcpPorts( uint16_t * pusOutTcpPortsArray,
                                           size_t * pxOutNumTcpOpenPorts )
 {
     eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
+    const MetricsType_t * pxMetrics = NULL;
 
-    MetricsType_t xMetrics = { 0 };
-    BaseType_t xMetricsStatus = 0;
     size_t xCopyAmount = 0UL;
 
     /* pusOutTcpPortsArray can be NULL. */
     configASSERT( pxOutNumTcpOpenPorts != NULL );
 
-    /* Get metrics from FreeRTOS+TCP tcp_netstat utility. */
-    xMetricsStatus = vGetMetrics( &xMetrics );
-
-    if( xMetricsStatus != 0 )
+    /* Read from the latest snapshot, taking one if there is none yet. */
+    if( xSnapshotValid == pdFALSE )
     {
-        LogError( ( "Failed to acquire metrics from FreeRTOS+TCP tcp_netstat utility. Status: %d.",
-                    ( int ) xMetricsStatus ) );
-        eStatus = eMetricsCollectorCollectionFailed;
+        eStatus = eUpdateMetrics( NULL );
     }
 
+    pxMetrics = &( xSnapshots[ uxCurrentSnapshot ] );
+
     if( eStatus == eMetricsCollectorSuccess )
     {
         /* Fill the output array with as many TCP ports as will fit in the
          * given array. */
         if( pusOutTcpPortsArray != NULL )
         {
-            xCopyAmount = xMetrics.xTCPPortList.uxCount;
+            xCopyAmount = pxMetrics->xTCPPortList.uxCount;
 
             /* Limit the copied ports to what can fit in the output array. */
-            if( xTcpPortsArrayLength < xMetrics.xTCPPortList.uxCount )
+            if( xTcpPortsArrayLength < pxMetrics->xTCPPortList.uxCount )
             {
                 LogWarn( ( "Ports returned truncated due to insufficient buffer size." ) );
                 xCopyAmount = xTcpPortsArrayLength;
             }
 
-            memcpy( pusOutTcpPortsArray, &xMetrics.xTCPPortList.usTCPPortList, xCopyAmount * sizeof( uint16_t ) );
+            memcpy( pusOutTcpPortsArray, pxMetrics->xTCPPortList.usTCPPortList, xCopyAmount * sizeof( uint16_t ) );
 
             /* Return the number of elements copied to the array. */
             *pxOutNumTcpOpenPorts = xCopyAmount;
@@ -138,7 +248,7 @@ eMetricsCollectorStatus eGetOpenTcpPorts( uint16_t * pusOutTcpPortsArray,
         else
         {
             /* Return the total number of open ports. */
-            *pxOutNumTcpOpenPorts = xMetrics.xTCPPortList.uxCount;
+            *pxOutNumTcpOpenPorts = pxMetrics->xTCPPortList.uxCount;
         }
     }
 
@@ -151,40 +261,37 @@ eMetricsCollectorStatus eGetOpenUdpPorts( uint16_t * pusOutUdpPortsArray,
                                           size_t * pxOutNumUdpOpenPorts )
 {
     eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
+    const MetricsType_t * pxMetrics = NULL;
 
-    MetricsType_t xMetrics = { 0 };
-    BaseType_t xMetricsStatus = 0;
     size_t xCopyAmount = 0UL;
 
     /* pusOutUdpPortsArray can be NULL. */
     configASSERT( pxOutNumUdpOpenPorts != NULL );
 
-    /* Get metrics from FreeRTOS+TCP tcp_netstat utility. */
-    xMetricsStatus = vGetMetrics( &xMetrics );
-
-    if( xMetricsStatus != 0 )
+    /* Read from the latest snapshot, taking one if there is none yet. */
+    if( xSnapshotValid == pdFALSE )
     {
-        LogError( ( "Failed to acquire metrics from FreeRTOS+TCP tcp_netstat utility. Status: %d.",
-                    ( int ) xMetricsStatus ) );
-        eStatus = eMetricsCollectorCollectionFailed;
+        eStatus = eUpdateMetrics( NULL );
     }
 
+    pxMetrics = &( xSnapshots[ uxCurrentSnapshot ] );
+
     if( eStatus == eMetricsCollectorSuccess )
     {
         /* Fill the output array with as many UDP ports as will fit in the
          * given array. */
         if( pusOutUdpPortsArray != NULL )
         {
-            xCopyAmount = xMetrics.xUDPPortList.uxCount;
+            xCopyAmount = pxMetrics->xUDPPortList.uxCount;
 
             /* Limit the copied ports to what can fit in the output array. */
-            if( xUdpPortsArrayLength < xMetrics.xUDPPortList.uxCount )
+            if( xUdpPortsArrayLength < pxMetrics->xUDPPortList.uxCount )
             {
                 LogWarn( ( "Ports returned truncated due to insufficient buffer size." ) );
                 xCopyAmount = xUdpPortsArrayLength;
             }
 
-            memcpy( pusOutUdpPortsArray, &xMetrics.xUDPPortList.usUDPPortList, xCopyAmount * sizeof( uint16_t ) );
+            memcpy( pusOutUdpPortsArray, pxMetrics->xUDPPortList.usUDPPortList, xCopyAmount * sizeof( uint16_t ) );
 
             /* Return the number of elements copied to the array. */
             *pxOutNumUdpOpenPorts = xCopyAmount;
@@ -192,7 +299,7 @@ eMetricsCollectorStatus eGetOpenUdpPorts( uint16_t * pusOutUdpPortsArray,
         else
         {
             /* Return the total number of open ports. */
-            *pxOutNumUdpOpenPorts = xMetrics.xUDPPortList.uxCount;
+            *pxOutNumUdpOpenPorts = pxMetrics->xUDPPortList.uxCount;
         }
     }
 
@@ -206,9 +313,8 @@ eMetricsCollectorStatus eGetEstablishedConnections( Connection_t * pxOutConnecti
                                                     size_t * pxOutNumEstablishedConnections )
 {
     eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
+    const MetricsType_t * pxMetrics = NULL;
 
-    MetricsType_t xMetrics = { 0 };
-    BaseType_t xMetricsStatus = 0;
     size_t xCopyAmount = 0UL;
     size_t uxIdx;
     uint32_t ulLocalIp = 0UL;
@@ -216,29 +322,27 @@ eMetricsCollectorStatus eGetEstablishedConnections( Connection_t * pxOutConnecti
     /* pxOutConnectionsArray can be NULL. */
     configASSERT( pxOutNumEstablishedConnections != NULL );
 
-    /* Get metrics from FreeRTOS+TCP tcp_netstat utility. */
-    xMetricsStatus = vGetMetrics( &xMetrics );
-
-    if( xMetricsStatus != 0 )
+    /* Read from the latest snapshot, taking one if there is none yet. */
+    if( xSnapshotValid == pdFALSE )
     {
-        LogError( ( "Failed to acquire metrics from FreeRTOS+TCP tcp_netstat utility. Status: %d.",
-                    ( int ) xMetricsStatus ) );
-        eStatus = eMetricsCollectorCollectionFailed;
+        eStatus = eUpdateMetrics( NULL );
     }
 
+    pxMetrics = &( xSnapshots[ uxCurrentSnapshot ] );
+
     if( eStatus == eMetricsCollectorSuccess )
     {
         /* Fill the output array with as many TCP socket infos as will fit in
          * the given array. */
         if( pxOutConnectionsArray != NULL )
         {
-            xCopyAmount = xMetrics.xTCPSocketList.uxCount;
+            xCopyAmount = pxMetrics->xTCPSocketList.uxCount;
 
             /* Get local IP as the tcp_netstat utility does not give it. */
             ulLocalIp = FreeRTOS_GetIPAddress();
 
             /* Limit the outputted connections to what can fit in the output array. */
-            if( xConnectionsArrayLength < xMetrics.xTCPSocketList.uxCount )
+            if( xConnectionsArrayLength < pxMetrics->xTCPSocketList.uxCount )
             {
                 LogWarn( ( "Ports returned truncated due to insufficient buffer size." ) );
                 xCopyAmount = xConnectionsArrayLength;
@@ -248,11 +352,11 @@ eMetricsCollectorStatus eGetEstablishedConnections( Connection_t * pxOutConnecti
             {
                 pxOutConnectionsArray[ uxIdx ].ulLocalIp = ulLocalIp;
                 pxOutConnectionsArray[ uxIdx ].usLocalPort =
-                    xMetrics.xTCPSocketList.xTCPList[ uxIdx ].usLocalPort;
+                    pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].usLocalPort;
                 pxOutConnectionsArray[ uxIdx ].ulRemoteIp =
-                    xMetrics.xTCPSocketList.xTCPList[ uxIdx ].ulRemoteIP;
+                    pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].ulRemoteIP;
                 pxOutConnectionsArray[ uxIdx ].usRemotePort =
-                    xMetrics.xTCPSocketList.xTCPList[ uxIdx ].usRemotePort;
+                    pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].usRemotePort;
             }
 
             /* Return the number of elements copied to the array. */
@@ -261,7 +365,7 @@ eMetricsCollectorStatus eGetEstablishedConnections( Connection_t * pxOutConnecti
         else
         {
             /* Return the total number of established connections. */
-            *pxOutNumEstablishedConnections = xMetrics.xTCPSocketList.uxCount;
+            *pxOutNumEstablishedConnections = pxMetrics->xTCPSocketList.uxCount;
         }
     }
 
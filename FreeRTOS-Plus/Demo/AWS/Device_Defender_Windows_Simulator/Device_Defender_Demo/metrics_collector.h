@@ -35,6 +35,7 @@
 #define METRICS_COLLECTOR_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /**
  * @brief Return codes from metrics collector APIs.
@@ -68,6 +69,23 @@ typedef struct Connection
     uint16_t usRemotePort;
 } Connection_t;
 
+/**
+ * @brief Take a new snapshot of the device metrics.
+ *
+ * The other functions of the metrics collector read from the latest snapshot,
+ * so all the metrics of a report come from a single walk of the network stack
+ * instead of one walk per function. They take a snapshot themselves if none has
+ * been taken yet.
+ *
+ * @param[out] pxOutListsChanged Set to true if the open TCP ports, open UDP
+ * ports or established connections differ from the previous snapshot, or if
+ * there was no previous snapshot. This can be NULL.
+ *
+ * @return #eMetricsCollectorSuccess if the snapshot is successfully taken;
+ * #eMetricsCollectorCollectionFailed if the collection methods failed.
+ */
+eMetricsCollectorStatus eUpdateMetrics( bool * pxOutListsChanged );
+
 /**
  * @brief Get network stats.
  *
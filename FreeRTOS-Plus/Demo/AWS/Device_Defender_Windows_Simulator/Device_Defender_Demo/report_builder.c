@@ -45,6 +45,36 @@
 /* Helper macro to check if snprintf was successful. */
 #define reportbuilderSNPRINTF_SUCCESS( retVal, bufLen )    ( ( retVal > 0 ) && ( ( uint32_t ) retVal < bufLen ) )
 
+/* CBOR major types used in the report. */
+#define reportbuilderCBOR_UNSIGNED_INT    ( 0U )
+#define reportbuilderCBOR_TEXT_STRING     ( 3U )
+#define reportbuilderCBOR_ARRAY           ( 4U )
+#define reportbuilderCBOR_MAP             ( 5U )
+
+/* Helper macro to write a key given as a string literal. */
+#define reportbuilderCBOR_WRITE_KEY( pxWriter, key )    prvCborWriteText( ( pxWriter ), ( key ), sizeof( key ) - 1U )
+
+/* Helper macro to write an unsigned integer. */
+#define reportbuilderCBOR_WRITE_UINT( pxWriter, value )    prvCborWriteHead( ( pxWriter ), reportbuilderCBOR_UNSIGNED_INT, ( uint32_t ) ( value ) )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief State of the CBOR writer used by eGenerateCborReport().
+ *
+ * Only definite length items are written, so the report is encoded in a single
+ * pass directly into the output buffer. The status is sticky: once the buffer
+ * is too small, the remaining writes are skipped and the error is reported at
+ * the end.
+ */
+typedef struct CborWriter
+{
+    uint8_t * pucBuffer;
+    size_t xBufferLength;
+    size_t xOffset;
+    eReportBuilderStatus eStatus;
+} CborWriter_t;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -124,6 +154,46 @@ static eReportBuilderStatus prvWriteTaskIdArray( char * pcBuffer,
                                                  const TaskStatus_t * pxTaskStatusArray,
                                                  size_t xTaskStatusArrayLength,
                                                  size_t * pxOutCharsWritten );
+
+/**
+ * @brief Write the head of a CBOR data item.
+ *
+ * The head is the major type followed by the argument in the shortest
+ * encoding. For unsigned integers the argument is the value, for text strings
+ * it is the length in bytes and for arrays and maps it is the number of items
+ * or pairs that follow.
+ *
+ * @param[in] pxWriter The CBOR writer.
+ * @param[in] ucMajorType The major type of the data item.
+ * @param[in] ulArgument The argument of the data item.
+ */
+static void prvCborWriteHead( CborWriter_t * pxWriter,
+                              uint8_t ucMajorType,
+                              uint32_t ulArgument );
+
+/**
+ * @brief Write a CBOR text string.
+ *
+ * @param[in] pxWriter The CBOR writer.
+ * @param[in] pcText The text, which need not be NUL terminated.
+ * @param[in] xTextLength Length of the text in bytes.
+ */
+static void prvCborWriteText( CborWriter_t * pxWriter,
+                              const char * pcText,
+                              size_t xTextLength );
+
+/**
+ * @brief Write the decimal representation of a number without a terminating
+ * NUL.
+ *
+ * @param[in] pcBuffer The buffer to write the digits into. It must be able to
+ * hold at least 10 characters.
+ * @param[in] ulValue The number to write.
+ *
+ * @return Number of characters written.
+ */
+static size_t prvFormatDecimal( char * pcBuffer,
+                                uint32_t ulValue );
 /*-----------------------------------------------------------*/
 
 static eReportBuilderStatus prvWritePortsArray( char * pcBuffer,
@@ -621,3 +691,270 @@ eReportBuilderStatus eGenerateJsonReport( char * pcBuffer,
     return eStatus;
 }
 /*-----------------------------------------------------------*/
+
+static void prvCborWriteHead( CborWriter_t * pxWriter,
+                              uint8_t ucMajorType,
+                              uint32_t ulArgument )
+{
+    uint8_t ucHead[ 5 ];
+    size_t xHeadLength;
+    uint8_t ucType = ( uint8_t ) ( ucMajorType << 5 );
+
+    if( ulArgument < 24UL )
+    {
+        ucHead[ 0 ] = ( uint8_t ) ( ucType | ( uint8_t ) ulArgument );
+        xHeadLength = 1U;
+    }
+    else if( ulArgument <= 0xFFUL )
+    {
+        ucHead[ 0 ] = ( uint8_t ) ( ucType | 24U );
+        ucHead[ 1 ] = ( uint8_t ) ulArgument;
+        xHeadLength = 2U;
+    }
+    else if( ulArgument <= 0xFFFFUL )
+    {
+        ucHead[ 0 ] = ( uint8_t ) ( ucType | 25U );
+        ucHead[ 1 ] = ( uint8_t ) ( ulArgument >> 8 );
+        ucHead[ 2 ] = ( uint8_t ) ulArgument;
+        xHeadLength = 3U;
+    }
+    else
+    {
+        ucHead[ 0 ] = ( uint8_t ) ( ucType | 26U );
+        ucHead[ 1 ] = ( uint8_t ) ( ulArgument >> 24 );
+        ucHead[ 2 ] = ( uint8_t ) ( ulArgument >> 16 );
+        ucHead[ 3 ] = ( uint8_t ) ( ulArgument >> 8 );
+        ucHead[ 4 ] = ( uint8_t ) ulArgument;
+        xHeadLength = 5U;
+    }
+
+    if( pxWriter->eStatus == eReportBuilderSuccess )
+    {
+        if( ( pxWriter->xBufferLength - pxWriter->xOffset ) < xHeadLength )
+        {
+            pxWriter->eStatus = eReportBuilderBufferTooSmall;
+        }
+        else
+        {
+            memcpy( &( pxWriter->pucBuffer[ pxWriter->xOffset ] ), ucHead, xHeadLength );
+            pxWriter->xOffset += xHeadLength;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCborWriteText( CborWriter_t * pxWriter,
+                              const char * pcText,
+                              size_t xTextLength )
+{
+    prvCborWriteHead( pxWriter, reportbuilderCBOR_TEXT_STRING, ( uint32_t ) xTextLength );
+
+    if( pxWriter->eStatus == eReportBuilderSuccess )
+    {
+        if( ( pxWriter->xBufferLength - pxWriter->xOffset ) < xTextLength )
+        {
+            pxWriter->eStatus = eReportBuilderBufferTooSmall;
+        }
+        else
+        {
+            memcpy( &( pxWriter->pucBuffer[ pxWriter->xOffset ] ), pcText, xTextLength );
+            pxWriter->xOffset += xTextLength;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFormatDecimal( char * pcBuffer,
+                                uint32_t ulValue )
+{
+    char cDigits[ 10 ];
+    size_t xDigitCount = 0U;
+    size_t uxIdx;
+
+    /* Produce the digits from the least significant one, then reverse them. */
+    do
+    {
+        cDigits[ xDigitCount ] = ( char ) ( '0' + ( ulValue % 10UL ) );
+        ulValue /= 10UL;
+        xDigitCount++;
+    } while( ulValue != 0UL );
+
+    for( uxIdx = 0; uxIdx < xDigitCount; uxIdx++ )
+    {
+        pcBuffer[ uxIdx ] = cDigits[ xDigitCount - 1U - uxIdx ];
+    }
+
+    return xDigitCount;
+}
+/*-----------------------------------------------------------*/
+
+eReportBuilderStatus eGenerateCborReport( uint8_t * pucBuffer,
+                                          size_t xBufferLength,
+                                          const ReportMetrics_t * pxMetrics,
+                                          uint32_t ulMajorReportVersion,
+                                          uint32_t ulMinorReportVersion,
+                                          uint32_t ulReportId,
+                                          size_t * pxOutReportLength )
+{
+    CborWriter_t xWriter;
+    /* Large enough for "4294967295.4294967295" and "255.255.255.255:65535". */
+    char cText[ 21 ];
+    size_t xTextLength;
+    size_t uxIdx;
+    const Connection_t * pxConn;
+    eReportBuilderStatus eStatus = eReportBuilderSuccess;
+
+    configASSERT( pucBuffer != NULL );
+    configASSERT( pxMetrics != NULL );
+    configASSERT( pxOutReportLength != NULL );
+    configASSERT( xBufferLength != 0 );
+
+    if( ( pucBuffer == NULL ) ||
+        ( xBufferLength == 0 ) ||
+        ( pxMetrics == NULL ) ||
+        ( pxOutReportLength == NULL ) )
+    {
+        LogError( ( "Invalid parameters. pucBuffer: %p, xBufferLength: %u"
+                    " pMetrics: %p, pOutReprotLength: %p.",
+                    pucBuffer,
+                    ( unsigned int ) xBufferLength,
+                    pxMetrics,
+                    pxOutReportLength ) );
+        eStatus = eReportBuilderBadParameter;
+    }
+
+    if( eStatus == eReportBuilderSuccess )
+    {
+        xWriter.pucBuffer = pucBuffer;
+        xWriter.xBufferLength = xBufferLength;
+        xWriter.xOffset = 0U;
+        xWriter.eStatus = eReportBuilderSuccess;
+
+        /* The report has the same structure as the one written by
+         * eGenerateJsonReport(). Every map and array is written with its item
+         * count up front. */
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 3U );
+
+        /* Header. */
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_HEADER_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 2U );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_ID_KEY );
+        reportbuilderCBOR_WRITE_UINT( &xWriter, ulReportId );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_VERSION_KEY );
+        xTextLength = prvFormatDecimal( cText, ulMajorReportVersion );
+        cText[ xTextLength++ ] = '.';
+        xTextLength += prvFormatDecimal( &( cText[ xTextLength ] ), ulMinorReportVersion );
+        prvCborWriteText( &xWriter, cText, xTextLength );
+
+        /* Metrics. */
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_METRICS_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 4U );
+
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_TCP_LISTENING_PORTS_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 2U );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_PORTS_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_ARRAY, ( uint32_t ) pxMetrics->xOpenTcpPortsArrayLength );
+
+        for( uxIdx = 0; uxIdx < pxMetrics->xOpenTcpPortsArrayLength; uxIdx++ )
+        {
+            prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 1U );
+            reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_PORT_KEY );
+            reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->pusOpenTcpPortsArray[ uxIdx ] );
+        }
+
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_TOTAL_KEY );
+        reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->xOpenTcpPortsArrayLength );
+
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_UDP_LISTENING_PORTS_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 2U );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_PORTS_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_ARRAY, ( uint32_t ) pxMetrics->xOpenUdpPortsArrayLength );
+
+        for( uxIdx = 0; uxIdx < pxMetrics->xOpenUdpPortsArrayLength; uxIdx++ )
+        {
+            prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 1U );
+            reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_PORT_KEY );
+            reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->pusOpenUdpPortsArray[ uxIdx ] );
+        }
+
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_TOTAL_KEY );
+        reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->xOpenUdpPortsArrayLength );
+
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_NETWORK_STATS_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 4U );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_BYTES_IN_KEY );
+        reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->pxNetworkStats->uxBytesReceived );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_BYTES_OUT_KEY );
+        reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->pxNetworkStats->uxBytesSent );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_PKTS_IN_KEY );
+        reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->pxNetworkStats->uxPacketsReceived );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_PKTS_OUT_KEY );
+        reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->pxNetworkStats->uxPacketsSent );
+
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_TCP_CONNECTIONS_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 1U );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_ESTABLISHED_CONNECTIONS_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 2U );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_CONNECTIONS_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_ARRAY, ( uint32_t ) pxMetrics->xEstablishedConnectionsArrayLength );
+
+        for( uxIdx = 0; uxIdx < pxMetrics->xEstablishedConnectionsArrayLength; uxIdx++ )
+        {
+            pxConn = &( pxMetrics->pxEstablishedConnectionsArray[ uxIdx ] );
+
+            prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 2U );
+            reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_LOCAL_PORT_KEY );
+            reportbuilderCBOR_WRITE_UINT( &xWriter, pxConn->usLocalPort );
+            reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_REMOTE_ADDR_KEY );
+            xTextLength = prvFormatDecimal( cText, ( pxConn->ulRemoteIp >> 24 ) & 0xFFUL );
+            cText[ xTextLength++ ] = '.';
+            xTextLength += prvFormatDecimal( &( cText[ xTextLength ] ), ( pxConn->ulRemoteIp >> 16 ) & 0xFFUL );
+            cText[ xTextLength++ ] = '.';
+            xTextLength += prvFormatDecimal( &( cText[ xTextLength ] ), ( pxConn->ulRemoteIp >> 8 ) & 0xFFUL );
+            cText[ xTextLength++ ] = '.';
+            xTextLength += prvFormatDecimal( &( cText[ xTextLength ] ), pxConn->ulRemoteIp & 0xFFUL );
+            cText[ xTextLength++ ] = ':';
+            xTextLength += prvFormatDecimal( &( cText[ xTextLength ] ), pxConn->usRemotePort );
+            prvCborWriteText( &xWriter, cText, xTextLength );
+        }
+
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_TOTAL_KEY );
+        reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->xEstablishedConnectionsArrayLength );
+
+        /* Custom metrics. */
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_CUSTOM_METRICS_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 2U );
+
+        reportbuilderCBOR_WRITE_KEY( &xWriter, "stack_high_water_mark" );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_ARRAY, 1U );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 1U );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_NUMBER_KEY );
+        reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->ulStackHighWaterMark );
+
+        reportbuilderCBOR_WRITE_KEY( &xWriter, "task_numbers" );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_ARRAY, 1U );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_MAP, 1U );
+        reportbuilderCBOR_WRITE_KEY( &xWriter, DEFENDER_REPORT_NUMBER_LIST_KEY );
+        prvCborWriteHead( &xWriter, reportbuilderCBOR_ARRAY, ( uint32_t ) pxMetrics->xTaskStatusArrayLength );
+
+        for( uxIdx = 0; uxIdx < pxMetrics->xTaskStatusArrayLength; uxIdx++ )
+        {
+            reportbuilderCBOR_WRITE_UINT( &xWriter, pxMetrics->pxTaskStatusArray[ uxIdx ].xTaskNumber );
+        }
+
+        eStatus = xWriter.eStatus;
+
+        if( eStatus == eReportBuilderSuccess )
+        {
+            *pxOutReportLength = xWriter.xOffset;
+        }
+        else
+        {
+            LogError( ( "Failed to write CBOR report. Buffer length: %u.",
+                        ( unsigned int ) xBufferLength ) );
+        }
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
@@ -88,4 +88,33 @@ eReportBuilderStatus eGenerateJsonReport( char * pcBuffer,
                                           uint32_t ulReportId,
                                           size_t * pxOutReportLength );
 
+/**
+ * @brief Generate a CBOR report in the format expected by the AWS IoT Device
+ * Defender Service.
+ *
+ * The report has the same content as the one generated by
+ * eGenerateJsonReport() but is smaller and is encoded without any formatted
+ * printing. It is written in a single pass, so the buffer can be reused for
+ * every report.
+ *
+ * @param[in] pucBuffer The buffer to write the report into.
+ * @param[in] xBufferLength The length of the buffer.
+ * @param[in] pxMetrics Metrics to write in the generated report.
+ * @param[in] ulMajorReportVersion Major version of the report.
+ * @param[in] ulMinorReportVersion Minor version of the report.
+ * @param[in] ulReportId Value to be used as the ulReportId in the generated report.
+ * @param[out] pxOutReportLength The length of the generated report.
+ *
+ * @return #ReportBuilderSuccess if the report is successfully generated;
+ * #ReportBuilderBadParameter if invalid parameters are passed;
+ * #ReportBuilderBufferTooSmall if the buffer cannot hold the full report.
+ */
+eReportBuilderStatus eGenerateCborReport( uint8_t * pucBuffer,
+                                          size_t xBufferLength,
+                                          const ReportMetrics_t * pxMetrics,
+                                          uint32_t ulMajorReportVersion,
+                                          uint32_t ulMinorReportVersion,
+                                          uint32_t ulReportId,
+                                          size_t * pxOutReportLength );
+
 #endif /* ifndef REPORT_BUILDER_H_ */
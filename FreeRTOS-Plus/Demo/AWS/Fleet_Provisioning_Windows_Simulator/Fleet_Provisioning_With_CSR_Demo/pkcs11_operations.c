@@ -133,6 +133,10 @@ static CK_RV prvDestroyProvidedObjects( CK_SESSION_HANDLE xSession,
                 }
             }
         }
+
+        /* The transport may have cached the handles of the destroyed objects,
+         * and the credentials read from them. */
+        vPKCS11_InvalidateObjectCache();
     }
 
     return xResult;
@@ -393,6 +397,8 @@ bool xPkcs11CloseSession( CK_SESSION_HANDLE xP11Session )
 
     if( xResult == CKR_OK )
     {
+        /* C_Finalize closes the persistent session of the transport too. */
+        vPKCS11_InvalidateObjectCache();
         xResult = xFunctionList->C_Finalize( NULL );
     }
 
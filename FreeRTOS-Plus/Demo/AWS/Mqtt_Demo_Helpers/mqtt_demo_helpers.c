@@ -43,6 +43,7 @@
 /* Kernel includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
 
 /* Shadow includes */
 #include "mqtt_demo_helpers.h"
@@ -143,12 +144,32 @@
  */
 #define mqttexampleTRANSPORT_SEND_RECV_TIMEOUT_MS    ( 200U )
 
+/**
+ * @brief Maximum number of outgoing publishes maintained in the application
+ * until an ack is received from the broker.
+ */
+#ifndef democonfigMAX_OUTGOING_PUBLISHES
+    #define democonfigMAX_OUTGOING_PUBLISHES         ( 1U )
+#endif
+#define MAX_OUTGOING_PUBLISHES                       democonfigMAX_OUTGOING_PUBLISHES
+
+/**
+ * @brief Number of hash buckets used to find an outgoing publish by packet
+ * identifier. Packet identifiers are handed out sequentially, so twice as many
+ * buckets as publishes keeps the chains at a single entry in practice.
+ */
+#define OUTGOING_PUBLISH_BUCKETS                     ( 2U * MAX_OUTGOING_PUBLISHES )
+
 /**
  * @brief The length of the outgoing publish records array used by the coreMQTT
  * library to track QoS > 0 packet ACKS for outgoing publishes.
  * This length depends on the Number of publishes & can be updated accordingly.
  */
-#define mqttexampleOUTGOING_PUBLISH_RECORD_LEN       ( 15U )
+#if ( MAX_OUTGOING_PUBLISHES > 15U )
+    #define mqttexampleOUTGOING_PUBLISH_RECORD_LEN   MAX_OUTGOING_PUBLISHES
+#else
+    #define mqttexampleOUTGOING_PUBLISH_RECORD_LEN   ( 15U )
+#endif
 
 /**
  * @brief The length of the incoming publish records array used by the coreMQTT
@@ -157,12 +178,6 @@
  */
 #define mqttexampleINCOMING_PUBLISH_RECORD_LEN       ( 15U )
 
-/**
- * @brief Maximum number of outgoing publishes maintained in the application
- * until an ack is received from the broker.
- */
-#define MAX_OUTGOING_PUBLISHES                       ( 1U )
-
 /**
  * @brief Milliseconds per second.
  */
@@ -198,6 +213,18 @@ typedef struct PublishPackets
      * @brief Publish info of the publish packet.
      */
     MQTTPublishInfo_t pubInfo;
+
+    /**
+     * @brief Next entry in the same hash bucket while in use, or next free
+     * entry while free. Links hold the array index plus one, so 0 ends a list.
+     */
+    uint16_t usNextLink;
+
+    /**
+     * @brief Neighbours in the list of publishes in the order they were sent.
+     */
+    uint16_t usPrevSent;
+    uint16_t usNextSent;
 } PublishPackets_t;
 
 /*-----------------------------------------------------------*/
@@ -249,6 +276,29 @@ static uint16_t globalUnsubscribePacketIdentifier = 0U;
  */
 static PublishPackets_t outgoingPublishPackets[ MAX_OUTGOING_PUBLISHES ] = { 0 };
 
+/**
+ * @brief First entry of #outgoingPublishPackets in each hash bucket, indexed by
+ * packet identifier modulo #OUTGOING_PUBLISH_BUCKETS.
+ */
+static uint16_t usOutgoingPublishBuckets[ OUTGOING_PUBLISH_BUCKETS ] = { 0 };
+
+/**
+ * @brief Entries of #outgoingPublishPackets that have been used and released.
+ */
+static uint16_t usFreeOutgoingPublishes = 0U;
+
+/**
+ * @brief Number of entries of #outgoingPublishPackets that have ever been
+ * handed out. Entries above this index have never been on the free list.
+ */
+static uint16_t usUsedOutgoingPublishes = 0U;
+
+/**
+ * @brief Oldest and newest outgoing publishes still awaiting a PUBACK.
+ */
+static uint16_t usOldestOutgoingPublish = 0U;
+static uint16_t usNewestOutgoingPublish = 0U;
+
 /**
  * @brief Array to track the outgoing publish records for outgoing publishes
  * with QoS > 0.
@@ -267,6 +317,18 @@ static MQTTPubAckInfo_t pOutgoingPublishRecords[ mqttexampleOUTGOING_PUBLISH_REC
  */
 static MQTTPubAckInfo_t pIncomingPublishRecords[ mqttexampleINCOMING_PUBLISH_RECORD_LEN ];
 
+/**
+ * @brief Semaphore the transport gives when the connection may have become
+ * readable, so the process loop can sleep instead of polling.
+ */
+static SemaphoreHandle_t xReadySemaphore = NULL;
+
+/**
+ * @brief Set when the transport of the current connection gives
+ * #xReadySemaphore. Otherwise the process loop polls as before.
+ */
+static BaseType_t xReadyWakeupsEnabled = pdFALSE;
+
 
 /*-----------------------------------------------------------*/
 
@@ -303,21 +365,29 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkContext
  * @brief Function to get the free index at which an outgoing publish
  * can be stored.
  *
- * @param[out] pucIndex The output parameter to return the index at which an
+ * @param[out] pusIndex The output parameter to return the index at which an
  * outgoing publish message can be stored.
  *
  * @return pdFAIL if no more publishes can be stored;
  * pdTRUE if an index to store the next outgoing publish is obtained.
  */
-static BaseType_t prvGetNextFreeIndexForOutgoingPublishes( uint8_t * pucIndex );
+static BaseType_t prvGetNextFreeIndexForOutgoingPublishes( uint16_t * pusIndex );
+
+/**
+ * @brief Function to make the outgoing publish at the given index findable by
+ * its packet identifier, once the identifier has been assigned.
+ *
+ * @param[in] usIndex The index of the publish message.
+ */
+static void prvTrackOutgoingPublishAt( uint16_t usIndex );
 
 /**
  * @brief Function to clean up an outgoing publish at given index from the
  * #outgoingPublishPackets array.
  *
- * @param[in] ucIndex The index at which a publish message has to be cleaned up.
+ * @param[in] usIndex The index at which a publish message has to be cleaned up.
  */
-static void vCleanupOutgoingPublishAt( uint8_t ucIndex );
+static void vCleanupOutgoingPublishAt( uint16_t usIndex );
 
 /**
  * @brief Function to clean up all the outgoing publishes maintained in the
@@ -361,6 +431,27 @@ static uint32_t prvGetTimeMs( void );
 static MQTTStatus_t prvProcessLoopWithTimeout( MQTTContext_t * pMqttContext,
                                                uint32_t ulTimeoutMs );
 
+/**
+ * @brief Ask the transport to give #xReadySemaphore when the connection may
+ * have become readable, creating the semaphore on first use.
+ *
+ * @param[in] pxNetworkContext The network context of the new connection.
+ */
+static void prvEnableReadyWakeups( NetworkContext_t * pxNetworkContext );
+
+/**
+ * @brief Time until #MQTT_ProcessLoop next needs to run for keep-alive,
+ * either to send a PINGREQ or to notice a missing PINGRESP.
+ *
+ * @param[in] pMqttContext MQTT context pointer.
+ * @param[in] ulNowMs The current time from the context's time function.
+ *
+ * @return Milliseconds until the deadline, 0 if it has passed, or UINT32_MAX
+ * if keep-alive is disabled.
+ */
+static uint32_t prvTimeUntilKeepAliveMs( const MQTTContext_t * pMqttContext,
+                                         uint32_t ulNowMs );
+
 /*-----------------------------------------------------------*/
 
 static int32_t prvGenerateRandomNumber()
@@ -480,38 +571,153 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkContext
 
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvGetNextFreeIndexForOutgoingPublishes( uint8_t * pucIndex )
+static BaseType_t prvGetNextFreeIndexForOutgoingPublishes( uint16_t * pusIndex )
 {
-    BaseType_t xReturnStatus = pdFAIL;
-    uint8_t ucIndex = 0;
+    BaseType_t xReturnStatus = pdPASS;
+    uint16_t usIndex = MAX_OUTGOING_PUBLISHES;
 
-    configASSERT( outgoingPublishPackets != NULL );
-    configASSERT( pucIndex != NULL );
+    configASSERT( pusIndex != NULL );
 
-    for( ucIndex = 0; ucIndex < MAX_OUTGOING_PUBLISHES; ucIndex++ )
+    /* Reuse a released entry if there is one, otherwise take the next entry
+     * that has never been used. */
+    if( usFreeOutgoingPublishes != 0U )
     {
-        /* A free ucIndex is marked by invalid packet id.
-         * Check if the ucIndex has a free slot. */
-        if( outgoingPublishPackets[ ucIndex ].packetId == MQTT_PACKET_ID_INVALID )
-        {
-            xReturnStatus = pdPASS;
-            break;
-        }
+        usIndex = usFreeOutgoingPublishes - 1U;
+        usFreeOutgoingPublishes = outgoingPublishPackets[ usIndex ].usNextLink;
+        outgoingPublishPackets[ usIndex ].usNextLink = 0U;
+    }
+    else if( usUsedOutgoingPublishes < MAX_OUTGOING_PUBLISHES )
+    {
+        usIndex = usUsedOutgoingPublishes;
+        usUsedOutgoingPublishes++;
+    }
+    else
+    {
+        xReturnStatus = pdFAIL;
     }
 
-    /* Copy the available ucIndex into the output param. */
-    *pucIndex = ucIndex;
+    /* Copy the available usIndex into the output param. */
+    *pusIndex = usIndex;
 
     return xReturnStatus;
 }
 
 /*-----------------------------------------------------------*/
 
+static void prvTrackOutgoingPublishAt( uint16_t usIndex )
+{
+    PublishPackets_t * pxPublish;
+    uint16_t usBucket;
+
+    configASSERT( usIndex < MAX_OUTGOING_PUBLISHES );
+
+    pxPublish = &( outgoingPublishPackets[ usIndex ] );
+    configASSERT( pxPublish->packetId != MQTT_PACKET_ID_INVALID );
+
+    /* Add to the front of the packet identifier's hash bucket. */
+    usBucket = pxPublish->packetId % OUTGOING_PUBLISH_BUCKETS;
+    pxPublish->usNextLink = usOutgoingPublishBuckets[ usBucket ];
+    usOutgoingPublishBuckets[ usBucket ] = usIndex + 1U;
+
+    /* Add to the end of the list of publishes in the order they were sent. */
+    pxPublish->usPrevSent = usNewestOutgoingPublish;
+    pxPublish->usNextSent = 0U;
+
+    if( usNewestOutgoingPublish != 0U )
+    {
+        outgoingPublishPackets[ usNewestOutgoingPublish - 1U ].usNextSent = usIndex + 1U;
+    }
+    else
+    {
+        usOldestOutgoingPublish = usIndex + 1U;
+    }
+
+    usNewestOutgoingPublish = usIndex + 1U;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvEnableReadyWakeups( NetworkContext_t * pxNetworkContext )
+{
+    xReadyWakeupsEnabled = pdFALSE;
+
+    if( xReadySemaphore == NULL )
+    {
+        xReadySemaphore = xSemaphoreCreateBinary();
+    }
+
+    if( ( xReadySemaphore != NULL ) &&
+        ( TLS_FreeRTOS_SetReadySemaphore( pxNetworkContext, xReadySemaphore ) == TLS_TRANSPORT_SUCCESS ) )
+    {
+        xReadyWakeupsEnabled = pdTRUE;
+    }
+    else
+    {
+        LogInfo( ( "Transport has no readiness signal, MQTT process loop will poll." ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvTimeUntilKeepAliveMs( const MQTTContext_t * pMqttContext,
+                                         uint32_t ulNowMs )
+{
+    uint32_t ulDeadlineMs = 0U;
+    uint32_t ulIntervalMs;
+    uint32_t ulWaitMs = UINT32_MAX;
+    BaseType_t xHasDeadline = pdTRUE;
+
+    if( pMqttContext->waitingForPingResp == true )
+    {
+        ulDeadlineMs = pMqttContext->pingReqSendTimeMs + MQTT_PINGRESP_TIMEOUT_MS;
+    }
+    else if( pMqttContext->keepAliveIntervalSec != 0U )
+    {
+        ulIntervalMs = ( uint32_t ) pMqttContext->keepAliveIntervalSec * MILLISECONDS_PER_SECOND;
+
+        /* Newer coreMQTT versions can ping more often than the keep-alive
+         * interval, after a quiet period in either direction. */
+        #if defined( PACKET_TX_TIMEOUT_MS )
+            if( ( PACKET_TX_TIMEOUT_MS != 0U ) && ( PACKET_TX_TIMEOUT_MS < ulIntervalMs ) )
+            {
+                ulIntervalMs = PACKET_TX_TIMEOUT_MS;
+            }
+        #endif
+
+        ulDeadlineMs = pMqttContext->lastPacketTxTime + ulIntervalMs;
+
+        #if defined( PACKET_RX_TIMEOUT_MS )
+            if( ( PACKET_RX_TIMEOUT_MS != 0U ) &&
+                ( ( int32_t ) ( ( pMqttContext->lastPacketRxTime + PACKET_RX_TIMEOUT_MS ) - ulDeadlineMs ) < 0 ) )
+            {
+                ulDeadlineMs = pMqttContext->lastPacketRxTime + PACKET_RX_TIMEOUT_MS;
+            }
+        #endif
+    }
+    else
+    {
+        /* Keep-alive is disabled, so there is no deadline. */
+        xHasDeadline = pdFALSE;
+    }
+
+    if( xHasDeadline == pdTRUE )
+    {
+        /* The subtraction is done modulo 2^32 so a wrapped clock still works. */
+        ulWaitMs = ( ( int32_t ) ( ulDeadlineMs - ulNowMs ) > 0 ) ? ( ulDeadlineMs - ulNowMs ) : 0U;
+    }
+
+    return ulWaitMs;
+}
+
+/*-----------------------------------------------------------*/
+
 static MQTTStatus_t prvProcessLoopWithTimeout( MQTTContext_t * pMqttContext,
                                                uint32_t ulTimeoutMs )
 {
     uint32_t ulMqttProcessLoopTimeoutTime;
     uint32_t ulCurrentTime;
+    uint32_t ulWaitMs;
+    NetworkContext_t * pxNetworkContext = pMqttContext->transportInterface.pNetworkContext;
 
     MQTTStatus_t eMqttStatus = MQTTSuccess;
 
@@ -523,6 +729,33 @@ static MQTTStatus_t prvProcessLoopWithTimeout( MQTTContext_t * pMqttContext,
     while( ( ulCurrentTime < ulMqttProcessLoopTimeoutTime ) &&
            ( eMqttStatus == MQTTSuccess || eMqttStatus == MQTTNeedMoreBytes ) )
     {
+        /* When the transport can signal readiness, only run the process loop
+         * once there is something to receive or keep-alive is due, and sleep
+         * until then. An idle connection then costs no wake-ups between
+         * keep-alive pings. */
+        if( ( xReadyWakeupsEnabled == pdTRUE ) && ( TLS_FreeRTOS_Poll( pxNetworkContext ) == 0 ) )
+        {
+            ulWaitMs = prvTimeUntilKeepAliveMs( pMqttContext, ulCurrentTime );
+
+            if( ulWaitMs > ( ulMqttProcessLoopTimeoutTime - ulCurrentTime ) )
+            {
+                ulWaitMs = ulMqttProcessLoopTimeoutTime - ulCurrentTime;
+            }
+
+            if( ulWaitMs > 0U )
+            {
+                ( void ) xSemaphoreTake( xReadySemaphore, pdMS_TO_TICKS( ulWaitMs ) );
+                ulCurrentTime = pMqttContext->getTime();
+
+                if( ( TLS_FreeRTOS_Poll( pxNetworkContext ) == 0 ) &&
+                    ( prvTimeUntilKeepAliveMs( pMqttContext, ulCurrentTime ) > 0U ) )
+                {
+                    /* Woken by a stale signal, or the timeout expired. */
+                    continue;
+                }
+            }
+        }
+
         eMqttStatus = MQTT_ProcessLoop( pMqttContext );
         ulCurrentTime = pMqttContext->getTime();
     }
@@ -537,42 +770,84 @@ static MQTTStatus_t prvProcessLoopWithTimeout( MQTTContext_t * pMqttContext,
 
 /*-----------------------------------------------------------*/
 
-static void vCleanupOutgoingPublishAt( uint8_t ucIndex )
+static void vCleanupOutgoingPublishAt( uint16_t usIndex )
 {
-    configASSERT( outgoingPublishPackets != NULL );
-    configASSERT( ucIndex < MAX_OUTGOING_PUBLISHES );
+    PublishPackets_t * pxPublish;
+    uint16_t * pusLink;
 
-    /* Clear the outgoing publish packet. */
-    ( void ) memset( &( outgoingPublishPackets[ ucIndex ] ),
-                     0x00,
-                     sizeof( outgoingPublishPackets[ ucIndex ] ) );
+    configASSERT( usIndex < MAX_OUTGOING_PUBLISHES );
+
+    pxPublish = &( outgoingPublishPackets[ usIndex ] );
+
+    /* A packet identifier is only assigned once the publish is tracked. */
+    if( pxPublish->packetId != MQTT_PACKET_ID_INVALID )
+    {
+        /* Unlink from the hash bucket. */
+        pusLink = &( usOutgoingPublishBuckets[ pxPublish->packetId % OUTGOING_PUBLISH_BUCKETS ] );
+
+        while( *pusLink != ( usIndex + 1U ) )
+        {
+            configASSERT( *pusLink != 0U );
+            pusLink = &( outgoingPublishPackets[ *pusLink - 1U ].usNextLink );
+        }
+
+        *pusLink = pxPublish->usNextLink;
+
+        /* Unlink from the list of publishes in the order they were sent. */
+        if( pxPublish->usPrevSent != 0U )
+        {
+            outgoingPublishPackets[ pxPublish->usPrevSent - 1U ].usNextSent = pxPublish->usNextSent;
+        }
+        else
+        {
+            usOldestOutgoingPublish = pxPublish->usNextSent;
+        }
+
+        if( pxPublish->usNextSent != 0U )
+        {
+            outgoingPublishPackets[ pxPublish->usNextSent - 1U ].usPrevSent = pxPublish->usPrevSent;
+        }
+        else
+        {
+            usNewestOutgoingPublish = pxPublish->usPrevSent;
+        }
+    }
+
+    /* Clear the outgoing publish packet and return it to the free list. */
+    ( void ) memset( pxPublish, 0x00, sizeof( *pxPublish ) );
+    pxPublish->usNextLink = usFreeOutgoingPublishes;
+    usFreeOutgoingPublishes = usIndex + 1U;
 }
 
 /*-----------------------------------------------------------*/
 
 static void vCleanupOutgoingPublishes( void )
 {
-    configASSERT( outgoingPublishPackets != NULL );
-
     /* Clean up all the outgoing publish packets. */
     ( void ) memset( outgoingPublishPackets, 0x00, sizeof( outgoingPublishPackets ) );
+    ( void ) memset( usOutgoingPublishBuckets, 0x00, sizeof( usOutgoingPublishBuckets ) );
+    usFreeOutgoingPublishes = 0U;
+    usUsedOutgoingPublishes = 0U;
+    usOldestOutgoingPublish = 0U;
+    usNewestOutgoingPublish = 0U;
 }
 
 /*-----------------------------------------------------------*/
 
 static void vCleanupOutgoingPublishWithPacketID( uint16_t usPacketId )
 {
-    uint8_t ucIndex = 0;
+    uint16_t usLink;
 
-    configASSERT( outgoingPublishPackets != NULL );
     configASSERT( usPacketId != MQTT_PACKET_ID_INVALID );
 
-    /* Clean up all the saved outgoing publishes. */
-    for( ; ucIndex < MAX_OUTGOING_PUBLISHES; ucIndex++ )
+    /* Look the publish up in its packet identifier's hash bucket. */
+    for( usLink = usOutgoingPublishBuckets[ usPacketId % OUTGOING_PUBLISH_BUCKETS ];
+         usLink != 0U;
+         usLink = outgoingPublishPackets[ usLink - 1U ].usNextLink )
     {
-        if( outgoingPublishPackets[ ucIndex ].packetId == usPacketId )
+        if( outgoingPublishPackets[ usLink - 1U ].packetId == usPacketId )
         {
-            vCleanupOutgoingPublishAt( ucIndex );
+            vCleanupOutgoingPublishAt( usLink - 1U );
             LogInfo( ( "Cleaned up outgoing publish packet with packet id %u.\n\n",
                        usPacketId ) );
             break;
@@ -628,42 +903,39 @@ static BaseType_t xHandlePublishResend( MQTTContext_t * pxMqttContext )
 {
     BaseType_t xReturnStatus = pdTRUE;
     MQTTStatus_t xMQTTStatus = MQTTSuccess;
-    uint8_t ucIndex = 0U;
-
-    configASSERT( outgoingPublishPackets != NULL );
-
-    /* Resend all the QoS1 publishes still in the array. These are the
-     * publishes that haven't received a PUBACK. When a PUBACK is
-     * received, the publish is removed from the array. */
-    for( ucIndex = 0U; ucIndex < MAX_OUTGOING_PUBLISHES; ucIndex++ )
+    PublishPackets_t * pxPublish = NULL;
+    uint16_t usLink;
+    uint32_t ulResent = 0U;
+
+    /* Resend all the QoS1 publishes that haven't received a PUBACK, back to
+     * back and in the order they were first sent. When a PUBACK is received,
+     * the publish is removed from the list. */
+    for( usLink = usOldestOutgoingPublish; usLink != 0U; usLink = pxPublish->usNextSent )
     {
-        if( outgoingPublishPackets[ ucIndex ].packetId != MQTT_PACKET_ID_INVALID )
-        {
-            outgoingPublishPackets[ ucIndex ].pubInfo.dup = true;
+        pxPublish = &( outgoingPublishPackets[ usLink - 1U ] );
+        pxPublish->pubInfo.dup = true;
 
-            LogInfo( ( "Sending duplicate PUBLISH with packet id %u.",
-                       outgoingPublishPackets[ ucIndex ].packetId ) );
-            xMQTTStatus = MQTT_Publish( pxMqttContext,
-                                        &outgoingPublishPackets[ ucIndex ].pubInfo,
-                                        outgoingPublishPackets[ ucIndex ].packetId );
+        xMQTTStatus = MQTT_Publish( pxMqttContext,
+                                    &pxPublish->pubInfo,
+                                    pxPublish->packetId );
 
-            if( xMQTTStatus != MQTTSuccess )
-            {
-                LogError( ( "Sending duplicate PUBLISH for packet id %u "
-                            " failed with status %s.",
-                            outgoingPublishPackets[ ucIndex ].packetId,
-                            MQTT_Status_strerror( xMQTTStatus ) ) );
-                xReturnStatus = pdFAIL;
-                break;
-            }
-            else
-            {
-                LogInfo( ( "Sent duplicate PUBLISH successfully for packet id %u.\n\n",
-                           outgoingPublishPackets[ ucIndex ].packetId ) );
-            }
+        if( xMQTTStatus != MQTTSuccess )
+        {
+            LogError( ( "Sending duplicate PUBLISH for packet id %u "
+                        " failed with status %s.",
+                        pxPublish->packetId,
+                        MQTT_Status_strerror( xMQTTStatus ) ) );
+            xReturnStatus = pdFAIL;
+            break;
         }
+
+        LogDebug( ( "Sent duplicate PUBLISH for packet id %u.",
+                    pxPublish->packetId ) );
+        ulResent++;
     }
 
+    LogInfo( ( "Resent %lu unacked PUBLISH packets.\n\n", ulResent ) );
+
     return xReturnStatus;
 }
 
@@ -791,6 +1063,9 @@ BaseType_t xEstablishMqttSession( MQTTContext_t * pxMqttContext,
                 else
                 {
                     LogInfo( ( "MQTT connection successfully established with broker.\n\n" ) );
+
+                    /* Let the process loop sleep until the connection is readable. */
+                    prvEnableReadyWakeups( pxNetworkContext );
                 }
             }
         }
@@ -803,7 +1078,7 @@ BaseType_t xEstablishMqttSession( MQTTContext_t * pxMqttContext,
             xMqttSessionEstablished = true;
         }
 
-        if( xReturnStatus == pdFAIL )
+        if( xReturnStatus == pdPASS )
         {
             /* Check if session is present and if there are any outgoing publishes
              * that need to resend. This is only valid if the broker is
@@ -856,6 +1131,7 @@ BaseType_t xDisconnectMqttSession( MQTTContext_t * pxMqttContext,
     }
 
     /* Close the network connection.  */
+    xReadyWakeupsEnabled = pdFALSE;
     TLS_FreeRTOS_Disconnect( pxNetworkContext );
 
     return xReturnStatus;
@@ -991,7 +1267,7 @@ BaseType_t xPublishToTopic( MQTTContext_t * pxMqttContext,
 {
     BaseType_t xReturnStatus = pdPASS;
     MQTTStatus_t xMQTTStatus = MQTTSuccess;
-    uint8_t ucPublishIndex = MAX_OUTGOING_PUBLISHES;
+    uint16_t usPublishIndex = MAX_OUTGOING_PUBLISHES;
 
     configASSERT( pxMqttContext != NULL );
     configASSERT( pcTopicFilter != NULL );
@@ -1001,7 +1277,7 @@ BaseType_t xPublishToTopic( MQTTContext_t * pxMqttContext,
      * publishes are stored until a PUBACK is received. These messages are
      * stored for supporting a resend if a network connection is broken before
      * receiving a PUBACK. */
-    xReturnStatus = prvGetNextFreeIndexForOutgoingPublishes( &ucPublishIndex );
+    xReturnStatus = prvGetNextFreeIndexForOutgoingPublishes( &usPublishIndex );
 
     if( xReturnStatus == pdFAIL )
     {
@@ -1011,25 +1287,26 @@ BaseType_t xPublishToTopic( MQTTContext_t * pxMqttContext,
     {
         LogInfo( ( "the published payload:%.*s \r\n ", payloadLength, pcPayload ) );
         /* This example publishes to only one topic and uses QOS1. */
-        outgoingPublishPackets[ ucPublishIndex ].pubInfo.qos = MQTTQoS1;
-        outgoingPublishPackets[ ucPublishIndex ].pubInfo.pTopicName = pcTopicFilter;
-        outgoingPublishPackets[ ucPublishIndex ].pubInfo.topicNameLength = topicFilterLength;
-        outgoingPublishPackets[ ucPublishIndex ].pubInfo.pPayload = pcPayload;
-        outgoingPublishPackets[ ucPublishIndex ].pubInfo.payloadLength = payloadLength;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.qos = MQTTQoS1;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.pTopicName = pcTopicFilter;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.topicNameLength = topicFilterLength;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.pPayload = pcPayload;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.payloadLength = payloadLength;
 
         /* Get a new packet id. */
-        outgoingPublishPackets[ ucPublishIndex ].packetId = MQTT_GetPacketId( pxMqttContext );
+        outgoingPublishPackets[ usPublishIndex ].packetId = MQTT_GetPacketId( pxMqttContext );
+        prvTrackOutgoingPublishAt( usPublishIndex );
 
         /* Send PUBLISH packet. */
         xMQTTStatus = MQTT_Publish( pxMqttContext,
-                                    &outgoingPublishPackets[ ucPublishIndex ].pubInfo,
-                                    outgoingPublishPackets[ ucPublishIndex ].packetId );
+                                    &outgoingPublishPackets[ usPublishIndex ].pubInfo,
+                                    outgoingPublishPackets[ usPublishIndex ].packetId );
 
         if( xMQTTStatus != MQTTSuccess )
         {
             LogError( ( "Failed to send PUBLISH packet to broker with error = %s.",
                         MQTT_Status_strerror( xMQTTStatus ) ) );
-            vCleanupOutgoingPublishAt( ucPublishIndex );
+            vCleanupOutgoingPublishAt( usPublishIndex );
             xReturnStatus = pdFAIL;
         }
         else
@@ -1037,7 +1314,7 @@ BaseType_t xPublishToTopic( MQTTContext_t * pxMqttContext,
             LogInfo( ( "PUBLISH sent for topic %.*s to broker with packet ID %u.\n\n",
                        topicFilterLength,
                        pcTopicFilter,
-                       outgoingPublishPackets[ ucPublishIndex ].packetId ) );
+                       outgoingPublishPackets[ usPublishIndex ].packetId ) );
 
             /* Calling MQTT_ProcessLoop to process incoming publish echo, since
              * application subscribed to the same topic the broker will send
@@ -42,4 +42,38 @@
  */
 OtaPalMainStatus_t xValidateImageSignature( OtaFileContext_t* const pFileContext );
 
+/**
+ * @brief Start an incremental SHA-256 over an image as it is received.
+ * @param[out] ppvContext Opaque hash context, owned by the caller until passed
+ * to xValidateImageSignatureFromHash() or vImageSignatureHashAbort().
+ * @return pdTRUE if the context was created, pdFALSE otherwise.
+ */
+BaseType_t xImageSignatureHashStart( void ** ppvContext );
+
+/**
+ * @brief Add the next contiguous run of image bytes to an incremental hash.
+ * @param[in] pvContext Context returned by xImageSignatureHashStart().
+ * @param[in] pucData Image bytes that directly follow those already hashed.
+ * @param[in] xDataLength Number of bytes in pucData.
+ */
+void vImageSignatureHashUpdate( void * pvContext,
+                                const uint8_t * pucData,
+                                size_t xDataLength );
+
+/**
+ * @brief Finish an incremental hash and verify the image signature against it.
+ * The file itself is not read again. The context is freed in all cases.
+ * @param[in] pFileContext pointer to File context
+ * @param[in] pvContext Context that has been fed every byte of the image.
+ * @return OtaPalMainStatus_t , OtaPalSuccess if the signature of the image is valid.
+ */
+OtaPalMainStatus_t xValidateImageSignatureFromHash( OtaFileContext_t * const pFileContext,
+                                                    void * pvContext );
+
+/**
+ * @brief Release an incremental hash context without verifying anything.
+ * @param[in] pvContext Context returned by xImageSignatureHashStart(), may be NULL.
+ */
+void vImageSignatureHashAbort( void * pvContext );
+
 #endif
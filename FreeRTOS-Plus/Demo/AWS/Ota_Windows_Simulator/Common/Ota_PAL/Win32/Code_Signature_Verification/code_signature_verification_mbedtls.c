@@ -462,4 +462,63 @@ OtaPalMainStatus_t xValidateImageSignature(OtaFileContext_t* const C)
         }
 
     return eResult;
-}
\ No newline at end of file
+}
+
+/* Start hashing an image while it is being received. */
+BaseType_t xImageSignatureHashStart(void** ppvContext)
+{
+    return prvSignatureVerificationStart(ppvContext, ASYMMETRIC_ALGORITHM_ECDSA, HASH_ALGORITHM_SHA256);
+}
+
+/* Feed the next contiguous run of image bytes into the hash. */
+void vImageSignatureHashUpdate(void* pvContext,
+    const uint8_t* pucData,
+    size_t xDataLength)
+{
+    if (pvContext != NULL)
+    {
+        prvSignatureVerificationUpdate(pvContext, pucData, xDataLength);
+    }
+}
+
+/* Verify the signature of the specified file from a hash built while it was received. */
+OtaPalMainStatus_t xValidateImageSignatureFromHash(OtaFileContext_t* const C,
+    void* pvContext)
+{
+    OtaPalMainStatus_t eResult = OtaPalSuccess;
+    uint32_t ulSignerCertSize;
+    uint8_t* pucSignerCert;
+
+    LogInfo(("Finishing %s signature verification from streamed hash, file: %s\r\n",
+        OTA_JsonFileSignatureKey, (const char*)C->pCertFilepath));
+    pucSignerCert = otaPal_ReadAndAssumeCertificate((const uint8_t* const)C->pCertFilepath, &ulSignerCertSize);
+
+    if (pucSignerCert != NULL)
+    {
+        if (pdFALSE == prvSignatureVerificationFinal(pvContext,
+            (char*)pucSignerCert,
+            (size_t)ulSignerCertSize,
+            C->pSignature->data,
+            C->pSignature->size)) /*lint !e732 !e9034 Allow comparison in this context. */
+        {
+            eResult = OtaPalSignatureCheckFailed;
+        }
+
+        /* Free the signer certificate that we now own after prvReadAndAssumeCertificate(). */
+        vPortFree(pucSignerCert);
+    }
+    else
+    {
+        /* Only the context pointer is passed so that it is freed. */
+        (void)prvSignatureVerificationFinal(pvContext, NULL, 0, NULL, 0);
+        eResult = OtaPalBadSignerCert;
+    }
+
+    return eResult;
+}
+
+/* Release a streamed hash that will not be verified. */
+void vImageSignatureHashAbort(void* pvContext)
+{
+    (void)prvSignatureVerificationFinal(pvContext, NULL, 0, NULL, 0);
+}
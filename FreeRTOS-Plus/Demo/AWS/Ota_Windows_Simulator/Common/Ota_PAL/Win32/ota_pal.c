@@ -32,6 +32,7 @@
 /* Standard includes. */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
@@ -50,6 +51,17 @@ const char OTA_JsonFileSignatureKey[ OTA_FILE_SIG_KEY_STR_MAX_LENGTH ] = "sig-sh
 
 static OtaPalMainStatus_t otaPal_CheckFileSignature( OtaFileContext_t * const C );
 
+static int32_t prvWriteAt( FILE * pFile,
+                           uint32_t ulOffset,
+                           const uint8_t * pucData,
+                           uint32_t ulSize );
+static void prvPipelineStart( FILE * pFile );
+static void prvPipelineRelease( void );
+static int32_t prvPipelineFlush( void );
+static int32_t prvPipelineWrite( uint32_t ulOffset,
+                                 const uint8_t * pucData,
+                                 uint32_t ulSize );
+
 /*-----------------------------------------------------------*/
 
 static inline BaseType_t prvContextValidate( OtaFileContext_t* pFileContext )
@@ -61,6 +73,45 @@ static inline BaseType_t prvContextValidate( OtaFileContext_t* pFileContext )
 /* Used to set the high bit of Windows error codes for a negative return value. */
 #define OTA_PAL_INT16_NEGATIVE_MASK    ( 1 << 15 )
 
+/* Size of the buffer that coalesces in-order blocks into one large fwrite().
+ * Define it as 0 in ota_config.h to write every block straight to the file. */
+#ifndef otaconfigPAL_WRITE_BUFFER_SIZE
+    #define otaconfigPAL_WRITE_BUFFER_SIZE    ( 32UL * otaconfigFILE_BLOCK_SIZE )
+#endif
+
+/* Number of blocks that may arrive ahead of the contiguous prefix and be held
+ * in RAM until the gap before them is filled. A block arriving when all slots
+ * are in use is written straight to the file and the image is hashed by
+ * re-reading it at close instead. */
+#ifndef otaconfigPAL_MAX_HELD_BLOCKS
+    #define otaconfigPAL_MAX_HELD_BLOCKS      ( 4U * otaconfigMAX_NUM_BLOCKS_REQUEST )
+#endif
+
+/* A block received ahead of the contiguous prefix. */
+typedef struct HeldBlock
+{
+    uint8_t * pucData;
+    uint32_t ulOffset;
+    uint32_t ulSize;
+} HeldBlock_t;
+
+/* Write pipeline for the file being received. The OTA agent only ever has one
+ * file open, so a single static instance is enough. ulContiguous is the length
+ * of the prefix of the image that has been hashed; the last ulBuffered bytes
+ * of that prefix are still in pucWriteBuffer and not yet in the file. */
+typedef struct WritePipeline
+{
+    FILE * pFile;
+    void * pvHashContext;
+    uint8_t * pucWriteBuffer;
+    uint32_t ulBuffered;
+    uint32_t ulContiguous;
+    BaseType_t xHashComplete;
+    HeldBlock_t xHeld[ otaconfigPAL_MAX_HELD_BLOCKS ];
+} WritePipeline_t;
+
+static WritePipeline_t xPipeline;
+
 /* Attempt to create a new receive file for the file chunks as they come in. */
 
 OtaPalStatus_t otaPal_CreateFileForRx( OtaFileContext_t* const C )
@@ -77,6 +128,7 @@ OtaPalStatus_t otaPal_CreateFileForRx( OtaFileContext_t* const C )
 
             if ( C->pFile != NULL )
             {
+                prvPipelineStart( C->pFile );
                 mainErr = OtaPalSuccess;
                 LogInfo( ( "Receive file created.\r\n" ) );
             }
@@ -117,6 +169,12 @@ OtaPalStatus_t otaPal_Abort( OtaFileContext_t * const C )
         /* Close the OTA update file if it's open. */
         if( NULL != C->pFile )
         {
+            /* Nothing buffered is worth keeping for an aborted image. */
+            if( xPipeline.pFile == C->pFile )
+            {
+                prvPipelineRelease();
+            }
+
             lFileCloseResult = fclose( C->pFile ); /*lint !e482 !e586
                                                       * Context file handle state is managed by this API. */
             C->pFile = NULL;
@@ -148,7 +206,9 @@ OtaPalStatus_t otaPal_Abort( OtaFileContext_t * const C )
     return OTA_PAL_COMBINE_ERR(mainErr,subErr);
 }
 
-/* Write a block of data to the specified file. */
+/* Write a block of data to the specified file. Blocks that extend the
+ * contiguous prefix of the image are hashed and coalesced into large sequential
+ * writes; blocks that arrive early are held until the gap before them fills. */
 int16_t otaPal_WriteBlock( OtaFileContext_t * const C,
                            uint32_t ulOffset,
                            uint8_t * const pacData,
@@ -158,26 +218,22 @@ int16_t otaPal_WriteBlock( OtaFileContext_t * const C,
 
     if( prvContextValidate( C ) == pdTRUE )
     {
-        lResult = fseek( C->pFile, ulOffset, SEEK_SET ); /*lint !e586 !e713 !e9034
-                                                            * C standard library call is being used for portability. */
-
-        if( 0 == lResult )
+        if( xPipeline.pFile == C->pFile )
         {
-            lResult = fwrite( pacData, 1, ulBlockSize, C->pFile ); /*lint !e586 !e713 !e9034
-                                                                      * C standard library call is being used for portability. */
-
-            if( lResult < 0 )
-            {
-                LogError( ( "ERROR - fwrite failed\r\n" ) );
-                /* Mask to return a negative value. */
-                lResult = OTA_PAL_INT16_NEGATIVE_MASK | errno; /*lint !e40 !e9027
-                                                                * Errno is being used in accordance with host API documentation.
-                                                                * Bitmasking is being used to preserve host API error with library status code. */
-            }
+            lResult = prvPipelineWrite( ulOffset, pacData, ulBlockSize );
+        }
+        else if( prvWriteAt( C->pFile, ulOffset, pacData, ulBlockSize ) == 0 )
+        {
+            lResult = ( int32_t ) ulBlockSize;
         }
         else
         {
-            LogError( ( "ERROR - fseek failed\r\n" ) );
+            lResult = -1;
+        }
+
+        if( lResult < 0 )
+        {
+            LogError( ( "ERROR - Block write failed\r\n" ) );
             /* Mask to return a negative value. */
             lResult = OTA_PAL_INT16_NEGATIVE_MASK | errno; /*lint !e40 !e9027
                                                             * Errno is being used in accordance with host API documentation.
@@ -203,7 +259,13 @@ OtaPalStatus_t otaPal_CloseFile( OtaFileContext_t * const C )
 
     if( prvContextValidate( C ) == pdTRUE )
     {
-        if( C->pSignature != NULL )
+        if( ( xPipeline.pFile == C->pFile ) && ( prvPipelineFlush() != 0 ) )
+        {
+            LogError( ( "Failed to write buffered blocks to OTA update file.\r\n" ) );
+            mainErr = OtaPalFileClose;
+            subErr = errno;
+        }
+        else if( C->pSignature != NULL )
         {
             /* Verify the file signature, close the file and return the signature verification result. */
             mainErr = otaPal_CheckFileSignature( C );
@@ -214,6 +276,11 @@ OtaPalStatus_t otaPal_CloseFile( OtaFileContext_t * const C )
             mainErr = OtaPalSignatureCheckFailed;
         }
 
+        if( xPipeline.pFile == C->pFile )
+        {
+            prvPipelineRelease();
+        }
+
         /* Close the file. */
         lWindowsError = fclose( C->pFile ); /*lint !e482 !e586
                                                * C standard library call is being used for portability. */
@@ -259,7 +326,20 @@ static OtaPalMainStatus_t otaPal_CheckFileSignature( OtaFileContext_t* const C )
 
     if ( prvContextValidate( C ) == pdTRUE )
     {
-        eResult = xValidateImageSignature( C );
+        if( ( xPipeline.pFile == C->pFile ) &&
+            ( xPipeline.xHashComplete == pdTRUE ) &&
+            ( xPipeline.ulContiguous == C->fileSize ) )
+        {
+            /* Every byte was hashed in order as it arrived, so only the hash
+             * needs finishing. The context is consumed either way. */
+            eResult = xValidateImageSignatureFromHash( C, xPipeline.pvHashContext );
+            xPipeline.pvHashContext = NULL;
+        }
+        else
+        {
+            /* Blocks were written out of band, so hash the file as stored. */
+            eResult = xValidateImageSignature( C );
+        }
     }
     else
     {
@@ -271,6 +351,221 @@ static OtaPalMainStatus_t otaPal_CheckFileSignature( OtaFileContext_t* const C )
 
 /*-----------------------------------------------------------*/
 
+/* Write a run of bytes at the given file offset. Returns 0 on success. */
+static int32_t prvWriteAt( FILE * pFile,
+                           uint32_t ulOffset,
+                           const uint8_t * pucData,
+                           uint32_t ulSize )
+{
+    int32_t lResult;
+
+    lResult = fseek( pFile, ulOffset, SEEK_SET ); /*lint !e586 !e713
+                                                   * C standard library call is being used for portability. */
+
+    if( ( lResult == 0 ) &&
+        ( fwrite( pucData, 1, ulSize, pFile ) != ulSize ) ) /*lint !e586
+                                                              * C standard library call is being used for portability. */
+    {
+        lResult = -1;
+    }
+
+    return lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPipelineStart( FILE * pFile )
+{
+    /* Drop anything left over from a previous file. */
+    prvPipelineRelease();
+
+    xPipeline.pFile = pFile;
+    xPipeline.xHashComplete = xImageSignatureHashStart( &xPipeline.pvHashContext );
+
+    if( xPipeline.xHashComplete != pdTRUE )
+    {
+        xPipeline.pvHashContext = NULL;
+        LogWarn( ( "No memory for streamed image hash, the file will be re-read at close.\r\n" ) );
+    }
+
+    #if ( otaconfigPAL_WRITE_BUFFER_SIZE > 0 )
+        xPipeline.pucWriteBuffer = pvPortMalloc( otaconfigPAL_WRITE_BUFFER_SIZE ); /*lint !e9079 Allow conversion. */
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPipelineRelease( void )
+{
+    UBaseType_t uxIndex;
+
+    for( uxIndex = 0; uxIndex < otaconfigPAL_MAX_HELD_BLOCKS; uxIndex++ )
+    {
+        vPortFree( xPipeline.xHeld[ uxIndex ].pucData );
+    }
+
+    vImageSignatureHashAbort( xPipeline.pvHashContext );
+    vPortFree( xPipeline.pucWriteBuffer );
+    memset( &xPipeline, 0, sizeof( xPipeline ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Write the coalesced run and any held blocks to the file. Returns 0 on
+ * success. Held blocks are only still present at this point if the image
+ * has a gap, in which case the streamed hash cannot be used. */
+static int32_t prvPipelineFlush( void )
+{
+    int32_t lResult = 0;
+    UBaseType_t uxIndex;
+    HeldBlock_t * pxHeld;
+
+    if( xPipeline.ulBuffered > 0UL )
+    {
+        lResult = prvWriteAt( xPipeline.pFile,
+                              xPipeline.ulContiguous - xPipeline.ulBuffered,
+                              xPipeline.pucWriteBuffer,
+                              xPipeline.ulBuffered );
+        xPipeline.ulBuffered = 0;
+    }
+
+    for( uxIndex = 0; ( uxIndex < otaconfigPAL_MAX_HELD_BLOCKS ) && ( lResult == 0 ); uxIndex++ )
+    {
+        pxHeld = &xPipeline.xHeld[ uxIndex ];
+
+        if( pxHeld->pucData != NULL )
+        {
+            lResult = prvWriteAt( xPipeline.pFile, pxHeld->ulOffset, pxHeld->pucData, pxHeld->ulSize );
+            vPortFree( pxHeld->pucData );
+            pxHeld->pucData = NULL;
+            xPipeline.xHashComplete = pdFALSE;
+        }
+    }
+
+    return lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Append a run that starts exactly at the end of the contiguous prefix. */
+static int32_t prvPipelineAppend( const uint8_t * pucData,
+                                  uint32_t ulSize )
+{
+    int32_t lResult = 0;
+
+    vImageSignatureHashUpdate( xPipeline.pvHashContext, pucData, ulSize );
+
+    if( ( xPipeline.pucWriteBuffer != NULL ) &&
+        ( ( xPipeline.ulBuffered + ulSize ) > otaconfigPAL_WRITE_BUFFER_SIZE ) &&
+        ( xPipeline.ulBuffered > 0UL ) )
+    {
+        /* Only the coalesced run is written here; held blocks stay in RAM. */
+        lResult = prvWriteAt( xPipeline.pFile,
+                              xPipeline.ulContiguous - xPipeline.ulBuffered,
+                              xPipeline.pucWriteBuffer,
+                              xPipeline.ulBuffered );
+        xPipeline.ulBuffered = 0;
+    }
+
+    if( lResult == 0 )
+    {
+        if( ( xPipeline.pucWriteBuffer != NULL ) &&
+            ( ulSize <= otaconfigPAL_WRITE_BUFFER_SIZE ) )
+        {
+            memcpy( &xPipeline.pucWriteBuffer[ xPipeline.ulBuffered ], pucData, ulSize );
+            xPipeline.ulBuffered += ulSize;
+        }
+        else
+        {
+            lResult = prvWriteAt( xPipeline.pFile, xPipeline.ulContiguous, pucData, ulSize );
+        }
+
+        xPipeline.ulContiguous += ulSize;
+    }
+
+    return lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static int32_t prvPipelineWrite( uint32_t ulOffset,
+                                 const uint8_t * pucData,
+                                 uint32_t ulSize )
+{
+    int32_t lResult = 0;
+    UBaseType_t uxIndex;
+    UBaseType_t uxFree = otaconfigPAL_MAX_HELD_BLOCKS;
+    HeldBlock_t * pxHeld = NULL;
+    BaseType_t xProgress;
+
+    if( ulOffset == xPipeline.ulContiguous )
+    {
+        lResult = prvPipelineAppend( pucData, ulSize );
+
+        /* The new block may have closed the gap in front of held blocks. */
+        do
+        {
+            xProgress = pdFALSE;
+
+            for( uxIndex = 0; ( uxIndex < otaconfigPAL_MAX_HELD_BLOCKS ) && ( lResult == 0 ); uxIndex++ )
+            {
+                pxHeld = &xPipeline.xHeld[ uxIndex ];
+
+                if( ( pxHeld->pucData != NULL ) && ( pxHeld->ulOffset == xPipeline.ulContiguous ) )
+                {
+                    lResult = prvPipelineAppend( pxHeld->pucData, pxHeld->ulSize );
+                    vPortFree( pxHeld->pucData );
+                    pxHeld->pucData = NULL;
+                    xProgress = pdTRUE;
+                }
+            }
+        } while( ( xProgress == pdTRUE ) && ( lResult == 0 ) );
+    }
+    else
+    {
+        if( ulOffset > xPipeline.ulContiguous )
+        {
+            for( uxIndex = 0; uxIndex < otaconfigPAL_MAX_HELD_BLOCKS; uxIndex++ )
+            {
+                if( xPipeline.xHeld[ uxIndex ].pucData == NULL )
+                {
+                    uxFree = uxIndex;
+                    break;
+                }
+            }
+        }
+
+        if( uxFree < otaconfigPAL_MAX_HELD_BLOCKS )
+        {
+            pxHeld = &xPipeline.xHeld[ uxFree ];
+            pxHeld->pucData = pvPortMalloc( ulSize ); /*lint !e9079 Allow conversion. */
+        }
+
+        if( ( pxHeld != NULL ) && ( pxHeld->pucData != NULL ) )
+        {
+            memcpy( pxHeld->pucData, pucData, ulSize );
+            pxHeld->ulOffset = ulOffset;
+            pxHeld->ulSize = ulSize;
+        }
+        else
+        {
+            /* A rewrite of already hashed data, or no room to hold the block.
+             * Write it where it belongs and hash the stored file at close. */
+            xPipeline.xHashComplete = pdFALSE;
+            lResult = prvPipelineFlush();
+
+            if( lResult == 0 )
+            {
+                lResult = prvWriteAt( xPipeline.pFile, ulOffset, pucData, ulSize );
+            }
+        }
+    }
+
+    return ( lResult == 0 ) ? ( int32_t ) ulSize : -1;
+}
+
+/*-----------------------------------------------------------*/
+
 OtaPalStatus_t otaPal_ResetDevice( OtaFileContext_t* const pFileContext )
 {
     (void)pFileContext;
@@ -35,6 +35,739 @@
 /* Subscription manager header include. */
 #include "subscription_manager.h"
 
+#if ( SUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+
+/**
+ * @brief Index used for "no node" and "no subscription".
+ */
+    #define TRIE_NONE              ( ( int16_t ) -1 )
+
+/**
+ * @brief Index of the root node, which represents the empty prefix.
+ */
+    #define TRIE_ROOT              ( ( int16_t ) 0 )
+
+/**
+ * @brief Number of buckets in the hash table used to find the child of a node
+ * that matches a topic level.
+ */
+    #define TRIE_HASH_BUCKETS      ( SUBSCRIPTION_MANAGER_MAX_TRIE_NODES )
+
+/**
+ * @brief One level of one or more topic filters.
+ *
+ * Children that match a literal topic level are found through the hash table
+ * so that a level with hundreds of children (for example one per thing name)
+ * is searched in constant time.  The single-level and multi-level wildcard
+ * children are held separately because every topic level matches them.
+ */
+    typedef struct TopicTrieNode
+    {
+        const char * pcLevel;       /**< @brief Topic filter level, pointing into a subscribed topic filter string. */
+        uint16_t usLevelLength;     /**< @brief Length of pcLevel. */
+        int16_t sParent;            /**< @brief Parent node, or TRIE_NONE for the root and for free nodes. */
+        int16_t sNextInBucket;      /**< @brief Next node in the same hash bucket, or next free node. */
+        int16_t sPlusChild;         /**< @brief Child for a "+" level. */
+        int16_t sHashChild;         /**< @brief Child for a "#" level. */
+        uint16_t usLiteralChildren; /**< @brief Number of children found through the hash table. */
+        int16_t sFirstSubscription; /**< @brief First subscription whose topic filter ends at this node. */
+        bool xInUse;                /**< @brief Whether the node is part of the trie. */
+    } TopicTrieNode_t;
+
+/**
+ * @brief Nodes of the trie.  Node 0 is the root.
+ */
+    static TopicTrieNode_t xTrieNodes[ SUBSCRIPTION_MANAGER_MAX_TRIE_NODES ];
+
+/**
+ * @brief Heads of the hash chains used to look up literal children.
+ */
+    static int16_t sChildBuckets[ TRIE_HASH_BUCKETS ];
+
+/**
+ * @brief Head of the list of free nodes, chained through sNextInBucket.
+ */
+    static int16_t sFreeNode = TRIE_NONE;
+
+/**
+ * @brief Number of nodes in the free list.
+ */
+    static uint32_t ulFreeNodeCount = 0U;
+
+/**
+ * @brief For each element of the indexed subscription list, the next
+ * subscription ending at the same node, or the next free element.
+ */
+    static int16_t sNextSubscription[ SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS ];
+
+/**
+ * @brief Head of the list of free elements in the indexed subscription list.
+ */
+    static int16_t sFreeSubscription = TRIE_NONE;
+
+/**
+ * @brief The subscription list the trie indexes, or NULL before first use.
+ */
+    static SubscriptionElement_t * pxIndexedList = NULL;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the topic level that starts at *pusOffset.
+ *
+ * @param[in] pcString Topic name or topic filter.
+ * @param[in] usLength Length of pcString.
+ * @param[in,out] pusOffset Offset of the level on entry; offset of the next
+ * level on exit.
+ * @param[out] pusLevelLength Length of the level, which may be zero.
+ *
+ * @return `true` if this is the last level of the string.
+ */
+    static bool prvNextLevel( const char * pcString,
+                              uint16_t usLength,
+                              uint16_t * pusOffset,
+                              uint16_t * pusLevelLength )
+    {
+        uint16_t usEnd = *pusOffset;
+        bool xLast;
+
+        while( ( usEnd < usLength ) && ( pcString[ usEnd ] != '/' ) )
+        {
+            usEnd++;
+        }
+
+        *pusLevelLength = ( uint16_t ) ( usEnd - *pusOffset );
+        xLast = ( usEnd >= usLength ) ? true : false;
+        *pusOffset = ( uint16_t ) ( usEnd + 1U );
+
+        return xLast;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Hash a topic level together with the node it is a child of.
+ */
+    static uint32_t prvHashLevel( int16_t sParent,
+                                  const char * pcLevel,
+                                  uint16_t usLevelLength )
+    {
+        /* FNV-1a. */
+        uint32_t ulHash = 2166136261UL ^ ( uint32_t ) ( uint16_t ) sParent;
+        uint16_t usIndex;
+
+        for( usIndex = 0U; usIndex < usLevelLength; usIndex++ )
+        {
+            ulHash ^= ( uint8_t ) pcLevel[ usIndex ];
+            ulHash *= 16777619UL;
+        }
+
+        return ulHash % TRIE_HASH_BUCKETS;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the literal child of sParent for a topic level.
+ *
+ * @return The child, or TRIE_NONE.
+ */
+    static int16_t prvFindLiteralChild( int16_t sParent,
+                                        const char * pcLevel,
+                                        uint16_t usLevelLength )
+    {
+        int16_t sNode = sChildBuckets[ prvHashLevel( sParent, pcLevel, usLevelLength ) ];
+
+        while( sNode != TRIE_NONE )
+        {
+            if( ( xTrieNodes[ sNode ].sParent == sParent ) &&
+                ( xTrieNodes[ sNode ].usLevelLength == usLevelLength ) &&
+                ( memcmp( xTrieNodes[ sNode ].pcLevel, pcLevel, usLevelLength ) == 0 ) )
+            {
+                break;
+            }
+
+            sNode = xTrieNodes[ sNode ].sNextInBucket;
+        }
+
+        return sNode;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Take a node from the free list and attach it below sParent.
+ *
+ * @return The new node, or TRIE_NONE if the trie is full.
+ */
+    static int16_t prvCreateChild( int16_t sParent,
+                                   const char * pcLevel,
+                                   uint16_t usLevelLength )
+    {
+        int16_t sNode = sFreeNode;
+        uint32_t ulBucket;
+
+        if( sNode != TRIE_NONE )
+        {
+            sFreeNode = xTrieNodes[ sNode ].sNextInBucket;
+            ulFreeNodeCount--;
+
+            xTrieNodes[ sNode ].pcLevel = pcLevel;
+            xTrieNodes[ sNode ].usLevelLength = usLevelLength;
+            xTrieNodes[ sNode ].sParent = sParent;
+            xTrieNodes[ sNode ].sNextInBucket = TRIE_NONE;
+            xTrieNodes[ sNode ].sPlusChild = TRIE_NONE;
+            xTrieNodes[ sNode ].sHashChild = TRIE_NONE;
+            xTrieNodes[ sNode ].usLiteralChildren = 0U;
+            xTrieNodes[ sNode ].sFirstSubscription = TRIE_NONE;
+            xTrieNodes[ sNode ].xInUse = true;
+
+            if( ( usLevelLength == 1U ) && ( pcLevel[ 0 ] == '+' ) )
+            {
+                xTrieNodes[ sParent ].sPlusChild = sNode;
+            }
+            else if( ( usLevelLength == 1U ) && ( pcLevel[ 0 ] == '#' ) )
+            {
+                xTrieNodes[ sParent ].sHashChild = sNode;
+            }
+            else
+            {
+                ulBucket = prvHashLevel( sParent, pcLevel, usLevelLength );
+                xTrieNodes[ sNode ].sNextInBucket = sChildBuckets[ ulBucket ];
+                sChildBuckets[ ulBucket ] = sNode;
+                xTrieNodes[ sParent ].usLiteralChildren++;
+            }
+        }
+
+        return sNode;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the node at which a topic filter ends, optionally creating the
+ * missing nodes on the way.  Nothing is created unless all the missing nodes
+ * can be.
+ *
+ * @return The node, or TRIE_NONE if it does not exist and could not be created.
+ */
+    static int16_t prvFindFilterNode( const char * pcTopicFilter,
+                                      uint16_t usTopicFilterLength,
+                                      bool xCreate )
+    {
+        int16_t sNode = TRIE_ROOT, sChild;
+        uint16_t usOffset = 0U, usLevelLength, usIndex;
+        uint32_t ulLevelsToCreate;
+        const char * pcLevel;
+        bool xLast = false, xCapacityChecked = false;
+
+        while( ( xLast == false ) && ( sNode != TRIE_NONE ) )
+        {
+            pcLevel = &( pcTopicFilter[ usOffset ] );
+            xLast = prvNextLevel( pcTopicFilter, usTopicFilterLength, &usOffset, &usLevelLength );
+
+            if( ( usLevelLength == 1U ) && ( pcLevel[ 0 ] == '+' ) )
+            {
+                sChild = xTrieNodes[ sNode ].sPlusChild;
+            }
+            else if( ( usLevelLength == 1U ) && ( pcLevel[ 0 ] == '#' ) )
+            {
+                sChild = xTrieNodes[ sNode ].sHashChild;
+            }
+            else
+            {
+                sChild = prvFindLiteralChild( sNode, pcLevel, usLevelLength );
+            }
+
+            if( ( sChild == TRIE_NONE ) && ( xCreate == true ) )
+            {
+                if( xCapacityChecked == false )
+                {
+                    /* This level and every level after it need a new node. */
+                    ulLevelsToCreate = 1U;
+
+                    if( xLast == false )
+                    {
+                        ulLevelsToCreate++;
+
+                        for( usIndex = usOffset; usIndex < usTopicFilterLength; usIndex++ )
+                        {
+                            if( pcTopicFilter[ usIndex ] == '/' )
+                            {
+                                ulLevelsToCreate++;
+                            }
+                        }
+                    }
+
+                    xCapacityChecked = true;
+                    xCreate = ( ulLevelsToCreate <= ulFreeNodeCount ) ? true : false;
+                }
+
+                if( xCreate == true )
+                {
+                    sChild = prvCreateChild( sNode, pcLevel, usLevelLength );
+                }
+            }
+
+            sNode = sChild;
+        }
+
+        return sNode;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Return nodes that no longer lead to any subscription to the free
+ * list, working up from sNode towards the root.
+ */
+    static void prvPruneNode( int16_t sNode )
+    {
+        int16_t sParent, * psLink;
+        TopicTrieNode_t * pxNode;
+
+        while( sNode != TRIE_ROOT )
+        {
+            pxNode = &( xTrieNodes[ sNode ] );
+
+            if( ( pxNode->sFirstSubscription != TRIE_NONE ) ||
+                ( pxNode->sPlusChild != TRIE_NONE ) ||
+                ( pxNode->sHashChild != TRIE_NONE ) ||
+                ( pxNode->usLiteralChildren != 0U ) )
+            {
+                break;
+            }
+
+            sParent = pxNode->sParent;
+
+            if( xTrieNodes[ sParent ].sPlusChild == sNode )
+            {
+                xTrieNodes[ sParent ].sPlusChild = TRIE_NONE;
+            }
+            else if( xTrieNodes[ sParent ].sHashChild == sNode )
+            {
+                xTrieNodes[ sParent ].sHashChild = TRIE_NONE;
+            }
+            else
+            {
+                psLink = &( sChildBuckets[ prvHashLevel( sParent, pxNode->pcLevel, pxNode->usLevelLength ) ] );
+
+                while( *psLink != sNode )
+                {
+                    psLink = &( xTrieNodes[ *psLink ].sNextInBucket );
+                }
+
+                *psLink = pxNode->sNextInBucket;
+                xTrieNodes[ sParent ].usLiteralChildren--;
+            }
+
+            pxNode->xInUse = false;
+            pxNode->sParent = TRIE_NONE;
+            pxNode->sNextInBucket = sFreeNode;
+            sFreeNode = sNode;
+            ulFreeNodeCount++;
+
+            sNode = sParent;
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Add element lIndex of the indexed list to the trie.
+ *
+ * @return `false` if the trie is full.
+ */
+    static bool prvIndexSubscription( int32_t lIndex )
+    {
+        int16_t sNode;
+        bool xReturn = false;
+
+        sNode = prvFindFilterNode( pxIndexedList[ lIndex ].pcSubscriptionFilterString,
+                                   pxIndexedList[ lIndex ].usFilterStringLength,
+                                   true );
+
+        if( sNode != TRIE_NONE )
+        {
+            sNextSubscription[ lIndex ] = xTrieNodes[ sNode ].sFirstSubscription;
+            xTrieNodes[ sNode ].sFirstSubscription = ( int16_t ) lIndex;
+            xReturn = true;
+        }
+
+        return xReturn;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check whether the trie indexes pxSubscriptionList, building the
+ * index from the list's current contents the first time a list is seen.
+ *
+ * @return `true` if pxSubscriptionList is the indexed list.
+ */
+    static bool prvTrieIndexesList( SubscriptionElement_t * pxSubscriptionList )
+    {
+        int32_t lIndex;
+        bool xIndexed = true;
+
+        if( pxIndexedList == NULL )
+        {
+            memset( xTrieNodes, 0x00, sizeof( xTrieNodes ) );
+
+            for( lIndex = 0; lIndex < ( int32_t ) TRIE_HASH_BUCKETS; lIndex++ )
+            {
+                sChildBuckets[ lIndex ] = TRIE_NONE;
+            }
+
+            xTrieNodes[ TRIE_ROOT ].sParent = TRIE_NONE;
+            xTrieNodes[ TRIE_ROOT ].sPlusChild = TRIE_NONE;
+            xTrieNodes[ TRIE_ROOT ].sHashChild = TRIE_NONE;
+            xTrieNodes[ TRIE_ROOT ].sFirstSubscription = TRIE_NONE;
+            xTrieNodes[ TRIE_ROOT ].xInUse = true;
+
+            sFreeNode = TRIE_NONE;
+
+            for( lIndex = ( int32_t ) SUBSCRIPTION_MANAGER_MAX_TRIE_NODES - 1; lIndex > ( int32_t ) TRIE_ROOT; lIndex-- )
+            {
+                xTrieNodes[ lIndex ].sParent = TRIE_NONE;
+                xTrieNodes[ lIndex ].sNextInBucket = sFreeNode;
+                sFreeNode = ( int16_t ) lIndex;
+            }
+
+            ulFreeNodeCount = SUBSCRIPTION_MANAGER_MAX_TRIE_NODES - 1U;
+
+            pxIndexedList = pxSubscriptionList;
+            sFreeSubscription = TRIE_NONE;
+
+            /* Free elements are chained lowest index first so that new
+             * subscriptions fill the list from the start, as the linear
+             * implementation does. */
+            for( lIndex = ( int32_t ) SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS - 1; lIndex >= 0; lIndex-- )
+            {
+                if( pxSubscriptionList[ lIndex ].usFilterStringLength == 0U )
+                {
+                    sNextSubscription[ lIndex ] = sFreeSubscription;
+                    sFreeSubscription = ( int16_t ) lIndex;
+                }
+                else if( prvIndexSubscription( lIndex ) == false )
+                {
+                    LogError( ( "Topic trie is full. Increase SUBSCRIPTION_MANAGER_MAX_TRIE_NODES." ) );
+                    xIndexed = false;
+                }
+            }
+
+            if( xIndexed == false )
+            {
+                /* Use linear searches rather than an incomplete index. */
+                pxIndexedList = NULL;
+            }
+        }
+
+        return ( xIndexed == true ) && ( pxIndexedList == pxSubscriptionList );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Append the subscriptions ending at sNode to the match list.
+ */
+    static void prvCollectSubscriptions( int16_t sNode,
+                                         int16_t * psMatches,
+                                         uint32_t * pulMatchCount )
+    {
+        int16_t sSubscription = xTrieNodes[ sNode ].sFirstSubscription;
+
+        while( ( sSubscription != TRIE_NONE ) && ( *pulMatchCount < SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS ) )
+        {
+            psMatches[ *pulMatchCount ] = sSubscription;
+            ( *pulMatchCount )++;
+            sSubscription = sNextSubscription[ sSubscription ];
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Collect the subscriptions below sNode whose topic filters match the
+ * topic name from usOffset onwards.
+ *
+ * A topic that starts with '$' does not match a wildcard in the first level,
+ * and "a/#" matches "a" as well as every topic below it, as the MQTT
+ * specification requires and MQTT_MatchTopic() implements.
+ */
+    static void prvMatchTopic( int16_t sNode,
+                               const char * pcTopicName,
+                               uint16_t usTopicNameLength,
+                               uint16_t usOffset,
+                               bool xTopicEnded,
+                               int16_t * psMatches,
+                               uint32_t * pulMatchCount )
+    {
+        const char * pcLevel;
+        uint16_t usLevelLength, usNextOffset = usOffset;
+        int16_t sChild;
+        bool xLast, xWildcardsAllowed;
+
+        if( xTopicEnded == true )
+        {
+            prvCollectSubscriptions( sNode, psMatches, pulMatchCount );
+
+            if( xTrieNodes[ sNode ].sHashChild != TRIE_NONE )
+            {
+                prvCollectSubscriptions( xTrieNodes[ sNode ].sHashChild, psMatches, pulMatchCount );
+            }
+        }
+        else
+        {
+            xWildcardsAllowed = ( ( sNode != TRIE_ROOT ) || ( pcTopicName[ 0 ] != '$' ) ) ? true : false;
+
+            if( ( xWildcardsAllowed == true ) && ( xTrieNodes[ sNode ].sHashChild != TRIE_NONE ) )
+            {
+                prvCollectSubscriptions( xTrieNodes[ sNode ].sHashChild, psMatches, pulMatchCount );
+            }
+
+            pcLevel = &( pcTopicName[ usOffset ] );
+            xLast = prvNextLevel( pcTopicName, usTopicNameLength, &usNextOffset, &usLevelLength );
+
+            sChild = prvFindLiteralChild( sNode, pcLevel, usLevelLength );
+
+            if( sChild != TRIE_NONE )
+            {
+                prvMatchTopic( sChild, pcTopicName, usTopicNameLength, usNextOffset, xLast, psMatches, pulMatchCount );
+            }
+
+            if( ( xWildcardsAllowed == true ) && ( xTrieNodes[ sNode ].sPlusChild != TRIE_NONE ) )
+            {
+                prvMatchTopic( xTrieNodes[ sNode ].sPlusChild, pcTopicName, usTopicNameLength, usNextOffset, xLast, psMatches, pulMatchCount );
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    static bool prvTrieAddSubscription( const char * pcTopicFilterString,
+                                        uint16_t usTopicFilterLength,
+                                        IncomingPubCallback_t pxIncomingPublishCallback,
+                                        void * pvIncomingPublishCallbackContext )
+    {
+        int16_t sNode, sSubscription;
+        int32_t lIndex;
+        bool xReturnStatus = false;
+
+        /* If the same context-callback pair is already subscribed to this
+         * topic filter, don't do anything. */
+        sNode = prvFindFilterNode( pcTopicFilterString, usTopicFilterLength, false );
+        sSubscription = ( sNode != TRIE_NONE ) ? xTrieNodes[ sNode ].sFirstSubscription : TRIE_NONE;
+
+        while( sSubscription != TRIE_NONE )
+        {
+            if( ( pxIndexedList[ sSubscription ].pxIncomingPublishCallback == pxIncomingPublishCallback ) &&
+                ( pxIndexedList[ sSubscription ].pvIncomingPublishCallbackContext == pvIncomingPublishCallbackContext ) )
+            {
+                LogWarn( ( "Subscription already exists.\n" ) );
+                xReturnStatus = true;
+                break;
+            }
+
+            sSubscription = sNextSubscription[ sSubscription ];
+        }
+
+        if( ( xReturnStatus == false ) && ( sFreeSubscription != TRIE_NONE ) )
+        {
+            lIndex = sFreeSubscription;
+
+            pxIndexedList[ lIndex ].pcSubscriptionFilterString = pcTopicFilterString;
+            pxIndexedList[ lIndex ].usFilterStringLength = usTopicFilterLength;
+            pxIndexedList[ lIndex ].pxIncomingPublishCallback = pxIncomingPublishCallback;
+            pxIndexedList[ lIndex ].pvIncomingPublishCallbackContext = pvIncomingPublishCallbackContext;
+
+            if( prvIndexSubscription( lIndex ) == true )
+            {
+                sFreeSubscription = sNextSubscription[ lIndex ];
+                xReturnStatus = true;
+            }
+            else
+            {
+                LogError( ( "Topic trie is full. Increase SUBSCRIPTION_MANAGER_MAX_TRIE_NODES." ) );
+                memset( &( pxIndexedList[ lIndex ] ), 0x00, sizeof( SubscriptionElement_t ) );
+            }
+        }
+
+        return xReturnStatus;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvTrieRemoveSubscription( const char * pcTopicFilterString,
+                                           uint16_t usTopicFilterLength )
+    {
+        int16_t sNode, sSubscription, sNext;
+
+        sNode = prvFindFilterNode( pcTopicFilterString, usTopicFilterLength, false );
+
+        if( sNode != TRIE_NONE )
+        {
+            sSubscription = xTrieNodes[ sNode ].sFirstSubscription;
+
+            while( sSubscription != TRIE_NONE )
+            {
+                sNext = sNextSubscription[ sSubscription ];
+
+                memset( &( pxIndexedList[ sSubscription ] ), 0x00, sizeof( SubscriptionElement_t ) );
+                sNextSubscription[ sSubscription ] = sFreeSubscription;
+                sFreeSubscription = sSubscription;
+
+                sSubscription = sNext;
+            }
+
+            xTrieNodes[ sNode ].sFirstSubscription = TRIE_NONE;
+            prvPruneNode( sNode );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    static bool prvTrieHandleIncomingPublishes( MQTTPublishInfo_t * pxPublishInfo )
+    {
+        int16_t sMatches[ SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS ];
+        int16_t sKey;
+        uint32_t ulMatchCount = 0U, ulIndex, ulInsert;
+        bool publishHandled = false;
+
+        if( ( pxPublishInfo->pTopicName != NULL ) && ( pxPublishInfo->topicNameLength > 0U ) )
+        {
+            prvMatchTopic( TRIE_ROOT, pxPublishInfo->pTopicName, pxPublishInfo->topicNameLength,
+                           0U, false, sMatches, &ulMatchCount );
+        }
+
+        /* Invoke the callbacks in list order, as the linear implementation
+         * does.  Usually only one or two subscriptions match. */
+        for( ulIndex = 1U; ulIndex < ulMatchCount; ulIndex++ )
+        {
+            sKey = sMatches[ ulIndex ];
+
+            for( ulInsert = ulIndex; ( ulInsert > 0U ) && ( sMatches[ ulInsert - 1U ] > sKey ); ulInsert-- )
+            {
+                sMatches[ ulInsert ] = sMatches[ ulInsert - 1U ];
+            }
+
+            sMatches[ ulInsert ] = sKey;
+        }
+
+        for( ulIndex = 0U; ulIndex < ulMatchCount; ulIndex++ )
+        {
+            /* A callback may have removed a later subscription. */
+            if( pxIndexedList[ sMatches[ ulIndex ] ].usFilterStringLength > 0U )
+            {
+                pxIndexedList[ sMatches[ ulIndex ] ].pxIncomingPublishCallback( pxIndexedList[ sMatches[ ulIndex ] ].pvIncomingPublishCallbackContext,
+                                                                                pxPublishInfo );
+                publishHandled = true;
+            }
+        }
+
+        return publishHandled;
+    }
+
+#endif /* SUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 */
+
+/*-----------------------------------------------------------*/
+
+static bool prvLinearAddSubscription( SubscriptionElement_t * pxSubscriptionList,
+                                      const char * pcTopicFilterString,
+                                      uint16_t usTopicFilterLength,
+                                      IncomingPubCallback_t pxIncomingPublishCallback,
+                                      void * pvIncomingPublishCallbackContext )
+{
+    int32_t lIndex = 0;
+    size_t xAvailableIndex = SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS;
+    bool xReturnStatus = false;
+
+    /* Start at end of array, so that we will insert at the first available index.
+     * Scans backwards to find duplicates. */
+    for( lIndex = ( int32_t ) SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS - 1; lIndex >= 0; lIndex-- )
+    {
+        if( pxSubscriptionList[ lIndex ].usFilterStringLength == 0 )
+        {
+            xAvailableIndex = lIndex;
+        }
+        else if( ( pxSubscriptionList[ lIndex ].usFilterStringLength == usTopicFilterLength ) &&
+                 ( strncmp( pcTopicFilterString, pxSubscriptionList[ lIndex ].pcSubscriptionFilterString, ( size_t ) usTopicFilterLength ) == 0 ) )
+        {
+            /* If a subscription already exists, don't do anything. */
+            if( ( pxSubscriptionList[ lIndex ].pxIncomingPublishCallback == pxIncomingPublishCallback ) &&
+                ( pxSubscriptionList[ lIndex ].pvIncomingPublishCallbackContext == pvIncomingPublishCallbackContext ) )
+            {
+                LogWarn( ( "Subscription already exists.\n" ) );
+                xAvailableIndex = SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS;
+                xReturnStatus = true;
+                break;
+            }
+        }
+    }
+
+    if( xAvailableIndex < SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS )
+    {
+        pxSubscriptionList[ xAvailableIndex ].pcSubscriptionFilterString = pcTopicFilterString;
+        pxSubscriptionList[ xAvailableIndex ].usFilterStringLength = usTopicFilterLength;
+        pxSubscriptionList[ xAvailableIndex ].pxIncomingPublishCallback = pxIncomingPublishCallback;
+        pxSubscriptionList[ xAvailableIndex ].pvIncomingPublishCallbackContext = pvIncomingPublishCallbackContext;
+        xReturnStatus = true;
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvLinearRemoveSubscription( SubscriptionElement_t * pxSubscriptionList,
+                                         const char * pcTopicFilterString,
+                                         uint16_t usTopicFilterLength )
+{
+    int32_t lIndex = 0;
+
+    for( lIndex = 0; lIndex < SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; lIndex++ )
+    {
+        if( pxSubscriptionList[ lIndex ].usFilterStringLength == usTopicFilterLength )
+        {
+            if( strncmp( pxSubscriptionList[ lIndex ].pcSubscriptionFilterString, pcTopicFilterString, usTopicFilterLength ) == 0 )
+            {
+                memset( &( pxSubscriptionList[ lIndex ] ), 0x00, sizeof( SubscriptionElement_t ) );
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvLinearHandleIncomingPublishes( SubscriptionElement_t * pxSubscriptionList,
+                                              MQTTPublishInfo_t * pxPublishInfo )
+{
+    int32_t lIndex = 0;
+    bool isMatched = false, publishHandled = false;
+
+    for( lIndex = 0; lIndex < SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; lIndex++ )
+    {
+        if( pxSubscriptionList[ lIndex ].usFilterStringLength > 0 )
+        {
+            MQTT_MatchTopic( pxPublishInfo->pTopicName,
+                             pxPublishInfo->topicNameLength,
+                             pxSubscriptionList[ lIndex ].pcSubscriptionFilterString,
+                             pxSubscriptionList[ lIndex ].usFilterStringLength,
+                             &isMatched );
+
+            if( isMatched == true )
+            {
+                pxSubscriptionList[ lIndex ].pxIncomingPublishCallback( pxSubscriptionList[ lIndex ].pvIncomingPublishCallbackContext,
+                                                                        pxPublishInfo );
+                publishHandled = true;
+            }
+        }
+    }
+
+    return publishHandled;
+}
+
+/*-----------------------------------------------------------*/
 
 bool addSubscription( SubscriptionElement_t * pxSubscriptionList,
                       const char * pcTopicFilterString,
@@ -42,8 +775,6 @@ bool addSubscription( SubscriptionElement_t * pxSubscriptionList,
                       IncomingPubCallback_t pxIncomingPublishCallback,
                       void * pvIncomingPublishCallbackContext )
 {
-    int32_t lIndex = 0;
-    size_t xAvailableIndex = SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS;
     bool xReturnStatus = false;
 
     if( ( pxSubscriptionList == NULL ) ||
@@ -58,39 +789,23 @@ bool addSubscription( SubscriptionElement_t * pxSubscriptionList,
                     ( unsigned int ) usTopicFilterLength,
                     pxIncomingPublishCallback ) );
     }
-    else
-    {
-        /* Start at end of array, so that we will insert at the first available index.
-         * Scans backwards to find duplicates. */
-        for( lIndex = ( int32_t ) SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS - 1; lIndex >= 0; lIndex-- )
-        {
-            if( pxSubscriptionList[ lIndex ].usFilterStringLength == 0 )
-            {
-                xAvailableIndex = lIndex;
-            }
-            else if( ( pxSubscriptionList[ lIndex ].usFilterStringLength == usTopicFilterLength ) &&
-                     ( strncmp( pcTopicFilterString, pxSubscriptionList[ lIndex ].pcSubscriptionFilterString, ( size_t ) usTopicFilterLength ) == 0 ) )
-            {
-                /* If a subscription already exists, don't do anything. */
-                if( ( pxSubscriptionList[ lIndex ].pxIncomingPublishCallback == pxIncomingPublishCallback ) &&
-                    ( pxSubscriptionList[ lIndex ].pvIncomingPublishCallbackContext == pvIncomingPublishCallbackContext ) )
-                {
-                    LogWarn( ( "Subscription already exists.\n" ) );
-                    xAvailableIndex = SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS;
-                    xReturnStatus = true;
-                    break;
-                }
-            }
-        }
 
-        if( xAvailableIndex < SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS )
+    #if ( SUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+        else if( prvTrieIndexesList( pxSubscriptionList ) == true )
         {
-            pxSubscriptionList[ xAvailableIndex ].pcSubscriptionFilterString = pcTopicFilterString;
-            pxSubscriptionList[ xAvailableIndex ].usFilterStringLength = usTopicFilterLength;
-            pxSubscriptionList[ xAvailableIndex ].pxIncomingPublishCallback = pxIncomingPublishCallback;
-            pxSubscriptionList[ xAvailableIndex ].pvIncomingPublishCallbackContext = pvIncomingPublishCallbackContext;
-            xReturnStatus = true;
+            xReturnStatus = prvTrieAddSubscription( pcTopicFilterString,
+                                                    usTopicFilterLength,
+                                                    pxIncomingPublishCallback,
+                                                    pvIncomingPublishCallbackContext );
         }
+    #endif
+    else
+    {
+        xReturnStatus = prvLinearAddSubscription( pxSubscriptionList,
+                                                  pcTopicFilterString,
+                                                  usTopicFilterLength,
+                                                  pxIncomingPublishCallback,
+                                                  pvIncomingPublishCallbackContext );
     }
 
     return xReturnStatus;
@@ -102,8 +817,6 @@ void removeSubscription( SubscriptionElement_t * pxSubscriptionList,
                          const char * pcTopicFilterString,
                          uint16_t usTopicFilterLength )
 {
-    int32_t lIndex = 0;
-
     if( ( pxSubscriptionList == NULL ) ||
         ( pcTopicFilterString == NULL ) ||
         ( usTopicFilterLength == 0U ) )
@@ -114,18 +827,16 @@ void removeSubscription( SubscriptionElement_t * pxSubscriptionList,
                     pcTopicFilterString,
                     ( unsigned int ) usTopicFilterLength ) );
     }
-    else
-    {
-        for( lIndex = 0; lIndex < SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; lIndex++ )
+
+    #if ( SUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+        else if( prvTrieIndexesList( pxSubscriptionList ) == true )
         {
-            if( pxSubscriptionList[ lIndex ].usFilterStringLength == usTopicFilterLength )
-            {
-                if( strncmp( pxSubscriptionList[ lIndex ].pcSubscriptionFilterString, pcTopicFilterString, usTopicFilterLength ) == 0 )
-                {
-                    memset( &( pxSubscriptionList[ lIndex ] ), 0x00, sizeof( SubscriptionElement_t ) );
-                }
-            }
+            prvTrieRemoveSubscription( pcTopicFilterString, usTopicFilterLength );
         }
+    #endif
+    else
+    {
+        prvLinearRemoveSubscription( pxSubscriptionList, pcTopicFilterString, usTopicFilterLength );
     }
 }
 
@@ -134,8 +845,7 @@ void removeSubscription( SubscriptionElement_t * pxSubscriptionList,
 bool handleIncomingPublishes( SubscriptionElement_t * pxSubscriptionList,
                               MQTTPublishInfo_t * pxPublishInfo )
 {
-    int32_t lIndex = 0;
-    bool isMatched = false, publishHandled = false;
+    bool publishHandled = false;
 
     if( ( pxSubscriptionList == NULL ) ||
         ( pxPublishInfo == NULL ) )
@@ -144,26 +854,16 @@ bool handleIncomingPublishes( SubscriptionElement_t * pxSubscriptionList,
                     pxSubscriptionList,
                     pxPublishInfo ) );
     }
-    else
-    {
-        for( lIndex = 0; lIndex < SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; lIndex++ )
-        {
-            if( pxSubscriptionList[ lIndex ].usFilterStringLength > 0 )
-            {
-                MQTT_MatchTopic( pxPublishInfo->pTopicName,
-                                 pxPublishInfo->topicNameLength,
-                                 pxSubscriptionList[ lIndex ].pcSubscriptionFilterString,
-                                 pxSubscriptionList[ lIndex ].usFilterStringLength,
-                                 &isMatched );
 
-                if( isMatched == true )
-                {
-                    pxSubscriptionList[ lIndex ].pxIncomingPublishCallback( pxSubscriptionList[ lIndex ].pvIncomingPublishCallbackContext,
-                                                                            pxPublishInfo );
-                    publishHandled = true;
-                }
-            }
+    #if ( SUBSCRIPTION_MANAGER_USE_TOPIC_TRIE == 1 )
+        else if( prvTrieIndexesList( pxSubscriptionList ) == true )
+        {
+            publishHandled = prvTrieHandleIncomingPublishes( pxPublishInfo );
         }
+    #endif
+    else
+    {
+        publishHandled = prvLinearHandleIncomingPublishes( pxSubscriptionList, pxPublishInfo );
     }
 
     return publishHandled;
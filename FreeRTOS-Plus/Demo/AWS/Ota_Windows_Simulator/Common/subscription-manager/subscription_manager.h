@@ -70,6 +70,28 @@
     #define SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS    10U
 #endif
 
+/**
+ * @brief Set to 1 to index the subscription list with a trie of topic filter
+ * levels, so that the cost of dispatching an incoming publish depends on the
+ * number of levels in its topic rather than on the number of subscriptions.
+ * Set to 0 to match every publish against every subscription in turn.
+ *
+ * The index is kept for one subscription list, the first one passed to this
+ * module.  Any other list is searched linearly.
+ */
+#ifndef SUBSCRIPTION_MANAGER_USE_TOPIC_TRIE
+    #define SUBSCRIPTION_MANAGER_USE_TOPIC_TRIE    1
+#endif
+
+/**
+ * @brief Maximum number of topic filter levels stored in the trie.  Topic
+ * filters that share leading levels share nodes.  Adding a subscription fails
+ * if the trie is full.
+ */
+#ifndef SUBSCRIPTION_MANAGER_MAX_TRIE_NODES
+    #define SUBSCRIPTION_MANAGER_MAX_TRIE_NODES    ( SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS * 8U )
+#endif
+
 /**
  * @brief Callback function called when receiving a publish.
  *
@@ -47,9 +47,22 @@
 	#define ARRAY_SIZE(x) ( BaseType_t ) (sizeof( x ) / sizeof( x )[ 0 ] )
 #endif
 
+/* Round up to the alignment of the port. */
+#define tcpALIGN( uxSize )		( ( ( size_t ) ( uxSize ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+#if( ipconfigTCP_SERVER_CLIENT_SLOTS > 0 )
+	#define tcpARENA_SIZE		tcpALIGN( ipconfigTCP_SERVER_CLIENT_ARENA_SIZE )
+
+	/* The arena of a client slot follows the client structure. */
+	#define tcpCLIENT_ARENA( pxClient )		( ( ( uint8_t * ) ( pxClient ) ) + ( pxClient )->pxParent->uxClientSize )
+#endif
+
 
 static void prvReceiveNewClient( TCPServer_t *pxServer, BaseType_t xIndex, Socket_t xNexSocket );
-static char *strnew( const char *pcString );
+/* Return pdTRUE if a client has a socket event, or has been idle for too long. */
+static BaseType_t prvClientNeedsWork( TCPServer_t *pxServer, TCPClient_t *pxClient, TickType_t xNow );
+static TCPClient_t *prvAllocateClient( TCPServer_t *pxServer, BaseType_t xSize );
+static void prvReleaseClient( TCPServer_t *pxServer, TCPClient_t *pxClient );
 /* Remove slashes at the end of a path. */
 static void prvRemoveSlash( char *pcDir );
 
@@ -57,6 +70,7 @@ TCPServer_t *FreeRTOS_CreateTCPServer( const struct xSERVER_CONFIG *pxConfigs, B
 {
 TCPServer_t *pxServer;
 SocketSet_t xSocketSet;
+char *pcRootDir;
 
 	/* Create a new server.
 	xPort / xPortAlt : Make the service available on 1 or 2 public port numbers. */
@@ -65,19 +79,74 @@ SocketSet_t xSocketSet;
 	if( xSocketSet != NULL )
 	{
 	BaseType_t xSize;
+	BaseType_t xIndex;
+	BaseType_t xRootDirOffset;
+	#if( ipconfigTCP_SERVER_CLIENT_SLOTS > 0 )
+		BaseType_t xSlotOffset;
+		size_t uxClientSize = 0u;
+		size_t uxSlotSize;
+	#endif
 
 		xSize = sizeof( *pxServer ) - sizeof( pxServer->xServers ) + xCount * sizeof( pxServer->xServers[ 0 ] );
 
+		/* The root directories are stored behind the server, so they don't
+		need allocations of their own. */
+		xRootDirOffset = xSize;
+		for( xIndex = 0; xIndex < xCount; xIndex++ )
+		{
+			if( pxConfigs[ xIndex ].xPortNumber > 0 )
+			{
+				xSize += strlen( pxConfigs[ xIndex ].pcRootDir ) + 1;
+			}
+		}
+
+		#if( ipconfigTCP_SERVER_CLIENT_SLOTS > 0 )
+		{
+			/* Each slot can hold any type of client. */
+			#if( ipconfigUSE_HTTP != 0 )
+			{
+				uxClientSize = sizeof( HTTPClient_t );
+			}
+			#endif
+			#if( ipconfigUSE_FTP != 0 )
+			{
+				if( uxClientSize < sizeof( FTPClient_t ) )
+				{
+					uxClientSize = sizeof( FTPClient_t );
+				}
+			}
+			#endif
+			uxClientSize = tcpALIGN( uxClientSize );
+			uxSlotSize = uxClientSize + tcpARENA_SIZE;
+			xSlotOffset = ( BaseType_t ) tcpALIGN( xSize );
+			xSize = xSlotOffset + ( BaseType_t ) ( ipconfigTCP_SERVER_CLIENT_SLOTS * uxSlotSize );
+		}
+		#endif
+
 		pxServer = ( TCPServer_t * ) pvPortMallocLarge( xSize );
 		if( pxServer != NULL )
 		{
 		struct freertos_sockaddr xAddress;
 		BaseType_t xNoTimeout = 0;
-		BaseType_t xIndex;
 
 			memset( pxServer, '\0', xSize );
 			pxServer->xServerCount = xCount;
 			pxServer->xSocketSet = xSocketSet;
+			pcRootDir = ( ( char * ) pxServer ) + xRootDirOffset;
+
+			#if( ipconfigTCP_SERVER_CLIENT_SLOTS > 0 )
+			{
+			TCPClient_t *pxSlot;
+
+				pxServer->uxClientSize = uxClientSize;
+				for( xIndex = 0; xIndex < ipconfigTCP_SERVER_CLIENT_SLOTS; xIndex++ )
+				{
+					pxSlot = ( TCPClient_t * ) ( ( ( uint8_t * ) pxServer ) + xSlotOffset + ( size_t ) xIndex * uxSlotSize );
+					pxSlot->pxNextClient = pxServer->pxFreeClients;
+					pxServer->pxFreeClients = pxSlot;
+				}
+			}
+			#endif
 
 			for( xIndex = 0; xIndex < xCount; xIndex++ )
 			{
@@ -134,8 +203,10 @@ SocketSet_t xSocketSet;
 						FreeRTOS_FD_SET( xSocket, xSocketSet, eSELECT_READ|eSELECT_EXCEPT );
 						pxServer->xServers[ xIndex ].xSocket = xSocket;
 						pxServer->xServers[ xIndex ].eType = pxConfigs[ xIndex ].eType;
-						pxServer->xServers[ xIndex ].pcRootDir = strnew( pxConfigs[ xIndex ].pcRootDir );
-						prvRemoveSlash( ( char * ) pxServer->xServers[ xIndex ].pcRootDir );
+						strcpy( pcRootDir, pxConfigs[ xIndex ].pcRootDir );
+						prvRemoveSlash( pcRootDir );
+						pxServer->xServers[ xIndex ].pcRootDir = pcRootDir;
+						pcRootDir += strlen( pxConfigs[ xIndex ].pcRootDir ) + 1;
 					}
 				}
 			}
@@ -193,7 +264,7 @@ const char *pcType = "Unknown";
 	/* Malloc enough space for a new HTTP-client */
 	if( xSize )
 	{
-		pxClient = ( TCPClient_t* ) pvPortMallocLarge( xSize );
+		pxClient = prvAllocateClient( pxServer, xSize );
 	}
 
 	if( pxClient != NULL )
@@ -208,6 +279,9 @@ const char *pcType = "Unknown";
 		pxClient->pxNextClient = pxServer->pxClients;
 		pxClient->fWorkFunction = fWorkFunc;
 		pxClient->fDeleteFunction = fDeleteFunc;
+		/* Make sure that the work function is called in the next cycle,
+		e.g. to send the FTP greeting. */
+		pxClient->xLastWorkTime = xTaskGetTickCount() - pdMS_TO_TICKS( ipconfigTCP_SERVER_IDLE_WORK_MS );
 		pxServer->pxClients = pxClient;
 
 		FreeRTOS_FD_SET( xNexSocket, pxServer->xSocketSet, eSELECT_READ|eSELECT_EXCEPT );
@@ -215,11 +289,10 @@ const char *pcType = "Unknown";
 	else
 	{
 		pcType = "closed";
-		FreeRTOS_closesocket( xNexSocket );
 	}
 	{
 	struct freertos_sockaddr xRemoteAddress;
-		FreeRTOS_GetRemoteAddress( pxClient->xSocket, &xRemoteAddress );
+		FreeRTOS_GetRemoteAddress( xNexSocket, &xRemoteAddress );
 		#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
 		{
 			FreeRTOS_printf( ( "TPC-server: new %s client %xip\n", pcType, (unsigned)FreeRTOS_ntohl( xRemoteAddress.sin_address.ulIP_IPv4 ) ) );
@@ -231,16 +304,58 @@ const char *pcType = "Unknown";
 		#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
 	}
 
+	if( pxClient == NULL )
+	{
+		FreeRTOS_closesocket( xNexSocket );
+	}
+
 	/* Remove compiler warnings in case FreeRTOS_printf() is not used. */
 	( void ) pcType;
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvClientNeedsWork( TCPServer_t *pxServer, TCPClient_t *pxClient, TickType_t xNow )
+{
+BaseType_t xResult = pdFALSE;
+
+	/* The socket set is level-triggered: a socket stays readable or writable
+	until the work function has handled it. */
+	if( FreeRTOS_FD_ISSET( pxClient->xSocket, pxServer->xSocketSet ) != 0 )
+	{
+		xResult = pdTRUE;
+	}
+
+	#if( ipconfigUSE_FTP != 0 )
+	{
+		if( pxClient->eType == eSERVER_FTP )
+		{
+		FTPClient_t *pxFTPClient = ( FTPClient_t * ) pxClient;
+
+			/* The data connection is in the same socket set. */
+			if( ( pxFTPClient->xTransferSocket != FREERTOS_NO_SOCKET ) &&
+				( FreeRTOS_FD_ISSET( pxFTPClient->xTransferSocket, pxServer->xSocketSet ) != 0 ) )
+			{
+				xResult = pdTRUE;
+			}
+		}
+	}
+	#endif /* ipconfigUSE_FTP != 0 */
+
+	if( ( xNow - pxClient->xLastWorkTime ) >= pdMS_TO_TICKS( ipconfigTCP_SERVER_IDLE_WORK_MS ) )
+	{
+		xResult = pdTRUE;
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
 void FreeRTOS_TCPServerWork( TCPServer_t *pxServer, TickType_t xBlockingTime )
 {
 TCPClient_t **ppxClient;
 BaseType_t xIndex;
 BaseType_t xRc;
+TickType_t xNow;
 
 	/* Let the server do one working cycle */
 	xRc = FreeRTOS_select( pxServer->xSocketSet, xBlockingTime );
@@ -269,11 +384,23 @@ BaseType_t xRc;
 	}
 
 	ppxClient = &pxServer->pxClients;
+	xNow = xTaskGetTickCount();
 
+	/* Only the clients with a socket event are visited, each of them once
+	per cycle, so that idle clients cost nothing and busy clients take
+	turns. */
 	while( ( * ppxClient ) != NULL )
 	{
 	TCPClient_t *pxThis = *ppxClient;
 
+		if( prvClientNeedsWork( pxServer, pxThis, xNow ) == pdFALSE )
+		{
+			ppxClient = &( pxThis->pxNextClient );
+			continue;
+		}
+
+		pxThis->xLastWorkTime = xNow;
+
 		/* Almost C++ */
 		xRc = pxThis->fWorkFunction( pxThis );
 
@@ -283,7 +410,7 @@ BaseType_t xRc;
 			/* Close handles, resources */
 			pxThis->fDeleteFunction( pxThis );
 			/* Free the space */
-			vPortFreeLarge( pxThis );
+			prvReleaseClient( pxServer, pxThis );
 		}
 		else
 		{
@@ -293,19 +420,107 @@ BaseType_t xRc;
 }
 /*-----------------------------------------------------------*/
 
-static char *strnew( const char *pcString )
+static TCPClient_t *prvAllocateClient( TCPServer_t *pxServer, BaseType_t xSize )
+{
+TCPClient_t *pxClient;
+
+	#if( ipconfigTCP_SERVER_CLIENT_SLOTS > 0 )
+	{
+		/* Every slot is big enough for any type of client. */
+		( void ) xSize;
+		pxClient = pxServer->pxFreeClients;
+		if( pxClient != NULL )
+		{
+			pxServer->pxFreeClients = pxClient->pxNextClient;
+		}
+	}
+	#else
+	{
+		( void ) pxServer;
+		pxClient = ( TCPClient_t * ) pvPortMallocLarge( xSize );
+	}
+	#endif
+
+	return pxClient;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseClient( TCPServer_t *pxServer, TCPClient_t *pxClient )
+{
+	#if( ipconfigTCP_SERVER_CLIENT_SLOTS > 0 )
+	{
+		/* The arena goes back together with the slot, whatever is still
+		allocated from it. */
+		pxClient->pxNextClient = pxServer->pxFreeClients;
+		pxServer->pxFreeClients = pxClient;
+	}
+	#else
+	{
+		( void ) pxServer;
+		vPortFreeLarge( pxClient );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+void *pvTCPClientAlloc( TCPClient_t *pxClient, size_t uxSize )
+{
+void *pvBuffer = NULL;
+
+	#if( ipconfigTCP_SERVER_CLIENT_SLOTS > 0 )
+	{
+	size_t uxNeeded = tcpALIGN( uxSize );
+
+		if( ( uxSize > 0u ) && ( uxNeeded <= tcpARENA_SIZE - pxClient->uxArenaUsed ) )
+		{
+			pvBuffer = tcpCLIENT_ARENA( pxClient ) + pxClient->uxArenaUsed;
+			pxClient->uxArenaLast = pxClient->uxArenaUsed;
+			pxClient->uxArenaUsed += uxNeeded;
+		}
+	}
+	#else
+	{
+		( void ) pxClient;
+	}
+	#endif
+
+	if( pvBuffer == NULL )
+	{
+		pvBuffer = pvPortMalloc( uxSize );
+	}
+
+	return pvBuffer;
+}
+/*-----------------------------------------------------------*/
+
+void vTCPClientFree( TCPClient_t *pxClient, void *pvBuffer )
 {
-BaseType_t xLength;
-char *pxBuffer;
+	#if( ipconfigTCP_SERVER_CLIENT_SLOTS > 0 )
+	{
+	uint8_t *pucArena = tcpCLIENT_ARENA( pxClient );
 
-	xLength = strlen( pcString ) + 1;
-	pxBuffer = ( char * ) pvPortMalloc( xLength );
-	if( pxBuffer != NULL )
+		if( ( ( uint8_t * ) pvBuffer >= pucArena ) && ( ( uint8_t * ) pvBuffer < pucArena + tcpARENA_SIZE ) )
+		{
+			/* Only the most recent block can be given back, so that a
+			buffer that is allocated for each transfer can be re-used.  The
+			rest is released when the client disconnects. */
+			if( ( uint8_t * ) pvBuffer == pucArena + pxClient->uxArenaLast )
+			{
+				pxClient->uxArenaUsed = pxClient->uxArenaLast;
+			}
+			pvBuffer = NULL;
+		}
+	}
+	#else
 	{
-		memcpy( pxBuffer, pcString, xLength );
+		( void ) pxClient;
 	}
+	#endif
 
-	return pxBuffer;
+	if( pvBuffer != NULL )
+	{
+		vPortFree( pvBuffer );
+	}
 }
 /*-----------------------------------------------------------*/
 
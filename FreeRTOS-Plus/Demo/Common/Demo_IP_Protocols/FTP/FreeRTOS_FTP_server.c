@@ -96,6 +96,27 @@
 	#define ipconfigFTP_ZERO_COPY_ALIGNED_WRITES			0
 #endif
 
+/*
+ * ipconfigFTP_TX_BUFSIZE, ipconfigFTP_TX_WINSIZE, ipconfigFTP_RX_BUFSIZE and
+ * ipconfigFTP_RX_WINSIZE: when ipconfigFTP_TX_BUFSIZE is defined, the data
+ * sockets get these buffer sizes (in bytes) and window sizes (in segments).
+ * While a received block is written to disk, the peer can go on sending as
+ * long as the RX window is open: a large RX buffer works as the second buffer
+ * of an upload.  With ipconfigUSE_TCP_WIN, windows larger than 64 KB are
+ * announced with window scaling.
+ */
+#if defined( ipconfigFTP_TX_BUFSIZE ) && ( ipconfigFTP_TX_BUFSIZE > 0 )
+	#ifndef ipconfigFTP_TX_WINSIZE
+		#define ipconfigFTP_TX_WINSIZE	( ( ipconfigFTP_TX_BUFSIZE / 2 ) / ipconfigTCP_MSS + 1 )
+	#endif
+	#ifndef ipconfigFTP_RX_BUFSIZE
+		#define ipconfigFTP_RX_BUFSIZE	ipconfigFTP_TX_BUFSIZE
+	#endif
+	#ifndef ipconfigFTP_RX_WINSIZE
+		#define ipconfigFTP_RX_WINSIZE	( ( ipconfigFTP_RX_BUFSIZE / 2 ) / ipconfigTCP_MSS + 1 )
+	#endif
+#endif
+
 /*
  * This module only has 2 public functions:
  */
@@ -213,9 +234,40 @@ static BaseType_t prvMakeRemoveDir( FTPClient_t *pxClient, const char *pcDirecto
 
 /*
  * LIST: Send a directory listing in Unix style.
+ * NLST: Send the names only.
+ * MLSD: Send a listing in the machine readable format of RFC 3659.
  */
-static BaseType_t prvListSendPrep( FTPClient_t *pxClient );
+static BaseType_t prvListSendPrep( FTPClient_t *pxClient, BaseType_t xFormat );
 static BaseType_t prvListSendWork( FTPClient_t *pxClient );
+static void prvListPrepareAck( FTPClient_t *pxClient );
+
+#define ftpLIST_FORMAT_LONG		0
+#define ftpLIST_FORMAT_NAMES	1
+#define ftpLIST_FORMAT_MLSD		2
+
+#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+	/*
+	 * The text of a directory listing, see ipconfigFTP_LIST_CACHE_SIZE.
+	 */
+	typedef struct xFTP_LIST_CACHE
+	{
+		char pcDirectory[ ffconfigMAX_FILENAME ];
+		BaseType_t xFormat;
+		BaseType_t xDirCount;
+		uint32_t ulGeneration;	/* The value of ulListGeneration when the listing was made. */
+		TickType_t xCreated;
+		UBaseType_t uxUsers;	/* The number of clients sending this listing. */
+		size_t uxLength;
+		char pcData[ ipconfigFTP_LIST_CACHE_SIZE ];
+	} FTPListCache_t;
+
+	static BaseType_t prvListCacheGet( FTPClient_t *pxClient );
+	static void prvListCacheStart( FTPClient_t *pxClient );
+	static void prvListCacheAppend( FTPClient_t *pxClient, const char *pcText, BaseType_t xLength );
+	static void prvListCacheStore( FTPClient_t *pxClient );
+	static void prvListCacheRelease( FTPClient_t *pxClient );
+	static BaseType_t prvListSendCached( FTPClient_t *pxClient );
+#endif /* ipconfigFTP_LIST_CACHE_SIZE */
 
 /*
  * RETR: Send a file to the FTP client.
@@ -229,11 +281,25 @@ static BaseType_t prvRetrieveFileWork( FTPClient_t *pxClient );
 static BaseType_t prvStoreFilePrep( FTPClient_t *pxClient, char *pcFileName );
 static BaseType_t prvStoreFileWork( FTPClient_t *pxClient );
 
+#if( ipconfigFTP_WRITE_BUFFER_SIZE > 0 ) && ( ipconfigFTP_ZERO_COPY_ALIGNED_WRITES == 0 )
+	/*
+	 * Collect received data in pcWriteBuffer, and write it in whole blocks.
+	 */
+	static void prvStoreBufferPrep( FTPClient_t *pxClient, FF_FILE *pxFile );
+	static BaseType_t prvStoreBuffered( FTPClient_t *pxClient, const char *pcData, BaseType_t xLength );
+	static BaseType_t prvStoreFlush( FTPClient_t *pxClient );
+#endif
+
 /*
  * Print/format a single directory entry in Unix style.
  */
 static BaseType_t prvGetFileInfoStat( FF_DirEnt_t *pxEntry, char *pcLine, BaseType_t xMaxLength );
 
+/*
+ * Print/format a single directory entry as a MLSD fact line.
+ */
+static BaseType_t prvGetFileInfoMLSD( FF_DirEnt_t *pxEntry, char *pcLine, BaseType_t xMaxLength );
+
 /*
  * Send a reply to a socket, either the command- or the data-socket.
  */
@@ -259,8 +325,8 @@ BaseType_t xMakeAbsolute( FTPClient_t *pxClient, char *pcBuffer, BaseType_t xBuf
 
  *	xFTPClientWork()
  *	will be called by FreeRTOS_TCPServerWork(), after select has expired().
- *	FD_ISSET will not be used.  This work function will always be called at
- *	regular intervals, and also after a select() event has occurred.
+ *	It is called when the command socket or the data socket has an event, and
+ *	otherwise at least every ipconfigTCP_SERVER_IDLE_WORK_MS.
  */
 BaseType_t xFTPClientWork( TCPClient_t *pxTCPClient )
 {
@@ -542,6 +608,48 @@ BaseType_t xResult = 0;
 			}
 			break;
 
+		case ECMD_ALLO:	/* Allocate storage for the next STOR. */
+			if( pxClient->bits.bReadOnly != pdFALSE_UNSIGNED )
+			{
+				pcMyReply = REPL_553_READ_ONLY;
+			}
+			else
+			{
+			const char *pcPtr = pcRestCommand;
+			uint32_t ulTotalCount;
+			uint32_t ulFreeCount;
+
+				while( *pcPtr == ' ' )
+				{
+					pcPtr++;
+				}
+
+				if( ( *pcPtr >= '0' ) && ( *pcPtr <= '9' ) )
+				{
+					/* An optional "R <record size>" is not used. */
+					pxClient->ulAllocSize = ( uint32_t ) strtoul( pcPtr, NULL, 10 );
+
+					/* ff_diskfree() counts in units of 512 bytes.  +FAT can
+					not reserve the space, but a file that won't fit is
+					refused before it is sent. */
+					ulFreeCount = ff_diskfree( pxClient->pcCurrentDir, &ulTotalCount );
+					if( ( ( uint64_t ) ulFreeCount * 512ull ) < ( uint64_t ) pxClient->ulAllocSize )
+					{
+						pxClient->ulAllocSize = 0ul;
+						pcMyReply = "552 Insufficient storage space.\r\n";
+					}
+					else
+					{
+						pcMyReply = "200 ALLO command successful.\r\n";
+					}
+				}
+				else
+				{
+					pcMyReply = REPL_501; /* Syntax error in parameters or arguments. */
+				}
+			}
+			break;
+
 		case ECMD_NOOP:	/* NOP operation */
 			if( pxClient->xTransferSocket != FREERTOS_NO_SOCKET )
 			{
@@ -752,6 +860,8 @@ BaseType_t xResult = 0;
 			pxClient->bits.bLoggedIn = pdFALSE_UNSIGNED;
 			break;
 		case ECMD_LIST:
+		case ECMD_NLST:
+		case ECMD_MLSD:
 		case ECMD_RETR:
 		case ECMD_STOR:
 			if( ( pxClient->xTransferSocket == FREERTOS_NO_SOCKET ) &&
@@ -778,7 +888,13 @@ BaseType_t xResult = 0;
 				switch( pxFTPCommand->ucCommandType )
 				{
 				case ECMD_LIST:
-					prvListSendPrep( pxClient );
+					prvListSendPrep( pxClient, ftpLIST_FORMAT_LONG );
+					break;
+				case ECMD_NLST:
+					prvListSendPrep( pxClient, ftpLIST_FORMAT_NAMES );
+					break;
+				case ECMD_MLSD:
+					prvListSendPrep( pxClient, ftpLIST_FORMAT_MLSD );
 					break;
 				case ECMD_RETR:
 					prvRetrieveFilePrep( pxClient, pcRestCommand );
@@ -814,6 +930,9 @@ BaseType_t xResult = 0;
 					there is support for date&time. */
 				#if( ffconfigTIME_SUPPORT != 0 )
 					" MDTM\x0a"
+					" MLST type*;size*;modify*;\x0a"
+				#else
+					" MLST type*;size*;\x0a"
 				#endif
 					" REST STREAM\x0a"
 					" SIZE\x0d\x0a"
@@ -833,6 +952,26 @@ BaseType_t xResult = 0;
 		pxClient->bits.bInRename = pdFALSE_UNSIGNED;
 	}
 
+	#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+	{
+		switch( pxFTPCommand->ucCommandType )
+		{
+		case ECMD_STOR:
+		case ECMD_DELE:
+		case ECMD_RNTO:
+		case ECMD_MKD:
+		case ECMD_RMD:
+		case ECMD_SITE:
+			/* The file system may have changed, cached listings can not be
+			used any more. */
+			pxClient->pxParent->ulListGeneration++;
+			break;
+		default:
+			break;
+		}
+	}
+	#endif /* ipconfigFTP_LIST_CACHE_SIZE */
+
 	if( pcMyReply != NULL )
 	{
 		xResult = prvSendReply( pxClient->xSocket, pcMyReply, strlen( pcMyReply ) );
@@ -1091,6 +1230,16 @@ static void prvTransferCloseSocket( FTPClient_t *pxClient )
 	BaseType_t xLength;
 	char pcStrBuf[ 32 ];
 
+		#if( ipconfigFTP_WRITE_BUFFER_SIZE > 0 ) && ( ipconfigFTP_ZERO_COPY_ALIGNED_WRITES == 0 )
+		{
+			/* The last part must be on disk before the result is reported. */
+			if( prvStoreFlush( pxClient ) == pdFAIL )
+			{
+				pxClient->bits1.bHadError = pdTRUE_UNSIGNED;
+			}
+		}
+		#endif
+
 		if( pxClient->bits1.bHadError == pdFALSE_UNSIGNED )
 		{
 			xLength = snprintf( pxClient->pcClientAck, sizeof( pxClient->pcClientAck ),
@@ -1140,11 +1289,28 @@ static void prvTransferCloseSocket( FTPClient_t *pxClient )
 	pxClient->bits1.bDirHasEntry = pdFALSE_UNSIGNED;
 	pxClient->bits1.bClientConnected = pdFALSE_UNSIGNED;
 	pxClient->bits1.bHadError = pdFALSE_UNSIGNED;
+
+	#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+	{
+		prvListCacheRelease( pxClient );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
 static void prvTransferCloseFile( FTPClient_t *pxClient )
 {
+	#if( ipconfigFTP_WRITE_BUFFER_SIZE > 0 ) && ( ipconfigFTP_ZERO_COPY_ALIGNED_WRITES == 0 )
+	{
+		if( pxClient->pcWriteBuffer != NULL )
+		{
+			/* Normally flushed already by prvTransferCloseSocket(). */
+			( void ) prvStoreFlush( pxClient );
+			vTCPClientFree( ( TCPClient_t * ) pxClient, pxClient->pcWriteBuffer );
+			pxClient->pcWriteBuffer = NULL;
+		}
+	}
+	#endif
 	if( pxClient->pxWriteHandle != NULL )
 	{
 		ff_fclose( pxClient->pxWriteHandle );
@@ -1154,6 +1320,12 @@ static void prvTransferCloseFile( FTPClient_t *pxClient )
 			vApplicationFTPReceivedHook( pxClient->pcFileName, pxClient->ulRecvBytes, pxClient );
 		}
 		#endif
+		#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+		{
+			/* The size of the file has changed while it was received. */
+			pxClient->pxParent->ulListGeneration++;
+		}
+		#endif
 
 	}
 	if( pxClient->pxReadHandle != NULL )
@@ -1161,6 +1333,16 @@ static void prvTransferCloseFile( FTPClient_t *pxClient )
 		ff_fclose( pxClient->pxReadHandle );
 		pxClient->pxReadHandle = NULL;
 	}
+	#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
+	{
+		if( pxClient->pcReadAhead != NULL )
+		{
+			vTCPClientFree( ( TCPClient_t * ) pxClient, pxClient->pcReadAhead );
+			pxClient->pcReadAhead = NULL;
+		}
+		pxClient->uxReadAheadLength = 0u;
+	}
+	#endif
 	/* These two field are only used for logging / file-statistics */
 	pxClient->ulRecvBytes = 0ul;
 	pxClient->xStartTime = 0ul;
@@ -1427,6 +1609,12 @@ int iErrorNo;
 			prvTransferStart( pxClient ); /* Now active connect. */
 		}
 
+		#if( ipconfigFTP_WRITE_BUFFER_SIZE > 0 ) && ( ipconfigFTP_ZERO_COPY_ALIGNED_WRITES == 0 )
+		{
+			prvStoreBufferPrep( pxClient, pxNewHandle );
+		}
+		#endif
+
 		pxClient->pxWriteHandle = pxNewHandle;
 
 		/* To get some statistics about the performance. */
@@ -1435,10 +1623,92 @@ int iErrorNo;
 		xResult = pdTRUE;
 	}
 
+	/* The size announced with ALLO is only used once. */
+	pxClient->ulAllocSize = 0ul;
+
 	return xResult;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigFTP_WRITE_BUFFER_SIZE > 0 ) && ( ipconfigFTP_ZERO_COPY_ALIGNED_WRITES == 0 )
+
+	static void prvStoreBufferPrep( FTPClient_t *pxClient, FF_FILE *pxFile )
+	{
+	size_t uxSize = ipconfigFTP_WRITE_BUFFER_SIZE;
+	size_t uxPosition = ( size_t ) ff_ftell( pxFile );
+
+		if( ( pxClient->ulAllocSize > 0ul ) && ( pxClient->ulAllocSize < uxSize ) )
+		{
+			/* The whole file fits in a smaller buffer. */
+			uxSize = ( size_t ) pxClient->ulAllocSize;
+		}
+
+		/* Without memory, the data is written as it comes in. */
+		pxClient->pcWriteBuffer = ( char * ) pvTCPClientAlloc( ( TCPClient_t * ) pxClient, uxSize );
+		pxClient->uxWriteBufferSize = uxSize;
+		pxClient->uxWriteLength = 0u;
+
+		/* After a REST in the middle of a block, the first write ends at a
+		block boundary, so that all following writes are aligned. */
+		pxClient->uxWriteLimit = FreeRTOS_min_uint32( uxSize, ipconfigFTP_WRITE_BUFFER_SIZE - ( uxPosition % ipconfigFTP_WRITE_BUFFER_SIZE ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvStoreBuffered( FTPClient_t *pxClient, const char *pcData, BaseType_t xLength )
+	{
+	size_t uxCount;
+	size_t uxLeft = ( size_t ) xLength;
+	BaseType_t xResult = xLength;
+
+		while( ( uxLeft > 0u ) && ( xResult >= 0 ) )
+		{
+			uxCount = FreeRTOS_min_uint32( uxLeft, pxClient->uxWriteLimit - pxClient->uxWriteLength );
+			if( ( pxClient->uxWriteLength == 0u ) && ( uxCount == pxClient->uxWriteLimit ) )
+			{
+				/* A whole block is available, write it without copying. */
+				if( ff_fwrite( pcData, 1, uxCount, pxClient->pxWriteHandle ) != uxCount )
+				{
+					xResult = -1;
+				}
+				pxClient->uxWriteLimit = pxClient->uxWriteBufferSize;
+			}
+			else
+			{
+				memcpy( pxClient->pcWriteBuffer + pxClient->uxWriteLength, pcData, uxCount );
+				pxClient->uxWriteLength += uxCount;
+				if( ( pxClient->uxWriteLength == pxClient->uxWriteLimit ) && ( prvStoreFlush( pxClient ) == pdFAIL ) )
+				{
+					xResult = -1;
+				}
+			}
+			pcData += uxCount;
+			uxLeft -= uxCount;
+		}
+
+		return xResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvStoreFlush( FTPClient_t *pxClient )
+	{
+	BaseType_t xResult = pdPASS;
+
+		if( ( pxClient->pcWriteBuffer != NULL ) && ( pxClient->uxWriteLength > 0u ) )
+		{
+			if( ff_fwrite( pxClient->pcWriteBuffer, 1, pxClient->uxWriteLength, pxClient->pxWriteHandle ) != pxClient->uxWriteLength )
+			{
+				xResult = pdFAIL;
+			}
+			pxClient->uxWriteLength = 0u;
+			pxClient->uxWriteLimit = pxClient->uxWriteBufferSize;
+		}
+
+		return xResult;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigFTP_WRITE_BUFFER_SIZE */
+
 #if( ipconfigFTP_ZERO_COPY_ALIGNED_WRITES == 0 )
 
 	static BaseType_t prvStoreFileWork( FTPClient_t *pxClient )
@@ -1459,7 +1729,16 @@ int iErrorNo;
 				break;
 			}
 			pxClient->ulRecvBytes += xRc;
-			xWritten = ff_fwrite( pcBuffer, 1, xRc, pxClient->pxWriteHandle );
+			#if( ipconfigFTP_WRITE_BUFFER_SIZE > 0 )
+			if( pxClient->pcWriteBuffer != NULL )
+			{
+				xWritten = prvStoreBuffered( pxClient, pcBuffer, xRc );
+			}
+			else
+			#endif /* ipconfigFTP_WRITE_BUFFER_SIZE */
+			{
+				xWritten = ff_fwrite( pcBuffer, 1, xRc, pxClient->pxWriteHandle );
+			}
 			FreeRTOS_recv( pxClient->xTransferSocket, ( void * ) NULL, xRc, 0 );
 			if( xWritten != xRc )
 			{
@@ -1641,6 +1920,18 @@ size_t uxFileSize;
 			}
 		}
 	}
+	#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
+	{
+		if( xResult != pdFALSE )
+		{
+			/* When there is not enough memory, the file will be sent through
+			pcFILE_BUFFER. */
+			pxClient->pcReadAhead = ( char * ) pvTCPClientAlloc( ( TCPClient_t * ) pxClient, ipconfigFTP_READ_AHEAD_SIZE );
+			pxClient->uxReadAheadOffset = 0u;
+			pxClient->uxReadAheadLength = 0u;
+		}
+	}
+	#endif
 	if( xResult != pdFALSE )
 	{
 		if( pxClient->bits1.bIsListen != pdFALSE_UNSIGNED )
@@ -1678,6 +1969,39 @@ size_t uxFileSize;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
+
+	static BaseType_t prvReadAhead( FTPClient_t *pxClient )
+	{
+	size_t uxCount;
+	size_t uxItemsRead;
+	BaseType_t xResult = pdPASS;
+
+		/* The buffer is refilled as soon as it is empty, also when the TX
+		stream is full: the disk is read while the previous data is still
+		being transmitted. */
+		if( ( pxClient->uxReadAheadLength == 0u ) && ( pxClient->uxBytesLeft > 0u ) )
+		{
+			uxCount = FreeRTOS_min_uint32( pxClient->uxBytesLeft, ipconfigFTP_READ_AHEAD_SIZE );
+			uxItemsRead = ff_fread( pxClient->pcReadAhead, 1, uxCount, pxClient->pxReadHandle );
+			if( uxItemsRead != uxCount )
+			{
+				FreeRTOS_printf( ( "prvReadAhead: Got %u Expected %u\n", ( unsigned )uxItemsRead, ( unsigned ) uxCount ) );
+				xResult = pdFAIL;
+			}
+			else
+			{
+				pxClient->uxReadAheadOffset = 0u;
+				pxClient->uxReadAheadLength = uxCount;
+			}
+		}
+
+		return xResult;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigFTP_READ_AHEAD_SIZE */
+
 static BaseType_t prvRetrieveFileWork( FTPClient_t *pxClient )
 {
 size_t uxSpace;
@@ -1690,20 +2014,16 @@ BaseType_t xSetEvent = pdFALSE;
 	#if( ipconfigFTP_TX_ZERO_COPY != 0 )
 		char *pcBuffer;
 		BaseType_t xBufferLength;
+	#else
+		char *pcSource = pcFILE_BUFFER;
 	#endif /* ipconfigFTP_TX_ZERO_COPY */
 
 		/* Take the lesser of the two: tx_space (number of bytes that can be
 		queued for transmission) and uxBytesLeft (the number of bytes left to
-		read from the file) */
+		read from the file).  When the TX stream is full, eSELECT_WRITE is
+		set below and the other clients get a turn. */
 		uxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
 
-		if( uxSpace == 0 )
-		{
-			FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE | eSELECT_EXCEPT );
-			xRc = FreeRTOS_select( pxClient->pxParent->xSocketSet, 200 );
-			uxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
-		}
-
 		uxCount = FreeRTOS_min_uint32( pxClient->uxBytesLeft, uxSpace );
 
 		if( uxCount == 0 )
@@ -1713,17 +2033,35 @@ BaseType_t xSetEvent = pdFALSE;
 
 		#if( ipconfigFTP_TX_ZERO_COPY == 0 )
 		{
-			if( uxCount > sizeof( pcFILE_BUFFER ) )
+			#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
+			if( pxClient->pcReadAhead != NULL )
 			{
-				uxCount = sizeof( pcFILE_BUFFER );
+				if( prvReadAhead( pxClient ) != pdPASS )
+				{
+					xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
+					pxClient->uxBytesLeft = 0u;
+					break;
+				}
+				uxCount = FreeRTOS_min_uint32( uxCount, pxClient->uxReadAheadLength );
+				pcSource = pxClient->pcReadAhead + pxClient->uxReadAheadOffset;
+				pxClient->uxReadAheadOffset += uxCount;
+				pxClient->uxReadAheadLength -= uxCount;
 			}
-			uxItemsRead = ff_fread( pcFILE_BUFFER, 1, uxCount, pxClient->pxReadHandle );
-			if( uxItemsRead != uxCount )
+			else
+			#endif /* ipconfigFTP_READ_AHEAD_SIZE */
 			{
-				FreeRTOS_printf( ( "prvRetrieveFileWork: Got %u Expected %u\n", ( unsigned )uxItemsRead, ( unsigned ) uxCount ) );
-				xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
-				pxClient->uxBytesLeft = 0u;
-				break;
+				if( uxCount > sizeof( pcFILE_BUFFER ) )
+				{
+					uxCount = sizeof( pcFILE_BUFFER );
+				}
+				uxItemsRead = ff_fread( pcFILE_BUFFER, 1, uxCount, pxClient->pxReadHandle );
+				if( uxItemsRead != uxCount )
+				{
+					FreeRTOS_printf( ( "prvRetrieveFileWork: Got %u Expected %u\n", ( unsigned )uxItemsRead, ( unsigned ) uxCount ) );
+					xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
+					pxClient->uxBytesLeft = 0u;
+					break;
+				}
 			}
 			pxClient->uxBytesLeft -= uxCount;
 
@@ -1734,7 +2072,16 @@ BaseType_t xSetEvent = pdFALSE;
 				FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
 			}
 
-			xRc = FreeRTOS_send( pxClient->xTransferSocket, pcFILE_BUFFER, uxCount, 0 );
+			xRc = FreeRTOS_send( pxClient->xTransferSocket, pcSource, uxCount, 0 );
+
+			#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
+			if( ( xRc >= 0 ) && ( pxClient->pcReadAhead != NULL ) && ( prvReadAhead( pxClient ) != pdPASS ) )
+			{
+				xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
+				pxClient->uxBytesLeft = 0u;
+				break;
+			}
+			#endif /* ipconfigFTP_READ_AHEAD_SIZE */
 		}
 		#else /* ipconfigFTP_TX_ZERO_COPY != 0 */
 		{
@@ -1852,11 +2199,13 @@ BaseType_t xSetEvent = pdFALSE;
 ####### #####  ####   ####
 */
 /* Prepare sending a directory LIST */
-static BaseType_t prvListSendPrep( FTPClient_t *pxClient )
+static BaseType_t prvListSendPrep( FTPClient_t *pxClient, BaseType_t xFormat )
 {
 BaseType_t xFindResult;
 int iErrorNo;
 
+	pxClient->xListFormat = xFormat;
+
 	if( pxClient->bits1.bIsListen != pdFALSE_UNSIGNED )
 	{
 		/* True if PASV is used */
@@ -1880,10 +2229,33 @@ int iErrorNo;
 	pxClient->xDirCount = 0;
 	xMakeAbsolute( pxClient, pcNEW_DIR, sizeof( pcNEW_DIR ), pxClient->pcCurrentDir );
 
+	#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+	{
+		prvListCacheRelease( pxClient );
+		if( prvListCacheGet( pxClient ) != pdFALSE )
+		{
+			pxClient->pcClientAck[ 0 ] = '\0';
+
+			/* Although against the coding standard of FreeRTOS, a return is
+			done here  to simplify this conditional code. */
+			return pxClient->xDirCount;
+		}
+	}
+	#endif /* ipconfigFTP_LIST_CACHE_SIZE */
+
 	xFindResult = ff_findfirst( pcNEW_DIR, &pxClient->xFindData );
 
 	pxClient->bits1.bDirHasEntry = ( xFindResult >= 0 );
 
+	#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+	{
+		if( pxClient->bits1.bDirHasEntry != pdFALSE_UNSIGNED )
+		{
+			prvListCacheStart( pxClient );
+		}
+	}
+	#endif /* ipconfigFTP_LIST_CACHE_SIZE */
+
 	iErrorNo = stdioGET_ERRNO();
 	if( ( xFindResult < 0 ) && ( iErrorNo == pdFREERTOS_ERRNO_ENMFILE ) )
 	{
@@ -1904,10 +2276,40 @@ int iErrorNo;
 
 #define	MAX_DIR_LIST_ENTRY_SIZE		256
 
+static void prvListPrepareAck( FTPClient_t *pxClient )
+{
+uint32_t ulTotalCount;
+uint32_t ulFreeCount;
+uint32_t ulPercentage;
+
+	ulTotalCount = 1;
+	ulFreeCount = ff_diskfree( pxClient->pcCurrentDir, &ulTotalCount );
+	ulPercentage = ( uint32_t ) ( ( 100ULL * ulFreeCount + ulTotalCount / 2 ) / ulTotalCount );
+
+	/* Prepare the ACK which will be sent when all data has been sent. */
+	snprintf( pxClient->pcClientAck, sizeof( pxClient->pcClientAck ),
+		"226-Options: -l\r\n"
+		"226-%ld matches total\r\n"
+		"226 Total %lu KB (%lu %% free)\r\n",
+		pxClient->xDirCount, ulTotalCount /1024, ulPercentage );
+}
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvListSendWork( FTPClient_t *pxClient )
 {
 BaseType_t xTxSpace;
 
+	#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+	{
+		if( pxClient->bits1.bListFromCache != pdFALSE_UNSIGNED )
+		{
+			/* Although against the coding standard of FreeRTOS, a return is
+			done here  to simplify this conditional code. */
+			return prvListSendCached( pxClient );
+		}
+	}
+	#endif /* ipconfigFTP_LIST_CACHE_SIZE */
+
 	while( pxClient->bits1.bClientConnected != pdFALSE_UNSIGNED )
 	{
 	char *pcWritePtr = pcCOMMAND_BUFFER;
@@ -1926,7 +2328,24 @@ BaseType_t xTxSpace;
 		int32_t iRc;
 		int iErrorNo;
 
-			xLength = prvGetFileInfoStat( &( pxClient->xFindData.xDirectoryEntry ), pcWritePtr, xTxSpace );
+			switch( pxClient->xListFormat )
+			{
+			case ftpLIST_FORMAT_NAMES:
+				xLength = snprintf( pcWritePtr, xTxSpace, "%s\r\n", pxClient->xFindData.xDirectoryEntry.pcFileName );
+				break;
+			case ftpLIST_FORMAT_MLSD:
+				xLength = prvGetFileInfoMLSD( &( pxClient->xFindData.xDirectoryEntry ), pcWritePtr, xTxSpace );
+				break;
+			default:
+				xLength = prvGetFileInfoStat( &( pxClient->xFindData.xDirectoryEntry ), pcWritePtr, xTxSpace );
+				break;
+			}
+
+			#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+			{
+				prvListCacheAppend( pxClient, pcWritePtr, xLength );
+			}
+			#endif
 
 			pxClient->xDirCount++;
 			pcWritePtr += xLength;
@@ -1955,20 +2374,13 @@ BaseType_t xTxSpace;
 
 		if( pxClient->bits1.bDirHasEntry == pdFALSE_UNSIGNED )
 		{
-		uint32_t ulTotalCount;
-		uint32_t ulFreeCount;
-		uint32_t ulPercentage;
-
-			ulTotalCount = 1;
-			ulFreeCount = ff_diskfree( pxClient->pcCurrentDir, &ulTotalCount );
-			ulPercentage = ( uint32_t ) ( ( 100ULL * ulFreeCount + ulTotalCount / 2 ) / ulTotalCount );
+			prvListPrepareAck( pxClient );
 
-			/* Prepare the ACK which will be sent when all data has been sent. */
-			snprintf( pxClient->pcClientAck, sizeof( pxClient->pcClientAck ),
-				"226-Options: -l\r\n"
-				"226-%ld matches total\r\n"
-				"226 Total %lu KB (%lu %% free)\r\n",
-				pxClient->xDirCount, ulTotalCount /1024, ulPercentage );
+			#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+			{
+				prvListCacheStore( pxClient );
+			}
+			#endif
 		}
 
 		if( xWriteLength )
@@ -1991,10 +2403,193 @@ BaseType_t xTxSpace;
 
 	}	/* while( pxClient->bits1.bClientConnected )  */
 
+	/* Get called again as soon as the TX stream has space for more entries. */
+	if( pxClient->bits1.bDirHasEntry != pdFALSE_UNSIGNED )
+	{
+		FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+	}
+	else
+	{
+		FreeRTOS_FD_CLR( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+	}
+
 	return 0;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+
+	static BaseType_t prvListCacheGet( FTPClient_t *pxClient )
+	{
+	TCPServer_t *pxServer = pxClient->pxParent;
+	FTPListCache_t *pxCache = pxServer->pxListCache;
+	BaseType_t xFound = pdFALSE;
+
+		if( ( pxCache != NULL ) &&
+			( pxCache->xFormat == pxClient->xListFormat ) &&
+			( pxCache->ulGeneration == pxServer->ulListGeneration ) &&
+			( ( xTaskGetTickCount() - pxCache->xCreated ) < pdMS_TO_TICKS( ipconfigFTP_LIST_CACHE_MS ) ) &&
+			( strcmp( pxCache->pcDirectory, pcNEW_DIR ) == 0 ) )
+		{
+			pxCache->uxUsers++;
+			pxClient->pxListCache = pxCache;
+			pxClient->uxListOffset = 0u;
+			pxClient->xDirCount = pxCache->xDirCount;
+			pxClient->bits1.bListFromCache = pdTRUE_UNSIGNED;
+			/* Let xFTPClientWork() call prvListSendWork(). */
+			pxClient->bits1.bDirHasEntry = pdTRUE_UNSIGNED;
+			xFound = pdTRUE;
+		}
+
+		return xFound;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvListCacheStart( FTPClient_t *pxClient )
+	{
+	FTPListCache_t *pxCache;
+
+		/* The listing is copied while it is being sent.  Without memory, it
+		is just not cached. */
+		pxCache = ( FTPListCache_t * ) pvPortMalloc( sizeof( *pxCache ) );
+		if( pxCache != NULL )
+		{
+			snprintf( pxCache->pcDirectory, sizeof( pxCache->pcDirectory ), "%s", pcNEW_DIR );
+			pxCache->xFormat = pxClient->xListFormat;
+			pxCache->ulGeneration = pxClient->pxParent->ulListGeneration;
+			pxCache->xCreated = xTaskGetTickCount();
+			pxCache->uxUsers = 0u;
+			pxCache->uxLength = 0u;
+		}
+		pxClient->pxListCache = pxCache;
+		pxClient->bits1.bListFromCache = pdFALSE_UNSIGNED;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvListCacheAppend( FTPClient_t *pxClient, const char *pcText, BaseType_t xLength )
+	{
+	FTPListCache_t *pxCache = pxClient->pxListCache;
+
+		if( ( pxCache != NULL ) && ( pxClient->bits1.bListFromCache == pdFALSE_UNSIGNED ) && ( xLength > 0 ) )
+		{
+			if( pxCache->uxLength + ( size_t ) xLength <= sizeof( pxCache->pcData ) )
+			{
+				memcpy( pxCache->pcData + pxCache->uxLength, pcText, ( size_t ) xLength );
+				pxCache->uxLength += ( size_t ) xLength;
+			}
+			else
+			{
+				/* Too long to be cached. */
+				vPortFree( pxCache );
+				pxClient->pxListCache = NULL;
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvListCacheStore( FTPClient_t *pxClient )
+	{
+	TCPServer_t *pxServer = pxClient->pxParent;
+	FTPListCache_t *pxCache = pxClient->pxListCache;
+	FTPListCache_t *pxOld;
+
+		if( ( pxCache != NULL ) && ( pxClient->bits1.bListFromCache == pdFALSE_UNSIGNED ) )
+		{
+			pxClient->pxListCache = NULL;
+			if( pxCache->ulGeneration == pxServer->ulListGeneration )
+			{
+				pxCache->xDirCount = pxClient->xDirCount;
+				pxOld = pxServer->pxListCache;
+				pxServer->pxListCache = pxCache;
+
+				/* A listing that is still being sent is freed by the last
+				client that sends it. */
+				if( ( pxOld != NULL ) && ( pxOld->uxUsers == 0u ) )
+				{
+					vPortFree( pxOld );
+				}
+			}
+			else
+			{
+				/* The file system has changed while the listing was made. */
+				vPortFree( pxCache );
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvListCacheRelease( FTPClient_t *pxClient )
+	{
+	FTPListCache_t *pxCache = pxClient->pxListCache;
+
+		if( pxCache != NULL )
+		{
+			if( pxClient->bits1.bListFromCache == pdFALSE_UNSIGNED )
+			{
+				/* A listing that was not completed. */
+				vPortFree( pxCache );
+			}
+			else
+			{
+				pxCache->uxUsers--;
+				if( ( pxCache->uxUsers == 0u ) && ( pxClient->pxParent->pxListCache != pxCache ) )
+				{
+					vPortFree( pxCache );
+				}
+			}
+			pxClient->pxListCache = NULL;
+		}
+		pxClient->bits1.bListFromCache = pdFALSE_UNSIGNED;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvListSendCached( FTPClient_t *pxClient )
+	{
+	FTPListCache_t *pxCache = pxClient->pxListCache;
+	size_t uxCount;
+	BaseType_t xRc;
+
+		if( pxClient->bits1.bClientConnected != pdFALSE_UNSIGNED )
+		{
+			uxCount = FreeRTOS_min_uint32( pxCache->uxLength - pxClient->uxListOffset,
+				( uint32_t ) FreeRTOS_tx_space( pxClient->xTransferSocket ) );
+
+			if( pxClient->uxListOffset + uxCount == pxCache->uxLength )
+			{
+			BaseType_t xTrueValue = 1;
+
+				FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
+			}
+
+			if( uxCount > 0u )
+			{
+				xRc = FreeRTOS_send( pxClient->xTransferSocket, pxCache->pcData + pxClient->uxListOffset, uxCount, 0 );
+				if( xRc > 0 )
+				{
+					pxClient->uxListOffset += ( size_t ) xRc;
+				}
+			}
+
+			if( pxClient->uxListOffset == pxCache->uxLength )
+			{
+				pxClient->bits1.bDirHasEntry = pdFALSE_UNSIGNED;
+				prvListCacheRelease( pxClient );
+				prvListPrepareAck( pxClient );
+				prvSendReply( pxClient->xSocket, pxClient->pcClientAck, 0 );
+				FreeRTOS_FD_CLR( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+			}
+			else
+			{
+				FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+			}
+		}
+
+		return 0;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigFTP_LIST_CACHE_SIZE */
+
 static const char *pcMonthAbbrev( BaseType_t xMonth )
 {
 static const char pcMonthList[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
@@ -2079,6 +2674,60 @@ static BaseType_t prvGetFileInfoStat( FF_DirEnt_t *pxEntry, char *pcLine, BaseTy
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvGetFileInfoMLSD( FF_DirEnt_t *pxEntry, char *pcLine, BaseType_t xMaxLength )
+{
+const char *pcType = "file";
+const char *pcFileName = pxEntry->pcFileName;
+
+/*
+ *	Creates a fact line as defined in RFC 3659, which is easier to format and
+ *	to parse than the Unix-style listing:
+ *
+ * type=file;size=10564588;modify=20150901001700; 03.  Metaharmoniks - Star (Instrumental).mp3
+ */
+
+	if( ( pxEntry->ucAttrib & FF_FAT_ATTR_DIR ) != 0 )
+	{
+		if( strcmp( pcFileName, "." ) == 0 )
+		{
+			pcType = "cdir";
+		}
+		else if( strcmp( pcFileName, ".." ) == 0 )
+		{
+			pcType = "pdir";
+		}
+		else
+		{
+			pcType = "dir";
+		}
+	}
+
+	#if ( ffconfigTIME_SUPPORT == 1 )
+	{
+	const FF_SystemTime_t *pxTime = &( pxEntry->xModifiedTime );
+
+		return snprintf( pcLine, xMaxLength, "type=%s;size=%lu;modify=%04u%02u%02u%02u%02u%02u; %s\r\n",
+			pcType,
+			( unsigned long ) pxEntry->ulFileSize,
+			( unsigned ) pxTime->Year,
+			( unsigned ) pxTime->Month,
+			( unsigned ) pxTime->Day,
+			( unsigned ) pxTime->Hour,
+			( unsigned ) pxTime->Minute,
+			( unsigned ) pxTime->Second,
+			pcFileName );
+	}
+	#else
+	{
+		return snprintf( pcLine, xMaxLength, "type=%s;size=%lu; %s\r\n",
+			pcType,
+			( unsigned long ) pxEntry->ulFileSize,
+			pcFileName );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
 /*
   ####  #     # #####
  #    # #     #  #   #
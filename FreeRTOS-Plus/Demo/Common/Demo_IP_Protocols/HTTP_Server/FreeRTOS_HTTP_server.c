@@ -55,10 +55,6 @@
 	#define HTTP_SERVER_BACKLOG			( 12 )
 #endif
 
-#ifndef USE_HTML_CHUNKS
-	#define USE_HTML_CHUNKS				( 0 )
-#endif
-
 #if !defined( ARRAY_SIZE )
 	#define ARRAY_SIZE(x) ( BaseType_t ) (sizeof( x ) / sizeof( x )[ 0 ] )
 #endif
@@ -72,13 +68,67 @@
 	#define ipconfigHTTP_REQUEST_CHARACTER		'?'
 #endif
 
+/* When non-zero, files are read straight into the TX stream of the socket,
+as the FTP server does with ipconfigFTP_TX_ZERO_COPY, instead of being
+copied through pcFileBuffer. */
+#ifndef ipconfigHTTP_TX_ZERO_COPY
+	#define ipconfigHTTP_TX_ZERO_COPY			( 0 )
+#endif
+
+/* The longest chunk-size line plus the CRLF that ends a chunk. */
+#define httpCHUNK_OVERHEAD		( 12u )
+
 /*_RB_ Need comment block, although fairly self evident. */
 static void prvFileClose( HTTPClient_t *pxClient );
 static BaseType_t prvProcessCmd( HTTPClient_t *pxClient, BaseType_t xIndex );
 static const char *pcGetContentsType( const char *apFname );
 static BaseType_t prvOpenURL( HTTPClient_t *pxClient );
 static BaseType_t prvSendFile( HTTPClient_t *pxClient );
+static BaseType_t prvSendRange( HTTPClient_t *pxClient );
+static void prvParseRange( HTTPClient_t *pxClient, const char *pcValue );
 static BaseType_t prvSendReply( HTTPClient_t *pxClient, BaseType_t xCode );
+static BaseType_t prvSendEmptyReply( HTTPClient_t *pxClient, BaseType_t xCode );
+static BaseType_t prvReadRequest( HTTPClient_t *pxClient );
+static BaseType_t prvRequestLineEnds( HTTPClient_t *pxClient );
+static BaseType_t prvProcessRequest( HTTPClient_t *pxClient );
+static BaseType_t prvReplyPending( HTTPClient_t *pxClient );
+
+#if( ipconfigHTTP_HAS_CHUNKED_REQUEST_HOOK != 0 )
+	static BaseType_t prvSendChunk( HTTPClient_t *pxClient, const char *pcData, size_t uxLength );
+	static BaseType_t prvSendChunks( HTTPClient_t *pxClient );
+#endif
+
+#if( ipconfigHTTP_CONTENT_CACHE_ENTRIES > 0 )
+	/* One representation of a cached file: the plain contents, or the
+	contents of "<name>.gz". */
+	typedef struct xHTTP_CACHED_BODY
+	{
+		char pcHeader[ 192 ];	/* The reply header, except "Connection" and the empty line. */
+		uint8_t *pucData;
+		size_t uxLength;
+		uint32_t ulETag;		/* A FNV-1a hash of the data. */
+	} HTTPCachedBody_t;
+
+	typedef struct xHTTP_CACHE_ENTRY
+	{
+		char pcFilename[ ffconfigMAX_FILENAME ];	/* Empty when the entry is out of date. */
+		uint32_t ulFileSize;
+		uint32_t ulModified;
+		TickType_t xLastChecked;
+		TickType_t xLastUsed;
+		UBaseType_t uxUsers;	/* The number of clients sending from this entry. */
+		HTTPCachedBody_t xPlain;
+		HTTPCachedBody_t xGzip;	/* pucData is NULL when there is no "<name>.gz". */
+	} HTTPCacheEntry_t;
+
+	static HTTPCacheEntry_t *prvCacheLookup( TCPServer_t *pxServer, const char *pcFilename );
+	static HTTPCacheEntry_t *prvCacheInsert( HTTPClient_t *pxClient );
+	static BaseType_t prvCacheLoadBody( HTTPCachedBody_t *pxBody, FF_FILE *pxFile, const char *pcType, const char *pcExtra );
+	static void prvCacheFree( HTTPCacheEntry_t *pxEntry );
+	static void prvCacheRelease( HTTPClient_t *pxClient );
+	static BaseType_t prvSendCachedFile( HTTPClient_t *pxClient, HTTPCacheEntry_t *pxEntry );
+	static BaseType_t prvSendCachedData( HTTPClient_t *pxClient );
+#endif
 
 static const char pcEmptyString[1] = { '\0' };
 
@@ -117,6 +167,12 @@ HTTPClient_t *pxClient = ( HTTPClient_t * ) pxTCPClient;
 		pxClient->xSocket = FREERTOS_NO_SOCKET;
 	}
 	prvFileClose( pxClient );
+
+	#if( ipconfigHTTP_CONTENT_CACHE_ENTRIES > 0 )
+	{
+		prvCacheRelease( pxClient );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -141,15 +197,13 @@ BaseType_t xRc;
 
 	xRc = snprintf( pcBuffer, sizeof( pxParent->pcFileBuffer ),
 		"HTTP/1.1 %d %s\r\n"
-#if	USE_HTML_CHUNKS
-		"Transfer-Encoding: chunked\r\n"
-#endif
 		"Content-Type: %s\r\n"
-		"Connection: keep-alive\r\n"
+		"Connection: %s\r\n"
 		"%s\r\n",
 		( int ) xCode,
 		webCodename (xCode),
 		pxParent->pcContentsType[0] ? pxParent->pcContentsType : "text/html",
+		pxClient->bits.bCloseConnection ? "close" : "keep-alive",
 		pxParent->pcExtraContents );
 
 	pxParent->pcContentsType[0] = '\0';
@@ -162,10 +216,101 @@ BaseType_t xRc;
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvSendEmptyReply( HTTPClient_t *pxClient, BaseType_t xCode )
+{
+	/* Without a Content-Length, the browser would wait for the body until
+	the connection is closed. */
+	snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+		"Content-Length: 0\r\n" );
+
+	return prvSendReply( pxClient, xCode );
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigHTTP_HAS_CHUNKED_REQUEST_HOOK != 0 )
+
+	static BaseType_t prvSendChunk( HTTPClient_t *pxClient, const char *pcData, size_t uxLength )
+	{
+	char pcChunkSize[ httpCHUNK_OVERHEAD ];
+	BaseType_t xRc;
+
+		/* A chunk is its size in hex, the data, and a CRLF.  A chunk of
+		size zero ends the body. */
+		xRc = snprintf( pcChunkSize, sizeof( pcChunkSize ), "%x\r\n", ( unsigned ) uxLength );
+		xRc = FreeRTOS_send( pxClient->xSocket, pcChunkSize, xRc, 0 );
+		if( ( xRc >= 0 ) && ( uxLength > 0u ) )
+		{
+			xRc = FreeRTOS_send( pxClient->xSocket, pcData, uxLength, 0 );
+		}
+		if( xRc >= 0 )
+		{
+			xRc = FreeRTOS_send( pxClient->xSocket, "\r\n", 2, 0 );
+		}
+
+		return xRc;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvSendChunks( HTTPClient_t *pxClient )
+	{
+	size_t uxSpace;
+	size_t uxCount;
+	size_t uxLength;
+	size_t uxBudget = ipconfigTCP_SERVER_WORK_BUDGET;
+	BaseType_t xRc = 0;
+
+		for( ;; )
+		{
+			uxSpace = FreeRTOS_tx_space( pxClient->xSocket );
+			if( ( uxSpace <= httpCHUNK_OVERHEAD ) || ( uxBudget == 0u ) )
+			{
+				break;
+			}
+
+			/* Ask for no more than what fits in the TX stream, so the chunk
+			can be sent without blocking. */
+			uxCount = FreeRTOS_min_uint32( uxSpace - httpCHUNK_OVERHEAD, sizeof( pcFILE_BUFFER ) );
+			uxCount = FreeRTOS_min_uint32( uxCount, uxBudget );
+
+			uxLength = uxApplicationHTTPHandleChunkedRequestHook( pxClient->pcUrlData, pxClient->uxChunkOffset, pcFILE_BUFFER, uxCount );
+			if( uxLength > uxCount )
+			{
+				uxLength = uxCount;
+			}
+
+			xRc = prvSendChunk( pxClient, pcFILE_BUFFER, uxLength );
+			if( ( xRc < 0 ) || ( uxLength == 0u ) )
+			{
+				/* The last chunk has been sent, or the connection is lost. */
+				pxClient->bits.bChunked = pdFALSE_UNSIGNED;
+				break;
+			}
+			pxClient->uxChunkOffset += uxLength;
+			uxBudget -= uxLength;
+		}
+
+		if( pxClient->bits.bChunked == pdFALSE_UNSIGNED )
+		{
+			FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+		}
+		else
+		{
+			FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+		}
+
+		return xRc;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigHTTP_HAS_CHUNKED_REQUEST_HOOK */
+
 static BaseType_t prvSendFile( HTTPClient_t *pxClient )
 {
 size_t uxSpace;
 size_t uxCount;
+size_t uxItemsRead;
+size_t uxBudget = ipconfigTCP_SERVER_WORK_BUDGET;
+char *pcBuffer;
 BaseType_t xRc = 0;
 
 	if( pxClient->bits.bReplySent == pdFALSE_UNSIGNED )
@@ -173,11 +318,28 @@ BaseType_t xRc = 0;
 		pxClient->bits.bReplySent = pdTRUE_UNSIGNED;
 
 		strcpy( pxClient->pxParent->pcContentsType, pcGetContentsType( pxClient->pcCurrentFilename ) );
-		snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
-			"Content-Length: %d\r\n", ( int ) pxClient->uxBytesLeft );
+		if( pxClient->bits.bRange != pdFALSE_UNSIGNED )
+		{
+			snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+				"Content-Length: %u\r\n"
+				"Content-Range: bytes %u-%u/%u\r\n",
+				( unsigned ) pxClient->uxBytesLeft,
+				( unsigned ) pxClient->uxRangeFirst,
+				( unsigned ) pxClient->uxRangeLast,
+				( unsigned ) pxClient->pxFileHandle->ulFileSize );
 
-		/* "Requested file action OK". */
-		xRc = prvSendReply( pxClient, WEB_REPLY_OK );
+			/* "Partial Content". */
+			xRc = prvSendReply( pxClient, WEB_PARTIAL_CONTENT );
+		}
+		else
+		{
+			snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+				"Content-Length: %d\r\n"
+				"Accept-Ranges: bytes\r\n", ( int ) pxClient->uxBytesLeft );
+
+			/* "Requested file action OK". */
+			xRc = prvSendReply( pxClient, WEB_REPLY_OK );
+		}
 	}
 
 	if( xRc >= 0 ) do
@@ -193,16 +355,68 @@ BaseType_t xRc = 0;
 			uxCount = uxSpace;
 		}
 
+		/* Leave the rest for the next call, to give the other clients a turn. */
+		if( uxCount > uxBudget )
+		{
+			uxCount = uxBudget;
+		}
+
 		if( uxCount > 0u )
 		{
-			if( uxCount > sizeof( pxClient->pxParent->pcFileBuffer ) )
+			pcBuffer = pcFILE_BUFFER;
+
+			#if( ipconfigHTTP_TX_ZERO_COPY != 0 )
 			{
-				uxCount = sizeof( pxClient->pxParent->pcFileBuffer );
+			char *pcHead;
+			BaseType_t xBufferLength;
+			size_t uxPosition;
+
+				/* FreeRTOS_get_tx_head() returns a direct pointer to the TX
+				stream, and sets xBufferLength to the space up to where the
+				stream wraps around. */
+				pcHead = ( char * ) FreeRTOS_get_tx_head( pxClient->xSocket, &xBufferLength );
+				if( ( pcHead != NULL ) && ( xBufferLength >= 512 ) )
+				{
+					pcBuffer = pcHead;
+					uxCount = FreeRTOS_min_uint32( uxCount, ( uint32_t ) xBufferLength );
+
+					/* Read whole sectors, which +FAT copies without passing
+					them through its sector cache.  A range may start in the
+					middle of a sector: stop at a sector boundary, so that the
+					next reads are aligned. */
+					if( ( pxClient->uxBytesLeft > uxCount ) && ( uxCount >= 512u ) )
+					{
+						uxPosition = ( size_t ) ff_ftell( pxClient->pxFileHandle );
+						uxCount = ( ( uxPosition + uxCount ) & ~( ( size_t ) 512u - 1u ) ) - uxPosition;
+					}
+				}
+			}
+			#endif /* ipconfigHTTP_TX_ZERO_COPY */
+
+			if( ( pcBuffer == pcFILE_BUFFER ) && ( uxCount > sizeof( pcFILE_BUFFER ) ) )
+			{
+				uxCount = sizeof( pcFILE_BUFFER );
+			}
+
+			uxItemsRead = ff_fread( pcBuffer, 1, uxCount, pxClient->pxFileHandle );
+			if( uxItemsRead != uxCount )
+			{
+				/* The promised Content-Length can not be met, drop the
+				connection. */
+				FreeRTOS_printf( ( "prvSendFile: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
+				pxClient->uxBytesLeft = 0u;
+				xRc = FreeRTOS_shutdown( pxClient->xSocket, FREERTOS_SHUT_RDWR );
+				break;
 			}
-			ff_fread( pxClient->pxParent->pcFileBuffer, 1, uxCount, pxClient->pxFileHandle );
 			pxClient->uxBytesLeft -= uxCount;
+			uxBudget -= uxCount;
 
-			xRc = FreeRTOS_send( pxClient->xSocket, pxClient->pxParent->pcFileBuffer, uxCount, 0 );
+			if( pcBuffer != pcFILE_BUFFER )
+			{
+				/* The data is in the TX stream already, only pass the length. */
+				pcBuffer = NULL;
+			}
+			xRc = FreeRTOS_send( pxClient->xSocket, pcBuffer, uxCount, 0 );
 			if( xRc < 0 )
 			{
 				break;
@@ -226,12 +440,390 @@ BaseType_t xRc = 0;
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvSendRange( HTTPClient_t *pxClient )
+{
+size_t uxFileSize = ( size_t ) pxClient->pxFileHandle->ulFileSize;
+BaseType_t xValid = pdFALSE;
+BaseType_t xRc;
+
+	if( pxClient->bits.bRangeSuffix != pdFALSE_UNSIGNED )
+	{
+		/* "bytes=-n": the last n bytes, or the whole file if it is shorter. */
+		if( ( pxClient->uxRangeLast > 0u ) && ( uxFileSize > 0u ) )
+		{
+			if( pxClient->uxRangeLast < uxFileSize )
+			{
+				pxClient->uxRangeFirst = uxFileSize - pxClient->uxRangeLast;
+			}
+			else
+			{
+				pxClient->uxRangeFirst = 0u;
+			}
+			pxClient->uxRangeLast = uxFileSize - 1u;
+			xValid = pdTRUE;
+		}
+	}
+	else if( pxClient->uxRangeFirst < uxFileSize )
+	{
+		/* "bytes=a-" or "bytes=a-b", b may lie beyond the end of the file. */
+		if( pxClient->uxRangeLast >= uxFileSize )
+		{
+			pxClient->uxRangeLast = uxFileSize - 1u;
+		}
+		xValid = pdTRUE;
+	}
+
+	if( ( xValid != pdFALSE ) && ( ff_fseek( pxClient->pxFileHandle, ( long ) pxClient->uxRangeFirst, FF_SEEK_SET ) == 0 ) )
+	{
+		/* The bytes before the range are not read at all. */
+		pxClient->uxBytesLeft = ( pxClient->uxRangeLast - pxClient->uxRangeFirst ) + 1u;
+		xRc = prvSendFile( pxClient );
+	}
+	else
+	{
+		prvFileClose( pxClient );
+		snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+			"Content-Length: 0\r\n"
+			"Content-Range: bytes */%u\r\n", ( unsigned ) uxFileSize );
+
+		/* "416 Range Not Satisfiable". */
+		xRc = prvSendReply( pxClient, WEB_RANGE_NOT_SATISFIABLE );
+	}
+
+	return xRc;
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigHTTP_CONTENT_CACHE_ENTRIES > 0 )
+
+	static BaseType_t prvCacheIsValid( HTTPCacheEntry_t *pxEntry )
+	{
+	FF_Stat_t xStatBuf;
+	BaseType_t xValid = pdFALSE;
+
+		/* Only the file itself is checked, "<name>.gz" is supposed to be
+		rewritten together with it. */
+		if( ff_stat( pxEntry->pcFilename, &xStatBuf ) == 0 )
+		{
+			if( xStatBuf.st_size == pxEntry->ulFileSize )
+			{
+				xValid = pdTRUE;
+			}
+			#if( ffconfigTIME_SUPPORT != 0 )
+			{
+				if( ( uint32_t ) xStatBuf.st_mtime != pxEntry->ulModified )
+				{
+					xValid = pdFALSE;
+				}
+			}
+			#endif
+		}
+
+		return xValid;
+	}
+	/*-----------------------------------------------------------*/
+
+	static HTTPCacheEntry_t *prvCacheLookup( TCPServer_t *pxServer, const char *pcFilename )
+	{
+	HTTPCacheEntry_t *pxEntry = NULL;
+	TickType_t xNow = xTaskGetTickCount();
+	BaseType_t xIndex;
+
+		for( xIndex = 0; xIndex < ipconfigHTTP_CONTENT_CACHE_ENTRIES; xIndex++ )
+		{
+			pxEntry = pxServer->pxContentCache[ xIndex ];
+			if( ( pxEntry != NULL ) && ( strcmp( pxEntry->pcFilename, pcFilename ) == 0 ) )
+			{
+				break;
+			}
+			pxEntry = NULL;
+		}
+
+		if( ( pxEntry != NULL ) && ( ( xNow - pxEntry->xLastChecked ) >= pdMS_TO_TICKS( ipconfigHTTP_CONTENT_CACHE_CHECK_MS ) ) )
+		{
+			if( prvCacheIsValid( pxEntry ) != pdFALSE )
+			{
+				pxEntry->xLastChecked = xNow;
+			}
+			else
+			{
+				/* The file has changed.  Clients may still be sending the old
+				contents, the entry will be re-used by prvCacheInsert(). */
+				FreeRTOS_printf( ( "prvCacheLookup: '%s' has changed\n", pcFilename ) );
+				pxEntry->pcFilename[ 0 ] = '\0';
+				pxEntry = NULL;
+			}
+		}
+
+		return pxEntry;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvCacheLoadBody( HTTPCachedBody_t *pxBody, FF_FILE *pxFile, const char *pcType, const char *pcExtra )
+	{
+	size_t uxIndex;
+	uint32_t ulHash = 2166136261ul;
+	BaseType_t xResult = pdFAIL;
+
+		pxBody->uxLength = ( size_t ) pxFile->ulFileSize;
+		pxBody->pucData = ( uint8_t * ) pvPortMalloc( pxBody->uxLength + 1u );
+
+		if( pxBody->pucData != NULL )
+		{
+			if( ff_fread( pxBody->pucData, 1, pxBody->uxLength, pxFile ) == pxBody->uxLength )
+			{
+				for( uxIndex = 0u; uxIndex < pxBody->uxLength; uxIndex++ )
+				{
+					ulHash = ( ulHash ^ pxBody->pucData[ uxIndex ] ) * 16777619ul;
+				}
+				pxBody->ulETag = ulHash;
+
+				snprintf( pxBody->pcHeader, sizeof( pxBody->pcHeader ),
+					"HTTP/1.1 %d %s\r\n"
+					"Content-Type: %s\r\n"
+					"Content-Length: %u\r\n"
+					"ETag: \"%08lx\"\r\n"
+					"%s",
+					WEB_REPLY_OK,
+					webCodename( WEB_REPLY_OK ),
+					pcType,
+					( unsigned ) pxBody->uxLength,
+					( unsigned long ) ulHash,
+					pcExtra );
+				xResult = pdPASS;
+			}
+			else
+			{
+				vPortFree( pxBody->pucData );
+				pxBody->pucData = NULL;
+			}
+		}
+
+		return xResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCacheFree( HTTPCacheEntry_t *pxEntry )
+	{
+		if( pxEntry->xPlain.pucData != NULL )
+		{
+			vPortFree( pxEntry->xPlain.pucData );
+		}
+		if( pxEntry->xGzip.pucData != NULL )
+		{
+			vPortFree( pxEntry->xGzip.pucData );
+		}
+		vPortFree( pxEntry );
+	}
+	/*-----------------------------------------------------------*/
+
+	static HTTPCacheEntry_t *prvCacheInsert( HTTPClient_t *pxClient )
+	{
+	TCPServer_t *pxServer = pxClient->pxParent;
+	HTTPCacheEntry_t *pxEntry = NULL;
+	HTTPCacheEntry_t *pxOld;
+	BaseType_t xIndex;
+	BaseType_t xSlot = -1;
+	FF_FILE *pxGzFile;
+	const char *pcType;
+	TickType_t xNow = xTaskGetTickCount();
+
+		if( pxClient->uxBytesLeft <= ipconfigHTTP_CONTENT_CACHE_MAX_SIZE )
+		{
+			/* Take an empty slot, or else an entry that is out of date, or
+			else the entry that was used least recently.  Entries that are
+			being sent can not be replaced. */
+			for( xIndex = 0; xIndex < ipconfigHTTP_CONTENT_CACHE_ENTRIES; xIndex++ )
+			{
+				pxOld = pxServer->pxContentCache[ xIndex ];
+				if( pxOld == NULL )
+				{
+					xSlot = xIndex;
+					break;
+				}
+				if( pxOld->uxUsers == 0u )
+				{
+					if( pxOld->pcFilename[ 0 ] == '\0' )
+					{
+						xSlot = xIndex;
+						break;
+					}
+					if( ( xSlot < 0 ) ||
+						( ( xNow - pxOld->xLastUsed ) > ( xNow - pxServer->pxContentCache[ xSlot ]->xLastUsed ) ) )
+					{
+						xSlot = xIndex;
+					}
+				}
+			}
+		}
+
+		if( xSlot >= 0 )
+		{
+			pxEntry = ( HTTPCacheEntry_t * ) pvPortMalloc( sizeof( *pxEntry ) );
+		}
+
+		if( pxEntry != NULL )
+		{
+			memset( pxEntry, '\0', sizeof( *pxEntry ) );
+			pcType = pcGetContentsType( pxClient->pcCurrentFilename );
+
+			/* The command buffer is not in use while a request is handled. */
+			snprintf( pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ), "%s.gz", pxClient->pcCurrentFilename );
+			pxGzFile = ff_fopen( pcCOMMAND_BUFFER, "rb" );
+			if( pxGzFile != NULL )
+			{
+				if( pxGzFile->ulFileSize <= ipconfigHTTP_CONTENT_CACHE_MAX_SIZE )
+				{
+					prvCacheLoadBody( &( pxEntry->xGzip ), pxGzFile, pcType,
+						"Content-Encoding: gzip\r\n"
+						"Vary: Accept-Encoding\r\n" );
+				}
+				ff_fclose( pxGzFile );
+			}
+
+			if( prvCacheLoadBody( &( pxEntry->xPlain ), pxClient->pxFileHandle, pcType,
+					( pxEntry->xGzip.pucData != NULL ) ? "Accept-Ranges: bytes\r\nVary: Accept-Encoding\r\n" : "Accept-Ranges: bytes\r\n" ) == pdPASS )
+			{
+				strcpy( pxEntry->pcFilename, pxClient->pcCurrentFilename );
+				pxEntry->ulFileSize = pxClient->pxFileHandle->ulFileSize;
+				#if( ffconfigTIME_SUPPORT != 0 )
+				{
+				FF_Stat_t xStatBuf;
+
+					if( ff_stat( pxEntry->pcFilename, &xStatBuf ) == 0 )
+					{
+						pxEntry->ulModified = ( uint32_t ) xStatBuf.st_mtime;
+					}
+				}
+				#endif
+				pxEntry->xLastChecked = xNow;
+				pxEntry->xLastUsed = xNow;
+
+				if( pxServer->pxContentCache[ xSlot ] != NULL )
+				{
+					prvCacheFree( pxServer->pxContentCache[ xSlot ] );
+				}
+				pxServer->pxContentCache[ xSlot ] = pxEntry;
+
+				/* The file is not needed any more, the reply will be sent
+				from RAM. */
+				prvFileClose( pxClient );
+			}
+			else
+			{
+				/* Let prvSendFile() read the file from the start. */
+				ff_fseek( pxClient->pxFileHandle, 0, FF_SEEK_SET );
+				prvCacheFree( pxEntry );
+				pxEntry = NULL;
+			}
+		}
+
+		return pxEntry;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCacheRelease( HTTPClient_t *pxClient )
+	{
+		if( pxClient->pxCacheEntry != NULL )
+		{
+			pxClient->pxCacheEntry->uxUsers--;
+			pxClient->pxCacheEntry = NULL;
+			pxClient->pucCacheData = NULL;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvSendCachedData( HTTPClient_t *pxClient )
+	{
+	size_t uxCount;
+	BaseType_t xRc = 0;
+
+		uxCount = FreeRTOS_min_uint32( pxClient->uxBytesLeft, ( uint32_t ) FreeRTOS_tx_space( pxClient->xSocket ) );
+		uxCount = FreeRTOS_min_uint32( uxCount, ipconfigTCP_SERVER_WORK_BUDGET );
+
+		if( uxCount > 0u )
+		{
+			xRc = FreeRTOS_send( pxClient->xSocket, pxClient->pucCacheData, uxCount, 0 );
+			if( xRc > 0 )
+			{
+				pxClient->pucCacheData += xRc;
+				pxClient->uxBytesLeft -= ( size_t ) xRc;
+			}
+		}
+
+		if( ( pxClient->uxBytesLeft == 0u ) || ( xRc < 0 ) )
+		{
+			FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+			prvCacheRelease( pxClient );
+		}
+		else
+		{
+			FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+		}
+
+		return xRc;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvSendCachedFile( HTTPClient_t *pxClient, HTTPCacheEntry_t *pxEntry )
+	{
+	HTTPCachedBody_t *pxBody = &( pxEntry->xPlain );
+	BaseType_t xRc;
+
+		pxEntry->xLastUsed = xTaskGetTickCount();
+
+		if( ( pxClient->bits.bAcceptGzip != pdFALSE_UNSIGNED ) && ( pxEntry->xGzip.pucData != NULL ) )
+		{
+			pxBody = &( pxEntry->xGzip );
+		}
+
+		if( ( pxClient->bits.bIfNoneMatch != pdFALSE_UNSIGNED ) && ( pxClient->ulIfNoneMatch == pxBody->ulETag ) )
+		{
+			/* The browser has this version already. */
+			snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+				"ETag: \"%08lx\"\r\n", ( unsigned long ) pxBody->ulETag );
+			xRc = prvSendReply( pxClient, WEB_NOT_MODIFIED );
+		}
+		else
+		{
+			/* Only the "Connection" line depends on the request. */
+			xRc = FreeRTOS_send( pxClient->xSocket, pxBody->pcHeader, strlen( pxBody->pcHeader ), 0 );
+			if( xRc >= 0 )
+			{
+				if( pxClient->bits.bCloseConnection != pdFALSE_UNSIGNED )
+				{
+					xRc = FreeRTOS_send( pxClient->xSocket, "Connection: close\r\n\r\n", 23, 0 );
+				}
+				else
+				{
+					xRc = FreeRTOS_send( pxClient->xSocket, "Connection: keep-alive\r\n\r\n", 28, 0 );
+				}
+			}
+			if( xRc >= 0 )
+			{
+				pxEntry->uxUsers++;
+				pxClient->pxCacheEntry = pxEntry;
+				pxClient->pucCacheData = pxBody->pucData;
+				pxClient->uxBytesLeft = pxBody->uxLength;
+				xRc = prvSendCachedData( pxClient );
+			}
+		}
+
+		return xRc;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigHTTP_CONTENT_CACHE_ENTRIES */
+
 static BaseType_t prvOpenURL( HTTPClient_t *pxClient )
 {
 BaseType_t xRc;
 char pcSlash[ 2 ];
+#if( ipconfigHTTP_CONTENT_CACHE_ENTRIES > 0 )
+	HTTPCacheEntry_t *pxEntry;
+#endif
 
-	pxClient->bits.ulFlags = 0;
+	pxClient->bits.bReplySent = pdFALSE_UNSIGNED;
 
 	#if( ipconfigHTTP_HAS_HANDLE_REQUEST_HOOK != 0 )
 	{
@@ -258,6 +850,45 @@ char pcSlash[ 2 ];
 	}
 	#endif /* ipconfigHTTP_HAS_HANDLE_REQUEST_HOOK */
 
+	#if( ipconfigHTTP_HAS_CHUNKED_REQUEST_HOOK != 0 )
+	{
+		if( strchr( pxClient->pcUrlData, ipconfigHTTP_REQUEST_CHARACTER ) != NULL )
+		{
+		size_t xResult;
+
+			/* The first part is produced before the reply is sent: when
+			there is none, the request is not for this hook.  It is stored in
+			the command buffer, because prvSendReply() uses the file buffer. */
+			xResult = uxApplicationHTTPHandleChunkedRequestHook( pxClient->pcUrlData, 0u, pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ) );
+			if( xResult > 0 )
+			{
+				if( xResult > sizeof( pcCOMMAND_BUFFER ) )
+				{
+					xResult = sizeof( pcCOMMAND_BUFFER );
+				}
+
+				strcpy( pxClient->pxParent->pcContentsType, "text/html" );
+				snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+					"Transfer-Encoding: chunked\r\n" );
+				xRc = prvSendReply( pxClient, WEB_REPLY_OK );	/* "Requested file action OK" */
+				if( xRc > 0 )
+				{
+					xRc = prvSendChunk( pxClient, pcCOMMAND_BUFFER, xResult );
+				}
+				if( xRc >= 0 )
+				{
+					pxClient->uxChunkOffset = xResult;
+					pxClient->bits.bChunked = pdTRUE_UNSIGNED;
+					xRc = prvSendChunks( pxClient );
+				}
+				/* Although against the coding standard of FreeRTOS, a return is
+				done here  to simplify this conditional code. */
+				return xRc;
+			}
+		}
+	}
+	#endif /* ipconfigHTTP_HAS_CHUNKED_REQUEST_HOOK */
+
 	if( pxClient->pcUrlData[ 0 ] != '/' )
 	{
 		/* Insert a slash before the file name. */
@@ -274,6 +905,22 @@ char pcSlash[ 2 ];
 		pcSlash,
 		pxClient->pcUrlData);
 
+	#if( ipconfigHTTP_CONTENT_CACHE_ENTRIES > 0 )
+	{
+		/* A range is always read from the file itself. */
+		if( pxClient->bits.bRange == pdFALSE_UNSIGNED )
+		{
+			pxEntry = prvCacheLookup( pxClient->pxParent, pxClient->pcCurrentFilename );
+			if( pxEntry != NULL )
+			{
+				/* Although against the coding standard of FreeRTOS, a return is
+				done here  to simplify this conditional code. */
+				return prvSendCachedFile( pxClient, pxEntry );
+			}
+		}
+	}
+	#endif /* ipconfigHTTP_CONTENT_CACHE_ENTRIES */
+
 	pxClient->pxFileHandle = ff_fopen( pxClient->pcCurrentFilename, "rb" );
 
 	FreeRTOS_printf( ( "Open file '%s': %s\n", pxClient->pcCurrentFilename,
@@ -282,12 +929,30 @@ char pcSlash[ 2 ];
 	if( pxClient->pxFileHandle == NULL )
 	{
 		/* "404 File not found". */
-		xRc = prvSendReply( pxClient, WEB_NOT_FOUND );
+		xRc = prvSendEmptyReply( pxClient, WEB_NOT_FOUND );
 	}
 	else
 	{
 		pxClient->uxBytesLeft = ( size_t ) pxClient->pxFileHandle->ulFileSize;
-		xRc = prvSendFile( pxClient );
+
+		if( pxClient->bits.bRange != pdFALSE_UNSIGNED )
+		{
+			xRc = prvSendRange( pxClient );
+		}
+		else
+		{
+			#if( ipconfigHTTP_CONTENT_CACHE_ENTRIES > 0 )
+			pxEntry = prvCacheInsert( pxClient );
+			if( pxEntry != NULL )
+			{
+				xRc = prvSendCachedFile( pxClient, pxEntry );
+			}
+			else
+			#endif /* ipconfigHTTP_CONTENT_CACHE_ENTRIES */
+			{
+				xRc = prvSendFile( pxClient );
+			}
+		}
 	}
 
 	return xRc;
@@ -317,6 +982,7 @@ BaseType_t xResult = 0;
 		{
 			FreeRTOS_printf( ( "prvProcessCmd: Not implemented: %s\n",
 				xWebCommands[xIndex].pcCommandName ) );
+			xResult = prvSendEmptyReply( pxClient, WEB_NOT_IMPLEMENTED );
 		}
 		break;
 	}
@@ -325,74 +991,388 @@ BaseType_t xResult = 0;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xHTTPClientWork( TCPClient_t *pxTCPClient )
+static void prvParseRange( HTTPClient_t *pxClient, const char *pcValue )
 {
-BaseType_t xRc;
-HTTPClient_t *pxClient = ( HTTPClient_t * ) pxTCPClient;
+char *pcEnd = NULL;
+BaseType_t xValid = pdFALSE;
 
-	if( pxClient->pxFileHandle != NULL )
+	for( ; *pcValue == ' '; pcValue++ )
 	{
-		prvSendFile( pxClient );
 	}
 
-	xRc = FreeRTOS_recv( pxClient->xSocket, ( void * )pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ), 0 );
-
-	if( xRc > 0 )
+	/* Only a single range is served.  For a list of ranges the whole file is
+	sent, which a server is allowed to do. */
+	if( ( strncasecmp( pcValue, "bytes=", 6 ) == 0 ) && ( strchr( pcValue, ',' ) == NULL ) )
 	{
-	BaseType_t xIndex;
-	const char *pcEndOfCmd;
-	const struct xWEB_COMMAND *curCmd;
-	char *pcBuffer = pcCOMMAND_BUFFER;
-
-		if( xRc < ( BaseType_t ) sizeof( pcCOMMAND_BUFFER ) )
+		pcValue += 6;
+		if( ( pcValue[ 0 ] == '-' ) && ( pcValue[ 1 ] >= '0' ) && ( pcValue[ 1 ] <= '9' ) )
 		{
-			pcBuffer[ xRc ] = '\0';
+			/* "bytes=-500": the last 500 bytes. */
+			pxClient->bits.bRangeSuffix = pdTRUE_UNSIGNED;
+			pxClient->uxRangeFirst = 0u;
+			pxClient->uxRangeLast = ( size_t ) strtoul( pcValue + 1, &pcEnd, 10 );
+			xValid = pdTRUE;
 		}
-		while( xRc && ( pcBuffer[ xRc - 1 ] == 13 || pcBuffer[ xRc - 1 ] == 10 ) )
+		else if( ( pcValue[ 0 ] >= '0' ) && ( pcValue[ 0 ] <= '9' ) )
 		{
-			pcBuffer[ --xRc ] = '\0';
+			pxClient->bits.bRangeSuffix = pdFALSE_UNSIGNED;
+			pxClient->uxRangeFirst = ( size_t ) strtoul( pcValue, &pcEnd, 10 );
+			if( *pcEnd == '-' )
+			{
+				pcValue = pcEnd + 1;
+				if( ( pcValue[ 0 ] >= '0' ) && ( pcValue[ 0 ] <= '9' ) )
+				{
+					/* "bytes=500-999". */
+					pxClient->uxRangeLast = ( size_t ) strtoul( pcValue, &pcEnd, 10 );
+					xValid = ( pxClient->uxRangeLast >= pxClient->uxRangeFirst ) ? pdTRUE : pdFALSE;
+				}
+				else
+				{
+					/* "bytes=500-": up to the end of the file. */
+					pxClient->uxRangeLast = ~( ( size_t ) 0u );
+					pcEnd = ( char * ) pcValue;
+					xValid = pdTRUE;
+				}
+			}
 		}
-		pcEndOfCmd = pcBuffer + xRc;
+	}
+
+	if( ( xValid != pdFALSE ) && ( *pcEnd != '\0' ) && ( *pcEnd != ' ' ) )
+	{
+		xValid = pdFALSE;
+	}
 
-		curCmd = xWebCommands;
+	/* A range that can not be parsed is ignored, as if it wasn't there. */
+	pxClient->bits.bRange = ( xValid != pdFALSE ) ? pdTRUE_UNSIGNED : pdFALSE_UNSIGNED;
+}
+/*-----------------------------------------------------------*/
 
-		/* Pointing to "/index.html HTTP/1.1". */
-		pxClient->pcUrlData = pcBuffer;
+static BaseType_t prvRequestLineEnds( HTTPClient_t *pxClient )
+{
+BaseType_t xComplete = pdFALSE;
+BaseType_t xTruncated;
+const char *pcValue;
 
-		/* Pointing to "HTTP/1.1". */
-		pxClient->pcRestData = pcEmptyString;
+	if( pxClient->bits.bInRequest == pdFALSE_UNSIGNED )
+	{
+		/* Empty lines in front of a request line are ignored. */
+		if( pxClient->uxRequestLength > 0u )
+		{
+			pxClient->pcRequest[ pxClient->uxRequestLength ] = '\0';
+			pxClient->bits.bInRequest = pdTRUE_UNSIGNED;
+			pxClient->uxHeaderLength = 0u;
 
-		/* Last entry is "ECMD_UNK". */
-		for( xIndex = 0; xIndex < WEB_CMD_COUNT - 1; xIndex++, curCmd++ )
+			/* A HTTP/1.0 client expects the connection to be closed, unless
+			it asks to keep it alive. */
+			if( strstr( pxClient->pcRequest, "HTTP/1.0" ) != NULL )
+			{
+				pxClient->bits.bCloseConnection = pdTRUE_UNSIGNED;
+			}
+		}
+	}
+	else if( pxClient->uxHeaderLength == 0u )
+	{
+		/* An empty line ends the headers: the request is complete. */
+		pxClient->bits.bInRequest = pdFALSE_UNSIGNED;
+		if( pxClient->bits.bIfRange != pdFALSE_UNSIGNED )
 		{
-		BaseType_t xLength;
+			/* The validator in "If-Range" is not checked, sending the whole
+			file is always correct. */
+			pxClient->bits.bRange = pdFALSE_UNSIGNED;
+		}
+		pxClient->uxRequestLength = 0u;
+		xComplete = pdTRUE;
+	}
+	else
+	{
+		pxClient->pcHeader[ pxClient->uxHeaderLength ] = '\0';
+		xTruncated = ( pxClient->uxHeaderLength >= sizeof( pxClient->pcHeader ) - 1u ) ? pdTRUE : pdFALSE;
+		pxClient->uxHeaderLength = 0u;
 
-			xLength = curCmd->xCommandLength;
-			if( ( xRc >= xLength ) && ( memcmp( curCmd->pcCommandName, pcBuffer, xLength ) == 0 ) )
+		if( strncasecmp( pxClient->pcHeader, "Connection:", 11 ) == 0 )
+		{
+			for( pcValue = pxClient->pcHeader + 11; *pcValue == ' '; pcValue++ )
+			{
+			}
+			if( strncasecmp( pcValue, "close", 5 ) == 0 )
+			{
+				pxClient->bits.bCloseConnection = pdTRUE_UNSIGNED;
+			}
+			else if( strncasecmp( pcValue, "keep-alive", 10 ) == 0 )
+			{
+				pxClient->bits.bCloseConnection = pdFALSE_UNSIGNED;
+			}
+		}
+		else if( strncasecmp( pxClient->pcHeader, "Content-Length:", 15 ) == 0 )
+		{
+			/* The body will be skipped once the headers are complete. */
+			pxClient->uxContentLeft = ( size_t ) strtoul( pxClient->pcHeader + 15, NULL, 10 );
+		}
+		else if( strncasecmp( pxClient->pcHeader, "If-None-Match:", 14 ) == 0 )
+		{
+			/* The ETags of this server are 8 hex digits within quotes, any
+			other ETag won't match. */
+			pcValue = strchr( pxClient->pcHeader + 14, '"' );
+			if( pcValue != NULL )
+			{
+				pxClient->ulIfNoneMatch = ( uint32_t ) strtoul( pcValue + 1, NULL, 16 );
+				pxClient->bits.bIfNoneMatch = pdTRUE_UNSIGNED;
+			}
+		}
+		else if( strncasecmp( pxClient->pcHeader, "Range:", 6 ) == 0 )
+		{
+			/* A line that did not fit might end in other digits. */
+			if( xTruncated == pdFALSE )
+			{
+				prvParseRange( pxClient, pxClient->pcHeader + 6 );
+			}
+		}
+		else if( strncasecmp( pxClient->pcHeader, "If-Range:", 9 ) == 0 )
+		{
+			pxClient->bits.bIfRange = pdTRUE_UNSIGNED;
+		}
+		else if( strncasecmp( pxClient->pcHeader, "Accept-Encoding:", 16 ) == 0 )
+		{
+			/* Only the start of the line is stored, "gzip" is normally
+			mentioned first. */
+			if( strstr( pxClient->pcHeader + 16, "gzip" ) != NULL )
 			{
-			char *pcLastPtr;
+				pxClient->bits.bAcceptGzip = pdTRUE_UNSIGNED;
+			}
+		}
+	}
 
-				pxClient->pcUrlData += xLength + 1;
-				for( pcLastPtr = (char *)pxClient->pcUrlData; pcLastPtr < pcEndOfCmd; pcLastPtr++ )
+	return xComplete;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReadRequest( HTTPClient_t *pxClient )
+{
+BaseType_t xRc;
+BaseType_t xIndex = 0;
+BaseType_t xComplete = pdFALSE;
+size_t uxSkip;
+char *pcBuffer = pcCOMMAND_BUFFER;
+char cChar;
+
+	/* Only peek at the data: the bytes up to the end of the current request
+	are taken from the stream further on.  Pipelined requests that follow it
+	stay in the stream until the reply to this request has been sent. */
+	xRc = FreeRTOS_recv( pxClient->xSocket, ( void * )pcBuffer, sizeof( pcCOMMAND_BUFFER ), FREERTOS_MSG_PEEK );
+
+	if( xRc > 0 )
+	{
+		while( ( xIndex < xRc ) && ( xComplete == pdFALSE ) )
+		{
+			if( ( pxClient->bits.bInRequest == pdFALSE_UNSIGNED ) && ( pxClient->uxContentLeft > 0u ) )
+			{
+				/* The body of the previous request is not used. */
+				uxSkip = FreeRTOS_min_uint32( pxClient->uxContentLeft, ( uint32_t ) ( xRc - xIndex ) );
+				pxClient->uxContentLeft -= uxSkip;
+				xIndex += ( BaseType_t ) uxSkip;
+			}
+			else
+			{
+				cChar = pcBuffer[ xIndex++ ];
+				if( cChar == '\n' )
+				{
+					xComplete = prvRequestLineEnds( pxClient );
+				}
+				else if( cChar == '\r' )
 				{
-					char ch = *pcLastPtr;
-					if( ( ch == '\0' ) || ( strchr( "\n\r \t", ch ) != NULL ) )
+					/* Lines end with CRLF, the LF is enough. */
+				}
+				else if( pxClient->bits.bInRequest == pdFALSE_UNSIGNED )
+				{
+					if( pxClient->uxRequestLength == 0u )
 					{
-						*pcLastPtr = '\0';
-						pxClient->pcRestData = pcLastPtr + 1;
-						break;
+						/* A new request starts. */
+						pxClient->bits.bRequestTooLong = pdFALSE_UNSIGNED;
+						pxClient->bits.bCloseConnection = pdFALSE_UNSIGNED;
+						pxClient->bits.bIfNoneMatch = pdFALSE_UNSIGNED;
+						pxClient->bits.bAcceptGzip = pdFALSE_UNSIGNED;
+						pxClient->bits.bRange = pdFALSE_UNSIGNED;
+						pxClient->bits.bIfRange = pdFALSE_UNSIGNED;
+					}
+					if( pxClient->uxRequestLength < sizeof( pxClient->pcRequest ) - 1u )
+					{
+						pxClient->pcRequest[ pxClient->uxRequestLength++ ] = cChar;
+					}
+					else
+					{
+						pxClient->bits.bRequestTooLong = pdTRUE_UNSIGNED;
 					}
 				}
-				break;
+				else if( pxClient->uxHeaderLength < sizeof( pxClient->pcHeader ) - 1u )
+				{
+					pxClient->pcHeader[ pxClient->uxHeaderLength++ ] = cChar;
+				}
+			}
+		}
+
+		/* Take the bytes that have been parsed from the stream.  Incomplete
+		requests are taken as well, their state is kept in pxClient. */
+		xRc = FreeRTOS_recv( pxClient->xSocket, ( void * )pcBuffer, xIndex, 0 );
+		if( xRc >= 0 )
+		{
+			xRc = xComplete;
+		}
+	}
+
+	return xRc;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvProcessRequest( HTTPClient_t *pxClient )
+{
+BaseType_t xRc;
+BaseType_t xIndex;
+const char *pcEndOfCmd;
+const struct xWEB_COMMAND *curCmd;
+char *pcBuffer = pxClient->pcRequest;
+
+	if( pxClient->bits.bRequestTooLong != pdFALSE_UNSIGNED )
+	{
+		/* The URL has been truncated, don't look it up. */
+		FreeRTOS_printf( ( "prvProcessRequest: request line too long\n" ) );
+		pcBuffer[ 0 ] = '\0';
+	}
+
+	xRc = ( BaseType_t ) strlen( pcBuffer );
+	pcEndOfCmd = pcBuffer + xRc;
+
+	curCmd = xWebCommands;
+
+	/* Pointing to "/index.html HTTP/1.1". */
+	pxClient->pcUrlData = pcBuffer;
+
+	/* Pointing to "HTTP/1.1". */
+	pxClient->pcRestData = pcEmptyString;
+
+	/* Last entry is "ECMD_UNK". */
+	for( xIndex = 0; xIndex < WEB_CMD_COUNT - 1; xIndex++, curCmd++ )
+	{
+	BaseType_t xLength;
+
+		xLength = curCmd->xCommandLength;
+		if( ( xRc >= xLength ) && ( memcmp( curCmd->pcCommandName, pcBuffer, xLength ) == 0 ) )
+		{
+		char *pcLastPtr;
+
+			pxClient->pcUrlData += xLength + 1;
+			for( pcLastPtr = (char *)pxClient->pcUrlData; pcLastPtr < pcEndOfCmd; pcLastPtr++ )
+			{
+				char ch = *pcLastPtr;
+				if( ( ch == '\0' ) || ( strchr( "\n\r \t", ch ) != NULL ) )
+				{
+					*pcLastPtr = '\0';
+					pxClient->pcRestData = pcLastPtr + 1;
+					break;
+				}
+			}
+			break;
+		}
+	}
+
+	/* Every request gets a reply, also the unknown ones, otherwise the next
+	request on this connection would never be handled. */
+	if( pxClient->bits.bRequestTooLong != pdFALSE_UNSIGNED )
+	{
+		xRc = prvSendEmptyReply( pxClient, WEB_BAD_REQUEST );
+	}
+	else
+	{
+		xRc = prvProcessCmd( pxClient, xIndex );
+	}
+
+	return xRc;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReplyPending( HTTPClient_t *pxClient )
+{
+BaseType_t xPending = pdFALSE;
+
+	if( ( pxClient->pxFileHandle != NULL ) || ( pxClient->bits.bChunked != pdFALSE_UNSIGNED ) )
+	{
+		xPending = pdTRUE;
+	}
+	#if( ipconfigHTTP_CONTENT_CACHE_ENTRIES > 0 )
+	else if( pxClient->pxCacheEntry != NULL )
+	{
+		xPending = pdTRUE;
+	}
+	#endif
+
+	return xPending;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xHTTPClientWork( TCPClient_t *pxTCPClient )
+{
+BaseType_t xRc = 0;
+HTTPClient_t *pxClient = ( HTTPClient_t * ) pxTCPClient;
+
+	/* The connection is persistent: it carries one request after the other.
+	A request is only read when the reply to the previous one is complete. */
+	if( pxClient->pxFileHandle != NULL )
+	{
+		xRc = prvSendFile( pxClient );
+	}
+	#if( ipconfigHTTP_HAS_CHUNKED_REQUEST_HOOK != 0 )
+	else if( pxClient->bits.bChunked != pdFALSE_UNSIGNED )
+	{
+		xRc = prvSendChunks( pxClient );
+	}
+	#endif
+	#if( ipconfigHTTP_CONTENT_CACHE_ENTRIES > 0 )
+	else if( pxClient->pxCacheEntry != NULL )
+	{
+		xRc = prvSendCachedData( pxClient );
+	}
+	#endif
+
+	if( ( xRc >= 0 ) && ( prvReplyPending( pxClient ) == pdFALSE ) )
+	{
+		if( pxClient->bits.bClosing != pdFALSE_UNSIGNED )
+		{
+			/* Discard whatever still comes in, until the peer has closed
+			the connection as well. */
+			xRc = FreeRTOS_recv( pxClient->xSocket, ( void * )pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ), 0 );
+		}
+		else
+		{
+			xRc = prvReadRequest( pxClient );
+			if( xRc > 0 )
+			{
+				xRc = prvProcessRequest( pxClient );
 			}
 		}
+	}
 
-		if( xIndex < ( WEB_CMD_COUNT - 1 ) )
+	if( xRc >= 0 )
+	{
+		if( prvReplyPending( pxClient ) != pdFALSE )
 		{
-			xRc = prvProcessCmd( pxClient, xIndex );
+			/* Don't get woken up by pipelined requests while the reply is
+			being sent, only by eSELECT_WRITE. */
+			FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_READ );
+		}
+		else
+		{
+			FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_READ );
+
+			if( ( pxClient->bits.bCloseConnection != pdFALSE_UNSIGNED ) &&
+				( pxClient->bits.bInRequest == pdFALSE_UNSIGNED ) &&
+				( pxClient->bits.bClosing == pdFALSE_UNSIGNED ) )
+			{
+				/* The client asked for "Connection: close". */
+				pxClient->bits.bClosing = pdTRUE_UNSIGNED;
+				FreeRTOS_shutdown( pxClient->xSocket, FREERTOS_SHUT_RDWR );
+			}
 		}
 	}
-	else if( xRc < 0 )
+	else
 	{
 		/* The connection will be closed and the client will be deleted. */
 		FreeRTOS_printf( ( "xHTTPClientWork: rc = %ld\n", xRc ) );
@@ -62,6 +62,100 @@
 
 #include "date_and_time.h"
 
+/* Largest correction applied to the rate of the clock, both to compensate
+the drift of the local oscillator and to slew out an offset, as with adjtime().
+In parts per billion. */
+#ifndef ntpdemoMAX_FREQUENCY_PPB
+	#define ntpdemoMAX_FREQUENCY_PPB		500000
+#endif
+
+/* Offsets larger than this are stepped rather than slewed, in ns. */
+#ifndef ntpdemoSTEP_THRESHOLD_NS
+	#define ntpdemoSTEP_THRESHOLD_NS		128000000LL
+#endif
+
+/* Range of the poll interval, as log2 seconds: 16 to 1024 seconds. */
+#ifndef ntpdemoMIN_POLL
+	#define ntpdemoMIN_POLL					4
+#endif
+#ifndef ntpdemoMAX_POLL
+	#define ntpdemoMAX_POLL					10
+#endif
+
+/* The poll interval doubles after ntpdemoPOLL_HYSTERESIS consecutive offsets
+below ntpdemoPOLL_INCREASE_NS and halves after any offset above
+ntpdemoPOLL_DECREASE_NS. On a network where half the round trip is larger,
+that is used instead for the lower limit and four times it for the upper
+limit: polling more often cannot do better than the network allows. */
+#ifndef ntpdemoPOLL_INCREASE_NS
+	#define ntpdemoPOLL_INCREASE_NS			250000LL
+#endif
+#ifndef ntpdemoPOLL_DECREASE_NS
+	#define ntpdemoPOLL_DECREASE_NS			1000000LL
+#endif
+#ifndef ntpdemoPOLL_HYSTERESIS
+	#define ntpdemoPOLL_HYSTERESIS			4
+#endif
+
+/* Number of past exchanges the clock filter chooses from. */
+#define ntpdemoFILTER_SAMPLES				8
+
+/* A sample's error is assumed to grow at this rate as it ages (the NTP
+dispersion rate), so that a fresh sample beats a stale one with a slightly
+shorter round trip. In parts per billion. */
+#define ntpdemoDISPERSION_PPB				15000
+
+/* The frequency is only re-estimated once two samples are far enough apart
+that their round trip uncertainty adds at most this much error, in ppb. */
+#define ntpdemoFREQUENCY_TOLERANCE_PPB		2000
+
+/* Weight of a new frequency estimate is 1 / ntpdemoFREQUENCY_GAIN. */
+#define ntpdemoFREQUENCY_GAIN				4
+
+/* How often the disciplined time is copied to the system clock, and how long
+to wait for a reply before asking again. */
+#define ntpdemoCLOCK_UPDATE_MS				1000
+#define ntpdemoRESPONSE_TIMEOUT_MS			5000
+
+/* A local clock which is never adjusted, in microseconds. Defaults to the tick
+count, so the resolution is one tick unless a finer clock is provided. */
+#ifndef ntpdemoLOCAL_MICROSECONDS
+	#define ntpdemoLOCAL_MICROSECONDS()		prvTickMicroseconds()
+	#define ntpdemoUSE_TICK_MICROSECONDS	1
+	static int64_t prvTickMicroseconds( void );
+#endif
+
+/* One exchange with the server, reduced to the instant half way through the
+round trip as seen by both clocks. Neither clock is ever adjusted, so samples
+stay valid however the disciplined clock is corrected afterwards. */
+typedef struct xNTP_SAMPLE
+{
+	int64_t llLocalUs;		/* Local clock, microseconds. */
+	int64_t llServerNs;		/* Server clock, ns since 1/1/1970. */
+	int64_t llDelayNs;		/* Round trip less the time spent in the server. */
+} NTPSample_t;
+
+/* State of the disciplined clock. Its time is llBaseNs at local time
+llBaseLocalUs and advances at the local rate corrected by lFrequencyPpb, plus
+lSlewRatePpb until llSlewRemainingNs has been used up. */
+typedef struct xNTP_DISCIPLINE
+{
+	BaseType_t xSynchronised;
+	int64_t llBaseNs;
+	int64_t llBaseLocalUs;
+	int32_t lFrequencyPpb;
+	BaseType_t xFrequencyValid;
+	int64_t llSlewRemainingNs;
+	int32_t lSlewRatePpb;
+	NTPSample_t xSamples[ ntpdemoFILTER_SAMPLES ];
+	BaseType_t xSampleCount;
+	BaseType_t xNextSample;
+	NTPSample_t xAnchor;	/* Sample against which the next frequency estimate is made. */
+	BaseType_t xPollExponent;
+	BaseType_t xGoodOffsets;
+	int64_t llLastOffsetNs;
+} NTPDiscipline_t;
+
 enum EStatus {
 	EStatusLookup,
 	EStatusAsking,
@@ -92,6 +186,14 @@ static Socket_t xUDPSocket = NULL;
 static TaskHandle_t xNTPTaskhandle = NULL;
 static TickType_t uxSendTime;
 
+static NTPDiscipline_t xDiscipline;
+
+/* The request in flight: replies are only accepted if they echo its transmit
+timestamp. */
+static BaseType_t xRequestPending = pdFALSE;
+static SNtpTimestamp xRequestTimestamp;
+static int64_t llRequestLocalUs;
+
 static void prvNTPTask( void *pvParameters );
 
 static void vSignalTask( void )
@@ -147,7 +249,7 @@ void vStartNTPTask( uint16_t usTaskStackSize, UBaseType_t uxTaskPriority )
 		#if( ipconfigUSE_CALLBACKS != 0 )
 			BaseType_t xReceiveTimeOut = pdMS_TO_TICKS( 0 );
 		#else
-			BaseType_t xReceiveTimeOut = pdMS_TO_TICKS( 5000 );
+			BaseType_t xReceiveTimeOut = pdMS_TO_TICKS( ntpdemoCLOCK_UPDATE_MS );
 		#endif
 
 			#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
@@ -224,103 +326,456 @@ static void prvSwapFields( struct SNtpPacket *pxPacket)
 }
 /*-----------------------------------------------------------*/
 
+#ifdef ntpdemoUSE_TICK_MICROSECONDS
+
+static int64_t prvTickMicroseconds( void )
+{
+TimeOut_t xTimeOut;
+
+	/* vTaskSetTimeOutState() also reports how often the tick count has
+	overflowed, which extends it to 64 bits. */
+	vTaskSetTimeOutState( &xTimeOut );
+
+	return ( ( ( int64_t ) xTimeOut.xOverflowCount * ( ( int64_t ) portMAX_DELAY + 1 ) ) + xTimeOut.xTimeOnEntering ) * 1000000LL / configTICK_RATE_HZ;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ntpdemoUSE_TICK_MICROSECONDS */
+
+static void prvNsToNTP( int64_t llNs, SNtpTimestamp *pxTimestamp )
+{
+	pxTimestamp->seconds = ( quint32 ) ( ( llNs / 1000000000LL ) + TIME1970 );
+	pxTimestamp->fraction = ( quint32 ) ( ( ( uint64_t ) ( llNs % 1000000000LL ) << 32 ) / 1000000000ULL );
+}
+/*-----------------------------------------------------------*/
+
+static int64_t prvNTPToNs( const SNtpTimestamp *pxTimestamp )
+{
+	return ( ( ( int64_t ) pxTimestamp->seconds - ( int64_t ) TIME1970 ) * 1000000000LL ) +
+		( int64_t ) ( ( ( uint64_t ) pxTimestamp->fraction * 1000000000ULL ) >> 32 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvDisciplineInit( void )
+{
+time_t uxSeconds, uxMS;
+
+	/* Until the first reply arrives, carry on from whatever the system clock
+	says. */
+	uxSeconds = FreeRTOS_get_secs_msec( &uxMS );
+
+	memset( &xDiscipline, '\0', sizeof( xDiscipline ) );
+	xDiscipline.llBaseNs = ( ( int64_t ) uxSeconds * 1000000000LL ) + ( ( int64_t ) uxMS * 1000000LL );
+	xDiscipline.llBaseLocalUs = ntpdemoLOCAL_MICROSECONDS();
+	xDiscipline.xPollExponent = ntpdemoMIN_POLL;
+}
+/*-----------------------------------------------------------*/
+
+static int64_t prvDisciplineNow( int64_t *pllLocalUs )
+{
+int64_t llLocalUs, llElapsedUs, llSlewNs;
+
+	/* Must be called from within a critical section. Moves the base of the
+	disciplined clock forward to the present, applying the frequency
+	correction and as much of the outstanding slew as is due. */
+	llLocalUs = ntpdemoLOCAL_MICROSECONDS();
+	llElapsedUs = llLocalUs - xDiscipline.llBaseLocalUs;
+
+	if( llElapsedUs > 0 )
+	{
+		llSlewNs = ( llElapsedUs * xDiscipline.lSlewRatePpb ) / 1000000LL;
+
+		if( llabs( llSlewNs ) >= llabs( xDiscipline.llSlewRemainingNs ) )
+		{
+			llSlewNs = xDiscipline.llSlewRemainingNs;
+			xDiscipline.lSlewRatePpb = 0;
+		}
+
+		xDiscipline.llSlewRemainingNs -= llSlewNs;
+		xDiscipline.llBaseNs += ( llElapsedUs * 1000LL ) + ( ( llElapsedUs * xDiscipline.lFrequencyPpb ) / 1000000LL ) + llSlewNs;
+		xDiscipline.llBaseLocalUs = llLocalUs;
+	}
+
+	if( pllLocalUs != NULL )
+	{
+		*pllLocalUs = xDiscipline.llBaseLocalUs;
+	}
+
+	return xDiscipline.llBaseNs;
+}
+/*-----------------------------------------------------------*/
+
+static const NTPSample_t *prvSelectSample( int64_t llLocalUs )
+{
+const NTPSample_t *pxBest = NULL;
+int64_t llScore, llBestScore = 0;
+BaseType_t x;
+
+	/* The sample with the shortest round trip has the smallest error, as
+	its offset can be wrong by at most half the round trip. Older samples
+	are penalised for the drift they may have missed since. */
+	for( x = 0; x < xDiscipline.xSampleCount; x++ )
+	{
+		llScore = ( xDiscipline.xSamples[ x ].llDelayNs / 2 ) +
+			( ( llLocalUs - xDiscipline.xSamples[ x ].llLocalUs ) * ntpdemoDISPERSION_PPB ) / 1000000LL;
+
+		if( ( pxBest == NULL ) || ( llScore < llBestScore ) )
+		{
+			pxBest = &( xDiscipline.xSamples[ x ] );
+			llBestScore = llScore;
+		}
+	}
+
+	return pxBest;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvClampPpb( int64_t llPpb )
+{
+	if( llPpb > ntpdemoMAX_FREQUENCY_PPB )
+	{
+		llPpb = ntpdemoMAX_FREQUENCY_PPB;
+	}
+	else if( llPpb < -ntpdemoMAX_FREQUENCY_PPB )
+	{
+		llPpb = -ntpdemoMAX_FREQUENCY_PPB;
+	}
+
+	return ( int32_t ) llPpb;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDisciplineUpdateFrequency( const NTPSample_t *pxBest )
+{
+int64_t llSpanUs, llBoundNs, llMeasuredPpb;
+
+	llSpanUs = pxBest->llLocalUs - xDiscipline.xAnchor.llLocalUs;
+
+	if( llSpanUs <= 0 )
+	{
+		return;
+	}
+
+	/* Both samples can be off by half their round trip, so wait until they
+	are far enough apart for that to matter little. The anchor is kept until
+	then, so the span keeps growing. */
+	llBoundNs = ( pxBest->llDelayNs + xDiscipline.xAnchor.llDelayNs ) / 2;
+
+	if( ( llBoundNs * 1000000LL ) / llSpanUs > ntpdemoFREQUENCY_TOLERANCE_PPB )
+	{
+		return;
+	}
+
+	/* How much further the server clock moved than the local clock. */
+	llMeasuredPpb = ( ( ( pxBest->llServerNs - xDiscipline.xAnchor.llServerNs ) - ( llSpanUs * 1000LL ) ) * 1000000LL ) / llSpanUs;
+
+	if( xDiscipline.xFrequencyValid == pdFALSE )
+	{
+		xDiscipline.lFrequencyPpb = prvClampPpb( llMeasuredPpb );
+		xDiscipline.xFrequencyValid = pdTRUE;
+	}
+	else
+	{
+		xDiscipline.lFrequencyPpb = prvClampPpb( xDiscipline.lFrequencyPpb +
+			( llMeasuredPpb - xDiscipline.lFrequencyPpb ) / ntpdemoFREQUENCY_GAIN );
+	}
+
+	xDiscipline.xAnchor = *pxBest;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDisciplineUpdatePoll( int64_t llOffsetNs, int64_t llDelayNs )
+{
+int64_t llIncreaseNs = ntpdemoPOLL_INCREASE_NS;
+int64_t llDecreaseNs = ntpdemoPOLL_DECREASE_NS;
+
+	if( ( llDelayNs / 2 ) > llIncreaseNs )
+	{
+		llIncreaseNs = llDelayNs / 2;
+	}
+
+	if( ( llIncreaseNs * 4 ) > llDecreaseNs )
+	{
+		llDecreaseNs = llIncreaseNs * 4;
+	}
+
+	if( llabs( llOffsetNs ) > llDecreaseNs )
+	{
+		xDiscipline.xGoodOffsets = 0;
+
+		if( xDiscipline.xPollExponent > ntpdemoMIN_POLL )
+		{
+			xDiscipline.xPollExponent--;
+		}
+	}
+	else if( llabs( llOffsetNs ) < llIncreaseNs )
+	{
+		if( ++xDiscipline.xGoodOffsets >= ntpdemoPOLL_HYSTERESIS )
+		{
+			xDiscipline.xGoodOffsets = 0;
+
+			if( xDiscipline.xPollExponent < ntpdemoMAX_POLL )
+			{
+				xDiscipline.xPollExponent++;
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvDisciplineUpdate( const NTPSample_t *pxSample )
+{
+const NTPSample_t *pxBest;
+int64_t llLocalUs, llNowNs, llSinceUs, llPredictedNs, llOffsetNs, llIntervalUs;
+
+	/* Must be called from within a critical section. */
+	xDiscipline.xSamples[ xDiscipline.xNextSample ] = *pxSample;
+	xDiscipline.xNextSample = ( xDiscipline.xNextSample + 1 ) % ntpdemoFILTER_SAMPLES;
+	if( xDiscipline.xSampleCount < ntpdemoFILTER_SAMPLES )
+	{
+		xDiscipline.xSampleCount++;
+	}
+
+	llNowNs = prvDisciplineNow( &llLocalUs );
+
+	if( xDiscipline.xSynchronised == pdFALSE )
+	{
+		xDiscipline.xAnchor = *pxSample;
+		pxBest = pxSample;
+	}
+	else
+	{
+		pxBest = prvSelectSample( llLocalUs );
+		prvDisciplineUpdateFrequency( pxBest );
+	}
+
+	/* Project the best sample forward to now to get the offset of the
+	disciplined clock. */
+	llSinceUs = llLocalUs - pxBest->llLocalUs;
+	llPredictedNs = pxBest->llServerNs + ( llSinceUs * 1000LL ) + ( ( llSinceUs * xDiscipline.lFrequencyPpb ) / 1000000LL );
+	llOffsetNs = llPredictedNs - llNowNs;
+	xDiscipline.llLastOffsetNs = llOffsetNs;
+
+	if( ( xDiscipline.xSynchronised == pdFALSE ) || ( llabs( llOffsetNs ) > ntpdemoSTEP_THRESHOLD_NS ) )
+	{
+		/* Too far out to slew within a reasonable time: step. */
+		xDiscipline.llBaseNs = llPredictedNs;
+		xDiscipline.llSlewRemainingNs = 0;
+		xDiscipline.lSlewRatePpb = 0;
+		xDiscipline.xPollExponent = ntpdemoMIN_POLL;
+		xDiscipline.xGoodOffsets = 0;
+		xDiscipline.xSynchronised = pdTRUE;
+	}
+	else
+	{
+		/* Slew the offset out over the next poll interval. This replaces any
+		slew still outstanding, as the offset was measured against the clock
+		without it. */
+		llIntervalUs = ( 1LL << xDiscipline.xPollExponent ) * 1000000LL;
+		xDiscipline.llSlewRemainingNs = llOffsetNs;
+		xDiscipline.lSlewRatePpb = prvClampPpb( ( llOffsetNs * 1000000LL ) / llIntervalUs );
+
+		if( ( xDiscipline.lSlewRatePpb == 0 ) && ( llOffsetNs != 0 ) )
+		{
+			xDiscipline.lSlewRatePpb = ( llOffsetNs > 0 ) ? 1 : -1;
+		}
+
+		prvDisciplineUpdatePoll( llOffsetNs, pxBest->llDelayNs );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateSystemClock( void )
+{
+int64_t llNowNs = 0;
+BaseType_t xSynchronised;
+time_t uxSeconds, uxMS;
+
+	taskENTER_CRITICAL();
+	{
+		xSynchronised = xDiscipline.xSynchronised;
+		if( xSynchronised != pdFALSE )
+		{
+			llNowNs = prvDisciplineNow( NULL );
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	/* Copied often enough that the slew and the frequency correction show in
+	the system clock as a smooth change of rate rather than as steps. */
+	if( xSynchronised != pdFALSE )
+	{
+		uxSeconds = ( time_t ) ( llNowNs / 1000000000LL );
+		uxMS = ( time_t ) ( ( llNowNs % 1000000000LL ) / 1000000LL );
+		FreeRTOS_set_secs_msec( &uxSeconds, &uxMS );
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNTPGetTime( uint32_t *pulSeconds, uint32_t *pulMicroseconds )
+{
+int64_t llNowNs;
+BaseType_t xSynchronised;
+
+	taskENTER_CRITICAL();
+	{
+		xSynchronised = xDiscipline.xSynchronised;
+		llNowNs = prvDisciplineNow( NULL );
+	}
+	taskEXIT_CRITICAL();
+
+	*pulSeconds = ( uint32_t ) ( llNowNs / 1000000000LL );
+	*pulMicroseconds = ( uint32_t ) ( ( llNowNs % 1000000000LL ) / 1000LL );
+
+	return xSynchronised;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvPollDue( void )
+{
+BaseType_t xPollExponent;
+
+	taskENTER_CRITICAL();
+	{
+		xPollExponent = xDiscipline.xPollExponent;
+	}
+	taskEXIT_CRITICAL();
+
+	return ( ( xTaskGetTickCount() - uxSendTime ) >= ( ( TickType_t ) 1u << xPollExponent ) * configTICK_RATE_HZ ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRequestDue( void )
+{
+	/* Ask again only if the last request went unanswered for too long. */
+	return ( ( xRequestPending == pdFALSE ) ||
+		( ( xTaskGetTickCount() - uxSendTime ) >= pdMS_TO_TICKS( ntpdemoRESPONSE_TIMEOUT_MS ) ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
 static void prvNTPPacketInit( )
 {
+int64_t llNowNs;
+BaseType_t xPollExponent;
+
 	memset (&xNTPPacket, '\0', sizeof( xNTPPacket ) );
 
+	taskENTER_CRITICAL();
+	{
+		llNowNs = prvDisciplineNow( &llRequestLocalUs );
+		xPollExponent = xDiscipline.xPollExponent;
+	}
+	taskEXIT_CRITICAL();
+
 	xNTPPacket.flags = 0xDB;				/* value 0xDB : mode 3 (client), version 3, leap indicator unknown 3 */
-	xNTPPacket.poll = 10;					/* 10 means 1 << 10 = 1024 seconds */
+	xNTPPacket.poll = ( qint8 ) xPollExponent;
 	xNTPPacket.precision = 0xFA;			/* = 250 = 0.015625 seconds */
 	xNTPPacket.rootDelay = 0x5D2E;			/* 0x5D2E = 23854 or (23854/65535)= 0.3640 sec */
 	xNTPPacket.rootDispersion = 0x0008CAC8;	/* 0x0008CAC8 = 8.7912  seconds */
 
-	/* use the recorded NTP time */
-	time_t uxSecs = FreeRTOS_time( NULL );/* apTime may be NULL, returns seconds */
-
-	xNTPPacket.referenceTimestamp.seconds = uxSecs;	/* Current time */
-	xNTPPacket.transmitTimestamp.seconds = uxSecs + 3;
+	/* The server echoes the transmit timestamp as the originate timestamp of
+	its reply, which identifies the reply to this request. */
+	prvNsToNTP( llNowNs, &xRequestTimestamp );
+	xNTPPacket.referenceTimestamp.seconds = xRequestTimestamp.seconds;
+	xNTPPacket.transmitTimestamp = xRequestTimestamp;
+	xRequestPending = pdTRUE;
 
 	/* Transform the contents of the fields from native to big endian. */
 	prvSwapFields( &xNTPPacket );
 }
 /*-----------------------------------------------------------*/
 
-static void prvReadTime( struct SNtpPacket * pxPacket )
+static BaseType_t prvReadTime( struct SNtpPacket * pxPacket )
 {
 	FF_TimeStruct_t xTimeStruct;
-	time_t uxPreviousSeconds;
-	time_t uxPreviousMS;
-
+	NTPSample_t xSample;
+	int64_t llReceiveLocalUs;
+	int64_t llServerReceiveNs;
+	int64_t llServerTransmitNs;
+	int64_t llNowNs;
+	int64_t llOffsetNs;
+	int32_t lFrequencyPpb;
+	BaseType_t xPollExponent;
 	time_t uxCurrentSeconds;
-	time_t uxCurrentMS;
+	uint32_t ulCurrentMS;
 
-	const char *pcTimeUnit;
-	int32_t ilDiff;
-	TickType_t uxTravelTime;
-
-	uxTravelTime = xTaskGetTickCount() - uxSendTime;
+	/* Note the arrival time before anything else. */
+	llReceiveLocalUs = ntpdemoLOCAL_MICROSECONDS();
 
 	/* Transform the contents of the fields from big to native endian. */
 	prvSwapFields( pxPacket );
 
-	uxCurrentSeconds = pxPacket->receiveTimestamp.seconds - TIME1970;
-	uxCurrentMS = pxPacket->receiveTimestamp.fraction / 4294967;
-	uxCurrentSeconds += uxCurrentMS / 1000;
-	uxCurrentMS = uxCurrentMS % 1000;
-
-	// Get the last time recorded
-	uxPreviousSeconds = FreeRTOS_get_secs_msec( &uxPreviousMS );
-
-	// Set the new time with precision in msec. */
-	FreeRTOS_set_secs_msec( &uxCurrentSeconds, &uxCurrentMS );
-
-	if( uxCurrentSeconds >= uxPreviousSeconds )
+	if( ( xRequestPending == pdFALSE ) ||
+		( pxPacket->originateTimestamp.seconds != xRequestTimestamp.seconds ) ||
+		( pxPacket->originateTimestamp.fraction != xRequestTimestamp.fraction ) )
 	{
-		ilDiff = ( int32_t ) ( uxCurrentSeconds - uxPreviousSeconds );
+		FreeRTOS_printf( ( "NTP: ignoring a reply which does not match the request\n" ) );
+		return pdFALSE;
 	}
-	else
+
+	/* Mode must be 4 (server), the leap indicator must not say "unsynchronised"
+	and stratum 0 is a kiss-o'-death packet. */
+	if( ( ( pxPacket->flags & 0x07 ) != 4 ) || ( ( pxPacket->flags >> 6 ) == 3 ) ||
+		( pxPacket->stratum == 0 ) || ( pxPacket->stratum > 15 ) )
 	{
-		ilDiff = 0 - ( int32_t ) ( uxPreviousSeconds - uxCurrentSeconds );
+		FreeRTOS_printf( ( "NTP: server is not synchronised (stratum %u)\n", pxPacket->stratum ) );
+		return pdFALSE;
 	}
 
-	if( ( ilDiff < -5 ) || ( ilDiff > 5 ) )
+	xRequestPending = pdFALSE;
+
+	llServerReceiveNs = prvNTPToNs( &( pxPacket->receiveTimestamp ) );
+	llServerTransmitNs = prvNTPToNs( &( pxPacket->transmitTimestamp ) );
+
+	xSample.llLocalUs = llRequestLocalUs + ( llReceiveLocalUs - llRequestLocalUs ) / 2;
+	xSample.llServerNs = llServerReceiveNs + ( llServerTransmitNs - llServerReceiveNs ) / 2;
+	xSample.llDelayNs = ( ( llReceiveLocalUs - llRequestLocalUs ) * 1000LL ) - ( llServerTransmitNs - llServerReceiveNs );
+	if( xSample.llDelayNs < 0 )
 	{
-		/* More than 5 seconds difference. */
-		pcTimeUnit = "sec";
+		/* The local clock is coarser than the server's. */
+		xSample.llDelayNs = 0;
 	}
-	else
+
+	taskENTER_CRITICAL();
 	{
-		/* Less than or equal to 5 second difference. */
-		pcTimeUnit = "ms";
-		uint32_t ulLowest = ( uxCurrentSeconds <= uxPreviousSeconds ) ? uxCurrentSeconds : uxPreviousSeconds;
-		int32_t iCurMS = 1000 * ( uxCurrentSeconds - ulLowest ) + uxCurrentMS;
-		int32_t iPrevMS = 1000 * ( uxPreviousSeconds - ulLowest ) + uxPreviousMS;
-		ilDiff = iCurMS - iPrevMS;
+		prvDisciplineUpdate( &xSample );
+		llNowNs = prvDisciplineNow( NULL );
+		llOffsetNs = xDiscipline.llLastOffsetNs;
+		lFrequencyPpb = xDiscipline.lFrequencyPpb;
+		xPollExponent = xDiscipline.xPollExponent;
 	}
+	taskEXIT_CRITICAL();
+
+	prvUpdateSystemClock();
+
+	uxCurrentSeconds = ( time_t ) ( llNowNs / 1000000000LL );
+	ulCurrentMS = ( uint32_t ) ( ( llNowNs % 1000000000LL ) / 1000000LL );
 	uxCurrentSeconds -= iTimeZone;
 
 	FreeRTOS_gmtime_r( &uxCurrentSeconds, &xTimeStruct );
 
 	/*
-		378.067 [NTP client] NTP time: 9/11/2015 16:11:19.559 Diff -20 ms (289 ms)
-		379.441 [NTP client] NTP time: 9/11/2015 16:11:20.933 Diff 0 ms (263 ms)
+		378.067 [NTP client] NTP time: 9/11/2015 16:11:19.559 offset -20412 us delay 263015 us drift 1240 ppb poll 16 s
 	*/
 
-	FreeRTOS_printf( ("NTP time: %d/%d/%02d %2d:%02d:%02d.%03u Diff %d %s (%lu ms)\n",
+	FreeRTOS_printf( ("NTP time: %d/%d/%02d %2d:%02d:%02d.%03u offset %ld us delay %ld us drift %ld ppb poll %lu s\n",
 		xTimeStruct.tm_mday,
 		xTimeStruct.tm_mon + 1,
 		xTimeStruct.tm_year + 1900,
 		xTimeStruct.tm_hour,
 		xTimeStruct.tm_min,
 		xTimeStruct.tm_sec,
-		( unsigned )uxCurrentMS,
-		( unsigned )ilDiff,
-		pcTimeUnit,
-		uxTravelTime ) );
+		( unsigned )ulCurrentMS,
+		( long ) ( llOffsetNs / 1000LL ),
+		( long ) ( xSample.llDelayNs / 1000LL ),
+		( long ) lFrequencyPpb,
+		( unsigned long ) ( 1UL << xPollExponent ) ) );
 
 	/* Remove compiler warnings in case FreeRTOS_printf() is not used. */
-	( void ) pcTimeUnit;
-	( void ) uxTravelTime;
+	( void ) llOffsetNs;
+	( void ) lFrequencyPpb;
+
+	return pdTRUE;
 }
 /*-----------------------------------------------------------*/
 
@@ -329,9 +784,8 @@ static void prvReadTime( struct SNtpPacket * pxPacket )
 	static BaseType_t xOnUDPReceive( Socket_t xSocket, void * pvData, size_t xLength,
 		const struct freertos_sockaddr *pxFrom, const struct freertos_sockaddr *pxDest )
 	{
-		if( xLength >= sizeof( xNTPPacket ) )
+		if( ( xLength >= sizeof( xNTPPacket ) ) && ( prvReadTime( ( struct SNtpPacket *)pvData ) != pdFALSE ) )
 		{
-			prvReadTime( ( struct SNtpPacket *)pvData );
 			if( xStatus != EStatusPause )
 			{
 				xStatus = EStatusPause;
@@ -354,6 +808,8 @@ struct freertos_sockaddr xAddress;
 #endif /* ipconfigUSE_CALLBACKS != 0 */
 
 	xStatus = EStatusLookup;
+	prvDisciplineInit();
+
 	#if( ipconfigSOCKET_HAS_USER_SEMAPHORE != 0 ) || ( ipconfigUSE_CALLBACKS != 0 )
 	{
 		xNTPWakeupSem = xSemaphoreCreateBinary();
@@ -393,6 +849,7 @@ struct freertos_sockaddr xAddress;
 			break;
 
 		case EStatusAsking:
+			if( prvRequestDue() != pdFALSE )
 			{
 			char pcBuf[16];
 
@@ -424,6 +881,11 @@ struct freertos_sockaddr xAddress;
 			break;
 
 		case EStatusPause:
+			/* Poll again when the adaptive poll interval has passed. */
+			if( prvPollDue() != pdFALSE )
+			{
+				xStatus = EStatusAsking;
+			}
 			break;
 
 		case EStatusFailed:
@@ -432,7 +894,7 @@ struct freertos_sockaddr xAddress;
 
 		#if( ipconfigUSE_CALLBACKS != 0 )
 		{
-			xSemaphoreTake( xNTPWakeupSem, 5000 );
+			xSemaphoreTake( xNTPWakeupSem, pdMS_TO_TICKS( ntpdemoCLOCK_UPDATE_MS ) );
 		}
 		#else
 		{
@@ -452,9 +914,8 @@ struct freertos_sockaddr xAddress;
 				{
 					FreeRTOS_printf( ( "FreeRTOS_recvfrom: returns %ld\n", xReturned ) );
 				}
-				else
+				else if( prvReadTime( ( struct SNtpPacket *)cRecvBuffer ) != pdFALSE )
 				{
-					prvReadTime( ( struct SNtpPacket *)cRecvBuffer );
 					if( xStatus != EStatusPause )
 					{
 						xStatus = EStatusPause;
@@ -464,6 +925,8 @@ struct freertos_sockaddr xAddress;
 			}
 		}
 		#endif
+
+		prvUpdateSystemClock();
 	}
 }
 /*-----------------------------------------------------------*/
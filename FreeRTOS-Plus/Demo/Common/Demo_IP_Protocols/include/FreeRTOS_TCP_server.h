@@ -95,6 +95,24 @@ struct xFTP_CLIENT;
 	extern size_t uxApplicationHTTPHandleRequestHook( const char *pcURLData, char *pcBuffer, size_t uxBufferLength );
 #endif /* ipconfigHTTP_HAS_HANDLE_REQUEST_HOOK */
 
+#if( ipconfigHTTP_HAS_CHUNKED_REQUEST_HOOK != 0 )
+	/*
+	 * Like uxApplicationHTTPHandleRequestHook(), but for answers of which the
+	 * length is not known in advance.  The answer is sent with
+	 * "Transfer-Encoding: chunked", the hook is called repeatedly, and each
+	 * call returns the next part of it.
+	 * const char *pcURLData;	// A request, e.g. "/request?limit=75"
+	 * size_t uxOffset;			// Number of bytes returned in earlier calls
+	 * char *pcBuffer;			// Here the next part can be written
+	 * size_t uxBufferLength;	// Size of the buffer
+	 *
+	 * Returning zero ends the answer.  When zero is returned for uxOffset 0,
+	 * the request is not handled by the hook and the URL is looked up as a
+	 * file.
+	 */
+	extern size_t uxApplicationHTTPHandleChunkedRequestHook( const char *pcURLData, size_t uxOffset, char *pcBuffer, size_t uxBufferLength );
+#endif /* ipconfigHTTP_HAS_CHUNKED_REQUEST_HOOK */
+
 struct xSERVER_CONFIG
 {
 	enum eSERVER_TYPE eType;		/* eSERVER_HTTP | eSERVER_FTP */
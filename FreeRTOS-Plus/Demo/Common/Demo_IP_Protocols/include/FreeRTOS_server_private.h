@@ -56,6 +56,131 @@
 	#define ipconfigTCP_FILE_BUFFER_SIZE	( 2048 )
 #endif
 
+/*
+ * FreeRTOS_TCPServerWork() only calls the work function of a client when one
+ * of its sockets has an event.
+ *
+ * ipconfigTCP_SERVER_IDLE_WORK_MS sets the time after which a client without
+ * events is called anyway, for work that depends on time rather than on a
+ * socket, such as the time-outs of FTP data connections.
+ *
+ * ipconfigTCP_SERVER_WORK_BUDGET sets the number of bytes of a file that one
+ * call of a work function may send.  Clients with a lot to send will then
+ * take turns with the other clients, instead of filling their whole
+ * transmission buffer at once.
+ */
+#ifndef ipconfigTCP_SERVER_IDLE_WORK_MS
+	#define ipconfigTCP_SERVER_IDLE_WORK_MS	( 1000 )
+#endif
+
+#ifndef ipconfigTCP_SERVER_WORK_BUDGET
+	#define ipconfigTCP_SERVER_WORK_BUDGET	( 4 * ipconfigTCP_FILE_BUFFER_SIZE )
+#endif
+
+/*
+ * ipconfigHTTP_REQUEST_LINE_SIZE sets the size of 'pcRequest', which holds
+ * the request line of the HTTP request being handled, e.g.
+ * "GET /index.html HTTP/1.1".  The header lines that follow are not stored,
+ * except for the first HTTP_HEADER_LINE_SIZE characters of each line, which
+ * are enough to recognise "Connection" and "Content-Length", and to hold a
+ * "Range" of two 10-digit offsets.
+ */
+#ifndef ipconfigHTTP_REQUEST_LINE_SIZE
+	#define ipconfigHTTP_REQUEST_LINE_SIZE	( ffconfigMAX_FILENAME + 16 )
+#endif
+
+#define HTTP_HEADER_LINE_SIZE	( 48 )
+
+/*
+ * ipconfigHTTP_CONTENT_CACHE_ENTRIES sets the number of files that the HTTP
+ * server keeps in RAM, together with a preformatted reply header and an
+ * ETag.  Zero disables the cache.  Only files up to
+ * ipconfigHTTP_CONTENT_CACHE_MAX_SIZE bytes are cached.  When a file
+ * "<name>.gz" exists next to a cached file, it is cached as well, and sent to
+ * browsers that accept "gzip".
+ *
+ * ipconfigHTTP_CONTENT_CACHE_CHECK_MS sets how often a cached file is
+ * compared with the disk, using ff_stat().
+ */
+#ifndef ipconfigHTTP_CONTENT_CACHE_ENTRIES
+	#define ipconfigHTTP_CONTENT_CACHE_ENTRIES	( 0 )
+#endif
+
+#ifndef ipconfigHTTP_CONTENT_CACHE_MAX_SIZE
+	#define ipconfigHTTP_CONTENT_CACHE_MAX_SIZE	( 8192 )
+#endif
+
+#ifndef ipconfigHTTP_CONTENT_CACHE_CHECK_MS
+	#define ipconfigHTTP_CONTENT_CACHE_CHECK_MS	( 5000 )
+#endif
+
+/* Defined in FreeRTOS_HTTP_server.c. */
+struct xHTTP_CACHE_ENTRY;
+
+/*
+ * ipconfigFTP_READ_AHEAD_SIZE: when non-zero, a file that is retrieved with
+ * RETR is read into a private buffer of this size, which is refilled as soon
+ * as it has been passed to the socket.  The next part of the file is then
+ * read while the previous part is still being transmitted, also when the TX
+ * stream is full.  Not used when ipconfigFTP_TX_ZERO_COPY is defined.
+ */
+#ifndef ipconfigFTP_READ_AHEAD_SIZE
+	#define ipconfigFTP_READ_AHEAD_SIZE	( 0 )
+#endif
+
+/*
+ * ipconfigFTP_WRITE_BUFFER_SIZE: when non-zero, data received with STOR is
+ * collected in a private buffer of this size, and written to disk in blocks
+ * of this size that start at a multiple of it in the file.  Use a multiple
+ * of the cluster size, e.g. 4096, so that +FAT writes whole sectors and
+ * extends the cluster chain once per block.  A size announced with ALLO
+ * makes the buffer smaller for small files.  Not used when
+ * ipconfigFTP_ZERO_COPY_ALIGNED_WRITES is defined.
+ */
+#ifndef ipconfigFTP_WRITE_BUFFER_SIZE
+	#define ipconfigFTP_WRITE_BUFFER_SIZE	( 0 )
+#endif
+
+/*
+ * ipconfigFTP_LIST_CACHE_SIZE: when non-zero, the FTP server keeps the text
+ * of the last directory listing, if it is not longer than this.  An identical
+ * LIST, NLST or MLSD of the same directory is then answered from RAM, unless
+ * a client has changed the file system in the mean time, or the listing is
+ * older than ipconfigFTP_LIST_CACHE_MS.
+ */
+#ifndef ipconfigFTP_LIST_CACHE_SIZE
+	#define ipconfigFTP_LIST_CACHE_SIZE	( 0 )
+#endif
+
+#ifndef ipconfigFTP_LIST_CACHE_MS
+	#define ipconfigFTP_LIST_CACHE_MS	( 10000 )
+#endif
+
+/* Defined in FreeRTOS_FTP_server.c. */
+struct xFTP_LIST_CACHE;
+
+/*
+ * ipconfigTCP_SERVER_CLIENT_SLOTS: when non-zero, FreeRTOS_CreateTCPServer()
+ * allocates this many client structures together with the server, and a new
+ * connection takes a free slot instead of calling pvPortMallocLarge().  A
+ * connection that finds no free slot is closed.  Short connections then
+ * take a constant time to set up, and don't fragment the heap.
+ *
+ * ipconfigTCP_SERVER_CLIENT_ARENA_SIZE: the number of bytes behind each slot
+ * from which pvTCPClientAlloc() hands out memory, e.g. the FTP read-ahead
+ * buffer.  The whole arena is released at once when the client disconnects.
+ * Requests that do not fit are passed to pvPortMalloc().
+ */
+#ifndef ipconfigTCP_SERVER_CLIENT_SLOTS
+	#define ipconfigTCP_SERVER_CLIENT_SLOTS	( 0 )
+#endif
+
+#ifndef ipconfigTCP_SERVER_CLIENT_ARENA_SIZE
+	/* A client either retrieves or stores a file, never both at once. */
+	#define ipconfigTCP_SERVER_CLIENT_ARENA_SIZE	\
+		( ( ipconfigFTP_READ_AHEAD_SIZE > ipconfigFTP_WRITE_BUFFER_SIZE ) ? ipconfigFTP_READ_AHEAD_SIZE : ipconfigFTP_WRITE_BUFFER_SIZE )
+#endif
+
 struct xTCP_CLIENT;
 
 typedef BaseType_t ( * FTCPWorkFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
@@ -68,7 +193,10 @@ typedef void ( * FTCPDeleteFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
 	const char *pcRootDir; \
 	FTCPWorkFunction fWorkFunction; \
 	FTCPDeleteFunction fDeleteFunction; \
-	struct xTCP_CLIENT *pxNextClient
+	struct xTCP_CLIENT *pxNextClient; \
+	size_t uxArenaUsed; \
+	size_t uxArenaLast; \
+	TickType_t xLastWorkTime
 
 typedef struct xTCP_CLIENT
 {
@@ -89,10 +217,33 @@ struct xHTTP_CLIENT
 	char pcCurrentFilename[ ffconfigMAX_FILENAME ];
 	size_t uxBytesLeft;
 	FF_FILE *pxFileHandle;
+	char pcRequest[ ipconfigHTTP_REQUEST_LINE_SIZE ];	/* The request line being received or handled. */
+	size_t uxRequestLength;
+	char pcHeader[ HTTP_HEADER_LINE_SIZE ];	/* The start of the header line being received. */
+	size_t uxHeaderLength;
+	size_t uxContentLeft;	/* Bytes of a request body that must still be skipped. */
+	size_t uxChunkOffset;	/* Bytes produced so far by the chunked request hook. */
+	uint32_t ulIfNoneMatch;	/* The ETag found in "If-None-Match". */
+	size_t uxRangeFirst;	/* The "Range" asked for, see bRange. */
+	size_t uxRangeLast;		/* ~0 when open ended, or the length of a suffix range. */
+	#if( ipconfigHTTP_CONTENT_CACHE_ENTRIES > 0 )
+		struct xHTTP_CACHE_ENTRY *pxCacheEntry;	/* The cached file being sent. */
+		const uint8_t *pucCacheData;			/* The next byte of it to send. */
+	#endif
 	union {
 		struct {
 			uint32_t
-				bReplySent : 1;
+				bReplySent : 1,
+				bInRequest : 1,			/* The request line has been received, the headers follow. */
+				bRequestTooLong : 1,	/* The request line did not fit in pcRequest. */
+				bCloseConnection : 1,	/* Close the connection after the reply. */
+				bClosing : 1,			/* The connection has been shut down. */
+				bChunked : 1,			/* A chunked reply is being sent. */
+				bIfNoneMatch : 1,		/* ulIfNoneMatch is valid. */
+				bAcceptGzip : 1,		/* "Accept-Encoding" includes "gzip". */
+				bRange : 1,				/* A single byte range was asked for. */
+				bRangeSuffix : 1,		/* The range is "-n", the last n bytes. */
+				bIfRange : 1;			/* "If-Range" was present, the range is ignored. */
 		};
 		uint32_t ulFlags;
 	} bits;
@@ -115,9 +266,26 @@ struct xFTP_CLIENT
 	Socket_t xTransferSocket;
 	BaseType_t xTransType;
 	BaseType_t xDirCount;
+	BaseType_t xListFormat;		/* LIST, NLST or MLSD. */
 	FF_FindData_t xFindData;
 	FF_FILE *pxReadHandle;
 	FF_FILE *pxWriteHandle;
+	#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
+		char *pcReadAhead;			/* Data read from pxReadHandle, not yet sent. */
+		size_t uxReadAheadOffset;
+		size_t uxReadAheadLength;
+	#endif
+	#if( ipconfigFTP_WRITE_BUFFER_SIZE > 0 )
+		char *pcWriteBuffer;		/* Data received with STOR, not yet written. */
+		size_t uxWriteBufferSize;
+		size_t uxWriteLength;
+		size_t uxWriteLimit;		/* Write when this many bytes are in the buffer. */
+	#endif
+	uint32_t ulAllocSize;		/* The size given with ALLO, used by the next STOR. */
+	#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+		struct xFTP_LIST_CACHE *pxListCache;	/* The listing being sent, or being made. */
+		size_t uxListOffset;
+	#endif
 	char pcCurrentDir[ ffconfigMAX_FILENAME ];
 	char pcFileName[ ffconfigMAX_FILENAME ];
 	char pcConnectionAck[ 128 ];
@@ -140,7 +308,8 @@ struct xFTP_CLIENT
 				bDirHasEntry : 1,		/* pdTRUE if ff_findfirst() was successful. */
 				bClientConnected : 1,	/* pdTRUE after connect() or accept() has succeeded. */
 				bEmptyFile : 1,			/* pdTRUE if a connection-without-data was received. */
-				bHadError : 1;			/* pdTRUE if a transfer got aborted because of an error. */
+				bHadError : 1,			/* pdTRUE if a transfer got aborted because of an error. */
+				bListFromCache : 1;		/* pdTRUE if pxListCache is being sent. */
 		};
 		uint32_t ulConnFlags;
 	} bits1;
@@ -154,6 +323,10 @@ BaseType_t xFTPClientWork( TCPClient_t *pxClient );
 void vHTTPClientDelete( TCPClient_t *pxClient );
 void vFTPClientDelete( TCPClient_t *pxClient );
 
+/* Memory for the lifetime of a client, see ipconfigTCP_SERVER_CLIENT_ARENA_SIZE. */
+void *pvTCPClientAlloc( TCPClient_t *pxClient, size_t uxSize );
+void vTCPClientFree( TCPClient_t *pxClient, void *pvBuffer );
+
 BaseType_t xMakeAbsolute( struct xFTP_CLIENT *pxClient, char *pcBuffer, BaseType_t xBufferLength, const char *pcFileName );
 BaseType_t xMakeRelative( FTPClient_t *pxClient, char *pcBuffer, BaseType_t xBufferLength, const char *pcFileName );
 
@@ -167,10 +340,21 @@ struct xTCP_SERVER
 
 	#if( ipconfigUSE_FTP != 0 )
 		char pcNewDir[ ffconfigMAX_FILENAME ];
+		#if( ipconfigFTP_LIST_CACHE_SIZE > 0 )
+			struct xFTP_LIST_CACHE *pxListCache;
+			uint32_t ulListGeneration;	/* Incremented when a client changes the file system. */
+		#endif
 	#endif
 	#if( ipconfigUSE_HTTP != 0 )
 		char pcContentsType[40];	/* Space for the msg: "text/javascript" */
-		char pcExtraContents[40];	/* Space for the msg: "Content-Length: 346500" */
+		char pcExtraContents[96];	/* Space for the msg: "Content-Length: 346500", and a "Content-Range". */
+	#endif
+	#if( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CONTENT_CACHE_ENTRIES > 0 )
+		struct xHTTP_CACHE_ENTRY *pxContentCache[ ipconfigHTTP_CONTENT_CACHE_ENTRIES ];
+	#endif
+	#if( ipconfigTCP_SERVER_CLIENT_SLOTS > 0 )
+		TCPClient_t *pxFreeClients;	/* The client slots that are not in use. */
+		size_t uxClientSize;		/* The size of a slot, without its arena. */
 	#endif
 	BaseType_t xServerCount;
 	TCPClient_t *pxClients;
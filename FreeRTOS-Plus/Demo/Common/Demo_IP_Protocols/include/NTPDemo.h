@@ -8,4 +8,9 @@
 
 void vStartNTPTask( uint16_t usTaskStackSize, UBaseType_t uxTaskPriority );
 
+/* Reads the clock disciplined by the NTP task: seconds since 1/1/1970 and
+microseconds. Returns pdFALSE until the first reply from a server has been
+received, in which case the time is only as good as the system clock was. */
+BaseType_t xNTPGetTime( uint32_t *pulSeconds, uint32_t *pulMicroseconds );
+
 #endif
\ No newline at end of file
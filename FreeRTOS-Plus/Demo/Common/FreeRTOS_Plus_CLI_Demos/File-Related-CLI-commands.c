@@ -48,6 +48,15 @@
 
 #define cliNEW_LINE		"\r\n"
 
+/* The size of the buffer used to copy files.  FreeRTOS+FAT SL can only have
+one file open at a time, so the source and destination files are opened,
+sought and closed again for every buffer full of data - the larger the buffer,
+the fewer times that has to happen.  Defined here so it can be overridden from
+FreeRTOSConfig.h on parts with less RAM to spare. */
+#ifndef cliFILE_TRANSFER_BUFFER_SIZE
+	#define cliFILE_TRANSFER_BUFFER_SIZE	( 8 * 1024 )
+#endif
+
 /*******************************************************************************
  * See the URL in the comments within main.c for the location of the online
  * documentation.
@@ -58,20 +67,31 @@
  */
 static void prvCreateFileInfoString( char *pcBuffer, F_FIND *pxFindStruct );
 
+/*
+ * Return a string that describes the type of a file.
+ */
+static const char *prvGetFileAttributeString( F_FIND *pxFindStruct );
+
 /*
  * Copies an existing file into a newly created file.
  */
 static BaseType_t prvPerformCopy( const char *pcSourceFile,
 									int32_t lSourceFileLength,
-									const char *pcDestinationFile,
-									char *pxWriteBuffer,
-									size_t xWriteBufferLen );
+									const char *pcDestinationFile );
 
 /*
  * Implements the DIR command.
  */
 static BaseType_t prvDIRCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 
+/*
+ * Implements the DIR command on consoles that can stream output, listing the
+ * whole directory in one call.
+ */
+#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+	static BaseType_t prvDIRStreamCommand( CLI_Output_t *pxOutput, const char *pcCommandString );
+#endif
+
 /*
  * Implements the CD command.
  */
@@ -99,7 +119,10 @@ static const CLI_Command_Definition_t xDIR =
 	"dir", /* The command string to type. */
 	"\r\ndir:\r\n Lists the files in the current directory\r\n",
 	prvDIRCommand, /* The function to run. */
-	0 /* No parameters are expected. */
+	0, /* No parameters are expected. */
+	#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+		prvDIRStreamCommand /* The function to run when the console can stream output. */
+	#endif
 };
 
 /* Structure that defines the CD command line command, which changes the
@@ -140,6 +163,9 @@ static const CLI_Command_Definition_t xCOPY =
 	2 /* Two parameters are expected. */
 };
 
+/* The buffer through which the COPY command moves data.  It is declared as an
+array of words so it is word aligned, as some media drivers require for DMA. */
+static uint32_t ulTransferBuffer[ cliFILE_TRANSFER_BUFFER_SIZE / sizeof( uint32_t ) ];
 
 /*-----------------------------------------------------------*/
 
@@ -332,6 +358,49 @@ BaseType_t xReturn = pdFALSE;
 }
 /*-----------------------------------------------------------*/
 
+#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+
+	static BaseType_t prvDIRStreamCommand( CLI_Output_t *pxOutput, const char *pcCommandString )
+	{
+	F_FIND *pxFindStruct;
+	unsigned char ucReturned;
+	BaseType_t xReturn = pdPASS;
+
+		( void ) pcCommandString;
+
+		/* Unlike prvDIRCommand() the find structure is only needed for the
+		duration of this call. */
+		pxFindStruct = ( F_FIND * ) pvPortMalloc( sizeof( F_FIND ) );
+
+		if( pxFindStruct != NULL )
+		{
+			ucReturned = f_findfirst( "*.*", pxFindStruct );
+
+			if( ucReturned != F_NO_ERROR )
+			{
+				FreeRTOS_CLIPrintf( pxOutput, "Error: f_findfirst() failed." cliNEW_LINE );
+			}
+
+			/* Stop early if the console has gone away. */
+			while( ( ucReturned == F_NO_ERROR ) && ( xReturn == pdPASS ) )
+			{
+				xReturn = FreeRTOS_CLIPrintf( pxOutput, "%s [%s] [size=%d]" cliNEW_LINE, pxFindStruct->filename, prvGetFileAttributeString( pxFindStruct ), ( int ) pxFindStruct->filesize );
+				ucReturned = f_findnext( pxFindStruct );
+			}
+
+			vPortFree( pxFindStruct );
+		}
+		else
+		{
+			FreeRTOS_CLIPrintf( pxOutput, "Failed to allocate RAM (using heap_4.c will prevent fragmentation)." cliNEW_LINE );
+		}
+
+		return pdFALSE;
+	}
+
+#endif /* configCOMMAND_INT_STREAMING_OUTPUT */
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvDELCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
 {
 const char *pcParameter;
@@ -376,6 +445,9 @@ char *pcSourceFile, *pcDestinationFile;
 BaseType_t xParameterStringLength;
 long lSourceLength, lDestinationLength = 0;
 
+	/* This function assumes xWriteBufferLen is large enough! */
+	( void ) xWriteBufferLen;
+
 	/* Obtain the name of the destination file. */
 	pcDestinationFile = ( char * ) FreeRTOS_CLIGetParameter
 									(
@@ -423,7 +495,7 @@ long lSourceLength, lDestinationLength = 0;
 	not exist. */
 	if( ( lSourceLength != 0 ) && ( lDestinationLength == 0 ) )
 	{
-		if( prvPerformCopy( pcSourceFile, lSourceLength, pcDestinationFile, pcWriteBuffer, xWriteBufferLen ) == pdPASS )
+		if( prvPerformCopy( pcSourceFile, lSourceLength, pcDestinationFile ) == pdPASS )
 		{
 			sprintf( pcWriteBuffer, "Copy made" );
 		}
@@ -441,15 +513,12 @@ long lSourceLength, lDestinationLength = 0;
 
 static BaseType_t prvPerformCopy( const char *pcSourceFile,
 									int32_t lSourceFileLength,
-									const char *pcDestinationFile,
-									char *pxWriteBuffer,
-									size_t xWriteBufferLen )
+									const char *pcDestinationFile )
 {
 int32_t lBytesRead = 0, lBytesToRead, lBytesRemaining;
 F_FILE *pxFile;
 BaseType_t xReturn = pdPASS;
-
-	/* NOTE:  Error handling has been omitted for clarity. */
+long lItems;
 
 	while( lBytesRead < lSourceFileLength )
 	{
@@ -458,9 +527,9 @@ BaseType_t xReturn = pdPASS;
 
 		/* How many bytes should be read this time around the loop.  Can't
 		read more bytes than will fit into the buffer. */
-		if( lBytesRemaining > ( long ) xWriteBufferLen )
+		if( lBytesRemaining > ( long ) sizeof( ulTransferBuffer ) )
 		{
-			lBytesToRead = ( long ) xWriteBufferLen;
+			lBytesToRead = ( long ) sizeof( ulTransferBuffer );
 		}
 		else
 		{
@@ -473,9 +542,20 @@ BaseType_t xReturn = pdPASS;
 		pxFile = f_open( pcSourceFile, "r" );
 		if( pxFile != NULL )
 		{
-			f_seek( pxFile, lBytesRead, F_SEEK_SET );
-			f_read( pxWriteBuffer, lBytesToRead, 1, pxFile );
+			lItems = 0;
+
+			if( f_seek( pxFile, lBytesRead, F_SEEK_SET ) == F_NO_ERROR )
+			{
+				lItems = f_read( ulTransferBuffer, lBytesToRead, 1, pxFile );
+			}
+
 			f_close( pxFile );
+
+			if( lItems != 1 )
+			{
+				xReturn = pdFAIL;
+				break;
+			}
 		}
 		else
 		{
@@ -488,8 +568,13 @@ BaseType_t xReturn = pdPASS;
 		pxFile = f_open( pcDestinationFile, "a" );
 		if( pxFile != NULL )
 		{
-			f_write( pxWriteBuffer, lBytesToRead, 1, pxFile );
-			f_close( pxFile );
+			lItems = f_write( ulTransferBuffer, lBytesToRead, 1, pxFile );
+
+			if( ( f_close( pxFile ) != F_NO_ERROR ) || ( lItems != 1 ) )
+			{
+				xReturn = pdFAIL;
+				break;
+			}
 		}
 		else
 		{
@@ -505,6 +590,14 @@ BaseType_t xReturn = pdPASS;
 /*-----------------------------------------------------------*/
 
 static void prvCreateFileInfoString( char *pcBuffer, F_FIND *pxFindStruct )
+{
+	/* Create a string that includes the file name, the file size and the
+	attributes string. */
+	sprintf( pcBuffer, "%s [%s] [size=%d]", pxFindStruct->filename, prvGetFileAttributeString( pxFindStruct ), ( int ) pxFindStruct->filesize );
+}
+/*-----------------------------------------------------------*/
+
+static const char *prvGetFileAttributeString( F_FIND *pxFindStruct )
 {
 const char *pcWritableFile = "writable file", *pcReadOnlyFile = "read only file", *pcDirectory = "directory";
 const char * pcAttrib;
@@ -523,7 +616,5 @@ const char * pcAttrib;
 		pcAttrib = pcWritableFile;
 	}
 
-	/* Create a string that includes the file name, the file size and the
-	attributes string. */
-	sprintf( pcBuffer, "%s [%s] [size=%d]", pxFindStruct->filename, pcAttrib, ( int ) pxFindStruct->filesize );
+	return pcAttrib;
 }
@@ -53,6 +53,17 @@
 	#define configINCLUDE_QUERY_HEAP_COMMAND 0
 #endif
 
+/* Needs TRC_CFG_ENABLE_TASK_STATS set to 1 in the trace recorder's
+trcStreamingConfig.h. */
+#ifndef configINCLUDE_TRACE_TASK_STATS_COMMAND
+	#define configINCLUDE_TRACE_TASK_STATS_COMMAND 0
+#endif
+
+/* The IDs that select the binary versions of the commands in a frame when
+configCOMMAND_INT_BINARY_FRAMES is 1. */
+#define cmdBINARY_TASK_STATS_ID		( ( uint16_t ) 1U )
+#define cmdBINARY_QUERY_HEAP_ID		( ( uint16_t ) 2U )
+
 /*
  * The function that registers the commands that are defined within this file.
  */
@@ -94,6 +105,39 @@ static BaseType_t prvParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBuf
 	static BaseType_t prvStartStopTraceCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 #endif
 
+/*
+ * Implements the "trace-task-stats" command.
+ */
+#if( configINCLUDE_TRACE_TASK_STATS_COMMAND == 1 )
+	static BaseType_t prvTraceTaskStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+#endif
+
+#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+
+	/*
+	 * Implements the binary version of the task-stats command.  The response
+	 * holds the total run time followed by one record per task, so test
+	 * equipment does not have to parse the table output by task-stats and
+	 * run-time-stats.
+	 */
+	#if( configUSE_TRACE_FACILITY == 1 )
+		static BaseType_t prvBinaryTaskStatsCommand( const uint8_t *pucRequest, size_t xRequestLength, uint8_t *pucResponse, size_t xResponseLength, size_t *pxResponseUsed );
+	#endif
+
+	/*
+	 * Implements the binary version of the query-heap command.
+	 */
+	#if( configINCLUDE_QUERY_HEAP_COMMAND == 1 )
+		static BaseType_t prvBinaryQueryHeapCommand( const uint8_t *pucRequest, size_t xRequestLength, uint8_t *pucResponse, size_t xResponseLength, size_t *pxResponseUsed );
+	#endif
+
+	/*
+	 * Write ulValue to pucBuffer little endian, as frames require.
+	 */
+	static void prvPutUint32( uint8_t *pucBuffer, uint32_t ulValue );
+
+#endif /* configCOMMAND_INT_BINARY_FRAMES */
+
 /* Structure that defines the "task-stats" command line command.  This generates
 a table that gives information on each task in the system. */
 static const CLI_Command_Definition_t xTaskStats =
@@ -161,6 +205,41 @@ static const CLI_Command_Definition_t xParameterEcho =
 	};
 #endif /* configINCLUDE_TRACE_RELATED_CLI_COMMANDS */
 
+#if( configINCLUDE_TRACE_TASK_STATS_COMMAND == 1 )
+	/* Structure that defines the "trace-task-stats" command line command.  This
+	generates a table of the task statistics kept by the trace recorder, with or
+	without a trace being recorded.  The parameter "clear" clears them. */
+	static const CLI_Command_Definition_t xTraceTaskStats =
+	{
+		"trace-task-stats",
+		"\r\ntrace-task-stats [show | clear]:\r\n Displays the run time, preemptions and wakeup latency histogram of each task, as measured by the trace recorder\r\n",
+		prvTraceTaskStatsCommand, /* The function to run. */
+		1 /* One parameter is expected.  Valid values are "show" and "clear". */
+	};
+#endif /* configINCLUDE_TRACE_TASK_STATS_COMMAND */
+
+#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+
+	#if( configUSE_TRACE_FACILITY == 1 )
+		static const CLI_Binary_Command_Definition_t xBinaryTaskStats =
+		{
+			cmdBINARY_TASK_STATS_ID,
+			"task-stats",
+			prvBinaryTaskStatsCommand
+		};
+	#endif
+
+	#if( configINCLUDE_QUERY_HEAP_COMMAND == 1 )
+		static const CLI_Binary_Command_Definition_t xBinaryQueryHeap =
+		{
+			cmdBINARY_QUERY_HEAP_ID,
+			"query-heap",
+			prvBinaryQueryHeapCommand
+		};
+	#endif
+
+#endif /* configCOMMAND_INT_BINARY_FRAMES */
+
 /*-----------------------------------------------------------*/
 
 void vRegisterSampleCLICommands( void )
@@ -187,6 +266,24 @@ void vRegisterSampleCLICommands( void )
 		FreeRTOS_CLIRegisterCommand( &xStartStopTrace );
 	}
 	#endif
+
+	#if( configINCLUDE_TRACE_TASK_STATS_COMMAND == 1 )
+	{
+		FreeRTOS_CLIRegisterCommand( &xTraceTaskStats );
+	}
+	#endif
+
+	#if( ( configCOMMAND_INT_BINARY_FRAMES == 1 ) && ( configUSE_TRACE_FACILITY == 1 ) )
+	{
+		FreeRTOS_CLIRegisterBinaryCommand( &xBinaryTaskStats );
+	}
+	#endif
+
+	#if( ( configCOMMAND_INT_BINARY_FRAMES == 1 ) && ( configINCLUDE_QUERY_HEAP_COMMAND == 1 ) )
+	{
+		FreeRTOS_CLIRegisterBinaryCommand( &xBinaryQueryHeap );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -477,3 +574,200 @@ static UBaseType_t uxParameterNumber = 0;
 	}
 
 #endif /* configINCLUDE_TRACE_RELATED_CLI_COMMANDS */
+/*-----------------------------------------------------------*/
+
+#if( configINCLUDE_TRACE_TASK_STATS_COMMAND == 1 )
+
+	static BaseType_t prvTraceTaskStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	{
+	const char *pcParameter;
+	BaseType_t lParameterStringLength, xReturn = pdFALSE;
+	static uint32_t ulTaskIndex = 0;
+	uint32_t ulCount = 0, ulBin;
+	TraceUnsignedBaseType_t uxFrequency = 0;
+	TraceTaskStats_t xStats;
+
+		/* Remove compile time warnings about unused parameters, and check the
+		write buffer is not NULL.  NOTE - for simplicity, this example assumes the
+		write buffer length is adequate, so does not check for buffer overflows. */
+		( void ) xWriteBufferLen;
+		configASSERT( pcWriteBuffer );
+
+		/* Obtain the parameter string. */
+		pcParameter = FreeRTOS_CLIGetParameter
+						(
+							pcCommandString,		/* The command string itself. */
+							1,						/* Return the first parameter. */
+							&lParameterStringLength	/* Store the parameter string length. */
+						);
+
+		/* Sanity check something was returned. */
+		configASSERT( pcParameter );
+
+		if( strncmp( pcParameter, "clear", strlen( "clear" ) ) == 0 )
+		{
+			xTraceTaskStatsClear();
+			sprintf( pcWriteBuffer, "Task statistics cleared.\r\n" );
+		}
+		else if( strncmp( pcParameter, "show", strlen( "show" ) ) == 0 )
+		{
+			/* The timestamp frequency is only set once a trace is started. */
+			xTraceTimestampGetFrequency( &uxFrequency );
+			if( uxFrequency == 0 )
+			{
+				uxFrequency = TRC_HWTC_FREQ_HZ;
+			}
+
+			xTraceTaskStatsGetCount( &ulCount );
+
+			if( ulTaskIndex == 0 )
+			{
+				/* The first time the function is called after the command has
+				been entered just a header string is returned. */
+				sprintf( pcWriteBuffer, "Task\tRun ms\tIn\tPreempt\tMax us\tLatency bins (first < %lu us, doubling)\r\n", ( unsigned long ) ( ( ( uint64_t ) 1 << TRC_CFG_TASK_STATS_LATENCY_SHIFT ) * 1000000ULL / uxFrequency ) );
+			}
+			else if( xTraceTaskStatsGetAtIndex( ulTaskIndex - 1, &xStats ) == TRC_SUCCESS )
+			{
+				/* One task per call, so the write buffer only needs room for
+				one line. */
+				pcWriteBuffer += sprintf( pcWriteBuffer, "%s\t%lu\t%lu\t%lu\t%lu\t", pcTaskGetName( ( TaskHandle_t ) xStats.pvTask ), ( unsigned long ) ( xStats.uiRunTime * 1000ULL / uxFrequency ), ( unsigned long ) xStats.uiSwitchIns, ( unsigned long ) xStats.uiPreemptions, ( unsigned long ) ( xStats.uiLatencyMax * 1000000ULL / uxFrequency ) );
+
+				for( ulBin = 0; ulBin < TRC_CFG_TASK_STATS_HISTOGRAM_BINS; ulBin++ )
+				{
+					pcWriteBuffer += sprintf( pcWriteBuffer, " %lu", ( unsigned long ) xStats.uiLatencyBins[ ulBin ] );
+				}
+
+				sprintf( pcWriteBuffer, "\r\n" );
+			}
+			else
+			{
+				/* A task was deleted since the count was read. */
+				*pcWriteBuffer = 0x00;
+			}
+
+			if( ulTaskIndex < ulCount )
+			{
+				/* There are more tasks to show. */
+				ulTaskIndex++;
+				xReturn = pdTRUE;
+			}
+			else
+			{
+				ulTaskIndex = 0;
+			}
+		}
+		else
+		{
+			sprintf( pcWriteBuffer, "Valid parameters are 'show' and 'clear'.\r\n" );
+		}
+
+		return xReturn;
+	}
+
+#endif /* configINCLUDE_TRACE_TASK_STATS_COMMAND */
+/*-----------------------------------------------------------*/
+
+#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+
+	#if( configUSE_TRACE_FACILITY == 1 )
+
+		static BaseType_t prvBinaryTaskStatsCommand( const uint8_t *pucRequest, size_t xRequestLength, uint8_t *pucResponse, size_t xResponseLength, size_t *pxResponseUsed )
+		{
+		TaskStatus_t *pxTaskStatusArray;
+		UBaseType_t uxArraySize, x, uxRecords = 0;
+		uint32_t ulTotalRunTime = 0;
+		size_t xNameLength, xUsed = 8;
+		BaseType_t xReturn = pdFAIL;
+
+			/* The request has no payload. */
+			( void ) pucRequest;
+			( void ) xRequestLength;
+
+			/* The response starts with the total run time and the number of
+			task records that follow it, each of which is:
+			  [0..3]   task number
+			  [4]      state, as an eTaskState value
+			  [5]      current priority
+			  [6..9]   stack high water mark
+			  [10..13] run time counter
+			  [14]     name length, followed by the name without a null.
+			All values are little endian.  Only whole records are returned. */
+			if( xResponseLength >= xUsed )
+			{
+				uxArraySize = uxTaskGetNumberOfTasks();
+				pxTaskStatusArray = pvPortMalloc( uxArraySize * sizeof( TaskStatus_t ) );
+
+				if( pxTaskStatusArray != NULL )
+				{
+					uxArraySize = uxTaskGetSystemState( pxTaskStatusArray, uxArraySize, &ulTotalRunTime );
+
+					for( x = 0; x < uxArraySize; x++ )
+					{
+						xNameLength = strlen( pxTaskStatusArray[ x ].pcTaskName );
+
+						if( ( xResponseLength - xUsed ) < ( 15U + xNameLength ) )
+						{
+							break;
+						}
+
+						prvPutUint32( &( pucResponse[ xUsed ] ), ( uint32_t ) pxTaskStatusArray[ x ].xTaskNumber );
+						pucResponse[ xUsed + 4U ] = ( uint8_t ) pxTaskStatusArray[ x ].eCurrentState;
+						pucResponse[ xUsed + 5U ] = ( uint8_t ) pxTaskStatusArray[ x ].uxCurrentPriority;
+						prvPutUint32( &( pucResponse[ xUsed + 6U ] ), ( uint32_t ) pxTaskStatusArray[ x ].usStackHighWaterMark );
+						prvPutUint32( &( pucResponse[ xUsed + 10U ] ), ( uint32_t ) pxTaskStatusArray[ x ].ulRunTimeCounter );
+						pucResponse[ xUsed + 14U ] = ( uint8_t ) xNameLength;
+						memcpy( &( pucResponse[ xUsed + 15U ] ), pxTaskStatusArray[ x ].pcTaskName, xNameLength );
+
+						xUsed += 15U + xNameLength;
+						uxRecords++;
+					}
+
+					vPortFree( pxTaskStatusArray );
+
+					prvPutUint32( &( pucResponse[ 0 ] ), ulTotalRunTime );
+					prvPutUint32( &( pucResponse[ 4 ] ), ( uint32_t ) uxRecords );
+					*pxResponseUsed = xUsed;
+					xReturn = pdPASS;
+				}
+			}
+
+			return xReturn;
+		}
+
+	#endif /* configUSE_TRACE_FACILITY */
+	/*-----------------------------------------------------------*/
+
+	#if( configINCLUDE_QUERY_HEAP_COMMAND == 1 )
+
+		static BaseType_t prvBinaryQueryHeapCommand( const uint8_t *pucRequest, size_t xRequestLength, uint8_t *pucResponse, size_t xResponseLength, size_t *pxResponseUsed )
+		{
+		BaseType_t xReturn = pdFAIL;
+
+			/* The request has no payload.  The response is the current free
+			heap followed by the minimum ever free heap. */
+			( void ) pucRequest;
+			( void ) xRequestLength;
+
+			if( xResponseLength >= 8U )
+			{
+				prvPutUint32( &( pucResponse[ 0 ] ), ( uint32_t ) xPortGetFreeHeapSize() );
+				prvPutUint32( &( pucResponse[ 4 ] ), ( uint32_t ) xPortGetMinimumEverFreeHeapSize() );
+				*pxResponseUsed = 8U;
+				xReturn = pdPASS;
+			}
+
+			return xReturn;
+		}
+
+	#endif /* configINCLUDE_QUERY_HEAP_COMMAND */
+	/*-----------------------------------------------------------*/
+
+	static void prvPutUint32( uint8_t *pucBuffer, uint32_t ulValue )
+	{
+		pucBuffer[ 0 ] = ( uint8_t ) ( ulValue & 0xFFUL );
+		pucBuffer[ 1 ] = ( uint8_t ) ( ( ulValue >> 8 ) & 0xFFUL );
+		pucBuffer[ 2 ] = ( uint8_t ) ( ( ulValue >> 16 ) & 0xFFUL );
+		pucBuffer[ 3 ] = ( uint8_t ) ( ulValue >> 24 );
+	}
+
+#endif /* configCOMMAND_INT_BINARY_FRAMES */
@@ -57,6 +57,11 @@ buffer at all. */
 available. */
 #define cmdMAX_MUTEX_WAIT		pdMS_TO_TICKS( 300 )
 
+/* Dimensions the buffer into which binary request frames are placed, and the
+maximum time to wait for each byte of a frame after the first. */
+#define cmdMAX_FRAME_SIZE		64
+#define cmdFRAME_BYTE_TIMEOUT	pdMS_TO_TICKS( 100 )
+
 #ifndef configCLI_BAUD_RATE
 	#define configCLI_BAUD_RATE	115200
 #endif
@@ -69,6 +74,14 @@ available. */
 static void prvUARTCommandConsoleTask( void *pvParameters );
 void vUARTCommandConsoleStart( uint16_t usStackSize, UBaseType_t uxPriority );
 
+/*
+ * Receive the rest of a binary frame whose start byte has already been
+ * received, execute it, and send the response frame.
+ */
+#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+	static void prvProcessFrame( xComPortHandle xPort, uint8_t *pucResponse, size_t xResponseLength );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* Const messages output by the command console. */
@@ -130,6 +143,19 @@ xComPortHandle xPort;
 		be a genuine block time rather than an infinite block time. */
 		while( xSerialGetChar( xPort, &cRxedChar, portMAX_DELAY ) != pdPASS );
 
+		#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+		{
+			/* A frame start byte received between text commands means a
+			program, rather than a person, is sending a binary frame.  Frames
+			are not echoed. */
+			if( ( cRxedChar == ( signed char ) cliFRAME_START ) && ( ucInputIndex == 0 ) )
+			{
+				prvProcessFrame( xPort, ( uint8_t * ) pcOutputString, configCOMMAND_INT_MAX_OUTPUT_SIZE );
+				continue;
+			}
+		}
+		#endif
+
 		/* Ensure exclusive access to the UART Tx. */
 		if( xSemaphoreTake( xTxMutex, cmdMAX_MUTEX_WAIT ) == pdPASS )
 		{
@@ -213,6 +239,58 @@ xComPortHandle xPort;
 }
 /*-----------------------------------------------------------*/
 
+#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+
+	static void prvProcessFrame( xComPortHandle xPort, uint8_t *pucResponse, size_t xResponseLength )
+	{
+	static uint8_t ucFrame[ cmdMAX_FRAME_SIZE ];
+	size_t xReceived = 1, xFrameLength = cliFRAME_REQUEST_HEADER_SIZE, xResponseUsed;
+	signed char cRxedChar;
+
+		ucFrame[ 0 ] = cliFRAME_START;
+
+		/* Receive the length, then as many bytes as it says follow it.  Bytes
+		that do not fit in ucFrame are discarded, which leaves an incomplete
+		frame that FreeRTOS_CLIProcessFrame() will reject, as it will a frame
+		that stops part way through. */
+		while( xReceived < xFrameLength )
+		{
+			if( xSerialGetChar( xPort, &cRxedChar, cmdFRAME_BYTE_TIMEOUT ) != pdPASS )
+			{
+				break;
+			}
+
+			if( xReceived < cmdMAX_FRAME_SIZE )
+			{
+				ucFrame[ xReceived ] = ( uint8_t ) cRxedChar;
+			}
+
+			xReceived++;
+
+			if( xReceived == 3 )
+			{
+				/* The little endian length has been received. */
+				xFrameLength = 3 + ( ( ( size_t ) ucFrame[ 2 ] << 8 ) | ( size_t ) ucFrame[ 1 ] );
+			}
+		}
+
+		if( xReceived > cmdMAX_FRAME_SIZE )
+		{
+			xReceived = cmdMAX_FRAME_SIZE;
+		}
+
+		xResponseUsed = FreeRTOS_CLIProcessFrame( ucFrame, xReceived, pucResponse, xResponseLength );
+
+		if( xSemaphoreTake( xTxMutex, cmdMAX_MUTEX_WAIT ) == pdPASS )
+		{
+			vSerialPutString( xPort, ( signed char * ) pucResponse, ( unsigned short ) xResponseUsed );
+			xSemaphoreGive( xTxMutex );
+		}
+	}
+
+#endif /* configCOMMAND_INT_BINARY_FRAMES */
+/*-----------------------------------------------------------*/
+
 void vOutputString( const char * const pcMessage )
 {
 	if( xSemaphoreTake( xTxMutex, cmdMAX_MUTEX_WAIT ) == pdPASS )
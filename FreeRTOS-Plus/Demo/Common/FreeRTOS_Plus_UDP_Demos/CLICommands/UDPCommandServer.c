@@ -27,6 +27,7 @@
 /* Standard includes. */
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
@@ -48,8 +49,23 @@
 /* Dimensions the buffer into which string outputs can be placed. */
 #define cmdMAX_OUTPUT_SIZE	1250
 
-/* Dimensions the buffer passed to the recvfrom() call. */
-#define cmdSOCKET_INPUT_BUFFER_SIZE 60
+/* The largest UDP payload that fits in one Ethernet frame without IP
+fragmentation.  28 is the size of the IP and UDP headers. */
+#ifdef ipconfigNETWORK_MTU
+	#define cmdMAX_DATAGRAM_SIZE	( ipconfigNETWORK_MTU - 28 )
+#else
+	#define cmdMAX_DATAGRAM_SIZE	1472
+#endif
+
+/* Dimensions the buffer passed to the recvfrom() call.  A datagram can carry
+several newline separated commands, so it is large enough for a full
+datagram. */
+#define cmdSOCKET_INPUT_BUFFER_SIZE cmdMAX_DATAGRAM_SIZE
+
+/* The maximum number of datagrams that are received, without blocking, after
+the first of a batch.  The output of every command in a batch is collected into
+as few datagrams as possible before it is sent. */
+#define cmdMAX_BATCH_SIZE	8
 
 /*
  * The task that runs FreeRTOS+CLI.
@@ -61,6 +77,43 @@ void vUDPCommandInterpreterTask( void *pvParameters );
  */
 static xSocket_t prvOpenUDPServerSocket( uint16_t usPort );
 
+/*
+ * Execute each newline terminated command in the datagram received from
+ * pxClient, adding the output to the pending response.
+ */
+static void prvProcessDatagram( xSocket_t xSocket, const char *pcData, long lBytes, const struct freertos_sockaddr *pxClient );
+
+/*
+ * Add xLength bytes of output for pxClient to the pending response, sending
+ * the pending response first if it is for a different client or if the output
+ * will not fit.
+ */
+static void prvQueueResponse( xSocket_t xSocket, const char *pcData, size_t xLength, const struct freertos_sockaddr *pxClient );
+
+/*
+ * Send the pending response, if any.
+ */
+static void prvSendResponse( xSocket_t xSocket );
+
+/*
+ * Return pdTRUE if pxA and pxB are the same client address and port.
+ */
+static BaseType_t prvIsSameClient( const struct freertos_sockaddr *pxA, const struct freertos_sockaddr *pxB );
+
+/*-----------------------------------------------------------*/
+
+/* Characters received from the client whose command has not yet been
+terminated by a newline. */
+static char cInputString[ cmdMAX_INPUT_SIZE ];
+static signed char cInputIndex = 0;
+
+/* The output of the commands executed so far in the current batch, which is
+sent to xResponseClient as a single datagram once the batch is complete or the
+datagram is full. */
+static char cOutputString[ cmdMAX_OUTPUT_SIZE ], cResponse[ cmdMAX_DATAGRAM_SIZE ];
+static size_t xResponseLength = 0;
+static struct freertos_sockaddr xResponseClient, xInputClient;
+
 /*-----------------------------------------------------------*/
 
 void vStartUDPCommandInterpreterTask( uint16_t usStackSize, uint32_t ulPort, UBaseType_t uxPriority )
@@ -76,10 +129,10 @@ void vStartUDPCommandInterpreterTask( uint16_t usStackSize, uint32_t ulPort, UBa
  */
 void vUDPCommandInterpreterTask( void *pvParameters )
 {
-long lBytes, lByte;
-signed char cInChar, cInputIndex = 0;
-static char cInputString[ cmdMAX_INPUT_SIZE ], cOutputString[ cmdMAX_OUTPUT_SIZE ], cLocalBuffer[ cmdSOCKET_INPUT_BUFFER_SIZE ];
-BaseType_t xMoreDataToFollow;
+long lBytes;
+UBaseType_t uxDatagrams;
+BaseType_t xFlags;
+static char cLocalBuffer[ cmdSOCKET_INPUT_BUFFER_SIZE ];
 struct freertos_sockaddr xClient;
 socklen_t xClientAddressLength = 0; /* This is required as a parameter to maintain the sendto() Berkeley sockets API - but it is not actually used so can take any value. */
 xSocket_t xSocket;
@@ -96,77 +149,26 @@ xSocket_t xSocket;
 	{
 		for( ;; )
 		{
-			/* Wait for incoming data on the opened socket. */
-			lBytes = FreeRTOS_recvfrom( xSocket, ( void * ) cLocalBuffer, sizeof( cLocalBuffer ), 0, &xClient, &xClientAddressLength );
-
-			if( lBytes != FREERTOS_SOCKET_ERROR )
+			/* Wait for incoming data on the opened socket, then also take any
+			datagrams that are already queued so the output of all the commands
+			they contain can share as few response datagrams as possible.
+			Pollers that send several commands at once then get a single
+			reply. */
+			xFlags = 0;
+			for( uxDatagrams = 0; uxDatagrams <= cmdMAX_BATCH_SIZE; uxDatagrams++ )
 			{
-				/* Process each received byte in turn. */
-				lByte = 0;
-				while( lByte < lBytes )
+				lBytes = FreeRTOS_recvfrom( xSocket, ( void * ) cLocalBuffer, sizeof( cLocalBuffer ), xFlags, &xClient, &xClientAddressLength );
+
+				if( ( lBytes == FREERTOS_SOCKET_ERROR ) || ( lBytes <= 0 ) )
 				{
-					/* The next character in the input buffer. */
-					cInChar = cLocalBuffer[ lByte ];
-					lByte++;
-
-					/* Newline characters are taken as the end of the command
-					string. */
-					if( cInChar == '\n' )
-					{
-						/* Process the input string received prior to the
-						newline. */
-						do
-						{
-							/* Pass the string to FreeRTOS+CLI. */
-							xMoreDataToFollow = FreeRTOS_CLIProcessCommand( cInputString, cOutputString, cmdMAX_OUTPUT_SIZE );
-
-							/* Send the output generated by the command's
-							implementation. */
-							FreeRTOS_sendto( xSocket, cOutputString,  strlen( cOutputString ), 0, &xClient, xClientAddressLength );
-
-						} while( xMoreDataToFollow != pdFALSE ); /* Until the command does not generate any more output. */
-
-						/* All the strings generated by the command processing
-						have been sent.  Clear the input string ready to receive
-						the next command. */
-						cInputIndex = 0;
-						memset( cInputString, 0x00, cmdMAX_INPUT_SIZE );
-
-						/* Transmit a spacer, just to make the command console
-						easier to read. */
-						FreeRTOS_sendto( xSocket, "\r\n",  strlen( "\r\n" ), 0, &xClient, xClientAddressLength );
-					}
-					else
-					{
-						if( cInChar == '\r' )
-						{
-							/* Ignore the character.  Newlines are used to
-							detect the end of the input string. */
-						}
-						else if( cInChar == '\b' )
-						{
-							/* Backspace was pressed.  Erase the last character
-							in the string - if any. */
-							if( cInputIndex > 0 )
-							{
-								cInputIndex--;
-								cInputString[ cInputIndex ] = '\0';
-							}
-						}
-						else
-						{
-							/* A character was entered.  Add it to the string
-							entered so far.  When a \n is entered the complete
-							string will be passed to the command interpreter. */
-							if( cInputIndex < cmdMAX_INPUT_SIZE )
-							{
-								cInputString[ cInputIndex ] = cInChar;
-								cInputIndex++;
-							}
-						}
-					}
+					break;
 				}
+
+				prvProcessDatagram( xSocket, cLocalBuffer, lBytes, &xClient );
+				xFlags = FREERTOS_MSG_DONTWAIT;
 			}
+
+			prvSendResponse( xSocket );
 		}
 	}
 	else
@@ -177,6 +179,185 @@ xSocket_t xSocket;
 }
 /*-----------------------------------------------------------*/
 
+static void prvProcessDatagram( xSocket_t xSocket, const char *pcData, long lBytes, const struct freertos_sockaddr *pxClient )
+{
+long lByte;
+signed char cInChar;
+BaseType_t xMoreDataToFollow;
+
+	/* A partial command can only be completed by the client that sent it. */
+	if( prvIsSameClient( pxClient, &xInputClient ) == pdFALSE )
+	{
+		cInputIndex = 0;
+		memset( cInputString, 0x00, cmdMAX_INPUT_SIZE );
+		xInputClient = *pxClient;
+	}
+
+	#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+	{
+		/* A datagram that starts with a frame start byte holds one binary
+		frame, which is executed as a whole rather than being passed through
+		the line editing below.  Its response is a datagram of its own. */
+		if( ( ( uint8_t ) pcData[ 0 ] == cliFRAME_START ) && ( cInputIndex == 0 ) )
+		{
+			prvSendResponse( xSocket );
+			lByte = ( long ) FreeRTOS_CLIProcessFrame( ( const uint8_t * ) pcData, ( size_t ) lBytes, ( uint8_t * ) cOutputString, cmdMAX_OUTPUT_SIZE );
+			FreeRTOS_sendto( xSocket, cOutputString, ( size_t ) lByte, 0, pxClient, sizeof( *pxClient ) );
+			return;
+		}
+	}
+	#endif
+
+	/* Process each received byte in turn. */
+	lByte = 0;
+	while( lByte < lBytes )
+	{
+		/* The next character in the input buffer. */
+		cInChar = pcData[ lByte ];
+		lByte++;
+
+		/* Newline characters are taken as the end of the command
+		string. */
+		if( cInChar == '\n' )
+		{
+			/* Process the input string received prior to the
+			newline. */
+			do
+			{
+				/* Pass the string to FreeRTOS+CLI. */
+				xMoreDataToFollow = FreeRTOS_CLIProcessCommand( cInputString, cOutputString, cmdMAX_OUTPUT_SIZE );
+
+				/* Queue the output generated by the command's
+				implementation. */
+				prvQueueResponse( xSocket, cOutputString, strlen( cOutputString ), pxClient );
+
+			} while( xMoreDataToFollow != pdFALSE ); /* Until the command does not generate any more output. */
+
+			/* All the strings generated by the command processing
+			have been queued.  Clear the input string ready to receive
+			the next command. */
+			cInputIndex = 0;
+			memset( cInputString, 0x00, cmdMAX_INPUT_SIZE );
+
+			/* Add a spacer, just to make the command console
+			easier to read. */
+			prvQueueResponse( xSocket, "\r\n", strlen( "\r\n" ), pxClient );
+		}
+		else
+		{
+			if( cInChar == '\r' )
+			{
+				/* Ignore the character.  Newlines are used to
+				detect the end of the input string. */
+			}
+			else if( cInChar == '\b' )
+			{
+				/* Backspace was pressed.  Erase the last character
+				in the string - if any. */
+				if( cInputIndex > 0 )
+				{
+					cInputIndex--;
+					cInputString[ cInputIndex ] = '\0';
+				}
+			}
+			else
+			{
+				/* A character was entered.  Add it to the string
+				entered so far.  When a \n is entered the complete
+				string will be passed to the command interpreter.  One
+				byte is kept for the terminating null. */
+				if( cInputIndex < ( cmdMAX_INPUT_SIZE - 1 ) )
+				{
+					cInputString[ cInputIndex ] = cInChar;
+					cInputIndex++;
+				}
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueResponse( xSocket_t xSocket, const char *pcData, size_t xLength, const struct freertos_sockaddr *pxClient )
+{
+size_t xSpace;
+
+	if( ( xResponseLength > 0 ) && ( prvIsSameClient( pxClient, &xResponseClient ) == pdFALSE ) )
+	{
+		prvSendResponse( xSocket );
+	}
+
+	xResponseClient = *pxClient;
+
+	while( xLength > 0 )
+	{
+		xSpace = sizeof( cResponse ) - xResponseLength;
+
+		if( xSpace == 0 )
+		{
+			prvSendResponse( xSocket );
+		}
+		else
+		{
+			/* Output that does not fit in the space that remains is started
+			in a new datagram rather than split, unless it is too long for any
+			datagram. */
+			if( ( xLength > xSpace ) && ( xLength <= sizeof( cResponse ) ) && ( xResponseLength > 0 ) )
+			{
+				prvSendResponse( xSocket );
+				xSpace = sizeof( cResponse );
+			}
+
+			if( xSpace > xLength )
+			{
+				xSpace = xLength;
+			}
+
+			memcpy( &( cResponse[ xResponseLength ] ), pcData, xSpace );
+			xResponseLength += xSpace;
+			pcData += xSpace;
+			xLength -= xSpace;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendResponse( xSocket_t xSocket )
+{
+	if( xResponseLength > 0 )
+	{
+		FreeRTOS_sendto( xSocket, cResponse, xResponseLength, 0, &xResponseClient, sizeof( xResponseClient ) );
+		xResponseLength = 0;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsSameClient( const struct freertos_sockaddr *pxA, const struct freertos_sockaddr *pxB )
+{
+BaseType_t xReturn = pdFALSE;
+
+	if( pxA->sin_port == pxB->sin_port )
+	{
+		#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+		{
+			if( pxA->sin_address.ulIP_IPv4 == pxB->sin_address.ulIP_IPv4 )
+			{
+				xReturn = pdTRUE;
+			}
+		}
+		#else
+		{
+			if( pxA->sin_addr == pxB->sin_addr )
+			{
+				xReturn = pdTRUE;
+			}
+		}
+		#endif
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
 static xSocket_t prvOpenUDPServerSocket( uint16_t usPort )
 {
 struct freertos_sockaddr xServer;
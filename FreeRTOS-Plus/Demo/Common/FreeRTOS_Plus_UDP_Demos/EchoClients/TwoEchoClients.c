@@ -38,6 +38,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
@@ -75,6 +76,76 @@ network does not get too congested. */
 protocol port. */
 #define echoECHO_PORT	( 7 )
 
+/* Set echoTHROUGHPUT_TEST to 1 in FreeRTOSConfig.h to replace the two echo
+client tasks with echoTHROUGHPUT_STREAMS tasks that measure the round trip
+time and throughput of the echo server, in the style of iperf.  Each task first
+times echoTHROUGHPUT_RTT_SAMPLES datagrams sent one at a time, then keeps up to
+echoTHROUGHPUT_WINDOW datagrams in flight for echoTHROUGHPUT_DURATION_MS. */
+#ifndef echoTHROUGHPUT_TEST
+	#define echoTHROUGHPUT_TEST	0
+#endif
+
+#if( echoTHROUGHPUT_TEST == 1 )
+
+	#ifndef echoTHROUGHPUT_STREAMS
+		#define echoTHROUGHPUT_STREAMS		( 2 )
+	#endif
+
+	/* Size of each datagram, which must fit in one Ethernet frame. */
+	#ifndef echoTHROUGHPUT_MESSAGE_SIZE
+		#define echoTHROUGHPUT_MESSAGE_SIZE	( 1024 )
+	#endif
+
+	/* The number of datagrams that can be waiting for their echo. */
+	#ifndef echoTHROUGHPUT_WINDOW
+		#define echoTHROUGHPUT_WINDOW		( 4 )
+	#endif
+
+	#ifndef echoTHROUGHPUT_DURATION_MS
+		#define echoTHROUGHPUT_DURATION_MS	( 10000 )
+	#endif
+
+	#ifndef echoTHROUGHPUT_RTT_SAMPLES
+		#define echoTHROUGHPUT_RTT_SAMPLES	( 100 )
+	#endif
+
+	/* Times are taken from the tick count unless the application provides a
+	finer clock. */
+	#ifndef echoTIMESTAMP_US
+		#define echoTIMESTAMP_US()	( ( uint32_t ) ( ( uint64_t ) xTaskGetTickCount() * 1000000ULL / configTICK_RATE_HZ ) )
+	#endif
+
+	#if( echoTHROUGHPUT_MESSAGE_SIZE < 8 ) || ( echoTHROUGHPUT_MESSAGE_SIZE > ( ipconfigNETWORK_MTU - 28 ) )
+		#error echoTHROUGHPUT_MESSAGE_SIZE must hold the 8 byte header and fit in one frame.
+	#endif
+
+	/* Each datagram starts with its sequence number and the time it was sent,
+	both in the byte order of the sender as only the sender reads them. */
+	typedef struct xTHROUGHPUT_HEADER
+	{
+		uint32_t ulSequence;
+		uint32_t ulSentUs;
+	} xThroughputHeader_t;
+
+	/* Results of the latest run of each stream. */
+	typedef struct xTHROUGHPUT_RESULT
+	{
+		uint32_t ulRttUs[ echoTHROUGHPUT_RTT_SAMPLES ];	/* Sorted once the run is complete. */
+		uint32_t ulBytesEchoed;
+		uint32_t ulElapsedUs;
+		uint32_t ulRetransmits;							/* Latency probes sent again after a timeout. */
+		uint32_t ulLost;								/* Throughput datagrams that were never echoed. */
+	} xThroughputResult_t;
+
+	static xThroughputResult_t xThroughputResults[ echoTHROUGHPUT_STREAMS ];
+	static uint8_t ucThroughputBuffers[ echoTHROUGHPUT_STREAMS ][ echoTHROUGHPUT_MESSAGE_SIZE ];
+
+	/* Counts streams which finished the current run, so the last one to finish
+	can print the totals. */
+	static BaseType_t xStreamsReported = 0;
+
+#endif /* echoTHROUGHPUT_TEST */
+
 /*
  * Uses a socket to send data to, then receive data from, the standard echo
  * port number 7.  prvEchoClientTask() uses the standard interface.
@@ -83,6 +154,14 @@ protocol port. */
 static void prvEchoClientTask( void *pvParameters );
 static void prvZeroCopyEchoClientTask( void *pvParameters );
 
+#if( echoTHROUGHPUT_TEST == 1 )
+	/*
+	 * Implements one stream of the throughput test.  The parameter is the
+	 * index of the stream.
+	 */
+	static void prvThroughputClientTask( void *pvParameters );
+#endif
+
 /* The receive timeout is set shorter when the windows simulator is used
 because simulated time is slower than real time. */
 #ifdef _WINDOWS_
@@ -95,6 +174,16 @@ because simulated time is slower than real time. */
 
 void vStartEchoClientTasks( uint16_t usTaskStackSize, UBaseType_t uxTaskPriority )
 {
+#if( echoTHROUGHPUT_TEST == 1 )
+BaseType_t x;
+
+	/* The throughput streams replace the echo tasks so the two do not compete
+	for the link. */
+	for( x = 0; x < echoTHROUGHPUT_STREAMS; x++ )
+	{
+		xTaskCreate( prvThroughputClientTask, "EchoPerf", usTaskStackSize, ( void * ) x, uxTaskPriority, NULL );
+	}
+#else
 	/* Create the echo client task that does not use the zero copy interface. */
 	xTaskCreate( 	prvEchoClientTask,	/* The function that implements the task. */
 					"Echo0",			/* Just a text name for the task to aid debugging. */
@@ -110,6 +199,7 @@ void vStartEchoClientTasks( uint16_t usTaskStackSize, UBaseType_t uxTaskPriority
 					NULL,						/* The task parameter, not used in this case. */
 					uxTaskPriority,				/* The priority assigned to the task is defined in FreeRTOSConfig.h. */
 					NULL );						/* The task handle is not used. */
+#endif /* echoTHROUGHPUT_TEST */
 }
 /*-----------------------------------------------------------*/
 
@@ -384,3 +474,276 @@ const size_t xBufferLength = strlen( pcStringToSend ) + 15;
 }
 /*-----------------------------------------------------------*/
 
+#if( echoTHROUGHPUT_TEST == 1 )
+
+	static BaseType_t prvSendProbe( xSocket_t xSocket, struct freertos_sockaddr *pxAddress, uint8_t *pucBuffer, uint32_t ulSequence )
+	{
+	xThroughputHeader_t xHeader;
+	int32_t lReturned;
+
+		xHeader.ulSequence = ulSequence;
+		xHeader.ulSentUs = echoTIMESTAMP_US();
+		memcpy( pucBuffer, &xHeader, sizeof( xHeader ) );
+
+		lReturned = FreeRTOS_sendto( xSocket, pucBuffer, echoTHROUGHPUT_MESSAGE_SIZE, 0, pxAddress, sizeof( *pxAddress ) );
+
+		return ( lReturned == echoTHROUGHPUT_MESSAGE_SIZE ) ? pdPASS : pdFAIL;
+	}
+	/*-----------------------------------------------------------*/
+
+	/* Returns pdPASS and the header of the next full size echo, or pdFAIL if
+	none arrived before the receive timeout. */
+	static BaseType_t prvReceiveEcho( xSocket_t xSocket, uint8_t *pucBuffer, xThroughputHeader_t *pxHeader )
+	{
+	struct freertos_sockaddr xSource;
+	uint32_t xAddressLength = sizeof( xSource );
+	int32_t lReturned;
+
+		lReturned = FreeRTOS_recvfrom( xSocket, pucBuffer, echoTHROUGHPUT_MESSAGE_SIZE, 0, &xSource, &xAddressLength );
+
+		if( lReturned != echoTHROUGHPUT_MESSAGE_SIZE )
+		{
+			return pdFAIL;
+		}
+
+		memcpy( pxHeader, pucBuffer, sizeof( *pxHeader ) );
+		return pdPASS;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvMeasureLatency( xSocket_t xSocket, struct freertos_sockaddr *pxAddress, BaseType_t xInstance, uint32_t *pulSequence )
+	{
+	uint8_t *pucBuffer = ucThroughputBuffers[ xInstance ];
+	xThroughputResult_t *pxResult = &( xThroughputResults[ xInstance ] );
+	xThroughputHeader_t xHeader;
+	BaseType_t xSample, xReceived;
+	uint32_t ulRttUs;
+
+		for( xSample = 0; xSample < echoTHROUGHPUT_RTT_SAMPLES; xSample++ )
+		{
+			ulRttUs = UINT32_MAX;
+			( *pulSequence )++;
+
+			/* A lost probe is sent again until one comes back.  The sample is
+			the round trip of whichever copy was echoed. */
+			while( ulRttUs == UINT32_MAX )
+			{
+				if( prvSendProbe( xSocket, pxAddress, pucBuffer, *pulSequence ) != pdPASS )
+				{
+					vTaskDelay( echoTINY_DELAY );
+					continue;
+				}
+
+				do
+				{
+					xReceived = prvReceiveEcho( xSocket, pucBuffer, &xHeader );
+				} while( ( xReceived == pdPASS ) && ( xHeader.ulSequence != *pulSequence ) );
+
+				if( xReceived == pdPASS )
+				{
+					ulRttUs = echoTIMESTAMP_US() - xHeader.ulSentUs;
+				}
+				else
+				{
+					pxResult->ulRetransmits++;
+				}
+			}
+
+			pxResult->ulRttUs[ xSample ] = ulRttUs;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvMeasureThroughput( xSocket_t xSocket, struct freertos_sockaddr *pxAddress, BaseType_t xInstance, uint32_t *pulSequence )
+	{
+	uint8_t *pucBuffer = ucThroughputBuffers[ xInstance ];
+	xThroughputResult_t *pxResult = &( xThroughputResults[ xInstance ] );
+	xThroughputHeader_t xHeader;
+	uint32_t ulStart, ulNow, ulFirstInFlight, ulInFlight = 0;
+	const uint32_t ulDurationUs = ( uint32_t ) echoTHROUGHPUT_DURATION_MS * 1000UL;
+
+		ulStart = echoTIMESTAMP_US();
+		ulNow = ulStart;
+		ulFirstInFlight = *pulSequence + 1UL;
+
+		while( ( ( ulNow - ulStart ) < ulDurationUs ) || ( ulInFlight > 0UL ) )
+		{
+			/* Fill the window, then wait for an echo to make room. */
+			while( ( ( ulNow - ulStart ) < ulDurationUs ) && ( ulInFlight < echoTHROUGHPUT_WINDOW ) )
+			{
+				( *pulSequence )++;
+
+				if( prvSendProbe( xSocket, pxAddress, pucBuffer, *pulSequence ) == pdPASS )
+				{
+					ulInFlight++;
+				}
+				else
+				{
+					/* No network buffer - the datagram is treated as lost. */
+					pxResult->ulLost++;
+				}
+			}
+
+			if( ulInFlight == 0UL )
+			{
+				break;
+			}
+
+			if( prvReceiveEcho( xSocket, pucBuffer, &xHeader ) == pdPASS )
+			{
+				/* Ignore late echoes of datagrams already counted as lost and
+				anything left over from the latency phase. */
+				if( ( xHeader.ulSequence - ulFirstInFlight ) <= ( *pulSequence - ulFirstInFlight ) )
+				{
+					ulInFlight--;
+					pxResult->ulBytesEchoed += echoTHROUGHPUT_MESSAGE_SIZE;
+				}
+			}
+			else
+			{
+				/* Nothing came back within the receive timeout, so everything
+				in flight is lost. */
+				pxResult->ulLost += ulInFlight;
+				ulInFlight = 0UL;
+				ulFirstInFlight = *pulSequence + 1UL;
+			}
+
+			ulNow = echoTIMESTAMP_US();
+		}
+
+		pxResult->ulElapsedUs = ulNow - ulStart;
+	}
+	/*-----------------------------------------------------------*/
+
+	static uint32_t prvKbitPerSecond( uint32_t ulBytes, uint32_t ulElapsedUs )
+	{
+		return ( ulElapsedUs > 0UL ) ? ( uint32_t ) ( ( ( uint64_t ) ulBytes * 8000ULL ) / ulElapsedUs ) : 0UL;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvReportThroughput( BaseType_t xInstance )
+	{
+	xThroughputResult_t *pxResult = &( xThroughputResults[ xInstance ] );
+	uint32_t *pulRtt = pxResult->ulRttUs;
+	uint32_t ulValue, ulKbps, ulBytes = 0UL, ulElapsedUs = 0UL, ulLost = 0UL, ulRetransmits = 0UL;
+	BaseType_t x, y, xLast;
+
+		/* Insertion sort - there are only a few samples. */
+		for( x = 1; x < echoTHROUGHPUT_RTT_SAMPLES; x++ )
+		{
+			ulValue = pulRtt[ x ];
+
+			for( y = x; ( y > 0 ) && ( pulRtt[ y - 1 ] > ulValue ); y-- )
+			{
+				pulRtt[ y ] = pulRtt[ y - 1 ];
+			}
+
+			pulRtt[ y ] = ulValue;
+		}
+
+		ulKbps = prvKbitPerSecond( pxResult->ulBytesEchoed, pxResult->ulElapsedUs );
+
+		printf( "[%ld] %lu KB in %lu ms: %lu.%03lu Mbit/s, RTT us p50 %lu p90 %lu p99 %lu max %lu, retransmits %lu, lost %lu\r\n",
+				( long ) xInstance,
+				( unsigned long ) ( pxResult->ulBytesEchoed / 1024UL ),
+				( unsigned long ) ( pxResult->ulElapsedUs / 1000UL ),
+				( unsigned long ) ( ulKbps / 1000UL ),
+				( unsigned long ) ( ulKbps % 1000UL ),
+				( unsigned long ) pulRtt[ ( echoTHROUGHPUT_RTT_SAMPLES * 50 ) / 100 ],
+				( unsigned long ) pulRtt[ ( echoTHROUGHPUT_RTT_SAMPLES * 90 ) / 100 ],
+				( unsigned long ) pulRtt[ ( echoTHROUGHPUT_RTT_SAMPLES * 99 ) / 100 ],
+				( unsigned long ) pulRtt[ echoTHROUGHPUT_RTT_SAMPLES - 1 ],
+				( unsigned long ) pxResult->ulRetransmits,
+				( unsigned long ) pxResult->ulLost );
+
+		taskENTER_CRITICAL();
+		{
+			xStreamsReported++;
+			xLast = ( xStreamsReported == echoTHROUGHPUT_STREAMS ) ? pdTRUE : pdFALSE;
+
+			if( xLast != pdFALSE )
+			{
+				xStreamsReported = 0;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( ( xLast != pdFALSE ) && ( echoTHROUGHPUT_STREAMS > 1 ) )
+		{
+			/* The streams ran concurrently, so the total rate is the total
+			data over the longest run. */
+			for( x = 0; x < echoTHROUGHPUT_STREAMS; x++ )
+			{
+				ulBytes += xThroughputResults[ x ].ulBytesEchoed;
+				ulLost += xThroughputResults[ x ].ulLost;
+				ulRetransmits += xThroughputResults[ x ].ulRetransmits;
+
+				if( xThroughputResults[ x ].ulElapsedUs > ulElapsedUs )
+				{
+					ulElapsedUs = xThroughputResults[ x ].ulElapsedUs;
+				}
+			}
+
+			ulKbps = prvKbitPerSecond( ulBytes, ulElapsedUs );
+
+			printf( "[SUM] %lu KB in %lu ms: %lu.%03lu Mbit/s, retransmits %lu, lost %lu\r\n",
+					( unsigned long ) ( ulBytes / 1024UL ),
+					( unsigned long ) ( ulElapsedUs / 1000UL ),
+					( unsigned long ) ( ulKbps / 1000UL ),
+					( unsigned long ) ( ulKbps % 1000UL ),
+					( unsigned long ) ulRetransmits,
+					( unsigned long ) ulLost );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvThroughputClientTask( void *pvParameters )
+	{
+	xSocket_t xSocket;
+	struct freertos_sockaddr xEchoServerAddress;
+	BaseType_t xInstance = ( BaseType_t ) pvParameters;
+	xThroughputResult_t *pxResult = &( xThroughputResults[ xInstance ] );
+	uint32_t ulSequence = 0UL;
+
+		xEchoServerAddress.sin_port = FreeRTOS_htons( echoECHO_PORT );
+
+		#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+		{
+			xEchoServerAddress.sin_address.ulIP_IPv4 = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
+																	configECHO_SERVER_ADDR1,
+																	configECHO_SERVER_ADDR2,
+																	configECHO_SERVER_ADDR3 );
+		}
+		#else
+		{
+			xEchoServerAddress.sin_addr = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
+																	configECHO_SERVER_ADDR1,
+																	configECHO_SERVER_ADDR2,
+																	configECHO_SERVER_ADDR3 );
+		}
+		#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+
+		xEchoServerAddress.sin_family = FREERTOS_AF_INET;
+
+		/* The payload after the header is never checked, but give it a
+		recognisable pattern for anyone watching the link. */
+		memset( ucThroughputBuffers[ xInstance ], 'a' + ( int ) xInstance, echoTHROUGHPUT_MESSAGE_SIZE );
+
+		for( ;; )
+		{
+			xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+			configASSERT( xSocket != FREERTOS_INVALID_SOCKET );
+			FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
+
+			memset( pxResult, 0x00, sizeof( *pxResult ) );
+			prvMeasureLatency( xSocket, &xEchoServerAddress, xInstance, &ulSequence );
+			prvMeasureThroughput( xSocket, &xEchoServerAddress, xInstance, &ulSequence );
+			prvReportThroughput( xInstance );
+
+			FreeRTOS_closesocket( xSocket );
+			vTaskDelay( echoLOOP_DELAY );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* echoTHROUGHPUT_TEST */
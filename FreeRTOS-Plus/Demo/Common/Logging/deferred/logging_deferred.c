@@ -0,0 +1,300 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Deferred logging backend, see logging_deferred.h.
+ *
+ * Each line is formatted by the task that logs it and copied, prefixed with its
+ * length, into a ring buffer.  The copy is done inside a critical section so
+ * any number of tasks can log at the same time, which keeps the cost per line
+ * to a few microseconds.  A low priority task is notified, takes the lines out
+ * of the ring buffer one at a time and outputs them with dlDEFERRED_OUTPUT().
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "logging_deferred.h"
+
+/*-----------------------------------------------------------*/
+
+/* The line break appended to every line. */
+#define dlLINE_BREAK           "\r\n"
+#define dlLINE_BREAK_LENGTH    ( sizeof( dlLINE_BREAK ) - 1U )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Copy a record into the ring buffer.  Returns pdFALSE if it does not fit.
+ */
+static BaseType_t prvRingWrite( const char * pcLine,
+                                uint16_t usLength );
+
+/*
+ * Take the oldest record out of the ring buffer into pcLine, which must hold
+ * dlDEFERRED_MAX_LINE_LENGTH bytes.  Returns its length, or 0 if the ring
+ * buffer is empty.
+ */
+static uint16_t prvRingRead( char * pcLine );
+
+/*
+ * The task that outputs the queued lines.
+ */
+static void prvLoggingTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+/* The ring buffer.  Each record is a 16-bit length followed by that many
+ * characters.  Records may wrap around the end of the array. */
+static uint8_t ucRing[ dlDEFERRED_BUFFER_SIZE ];
+
+/* Where the next record is written and read, and the number of bytes in use.
+ * Only accessed inside a critical section. */
+static size_t uxRingHead = 0U;
+static size_t uxRingTail = 0U;
+static size_t uxRingUsed = 0U;
+
+/* Lines that did not fit in the ring buffer. */
+static volatile uint32_t ulDroppedLines = 0U;
+
+/* The task that outputs the lines, NULL until xLoggingDeferredInit() is
+ * called. */
+static TaskHandle_t xLoggingTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingDeferredInit( UBaseType_t uxPriority )
+{
+    BaseType_t xReturn = pdPASS;
+
+    if( xLoggingTask == NULL )
+    {
+        xReturn = xTaskCreate( prvLoggingTask,
+                               "Logging",
+                               dlDEFERRED_TASK_STACK_SIZE,
+                               NULL,
+                               uxPriority,
+                               &xLoggingTask );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingDeferredLine( const char * pcLevel,
+                           const char * pcLibrary,
+                           const char * pcFunction,
+                           int iLine,
+                           const char * pcFormat,
+                           ... )
+{
+    char cLine[ dlDEFERRED_MAX_LINE_LENGTH ];
+    const size_t uxMaxText = sizeof( cLine ) - dlLINE_BREAK_LENGTH - 1U;
+    size_t uxLength;
+    int iResult;
+    va_list xArgs;
+
+    /* The same prefix as the default logging macros produce. */
+    iResult = snprintf( cLine, uxMaxText + 1U, "[%s] [%s] [%s:%d] ", pcLevel, pcLibrary, pcFunction, iLine );
+    uxLength = ( iResult < 0 ) ? 0U : ( size_t ) iResult;
+
+    if( uxLength > uxMaxText )
+    {
+        uxLength = uxMaxText;
+    }
+
+    va_start( xArgs, pcFormat );
+    iResult = vsnprintf( &( cLine[ uxLength ] ), ( uxMaxText + 1U ) - uxLength, pcFormat, xArgs );
+    va_end( xArgs );
+
+    if( iResult > 0 )
+    {
+        uxLength += ( size_t ) iResult;
+
+        if( uxLength > uxMaxText )
+        {
+            /* Truncated, but the line break is still added. */
+            uxLength = uxMaxText;
+        }
+    }
+
+    memcpy( &( cLine[ uxLength ] ), dlLINE_BREAK, dlLINE_BREAK_LENGTH + 1U );
+    uxLength += dlLINE_BREAK_LENGTH;
+
+    if( ( xLoggingTask == NULL ) || ( xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ) )
+    {
+        /* Nothing will empty the ring buffer yet. */
+        dlDEFERRED_OUTPUT( cLine );
+    }
+    else if( prvRingWrite( cLine, ( uint16_t ) uxLength ) != pdFALSE )
+    {
+        xTaskNotifyGive( xLoggingTask );
+    }
+    else
+    {
+        ulDroppedLines++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulLoggingDeferredDropped( void )
+{
+    return ulDroppedLines;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRingWrite( const char * pcLine,
+                                uint16_t usLength )
+{
+    BaseType_t xReturn = pdFALSE;
+    const uint8_t * pucSource;
+    size_t uxCount, uxFirst;
+
+    taskENTER_CRITICAL();
+    {
+        if( ( dlDEFERRED_BUFFER_SIZE - uxRingUsed ) >= ( sizeof( usLength ) + usLength ) )
+        {
+            /* The length, then the characters, each possibly wrapping. */
+            pucSource = ( const uint8_t * ) &usLength;
+            uxCount = sizeof( usLength );
+
+            for( ; ; )
+            {
+                uxFirst = dlDEFERRED_BUFFER_SIZE - uxRingHead;
+
+                if( uxFirst > uxCount )
+                {
+                    uxFirst = uxCount;
+                }
+
+                memcpy( &( ucRing[ uxRingHead ] ), pucSource, uxFirst );
+                memcpy( ucRing, &( pucSource[ uxFirst ] ), uxCount - uxFirst );
+                uxRingHead = ( uxRingHead + uxCount ) % dlDEFERRED_BUFFER_SIZE;
+                uxRingUsed += uxCount;
+
+                if( pucSource == ( const uint8_t * ) pcLine )
+                {
+                    break;
+                }
+
+                pucSource = ( const uint8_t * ) pcLine;
+                uxCount = usLength;
+            }
+
+            xReturn = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvRingRead( char * pcLine )
+{
+    uint16_t usLength = 0U;
+    uint8_t * pucTarget;
+    size_t uxCount, uxFirst;
+
+    taskENTER_CRITICAL();
+    {
+        if( uxRingUsed != 0U )
+        {
+            pucTarget = ( uint8_t * ) &usLength;
+            uxCount = sizeof( usLength );
+
+            for( ; ; )
+            {
+                uxFirst = dlDEFERRED_BUFFER_SIZE - uxRingTail;
+
+                if( uxFirst > uxCount )
+                {
+                    uxFirst = uxCount;
+                }
+
+                memcpy( pucTarget, &( ucRing[ uxRingTail ] ), uxFirst );
+                memcpy( &( pucTarget[ uxFirst ] ), ucRing, uxCount - uxFirst );
+                uxRingTail = ( uxRingTail + uxCount ) % dlDEFERRED_BUFFER_SIZE;
+                uxRingUsed -= uxCount;
+
+                if( pucTarget == ( uint8_t * ) pcLine )
+                {
+                    break;
+                }
+
+                /* Lines were formatted into dlDEFERRED_MAX_LINE_LENGTH byte
+                 * buffers, so the text and its terminator always fit. */
+                pucTarget = ( uint8_t * ) pcLine;
+                uxCount = usLength;
+            }
+
+            pcLine[ usLength ] = '\0';
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return usLength;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingTask( void * pvParameters )
+{
+    char cLine[ dlDEFERRED_MAX_LINE_LENGTH ];
+    uint32_t ulReported = 0U;
+    uint32_t ulDropped;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        /* Wait until at least one line has been written. */
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        while( prvRingRead( cLine ) != 0U )
+        {
+            dlDEFERRED_OUTPUT( cLine );
+        }
+
+        ulDropped = ulDroppedLines;
+
+        if( ulDropped != ulReported )
+        {
+            ( void ) snprintf( cLine, sizeof( cLine ), "[WARN] [Logging] %lu log lines dropped\r\n",
+                               ( unsigned long ) ( ulDropped - ulReported ) );
+            dlDEFERRED_OUTPUT( cLine );
+            ulReported = ulDropped;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,101 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef LOGGING_DEFERRED_H
+#define LOGGING_DEFERRED_H
+
+/*
+ * Deferred logging backend.  Include this header before logging_stack.h (for
+ * example from the library configuration headers) to have every LogXxx() call
+ * format its line into RAM in the caller's context and hand it, as a single
+ * record, to a low priority task that performs the slow output.  Tasks that log
+ * then only pay for the formatting and a short copy, not for the UART, console
+ * or network time of the output itself.
+ *
+ * Records are copied into a ring buffer inside a short critical section.  When
+ * the ring buffer is full the line is dropped and counted, the caller never
+ * blocks.  Log lines must not be produced from interrupts.
+ */
+
+#include "FreeRTOS.h"
+
+/* The length of the ring buffer that holds lines waiting to be output. */
+#ifndef dlDEFERRED_BUFFER_SIZE
+    #define dlDEFERRED_BUFFER_SIZE    4096
+#endif
+
+/* The longest line, including the metadata prefix and the line break, that is
+ * kept.  Longer lines are truncated.  A buffer of this size is placed on the
+ * stack of the task that logs. */
+#ifndef dlDEFERRED_MAX_LINE_LENGTH
+    #define dlDEFERRED_MAX_LINE_LENGTH    160
+#endif
+
+/* The stack size of the task that outputs the lines. */
+#ifndef dlDEFERRED_TASK_STACK_SIZE
+    #define dlDEFERRED_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+/* How a complete, NUL terminated, line is output by the logging task.  Lines
+ * already end with "\r\n". */
+#ifndef dlDEFERRED_OUTPUT
+    #define dlDEFERRED_OUTPUT( pcLine )    vLoggingPrintf( "%s", ( pcLine ) )
+#endif
+
+/* Removes the parentheses around the message passed to the logging macros. */
+#define dlDEFERRED_UNPAREN( ... )    __VA_ARGS__
+
+/* Emit each log line as a single record. */
+#define SdkLogLine( pcLevel, message ) \
+    vLoggingDeferredLine( pcLevel, LIBRARY_LOG_NAME, __FUNCTION__, __LINE__, dlDEFERRED_UNPAREN message )
+
+/*
+ * Create the task that outputs the logged lines, at priority uxPriority.  Lines
+ * logged before this is called, or before the scheduler is started, are output
+ * directly.
+ */
+BaseType_t xLoggingDeferredInit( UBaseType_t uxPriority );
+
+/*
+ * Format one log line, in the same format as the default logging macros, and
+ * queue it for output.  Called through SdkLogLine().
+ */
+void vLoggingDeferredLine( const char * pcLevel,
+                           const char * pcLibrary,
+                           const char * pcFunction,
+                           int iLine,
+                           const char * pcFormat,
+                           ... );
+
+/*
+ * Returns the number of lines dropped because the ring buffer was full.
+ */
+uint32_t ulLoggingDeferredDropped( void );
+
+void vLoggingPrintf( const char * pcFormat,
+                     ... );
+
+#endif /* LOGGING_DEFERRED_H */
@@ -0,0 +1,428 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Logging utility for the Posix port that allows FreeRTOS tasks to log to
+ * stdout and a disk file without blocking on the host's I/O.
+ *
+ * This is the Posix counterpart of Logging_WinSim.c.  Tasks format their
+ * message and copy it into a byte ring buffer inside a FreeRTOS critical
+ * section.  A host pthread, which is not a FreeRTOS task, drains the ring and
+ * writes it out in large chunks.  If the ring is full the message is dropped
+ * and counted rather than the task waiting, and the count is reported in the
+ * log once there is space again.
+ *
+ * Host locks are never taken by tasks - a task holding a pthread mutex can be
+ * suspended by the scheduler while the writer thread waits on it.  The only
+ * host call a task makes is sem_post(), which does not block.
+ *
+ * UDP logging is not implemented, the xLogToUDP parameter of vLoggingInit() is
+ * ignored.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "logging.h"
+
+/*-----------------------------------------------------------*/
+
+/* The maximum size of a single formatted message. */
+#define dlMAX_PRINT_STRING_LENGTH    255
+
+/* Size of the ring buffer used to pass messages from FreeRTOS tasks to the
+ * writer thread.  Must be a power of two. */
+#define dlLOGGING_RING_SIZE          32768
+
+/* The writer thread collects at most this many bytes per write() call. */
+#define dlFLUSH_CHUNK_SIZE           8192
+
+/* The writer thread wakes at least this often even if it is not signalled,
+ * so a missed wake up can only delay output, never lose it. */
+#define dlWRITER_PERIOD_NS           100000000L
+
+/* The disk file is closed and renamed once it reaches this size. */
+#define dlLOGGING_FILE_SIZE          ( 40ul * 1024ul * 1024ul )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The pthread that drains the ring buffer to stdout and the disk file.
+ */
+static void * prvLoggingWriterThread( void * pvParameter );
+
+/*
+ * Copy everything in the ring buffer to stdout and/or the disk file.
+ */
+static void prvLoggingFlushBuffer( void );
+
+/*
+ * Write a chunk of messages to stdout and/or the disk file.
+ */
+static void prvLoggingWriteChunk( const char * pcChunk,
+                                  size_t xLength );
+
+/*
+ * Append one message to the ring buffer, returning pdFALSE if it did not fit.
+ */
+static BaseType_t prvRingAdd( const char * pcMessage,
+                              size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+/* Is stdout output, or disk file output, being used? */
+static BaseType_t xStdoutLoggingUsed = pdFALSE;
+static BaseType_t xDiskFileLoggingUsed = pdFALSE;
+
+/* Set once the writer thread is running.  Until then messages are written
+ * directly by the caller, which is safe while the scheduler is not running. */
+static BaseType_t xWriterRunning = pdFALSE;
+
+/* The ring buffer.  xRingHead is only written by tasks, inside a critical
+ * section, and xRingTail is only written by the writer thread.  Both are free
+ * running and are masked when used as an index. */
+static uint8_t ucRing[ dlLOGGING_RING_SIZE ];
+static size_t xRingHead = 0;
+static size_t xRingTail = 0;
+
+/* Messages dropped because the ring buffer was full. */
+static volatile uint32_t ulDroppedMessages = 0ul;
+
+/* Posted by tasks to wake the writer thread. */
+static sem_t xWriterSemaphore;
+static pthread_t xWriterThread;
+
+/* Names of the log files. */
+static const char * pcLogFileName = "RTOSDemo.log";
+static const char * pcFullLogFileName = "RTOSDemo.ful";
+static FILE * pxLoggingFileHandle = NULL;
+static size_t ulSizeOfLoggingFile = 0ul;
+
+/*-----------------------------------------------------------*/
+
+void vLoggingInit( BaseType_t xLogToStdout,
+                   BaseType_t xLogToFile,
+                   BaseType_t xLogToUDP,
+                   uint32_t ulRemoteIPAddress,
+                   uint16_t usRemotePort )
+{
+    sigset_t xAllSignals, xOriginalMask;
+
+    /* Can only be called before the scheduler has started. */
+    configASSERT( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED );
+
+    /* UDP logging is not supported by this implementation. */
+    ( void ) xLogToUDP;
+    ( void ) ulRemoteIPAddress;
+    ( void ) usRemotePort;
+
+    xStdoutLoggingUsed = xLogToStdout;
+    xDiskFileLoggingUsed = xLogToFile;
+
+    if( ( ( xStdoutLoggingUsed != pdFALSE ) || ( xDiskFileLoggingUsed != pdFALSE ) ) &&
+        ( xWriterRunning == pdFALSE ) )
+    {
+        if( sem_init( &xWriterSemaphore, 0, 0 ) == 0 )
+        {
+            /* The Posix port drives the scheduler with signals, which must
+             * never be delivered to a thread that is not a FreeRTOS task.  The
+             * writer thread inherits the mask in force when it is created. */
+            sigfillset( &xAllSignals );
+            pthread_sigmask( SIG_SETMASK, &xAllSignals, &xOriginalMask );
+
+            if( pthread_create( &xWriterThread, NULL, prvLoggingWriterThread, NULL ) == 0 )
+            {
+                xWriterRunning = pdTRUE;
+            }
+
+            pthread_sigmask( SIG_SETMASK, &xOriginalMask, NULL );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintf( const char * pcFormat,
+                     ... )
+{
+    char cPrintString[ dlMAX_PRINT_STRING_LENGTH ];
+    size_t xLength = 0;
+    int iReturned;
+    static uint32_t ulMessageNumber = 0;
+    static BaseType_t xAfterLineBreak = pdTRUE;
+    const char * pcTaskName = "None";
+    va_list args;
+
+    if( ( xStdoutLoggingUsed == pdFALSE ) && ( xDiskFileLoggingUsed == pdFALSE ) )
+    {
+        return;
+    }
+
+    if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+    {
+        pcTaskName = pcTaskGetName( NULL );
+    }
+
+    /* Add the message number, tick count and task name if this is the start of
+     * a new line. */
+    if( xAfterLineBreak != pdFALSE )
+    {
+        iReturned = snprintf( cPrintString, sizeof( cPrintString ), "%lu %lu [%s] ",
+                              ( unsigned long ) ulMessageNumber++,
+                              ( unsigned long ) xTaskGetTickCount(),
+                              pcTaskName );
+
+        if( iReturned > 0 )
+        {
+            xLength = ( ( size_t ) iReturned < sizeof( cPrintString ) ) ? ( size_t ) iReturned : sizeof( cPrintString ) - 1;
+        }
+    }
+
+    va_start( args, pcFormat );
+    iReturned = vsnprintf( &( cPrintString[ xLength ] ), sizeof( cPrintString ) - xLength, pcFormat, args );
+    va_end( args );
+
+    if( iReturned > 0 )
+    {
+        xLength += ( ( size_t ) iReturned < ( sizeof( cPrintString ) - xLength ) ) ? ( size_t ) iReturned : ( sizeof( cPrintString ) - xLength - 1 );
+    }
+
+    xAfterLineBreak = ( ( xLength > 0 ) && ( cPrintString[ xLength - 1 ] == '\n' ) ) ? pdTRUE : pdFALSE;
+
+    if( ( xWriterRunning == pdFALSE ) || ( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED ) )
+    {
+        /* No task can be interrupted part way through a host call yet, so it
+         * is safe to write directly.  The ring is only used once tasks run. */
+        prvLoggingWriteChunk( cPrintString, xLength );
+    }
+    else if( prvRingAdd( cPrintString, xLength ) != pdFALSE )
+    {
+        sem_post( &xWriterSemaphore );
+    }
+    else
+    {
+        /* Never wait for the writer thread, just count the loss.  It is
+         * reported once the writer catches up. */
+        ulDroppedMessages++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vPlatformInitLogging( void )
+{
+    vLoggingInit( pdTRUE, pdFALSE, pdFALSE, 0U, 0U );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRingAdd( const char * pcMessage,
+                              size_t xLength )
+{
+    BaseType_t xReturn = pdFALSE;
+    size_t xHead, xTail, xIndex, xFirst;
+
+    taskENTER_CRITICAL();
+    {
+        xHead = xRingHead;
+        xTail = __atomic_load_n( &xRingTail, __ATOMIC_ACQUIRE );
+
+        if( ( dlLOGGING_RING_SIZE - ( xHead - xTail ) ) >= xLength )
+        {
+            xIndex = xHead & ( dlLOGGING_RING_SIZE - 1 );
+            xFirst = dlLOGGING_RING_SIZE - xIndex;
+
+            if( xFirst > xLength )
+            {
+                xFirst = xLength;
+            }
+
+            memcpy( &( ucRing[ xIndex ] ), pcMessage, xFirst );
+            memcpy( ucRing, &( pcMessage[ xFirst ] ), xLength - xFirst );
+
+            /* Publish the data only after it has been copied. */
+            __atomic_store_n( &xRingHead, xHead + xLength, __ATOMIC_RELEASE );
+            xReturn = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void * prvLoggingWriterThread( void * pvParameter )
+{
+    struct timespec xWakeTime;
+
+    ( void ) pvParameter;
+
+    for( ; ; )
+    {
+        clock_gettime( CLOCK_REALTIME, &xWakeTime );
+        xWakeTime.tv_nsec += dlWRITER_PERIOD_NS;
+
+        if( xWakeTime.tv_nsec >= 1000000000L )
+        {
+            xWakeTime.tv_sec++;
+            xWakeTime.tv_nsec -= 1000000000L;
+        }
+
+        /* Wait to be signalled, then absorb any other posts so a burst of
+         * messages results in one flush. */
+        ( void ) sem_timedwait( &xWriterSemaphore, &xWakeTime );
+
+        while( sem_trywait( &xWriterSemaphore ) == 0 )
+        {
+        }
+
+        prvLoggingFlushBuffer();
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingFlushBuffer( void )
+{
+    static char cChunk[ dlFLUSH_CHUNK_SIZE ];
+    static uint32_t ulReportedDrops = 0ul;
+    size_t xHead, xTail, xLength, xIndex, xFirst;
+    uint32_t ulDrops;
+
+    xTail = xRingTail;
+    xHead = __atomic_load_n( &xRingHead, __ATOMIC_ACQUIRE );
+
+    while( xHead != xTail )
+    {
+        xLength = xHead - xTail;
+
+        if( xLength > sizeof( cChunk ) )
+        {
+            xLength = sizeof( cChunk );
+        }
+
+        xIndex = xTail & ( dlLOGGING_RING_SIZE - 1 );
+        xFirst = dlLOGGING_RING_SIZE - xIndex;
+
+        if( xFirst > xLength )
+        {
+            xFirst = xLength;
+        }
+
+        memcpy( cChunk, &( ucRing[ xIndex ] ), xFirst );
+        memcpy( &( cChunk[ xFirst ] ), ucRing, xLength - xFirst );
+
+        /* Return the space to the tasks before doing the slow part. */
+        xTail += xLength;
+        __atomic_store_n( &xRingTail, xTail, __ATOMIC_RELEASE );
+
+        prvLoggingWriteChunk( cChunk, xLength );
+        xHead = __atomic_load_n( &xRingHead, __ATOMIC_ACQUIRE );
+    }
+
+    ulDrops = ulDroppedMessages;
+
+    if( ulDrops != ulReportedDrops )
+    {
+        xLength = ( size_t ) snprintf( cChunk, sizeof( cChunk ),
+                                       "[Logging] %lu messages dropped, the log ring buffer was full\n",
+                                       ( unsigned long ) ( ulDrops - ulReportedDrops ) );
+        ulReportedDrops = ulDrops;
+        prvLoggingWriteChunk( cChunk, xLength );
+    }
+
+    if( pxLoggingFileHandle != NULL )
+    {
+        fflush( pxLoggingFileHandle );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingWriteChunk( const char * pcChunk,
+                                  size_t xLength )
+{
+    ssize_t xWritten;
+    size_t xOffset = 0;
+
+    if( xStdoutLoggingUsed != pdFALSE )
+    {
+        while( xOffset < xLength )
+        {
+            xWritten = write( STDOUT_FILENO, &( pcChunk[ xOffset ] ), xLength - xOffset );
+
+            if( xWritten > 0 )
+            {
+                xOffset += ( size_t ) xWritten;
+            }
+            else if( ( xWritten < 0 ) && ( errno == EINTR ) )
+            {
+                continue;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+
+    if( ( xDiskFileLoggingUsed != pdFALSE ) && ( xLength > 0 ) )
+    {
+        if( pxLoggingFileHandle == NULL )
+        {
+            pxLoggingFileHandle = fopen( pcLogFileName, "a" );
+        }
+
+        if( pxLoggingFileHandle != NULL )
+        {
+            fwrite( pcChunk, 1, xLength, pxLoggingFileHandle );
+            ulSizeOfLoggingFile += xLength;
+
+            /* If the file has grown to its maximum permissible size then close
+             * and rename it - then start with a new file. */
+            if( ulSizeOfLoggingFile > ( size_t ) dlLOGGING_FILE_SIZE )
+            {
+                fclose( pxLoggingFileHandle );
+                pxLoggingFileHandle = NULL;
+                ( void ) remove( pcFullLogFileName );
+                ( void ) rename( pcLogFileName, pcFullLogFileName );
+                ulSizeOfLoggingFile = 0;
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
@@ -70,6 +70,11 @@
 /* A block time of zero simply means don't block. */
 #define dlDONT_BLOCK                    0
 
+/* Messages are collected into chunks of up to this size before being written
+ * to stdout and the disk file, so the Win32 thread makes one system call per
+ * chunk rather than per message. */
+#define dlFLUSH_CHUNK_SIZE              8192
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -97,6 +102,12 @@ static void prvFileClose( void );
  */
 static void prvLoggingFlushBuffer( void );
 
+/*
+ * Write a chunk of collected messages to stdout and/or the disk file.
+ */
+static void prvLoggingWriteChunk( const char * pcChunk,
+                                  size_t xLength );
+
 /*
  * The windows thread that performs the actual writing of messages that require
  * Win32 system calls.  Only the windows thread can make system calls so as not
@@ -144,6 +155,10 @@ static const char * pcFullLogFileName = "RTOSDemo.ful";
 /* As an optimization, the current file size is kept in a variable. */
 static size_t ulSizeOfLoggingFile = 0ul;
 
+/* Messages that were not logged to stdout or the disk file because the stream
+ * buffer was full. */
+static volatile uint32_t ulDroppedMessages = 0ul;
+
 /* The UDP socket and address on/to which print messages are sent. */
 Socket_t xPrintSocket = FREERTOS_INVALID_SOCKET;
 struct freertos_sockaddr xPrintUDPAddress;
@@ -414,6 +429,12 @@ void vLoggingPrintf( const char * pcFormat,
                 uxStreamBufferAdd( xLogStreamBuffer, 0, ( const uint8_t * ) cOutputString, xLength );
                 SetThreadPriority( GetCurrentThread(), iOriginalPriority );
             }
+            else
+            {
+                /* Never wait for the Win32 thread, just count the loss.  It
+                 * is reported once the thread catches up. */
+                ulDroppedMessages++;
+            }
 
             /* xDirectPrint is initialized to pdTRUE, and while it remains true the
              * logging output function is called directly.  When the system is running
@@ -439,34 +460,63 @@ void vLoggingPrintf( const char * pcFormat,
 
 static void prvLoggingFlushBuffer( void )
 {
-    size_t xLength;
-    char cPrintString[ dlMAX_PRINT_STRING_LENGTH ];
+    size_t xLength, xChunkLength = 0;
+    static char cChunk[ dlFLUSH_CHUNK_SIZE ];
+    static uint32_t ulReportedDrops = 0ul;
+    uint32_t ulDrops;
 
     /* Is there more than the length value stored in the circular buffer
      * used to pass data from the FreeRTOS simulator into this Win32 thread? */
     while( uxStreamBufferGetSize( xLogStreamBuffer ) > sizeof( xLength ) )
     {
-        memset( cPrintString, 0x00, dlMAX_PRINT_STRING_LENGTH );
         uxStreamBufferGet( xLogStreamBuffer, 0, ( uint8_t * ) &xLength, sizeof( xLength ), pdFALSE );
-        uxStreamBufferGet( xLogStreamBuffer, 0, ( uint8_t * ) cPrintString, xLength, pdFALSE );
 
-        /* Write the message to standard out if requested to do so when
+        /* Messages are never longer than dlMAX_PRINT_STRING_LENGTH, so one
+         * always fits once the chunk has been written out. */
+        if( ( xChunkLength + xLength ) > sizeof( cChunk ) )
+        {
+            prvLoggingWriteChunk( cChunk, xChunkLength );
+            xChunkLength = 0;
+        }
+
+        uxStreamBufferGet( xLogStreamBuffer, 0, ( uint8_t * ) &( cChunk[ xChunkLength ] ), xLength, pdFALSE );
+        xChunkLength += xLength;
+    }
+
+    ulDrops = ulDroppedMessages;
+
+    if( ( ulDrops != ulReportedDrops ) && ( ( xChunkLength + dlMAX_PRINT_STRING_LENGTH ) <= sizeof( cChunk ) ) )
+    {
+        xChunkLength += snprintf( &( cChunk[ xChunkLength ] ), dlMAX_PRINT_STRING_LENGTH,
+                                  "[Logging] %lu messages dropped, the log stream buffer was full\r\n",
+                                  ( unsigned long ) ( ulDrops - ulReportedDrops ) );
+        ulReportedDrops = ulDrops;
+    }
+
+    prvLoggingWriteChunk( cChunk, xChunkLength );
+    prvFileClose();
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingWriteChunk( const char * pcChunk,
+                                  size_t xLength )
+{
+    if( xLength > 0 )
+    {
+        /* Write the messages to standard out if requested to do so when
          * vLoggingInit() was called, or if the network is not yet up. */
         if( ( xStdoutLoggingUsed != pdFALSE ) || ( FreeRTOS_IsNetworkUp() == pdFALSE ) )
         {
-            /* Write the message to stdout. */
-            _write( _fileno( stdout ), cPrintString, strlen( cPrintString ) );
+            _write( _fileno( stdout ), pcChunk, ( unsigned int ) xLength );
         }
 
-        /* Write the message to a file if requested to do so when
+        /* Write the messages to a file if requested to do so when
          * vLoggingInit() was called. */
         if( xDiskFileLoggingUsed != pdFALSE )
         {
-            prvLogToFile( cPrintString, xLength );
+            prvLogToFile( pcChunk, xLength );
         }
     }
-
-    prvFileClose();
 }
 /*-----------------------------------------------------------*/
 
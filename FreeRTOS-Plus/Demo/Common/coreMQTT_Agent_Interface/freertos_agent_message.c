@@ -35,26 +35,370 @@
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
 
 /* Header include. */
 #include "freertos_agent_message.h"
 #include "core_mqtt_agent_message_interface.h"
+#include "freertos_command_pool.h"
 
 /*-----------------------------------------------------------*/
 
-bool Agent_MessageSend( const MQTTAgentMessageContext_t * pMsgCtx,
-                        MQTTAgentCommand_t * const * pCommandToSend,
-                        uint32_t blockTimeMs )
+/**
+ * @brief Create the queue or stream buffer that carries bulk commands.
+ *
+ * @param[out] pMsgCtx The context to create the lane in.
+ * @param[in] queueLength Maximum number of commands in the lane.
+ *
+ * @return `true` if the lane was created, else `false`.
+ */
+static bool prvCreateBulkLane( MQTTAgentMessageContext_t * pMsgCtx,
+                               size_t queueLength );
+
+/**
+ * @brief Send commands into the bulk lane.
+ *
+ * @param[in] pMsgCtx The context to send to.
+ * @param[in] pCommandsToSend Array of commands to send, in order.
+ * @param[in] commandCount Number of entries in @p pCommandsToSend.
+ * @param[in,out] pTimeOut Time at which the caller started waiting.
+ * @param[in,out] pTicksToWait Ticks the caller may still wait, updated on return.
+ *
+ * @return The number of commands sent.
+ */
+static size_t prvSendBulk( const MQTTAgentMessageContext_t * pMsgCtx,
+                           MQTTAgentCommand_t * const * pCommandsToSend,
+                           size_t commandCount,
+                           TimeOut_t * pTimeOut,
+                           TickType_t * pTicksToWait );
+
+/**
+ * @brief Receive the next command from the bulk lane.
+ *
+ * @param[in] pMsgCtx The context to receive from.
+ * @param[out] pReceivedCommand Where to write the command.
+ * @param[in] ticksToWait Ticks to wait for a command to arrive.
+ *
+ * @return `true` if a command was received, else `false`.
+ */
+static bool prvReceiveBulk( const MQTTAgentMessageContext_t * pMsgCtx,
+                            MQTTAgentCommand_t ** pReceivedCommand,
+                            TickType_t ticksToWait );
+
+/**
+ * @brief Check whether the bulk lane holds any commands.
+ *
+ * @param[in] pMsgCtx The context to check.
+ *
+ * @return `true` if a command is waiting, else `false`.
+ */
+static bool prvBulkPending( const MQTTAgentMessageContext_t * pMsgCtx );
+
+#if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 )
+
+/**
+ * @brief Decide which lane a command travels in.  Everything except PUBLISH
+ * is control traffic: it is rare, and a subscription, ping or disconnect
+ * should not wait behind a backlog of telemetry.
+ *
+ * @param[in] pCommand The command to classify.
+ *
+ * @return `true` for the control lane, `false` for the bulk lane.
+ */
+    static bool prvIsControlCommand( const MQTTAgentCommand_t * pCommand );
+#endif
+
+/*-----------------------------------------------------------*/
+
+#if ( MQTT_AGENT_MESSAGE_BATCH_LENGTH > 0 )
+
+static bool prvCreateBulkLane( MQTTAgentMessageContext_t * pMsgCtx,
+                               size_t queueLength )
 {
-    BaseType_t queueStatus = pdFAIL;
+    bool created = false;
 
-    if( ( pMsgCtx != NULL ) && ( pCommandToSend != NULL ) )
+    /* The trigger level of one pointer wakes the agent as soon as any
+     * command is written. */
+    pMsgCtx->streamBuffer = xStreamBufferCreate( queueLength * sizeof( MQTTAgentCommand_t * ),
+                                                 sizeof( MQTTAgentCommand_t * ) );
+    pMsgCtx->sendMutex = xSemaphoreCreateMutex();
+    pMsgCtx->pBatch = ( AgentMessageBatch_t * ) pvPortMalloc( sizeof( AgentMessageBatch_t ) );
+
+    if( ( pMsgCtx->streamBuffer != NULL ) && ( pMsgCtx->sendMutex != NULL ) && ( pMsgCtx->pBatch != NULL ) )
     {
-        queueStatus = xQueueSendToBack( pMsgCtx->queue, pCommandToSend, pdMS_TO_TICKS( blockTimeMs ) );
+        pMsgCtx->pBatch->count = 0U;
+        pMsgCtx->pBatch->next = 0U;
+        created = true;
     }
 
-    return ( queueStatus == pdPASS ) ? true : false;
+    return created;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvSendBulk( const MQTTAgentMessageContext_t * pMsgCtx,
+                           MQTTAgentCommand_t * const * pCommandsToSend,
+                           size_t commandCount,
+                           TimeOut_t * pTimeOut,
+                           TickType_t * pTicksToWait )
+{
+    size_t sentCount = 0U;
+    size_t spaceCount;
+    size_t writeCount;
+    bool timedOut = false;
+
+    if( xSemaphoreTake( pMsgCtx->sendMutex, *pTicksToWait ) == pdPASS )
+    {
+        /* The mutex makes this task the only writer, so space can only grow
+         * while it is held and whole pointers are always written together. */
+        while( ( sentCount < commandCount ) && ( timedOut == false ) )
+        {
+            spaceCount = xStreamBufferSpacesAvailable( pMsgCtx->streamBuffer ) / sizeof( MQTTAgentCommand_t * );
+            writeCount = commandCount - sentCount;
+
+            if( spaceCount > 0U )
+            {
+                if( writeCount > spaceCount )
+                {
+                    writeCount = spaceCount;
+                }
+
+                ( void ) xStreamBufferSend( pMsgCtx->streamBuffer,
+                                            &( pCommandsToSend[ sentCount ] ),
+                                            writeCount * sizeof( MQTTAgentCommand_t * ),
+                                            0U );
+                sentCount += writeCount;
+            }
+            else if( xTaskCheckForTimeOut( pTimeOut, pTicksToWait ) == pdFALSE )
+            {
+                /* Full.  Block until one pointer fits, the stream buffer does
+                 * not write anything before the whole length has space. */
+                if( xStreamBufferSend( pMsgCtx->streamBuffer,
+                                       &( pCommandsToSend[ sentCount ] ),
+                                       sizeof( MQTTAgentCommand_t * ),
+                                       *pTicksToWait ) == sizeof( MQTTAgentCommand_t * ) )
+                {
+                    sentCount++;
+                }
+            }
+            else
+            {
+                timedOut = true;
+            }
+        }
+
+        ( void ) xSemaphoreGive( pMsgCtx->sendMutex );
+    }
+
+    return sentCount;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvReceiveBulk( const MQTTAgentMessageContext_t * pMsgCtx,
+                            MQTTAgentCommand_t ** pReceivedCommand,
+                            TickType_t ticksToWait )
+{
+    AgentMessageBatch_t * pBatch = pMsgCtx->pBatch;
+    bool received = false;
+
+    if( pBatch->next == pBatch->count )
+    {
+        /* Everything read last time has been handed out, so drain as
+         * many pending commands as fit in one read. */
+        pBatch->count = xStreamBufferReceive( pMsgCtx->streamBuffer,
+                                              pBatch->commands,
+                                              sizeof( pBatch->commands ),
+                                              ticksToWait ) / sizeof( MQTTAgentCommand_t * );
+        pBatch->next = 0U;
+    }
+
+    if( pBatch->next < pBatch->count )
+    {
+        *pReceivedCommand = pBatch->commands[ pBatch->next ];
+        pBatch->next++;
+        received = true;
+    }
+
+    return received;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvBulkPending( const MQTTAgentMessageContext_t * pMsgCtx )
+{
+    return ( ( pMsgCtx->pBatch->next < pMsgCtx->pBatch->count ) ||
+             ( xStreamBufferIsEmpty( pMsgCtx->streamBuffer ) == pdFALSE ) ) ? true : false;
+}
+
+#else /* if ( MQTT_AGENT_MESSAGE_BATCH_LENGTH > 0 ) */
+
+static bool prvCreateBulkLane( MQTTAgentMessageContext_t * pMsgCtx,
+                               size_t queueLength )
+{
+    pMsgCtx->queue = xQueueCreate( queueLength, sizeof( MQTTAgentCommand_t * ) );
+
+    return ( pMsgCtx->queue != NULL ) ? true : false;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvSendBulk( const MQTTAgentMessageContext_t * pMsgCtx,
+                           MQTTAgentCommand_t * const * pCommandsToSend,
+                           size_t commandCount,
+                           TimeOut_t * pTimeOut,
+                           TickType_t * pTicksToWait )
+{
+    size_t sentCount = 0U;
+
+    /* A queue copies one item per call, so the commands go one by one
+     * under a single timeout. */
+    while( ( sentCount < commandCount ) &&
+           ( xQueueSendToBack( pMsgCtx->queue, &( pCommandsToSend[ sentCount ] ), *pTicksToWait ) == pdPASS ) )
+    {
+        sentCount++;
+        ( void ) xTaskCheckForTimeOut( pTimeOut, pTicksToWait );
+    }
+
+    return sentCount;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvReceiveBulk( const MQTTAgentMessageContext_t * pMsgCtx,
+                            MQTTAgentCommand_t ** pReceivedCommand,
+                            TickType_t ticksToWait )
+{
+    return ( xQueueReceive( pMsgCtx->queue, pReceivedCommand, ticksToWait ) == pdPASS ) ? true : false;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvBulkPending( const MQTTAgentMessageContext_t * pMsgCtx )
+{
+    return ( uxQueueMessagesWaiting( pMsgCtx->queue ) != 0U ) ? true : false;
+}
+
+#endif /* if ( MQTT_AGENT_MESSAGE_BATCH_LENGTH > 0 ) */
+/*-----------------------------------------------------------*/
+
+#if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 )
+
+    static bool prvIsControlCommand( const MQTTAgentCommand_t * pCommand )
+    {
+        return ( pCommand->commandType != PUBLISH ) ? true : false;
+    }
+
+#endif
+/*-----------------------------------------------------------*/
+
+bool Agent_InitializeMessageContext( MQTTAgentMessageContext_t * pMsgCtx,
+                                     size_t queueLength )
+{
+    bool initialized = false;
+
+    if( ( pMsgCtx != NULL ) && ( queueLength > 0U ) )
+    {
+        initialized = prvCreateBulkLane( pMsgCtx, queueLength );
+
+        #if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 )
+            if( initialized == true )
+            {
+                pMsgCtx->controlQueue = xQueueCreate( MQTT_AGENT_CONTROL_QUEUE_LENGTH,
+                                                      sizeof( MQTTAgentCommand_t * ) );
+                pMsgCtx->pendingCount = xSemaphoreCreateCounting( queueLength + MQTT_AGENT_CONTROL_QUEUE_LENGTH, 0U );
+                initialized = ( ( pMsgCtx->controlQueue != NULL ) && ( pMsgCtx->pendingCount != NULL ) ) ? true : false;
+            }
+        #endif
+    }
+
+    return initialized;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t Agent_MessageSendBatch( const MQTTAgentMessageContext_t * pMsgCtx,
+                               MQTTAgentCommand_t * const * pCommandsToSend,
+                               size_t commandCount,
+                               uint32_t blockTimeMs )
+{
+    size_t sentCount = 0U;
+    TimeOut_t timeOut;
+    TickType_t ticksToWait = pdMS_TO_TICKS( blockTimeMs );
+
+    #if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 )
+        size_t commandIndex;
+    #endif
+
+    #if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 )
+        size_t runLength = 0U;
+        size_t runSent = 0U;
+        size_t i;
+    #endif
+
+    vTaskSetTimeOutState( &timeOut );
+
+    if( ( pMsgCtx != NULL ) && ( pCommandsToSend != NULL ) )
+    {
+        #if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 )
+            /* Before sending, as the agent may complete a command, and its
+             * caller reuse the publish information, before this returns.  A
+             * command that is not sent is released by the caller, which also
+             * returns its payload. */
+            for( commandIndex = 0U; commandIndex < commandCount; commandIndex++ )
+            {
+                Agent_RecordCommandPayload( pCommandsToSend[ commandIndex ] );
+            }
+        #endif
+
+        #if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 )
+            while( ( sentCount < commandCount ) && ( runSent == runLength ) )
+            {
+                runLength = 1U;
+
+                if( prvIsControlCommand( pCommandsToSend[ sentCount ] ) == true )
+                {
+                    runSent = ( xQueueSendToBack( pMsgCtx->controlQueue, &( pCommandsToSend[ sentCount ] ), ticksToWait ) == pdPASS ) ? 1U : 0U;
+                    ( void ) xTaskCheckForTimeOut( &timeOut, &ticksToWait );
+                }
+                else
+                {
+                    /* Send the bulk commands up to the next control command
+                     * together. */
+                    while( ( ( sentCount + runLength ) < commandCount ) &&
+                           ( prvIsControlCommand( pCommandsToSend[ sentCount + runLength ] ) == false ) )
+                    {
+                        runLength++;
+                    }
+
+                    runSent = prvSendBulk( pMsgCtx, &( pCommandsToSend[ sentCount ] ), runLength, &timeOut, &ticksToWait );
+                }
+
+                /* Count the commands only once they are in a lane, so a
+                 * receiver that takes a count always finds a command. */
+                for( i = 0U; i < runSent; i++ )
+                {
+                    ( void ) xSemaphoreGive( pMsgCtx->pendingCount );
+                }
+
+                sentCount += runSent;
+            }
+        #else /* if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 ) */
+            sentCount = prvSendBulk( pMsgCtx, pCommandsToSend, commandCount, &timeOut, &ticksToWait );
+        #endif /* if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 ) */
+    }
+
+    return sentCount;
+}
+
+/*-----------------------------------------------------------*/
+
+bool Agent_MessageSend( const MQTTAgentMessageContext_t * pMsgCtx,
+                        MQTTAgentCommand_t * const * pCommandToSend,
+                        uint32_t blockTimeMs )
+{
+    return ( Agent_MessageSendBatch( pMsgCtx, pCommandToSend, 1U, blockTimeMs ) == 1U ) ? true : false;
 }
 
 /*-----------------------------------------------------------*/
@@ -63,12 +407,42 @@ bool Agent_MessageReceive( const MQTTAgentMessageContext_t * pMsgCtx,
                            MQTTAgentCommand_t ** pReceivedCommand,
                            uint32_t blockTimeMs )
 {
-    BaseType_t queueStatus = pdFAIL;
+    bool received = false;
 
     if( ( pMsgCtx != NULL ) && ( pReceivedCommand != NULL ) )
     {
-        queueStatus = xQueueReceive( pMsgCtx->queue, pReceivedCommand, pdMS_TO_TICKS( blockTimeMs ) );
+        #if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 )
+            if( xSemaphoreTake( pMsgCtx->pendingCount, pdMS_TO_TICKS( blockTimeMs ) ) == pdPASS )
+            {
+                /* A command is waiting in one of the lanes.  Control commands
+                 * go first, however many bulk commands are queued. */
+                if( xQueueReceive( pMsgCtx->controlQueue, pReceivedCommand, 0U ) == pdPASS )
+                {
+                    received = true;
+                }
+                else
+                {
+                    received = prvReceiveBulk( pMsgCtx, pReceivedCommand, 0U );
+                }
+
+                configASSERT( received );
+            }
+        #else /* if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 ) */
+            received = prvReceiveBulk( pMsgCtx, pReceivedCommand, pdMS_TO_TICKS( blockTimeMs ) );
+        #endif /* if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 ) */
     }
 
-    return ( queueStatus == pdPASS ) ? true : false;
+    return received;
+}
+
+/*-----------------------------------------------------------*/
+
+bool Agent_MessagesPending( const MQTTAgentMessageContext_t * pMsgCtx )
+{
+    #if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 )
+        return ( ( uxQueueMessagesWaiting( pMsgCtx->controlQueue ) != 0U ) ||
+                 ( prvBulkPending( pMsgCtx ) == true ) ) ? true : false;
+    #else
+        return prvBulkPending( pMsgCtx );
+    #endif
 }
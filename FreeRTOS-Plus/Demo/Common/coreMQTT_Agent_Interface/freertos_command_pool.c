@@ -35,17 +35,30 @@
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
 
 /* Header include. */
 #include "freertos_command_pool.h"
 #include "freertos_agent_message.h"
 
+#if ( MQTT_COMMAND_POOL_USE_FREE_MASK != 0 )
+    #include "atomic.h"
+#endif
+
 /*-----------------------------------------------------------*/
 
 #define QUEUE_NOT_INITIALIZED    ( 0U )
 #define QUEUE_INITIALIZED        ( 1U )
 
+#if ( MQTT_COMMAND_POOL_USE_FREE_MASK != 0 )
+
+/**
+ * @brief Number of 32-bit words needed to hold one free bit per command structure.
+ */
+    #define POOL_MASK_WORDS    ( ( MQTT_COMMAND_CONTEXTS_POOL_SIZE + 31U ) / 32U )
+#endif
+
 /**
  * @brief The pool of command structures used to hold information on commands (such
  * as PUBLISH or SUBSCRIBE) between the command being created by an API call and
@@ -53,13 +66,66 @@
  */
 static MQTTAgentCommand_t commandStructurePool[ MQTT_COMMAND_CONTEXTS_POOL_SIZE ];
 
+#if ( MQTT_COMMAND_POOL_USE_FREE_MASK != 0 )
+
+/**
+ * @brief One bit per structure in commandStructurePool, set while the structure
+ * is free.  Bits are claimed and returned with atomic compare-and-swap and OR
+ * operations, so an uncontended get or release never enters the scheduler.
+ */
+    static volatile uint32_t freeMask[ POOL_MASK_WORDS ];
+
+/**
+ * @brief Number of tasks blocked in Agent_GetCommand() waiting for a structure
+ * to be released.  Releases only give releaseSemaphore while this is non-zero.
+ */
+    static volatile uint32_t waitingTasks = 0U;
+
+/**
+ * @brief Counting semaphore that wakes tasks waiting for a free structure.
+ * Its count is only a hint: a woken task still has to claim a bit in freeMask.
+ */
+    static SemaphoreHandle_t releaseSemaphore = NULL;
+#else /* if ( MQTT_COMMAND_POOL_USE_FREE_MASK != 0 ) */
+
+/**
+ * @brief The queue used to guard the pool of MQTTAgentCommand_t structures.
+ * Structures may be obtained by receiving a pointer from the queue, and
+ * returned by sending the pointer back into it.  A plain queue is used rather
+ * than an MQTTAgentMessageContext_t because any task may take from the pool,
+ * while a batching message context only allows the agent task to receive.
+ */
+static QueueHandle_t commandStructQueue;
+#endif /* if ( MQTT_COMMAND_POOL_USE_FREE_MASK != 0 ) */
+
+#if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 )
+
 /**
- * @brief The message context used to guard the pool of MQTTAgentCommand_t structures.
- * For FreeRTOS, this is implemented with a queue. Structures may be
- * obtained by receiving a pointer from the queue, and returned by
- * sending the pointer back into it.
+ * @brief Buffers that callers fill with a PUBLISH payload and hand to the
+ * agent, which returns them when the command carrying them is released.
  */
-static MQTTAgentMessageContext_t commandStructMessageCtx;
+    static uint8_t payloadPool[ MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE ][ MQTT_AGENT_PUBLISH_PAYLOAD_SIZE ];
+
+/**
+ * @brief Set while the matching payloadPool entry is owned by a caller or by
+ * the agent.  Only accessed inside a critical section.
+ */
+    static uint8_t payloadInUse[ MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE ];
+
+/**
+ * @brief Counts the free entries in payloadPool, so callers can block until
+ * one is released.
+ */
+    static SemaphoreHandle_t payloadFreeCount = NULL;
+
+/**
+ * @brief The pool payload carried by each structure in commandStructurePool,
+ * or NULL.  Recorded when the command is sent to the agent, as the
+ * MQTTPublishInfo_t it came from belongs to the caller and may be gone or
+ * reused by the time the command is released.
+ */
+    static const void * commandPayloads[ MQTT_COMMAND_CONTEXTS_POOL_SIZE ];
+#endif /* if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 ) */
 
 /**
  * @brief Initialization status of the queue.
@@ -68,6 +134,305 @@ static volatile uint8_t initStatus = QUEUE_NOT_INITIALIZED;
 
 /*-----------------------------------------------------------*/
 
+#if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 )
+
+/**
+ * @brief Create the payload pool.  Called once from Agent_InitializePool().
+ */
+    static void prvInitializePayloadPool( void );
+
+/**
+ * @brief Return the payload recorded for a command to the payload pool, if
+ * there is one.  Called just before the command itself is released.
+ *
+ * @param[in] index Position of the command in commandStructurePool.
+ */
+    static void prvReleaseCommandPayload( size_t index );
+
+/*-----------------------------------------------------------*/
+
+    static void prvInitializePayloadPool( void )
+    {
+        memset( ( void * ) payloadInUse, 0x00, sizeof( payloadInUse ) );
+        memset( ( void * ) commandPayloads, 0x00, sizeof( commandPayloads ) );
+        payloadFreeCount = xSemaphoreCreateCounting( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE,
+                                                     MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE );
+        configASSERT( payloadFreeCount );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvReleaseCommandPayload( size_t index )
+    {
+        const void * pPayload = commandPayloads[ index ];
+
+        if( pPayload != NULL )
+        {
+            commandPayloads[ index ] = NULL;
+
+            /* Payloads that are not from the pool are ignored. */
+            ( void ) Agent_ReleasePublishPayload( pPayload );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    void Agent_RecordCommandPayload( const MQTTAgentCommand_t * pCommand )
+    {
+        const MQTTPublishInfo_t * pPublishInfo;
+
+        /* Only the task that obtained the command accesses its entry until
+         * the command is sent, so no lock is needed. */
+        if( ( pCommand >= commandStructurePool ) &&
+            ( pCommand < ( commandStructurePool + MQTT_COMMAND_CONTEXTS_POOL_SIZE ) ) &&
+            ( pCommand->commandType == PUBLISH ) &&
+            ( pCommand->pArgs != NULL ) )
+        {
+            pPublishInfo = ( const MQTTPublishInfo_t * ) pCommand->pArgs;
+            commandPayloads[ pCommand - commandStructurePool ] = pPublishInfo->pPayload;
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    uint8_t * Agent_GetPublishPayload( uint32_t blockTimeMs )
+    {
+        uint8_t * pPayload = NULL;
+        size_t i;
+
+        configASSERT( initStatus == QUEUE_INITIALIZED );
+
+        if( xSemaphoreTake( payloadFreeCount, pdMS_TO_TICKS( blockTimeMs ) ) == pdPASS )
+        {
+            /* Holding a count guarantees at least one entry is free. */
+            taskENTER_CRITICAL();
+            {
+                for( i = 0U; ( pPayload == NULL ) && ( i < MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE ); i++ )
+                {
+                    if( payloadInUse[ i ] == 0U )
+                    {
+                        payloadInUse[ i ] = 1U;
+                        pPayload = payloadPool[ i ];
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+        else
+        {
+            LogError( ( "No publish payload buffer available." ) );
+        }
+
+        return pPayload;
+    }
+
+/*-----------------------------------------------------------*/
+
+    bool Agent_ReleasePublishPayload( const void * pPayload )
+    {
+        bool payloadReturned = false;
+        const uint8_t * pBytes = ( const uint8_t * ) pPayload;
+        size_t offset;
+
+        configASSERT( initStatus == QUEUE_INITIALIZED );
+
+        /* See if the buffer being returned is actually from the pool. */
+        if( ( pBytes >= &( payloadPool[ 0 ][ 0 ] ) ) &&
+            ( pBytes < &( payloadPool[ MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE - 1 ][ MQTT_AGENT_PUBLISH_PAYLOAD_SIZE ] ) ) )
+        {
+            offset = ( size_t ) ( pBytes - &( payloadPool[ 0 ][ 0 ] ) );
+
+            if( ( offset % MQTT_AGENT_PUBLISH_PAYLOAD_SIZE ) == 0U )
+            {
+                taskENTER_CRITICAL();
+                {
+                    /* Only a buffer that is in use can be returned, which
+                     * makes a second release of the same buffer harmless. */
+                    if( payloadInUse[ offset / MQTT_AGENT_PUBLISH_PAYLOAD_SIZE ] != 0U )
+                    {
+                        payloadInUse[ offset / MQTT_AGENT_PUBLISH_PAYLOAD_SIZE ] = 0U;
+                        payloadReturned = true;
+                    }
+                }
+                taskEXIT_CRITICAL();
+            }
+        }
+
+        if( payloadReturned == true )
+        {
+            ( void ) xSemaphoreGive( payloadFreeCount );
+        }
+
+        return payloadReturned;
+    }
+
+#endif /* if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 ) */
+/*-----------------------------------------------------------*/
+
+#if ( MQTT_COMMAND_POOL_USE_FREE_MASK != 0 )
+
+/**
+ * @brief Claim the lowest free structure in the pool without blocking.
+ *
+ * @return A pointer to the claimed structure, or NULL if none is free.
+ */
+    static MQTTAgentCommand_t * prvClaimFreeCommand( void );
+
+/*-----------------------------------------------------------*/
+
+    static MQTTAgentCommand_t * prvClaimFreeCommand( void )
+    {
+        MQTTAgentCommand_t * pCommand = NULL;
+        uint32_t lowestBit, bit, current;
+        size_t i = 0U;
+
+        while( ( pCommand == NULL ) && ( i < POOL_MASK_WORDS ) )
+        {
+            current = freeMask[ i ];
+
+            if( current == 0U )
+            {
+                /* Nothing free in this word, move on to the next. */
+                i++;
+            }
+            else
+            {
+                /* Isolate the lowest set bit. */
+                lowestBit = current & ( ~current + 1U );
+
+                /* Another task may have claimed or released a structure since
+                 * the word was read, in which case the swap fails and the word is
+                 * read again. */
+                if( Atomic_CompareAndSwap_u32( &( freeMask[ i ] ), current & ~lowestBit, current ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    for( bit = 0U; lowestBit != 1U; bit++ )
+                    {
+                        lowestBit >>= 1U;
+                    }
+
+                    pCommand = &commandStructurePool[ ( i * 32U ) + bit ];
+                }
+            }
+        }
+
+        return pCommand;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void Agent_InitializePool( void )
+    {
+        size_t i;
+
+        if( initStatus == QUEUE_NOT_INITIALIZED )
+        {
+            memset( ( void * ) commandStructurePool, 0x00, sizeof( commandStructurePool ) );
+
+            releaseSemaphore = xSemaphoreCreateCounting( MQTT_COMMAND_CONTEXTS_POOL_SIZE, 0U );
+            configASSERT( releaseSemaphore );
+
+            /* Mark every structure in the pool as free. */
+            for( i = 0; i < MQTT_COMMAND_CONTEXTS_POOL_SIZE; i++ )
+            {
+                freeMask[ i / 32U ] |= ( 1UL << ( i % 32U ) );
+            }
+
+            #if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 )
+                prvInitializePayloadPool();
+            #endif
+
+            initStatus = QUEUE_INITIALIZED;
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    MQTTAgentCommand_t * Agent_GetCommand( uint32_t blockTimeMs )
+    {
+        MQTTAgentCommand_t * structToUse = NULL;
+        TimeOut_t timeOut;
+        TickType_t ticksToWait;
+
+        configASSERT( initStatus == QUEUE_INITIALIZED );
+
+        structToUse = prvClaimFreeCommand();
+
+        if( ( structToUse == NULL ) && ( blockTimeMs > 0U ) )
+        {
+            ticksToWait = pdMS_TO_TICKS( blockTimeMs );
+            vTaskSetTimeOutState( &timeOut );
+
+            /* Register as a waiter before looking at the mask again, so a
+             * structure released after the look gives the semaphore. */
+            ( void ) Atomic_Increment_u32( &waitingTasks );
+
+            structToUse = prvClaimFreeCommand();
+
+            while( ( structToUse == NULL ) &&
+                   ( xTaskCheckForTimeOut( &timeOut, &ticksToWait ) == pdFALSE ) )
+            {
+                /* The semaphore may have been given for a structure that
+                 * another task claimed first, so always check the mask again. */
+                ( void ) xSemaphoreTake( releaseSemaphore, ticksToWait );
+                structToUse = prvClaimFreeCommand();
+            }
+
+            ( void ) Atomic_Decrement_u32( &waitingTasks );
+        }
+
+        if( structToUse == NULL )
+        {
+            LogError( ( "No command structure available." ) );
+        }
+
+        return structToUse;
+    }
+
+/*-----------------------------------------------------------*/
+
+    bool Agent_ReleaseCommand( MQTTAgentCommand_t * pCommandToRelease )
+    {
+        bool structReturned = false;
+        size_t index;
+        uint32_t bit;
+
+        configASSERT( initStatus == QUEUE_INITIALIZED );
+
+        /* See if the structure being returned is actually from the pool. */
+        if( ( pCommandToRelease >= commandStructurePool ) &&
+            ( pCommandToRelease < ( commandStructurePool + MQTT_COMMAND_CONTEXTS_POOL_SIZE ) ) )
+        {
+            index = ( size_t ) ( pCommandToRelease - commandStructurePool );
+            bit = 1UL << ( index % 32U );
+
+            #if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 )
+                /* Before the structure is free, as a new owner may overwrite it. */
+                prvReleaseCommandPayload( index );
+            #endif
+
+            /* Atomic_OR_u32() returns the previous value, which tells whether
+             * the structure was already free. */
+            structReturned = ( ( Atomic_OR_u32( &( freeMask[ index / 32U ] ), bit ) & bit ) == 0U );
+
+            /* Releasing a structure twice is an application error. */
+            configASSERT( structReturned );
+
+            if( waitingTasks != 0U )
+            {
+                /* Giving may fail if the count already reached the pool size,
+                 * in which case the waiters are awake anyway. */
+                ( void ) xSemaphoreGive( releaseSemaphore );
+            }
+
+            LogDebug( ( "Returned Command Context %d to pool",
+                        ( int ) index ) );
+        }
+
+        return structReturned;
+    }
+
+#else /* if ( MQTT_COMMAND_POOL_USE_FREE_MASK != 0 ) */
+
 void Agent_InitializePool( void )
 {
     size_t i;
@@ -79,9 +444,9 @@ void Agent_InitializePool( void )
     if( initStatus == QUEUE_NOT_INITIALIZED )
     {
         memset( ( void * ) commandStructurePool, 0x00, sizeof( commandStructurePool ) );
-        commandStructMessageCtx.queue = xQueueCreate( MQTT_COMMAND_CONTEXTS_POOL_SIZE,
-                                                       sizeof( MQTTAgentCommand_t * ) );
-        configASSERT( commandStructMessageCtx.queue );
+        commandStructQueue = xQueueCreate( MQTT_COMMAND_CONTEXTS_POOL_SIZE,
+                                           sizeof( MQTTAgentCommand_t * ) );
+        configASSERT( commandStructQueue );
 
         /* Populate the queue. */
         for( i = 0; i < MQTT_COMMAND_CONTEXTS_POOL_SIZE; i++ )
@@ -89,10 +454,14 @@ void Agent_InitializePool( void )
             /* Store the address as a variable. */
             pCommand = &commandStructurePool[ i ];
             /* Send the pointer to the queue. */
-            commandAdded = Agent_MessageSend( &commandStructMessageCtx, &pCommand, 0U );
+            commandAdded = ( xQueueSendToBack( commandStructQueue, &pCommand, 0U ) == pdPASS );
             configASSERT( commandAdded );
         }
 
+        #if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 )
+            prvInitializePayloadPool();
+        #endif
+
         initStatus = QUEUE_INITIALIZED;
     }
 }
@@ -108,7 +477,7 @@ MQTTAgentCommand_t * Agent_GetCommand( uint32_t blockTimeMs )
     configASSERT( initStatus == QUEUE_INITIALIZED );
 
     /* Retrieve a struct from the queue. */
-    structRetrieved = Agent_MessageReceive( &commandStructMessageCtx, &( structToUse ), blockTimeMs );
+    structRetrieved = ( xQueueReceive( commandStructQueue, &( structToUse ), pdMS_TO_TICKS( blockTimeMs ) ) == pdPASS );
 
     if( !structRetrieved )
     {
@@ -130,7 +499,12 @@ bool Agent_ReleaseCommand( MQTTAgentCommand_t * pCommandToRelease )
     if( ( pCommandToRelease >= commandStructurePool ) &&
         ( pCommandToRelease < ( commandStructurePool + MQTT_COMMAND_CONTEXTS_POOL_SIZE ) ) )
     {
-        structReturned = Agent_MessageSend( &commandStructMessageCtx, &pCommandToRelease, 0U );
+        #if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 )
+            /* Before the structure is free, as a new owner may overwrite it. */
+            prvReleaseCommandPayload( ( size_t ) ( pCommandToRelease - commandStructurePool ) );
+        #endif
+
+        structReturned = ( xQueueSendToBack( commandStructQueue, &pCommandToRelease, 0U ) == pdPASS );
 
         /* The send should not fail as the queue was created to hold every command
          * in the pool. */
@@ -141,3 +515,5 @@ bool Agent_ReleaseCommand( MQTTAgentCommand_t * pCommandToRelease )
 
     return structReturned;
 }
+
+#endif /* if ( MQTT_COMMAND_POOL_USE_FREE_MASK != 0 ) */
@@ -38,17 +38,70 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "stream_buffer.h"
+#include "semphr.h"
 
 /* Include MQTT agent messaging interface. */
+#include "core_mqtt_agent.h"
 #include "core_mqtt_agent_message_interface.h"
 
+/**
+ * @brief When set above 0, commands are carried to the agent as pointers in a
+ * stream buffer instead of items in a queue.  Agent_MessageReceive() then
+ * drains up to MQTT_AGENT_MESSAGE_BATCH_LENGTH pending commands with a single
+ * stream buffer read and hands them out one by one from a local copy, and
+ * Agent_MessageSendBatch() writes several commands with a single write.  The
+ * context must be created with Agent_InitializeMessageContext() and must have
+ * only one receiving task, the agent task.  Defaults to 0, the queue.
+ */
+#ifndef MQTT_AGENT_MESSAGE_BATCH_LENGTH
+    #define MQTT_AGENT_MESSAGE_BATCH_LENGTH    0
+#endif
+
+/**
+ * @brief When set above 0, commands other than PUBLISH travel in a separate
+ * control queue of this length, which Agent_MessageReceive() always empties
+ * before taking anything from the PUBLISH (bulk) lane.  A backlog of telemetry
+ * then no longer delays subscriptions, pings or disconnects, at the cost of
+ * those commands overtaking PUBLISH commands that were sent earlier.  The
+ * context must be created with Agent_InitializeMessageContext().  Defaults to
+ * 0, a single lane.
+ */
+#ifndef MQTT_AGENT_CONTROL_QUEUE_LENGTH
+    #define MQTT_AGENT_CONTROL_QUEUE_LENGTH    0
+#endif
+
+#if ( MQTT_AGENT_MESSAGE_BATCH_LENGTH > 0 )
+
+/**
+ * @brief Commands taken from the stream buffer by the receiving task that have
+ * not been returned by Agent_MessageReceive() yet.
+ */
+    typedef struct AgentMessageBatch
+    {
+        MQTTAgentCommand_t * commands[ MQTT_AGENT_MESSAGE_BATCH_LENGTH ];
+        size_t count;
+        size_t next;
+    } AgentMessageBatch_t;
+#endif
+
 /**
  * @ingroup mqtt_agent_struct_types
  * @brief Context with which tasks may deliver messages to the agent.
  */
 struct MQTTAgentMessageContext
 {
-    QueueHandle_t queue;
+    #if ( MQTT_AGENT_MESSAGE_BATCH_LENGTH > 0 )
+        StreamBufferHandle_t streamBuffer; /**< Holds pointers to pending commands. */
+        SemaphoreHandle_t sendMutex;       /**< Serialises writers to streamBuffer. */
+        AgentMessageBatch_t * pBatch;      /**< Commands already read by the receiver. */
+    #else
+        QueueHandle_t queue;
+    #endif
+    #if ( MQTT_AGENT_CONTROL_QUEUE_LENGTH > 0 )
+        QueueHandle_t controlQueue;     /**< Commands other than PUBLISH. */
+        SemaphoreHandle_t pendingCount; /**< Counts commands in both lanes. */
+    #endif
 };
 
 /*-----------------------------------------------------------*/
@@ -81,4 +134,47 @@ bool Agent_MessageReceive( const MQTTAgentMessageContext_t * pMsgCtx,
                            MQTTAgentCommand_t ** pReceivedCommand,
                            uint32_t blockTimeMs );
 
+/**
+ * @brief Create the queues or stream buffer behind a message context.
+ *
+ * @param[out] pMsgCtx The #MQTTAgentMessageContext_t to initialize.
+ * @param[in] queueLength Maximum number of commands that can be pending, not
+ * counting the control lane if MQTT_AGENT_CONTROL_QUEUE_LENGTH is above 0.
+ *
+ * @return `true` if the context was created, else `false`.
+ */
+bool Agent_InitializeMessageContext( MQTTAgentMessageContext_t * pMsgCtx,
+                                     size_t queueLength );
+
+/**
+ * @brief Send several messages to the specified context in one call.
+ * Must be thread safe.
+ *
+ * When MQTT_AGENT_MESSAGE_BATCH_LENGTH is above 0, all the commands that fit
+ * are written with one stream buffer operation and reach the agent together.
+ * Otherwise the commands are sent to the queue one at a time.
+ *
+ * @param[in] pMsgCtx An #MQTTAgentMessageContext_t.
+ * @param[in] pCommandsToSend Array of commands to send, in order.
+ * @param[in] commandCount Number of entries in @p pCommandsToSend.
+ * @param[in] blockTimeMs Total time to wait for space to send into.
+ *
+ * @return The number of commands sent, which is less than @p commandCount if
+ * @p blockTimeMs expired first.
+ */
+size_t Agent_MessageSendBatch( const MQTTAgentMessageContext_t * pMsgCtx,
+                               MQTTAgentCommand_t * const * pCommandsToSend,
+                               size_t commandCount,
+                               uint32_t blockTimeMs );
+
+/**
+ * @brief Check whether any messages are waiting to be received.
+ *
+ * @param[in] pMsgCtx An #MQTTAgentMessageContext_t.
+ *
+ * @return `true` if Agent_MessageReceive() would return a command without
+ * blocking, else `false`.
+ */
+bool Agent_MessagesPending( const MQTTAgentMessageContext_t * pMsgCtx );
+
 #endif /* FREERTOS_AGENT_MESSAGE_H */
@@ -34,6 +34,38 @@
 /* MQTT agent includes. */
 #include "core_mqtt_agent.h"
 
+/**
+ * @brief Set MQTT_COMMAND_POOL_USE_FREE_MASK to 1 in core_mqtt_agent_config.h
+ * to track free command structures in a bit mask updated with the kernel's
+ * atomic.h operations instead of a queue.  A get or release that does not have
+ * to wait then costs a compare-and-swap instead of a queue operation, and tasks
+ * on different cores of an SMP build no longer serialise on the queue.  A task
+ * that finds the pool empty still blocks, on a counting semaphore that releases
+ * only give while somebody is waiting.  Defaults to 0, the queue based pool.
+ */
+#ifndef MQTT_COMMAND_POOL_USE_FREE_MASK
+    #define MQTT_COMMAND_POOL_USE_FREE_MASK    0
+#endif
+
+/**
+ * @brief Number of PUBLISH payload buffers to allocate next to the command
+ * pool.  A task can fill a buffer obtained from Agent_GetPublishPayload() and
+ * pass it as the payload to MQTTAgent_Publish().  The agent then owns the
+ * buffer and returns it to the pool when it releases the PUBLISH command, so
+ * the task needs neither its own staging buffer nor to keep the payload alive.
+ * Defaults to 0, no payload pool.
+ */
+#ifndef MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE
+    #define MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE    0
+#endif
+
+/**
+ * @brief Size in bytes of each buffer in the PUBLISH payload pool.
+ */
+#ifndef MQTT_AGENT_PUBLISH_PAYLOAD_SIZE
+    #define MQTT_AGENT_PUBLISH_PAYLOAD_SIZE    256
+#endif
+
 /**
  * @brief Initialize the common task pool. Not thread safe.
  */
@@ -80,4 +112,47 @@ MQTTAgentCommand_t * Agent_GetCommand( uint32_t blockTimeMs );
  */
 bool Agent_ReleaseCommand( MQTTAgentCommand_t * pCommandToRelease );
 
+#if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 )
+
+/**
+ * @brief Obtain a MQTT_AGENT_PUBLISH_PAYLOAD_SIZE byte buffer from the PUBLISH
+ * payload pool.
+ *
+ * @note Once the buffer is passed as the pPayload of MQTTAgent_Publish() it
+ * belongs to the agent, which returns it to the pool when it releases the
+ * command, after the completion callback has run.  Only if MQTTAgent_Publish()
+ * returns MQTTBadParameter or MQTTNoMemory was no command created, and the
+ * caller must return the buffer with Agent_ReleasePublishPayload().  The agent
+ * records the buffer when the command is sent to it, so the MQTTPublishInfo_t
+ * passed to MQTTAgent_Publish() is free to reuse once the completion callback
+ * has run.
+ *
+ * @param[in] blockTimeMs The length of time the calling task should remain in
+ * the Blocked state to wait for a buffer to become available.
+ *
+ * @return A pointer to the buffer, or NULL if none became available in time.
+ */
+    uint8_t * Agent_GetPublishPayload( uint32_t blockTimeMs );
+
+/**
+ * @brief Return a buffer to the PUBLISH payload pool.
+ *
+ * @param[in] pPayload A buffer obtained from Agent_GetPublishPayload().
+ *
+ * @return true if the buffer was returned, false if it is not from the pool or
+ * was already free.
+ */
+    bool Agent_ReleasePublishPayload( const void * pPayload );
+
+/**
+ * @brief Record the payload of a PUBLISH command, so it can be returned to the
+ * payload pool when the command is released.  Called by
+ * Agent_MessageSendBatch() for each command it sends, while the caller's
+ * MQTTPublishInfo_t is still valid.
+ *
+ * @param[in] pCommand A command about to be sent to the agent.
+ */
+    void Agent_RecordCommandPayload( const MQTTAgentCommand_t * pCommand );
+#endif /* if ( MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE > 0 ) */
+
 #endif /* FREERTOS_COMMAND_POOL_H */
@@ -32,6 +32,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* FreeRTOS+CLI includes. */
 #include "FreeRTOS_CLI.h"
@@ -46,6 +47,21 @@
 
 #define cliNEW_LINE		"\r\n"
 
+/* The number of directory entries the DIR command reads from the file system
+at a time.  The entries are then output one per call of the command. */
+#define cliDIR_BATCH_SIZE	8
+
+/* The size of the buffer used to copy files when the copy cannot be done
+within the file system.  Larger buffers mean fewer, larger reads and writes,
+which is what both Reliance Edge and the underlying media are fastest at. */
+#ifndef cliFILE_TRANSFER_BUFFER_SIZE
+	#define cliFILE_TRANSFER_BUFFER_SIZE	( 32 * 1024 )
+#endif
+
+/* The largest number of bytes handed to red_copyfile() at once.  Kept well
+below INT32_MAX, which red_copyfile() cannot report. */
+#define cliCOPYFILE_CHUNK_SIZE	0x40000000UL
+
 /*******************************************************************************
  * See the URL in the comments within main.c for the location of the online
  * documentation.
@@ -59,10 +75,7 @@ static void prvCreateFileInfoString( char *pcBuffer, REDDIRENT *pxDirent );
 /*
  * Copies an existing file into a newly created file.
  */
-static BaseType_t prvPerformCopy( int32_t lSourceFildes,
-							int32_t lDestinationFiledes,
-							char *pxWriteBuffer,
-							size_t xWriteBufferLen );
+static BaseType_t prvPerformCopy( int32_t lSourceFildes, int32_t lDestinationFiledes );
 
 /*
  * Implements the DIR command.
@@ -149,6 +162,12 @@ static BaseType_t prvABORTCommand( char *pcWriteBuffer, size_t xWriteBufferLen,
  */
 static BaseType_t prvTESTFSCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 
+/*
+ * Implements the BENCH-FS command.  The optional parameters select the tests
+ * to run and the size of the files they use.
+ */
+static BaseType_t prvBENCHFSCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
 
 /* Structure that defines the DIR command line command, which lists all the
 files in the current directory. */
@@ -317,6 +336,24 @@ static const CLI_Command_Definition_t xTEST_FS =
 	0 /* No parameters are expected. */
 };
 
+/* Structure that defines the BENCH-FS command line command, which measures
+file system throughput, IOPS and latency.  The benchmark works in a directory of
+its own, so it can be run against a volume holding real data while the file
+system configuration is being tuned. */
+static const CLI_Command_Definition_t xBENCH_FS =
+{
+	"bench-fs", /* The command string to type. */
+	"\r\nbench-fs [all|seq|rand|meta|trans] [size]:\r\n Executes file system benchmarks in the /fsbench directory.  size is the data\r\n file size, or the small file size for meta, in KB unless a B or MB suffix is\r\n used.  Results are sent to the Windows console.\r\n",
+	prvBENCHFSCommand, /* The function to run. */
+	-1 /* The number of parameters is variable. */
+};
+
+/* The buffer through which files are copied when red_copyfile() cannot be
+used.  All the commands run in the context of the one console task, so a single
+buffer is shared rather than each copy using stack.  It is declared as an array
+of words so it is word aligned, as some block device drivers require for DMA. */
+static uint32_t ulTransferBuffer[ cliFILE_TRANSFER_BUFFER_SIZE / sizeof( uint32_t ) ];
+
 /*-----------------------------------------------------------*/
 
 void vRegisterFileSystemCLICommands( void )
@@ -339,13 +376,15 @@ void vRegisterFileSystemCLICommands( void )
 	FreeRTOS_CLIRegisterCommand( &xTRANSMASKSET );
 	FreeRTOS_CLIRegisterCommand( &xABORT );
 	FreeRTOS_CLIRegisterCommand( &xTEST_FS );
+	FreeRTOS_CLIRegisterCommand( &xBENCH_FS );
 }
 /*-----------------------------------------------------------*/
 
 static BaseType_t prvDIRCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
 {
 static REDDIR *pxDir = NULL;
-REDDIRENT *pxDirent;
+static REDDIRENT xDirents[ cliDIR_BATCH_SIZE ];
+static int32_t lDirentCount = 0, lNextDirent = 0;
 const char *pcParameter;
 BaseType_t xParameterStringLength, xReturn = pdFALSE;
 
@@ -372,22 +411,29 @@ BaseType_t xParameterStringLength, xReturn = pdFALSE;
 		/* This is the first time this function has been executed since the Dir
 		command was run.  Open the directory. */
 		pxDir = red_opendir( pcParameter );
+		lDirentCount = 0;
+		lNextDirent = 0;
 	}
 
 	if( pxDir )
 	{
-		/* red_readdir() returns NULL either on error or upon reaching the
-		end of the directory.  Clear errno so these conditions can be
-		distinguished. */
-		red_errno = 0;
-		pxDirent = red_readdir( pxDir );
+		/* Read the next batch of entries, along with their size and
+		attributes, once the previous batch has been output.
+		red_readdir_batch() returns 0 at the end of the directory and -1 on
+		error. */
+		if( lNextDirent >= lDirentCount )
+		{
+			lDirentCount = red_readdir_batch( pxDir, xDirents, cliDIR_BATCH_SIZE, true );
+			lNextDirent = 0;
+		}
 
-		if( pxDirent )
+		if( lDirentCount > 0 )
 		{
-			prvCreateFileInfoString( pcWriteBuffer, pxDirent );
+			prvCreateFileInfoString( pcWriteBuffer, &( xDirents[ lNextDirent ] ) );
+			lNextDirent++;
 			xReturn = pdPASS;
 		}
-		else if( red_errno == 0 )
+		else if( lDirentCount == 0 )
 		{
 			/* There are no more files.  Close the directory. */
 			red_closedir( pxDir );
@@ -727,6 +773,9 @@ const char *pcDestinationFile;
 BaseType_t xParameterStringLength;
 int32_t lSourceFildes, lDestinationFildes;
 
+	/* This function assumes xWriteBufferLen is large enough! */
+	( void ) xWriteBufferLen;
+
 	/* Obtain the name of the destination file. */
 	pcDestinationFile = FreeRTOS_CLIGetParameter
 						(
@@ -770,7 +819,7 @@ int32_t lSourceFildes, lDestinationFildes;
 		}
 		else
 		{
-			if( prvPerformCopy( lSourceFildes, lDestinationFildes, pcWriteBuffer, xWriteBufferLen ) == pdPASS )
+			if( prvPerformCopy( lSourceFildes, lDestinationFildes ) == pdPASS )
 			{
 				sprintf( pcWriteBuffer, "Copy made" );
 			}
@@ -1462,20 +1511,182 @@ FSSTRESSPARAM param;
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvPerformCopy( int32_t lSourceFildes,
-									int32_t lDestinationFiledes,
-									char *pxWriteBuffer,
-									size_t xWriteBufferLen )
+static BaseType_t prvBENCHFSCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+UBaseType_t uxOriginalPriority;
+FSBENCHPARAM param;
+char *pcParameter;
+const char *pcEnd;
+BaseType_t xParameterStringLength, xGoodParameters = pdTRUE;
+uint32_t ulSize = 0;
+BaseType_t xSizeIsSmallFile = pdFALSE;
+
+	/* This function assumes xWriteBufferLen is large enough! */
+	( void ) xWriteBufferLen;
+
+	FsbenchDefaultParams( &param );
+
+	/* Find the size, if any.  This is the last parameter, so it is already
+	terminated. */
+	pcParameter = ( char * ) FreeRTOS_CLIGetParameter
+							(
+								pcCommandString,		/* The command string itself. */
+								2,						/* Return the second parameter. */
+								&xParameterStringLength	/* Store the parameter string length. */
+							);
+
+	if( pcParameter != NULL )
+	{
+		pcEnd = RedSizeToUL( pcParameter, &ulSize );
+		if( ( pcEnd == NULL ) || ( pcEnd != &pcParameter[ xParameterStringLength ] ) || ( ulSize == 0 ) )
+		{
+			strcpy( pcWriteBuffer, "Second parameter must be a size, such as 64, 512B or 2MB." );
+			xGoodParameters = pdFALSE;
+		}
+	}
+
+	if( xGoodParameters )
+	{
+		/* Find which tests to run, if specified. */
+		pcParameter = ( char * ) FreeRTOS_CLIGetParameter
+								(
+									pcCommandString,		/* The command string itself. */
+									1,						/* Return the first parameter. */
+									&xParameterStringLength	/* Store the parameter string length. */
+								);
+
+		if( pcParameter != NULL )
+		{
+			/* Terminate the string. */
+			pcParameter[ xParameterStringLength ] = 0x00;
+
+			param.fSequential = pdFALSE;
+			param.fRandom = pdFALSE;
+			param.fSmallFiles = pdFALSE;
+			param.fTransact = pdFALSE;
+
+			if( strcmp( pcParameter, "all" ) == 0 )
+			{
+				param.fSequential = pdTRUE;
+				param.fRandom = pdTRUE;
+				param.fSmallFiles = pdTRUE;
+				param.fTransact = pdTRUE;
+			}
+			else if( strcmp( pcParameter, "seq" ) == 0 )
+			{
+				param.fSequential = pdTRUE;
+			}
+			else if( strcmp( pcParameter, "rand" ) == 0 )
+			{
+				param.fRandom = pdTRUE;
+			}
+			else if( strcmp( pcParameter, "meta" ) == 0 )
+			{
+				param.fSmallFiles = pdTRUE;
+				xSizeIsSmallFile = pdTRUE;
+			}
+			else if( strcmp( pcParameter, "trans" ) == 0 )
+			{
+				param.fTransact = pdTRUE;
+			}
+			else
+			{
+				strcpy( pcWriteBuffer, "First parameter must be all, seq, rand, meta or trans." );
+				xGoodParameters = pdFALSE;
+			}
+		}
+	}
+
+	if( xGoodParameters && ( ulSize != 0 ) )
+	{
+		if( xSizeIsSmallFile != pdFALSE )
+		{
+			param.ulSmallFileSize = ulSize;
+		}
+		else
+		{
+			param.ulFileSize = ulSize;
+
+			/* The file must hold at least one I/O. */
+			if( param.ulIOSize > ulSize )
+			{
+				param.ulIOSize = ulSize;
+			}
+		}
+	}
+
+	if( xGoodParameters )
+	{
+		/* As with the TEST-FS command, run at a high priority for the duration
+		of the benchmark, so that switches to the idle task do not distort the
+		timings. */
+		uxOriginalPriority = uxTaskPriorityGet( NULL );
+		vTaskPrioritySet( NULL, configMAX_PRIORITIES - 1 );
+
+		/* The benchmark keeps its files in a directory of its own and removes
+		them when it is done, so the rest of the volume is left alone. */
+		if( FsbenchStart( &param ) == 0 )
+		{
+			strcpy( pcWriteBuffer, "Benchmark results were sent to Windows console" );
+		}
+		else
+		{
+			strcpy( pcWriteBuffer, "Benchmark failed, see the Windows console for details" );
+		}
+
+		/* Reset back to the original priority. */
+		vTaskPrioritySet( NULL, uxOriginalPriority );
+	}
+
+	strcat( pcWriteBuffer, cliNEW_LINE );
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvPerformCopy( int32_t lSourceFildes, int32_t lDestinationFiledes )
 {
 int32_t lBytesRead;
-BaseType_t xReturn = pdPASS;
+BaseType_t xReturn = pdPASS, xDone = pdFALSE;
 
 	/* Assuming both files are at offset zero. */
 
-	for( ;; )
+	#if( REDCONF_API_POSIX_COPYFILE == 1 )
+	{
+	int32_t lBytesCopied;
+
+		/* Copy within the file system, which moves the data a block at a time
+		through the file system's own buffers and does not have to go through
+		ulTransferBuffer at all.  Keep going until a zero length copy shows the
+		end of the source file has been reached. */
+		do
+		{
+			lBytesCopied = red_copyfile( lSourceFildes, lDestinationFiledes, cliCOPYFILE_CHUNK_SIZE );
+		} while( lBytesCopied > 0 );
+
+		if( lBytesCopied == 0 )
+		{
+			/* The whole file was copied. */
+			xDone = pdTRUE;
+		}
+		else if( red_errno != RED_EXDEV )
+		{
+			xReturn = pdFAIL;
+			xDone = pdTRUE;
+		}
+		else
+		{
+			/* The files are on different volumes, which red_copyfile() does
+			not support, and nothing was copied.  Fall back to copying
+			through the transfer buffer. */
+		}
+	}
+	#endif /* REDCONF_API_POSIX_COPYFILE */
+
+	while( xDone == pdFALSE )
 	{
 		/* Read the next block of data. */
-		lBytesRead = red_read( lSourceFildes, pxWriteBuffer, xWriteBufferLen );
+		lBytesRead = red_read( lSourceFildes, ulTransferBuffer, sizeof( ulTransferBuffer ) );
 		if( lBytesRead <= 0 )
 		{
 			if( lBytesRead == -1)
@@ -1492,7 +1703,7 @@ BaseType_t xReturn = pdPASS;
 		}
 
 		/* Write the block of data to the end of the file. */
-		if( red_write( lDestinationFiledes, pxWriteBuffer, lBytesRead ) != lBytesRead )
+		if( red_write( lDestinationFiledes, ulTransferBuffer, lBytesRead ) != lBytesRead )
 		{
 			xReturn = pdFAIL;
 			break;
@@ -40,6 +40,8 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
@@ -63,13 +65,63 @@
  * protocol port. */
     #define echoECHO_PORT                 ( 7 )
 
+/* Set echoTHROUGHPUT_TEST to 1 in FreeRTOSConfig.h to turn the echo clients
+ * into an iperf style throughput and latency test against the same echo
+ * server. Each client task is then one stream, which first times
+ * echoTHROUGHPUT_RTT_SAMPLES messages sent one at a time, then keeps up to
+ * echoTHROUGHPUT_WINDOW_MSS segments in flight for echoTHROUGHPUT_DURATION_MS
+ * and reports the rate at which they were echoed. */
+    #ifndef echoTHROUGHPUT_TEST
+        #define echoTHROUGHPUT_TEST    0
+    #endif
+
+    #if ( echoTHROUGHPUT_TEST == 1 )
+
+/* Number of parallel streams, each with its own connection. */
+        #ifndef echoTHROUGHPUT_STREAMS
+            #define echoTHROUGHPUT_STREAMS         ( 2 )
+        #endif
+
+/* Bytes passed to each FreeRTOS_send() call. */
+        #ifndef echoTHROUGHPUT_MESSAGE_SIZE
+            #define echoTHROUGHPUT_MESSAGE_SIZE    ( ipconfigTCP_MSS )
+        #endif
+
+/* TCP window size in segments. Also bounds the data in flight, and the
+ * socket buffers are twice this so the echo can never stall the sender. */
+        #ifndef echoTHROUGHPUT_WINDOW_MSS
+            #define echoTHROUGHPUT_WINDOW_MSS      ( 8 )
+        #endif
+
+        #ifndef echoTHROUGHPUT_DURATION_MS
+            #define echoTHROUGHPUT_DURATION_MS     ( 10000 )
+        #endif
+
+        #ifndef echoTHROUGHPUT_RTT_SAMPLES
+            #define echoTHROUGHPUT_RTT_SAMPLES     ( 100 )
+        #endif
+
+/* Received data is checked against the pattern it was sent with, so a
+ * stream can still detect corruption. */
+        #define echoPATTERN_BYTE( ullOffset, xInstance )    ( ( char ) ( ( ( ullOffset ) * 7U ) + ( uint64_t ) ( xInstance ) ) )
+
+    #endif /* echoTHROUGHPUT_TEST */
+
 /* The size of the buffers is a multiple of the MSS - the length of the data
  * sent is a pseudo random size between 20 and echoBUFFER_SIZES. */
     #define echoBUFFER_SIZE_MULTIPLIER    ( 3 )
-    #define echoBUFFER_SIZES              ( ipconfigTCP_MSS * echoBUFFER_SIZE_MULTIPLIER )
+    #if ( echoTHROUGHPUT_TEST == 1 )
+        #define echoBUFFER_SIZES          ( echoTHROUGHPUT_MESSAGE_SIZE )
+    #else
+        #define echoBUFFER_SIZES          ( ipconfigTCP_MSS * echoBUFFER_SIZE_MULTIPLIER )
+    #endif
 
 /* The number of instances of the echo client task to create. */
-    #define echoNUM_ECHO_CLIENTS          ( 1 )
+    #if ( echoTHROUGHPUT_TEST == 1 )
+        #define echoNUM_ECHO_CLIENTS      ( echoTHROUGHPUT_STREAMS )
+    #else
+        #define echoNUM_ECHO_CLIENTS      ( 1 )
+    #endif
 
 /*-----------------------------------------------------------*/
 
@@ -85,6 +137,40 @@
     static BaseType_t prvCreateTxData( char * ucBuffer,
                                        uint32_t ulBufferLength );
 
+    #if ( echoTHROUGHPUT_TEST == 1 )
+
+/*
+ * Implements one stream of the throughput test.
+ */
+        static void prvThroughputClientTask( void * pvParameters );
+
+/*
+ * Returns a free running time in microseconds.
+ */
+        static uint64_t prvTimestampUs( void );
+
+/*
+ * Sends echoTHROUGHPUT_RTT_SAMPLES messages one at a time and records the time
+ * each takes to come back. Returns pdPASS if all were echoed correctly.
+ */
+        static BaseType_t prvMeasureLatency( Socket_t xSocket,
+                                             BaseType_t xInstance );
+
+/*
+ * Streams data for echoTHROUGHPUT_DURATION_MS with up to a window in flight.
+ * Returns pdPASS if everything sent was echoed correctly.
+ */
+        static BaseType_t prvMeasureThroughput( Socket_t xSocket,
+                                                BaseType_t xInstance );
+
+/*
+ * Prints the results of one stream and, once every stream has finished a
+ * run, the totals.
+ */
+        static void prvReportThroughput( BaseType_t xInstance );
+
+    #endif /* echoTHROUGHPUT_TEST */
+
 /*-----------------------------------------------------------*/
 
 /* Rx and Tx time outs are used to ensure the sockets do not wait too long for
@@ -101,6 +187,25 @@
     static char cTxBuffers[ echoNUM_ECHO_CLIENTS ][ echoBUFFER_SIZES ],
                 cRxBuffers[ echoNUM_ECHO_CLIENTS ][ echoBUFFER_SIZES ];
 
+    #if ( echoTHROUGHPUT_TEST == 1 )
+
+/* Results of the latest run of each stream. */
+        typedef struct xTHROUGHPUT_RESULT
+        {
+            uint32_t ulRttUs[ echoTHROUGHPUT_RTT_SAMPLES ]; /* Sorted once the run is complete. */
+            uint64_t ullBytesEchoed;
+            uint64_t ullElapsedUs;
+            uint32_t ulStalls;                              /* Receive timeouts with data in flight. */
+        } ThroughputResult_t;
+
+        static ThroughputResult_t xThroughputResults[ echoTHROUGHPUT_STREAMS ];
+
+/* Counts streams which finished the current run, so the last one to finish
+ * can print the totals. */
+        static BaseType_t xStreamsReported = 0;
+
+    #endif /* echoTHROUGHPUT_TEST */
+
 /*-----------------------------------------------------------*/
 
     void vStartTCPEchoClientTasks_SingleTasks( configSTACK_DEPTH_TYPE uxTaskStackSize,
@@ -108,11 +213,17 @@
     {
         BaseType_t x;
 
+        #if ( echoTHROUGHPUT_TEST == 1 )
+            TaskFunction_t pxClientTask = prvThroughputClientTask;
+        #else
+            TaskFunction_t pxClientTask = prvEchoClientTask;
+        #endif
+
         /* Create the echo client tasks. */
         for( x = 0; x < echoNUM_ECHO_CLIENTS; x++ )
         {
             xTaskCreate(
-                prvEchoClientTask, /* The function that implements the task. */
+                pxClientTask,      /* The function that implements the task. */
                 "Echo0",           /* Just a text name for the task to aid debugging. */
                 uxTaskStackSize,   /* The stack size is defined in FreeRTOSIPConfig.h. */
                 ( void * ) x,      /* The task parameter, not used in this case. */
@@ -368,6 +479,327 @@
     }
 /*-----------------------------------------------------------*/
 
+    #if ( echoTHROUGHPUT_TEST == 1 )
+
+        static uint64_t prvTimestampUs( void )
+        {
+            struct timespec xNow;
+
+            /* The simulator runs on the host, whose clock is far finer than
+             * the tick. */
+            clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+            return ( ( uint64_t ) xNow.tv_sec * 1000000ULL ) + ( ( uint64_t ) xNow.tv_nsec / 1000ULL );
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvMeasureLatency( Socket_t xSocket,
+                                             BaseType_t xInstance )
+        {
+            char * pcTx = &( cTxBuffers[ xInstance ][ 0 ] );
+            char * pcRx = &( cRxBuffers[ xInstance ][ 0 ] );
+            ThroughputResult_t * pxResult = &( xThroughputResults[ xInstance ] );
+            BaseType_t xSample, xReceived, xReturned, x;
+            uint64_t ullStart;
+
+            for( xSample = 0; xSample < echoTHROUGHPUT_RTT_SAMPLES; xSample++ )
+            {
+                for( x = 0; x < echoTHROUGHPUT_MESSAGE_SIZE; x++ )
+                {
+                    pcTx[ x ] = echoPATTERN_BYTE( ( uint64_t ) xSample + ( uint64_t ) x, xInstance );
+                }
+
+                ullStart = prvTimestampUs();
+
+                if( FreeRTOS_send( xSocket, pcTx, echoTHROUGHPUT_MESSAGE_SIZE, 0 ) != echoTHROUGHPUT_MESSAGE_SIZE )
+                {
+                    return pdFAIL;
+                }
+
+                for( xReceived = 0; xReceived < echoTHROUGHPUT_MESSAGE_SIZE; xReceived += xReturned )
+                {
+                    xReturned = FreeRTOS_recv( xSocket, &( pcRx[ xReceived ] ), echoTHROUGHPUT_MESSAGE_SIZE - xReceived, 0 );
+
+                    if( xReturned <= 0 )
+                    {
+                        return pdFAIL;
+                    }
+                }
+
+                pxResult->ulRttUs[ xSample ] = ( uint32_t ) ( prvTimestampUs() - ullStart );
+
+                if( memcmp( pcTx, pcRx, echoTHROUGHPUT_MESSAGE_SIZE ) != 0 )
+                {
+                    return pdFAIL;
+                }
+            }
+
+            return pdPASS;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvMeasureThroughput( Socket_t xSocket,
+                                                BaseType_t xInstance )
+        {
+            char * pcTx = &( cTxBuffers[ xInstance ][ 0 ] );
+            char * pcRx = &( cRxBuffers[ xInstance ][ 0 ] );
+            ThroughputResult_t * pxResult = &( xThroughputResults[ xInstance ] );
+            const uint64_t ullWindow = ( uint64_t ) echoTHROUGHPUT_WINDOW_MSS * ipconfigTCP_MSS;
+            uint64_t ullSent = 0, ullReceived = 0, ullStart, ullNow;
+            BaseType_t xReturned, xFlags, x;
+
+            pxResult->ulStalls = 0;
+            ullStart = prvTimestampUs();
+            ullNow = ullStart;
+
+            /* Send while the test runs and there is room in the window, then
+             * wait for everything still in flight to come back. */
+            while( ( ( ullNow - ullStart ) < ( echoTHROUGHPUT_DURATION_MS * 1000ULL ) ) || ( ullReceived < ullSent ) )
+            {
+                xFlags = 0;
+
+                if( ( ( ullNow - ullStart ) < ( echoTHROUGHPUT_DURATION_MS * 1000ULL ) ) &&
+                    ( ( ullSent - ullReceived ) + echoTHROUGHPUT_MESSAGE_SIZE <= ullWindow ) )
+                {
+                    for( x = 0; x < echoTHROUGHPUT_MESSAGE_SIZE; x++ )
+                    {
+                        pcTx[ x ] = echoPATTERN_BYTE( ullSent + ( uint64_t ) x, xInstance );
+                    }
+
+                    xReturned = FreeRTOS_send( xSocket, pcTx, echoTHROUGHPUT_MESSAGE_SIZE, 0 );
+
+                    if( xReturned < 0 )
+                    {
+                        return pdFAIL;
+                    }
+
+                    ullSent += ( uint64_t ) xReturned;
+
+                    /* Collect whatever has been echoed so far without
+                     * blocking, so the window stays full. */
+                    xFlags = FREERTOS_MSG_DONTWAIT;
+                }
+
+                xReturned = FreeRTOS_recv( xSocket, pcRx, echoBUFFER_SIZES, xFlags );
+
+                if( xReturned > 0 )
+                {
+                    for( x = 0; x < xReturned; x++ )
+                    {
+                        if( pcRx[ x ] != echoPATTERN_BYTE( ullReceived + ( uint64_t ) x, xInstance ) )
+                        {
+                            return pdFAIL;
+                        }
+                    }
+
+                    ullReceived += ( uint64_t ) xReturned;
+                }
+                else if( ( xReturned == 0 ) || ( xReturned == -pdFREERTOS_ERRNO_EWOULDBLOCK ) )
+                {
+                    if( xFlags == 0 )
+                    {
+                        /* The receive timed out with data in flight. */
+                        pxResult->ulStalls++;
+
+                        if( pxResult->ulStalls > 3U )
+                        {
+                            return pdFAIL;
+                        }
+                    }
+                }
+                else
+                {
+                    return pdFAIL;
+                }
+
+                ullNow = prvTimestampUs();
+            }
+
+            pxResult->ullBytesEchoed = ullReceived;
+            pxResult->ullElapsedUs = ullNow - ullStart;
+
+            return pdPASS;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvSortRtt( uint32_t * pulRtt )
+        {
+            uint32_t ulValue;
+            BaseType_t x, y;
+
+            /* Insertion sort - there are only a few samples. */
+            for( x = 1; x < echoTHROUGHPUT_RTT_SAMPLES; x++ )
+            {
+                ulValue = pulRtt[ x ];
+
+                for( y = x; ( y > 0 ) && ( pulRtt[ y - 1 ] > ulValue ); y-- )
+                {
+                    pulRtt[ y ] = pulRtt[ y - 1 ];
+                }
+
+                pulRtt[ y ] = ulValue;
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static uint32_t prvKbitPerSecond( uint64_t ullBytes,
+                                          uint64_t ullElapsedUs )
+        {
+            return ( ullElapsedUs > 0U ) ? ( uint32_t ) ( ( ullBytes * 8000ULL ) / ullElapsedUs ) : 0U;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvReportThroughput( BaseType_t xInstance )
+        {
+            ThroughputResult_t * pxResult = &( xThroughputResults[ xInstance ] );
+            uint32_t * pulRtt = pxResult->ulRttUs;
+            uint32_t ulKbps, ulStalls = 0;
+            uint64_t ullBytes = 0, ullElapsedUs = 0;
+            BaseType_t x, xLast;
+
+            prvSortRtt( pulRtt );
+            ulKbps = prvKbitPerSecond( pxResult->ullBytesEchoed, pxResult->ullElapsedUs );
+
+            printf( "[%ld] %lu KB in %lu ms: %lu.%03lu Mbit/s, RTT us p50 %lu p90 %lu p99 %lu max %lu, stalls %lu\n",
+                    ( long ) xInstance,
+                    ( unsigned long ) ( pxResult->ullBytesEchoed / 1024U ),
+                    ( unsigned long ) ( pxResult->ullElapsedUs / 1000U ),
+                    ( unsigned long ) ( ulKbps / 1000U ),
+                    ( unsigned long ) ( ulKbps % 1000U ),
+                    ( unsigned long ) pulRtt[ ( echoTHROUGHPUT_RTT_SAMPLES * 50 ) / 100 ],
+                    ( unsigned long ) pulRtt[ ( echoTHROUGHPUT_RTT_SAMPLES * 90 ) / 100 ],
+                    ( unsigned long ) pulRtt[ ( echoTHROUGHPUT_RTT_SAMPLES * 99 ) / 100 ],
+                    ( unsigned long ) pulRtt[ echoTHROUGHPUT_RTT_SAMPLES - 1 ],
+                    ( unsigned long ) pxResult->ulStalls );
+
+            taskENTER_CRITICAL();
+            {
+                xStreamsReported++;
+                xLast = ( xStreamsReported == echoTHROUGHPUT_STREAMS ) ? pdTRUE : pdFALSE;
+
+                if( xLast != pdFALSE )
+                {
+                    xStreamsReported = 0;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( ( xLast != pdFALSE ) && ( echoTHROUGHPUT_STREAMS > 1 ) )
+            {
+                /* The streams ran concurrently, so the total rate is the total
+                 * data over the longest run. */
+                for( x = 0; x < echoTHROUGHPUT_STREAMS; x++ )
+                {
+                    ullBytes += xThroughputResults[ x ].ullBytesEchoed;
+                    ulStalls += xThroughputResults[ x ].ulStalls;
+
+                    if( xThroughputResults[ x ].ullElapsedUs > ullElapsedUs )
+                    {
+                        ullElapsedUs = xThroughputResults[ x ].ullElapsedUs;
+                    }
+                }
+
+                ulKbps = prvKbitPerSecond( ullBytes, ullElapsedUs );
+
+                printf( "[SUM] %lu KB in %lu ms: %lu.%03lu Mbit/s, stalls %lu\n",
+                        ( unsigned long ) ( ullBytes / 1024U ),
+                        ( unsigned long ) ( ullElapsedUs / 1000U ),
+                        ( unsigned long ) ( ulKbps / 1000U ),
+                        ( unsigned long ) ( ulKbps % 1000U ),
+                        ( unsigned long ) ulStalls );
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvThroughputClientTask( void * pvParameters )
+        {
+            Socket_t xSocket;
+            struct freertos_sockaddr xEchoServerAddress;
+            WinProperties_t xWinProps;
+            BaseType_t xInstance, xResult;
+            TickType_t xTimeOnEntering;
+
+            xInstance = ( BaseType_t ) pvParameters;
+
+            /* Buffers twice the window, so a full window of echoed data always
+             * fits in the receive buffer while the next window is sent. */
+            xWinProps.lTxBufSize = 2 * echoTHROUGHPUT_WINDOW_MSS * ipconfigTCP_MSS;
+            xWinProps.lTxWinSize = echoTHROUGHPUT_WINDOW_MSS;
+            xWinProps.lRxBufSize = 2 * echoTHROUGHPUT_WINDOW_MSS * ipconfigTCP_MSS;
+            xWinProps.lRxWinSize = echoTHROUGHPUT_WINDOW_MSS;
+
+            xEchoServerAddress.sin_port = FreeRTOS_htons( echoECHO_PORT );
+
+            #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+            {
+                xEchoServerAddress.sin_address.ulIP_IPv4 = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
+                                                                                     configECHO_SERVER_ADDR1,
+                                                                                     configECHO_SERVER_ADDR2,
+                                                                                     configECHO_SERVER_ADDR3 );
+            }
+            #else
+            {
+                xEchoServerAddress.sin_addr = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
+                                                                        configECHO_SERVER_ADDR1,
+                                                                        configECHO_SERVER_ADDR2,
+                                                                        configECHO_SERVER_ADDR3 );
+            }
+            #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+
+            xEchoServerAddress.sin_family = FREERTOS_AF_INET;
+
+            for( ; ; )
+            {
+                xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+                configASSERT( xSocket != FREERTOS_INVALID_SOCKET );
+
+                FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
+                FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, &xSendTimeOut, sizeof( xSendTimeOut ) );
+                FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_WIN_PROPERTIES, ( void * ) &xWinProps, sizeof( xWinProps ) );
+
+                if( FreeRTOS_connect( xSocket, &xEchoServerAddress, sizeof( xEchoServerAddress ) ) == 0 )
+                {
+                    ulConnections[ xInstance ]++;
+
+                    xResult = prvMeasureLatency( xSocket, xInstance );
+
+                    if( xResult == pdPASS )
+                    {
+                        xResult = prvMeasureThroughput( xSocket, xInstance );
+                    }
+
+                    if( xResult == pdPASS )
+                    {
+                        ulTxRxCycles[ xInstance ]++;
+                        prvReportThroughput( xInstance );
+                    }
+                    else
+                    {
+                        ulTxRxFailures[ xInstance ]++;
+                        printf( "[%ld] Throughput test failed %lu times.\n", ( long ) xInstance, ( unsigned long ) ulTxRxFailures[ xInstance ] );
+                    }
+
+                    /* Graceful close, as in prvEchoClientTask(). */
+                    FreeRTOS_shutdown( xSocket, FREERTOS_SHUT_RDWR );
+                    xTimeOnEntering = xTaskGetTickCount();
+
+                    do
+                    {
+                        if( FreeRTOS_recv( xSocket, &( cRxBuffers[ xInstance ][ 0 ] ), echoBUFFER_SIZES, 0 ) < 0 )
+                        {
+                            break;
+                        }
+                    } while( ( xTaskGetTickCount() - xTimeOnEntering ) < xReceiveTimeOut );
+                }
+
+                FreeRTOS_closesocket( xSocket );
+                vTaskDelay( echoLOOP_DELAY );
+            }
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* echoTHROUGHPUT_TEST */
+
     BaseType_t xAreSingleTaskTCPEchoClientsStillRunning( void )
     {
         static uint32_t ulLastEchoSocketCount[ echoNUM_ECHO_CLIENTS ] = { 0 }, ulLastConnections[ echoNUM_ECHO_CLIENTS ] = { 0 };
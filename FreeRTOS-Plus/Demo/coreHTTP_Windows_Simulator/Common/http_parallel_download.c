@@ -0,0 +1,604 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "http_parallel_download.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The maximum number of times a single range is requested before the
+ * download is abandoned.
+ */
+#define RANGE_MAX_ATTEMPTS                      ( 3U )
+
+/**
+ * @brief The HTTP status code returned for partial content.
+ */
+#define HTTP_STATUS_CODE_PARTIAL_CONTENT        ( 206 )
+
+/**
+ * @brief Field name of the HTTP range header to read from the server response.
+ */
+#define HTTP_CONTENT_RANGE_HEADER_FIELD         "Content-Range"
+
+/**
+ * @brief Length of the HTTP range header field.
+ */
+#define HTTP_CONTENT_RANGE_HEADER_FIELD_LENGTH  ( sizeof( HTTP_CONTENT_RANGE_HEADER_FIELD ) - 1 )
+
+/**
+ * @brief The length of the HTTP GET method.
+ */
+#define HTTP_METHOD_GET_LENGTH                  ( sizeof( HTTP_METHOD_GET ) - 1 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief State shared by the connection tasks of one download.
+ *
+ * Lives on the stack of the task that called parallelDownload(), which does not
+ * return until every connection task has finished with it.
+ */
+typedef struct ParallelDownload
+{
+    const ParallelDownloadConfig_t * pxConfig;
+    SemaphoreHandle_t xLock;   /**< Guards the members below and calls to the sink. */
+    TaskHandle_t xOwner;       /**< Task waiting in parallelDownload(). */
+    size_t xFileSize;
+    size_t xNextOffset;        /**< First byte not yet claimed by a connection. */
+    size_t xBytesStored;
+    uint32_t ulRequests;
+    uint32_t ulRetries;
+    BaseType_t xFailed;
+} ParallelDownload_t;
+
+/**
+ * @brief Per-connection state.
+ */
+typedef struct DownloadConnection
+{
+    ParallelDownload_t * pxDownload;
+    NetworkContext_t * pxNetworkContext;
+    BaseType_t xConnected;
+    size_t xRangeLength;       /**< Length of the next range this connection claims. */
+    uint8_t * pucHeaderBuffer;
+    uint8_t * pucResponseBuffer;
+    size_t xResponseBufferLength;
+} DownloadConnection_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Send a range request on a connection and receive the response into
+ * the connection's response buffer.
+ *
+ * @param[in] pxConnection The connection to use.
+ * @param[in] xStart The position of the first byte in the range.
+ * @param[in] xEnd The position of the last byte in the range, inclusive.
+ * @param[out] pxResponse The response, pointing into the connection's buffer.
+ *
+ * @return pdPASS if a partial content response was received; pdFAIL otherwise.
+ */
+static BaseType_t prvRequestRange( DownloadConnection_t * pxConnection,
+                                   size_t xStart,
+                                   size_t xEnd,
+                                   HTTPResponse_t * pxResponse );
+
+/**
+ * @brief Read the file size from the Content-Range header of a response.
+ *
+ * @param[in] pxResponse A partial content response.
+ * @param[out] pxFileSize The total size of the file.
+ *
+ * @return pdPASS if the size was found; pdFAIL otherwise.
+ */
+static BaseType_t prvReadFileSize( HTTPResponse_t * pxResponse,
+                                   size_t * pxFileSize );
+
+/**
+ * @brief Download the range starting at xOffset and hand it to the sink,
+ * reconnecting and retrying on failure.
+ *
+ * @param[in] pxConnection The connection to use.
+ * @param[in] xOffset The position of the first byte in the range.
+ * @param[in] xLength The length of the range.
+ *
+ * @return pdPASS if the range was stored; pdFAIL otherwise.
+ */
+static BaseType_t prvDownloadRange( DownloadConnection_t * pxConnection,
+                                    size_t xOffset,
+                                    size_t xLength );
+
+/**
+ * @brief Task that claims and downloads ranges over one connection until the
+ * whole file has been claimed or the download has failed.
+ *
+ * @param[in] pvParameters The #DownloadConnection_t of the connection.
+ */
+static void prvConnectionTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRequestRange( DownloadConnection_t * pxConnection,
+                                   size_t xStart,
+                                   size_t xEnd,
+                                   HTTPResponse_t * pxResponse )
+{
+    const ParallelDownloadConfig_t * pxConfig = pxConnection->pxDownload->pxConfig;
+    TransportInterface_t xTransportInterface = { 0 };
+    HTTPRequestInfo_t xRequestInfo = { 0 };
+    HTTPRequestHeaders_t xRequestHeaders = { 0 };
+    HTTPStatus_t xHTTPStatus;
+
+    xTransportInterface.pNetworkContext = pxConnection->pxNetworkContext;
+    xTransportInterface.send = pxConfig->xSend;
+    xTransportInterface.recv = pxConfig->xRecv;
+
+    xRequestInfo.pHost = pxConfig->pcHost;
+    xRequestInfo.hostLen = pxConfig->xHostLength;
+    xRequestInfo.pMethod = HTTP_METHOD_GET;
+    xRequestInfo.methodLen = HTTP_METHOD_GET_LENGTH;
+    xRequestInfo.pPath = pxConfig->pcPath;
+    xRequestInfo.pathLen = pxConfig->xPathLength;
+
+    /* Each connection sends all of its ranges over one TLS session. */
+    xRequestInfo.reqFlags = HTTP_REQUEST_KEEP_ALIVE_FLAG;
+
+    xRequestHeaders.pBuffer = pxConnection->pucHeaderBuffer;
+    xRequestHeaders.bufferLen = pxConfig->xHeaderBufferLength;
+
+    memset( pxResponse, 0, sizeof( HTTPResponse_t ) );
+    pxResponse->pBuffer = pxConnection->pucResponseBuffer;
+    pxResponse->bufferLen = pxConnection->xResponseBufferLength;
+
+    xHTTPStatus = HTTPClient_InitializeRequestHeaders( &xRequestHeaders, &xRequestInfo );
+
+    if( xHTTPStatus == HTTPSuccess )
+    {
+        xHTTPStatus = HTTPClient_AddRangeHeader( &xRequestHeaders,
+                                                 ( int32_t ) xStart,
+                                                 ( int32_t ) xEnd );
+    }
+
+    if( xHTTPStatus == HTTPSuccess )
+    {
+        xHTTPStatus = HTTPClient_Send( &xTransportInterface,
+                                       &xRequestHeaders,
+                                       NULL,
+                                       0,
+                                       pxResponse,
+                                       0 );
+    }
+
+    if( xHTTPStatus != HTTPSuccess )
+    {
+        LogWarn( ( "Range request for bytes %u to %u failed: Error=%s.",
+                   ( unsigned ) xStart,
+                   ( unsigned ) xEnd,
+                   HTTPClient_strerror( xHTTPStatus ) ) );
+    }
+    else if( pxResponse->statusCode != HTTP_STATUS_CODE_PARTIAL_CONTENT )
+    {
+        LogWarn( ( "Range request for bytes %u to %u received unexpected status code: %u.",
+                   ( unsigned ) xStart,
+                   ( unsigned ) xEnd,
+                   ( unsigned ) pxResponse->statusCode ) );
+        xHTTPStatus = HTTPInvalidResponse;
+    }
+
+    return ( xHTTPStatus == HTTPSuccess ) ? pdPASS : pdFAIL;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReadFileSize( HTTPResponse_t * pxResponse,
+                                   size_t * pxFileSize )
+{
+    HTTPStatus_t xHTTPStatus;
+    const char * pcContentRange = NULL;
+    size_t xContentRangeLength = 0;
+    size_t xFileSize = 0;
+    size_t i;
+    BaseType_t xStatus = pdFAIL;
+
+    /* The header will look like "Content-Range: bytes 0-0/FILESIZE". */
+    xHTTPStatus = HTTPClient_ReadHeader( pxResponse,
+                                         HTTP_CONTENT_RANGE_HEADER_FIELD,
+                                         HTTP_CONTENT_RANGE_HEADER_FIELD_LENGTH,
+                                         &pcContentRange,
+                                         &xContentRangeLength );
+
+    if( xHTTPStatus == HTTPSuccess )
+    {
+        for( i = 0; ( i < xContentRangeLength ) && ( pcContentRange[ i ] != '/' ); i++ )
+        {
+        }
+
+        for( i++; ( i < xContentRangeLength ) && ( pcContentRange[ i ] >= '0' ) && ( pcContentRange[ i ] <= '9' ); i++ )
+        {
+            xFileSize = ( xFileSize * 10U ) + ( size_t ) ( pcContentRange[ i ] - '0' );
+            xStatus = pdPASS;
+        }
+    }
+    else
+    {
+        LogError( ( "Failed to read Content-Range header from HTTP response: Error=%s.",
+                    HTTPClient_strerror( xHTTPStatus ) ) );
+    }
+
+    if( ( xStatus == pdPASS ) && ( xFileSize > 0U ) && ( xFileSize < ( size_t ) INT32_MAX ) )
+    {
+        *pxFileSize = xFileSize;
+    }
+    else
+    {
+        LogError( ( "Could not read the file size from Content-Range: %.*s.",
+                    ( int ) xContentRangeLength,
+                    ( pcContentRange != NULL ) ? pcContentRange : "" ) );
+        xStatus = pdFAIL;
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvDownloadRange( DownloadConnection_t * pxConnection,
+                                    size_t xOffset,
+                                    size_t xLength )
+{
+    ParallelDownload_t * pxDownload = pxConnection->pxDownload;
+    const ParallelDownloadConfig_t * pxConfig = pxDownload->pxConfig;
+    HTTPResponse_t xResponse;
+    TickType_t xStart, xElapsed;
+    BaseType_t xStatus = pdFAIL;
+    uint32_t ulAttempt;
+
+    for( ulAttempt = 0; ( ulAttempt < RANGE_MAX_ATTEMPTS ) && ( xStatus == pdFAIL ); ulAttempt++ )
+    {
+        if( ulAttempt > 0U )
+        {
+            xSemaphoreTake( pxDownload->xLock, portMAX_DELAY );
+            pxDownload->ulRetries++;
+            xSemaphoreGive( pxDownload->xLock );
+        }
+
+        if( pxConnection->xConnected == pdFALSE )
+        {
+            pxConnection->xConnected = connectToServerWithBackoffRetries( pxConfig->xConnect,
+                                                                          pxConnection->pxNetworkContext );
+
+            if( pxConnection->xConnected == pdFALSE )
+            {
+                break;
+            }
+        }
+
+        xStart = xTaskGetTickCount();
+        xStatus = prvRequestRange( pxConnection, xOffset, xOffset + xLength - 1U, &xResponse );
+        xElapsed = xTaskGetTickCount() - xStart;
+
+        if( ( xStatus == pdPASS ) && ( xResponse.bodyLen != xLength ) )
+        {
+            LogWarn( ( "Range at offset %u returned %u bytes instead of %u.",
+                       ( unsigned ) xOffset,
+                       ( unsigned ) xResponse.bodyLen,
+                       ( unsigned ) xLength ) );
+            xStatus = pdFAIL;
+        }
+
+        /* A failed exchange leaves the session in an unknown state, and S3
+         * closes a keep-alive connection after a number of requests. */
+        if( ( xStatus == pdFAIL ) ||
+            ( ( xResponse.respFlags & HTTP_RESPONSE_CONNECTION_CLOSE_FLAG ) != 0U ) )
+        {
+            pxConfig->xDisconnect( pxConnection->pxNetworkContext );
+            pxConnection->xConnected = pdFALSE;
+        }
+
+        if( xStatus == pdPASS )
+        {
+            xSemaphoreTake( pxDownload->xLock, portMAX_DELAY );
+
+            if( pxDownload->xFailed == pdFALSE )
+            {
+                xStatus = pxConfig->xSink( pxConfig->pvSinkContext, xOffset, xResponse.pBody, xResponse.bodyLen );
+                pxDownload->xBytesStored += ( xStatus == pdPASS ) ? xLength : 0U;
+                pxDownload->ulRequests++;
+            }
+
+            xSemaphoreGive( pxDownload->xLock );
+
+            if( xStatus == pdFAIL )
+            {
+                LogError( ( "Sink rejected the range at offset %u.", ( unsigned ) xOffset ) );
+
+                /* The sink failing is not something a retry will fix. */
+                break;
+            }
+
+            /* Grow the range while requests are dominated by round trips rather
+             * than by transfer time, and shrink it when they are slow. */
+            if( xElapsed < pxConfig->xTargetRangeTicks )
+            {
+                pxConnection->xRangeLength *= 2U;
+            }
+            else if( xElapsed > ( 2U * pxConfig->xTargetRangeTicks ) )
+            {
+                pxConnection->xRangeLength /= 2U;
+            }
+        }
+        else
+        {
+            pxConnection->xRangeLength /= 2U;
+        }
+
+        if( pxConnection->xRangeLength > pxConfig->xMaxRangeLength )
+        {
+            pxConnection->xRangeLength = pxConfig->xMaxRangeLength;
+        }
+        else if( pxConnection->xRangeLength < pxConfig->xMinRangeLength )
+        {
+            pxConnection->xRangeLength = pxConfig->xMinRangeLength;
+        }
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvConnectionTask( void * pvParameters )
+{
+    DownloadConnection_t * pxConnection = ( DownloadConnection_t * ) pvParameters;
+    ParallelDownload_t * pxDownload = pxConnection->pxDownload;
+    size_t xOffset, xLength;
+    BaseType_t xStatus = pdPASS;
+
+    while( xStatus == pdPASS )
+    {
+        /* Claim the next range of the file. */
+        xSemaphoreTake( pxDownload->xLock, portMAX_DELAY );
+
+        xOffset = pxDownload->xNextOffset;
+        xLength = pxDownload->xFileSize - xOffset;
+
+        if( xLength > pxConnection->xRangeLength )
+        {
+            xLength = pxConnection->xRangeLength;
+        }
+
+        if( pxDownload->xFailed != pdFALSE )
+        {
+            xLength = 0;
+        }
+
+        pxDownload->xNextOffset += xLength;
+
+        xSemaphoreGive( pxDownload->xLock );
+
+        if( xLength == 0U )
+        {
+            break;
+        }
+
+        xStatus = prvDownloadRange( pxConnection, xOffset, xLength );
+    }
+
+    if( xStatus == pdFAIL )
+    {
+        /* Stop the other connections from claiming further ranges. */
+        xSemaphoreTake( pxDownload->xLock, portMAX_DELAY );
+        pxDownload->xFailed = pdTRUE;
+        xSemaphoreGive( pxDownload->xLock );
+    }
+
+    /* pxDownload must not be touched once the owner has been notified. */
+    xTaskNotifyGive( pxDownload->xOwner );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t parallelDownload( const ParallelDownloadConfig_t * pxConfig,
+                             ParallelDownloadStats_t * pxStats )
+{
+    ParallelDownload_t xDownload = { 0 };
+    DownloadConnection_t * pxConnections = NULL;
+    DownloadConnection_t * pxConnection;
+    HTTPResponse_t xResponse;
+    UBaseType_t uxIndex, uxStarted = 0;
+    TickType_t xStartTime = xTaskGetTickCount();
+    BaseType_t xStatus = pdPASS;
+
+    assert( pxConfig != NULL );
+    assert( ( pxConfig->ppxNetworkContexts != NULL ) && ( pxConfig->uxConnectionCount > 0U ) );
+    assert( ( pxConfig->xMinRangeLength > 0U ) && ( pxConfig->xMinRangeLength <= pxConfig->xMaxRangeLength ) );
+
+    xDownload.pxConfig = pxConfig;
+    xDownload.xOwner = xTaskGetCurrentTaskHandle();
+    xDownload.xLock = xSemaphoreCreateMutex();
+
+    pxConnections = pvPortMalloc( pxConfig->uxConnectionCount * sizeof( DownloadConnection_t ) );
+
+    if( ( xDownload.xLock == NULL ) || ( pxConnections == NULL ) )
+    {
+        LogError( ( "Failed to allocate download state." ) );
+        xStatus = pdFAIL;
+    }
+    else
+    {
+        memset( pxConnections, 0, pxConfig->uxConnectionCount * sizeof( DownloadConnection_t ) );
+
+        for( uxIndex = 0; uxIndex < pxConfig->uxConnectionCount; uxIndex++ )
+        {
+            pxConnection = &pxConnections[ uxIndex ];
+            pxConnection->pxDownload = &xDownload;
+            pxConnection->pxNetworkContext = pxConfig->ppxNetworkContexts[ uxIndex ];
+            pxConnection->xConnected = pdFALSE;
+            pxConnection->xRangeLength = pxConfig->xMinRangeLength;
+
+            /* The response headers share the buffer with the body of the range. */
+            pxConnection->xResponseBufferLength = pxConfig->xMaxRangeLength + pxConfig->xHeaderBufferLength;
+            pxConnection->pucHeaderBuffer = pvPortMalloc( pxConfig->xHeaderBufferLength );
+            pxConnection->pucResponseBuffer = pvPortMalloc( pxConnection->xResponseBufferLength );
+
+            if( ( pxConnection->pucHeaderBuffer == NULL ) || ( pxConnection->pucResponseBuffer == NULL ) )
+            {
+                LogError( ( "Failed to allocate buffers for connection %u.", ( unsigned ) uxIndex ) );
+                xStatus = pdFAIL;
+            }
+        }
+    }
+
+    /* Learn the size of the file from a one byte request on the first
+     * connection, which then stays open for that connection's ranges. */
+    if( xStatus == pdPASS )
+    {
+        pxConnection = &pxConnections[ 0 ];
+        pxConnection->xConnected = connectToServerWithBackoffRetries( pxConfig->xConnect,
+                                                                      pxConnection->pxNetworkContext );
+        xStatus = pxConnection->xConnected;
+    }
+
+    if( xStatus == pdPASS )
+    {
+        xStatus = prvRequestRange( pxConnection, 0, 0, &xResponse );
+
+        if( xStatus == pdPASS )
+        {
+            xStatus = prvReadFileSize( &xResponse, &xDownload.xFileSize );
+        }
+
+        if( ( xResponse.respFlags & HTTP_RESPONSE_CONNECTION_CLOSE_FLAG ) != 0U )
+        {
+            pxConfig->xDisconnect( pxConnection->pxNetworkContext );
+            pxConnection->xConnected = pdFALSE;
+        }
+    }
+
+    if( xStatus == pdPASS )
+    {
+        LogInfo( ( "Downloading %u bytes over %u connections.",
+                   ( unsigned ) xDownload.xFileSize,
+                   ( unsigned ) pxConfig->uxConnectionCount ) );
+
+        for( uxIndex = 0; uxIndex < pxConfig->uxConnectionCount; uxIndex++ )
+        {
+            if( xTaskCreate( prvConnectionTask,
+                             "HTTPRange",
+                             pxConfig->ulStackDepth,
+                             &pxConnections[ uxIndex ],
+                             pxConfig->uxPriority,
+                             NULL ) != pdPASS )
+            {
+                /* The connections already started will share the work. */
+                LogWarn( ( "Could only start %u of %u connection tasks.",
+                           ( unsigned ) uxStarted,
+                           ( unsigned ) pxConfig->uxConnectionCount ) );
+                break;
+            }
+
+            uxStarted++;
+        }
+
+        /* Wait for every connection task to finish with the shared state. */
+        for( uxIndex = 0; uxIndex < uxStarted; uxIndex++ )
+        {
+            ( void ) ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+        }
+
+        if( ( xDownload.xFailed != pdFALSE ) || ( xDownload.xBytesStored != xDownload.xFileSize ) )
+        {
+            LogError( ( "Download failed after storing %u of %u bytes.",
+                        ( unsigned ) xDownload.xBytesStored,
+                        ( unsigned ) xDownload.xFileSize ) );
+            xStatus = pdFAIL;
+        }
+    }
+
+    if( pxConnections != NULL )
+    {
+        for( uxIndex = 0; uxIndex < pxConfig->uxConnectionCount; uxIndex++ )
+        {
+            pxConnection = &pxConnections[ uxIndex ];
+
+            if( pxConnection->xConnected != pdFALSE )
+            {
+                pxConfig->xDisconnect( pxConnection->pxNetworkContext );
+            }
+
+            vPortFree( pxConnection->pucHeaderBuffer );
+            vPortFree( pxConnection->pucResponseBuffer );
+        }
+
+        vPortFree( pxConnections );
+    }
+
+    if( xDownload.xLock != NULL )
+    {
+        vSemaphoreDelete( xDownload.xLock );
+    }
+
+    if( pxStats != NULL )
+    {
+        pxStats->xFileSize = xDownload.xFileSize;
+        pxStats->ulRequests = xDownload.ulRequests;
+        pxStats->ulRetries = xDownload.ulRetries;
+        pxStats->xElapsedTicks = xTaskGetTickCount() - xStartTime;
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t parallelDownloadFileSink( void * pvSinkContext,
+                                     size_t xOffset,
+                                     const uint8_t * pucData,
+                                     size_t xLength )
+{
+    FILE * pxFile = ( FILE * ) pvSinkContext;
+    BaseType_t xStatus = pdFAIL;
+
+    if( ( pxFile != NULL ) &&
+        ( fseek( pxFile, ( long ) xOffset, SEEK_SET ) == 0 ) &&
+        ( fwrite( pucData, 1, xLength, pxFile ) == xLength ) )
+    {
+        xStatus = pdPASS;
+    }
+
+    return xStatus;
+}
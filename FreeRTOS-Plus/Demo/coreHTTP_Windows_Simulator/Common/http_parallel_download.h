@@ -0,0 +1,152 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef HTTP_PARALLEL_DOWNLOAD_H
+#define HTTP_PARALLEL_DOWNLOAD_H
+
+/* Standard includes. */
+#include <stdio.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* HTTP API header. */
+#include "core_http_client.h"
+
+/* Common HTTP demo utilities. */
+#include "http_demo_utils.h"
+
+/**
+ * @brief Function pointer for closing a connection opened by a
+ * #TransportConnect_t function.
+ *
+ * @param[in] pxNetworkContext Implementation-defined network context.
+ */
+typedef void ( * TransportDisconnect_t )( NetworkContext_t * pxNetworkContext );
+
+/**
+ * @brief Function pointer for consuming a downloaded range.
+ *
+ * The download engine calls the sink once for every range it receives, straight
+ * from the response buffer of the connection that received it. Ranges arrive
+ * in whatever order the connections complete them. Calls are serialized by the
+ * engine, so the sink does not need to be thread safe.
+ *
+ * To stream a firmware image into the OTA PAL, the sink can call
+ * otaPal_WriteBlock() for each otaconfigFILE_BLOCK_SIZE slice of the range.
+ *
+ * @param[in] pvSinkContext The pvSinkContext member of #ParallelDownloadConfig_t.
+ * @param[in] xOffset Offset of the first byte of pucData within the file.
+ * @param[in] pucData The downloaded bytes.
+ * @param[in] xLength Number of bytes in pucData.
+ *
+ * @return pdPASS if the data was stored; pdFAIL to abort the download.
+ */
+typedef BaseType_t ( * DownloadSink_t )( void * pvSinkContext,
+                                         size_t xOffset,
+                                         const uint8_t * pucData,
+                                         size_t xLength );
+
+/**
+ * @brief Parameters for parallelDownload().
+ */
+typedef struct ParallelDownloadConfig
+{
+    const char * pcHost;                     /**< Host name sent in the Host header. */
+    size_t xHostLength;                      /**< Length of pcHost. */
+    const char * pcPath;                     /**< Request path, including any query. */
+    size_t xPathLength;                      /**< Length of pcPath. */
+
+    NetworkContext_t ** ppxNetworkContexts;  /**< One unconnected network context per connection. */
+    UBaseType_t uxConnectionCount;           /**< Number of entries in ppxNetworkContexts. */
+    TransportConnect_t xConnect;             /**< Opens a connection on a network context. */
+    TransportDisconnect_t xDisconnect;       /**< Closes a connection opened by xConnect. */
+    TransportSend_t xSend;                   /**< Transport send function for the HTTP client. */
+    TransportRecv_t xRecv;                   /**< Transport receive function for the HTTP client. */
+
+    DownloadSink_t xSink;                    /**< Consumer of the downloaded ranges. */
+    void * pvSinkContext;                    /**< Passed unchanged to xSink. */
+
+    size_t xMinRangeLength;                  /**< First and smallest range requested by a connection. */
+    size_t xMaxRangeLength;                  /**< Largest range requested by a connection. */
+    TickType_t xTargetRangeTicks;            /**< Ranges grow while a request completes faster than this. */
+    size_t xHeaderBufferLength;              /**< Room for request headers, and for response headers on top of a range. */
+    uint32_t ulStackDepth;                   /**< Stack depth of each connection task. */
+    UBaseType_t uxPriority;                  /**< Priority of each connection task. */
+} ParallelDownloadConfig_t;
+
+/**
+ * @brief Outcome of parallelDownload().
+ */
+typedef struct ParallelDownloadStats
+{
+    size_t xFileSize;          /**< Size of the file reported by the server. */
+    uint32_t ulRequests;       /**< Range requests that completed successfully. */
+    uint32_t ulRetries;        /**< Range requests that had to be sent again. */
+    TickType_t xElapsedTicks;  /**< Time from the first connection to the last range. */
+} ParallelDownloadStats_t;
+
+/**
+ * @brief Download a file over several connections at once using HTTP range
+ * requests.
+ *
+ * The size of the file is read from the Content-Range header of a one byte
+ * request. One task per connection then claims the next unrequested range of
+ * the file, requests it over its own keep-alive connection and passes the body
+ * to the sink. Each connection starts with ranges of xMinRangeLength bytes and
+ * doubles the length while requests complete within xTargetRangeTicks, up to
+ * xMaxRangeLength, so that high-latency links spend their time transferring
+ * data rather than waiting on round trips. A failed range is retried on a fresh
+ * connection, and a connection the server asks to close is reopened.
+ *
+ * The calling task blocks until the whole file has been passed to the sink or
+ * the download fails.
+ *
+ * @param[in] pxConfig Download parameters.
+ * @param[out] pxStats Optional statistics about the download, may be NULL.
+ *
+ * @return pdPASS if every byte of the file was stored by the sink; pdFAIL otherwise.
+ */
+BaseType_t parallelDownload( const ParallelDownloadConfig_t * pxConfig,
+                             ParallelDownloadStats_t * pxStats );
+
+/**
+ * @brief A #DownloadSink_t that writes each range to its offset in a file.
+ *
+ * @param[in] pvSinkContext The FILE * to write to, opened for binary writing.
+ * @param[in] xOffset Offset of the first byte of pucData within the file.
+ * @param[in] pucData The downloaded bytes.
+ * @param[in] xLength Number of bytes in pucData.
+ *
+ * @return pdPASS if all bytes were written; pdFAIL otherwise.
+ */
+BaseType_t parallelDownloadFileSink( void * pvSinkContext,
+                                     size_t xOffset,
+                                     const uint8_t * pucData,
+                                     size_t xLength );
+
+#endif /* ifndef HTTP_PARALLEL_DOWNLOAD_H */
@@ -124,28 +124,46 @@ extern void vLoggingPrintf( const char * pcFormatString,
 #define democonfigTRANSPORT_SEND_RECV_TIMEOUT_MS    ( 5000 )
 
 /**
- * @brief The length in bytes of the user buffer.
+ * @brief The length in bytes of the buffer used for request headers.
  *
- * @note A portion of the user buffer will be used to store the response header,
- * so the length of the response body returned on any given range request will
- * be less than democonfigUSER_BUFFER_LENGTH. We don't expect S3 to send more
- * than 1024 bytes of headers.
+ * @note The same amount of space is reserved for the response headers on top
+ * of the largest range in each connection's response buffer. We don't expect
+ * S3 to send more than 1024 bytes of headers, but the request headers include
+ * the long query of the pre-signed URL.
  */
 #define democonfigUSER_BUFFER_LENGTH                ( 2048 )
 
 /**
- * @brief The size of the range of the file to download, with each request.
+ * @brief The size of the first range of the file requested on each connection.
  *
- * @note This should account for the response headers that will also be stored
- * in the user buffer. We don't expect S3 to send more than 1024 bytes of
- * headers.
+ * @note Ranges grow from this size while requests complete quickly.
  */
 #define democonfigRANGE_REQUEST_LENGTH              ( 1024 )
 
 /**
- * @brief The number of items that can be held in each queue.
+ * @brief The largest range of the file requested on a connection.
+ *
+ * @note Each connection allocates a response buffer of this size plus
+ * democonfigUSER_BUFFER_LENGTH.
+ */
+#define democonfigMAX_RANGE_REQUEST_LENGTH          ( 64 * 1024 )
+
+/**
+ * @brief Ranges on a connection double in size while a request completes in
+ * less than this many milliseconds, and halve when it takes more than twice as
+ * long.
+ */
+#define democonfigTARGET_RANGE_REQUEST_MS           ( 1000 )
+
+/**
+ * @brief The number of TLS connections the file is downloaded over at once.
+ */
+#define democonfigNUM_CONNECTIONS                   ( 4 )
+
+/**
+ * @brief The file the downloaded S3 object is written to.
  */
-#define democonfigQUEUE_SIZE                        ( 10 )
+#define democonfigDOWNLOAD_FILE_PATH                "s3_download.bin"
 
 /**
  * @brief Set the stack size of the main demo task.
@@ -122,4 +122,22 @@ extern void vLoggingPrintf( const char * pcFormatString,
  */
 #define MQTT_COMMAND_CONTEXTS_POOL_SIZE         10
 
+/**
+ * @brief Set above 0 to carry commands to the agent in a stream buffer so the
+ * agent drains up to this many pending commands per read.  0 uses a queue.
+ */
+#define MQTT_AGENT_MESSAGE_BATCH_LENGTH         0
+
+/**
+ * @brief Set above 0 to give commands other than PUBLISH their own queue of
+ * this length, served before any queued PUBLISH commands.  0 uses one lane.
+ */
+#define MQTT_AGENT_CONTROL_QUEUE_LENGTH         0
+
+/**
+ * @brief Number of PUBLISH payload buffers the agent can take ownership of.
+ * 0 disables the payload pool.  See freertos_command_pool.h.
+ */
+#define MQTT_AGENT_PUBLISH_PAYLOAD_POOL_SIZE    0
+
 #endif /* ifndef CORE_MQTT_CONFIG_H */
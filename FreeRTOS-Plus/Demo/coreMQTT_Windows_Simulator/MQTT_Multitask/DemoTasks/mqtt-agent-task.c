@@ -491,6 +491,7 @@ static MQTTStatus_t prvMQTTInit( void )
     MQTTFixedBuffer_t xFixedBuffer = { .pBuffer = xNetworkBuffer, .size = MQTT_AGENT_NETWORK_BUFFER_SIZE };
     static uint8_t staticQueueStorageArea[ MQTT_AGENT_COMMAND_QUEUE_LENGTH * sizeof( MQTTAgentCommand_t * ) ];
     static StaticQueue_t staticQueueStructure;
+    bool xStatus;
     MQTTAgentMessageInterface_t messageInterface =
     {
         .pMsgCtx        = NULL,
@@ -501,9 +502,9 @@ static MQTTStatus_t prvMQTTInit( void )
     };
 
     LogDebug( ( "Creating command queue." ) );
-    xCommandQueue.queue = xQueueCreate( MQTT_AGENT_COMMAND_QUEUE_LENGTH,
-                                        sizeof( MQTTAgentCommand_t * ) );
-    configASSERT( xCommandQueue.queue );
+    xStatus = Agent_InitializeMessageContext( &xCommandQueue, MQTT_AGENT_COMMAND_QUEUE_LENGTH );
+    configASSERT( xStatus );
+    ( void ) xStatus;
     messageInterface.pMsgCtx = &xCommandQueue;
 
     /* Initialize the task pool. */
@@ -894,7 +895,7 @@ static void prvMQTTClientSocketWakeupCallback( Socket_t pxSocket )
 
     /* A socket used by the MQTT task may need attention.  Send an event
      * to the MQTT task to make sure the task is not blocked on xCommandQueue. */
-    if( ( uxQueueMessagesWaiting( xCommandQueue.queue ) == 0U ) && ( FreeRTOS_recvcount( pxSocket ) > 0 ) )
+    if( ( Agent_MessagesPending( &xCommandQueue ) == false ) && ( FreeRTOS_recvcount( pxSocket ) > 0 ) )
     {
         /* Don't block as this is called from the context of the IP task. */
         xCommandParams.blockTimeMs = 0U;
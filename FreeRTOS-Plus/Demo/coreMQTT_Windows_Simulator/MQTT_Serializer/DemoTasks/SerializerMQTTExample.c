@@ -34,7 +34,9 @@
  * send them over the connection established using FreeRTOS sockets.
  * The example is single threaded and uses statically allocated memory;
  * it uses QOS0 and therefore does not implement any retransmission
- * mechanism for Publish messages.
+ * mechanism for Publish messages. Incoming packets are parsed in place in
+ * the receive stream of the socket where possible, see
+ * mqttexampleZERO_COPY_RECEIVE.
  *
  * !!! NOTE !!!
  * This MQTT demo does not authenticate the server or the client.
@@ -169,6 +171,19 @@
  */
 #define mqttexampleMAX_SOCKET_SHUTDOWN_LOOPS        ( 3 )
 
+/**
+ * @brief Set to 1 to parse incoming packets in place in the receive stream of
+ * the TCP socket instead of copying them into #ucSharedBuffer first.
+ *
+ * A packet is parsed in place when it is stored contiguously in the receive
+ * stream, which then also allows packets larger than #ucSharedBuffer if the
+ * receive buffer of the socket can hold them. A packet that wraps around the
+ * end of the circular receive stream is copied as before.
+ */
+#ifndef mqttexampleZERO_COPY_RECEIVE
+    #define mqttexampleZERO_COPY_RECEIVE            ( 1 )
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -296,6 +311,10 @@ static void prvMQTTProcessResponse( MQTTPacketInfo_t * pxIncomingPacket,
  *
  * @param[in] pxPublishInfo is a pointer to structure containing deserialized
  * Publish message.
+ *
+ * @note The topic name and payload point into the buffer the packet was
+ * received in, which may be the receive stream of the socket. They are only
+ * valid until this function returns.
  */
 static void prvMQTTProcessIncomingPublish( MQTTPublishInfo_t * pxPublishInfo );
 
@@ -308,6 +327,38 @@ static void prvMQTTProcessIncomingPublish( MQTTPublishInfo_t * pxPublishInfo );
  */
 static void prvMQTTProcessIncomingPacket( Socket_t xMQTTSocket );
 
+/**
+ * @brief Receive the remaining bytes of an incoming packet.
+ *
+ * If #mqttexampleZERO_COPY_RECEIVE is 1 and the packet is stored contiguously
+ * in the receive stream of the socket, pxIncomingPacket->pRemainingData is set
+ * to point into the stream and nothing is copied. The packet then remains in
+ * the stream until it is released with prvReleaseIncomingPacket(). Otherwise
+ * the packet is copied into #ucSharedBuffer.
+ *
+ * @param[in] xMQTTSocket is a TCP socket that is connected to an MQTT broker.
+ * @param[in,out] pxIncomingPacket The packet whose type and remaining length
+ * have been read.
+ *
+ * @return pdTRUE if the packet is parsed in place and must be released;
+ * pdFALSE if it was copied.
+ */
+static BaseType_t prvReceiveIncomingPacket( Socket_t xMQTTSocket,
+                                            MQTTPacketInfo_t * pxIncomingPacket );
+
+/**
+ * @brief Release a packet received in place by prvReceiveIncomingPacket().
+ *
+ * This removes the packet from the receive stream of the socket so the TCP
+ * stack can reuse the space. Nothing that points into the packet may be used
+ * afterwards.
+ *
+ * @param[in] xMQTTSocket is the TCP socket the packet was received on.
+ * @param[in] pxIncomingPacket The packet to release.
+ */
+static void prvReleaseIncomingPacket( Socket_t xMQTTSocket,
+                                      const MQTTPacketInfo_t * pxIncomingPacket );
+
 /**
  * @brief The transport receive wrapper function supplied to the MQTT library for
  * receiving type and length of an incoming MQTT packet.
@@ -1204,11 +1255,72 @@ static void prvMQTTProcessIncomingPublish( MQTTPublishInfo_t * pxPublishInfo )
 
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvReceiveIncomingPacket( Socket_t xMQTTSocket,
+                                            MQTTPacketInfo_t * pxIncomingPacket )
+{
+    BaseType_t xInPlace = pdFALSE;
+    BaseType_t xStatus;
+
+    #if ( mqttexampleZERO_COPY_RECEIVE == 1 )
+    {
+        uint8_t * pucData = NULL;
+
+        /* Get a pointer to the bytes waiting in the receive stream. With
+         * FREERTOS_ZERO_COPY nothing is consumed from the stream, and the
+         * returned count is the number of bytes stored contiguously from
+         * pucData on. */
+        xStatus = FreeRTOS_recv( xMQTTSocket,
+                                 ( void * ) &pucData,
+                                 pxIncomingPacket->remainingLength,
+                                 FREERTOS_ZERO_COPY );
+
+        if( xStatus >= ( BaseType_t ) pxIncomingPacket->remainingLength )
+        {
+            pxIncomingPacket->pRemainingData = pucData;
+            xInPlace = pdTRUE;
+        }
+    }
+    #endif /* if ( mqttexampleZERO_COPY_RECEIVE == 1 ) */
+
+    if( xInPlace == pdFALSE )
+    {
+        /* The packet wraps around the end of the receive stream, or has not
+         * fully arrived yet, so copy it into the statically allocated buffer. */
+        configASSERT( pxIncomingPacket->remainingLength <= mqttexampleSHARED_BUFFER_SIZE );
+
+        xStatus = FreeRTOS_recv( xMQTTSocket,
+                                 ( void * ) xBuffer.pBuffer,
+                                 pxIncomingPacket->remainingLength, 0 );
+        configASSERT( xStatus == ( BaseType_t ) pxIncomingPacket->remainingLength );
+        pxIncomingPacket->pRemainingData = xBuffer.pBuffer;
+    }
+
+    return xInPlace;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseIncomingPacket( Socket_t xMQTTSocket,
+                                      const MQTTPacketInfo_t * pxIncomingPacket )
+{
+    BaseType_t xStatus;
+
+    /* Reading with a NULL buffer consumes the bytes without copying them. */
+    xStatus = FreeRTOS_recv( xMQTTSocket,
+                             NULL,
+                             pxIncomingPacket->remainingLength,
+                             0 );
+    configASSERT( xStatus == ( BaseType_t ) pxIncomingPacket->remainingLength );
+
+    /* Remove compiler warnings in case configASSERT() is not defined. */
+    ( void ) xStatus;
+}
+/*-----------------------------------------------------------*/
+
 static void prvMQTTProcessIncomingPacket( Socket_t xMQTTSocket )
 {
     MQTTStatus_t xResult;
     MQTTPacketInfo_t xIncomingPacket;
-    BaseType_t xStatus;
+    BaseType_t xInPlace = pdFALSE;
     MQTTPublishInfo_t xPublishInfo;
     uint16_t usPacketId;
     NetworkContext_t xNetworkContext;
@@ -1230,20 +1342,16 @@ static void prvMQTTProcessIncomingPacket( Socket_t xMQTTSocket )
     if( xResult != MQTTNoDataAvailable )
     {
         configASSERT( xResult == MQTTSuccess );
-        configASSERT( xIncomingPacket.remainingLength <= mqttexampleSHARED_BUFFER_SIZE );
 
         /* Current implementation expects an incoming Publish and three different
          * responses ( SUBACK, PINGRESP and UNSUBACK ). */
 
-        /* Receive the remaining bytes. In case of PINGRESP, remaining length will be zero.
-         * Skip reading from network for remaining length zero. */
+        /* Receive the remaining bytes, in place in the receive stream of the
+         * socket where possible. In case of PINGRESP, remaining length will be
+         * zero. Skip reading from network for remaining length zero. */
         if( xIncomingPacket.remainingLength > 0 )
         {
-            xStatus = FreeRTOS_recv( xMQTTSocket,
-                                     ( void * ) xBuffer.pBuffer,
-                                     xIncomingPacket.remainingLength, 0 );
-            configASSERT( xStatus == ( BaseType_t ) xIncomingPacket.remainingLength );
-            xIncomingPacket.pRemainingData = xBuffer.pBuffer;
+            xInPlace = prvReceiveIncomingPacket( xMQTTSocket, &xIncomingPacket );
         }
 
         /* Check if the incoming packet is a publish packet. */
@@ -1281,6 +1389,13 @@ static void prvMQTTProcessIncomingPacket( Socket_t xMQTTSocket )
             /* Process the response. */
             prvMQTTProcessResponse( &xIncomingPacket, usPacketId );
         }
+
+        /* The packet has been processed, so a packet parsed in place can now
+         * be removed from the receive stream. */
+        if( xInPlace == pdTRUE )
+        {
+            prvReleaseIncomingPacket( xMQTTSocket, &xIncomingPacket );
+        }
     }
 }
 
@@ -27,6 +27,11 @@
 /**
  * @file mbedtls_bio_tcp_sockets_wrapper.c
  * @brief Implements mbed TLS platform send/receive functions for the TCP sockets wrapper.
+ *
+ * @note Each record is copied once, between the mbed TLS record buffer and
+ * the socket stream buffer. Zero-copy socket calls would not remove that copy:
+ * mbed TLS encrypts and decrypts in its own record buffers, so the data would
+ * still have to be copied into or out of the stream buffer.
  */
 
 /* MbedTLS includes. */
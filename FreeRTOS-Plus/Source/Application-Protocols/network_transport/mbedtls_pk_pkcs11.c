@@ -52,6 +52,11 @@
 
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
+#include "mbedtls_pkcs11.h"
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
 
 /*-----------------------------------------------------------*/
 
@@ -74,6 +79,62 @@ typedef struct P11RsaCtx
     P11PkCtx_t xP11PkCtx;
 } P11RsaCtx_t;
 
+/**
+ * @brief A label and class to object handle mapping. Zero is the unused state.
+ */
+typedef struct P11ObjectCacheEntry
+{
+    CK_OBJECT_HANDLE xHandle;                            /**< @brief CK_INVALID_HANDLE when unused. */
+    CK_OBJECT_CLASS xClass;                              /**< @brief Class of the object. */
+    BaseType_t xHasKeyType;                              /**< @brief pdTRUE once xKeyType is known. */
+    CK_KEY_TYPE xKeyType;                                /**< @brief Key type of a private key. */
+    char cLabel[ pkcs11configMAX_LABEL_LENGTH + 1 ];     /**< @brief Label of the object. */
+} P11ObjectCacheEntry_t;
+
+/**
+ * @brief Object handles and the persistent session. Zero is the initialized,
+ * empty state. The entries and flags are accessed in critical sections; the
+ * session handle only by the task that has it borrowed.
+ */
+typedef struct P11ObjectCache
+{
+    P11ObjectCacheEntry_t xEntries[ MBEDTLS_PKCS11_OBJECT_CACHE_SIZE ]; /**< @brief Cached handles. */
+    size_t uxNextEntry;                                                 /**< @brief Entry replaced on the next miss. */
+    uint32_t ulGeneration;                                              /**< @brief Count of invalidations. */
+    BaseType_t xIsSessionInUse;                                         /**< @brief pdTRUE while xSession is borrowed. */
+    BaseType_t xIsSessionStale;                                         /**< @brief Close xSession when it is returned. */
+    CK_SESSION_HANDLE xSession;                                         /**< @brief The persistent session. */
+} P11ObjectCache_t;
+
+static P11ObjectCache_t xObjectCache;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Look up the cached key type of a private key.
+ *
+ * @param xPkHandle Handle of the private key.
+ * @param pxKeyType Set to the key type if it is cached.
+ * @return pdTRUE if the key type was cached.
+ */
+static BaseType_t prvGetCachedKeyType( CK_OBJECT_HANDLE xPkHandle,
+                                       CK_KEY_TYPE * pxKeyType );
+
+/**
+ * @brief Remember the key type of a cached private key.
+ *
+ * @param xPkHandle Handle of the private key.
+ * @param xKeyType Its key type.
+ */
+static void prvSetCachedKeyType( CK_OBJECT_HANDLE xPkHandle,
+                                 CK_KEY_TYPE xKeyType );
+
+/**
+ * @brief Close the persistent session, if it is open.
+ * Only called by the task that has it borrowed.
+ */
+static void prvCloseSession( void );
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -309,6 +370,10 @@ CK_RV xPKCS11_initMbedtlsPkContext( mbedtls_pk_context * pxMbedtlsPkCtx,
     {
         xResult = CKR_FUNCTION_FAILED;
     }
+    else if( prvGetCachedKeyType( xPkHandle, &xKeyType ) == pdTRUE )
+    {
+        /* Key type already known. */
+    }
     /* Determine key type */
     else
     {
@@ -323,6 +388,11 @@ CK_RV xPKCS11_initMbedtlsPkContext( mbedtls_pk_context * pxMbedtlsPkCtx,
                                                        xPkHandle,
                                                        &xAttrTemplate,
                                                        sizeof( xAttrTemplate ) / sizeof( CK_ATTRIBUTE ) );
+
+        if( xResult == CKR_OK )
+        {
+            prvSetCachedKeyType( xPkHandle, xKeyType );
+        }
     }
 
     if( xResult == CKR_OK )
@@ -387,6 +457,277 @@ CK_RV xPKCS11_initMbedtlsPkContext( mbedtls_pk_context * pxMbedtlsPkCtx,
 
 /*-----------------------------------------------------------*/
 
+CK_RV xPKCS11_FindObjectCached( CK_SESSION_HANDLE xSessionHandle,
+                                const char * pcLabelName,
+                                CK_OBJECT_CLASS xClass,
+                                CK_OBJECT_HANDLE_PTR pxHandle )
+{
+    CK_RV xResult = CKR_OK;
+    size_t uxLabelLength = 0;
+    size_t uxIndex = 0;
+    uint32_t ulGeneration = 0;
+    P11ObjectCacheEntry_t * pxEntry = NULL;
+
+    if( ( pcLabelName == NULL ) || ( pxHandle == NULL ) )
+    {
+        xResult = CKR_ARGUMENTS_BAD;
+    }
+    else
+    {
+        uxLabelLength = strnlen( pcLabelName, pkcs11configMAX_LABEL_LENGTH );
+        *pxHandle = CK_INVALID_HANDLE;
+
+        taskENTER_CRITICAL();
+        {
+            for( uxIndex = 0; uxIndex < MBEDTLS_PKCS11_OBJECT_CACHE_SIZE; uxIndex++ )
+            {
+                pxEntry = &( xObjectCache.xEntries[ uxIndex ] );
+
+                if( ( pxEntry->xHandle != CK_INVALID_HANDLE ) &&
+                    ( pxEntry->xClass == xClass ) &&
+                    ( strncmp( pxEntry->cLabel, pcLabelName, uxLabelLength ) == 0 ) &&
+                    ( pxEntry->cLabel[ uxLabelLength ] == '\0' ) )
+                {
+                    *pxHandle = pxEntry->xHandle;
+                    break;
+                }
+            }
+
+            ulGeneration = xObjectCache.ulGeneration;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    if( ( xResult == CKR_OK ) && ( *pxHandle == CK_INVALID_HANDLE ) )
+    {
+        xResult = xFindObjectWithLabelAndClass( xSessionHandle,
+                                                ( char * ) pcLabelName,
+                                                uxLabelLength,
+                                                xClass,
+                                                pxHandle );
+
+        /* Objects that do not exist yet are not cached, so provisioning them
+         * later needs no invalidation. */
+        if( ( xResult == CKR_OK ) && ( *pxHandle != CK_INVALID_HANDLE ) )
+        {
+            taskENTER_CRITICAL();
+            {
+                /* Drop the result if the cache was invalidated meanwhile. */
+                if( ulGeneration == xObjectCache.ulGeneration )
+                {
+                    pxEntry = &( xObjectCache.xEntries[ xObjectCache.uxNextEntry ] );
+                    pxEntry->xHandle = *pxHandle;
+                    pxEntry->xClass = xClass;
+                    pxEntry->xHasKeyType = pdFALSE;
+                    ( void ) memcpy( pxEntry->cLabel, pcLabelName, uxLabelLength );
+                    pxEntry->cLabel[ uxLabelLength ] = '\0';
+
+                    xObjectCache.uxNextEntry = ( xObjectCache.uxNextEntry + 1U ) % MBEDTLS_PKCS11_OBJECT_CACHE_SIZE;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+CK_RV xPKCS11_BorrowSession( CK_SESSION_HANDLE * pxSessionHandle )
+{
+    CK_RV xResult = CKR_OK;
+    BaseType_t xIsBorrowed = pdFALSE;
+
+    if( pxSessionHandle == NULL )
+    {
+        xResult = CKR_ARGUMENTS_BAD;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        {
+            if( xObjectCache.xIsSessionInUse == pdFALSE )
+            {
+                xObjectCache.xIsSessionInUse = pdTRUE;
+                xIsBorrowed = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xIsBorrowed == pdFALSE )
+        {
+            xResult = CKR_SESSION_COUNT;
+        }
+    }
+
+    if( ( xResult == CKR_OK ) && ( xObjectCache.xSession == CK_INVALID_HANDLE ) )
+    {
+        xResult = xInitializePkcs11Session( &( xObjectCache.xSession ) );
+
+        if( xResult != CKR_OK )
+        {
+            LogError( ( "Failed to open the persistent PKCS #11 session." ) );
+            xObjectCache.xSession = CK_INVALID_HANDLE;
+            vPKCS11_ReturnSession();
+        }
+    }
+
+    if( xResult == CKR_OK )
+    {
+        *pxSessionHandle = xObjectCache.xSession;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+void vPKCS11_ReturnSession( void )
+{
+    BaseType_t xIsStale = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        xIsStale = xObjectCache.xIsSessionStale;
+        xObjectCache.xIsSessionStale = pdFALSE;
+    }
+    taskEXIT_CRITICAL();
+
+    if( xIsStale == pdTRUE )
+    {
+        prvCloseSession();
+    }
+
+    taskENTER_CRITICAL();
+    {
+        xObjectCache.xIsSessionInUse = pdFALSE;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+void vPKCS11_InvalidateObjectCache( void )
+{
+    BaseType_t xIsBorrowed = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        ( void ) memset( xObjectCache.xEntries, 0, sizeof( xObjectCache.xEntries ) );
+        xObjectCache.uxNextEntry = 0;
+        xObjectCache.ulGeneration++;
+
+        if( xObjectCache.xIsSessionInUse == pdFALSE )
+        {
+            xObjectCache.xIsSessionInUse = pdTRUE;
+            xIsBorrowed = pdTRUE;
+        }
+        else
+        {
+            /* Closed by the borrower when it is returned. */
+            xObjectCache.xIsSessionStale = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xIsBorrowed == pdTRUE )
+    {
+        prvCloseSession();
+
+        taskENTER_CRITICAL();
+        {
+            xObjectCache.xIsSessionInUse = pdFALSE;
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t ulPKCS11_GetObjectCacheGeneration( void )
+{
+    uint32_t ulGeneration;
+
+    taskENTER_CRITICAL();
+    {
+        ulGeneration = xObjectCache.ulGeneration;
+    }
+    taskEXIT_CRITICAL();
+
+    return ulGeneration;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvGetCachedKeyType( CK_OBJECT_HANDLE xPkHandle,
+                                       CK_KEY_TYPE * pxKeyType )
+{
+    BaseType_t xIsCached = pdFALSE;
+    size_t uxIndex = 0;
+
+    taskENTER_CRITICAL();
+    {
+        for( uxIndex = 0; uxIndex < MBEDTLS_PKCS11_OBJECT_CACHE_SIZE; uxIndex++ )
+        {
+            if( ( xObjectCache.xEntries[ uxIndex ].xHandle == xPkHandle ) &&
+                ( xObjectCache.xEntries[ uxIndex ].xClass == CKO_PRIVATE_KEY ) &&
+                ( xObjectCache.xEntries[ uxIndex ].xHasKeyType == pdTRUE ) )
+            {
+                *pxKeyType = xObjectCache.xEntries[ uxIndex ].xKeyType;
+                xIsCached = pdTRUE;
+                break;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xIsCached;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSetCachedKeyType( CK_OBJECT_HANDLE xPkHandle,
+                                 CK_KEY_TYPE xKeyType )
+{
+    size_t uxIndex = 0;
+
+    taskENTER_CRITICAL();
+    {
+        for( uxIndex = 0; uxIndex < MBEDTLS_PKCS11_OBJECT_CACHE_SIZE; uxIndex++ )
+        {
+            if( ( xObjectCache.xEntries[ uxIndex ].xHandle == xPkHandle ) &&
+                ( xObjectCache.xEntries[ uxIndex ].xClass == CKO_PRIVATE_KEY ) )
+            {
+                xObjectCache.xEntries[ uxIndex ].xKeyType = xKeyType;
+                xObjectCache.xEntries[ uxIndex ].xHasKeyType = pdTRUE;
+                break;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCloseSession( void )
+{
+    CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
+
+    if( xObjectCache.xSession != CK_INVALID_HANDLE )
+    {
+        /* Fails harmlessly if C_Finalize() already closed it. */
+        if( ( C_GetFunctionList( &pxFunctionList ) == CKR_OK ) && ( pxFunctionList != NULL ) )
+        {
+            ( void ) pxFunctionList->C_CloseSession( xObjectCache.xSession );
+        }
+
+        xObjectCache.xSession = CK_INVALID_HANDLE;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 static void * p11_ecdsa_ctx_alloc( void )
 {
     void * pvCtx = NULL;
@@ -34,6 +34,45 @@
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Set to 1 to have lMbedCryptoRngCallbackPKCS11() return output from a
+ * local CTR_DRBG instead of calling C_GenerateRandom() for every request.
+ *
+ * The DRBG is seeded from C_GenerateRandom() on first use and reseeded from
+ * it every #MBEDTLS_PKCS11_RNG_RESEED_INTERVAL requests. With a secure
+ * element behind PKCS #11, this turns the many small RNG requests of a TLS
+ * handshake into one bus transaction. Requires MBEDTLS_CTR_DRBG_C.
+ */
+#ifndef MBEDTLS_PKCS11_RNG_USE_DRBG
+    #define MBEDTLS_PKCS11_RNG_USE_DRBG    ( 0 )
+#endif
+
+/**
+ * @brief Number of requests served by the CTR_DRBG between reseeds from
+ * C_GenerateRandom().
+ */
+#ifndef MBEDTLS_PKCS11_RNG_RESEED_INTERVAL
+    #define MBEDTLS_PKCS11_RNG_RESEED_INTERVAL    ( 1000 )
+#endif
+
+#if ( MBEDTLS_PKCS11_RNG_USE_DRBG == 1 ) && !defined( MBEDTLS_CTR_DRBG_C )
+    #error "MBEDTLS_PKCS11_RNG_USE_DRBG requires MBEDTLS_CTR_DRBG_C."
+#endif
+
+/**
+ * @brief Number of label and class to object handle mappings remembered by
+ * xPKCS11_FindObjectCached(). When full, the oldest mapping is replaced.
+ */
+#ifndef MBEDTLS_PKCS11_OBJECT_CACHE_SIZE
+    #define MBEDTLS_PKCS11_OBJECT_CACHE_SIZE    ( 4 )
+#endif
+
+#if ( MBEDTLS_PKCS11_OBJECT_CACHE_SIZE < 1 )
+    #error "MBEDTLS_PKCS11_OBJECT_CACHE_SIZE must be at least 1."
+#endif
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Initialize an mbedtls_pk_context for the given PKCS11 object handle.
  *
@@ -46,9 +85,70 @@ CK_RV xPKCS11_initMbedtlsPkContext( mbedtls_pk_context * pxMbedtlsPkCtx,
                                     CK_SESSION_HANDLE xSessionHandle,
                                     CK_OBJECT_HANDLE xPkHandle );
 
+/**
+ * @brief Find a PKCS11 object by label and class, remembering the handle.
+ *
+ * Object handles are shared by all sessions of the application, so a handle
+ * found through one session is returned for later lookups through any
+ * session without calling C_FindObjects() again. The key type of a cached
+ * private key is remembered by xPKCS11_initMbedtlsPkContext() as well.
+ *
+ * @param[in] xSessionHandle Session used if the object is not cached.
+ * @param[in] pcLabelName NULL terminated label of the object.
+ * @param[in] xClass Class of the object.
+ * @param[out] pxHandle The object handle, or CK_INVALID_HANDLE if there is
+ * no such object.
+ * @return CK_RV CKR_OK on success.
+ */
+CK_RV xPKCS11_FindObjectCached( CK_SESSION_HANDLE xSessionHandle,
+                                const char * pcLabelName,
+                                CK_OBJECT_CLASS xClass,
+                                CK_OBJECT_HANDLE_PTR pxHandle );
+
+/**
+ * @brief Borrow the persistent PKCS11 session, opening it on first use.
+ *
+ * The session stays open between borrowers, so connections do not pay for
+ * C_OpenSession() and the slot lookup each time. One task at a time borrows
+ * it, since a session can only run one operation such as a signature at a
+ * time; others get CKR_SESSION_COUNT and should open a session of their own.
+ *
+ * @param[out] pxSessionHandle The borrowed session.
+ * @return CK_RV CKR_OK on success.
+ */
+CK_RV xPKCS11_BorrowSession( CK_SESSION_HANDLE * pxSessionHandle );
+
+/**
+ * @brief Return the session borrowed with xPKCS11_BorrowSession().
+ */
+void vPKCS11_ReturnSession( void );
+
+/**
+ * @brief Forget all cached object handles and the persistent session.
+ *
+ * Call after objects are created or destroyed, for example when a device is
+ * provisioned, and before C_Finalize(). A borrowed session is closed when it
+ * is returned.
+ */
+void vPKCS11_InvalidateObjectCache( void );
+
+/**
+ * @brief Get a count of the calls to vPKCS11_InvalidateObjectCache().
+ *
+ * Modules that keep state derived from PKCS11 objects compare this with
+ * the value seen when they loaded the state to know it is out of date.
+ *
+ * @return The invalidation count.
+ */
+uint32_t ulPKCS11_GetObjectCacheGeneration( void );
+
 /**
  * @brief Callback to generate random data with the PKCS11 API.
  *
+ * With #MBEDTLS_PKCS11_RNG_USE_DRBG, the data comes from a CTR_DRBG seeded
+ * from the PKCS11 module. A task that finds the DRBG in use by another task
+ * calls the module directly instead of waiting.
+ *
  * @param[in] pvCtx void pointer to a PKCS11 Session handle.
  * @param[in] pucRandom Byte array to fill with random data.
  * @param[in] xRandomLength Length of byte array.
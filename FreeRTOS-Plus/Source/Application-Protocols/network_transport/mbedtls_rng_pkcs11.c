@@ -38,6 +38,187 @@
 
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
+#include "mbedtls_pkcs11.h"
+
+#if ( MBEDTLS_PKCS11_RNG_USE_DRBG == 1 )
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "mbedtls/ctr_drbg.h"
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief PKCS #11 function list, looked up on the first request.
+ */
+static CK_FUNCTION_LIST_PTR pxCachedFunctionList = NULL;
+
+#if ( MBEDTLS_PKCS11_RNG_USE_DRBG == 1 )
+
+/**
+ * @brief CTR_DRBG seeded from the PKCS #11 module, shared by all sessions.
+ * One task at a time borrows it; others go to the module directly.
+ */
+    typedef struct RngDrbg
+    {
+        BaseType_t xIsSeeded;              /**< @brief pdTRUE once xCtrDrbg is seeded. */
+        BaseType_t xIsInUse;               /**< @brief pdTRUE while a task borrows the DRBG. */
+        CK_SESSION_HANDLE xSession;        /**< @brief Session of the borrower, used to (re)seed. */
+        mbedtls_ctr_drbg_context xCtrDrbg; /**< @brief DRBG state. */
+    } RngDrbg_t;
+
+/**
+ * @brief The DRBG. Zero is the initialized, unseeded state.
+ */
+    static RngDrbg_t xRngDrbg;
+
+/**
+ * @brief Personalization string, keeps this DRBG's output distinct from
+ * other DRBGs seeded from the same module.
+ */
+    static const unsigned char pucDrbgPersonalization[] = "FreeRTOS PKCS11 RNG";
+
+#endif /* MBEDTLS_PKCS11_RNG_USE_DRBG == 1 */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the PKCS #11 function list, looking it up on first use.
+ *
+ * @return The function list, or NULL if it has no C_GenerateRandom.
+ */
+static CK_FUNCTION_LIST_PTR prvGetFunctionList( void );
+
+#if ( MBEDTLS_PKCS11_RNG_USE_DRBG == 1 )
+
+/**
+ * @brief mbed TLS entropy callback, reading from C_GenerateRandom.
+ *
+ * @param[in] pvCtx Pointer to the PKCS #11 session handle.
+ * @param[out] pucOutput Buffer to fill with entropy.
+ * @param[in] uxLen Length of the buffer.
+ *
+ * @return 0 on success, MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED otherwise.
+ */
+    static int prvDrbgEntropy( void * pvCtx,
+                               unsigned char * pucOutput,
+                               size_t uxLen );
+
+/**
+ * @brief Fill a buffer from the DRBG, seeding it first if needed.
+ * Only called by the task borrowing the DRBG.
+ *
+ * @param[out] pucOutput Buffer to fill with random data.
+ * @param[in] uxLen Length of the buffer.
+ *
+ * @return 0 on success.
+ */
+    static int prvDrbgRandom( unsigned char * pucOutput,
+                              size_t uxLen );
+
+#endif /* MBEDTLS_PKCS11_RNG_USE_DRBG == 1 */
+
+/*-----------------------------------------------------------*/
+
+static CK_FUNCTION_LIST_PTR prvGetFunctionList( void )
+{
+    CK_FUNCTION_LIST_PTR pxFunctionList = pxCachedFunctionList;
+
+    if( pxFunctionList == NULL )
+    {
+        /* Racing tasks store the same pointer, so no lock is needed. */
+        if( ( C_GetFunctionList( &pxFunctionList ) != CKR_OK ) ||
+            ( pxFunctionList == NULL ) ||
+            ( pxFunctionList->C_GenerateRandom == NULL ) )
+        {
+            pxFunctionList = NULL;
+        }
+        else
+        {
+            pxCachedFunctionList = pxFunctionList;
+        }
+    }
+
+    return pxFunctionList;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( MBEDTLS_PKCS11_RNG_USE_DRBG == 1 )
+
+    static int prvDrbgEntropy( void * pvCtx,
+                               unsigned char * pucOutput,
+                               size_t uxLen )
+    {
+        int lRslt = 0;
+        CK_SESSION_HANDLE * pxSessionHandle = ( CK_SESSION_HANDLE * ) pvCtx;
+
+        if( pxCachedFunctionList->C_GenerateRandom( *pxSessionHandle, pucOutput, uxLen ) != CKR_OK )
+        {
+            LogError( ( "Failed to seed the DRBG from the PKCS #11 module." ) );
+            lRslt = MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+        }
+
+        return lRslt;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static int prvDrbgRandom( unsigned char * pucOutput,
+                              size_t uxLen )
+    {
+        int lRslt = 0;
+        size_t uxOffset = 0;
+        size_t uxChunk;
+
+        if( xRngDrbg.xIsSeeded == pdFALSE )
+        {
+            mbedtls_ctr_drbg_init( &( xRngDrbg.xCtrDrbg ) );
+
+            lRslt = mbedtls_ctr_drbg_seed( &( xRngDrbg.xCtrDrbg ),
+                                           prvDrbgEntropy,
+                                           &( xRngDrbg.xSession ),
+                                           pucDrbgPersonalization,
+                                           sizeof( pucDrbgPersonalization ) - 1U );
+
+            if( lRslt == 0 )
+            {
+                mbedtls_ctr_drbg_set_reseed_interval( &( xRngDrbg.xCtrDrbg ),
+                                                      MBEDTLS_PKCS11_RNG_RESEED_INTERVAL );
+                xRngDrbg.xIsSeeded = pdTRUE;
+            }
+            else
+            {
+                mbedtls_ctr_drbg_free( &( xRngDrbg.xCtrDrbg ) );
+            }
+        }
+
+        /* The DRBG returns at most MBEDTLS_CTR_DRBG_MAX_REQUEST bytes per call. */
+        while( ( lRslt == 0 ) && ( uxOffset < uxLen ) )
+        {
+            uxChunk = uxLen - uxOffset;
+
+            if( uxChunk > MBEDTLS_CTR_DRBG_MAX_REQUEST )
+            {
+                uxChunk = MBEDTLS_CTR_DRBG_MAX_REQUEST;
+            }
+
+            lRslt = mbedtls_ctr_drbg_random( &( xRngDrbg.xCtrDrbg ), &( pucOutput[ uxOffset ] ), uxChunk );
+            uxOffset += uxChunk;
+        }
+
+        /* A failed reseed leaves the DRBG unusable, so seed it from scratch
+         * on the next request. */
+        if( ( lRslt != 0 ) && ( xRngDrbg.xIsSeeded == pdTRUE ) )
+        {
+            mbedtls_ctr_drbg_free( &( xRngDrbg.xCtrDrbg ) );
+            xRngDrbg.xIsSeeded = pdFALSE;
+        }
+
+        return lRslt;
+    }
+
+#endif /* MBEDTLS_PKCS11_RNG_USE_DRBG == 1 */
 
 /*-----------------------------------------------------------*/
 
@@ -45,10 +226,14 @@ int lMbedCryptoRngCallbackPKCS11( void * pvCtx,
                                   unsigned char * pucOutput,
                                   size_t uxLen )
 {
-    int lRslt;
+    int lRslt = -1;
     CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
     CK_SESSION_HANDLE * pxSessionHandle = ( CK_SESSION_HANDLE * ) pvCtx;
 
+    #if ( MBEDTLS_PKCS11_RNG_USE_DRBG == 1 )
+        BaseType_t xHasDrbg = pdFALSE;
+    #endif
+
     if( pucOutput == NULL )
     {
         lRslt = -1;
@@ -60,18 +245,45 @@ int lMbedCryptoRngCallbackPKCS11( void * pvCtx,
     }
     else
     {
-        lRslt = ( int ) C_GetFunctionList( &pxFunctionList );
+        pxFunctionList = prvGetFunctionList();
     }
 
-    if( ( lRslt != CKR_OK ) ||
-        ( pxFunctionList == NULL ) ||
-        ( pxFunctionList->C_GenerateRandom == NULL ) )
+    if( pxFunctionList != NULL )
     {
-        lRslt = -1;
-    }
-    else
-    {
-        lRslt = ( int ) pxFunctionList->C_GenerateRandom( *pxSessionHandle, pucOutput, uxLen );
+        #if ( MBEDTLS_PKCS11_RNG_USE_DRBG == 1 )
+            {
+                taskENTER_CRITICAL();
+
+                if( xRngDrbg.xIsInUse == pdFALSE )
+                {
+                    xRngDrbg.xIsInUse = pdTRUE;
+                    xHasDrbg = pdTRUE;
+                }
+
+                taskEXIT_CRITICAL();
+
+                if( xHasDrbg == pdTRUE )
+                {
+                    /* Any reseed during this request uses the caller's session,
+                     * which is known to be open. */
+                    xRngDrbg.xSession = *pxSessionHandle;
+
+                    lRslt = prvDrbgRandom( pucOutput, uxLen );
+
+                    taskENTER_CRITICAL();
+                    xRngDrbg.xIsInUse = pdFALSE;
+                    taskEXIT_CRITICAL();
+                }
+                else
+                {
+                    lRslt = ( int ) pxFunctionList->C_GenerateRandom( *pxSessionHandle, pucOutput, uxLen );
+                }
+            }
+        #else /* if ( MBEDTLS_PKCS11_RNG_USE_DRBG == 1 ) */
+            {
+                lRslt = ( int ) pxFunctionList->C_GenerateRandom( *pxSessionHandle, pucOutput, uxLen );
+            }
+        #endif /* if ( MBEDTLS_PKCS11_RNG_USE_DRBG == 1 ) */
     }
 
     return lRslt;
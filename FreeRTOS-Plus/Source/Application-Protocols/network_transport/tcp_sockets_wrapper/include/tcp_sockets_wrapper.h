@@ -38,6 +38,7 @@
 
 /* FreeRTOS Kernel includes. */
 #include "FreeRTOS.h"
+#include "semphr.h"
 
 /* Error codes. */
 #define TCP_SOCKETS_ERRNO_NONE                ( 0 )   /*!< No error. */
@@ -53,6 +54,24 @@
 #define TCP_SOCKETS_ERRNO_ENOSPC              ( -10 ) /*!< No space left on device */
 #define TCP_SOCKETS_ERRNO_EINTR               ( -11 ) /*!< Interrupted system call */
 
+/**
+ * @brief Hooks around the steps of TCP_Sockets_Connect(), e.g. to time them
+ * with the trace recorder's xTraceIntervalStart() and xTraceIntervalStop().
+ * They are empty by default and can be defined in FreeRTOSConfig.h.
+ */
+#ifndef traceTCP_SOCKETS_DNS_START
+    #define traceTCP_SOCKETS_DNS_START( pHostName )
+#endif
+#ifndef traceTCP_SOCKETS_DNS_END
+    #define traceTCP_SOCKETS_DNS_END( pHostName )
+#endif
+#ifndef traceTCP_SOCKETS_CONNECT_START
+    #define traceTCP_SOCKETS_CONNECT_START( pHostName, port )
+#endif
+#ifndef traceTCP_SOCKETS_CONNECT_END
+    #define traceTCP_SOCKETS_CONNECT_END( pHostName, port, status )
+#endif
+
 #ifndef SOCKET_T_TYPEDEFED
     struct xSOCKET;
     typedef struct xSOCKET * Socket_t; /**< @brief Socket handle data type. */
@@ -122,4 +141,53 @@ int32_t TCP_Sockets_Recv( Socket_t xSocket,
                           void * pvBuffer,
                           size_t xBufferLength );
 
+/**
+ * @brief Set a semaphore that is given when a socket may have become readable.
+ *
+ * One task can service several connections by setting the same semaphore on
+ * all of their sockets, taking it, and then calling TCP_Sockets_Poll() on each
+ * socket. The semaphore is given when new data arrives or the connection
+ * closes; it is not given again for data that was already there, so read a
+ * socket until TCP_Sockets_Poll() returns 0 before waiting again.
+ *
+ * @param[in] xSocket The socket descriptor.
+ * @param[in] xSemaphore The semaphore to give, or NULL to stop.
+ *
+ * @return TCP_SOCKETS_ERRNO_NONE on success, TCP_SOCKETS_ERRNO_ENOPROTOOPT if
+ * the port does not support it, else a negative value. @ref SocketsErrors
+ */
+BaseType_t TCP_Sockets_SetReadySemaphore( Socket_t xSocket,
+                                          SemaphoreHandle_t xSemaphore );
+
+/**
+ * @brief Check without blocking whether data can be received from a socket.
+ *
+ * @param[in] xSocket The socket descriptor.
+ *
+ * @return
+ * * The number of bytes TCP_Sockets_Recv() can return without blocking.
+ * * 0 if no data is available.
+ * * If the connection is closed, or another error occurred, a negative value.
+ *   @ref SocketsErrors
+ */
+int32_t TCP_Sockets_Poll( Socket_t xSocket );
+
+/**
+ * @brief Send data that TCP_Sockets_Send() accepted but the port still holds.
+ *
+ * A port may collect short writes and send them together, e.g. in one modem
+ * command. It sends them anyway before the socket is read or polled, so call
+ * this only when nothing will be read for a while, e.g. after a final QoS 0
+ * publish.
+ *
+ * @param[in] xSocket The socket descriptor.
+ *
+ * @return
+ * * TCP_SOCKETS_ERRNO_NONE if nothing is held back any more.
+ * * TCP_SOCKETS_ERRNO_EWOULDBLOCK if the send timeout expired first; the rest
+ *   is sent by the next flush.
+ * * Another negative value on error. @ref SocketsErrors
+ */
+BaseType_t TCP_Sockets_Flush( Socket_t xSocket );
+
 #endif /* ifndef TCP_SOCKETS_WRAPPER_H */
@@ -57,6 +57,7 @@ extern void vLoggingPrintf( const char * pcFormatString,
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 #include "event_groups.h"
 
 /* TCP sockets wrapper includes. */
@@ -122,6 +123,44 @@ extern uint8_t CellularSocketPdnContextId;
 /* Invalid socket. */
 #define CELLULAR_INVALID_SOCKET                ( ( Socket_t ) ~0U )
 
+/* Size of the per socket receive buffer. Reads shorter than this are served
+ * from the buffer, which is filled with everything the modem has in one
+ * receive command. */
+#ifndef CELLULAR_SOCKET_RECV_BUFFER_SIZE
+    #define CELLULAR_SOCKET_RECV_BUFFER_SIZE    ( CELLULAR_MAX_RECV_DATA_LEN )
+#endif
+
+/* Size of the per socket send buffer, 0 to send every write right away.
+ * Writes shorter than this are collected and sent in one modem send command
+ * when the buffer is full, CELLULAR_SOCKET_SEND_FLUSH_MS after the first of
+ * them, before the socket is read or polled, or on TCP_Sockets_Flush. There
+ * is no timer; the delay is checked when the socket is next used. */
+#ifndef CELLULAR_SOCKET_SEND_BUFFER_SIZE
+    #define CELLULAR_SOCKET_SEND_BUFFER_SIZE    ( 0U )
+#endif
+
+#ifndef CELLULAR_SOCKET_SEND_FLUSH_MS
+    #define CELLULAR_SOCKET_SEND_FLUSH_MS    ( 20U )
+#endif
+
+/* Set to 1 to receive for all sockets in one dispatcher task. The data ready
+ * callbacks only flag the socket; the dispatcher then reads every flagged
+ * socket, one after the other, into its receive buffer, and TCP_Sockets_Recv
+ * and TCP_Sockets_Poll are served from that buffer alone. Tasks owning
+ * different sockets then no longer take turns on the AT channel to ask for
+ * their data. The task is created by the first TCP_Sockets_Connect. */
+#ifndef CELLULAR_SOCKET_DISPATCHER
+    #define CELLULAR_SOCKET_DISPATCHER    ( 0 )
+#endif
+
+#ifndef CELLULAR_SOCKET_DISPATCHER_STACK_SIZE
+    #define CELLULAR_SOCKET_DISPATCHER_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4U )
+#endif
+
+#ifndef CELLULAR_SOCKET_DISPATCHER_PRIORITY
+    #define CELLULAR_SOCKET_DISPATCHER_PRIORITY    ( tskIDLE_PRIORITY + 2U )
+#endif
+
 /*-----------------------------------------------------------*/
 
 typedef struct xSOCKET
@@ -133,10 +172,35 @@ typedef struct xSOCKET
     TickType_t sendTimeout;
 
     EventGroupHandle_t socketEventGroupHandle;
+    SemaphoreHandle_t readySemaphore;
+
+    uint8_t recvBuffer[ CELLULAR_SOCKET_RECV_BUFFER_SIZE ];
+    uint32_t recvBufferHead;
+    uint32_t recvBufferLength;
+
+    #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+        uint8_t sendBuffer[ CELLULAR_SOCKET_SEND_BUFFER_SIZE ];
+        uint32_t sendBufferLength;
+        uint64_t sendBufferTimeMs; /* When the oldest buffered byte was written. */
+    #endif
+
+    #if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+        volatile uint32_t dataPending;        /* Set by the data ready callback. */
+        CellularError_t dispatchStatus;       /* Status of the last receive of the dispatcher. */
+        struct xSOCKET * pNextDispatchSocket; /* Next socket served by the dispatcher. */
+    #endif
 } cellularSocketWrapper_t;
 
 /*-----------------------------------------------------------*/
 
+#if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+    static TaskHandle_t dispatcherTaskHandle = NULL;       /**< @brief The dispatcher task. */
+    static SemaphoreHandle_t dispatcherMutex = NULL;       /**< @brief Held while the dispatcher reads and to change the socket list. */
+    static cellularSocketWrapper_t * pDispatchList = NULL; /**< @brief The connected sockets. */
+#endif
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Get the count of milliseconds since vTaskStartScheduler was called.
  *
@@ -144,6 +208,47 @@ typedef struct xSOCKET
  */
 static uint64_t getTimeMs( void );
 
+/**
+ * @brief Copy data from the socket receive buffer.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ * @param[out] buf The data buffer for receiving data.
+ * @param[in] len The length of the data buffer
+ *
+ * @return The number of bytes copied.
+ */
+static uint32_t prvCopyRecvBuffer( cellularSocketWrapper_t * pCellularSocketContext,
+                                   uint8_t * buf,
+                                   size_t len );
+
+#if ( CELLULAR_SOCKET_DISPATCHER == 0 )
+
+/**
+ * @brief Fill the empty socket receive buffer with what the modem has.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ *
+ * @return The status of Cellular_SocketRecv.
+ */
+    static CellularError_t prvFillRecvBuffer( cellularSocketWrapper_t * pCellularSocketContext );
+
+/**
+ * @brief Receive data from the modem, through the socket receive buffer for
+ * reads shorter than it.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ * @param[out] buf The data buffer for receiving data.
+ * @param[in] len The length of the data buffer
+ * @param[out] pRecvLength The number of bytes copied to buf.
+ *
+ * @return The status of Cellular_SocketRecv.
+ */
+    static CellularError_t prvCellularSocketRecv( cellularSocketWrapper_t * pCellularSocketContext,
+                                                  uint8_t * buf,
+                                                  size_t len,
+                                                  uint32_t * pRecvLength );
+#endif
+
 /**
  * @brief Receive data from cellular socket.
  *
@@ -160,10 +265,80 @@ static uint64_t getTimeMs( void );
  * @return Positive value indicate the number of bytes received. Otherwise, error code defined
  * in sockets_wrapper.h is returned.
  */
-static BaseType_t prvNetworkRecvCellular( const cellularSocketWrapper_t * pCellularSocketContext,
+static BaseType_t prvNetworkRecvCellular( cellularSocketWrapper_t * pCellularSocketContext,
                                           uint8_t * buf,
                                           size_t len );
 
+/**
+ * @brief Send data to the modem until it is all sent, the send timeout
+ * expires or an error occurs.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ * @param[in] buf The data to send.
+ * @param[in] len The length of the data.
+ *
+ * @return The number of bytes sent, 0 if the socket was closed, or
+ * TCP_SOCKETS_ERRNO_ERROR.
+ */
+static BaseType_t prvCellularSocketSend( cellularSocketWrapper_t * pCellularSocketContext,
+                                         const uint8_t * buf,
+                                         uint32_t len );
+
+#if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+
+/**
+ * @brief Send what is in the socket send buffer.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ *
+ * @return TCP_SOCKETS_ERRNO_NONE if the buffer is empty now,
+ * TCP_SOCKETS_ERRNO_EWOULDBLOCK if some of it could not be sent before the
+ * send timeout or the socket closed, else TCP_SOCKETS_ERRNO_ERROR.
+ */
+    static BaseType_t prvFlushSendBuffer( cellularSocketWrapper_t * pCellularSocketContext );
+#endif
+
+#if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+
+/**
+ * @brief Create the dispatcher task if it does not exist yet.
+ *
+ * @return TCP_SOCKETS_ERRNO_NONE on success, else TCP_SOCKETS_ERRNO_ENOMEM.
+ */
+    static BaseType_t prvDispatcherStart( void );
+
+/**
+ * @brief Add a connected socket to the sockets served by the dispatcher.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ */
+    static void prvDispatcherAdd( cellularSocketWrapper_t * pCellularSocketContext );
+
+/**
+ * @brief Remove a socket from the sockets served by the dispatcher. The
+ * dispatcher does not touch the socket once this returns.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ */
+    static void prvDispatcherRemove( cellularSocketWrapper_t * pCellularSocketContext );
+
+/**
+ * @brief Read what the modem has for a flagged socket into its receive buffer.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ *
+ * @return pdTRUE if the socket is still flagged and its buffer has room.
+ */
+    static BaseType_t prvDispatchRecv( cellularSocketWrapper_t * pCellularSocketContext );
+
+/**
+ * @brief The dispatcher task, which reads from the modem for all sockets.
+ *
+ * @param[in] pvParameters Unused.
+ */
+    static void prvSocketDispatcherTask( void * pvParameters );
+#endif
+
 /**
  * @brief Callback used to inform about the status of socket open.
  *
@@ -278,70 +453,201 @@ static uint64_t getTimeMs( void )
 
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvNetworkRecvCellular( const cellularSocketWrapper_t * pCellularSocketContext,
-                                          uint8_t * buf,
-                                          size_t len )
+static uint32_t prvCopyRecvBuffer( cellularSocketWrapper_t * pCellularSocketContext,
+                                   uint8_t * buf,
+                                   size_t len )
 {
-    CellularSocketHandle_t cellularSocketHandle = NULL;
-    BaseType_t retRecvLength = 0;
-    uint32_t recvLength = 0;
-    TickType_t recvTimeout = 0;
-    TickType_t recvStartTime = 0;
-    CellularError_t socketStatus = CELLULAR_SUCCESS;
-    EventBits_t waitEventBits = 0;
+    uint32_t copyLength = pCellularSocketContext->recvBufferLength;
+    uint32_t firstLength = 0;
+
+    if( len < copyLength )
+    {
+        copyLength = ( uint32_t ) len;
+    }
 
-    cellularSocketHandle = pCellularSocketContext->cellularSocketHandle;
+    /* The dispatcher fills the buffer as a ring, the data may wrap. */
+    firstLength = CELLULAR_SOCKET_RECV_BUFFER_SIZE - pCellularSocketContext->recvBufferHead;
 
-    if( pCellularSocketContext->receiveTimeout >= portMAX_DELAY )
+    if( firstLength > copyLength )
     {
-        recvTimeout = portMAX_DELAY;
+        firstLength = copyLength;
     }
-    else
+
+    ( void ) memcpy( buf, &pCellularSocketContext->recvBuffer[ pCellularSocketContext->recvBufferHead ], firstLength );
+    ( void ) memcpy( &buf[ firstLength ], pCellularSocketContext->recvBuffer, copyLength - firstLength );
+
+    taskENTER_CRITICAL();
     {
-        recvTimeout = pCellularSocketContext->receiveTimeout;
+        pCellularSocketContext->recvBufferHead = ( pCellularSocketContext->recvBufferHead + copyLength ) %
+                                                 CELLULAR_SOCKET_RECV_BUFFER_SIZE;
+        pCellularSocketContext->recvBufferLength -= copyLength;
     }
+    taskEXIT_CRITICAL();
+
+    #if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+        if( ( pCellularSocketContext->dataPending != 0U ) && ( copyLength > 0U ) )
+        {
+            /* The modem held more than fitted, there is room for it now. */
+            ( void ) xTaskNotifyGive( dispatcherTaskHandle );
+        }
+    #endif
 
-    recvStartTime = xTaskGetTickCount();
+    return copyLength;
+}
+
+/*-----------------------------------------------------------*/
 
-    ( void ) xEventGroupClearBits( pCellularSocketContext->socketEventGroupHandle,
-                                   SOCKET_DATA_RECEIVED_CALLBACK_BIT );
-    socketStatus = Cellular_SocketRecv( CellularHandle, cellularSocketHandle, buf, len, &recvLength );
+#if ( CELLULAR_SOCKET_DISPATCHER == 0 )
 
-    /* Calculate remain recvTimeout. */
-    if( recvTimeout != portMAX_DELAY )
+    static CellularError_t prvFillRecvBuffer( cellularSocketWrapper_t * pCellularSocketContext )
     {
-        if( ( recvStartTime + recvTimeout ) > xTaskGetTickCount() )
+        CellularError_t socketStatus = CELLULAR_SUCCESS;
+        uint32_t bufferedLength = 0;
+
+        socketStatus = Cellular_SocketRecv( CellularHandle, pCellularSocketContext->cellularSocketHandle,
+                                            pCellularSocketContext->recvBuffer,
+                                            sizeof( pCellularSocketContext->recvBuffer ),
+                                            &bufferedLength );
+
+        if( socketStatus == CELLULAR_SUCCESS )
         {
-            recvTimeout = recvTimeout - ( xTaskGetTickCount() - recvStartTime );
+            pCellularSocketContext->recvBufferHead = 0;
+            pCellularSocketContext->recvBufferLength = bufferedLength;
+
+            /* The modem may hold more than fits. Keep the data bit set so that
+             * TCP_Sockets_Poll looks again once the buffer is empty. */
+            if( bufferedLength == sizeof( pCellularSocketContext->recvBuffer ) )
+            {
+                ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
+                                             SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+            }
+        }
+
+        return socketStatus;
+    }
+
+    /*-----------------------------------------------------------*/
+
+    static CellularError_t prvCellularSocketRecv( cellularSocketWrapper_t * pCellularSocketContext,
+                                                  uint8_t * buf,
+                                                  size_t len,
+                                                  uint32_t * pRecvLength )
+    {
+        CellularError_t socketStatus = CELLULAR_SUCCESS;
+
+        if( len >= sizeof( pCellularSocketContext->recvBuffer ) )
+        {
+            /* Nothing is saved by buffering a long read. */
+            socketStatus = Cellular_SocketRecv( CellularHandle, pCellularSocketContext->cellularSocketHandle,
+                                                buf, ( uint32_t ) len, pRecvLength );
+
+            if( ( socketStatus == CELLULAR_SUCCESS ) && ( *pRecvLength == ( uint32_t ) len ) )
+            {
+                ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
+                                             SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+            }
         }
         else
         {
-            recvTimeout = 0;
+            /* Read all the modem has, so that the reads that follow, such as a TLS
+             * record body after its header, don't cost another AT command. */
+            socketStatus = prvFillRecvBuffer( pCellularSocketContext );
+            *pRecvLength = 0;
+
+            if( socketStatus == CELLULAR_SUCCESS )
+            {
+                *pRecvLength = prvCopyRecvBuffer( pCellularSocketContext, buf, len );
+            }
         }
+
+        return socketStatus;
     }
 
-    if( ( socketStatus == CELLULAR_SUCCESS ) && ( recvLength == 0U ) &&
-        ( recvTimeout != 0U ) )
-    {
-        waitEventBits = xEventGroupWaitBits( pCellularSocketContext->socketEventGroupHandle,
-                                             SOCKET_DATA_RECEIVED_CALLBACK_BIT | SOCKET_CLOSE_CALLBACK_BIT,
-                                             pdTRUE,
-                                             pdFALSE,
-                                             recvTimeout );
+#endif /* CELLULAR_SOCKET_DISPATCHER == 0 */
 
-        if( ( waitEventBits & SOCKET_CLOSE_CALLBACK_BIT ) != 0U )
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNetworkRecvCellular( cellularSocketWrapper_t * pCellularSocketContext,
+                                          uint8_t * buf,
+                                          size_t len )
+{
+    BaseType_t retRecvLength = 0;
+    uint32_t recvLength = 0;
+    TickType_t recvTimeout = 0;
+    TickType_t recvStartTime = 0;
+    CellularError_t socketStatus = CELLULAR_SUCCESS;
+    EventBits_t waitEventBits = 0;
+
+    if( pCellularSocketContext->recvBufferLength > 0U )
+    {
+        /* Served from RAM without a modem round trip. */
+        recvLength = prvCopyRecvBuffer( pCellularSocketContext, buf, len );
+    }
+    else
+    {
+        if( pCellularSocketContext->receiveTimeout >= portMAX_DELAY )
         {
-            socketStatus = CELLULAR_SOCKET_CLOSED;
+            recvTimeout = portMAX_DELAY;
         }
-        else if( ( waitEventBits & SOCKET_DATA_RECEIVED_CALLBACK_BIT ) != 0U )
+        else
         {
-            socketStatus = Cellular_SocketRecv( CellularHandle, cellularSocketHandle, buf, len, &recvLength );
+            recvTimeout = pCellularSocketContext->receiveTimeout;
         }
-        else
+
+        recvStartTime = xTaskGetTickCount();
+
+        ( void ) xEventGroupClearBits( pCellularSocketContext->socketEventGroupHandle,
+                                       SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+
+        #if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+            /* The dispatcher may have filled the buffer since it was checked. */
+            recvLength = prvCopyRecvBuffer( pCellularSocketContext, buf, len );
+            socketStatus = ( recvLength > 0U ) ? CELLULAR_SUCCESS : pCellularSocketContext->dispatchStatus;
+        #else
+            socketStatus = prvCellularSocketRecv( pCellularSocketContext, buf, len, &recvLength );
+        #endif
+
+        /* Calculate remain recvTimeout. */
+        if( recvTimeout != portMAX_DELAY )
+        {
+            if( ( recvStartTime + recvTimeout ) > xTaskGetTickCount() )
+            {
+                recvTimeout = recvTimeout - ( xTaskGetTickCount() - recvStartTime );
+            }
+            else
+            {
+                recvTimeout = 0;
+            }
+        }
+
+        if( ( socketStatus == CELLULAR_SUCCESS ) && ( recvLength == 0U ) &&
+            ( recvTimeout != 0U ) )
         {
-            LogInfo( ( "prvNetworkRecv timeout" ) );
-            socketStatus = CELLULAR_SUCCESS;
-            recvLength = 0;
+            waitEventBits = xEventGroupWaitBits( pCellularSocketContext->socketEventGroupHandle,
+                                                 SOCKET_DATA_RECEIVED_CALLBACK_BIT | SOCKET_CLOSE_CALLBACK_BIT,
+                                                 pdTRUE,
+                                                 pdFALSE,
+                                                 recvTimeout );
+
+            if( ( waitEventBits & SOCKET_CLOSE_CALLBACK_BIT ) != 0U )
+            {
+                socketStatus = CELLULAR_SOCKET_CLOSED;
+            }
+            else if( ( waitEventBits & SOCKET_DATA_RECEIVED_CALLBACK_BIT ) != 0U )
+            {
+                #if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+                    recvLength = prvCopyRecvBuffer( pCellularSocketContext, buf, len );
+                    socketStatus = ( recvLength > 0U ) ? CELLULAR_SUCCESS : pCellularSocketContext->dispatchStatus;
+                #else
+                    socketStatus = prvCellularSocketRecv( pCellularSocketContext, buf, len, &recvLength );
+                #endif
+            }
+            else
+            {
+                LogInfo( ( "prvNetworkRecv timeout" ) );
+                socketStatus = CELLULAR_SUCCESS;
+                recvLength = 0;
+            }
         }
     }
 
@@ -365,6 +671,293 @@ static BaseType_t prvNetworkRecvCellular( const cellularSocketWrapper_t * pCellu
 
 /*-----------------------------------------------------------*/
 
+/* This function sends the data until timeout or data is completely sent to server.
+ * Send timeout unit is TickType_t. Any timeout value greater than UINT32_MAX_MS_TICKS
+ * or portMAX_DELAY will be regarded as MAX delay. In this case, this function
+ * will not return until all bytes of data are sent successfully or until an error occurs. */
+static BaseType_t prvCellularSocketSend( cellularSocketWrapper_t * pCellularSocketContext,
+                                         const uint8_t * buf,
+                                         uint32_t len )
+{
+    BaseType_t retSendLength = 0;
+    uint32_t sentLength = 0;
+    CellularError_t socketStatus = CELLULAR_SUCCESS;
+    uint32_t bytesToSend = len;
+    uint64_t entryTimeMs = getTimeMs();
+    uint64_t elapsedTimeMs = 0;
+    uint32_t sendTimeoutMs = 0;
+
+    /* Convert ticks to ms delay. */
+    if( ( pCellularSocketContext->sendTimeout >= UINT32_MAX_MS_TICKS ) || ( pCellularSocketContext->sendTimeout >= portMAX_DELAY ) )
+    {
+        /* Check if the ticks cause overflow. */
+        sendTimeoutMs = UINT32_MAX_DELAY_MS;
+    }
+    else
+    {
+        sendTimeoutMs = TICKS_TO_MS( pCellularSocketContext->sendTimeout );
+    }
+
+    /* Loop sending data until data is sent completely or timeout. */
+    while( bytesToSend > 0U )
+    {
+        socketStatus = Cellular_SocketSend( CellularHandle,
+                                            pCellularSocketContext->cellularSocketHandle,
+                                            &buf[ retSendLength ],
+                                            bytesToSend,
+                                            &sentLength );
+
+        if( socketStatus == CELLULAR_SUCCESS )
+        {
+            retSendLength = retSendLength + ( BaseType_t ) sentLength;
+            bytesToSend = bytesToSend - sentLength;
+        }
+
+        /* Check socket status or timeout break. */
+        if( ( socketStatus != CELLULAR_SUCCESS ) ||
+            ( _calculateElapsedTime( entryTimeMs, sendTimeoutMs, &elapsedTimeMs ) ) )
+        {
+            if( socketStatus == CELLULAR_SOCKET_CLOSED )
+            {
+                /* Socket already closed. No data is sent. */
+                retSendLength = 0;
+            }
+            else if( socketStatus != CELLULAR_SUCCESS )
+            {
+                retSendLength = ( BaseType_t ) TCP_SOCKETS_ERRNO_ERROR;
+            }
+
+            break;
+        }
+    }
+
+    LogDebug( ( "prvCellularSocketSend expect %d write %d", len, sentLength ) );
+
+    return retSendLength;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+
+    static BaseType_t prvFlushSendBuffer( cellularSocketWrapper_t * pCellularSocketContext )
+    {
+        BaseType_t retFlush = TCP_SOCKETS_ERRNO_NONE;
+        BaseType_t sentLength = 0;
+
+        if( pCellularSocketContext->sendBufferLength > 0U )
+        {
+            sentLength = prvCellularSocketSend( pCellularSocketContext,
+                                                pCellularSocketContext->sendBuffer,
+                                                pCellularSocketContext->sendBufferLength );
+
+            if( sentLength < 0 )
+            {
+                retFlush = sentLength;
+            }
+            else
+            {
+                /* Keep what the send timeout cut off for the next flush. */
+                pCellularSocketContext->sendBufferLength -= ( uint32_t ) sentLength;
+
+                if( pCellularSocketContext->sendBufferLength > 0U )
+                {
+                    ( void ) memmove( pCellularSocketContext->sendBuffer,
+                                      &pCellularSocketContext->sendBuffer[ sentLength ],
+                                      pCellularSocketContext->sendBufferLength );
+                    retFlush = TCP_SOCKETS_ERRNO_EWOULDBLOCK;
+                }
+            }
+        }
+
+        return retFlush;
+    }
+
+#endif /* CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U */
+
+/*-----------------------------------------------------------*/
+
+#if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+
+    static BaseType_t prvDispatcherStart( void )
+    {
+        BaseType_t retStart = TCP_SOCKETS_ERRNO_NONE;
+
+        /* Keep two tasks connecting at once from both creating the task. */
+        vTaskSuspendAll();
+        {
+            if( dispatcherMutex == NULL )
+            {
+                dispatcherMutex = xSemaphoreCreateMutex();
+            }
+
+            if( ( dispatcherMutex != NULL ) && ( dispatcherTaskHandle == NULL ) )
+            {
+                if( xTaskCreate( prvSocketDispatcherTask,
+                                 "CellularSockets",
+                                 CELLULAR_SOCKET_DISPATCHER_STACK_SIZE,
+                                 NULL,
+                                 CELLULAR_SOCKET_DISPATCHER_PRIORITY,
+                                 &dispatcherTaskHandle ) != pdPASS )
+                {
+                    dispatcherTaskHandle = NULL;
+                }
+            }
+
+            if( dispatcherTaskHandle == NULL )
+            {
+                retStart = TCP_SOCKETS_ERRNO_ENOMEM;
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        return retStart;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvDispatcherAdd( cellularSocketWrapper_t * pCellularSocketContext )
+    {
+        ( void ) xSemaphoreTake( dispatcherMutex, portMAX_DELAY );
+        pCellularSocketContext->pNextDispatchSocket = pDispatchList;
+        pDispatchList = pCellularSocketContext;
+        ( void ) xSemaphoreGive( dispatcherMutex );
+
+        /* Data may have been reported before the socket was in the list. */
+        ( void ) xTaskNotifyGive( dispatcherTaskHandle );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvDispatcherRemove( cellularSocketWrapper_t * pCellularSocketContext )
+    {
+        cellularSocketWrapper_t ** ppIter = &pDispatchList;
+
+        ( void ) xSemaphoreTake( dispatcherMutex, portMAX_DELAY );
+
+        while( *ppIter != NULL )
+        {
+            if( *ppIter == pCellularSocketContext )
+            {
+                *ppIter = pCellularSocketContext->pNextDispatchSocket;
+                break;
+            }
+
+            ppIter = &( ( *ppIter )->pNextDispatchSocket );
+        }
+
+        pCellularSocketContext->pNextDispatchSocket = NULL;
+        ( void ) xSemaphoreGive( dispatcherMutex );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvDispatchRecv( cellularSocketWrapper_t * pCellularSocketContext )
+    {
+        CellularError_t socketStatus = CELLULAR_SUCCESS;
+        uint32_t tail = 0;
+        uint32_t room = 0;
+        uint32_t recvLength = 0;
+
+        if( ( pCellularSocketContext->dataPending != 0U ) &&
+            ( pCellularSocketContext->recvBufferLength < CELLULAR_SOCKET_RECV_BUFFER_SIZE ) )
+        {
+            /* Cleared first, so data reported during the read is read next. */
+            pCellularSocketContext->dataPending = 0U;
+
+            /* The owner moves the head and the length together. The room can
+             * only grow while the modem writes into it. */
+            taskENTER_CRITICAL();
+            {
+                tail = ( pCellularSocketContext->recvBufferHead + pCellularSocketContext->recvBufferLength ) %
+                       CELLULAR_SOCKET_RECV_BUFFER_SIZE;
+                room = CELLULAR_SOCKET_RECV_BUFFER_SIZE - pCellularSocketContext->recvBufferLength;
+            }
+            taskEXIT_CRITICAL();
+
+            if( room > ( CELLULAR_SOCKET_RECV_BUFFER_SIZE - tail ) )
+            {
+                room = CELLULAR_SOCKET_RECV_BUFFER_SIZE - tail;
+            }
+
+            socketStatus = Cellular_SocketRecv( CellularHandle, pCellularSocketContext->cellularSocketHandle,
+                                                &pCellularSocketContext->recvBuffer[ tail ],
+                                                room,
+                                                &recvLength );
+            pCellularSocketContext->dispatchStatus = socketStatus;
+
+            if( socketStatus == CELLULAR_SUCCESS )
+            {
+                taskENTER_CRITICAL();
+                {
+                    pCellularSocketContext->recvBufferLength += recvLength;
+                }
+                taskEXIT_CRITICAL();
+
+                /* The modem may hold more than fitted. */
+                if( recvLength == room )
+                {
+                    pCellularSocketContext->dataPending = 1U;
+                }
+            }
+            else
+            {
+                LogError( ( "Cellular socket dispatcher receive failed %d", socketStatus ) );
+            }
+
+            if( ( recvLength > 0U ) || ( socketStatus != CELLULAR_SUCCESS ) )
+            {
+                ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
+                                             SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+
+                if( pCellularSocketContext->readySemaphore != NULL )
+                {
+                    ( void ) xSemaphoreGive( pCellularSocketContext->readySemaphore );
+                }
+            }
+        }
+
+        return ( ( pCellularSocketContext->dataPending != 0U ) &&
+                 ( pCellularSocketContext->recvBufferLength < CELLULAR_SOCKET_RECV_BUFFER_SIZE ) ) ? pdTRUE : pdFALSE;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvSocketDispatcherTask( void * pvParameters )
+    {
+        cellularSocketWrapper_t * pIter = NULL;
+        BaseType_t morePending = pdFALSE;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+            /* Serve every socket the modem has data for in one go, again
+             * until none has both data waiting and room for it. */
+            do
+            {
+                morePending = pdFALSE;
+                ( void ) xSemaphoreTake( dispatcherMutex, portMAX_DELAY );
+
+                for( pIter = pDispatchList; pIter != NULL; pIter = pIter->pNextDispatchSocket )
+                {
+                    if( prvDispatchRecv( pIter ) == pdTRUE )
+                    {
+                        morePending = pdTRUE;
+                    }
+                }
+
+                ( void ) xSemaphoreGive( dispatcherMutex );
+            } while( morePending == pdTRUE );
+        }
+    }
+
+#endif /* CELLULAR_SOCKET_DISPATCHER == 1 */
+
+/*-----------------------------------------------------------*/
+
 static void prvCellularSocketOpenCallback( CellularUrcEvent_t urcEvent,
                                            CellularSocketHandle_t socketHandle,
                                            void * pCallbackContext )
@@ -409,8 +1002,20 @@ static void prvCellularSocketDataReadyCallback( CellularSocketHandle_t socketHan
     if( pCellularSocketContext != NULL )
     {
         LogDebug( ( "Data ready on Socket %p", pCellularSocketContext ) );
-        ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
-                                     SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+
+        #if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+            /* The owner is told once the dispatcher has read the data. */
+            pCellularSocketContext->dataPending = 1U;
+            ( void ) xTaskNotifyGive( dispatcherTaskHandle );
+        #else
+            ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
+                                         SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+
+            if( pCellularSocketContext->readySemaphore != NULL )
+            {
+                ( void ) xSemaphoreGive( pCellularSocketContext->readySemaphore );
+            }
+        #endif
     }
     else
     {
@@ -433,6 +1038,11 @@ static void prvCellularSocketClosedCallback( CellularSocketHandle_t socketHandle
         pCellularSocketContext->ulFlags = pCellularSocketContext->ulFlags & ( ~CELLULAR_SOCKET_CONNECT_FLAG );
         ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
                                      SOCKET_CLOSE_CALLBACK_BIT );
+
+        if( pCellularSocketContext->readySemaphore != NULL )
+        {
+            ( void ) xSemaphoreGive( pCellularSocketContext->readySemaphore );
+        }
     }
     else
     {
@@ -611,18 +1221,33 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
     EventBits_t waitEventBits = 0;
     BaseType_t retConnect = TCP_SOCKETS_ERRNO_NONE;
 
-    /* Create a new TCP socket. */
-    cellularSocketStatus = Cellular_CreateSocket( CellularHandle,
-                                                  CellularSocketPdnContextId,
-                                                  CELLULAR_SOCKET_DOMAIN_AF_INET,
-                                                  CELLULAR_SOCKET_TYPE_STREAM,
-                                                  CELLULAR_SOCKET_PROTOCOL_TCP,
-                                                  &cellularSocketHandle );
+    /* The modem resolves no names, the whole connect is timed. */
+    traceTCP_SOCKETS_CONNECT_START( pHostName, port );
+
+    #if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+        retConnect = prvDispatcherStart();
 
-    if( cellularSocketStatus != CELLULAR_SUCCESS )
+        if( retConnect != TCP_SOCKETS_ERRNO_NONE )
+        {
+            LogError( ( "Failed to create the cellular socket dispatcher." ) );
+        }
+    #endif
+
+    /* Create a new TCP socket. */
+    if( retConnect == TCP_SOCKETS_ERRNO_NONE )
     {
-        LogError( ( "Failed to create cellular sockets. %d", cellularSocketStatus ) );
-        retConnect = TCP_SOCKETS_ERRNO_ERROR;
+        cellularSocketStatus = Cellular_CreateSocket( CellularHandle,
+                                                      CellularSocketPdnContextId,
+                                                      CELLULAR_SOCKET_DOMAIN_AF_INET,
+                                                      CELLULAR_SOCKET_TYPE_STREAM,
+                                                      CELLULAR_SOCKET_PROTOCOL_TCP,
+                                                      &cellularSocketHandle );
+
+        if( cellularSocketStatus != CELLULAR_SUCCESS )
+        {
+            LogError( ( "Failed to create cellular sockets. %d", cellularSocketStatus ) );
+            retConnect = TCP_SOCKETS_ERRNO_ERROR;
+        }
     }
 
     /* Allocate socket context. */
@@ -711,6 +1336,15 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
         }
     }
 
+    #if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+        if( retConnect == TCP_SOCKETS_ERRNO_NONE )
+        {
+            prvDispatcherAdd( pCellularSocketContext );
+        }
+    #endif
+
+    traceTCP_SOCKETS_CONNECT_END( pHostName, port, retConnect );
+
     /* Cleanup the socket if any error. */
     if( retConnect != TCP_SOCKETS_ERRNO_NONE )
     {
@@ -770,8 +1404,20 @@ void TCP_Sockets_Disconnect( Socket_t xSocket )
 
     if( retClose == TCP_SOCKETS_ERRNO_NONE )
     {
+        #if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+            /* From here on only this task reads the socket. */
+            prvDispatcherRemove( pCellularSocketContext );
+        #endif
+
         if( cellularSocketHandle != NULL )
         {
+            #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+                if( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) != 0U )
+                {
+                    ( void ) prvFlushSendBuffer( pCellularSocketContext );
+                }
+            #endif
+
             /* Receive all the data before socket close. */
             do
             {
@@ -829,6 +1475,11 @@ int32_t TCP_Sockets_Recv( Socket_t xSocket,
     }
     else
     {
+        #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+            /* A reply can only come once the request has gone out. */
+            ( void ) prvFlushSendBuffer( pCellularSocketContext );
+        #endif
+
         retRecvLength = ( BaseType_t ) prvNetworkRecvCellular( pCellularSocketContext, buf, xBufferLength );
     }
 
@@ -837,24 +1488,21 @@ int32_t TCP_Sockets_Recv( Socket_t xSocket,
 
 /*-----------------------------------------------------------*/
 
-/* This function sends the data until timeout or data is completely sent to server.
- * Send timeout unit is TickType_t. Any timeout value greater than UINT32_MAX_MS_TICKS
- * or portMAX_DELAY will be regarded as MAX delay. In this case, this function
- * will not return until all bytes of data are sent successfully or until an error occurs. */
+/* This function sends the data until timeout or data is completely sent to server,
+ * or, with CELLULAR_SOCKET_SEND_BUFFER_SIZE, adds short writes to the socket
+ * send buffer. */
 int32_t TCP_Sockets_Send( Socket_t xSocket,
                           const void * pvBuffer,
                           size_t xDataLength )
 {
-    uint8_t * buf = ( uint8_t * ) pvBuffer;
-    CellularSocketHandle_t cellularSocketHandle = NULL;
+    const uint8_t * buf = ( const uint8_t * ) pvBuffer;
     BaseType_t retSendLength = 0;
-    uint32_t sentLength = 0;
-    CellularError_t socketStatus = CELLULAR_SUCCESS;
     cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
-    uint32_t bytesToSend = xDataLength;
-    uint64_t entryTimeMs = getTimeMs();
-    uint64_t elapsedTimeMs = 0;
-    uint32_t sendTimeoutMs = 0;
+
+    #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+        BaseType_t retFlush = TCP_SOCKETS_ERRNO_NONE;
+        uint64_t elapsedTimeMs = 0;
+    #endif
 
     if( pCellularSocketContext == NULL )
     {
@@ -870,56 +1518,186 @@ int32_t TCP_Sockets_Send( Socket_t xSocket,
     }
     else
     {
-        cellularSocketHandle = pCellularSocketContext->cellularSocketHandle;
-
-        /* Convert ticks to ms delay. */
-        if( ( pCellularSocketContext->sendTimeout >= UINT32_MAX_MS_TICKS ) || ( pCellularSocketContext->sendTimeout >= portMAX_DELAY ) )
-        {
-            /* Check if the ticks cause overflow. */
-            sendTimeoutMs = UINT32_MAX_DELAY_MS;
-        }
-        else
-        {
-            sendTimeoutMs = TICKS_TO_MS( pCellularSocketContext->sendTimeout );
-        }
-
-        /* Loop sending data until data is sent completely or timeout. */
-        while( bytesToSend > 0U )
-        {
-            socketStatus = Cellular_SocketSend( CellularHandle,
-                                                cellularSocketHandle,
-                                                &buf[ retSendLength ],
-                                                bytesToSend,
-                                                &sentLength );
-
-            if( socketStatus == CELLULAR_SUCCESS )
+        #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
             {
-                retSendLength = retSendLength + ( BaseType_t ) sentLength;
-                bytesToSend = bytesToSend - sentLength;
-            }
+                /* Make room, or send what is buffered ahead of a write too long
+                 * to buffer. */
+                if( ( pCellularSocketContext->sendBufferLength + xDataLength ) > CELLULAR_SOCKET_SEND_BUFFER_SIZE )
+                {
+                    retFlush = prvFlushSendBuffer( pCellularSocketContext );
+                }
 
-            /* Check socket status or timeout break. */
-            if( ( socketStatus != CELLULAR_SUCCESS ) ||
-                ( _calculateElapsedTime( entryTimeMs, sendTimeoutMs, &elapsedTimeMs ) ) )
-            {
-                if( socketStatus == CELLULAR_SOCKET_CLOSED )
+                if( retFlush == TCP_SOCKETS_ERRNO_ERROR )
                 {
-                    /* Socket already closed. No data is sent. */
-                    retSendLength = 0;
+                    retSendLength = retFlush;
                 }
-                else if( socketStatus != CELLULAR_SUCCESS )
+                else if( ( pCellularSocketContext->sendBufferLength == 0U ) &&
+                         ( xDataLength >= CELLULAR_SOCKET_SEND_BUFFER_SIZE ) )
                 {
-                    retSendLength = ( BaseType_t ) TCP_SOCKETS_ERRNO_ERROR;
+                    /* Nothing is saved by buffering a long write. */
+                    retSendLength = prvCellularSocketSend( pCellularSocketContext, buf, ( uint32_t ) xDataLength );
                 }
+                else if( ( pCellularSocketContext->sendBufferLength + xDataLength ) <= CELLULAR_SOCKET_SEND_BUFFER_SIZE )
+                {
+                    if( pCellularSocketContext->sendBufferLength == 0U )
+                    {
+                        pCellularSocketContext->sendBufferTimeMs = getTimeMs();
+                    }
+
+                    ( void ) memcpy( &pCellularSocketContext->sendBuffer[ pCellularSocketContext->sendBufferLength ],
+                                     buf, xDataLength );
+                    pCellularSocketContext->sendBufferLength += ( uint32_t ) xDataLength;
+                    retSendLength = ( BaseType_t ) xDataLength;
+
+                    if( ( pCellularSocketContext->sendBufferLength == CELLULAR_SOCKET_SEND_BUFFER_SIZE ) ||
+                        ( _calculateElapsedTime( pCellularSocketContext->sendBufferTimeMs,
+                                                 CELLULAR_SOCKET_SEND_FLUSH_MS,
+                                                 &elapsedTimeMs ) ) )
+                    {
+                        /* The write is taken either way. What the send timeout
+                         * cuts off is sent by the next flush. */
+                        if( prvFlushSendBuffer( pCellularSocketContext ) == TCP_SOCKETS_ERRNO_ERROR )
+                        {
+                            retSendLength = ( BaseType_t ) TCP_SOCKETS_ERRNO_ERROR;
+                        }
+                    }
+                }
+                else
+                {
+                    /* Older data still waits for the modem, so nothing of this
+                     * write is taken yet. */
+                    retSendLength = 0;
+                }
+            }
+        #else /* if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U ) */
+            {
+                retSendLength = prvCellularSocketSend( pCellularSocketContext, buf, ( uint32_t ) xDataLength );
+            }
+        #endif /* if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U ) */
+    }
 
-                break;
+    return retSendLength;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_SetReadySemaphore( Socket_t xSocket,
+                                          SemaphoreHandle_t xSemaphore )
+{
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
+    BaseType_t retSetSemaphore = TCP_SOCKETS_ERRNO_NONE;
+
+    /* coverity[misra_c_2012_rule_11_4_violation] */
+    if( ( pCellularSocketContext == NULL ) || ( xSocket == CELLULAR_INVALID_SOCKET ) )
+    {
+        LogError( ( "Cellular TCP_Sockets_SetReadySemaphore Invalid xSocket %p", pCellularSocketContext ) );
+        retSetSemaphore = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else
+    {
+        /* Given from the data ready and closed callbacks. */
+        pCellularSocketContext->readySemaphore = xSemaphore;
+    }
+
+    return retSetSemaphore;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t TCP_Sockets_Poll( Socket_t xSocket )
+{
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
+    int32_t retPoll = 0;
+    CellularError_t socketStatus = CELLULAR_SUCCESS;
+
+    #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+        /* coverity[misra_c_2012_rule_11_4_violation] */
+        if( ( pCellularSocketContext != NULL ) && ( xSocket != CELLULAR_INVALID_SOCKET ) &&
+            ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_OPEN_FLAG ) != 0U ) &&
+            ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) != 0U ) )
+        {
+            /* Callers poll before waiting for a reply, so send the request now. */
+            ( void ) prvFlushSendBuffer( pCellularSocketContext );
+        }
+    #endif
+
+    /* coverity[misra_c_2012_rule_11_4_violation] */
+    if( ( pCellularSocketContext == NULL ) || ( xSocket == CELLULAR_INVALID_SOCKET ) )
+    {
+        LogError( ( "Cellular TCP_Sockets_Poll Invalid xSocket %p", pCellularSocketContext ) );
+        retPoll = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else if( pCellularSocketContext->recvBufferLength > 0U )
+    {
+        retPoll = ( int32_t ) pCellularSocketContext->recvBufferLength;
+    }
+    else if( ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_OPEN_FLAG ) == 0U ) ||
+             ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) == 0U ) )
+    {
+        retPoll = TCP_SOCKETS_ERRNO_ENOTCONN;
+    }
+    else
+    {
+        #if ( CELLULAR_SOCKET_DISPATCHER == 1 )
+            /* The dispatcher reads as soon as the modem reports data, only
+             * its failures are left to report. */
+            socketStatus = pCellularSocketContext->dispatchStatus;
+        #else
+            if( ( xEventGroupGetBits( pCellularSocketContext->socketEventGroupHandle ) &
+                  SOCKET_DATA_RECEIVED_CALLBACK_BIT ) != 0U )
+            {
+                /* Only ask the modem when it reported data, the answer is kept for
+                 * the TCP_Sockets_Recv that follows. */
+                ( void ) xEventGroupClearBits( pCellularSocketContext->socketEventGroupHandle,
+                                               SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+                socketStatus = prvFillRecvBuffer( pCellularSocketContext );
             }
+        #endif
+
+        if( socketStatus == CELLULAR_SUCCESS )
+        {
+            retPoll = ( int32_t ) pCellularSocketContext->recvBufferLength;
+        }
+        else if( socketStatus == CELLULAR_SOCKET_CLOSED )
+        {
+            retPoll = TCP_SOCKETS_ERRNO_ECLOSED;
+        }
+        else
+        {
+            LogError( ( "TCP_Sockets_Poll failed %d", socketStatus ) );
+            retPoll = TCP_SOCKETS_ERRNO_ERROR;
         }
+    }
+
+    return retPoll;
+}
 
-        LogDebug( ( "TCP_Sockets_Send expect %d write %d", xDataLength, sentLength ) );
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_Flush( Socket_t xSocket )
+{
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
+    BaseType_t retFlush = TCP_SOCKETS_ERRNO_NONE;
+
+    /* coverity[misra_c_2012_rule_11_4_violation] */
+    if( ( pCellularSocketContext == NULL ) || ( xSocket == CELLULAR_INVALID_SOCKET ) )
+    {
+        LogError( ( "Cellular TCP_Sockets_Flush Invalid xSocket %p", pCellularSocketContext ) );
+        retFlush = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else if( ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_OPEN_FLAG ) == 0U ) ||
+             ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) == 0U ) )
+    {
+        retFlush = TCP_SOCKETS_ERRNO_ENOTCONN;
+    }
+    else
+    {
+        #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+            retFlush = prvFlushSendBuffer( pCellularSocketContext );
+        #endif
     }
 
-    return retSendLength;
+    return retFlush;
 }
 
 /*-----------------------------------------------------------*/
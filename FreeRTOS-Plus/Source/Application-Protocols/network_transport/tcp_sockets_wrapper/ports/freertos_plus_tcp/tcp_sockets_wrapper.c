@@ -73,6 +73,513 @@ extern void vLoggingPrintf( const char * pcFormatString,
  */
 #define FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR    ( -1 )
 
+/**
+ * @brief Most addresses of one host that are tried when connecting.
+ */
+#ifndef TCP_SOCKETS_CONNECT_MAX_ADDRESSES
+    #define TCP_SOCKETS_CONNECT_MAX_ADDRESSES    ( 4U )
+#endif
+
+/**
+ * @brief Delay after starting a connection attempt before the next address is
+ * tried while the first attempt is still pending (RFC 8305 "Happy Eyeballs").
+ */
+#ifndef TCP_SOCKETS_CONNECT_ATTEMPT_DELAY_MS
+    #define TCP_SOCKETS_CONNECT_ATTEMPT_DELAY_MS    ( 250U )
+#endif
+
+/**
+ * @brief Interval at which pending connection attempts are checked.
+ */
+#ifndef TCP_SOCKETS_CONNECT_POLL_MS
+    #define TCP_SOCKETS_CONNECT_POLL_MS    ( 10U )
+#endif
+
+/**
+ * @brief Number of host names whose addresses are kept between connections,
+ * 0 to resolve the name on every call.
+ *
+ * The cache is shared by every transport that connects through this wrapper
+ * so that a reconnect storm after a network outage does not send a query per
+ * connection. FreeRTOS+TCP does not report the TTL of the records it returns;
+ * the records are already cached for their TTL by the stack when
+ * ipconfigUSE_DNS_CACHE is 1, and this cache keeps them for at most
+ * TCP_SOCKETS_DNS_CACHE_TTL_MS more. An entry is dropped as soon as none of
+ * its addresses accepts a connection.
+ */
+#ifndef TCP_SOCKETS_DNS_CACHE_ENTRIES
+    #define TCP_SOCKETS_DNS_CACHE_ENTRIES    ( 0U )
+#endif
+
+/**
+ * @brief Longest time an entry of the wrapper's DNS cache is used.
+ */
+#ifndef TCP_SOCKETS_DNS_CACHE_TTL_MS
+    #define TCP_SOCKETS_DNS_CACHE_TTL_MS    ( 60000U )
+#endif
+
+/**
+ * @brief Size of the host name buffer of a DNS cache entry, including the
+ * terminator. Longer names are not cached.
+ */
+#ifndef TCP_SOCKETS_DNS_CACHE_NAME_LENGTH
+    #define TCP_SOCKETS_DNS_CACHE_NAME_LENGTH    ( 64U )
+#endif
+
+#if ( TCP_SOCKETS_CONNECT_MAX_ADDRESSES < 1U )
+    #error "TCP_SOCKETS_CONNECT_MAX_ADDRESSES must be at least 1."
+#endif
+
+#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+    #define TCP_SOCKETS_USE_GETADDRINFO    ( 1 )
+#else
+    #define TCP_SOCKETS_USE_GETADDRINFO    ( 0 )
+#endif
+
+/**
+ * @brief Resolved addresses of one host.
+ */
+typedef struct HostAddresses
+{
+    struct freertos_sockaddr xAddresses[ TCP_SOCKETS_CONNECT_MAX_ADDRESSES ];
+    size_t uxCount;
+} HostAddresses_t;
+
+#if ( TCP_SOCKETS_DNS_CACHE_ENTRIES > 0U )
+
+/**
+ * @brief One entry of the wrapper's DNS cache.
+ */
+    typedef struct DnsCacheEntry
+    {
+        char cHostName[ TCP_SOCKETS_DNS_CACHE_NAME_LENGTH ];
+        HostAddresses_t xHost;
+        TickType_t xStoredTime;
+    } DnsCacheEntry_t;
+
+/**
+ * @brief The DNS cache, an empty host name marks a free entry.
+ */
+    static DnsCacheEntry_t xDnsCache[ TCP_SOCKETS_DNS_CACHE_ENTRIES ];
+
+/**
+ * @brief The entry replaced when the cache is full.
+ */
+    static size_t uxDnsCacheNext = 0U;
+#endif /* TCP_SOCKETS_DNS_CACHE_ENTRIES > 0U */
+
+/*-----------------------------------------------------------*/
+
+#if ( TCP_SOCKETS_DNS_CACHE_ENTRIES > 0U )
+
+/**
+ * @brief Find the entry of a host name in the DNS cache.
+ *
+ * Must be called from a critical section.
+ *
+ * @param[in] pHostName The host name.
+ *
+ * @return The entry, or NULL if the name is not cached.
+ */
+    static DnsCacheEntry_t * prvDnsCacheFind( const char * pHostName )
+    {
+        DnsCacheEntry_t * pxEntry = NULL;
+        size_t uxIndex;
+
+        for( uxIndex = 0U; uxIndex < TCP_SOCKETS_DNS_CACHE_ENTRIES; uxIndex++ )
+        {
+            if( ( xDnsCache[ uxIndex ].cHostName[ 0 ] != '\0' ) &&
+                ( strncmp( xDnsCache[ uxIndex ].cHostName, pHostName, TCP_SOCKETS_DNS_CACHE_NAME_LENGTH ) == 0 ) )
+            {
+                pxEntry = &( xDnsCache[ uxIndex ] );
+                break;
+            }
+        }
+
+        return pxEntry;
+    }
+
+/**
+ * @brief Copy the cached addresses of a host name.
+ *
+ * @param[in] pHostName The host name.
+ * @param[out] pxHost Receives the addresses.
+ *
+ * @return pdTRUE if a fresh entry was found, else pdFALSE.
+ */
+    static BaseType_t prvDnsCacheLookup( const char * pHostName,
+                                         HostAddresses_t * pxHost )
+    {
+        DnsCacheEntry_t * pxEntry;
+        BaseType_t xFound = pdFALSE;
+
+        taskENTER_CRITICAL();
+        {
+            pxEntry = prvDnsCacheFind( pHostName );
+
+            if( pxEntry != NULL )
+            {
+                if( ( xTaskGetTickCount() - pxEntry->xStoredTime ) < pdMS_TO_TICKS( TCP_SOCKETS_DNS_CACHE_TTL_MS ) )
+                {
+                    ( void ) memcpy( pxHost, &( pxEntry->xHost ), sizeof( HostAddresses_t ) );
+                    xFound = pdTRUE;
+                }
+                else
+                {
+                    pxEntry->cHostName[ 0 ] = '\0';
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return xFound;
+    }
+
+/**
+ * @brief Store the addresses of a host name in the DNS cache.
+ *
+ * @param[in] pHostName The host name.
+ * @param[in] pxHost The addresses.
+ */
+    static void prvDnsCacheStore( const char * pHostName,
+                                  const HostAddresses_t * pxHost )
+    {
+        DnsCacheEntry_t * pxEntry;
+        size_t uxIndex;
+        size_t uxNameLength = strlen( pHostName );
+
+        if( uxNameLength < TCP_SOCKETS_DNS_CACHE_NAME_LENGTH )
+        {
+            taskENTER_CRITICAL();
+            {
+                pxEntry = prvDnsCacheFind( pHostName );
+
+                for( uxIndex = 0U; ( pxEntry == NULL ) && ( uxIndex < TCP_SOCKETS_DNS_CACHE_ENTRIES ); uxIndex++ )
+                {
+                    if( xDnsCache[ uxIndex ].cHostName[ 0 ] == '\0' )
+                    {
+                        pxEntry = &( xDnsCache[ uxIndex ] );
+                    }
+                }
+
+                if( pxEntry == NULL )
+                {
+                    pxEntry = &( xDnsCache[ uxDnsCacheNext ] );
+                    uxDnsCacheNext = ( uxDnsCacheNext + 1U ) % TCP_SOCKETS_DNS_CACHE_ENTRIES;
+                }
+
+                ( void ) memcpy( pxEntry->cHostName, pHostName, uxNameLength + 1U );
+                ( void ) memcpy( &( pxEntry->xHost ), pxHost, sizeof( HostAddresses_t ) );
+                pxEntry->xStoredTime = xTaskGetTickCount();
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+
+/**
+ * @brief Drop the entry of a host name from the DNS cache.
+ *
+ * @param[in] pHostName The host name.
+ */
+    static void prvDnsCacheRemove( const char * pHostName )
+    {
+        DnsCacheEntry_t * pxEntry;
+
+        taskENTER_CRITICAL();
+        {
+            pxEntry = prvDnsCacheFind( pHostName );
+
+            if( pxEntry != NULL )
+            {
+                pxEntry->cHostName[ 0 ] = '\0';
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+#endif /* TCP_SOCKETS_DNS_CACHE_ENTRIES > 0U */
+
+/*-----------------------------------------------------------*/
+
+#if ( TCP_SOCKETS_USE_GETADDRINFO == 1 )
+
+/**
+ * @brief Query the addresses of one family of a host name.
+ *
+ * @param[in] pHostName The host name.
+ * @param[in] xFamily FREERTOS_AF_INET4 or FREERTOS_AF_INET6.
+ * @param[in] port Server port, stored in the addresses.
+ * @param[out] pxAddresses Receives the addresses.
+ *
+ * @return The number of addresses found.
+ */
+    static size_t prvQueryFamily( const char * pHostName,
+                                  BaseType_t xFamily,
+                                  uint16_t port,
+                                  struct freertos_sockaddr * pxAddresses )
+    {
+        struct freertos_addrinfo xHints;
+        struct freertos_addrinfo * pxResult = NULL;
+        const struct freertos_addrinfo * pxIter;
+        size_t uxCount = 0U;
+
+        ( void ) memset( &xHints, 0, sizeof( xHints ) );
+        xHints.ai_family = xFamily;
+
+        if( FreeRTOS_getaddrinfo( pHostName, NULL, &xHints, &pxResult ) == 0 )
+        {
+            for( pxIter = pxResult;
+                 ( pxIter != NULL ) && ( uxCount < TCP_SOCKETS_CONNECT_MAX_ADDRESSES );
+                 pxIter = pxIter->ai_next )
+            {
+                if( ( pxIter->ai_family == xFamily ) && ( pxIter->ai_addr != NULL ) )
+                {
+                    ( void ) memcpy( &( pxAddresses[ uxCount ] ), pxIter->ai_addr, sizeof( struct freertos_sockaddr ) );
+                    pxAddresses[ uxCount ].sin_family = ( uint8_t ) xFamily;
+                    pxAddresses[ uxCount ].sin_port = FreeRTOS_htons( port );
+                    pxAddresses[ uxCount ].sin_len = ( uint8_t ) sizeof( struct freertos_sockaddr );
+                    uxCount++;
+                }
+            }
+        }
+
+        if( pxResult != NULL )
+        {
+            FreeRTOS_freeaddrinfo( pxResult );
+        }
+
+        return uxCount;
+    }
+
+#endif /* TCP_SOCKETS_USE_GETADDRINFO == 1 */
+
+/**
+ * @brief Resolve a host name.
+ *
+ * With IPv6 the AAAA and A records are both queried and the addresses are
+ * interleaved, IPv6 first, so that a broken path of one family only delays
+ * the connection by TCP_SOCKETS_CONNECT_ATTEMPT_DELAY_MS.
+ *
+ * @param[in] pHostName The host name.
+ * @param[in] port Server port, stored in the addresses.
+ * @param[out] pxHost Receives the addresses.
+ */
+static void prvResolveHost( const char * pHostName,
+                            uint16_t port,
+                            HostAddresses_t * pxHost )
+{
+    ( void ) memset( pxHost, 0, sizeof( HostAddresses_t ) );
+
+    traceTCP_SOCKETS_DNS_START( pHostName );
+
+    #if ( TCP_SOCKETS_USE_GETADDRINFO == 1 )
+    {
+        struct freertos_sockaddr xIPv4[ TCP_SOCKETS_CONNECT_MAX_ADDRESSES ];
+        size_t uxIPv4Count;
+        size_t uxIPv4Index = 0U;
+
+        uxIPv4Count = prvQueryFamily( pHostName, FREERTOS_AF_INET4, port, xIPv4 );
+
+        #if ( ipconfigUSE_IPv6 != 0 )
+        {
+            struct freertos_sockaddr xIPv6[ TCP_SOCKETS_CONNECT_MAX_ADDRESSES ];
+            size_t uxIPv6Count;
+            size_t uxIPv6Index = 0U;
+
+            uxIPv6Count = prvQueryFamily( pHostName, FREERTOS_AF_INET6, port, xIPv6 );
+
+            while( ( uxIPv6Index < uxIPv6Count ) && ( pxHost->uxCount < TCP_SOCKETS_CONNECT_MAX_ADDRESSES ) )
+            {
+                pxHost->xAddresses[ pxHost->uxCount ] = xIPv6[ uxIPv6Index ];
+                pxHost->uxCount++;
+                uxIPv6Index++;
+
+                if( ( uxIPv4Index < uxIPv4Count ) && ( pxHost->uxCount < TCP_SOCKETS_CONNECT_MAX_ADDRESSES ) )
+                {
+                    pxHost->xAddresses[ pxHost->uxCount ] = xIPv4[ uxIPv4Index ];
+                    pxHost->uxCount++;
+                    uxIPv4Index++;
+                }
+            }
+        }
+        #endif /* ipconfigUSE_IPv6 != 0 */
+
+        while( ( uxIPv4Index < uxIPv4Count ) && ( pxHost->uxCount < TCP_SOCKETS_CONNECT_MAX_ADDRESSES ) )
+        {
+            pxHost->xAddresses[ pxHost->uxCount ] = xIPv4[ uxIPv4Index ];
+            pxHost->uxCount++;
+            uxIPv4Index++;
+        }
+    }
+    #else /* TCP_SOCKETS_USE_GETADDRINFO == 1 */
+    {
+        uint32_t ulIPAddress = ( uint32_t ) FreeRTOS_gethostbyname( pHostName );
+
+        if( ulIPAddress != 0U )
+        {
+            pxHost->xAddresses[ 0 ].sin_family = FREERTOS_AF_INET;
+            pxHost->xAddresses[ 0 ].sin_port = FreeRTOS_htons( port );
+            pxHost->xAddresses[ 0 ].sin_len = ( uint8_t ) sizeof( struct freertos_sockaddr );
+            pxHost->xAddresses[ 0 ].sin_addr = ulIPAddress;
+            pxHost->uxCount = 1U;
+        }
+    }
+    #endif /* TCP_SOCKETS_USE_GETADDRINFO == 1 */
+
+    traceTCP_SOCKETS_DNS_END( pHostName );
+}
+
+/**
+ * @brief Start a non-blocking connection attempt to one address.
+ *
+ * @param[in] pxAddress The server address.
+ *
+ * @return The connecting socket, or FREERTOS_INVALID_SOCKET on failure.
+ */
+static Socket_t prvStartConnect( const struct freertos_sockaddr * pxAddress )
+{
+    Socket_t tcpSocket;
+    TickType_t xNoBlock = 0U;
+    BaseType_t xResult;
+
+    tcpSocket = FreeRTOS_socket( pxAddress->sin_family, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+    if( tcpSocket == FREERTOS_INVALID_SOCKET )
+    {
+        LogError( ( "Failed to create new socket." ) );
+    }
+    else
+    {
+        /* FreeRTOS_connect() blocks for the receive timeout; with none it
+         * only sends the SYN and the state is checked by the caller. */
+        ( void ) FreeRTOS_setsockopt( tcpSocket,
+                                      0,
+                                      FREERTOS_SO_RCVTIMEO,
+                                      &xNoBlock,
+                                      sizeof( TickType_t ) );
+
+        xResult = FreeRTOS_connect( tcpSocket, pxAddress, sizeof( struct freertos_sockaddr ) );
+
+        if( ( xResult != 0 ) &&
+            ( xResult != -pdFREERTOS_ERRNO_EINPROGRESS ) &&
+            ( xResult != -pdFREERTOS_ERRNO_EWOULDBLOCK ) )
+        {
+            LogDebug( ( "FreeRTOS_connect failed: ReturnCode=%d.", ( int ) xResult ) );
+            ( void ) FreeRTOS_closesocket( tcpSocket );
+            tcpSocket = FREERTOS_INVALID_SOCKET;
+        }
+    }
+
+    return tcpSocket;
+}
+
+/**
+ * @brief Connect to the first address of a host that answers.
+ *
+ * The addresses are tried in order, each TCP_SOCKETS_CONNECT_ATTEMPT_DELAY_MS
+ * after the previous one or as soon as all earlier attempts have failed, with
+ * the earlier attempts left running. The first connection established is
+ * kept and the others are closed. The attempts are given up after the default
+ * receive block time, which is how long a single blocking FreeRTOS_connect()
+ * would have waited.
+ *
+ * @param[in] pxHost The addresses of the host.
+ *
+ * @return The connected socket, or FREERTOS_INVALID_SOCKET on failure.
+ */
+static Socket_t prvConnectHost( const HostAddresses_t * pxHost )
+{
+    Socket_t xSockets[ TCP_SOCKETS_CONNECT_MAX_ADDRESSES ];
+    Socket_t tcpSocket = FREERTOS_INVALID_SOCKET;
+    TickType_t xStartTime = xTaskGetTickCount();
+    TickType_t xElapsed = 0U;
+    TickType_t xNextAttempt = 0U;
+    size_t uxStarted = 0U;
+    size_t uxPending = 0U;
+    size_t uxIndex;
+    BaseType_t xState;
+    TickType_t xPollTicks = pdMS_TO_TICKS( TCP_SOCKETS_CONNECT_POLL_MS );
+
+    if( xPollTicks == 0U )
+    {
+        xPollTicks = 1U;
+    }
+
+    for( ; ; )
+    {
+        if( ( uxStarted < pxHost->uxCount ) && ( ( xElapsed >= xNextAttempt ) || ( uxPending == 0U ) ) )
+        {
+            xSockets[ uxStarted ] = prvStartConnect( &( pxHost->xAddresses[ uxStarted ] ) );
+
+            if( xSockets[ uxStarted ] != FREERTOS_INVALID_SOCKET )
+            {
+                uxPending++;
+            }
+
+            uxStarted++;
+            xNextAttempt = xElapsed + pdMS_TO_TICKS( TCP_SOCKETS_CONNECT_ATTEMPT_DELAY_MS );
+        }
+
+        for( uxIndex = 0U; uxIndex < uxStarted; uxIndex++ )
+        {
+            if( xSockets[ uxIndex ] != FREERTOS_INVALID_SOCKET )
+            {
+                xState = FreeRTOS_connstatus( xSockets[ uxIndex ] );
+
+                if( ( xState == ( BaseType_t ) eESTABLISHED ) && ( tcpSocket == FREERTOS_INVALID_SOCKET ) )
+                {
+                    tcpSocket = xSockets[ uxIndex ];
+                    xSockets[ uxIndex ] = FREERTOS_INVALID_SOCKET;
+                    uxPending--;
+                }
+                else if( ( xState == ( BaseType_t ) eCLOSED ) || ( xState == ( BaseType_t ) eCLOSE_WAIT ) )
+                {
+                    ( void ) FreeRTOS_closesocket( xSockets[ uxIndex ] );
+                    xSockets[ uxIndex ] = FREERTOS_INVALID_SOCKET;
+                    uxPending--;
+                }
+                else
+                {
+                    /* Still connecting. */
+                }
+            }
+        }
+
+        if( ( tcpSocket != FREERTOS_INVALID_SOCKET ) ||
+            ( ( uxPending == 0U ) && ( uxStarted == pxHost->uxCount ) ) )
+        {
+            break;
+        }
+
+        if( ( ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME != portMAX_DELAY ) &&
+            ( xElapsed >= ( TickType_t ) ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME ) )
+        {
+            LogDebug( ( "Connection attempts timed out." ) );
+            break;
+        }
+
+        if( uxPending != 0U )
+        {
+            vTaskDelay( xPollTicks );
+        }
+
+        xElapsed = xTaskGetTickCount() - xStartTime;
+    }
+
+    /* Abandon the attempts that lost. */
+    for( uxIndex = 0U; uxIndex < uxStarted; uxIndex++ )
+    {
+        if( xSockets[ uxIndex ] != FREERTOS_INVALID_SOCKET )
+        {
+            ( void ) FreeRTOS_closesocket( xSockets[ uxIndex ] );
+        }
+    }
+
+    return tcpSocket;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Establish a connection to server.
  *
@@ -94,51 +601,61 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
 {
     Socket_t tcpSocket = FREERTOS_INVALID_SOCKET;
     BaseType_t socketStatus = 0;
-    struct freertos_sockaddr serverAddress = { 0 };
+    BaseType_t xCached = pdFALSE;
+    HostAddresses_t xHost;
     TickType_t transportTimeout = 0;
 
     configASSERT( pTcpSocket != NULL );
     configASSERT( pHostName != NULL );
 
-    /* Create a new TCP socket. */
-    tcpSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+    #if ( TCP_SOCKETS_DNS_CACHE_ENTRIES > 0U )
+        xCached = prvDnsCacheLookup( pHostName, &xHost );
+    #endif
 
-    if( tcpSocket == FREERTOS_INVALID_SOCKET )
+    if( xCached == pdFALSE )
     {
-        LogError( ( "Failed to create new socket." ) );
+        prvResolveHost( pHostName, port, &xHost );
+    }
+
+    if( xHost.uxCount == 0U )
+    {
+        LogError( ( "Failed to connect to server: DNS resolution failed: Hostname=%s.",
+                    pHostName ) );
         socketStatus = FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR;
     }
     else
     {
-        LogDebug( ( "Created new TCP socket." ) );
+        /* Establish connection. */
+        LogDebug( ( "Creating TCP Connection to %s.", pHostName ) );
+        traceTCP_SOCKETS_CONNECT_START( pHostName, port );
+        tcpSocket = prvConnectHost( &xHost );
 
-        /* Connection parameters. */
-        serverAddress.sin_family = FREERTOS_AF_INET;
-        serverAddress.sin_port = FreeRTOS_htons( port );
-        serverAddress.sin_len = ( uint8_t ) sizeof( serverAddress );
+        #if ( TCP_SOCKETS_DNS_CACHE_ENTRIES > 0U )
+            if( ( tcpSocket == FREERTOS_INVALID_SOCKET ) && ( xCached == pdTRUE ) )
+            {
+                /* The host may have moved, look it up again. */
+                prvDnsCacheRemove( pHostName );
+                xCached = pdFALSE;
+                prvResolveHost( pHostName, port, &xHost );
+
+                if( xHost.uxCount > 0U )
+                {
+                    tcpSocket = prvConnectHost( &xHost );
+                }
+            }
 
-#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-        serverAddress.sin_address.ulIP_IPv4 = ( uint32_t ) FreeRTOS_gethostbyname( pHostName );
-        /* Check for errors from DNS lookup. */
-        if( serverAddress.sin_address.ulIP_IPv4 == 0U )
-#else
-        serverAddress.sin_addr = ( uint32_t ) FreeRTOS_gethostbyname( pHostName );
-        /* Check for errors from DNS lookup. */
-        if( serverAddress.sin_addr == 0U )
-#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+            if( ( tcpSocket != FREERTOS_INVALID_SOCKET ) && ( xCached == pdFALSE ) )
+            {
+                prvDnsCacheStore( pHostName, &xHost );
+            }
+        #endif /* TCP_SOCKETS_DNS_CACHE_ENTRIES > 0U */
 
+        if( tcpSocket == FREERTOS_INVALID_SOCKET )
         {
-            LogError( ( "Failed to connect to server: DNS resolution failed: Hostname=%s.",
-                        pHostName ) );
             socketStatus = FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR;
         }
-    }
 
-    if( socketStatus == 0 )
-    {
-        /* Establish connection. */
-        LogDebug( ( "Creating TCP Connection to %s.", pHostName ) );
-        socketStatus = FreeRTOS_connect( tcpSocket, &serverAddress, sizeof( serverAddress ) );
+        traceTCP_SOCKETS_CONNECT_END( pHostName, port, socketStatus );
 
         if( socketStatus != 0 )
         {
@@ -169,19 +686,7 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
                                       FREERTOS_SO_SNDTIMEO,
                                       &transportTimeout,
                                       sizeof( TickType_t ) );
-    }
 
-    /* Clean up on failure. */
-    if( socketStatus != 0 )
-    {
-        if( tcpSocket != FREERTOS_INVALID_SOCKET )
-        {
-            ( void ) FreeRTOS_closesocket( tcpSocket );
-            tcpSocket = FREERTOS_INVALID_SOCKET;
-        }
-    }
-    else
-    {
         /* Set the socket. */
         *pTcpSocket = tcpSocket;
         LogInfo( ( "Established TCP connection with %s.", pHostName ) );
@@ -205,6 +710,9 @@ void TCP_Sockets_Disconnect( Socket_t tcpSocket )
         /* Initiate graceful shutdown. */
         ( void ) FreeRTOS_shutdown( tcpSocket, FREERTOS_SHUT_RDWR );
 
+        /* The semaphore belongs to the application, stop giving it. */
+        ( void ) TCP_Sockets_SetReadySemaphore( tcpSocket, NULL );
+
         /* Wait for the socket to disconnect gracefully (indicated by FreeRTOS_recv()
          * returning a FREERTOS_EINVAL error) before closing the socket. */
         while( FreeRTOS_recv( tcpSocket, pDummyBuffer, sizeof( pDummyBuffer ), 0 ) >= 0 )
@@ -339,3 +847,98 @@ int32_t TCP_Sockets_Recv( Socket_t xSocket,
 
     return xReturnStatus;
 }
+
+/**
+ * @brief Set a semaphore that is given when a socket may have become readable.
+ *
+ * @param[in] xSocket The socket descriptor.
+ * @param[in] xSemaphore The semaphore to give, or NULL to stop.
+ *
+ * @return TCP_SOCKETS_ERRNO_NONE on success, TCP_SOCKETS_ERRNO_ENOPROTOOPT if
+ * ipconfigSOCKET_HAS_USER_SEMAPHORE is not enabled, else a negative value.
+ */
+BaseType_t TCP_Sockets_SetReadySemaphore( Socket_t xSocket,
+                                          SemaphoreHandle_t xSemaphore )
+{
+    BaseType_t xReturnStatus = TCP_SOCKETS_ERRNO_ENOPROTOOPT;
+
+    configASSERT( xSocket != NULL );
+
+    #if ( ipconfigSOCKET_HAS_USER_SEMAPHORE == 1 )
+        /* FreeRTOS+TCP gives the semaphore on every event of the socket. */
+        if( FreeRTOS_setsockopt( xSocket,
+                                 0,
+                                 FREERTOS_SO_SET_SEMAPHORE,
+                                 &xSemaphore,
+                                 sizeof( SemaphoreHandle_t ) ) == 0 )
+        {
+            xReturnStatus = TCP_SOCKETS_ERRNO_NONE;
+        }
+        else
+        {
+            xReturnStatus = TCP_SOCKETS_ERRNO_EINVAL;
+        }
+    #else
+        ( void ) xSemaphore;
+    #endif
+
+    return xReturnStatus;
+}
+
+/**
+ * @brief Check without blocking whether data can be received from a socket.
+ *
+ * @param[in] xSocket The socket descriptor.
+ *
+ * @return The number of bytes in the receive stream, 0 if it is empty, or a
+ * negative value if the connection is closed or the socket is invalid.
+ */
+int32_t TCP_Sockets_Poll( Socket_t xSocket )
+{
+    BaseType_t xRxSize;
+    int32_t xReturnStatus = 0;
+
+    configASSERT( xSocket != NULL );
+
+    xRxSize = FreeRTOS_rx_size( xSocket );
+
+    if( xRxSize > 0 )
+    {
+        xReturnStatus = ( int32_t ) xRxSize;
+    }
+    else if( xRxSize < 0 )
+    {
+        xReturnStatus = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else if( FreeRTOS_issocketconnected( xSocket ) != pdTRUE )
+    {
+        /* Data received before the close has been read. */
+        xReturnStatus = TCP_SOCKETS_ERRNO_ENOTCONN;
+    }
+    else
+    {
+        /* Empty else marker. */
+    }
+
+    return xReturnStatus;
+}
+
+/**
+ * @brief Send data that TCP_Sockets_Send() accepted but the port still holds.
+ *
+ * FreeRTOS_send() copies the data into the socket's transmit stream, from
+ * which the IP task sends it without a further call, so nothing is held back
+ * here.
+ *
+ * @param[in] xSocket The socket descriptor.
+ *
+ * @return TCP_SOCKETS_ERRNO_NONE.
+ */
+BaseType_t TCP_Sockets_Flush( Socket_t xSocket )
+{
+    configASSERT( xSocket != NULL );
+
+    ( void ) xSocket;
+
+    return TCP_SOCKETS_ERRNO_NONE;
+}
@@ -42,6 +42,7 @@
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 
 /* MbedTLS Bio TCP sockets wrapper include. */
 #include "mbedtls_bio_tcp_sockets_wrapper.h"
@@ -49,6 +50,16 @@
 /* TLS transport header. */
 #include "transport_mbedtls.h"
 
+/* mbed TLS memory pool include. */
+#if defined( MBEDTLS_MEMORY_BUFFER_ALLOC_C )
+    #include "mbedtls/memory_buffer_alloc.h"
+#endif
+
+/* PSA Crypto include, needed by TLS 1.3. */
+#if defined( MBEDTLS_USE_PSA_CRYPTO ) || defined( MBEDTLS_SSL_PROTO_TLS1_3 )
+    #include "psa/crypto.h"
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -66,6 +77,41 @@ struct NetworkContext
 
 /*-----------------------------------------------------------*/
 
+#if ( TLS_TRANSPORT_POOL_SIZE > 0U )
+
+    /**
+     * @brief States of a connection pool slot.
+     */
+    typedef enum TlsPoolState
+    {
+        TLS_POOL_FREE = 0, /**< No connection. */
+        TLS_POOL_IDLE,     /**< Connected, waiting to be reused. */
+        TLS_POOL_IN_USE    /**< Given to the application, or being connected or closed. */
+    } TlsPoolState_t;
+
+    /**
+     * @brief A connection pool slot.
+     */
+    typedef struct TlsPoolEntry
+    {
+        TlsTransportParams_t params;                            /**< The connection. */
+        char hostName[ TLS_TRANSPORT_POOL_HOST_NAME_MAX + 1U ]; /**< Host it is connected to. */
+        uint16_t port;                                          /**< Port it is connected to. */
+        const NetworkCredentials_t * pNetworkCredentials;       /**< Credentials it was made with. */
+        TickType_t releaseTime;                                 /**< When it last became idle. */
+        TlsPoolState_t state;                                   /**< State of the slot. */
+    } TlsPoolEntry_t;
+
+    /**
+     * @brief The connection pool. Slot states are changed in critical sections,
+     * a slot in use belongs to a single task.
+     */
+    static TlsPoolEntry_t connectionPool[ TLS_TRANSPORT_POOL_SIZE ];
+
+#endif /* if ( TLS_TRANSPORT_POOL_SIZE > 0U ) */
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Represents string to be logged when mbedTLS returned error
  * does not contain a high-level code.
@@ -206,6 +252,25 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
 static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
                                           const NetworkCredentials_t * pNetworkCredentials );
 
+/**
+ * @brief Offer a previously established session to the server, if there is one.
+ *
+ * @param[in] pSslContext SSL context that is set up but not yet handshaken.
+ * @param[in] pSession The session to resume, may be NULL.
+ */
+static void setSession( SSLContext_t * pSslContext,
+                        const TlsSession_t * pSession );
+
+/**
+ * @brief Keep the session established by a successful handshake for the next
+ * connection.
+ *
+ * @param[in] pSslContext SSL context after a successful handshake.
+ * @param[out] pSession Where to keep the session, may be NULL.
+ */
+static void getSession( SSLContext_t * pSslContext,
+                        TlsSession_t * pSession );
+
 /**
  * @brief Initialize mbedTLS.
  *
@@ -217,6 +282,45 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
 static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pEntropyContext,
                                          mbedtls_ctr_drbg_context * pCtrDrgbContext );
 
+/**
+ * @brief Convert #NetworkCredentials_t.maxFragmentLength to the code of the
+ * maximum fragment length extension.
+ *
+ * @param[in] maxFragmentLength 512, 1024, 2048, 4096, or 0 for 4096.
+ *
+ * @return The MBEDTLS_SSL_MAX_FRAG_LEN_* code, or MBEDTLS_SSL_MAX_FRAG_LEN_INVALID.
+ */
+static uint8_t maxFragmentLengthCode( uint16_t maxFragmentLength );
+
+#if ( TLS_TRANSPORT_POOL_SIZE > 0U )
+
+    /**
+     * @brief Disconnect idle pooled connections.
+     *
+     * @param[in] evictAll pdTRUE for all of them, pdFALSE only for those that
+     * have been idle longer than #TLS_TRANSPORT_POOL_IDLE_TIMEOUT_MS.
+     */
+    static void poolEvictIdle( BaseType_t evictAll );
+
+    /**
+     * @brief Check that the server has neither closed an idle pooled connection
+     * nor sent anything on it, such as a close-notify alert.
+     *
+     * @param[in] pEntry The pooled connection.
+     *
+     * @return pdTRUE if the connection can be reused.
+     */
+    static BaseType_t poolIsHealthy( TlsPoolEntry_t * pEntry );
+
+    /**
+     * @brief Disconnect a pooled connection.
+     *
+     * @param[in] pEntry The pooled connection, in use by the caller.
+     */
+    static void poolDisconnect( TlsPoolEntry_t * pEntry );
+
+#endif /* if ( TLS_TRANSPORT_POOL_SIZE > 0U ) */
+
 /*-----------------------------------------------------------*/
 
 static void sslContextInit( SSLContext_t * pSslContext )
@@ -339,6 +443,7 @@ static int32_t setCredentials( SSLContext_t * pSslContext,
                                const NetworkCredentials_t * pNetworkCredentials )
 {
     int32_t mbedtlsError = -1;
+    TlsCredentialCache_t * pCache = NULL;
 
     configASSERT( pSslContext != NULL );
     configASSERT( pNetworkCredentials != NULL );
@@ -355,11 +460,44 @@ static int32_t setCredentials( SSLContext_t * pSslContext,
     mbedtls_ssl_conf_cert_profile( &( pSslContext->config ),
                                    &( pSslContext->certProfile ) );
 
-    mbedtlsError = setRootCa( pSslContext,
-                              pNetworkCredentials->pRootCa,
-                              pNetworkCredentials->rootCaSize );
+    pCache = pNetworkCredentials->pCredentialCache;
+
+    if( ( pCache != NULL ) &&
+        ( ( pCache->isValid != pdTRUE ) ||
+          ( pCache->pRootCa != pNetworkCredentials->pRootCa ) ||
+          ( pCache->pClientCert != pNetworkCredentials->pClientCert ) ||
+          ( pCache->pPrivateKey != pNetworkCredentials->pPrivateKey ) ) )
+    {
+        LogWarn( ( "Credential cache is not loaded from these credentials, parsing them." ) );
+        pCache = NULL;
+    }
+
+    if( pCache != NULL )
+    {
+        /* The cached objects are only read during the handshake, so they are
+         * used in place of the per-connection ones. */
+        mbedtls_ssl_conf_ca_chain( &( pSslContext->config ),
+                                   &( pCache->rootCa ),
+                                   NULL );
+        mbedtlsError = 0;
+
+        if( ( pCache->pClientCert != NULL ) &&
+            ( pCache->pPrivateKey != NULL ) )
+        {
+            mbedtlsError = mbedtls_ssl_conf_own_cert( &( pSslContext->config ),
+                                                      &( pCache->clientCert ),
+                                                      &( pCache->privKey ) );
+        }
+    }
+    else
+    {
+        mbedtlsError = setRootCa( pSslContext,
+                                  pNetworkCredentials->pRootCa,
+                                  pNetworkCredentials->rootCaSize );
+    }
 
-    if( ( pNetworkCredentials->pClientCert != NULL ) &&
+    if( ( pCache == NULL ) &&
+        ( pNetworkCredentials->pClientCert != NULL ) &&
         ( pNetworkCredentials->pPrivateKey != NULL ) )
     {
         if( mbedtlsError == 0 )
@@ -429,12 +567,10 @@ static void setOptionalConfigurations( SSLContext_t * pSslContext,
 
     /* Set Maximum Fragment Length if enabled. */
     #ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
-        /* Enable the max fragment extension. 4096 bytes is currently the largest fragment size permitted.
-         * See RFC 8449 https://tools.ietf.org/html/rfc8449 for more information.
-         *
-         * Smaller values can be found in "mbedtls/include/ssl.h".
-         */
-        mbedtlsError = mbedtls_ssl_conf_max_frag_len( &( pSslContext->config ), MBEDTLS_SSL_MAX_FRAG_LEN_4096 );
+        /* Enable the max fragment extension, with the length requested for
+         * this connection. See RFC 6066 for more information. */
+        mbedtlsError = mbedtls_ssl_conf_max_frag_len( &( pSslContext->config ),
+                                                      maxFragmentLengthCode( pNetworkCredentials->maxFragmentLength ) );
 
         if( mbedtlsError != 0 )
         {
@@ -442,7 +578,43 @@ static void setOptionalConfigurations( SSLContext_t * pSslContext,
                         mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
                         mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
         }
+    #else /* ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+        if( pNetworkCredentials->maxFragmentLength != 0U )
+        {
+            LogWarn( ( "maxFragmentLength ignored: MBEDTLS_SSL_MAX_FRAGMENT_LENGTH is not defined." ) );
+        }
     #endif /* ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+
+    /* Ask for a session ticket if the session is to be kept, so that servers
+     * without a session ID cache can still resume it. */
+    #ifdef MBEDTLS_SSL_SESSION_TICKETS
+        if( pNetworkCredentials->pSession != NULL )
+        {
+            mbedtls_ssl_conf_session_tickets( &( pSslContext->config ),
+                                              MBEDTLS_SSL_SESSION_TICKETS_ENABLED );
+
+            /* Have mbedtls_ssl_read report TLS 1.3 tickets, which arrive
+             * after the handshake, so they can be kept. */
+            #if defined( MBEDTLS_SSL_PROTO_TLS1_3 ) && ( MBEDTLS_VERSION_NUMBER >= 0x03060100 )
+                mbedtls_ssl_conf_tls13_enable_signal_new_session_tickets( &( pSslContext->config ),
+                                                                          MBEDTLS_SSL_TLS1_3_SIGNAL_NEW_SESSION_TICKETS_ENABLED );
+            #endif
+        }
+    #endif /* ifdef MBEDTLS_SSL_SESSION_TICKETS */
+
+    /* Offer TLS 1.3 early data if there is some to send. */
+    #ifdef MBEDTLS_SSL_EARLY_DATA
+        if( pNetworkCredentials->pEarlyData != NULL )
+        {
+            mbedtls_ssl_conf_early_data( &( pSslContext->config ),
+                                         MBEDTLS_SSL_EARLY_DATA_ENABLED );
+        }
+    #else /* ifdef MBEDTLS_SSL_EARLY_DATA */
+        if( pNetworkCredentials->pEarlyData != NULL )
+        {
+            LogWarn( ( "pEarlyData ignored: MBEDTLS_SSL_EARLY_DATA is not defined." ) );
+        }
+    #endif /* ifdef MBEDTLS_SSL_EARLY_DATA */
 }
 /*-----------------------------------------------------------*/
 
@@ -507,6 +679,13 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
     TlsTransportParams_t * pTlsTransportParams = NULL;
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
     int32_t mbedtlsError = 0;
+    int state = 0;
+    BaseType_t ticketFollows = pdFALSE;
+
+    #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+        TickType_t startTime = 0;
+        TickType_t stepStartTime = 0;
+    #endif
 
     configASSERT( pNetworkContext != NULL );
     configASSERT( pNetworkContext->pParams != NULL );
@@ -543,16 +722,77 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
                              xMbedTLSBioTCPSocketsWrapperSend,
                              xMbedTLSBioTCPSocketsWrapperRecv,
                              NULL );
+
+        setSession( &( pTlsTransportParams->sslContext ),
+                    pNetworkCredentials->pSession );
     }
 
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
-        /* Perform the TLS handshake. */
-        do
+        traceTLS_HANDSHAKE_START( pNetworkContext );
+
+        #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+            startTime = xTaskGetTickCount();
+        #endif
+
+        #ifdef MBEDTLS_SSL_EARLY_DATA
+            if( ( pNetworkCredentials->pEarlyData != NULL ) &&
+                ( pNetworkCredentials->earlyDataSize > 0U ) )
+            {
+                /* Runs the handshake up to the ClientHello, then sends as much
+                 * of the data as the offered session allows. */
+                mbedtlsError = mbedtls_ssl_write_early_data( &( pTlsTransportParams->sslContext.context ),
+                                                             pNetworkCredentials->pEarlyData,
+                                                             pNetworkCredentials->earlyDataSize );
+
+                if( mbedtlsError > 0 )
+                {
+                    pTlsTransportParams->earlyDataSent = ( size_t ) mbedtlsError;
+                    mbedtlsError = 0;
+                }
+                else if( mbedtlsError == MBEDTLS_ERR_SSL_CANNOT_WRITE_EARLY_DATA )
+                {
+                    LogDebug( ( "No session that allows early data, doing a full handshake." ) );
+                    mbedtlsError = 0;
+                }
+                else
+                {
+                    /* Empty else marker. Other errors end the handshake below. */
+                }
+            }
+        #endif /* ifdef MBEDTLS_SSL_EARLY_DATA */
+
+        /* Perform the TLS handshake a step at a time, as mbedtls_ssl_handshake
+         * does, so that the steps can be told apart. */
+        state = pTlsTransportParams->sslContext.context.MBEDTLS_PRIVATE( state );
+
+        while( ( state != MBEDTLS_SSL_HANDSHAKE_OVER ) &&
+               ( ( mbedtlsError == 0 ) ||
+                 ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
+                 ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) ) )
         {
-            mbedtlsError = mbedtls_ssl_handshake( &( pTlsTransportParams->sslContext.context ) );
-        } while( ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
-                 ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) );
+            traceTLS_HANDSHAKE_STEP( pNetworkContext, state );
+
+            #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+                stepStartTime = xTaskGetTickCount();
+            #endif
+
+            mbedtlsError = mbedtls_ssl_handshake_step( &( pTlsTransportParams->sslContext.context ) );
+
+            #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+                if( ( state == MBEDTLS_SSL_SERVER_CERTIFICATE ) ||
+                    ( state == MBEDTLS_SSL_CERTIFICATE_VERIFY ) )
+                {
+                    pTlsTransportParams->stats.certificateTimeMs += pdTICKS_TO_MS( xTaskGetTickCount() - stepStartTime );
+                }
+            #endif
+
+            state = pTlsTransportParams->sslContext.context.MBEDTLS_PRIVATE( state );
+        }
+
+        #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+            pTlsTransportParams->stats.handshakeTimeMs = pdTICKS_TO_MS( xTaskGetTickCount() - startTime );
+        #endif
 
         if( mbedtlsError != 0 )
         {
@@ -561,18 +801,120 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
                         mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
 
             returnStatus = TLS_TRANSPORT_HANDSHAKE_FAILED;
+
+            /* Do not offer the session again, in case it caused the failure. */
+            if( pNetworkCredentials->pSession != NULL )
+            {
+                TLS_FreeRTOS_SessionFree( pNetworkCredentials->pSession );
+            }
         }
         else
         {
             LogInfo( ( "(Network connection %p) TLS handshake successful.",
                        pNetworkContext ) );
+
+            #ifdef MBEDTLS_SSL_EARLY_DATA
+                if( ( pTlsTransportParams->earlyDataSent > 0U ) &&
+                    ( mbedtls_ssl_get_early_data_status( &( pTlsTransportParams->sslContext.context ) ) !=
+                      MBEDTLS_SSL_EARLY_DATA_STATUS_ACCEPTED ) )
+                {
+                    LogInfo( ( "(Network connection %p) Server rejected the early data.",
+                               pNetworkContext ) );
+                    pTlsTransportParams->earlyDataSent = 0U;
+                }
+            #endif
+
+            #ifdef MBEDTLS_SSL_PROTO_TLS1_3
+                if( mbedtls_ssl_get_version_number( &( pTlsTransportParams->sslContext.context ) ) ==
+                    MBEDTLS_SSL_VERSION_TLS1_3 )
+                {
+                    ticketFollows = pdTRUE;
+                }
+            #endif
+
+            if( ticketFollows == pdTRUE )
+            {
+                /* A TLS 1.3 ticket should be used once. The next one comes
+                 * after the handshake and is kept by TLS_FreeRTOS_recv. */
+                if( pNetworkCredentials->pSession != NULL )
+                {
+                    TLS_FreeRTOS_SessionFree( pNetworkCredentials->pSession );
+                }
+            }
+            else
+            {
+                getSession( &( pTlsTransportParams->sslContext ),
+                            pNetworkCredentials->pSession );
+            }
         }
+
+        traceTLS_HANDSHAKE_END( pNetworkContext, returnStatus );
     }
 
     return returnStatus;
 }
 /*-----------------------------------------------------------*/
 
+static void setSession( SSLContext_t * pSslContext,
+                        const TlsSession_t * pSession )
+{
+    int32_t mbedtlsError = 0;
+
+    configASSERT( pSslContext != NULL );
+
+    if( ( pSession != NULL ) && ( pSession->isValid == pdTRUE ) )
+    {
+        mbedtlsError = mbedtls_ssl_set_session( &( pSslContext->context ),
+                                                &( pSession->session ) );
+
+        if( mbedtlsError != 0 )
+        {
+            /* Not fatal, a full handshake is done instead. */
+            LogWarn( ( "Failed to set the session to resume: mbedTLSError= %s : %s.",
+                       mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                       mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+        }
+        else
+        {
+            LogDebug( ( "Offering the previous session for resumption." ) );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void getSession( SSLContext_t * pSslContext,
+                        TlsSession_t * pSession )
+{
+    int32_t mbedtlsError = 0;
+
+    configASSERT( pSslContext != NULL );
+
+    if( pSession != NULL )
+    {
+        /* Replace the session that was offered, whether or not the server
+         * resumed it, with the one in use now. */
+        TLS_FreeRTOS_SessionFree( pSession );
+
+        mbedtlsError = mbedtls_ssl_get_session( &( pSslContext->context ),
+                                                &( pSession->session ) );
+
+        if( mbedtlsError != 0 )
+        {
+            /* Not fatal, the next connection does a full handshake. */
+            LogWarn( ( "Failed to keep the session for resumption: mbedTLSError= %s : %s.",
+                       mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                       mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+
+            TLS_FreeRTOS_SessionFree( pSession );
+        }
+        else
+        {
+            pSession->isValid = pdTRUE;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
 static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pEntropyContext,
                                          mbedtls_ctr_drbg_context * pCtrDrgbContext )
 {
@@ -614,6 +956,19 @@ static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pEntropyConte
         }
     }
 
+    #if defined( MBEDTLS_USE_PSA_CRYPTO ) || defined( MBEDTLS_SSL_PROTO_TLS1_3 )
+        if( returnStatus == TLS_TRANSPORT_SUCCESS )
+        {
+            /* TLS 1.3 does its cryptography through PSA. Initializing it
+             * again for later connections has no effect. */
+            if( psa_crypto_init() != PSA_SUCCESS )
+            {
+                LogError( ( "Failed to initialize PSA Crypto." ) );
+                returnStatus = TLS_TRANSPORT_INTERNAL_ERROR;
+            }
+        }
+    #endif
+
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
         LogDebug( ( "Successfully initialized mbedTLS." ) );
@@ -623,6 +978,38 @@ static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pEntropyConte
 }
 /*-----------------------------------------------------------*/
 
+static uint8_t maxFragmentLengthCode( uint16_t maxFragmentLength )
+{
+    uint8_t code = MBEDTLS_SSL_MAX_FRAG_LEN_INVALID;
+
+    switch( maxFragmentLength )
+    {
+        case 512U:
+            code = MBEDTLS_SSL_MAX_FRAG_LEN_512;
+            break;
+
+        case 1024U:
+            code = MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+            break;
+
+        case 2048U:
+            code = MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+            break;
+
+        /* 4096 bytes is the largest fragment size the extension permits. */
+        case 0U:
+        case 4096U:
+            code = MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+            break;
+
+        default:
+            break;
+    }
+
+    return code;
+}
+/*-----------------------------------------------------------*/
+
 TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
                                            const char * pHostName,
                                            uint16_t port,
@@ -635,6 +1022,10 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     BaseType_t socketStatus = 0;
     BaseType_t isSocketConnected = pdFALSE, isTlsSetup = pdFALSE;
 
+    #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+        TickType_t startTime = 0;
+    #endif
+
     if( ( pNetworkContext == NULL ) ||
         ( pNetworkContext->pParams == NULL ) ||
         ( pHostName == NULL ) ||
@@ -652,6 +1043,13 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         LogError( ( "pRootCa cannot be NULL." ) );
         returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
     }
+    else if( maxFragmentLengthCode( pNetworkCredentials->maxFragmentLength ) ==
+             MBEDTLS_SSL_MAX_FRAG_LEN_INVALID )
+    {
+        LogError( ( "maxFragmentLength must be 0, 512, 1024, 2048 or 4096, not %u.",
+                    ( unsigned ) pNetworkCredentials->maxFragmentLength ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
     else
     {
         /* Empty else for MISRA 15.7 compliance. */
@@ -664,6 +1062,13 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
 
         /* Initialize tcpSocket. */
         pTlsTransportParams->tcpSocket = NULL;
+        pTlsTransportParams->pSession = pNetworkCredentials->pSession;
+        pTlsTransportParams->earlyDataSent = 0U;
+
+        #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+            ( void ) memset( &( pTlsTransportParams->stats ), 0, sizeof( TlsTransportStats_t ) );
+            startTime = xTaskGetTickCount();
+        #endif
 
         socketStatus = TCP_Sockets_Connect( &( pTlsTransportParams->tcpSocket ),
                                             pHostName,
@@ -671,6 +1076,10 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
                                             receiveTimeoutMs,
                                             sendTimeoutMs );
 
+        #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+            pTlsTransportParams->stats.tcpConnectTimeMs = pdTICKS_TO_MS( xTaskGetTickCount() - startTime );
+        #endif
+
         if( socketStatus != 0 )
         {
             LogError( ( "Failed to connect to %s with error %d.",
@@ -772,10 +1181,589 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
 
         /* Free mbed TLS contexts. */
         sslContextFree( &( pTlsTransportParams->sslContext ) );
+        pTlsTransportParams->pSession = NULL;
     }
 }
 /*-----------------------------------------------------------*/
 
+#if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+
+    void TLS_FreeRTOS_GetStats( const NetworkContext_t * pNetworkContext,
+                                TlsTransportStats_t * pStats )
+    {
+        configASSERT( pNetworkContext != NULL );
+        configASSERT( pNetworkContext->pParams != NULL );
+        configASSERT( pStats != NULL );
+
+        *pStats = pNetworkContext->pParams->stats;
+    }
+
+#endif /* if ( TLS_TRANSPORT_ENABLE_STATS == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if defined( MBEDTLS_MEMORY_BUFFER_ALLOC_C )
+
+    void TLS_FreeRTOS_InitBufferPool( uint8_t * pBuffer,
+                                      size_t bufferSize )
+    {
+        configASSERT( pBuffer != NULL );
+
+        mbedtls_memory_buffer_alloc_init( pBuffer, bufferSize );
+    }
+
+#endif /* if defined( MBEDTLS_MEMORY_BUFFER_ALLOC_C ) */
+/*-----------------------------------------------------------*/
+
+#if ( TLS_TRANSPORT_POOL_SIZE > 0U )
+
+    static void poolDisconnect( TlsPoolEntry_t * pEntry )
+    {
+        NetworkContext_t networkContext = { &( pEntry->params ) };
+
+        TLS_FreeRTOS_Disconnect( &networkContext );
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t poolIsHealthy( TlsPoolEntry_t * pEntry )
+    {
+        BaseType_t isHealthy = pdFALSE;
+
+        /* Anything readable on an idle connection, including the FIN or a
+         * close-notify alert, means it can't carry a new request. */
+        if( ( TCP_Sockets_Poll( pEntry->params.tcpSocket ) == 0 ) &&
+            ( mbedtls_ssl_get_bytes_avail( &( pEntry->params.sslContext.context ) ) == 0U ) )
+        {
+            isHealthy = pdTRUE;
+        }
+
+        return isHealthy;
+    }
+/*-----------------------------------------------------------*/
+
+    static void poolEvictIdle( BaseType_t evictAll )
+    {
+        TlsPoolEntry_t * pEntry = NULL;
+        BaseType_t evict = pdFALSE;
+        size_t i;
+
+        for( i = 0U; i < TLS_TRANSPORT_POOL_SIZE; i++ )
+        {
+            pEntry = &( connectionPool[ i ] );
+            evict = pdFALSE;
+
+            taskENTER_CRITICAL();
+            {
+                if( ( pEntry->state == TLS_POOL_IDLE ) &&
+                    ( ( evictAll == pdTRUE ) ||
+                      ( ( xTaskGetTickCount() - pEntry->releaseTime ) >
+                        pdMS_TO_TICKS( TLS_TRANSPORT_POOL_IDLE_TIMEOUT_MS ) ) ) )
+                {
+                    pEntry->state = TLS_POOL_IN_USE;
+                    evict = pdTRUE;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( evict == pdTRUE )
+            {
+                LogDebug( ( "Closing idle pooled connection to %s:%u.",
+                            pEntry->hostName,
+                            ( unsigned ) pEntry->port ) );
+                poolDisconnect( pEntry );
+                pEntry->state = TLS_POOL_FREE;
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    TlsTransportStatus_t TLS_FreeRTOS_PoolConnect( NetworkContext_t * pNetworkContext,
+                                                   const char * pHostName,
+                                                   uint16_t port,
+                                                   const NetworkCredentials_t * pNetworkCredentials,
+                                                   uint32_t receiveTimeoutMs,
+                                                   uint32_t sendTimeoutMs )
+    {
+        TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+        TlsPoolEntry_t * pEntry = NULL;
+        TlsPoolEntry_t * pFree = NULL;
+        TlsPoolEntry_t * pOldest = NULL;
+        BaseType_t isReused = pdFALSE;
+        size_t i;
+
+        if( ( pNetworkContext == NULL ) ||
+            ( pHostName == NULL ) ||
+            ( pNetworkCredentials == NULL ) )
+        {
+            LogError( ( "Invalid input parameter(s): Arguments cannot be NULL. pNetworkContext=%p, "
+                        "pHostName=%p, pNetworkCredentials=%p.",
+                        pNetworkContext,
+                        pHostName,
+                        pNetworkCredentials ) );
+            returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+        }
+        else if( strlen( pHostName ) > TLS_TRANSPORT_POOL_HOST_NAME_MAX )
+        {
+            LogError( ( "Host name longer than TLS_TRANSPORT_POOL_HOST_NAME_MAX: %s.",
+                        pHostName ) );
+            returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+        }
+        else
+        {
+            poolEvictIdle( pdFALSE );
+
+            /* Take a matching idle connection, else a free slot, else the
+             * slot of the connection that has been idle the longest. */
+            taskENTER_CRITICAL();
+            {
+                for( i = 0U; ( i < TLS_TRANSPORT_POOL_SIZE ) && ( pEntry == NULL ); i++ )
+                {
+                    if( connectionPool[ i ].state == TLS_POOL_FREE )
+                    {
+                        if( pFree == NULL )
+                        {
+                            pFree = &( connectionPool[ i ] );
+                        }
+                    }
+                    else if( connectionPool[ i ].state == TLS_POOL_IDLE )
+                    {
+                        if( ( connectionPool[ i ].port == port ) &&
+                            ( connectionPool[ i ].pNetworkCredentials == pNetworkCredentials ) &&
+                            ( strcmp( connectionPool[ i ].hostName, pHostName ) == 0 ) )
+                        {
+                            pEntry = &( connectionPool[ i ] );
+                            isReused = pdTRUE;
+                        }
+                        else if( ( pOldest == NULL ) ||
+                                 ( ( xTaskGetTickCount() - connectionPool[ i ].releaseTime ) >
+                                   ( xTaskGetTickCount() - pOldest->releaseTime ) ) )
+                        {
+                            pOldest = &( connectionPool[ i ] );
+                        }
+                        else
+                        {
+                            /* Empty else for MISRA 15.7 compliance. */
+                        }
+                    }
+                    else
+                    {
+                        /* Empty else for MISRA 15.7 compliance. */
+                    }
+                }
+
+                if( pEntry == NULL )
+                {
+                    pEntry = ( pFree != NULL ) ? pFree : pOldest;
+                }
+
+                if( pEntry != NULL )
+                {
+                    pEntry->state = TLS_POOL_IN_USE;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( pEntry == NULL )
+            {
+                LogError( ( "All %u pooled connections are in use.",
+                            ( unsigned ) TLS_TRANSPORT_POOL_SIZE ) );
+                returnStatus = TLS_TRANSPORT_INSUFFICIENT_MEMORY;
+            }
+            else if( ( isReused == pdTRUE ) && ( poolIsHealthy( pEntry ) == pdTRUE ) )
+            {
+                LogInfo( ( "(Network connection %p) Reusing pooled connection to %s.",
+                           pNetworkContext,
+                           pHostName ) );
+            }
+            else
+            {
+                /* The slot still holds a stale connection, or one to another
+                 * endpoint that is evicted to make room. */
+                if( pEntry != pFree )
+                {
+                    poolDisconnect( pEntry );
+                }
+
+                pNetworkContext->pParams = &( pEntry->params );
+                returnStatus = TLS_FreeRTOS_Connect( pNetworkContext,
+                                                     pHostName,
+                                                     port,
+                                                     pNetworkCredentials,
+                                                     receiveTimeoutMs,
+                                                     sendTimeoutMs );
+
+                if( returnStatus == TLS_TRANSPORT_SUCCESS )
+                {
+                    ( void ) strcpy( pEntry->hostName, pHostName );
+                    pEntry->port = port;
+                    pEntry->pNetworkCredentials = pNetworkCredentials;
+                }
+                else
+                {
+                    pEntry->state = TLS_POOL_FREE;
+                    pEntry = NULL;
+                }
+            }
+
+            pNetworkContext->pParams = ( pEntry != NULL ) ? &( pEntry->params ) : NULL;
+        }
+
+        return returnStatus;
+    }
+/*-----------------------------------------------------------*/
+
+    void TLS_FreeRTOS_PoolRelease( NetworkContext_t * pNetworkContext,
+                                   BaseType_t keepAlive )
+    {
+        TlsPoolEntry_t * pEntry = NULL;
+        size_t i;
+
+        if( pNetworkContext != NULL )
+        {
+            for( i = 0U; ( i < TLS_TRANSPORT_POOL_SIZE ) && ( pEntry == NULL ); i++ )
+            {
+                if( pNetworkContext->pParams == &( connectionPool[ i ].params ) )
+                {
+                    pEntry = &( connectionPool[ i ] );
+                }
+            }
+        }
+
+        if( pEntry == NULL )
+        {
+            LogError( ( "(Network connection %p) Not a pooled connection.",
+                        pNetworkContext ) );
+        }
+        else
+        {
+            if( keepAlive == pdTRUE )
+            {
+                pEntry->releaseTime = xTaskGetTickCount();
+                pEntry->state = TLS_POOL_IDLE;
+            }
+            else
+            {
+                poolDisconnect( pEntry );
+                pEntry->state = TLS_POOL_FREE;
+            }
+
+            pNetworkContext->pParams = NULL;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void TLS_FreeRTOS_PoolFlush( void )
+    {
+        poolEvictIdle( pdTRUE );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_POOL_SIZE > 0U ) */
+
+void TLS_FreeRTOS_SessionInit( TlsSession_t * pSession )
+{
+    configASSERT( pSession != NULL );
+
+    mbedtls_ssl_session_init( &( pSession->session ) );
+    pSession->isValid = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void TLS_FreeRTOS_SessionFree( TlsSession_t * pSession )
+{
+    configASSERT( pSession != NULL );
+
+    /* Also clears the master secret. */
+    mbedtls_ssl_session_free( &( pSession->session ) );
+    mbedtls_ssl_session_init( &( pSession->session ) );
+    pSession->isValid = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_SessionSave( const TlsSession_t * pSession,
+                                               uint8_t * pBuffer,
+                                               size_t bufferSize,
+                                               size_t * pSavedLength )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    int32_t mbedtlsError = 0;
+
+    if( ( pSession == NULL ) || ( pSavedLength == NULL ) ||
+        ( ( pBuffer == NULL ) && ( bufferSize != 0U ) ) )
+    {
+        LogError( ( "Invalid input parameter(s): pSession=%p, pBuffer=%p, pSavedLength=%p.",
+                    pSession,
+                    pBuffer,
+                    pSavedLength ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else if( pSession->isValid != pdTRUE )
+    {
+        LogDebug( ( "There is no session to save." ) );
+        *pSavedLength = 0;
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else
+    {
+        mbedtlsError = mbedtls_ssl_session_save( &( pSession->session ),
+                                                 pBuffer,
+                                                 bufferSize,
+                                                 pSavedLength );
+
+        if( mbedtlsError == MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL )
+        {
+            LogError( ( "Buffer of %lu bytes too small to save the session, %lu bytes needed.",
+                        ( unsigned long ) bufferSize,
+                        ( unsigned long ) *pSavedLength ) );
+            returnStatus = TLS_TRANSPORT_INSUFFICIENT_MEMORY;
+        }
+        else if( mbedtlsError != 0 )
+        {
+            LogError( ( "Failed to save the session: mbedTLSError= %s : %s.",
+                        mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                        mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+            returnStatus = TLS_TRANSPORT_INTERNAL_ERROR;
+        }
+        else
+        {
+            /* Empty else marker. */
+        }
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_SessionLoad( TlsSession_t * pSession,
+                                               const uint8_t * pBuffer,
+                                               size_t bufferLength )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    int32_t mbedtlsError = 0;
+
+    if( ( pSession == NULL ) || ( pBuffer == NULL ) || ( bufferLength == 0U ) )
+    {
+        LogError( ( "Invalid input parameter(s): pSession=%p, pBuffer=%p, bufferLength=%lu.",
+                    pSession,
+                    pBuffer,
+                    ( unsigned long ) bufferLength ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else
+    {
+        TLS_FreeRTOS_SessionFree( pSession );
+
+        mbedtlsError = mbedtls_ssl_session_load( &( pSession->session ),
+                                                 pBuffer,
+                                                 bufferLength );
+
+        if( mbedtlsError != 0 )
+        {
+            /* Saved by another mbed TLS version or configuration, or corrupt. */
+            LogError( ( "Failed to load the session: mbedTLSError= %s : %s.",
+                        mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                        mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+
+            TLS_FreeRTOS_SessionFree( pSession );
+            returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+        }
+        else
+        {
+            pSession->isValid = pdTRUE;
+        }
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+size_t TLS_FreeRTOS_GetEarlyDataSent( const NetworkContext_t * pNetworkContext )
+{
+    configASSERT( pNetworkContext != NULL );
+    configASSERT( pNetworkContext->pParams != NULL );
+
+    return pNetworkContext->pParams->earlyDataSent;
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_SetReadySemaphore( NetworkContext_t * pNetworkContext,
+                                                     SemaphoreHandle_t xSemaphore )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+    if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
+    {
+        LogError( ( "Invalid input parameter: pNetworkContext=%p.", pNetworkContext ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else if( TCP_Sockets_SetReadySemaphore( pNetworkContext->pParams->tcpSocket,
+                                            xSemaphore ) != TCP_SOCKETS_ERRNO_NONE )
+    {
+        LogDebug( ( "Sockets port does not support a ready semaphore." ) );
+        returnStatus = TLS_TRANSPORT_INTERNAL_ERROR;
+    }
+    else
+    {
+        /* Empty else for MISRA 15.7 compliance. */
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+int32_t TLS_FreeRTOS_Poll( NetworkContext_t * pNetworkContext )
+{
+    int32_t available = -1;
+    size_t decrypted;
+
+    if( ( pNetworkContext != NULL ) && ( pNetworkContext->pParams != NULL ) )
+    {
+        decrypted = mbedtls_ssl_get_bytes_avail( &( pNetworkContext->pParams->sslContext.context ) );
+
+        if( decrypted > 0U )
+        {
+            available = ( decrypted > ( size_t ) INT32_MAX ) ? INT32_MAX : ( int32_t ) decrypted;
+        }
+        else
+        {
+            available = TCP_Sockets_Poll( pNetworkContext->pParams->tcpSocket );
+        }
+    }
+
+    return available;
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_CredentialCacheLoad( TlsCredentialCache_t * pCache,
+                                                       const NetworkCredentials_t * pNetworkCredentials )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    int32_t mbedtlsError = 0;
+
+    #if MBEDTLS_VERSION_NUMBER >= 0x03000000
+        mbedtls_entropy_context entropyContext;
+        mbedtls_ctr_drbg_context ctrDrgbContext;
+    #endif
+
+    if( ( pCache == NULL ) || ( pNetworkCredentials == NULL ) ||
+        ( pNetworkCredentials->pRootCa == NULL ) )
+    {
+        LogError( ( "Invalid input parameter(s): pCache=%p, pNetworkCredentials=%p.",
+                    pCache,
+                    pNetworkCredentials ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else
+    {
+        TLS_FreeRTOS_CredentialCacheFree( pCache );
+
+        mbedtls_x509_crt_init( &( pCache->rootCa ) );
+        mbedtls_x509_crt_init( &( pCache->clientCert ) );
+        mbedtls_pk_init( &( pCache->privKey ) );
+        pCache->pRootCa = pNetworkCredentials->pRootCa;
+        pCache->pClientCert = pNetworkCredentials->pClientCert;
+        pCache->pPrivateKey = pNetworkCredentials->pPrivateKey;
+
+        mbedtlsError = mbedtls_x509_crt_parse( &( pCache->rootCa ),
+                                               pNetworkCredentials->pRootCa,
+                                               pNetworkCredentials->rootCaSize );
+
+        if( mbedtlsError != 0 )
+        {
+            LogError( ( "Failed to parse server root CA certificate: mbedTLSError= %s : %s.",
+                        mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                        mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+            returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
+        }
+    }
+
+    if( ( returnStatus == TLS_TRANSPORT_SUCCESS ) &&
+        ( pNetworkCredentials->pClientCert != NULL ) &&
+        ( pNetworkCredentials->pPrivateKey != NULL ) )
+    {
+        mbedtlsError = mbedtls_x509_crt_parse( &( pCache->clientCert ),
+                                               pNetworkCredentials->pClientCert,
+                                               pNetworkCredentials->clientCertSize );
+
+        if( mbedtlsError != 0 )
+        {
+            LogError( ( "Failed to parse the client certificate: mbedTLSError= %s : %s.",
+                        mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                        mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+            returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
+        }
+
+        #if MBEDTLS_VERSION_NUMBER < 0x03000000
+            if( returnStatus == TLS_TRANSPORT_SUCCESS )
+            {
+                mbedtlsError = mbedtls_pk_parse_key( &( pCache->privKey ),
+                                                     pNetworkCredentials->pPrivateKey,
+                                                     pNetworkCredentials->privateKeySize,
+                                                     NULL, 0 );
+            }
+        #else
+            if( returnStatus == TLS_TRANSPORT_SUCCESS )
+            {
+                /* The generator is only needed while the key is parsed. */
+                returnStatus = initMbedtls( &entropyContext, &ctrDrgbContext );
+
+                if( returnStatus == TLS_TRANSPORT_SUCCESS )
+                {
+                    mbedtlsError = mbedtls_pk_parse_key( &( pCache->privKey ),
+                                                         pNetworkCredentials->pPrivateKey,
+                                                         pNetworkCredentials->privateKeySize,
+                                                         NULL, 0,
+                                                         mbedtls_ctr_drbg_random,
+                                                         &ctrDrgbContext );
+                }
+
+                mbedtls_ctr_drbg_free( &ctrDrgbContext );
+                mbedtls_entropy_free( &entropyContext );
+            }
+        #endif /* if MBEDTLS_VERSION_NUMBER < 0x03000000 */
+
+        if( ( returnStatus == TLS_TRANSPORT_SUCCESS ) && ( mbedtlsError != 0 ) )
+        {
+            LogError( ( "Failed to parse the client key: mbedTLSError= %s : %s.",
+                        mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                        mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+            returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
+        }
+    }
+
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        pCache->isValid = pdTRUE;
+    }
+    else if( returnStatus != TLS_TRANSPORT_INVALID_PARAMETER )
+    {
+        TLS_FreeRTOS_CredentialCacheFree( pCache );
+    }
+    else
+    {
+        /* Empty else marker. */
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+void TLS_FreeRTOS_CredentialCacheFree( TlsCredentialCache_t * pCache )
+{
+    configASSERT( pCache != NULL );
+
+    /* Also clears the private key. Freeing zero-initialized objects is a
+     * no-op, so this is safe for a cache that was never loaded. */
+    mbedtls_x509_crt_free( &( pCache->rootCa ) );
+    mbedtls_x509_crt_free( &( pCache->clientCert ) );
+    mbedtls_pk_free( &( pCache->privKey ) );
+
+    pCache->pRootCa = NULL;
+    pCache->pClientCert = NULL;
+    pCache->pPrivateKey = NULL;
+    pCache->isValid = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
 int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
                            void * pBuffer,
                            size_t bytesToRecv )
@@ -806,6 +1794,17 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
                                                   pBuffer,
                                                   bytesToRecv );
 
+        #if defined( MBEDTLS_SSL_PROTO_TLS1_3 ) && defined( MBEDTLS_SSL_SESSION_TICKETS )
+            if( tlsStatus == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET )
+            {
+                /* Keep the ticket for the next connection, and retry the read
+                 * for the application data. */
+                getSession( &( pTlsTransportParams->sslContext ),
+                            pTlsTransportParams->pSession );
+                tlsStatus = MBEDTLS_ERR_SSL_WANT_READ;
+            }
+        #endif
+
         if( ( tlsStatus == MBEDTLS_ERR_SSL_TIMEOUT ) ||
             ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ||
             ( tlsStatus == MBEDTLS_ERR_SSL_WANT_WRITE ) )
@@ -827,7 +1826,14 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
         }
         else
         {
-            /* Empty else marker. */
+            #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+                pTlsTransportParams->stats.bytesReceived += ( uint64_t ) tlsStatus;
+
+                if( mbedtls_ssl_get_bytes_avail( &( pTlsTransportParams->sslContext.context ) ) == 0U )
+                {
+                    pTlsTransportParams->stats.recordsReceived++;
+                }
+            #endif
         }
     }
 
@@ -886,10 +1892,118 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
         }
         else
         {
-            /* Empty else marker. */
+            /* mbedtls_ssl_write sends at most one record. */
+            #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+                pTlsTransportParams->stats.bytesSent += ( uint64_t ) tlsStatus;
+                pTlsTransportParams->stats.recordsSent++;
+            #endif
         }
     }
 
     return tlsStatus;
 }
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Sends one contiguous part of a TLS_FreeRTOS_writev call.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[in] pBuffer Bytes to send.
+ * @param[in] length Number of bytes to send.
+ * @param[in,out] pBytesSent Bytes sent so far by the call, or the error if
+ * none were sent.
+ *
+ * @return pdTRUE if all @p length bytes were sent, else pdFALSE.
+ */
+static BaseType_t writevSendPart( NetworkContext_t * pNetworkContext,
+                                  const void * pBuffer,
+                                  size_t length,
+                                  int32_t * pBytesSent )
+{
+    BaseType_t complete = pdFALSE;
+    int32_t sendStatus = TLS_FreeRTOS_send( pNetworkContext, pBuffer, length );
+
+    if( sendStatus < 0 )
+    {
+        /* Bytes that already went out are reported first, the error is
+         * returned again by the next send. */
+        if( *pBytesSent == 0 )
+        {
+            *pBytesSent = sendStatus;
+        }
+    }
+    else
+    {
+        *pBytesSent += sendStatus;
+
+        if( sendStatus == ( int32_t ) length )
+        {
+            complete = pdTRUE;
+        }
+    }
+
+    return complete;
+}
+/*-----------------------------------------------------------*/
+
+int32_t TLS_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                             TransportOutVector_t * pIoVec,
+                             size_t ioVecCount )
+{
+    uint8_t gatherBuffer[ TLS_TRANSPORT_WRITEV_BUFFER_SIZE ];
+    size_t gathered = 0U;
+    size_t i;
+    int32_t bytesSent = 0;
+    BaseType_t complete = pdTRUE;
+
+    if( ( pIoVec == NULL ) || ( ioVecCount == 0U ) )
+    {
+        LogError( ( "invalid input, pIoVec=%p, ioVecCount=%lu",
+                    ( void * ) pIoVec,
+                    ( unsigned long ) ioVecCount ) );
+        bytesSent = -1;
+    }
+    else
+    {
+        for( i = 0U; ( i < ioVecCount ) && ( complete == pdTRUE ); i++ )
+        {
+            /* Send what was gathered when this segment does not fit after it. */
+            if( ( gathered > 0U ) &&
+                ( pIoVec[ i ].iov_len > ( sizeof( gatherBuffer ) - gathered ) ) )
+            {
+                complete = writevSendPart( pNetworkContext, gatherBuffer, gathered, &bytesSent );
+                gathered = 0U;
+            }
+
+            if( complete == pdFALSE )
+            {
+                /* Stop at a partial send, the caller sends the rest. */
+            }
+            else if( pIoVec[ i ].iov_len >= sizeof( gatherBuffer ) )
+            {
+                /* Long segments are not worth a copy. */
+                complete = writevSendPart( pNetworkContext,
+                                           pIoVec[ i ].iov_base,
+                                           pIoVec[ i ].iov_len,
+                                           &bytesSent );
+            }
+            else if( pIoVec[ i ].iov_len > 0U )
+            {
+                ( void ) memcpy( &gatherBuffer[ gathered ], pIoVec[ i ].iov_base, pIoVec[ i ].iov_len );
+                gathered += pIoVec[ i ].iov_len;
+            }
+            else
+            {
+                /* Empty else marker. */
+            }
+        }
+
+        if( ( complete == pdTRUE ) && ( gathered > 0U ) )
+        {
+            ( void ) writevSendPart( pNetworkContext, gatherBuffer, gathered, &bytesSent );
+        }
+    }
+
+    return bytesSent;
+}
+/*-----------------------------------------------------------*/
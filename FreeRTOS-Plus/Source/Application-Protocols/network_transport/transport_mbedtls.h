@@ -85,6 +85,31 @@ extern void vLoggingPrintf( const char * pcFormatString,
 #include "mbedtls/error.h"
 #include "mbedtls/build_info.h"
 
+/**
+ * @brief Set to 1 to keep #TlsTransportStats_t for each connection.
+ */
+#ifndef TLS_TRANSPORT_ENABLE_STATS
+    #define TLS_TRANSPORT_ENABLE_STATS    ( 0 )
+#endif
+
+/**
+ * @brief Hooks around the TLS handshake, e.g. to time it with the trace
+ * recorder's xTraceIntervalStart() and xTraceIntervalStop(). They are empty
+ * by default.
+ *
+ * traceTLS_HANDSHAKE_STEP is called before each step of the handshake with
+ * the mbed TLS handshake state (mbedtls_ssl_states) the step handles.
+ */
+#ifndef traceTLS_HANDSHAKE_START
+    #define traceTLS_HANDSHAKE_START( pNetworkContext )
+#endif
+#ifndef traceTLS_HANDSHAKE_STEP
+    #define traceTLS_HANDSHAKE_STEP( pNetworkContext, state )
+#endif
+#ifndef traceTLS_HANDSHAKE_END
+    #define traceTLS_HANDSHAKE_END( pNetworkContext, returnStatus )
+#endif
+
 /**
  * @brief Secured connection context.
  */
@@ -100,6 +125,27 @@ typedef struct SSLContext
     mbedtls_ctr_drbg_context ctrDrgbContext; /**< @brief CTR DRBG context for random number generation. */
 } SSLContext_t;
 
+#if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+
+    /**
+     * @brief Timing and traffic statistics of a TLS connection.
+     *
+     * Times are in milliseconds, at the resolution of the tick. The counters
+     * are for application data, not the handshake.
+     */
+    typedef struct TlsTransportStats
+    {
+        uint32_t tcpConnectTimeMs;  /**< @brief DNS lookup and TCP connect. */
+        uint32_t handshakeTimeMs;   /**< @brief Whole TLS handshake. */
+        uint32_t certificateTimeMs; /**< @brief Part of the handshake spent receiving and verifying the server certificate. */
+        uint64_t bytesSent;         /**< @brief Bytes sent. */
+        uint64_t bytesReceived;     /**< @brief Bytes received. */
+        uint32_t recordsSent;       /**< @brief Records sent. */
+        uint32_t recordsReceived;   /**< @brief Records received and read to the end. */
+    } TlsTransportStats_t;
+
+#endif /* if ( TLS_TRANSPORT_ENABLE_STATS == 1 ) */
+
 /**
  * @brief Parameters for the network context of the transport interface
  * implementation that uses mbedTLS and FreeRTOS+TCP sockets.
@@ -108,8 +154,59 @@ typedef struct TlsTransportParams
 {
     Socket_t tcpSocket;
     SSLContext_t sslContext;
+    struct TlsSession * pSession; /**< @brief Session to update with TLS 1.3 tickets received after the handshake, or NULL. */
+    size_t earlyDataSent;         /**< @brief Bytes of early data the server accepted. */
+    #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+        TlsTransportStats_t stats;
+    #endif
 } TlsTransportParams_t;
 
+/**
+ * @brief A TLS session that can be resumed by a later connection.
+ *
+ * Resuming a session skips the key exchange and the certificate verification
+ * of a full handshake. The server decides whether to accept the session ID or
+ * session ticket; if it does not, a full handshake is performed.
+ *
+ * With TLS 1.3 the server sends its session tickets after the handshake, so
+ * the session is updated by #TLS_FreeRTOS_recv when a ticket arrives rather
+ * than at the end of #TLS_FreeRTOS_Connect. A TLS 1.3 session can also carry
+ * early data, see #NetworkCredentials.pEarlyData.
+ *
+ * Initialize with #TLS_FreeRTOS_SessionInit before first use and release with
+ * #TLS_FreeRTOS_SessionFree. To keep a session across deep sleep, serialize it
+ * with #TLS_FreeRTOS_SessionSave to retained memory or flash and restore it
+ * with #TLS_FreeRTOS_SessionLoad after waking up.
+ */
+typedef struct TlsSession
+{
+    mbedtls_ssl_session session; /**< @brief Session ID or ticket, and the master secret. */
+    BaseType_t isValid;          /**< @brief pdTRUE if session holds a session that can be offered. */
+} TlsSession_t;
+
+/**
+ * @brief Parsed credentials that connections can share.
+ *
+ * Parsing the root CA chain, the client certificate and in particular the
+ * private key takes a large part of a connection's setup time. The cache
+ * parses them once, with #TLS_FreeRTOS_CredentialCacheLoad, and every
+ * connection whose #NetworkCredentials_t points to it uses the parsed objects
+ * instead of parsing its own copies. The cache is only read by connections,
+ * so several connections can use it at once.
+ *
+ * Free it with #TLS_FreeRTOS_CredentialCacheFree once no connection uses it.
+ */
+typedef struct TlsCredentialCache
+{
+    mbedtls_x509_crt rootCa;     /**< @brief Root CA certificate chain. */
+    mbedtls_x509_crt clientCert; /**< @brief Client certificate, if loaded. */
+    mbedtls_pk_context privKey;  /**< @brief Client private key, if loaded. */
+    const uint8_t * pRootCa;     /**< @brief Credential rootCa was parsed from. */
+    const uint8_t * pClientCert; /**< @brief Credential clientCert was parsed from, or NULL. */
+    const uint8_t * pPrivateKey; /**< @brief Credential privKey was parsed from, or NULL. */
+    BaseType_t isValid;          /**< @brief pdTRUE once loaded, until freed. */
+} TlsCredentialCache_t;
+
 /**
  * @brief Contains the credentials necessary for tls connection setup.
  */
@@ -136,6 +233,48 @@ typedef struct NetworkCredentials
     size_t clientCertSize;       /**< @brief Size associated with #NetworkCredentials.pClientCert. */
     const uint8_t * pPrivateKey; /**< @brief String representing the client certificate's private key. */
     size_t privateKeySize;       /**< @brief Size associated with #NetworkCredentials.pPrivateKey. */
+
+    /**
+     * @brief Optional session to resume, or NULL to always do a full handshake.
+     *
+     * If it holds a session, it is offered to the server. After a successful
+     * handshake it is updated with the session that was established, ready
+     * for the next connection. It is cleared if the handshake fails.
+     */
+    TlsSession_t * pSession;
+
+    /**
+     * @brief Optional loaded credential cache, or NULL to parse the
+     * credentials for each connection.
+     *
+     * It is used if it was loaded from the same pRootCa, pClientCert and
+     * pPrivateKey; otherwise the credentials are parsed as without a cache.
+     */
+    TlsCredentialCache_t * pCredentialCache;
+
+    /**
+     * @brief Largest TLS record the server may send, negotiated with the
+     * maximum fragment length extension (RFC 6066): 512, 1024, 2048 or 4096,
+     * or 0 for 4096.
+     *
+     * With MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH, the record buffers of the
+     * connection are shrunk to the negotiated length after the handshake.
+     */
+    uint16_t maxFragmentLength;
+
+    /**
+     * @brief Optional application data to send as TLS 1.3 early data (0-RTT),
+     * or NULL.
+     *
+     * Early data is sent with the ClientHello when pSession holds a TLS 1.3
+     * ticket that allows it, so a short request costs no extra round trip.
+     * Requires MBEDTLS_SSL_EARLY_DATA. The server may reject it, and it may be
+     * replayed by an attacker, so only use it for idempotent requests. After
+     * connecting, #TLS_FreeRTOS_GetEarlyDataSent tells how much was accepted;
+     * send the rest as usual.
+     */
+    const uint8_t * pEarlyData;
+    size_t earlyDataSize; /**< @brief Size associated with #NetworkCredentials.pEarlyData. */
 } NetworkCredentials_t;
 
 /**
@@ -180,6 +319,236 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
  */
 void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext );
 
+#if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+
+    /**
+     * @brief Get a copy of the statistics of a connection.
+     *
+     * @param[in] pNetworkContext Network context.
+     * @param[out] pStats The statistics since the connection was made.
+     */
+    void TLS_FreeRTOS_GetStats( const NetworkContext_t * pNetworkContext,
+                                TlsTransportStats_t * pStats );
+
+#endif /* if ( TLS_TRANSPORT_ENABLE_STATS == 1 ) */
+
+#if defined( MBEDTLS_MEMORY_BUFFER_ALLOC_C )
+
+    /**
+     * @brief Make mbed TLS allocate from a pre-allocated pool, shared by all
+     * connections, instead of the heap.
+     *
+     * Connections then take from the pool only what they use, e.g. record buffers
+     * shrunk by #NetworkCredentials_t.maxFragmentLength, and the total is bounded
+     * by the pool. Call once before the first connection. Requires
+     * MBEDTLS_PLATFORM_MEMORY, without MBEDTLS_PLATFORM_CALLOC_MACRO.
+     *
+     * @param[in] pBuffer The pool, e.g. a static array.
+     * @param[in] bufferSize Size of the pool.
+     */
+    void TLS_FreeRTOS_InitBufferPool( uint8_t * pBuffer,
+                                      size_t bufferSize );
+
+#endif /* if defined( MBEDTLS_MEMORY_BUFFER_ALLOC_C ) */
+
+/**
+ * @brief Number of connections kept by the connection pool, 0 to leave the
+ * pool out of the build.
+ */
+#ifndef TLS_TRANSPORT_POOL_SIZE
+    #define TLS_TRANSPORT_POOL_SIZE    ( 0U )
+#endif
+
+#if ( TLS_TRANSPORT_POOL_SIZE > 0U )
+
+    /**
+     * @brief Time after which an idle pooled connection is closed rather than
+     * reused. Keep it below the idle timeout of the servers.
+     */
+    #ifndef TLS_TRANSPORT_POOL_IDLE_TIMEOUT_MS
+        #define TLS_TRANSPORT_POOL_IDLE_TIMEOUT_MS    ( 30000U )
+    #endif
+
+    /**
+     * @brief Longest host name of a pooled connection, without the terminator.
+     */
+    #ifndef TLS_TRANSPORT_POOL_HOST_NAME_MAX
+        #define TLS_TRANSPORT_POOL_HOST_NAME_MAX    ( 64U )
+    #endif
+
+    /**
+     * @brief Get a TLS connection from the pool, or create one.
+     *
+     * An idle connection to the same host and port, made with the same
+     * credentials, is reused if it has not been idle for longer than
+     * #TLS_TRANSPORT_POOL_IDLE_TIMEOUT_MS and the server has not closed it or
+     * sent anything since. Otherwise a new connection is made with
+     * #TLS_FreeRTOS_Connect in a free slot, or in the slot of the connection
+     * that has been idle the longest. A reused connection keeps the timeouts
+     * it was made with.
+     *
+     * @param[out] pNetworkContext Network context, whose pParams is set to
+     * the pooled connection.
+     * @param[in] pHostName The hostname of the remote endpoint.
+     * @param[in] port The destination port.
+     * @param[in] pNetworkCredentials Credentials for the TLS connection, which
+     * must stay valid while the connection is in the pool.
+     * @param[in] receiveTimeoutMs Receive socket timeout.
+     * @param[in] sendTimeoutMs Send socket timeout.
+     *
+     * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INSUFFICIENT_MEMORY if all
+     * the pooled connections are in use, or an error of #TLS_FreeRTOS_Connect.
+     */
+    TlsTransportStatus_t TLS_FreeRTOS_PoolConnect( NetworkContext_t * pNetworkContext,
+                                                   const char * pHostName,
+                                                   uint16_t port,
+                                                   const NetworkCredentials_t * pNetworkCredentials,
+                                                   uint32_t receiveTimeoutMs,
+                                                   uint32_t sendTimeoutMs );
+
+    /**
+     * @brief Give a connection from #TLS_FreeRTOS_PoolConnect back to the pool.
+     *
+     * @param[in] pNetworkContext Network context, whose pParams is cleared.
+     * @param[in] keepAlive pdTRUE to keep the connection for reuse, pdFALSE to
+     * disconnect it, e.g. after an error or when the server asked to close.
+     */
+    void TLS_FreeRTOS_PoolRelease( NetworkContext_t * pNetworkContext,
+                                   BaseType_t keepAlive );
+
+    /**
+     * @brief Disconnect all idle pooled connections, e.g. before the network
+     * goes down.
+     */
+    void TLS_FreeRTOS_PoolFlush( void );
+
+#endif /* if ( TLS_TRANSPORT_POOL_SIZE > 0U ) */
+
+/**
+ * @brief Initialize a TLS session so that it holds no session.
+ *
+ * @param[out] pSession The session to initialize.
+ */
+void TLS_FreeRTOS_SessionInit( TlsSession_t * pSession );
+
+/**
+ * @brief Free a TLS session, so that the next connection does a full handshake.
+ *
+ * @param[in] pSession The session to free.
+ */
+void TLS_FreeRTOS_SessionFree( TlsSession_t * pSession );
+
+/**
+ * @brief Serialize a TLS session, e.g. to keep it in memory retained during
+ * deep sleep.
+ *
+ * The serialized session contains the master secret of the session and must
+ * be protected like a private key.
+ *
+ * @param[in] pSession The session to serialize.
+ * @param[out] pBuffer Buffer to serialize into.
+ * @param[in] bufferSize Size of pBuffer.
+ * @param[out] pSavedLength Number of bytes written, or the size needed if the
+ * buffer is too small.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INVALID_PARAMETER if there is
+ * no session to save, #TLS_TRANSPORT_INSUFFICIENT_MEMORY if the buffer is too
+ * small, or #TLS_TRANSPORT_INTERNAL_ERROR.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_SessionSave( const TlsSession_t * pSession,
+                                               uint8_t * pBuffer,
+                                               size_t bufferSize,
+                                               size_t * pSavedLength );
+
+/**
+ * @brief Restore a TLS session serialized by #TLS_FreeRTOS_SessionSave.
+ *
+ * @param[out] pSession An initialized session, replaced by the restored one.
+ * @param[in] pBuffer The serialized session.
+ * @param[in] bufferLength Length of the serialized session.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INVALID_PARAMETER if the
+ * data is not a session saved by the same mbed TLS version and configuration.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_SessionLoad( TlsSession_t * pSession,
+                                               const uint8_t * pBuffer,
+                                               size_t bufferLength );
+
+/**
+ * @brief Get how much of #NetworkCredentials.pEarlyData the server accepted.
+ *
+ * @param[in] pNetworkContext A connection made by #TLS_FreeRTOS_Connect.
+ *
+ * @return Bytes accepted as early data, from the start of pEarlyData. 0 if
+ * none was sent, for example without a TLS 1.3 session that allows it, or
+ * if the server rejected it.
+ */
+size_t TLS_FreeRTOS_GetEarlyDataSent( const NetworkContext_t * pNetworkContext );
+
+/**
+ * @brief Set a semaphore that is given when the connection may have become
+ * readable.
+ *
+ * Lets a task block until there is something to receive instead of waking
+ * up to poll. See #TCP_Sockets_SetReadySemaphore for when it is given.
+ *
+ * @param[in] pNetworkContext A connection made by #TLS_FreeRTOS_Connect.
+ * @param[in] xSemaphore The semaphore to give, or NULL to stop.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INVALID_PARAMETER, or
+ * #TLS_TRANSPORT_INTERNAL_ERROR if the sockets port does not support it.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_SetReadySemaphore( NetworkContext_t * pNetworkContext,
+                                                     SemaphoreHandle_t xSemaphore );
+
+/**
+ * @brief Check without blocking whether data can be received from a
+ * connection.
+ *
+ * Decrypted data still held by mbed TLS counts as well as data waiting on the
+ * socket. Socket data may be only part of a TLS record, so a following
+ * #TLS_FreeRTOS_recv can still wait for the rest of the record.
+ *
+ * @param[in] pNetworkContext A connection made by #TLS_FreeRTOS_Connect.
+ *
+ * @return A positive value if data is available, 0 if not, or a negative value
+ * if the connection is closed or broken.
+ */
+int32_t TLS_FreeRTOS_Poll( NetworkContext_t * pNetworkContext );
+
+/**
+ * @brief Parse credentials into a cache that connections can share.
+ *
+ * The root CA chain is always parsed; the client certificate and private key
+ * are parsed if both are set. Start from a zero-initialized cache. A cache
+ * that is already loaded is freed first, so it must not be in use by a
+ * connection. If parsing fails, the cache is left empty.
+ *
+ * @note Connections using the cache share the private key context. With an
+ * RSA key, enable MBEDTLS_THREADING_C when connections can sign at the same
+ * time, since the blinding values in the key context are updated by each
+ * signature.
+ *
+ * @param[out] pCache The cache to load.
+ * @param[in] pNetworkCredentials Credentials to parse. The cache remembers
+ * their pRootCa, pClientCert and pPrivateKey to match them on connect.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INVALID_CREDENTIALS if a
+ * credential could not be parsed, or #TLS_TRANSPORT_INTERNAL_ERROR if the
+ * random number generator needed to parse the key could not be seeded.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_CredentialCacheLoad( TlsCredentialCache_t * pCache,
+                                                       const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Free a credential cache loaded by #TLS_FreeRTOS_CredentialCacheLoad.
+ *
+ * Disconnect all connections that use the cache before freeing it.
+ *
+ * @param[in] pCache The cache to free.
+ */
+void TLS_FreeRTOS_CredentialCacheFree( TlsCredentialCache_t * pCache );
+
 /**
  * @brief Receives data from an established TLS connection.
  *
@@ -216,4 +585,33 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                            const void * pBuffer,
                            size_t bytesToSend );
 
+/**
+ * @brief Size of the stack buffer that TLS_FreeRTOS_writev gathers short
+ * segments into, so that they go out as one TLS record.
+ */
+#ifndef TLS_TRANSPORT_WRITEV_BUFFER_SIZE
+    #define TLS_TRANSPORT_WRITEV_BUFFER_SIZE    ( 256U )
+#endif
+
+/**
+ * @brief Sends several buffers over an established TLS connection.
+ *
+ * This is the TLS version of the transport interface's
+ * #TransportWritev_t function. Segments shorter than
+ * #TLS_TRANSPORT_WRITEV_BUFFER_SIZE are copied together and sent as one
+ * TLS record; longer segments are sent from the caller's buffer.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[in] pIoVec Array of buffers to send, in order.
+ * @param[in] ioVecCount Number of buffers in @p pIoVec.
+ *
+ * @return Number of bytes (> 0) sent on success, which is less than the
+ * total if the rest has to be sent by another call;
+ * 0 if the socket times out without sending any bytes;
+ * else a negative value to represent error.
+ */
+int32_t TLS_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                             TransportOutVector_t * pIoVec,
+                             size_t ioVecCount );
+
 #endif /* ifndef USING_MBEDTLS */
@@ -46,6 +46,7 @@
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 
 /* MbedTLS Bio TCP sockets wrapper include. */
 #include "mbedtls_bio_tcp_sockets_wrapper.h"
@@ -54,6 +55,11 @@
 #include "transport_mbedtls_pkcs11.h"
 #include "mbedtls_pkcs11.h"
 
+/* mbed TLS memory pool include. */
+#if defined( MBEDTLS_MEMORY_BUFFER_ALLOC_C )
+    #include "mbedtls/memory_buffer_alloc.h"
+#endif
+
 /* PKCS #11 includes. */
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
@@ -107,6 +113,36 @@ static const char * pNoLowLevelMbedTlsCodeStr = "<No-Low-Level-Code>";
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief PKCS #11 session and client credentials kept between connections.
+ *
+ * Opening a session, logging in, finding the private key and reading its
+ * public part and the client certificate can each take a round trip to a
+ * secure element, so they are done once and reused by later connections.
+ * One connection at a time borrows the cache, since a PKCS #11 session
+ * can only run one signing operation at a time. While loaded, the cache
+ * keeps the persistent session of xPKCS11_BorrowSession() borrowed.
+ */
+typedef struct CredentialCache
+{
+    BaseType_t xIsValid;                                      /**< @brief pdTRUE once loaded, until flushed. */
+    BaseType_t xIsInUse;                                      /**< @brief pdTRUE while a connection borrows or loads it. */
+    uint32_t ulObjectGeneration;                              /**< @brief PKCS #11 object cache generation when loaded. */
+    CK_SESSION_HANDLE xP11Session;                            /**< @brief Borrowed, logged in session. */
+    CK_OBJECT_HANDLE xP11PrivateKey;                          /**< @brief Private key object. */
+    mbedtls_pk_context privKey;                               /**< @brief Private key context, bound to xP11Session. */
+    mbedtls_x509_crt clientCert;                              /**< @brief Client certificate context. */
+    char privateKeyLabel[ pkcs11configMAX_LABEL_LENGTH + 1 ]; /**< @brief Label of privKey. */
+    char clientCertLabel[ pkcs11configMAX_LABEL_LENGTH + 1 ]; /**< @brief Label of clientCert. */
+} CredentialCache_t;
+
+/**
+ * @brief The credential cache. Zero is the initialized, empty state.
+ */
+static CredentialCache_t credentialCache;
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Initialize the mbed TLS structures in a network connection.
  *
@@ -177,7 +213,48 @@ static CK_RV readCertificateIntoContext( SSLContext_t * pSslContext,
  * @return Zero on success.
  */
 static CK_RV initializeClientKeys( SSLContext_t * pxCtx,
-                                   const char * pcLabelName );
+                                   const char * pcLabelName,
+                                   mbedtls_pk_context * pxPrivKey );
+
+/**
+ * @brief Set up the client private key and certificate, from the credential
+ * cache if it holds them, else from the PKCS #11 module.
+ *
+ * @param[in] pSslContext Caller TLS context.
+ * @param[in] pNetworkCredentials Labels of the private key and certificate.
+ *
+ * @return CKR_OK on success.
+ */
+static CK_RV setupClientCredentials( SSLContext_t * pSslContext,
+                                     const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Take the credential cache for a connection.
+ *
+ * @return pdTRUE if taken, pdFALSE if another connection has it.
+ */
+static BaseType_t acquireCredentialCache( void );
+
+/**
+ * @brief Give back the credential cache, clearing it if it was flushed.
+ */
+static void releaseCredentialCache( void );
+
+/**
+ * @brief Free the contents of the credential cache and close its session.
+ * Only called by the holder of the cache.
+ */
+static void clearCredentialCache( void );
+
+/**
+ * @brief Convert #NetworkCredentials_t.maxFragmentLength to the code of the
+ * maximum fragment length extension.
+ *
+ * @param[in] maxFragmentLength 512, 1024, 2048, 4096, or 0 for 4096.
+ *
+ * @return The MBEDTLS_SSL_MAX_FRAG_LEN_* code, or MBEDTLS_SSL_MAX_FRAG_LEN_INVALID.
+ */
+static uint8_t maxFragmentLengthCode( uint16_t maxFragmentLength );
 
 /**
  * @brief Sign a cryptographic hash with the private key.
@@ -214,9 +291,14 @@ static void sslContextInit( SSLContext_t * pSslContext )
     mbedtls_ssl_config_init( &( pSslContext->config ) );
     mbedtls_x509_crt_init( &( pSslContext->rootCa ) );
     mbedtls_x509_crt_init( &( pSslContext->clientCert ) );
+    mbedtls_pk_init( &( pSslContext->privKey ) );
     mbedtls_ssl_init( &( pSslContext->context ) );
 
-    xInitializePkcs11Session( &( pSslContext->xP11Session ) );
+    /* The session is opened, or borrowed from the credential cache, when
+     * the client credentials are set up. */
+    pSslContext->xP11Session = CK_INVALID_HANDLE;
+    pSslContext->xP11PrivateKey = CK_INVALID_HANDLE;
+    pSslContext->xUsesCredentialCache = pdFALSE;
     C_GetFunctionList( &( pSslContext->pxP11FunctionList ) );
 }
 /*-----------------------------------------------------------*/
@@ -232,7 +314,22 @@ static void sslContextFree( SSLContext_t * pSslContext )
 
     mbedtls_pk_free( &( pSslContext->privKey ) );
 
-    pSslContext->pxP11FunctionList->C_CloseSession( pSslContext->xP11Session );
+    if( pSslContext->xUsesCredentialCache == pdTRUE )
+    {
+        /* The session stays open for the next connection. */
+        pSslContext->xUsesCredentialCache = pdFALSE;
+        releaseCredentialCache();
+    }
+    else if( pSslContext->xP11Session != CK_INVALID_HANDLE )
+    {
+        pSslContext->pxP11FunctionList->C_CloseSession( pSslContext->xP11Session );
+    }
+    else
+    {
+        /* Empty else marker. */
+    }
+
+    pSslContext->xP11Session = CK_INVALID_HANDLE;
 }
 
 /*-----------------------------------------------------------*/
@@ -320,37 +417,14 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
 
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
-        /* Setup the client private key. */
-        xResult = initializeClientKeys( &( pTlsTransportParams->sslContext ),
-                                        pNetworkCredentials->pPrivateKeyLabel );
+        /* Setup the client private key and certificate. */
+        xResult = setupClientCredentials( &( pTlsTransportParams->sslContext ),
+                                          pNetworkCredentials );
 
         if( xResult != CKR_OK )
         {
-            LogError( ( "Failed to setup key handling by PKCS #11." ) );
-
             returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
         }
-        else
-        {
-            /* Setup the client certificate. */
-            xResult = readCertificateIntoContext( &( pTlsTransportParams->sslContext ),
-                                                  pNetworkCredentials->pClientCertLabel,
-                                                  CKO_CERTIFICATE,
-                                                  &( pTlsTransportParams->sslContext.clientCert ) );
-
-            if( xResult != CKR_OK )
-            {
-                LogError( ( "Failed to get certificate from PKCS #11 module." ) );
-
-                returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
-            }
-            else
-            {
-                ( void ) mbedtls_ssl_conf_own_cert( &( pTlsTransportParams->sslContext.config ),
-                                                    &( pTlsTransportParams->sslContext.clientCert ),
-                                                    &( pTlsTransportParams->sslContext.privKey ) );
-            }
-        }
     }
 
     if( ( returnStatus == TLS_TRANSPORT_SUCCESS ) && ( pNetworkCredentials->pAlpnProtos != NULL ) )
@@ -424,12 +498,10 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
     #ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
         if( returnStatus == TLS_TRANSPORT_SUCCESS )
         {
-            /* Enable the max fragment extension. 4096 bytes is currently the largest fragment size permitted.
-             * See RFC 8449 https://tools.ietf.org/html/rfc8449 for more information.
-             *
-             * Smaller values can be found in "mbedtls/include/ssl.h".
-             */
-            mbedtlsError = mbedtls_ssl_conf_max_frag_len( &( pTlsTransportParams->sslContext.config ), MBEDTLS_SSL_MAX_FRAG_LEN_4096 );
+            /* Enable the max fragment extension, with the length requested for
+             * this connection. See RFC 6066 for more information. */
+            mbedtlsError = mbedtls_ssl_conf_max_frag_len( &( pTlsTransportParams->sslContext.config ),
+                                                          maxFragmentLengthCode( pNetworkCredentials->maxFragmentLength ) );
 
             if( mbedtlsError != 0 )
             {
@@ -439,6 +511,11 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
                 returnStatus = TLS_TRANSPORT_INTERNAL_ERROR;
             }
         }
+    #else /* ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+        if( pNetworkCredentials->maxFragmentLength != 0U )
+        {
+            LogWarn( ( "maxFragmentLength ignored: MBEDTLS_SSL_MAX_FRAGMENT_LENGTH is not defined." ) );
+        }
     #endif /* ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
@@ -462,6 +539,14 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
 
     if( returnStatus != TLS_TRANSPORT_SUCCESS )
     {
+        /* The module may have closed the cached session, e.g. after a reset
+         * of the secure element, so load the credentials again next time. */
+        if( ( returnStatus == TLS_TRANSPORT_HANDSHAKE_FAILED ) &&
+            ( pTlsTransportParams->sslContext.xUsesCredentialCache == pdTRUE ) )
+        {
+            credentialCache.xIsValid = pdFALSE;
+        }
+
         sslContextFree( &( pTlsTransportParams->sslContext ) );
     }
     else
@@ -483,7 +568,13 @@ static int32_t generateRandomBytes( void * pvCtx,
     SSLContext_t * pxCtx = ( SSLContext_t * ) pvCtx;
     CK_RV xResult;
 
-    xResult = pxCtx->pxP11FunctionList->C_GenerateRandom( pxCtx->xP11Session, pucRandom, xRandomLength );
+    #if ( MBEDTLS_PKCS11_RNG_USE_DRBG == 1 )
+        /* Draw from the DRBG seeded from the module, instead of going to the
+         * module for each of the many small requests of a handshake. */
+        xResult = ( CK_RV ) lMbedCryptoRngCallbackPKCS11( &( pxCtx->xP11Session ), pucRandom, xRandomLength );
+    #else
+        xResult = pxCtx->pxP11FunctionList->C_GenerateRandom( pxCtx->xP11Session, pucRandom, xRandomLength );
+    #endif
 
     if( xResult != CKR_OK )
     {
@@ -505,12 +596,10 @@ static CK_RV readCertificateIntoContext( SSLContext_t * pSslContext,
     CK_OBJECT_HANDLE xCertObj = 0;
 
     /* Get the handle of the certificate. */
-    xResult = xFindObjectWithLabelAndClass( pSslContext->xP11Session,
-                                            pcLabelName,
-                                            strnlen( pcLabelName,
-                                                     pkcs11configMAX_LABEL_LENGTH ),
-                                            xClass,
-                                            &xCertObj );
+    xResult = xPKCS11_FindObjectCached( pSslContext->xP11Session,
+                                        pcLabelName,
+                                        xClass,
+                                        &xCertObj );
 
     if( ( CKR_OK == xResult ) && ( xCertObj == CK_INVALID_HANDLE ) )
     {
@@ -575,40 +664,10 @@ static CK_RV readCertificateIntoContext( SSLContext_t * pSslContext,
  * @return Zero on success.
  */
 static CK_RV initializeClientKeys( SSLContext_t * pxCtx,
-                                   const char * pcLabelName )
+                                   const char * pcLabelName,
+                                   mbedtls_pk_context * pxPrivKey )
 {
     CK_RV xResult = CKR_OK;
-    CK_SLOT_ID * pxSlotIds = NULL;
-    CK_ULONG xCount = 0;
-    CK_ATTRIBUTE xTemplate[ 2 ];
-    mbedtls_pk_type_t xKeyAlgo = ( mbedtls_pk_type_t ) ~0;
-
-    /* Get the PKCS #11 module/token slot count. */
-    if( CKR_OK == xResult )
-    {
-        xResult = ( BaseType_t ) pxCtx->pxP11FunctionList->C_GetSlotList( CK_TRUE,
-                                                                          NULL,
-                                                                          &xCount );
-    }
-
-    /* Allocate memory to store the token slots. */
-    if( CKR_OK == xResult )
-    {
-        pxSlotIds = ( CK_SLOT_ID * ) pvPortMalloc( sizeof( CK_SLOT_ID ) * xCount );
-
-        if( NULL == pxSlotIds )
-        {
-            xResult = CKR_HOST_MEMORY;
-        }
-    }
-
-    /* Get all of the available private key slot identities. */
-    if( CKR_OK == xResult )
-    {
-        xResult = ( BaseType_t ) pxCtx->pxP11FunctionList->C_GetSlotList( CK_TRUE,
-                                                                          pxSlotIds,
-                                                                          &xCount );
-    }
 
     /* Put the module in authenticated mode. */
     if( CKR_OK == xResult )
@@ -617,17 +676,22 @@ static CK_RV initializeClientKeys( SSLContext_t * pxCtx,
                                                                     CKU_USER,
                                                                     ( CK_UTF8CHAR_PTR ) configPKCS11_DEFAULT_USER_PIN,
                                                                     sizeof( configPKCS11_DEFAULT_USER_PIN ) - 1 );
+
+        /* Login state is shared by the sessions of the application, and the
+         * cached session may be logged in already. */
+        if( xResult == CKR_USER_ALREADY_LOGGED_IN )
+        {
+            xResult = CKR_OK;
+        }
     }
 
     if( CKR_OK == xResult )
     {
         /* Get the handle of the device private key. */
-        xResult = xFindObjectWithLabelAndClass( pxCtx->xP11Session,
-                                                pcLabelName,
-                                                strnlen( pcLabelName,
-                                                         pkcs11configMAX_LABEL_LENGTH ),
-                                                CKO_PRIVATE_KEY,
-                                                &pxCtx->xP11PrivateKey );
+        xResult = xPKCS11_FindObjectCached( pxCtx->xP11Session,
+                                            pcLabelName,
+                                            CKO_PRIVATE_KEY,
+                                            &pxCtx->xP11PrivateKey );
     }
 
     if( ( CKR_OK == xResult ) && ( pxCtx->xP11PrivateKey == CK_INVALID_HANDLE ) )
@@ -638,19 +702,239 @@ static CK_RV initializeClientKeys( SSLContext_t * pxCtx,
 
     if( xResult == CKR_OK )
     {
-        xResult = xPKCS11_initMbedtlsPkContext( &( pxCtx->privKey ),
+        xResult = xPKCS11_initMbedtlsPkContext( pxPrivKey,
                                                 pxCtx->xP11Session,
                                                 pxCtx->xP11PrivateKey );
     }
 
-    /* Free memory. */
-    vPortFree( pxSlotIds );
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static CK_RV setupClientCredentials( SSLContext_t * pSslContext,
+                                     const NetworkCredentials_t * pNetworkCredentials )
+{
+    CK_RV xResult = CKR_OK;
+    BaseType_t xIsCacheAcquired = pdFALSE;
+    mbedtls_pk_context * pxPrivKey = &( pSslContext->privKey );
+    mbedtls_x509_crt * pxClientCert = &( pSslContext->clientCert );
+
+    configASSERT( pSslContext != NULL );
+    configASSERT( pNetworkCredentials != NULL );
+
+    xIsCacheAcquired = acquireCredentialCache();
+
+    if( xIsCacheAcquired == pdTRUE )
+    {
+        if( ( credentialCache.xIsValid == pdTRUE ) &&
+            ( credentialCache.ulObjectGeneration == ulPKCS11_GetObjectCacheGeneration() ) &&
+            ( strncmp( credentialCache.privateKeyLabel,
+                       pNetworkCredentials->pPrivateKeyLabel,
+                       pkcs11configMAX_LABEL_LENGTH ) == 0 ) &&
+            ( strncmp( credentialCache.clientCertLabel,
+                       pNetworkCredentials->pClientCertLabel,
+                       pkcs11configMAX_LABEL_LENGTH ) == 0 ) )
+        {
+            LogDebug( ( "Using the cached PKCS #11 session and credentials." ) );
+
+            pSslContext->xP11Session = credentialCache.xP11Session;
+            pSslContext->xP11PrivateKey = credentialCache.xP11PrivateKey;
+            pSslContext->xUsesCredentialCache = pdTRUE;
+        }
+        else
+        {
+            /* Empty, flushed, out of date or for other labels: load into it,
+             * using the persistent session. */
+            clearCredentialCache();
+            credentialCache.ulObjectGeneration = ulPKCS11_GetObjectCacheGeneration();
+
+            if( xPKCS11_BorrowSession( &( credentialCache.xP11Session ) ) == CKR_OK )
+            {
+                pSslContext->xP11Session = credentialCache.xP11Session;
+            }
+            else
+            {
+                /* Someone else has the session; load without the cache. */
+                releaseCredentialCache();
+                xIsCacheAcquired = pdFALSE;
+            }
+        }
+    }
+
+    if( xIsCacheAcquired == pdTRUE )
+    {
+        pxPrivKey = &( credentialCache.privKey );
+        pxClientCert = &( credentialCache.clientCert );
+    }
+
+    if( pSslContext->xUsesCredentialCache == pdFALSE )
+    {
+        if( pSslContext->xP11Session == CK_INVALID_HANDLE )
+        {
+            xResult = xInitializePkcs11Session( &( pSslContext->xP11Session ) );
+        }
+
+        if( xResult != CKR_OK )
+        {
+            LogError( ( "Failed to open a PKCS #11 session." ) );
+        }
+
+        if( xResult == CKR_OK )
+        {
+            xResult = initializeClientKeys( pSslContext,
+                                            pNetworkCredentials->pPrivateKeyLabel,
+                                            pxPrivKey );
+
+            if( xResult != CKR_OK )
+            {
+                LogError( ( "Failed to setup key handling by PKCS #11." ) );
+            }
+        }
+
+        if( xResult == CKR_OK )
+        {
+            xResult = readCertificateIntoContext( pSslContext,
+                                                  pNetworkCredentials->pClientCertLabel,
+                                                  CKO_CERTIFICATE,
+                                                  pxClientCert );
+
+            if( xResult != CKR_OK )
+            {
+                LogError( ( "Failed to get certificate from PKCS #11 module." ) );
+            }
+        }
+
+        if( ( xIsCacheAcquired == pdTRUE ) && ( xResult == CKR_OK ) )
+        {
+            credentialCache.xP11PrivateKey = pSslContext->xP11PrivateKey;
+            ( void ) strncpy( credentialCache.privateKeyLabel,
+                              pNetworkCredentials->pPrivateKeyLabel,
+                              pkcs11configMAX_LABEL_LENGTH );
+            credentialCache.privateKeyLabel[ pkcs11configMAX_LABEL_LENGTH ] = '\0';
+            ( void ) strncpy( credentialCache.clientCertLabel,
+                              pNetworkCredentials->pClientCertLabel,
+                              pkcs11configMAX_LABEL_LENGTH );
+            credentialCache.clientCertLabel[ pkcs11configMAX_LABEL_LENGTH ] = '\0';
+            credentialCache.xIsValid = pdTRUE;
+
+            pSslContext->xUsesCredentialCache = pdTRUE;
+        }
+        else if( xIsCacheAcquired == pdTRUE )
+        {
+            /* Clearing the cache returns the persistent session. */
+            clearCredentialCache();
+            releaseCredentialCache();
+            pSslContext->xP11Session = CK_INVALID_HANDLE;
+        }
+        else
+        {
+            /* Empty else marker. */
+        }
+    }
+
+    if( xResult == CKR_OK )
+    {
+        ( void ) mbedtls_ssl_conf_own_cert( &( pSslContext->config ),
+                                            pxClientCert,
+                                            pxPrivKey );
+    }
 
     return xResult;
 }
 
 /*-----------------------------------------------------------*/
 
+static BaseType_t acquireCredentialCache( void )
+{
+    BaseType_t xIsAcquired = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        if( credentialCache.xIsInUse == pdFALSE )
+        {
+            credentialCache.xIsInUse = pdTRUE;
+            xIsAcquired = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xIsAcquired;
+}
+
+/*-----------------------------------------------------------*/
+
+static void releaseCredentialCache( void )
+{
+    if( credentialCache.xIsValid == pdFALSE )
+    {
+        clearCredentialCache();
+    }
+
+    taskENTER_CRITICAL();
+    {
+        credentialCache.xIsInUse = pdFALSE;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+static void clearCredentialCache( void )
+{
+    credentialCache.xIsValid = pdFALSE;
+
+    mbedtls_pk_free( &( credentialCache.privKey ) );
+    mbedtls_pk_init( &( credentialCache.privKey ) );
+    mbedtls_x509_crt_free( &( credentialCache.clientCert ) );
+    mbedtls_x509_crt_init( &( credentialCache.clientCert ) );
+
+    if( credentialCache.xP11Session != CK_INVALID_HANDLE )
+    {
+        vPKCS11_ReturnSession();
+    }
+
+    credentialCache.xP11Session = CK_INVALID_HANDLE;
+    credentialCache.xP11PrivateKey = CK_INVALID_HANDLE;
+    credentialCache.privateKeyLabel[ 0 ] = '\0';
+    credentialCache.clientCertLabel[ 0 ] = '\0';
+}
+
+/*-----------------------------------------------------------*/
+
+static uint8_t maxFragmentLengthCode( uint16_t maxFragmentLength )
+{
+    uint8_t code = MBEDTLS_SSL_MAX_FRAG_LEN_INVALID;
+
+    switch( maxFragmentLength )
+    {
+        case 512U:
+            code = MBEDTLS_SSL_MAX_FRAG_LEN_512;
+            break;
+
+        case 1024U:
+            code = MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+            break;
+
+        case 2048U:
+            code = MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+            break;
+
+        /* 4096 bytes is the largest fragment size the extension permits. */
+        case 0U:
+        case 4096U:
+            code = MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+            break;
+
+        default:
+            break;
+    }
+
+    return code;
+}
+
+/*-----------------------------------------------------------*/
+
 TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
                                            const char * pHostName,
                                            uint16_t port,
@@ -680,6 +964,13 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         LogError( ( "pRootCa cannot be NULL." ) );
         returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
     }
+    else if( maxFragmentLengthCode( pNetworkCredentials->maxFragmentLength ) ==
+             MBEDTLS_SSL_MAX_FRAG_LEN_INVALID )
+    {
+        LogError( ( "maxFragmentLength must be 0, 512, 1024, 2048 or 4096, not %u.",
+                    ( unsigned ) pNetworkCredentials->maxFragmentLength ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
     else
     {
         /* Empty else for MISRA 15.7 compliance. */
@@ -776,6 +1067,44 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
 
 /*-----------------------------------------------------------*/
 
+#if defined( MBEDTLS_MEMORY_BUFFER_ALLOC_C )
+
+    void TLS_FreeRTOS_InitBufferPool( uint8_t * pBuffer,
+                                      size_t bufferSize )
+    {
+        configASSERT( pBuffer != NULL );
+
+        mbedtls_memory_buffer_alloc_init( pBuffer, bufferSize );
+    }
+
+#endif /* if defined( MBEDTLS_MEMORY_BUFFER_ALLOC_C ) */
+
+/*-----------------------------------------------------------*/
+
+void TLS_FreeRTOS_FlushCredentialCache( void )
+{
+    /* Also forgets the PKCS #11 object handles, which makes a cache that is
+     * in use out of date once it is released. */
+    vPKCS11_InvalidateObjectCache();
+
+    if( acquireCredentialCache() == pdTRUE )
+    {
+        clearCredentialCache();
+        releaseCredentialCache();
+    }
+    else
+    {
+        /* Cleared when the connection using it is disconnected. */
+        taskENTER_CRITICAL();
+        {
+            credentialCache.xIsValid = pdFALSE;
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
                            void * pBuffer,
                            size_t bytesToRecv )
@@ -893,3 +1222,107 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     return tlsStatus;
 }
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Sends one contiguous part of a TLS_FreeRTOS_writev call.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[in] pBuffer Bytes to send.
+ * @param[in] length Number of bytes to send.
+ * @param[in,out] pBytesSent Bytes sent so far by the call, or the error if
+ * none were sent.
+ *
+ * @return pdTRUE if all @p length bytes were sent, else pdFALSE.
+ */
+static BaseType_t writevSendPart( NetworkContext_t * pNetworkContext,
+                                  const void * pBuffer,
+                                  size_t length,
+                                  int32_t * pBytesSent )
+{
+    BaseType_t complete = pdFALSE;
+    int32_t sendStatus = TLS_FreeRTOS_send( pNetworkContext, pBuffer, length );
+
+    if( sendStatus < 0 )
+    {
+        /* Bytes that already went out are reported first, the error is
+         * returned again by the next send. */
+        if( *pBytesSent == 0 )
+        {
+            *pBytesSent = sendStatus;
+        }
+    }
+    else
+    {
+        *pBytesSent += sendStatus;
+
+        if( sendStatus == ( int32_t ) length )
+        {
+            complete = pdTRUE;
+        }
+    }
+
+    return complete;
+}
+/*-----------------------------------------------------------*/
+
+int32_t TLS_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                             TransportOutVector_t * pIoVec,
+                             size_t ioVecCount )
+{
+    uint8_t gatherBuffer[ TLS_TRANSPORT_WRITEV_BUFFER_SIZE ];
+    size_t gathered = 0U;
+    size_t i;
+    int32_t bytesSent = 0;
+    BaseType_t complete = pdTRUE;
+
+    if( ( pIoVec == NULL ) || ( ioVecCount == 0U ) )
+    {
+        LogError( ( "invalid input, pIoVec=%p, ioVecCount=%lu",
+                    ( void * ) pIoVec,
+                    ( unsigned long ) ioVecCount ) );
+        bytesSent = -1;
+    }
+    else
+    {
+        for( i = 0U; ( i < ioVecCount ) && ( complete == pdTRUE ); i++ )
+        {
+            /* Send what was gathered when this segment does not fit after it. */
+            if( ( gathered > 0U ) &&
+                ( pIoVec[ i ].iov_len > ( sizeof( gatherBuffer ) - gathered ) ) )
+            {
+                complete = writevSendPart( pNetworkContext, gatherBuffer, gathered, &bytesSent );
+                gathered = 0U;
+            }
+
+            if( complete == pdFALSE )
+            {
+                /* Stop at a partial send, the caller sends the rest. */
+            }
+            else if( pIoVec[ i ].iov_len >= sizeof( gatherBuffer ) )
+            {
+                /* Long segments are not worth a copy. */
+                complete = writevSendPart( pNetworkContext,
+                                           pIoVec[ i ].iov_base,
+                                           pIoVec[ i ].iov_len,
+                                           &bytesSent );
+            }
+            else if( pIoVec[ i ].iov_len > 0U )
+            {
+                ( void ) memcpy( &gatherBuffer[ gathered ], pIoVec[ i ].iov_base, pIoVec[ i ].iov_len );
+                gathered += pIoVec[ i ].iov_len;
+            }
+            else
+            {
+                /* Empty else marker. */
+            }
+        }
+
+        if( ( complete == pdTRUE ) && ( gathered > 0U ) )
+        {
+            ( void ) writevSendPart( pNetworkContext, gatherBuffer, gathered, &bytesSent );
+        }
+    }
+
+    return bytesSent;
+}
+/*-----------------------------------------------------------*/
@@ -76,6 +76,12 @@ typedef struct SSLContext
     CK_FUNCTION_LIST_PTR pxP11FunctionList;
     CK_SESSION_HANDLE xP11Session;
     CK_OBJECT_HANDLE xP11PrivateKey;
+
+    /**
+     * @brief pdTRUE if the session, private key and client certificate are
+     * borrowed from the credential cache instead of privKey and clientCert.
+     */
+    BaseType_t xUsesCredentialCache;
 } SSLContext_t;
 
 /**
@@ -116,6 +122,16 @@ typedef struct NetworkCredentials
     size_t passwordSize;             /**< @brief Size associated with #NetworkCredentials.pPassword. */
     const char * pClientCertLabel;   /**< @brief PKCS #11 label string of the client certificate. */
     const char * pPrivateKeyLabel;   /**< @brief PKCS #11 label for the private key. */
+
+    /**
+     * @brief Largest TLS record the server may send, negotiated with the
+     * maximum fragment length extension (RFC 6066): 512, 1024, 2048 or 4096,
+     * or 0 for 4096.
+     *
+     * With MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH, the record buffers of the
+     * connection are shrunk to the negotiated length after the handshake.
+     */
+    uint16_t maxFragmentLength;
 } NetworkCredentials_t;
 
 /**
@@ -160,6 +176,39 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
  */
 void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext );
 
+#if defined( MBEDTLS_MEMORY_BUFFER_ALLOC_C )
+
+    /**
+     * @brief Make mbed TLS allocate from a pre-allocated pool, shared by all
+     * connections, instead of the heap.
+     *
+     * Connections then take from the pool only what they use, e.g. record buffers
+     * shrunk by #NetworkCredentials_t.maxFragmentLength, and the total is bounded
+     * by the pool. Call once before the first connection. Requires
+     * MBEDTLS_PLATFORM_MEMORY, without MBEDTLS_PLATFORM_CALLOC_MACRO.
+     *
+     * @param[in] pBuffer The pool, e.g. a static array.
+     * @param[in] bufferSize Size of the pool.
+     */
+    void TLS_FreeRTOS_InitBufferPool( uint8_t * pBuffer,
+                                      size_t bufferSize );
+
+#endif /* if defined( MBEDTLS_MEMORY_BUFFER_ALLOC_C ) */
+
+/**
+ * @brief Drop the cached PKCS #11 session, private key and client certificate.
+ *
+ * The first connection borrows the persistent PKCS #11 session, logs in, finds
+ * the private key and reads the client certificate, and keeps all of it for
+ * the following connections with the same labels. Object handles are also
+ * cached by label, see xPKCS11_FindObjectCached(), so connections that cannot
+ * use the cache skip the object searches. Call this, or
+ * vPKCS11_InvalidateObjectCache(), after replacing the key or the certificate,
+ * or before calling C_Finalize. A connection using the cache keeps it until it
+ * is disconnected.
+ */
+void TLS_FreeRTOS_FlushCredentialCache( void );
+
 /**
  * @brief Receives data from an established TLS connection.
  *
@@ -196,4 +245,33 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                            const void * pBuffer,
                            size_t bytesToSend );
 
+/**
+ * @brief Size of the stack buffer that TLS_FreeRTOS_writev gathers short
+ * segments into, so that they go out as one TLS record.
+ */
+#ifndef TLS_TRANSPORT_WRITEV_BUFFER_SIZE
+    #define TLS_TRANSPORT_WRITEV_BUFFER_SIZE    ( 256U )
+#endif
+
+/**
+ * @brief Sends several buffers over an established TLS connection.
+ *
+ * This is the TLS version of the transport interface's
+ * #TransportWritev_t function. Segments shorter than
+ * #TLS_TRANSPORT_WRITEV_BUFFER_SIZE are copied together and sent as one
+ * TLS record; longer segments are sent from the caller's buffer.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[in] pIoVec Array of buffers to send, in order.
+ * @param[in] ioVecCount Number of buffers in @p pIoVec.
+ *
+ * @return Number of bytes (> 0) sent on success, which is less than the
+ * total if the rest has to be sent by another call;
+ * 0 if the socket times out without sending any bytes;
+ * else a negative value to represent error.
+ */
+int32_t TLS_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                             TransportOutVector_t * pIoVec,
+                             size_t ioVecCount );
+
 #endif /* ifndef TRANSPORT_MBEDTLS_PKCS11 */
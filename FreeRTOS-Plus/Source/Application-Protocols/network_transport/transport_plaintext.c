@@ -181,3 +181,108 @@ int32_t Plaintext_FreeRTOS_send( NetworkContext_t * pNetworkContext,
 
     return socketStatus;
 }
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sends one contiguous part of a Plaintext_FreeRTOS_writev call.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[in] pBuffer Bytes to send.
+ * @param[in] length Number of bytes to send.
+ * @param[in,out] pBytesSent Bytes sent so far by the call, or the error if
+ * none were sent.
+ *
+ * @return pdTRUE if all @p length bytes were sent, else pdFALSE.
+ */
+static BaseType_t writevSendPart( NetworkContext_t * pNetworkContext,
+                                  const void * pBuffer,
+                                  size_t length,
+                                  int32_t * pBytesSent )
+{
+    BaseType_t complete = pdFALSE;
+    int32_t sendStatus = Plaintext_FreeRTOS_send( pNetworkContext, pBuffer, length );
+
+    if( sendStatus < 0 )
+    {
+        /* Bytes that already went out are reported first, the error is
+         * returned again by the next send. */
+        if( *pBytesSent == 0 )
+        {
+            *pBytesSent = sendStatus;
+        }
+    }
+    else
+    {
+        *pBytesSent += sendStatus;
+
+        if( sendStatus == ( int32_t ) length )
+        {
+            complete = pdTRUE;
+        }
+    }
+
+    return complete;
+}
+/*-----------------------------------------------------------*/
+
+int32_t Plaintext_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                                   TransportOutVector_t * pIoVec,
+                                   size_t ioVecCount )
+{
+    uint8_t gatherBuffer[ PLAINTEXT_TRANSPORT_WRITEV_BUFFER_SIZE ];
+    size_t gathered = 0U;
+    size_t i;
+    int32_t bytesSent = 0;
+    BaseType_t complete = pdTRUE;
+
+    if( ( pIoVec == NULL ) || ( ioVecCount == 0U ) )
+    {
+        LogError( ( "invalid input, pIoVec=%p, ioVecCount=%lu",
+                    ( void * ) pIoVec,
+                    ( unsigned long ) ioVecCount ) );
+        bytesSent = -1;
+    }
+    else
+    {
+        for( i = 0U; ( i < ioVecCount ) && ( complete == pdTRUE ); i++ )
+        {
+            /* Send what was gathered when this segment does not fit after it. */
+            if( ( gathered > 0U ) &&
+                ( pIoVec[ i ].iov_len > ( sizeof( gatherBuffer ) - gathered ) ) )
+            {
+                complete = writevSendPart( pNetworkContext, gatherBuffer, gathered, &bytesSent );
+                gathered = 0U;
+            }
+
+            if( complete == pdFALSE )
+            {
+                /* Stop at a partial send, the caller sends the rest. */
+            }
+            else if( pIoVec[ i ].iov_len >= sizeof( gatherBuffer ) )
+            {
+                /* Long segments are not worth a copy. */
+                complete = writevSendPart( pNetworkContext,
+                                           pIoVec[ i ].iov_base,
+                                           pIoVec[ i ].iov_len,
+                                           &bytesSent );
+            }
+            else if( pIoVec[ i ].iov_len > 0U )
+            {
+                ( void ) memcpy( &gatherBuffer[ gathered ], pIoVec[ i ].iov_base, pIoVec[ i ].iov_len );
+                gathered += pIoVec[ i ].iov_len;
+            }
+            else
+            {
+                /* Empty else marker. */
+            }
+        }
+
+        if( ( complete == pdTRUE ) && ( gathered > 0U ) )
+        {
+            ( void ) writevSendPart( pNetworkContext, gatherBuffer, gathered, &bytesSent );
+        }
+    }
+
+    return bytesSent;
+}
+/*-----------------------------------------------------------*/
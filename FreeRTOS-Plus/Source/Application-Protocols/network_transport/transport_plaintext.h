@@ -149,4 +149,33 @@ int32_t Plaintext_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                                  const void * pBuffer,
                                  size_t bytesToSend );
 
+/**
+ * @brief Size of the stack buffer that Plaintext_FreeRTOS_writev gathers short
+ * segments into, so that they go out as one TCP segment.
+ */
+#ifndef PLAINTEXT_TRANSPORT_WRITEV_BUFFER_SIZE
+    #define PLAINTEXT_TRANSPORT_WRITEV_BUFFER_SIZE    ( 256U )
+#endif
+
+/**
+ * @brief Sends several buffers over an established TCP connection.
+ *
+ * This is the TCP version of the transport interface's
+ * #TransportWritev_t function. Segments shorter than
+ * #PLAINTEXT_TRANSPORT_WRITEV_BUFFER_SIZE are copied together and sent as one
+ * TCP segment; longer segments are sent from the caller's buffer.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[in] pIoVec Array of buffers to send, in order.
+ * @param[in] ioVecCount Number of buffers in @p pIoVec.
+ *
+ * @return Number of bytes (> 0) sent on success, which is less than the
+ * total if the rest has to be sent by another call;
+ * 0 if the socket times out without sending any bytes;
+ * else a negative value to represent error.
+ */
+int32_t Plaintext_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                                   TransportOutVector_t * pIoVec,
+                                   size_t ioVecCount );
+
 #endif /* ifndef USING_PLAINTEXT_H */
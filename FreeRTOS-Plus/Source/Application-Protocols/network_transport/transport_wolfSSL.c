@@ -35,6 +35,7 @@
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
@@ -52,6 +53,16 @@
 /* Demo Specific configs. */
 #include "demo_config.h"
 
+#ifdef WOLFSSL_STATIC_MEMORY
+    /* wolfSSL static memory include. */
+    #include "wolfssl/wolfcrypt/memory.h"
+
+/**
+ * @brief Pool set by #TLS_FreeRTOS_InitBufferPool, NULL to use the heap.
+ */
+    static WOLFSSL_HEAP_HINT * pTlsHeapHint = NULL;
+#endif
+
 /**
  * @brief Initialize the TLS structures in a network connection.
  *
@@ -95,7 +106,8 @@ static TlsTransportStatus_t initTLS( void );
  *  @param[in] sz  Size to receive
  *  @param[in] context Socket to be received from
  *
- *  @return received size( > 0 ), #WOLFSSL_CBIO_ERR_CONN_CLOSE, #WOLFSSL_CBIO_ERR_WANT_READ.
+ *  @return received size( > 0 ), #WOLFSSL_CBIO_ERR_CONN_CLOSE, #WOLFSSL_CBIO_ERR_WANT_READ,
+ *  #WOLFSSL_CBIO_ERR_GENERAL.
  */
 static int wolfSSL_IORecvGlue( WOLFSSL * ssl,
                                char * buf,
@@ -110,7 +122,8 @@ static int wolfSSL_IORecvGlue( WOLFSSL * ssl,
  *  @param[in] sz  Size to send
  *  @param[in] context Socket to be sent to
  *
- *  @return received size( > 0 ), #WOLFSSL_CBIO_ERR_CONN_CLOSE, #WOLFSSL_CBIO_ERR_WANT_WRITE.
+ *  @return sent size( > 0 ), #WOLFSSL_CBIO_ERR_CONN_CLOSE, #WOLFSSL_CBIO_ERR_WANT_WRITE,
+ *  #WOLFSSL_CBIO_ERR_GENERAL.
  */
 static int wolfSSL_IOSendGlue( WOLFSSL * ssl,
                                char * buf,
@@ -128,6 +141,16 @@ static int wolfSSL_IOSendGlue( WOLFSSL * ssl,
 static TlsTransportStatus_t loadCredentials( NetworkContext_t * pNetCtx,
                                              const NetworkCredentials_t * pNetCred );
 
+/*
+ *  @brief  Convert #NetworkCredentials_t.maxFragmentLength to the code of the
+ *  maximum fragment length extension.
+ *
+ *  @param[in] maxFragmentLength 512, 1024, 2048 or 4096.
+ *
+ *  @return The WOLFSSL_MFL_* code, or 0 if the length is not supported.
+ */
+static uint8_t maxFragmentLengthCode( uint16_t maxFragmentLength );
+
 /*-----------------------------------------------------------*/
 static int wolfSSL_IORecvGlue( WOLFSSL * ssl,
                                char * buf,
@@ -139,18 +162,25 @@ static int wolfSSL_IORecvGlue( WOLFSSL * ssl,
 
     Socket_t xSocket = ( Socket_t ) context;
 
-
+    /* wolfSSL passes its own input buffer, so the record is received
+     * straight into it without another copy */
     read = TCP_Sockets_Recv( xSocket, ( void * ) buf, ( size_t ) sz );
 
+    /* the TCP_SOCKETS_ERRNO_ codes are negative already */
     if( ( read == 0 ) ||
-        ( read == -TCP_SOCKETS_ERRNO_EWOULDBLOCK ) )
+        ( read == TCP_SOCKETS_ERRNO_EWOULDBLOCK ) )
     {
         read = WOLFSSL_CBIO_ERR_WANT_READ;
     }
-    else if( read == -TCP_SOCKETS_ERRNO_ENOTCONN )
+    else if( ( read == TCP_SOCKETS_ERRNO_ENOTCONN ) ||
+             ( read == TCP_SOCKETS_ERRNO_ECLOSED ) )
     {
         read = WOLFSSL_CBIO_ERR_CONN_CLOSE;
     }
+    else if( read < 0 )
+    {
+        read = WOLFSSL_CBIO_ERR_GENERAL;
+    }
     else
     {
         /* do nothing */
@@ -167,16 +197,27 @@ static int wolfSSL_IOSendGlue( WOLFSSL * ssl,
 {
     ( void ) ssl; /* to prevent unused warning*/
     Socket_t xSocket = ( Socket_t ) context;
+
+    /* sent straight from wolfSSL's output buffer */
     BaseType_t sent = TCP_Sockets_Send( xSocket, ( void * ) buf, ( size_t ) sz );
 
-    if( sent == -TCP_SOCKETS_ERRNO_EWOULDBLOCK )
+    /* 0 is a send timeout; wolfSSL would take it as progress and retry
+     * without end, so report it as WANT_WRITE */
+    if( ( sent == 0 ) ||
+        ( sent == TCP_SOCKETS_ERRNO_EWOULDBLOCK ) ||
+        ( sent == TCP_SOCKETS_ERRNO_ENOSPC ) )
     {
         sent = WOLFSSL_CBIO_ERR_WANT_WRITE;
     }
-    else if( sent == -TCP_SOCKETS_ERRNO_ENOTCONN )
+    else if( ( sent == TCP_SOCKETS_ERRNO_ENOTCONN ) ||
+             ( sent == TCP_SOCKETS_ERRNO_ECLOSED ) )
     {
         sent = WOLFSSL_CBIO_ERR_CONN_CLOSE;
     }
+    else if( sent < 0 )
+    {
+        sent = WOLFSSL_CBIO_ERR_GENERAL;
+    }
     else
     {
         /* do nothing */
@@ -198,6 +239,36 @@ static TlsTransportStatus_t initTLS( void )
     return TLS_TRANSPORT_SUCCESS;
 }
 
+/*-----------------------------------------------------------*/
+static uint8_t maxFragmentLengthCode( uint16_t maxFragmentLength )
+{
+    uint8_t code = 0U;
+
+    switch( maxFragmentLength )
+    {
+        case 512U:
+            code = WOLFSSL_MFL_2_9;
+            break;
+
+        case 1024U:
+            code = WOLFSSL_MFL_2_10;
+            break;
+
+        case 2048U:
+            code = WOLFSSL_MFL_2_11;
+            break;
+
+        case 4096U:
+            code = WOLFSSL_MFL_2_12;
+            break;
+
+        default:
+            break;
+    }
+
+    return code;
+}
+
 /*-----------------------------------------------------------*/
 static TlsTransportStatus_t loadCredentials( NetworkContext_t * pNetCtx,
                                              const NetworkCredentials_t * pNetCred )
@@ -284,6 +355,12 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
 {
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
     Socket_t xSocket = { 0 };
+    int handshakeStatus = 0;
+    int earlyDataSent = 0;
+
+    #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+        TickType_t startTime = 0;
+    #endif
 
     configASSERT( pNetCtx != NULL );
     configASSERT( pHostName != NULL );
@@ -294,8 +371,33 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
     if( pNetCtx->sslContext.ctx == NULL )
     {
         /* Attempt to create a context that uses the TLS 1.3 or 1.2 */
-        pNetCtx->sslContext.ctx =
-            wolfSSL_CTX_new( wolfSSLv23_client_method_ex( NULL ) );
+        #ifdef WOLFSSL_STATIC_MEMORY
+            WOLFSSL_HEAP_HINT * pHeapHint = pTlsHeapHint;
+
+            /* a pool of its own bounds what this connection can take */
+            if( pNetCred->pTlsBuffer != NULL )
+            {
+                pHeapHint = NULL;
+
+                if( wc_LoadStaticMemory( &pHeapHint, pNetCred->pTlsBuffer,
+                                         ( unsigned int ) pNetCred->tlsBufferSize,
+                                         WOLFMEM_GENERAL, 0 ) != 0 )
+                {
+                    LogError( ( "Failed to load a connection buffer pool of %lu bytes",
+                                ( unsigned long ) pNetCred->tlsBufferSize ) );
+                    pHeapHint = NULL;
+                }
+            }
+
+            if( ( pNetCred->pTlsBuffer == NULL ) || ( pHeapHint != NULL ) )
+            {
+                pNetCtx->sslContext.ctx =
+                    wolfSSL_CTX_new_ex( wolfSSLv23_client_method_ex( pHeapHint ), pHeapHint );
+            }
+        #else
+            pNetCtx->sslContext.ctx =
+                wolfSSL_CTX_new( wolfSSLv23_client_method_ex( NULL ) );
+        #endif
     }
 
     if( pNetCtx->sslContext.ctx != NULL )
@@ -321,10 +423,86 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
                 wolfSSL_SetIOReadCtx( pNetCtx->sslContext.ssl, xSocket );
                 wolfSSL_SetIOWriteCtx( pNetCtx->sslContext.ssl, xSocket );
 
+                /* ask the server for records no larger than requested */
+                #ifdef HAVE_MAX_FRAGMENT
+                    if( ( pNetCred->maxFragmentLength != 0U ) &&
+                        ( wolfSSL_UseMaxFragment( pNetCtx->sslContext.ssl,
+                                                  maxFragmentLengthCode( pNetCred->maxFragmentLength ) ) != WOLFSSL_SUCCESS ) )
+                    {
+                        LogError( ( "Failed to set the maximum fragment length" ) );
+                    }
+                #else
+                    if( pNetCred->maxFragmentLength != 0U )
+                    {
+                        LogWarn( ( "maxFragmentLength ignored: HAVE_MAX_FRAGMENT is not defined" ) );
+                    }
+                #endif
+
+                /* resume the last session with this host, if there is one */
+                #if !defined( NO_SESSION_CACHE ) && !defined( NO_CLIENT_CACHE )
+                    if( pNetCred->resumeSession == pdTRUE )
+                    {
+                        #ifdef HAVE_SESSION_TICKET
+                            ( void ) wolfSSL_UseSessionTicket( pNetCtx->sslContext.ssl );
+                        #endif
+
+                        if( wolfSSL_SetServerID( pNetCtx->sslContext.ssl,
+                                                 ( const unsigned char * ) pHostName,
+                                                 ( int ) strlen( pHostName ),
+                                                 0 ) != WOLFSSL_SUCCESS )
+                        {
+                            LogWarn( ( "Failed to look up a session to resume" ) );
+                        }
+                    }
+                #else
+                    if( pNetCred->resumeSession == pdTRUE )
+                    {
+                        LogWarn( ( "resumeSession ignored: NO_SESSION_CACHE or NO_CLIENT_CACHE is defined" ) );
+                    }
+                #endif /* if !defined( NO_SESSION_CACHE ) && !defined( NO_CLIENT_CACHE ) */
+
+                traceTLS_HANDSHAKE_START( pNetCtx );
+
+                #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+                    startTime = xTaskGetTickCount();
+                #endif
+
+                /* send the early data with the ClientHello if the resumed
+                 * session allows it; otherwise this only sends the ClientHello */
+                #if defined( WOLFSSL_TLS13 ) && defined( WOLFSSL_EARLY_DATA )
+                    if( ( pNetCred->pEarlyData != NULL ) && ( pNetCred->earlyDataSize > 0U ) )
+                    {
+                        if( wolfSSL_write_early_data( pNetCtx->sslContext.ssl,
+                                                      pNetCred->pEarlyData,
+                                                      ( int ) pNetCred->earlyDataSize,
+                                                      &earlyDataSent ) < 0 )
+                        {
+                            earlyDataSent = 0;
+                        }
+                    }
+                #else
+                    if( pNetCred->pEarlyData != NULL )
+                    {
+                        LogWarn( ( "pEarlyData ignored: WOLFSSL_TLS13 or WOLFSSL_EARLY_DATA is not defined" ) );
+                    }
+                #endif /* if defined( WOLFSSL_TLS13 ) && defined( WOLFSSL_EARLY_DATA ) */
+
                 /* let wolfSSL perform tls handshake */
-                if( wolfSSL_connect( pNetCtx->sslContext.ssl )
-                    == SSL_SUCCESS )
+                handshakeStatus = wolfSSL_connect( pNetCtx->sslContext.ssl );
+
+                #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+                    pNetCtx->stats.handshakeTimeMs = pdTICKS_TO_MS( xTaskGetTickCount() - startTime );
+                #endif
+
+                if( handshakeStatus == SSL_SUCCESS )
                 {
+                    /* a server that did not resume the session ignored the early data */
+                    if( ( earlyDataSent > 0 ) &&
+                        ( wolfSSL_session_reused( pNetCtx->sslContext.ssl ) == 1 ) )
+                    {
+                        pNetCtx->earlyDataSent = ( size_t ) earlyDataSent;
+                    }
+
                     returnStatus = TLS_TRANSPORT_SUCCESS;
                 }
                 else
@@ -338,6 +516,8 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
                     LogError( ( "Failed to establish a TLS connection" ) );
                     returnStatus = TLS_TRANSPORT_HANDSHAKE_FAILED;
                 }
+
+                traceTLS_HANDSHAKE_END( pNetCtx, returnStatus );
             }
             else
             {
@@ -382,6 +562,10 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     BaseType_t socketStatus = 0;
     BaseType_t isSocketConnected = pdFALSE;
 
+    #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+        TickType_t startTime = 0;
+    #endif
+
     if( ( pNetworkContext == NULL ) ||
         ( pHostName == NULL ) ||
         ( pNetworkCredentials == NULL ) )
@@ -398,11 +582,24 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         LogError( ( "pRootCa cannot be NULL." ) );
         returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
     }
+    else if( ( pNetworkCredentials->maxFragmentLength != 0U ) &&
+             ( maxFragmentLengthCode( pNetworkCredentials->maxFragmentLength ) == 0U ) )
+    {
+        LogError( ( "maxFragmentLength must be 0, 512, 1024, 2048 or 4096, not %u.",
+                    ( unsigned ) pNetworkCredentials->maxFragmentLength ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
 
     /* Establish a TCP connection with the server. */
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
         pNetworkContext->tcpSocket = NULL;
+        pNetworkContext->earlyDataSent = 0U;
+
+        #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+            ( void ) memset( &( pNetworkContext->stats ), 0, sizeof( TlsTransportStats_t ) );
+            startTime = xTaskGetTickCount();
+        #endif
 
         socketStatus = TCP_Sockets_Connect( &( pNetworkContext->tcpSocket ),
                                             pHostName,
@@ -410,6 +607,10 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
                                             receiveTimeoutMs,
                                             sendTimeoutMs );
 
+        #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+            pNetworkContext->stats.tcpConnectTimeMs = pdTICKS_TO_MS( xTaskGetTickCount() - startTime );
+        #endif
+
         if( socketStatus != 0 )
         {
             LogError( ( "Failed to connect to %s with error %d.",
@@ -480,6 +681,99 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
 
 /*-----------------------------------------------------------*/
 
+#if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+
+    void TLS_FreeRTOS_GetStats( const NetworkContext_t * pNetworkContext,
+                                TlsTransportStats_t * pStats )
+    {
+        configASSERT( pNetworkContext != NULL );
+        configASSERT( pStats != NULL );
+
+        *pStats = pNetworkContext->stats;
+    }
+
+#endif /* if ( TLS_TRANSPORT_ENABLE_STATS == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+#ifdef WOLFSSL_STATIC_MEMORY
+
+    TlsTransportStatus_t TLS_FreeRTOS_InitBufferPool( uint8_t * pBuffer,
+                                                      size_t bufferSize )
+    {
+        TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+        configASSERT( pBuffer != NULL );
+
+        /* Divide the pool into the buckets configured by WOLFMEM_BUCKETS and
+         * WOLFMEM_DIST, shared by all connections. */
+        if( wc_LoadStaticMemory( &pTlsHeapHint, pBuffer, ( unsigned int ) bufferSize,
+                                 WOLFMEM_GENERAL, 0 ) != 0 )
+        {
+            LogError( ( "Failed to load a TLS buffer pool of %lu bytes",
+                        ( unsigned long ) bufferSize ) );
+            pTlsHeapHint = NULL;
+            returnStatus = TLS_TRANSPORT_INSUFFICIENT_MEMORY;
+        }
+
+        return returnStatus;
+    }
+
+#endif /* ifdef WOLFSSL_STATIC_MEMORY */
+
+/*-----------------------------------------------------------*/
+
+size_t TLS_FreeRTOS_GetEarlyDataSent( const NetworkContext_t * pNetworkContext )
+{
+    configASSERT( pNetworkContext != NULL );
+
+    return pNetworkContext->earlyDataSent;
+}
+
+/*-----------------------------------------------------------*/
+
+#ifdef PERSIST_SESSION_CACHE
+
+    TlsTransportStatus_t TLS_FreeRTOS_SessionCacheSave( uint8_t * pBuffer,
+                                                        size_t bufferLength )
+    {
+        TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+        configASSERT( pBuffer != NULL );
+
+        if( wolfSSL_memsave_session_cache( pBuffer, ( int ) bufferLength ) != WOLFSSL_SUCCESS )
+        {
+            LogError( ( "Failed to save the session cache, %d bytes needed",
+                        wolfSSL_get_session_cache_memsize() ) );
+            returnStatus = TLS_TRANSPORT_INSUFFICIENT_MEMORY;
+        }
+
+        return returnStatus;
+    }
+
+/*-----------------------------------------------------------*/
+
+    TlsTransportStatus_t TLS_FreeRTOS_SessionCacheLoad( const uint8_t * pBuffer,
+                                                        size_t bufferLength )
+    {
+        TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+        configASSERT( pBuffer != NULL );
+
+        /* the cache is checked against the version and layout it was saved with */
+        if( wolfSSL_memrestore_session_cache( pBuffer, ( int ) bufferLength ) != WOLFSSL_SUCCESS )
+        {
+            LogError( ( "Failed to restore the session cache" ) );
+            returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+        }
+
+        return returnStatus;
+    }
+
+#endif /* ifdef PERSIST_SESSION_CACHE */
+
+/*-----------------------------------------------------------*/
+
 int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
                            void * pBuffer,
                            size_t bytesToRecv )
@@ -512,6 +806,10 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
         if( iResult > 0 )
         {
             tlsStatus = iResult;
+
+            #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+                pNetworkContext->stats.bytesReceived += ( uint64_t ) iResult;
+            #endif
         }
         else if( wolfSSL_want_read( pSsl ) == 1 )
         {
@@ -562,6 +860,10 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
         if( iResult > 0 )
         {
             tlsStatus = iResult;
+
+            #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+                pNetworkContext->stats.bytesSent += ( uint64_t ) iResult;
+            #endif
         }
         else if( wolfSSL_want_write( pSsl ) == 1 )
         {
@@ -578,3 +880,107 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     return tlsStatus;
 }
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Sends one contiguous part of a TLS_FreeRTOS_writev call.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[in] pBuffer Bytes to send.
+ * @param[in] length Number of bytes to send.
+ * @param[in,out] pBytesSent Bytes sent so far by the call, or the error if
+ * none were sent.
+ *
+ * @return pdTRUE if all @p length bytes were sent, else pdFALSE.
+ */
+static BaseType_t writevSendPart( NetworkContext_t * pNetworkContext,
+                                  const void * pBuffer,
+                                  size_t length,
+                                  int32_t * pBytesSent )
+{
+    BaseType_t complete = pdFALSE;
+    int32_t sendStatus = TLS_FreeRTOS_send( pNetworkContext, pBuffer, length );
+
+    if( sendStatus < 0 )
+    {
+        /* Bytes that already went out are reported first, the error is
+         * returned again by the next send. */
+        if( *pBytesSent == 0 )
+        {
+            *pBytesSent = sendStatus;
+        }
+    }
+    else
+    {
+        *pBytesSent += sendStatus;
+
+        if( sendStatus == ( int32_t ) length )
+        {
+            complete = pdTRUE;
+        }
+    }
+
+    return complete;
+}
+/*-----------------------------------------------------------*/
+
+int32_t TLS_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                             TransportOutVector_t * pIoVec,
+                             size_t ioVecCount )
+{
+    uint8_t gatherBuffer[ TLS_TRANSPORT_WRITEV_BUFFER_SIZE ];
+    size_t gathered = 0U;
+    size_t i;
+    int32_t bytesSent = 0;
+    BaseType_t complete = pdTRUE;
+
+    if( ( pIoVec == NULL ) || ( ioVecCount == 0U ) )
+    {
+        LogError( ( "invalid input, pIoVec=%p, ioVecCount=%lu",
+                    ( void * ) pIoVec,
+                    ( unsigned long ) ioVecCount ) );
+        bytesSent = -1;
+    }
+    else
+    {
+        for( i = 0U; ( i < ioVecCount ) && ( complete == pdTRUE ); i++ )
+        {
+            /* Send what was gathered when this segment does not fit after it. */
+            if( ( gathered > 0U ) &&
+                ( pIoVec[ i ].iov_len > ( sizeof( gatherBuffer ) - gathered ) ) )
+            {
+                complete = writevSendPart( pNetworkContext, gatherBuffer, gathered, &bytesSent );
+                gathered = 0U;
+            }
+
+            if( complete == pdFALSE )
+            {
+                /* Stop at a partial send, the caller sends the rest. */
+            }
+            else if( pIoVec[ i ].iov_len >= sizeof( gatherBuffer ) )
+            {
+                /* Long segments are not worth a copy. */
+                complete = writevSendPart( pNetworkContext,
+                                           pIoVec[ i ].iov_base,
+                                           pIoVec[ i ].iov_len,
+                                           &bytesSent );
+            }
+            else if( pIoVec[ i ].iov_len > 0U )
+            {
+                ( void ) memcpy( &gatherBuffer[ gathered ], pIoVec[ i ].iov_base, pIoVec[ i ].iov_len );
+                gathered += pIoVec[ i ].iov_len;
+            }
+            else
+            {
+                /* Empty else marker. */
+            }
+        }
+
+        if( ( complete == pdTRUE ) && ( gathered > 0U ) )
+        {
+            ( void ) writevSendPart( pNetworkContext, gatherBuffer, gathered, &bytesSent );
+        }
+    }
+
+    return bytesSent;
+}
+/*-----------------------------------------------------------*/
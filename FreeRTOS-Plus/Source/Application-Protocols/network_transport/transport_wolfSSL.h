@@ -66,6 +66,25 @@
 /* wolfSSL interface include. */
 #include "wolfssl/ssl.h"
 
+/**
+ * @brief Set to 1 to keep #TlsTransportStats_t for each connection.
+ */
+#ifndef TLS_TRANSPORT_ENABLE_STATS
+    #define TLS_TRANSPORT_ENABLE_STATS    ( 0 )
+#endif
+
+/**
+ * @brief Hooks around the TLS handshake, e.g. to time it with the trace
+ * recorder's xTraceIntervalStart() and xTraceIntervalStop(). They are empty
+ * by default.
+ */
+#ifndef traceTLS_HANDSHAKE_START
+    #define traceTLS_HANDSHAKE_START( pNetworkContext )
+#endif
+#ifndef traceTLS_HANDSHAKE_END
+    #define traceTLS_HANDSHAKE_END( pNetworkContext, returnStatus )
+#endif
+
 /**
  * @brief Secured connection context.
  */
@@ -75,6 +94,24 @@ typedef struct SSLContext
     WOLFSSL* ssl;                         /**< @brief wolfSSL ssl session context */
 } SSLContext_t;
 
+#if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+
+    /**
+     * @brief Timing and traffic statistics of a TLS connection.
+     *
+     * Times are in milliseconds, at the resolution of the tick. The counters
+     * are for application data, not the handshake.
+     */
+    typedef struct TlsTransportStats
+    {
+        uint32_t tcpConnectTimeMs; /**< @brief DNS lookup and TCP connect. */
+        uint32_t handshakeTimeMs;  /**< @brief Whole TLS handshake. */
+        uint64_t bytesSent;        /**< @brief Bytes sent. */
+        uint64_t bytesReceived;    /**< @brief Bytes received. */
+    } TlsTransportStats_t;
+
+#endif /* if ( TLS_TRANSPORT_ENABLE_STATS == 1 ) */
+
 /**
  * @brief Definition of the network context for the transport interface
  * implementation that uses mbedTLS and FreeRTOS+TLS sockets.
@@ -83,6 +120,10 @@ struct NetworkContext
 {
     Socket_t tcpSocket;
     SSLContext_t sslContext;
+    #if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+        TlsTransportStats_t stats;
+    #endif
+    size_t earlyDataSent; /**< @brief Bytes of early data sent with a resumed session. */
 };
 
 /**
@@ -116,6 +157,57 @@ typedef struct NetworkCredentials
     size_t userNameSize;               /**< @brief Size associated with #IotNetworkCredentials.pUserName. */
     const unsigned char * pPassword;   /**< @brief String representing the password for MQTT. */
     size_t passwordSize;               /**< @brief Size associated with #IotNetworkCredentials.pPassword. */
+
+    /**
+     * @brief Largest TLS record the server may send, negotiated with the
+     * maximum fragment length extension (RFC 6066): 512, 1024, 2048 or 4096,
+     * or 0 to not use the extension. Requires HAVE_MAX_FRAGMENT.
+     *
+     * wolfSSL grows its input buffer to the largest record received, so this
+     * bounds the buffer of the connection.
+     */
+    uint16_t maxFragmentLength;
+
+    /**
+     * @brief Set to pdTRUE to resume the last session with the same host.
+     *
+     * wolfSSL keeps the sessions, including TLS 1.3 session tickets received
+     * after the handshake, in its client session cache, looked up by host
+     * name. Requires NO_SESSION_CACHE and NO_CLIENT_CACHE not defined. To keep
+     * the cache across deep sleep, see #TLS_FreeRTOS_SessionCacheSave.
+     */
+    BaseType_t resumeSession;
+
+    /**
+     * @brief Optional application data to send as TLS 1.3 early data (0-RTT),
+     * or NULL.
+     *
+     * Early data is sent with the ClientHello when the resumed session is a
+     * TLS 1.3 session that allows it, so a short request costs no extra round
+     * trip. Requires WOLFSSL_TLS13 and WOLFSSL_EARLY_DATA. It may be replayed
+     * by an attacker, so only use it for idempotent requests. After
+     * connecting, #TLS_FreeRTOS_GetEarlyDataSent tells how much was sent;
+     * send the rest as usual.
+     */
+    const unsigned char * pEarlyData;
+    size_t earlyDataSize; /**< @brief Size associated with #NetworkCredentials.pEarlyData. */
+
+    #ifdef WOLFSSL_STATIC_MEMORY
+
+        /**
+         * @brief Optional pool for this connection alone, or NULL to use the
+         * pool of #TLS_FreeRTOS_InitBufferPool, or the heap if there is none.
+         *
+         * wolfSSL allocates the context, the session and the record buffers
+         * of the connection from it, divided into the WOLFMEM_BUCKETS and
+         * WOLFMEM_DIST buckets, so the connection can never take more than
+         * this and cannot fragment the heap or another connection's pool.
+         * The pool must stay unused by anything else until
+         * #TLS_FreeRTOS_Disconnect returns.
+         */
+        uint8_t * pTlsBuffer;
+        size_t tlsBufferSize; /**< @brief Size associated with #NetworkCredentials.pTlsBuffer. */
+    #endif
 } NetworkCredentials_t;
 
 /**
@@ -160,6 +252,84 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
  */
 void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext );
 
+#if ( TLS_TRANSPORT_ENABLE_STATS == 1 )
+
+    /**
+     * @brief Get a copy of the statistics of a connection.
+     *
+     * @param[in] pNetworkContext Network context.
+     * @param[out] pStats The statistics since the connection was made.
+     */
+    void TLS_FreeRTOS_GetStats( const NetworkContext_t * pNetworkContext,
+                                TlsTransportStats_t * pStats );
+
+#endif /* if ( TLS_TRANSPORT_ENABLE_STATS == 1 ) */
+
+#ifdef WOLFSSL_STATIC_MEMORY
+
+    /**
+     * @brief Make wolfSSL allocate the contexts and buffers of all connections
+     * from a pre-allocated pool instead of the heap.
+     *
+     * Connections then take from the pool only what they use, and the total is
+     * bounded by the pool. Call once before the first connection. A connection
+     * given its own pool in #NetworkCredentials.pTlsBuffer does not use this one.
+     *
+     * @param[in] pBuffer The pool, e.g. a static array.
+     * @param[in] bufferSize Size of the pool.
+     *
+     * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INSUFFICIENT_MEMORY if the
+     * pool is too small to be divided into the configured wolfSSL buckets.
+     */
+    TlsTransportStatus_t TLS_FreeRTOS_InitBufferPool( uint8_t * pBuffer,
+                                                      size_t bufferSize );
+
+#endif /* ifdef WOLFSSL_STATIC_MEMORY */
+
+/**
+ * @brief Get how much of #NetworkCredentials.pEarlyData was sent as early data.
+ *
+ * wolfSSL does not report whether the server accepted the early data, only
+ * whether it resumed the session; early data sent with a session that was
+ * not resumed is counted as not sent.
+ *
+ * @param[in] pNetworkContext A connection made by #TLS_FreeRTOS_Connect.
+ *
+ * @return Bytes sent as early data, from the start of pEarlyData, or 0.
+ */
+size_t TLS_FreeRTOS_GetEarlyDataSent( const NetworkContext_t * pNetworkContext );
+
+#ifdef PERSIST_SESSION_CACHE
+
+    /**
+     * @brief Serialize wolfSSL's client session cache, e.g. to retained memory
+     * or flash before deep sleep.
+     *
+     * @param[out] pBuffer Buffer to serialize to.
+     * @param[in] bufferLength Size of pBuffer, at least
+     * wolfSSL_get_session_cache_memsize().
+     *
+     * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INSUFFICIENT_MEMORY if
+     * pBuffer is too small.
+     */
+    TlsTransportStatus_t TLS_FreeRTOS_SessionCacheSave( uint8_t * pBuffer,
+                                                        size_t bufferLength );
+
+    /**
+     * @brief Restore a client session cache serialized by
+     * #TLS_FreeRTOS_SessionCacheSave, before the first connection.
+     *
+     * @param[in] pBuffer The serialized cache.
+     * @param[in] bufferLength Length of the serialized cache.
+     *
+     * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INVALID_PARAMETER if the
+     * data is not a cache saved by the same wolfSSL configuration.
+     */
+    TlsTransportStatus_t TLS_FreeRTOS_SessionCacheLoad( const uint8_t * pBuffer,
+                                                        size_t bufferLength );
+
+#endif /* ifdef PERSIST_SESSION_CACHE */
+
 /**
  * @brief Receives data from an established TLS connection.
  *
@@ -196,4 +366,33 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                            const void * pBuffer,
                            size_t bytesToSend );
 
+/**
+ * @brief Size of the stack buffer that TLS_FreeRTOS_writev gathers short
+ * segments into, so that they go out as one TLS record.
+ */
+#ifndef TLS_TRANSPORT_WRITEV_BUFFER_SIZE
+    #define TLS_TRANSPORT_WRITEV_BUFFER_SIZE    ( 256U )
+#endif
+
+/**
+ * @brief Sends several buffers over an established TLS connection.
+ *
+ * This is the TLS version of the transport interface's
+ * #TransportWritev_t function. Segments shorter than
+ * #TLS_TRANSPORT_WRITEV_BUFFER_SIZE are copied together and sent as one
+ * TLS record; longer segments are sent from the caller's buffer.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[in] pIoVec Array of buffers to send, in order.
+ * @param[in] ioVecCount Number of buffers in @p pIoVec.
+ *
+ * @return Number of bytes (> 0) sent on success, which is less than the
+ * total if the rest has to be sent by another call;
+ * 0 if the socket times out without sending any bytes;
+ * else a negative value to represent error.
+ */
+int32_t TLS_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                             TransportOutVector_t * pIoVec,
+                             size_t ioVecCount );
+
 #endif /* ifndef USING_WOLFSSL_H */
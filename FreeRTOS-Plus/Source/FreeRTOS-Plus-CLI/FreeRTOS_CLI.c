@@ -35,6 +35,12 @@
 /* Utils includes. */
 #include "FreeRTOS_CLI.h"
 
+#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+	/* Standard includes used to format streamed output. */
+	#include <stdio.h>
+	#include <stdarg.h>
+#endif
+
 /* If the application writer needs to place the buffer used by the CLI at a
 fixed address then set configAPPLICATION_PROVIDES_cOutputBuffer to 1 in
 FreeRTOSConfig.h, then declare an array with the following name and size in
@@ -56,23 +62,96 @@ static void prvRegisterCommand( const CLI_Command_Definition_t * const pxCommand
 								CLI_Definition_List_Item_t * pxCliDefinitionListItemBuffer );
 
 /*
- * The callback function that is executed when "help" is entered.  This is the
- * only default command that is always present.
+ * The function that is executed when "help" is entered.  This is the only
+ * default command that is always present.  It lists the commands one per call,
+ * so needs the session in which it is running, and is therefore called
+ * directly rather than through a command line callback.
+ */
+static BaseType_t prvHelpCommand( CLI_Session_t *pxSession, char *pcWriteBuffer, size_t xWriteBufferLen );
+
+/*
+ * Implements FreeRTOS_CLIProcessCommand() and
+ * FreeRTOS_CLISessionProcessCommand() using the state held in pxSession.
  */
-static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static BaseType_t prvProcessCommand( CLI_Session_t *pxSession, const char * const pcCommandInput, char *pcWriteBuffer, size_t xWriteBufferLen );
 
 /*
  * Return the number of parameters that follow the command name.
  */
-static int8_t prvGetNumberOfParameters( const char *pcCommandString );
+#if( configCOMMAND_INT_HASH_TABLE_SIZE == 0 )
+	static int8_t prvGetNumberOfParameters( const char *pcCommandString );
+#endif
+
+#if( configCOMMAND_INT_HASH_TABLE_SIZE > 0 )
+
+	/*
+	 * Add a registered command to the hash table, after the help command if
+	 * that has not been added yet.  Must be called from a critical section.
+	 */
+	static void prvAddToHashTable( CLI_Definition_List_Item_t *pxListItem );
+
+	/*
+	 * Split pcCommandString into words in a single pass, storing the result
+	 * in pxTokens.
+	 */
+	static void prvTokeniseCommand( CLI_Command_Tokens_t *pxTokens, const char *pcCommandString );
+
+	/*
+	 * Return the registered command that pcCommandInput starts with, or NULL
+	 * if there is no such command.  Also tokenises pcCommandInput into
+	 * pxTokens.
+	 */
+	static const CLI_Definition_List_Item_t *prvFindHashedCommand( CLI_Command_Tokens_t *pxTokens, const char *pcCommandInput );
+
+#endif /* configCOMMAND_INT_HASH_TABLE_SIZE */
+
+#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+
+	/*
+	 * Run a command that streams its output, passing the output to the
+	 * session's sink each time pcWriteBuffer fills.  Leaves pcWriteBuffer
+	 * empty as everything has already been sent.
+	 */
+	static void prvStreamCommand( CLI_Session_t *pxSession, const CLI_Definition_List_Item_t *pxCommand, const char *pcCommandInput, char *pcWriteBuffer, size_t xWriteBufferLen );
+
+	/*
+	 * Pass any output collected in pxOutput's buffer to the sink.
+	 */
+	static void prvFlushOutput( CLI_Output_t *pxOutput );
+
+#endif /* configCOMMAND_INT_STREAMING_OUTPUT */
+
+#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+
+	/*
+	 * Add pxCommandToRegister to the end of the list of binary commands, using
+	 * pxListItem as the memory for the list entry.
+	 */
+	static void prvRegisterBinaryCommand( const CLI_Binary_Command_Definition_t * const pxCommandToRegister,
+										  CLI_Binary_Definition_List_Item_t * pxListItem );
+
+	/*
+	 * The response to cliFRAME_LIST_COMMANDS_ID.  Writes as many entries as fit
+	 * in xResponseLength bytes and returns the number of bytes written.
+	 */
+	static size_t prvListBinaryCommands( uint8_t *pucResponse, size_t xResponseLength );
+
+	/*
+	 * Read and write the little endian 16-bit values in frame headers.
+	 */
+	static uint16_t prvReadFrameUint16( const uint8_t *pucBuffer );
+	static void prvWriteFrameUint16( uint8_t *pucBuffer, uint16_t usValue );
+
+#endif /* configCOMMAND_INT_BINARY_FRAMES */
 
 /* The definition of the "help" command.  This command is always at the front
-of the list of registered commands. */
+of the list of registered commands.  It has no callback as prvHelpCommand() is
+called directly. */
 static const CLI_Command_Definition_t xHelpCommand =
 {
 	"help",
 	"\r\nhelp:\r\n Lists all the registered commands\r\n\r\n",
-	prvHelpCommand,
+	NULL,
 	0
 };
 
@@ -91,7 +170,8 @@ command interpreter by UART and by Ethernet.  Sharing a buffer is done purely
 to save RAM.  Note, however, that the command console itself is not re-entrant,
 so only one command interpreter interface can be used at any one time.  For that
 reason, no attempt at providing mutual exclusion to the cOutputBuffer array is
-attempted.
+attempted.  Consoles that must run at the same time should each use a
+CLI_Session_t, which has its own output buffer.
 
 configAPPLICATION_PROVIDES_cOutputBuffer is provided to allow the application
 writer to provide their own cOutputBuffer declaration in cases where the
@@ -102,6 +182,41 @@ buffer needs to be placed at a fixed address (rather than by the linker). */
 	extern char cOutputBuffer[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
 #endif
 
+/* The session used by FreeRTOS_CLIProcessCommand(), which writes to the buffer
+passed to it rather than to a session output buffer. */
+static CLI_Session_t xDefaultSession;
+
+#if( configCOMMAND_INT_HASH_TABLE_SIZE > 0 )
+
+	/* FNV-1a, used to hash the first word of a command. */
+	#define cliHASH_OFFSET_BASIS	( ( uint32_t ) 2166136261UL )
+	#define cliHASH_PRIME			( ( uint32_t ) 16777619UL )
+
+	/* Registered commands, chained through pxNextInBucket in the order in
+	which they were registered so the first match is the same command the
+	linear search would find. */
+	static CLI_Definition_List_Item_t *pxCommandHashTable[ configCOMMAND_INT_HASH_TABLE_SIZE ];
+
+	/* The help command is defined in this file so is added to the hash table
+	the first time it is needed. */
+	static BaseType_t xHelpCommandHashed = pdFALSE;
+
+#endif /* configCOMMAND_INT_HASH_TABLE_SIZE */
+
+#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+
+	/* The length field of a frame counts the bytes that follow it, so the
+	command ID and, in a response, the status byte are included. */
+	#define cliFRAME_REQUEST_ID_SIZE	( 2U )
+	#define cliFRAME_RESPONSE_ID_SIZE	( 3U )
+
+	/* Commands that can be run from a binary frame, in the order in which they
+	were registered.  Commands are found by comparing IDs, so no string
+	comparisons are needed to execute a frame. */
+	static CLI_Binary_Definition_List_Item_t *pxRegisteredBinaryCommands = NULL;
+
+#endif /* configCOMMAND_INT_BINARY_FRAMES */
+
 
 /*-----------------------------------------------------------*/
 
@@ -150,46 +265,98 @@ buffer needs to be placed at a fixed address (rather than by the linker). */
 
 BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  )
 {
-static const CLI_Definition_List_Item_t *pxCommand = NULL;
-BaseType_t xReturn = pdTRUE;
-const char *pcRegisteredCommandString;
-size_t xCommandStringLength;
-
 	/* Note:  This function is not re-entrant.  It must not be called from more
 	thank one task. */
+	return prvProcessCommand( &xDefaultSession, pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+}
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CLISessionInit( CLI_Session_t *pxSession, char *pcOutputBuffer, size_t xOutputBufferLength )
+{
+	configASSERT( pxSession != NULL );
+	configASSERT( pcOutputBuffer != NULL );
+
+	memset( pxSession, 0x00, sizeof( *pxSession ) );
+	pxSession->pcOutputBuffer = pcOutputBuffer;
+	pxSession->xOutputBufferLength = xOutputBufferLength;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLISessionProcessCommand( CLI_Session_t *pxSession, const char * const pcCommandInput )
+{
+	configASSERT( pxSession != NULL );
+	configASSERT( pxSession->pcOutputBuffer != NULL );
+
+	return prvProcessCommand( pxSession, pcCommandInput, pxSession->pcOutputBuffer, pxSession->xOutputBufferLength );
+}
+/*-----------------------------------------------------------*/
+
+char *FreeRTOS_CLISessionGetOutputBuffer( const CLI_Session_t *pxSession )
+{
+	configASSERT( pxSession != NULL );
+
+	return pxSession->pcOutputBuffer;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvProcessCommand( CLI_Session_t *pxSession, const char * const pcCommandInput, char *pcWriteBuffer, size_t xWriteBufferLen )
+{
+const CLI_Definition_List_Item_t *pxCommand = pxSession->pxCommand;
+BaseType_t xReturn = pdTRUE;
 
 	if( pxCommand == NULL )
 	{
-		/* Search for the command string in the list of registered commands. */
-		for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
+		#if( configCOMMAND_INT_HASH_TABLE_SIZE > 0 )
 		{
-			pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
-			xCommandStringLength = strlen( pcRegisteredCommandString );
+			/* Only the commands whose first word hashes to the same bucket as
+			the first word of the input need to be compared. */
+			pxCommand = prvFindHashedCommand( &( pxSession->xTokens ), pcCommandInput );
 
-			/* To ensure the string lengths match exactly, so as not to pick up
-			a sub-string of a longer command, check the byte after the expected
-			end of the string is either the end of the string or a space before
-			a parameter. */
-			if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
+			if( ( pxCommand != NULL ) && ( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 ) )
 			{
-				if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
+				if( pxSession->xTokens.cParameters != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
+				{
+					xReturn = pdFALSE;
+				}
+			}
+		}
+		#else
+		{
+		const char *pcRegisteredCommandString;
+		size_t xCommandStringLength;
+
+			/* Search for the command string in the list of registered commands. */
+			for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
+			{
+				pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
+				xCommandStringLength = strlen( pcRegisteredCommandString );
+
+				/* To ensure the string lengths match exactly, so as not to pick up
+				a sub-string of a longer command, check the byte after the expected
+				end of the string is either the end of the string or a space before
+				a parameter. */
+				if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
 				{
-					/* The command has been found.  Check it has the expected
-					number of parameters.  If cExpectedNumberOfParameters is -1,
-					then there could be a variable number of parameters and no
-					check is made. */
-					if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
+					if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
 					{
-						if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
+						/* The command has been found.  Check it has the expected
+						number of parameters.  If cExpectedNumberOfParameters is -1,
+						then there could be a variable number of parameters and no
+						check is made. */
+						if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
 						{
-							xReturn = pdFALSE;
+							if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
+							{
+								xReturn = pdFALSE;
+							}
 						}
-					}
 
-					break;
+						break;
+					}
 				}
 			}
 		}
+		#endif /* configCOMMAND_INT_HASH_TABLE_SIZE */
 	}
 
 	if( ( pxCommand != NULL ) && ( xReturn == pdFALSE ) )
@@ -202,7 +369,28 @@ size_t xCommandStringLength;
 	else if( pxCommand != NULL )
 	{
 		/* Call the callback function that is registered to this command. */
-		xReturn = pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+		if( pxCommand == &xRegisteredCommands )
+		{
+			xReturn = prvHelpCommand( pxSession, pcWriteBuffer, xWriteBufferLen );
+		}
+		#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+			else if( ( pxCommand->pxCommandLineDefinition->pxStreamInterpreter != NULL ) && ( pxSession->xOutput.pxSink != NULL ) )
+			{
+				prvStreamCommand( pxSession, pxCommand, pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+				xReturn = pdFALSE;
+			}
+			else if( pxCommand->pxCommandLineDefinition->pxCommandInterpreter == NULL )
+			{
+				/* The command can only stream its output, and the session has
+				nowhere to stream it to. */
+				strncpy( pcWriteBuffer, "This command cannot be used from this console.\r\n\r\n", xWriteBufferLen );
+				xReturn = pdFALSE;
+			}
+		#endif /* configCOMMAND_INT_STREAMING_OUTPUT */
+		else
+		{
+			xReturn = pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+		}
 
 		/* If xReturn is pdFALSE, then no further strings will be returned
 		after this one, and	pxCommand can be reset to NULL ready to search
@@ -219,6 +407,19 @@ size_t xCommandStringLength;
 		xReturn = pdFALSE;
 	}
 
+	#if( configCOMMAND_INT_HASH_TABLE_SIZE > 0 )
+	{
+		/* Forget the words of a command that has completed, as the buffer that
+		holds it is likely to be reused for the next command. */
+		if( pxCommand == NULL )
+		{
+			pxSession->xTokens.pcCommandString = NULL;
+		}
+	}
+	#endif
+
+	pxSession->pxCommand = pxCommand;
+
 	return xReturn;
 }
 /*-----------------------------------------------------------*/
@@ -236,6 +437,23 @@ const char *pcReturn = NULL;
 
 	*pxParameterStringLength = 0;
 
+	#if( configCOMMAND_INT_HASH_TABLE_SIZE > 0 )
+	{
+		/* If the string was split into words when the command was looked up
+		by FreeRTOS_CLIProcessCommand() then the position of the parameter may
+		already be known.  Commands run in other sessions are not known here as
+		the session is not passed to this function. */
+		if( ( pcCommandString == xDefaultSession.xTokens.pcCommandString ) && ( uxWantedParameter > 0 ) && ( uxWantedParameter <= xDefaultSession.xTokens.uxCachedParameters ) )
+		{
+			pcReturn = xDefaultSession.xTokens.pcParameters[ uxWantedParameter - 1 ];
+			*pxParameterStringLength = xDefaultSession.xTokens.xParameterLengths[ uxWantedParameter - 1 ];
+
+			/* Skip the scan below. */
+			uxParametersFound = uxWantedParameter;
+		}
+	}
+	#endif
+
 	while( uxParametersFound < uxWantedParameter )
 	{
 		/* Index the character pointer past the current word.  If this is the start
@@ -310,30 +528,33 @@ static CLI_Definition_List_Item_t *pxLastCommandInList = &xRegisteredCommands;
 
 		/* Set the end of list marker to the new list item. */
 		pxLastCommandInList = pxCliDefinitionListItemBuffer;
+
+		#if( configCOMMAND_INT_HASH_TABLE_SIZE > 0 )
+		{
+			prvAddToHashTable( pxCliDefinitionListItemBuffer );
+		}
+		#endif
 	}
 	taskEXIT_CRITICAL();
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static BaseType_t prvHelpCommand( CLI_Session_t *pxSession, char *pcWriteBuffer, size_t xWriteBufferLen )
 {
-static const CLI_Definition_List_Item_t * pxCommand = NULL;
 BaseType_t xReturn;
 
-	( void ) pcCommandString;
-
-	if( pxCommand == NULL )
+	if( pxSession->pxNextHelpItem == NULL )
 	{
-		/* Reset the pxCommand pointer back to the start of the list. */
-		pxCommand = &xRegisteredCommands;
+		/* Reset the pointer back to the start of the list. */
+		pxSession->pxNextHelpItem = &xRegisteredCommands;
 	}
 
 	/* Return the next command help string, before moving the pointer on to
 	the next command in the list. */
-	strncpy( pcWriteBuffer, pxCommand->pxCommandLineDefinition->pcHelpString, xWriteBufferLen );
-	pxCommand = pxCommand->pxNext;
+	strncpy( pcWriteBuffer, pxSession->pxNextHelpItem->pxCommandLineDefinition->pcHelpString, xWriteBufferLen );
+	pxSession->pxNextHelpItem = pxSession->pxNextHelpItem->pxNext;
 
-	if( pxCommand == NULL )
+	if( pxSession->pxNextHelpItem == NULL )
 	{
 		/* There are no more commands in the list, so there will be no more
 		strings to return after this one and pdFALSE should be returned. */
@@ -348,6 +569,8 @@ BaseType_t xReturn;
 }
 /*-----------------------------------------------------------*/
 
+#if( configCOMMAND_INT_HASH_TABLE_SIZE == 0 )
+
 static int8_t prvGetNumberOfParameters( const char *pcCommandString )
 {
 int8_t cParameters = 0;
@@ -384,3 +607,483 @@ BaseType_t xLastCharacterWasSpace = pdFALSE;
 	return cParameters;
 }
 /*-----------------------------------------------------------*/
+
+#endif /* configCOMMAND_INT_HASH_TABLE_SIZE == 0 */
+
+#if( configCOMMAND_INT_HASH_TABLE_SIZE > 0 )
+
+	static void prvAddToHashTable( CLI_Definition_List_Item_t *pxListItem )
+	{
+	const char *pcCommand = pxListItem->pxCommandLineDefinition->pcCommand;
+	uint32_t ulHash = cliHASH_OFFSET_BASIS;
+	CLI_Definition_List_Item_t **ppxLink;
+
+		/* The help command is always the first command, so must be in the
+		table before any other. */
+		if( xHelpCommandHashed == pdFALSE )
+		{
+			xHelpCommandHashed = pdTRUE;
+			prvAddToHashTable( &xRegisteredCommands );
+		}
+
+		pxListItem->xCommandLength = strlen( pcCommand );
+		pxListItem->pxNextInBucket = NULL;
+
+		/* Commands are looked up by their first word, so commands that
+		contain a space are hashed on the part before the space. */
+		while( ( *pcCommand != 0x00 ) && ( *pcCommand != ' ' ) )
+		{
+			ulHash = ( ulHash ^ ( uint8_t ) *pcCommand ) * cliHASH_PRIME;
+			pcCommand++;
+		}
+
+		/* Add to the end of the bucket to keep registration order. */
+		ppxLink = &( pxCommandHashTable[ ulHash % configCOMMAND_INT_HASH_TABLE_SIZE ] );
+
+		while( *ppxLink != NULL )
+		{
+			ppxLink = &( ( *ppxLink )->pxNextInBucket );
+		}
+
+		*ppxLink = pxListItem;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTokeniseCommand( CLI_Command_Tokens_t *pxTokens, const char *pcCommandString )
+	{
+	uint32_t ulHash = cliHASH_OFFSET_BASIS;
+	int8_t cParameters = 0;
+	UBaseType_t uxWords = 0;
+	BaseType_t xLastCharacterWasSpace = pdFALSE, xInFirstWord = pdTRUE;
+	const char *pcCharacter;
+
+		/* This produces the same results as hashing the first word, calling
+		prvGetNumberOfParameters() and calling FreeRTOS_CLIGetParameter() for
+		each parameter, but only reads the string once. */
+		for( pcCharacter = pcCommandString; *pcCharacter != 0x00; pcCharacter++ )
+		{
+			if( ( *pcCharacter ) == ' ' )
+			{
+				xInFirstWord = pdFALSE;
+
+				if( xLastCharacterWasSpace != pdTRUE )
+				{
+					cParameters++;
+					xLastCharacterWasSpace = pdTRUE;
+				}
+			}
+			else
+			{
+				if( xInFirstWord != pdFALSE )
+				{
+					ulHash = ( ulHash ^ ( uint8_t ) *pcCharacter ) * cliHASH_PRIME;
+				}
+				else if( xLastCharacterWasSpace != pdFALSE )
+				{
+					/* The first character of a parameter. */
+					uxWords++;
+
+					if( uxWords <= ( UBaseType_t ) configCOMMAND_INT_MAX_CACHED_PARAMETERS )
+					{
+						pxTokens->pcParameters[ uxWords - 1 ] = pcCharacter;
+						pxTokens->xParameterLengths[ uxWords - 1 ] = 0;
+					}
+				}
+
+				if( ( xInFirstWord == pdFALSE ) && ( uxWords <= ( UBaseType_t ) configCOMMAND_INT_MAX_CACHED_PARAMETERS ) )
+				{
+					pxTokens->xParameterLengths[ uxWords - 1 ]++;
+				}
+
+				xLastCharacterWasSpace = pdFALSE;
+			}
+		}
+
+		/* If the command string ended with spaces, then there will have been
+		too many parameters counted. */
+		if( xLastCharacterWasSpace == pdTRUE )
+		{
+			cParameters--;
+		}
+
+		pxTokens->pcCommandString = pcCommandString;
+		pxTokens->ulFirstWordHash = ulHash;
+		pxTokens->cParameters = cParameters;
+		pxTokens->uxCachedParameters = ( uxWords < ( UBaseType_t ) configCOMMAND_INT_MAX_CACHED_PARAMETERS ) ? uxWords : ( UBaseType_t ) configCOMMAND_INT_MAX_CACHED_PARAMETERS;
+	}
+	/*-----------------------------------------------------------*/
+
+	static const CLI_Definition_List_Item_t *prvFindHashedCommand( CLI_Command_Tokens_t *pxTokens, const char *pcCommandInput )
+	{
+	const CLI_Definition_List_Item_t *pxCommand;
+	size_t xCommandStringLength;
+
+		if( xHelpCommandHashed == pdFALSE )
+		{
+			/* No commands have been registered, only help is available. */
+			taskENTER_CRITICAL();
+			{
+				if( xHelpCommandHashed == pdFALSE )
+				{
+					xHelpCommandHashed = pdTRUE;
+					prvAddToHashTable( &xRegisteredCommands );
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+
+		prvTokeniseCommand( pxTokens, pcCommandInput );
+
+		for( pxCommand = pxCommandHashTable[ pxTokens->ulFirstWordHash % configCOMMAND_INT_HASH_TABLE_SIZE ]; pxCommand != NULL; pxCommand = pxCommand->pxNextInBucket )
+		{
+			xCommandStringLength = pxCommand->xCommandLength;
+
+			/* As with the linear search, check the byte after the expected end
+			of the string so as not to pick up a sub-string of a longer
+			command. */
+			if( strncmp( pcCommandInput, pxCommand->pxCommandLineDefinition->pcCommand, xCommandStringLength ) == 0 )
+			{
+				if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
+				{
+					break;
+				}
+			}
+		}
+
+		return pxCommand;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configCOMMAND_INT_HASH_TABLE_SIZE */
+
+#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+
+	void FreeRTOS_CLISessionSetOutput( CLI_Session_t *pxSession, pdCOMMAND_LINE_OUTPUT pxSink, void *pvContext )
+	{
+		configASSERT( pxSession != NULL );
+
+		pxSession->xOutput.pxSink = pxSink;
+		pxSession->xOutput.pvSinkContext = pvContext;
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t FreeRTOS_CLIWrite( CLI_Output_t *pxOutput, const char *pcData, size_t xDataLength )
+	{
+	size_t xSpace;
+
+		configASSERT( pxOutput != NULL );
+
+		while( ( xDataLength > 0 ) && ( pxOutput->xSinkFailed == pdFALSE ) )
+		{
+			xSpace = pxOutput->xBufferLength - pxOutput->xBytesUsed;
+
+			if( xSpace == 0 )
+			{
+				prvFlushOutput( pxOutput );
+			}
+			else
+			{
+				if( xSpace > xDataLength )
+				{
+					xSpace = xDataLength;
+				}
+
+				memcpy( &( pxOutput->pcBuffer[ pxOutput->xBytesUsed ] ), pcData, xSpace );
+				pxOutput->xBytesUsed += xSpace;
+				pcData += xSpace;
+				xDataLength -= xSpace;
+			}
+		}
+
+		return ( pxOutput->xSinkFailed == pdFALSE ) ? pdPASS : pdFAIL;
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t FreeRTOS_CLIPrintf( CLI_Output_t *pxOutput, const char *pcFormat, ... )
+	{
+	va_list xArgs;
+	int iLength;
+	size_t xSpace;
+	BaseType_t xAttempt;
+
+		configASSERT( pxOutput != NULL );
+		configASSERT( pxOutput->xBufferLength > 1 );
+
+		/* Format into the free end of the buffer.  If that is too small, pass
+		what is already in the buffer to the sink and try again with the whole
+		buffer. */
+		for( xAttempt = 0; ( xAttempt < 2 ) && ( pxOutput->xSinkFailed == pdFALSE ); xAttempt++ )
+		{
+			xSpace = pxOutput->xBufferLength - pxOutput->xBytesUsed;
+
+			va_start( xArgs, pcFormat );
+			iLength = vsnprintf( &( pxOutput->pcBuffer[ pxOutput->xBytesUsed ] ), xSpace, pcFormat, xArgs );
+			va_end( xArgs );
+
+			if( iLength < 0 )
+			{
+				/* Formatting error, output nothing. */
+				break;
+			}
+			else if( ( size_t ) iLength < xSpace )
+			{
+				pxOutput->xBytesUsed += ( size_t ) iLength;
+				break;
+			}
+			else if( pxOutput->xBytesUsed == 0 )
+			{
+				/* Longer than the whole buffer, so output the part that fitted,
+				excluding the terminating null. */
+				pxOutput->xBytesUsed = pxOutput->xBufferLength - 1;
+				break;
+			}
+			else
+			{
+				prvFlushOutput( pxOutput );
+			}
+		}
+
+		return ( pxOutput->xSinkFailed == pdFALSE ) ? pdPASS : pdFAIL;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvStreamCommand( CLI_Session_t *pxSession, const CLI_Definition_List_Item_t *pxCommand, const char *pcCommandInput, char *pcWriteBuffer, size_t xWriteBufferLen )
+	{
+	CLI_Output_t *pxOutput = &( pxSession->xOutput );
+
+		configASSERT( xWriteBufferLen > 1 );
+
+		/* The output is collected in the same buffer a non-streaming command
+		would write to, so no extra RAM is needed. */
+		pxOutput->pcBuffer = pcWriteBuffer;
+		pxOutput->xBufferLength = xWriteBufferLen;
+		pxOutput->xBytesUsed = 0;
+		pxOutput->xSinkFailed = pdFALSE;
+
+		( void ) pxCommand->pxCommandLineDefinition->pxStreamInterpreter( pxOutput, pcCommandInput );
+		prvFlushOutput( pxOutput );
+
+		pcWriteBuffer[ 0 ] = 0x00;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvFlushOutput( CLI_Output_t *pxOutput )
+	{
+		if( ( pxOutput->xBytesUsed > 0 ) && ( pxOutput->xSinkFailed == pdFALSE ) )
+		{
+			if( pxOutput->pxSink( pxOutput->pvSinkContext, pxOutput->pcBuffer, pxOutput->xBytesUsed ) != pdPASS )
+			{
+				pxOutput->xSinkFailed = pdTRUE;
+			}
+		}
+
+		pxOutput->xBytesUsed = 0;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configCOMMAND_INT_STREAMING_OUTPUT */
+
+#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+
+	#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+		BaseType_t FreeRTOS_CLIRegisterBinaryCommand( const CLI_Binary_Command_Definition_t * const pxCommandToRegister )
+		{
+		BaseType_t xReturn = pdFAIL;
+		CLI_Binary_Definition_List_Item_t *pxNewListItem;
+
+			/* Check the parameter is not NULL. */
+			configASSERT( pxCommandToRegister != NULL );
+
+			/* Create a new list item that will reference the command being registered. */
+			pxNewListItem = ( CLI_Binary_Definition_List_Item_t * ) pvPortMalloc( sizeof( CLI_Binary_Definition_List_Item_t ) );
+			configASSERT( pxNewListItem != NULL );
+
+			if( pxNewListItem != NULL )
+			{
+				prvRegisterBinaryCommand( pxCommandToRegister, pxNewListItem );
+				xReturn = pdPASS;
+			}
+
+			return xReturn;
+		}
+
+	#endif /* #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
+	/*-----------------------------------------------------------*/
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+		BaseType_t FreeRTOS_CLIRegisterBinaryCommandStatic( const CLI_Binary_Command_Definition_t * const pxCommandToRegister,
+															CLI_Binary_Definition_List_Item_t * pxBinaryListItemBuffer )
+		{
+			/* Check the parameters are not NULL. */
+			configASSERT( pxCommandToRegister != NULL );
+			configASSERT( pxBinaryListItemBuffer != NULL );
+
+			prvRegisterBinaryCommand( pxCommandToRegister, pxBinaryListItemBuffer );
+
+			return pdPASS;
+		}
+
+	#endif /* #if ( configSUPPORT_STATIC_ALLOCATION == 1 ) */
+	/*-----------------------------------------------------------*/
+
+	size_t FreeRTOS_CLIProcessFrame( const uint8_t *pucFrame, size_t xFrameLength, uint8_t *pucResponse, size_t xResponseLength )
+	{
+	const CLI_Binary_Definition_List_Item_t *pxCommand;
+	uint16_t usCommandID = cliFRAME_LIST_COMMANDS_ID;
+	uint8_t ucStatus = cliFRAME_STATUS_BAD_FRAME;
+	size_t xRequestLength, xMaxPayload, xUsed = 0;
+
+		configASSERT( pucFrame != NULL );
+		configASSERT( pucResponse != NULL );
+
+		if( xResponseLength < cliFRAME_RESPONSE_HEADER_SIZE )
+		{
+			return 0;
+		}
+
+		/* The length field is 16 bits, which limits the size of a response
+		however large pucResponse is. */
+		xMaxPayload = xResponseLength - cliFRAME_RESPONSE_HEADER_SIZE;
+		if( xMaxPayload > ( ( size_t ) 0xFFFFU - cliFRAME_RESPONSE_ID_SIZE ) )
+		{
+			xMaxPayload = ( size_t ) 0xFFFFU - cliFRAME_RESPONSE_ID_SIZE;
+		}
+
+		if( ( xFrameLength >= cliFRAME_REQUEST_HEADER_SIZE ) && ( pucFrame[ 0 ] == cliFRAME_START ) )
+		{
+			xRequestLength = ( size_t ) prvReadFrameUint16( &( pucFrame[ 1 ] ) );
+			usCommandID = prvReadFrameUint16( &( pucFrame[ 3 ] ) );
+
+			/* The length must at least cover the command ID, and the payload it
+			describes must have been received in full.  Bytes after the end of
+			the frame are ignored. */
+			if( ( xRequestLength >= cliFRAME_REQUEST_ID_SIZE ) &&
+				( ( xRequestLength - cliFRAME_REQUEST_ID_SIZE ) <= ( xFrameLength - cliFRAME_REQUEST_HEADER_SIZE ) ) )
+			{
+				xRequestLength -= cliFRAME_REQUEST_ID_SIZE;
+
+				if( usCommandID == cliFRAME_LIST_COMMANDS_ID )
+				{
+					xUsed = prvListBinaryCommands( &( pucResponse[ cliFRAME_RESPONSE_HEADER_SIZE ] ), xMaxPayload );
+					ucStatus = cliFRAME_STATUS_OK;
+				}
+				else
+				{
+					ucStatus = cliFRAME_STATUS_UNKNOWN_COMMAND;
+
+					for( pxCommand = pxRegisteredBinaryCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
+					{
+						if( pxCommand->pxBinaryDefinition->usCommandID == usCommandID )
+						{
+							/* A command that fails may still have written a
+							payload describing why, so it is returned either
+							way. */
+							if( pxCommand->pxBinaryDefinition->pxBinaryInterpreter( &( pucFrame[ cliFRAME_REQUEST_HEADER_SIZE ] ), xRequestLength,
+																					&( pucResponse[ cliFRAME_RESPONSE_HEADER_SIZE ] ), xMaxPayload, &xUsed ) == pdPASS )
+							{
+								ucStatus = cliFRAME_STATUS_OK;
+							}
+							else
+							{
+								ucStatus = cliFRAME_STATUS_COMMAND_FAILED;
+							}
+
+							configASSERT( xUsed <= xMaxPayload );
+							if( xUsed > xMaxPayload )
+							{
+								xUsed = xMaxPayload;
+							}
+
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		pucResponse[ 0 ] = cliFRAME_START;
+		prvWriteFrameUint16( &( pucResponse[ 1 ] ), ( uint16_t ) ( xUsed + cliFRAME_RESPONSE_ID_SIZE ) );
+		prvWriteFrameUint16( &( pucResponse[ 3 ] ), usCommandID );
+		pucResponse[ 5 ] = ucStatus;
+
+		return xUsed + cliFRAME_RESPONSE_HEADER_SIZE;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvRegisterBinaryCommand( const CLI_Binary_Command_Definition_t * const pxCommandToRegister,
+										  CLI_Binary_Definition_List_Item_t * pxListItem )
+	{
+	static CLI_Binary_Definition_List_Item_t *pxLastBinaryCommandInList = NULL;
+
+		/* Check the parameters are valid.  ID 0 is reserved for listing the
+		commands. */
+		configASSERT( pxCommandToRegister != NULL );
+		configASSERT( pxCommandToRegister->pxBinaryInterpreter != NULL );
+		configASSERT( pxCommandToRegister->usCommandID != cliFRAME_LIST_COMMANDS_ID );
+		configASSERT( pxListItem != NULL );
+
+		taskENTER_CRITICAL();
+		{
+			pxListItem->pxBinaryDefinition = pxCommandToRegister;
+			pxListItem->pxNext = NULL;
+
+			if( pxLastBinaryCommandInList == NULL )
+			{
+				pxRegisteredBinaryCommands = pxListItem;
+			}
+			else
+			{
+				pxLastBinaryCommandInList->pxNext = pxListItem;
+			}
+
+			pxLastBinaryCommandInList = pxListItem;
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	static size_t prvListBinaryCommands( uint8_t *pucResponse, size_t xResponseLength )
+	{
+	const CLI_Binary_Definition_List_Item_t *pxCommand;
+	size_t xNameLength, xUsed = 0;
+
+		for( pxCommand = pxRegisteredBinaryCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
+		{
+			xNameLength = strlen( pxCommand->pxBinaryDefinition->pcCommand );
+			if( xNameLength > 0xFFU )
+			{
+				xNameLength = 0xFFU;
+			}
+
+			if( ( xResponseLength - xUsed ) < ( xNameLength + 3U ) )
+			{
+				/* Only whole entries are returned. */
+				break;
+			}
+
+			prvWriteFrameUint16( &( pucResponse[ xUsed ] ), pxCommand->pxBinaryDefinition->usCommandID );
+			pucResponse[ xUsed + 2U ] = ( uint8_t ) xNameLength;
+			memcpy( &( pucResponse[ xUsed + 3U ] ), pxCommand->pxBinaryDefinition->pcCommand, xNameLength );
+			xUsed += xNameLength + 3U;
+		}
+
+		return xUsed;
+	}
+	/*-----------------------------------------------------------*/
+
+	static uint16_t prvReadFrameUint16( const uint8_t *pucBuffer )
+	{
+		return ( uint16_t ) ( ( ( uint16_t ) pucBuffer[ 1 ] << 8 ) | ( uint16_t ) pucBuffer[ 0 ] );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvWriteFrameUint16( uint8_t *pucBuffer, uint16_t usValue )
+	{
+		pucBuffer[ 0 ] = ( uint8_t ) ( usValue & 0xFFU );
+		pucBuffer[ 1 ] = ( uint8_t ) ( usValue >> 8 );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configCOMMAND_INT_BINARY_FRAMES */
@@ -33,6 +33,41 @@
 #endif
 /* *INDENT-ON* */
 
+/* Set configCOMMAND_INT_HASH_TABLE_SIZE to a non-zero number of buckets in
+FreeRTOSConfig.h to have FreeRTOS_CLIProcessCommand() find commands through a
+hash table built as commands are registered, rather than by comparing the input
+against every registered command in turn.  The input string is then also split
+into words in a single pass, and the positions of up to
+configCOMMAND_INT_MAX_CACHED_PARAMETERS parameters are remembered so
+FreeRTOS_CLIGetParameter() does not rescan the string.  Each list item is a
+little larger when this is used. */
+#ifndef configCOMMAND_INT_HASH_TABLE_SIZE
+	#define configCOMMAND_INT_HASH_TABLE_SIZE 0
+#endif
+
+#ifndef configCOMMAND_INT_MAX_CACHED_PARAMETERS
+	#define configCOMMAND_INT_MAX_CACHED_PARAMETERS 8
+#endif
+
+/* Set configCOMMAND_INT_STREAMING_OUTPUT to 1 in FreeRTOSConfig.h to allow
+commands to write their output through FreeRTOS_CLIWrite() and
+FreeRTOS_CLIPrintf() in a single call, rather than returning it one buffer at a
+time.  The output is passed to the sink set with FreeRTOS_CLISessionSetOutput()
+each time the session's output buffer fills. */
+#ifndef configCOMMAND_INT_STREAMING_OUTPUT
+	#define configCOMMAND_INT_STREAMING_OUTPUT 0
+#endif
+
+/* Set configCOMMAND_INT_BINARY_FRAMES to 1 in FreeRTOSConfig.h to allow
+commands to also be run from binary frames, which are intended for use by test
+equipment and other programs rather than by people.  A frame selects a command
+by a numeric ID rather than by name, and the response is binary, so neither end
+has to format or parse text.  See FreeRTOS_CLIProcessFrame() for the layout of
+a frame. */
+#ifndef configCOMMAND_INT_BINARY_FRAMES
+	#define configCOMMAND_INT_BINARY_FRAMES 0
+#endif
+
 /* The prototype to which callback functions used to process command line
 commands must comply.  pcWriteBuffer is a buffer into which the output from
 executing the command can be written, xWriteBufferLen is the length, in bytes of
@@ -40,6 +75,83 @@ the pcWriteBuffer buffer, and pcCommandString is the entire string as input by
 the user (from which parameters can be extracted).*/
 typedef BaseType_t (*pdCOMMAND_LINE_CALLBACK)( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 
+#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+
+	/* The prototype of the function that sends streamed output to the console,
+	for example by writing it to a UART or a socket.  pvContext is the value
+	passed to FreeRTOS_CLISessionSetOutput().  Return pdPASS if the data was
+	sent, or pdFAIL to stop the command from producing any more output. */
+	typedef BaseType_t (*pdCOMMAND_LINE_OUTPUT)( void *pvContext, const char *pcData, size_t xDataLength );
+
+	/* Where a streaming command writes its output.  Only accessed through
+	FreeRTOS_CLIWrite() and FreeRTOS_CLIPrintf(). */
+	typedef struct xCLI_OUTPUT
+	{
+		pdCOMMAND_LINE_OUTPUT pxSink;	/* Sends the contents of pcBuffer to the console. */
+		void *pvSinkContext;			/* Passed to pxSink. */
+		char *pcBuffer;					/* Output is collected here until pxSink is called. */
+		size_t xBufferLength;			/* The size of pcBuffer in bytes. */
+		size_t xBytesUsed;				/* The number of bytes in pcBuffer not yet passed to pxSink. */
+		BaseType_t xSinkFailed;			/* Set if pxSink returned pdFAIL, after which output is discarded. */
+	} CLI_Output_t;
+
+	/* The prototype to which callback functions of streaming commands must
+	comply.  The callback is called once, and writes all its output to pxOutput
+	before returning.  The return value is currently unused. */
+	typedef BaseType_t (*pdCOMMAND_LINE_STREAM_CALLBACK)( CLI_Output_t *pxOutput, const char *pcCommandString );
+
+#endif /* configCOMMAND_INT_STREAMING_OUTPUT */
+
+#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+
+	/* Every frame, in both directions, starts with this byte.  It is a control
+	character so it cannot be the first character of a text command. */
+	#define cliFRAME_START					( ( uint8_t ) 0x02 )
+
+	/* The number of bytes before the payload of a request frame and of a
+	response frame respectively.  A request is the start byte, a two byte length
+	and a two byte command ID.  A response adds a one byte status. */
+	#define cliFRAME_REQUEST_HEADER_SIZE	( 5U )
+	#define cliFRAME_RESPONSE_HEADER_SIZE	( 6U )
+
+	/* Command ID 0 is handled by FreeRTOS_CLIProcessFrame() itself.  Its
+	response lists the registered binary commands, each as a two byte ID, a one
+	byte name length, then the name without a terminating null. */
+	#define cliFRAME_LIST_COMMANDS_ID		( ( uint16_t ) 0U )
+
+	/* Values of the status byte in a response frame. */
+	#define cliFRAME_STATUS_OK				( ( uint8_t ) 0U )	/* The payload holds the command's output. */
+	#define cliFRAME_STATUS_UNKNOWN_COMMAND	( ( uint8_t ) 1U )	/* No command is registered with the requested ID. */
+	#define cliFRAME_STATUS_BAD_FRAME		( ( uint8_t ) 2U )	/* The request was not a complete frame. */
+	#define cliFRAME_STATUS_COMMAND_FAILED	( ( uint8_t ) 3U )	/* The command returned pdFAIL. */
+
+	/* The prototype to which the callback functions of binary commands must
+	comply.  pucRequest and xRequestLength are the payload of the request frame.
+	The callback writes its output to pucResponse, which can hold
+	xResponseLength bytes, sets *pxResponseUsed to the number of bytes written,
+	and returns pdPASS, or pdFAIL if the command could not be executed.
+	Multi-byte values should be written little endian, as the frame header
+	is. */
+	typedef BaseType_t (*pdCOMMAND_LINE_BINARY_CALLBACK)( const uint8_t *pucRequest, size_t xRequestLength, uint8_t *pucResponse, size_t xResponseLength, size_t *pxResponseUsed );
+
+	/* The structure that defines a command that can be run from a binary
+	frame. */
+	typedef struct xCOMMAND_BINARY_INPUT
+	{
+		const uint16_t usCommandID;								/* The ID that selects the command in a request frame.  Must not be cliFRAME_LIST_COMMANDS_ID. */
+		const char * const pcCommand;							/* The name of the command, as listed by command ID 0.  Normally the name of the equivalent text command. */
+		const pdCOMMAND_LINE_BINARY_CALLBACK pxBinaryInterpreter;	/* A pointer to the callback function that will generate the response. */
+	} CLI_Binary_Command_Definition_t;
+
+	/* The structure that defines a binary command list entry. */
+	typedef struct xCOMMAND_BINARY_INPUT_LIST
+	{
+		const CLI_Binary_Command_Definition_t *pxBinaryDefinition;
+		struct xCOMMAND_BINARY_INPUT_LIST *pxNext;
+	} CLI_Binary_Definition_List_Item_t;
+
+#endif /* configCOMMAND_INT_BINARY_FRAMES */
+
 /* The structure that defines command line commands.  A command line command
 should be defined by declaring a const structure of this type. */
 typedef struct xCOMMAND_LINE_INPUT
@@ -48,6 +160,9 @@ typedef struct xCOMMAND_LINE_INPUT
 	const char * const pcHelpString;			/* String that describes how to use the command.  Should start with the command itself, and end with "\r\n".  For example "help: Returns a list of all the commands\r\n". */
 	const pdCOMMAND_LINE_CALLBACK pxCommandInterpreter;	/* A pointer to the callback function that will return the output generated by the command. */
 	int8_t cExpectedNumberOfParameters;			/* Commands expect a fixed number of parameters, which may be zero. */
+	#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+		const pdCOMMAND_LINE_STREAM_CALLBACK pxStreamInterpreter;	/* Optional.  Used instead of pxCommandInterpreter when the session has an output sink.  pxCommandInterpreter can then be NULL. */
+	#endif
 } CLI_Command_Definition_t;
 
 /* The structure that defines a command line list entry. */
@@ -55,8 +170,45 @@ typedef struct xCOMMAND_INPUT_LIST
 {
 	const CLI_Command_Definition_t *pxCommandLineDefinition;
 	struct xCOMMAND_INPUT_LIST *pxNext;
+	#if( configCOMMAND_INT_HASH_TABLE_SIZE > 0 )
+		struct xCOMMAND_INPUT_LIST *pxNextInBucket;	/* The next command whose first word has the same hash. */
+		size_t xCommandLength;						/* strlen() of pcCommand, calculated when the command is registered. */
+	#endif
 } CLI_Definition_List_Item_t;
 
+#if( configCOMMAND_INT_HASH_TABLE_SIZE > 0 )
+
+	/* The result of splitting an input string into space delimited words.  Only
+	used within FreeRTOS_CLI.c. */
+	typedef struct xCOMMAND_TOKENS
+	{
+		const char *pcCommandString;	/* The string that was split, or NULL if nothing is remembered. */
+		uint32_t ulFirstWordHash;		/* Hash of the characters before the first space. */
+		int8_t cParameters;				/* The number of parameters that follow the command name. */
+		UBaseType_t uxCachedParameters;	/* How many entries of the arrays below are valid. */
+		const char *pcParameters[ configCOMMAND_INT_MAX_CACHED_PARAMETERS ];
+		BaseType_t xParameterLengths[ configCOMMAND_INT_MAX_CACHED_PARAMETERS ];
+	} CLI_Command_Tokens_t;
+
+#endif
+
+/* The state of one command console.  Consoles that run commands at the same
+time as each other must each have their own session, initialised by
+FreeRTOS_CLISessionInit().  The members are only used within FreeRTOS_CLI.c. */
+typedef struct xCLI_SESSION
+{
+	const CLI_Definition_List_Item_t *pxCommand;		/* The command that is still returning output, or NULL between commands. */
+	const CLI_Definition_List_Item_t *pxNextHelpItem;	/* The next command to be listed by the help command. */
+	char *pcOutputBuffer;								/* The buffer into which this session's commands write their output. */
+	size_t xOutputBufferLength;							/* The size of pcOutputBuffer in bytes. */
+	#if( configCOMMAND_INT_HASH_TABLE_SIZE > 0 )
+		CLI_Command_Tokens_t xTokens;					/* The words of the command being executed. */
+	#endif
+	#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+		CLI_Output_t xOutput;							/* Streamed output, using pcOutputBuffer. */
+	#endif
+} CLI_Session_t;
+
 /* For backward compatibility. */
 #define xCommandLineInput CLI_Command_Definition_t
 
@@ -88,10 +240,104 @@ typedef struct xCOMMAND_INPUT_LIST
  * FreeRTOS_CLIProcessCommand should be called repeatedly until it returns pdFALSE.
  *
  * pcCmdIntProcessCommand is not reentrant.  It must not be called from more
- * than one task - or at least - by more than one task at a time.
+ * than one task - or at least - by more than one task at a time.  Use
+ * FreeRTOS_CLISessionProcessCommand() to run more than one console at once.
  */
 BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  );
 
+/*
+ * Prepare pxSession for use by one command console.  pcOutputBuffer, which
+ * is xOutputBufferLength bytes long, receives the output of every command
+ * run in the session.
+ */
+void FreeRTOS_CLISessionInit( CLI_Session_t *pxSession, char *pcOutputBuffer, size_t xOutputBufferLength );
+
+/*
+ * As FreeRTOS_CLIProcessCommand(), but the state of the command being
+ * executed is held in pxSession and the output is written to the session's
+ * output buffer.  Different sessions can be used by different tasks at the
+ * same time, but each session must only be used by one task at a time.  The
+ * callbacks of commands that can run in more than one session at once must
+ * themselves be re-entrant.
+ */
+BaseType_t FreeRTOS_CLISessionProcessCommand( CLI_Session_t *pxSession, const char * const pcCommandInput );
+
+/*
+ * Return the output buffer of pxSession.
+ */
+char *FreeRTOS_CLISessionGetOutputBuffer( const CLI_Session_t *pxSession );
+
+#if( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+
+	/*
+	 * Send the output of streaming commands run in pxSession to pxSink.  Until
+	 * this is called, or if pxSink is NULL, commands that only have a
+	 * pxStreamInterpreter cannot be run in the session.
+	 */
+	void FreeRTOS_CLISessionSetOutput( CLI_Session_t *pxSession, pdCOMMAND_LINE_OUTPUT pxSink, void *pvContext );
+
+	/*
+	 * Called by streaming commands to output xDataLength bytes from pcData.
+	 * Returns pdFAIL if the sink has failed, in which case the command should
+	 * stop generating output.
+	 */
+	BaseType_t FreeRTOS_CLIWrite( CLI_Output_t *pxOutput, const char *pcData, size_t xDataLength );
+
+	/*
+	 * As FreeRTOS_CLIWrite(), but formats the output as printf() would.  A
+	 * single call cannot output more than the session's output buffer holds.
+	 */
+	BaseType_t FreeRTOS_CLIPrintf( CLI_Output_t *pxOutput, const char *pcFormat, ... );
+
+#endif /* configCOMMAND_INT_STREAMING_OUTPUT */
+
+#if( configCOMMAND_INT_BINARY_FRAMES == 1 )
+
+	/*
+	 * Register a command that can be run from a binary frame.  Binary commands
+	 * are held in their own list, so a command can be registered as either a
+	 * text command, a binary command, or both.
+	 */
+	#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		BaseType_t FreeRTOS_CLIRegisterBinaryCommand( const CLI_Binary_Command_Definition_t * const pxCommandToRegister );
+	#endif
+
+	/*
+	 * Static version of the above function which allows the application writer
+	 * to supply the memory used for a binary command list entry.
+	 */
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		BaseType_t FreeRTOS_CLIRegisterBinaryCommandStatic( const CLI_Binary_Command_Definition_t * const pxCommandToRegister,
+															CLI_Binary_Definition_List_Item_t * pxBinaryListItemBuffer );
+	#endif
+
+	/*
+	 * Execute the command selected by the request frame in pucFrame, which is
+	 * xFrameLength bytes long, and write a response frame to pucResponse, which
+	 * can hold xResponseLength bytes.  Returns the length of the response frame,
+	 * or 0 if pucResponse cannot hold even a response header.
+	 *
+	 * A request frame is laid out as:
+	 *   [0]    cliFRAME_START
+	 *   [1..2] the number of bytes that follow the length, little endian
+	 *   [3..4] the command ID, little endian
+	 *   [5..]  the payload passed to the command
+	 *
+	 * A response frame is laid out as:
+	 *   [0]    cliFRAME_START
+	 *   [1..2] the number of bytes that follow the length, little endian
+	 *   [3..4] the command ID copied from the request
+	 *   [5]    one of the cliFRAME_STATUS_ values
+	 *   [6..]  the payload written by the command
+	 *
+	 * Unlike FreeRTOS_CLIProcessCommand() no state is kept between calls, so
+	 * this can be called by more than one task at a time, provided the
+	 * callbacks of the commands being executed are themselves re-entrant.
+	 */
+	size_t FreeRTOS_CLIProcessFrame( const uint8_t *pucFrame, size_t xFrameLength, uint8_t *pucResponse, size_t xResponseLength );
+
+#endif /* configCOMMAND_INT_BINARY_FRAMES */
+
 /*-----------------------------------------------------------*/
 
 /*
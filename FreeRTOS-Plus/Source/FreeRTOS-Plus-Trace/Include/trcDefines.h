@@ -34,9 +34,10 @@
 
 /* Command codes for TzCtrl task */
 #define CMD_SET_ACTIVE      1 /* Start (param1 = 1) or Stop (param1 = 0) */
+#define CMD_SET_EVENT_FILTER 2 /* Enable (param1 = 1) or Disable (param1 = 0) event code param2 (LSB) and param3 (MSB), or all event codes if param4 = 1 */
 
 /* The final command code, used to validate commands. */
-#define CMD_LAST_COMMAND 1
+#define CMD_LAST_COMMAND 2
 
 #define TRC_RECORDER_MODE_SNAPSHOT		0
 #define TRC_RECORDER_MODE_STREAMING		1
@@ -105,6 +106,10 @@
 #define TRC_RECORDER_COMPONENT_TASK						0x00100000
 #define TRC_RECORDER_COMPONENT_TIMESTAMP				0x00200000
 #define TRC_RECORDER_COMPONENT_COUNTER					0x00400000
+#define TRC_RECORDER_COMPONENT_PROFILER					0x00800000
+#define TRC_RECORDER_COMPONENT_TASK_STATS				0x01000000
+#define TRC_RECORDER_COMPONENT_HEAP_PROFILER			0x02000000
+#define TRC_RECORDER_COMPONENT_DURATION_STATS			0x04000000
 
 /* Filter Groups */
 #define FilterGroup0 (uint16_t)0x0001
@@ -25,8 +25,13 @@
 extern "C" {
 #endif
 
-#define TRC_DIAGNOSTICS_COUNT 5
+#define TRC_DIAGNOSTICS_COUNT 16
 
+/* The metrics from TRC_DIAGNOSTICS_EVENTS_WRITTEN to
+ * TRC_DIAGNOSTICS_BYTES_PER_SECOND are only updated if
+ * TRC_CFG_ENABLE_RECORDER_METRICS is 1. The events and bytes written and the
+ * critical section times, in timer counts (TRC_HWTC_COUNT), are since the last
+ * metrics report. The rates are those of the last metrics report. */
 typedef enum TraceDiagnosticsType
 {
 	TRC_DIAGNOSTICS_ENTRY_SYMBOL_LONGEST_LENGTH = 0x00,
@@ -34,6 +39,17 @@ typedef enum TraceDiagnosticsType
 	TRC_DIAGNOSTICS_BLOB_MAX_BYTES_TRUNCATED = 0x02,
 	TRC_DIAGNOSTICS_STACK_MONITOR_NO_SLOTS = 0x03,
 	TRC_DIAGNOSTICS_ASSERTS_TRIGGERED = 0x04,
+	TRC_DIAGNOSTICS_EVENTS_WRITTEN = 0x05,
+	TRC_DIAGNOSTICS_BYTES_WRITTEN = 0x06,
+	TRC_DIAGNOSTICS_EVENTS_DROPPED = 0x07,
+	TRC_DIAGNOSTICS_BUFFER_HIGH_WATER_MARK = 0x08,
+	TRC_DIAGNOSTICS_CRITICAL_SECTION_LONGEST = 0x09,
+	TRC_DIAGNOSTICS_CRITICAL_SECTION_TOTAL = 0x0A,
+	TRC_DIAGNOSTICS_EVENTS_PER_SECOND = 0x0B,
+	TRC_DIAGNOSTICS_BYTES_PER_SECOND = 0x0C,
+	TRC_DIAGNOSTICS_ENTRY_SLOTS_MISSED = 0x0D,			/* Objects not traced since the entry table was full, never cleared */
+	TRC_DIAGNOSTICS_ENTRY_SLOTS_RECYCLED = 0x0E,		/* Entries taken from other objects, see TRC_CFG_ENTRY_RECYCLE */
+	TRC_DIAGNOSTICS_ENTRY_SLOTS_HIGH_WATER_MARK = 0x0F,	/* The most entries in use at once */
 } TraceDiagnosticsType_t;
 
 typedef struct TraceDiagnosticsBuffer
@@ -134,6 +150,37 @@ traceResult xTraceDiagnosticsSetIfLower(TraceDiagnosticsType_t xType, TraceBaseT
  */
 traceResult xTraceDiagnosticsCheckStatus(void);
 
+#if (TRC_CFG_ENABLE_RECORDER_METRICS == 1)
+
+/**
+ * @internal Update the metrics for an event that has been committed. Must be
+ * called from within the critical section of the event.
+ *
+ * @param[in] uiSize Event size
+ * @param[in] iBytesCommitted Bytes committed by the stream port
+ * @param[in] uiStart Timer count when the critical section was entered
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceDiagnosticsEventCommitted(uint32_t uiSize, int32_t iBytesCommitted, uint32_t uiStart);
+
+/**
+ * @brief Report the recorder metrics as a User Event, if
+ * TRC_CFG_RECORDER_METRICS_REPORT_PERIOD ticks have passed since the last
+ * report. Called periodically by the TzCtrl task.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceDiagnosticsReportMetrics(void);
+
+#else
+
+#define xTraceDiagnosticsReportMetrics() (TRC_SUCCESS)
+
+#endif /* (TRC_CFG_ENABLE_RECORDER_METRICS == 1) */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,209 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+/**
+ * @file
+ *
+ * @brief Public trace duration statistics APIs.
+ */
+
+#ifndef TRC_DURATION_STATS_H
+#define TRC_DURATION_STATS_H
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <stdint.h>
+#include <trcTypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup trace_duration_stats_apis Trace Duration Statistics APIs
+ * @ingroup trace_recorder_apis
+ * @{
+ */
+
+#if (TRC_CFG_ENABLE_DURATION_STATS == 1)
+
+/**
+ * @brief The duration statistics of one interval or state machine state.
+ *
+ * All times are in timer counts (TRC_HWTC_COUNT), at the timestamp frequency,
+ * TRC_HWTC_FREQ_HZ unless set by xTraceTimestampSetFrequency(...). The mean
+ * is uiTotal / uiCount.
+ *
+ * Bin 0 of the histogram counts the durations below 2 timer counts, bin n
+ * those from 2^n up to 2^(n+1), and the last bin everything longer.
+ */
+typedef struct TraceDurationStats
+{
+	void* pvHandle;									/**< The interval or state machine state */
+	uint64_t uiTotal;								/**< Sum of all durations */
+	uint32_t uiCount;								/**< Number of durations */
+	uint32_t uiMin;									/**< Shortest duration */
+	uint32_t uiMax;									/**< Longest duration */
+	uint32_t uiBins[TRC_CFG_DURATION_STATS_HISTOGRAM_BINS]; /**< Duration histogram */
+} TraceDurationStats_t;
+
+/**
+ * @internal Trace Duration Statistics Entry Structure
+ */
+typedef struct TraceDurationStatsEntry
+{
+	TraceDurationStats_t xStats;
+	uint64_t uiStartTime;
+	uint32_t uiStarted;
+} TraceDurationStatsEntry_t;
+
+/**
+ * @internal Trace Duration Statistics Structure
+ */
+typedef struct TraceDurationStatsData
+{
+	TraceDurationStatsEntry_t xEntries[TRC_CFG_DURATION_STATS_MAX_SLOTS];
+	uint32_t uiEntryCount;
+} TraceDurationStatsData_t;
+
+/**
+ * @internal Trace Duration Statistics Buffer Structure
+ */
+typedef struct TraceDurationStatsBuffer
+{
+	uint64_t buffer[(sizeof(TraceDurationStatsData_t) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+} TraceDurationStatsBuffer_t;
+
+/**
+ * @internal Initialize trace duration statistics system.
+ *
+ * @param[in] pxBuffer Pointer to memory that will be used by the trace
+ * duration statistics system.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceDurationStatsInitialize(TraceDurationStatsBuffer_t* pxBuffer);
+
+/**
+ * @internal Marks the start of a duration. Called when an interval is started
+ * or a state machine enters a state, whether or not the recorder is enabled.
+ *
+ * @param[in] pvHandle The interval or state machine state.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceDurationStatsStart(void* pvHandle);
+
+/**
+ * @internal Marks the end of a duration and adds it to the statistics. Called
+ * when an interval is stopped or a state machine leaves a state.
+ *
+ * @param[in] pvHandle The interval or state machine state.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceDurationStatsStop(void* pvHandle);
+
+/**
+ * @brief Gets a copy of the statistics of an interval or state machine state.
+ *
+ * @param[in] pvHandle The interval or state machine state handle.
+ * @param[out] pxStats The statistics.
+ *
+ * @retval TRC_FAIL Not started yet, or no room for its statistics
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceDurationStatsGet(void* pvHandle, TraceDurationStats_t* pxStats);
+
+/**
+ * @brief Gets the number of intervals and states with statistics.
+ *
+ * @param[out] puiCount Number of intervals and states.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceDurationStatsGetCount(uint32_t* puiCount);
+
+/**
+ * @brief Gets a copy of the statistics at an index.
+ *
+ * @param[in] uiIndex Index, below the count from xTraceDurationStatsGetCount(...).
+ * @param[out] pxStats The statistics.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceDurationStatsGetAtIndex(uint32_t uiIndex, TraceDurationStats_t* pxStats);
+
+/**
+ * @brief Gets a percentile of the durations from the histogram.
+ *
+ * This is the upper end of the bin holding the percentile, capped at the
+ * longest duration, so it is at most twice the exact value.
+ *
+ * @param[in] pxStats The statistics.
+ * @param[in] uiPercent Percentile, 1 to 100.
+ * @param[out] puiDuration Duration in timer counts, 0 if there are none.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceDurationStatsGetPercentile(const TraceDurationStats_t* pxStats, uint32_t uiPercent, uint32_t* puiDuration);
+
+/**
+ * @brief Clears all statistics, to measure from now on.
+ *
+ * Durations that are in progress are still measured from their start.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceDurationStatsClear(void);
+
+#else /* (TRC_CFG_ENABLE_DURATION_STATS == 1) */
+
+typedef struct TraceDurationStatsBuffer
+{
+	uint32_t buffer[1];
+} TraceDurationStatsBuffer_t;
+
+#define xTraceDurationStatsInitialize(pxBuffer) ((void)pxBuffer, TRC_SUCCESS)
+
+#define xTraceDurationStatsStart(pvHandle) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2((void)(pvHandle), TRC_SUCCESS)
+
+#define xTraceDurationStatsStop(pvHandle) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2((void)(pvHandle), TRC_SUCCESS)
+
+#define xTraceDurationStatsGet(pvHandle, pxStats) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)(pvHandle), (void)(pxStats), TRC_FAIL)
+
+#define xTraceDurationStatsGetCount(puiCount) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(puiCount) = 0, TRC_SUCCESS)
+
+#define xTraceDurationStatsGetAtIndex(uiIndex, pxStats) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)(uiIndex), (void)(pxStats), TRC_FAIL)
+
+#define xTraceDurationStatsGetPercentile(pxStats, uiPercent, puiDuration) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_4((void)(pxStats), (void)(uiPercent), *(puiDuration) = 0, TRC_FAIL)
+
+#define xTraceDurationStatsClear() TRC_COMMA_EXPR_TO_STATEMENT_EXPR_1(TRC_SUCCESS)
+
+#endif /* (TRC_CFG_ENABLE_DURATION_STATS == 1) */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
+
+#endif /* TRC_DURATION_STATS_H */
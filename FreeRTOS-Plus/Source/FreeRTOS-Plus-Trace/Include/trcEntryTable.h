@@ -31,7 +31,6 @@ extern "C" {
  * @{
  */
 
-#define TRC_ENTRY_CREATE_WITH_ADDRESS(_pvAddress, _pxEntryHandle) (xTraceEntryCreate(_pxEntryHandle) == TRC_SUCCESS ? (((TraceEntry_t*)*(_pxEntryHandle))->pvAddress = (_pvAddress), TRC_SUCCESS) : TRC_FAIL)
 #define TRC_ENTRY_SET_STATE(xEntryHandle, uiStateIndex, uxState) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(((TraceEntry_t*)(xEntryHandle))->xStates[uiStateIndex] = (uxState), TRC_SUCCESS)
 #define TRC_ENTRY_SET_OPTIONS(xEntryHandle, uiMask) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(((TraceEntry_t*)(xEntryHandle))->uiOptions |= (uiMask), TRC_SUCCESS)
 #define TRC_ENTRY_CLEAR_OPTIONS(xEntryHandle, uiMask) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(((TraceEntry_t*)(xEntryHandle))->uiOptions &= ~(uiMask), TRC_SUCCESS)
@@ -85,6 +84,19 @@ traceResult xTraceEntryTableInitialize(TraceEntryTableBuffer_t* pxBuffer);
  */
 traceResult xTraceEntryCreate(TraceEntryHandle_t *pxEntryHandle);
 
+/**
+ * @brief Creates trace entry mapped to memory address.
+ * 
+ * The address is also added to the address hash used by xTraceEntryFind(...).
+ * 
+ * @param[in] pvAddress Address.
+ * @param[out] pxEntryHandle Pointer to uninitialized trace entry handle.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceEntryCreateWithAddress(void* pvAddress, TraceEntryHandle_t* pxEntryHandle);
+
 /**
  * @brief Deletes trace entry.
  * 
@@ -140,17 +152,6 @@ traceResult xTraceEntrySetSymbol(TraceEntryHandle_t xEntryHandle, const char* sz
 
 #if ((TRC_CFG_USE_TRACE_ASSERT) == 1)
 
-/**
- * @brief Creates trace entry mapped to memory address.
- * 
- * @param[in] pvAddress Address.
- * @param[out] pxEntryHandle Pointer to uninitialized trace entry handle.
- * 
- * @retval TRC_FAIL Failure
- * @retval TRC_SUCCESS Success
- */
-traceResult xTraceEntryCreateWithAddress(void* pvAddress, TraceEntryHandle_t* pxEntryHandle);
-
 /**
  * @brief Sets trace entry state.
  * 
@@ -232,8 +233,6 @@ traceResult xTraceEntryGetOptions(TraceEntryHandle_t xEntryHandle, uint32_t *pui
 
 #else
 
-#define xTraceEntryCreateWithAddress TRC_ENTRY_CREATE_WITH_ADDRESS
-
 #define xTraceEntrySetState TRC_ENTRY_SET_STATE
 #define xTraceEntrySetOptions TRC_ENTRY_SET_OPTIONS
 #define xTraceEntryClearOptions TRC_ENTRY_CLEAR_OPTIONS
@@ -192,6 +192,12 @@ typedef struct TraceEventData
 	void* pvBlob;		/**< */
 	uint32_t size;		/**< */
 	uint32_t offset;	/**< */
+#if (TRC_CFG_ENABLE_RECORDER_METRICS == 1)
+	uint32_t start;		/**< Timer count when the critical section was entered */
+#endif
+#if (TRC_CFG_STREAMING_COMPACT == 1)
+	TraceUnsignedBaseType_t uxEvent[TRC_MAX_BLOB_SIZE / sizeof(TraceUnsignedBaseType_t)];	/**< The event, encoded when it ends */
+#endif
 } TraceEventData_t;
 
 /** 
@@ -201,6 +207,12 @@ typedef struct TraceCoreEventData
 {
 	TraceEventData_t eventData[(TRC_CFG_MAX_ISR_NESTING)+1];	/**< */
 	uint32_t eventCounter;										/**< */
+#if (TRC_CFG_STREAMING_COMPACT == 1)
+	uint32_t compactSession;									/**< Session of the last compact event sent */
+	uint32_t compactTS;											/**< Timestamp of the last compact event sent */
+	uint16_t compactCount;										/**< Event count of the last compact event sent */
+	uint16_t compactHigh;										/**< Upper half of the last parameter sent in full */
+#endif
 } TraceCoreEventData_t;
 
 /** 
@@ -300,7 +312,7 @@ traceResult xTraceEventBeginRawOfflineBlocking(uint32_t uiSize, TraceEventHandle
  * @retval TRC_SUCCESS Success
  */
 #define xTraceEventBegin(uiEventCode, uiTotalPayloadSize, pxEventHandle) \
-	(xTraceIsRecorderEnabled() ? xTraceEventBeginOffline(uiEventCode, uiTotalPayloadSize, pxEventHandle) : TRC_FAIL)
+	((xTraceIsRecorderEnabled() && xTraceEventFilterIsEnabled(uiEventCode)) ? xTraceEventBeginOffline(uiEventCode, uiTotalPayloadSize, pxEventHandle) : TRC_FAIL)
 
 /**
  * @internal Ends a trace event offline. 
@@ -43,15 +43,38 @@ extern "C" {
  */
 #define TRC_EVENT_BUFFER_OPTION_OVERWRITE	(1U)
 
+/**
+ * @def TRC_EVENT_BUFFER_OPTION_LOCK_FREE
+ * @brief Buffer should skip new events when full, and may be pushed to by one
+ * producer while one consumer transfers from it without any lock. Only the
+ * producer writes the head and only the consumer writes the tail.
+ */
+#define TRC_EVENT_BUFFER_OPTION_LOCK_FREE	(2U)
+
+/**
+ * @def TRC_EVENT_BUFFER_MEMORY_BARRIER
+ * @brief Memory barrier used by TRC_EVENT_BUFFER_OPTION_LOCK_FREE, so that the
+ * event data and the head and tail indexes are seen in order by the other core.
+ * Defaults to a full barrier for GCC compatible compilers. Other compilers
+ * should define it in trcConfig.h when used on a multi-core target.
+ */
+#ifndef TRC_EVENT_BUFFER_MEMORY_BARRIER
+#if defined(__GNUC__)
+#define TRC_EVENT_BUFFER_MEMORY_BARRIER() __sync_synchronize()
+#else
+#define TRC_EVENT_BUFFER_MEMORY_BARRIER()
+#endif
+#endif
+
 /**
  * @brief Trace Event Buffer Structure
  */
 typedef struct TraceEventBuffer
 {
-	uint32_t uiHead;				/**< Head index of buffer */
-	uint32_t uiTail;				/**< Tail index of buffer */
+	volatile uint32_t uiHead;		/**< Head index of buffer */
+	volatile uint32_t uiTail;		/**< Tail index of buffer */
 	uint32_t uiSize;				/**< Buffer size */
-	uint32_t uiOptions;				/**< Options (skip/overwrite when full) */
+	uint32_t uiOptions;				/**< Options (skip/overwrite/lock-free) */
 	uint32_t uiDroppedEvents;		/**< Nr of dropped events */
 	uint32_t uiFree;				/**< Nr of free bytes */
 	uint32_t uiTimerWraparounds;	/**< Nr of timer wraparounds */
@@ -65,8 +88,9 @@ typedef struct TraceEventBuffer
  * memory area based on the supplied buffer.
  * 
  * Trace event buffer options specifies the buffer behavior regarding
- * old data, the alternatives are TRC_EVENT_BUFFER_OPTION_SKIP and
- * TRC_EVENT_BUFFER_OPTION_OVERWRITE (mutal exclusive).
+ * old data, the alternatives are TRC_EVENT_BUFFER_OPTION_SKIP,
+ * TRC_EVENT_BUFFER_OPTION_OVERWRITE and TRC_EVENT_BUFFER_OPTION_LOCK_FREE
+ * (mutal exclusive).
  *
  * @param[out] pxTraceEventBuffer Pointer to uninitialized trace event buffer.
  * @param[in] uiOptions Trace event buffer options.
@@ -94,6 +118,39 @@ traceResult xTraceEventBufferInitialize(TraceEventBuffer_t * pxTraceEventBuffer,
  */
 traceResult xTraceEventBufferPush(TraceEventBuffer_t *pxTraceEventBuffer, void *pxData, uint32_t uiSize, int32_t *piBytesWritten);
 
+/**
+ * @brief Allocates space for an event to be written in place.
+ * 
+ * If the event fits at the head of the trace event buffer without wrapping, the
+ * returned pointer points into the buffer itself, so the event is written once and
+ * published by xTraceEventBufferCommit(...) without being copied. Otherwise the
+ * static buffer is returned and the event is copied by xTraceEventBufferCommit(...).
+ * 
+ * Only one allocation can be outstanding per buffer, so the event must be committed
+ * before the critical section it was allocated in is exited.
+ *
+ * @param[in] pxTraceEventBuffer Pointer to initialized trace event buffer.
+ * @param[in] uiSize Size of event.
+ * @param[out] ppvData Pointer to where the event should be written.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceEventBufferAllocate(TraceEventBuffer_t *pxTraceEventBuffer, uint32_t uiSize, void **ppvData);
+
+/**
+ * @brief Commits an event allocated with xTraceEventBufferAllocate(...).
+ *
+ * @param[in] pxTraceEventBuffer Pointer to initialized trace event buffer.
+ * @param[in] pvData Pointer returned by xTraceEventBufferAllocate(...).
+ * @param[in] uiSize Size of event.
+ * @param[out] piBytesWritten Bytes written.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceEventBufferCommit(TraceEventBuffer_t *pxTraceEventBuffer, void *pvData, uint32_t uiSize, int32_t *piBytesWritten);
+
 /**
  * @brief Transfer trace event buffer data through streamport.
  * 
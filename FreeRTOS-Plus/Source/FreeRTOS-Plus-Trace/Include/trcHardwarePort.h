@@ -85,6 +85,15 @@
  * previous event exceeds a certain limit (255 or 65535 depending on event type).
  * It is advised to keep the time between most events below 65535 native ticks
  * (after division by TRC_HWTC_DIVISOR) to avoid frequent XTS events.
+ *
+ * TRC_HWTC_COUNT_WRAPAROUNDS (optional, used in streaming mode only):
+ * How to read the number of times TRC_HWTC_COUNT has wrapped around, e.g. the
+ * upper half of a 64-bit counter whose lower half is TRC_HWTC_COUNT. If
+ * defined, the recorder doesn't have to detect the wraparounds on every
+ * timestamp, so taking a timestamp only reads the counter. On multi-core
+ * targets, using a counter shared by all cores also gives events on different
+ * cores a common timeline. See also TRC_CFG_TIMESTAMP_WRAPAROUNDS_ON_TICK in
+ * trcStreamingConfig.h, for 32-bit counters.
  ******************************************************************************/
 
 #if (TRC_CFG_HARDWARE_PORT == TRC_HARDWARE_PORT_NOT_SET)
@@ -156,6 +165,12 @@ uint32_t uiTraceTimerGetValue(void);
 	* either directly below or in trcConfig.h.
 	*
 	* #define TRC_CFG_ARM_CM_USE_SYSTICK
+	*
+	* The DWT cycle counter wraps around every few seconds at typical core
+	* clocks. Set TRC_CFG_TIMESTAMP_WRAPAROUNDS_ON_TICK to count this on the
+	* OS tick rather than on every event. Both DWT and SysTick are per core,
+	* so on multi-core devices use a timer shared by the cores instead, with
+	* TRC_HARDWARE_PORT_APPLICATION_DEFINED.
     **************************************************************************/
 
 	#if ((__CORTEX_M >= 0x03) && (! defined TRC_CFG_ARM_CM_USE_SYSTICK))
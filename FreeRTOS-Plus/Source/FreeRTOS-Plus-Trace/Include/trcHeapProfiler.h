@@ -0,0 +1,221 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+/**
+ * @file
+ *
+ * @brief Public trace heap profiler APIs.
+ */
+
+#ifndef TRC_HEAP_PROFILER_H
+#define TRC_HEAP_PROFILER_H
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <trcTypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup trace_heap_profiler_apis Trace Heap Profiler APIs
+ * @ingroup trace_recorder_apis
+ * @{
+ */
+
+/**
+ * @def TRC_HEAP_PROFILER_SIZE_CLASSES
+ * @brief The number of allocation size classes. Class 0 counts the
+ * allocations below 16 bytes, every following class twice the range of the
+ * previous one, and the last class everything from 1024 bytes.
+ */
+#define TRC_HEAP_PROFILER_SIZE_CLASSES 8
+
+#if (TRC_CFG_ENABLE_HEAP_PROFILER == 1)
+
+/**
+ * @brief The allocations from one call site.
+ *
+ * A free is attributed to the call site that allocated the block. The live
+ * values only include the allocations that could be tracked, see
+ * TRC_CFG_HEAP_PROFILER_MAX_LIVE_ALLOCATIONS.
+ */
+typedef struct TraceHeapProfilerCallSite
+{
+	void* pvCallSite;							/**< Return address of the allocation call, 0 for the call sites that didn't fit */
+	uint32_t uiAllocs;							/**< Successful allocations */
+	uint32_t uiFailedAllocs;					/**< Failed allocations */
+	uint32_t uiFrees;							/**< Frees of blocks allocated here */
+	uint32_t uiLiveAllocs;						/**< Blocks allocated here and not yet freed */
+	TraceUnsignedBaseType_t uxBytes;			/**< Bytes allocated in total */
+	TraceUnsignedBaseType_t uxLiveBytes;		/**< Bytes allocated here and not yet freed */
+} TraceHeapProfilerCallSite_t;
+
+/**
+ * @internal Trace Heap Profiler Allocation Structure
+ */
+typedef struct TraceHeapProfilerAllocation
+{
+	void* pvAddress;
+	TraceUnsignedBaseType_t uxSize;
+	uint32_t uiCallSite;
+} TraceHeapProfilerAllocation_t;
+
+/**
+ * @internal Trace Heap Profiler Structure
+ */
+typedef struct TraceHeapProfilerData
+{
+	TraceHeapProfilerCallSite_t xCallSites[TRC_CFG_HEAP_PROFILER_MAX_CALL_SITES];
+	TraceHeapProfilerAllocation_t xAllocations[TRC_CFG_HEAP_PROFILER_MAX_LIVE_ALLOCATIONS];
+	uint32_t uiSizeClasses[TRC_HEAP_PROFILER_SIZE_CLASSES];
+	uint8_t ucChanged[TRC_CFG_HEAP_PROFILER_MAX_CALL_SITES];
+	uint32_t uiCallSiteCount;
+	uint32_t uiAllocationCount;
+	uint32_t uiUntracked;
+	uint32_t uiReportTick;
+} TraceHeapProfilerData_t;
+
+/**
+ * @internal Trace Heap Profiler Buffer Structure
+ */
+typedef struct TraceHeapProfilerBuffer
+{
+	TraceUnsignedBaseType_t buffer[(sizeof(TraceHeapProfilerData_t) + sizeof(TraceUnsignedBaseType_t) - 1) / sizeof(TraceUnsignedBaseType_t)];
+} TraceHeapProfilerBuffer_t;
+
+/**
+ * @internal Initialize trace heap profiler system.
+ *
+ * @param[in] pxBuffer Pointer to memory that will be used by the trace
+ * heap profiler system.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHeapProfilerInitialize(TraceHeapProfilerBuffer_t* pxBuffer);
+
+/**
+ * @brief Counts an allocation. Called by the kernel port on every allocation,
+ * whether or not the recorder is enabled.
+ *
+ * @param[in] pvAddress Address, or 0 if the allocation failed.
+ * @param[in] uxSize Size.
+ * @param[in] pvCallSite Return address of the allocation call.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHeapProfilerAlloc(void* pvAddress, TraceUnsignedBaseType_t uxSize, void* pvCallSite);
+
+/**
+ * @brief Counts a free. Called by the kernel port on every free, whether or
+ * not the recorder is enabled.
+ *
+ * @param[in] pvAddress Address.
+ *
+ * @retval TRC_FAIL Failure, the block wasn't tracked
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHeapProfilerFree(void* pvAddress);
+
+/**
+ * @brief Gets the number of call sites seen.
+ *
+ * @param[out] puiCount Number of call sites.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHeapProfilerGetCallSiteCount(uint32_t* puiCount);
+
+/**
+ * @brief Gets a copy of the counts of the call site at an index. Call sites
+ * keep their index.
+ *
+ * @param[in] uiIndex Index, below the count from xTraceHeapProfilerGetCallSiteCount(...).
+ * @param[out] pxCallSite The call site.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHeapProfilerGetCallSite(uint32_t uiIndex, TraceHeapProfilerCallSite_t* pxCallSite);
+
+/**
+ * @brief Gets the number of allocations in a size class, see
+ * TRC_HEAP_PROFILER_SIZE_CLASSES.
+ *
+ * @param[in] uiClass Size class.
+ * @param[out] puiCount Number of allocations.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHeapProfilerGetSizeClass(uint32_t uiClass, uint32_t* puiCount);
+
+/**
+ * @brief Gets the number of allocations that could not be tracked, since
+ * TRC_CFG_HEAP_PROFILER_MAX_LIVE_ALLOCATIONS were live already. Their frees
+ * aren't attributed to any call site.
+ *
+ * @param[out] puiCount Number of untracked allocations.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHeapProfilerGetUntracked(uint32_t* puiCount);
+
+/**
+ * @internal Reports the heap profile as User Events on the "#Heap" channel,
+ * at most every TRC_CFG_HEAP_PROFILER_REPORT_PERIOD ticks. Called from the
+ * TzCtrl task.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHeapProfilerReport(void);
+
+#else /* (TRC_CFG_ENABLE_HEAP_PROFILER == 1) */
+
+typedef struct TraceHeapProfilerBuffer
+{
+	uint32_t buffer[1];
+} TraceHeapProfilerBuffer_t;
+
+#define xTraceHeapProfilerInitialize(pxBuffer) ((void)pxBuffer, TRC_SUCCESS)
+
+#define xTraceHeapProfilerAlloc(pvAddress, uxSize, pvCallSite) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_4((void)(pvAddress), (void)(uxSize), (void)(pvCallSite), TRC_SUCCESS)
+
+#define xTraceHeapProfilerFree(pvAddress) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2((void)(pvAddress), TRC_SUCCESS)
+
+#define xTraceHeapProfilerGetCallSiteCount(puiCount) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(puiCount) = 0, TRC_SUCCESS)
+
+#define xTraceHeapProfilerGetCallSite(uiIndex, pxCallSite) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)(uiIndex), (void)(pxCallSite), TRC_FAIL)
+
+#define xTraceHeapProfilerGetSizeClass(uiClass, puiCount) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)(uiClass), *(puiCount) = 0, TRC_SUCCESS)
+
+#define xTraceHeapProfilerGetUntracked(puiCount) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(puiCount) = 0, TRC_SUCCESS)
+
+#define xTraceHeapProfilerReport() TRC_COMMA_EXPR_TO_STATEMENT_EXPR_1(TRC_SUCCESS)
+
+#endif /* (TRC_CFG_ENABLE_HEAP_PROFILER == 1) */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
+
+#endif /* TRC_HEAP_PROFILER_H */
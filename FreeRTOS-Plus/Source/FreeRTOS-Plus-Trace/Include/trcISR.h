@@ -31,14 +31,32 @@ extern "C" {
  * @{
  */
 
+/**
+ * @def TRC_ISR_COMPILER_BARRIER
+ * @brief Compiler barrier used by xTraceISRBegin() and xTraceISREnd(), so that
+ * the nesting stack is updated in program order as seen by a nested ISR on the
+ * same core. Defaults to an empty asm statement for GCC compatible compilers.
+ * Other compilers should define it in trcConfig.h.
+ */
+#ifndef TRC_ISR_COMPILER_BARRIER
+#if defined(__GNUC__)
+#define TRC_ISR_COMPILER_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define TRC_ISR_COMPILER_BARRIER()
+#endif
+#endif
+
 /**
  * @internal Trace ISR Core Info Structure
+ *
+ * Only accessed from its own core, and nested ISRs always return before the
+ * ISR they interrupted continues, so it is updated without any lock.
  */
 typedef struct TraceISRCoreInfo
 {
-	TraceISRHandle_t handleStack[TRC_CFG_MAX_ISR_NESTING];	/**< */
-	int32_t stackIndex;										/**< */
-	int32_t isPendingContextSwitch;							/**< */
+	volatile TraceISRHandle_t handleStack[TRC_CFG_MAX_ISR_NESTING];	/**< */
+	volatile int32_t stackIndex;									/**< */
+	volatile int32_t isPendingContextSwitch;						/**< */
 } TraceISRCoreInfo_t;
 
 /**
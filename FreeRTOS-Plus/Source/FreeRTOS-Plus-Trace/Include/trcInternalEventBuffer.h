@@ -27,6 +27,21 @@
 
 #include <trcTypes.h>
 
+/**
+ * @def TRC_CFG_INTERNAL_EVENT_BUFFER_OPTION
+ * @brief Trace event buffer option used by the internal event buffer. On
+ * multi-core targets the per-core buffers default to the lock-free mode, so
+ * the core transferring the events never needs a lock shared with the cores
+ * producing them. May be overridden in trcConfig.h.
+ */
+#ifndef TRC_CFG_INTERNAL_EVENT_BUFFER_OPTION
+#if (TRC_CFG_CORE_COUNT > 1)
+#define TRC_CFG_INTERNAL_EVENT_BUFFER_OPTION TRC_EVENT_BUFFER_OPTION_LOCK_FREE
+#else
+#define TRC_CFG_INTERNAL_EVENT_BUFFER_OPTION TRC_EVENT_BUFFER_OPTION_SKIP
+#endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -60,6 +75,32 @@ traceResult xTraceInternalEventBufferInitialize(uint8_t* puiBuffer, uint32_t uiS
  */
 traceResult xTraceInternalEventBufferPush(void *pvData, uint32_t uiSize, int32_t *piBytesWritten);
 
+/**
+ * @brief Allocates space for an event in the internal trace event buffer.
+ * 
+ * The event is written in place when it fits without wrapping, and is then
+ * published by xTraceInternalEventBufferCommit(...) without being copied.
+ * 
+ * @param[in] uiSize Size of event
+ * @param[out] ppvData Pointer to where the event should be written
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceInternalEventBufferAllocate(uint32_t uiSize, void **ppvData);
+
+/**
+ * @brief Commits an event allocated with xTraceInternalEventBufferAllocate(...).
+ * 
+ * @param[in] pvData Pointer returned by xTraceInternalEventBufferAllocate(...)
+ * @param[in] uiSize Size of event
+ * @param[out] piBytesWritten Bytes written.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceInternalEventBufferCommit(void *pvData, uint32_t uiSize, int32_t *piBytesWritten);
+
 /**
  * @brief Transfers all internal trace event buffer data using the function 
  * xTraceStreamPortWriteData(...) as defined in trcStreamPort.h.
@@ -85,6 +126,17 @@ traceResult xTraceInternalEventBufferTransfer(int32_t *piBytesWritten);
  */
 traceResult xTraceInternalEventBufferClear(void);
 
+/**
+ * @brief Gets the size of the internal trace event buffer of a single core,
+ * which is the most that can be buffered between two transfers.
+ * 
+ * @param[out] puiSize Size in bytes.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceInternalEventBufferGetSize(uint32_t *puiSize);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -95,8 +147,11 @@ traceResult xTraceInternalEventBufferClear(void);
 
 #define xTraceInternalEventBufferInitialize(puiBuffer, uiSize) ((void)uiSize, puiBuffer != 0 ? TRC_SUCCESS : TRC_FAIL)
 #define xTraceInternalEventBufferPush(pvData, uiSize, piBytesWritten) ((void)uiSize, (void)piBytesWritten, pvData != 0 ? TRC_SUCCESS : TRC_FAIL)
+#define xTraceInternalEventBufferAllocate(uiSize, ppvData) ((void)uiSize, xTraceStaticBufferGet(ppvData))
+#define xTraceInternalEventBufferCommit(pvData, uiSize, piBytesWritten) ((void)uiSize, (void)piBytesWritten, pvData != 0 ? TRC_SUCCESS : TRC_FAIL)
 #define xTraceInternalEventBufferTransfer(piBytesWritten) ((void)piBytesWritten, TRC_SUCCESS)
 #define xTraceInternalEventBufferClear() (void)(TRC_SUCCESS)
+#define xTraceInternalEventBufferGetSize(puiSize) (*(puiSize) = 0, TRC_SUCCESS)
 
 #endif /* (TRC_USE_INTERNAL_BUFFER == 1)*/
 
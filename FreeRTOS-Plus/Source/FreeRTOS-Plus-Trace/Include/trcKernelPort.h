@@ -263,6 +263,24 @@ void vTraceSetMessageBufferName(void* pvMessageBuffer, const char* szName);
   */
 traceResult xTraceKernelPortGetUnusedStack(void* pvTask, TraceUnsignedBaseType_t *puxUnusedStack);
 
+/**
+ * @internal Calls on FreeRTOS vTaskSuspendAll(). Keeps tasks from being
+ * deleted, and their stacks from being freed, while a stack is scanned
+ * without the recorder's critical section.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceKernelPortSuspendScheduler(void);
+
+/**
+ * @internal Calls on FreeRTOS xTaskResumeAll().
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceKernelPortResumeScheduler(void);
+
 #endif
 
 #else
@@ -2665,21 +2683,45 @@ TraceHeapHandle_t xTraceKernelPortGetSystemHeapHandle(void);
 #define traceTASK_RESUME_FROM_ISR( pxTaskToResume ) \
 	prvTraceStoreEvent_Handle(PSF_EVENT_TASK_RESUME_FROMISR, (void*)(pxTaskToResume))
 
-#if (TRC_CFG_INCLUDE_MEMMANG_EVENTS == 1)
+#if (TRC_CFG_INCLUDE_MEMMANG_EVENTS == 1) || (TRC_CFG_ENABLE_HEAP_PROFILER == 1)
 
-#undef traceMALLOC
-#define traceMALLOC( pvAddress, uiSize ) \
+#if (TRC_CFG_INCLUDE_MEMMANG_EVENTS == 1)
+#define TRC_KERNEL_PORT_MALLOC_EVENT(pvAddress, uiSize) \
 	if (xTraceIsRecorderEnabled()) \
 	{ \
 		xTraceHeapAlloc(xTraceKernelPortGetSystemHeapHandle(), pvAddress, uiSize); \
 	}
-
-#undef traceFREE
-#define traceFREE( pvAddress, uiSize ) \
+#define TRC_KERNEL_PORT_FREE_EVENT(pvAddress, uiSize) \
 	if (xTraceIsRecorderEnabled()) \
 	{ \
 		xTraceHeapFree(xTraceKernelPortGetSystemHeapHandle(), pvAddress, uiSize); \
 	}
+#else
+#define TRC_KERNEL_PORT_MALLOC_EVENT(pvAddress, uiSize)
+#define TRC_KERNEL_PORT_FREE_EVENT(pvAddress, uiSize)
+#endif
+
+/* The heap profiler counts also when not tracing. The call site is the caller
+ * of pvPortMalloc, since this is expanded inside it. */
+#if (TRC_CFG_ENABLE_HEAP_PROFILER == 1)
+#define TRC_KERNEL_PORT_MALLOC_PROFILE(pvAddress, uiSize) \
+	xTraceHeapProfilerAlloc(pvAddress, uiSize, TRC_CFG_HEAP_PROFILER_GET_CALL_SITE());
+#define TRC_KERNEL_PORT_FREE_PROFILE(pvAddress) \
+	xTraceHeapProfilerFree(pvAddress);
+#else
+#define TRC_KERNEL_PORT_MALLOC_PROFILE(pvAddress, uiSize)
+#define TRC_KERNEL_PORT_FREE_PROFILE(pvAddress)
+#endif
+
+#undef traceMALLOC
+#define traceMALLOC( pvAddress, uiSize ) \
+	TRC_KERNEL_PORT_MALLOC_PROFILE(pvAddress, uiSize) \
+	TRC_KERNEL_PORT_MALLOC_EVENT(pvAddress, uiSize)
+
+#undef traceFREE
+#define traceFREE( pvAddress, uiSize ) \
+	TRC_KERNEL_PORT_FREE_PROFILE(pvAddress) \
+	TRC_KERNEL_PORT_FREE_EVENT(pvAddress, uiSize)
 
 #endif
 
@@ -46,8 +46,9 @@ typedef struct TraceMultiCoreEventBuffer
  * a memory area based on the supplied buffer.
  * 
  * Trace event buffer options specifies the buffer behavior regarding
- * old data, the alternatives are TRC_EVENT_BUFFER_OPTION_SKIP and
- * TRC_EVENT_BUFFER_OPTION_OVERWRITE (mutal exclusive).
+ * old data, the alternatives are TRC_EVENT_BUFFER_OPTION_SKIP,
+ * TRC_EVENT_BUFFER_OPTION_OVERWRITE and TRC_EVENT_BUFFER_OPTION_LOCK_FREE
+ * (mutal exclusive).
  * 
  * @param[out] pxTraceMultiCoreEventBuffer Pointer to unitialized multi-core trace event buffer.
  * @param[in] uiOptions Trace event buffer options.
@@ -82,6 +83,35 @@ traceResult xTraceMultiCoreEventBufferInitialize(TraceMultiCoreEventBuffer_t* px
  */
 traceResult xTraceMultiCoreEventBufferPush(TraceMultiCoreEventBuffer_t* pxTraceMultiCoreEventBuffer, void* pvData, uint32_t uiSize, int32_t* piBytesWritten);
 
+/**
+ * @brief Allocates space for an event in the current core's trace event buffer.
+ * 
+ * See xTraceEventBufferAllocate(...).
+ * 
+ * @param[in] pxTraceMultiCoreEventBuffer Pointer to initialized multi-core event buffer.
+ * @param[in] uiSize Size of event.
+ * @param[out] ppvData Pointer to where the event should be written.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceMultiCoreEventBufferAllocate(TraceMultiCoreEventBuffer_t* pxTraceMultiCoreEventBuffer, uint32_t uiSize, void** ppvData);
+
+/**
+ * @brief Commits an event allocated with xTraceMultiCoreEventBufferAllocate(...).
+ * 
+ * See xTraceEventBufferCommit(...).
+ * 
+ * @param[in] pxTraceMultiCoreEventBuffer Pointer to initialized multi-core event buffer.
+ * @param[in] pvData Pointer returned by xTraceMultiCoreEventBufferAllocate(...).
+ * @param[in] uiSize Size of event.
+ * @param[out] piBytesWritten Bytes written.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceMultiCoreEventBufferCommit(TraceMultiCoreEventBuffer_t* pxTraceMultiCoreEventBuffer, void* pvData, uint32_t uiSize, int32_t* piBytesWritten);
+
 #else
 
 /**
@@ -102,6 +132,35 @@ traceResult xTraceMultiCoreEventBufferPush(TraceMultiCoreEventBuffer_t* pxTraceM
  */
 #define xTraceMultiCoreEventBufferPush(pxTraceMultiCoreEventBuffer, pvData, uiSize, piBytesWritten) xTraceEventBufferPush((pxTraceMultiCoreEventBuffer)->xEventBuffer[TRC_CFG_GET_CURRENT_CORE()], pvData, uiSize, piBytesWritten)
 
+/**
+ * @brief Allocates space for an event in the current core's trace event buffer.
+ * 
+ * See xTraceEventBufferAllocate(...).
+ * 
+ * @param[in] pxTraceMultiCoreEventBuffer Pointer to initialized multi-core event buffer.
+ * @param[in] uiSize Size of event.
+ * @param[out] ppvData Pointer to where the event should be written.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+#define xTraceMultiCoreEventBufferAllocate(pxTraceMultiCoreEventBuffer, uiSize, ppvData) xTraceEventBufferAllocate((pxTraceMultiCoreEventBuffer)->xEventBuffer[TRC_CFG_GET_CURRENT_CORE()], uiSize, ppvData)
+
+/**
+ * @brief Commits an event allocated with xTraceMultiCoreEventBufferAllocate(...).
+ * 
+ * See xTraceEventBufferCommit(...).
+ * 
+ * @param[in] pxTraceMultiCoreEventBuffer Pointer to initialized multi-core event buffer.
+ * @param[in] pvData Pointer returned by xTraceMultiCoreEventBufferAllocate(...).
+ * @param[in] uiSize Size of event.
+ * @param[out] piBytesWritten Bytes written.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+#define xTraceMultiCoreEventBufferCommit(pxTraceMultiCoreEventBuffer, pvData, uiSize, piBytesWritten) xTraceEventBufferCommit((pxTraceMultiCoreEventBuffer)->xEventBuffer[TRC_CFG_GET_CURRENT_CORE()], pvData, uiSize, piBytesWritten)
+
 #endif
 
 /**
@@ -189,6 +189,24 @@ traceResult xTraceObjectSetSpecificStateWithoutHandle(void* pvObject, uint32_t u
  */
 traceResult xTraceObjectSetOptionsWithoutHandle(void* pvObject, uint32_t uiOptions);
 
+#if (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0)
+/**
+ * @internal Forgets all names sent, since a new trace is started.
+ */
+void xTraceObjectNameCacheClear(void);
+
+/**
+ * @internal Remembers a name as sent to the host, e.g., in the entry table.
+ * 
+ * @param[in] pvObject Object.
+ * @param[in] szName Name.
+ */
+void xTraceObjectNameCacheAdd(void* pvObject, const char* szName);
+#else
+#define xTraceObjectNameCacheClear()
+#define xTraceObjectNameCacheAdd(pvObject, szName)
+#endif /* (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0) */
+
 /** @} */
 
 #ifdef __cplusplus
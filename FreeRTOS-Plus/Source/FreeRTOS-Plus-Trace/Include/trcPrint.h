@@ -174,6 +174,46 @@ traceResult xTracePrintF(TraceStringHandle_t xChannel, const char* szFormat, ...
  */
 traceResult xTraceVPrintF(TraceStringHandle_t xChannel, const char* szFormat, va_list xVL);
 
+/**
+ * @brief Generates "User Events" with formatted text and data, like
+ * xTracePrintF(...) but without parsing the format string on the target.
+ * 
+ * @param[in] xChannel Channel.
+ * @param[in] szFormat Format.
+ * @param[in] uiLength Format length, including null termination.
+ * @param[in] uiArgs Number of arguments, up to 15.
+ * @param[in] puxArgs Arguments.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTracePrintFArgs(TraceStringHandle_t xChannel, const char* szFormat, uint32_t uiLength, uint32_t uiArgs, const TraceUnsignedBaseType_t* puxArgs);
+
+/**
+ * @brief Generates "User Events" with formatted text and data, for a format
+ * given as a string literal. The format length and the number of arguments
+ * are worked out at compile time, so unlike xTracePrintF(...) the format
+ * string is neither scanned nor measured on the target. The event is the same,
+ * and is still formatted on the host.
+ * 
+ * This is a statement, not an expression. All arguments are converted to
+ * TraceUnsignedBaseType_t.
+ * 
+ * Example:
+ * 
+ *	 xTracePrintFLiteral(adc_uechannel, "ADC channel %d: %d volts", ch, adc_reading);
+ * 
+ * @param[in] xChannel Channel.
+ * @param[in] szFormat Format, must be a string literal.
+ * @param[in] ... Arguments, up to 15.
+ */
+#define xTracePrintFLiteral(xChannel, szFormat, ...) \
+	do \
+	{ \
+		const TraceUnsignedBaseType_t _auxTraceArgs[] = { 0, __VA_ARGS__ }; /* The first one is padding, for when there are no arguments */ \
+		(void)xTracePrintFArgs((xChannel), "" szFormat, sizeof("" szFormat), (sizeof(_auxTraceArgs) / sizeof(_auxTraceArgs[0])) - 1, &_auxTraceArgs[1]); \
+	} while (0)
+
 #else /* (TRC_CFG_SCHEDULING_ONLY == 0) && (TRC_CFG_INCLUDE_USER_EVENTS == 1) */
 
 typedef struct TracePrintBuffer
@@ -191,6 +231,10 @@ typedef struct TracePrintBuffer
 
 #define xTraceVPrintF(c, s, v) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_4((void)c, (void)s, (void)v, TRC_SUCCESS)
 
+#define xTracePrintFArgs(c, s, l, n, a) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_6((void)c, (void)s, (void)l, (void)n, (void)a, TRC_SUCCESS)
+
+#define xTracePrintFLiteral(c, s, ...) do { (void)(c); } while (0)
+
 #endif /* (TRC_CFG_SCHEDULING_ONLY == 0) && (TRC_CFG_INCLUDE_USER_EVENTS == 1) */
 
 /** @} */
@@ -0,0 +1,125 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+/**
+ * @file
+ *
+ * @brief Public trace profiler APIs.
+ */
+
+#ifndef TRC_PROFILER_H
+#define TRC_PROFILER_H
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <trcTypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup trace_profiler_apis Trace Profiler APIs
+ * @ingroup trace_recorder_apis
+ * @{
+ */
+
+/**
+ * @def TRC_PROFILER_EXTENSION_NAME
+ * @brief The name of the trace extension that the samples belong to.
+ */
+#define TRC_PROFILER_EXTENSION_NAME "Profiler"
+
+/**
+ * @def TRC_PROFILER_EVENT_SAMPLE
+ * @brief The local event id of a sample, within the extension.
+ */
+#define TRC_PROFILER_EVENT_SAMPLE 0
+
+#if (TRC_CFG_ENABLE_PROFILER == 1)
+
+/**
+ * @internal Trace Profiler Buffer Structure
+ */
+typedef struct TraceProfilerBuffer
+{
+	uint32_t buffer[(sizeof(TraceExtensionHandle_t) + sizeof(uint32_t)) / sizeof(uint32_t)];
+} TraceProfilerBuffer_t;
+
+/**
+ * @internal Initialize trace profiler system.
+ *
+ * @param[in] pxBuffer Pointer to memory that will be used by the trace
+ * profiler system.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceProfilerInitialize(TraceProfilerBuffer_t* pxBuffer);
+
+/**
+ * @brief Stores a profiler sample, attributed to the current task.
+ *
+ * Call this from a periodic timer interrupt, with the program counter
+ * of the code it interrupted. That gives a statistical breakdown of the
+ * CPU time per task and function, for far less overhead than tracing every
+ * event. A sample is one event, with the task and the program counter.
+ *
+ * The timer interrupt must be masked by the recorder's critical sections, like
+ * any interrupt that calls the recorder. A rate that isn't a multiple of
+ * the OS tick rate avoids sampling in step with periodic tasks.
+ *
+ * Example, for ARM Cortex-M using GCC. The program counter is at offset 24 of
+ * the registers stacked on exception entry, on the process stack if a task
+ * was interrupted:
+ *
+ *	 void TIMx_IRQHandler(void)
+ *	 {
+ *		 uint32_t uiExcReturn = (uint32_t)__builtin_return_address(0);
+ *		 uint32_t* puiFrame = 0;
+ *		 ...
+ *		 if ((uiExcReturn & 0x4) != 0)
+ *		 {
+ *			 __asm volatile ("mrs %0, psp" : "=r" (puiFrame));
+ *		 }
+ *		 xTraceProfilerSample(puiFrame != 0 ? (void*)puiFrame[6] : 0);
+ *	 }
+ *
+ * @param[in] pvPC Program counter of the interrupted code, or 0 if not known.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceProfilerSample(void* pvPC);
+
+#else /* (TRC_CFG_ENABLE_PROFILER == 1) */
+
+typedef struct TraceProfilerBuffer
+{
+	uint32_t buffer[1];
+} TraceProfilerBuffer_t;
+
+#define xTraceProfilerInitialize(pxBuffer) ((void)pxBuffer, TRC_SUCCESS)
+
+#define xTraceProfilerSample(pvPC) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2((void)(pvPC), TRC_SUCCESS)
+
+#endif /* (TRC_CFG_ENABLE_PROFILER == 1) */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
+
+#endif /* TRC_PROFILER_H */
@@ -103,6 +103,118 @@ typedef uint8_t traceHandle;
 #define TRC_CFG_USE_GCC_STATEMENT_EXPR 0
 #endif
 
+/* Unless specified in trcStreamingConfig.h objects that don't fit in the entry table aren't traced */
+#ifndef TRC_CFG_ENTRY_RECYCLE
+#define TRC_CFG_ENTRY_RECYCLE 0
+#endif
+
+/* Unless specified in trcStreamingConfig.h every object name is sent */
+#ifndef TRC_CFG_OBJECT_NAME_CACHE_SIZE
+#define TRC_CFG_OBJECT_NAME_CACHE_SIZE 0
+#endif
+
+/* Unless specified in trcStreamingConfig.h the event filter isn't used */
+#ifndef TRC_CFG_USE_EVENT_FILTER
+#define TRC_CFG_USE_EVENT_FILTER 0
+#endif
+
+/* Event codes are 12 bits, one filter bit per event code */
+#define TRC_EVENT_FILTER_WORDS (0x1000 / 32)
+
+/* Unless specified in trcStreamingConfig.h TzCtrl sleeps TRC_CFG_CTRL_TASK_DELAY every loop */
+#ifndef TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY
+#define TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY 0
+#endif
+
+/* Unless specified in trcStreamingConfig.h timer wraparounds are detected on every timestamp */
+#ifndef TRC_CFG_TIMESTAMP_WRAPAROUNDS_ON_TICK
+#define TRC_CFG_TIMESTAMP_WRAPAROUNDS_ON_TICK 0
+#endif
+
+/* Unless specified in trcStreamingConfig.h the recorder doesn't measure itself */
+#ifndef TRC_CFG_ENABLE_RECORDER_METRICS
+#define TRC_CFG_ENABLE_RECORDER_METRICS 0
+#endif
+
+/* Unless specified in trcStreamingConfig.h the metrics are reported every 1000 ticks */
+#ifndef TRC_CFG_RECORDER_METRICS_REPORT_PERIOD
+#define TRC_CFG_RECORDER_METRICS_REPORT_PERIOD 1000
+#endif
+
+/* Unless specified in trcStreamingConfig.h there is no sampling profiler */
+#ifndef TRC_CFG_ENABLE_PROFILER
+#define TRC_CFG_ENABLE_PROFILER 0
+#endif
+
+/* Unless specified in trcStreamingConfig.h there are no task statistics */
+#ifndef TRC_CFG_ENABLE_TASK_STATS
+#define TRC_CFG_ENABLE_TASK_STATS 0
+#endif
+
+/* Unless specified in trcStreamingConfig.h statistics are kept for 10 tasks */
+#ifndef TRC_CFG_TASK_STATS_MAX_TASKS
+#define TRC_CFG_TASK_STATS_MAX_TASKS 10
+#endif
+
+/* Unless specified in trcStreamingConfig.h the latency histograms have 8 bins */
+#ifndef TRC_CFG_TASK_STATS_HISTOGRAM_BINS
+#define TRC_CFG_TASK_STATS_HISTOGRAM_BINS 8
+#endif
+
+/* Unless specified in trcStreamingConfig.h the first bin is 1024 timer counts */
+#ifndef TRC_CFG_TASK_STATS_LATENCY_SHIFT
+#define TRC_CFG_TASK_STATS_LATENCY_SHIFT 10
+#endif
+
+/* Unless specified in trcStreamingConfig.h there is no heap profiler */
+#ifndef TRC_CFG_ENABLE_HEAP_PROFILER
+#define TRC_CFG_ENABLE_HEAP_PROFILER 0
+#endif
+
+/* Unless specified in trcStreamingConfig.h 16 call sites are told apart */
+#ifndef TRC_CFG_HEAP_PROFILER_MAX_CALL_SITES
+#define TRC_CFG_HEAP_PROFILER_MAX_CALL_SITES 16
+#endif
+
+/* Unless specified in trcStreamingConfig.h 64 live allocations are tracked */
+#ifndef TRC_CFG_HEAP_PROFILER_MAX_LIVE_ALLOCATIONS
+#define TRC_CFG_HEAP_PROFILER_MAX_LIVE_ALLOCATIONS 64
+#endif
+
+/* Unless specified in trcStreamingConfig.h the heap profile is reported every 1000 ticks */
+#ifndef TRC_CFG_HEAP_PROFILER_REPORT_PERIOD
+#define TRC_CFG_HEAP_PROFILER_REPORT_PERIOD 1000
+#endif
+
+/* Unless specified in trcStreamingConfig.h there are no duration statistics */
+#ifndef TRC_CFG_ENABLE_DURATION_STATS
+#define TRC_CFG_ENABLE_DURATION_STATS 0
+#endif
+
+/* Unless specified in trcStreamingConfig.h statistics are kept for 8 intervals and states */
+#ifndef TRC_CFG_DURATION_STATS_MAX_SLOTS
+#define TRC_CFG_DURATION_STATS_MAX_SLOTS 8
+#endif
+
+/* Unless specified in trcStreamingConfig.h the duration histograms cover all 32-bit durations */
+#ifndef TRC_CFG_DURATION_STATS_HISTOGRAM_BINS
+#define TRC_CFG_DURATION_STATS_HISTOGRAM_BINS 32
+#endif
+
+/* Unless specified in trcStreamingConfig.h events are sent in the standard format */
+#ifndef TRC_CFG_STREAMING_COMPACT
+#define TRC_CFG_STREAMING_COMPACT 0
+#endif
+
+/* Unless specified in trcConfig.h the call site is the return address, if the compiler provides it */
+#ifndef TRC_CFG_HEAP_PROFILER_GET_CALL_SITE
+#if defined(__GNUC__)
+#define TRC_CFG_HEAP_PROFILER_GET_CALL_SITE() __builtin_return_address(0)
+#else
+#define TRC_CFG_HEAP_PROFILER_GET_CALL_SITE() ((void*)0)
+#endif
+#endif
+
 /* Backwards compatibility */
 typedef TraceISRHandle_t traceHandle;
 
@@ -145,6 +257,15 @@ typedef struct TraceHeaderBuffer
 #include <trcDiagnostics.h>
 #include <trcAssert.h>
 #include <trcCounter.h>
+#include <trcProfiler.h>
+#include <trcTaskStats.h>
+#include <trcHeapProfiler.h>
+#include <trcDurationStats.h>
+
+/* Unless the stream port keeps a ring buffer to freeze, triggers are ignored */
+#ifndef xTraceStreamPortOnTrigger
+#define xTraceStreamPortOnTrigger() (TRC_SUCCESS)
+#endif
 
 #endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
 
@@ -242,6 +363,28 @@ traceResult	xTraceEnable(uint32_t uiStartOption);
  */
 traceResult xTraceDisable(void);
 
+/**
+ * @brief Triggers a freeze of the trace, for post-mortem tracing.
+ *
+ * With the RingBuffer stream port, the recorder keeps overwriting the oldest
+ * events until this is called, then records
+ * TRC_CFG_STREAM_PORT_RINGBUFFER_TRIGGER_EVENTS more events and stops. The
+ * buffer then holds the events leading up to and following the trigger, and
+ * can be read by a debugger or sent with xTraceRingBufferDump(). Only the
+ * first trigger counts until tracing is started again. The FanOut stream
+ * port only freezes its ring buffer, and keeps writing to its other
+ * destinations. Other stream ports ignore the trigger. In snapshot mode, the recorder stops at once.
+ *
+ * Call this from the application where the trace should be kept, e.g. in
+ * configASSERT, vApplicationStackOverflowHook or a counter callback (see
+ * xTraceCounterSetCallback). The recorder already stops on its own errors,
+ * including a failed TRC_ASSERT.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceTrigger(void);
+
 /**
  * @brief
  *
@@ -616,6 +759,14 @@ void vTraceClear(void);
 #define TRC_CFG_INCLUDE_OSTICK_EVENTS 0
 #endif
 
+#ifndef TRC_CFG_SNAPSHOT_COMPACT
+#define TRC_CFG_SNAPSHOT_COMPACT 0
+#endif
+
+/* In the compact layout, eventData only holds the event being written, which
+is at most a user event with 15 data records */
+#define TRC_SNAPSHOT_STAGING_SLOTS 16
+
 /* This macro will create a task in the object table */
 #undef trcKERNEL_HOOKS_TASK_CREATE
 #define trcKERNEL_HOOKS_TASK_CREATE(SERVICE, CLASS, pxTCB) \
@@ -1397,8 +1548,29 @@ typedef struct
 	/* 0xF3F3F3F3 - for control only */
 	int32_t debugMarker3;
 
+#if (TRC_CFG_SNAPSHOT_COMPACT == 1)
+	/* The event being written, in 4-byte records. It is then packed into
+	compactData by prvTraceCompactCommit */
+	uint8_t eventData[ (TRC_SNAPSHOT_STAGING_SLOTS) * 4 ];
+
+	/* 0xF4F4F4F4 - for control only */
+	int32_t debugMarker4;
+
+	/* The size of compactData, in bytes */
+	uint32_t compactSize;
+
+	/* The index in compactData where to write the next record */
+	uint32_t compactHead;
+
+	/* The number of bytes of records, ending at compactHead */
+	uint32_t compactUsed;
+
+	/* The event data, in variable length records */
+	uint8_t compactData[ (TRC_CFG_EVENT_BUFFER_SIZE) * 4 ];
+#else
 	/* The event data, in 4-byte records */
 	uint8_t eventData[ (TRC_CFG_EVENT_BUFFER_SIZE) * 4 ];
+#endif
 
 #if (TRC_CFG_USE_SEPARATE_USER_EVENT_BUFFER == 1)
 	UserEventBuffer userEventBuffer;
@@ -1518,6 +1690,12 @@ typedef struct TraceRecorderData
 	uint32_t uiSessionCounter;
 	uint32_t uiRecorderEnabled;
 	uint32_t uiTraceSystemState;
+#if (TRC_CFG_USE_EVENT_FILTER == 1)
+	uint32_t uiEventFilter[TRC_EVENT_FILTER_WORDS]; /* Set bits are disabled event codes */
+#endif
+#if (TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY == 1)
+	uint32_t uiTzCtrlDelay; /* Ticks to sleep before the next TzCtrl loop */
+#endif
 
 	TraceAssertBuffer_t xAssertBuffer;
 #if (TRC_EXTERNAL_BUFFERS == 0)
@@ -1535,6 +1713,10 @@ typedef struct TraceRecorderData
 	TraceTaskInfoBuffer_t xTaskInfoBuffer;
 	TraceStackMonitorBuffer_t xStackMonitorBuffer;
 	TraceDiagnosticsBuffer_t xDiagnosticsBuffer;
+	TraceProfilerBuffer_t xProfilerBuffer;
+	TraceTaskStatsBuffer_t xTaskStatsBuffer;
+	TraceHeapProfilerBuffer_t xHeapProfilerBuffer;
+	TraceDurationStatsBuffer_t xDurationStatsBuffer;
 } TraceRecorderData_t;
 
 extern TraceRecorderData_t* pxTraceRecorderData;
@@ -1593,6 +1775,51 @@ traceResult xTraceHeaderInitialize(TraceHeaderBuffer_t* pxBuffer);
  */
 #define xTraceIsComponentInitialized(uiComponentBit) ((RecorderInitialized & (uiComponentBit)) ? 1 : 0)
 
+#if (TRC_CFG_USE_EVENT_FILTER == 1)
+
+/**
+ * @brief Enables or disables an event code.
+ * 
+ * A disabled event code is dropped by xTraceEventBegin(...).
+ * 
+ * @param[in] uiEventCode Event code
+ * @param[in] uiEnabled 1 to enable, 0 to disable
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceEventFilterSet(uint32_t uiEventCode, uint32_t uiEnabled);
+
+/**
+ * @brief Enables or disables all event codes.
+ * 
+ * @param[in] uiEnabled 1 to enable, 0 to disable
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceEventFilterSetAll(uint32_t uiEnabled);
+
+/**
+ * @brief Query if an event code is enabled
+ * 
+ * @param[in] uiEventCode Event code
+ * 
+ * @retval 1 Event code enabled
+ * @retval 0 Event code disabled
+ */
+#define xTraceEventFilterIsEnabled(uiEventCode) ((pxTraceRecorderData->uiEventFilter[((uiEventCode) & 0xFFF) >> 5] & (1UL << ((uiEventCode) & 0x1F))) == 0)
+
+#else
+
+#define xTraceEventFilterSet(uiEventCode, uiEnabled) ((void)(uiEventCode), (void)(uiEnabled), TRC_FAIL)
+
+#define xTraceEventFilterSetAll(uiEnabled) ((void)(uiEnabled), TRC_FAIL)
+
+#define xTraceEventFilterIsEnabled(uiEventCode) 1
+
+#endif /* (TRC_CFG_USE_EVENT_FILTER == 1) */
+
 /**
  * @brief Set the trace state
  * 
@@ -1621,6 +1848,25 @@ traceResult xTraceHeaderInitialize(TraceHeaderBuffer_t* pxBuffer);
  */
 traceResult xTraceTzCtrl(void);
 
+#if (TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY == 1)
+
+/**
+ * @brief Query how long the TzCtrl task should sleep before calling
+ * xTraceTzCtrl() again.
+ * 
+ * @param[out] puiTicks Delay in ticks
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+#define xTraceTzCtrlGetDelay(puiTicks) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(puiTicks) = pxTraceRecorderData->uiTzCtrlDelay, TRC_SUCCESS)
+
+#else
+
+#define xTraceTzCtrlGetDelay(puiTicks) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(puiTicks) = (TRC_CFG_CTRL_TASK_DELAY), TRC_SUCCESS)
+
+#endif /* (TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY == 1) */
+
 /******************************************************************************/
 /*** INTERNAL STREAMING FUNCTIONS *********************************************/
 /******************************************************************************/
@@ -1791,6 +2037,8 @@ traceResult xTraceGetEventBuffer(void** ppvBuffer, TraceUnsignedBaseType_t * pui
 #define xTraceInitialize() (TRC_SUCCESS)
 #define xTraceEnable(x) ((void)(x), TRC_SUCCESS)
 #define xTraceDisable() (TRC_SUCCESS)
+#define xTraceTrigger() (TRC_SUCCESS)
+#define xTraceProfilerSample(pvPC) ((void)(pvPC), TRC_SUCCESS)
 #define xTraceStringRegister(x, y) ((void)(x), (void)y, TRC_SUCCESS) /* Comma operator in parenthesis is used to avoid "unused variable" compiler warnings and return 0 in a single statement */
 #define xTracePrint(chn, ...) ((void)(chn), TRC_SUCCESS)
 #define xTracePrintF(chn, fmt, ...) ((void)(chn), (void)(fmt), TRC_SUCCESS) /* Comma operator is used to avoid "unused variable" compiler warnings in a single statement */
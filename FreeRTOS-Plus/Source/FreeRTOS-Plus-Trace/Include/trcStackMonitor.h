@@ -78,6 +78,8 @@ traceResult xTraceStackMonitorRemove(void* pvTask);
 /**
  * @brief Gets trace stack monitor tread/task at index.
  * 
+ * The low water mark is all ones until the task has been reported once.
+ * 
  * @param[in] uiIndex Index.
  * @param[in] ppvTask Task/Thread.
  * @param[out] puxLowWaterMark Low water mark.
@@ -94,6 +96,10 @@ traceResult xTraceStackMonitorGetAtIndex(uint32_t uiIndex, void** ppvTask, Trace
  * for TRC_CFG_STACK_MONITOR_MAX_REPORTS number of registered
  * tasks/threads.
  * 
+ * The stacks are scanned with the scheduler suspended but outside the
+ * recorder's critical section, so interrupts aren't kept disabled for
+ * the scan.
+ * 
  * @retval TRC_FAIL Failure
  * @retval TRC_SUCCESS Success
  */
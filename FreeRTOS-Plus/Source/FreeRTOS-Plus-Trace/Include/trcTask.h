@@ -168,10 +168,12 @@ traceResult xTraceTaskSetPriorityWithoutHandle(void* pvTask, TraceUnsignedBaseTy
  */
 traceResult xTraceTaskSwitch(void* pvTask, TraceUnsignedBaseType_t uxPriority);
 
-#if (TRC_CFG_INCLUDE_READY_EVENTS == 1)
+#if (TRC_CFG_INCLUDE_READY_EVENTS == 1) || (TRC_CFG_ENABLE_TASK_STATS == 1)
 /**
  * @brief Registers trace task ready event.
  * 
+ * The event is only stored if TRC_CFG_INCLUDE_READY_EVENTS is 1.
+ * 
  * @param[in] pvTask Task.
  * 
  * @retval TRC_FAIL Failure
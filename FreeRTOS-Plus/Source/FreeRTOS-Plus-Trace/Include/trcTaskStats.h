@@ -0,0 +1,197 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+/**
+ * @file
+ *
+ * @brief Public trace task statistics APIs.
+ */
+
+#ifndef TRC_TASK_STATS_H
+#define TRC_TASK_STATS_H
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <stdint.h>
+#include <trcTypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup trace_task_stats_apis Trace Task Statistics APIs
+ * @ingroup trace_recorder_apis
+ * @{
+ */
+
+#if (TRC_CFG_ENABLE_TASK_STATS == 1)
+
+/**
+ * @brief The statistics of one task.
+ *
+ * All times are in timer counts (TRC_HWTC_COUNT), at the timestamp frequency,
+ * TRC_HWTC_FREQ_HZ unless set by xTraceTimestampSetFrequency(...).
+ *
+ * The latency is the time from the task becoming ready until it runs. Bin 0
+ * of the histogram counts the latencies below 2^TRC_CFG_TASK_STATS_LATENCY_SHIFT
+ * timer counts, every following bin twice the range of the previous one, and
+ * the last bin everything longer.
+ */
+typedef struct TraceTaskStats
+{
+	void* pvTask;									/**< The task */
+	uint64_t uiRunTime;								/**< Total run time */
+	uint32_t uiSwitchIns;							/**< Times the task was switched in */
+	uint32_t uiPreemptions;							/**< Times the task was switched in again without having been made ready, i.e. it was preempted or yielded */
+	uint32_t uiLatencyMax;							/**< Longest latency */
+	uint32_t uiLatencyBins[TRC_CFG_TASK_STATS_HISTOGRAM_BINS]; /**< Latency histogram */
+} TraceTaskStats_t;
+
+/**
+ * @internal Trace Task Statistics Entry Structure
+ */
+typedef struct TraceTaskStatsEntry
+{
+	TraceTaskStats_t xStats;
+	uint64_t uiReadyTime;
+	uint32_t uiFlags;
+} TraceTaskStatsEntry_t;
+
+/**
+ * @internal Trace Task Statistics Structure
+ */
+typedef struct TraceTaskStatsData
+{
+	TraceTaskStatsEntry_t xEntries[TRC_CFG_TASK_STATS_MAX_TASKS];
+	uint64_t uiSwitchInTime[TRC_CFG_CORE_COUNT];
+	void* pvCurrent[TRC_CFG_CORE_COUNT];
+	uint32_t uiEntryCount;
+} TraceTaskStatsData_t;
+
+/**
+ * @internal Trace Task Statistics Buffer Structure
+ */
+typedef struct TraceTaskStatsBuffer
+{
+	uint64_t buffer[(sizeof(TraceTaskStatsData_t) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+} TraceTaskStatsBuffer_t;
+
+/**
+ * @internal Initialize trace task statistics system.
+ *
+ * @param[in] pxBuffer Pointer to memory that will be used by the trace
+ * task statistics system.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceTaskStatsInitialize(TraceTaskStatsBuffer_t* pxBuffer);
+
+/**
+ * @internal Updates the statistics on a task switch. Called from
+ * xTraceTaskSwitch(...) whether or not the recorder is enabled.
+ *
+ * @param[in] pvTask The task being switched in.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceTaskStatsSwitch(void* pvTask);
+
+/**
+ * @internal Updates the statistics when a task becomes ready. Called from
+ * xTraceTaskReady(...) whether or not the recorder is enabled.
+ *
+ * @param[in] pvTask The task.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceTaskStatsReady(void* pvTask);
+
+/**
+ * @internal Removes a task from the statistics, freeing its slot. Called
+ * when the task is deleted.
+ *
+ * @param[in] pvTask The task.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceTaskStatsRemove(void* pvTask);
+
+/**
+ * @brief Gets the number of tasks with statistics.
+ *
+ * @param[out] puiCount Number of tasks.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceTaskStatsGetCount(uint32_t* puiCount);
+
+/**
+ * @brief Gets a copy of the statistics of the task at an index.
+ *
+ * The run time of a task that is running right now is included up to this
+ * call. Tasks are moved around when others are deleted, so the index of a
+ * task is only stable as long as no task is deleted.
+ *
+ * @param[in] uiIndex Index, below the count from xTraceTaskStatsGetCount(...).
+ * @param[out] pxStats The statistics.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceTaskStatsGetAtIndex(uint32_t uiIndex, TraceTaskStats_t* pxStats);
+
+/**
+ * @brief Clears the statistics of all tasks, to measure from now on.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceTaskStatsClear(void);
+
+#else /* (TRC_CFG_ENABLE_TASK_STATS == 1) */
+
+typedef struct TraceTaskStatsBuffer
+{
+	uint32_t buffer[1];
+} TraceTaskStatsBuffer_t;
+
+#define xTraceTaskStatsInitialize(pxBuffer) ((void)pxBuffer, TRC_SUCCESS)
+
+#define xTraceTaskStatsSwitch(pvTask) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2((void)(pvTask), TRC_SUCCESS)
+
+#define xTraceTaskStatsReady(pvTask) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2((void)(pvTask), TRC_SUCCESS)
+
+#define xTraceTaskStatsRemove(pvTask) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2((void)(pvTask), TRC_SUCCESS)
+
+#define xTraceTaskStatsGetCount(puiCount) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(puiCount) = 0, TRC_SUCCESS)
+
+#define xTraceTaskStatsGetAtIndex(uiIndex, pxStats) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)(uiIndex), (void)(pxStats), TRC_FAIL)
+
+#define xTraceTaskStatsClear() TRC_COMMA_EXPR_TO_STATEMENT_EXPR_1(TRC_SUCCESS)
+
+#endif /* (TRC_CFG_ENABLE_TASK_STATS == 1) */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
+
+#endif /* TRC_TASK_STATS_H */
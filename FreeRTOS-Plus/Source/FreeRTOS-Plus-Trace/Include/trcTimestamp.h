@@ -47,6 +47,23 @@ typedef struct TraceTimestamp
 
 extern TraceTimestamp_t* pxTraceTimestamp;
 
+/* How the timer wraparounds are kept track of */
+#define TRC_TIMESTAMP_WRAPAROUNDS_EVENT 0	/* Detected on every timestamp */
+#define TRC_TIMESTAMP_WRAPAROUNDS_TICK 1	/* Detected on every OS tick, see TRC_CFG_TIMESTAMP_WRAPAROUNDS_ON_TICK */
+#define TRC_TIMESTAMP_WRAPAROUNDS_HWTC 2	/* Read from the hardware port, see TRC_HWTC_COUNT_WRAPAROUNDS */
+
+#if defined(TRC_HWTC_COUNT_WRAPAROUNDS)
+#define TRC_TIMESTAMP_WRAPAROUNDS TRC_TIMESTAMP_WRAPAROUNDS_HWTC
+#elif ((TRC_CFG_TIMESTAMP_WRAPAROUNDS_ON_TICK) == 1)
+#define TRC_TIMESTAMP_WRAPAROUNDS TRC_TIMESTAMP_WRAPAROUNDS_TICK
+#else
+#define TRC_TIMESTAMP_WRAPAROUNDS TRC_TIMESTAMP_WRAPAROUNDS_EVENT
+#endif
+
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) != TRC_TIMESTAMP_WRAPAROUNDS_EVENT) && ((TRC_HWTC_TYPE == TRC_OS_TIMER_INCR) || (TRC_HWTC_TYPE == TRC_OS_TIMER_DECR))
+#error "The wraparounds of an OS timer are the OS ticks, use a free-running or custom timer with TRC_CFG_TIMESTAMP_WRAPAROUNDS_ON_TICK or TRC_HWTC_COUNT_WRAPAROUNDS."
+#endif
+
 #define TRC_TIMESTAMP_RECORD_SIZE (sizeof(TraceTimestamp_t))
 
 /**
@@ -68,6 +85,47 @@ typedef struct TraceTimestampBuffer
  */
 traceResult xTraceTimestampInitialize(TraceTimestampBuffer_t *pxBuffer);
 
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_TICK)
+
+/**
+ * @internal Gets the timer wraparounds counted on the OS tick, plus one if
+ * the timer has wrapped around since.
+ * 
+ * @param[out] puiTimerWraparounds Timer wraparounds.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult prvTraceTimestampGetWraparounds(uint32_t* puiTimerWraparounds);
+
+#endif
+
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) != TRC_TIMESTAMP_WRAPAROUNDS_EVENT)
+
+/**
+ * @internal Sets the OS tick count, and brings the timer wraparounds and
+ * latest timestamp up to date.
+ * 
+ * @param[in] uiOsTickCount OS tick count.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult prvTraceTimestampSetOsTickCount(uint32_t uiOsTickCount);
+
+#endif
+
+/**
+ * @brief Gets the current time in timer counts as a 64-bit value, from the
+ * timer and its wraparounds, for measuring durations on the target.
+ * 
+ * @param[out] puiTime Time.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceTimestampGet64(uint64_t* puiTime);
+
 #if ((TRC_CFG_USE_TRACE_ASSERT) == 1)
 
 /**
@@ -160,7 +218,9 @@ traceResult xTraceTimestampGetOsTickCount(uint32_t *puiOsTickCount);
  * @retval TRC_FAIL Failure
  * @retval TRC_SUCCESS Success
  */
-#if ((TRC_HWTC_TYPE == TRC_FREE_RUNNING_32BIT_INCR) || (TRC_HWTC_TYPE == TRC_CUSTOM_TIMER_INCR))
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) != TRC_TIMESTAMP_WRAPAROUNDS_EVENT)
+#define xTraceTimestampGet(puiTimestamp) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(puiTimestamp) = TRC_HWTC_COUNT, TRC_SUCCESS)
+#elif ((TRC_HWTC_TYPE == TRC_FREE_RUNNING_32BIT_INCR) || (TRC_HWTC_TYPE == TRC_CUSTOM_TIMER_INCR))
 #define xTraceTimestampGet(puiTimestamp) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_4(*(puiTimestamp) = TRC_HWTC_COUNT, (*(puiTimestamp) < pxTraceTimestamp->latestTimestamp) ? pxTraceTimestamp->wraparounds++ : 0, pxTraceTimestamp->latestTimestamp = *(puiTimestamp), TRC_SUCCESS)
 #elif ((TRC_HWTC_TYPE == TRC_FREE_RUNNING_32BIT_DECR) || (TRC_HWTC_TYPE == TRC_CUSTOM_TIMER_DECR))
 #define xTraceTimestampGet(puiTimestamp) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_4(*(puiTimestamp) = TRC_HWTC_COUNT, (*(puiTimestamp) > pxTraceTimestamp->latestTimestamp) ? pxTraceTimestamp->wraparounds++ : 0, pxTraceTimestamp->latestTimestamp = *(puiTimestamp), TRC_SUCCESS)
@@ -176,7 +236,13 @@ traceResult xTraceTimestampGetOsTickCount(uint32_t *puiOsTickCount);
  * @retval TRC_FAIL Failure
  * @retval TRC_SUCCESS Success
  */
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_HWTC)
+#define xTraceTimestampGetWraparounds(puiTimerWraparounds) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(puiTimerWraparounds) = TRC_HWTC_COUNT_WRAPAROUNDS, TRC_SUCCESS)
+#elif ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_TICK)
+#define xTraceTimestampGetWraparounds prvTraceTimestampGetWraparounds
+#else
 #define xTraceTimestampGetWraparounds(puiTimerWraparounds) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(puiTimerWraparounds) = pxTraceTimestamp->wraparounds, TRC_SUCCESS)
+#endif
 
 /**
  * @brief Sets trace timestamp frequency. 
@@ -206,7 +272,11 @@ traceResult xTraceTimestampGetOsTickCount(uint32_t *puiOsTickCount);
  * @retval TRC_FAIL Failure
  * @retval TRC_SUCCESS Success
  */
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) != TRC_TIMESTAMP_WRAPAROUNDS_EVENT)
+#define xTraceTimestampSetOsTickCount prvTraceTimestampSetOsTickCount
+#else
 #define xTraceTimestampSetOsTickCount(uiOsTickCount) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(pxTraceTimestamp->osTickCount = uiOsTickCount, TRC_SUCCESS)
+#endif
 
 /**
  * @brief Gets trace timestamp frequency.
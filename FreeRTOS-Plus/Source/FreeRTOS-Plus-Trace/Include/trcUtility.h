@@ -40,12 +40,14 @@
 	#define TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3(e1, e2, e3)			({e1; e2; e3;})
 	#define TRC_COMMA_EXPR_TO_STATEMENT_EXPR_4(e1, e2, e3, e4)		({e1; e2; e3; e4;})
 	#define TRC_COMMA_EXPR_TO_STATEMENT_EXPR_5(e1, e2, e3, e4, e5)	({e1; e2; e3; e4; e5;})
+	#define TRC_COMMA_EXPR_TO_STATEMENT_EXPR_6(e1, e2, e3, e4, e5, e6)	({e1; e2; e3; e4; e5; e6;})
 #else
 	#define TRC_COMMA_EXPR_TO_STATEMENT_EXPR_1(e1)					(e1)
 	#define TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(e1, e2)				(e1, e2)
 	#define TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3(e1, e2, e3)			(e1, e2, e3)
 	#define TRC_COMMA_EXPR_TO_STATEMENT_EXPR_4(e1, e2, e3, e4)		(e1, e2, e3, e4)
 	#define TRC_COMMA_EXPR_TO_STATEMENT_EXPR_5(e1, e2, e3, e4, e5)	(e1, e2, e3, e4, e5)
+	#define TRC_COMMA_EXPR_TO_STATEMENT_EXPR_6(e1, e2, e3, e4, e5, e6)	(e1, e2, e3, e4, e5, e6)
 #endif
 
 #endif /* TRC_UTILITY_H */
@@ -204,7 +204,9 @@ extern "C" {
  * In streaming mode, this also affects the trace data transfer if you are using
  * a stream port leveraging the internal buffer (like TCP/IP). A shorter delay
  * increases the CPU load of TzCtrl somewhat, but may improve the performance of
- * of the trace streaming, especially if the trace buffer is small.
+ * of the trace streaming, especially if the trace buffer is small. With
+ * TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY (trcStreamingConfig.h) this is instead the
+ * longest delay, and TzCtrl wakes up earlier when events are produced quickly.
  */
 #define TRC_CFG_CTRL_TASK_DELAY 2
 
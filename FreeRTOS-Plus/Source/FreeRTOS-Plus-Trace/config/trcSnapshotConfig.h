@@ -49,6 +49,25 @@ extern "C" {
  */
 #define TRC_CFG_EVENT_BUFFER_SIZE 1000
 
+/**
+ * @def TRC_CFG_SNAPSHOT_COMPACT
+ * @brief Macro which should be defined as either zero (0) or one (1).
+ *
+ * If this is one (1), the event buffer (still TRC_CFG_EVENT_BUFFER_SIZE * 4
+ * bytes) holds variable length records instead of 4-byte records, so that
+ * it holds a longer history in the same RAM. Each record keeps the event
+ * code and parameters, while the differential timestamp is packed into as
+ * few bytes as it needs. The XTS records otherwise needed for timestamps
+ * that don't fit in 8 or 16 bits are folded into the event they belong to.
+ *
+ * Tracealyzer can't read this layout directly. Convert the dump to the
+ * standard layout first, with the host tool in extras/TraceAnalyzer:
+ *	trcAnalyzer -o Expanded.dump Trace.dump
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_SNAPSHOT_COMPACT 0
+
 /**
  * @def TRC_CFG_INCLUDE_FLOAT_SUPPORT
  * @brief Macro which should be defined as either zero (0) or one (1).
@@ -85,6 +104,21 @@ extern "C" {
 #error "TRC_CFG_SYMBOL_TABLE_SIZE may not be zero!"
 #endif
 
+/**
+ * @def TRC_CFG_SYMBOL_CACHE_SIZE
+ * @brief Macro which should be defined as an integer value.
+ *
+ * This defines the number of slots in a cache that maps string addresses to
+ * symbol table entries. User event channels and vTracePrintF format strings
+ * that are used repeatedly are then found without computing their checksum,
+ * searching the symbol table or entering a critical section. Each slot uses
+ * 8 bytes (on 32-bit targets) outside of the trace data. Strings that share a
+ * slot only make each other take the slower path; set to 0 to disable.
+ *
+ * Default value is 16.
+ */
+#define TRC_CFG_SYMBOL_CACHE_SIZE 16
+
 /******************************************************************************
  *** ADVANCED SETTINGS ********************************************************
  ******************************************************************************
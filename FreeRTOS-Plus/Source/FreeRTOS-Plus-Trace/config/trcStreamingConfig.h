@@ -27,6 +27,11 @@ extern "C" {
  * If this value is too small, not all symbol names will be stored and the
  * trace display will be affected. In that case, there will be warnings
  * (as User Events) from TzCtrl task, that monitors this.
+ *
+ * The most entries in use at once and the number of objects that didn't fit
+ * are read using xTraceDiagnosticsGet(...) with
+ * TRC_DIAGNOSTICS_ENTRY_SLOTS_HIGH_WATER_MARK and
+ * TRC_DIAGNOSTICS_ENTRY_SLOTS_MISSED, for sizing this after a test run.
  */
 #define TRC_CFG_ENTRY_SLOTS 50
 
@@ -44,6 +49,289 @@ extern "C" {
  */
 #define TRC_CFG_ENTRY_SYMBOL_MAX_LENGTH 32
 
+/**
+ * @def TRC_CFG_ENTRY_RECYCLE
+ * @brief When the entry table is full, gives a new object the entry of an
+ * object that hasn't been used for a while, instead of not tracing the new
+ * object. This suits applications that keep many short-lived queues, timers
+ * and the like, as these are then traced with a smaller TRC_CFG_ENTRY_SLOTS.
+ *
+ * Only entries of objects registered by address, such as the kernel objects,
+ * are recycled. Their names have been sent already, so the trace display is
+ * not affected while tracing. The recycled object is however no longer known
+ * to the recorder, so its later state changes and delete event are not
+ * traced, and it has no name in traces started after it was recycled. Don't
+ * use this if object handles from xTraceObjectRegister(...) with an address
+ * are kept, since the handle may then be given to another object.
+ *
+ * The number of recycled entries is read using xTraceDiagnosticsGet(...) with
+ * TRC_DIAGNOSTICS_ENTRY_SLOTS_RECYCLED.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_ENTRY_RECYCLE 0
+
+/**
+ * @def TRC_CFG_OBJECT_NAME_CACHE_SIZE
+ * @brief The number of objects whose last sent name is remembered, so that
+ * the name event is not sent again when an object gets the same name as the
+ * last one sent for its address. This is typically the case when objects
+ * are deleted and created again with the same name, or when a name is set
+ * again. The names in the entry table sent on start count as sent.
+ *
+ * Objects are looked up by address in a direct-mapped cache, so an object
+ * whose slot was taken by another object just gets its name sent again.
+ * Names are compared by a 32-bit hash. Each slot takes a pointer and 4 bytes.
+ *
+ * Default value is 0, which sends every name.
+ */
+#define TRC_CFG_OBJECT_NAME_CACHE_SIZE 0
+
+/**
+ * @def TRC_CFG_USE_EVENT_FILTER
+ * @brief Enables a per-event-code filter, so that individual event codes can be
+ * disabled and enabled at runtime using xTraceEventFilterSet(...) and
+ * xTraceEventFilterSetAll(...), or from the host using the CMD_SET_EVENT_FILTER
+ * command. A disabled event is dropped when it begins, before any of its
+ * parameters are written.
+ *
+ * This adds 512 bytes to the recorder data.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_USE_EVENT_FILTER 0
+
+/**
+ * @def TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY
+ * @brief Makes TRC_CFG_CTRL_TASK_DELAY the longest delay between loops of the
+ * TzCtrl task rather than a fixed one. After each loop, TzCtrl measures how
+ * fast the internal buffer was filled and sleeps until it is expected to be
+ * half full, but never longer than TRC_CFG_CTRL_TASK_DELAY and never shorter
+ * than one tick. The delay shrinks at once when the event rate goes up, and
+ * at most doubles per loop when it goes down.
+ *
+ * This lets TRC_CFG_CTRL_TASK_DELAY be set much longer, so that an idle system
+ * stays longer in tickless idle, while bursts are still transferred in time.
+ * Only has an effect for stream ports that use the internal buffer.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY 0
+
+/**
+ * @def TRC_CFG_TIMESTAMP_WRAPAROUNDS_ON_TICK
+ * @brief Counts the wraparounds of the timestamp counter on every OS tick,
+ * instead of checking for one on every timestamp. Taking a timestamp is then
+ * only a read of the counter and writes no shared state, so events on
+ * different cores don't contend for the wraparound tracking.
+ *
+ * This requires a free-running counter (TRC_FREE_RUNNING_32BIT_INCR/DECR or
+ * TRC_CUSTOM_TIMER_INCR/DECR), such as the DWT cycle counter on ARM Cortex-M,
+ * that wraps around less often than once per OS tick, also in tickless idle.
+ * On multi-core targets the counter must also be shared by all cores, or be
+ * kept in sync between them. It has no effect if the hardware port provides
+ * the wraparounds itself, see TRC_HWTC_COUNT_WRAPAROUNDS in trcHardwarePort.h.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_TIMESTAMP_WRAPAROUNDS_ON_TICK 0
+
+/**
+ * @def TRC_CFG_ENABLE_RECORDER_METRICS
+ * @brief Makes the recorder measure itself: the events and bytes written, the
+ * events dropped because the buffer was full (skipped, or overwritten in
+ * overwrite mode), the highest fill level of the internal buffer, and the time
+ * spent in the critical sections of the recorder. The values are read using
+ * xTraceDiagnosticsGet(...), and are reported periodically as User Events on
+ * the "#Metrics" channel, see TRC_CFG_RECORDER_METRICS_REPORT_PERIOD.
+ *
+ * This is meant for sizing TRC_CFG_STREAM_PORT_BUFFER_SIZE and measuring the
+ * overhead of the recorder. It reads the timer twice more for every event.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_ENABLE_RECORDER_METRICS 0
+
+/**
+ * @def TRC_CFG_RECORDER_METRICS_REPORT_PERIOD
+ * @brief The number of OS ticks between the metrics reports from the TzCtrl
+ * task, if TRC_CFG_ENABLE_RECORDER_METRICS is 1. Each report gives the event
+ * and byte rates per second since the last report, the dropped events, the
+ * buffer high-water mark in bytes, and the longest and the total time in
+ * critical sections in microseconds. Set to 0 to not report at all.
+ *
+ * Default value is 1000.
+ */
+#define TRC_CFG_RECORDER_METRICS_REPORT_PERIOD 1000
+
+/**
+ * @def TRC_CFG_ENABLE_PROFILER
+ * @brief Enables the sampling profiler, xTraceProfilerSample(...). Each call
+ * from a periodic timer interrupt stores one sample with the current task and
+ * the interrupted program counter, through the stream port like any event.
+ *
+ * For the lowest overhead, combine it with TRC_CFG_SCHEDULING_ONLY or the
+ * event filter, so that the samples and the task switches are the main events.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_ENABLE_PROFILER 0
+
+/**
+ * @def TRC_CFG_ENABLE_TASK_STATS
+ * @brief Makes the recorder keep statistics per task on the target: the total
+ * run time, the number of switch-ins and preemptions, and a histogram of the
+ * latency from the task becoming ready until it runs. They are kept from
+ * xTraceInitialize(), also when no trace is being streamed, and are read
+ * using xTraceTaskStatsGetAtIndex(...).
+ *
+ * This reads the timer on every task switch and every time a task is made
+ * ready, also when TRC_CFG_INCLUDE_READY_EVENTS is 0.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_ENABLE_TASK_STATS 0
+
+/**
+ * @def TRC_CFG_TASK_STATS_MAX_TASKS
+ * @brief The number of tasks to keep statistics for, if
+ * TRC_CFG_ENABLE_TASK_STATS is 1. Tasks are added as they first run or become
+ * ready, and removed when deleted. Tasks that don't fit are not counted.
+ *
+ * Default value is 10.
+ */
+#define TRC_CFG_TASK_STATS_MAX_TASKS 10
+
+/**
+ * @def TRC_CFG_TASK_STATS_HISTOGRAM_BINS
+ * @brief The number of bins in the latency histogram of each task.
+ *
+ * Default value is 8.
+ */
+#define TRC_CFG_TASK_STATS_HISTOGRAM_BINS 8
+
+/**
+ * @def TRC_CFG_TASK_STATS_LATENCY_SHIFT
+ * @brief Sets the range of the latency histograms. The first bin counts the
+ * latencies below 2 to the power of this many timer counts, every following
+ * bin twice the range of the previous one, and the last bin everything longer.
+ * With the defaults and a 100 MHz timer, the bins end at about 10, 20, 41,
+ * 82, 164, 328 and 655 microseconds.
+ *
+ * Default value is 10.
+ */
+#define TRC_CFG_TASK_STATS_LATENCY_SHIFT 10
+
+/**
+ * @def TRC_CFG_ENABLE_HEAP_PROFILER
+ * @brief Makes the recorder profile the heap on the target: per call site
+ * (the caller of pvPortMalloc) the allocations, bytes, and the blocks and
+ * bytes still live, plus a histogram of the allocation sizes. This is kept
+ * from xTraceInitialize(), also when no trace is being streamed, and is read
+ * using xTraceHeapProfilerGetCallSite(...). While tracing, it is reported as
+ * User Events on the "#Heap" channel, see TRC_CFG_HEAP_PROFILER_REPORT_PERIOD.
+ *
+ * Set TRC_CFG_INCLUDE_MEMMANG_EVENTS (trcConfig.h) to 0 to only get the
+ * reports, instead of an event for every malloc and free.
+ *
+ * The call site is found with TRC_CFG_HEAP_PROFILER_GET_CALL_SITE(), which is
+ * __builtin_return_address(0) for GCC and Clang. For other compilers, define
+ * it in trcConfig.h, or all allocations are counted as call site 0.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_ENABLE_HEAP_PROFILER 0
+
+/**
+ * @def TRC_CFG_HEAP_PROFILER_MAX_CALL_SITES
+ * @brief The number of call sites that are told apart, if
+ * TRC_CFG_ENABLE_HEAP_PROFILER is 1. When all but one are used, the others
+ * share the last one, reported as call site 0.
+ *
+ * Default value is 16.
+ */
+#define TRC_CFG_HEAP_PROFILER_MAX_CALL_SITES 16
+
+/**
+ * @def TRC_CFG_HEAP_PROFILER_MAX_LIVE_ALLOCATIONS
+ * @brief The number of live allocations that are tracked, so that their frees
+ * are attributed to the call site that allocated them. Allocations beyond this
+ * are counted, but not as live.
+ *
+ * Default value is 64.
+ */
+#define TRC_CFG_HEAP_PROFILER_MAX_LIVE_ALLOCATIONS 64
+
+/**
+ * @def TRC_CFG_HEAP_PROFILER_REPORT_PERIOD
+ * @brief The number of OS ticks between the heap profile reports from the
+ * TzCtrl task. Each report gives the live blocks and bytes, the size
+ * histogram, and the call sites that allocated or freed since the last
+ * report. Set to 0 to not report at all.
+ *
+ * Default value is 1000.
+ */
+#define TRC_CFG_HEAP_PROFILER_REPORT_PERIOD 1000
+
+/**
+ * @def TRC_CFG_ENABLE_DURATION_STATS
+ * @brief Makes the recorder keep statistics on the target of how long the
+ * intervals (xTraceIntervalStart/Stop) last and how long the state machines
+ * stay in each state: the count, min, max, total and a log2 histogram of the
+ * durations. They are kept from xTraceInitialize(), also when no trace is
+ * being streamed, and are read using xTraceDurationStatsGet(...) with the
+ * interval or state handle. xTraceDurationStatsGetPercentile(...) gives
+ * percentiles from the histogram, e.g., for soak tests.
+ *
+ * This reads the timer on every interval start and stop and state change.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_ENABLE_DURATION_STATS 0
+
+/**
+ * @def TRC_CFG_DURATION_STATS_MAX_SLOTS
+ * @brief The number of intervals and state machine states to keep duration
+ * statistics for, if TRC_CFG_ENABLE_DURATION_STATS is 1. They are added as
+ * they are first started or entered. Those that don't fit are not counted.
+ *
+ * Default value is 8.
+ */
+#define TRC_CFG_DURATION_STATS_MAX_SLOTS 8
+
+/**
+ * @def TRC_CFG_DURATION_STATS_HISTOGRAM_BINS
+ * @brief The number of bins in the duration histograms. Bin n counts the
+ * durations from 2^n up to 2^(n+1) timer counts, and the last bin everything
+ * longer. 32 bins cover all durations, fewer bins save 4 bytes each per slot.
+ *
+ * Default value is 32.
+ */
+#define TRC_CFG_DURATION_STATS_HISTOGRAM_BINS 32
+
+/**
+ * @def TRC_CFG_STREAMING_COMPACT
+ * @brief Sends the events in a compact format, for stream ports whose
+ * bandwidth limits the event rate, such as J-Link RTT and ITM. Instead of a
+ * 32-bit timestamp and 32-bit parameters, each event has the timestamp as a
+ * variable length delta from the previous event on the same core, and each
+ * parameter in 1, 2 or 4 bytes. The event count is only sent when it isn't
+ * one more than the previous. A kernel event with one parameter typically
+ * takes 6 to 8 bytes instead of 12. The format is described in trcEvent.c.
+ *
+ * The header tells that the stream is compact, but Tracealyzer only reads the
+ * standard format. Convert the stream with "trcAnalyzer -o OUT FILE", see
+ * extras/TraceAnalyzer, and open OUT in Tracealyzer.
+ *
+ * The events are built in RAM and encoded when they end, which takes
+ * TRC_MAX_BLOB_SIZE bytes per core and ISR nesting level. The encoded events
+ * aren't 4-byte aligned, so the RingBuffer stream port and the FanOut ring
+ * buffer can't be used.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_STREAMING_COMPACT 0
+
 #ifdef __cplusplus
 }
 #endif
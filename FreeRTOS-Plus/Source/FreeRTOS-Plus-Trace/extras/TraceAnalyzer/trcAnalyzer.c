@@ -0,0 +1,1816 @@
+/*
+ * Trace Recorder for Tracealyzer v4.6.0
+ * Copyright 2021 Percepio AB
+ * www.percepio.com
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host side analyzer for traces saved by the recorder, e.g. the snapshot
+ * dump written by prvSaveTraceFile() in the Posix/Win32 demos, or a stream
+ * written by the File stream port. Reports per task CPU usage, response time
+ * percentiles and blocking time per kernel object as CSV or JSON.
+ *
+ * Several streams can also be given, one per core, as written by the J-Link
+ * RTT stream port with TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_PER_CORE enabled.
+ * They are then merged into one stream by timestamp before being analyzed,
+ * and the merged stream can be saved for Tracealyzer.
+ *
+ * This is built and run on the host, not on the target. It does not include
+ * the recorder headers since the layouts it reads depend on the target
+ * configuration, which is instead read from the trace itself where possible.
+ * The host and the target are assumed to be little endian.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TRC_ANALYZER_NAME_LENGTH 32
+#define TRC_ANALYZER_MAX_CORES 16
+#define TRC_ANALYZER_MAX_LIMITS 32
+
+/* Snapshot event codes, see trcKernelPort.h */
+#define SNAPSHOT_DIV_XPS						0x01
+#define SNAPSHOT_DIV_TASK_READY					0x02
+#define SNAPSHOT_DIV_NEW_TIME					0x03
+#define SNAPSHOT_TS_ISR_BEGIN					0x04
+#define SNAPSHOT_TS_ISR_RESUME					0x05
+#define SNAPSHOT_TS_TASK_BEGIN					0x06
+#define SNAPSHOT_TS_TASK_RESUME					0x07
+#define SNAPSHOT_CREATE_OBJ_TRCFAILED_MUTEX		0x42
+#define SNAPSHOT_RECEIVE_TRCBLOCK				0x68
+#define SNAPSHOT_SEND_TRCBLOCK					0x70
+#define SNAPSHOT_TASK_DELAY_UNTIL				0x88
+#define SNAPSHOT_TASK_DELAY						0x89
+#define SNAPSHOT_TASK_SUSPEND					0x8A
+#define SNAPSHOT_TASK_PRIORITY_SET				0x8D
+#define SNAPSHOT_TASK_PRIORITY_DISINHERIT		0x8F
+#define SNAPSHOT_MEM_MALLOC_SIZE				0x94
+#define SNAPSHOT_MEM_FREE_SIZE					0x96
+#define SNAPSHOT_USER_EVENT						0x98
+#define SNAPSHOT_USER_EVENT_LAST				0xA7
+#define SNAPSHOT_XTS8							0xA8
+#define SNAPSHOT_XTS16							0xA9
+#define SNAPSHOT_LOW_POWER_BEGIN				0xAC
+#define SNAPSHOT_LOW_POWER_END					0xAD
+#define SNAPSHOT_TIMER_CREATE					0xB0
+#define SNAPSHOT_TIMER_CREATE_TRCFAILED			0xB9
+#define SNAPSHOT_TIMER_STOP_FROM_ISR_TRCFAILED	0xC1
+#define SNAPSHOT_EVENT_GROUP_CREATE				0xC2
+#define SNAPSHOT_EVENT_GROUP_CREATE_TRCFAILED	0xC3
+#define SNAPSHOT_EVENT_GROUP_SYNC_TRCBLOCK		0xC4
+#define SNAPSHOT_EVENT_GROUP_WAIT_BITS_TRCBLOCK	0xC6
+#define SNAPSHOT_EVENT_GROUP_DELETE_OBJ			0xCB
+#define SNAPSHOT_TASK_INSTANCE_FINISHED_DIRECT	0xD1
+#define SNAPSHOT_TASK_NOTIFY					0xD2
+#define SNAPSHOT_TASK_NOTIFY_TAKE				0xD3
+#define SNAPSHOT_TASK_NOTIFY_TAKE_TRCBLOCK		0xD4
+#define SNAPSHOT_TASK_NOTIFY_WAIT_TRCBLOCK		0xD7
+#define SNAPSHOT_TASK_NOTIFY_WAIT_TRCFAILED		0xD8
+#define SNAPSHOT_PEEK_TRCBLOCK					0xDC
+#define SNAPSHOT_MEM_MALLOC_SIZE_TRCFAILED		0xE8
+
+/* Snapshot object classes, see trcKernelPort.h */
+#define SNAPSHOT_CLASS_QUEUE					0
+#define SNAPSHOT_CLASS_SEMAPHORE				1
+#define SNAPSHOT_CLASS_MUTEX					2
+#define SNAPSHOT_CLASS_TASK						3
+#define SNAPSHOT_CLASS_ISR						4
+#define SNAPSHOT_CLASS_EVENTGROUP				6
+#define SNAPSHOT_CLASS_STREAMBUFFER				7
+#define SNAPSHOT_CLASS_MESSAGEBUFFER			8
+
+/* Streaming event codes, see trcKernelPort.h */
+#define PSF_EVENT_TRACE_START					0x01
+#define PSF_EVENT_OBJ_NAME						0x03
+#define PSF_EVENT_DEFINE_ISR					0x07
+#define PSF_EVENT_TASK_READY					0x30
+#define PSF_EVENT_ISR_BEGIN						0x33
+#define PSF_EVENT_ISR_RESUME					0x34
+#define PSF_EVENT_TASK_ACTIVATE					0x37
+#define PSF_EVENT_QUEUE_SEND_BLOCK				0x56
+#define PSF_EVENT_SEMAPHORE_GIVE_BLOCK			0x57
+#define PSF_EVENT_MUTEX_GIVE_BLOCK				0x58
+#define PSF_EVENT_QUEUE_RECEIVE_BLOCK			0x66
+#define PSF_EVENT_SEMAPHORE_TAKE_BLOCK			0x67
+#define PSF_EVENT_MUTEX_TAKE_BLOCK				0x68
+#define PSF_EVENT_QUEUE_PEEK_BLOCK				0x76
+#define PSF_EVENT_SEMAPHORE_PEEK_BLOCK			0x77
+#define PSF_EVENT_MUTEX_PEEK_BLOCK				0x78
+#define PSF_EVENT_TASK_DELAY_UNTIL				0x79
+#define PSF_EVENT_TASK_DELAY					0x7A
+#define PSF_EVENT_TASK_SUSPEND					0x7B
+#define PSF_EVENT_EVENTGROUP_SYNC_BLOCK			0xB6
+#define PSF_EVENT_EVENTGROUP_WAITBITS_BLOCK		0xB7
+#define PSF_EVENT_QUEUE_SEND_FRONT_BLOCK		0xC2
+#define PSF_EVENT_TASK_NOTIFY_WAIT_BLOCK		0xCB
+#define PSF_EVENT_STREAMBUFFER_SEND_BLOCK		0xD4
+#define PSF_EVENT_STREAMBUFFER_RECEIVE_BLOCK	0xD7
+#define PSF_EVENT_MESSAGEBUFFER_SEND_BLOCK		0xDF
+#define PSF_EVENT_MESSAGEBUFFER_RECEIVE_BLOCK	0xE2
+#define PSF_EVENT_MUTEX_TAKE_RECURSIVE_BLOCK	0xF6
+
+#define TRACE_PSF_ENDIANESS_IDENTIFIER ((uint32_t)0x50534600)
+
+/* Header options, see xTraceHeaderInitialize() */
+#define PSF_OPTION_COMPACT						0x08
+
+/* Compact event flags and parameter tags, see trcEvent.c */
+#define PSF_COMPACT_FLAG_RECORD					0x80
+#define PSF_COMPACT_FLAG_ABSOLUTE				0x01
+#define PSF_COMPACT_FLAG_COUNT					0x02
+#define PSF_COMPACT_TAG_8						0
+#define PSF_COMPACT_TAG_16						1
+#define PSF_COMPACT_TAG_LOW_16					2
+#define PSF_COMPACT_TAG_32						3
+
+typedef enum TraceAnalyzerKind
+{
+	TRC_KIND_UNKNOWN = 0,
+	TRC_KIND_TASK,
+	TRC_KIND_ISR,
+	TRC_KIND_QUEUE,
+	TRC_KIND_SEMAPHORE,
+	TRC_KIND_MUTEX,
+	TRC_KIND_EVENTGROUP,
+	TRC_KIND_STREAMBUFFER,
+	TRC_KIND_MESSAGEBUFFER,
+	TRC_KIND_NOTIFY
+} TraceAnalyzerKind_t;
+
+static const char* const pszKindNames[] = { "unknown", "task", "isr", "queue", "semaphore", "mutex", "eventgroup", "streambuffer", "messagebuffer", "notify" };
+
+typedef struct TraceAnalyzerObject
+{
+	uint64_t uxHandle;
+	TraceAnalyzerKind_t xKind;
+	char szName[TRC_ANALYZER_NAME_LENGTH];
+
+	/* Task and ISR */
+	uint64_t uxRunTime;
+	uint32_t uiActivations;
+
+	/* Task only */
+	uint32_t isReady;				/* Ready and not yet blocked */
+	uint64_t uxReadyTime;
+	uint32_t isBlocked;
+	int32_t iBlockedOn;				/* Object index */
+	uint64_t uxBlockedTime;
+	uint64_t* puxResponseTimes;
+	uint32_t uiResponseCount;
+	uint32_t uiResponseCapacity;
+
+	/* Objects that tasks block on */
+	uint32_t uiBlockCount;
+	uint64_t uxBlockTime;
+	uint64_t uxBlockMax;
+} TraceAnalyzerObject_t;
+
+typedef struct TraceAnalyzerStream
+{
+	const uint8_t* puiData;
+	uint32_t uiSize;
+	uint32_t uiOffset;							/* Of the next event */
+} TraceAnalyzerStream_t;
+
+/* The previous compact event of a core */
+typedef struct TraceAnalyzerCompactCore
+{
+	uint32_t uiTS;
+	uint32_t uiCount;
+	uint32_t uiHigh;							/* Upper half of the last full parameter */
+	uint32_t hasBase;							/* Set once an absolute event is seen */
+} TraceAnalyzerCompactCore_t;
+
+typedef struct TraceAnalyzerLimit
+{
+	const char* szTask;
+	double dResponseP99;
+} TraceAnalyzerLimit_t;
+
+typedef struct TraceAnalyzer
+{
+	TraceAnalyzerObject_t* pxObjects;
+	uint32_t uiObjectCount;
+	uint32_t uiObjectCapacity;
+
+	int32_t iCurrent[TRC_ANALYZER_MAX_CORES];	/* Object index, -1 if unknown */
+	uint64_t uxCurrentSince[TRC_ANALYZER_MAX_CORES];
+
+	uint64_t uxFrequency;						/* 0 if unknown */
+	uint64_t uxFirst;
+	uint64_t uxLast;
+	uint32_t uiCoreCount;
+	uint32_t uiEvents;
+	uint32_t hasEvents;
+	const char* szFormat;
+} TraceAnalyzer_t;
+
+static TraceAnalyzer_t xAnalyzer;
+
+static uint32_t prvRead16(const uint8_t* puiData)
+{
+	return (uint32_t)puiData[0] | ((uint32_t)puiData[1] << 8);
+}
+
+static uint32_t prvRead32(const uint8_t* puiData)
+{
+	return prvRead16(puiData) | (prvRead16(puiData + 2) << 16);
+}
+
+static uint64_t prvReadWord(const uint8_t* puiData, uint32_t uiWordSize)
+{
+	if (uiWordSize == 8)
+	{
+		return (uint64_t)prvRead32(puiData) | ((uint64_t)prvRead32(puiData + 4) << 32);
+	}
+
+	return prvRead32(puiData);
+}
+
+static void* prvAlloc(void* pvData, size_t uxSize)
+{
+	pvData = realloc(pvData, uxSize);
+	if (pvData == 0)
+	{
+		fprintf(stderr, "Out of memory.\n");
+		exit(1);
+	}
+
+	return pvData;
+}
+
+/* Returns the index of the object, creating it if needed */
+static int32_t prvObjectGet(uint64_t uxHandle, TraceAnalyzerKind_t xKind)
+{
+	uint32_t i;
+	TraceAnalyzerObject_t* pxObject;
+
+	for (i = 0; i < xAnalyzer.uiObjectCount; i++)
+	{
+		if (xAnalyzer.pxObjects[i].uxHandle == uxHandle)
+		{
+			if (xAnalyzer.pxObjects[i].xKind == TRC_KIND_UNKNOWN)
+			{
+				xAnalyzer.pxObjects[i].xKind = xKind;
+			}
+
+			return (int32_t)i;
+		}
+	}
+
+	if (xAnalyzer.uiObjectCount == xAnalyzer.uiObjectCapacity)
+	{
+		xAnalyzer.uiObjectCapacity = xAnalyzer.uiObjectCapacity ? xAnalyzer.uiObjectCapacity * 2 : 64;
+		xAnalyzer.pxObjects = (TraceAnalyzerObject_t*)prvAlloc(xAnalyzer.pxObjects, xAnalyzer.uiObjectCapacity * sizeof(TraceAnalyzerObject_t));
+	}
+
+	pxObject = &xAnalyzer.pxObjects[xAnalyzer.uiObjectCount];
+	memset(pxObject, 0, sizeof(TraceAnalyzerObject_t));
+	pxObject->uxHandle = uxHandle;
+	pxObject->xKind = xKind;
+	pxObject->iBlockedOn = -1;
+	snprintf(pxObject->szName, sizeof(pxObject->szName), "0x%llx", (unsigned long long)uxHandle);
+
+	return (int32_t)xAnalyzer.uiObjectCount++;
+}
+
+static void prvObjectSetName(uint64_t uxHandle, TraceAnalyzerKind_t xKind, const char* szName, uint32_t uiMaxLength)
+{
+	int32_t iIndex = prvObjectGet(uxHandle, xKind);	/* May move pxObjects */
+	TraceAnalyzerObject_t* pxObject = &xAnalyzer.pxObjects[iIndex];
+	uint32_t i;
+
+	for (i = 0; i < uiMaxLength && i < sizeof(pxObject->szName) - 1 && szName[i] != 0; i++)
+	{
+		/* Keeps the CSV and JSON output valid */
+		pxObject->szName[i] = (szName[i] == '"' || szName[i] == ',' || szName[i] == '\\' || (uint8_t)szName[i] < 0x20) ? '_' : szName[i];
+	}
+
+	if (i > 0)
+	{
+		pxObject->szName[i] = 0;
+	}
+}
+
+static void prvTime(uint64_t uxTime)
+{
+	if (!xAnalyzer.hasEvents)
+	{
+		xAnalyzer.uxFirst = uxTime;
+		xAnalyzer.hasEvents = 1;
+	}
+
+	xAnalyzer.uxLast = uxTime;
+	xAnalyzer.uiEvents++;
+}
+
+/* A task or ISR starts executing on a core */
+static void prvOnSwitch(uint32_t uiCore, uint64_t uxHandle, TraceAnalyzerKind_t xKind, uint64_t uxTime)
+{
+	int32_t iIndex = prvObjectGet(uxHandle, xKind);
+	TraceAnalyzerObject_t* pxObject = &xAnalyzer.pxObjects[iIndex];
+
+	if (xAnalyzer.iCurrent[uiCore] >= 0)
+	{
+		xAnalyzer.pxObjects[xAnalyzer.iCurrent[uiCore]].uxRunTime += uxTime - xAnalyzer.uxCurrentSince[uiCore];
+	}
+
+	if (xAnalyzer.iCurrent[uiCore] != iIndex)
+	{
+		pxObject->uiActivations++;
+	}
+
+	xAnalyzer.iCurrent[uiCore] = iIndex;
+	xAnalyzer.uxCurrentSince[uiCore] = uxTime;
+
+	if (pxObject->isBlocked)
+	{
+		TraceAnalyzerObject_t* pxBlockedOn = &xAnalyzer.pxObjects[pxObject->iBlockedOn];
+		uint64_t uxBlocked = uxTime - pxObject->uxBlockedTime;
+
+		pxBlockedOn->uiBlockCount++;
+		pxBlockedOn->uxBlockTime += uxBlocked;
+		if (uxBlocked > pxBlockedOn->uxBlockMax)
+		{
+			pxBlockedOn->uxBlockMax = uxBlocked;
+		}
+
+		pxObject->isBlocked = 0;
+	}
+}
+
+static void prvOnReady(uint64_t uxHandle, uint64_t uxTime)
+{
+	int32_t iIndex = prvObjectGet(uxHandle, TRC_KIND_TASK);	/* May move pxObjects */
+	TraceAnalyzerObject_t* pxObject = &xAnalyzer.pxObjects[iIndex];
+
+	/* The response time is counted from the first time it became ready */
+	if (!pxObject->isReady)
+	{
+		pxObject->isReady = 1;
+		pxObject->uxReadyTime = uxTime;
+	}
+}
+
+/* The task running on the core blocks, on an object or just waiting (iObject = -1) */
+static void prvOnBlock(uint32_t uiCore, int32_t iObject, uint64_t uxTime)
+{
+	TraceAnalyzerObject_t* pxTask;
+
+	if (xAnalyzer.iCurrent[uiCore] < 0)
+	{
+		return;
+	}
+
+	pxTask = &xAnalyzer.pxObjects[xAnalyzer.iCurrent[uiCore]];
+
+	if (pxTask->xKind != TRC_KIND_TASK)
+	{
+		return;
+	}
+
+	if (pxTask->isReady)
+	{
+		if (pxTask->uiResponseCount == pxTask->uiResponseCapacity)
+		{
+			pxTask->uiResponseCapacity = pxTask->uiResponseCapacity ? pxTask->uiResponseCapacity * 2 : 256;
+			pxTask->puxResponseTimes = (uint64_t*)prvAlloc(pxTask->puxResponseTimes, pxTask->uiResponseCapacity * sizeof(uint64_t));
+		}
+
+		pxTask->puxResponseTimes[pxTask->uiResponseCount++] = uxTime - pxTask->uxReadyTime;
+		pxTask->isReady = 0;
+	}
+
+	if (iObject >= 0)
+	{
+		pxTask->isBlocked = 1;
+		pxTask->iBlockedOn = iObject;
+		pxTask->uxBlockedTime = uxTime;
+	}
+}
+
+/*******************************************************************************
+ * Snapshot
+ ******************************************************************************/
+
+typedef struct TraceAnalyzerSnapshot
+{
+	const uint8_t* puiData;
+	uint32_t uiSize;
+	uint32_t uiClassCount;
+	uint32_t uiHandleSize;
+	uint32_t uiNumberOfObjectsOffset;
+	uint32_t uiNameLengthOffset;
+	uint32_t uiTotalBytesOffset;
+	uint32_t uiStartIndexOffset;
+	uint32_t uiObjBytesOffset;
+	uint32_t uiObjBytesSize;
+	uint32_t hasNames;
+} TraceAnalyzerSnapshot_t;
+
+static uint32_t prvRoundUp(uint32_t uiValue, uint32_t uiMultiple)
+{
+	return ((uiValue + uiMultiple - 1) / uiMultiple) * uiMultiple;
+}
+
+static uint64_t prvSnapshotKey(uint32_t uiClass, uint32_t uiHandle)
+{
+	return ((uint64_t)uiClass << 16) | uiHandle;
+}
+
+static void prvSnapshotName(TraceAnalyzerSnapshot_t* pxSnapshot, uint32_t uiClass, uint32_t uiHandle, TraceAnalyzerKind_t xKind)
+{
+	uint32_t uiCount, uiIndex, uiNameLength;
+
+	(void)prvObjectGet(prvSnapshotKey(uiClass, uiHandle), xKind);
+
+	if (!pxSnapshot->hasNames || uiClass >= pxSnapshot->uiClassCount || uiHandle == 0)
+	{
+		return;
+	}
+
+	uiCount = pxSnapshot->uiHandleSize == 2 ?
+		prvRead16(&pxSnapshot->puiData[pxSnapshot->uiNumberOfObjectsOffset + uiClass * 2]) :
+		pxSnapshot->puiData[pxSnapshot->uiNumberOfObjectsOffset + uiClass];
+
+	if (uiHandle > uiCount)
+	{
+		return;
+	}
+
+	uiNameLength = pxSnapshot->puiData[pxSnapshot->uiNameLengthOffset + uiClass];
+	uiIndex = prvRead16(&pxSnapshot->puiData[pxSnapshot->uiStartIndexOffset + uiClass * 2]) +
+		pxSnapshot->puiData[pxSnapshot->uiTotalBytesOffset + uiClass] * (uiHandle - 1);
+
+	if (uiIndex + uiNameLength <= pxSnapshot->uiObjBytesSize)
+	{
+		prvObjectSetName(prvSnapshotKey(uiClass, uiHandle), xKind, (const char*)&pxSnapshot->puiData[pxSnapshot->uiObjBytesOffset + uiIndex], uiNameLength);
+	}
+}
+
+/* Returns the DTS width of the event (0, 8 or 16) and where it is stored */
+static uint32_t prvSnapshotDTS(uint32_t uiCode, uint32_t* puiOffset)
+{
+	switch (uiCode)
+	{
+	case 0x00:
+	case SNAPSHOT_DIV_XPS:
+	case SNAPSHOT_XTS8:
+	case SNAPSHOT_XTS16:
+	case 0xAA: /* EVENT_BEING_WRITTEN */
+	case 0xAB: /* RESERVED_DUMMY_CODE */
+	case 0xAE: /* XID */
+	case 0xAF: /* XTS16L */
+	case 0x95: /* MEM_MALLOC_ADDR */
+	case 0x97: /* MEM_FREE_ADDR */
+	case 0xE9: /* MEM_MALLOC_ADDR_TRCFAILED */
+		return 0;
+
+	/* prvTraceStoreKernelCallWithNumericParamOnly(), user events and memory events */
+	case SNAPSHOT_DIV_NEW_TIME:
+	case SNAPSHOT_CREATE_OBJ_TRCFAILED_MUTEX:
+	case SNAPSHOT_TASK_DELAY_UNTIL:
+	case SNAPSHOT_TASK_DELAY:
+	case SNAPSHOT_MEM_MALLOC_SIZE:
+	case SNAPSHOT_MEM_FREE_SIZE:
+	case SNAPSHOT_MEM_MALLOC_SIZE_TRCFAILED:
+		*puiOffset = 1;
+		return 8;
+
+	default:
+		break;
+	}
+
+	/* Object close events */
+	if ((uiCode >= 0x08 && uiCode <= 0x17) || (uiCode >= 0xE4 && uiCode <= 0xE7))
+	{
+		return 0;
+	}
+
+	if (uiCode >= SNAPSHOT_USER_EVENT && uiCode <= SNAPSHOT_USER_EVENT_LAST)
+	{
+		*puiOffset = 1;
+		return 8;
+	}
+
+	/* prvTraceStoreKernelCallWithParam() and the task instance events */
+	if ((uiCode >= SNAPSHOT_TASK_PRIORITY_SET && uiCode <= SNAPSHOT_TASK_PRIORITY_DISINHERIT) ||
+		(uiCode > SNAPSHOT_TIMER_CREATE && uiCode <= SNAPSHOT_TIMER_STOP_FROM_ISR_TRCFAILED && uiCode != SNAPSHOT_TIMER_CREATE_TRCFAILED) ||
+		(uiCode > SNAPSHOT_EVENT_GROUP_CREATE_TRCFAILED && uiCode <= SNAPSHOT_TASK_INSTANCE_FINISHED_DIRECT && uiCode != SNAPSHOT_EVENT_GROUP_DELETE_OBJ) ||
+		(uiCode >= SNAPSHOT_TASK_NOTIFY_TAKE && uiCode <= SNAPSHOT_TASK_NOTIFY_WAIT_TRCFAILED))
+	{
+		*puiOffset = 3;
+		return 8;
+	}
+
+	/* prvTraceStoreKernelCall(), task switches, ready and low power events */
+	*puiOffset = 2;
+	return 16;
+}
+
+/* Maps the class offset within an event group to the object kind and class */
+static void prvSnapshotBlockObject(uint32_t uiOffset, uint32_t* puiClass, TraceAnalyzerKind_t* pxKind)
+{
+	static const uint32_t uiClasses[] = { SNAPSHOT_CLASS_QUEUE, SNAPSHOT_CLASS_SEMAPHORE, SNAPSHOT_CLASS_MUTEX, SNAPSHOT_CLASS_STREAMBUFFER, SNAPSHOT_CLASS_MESSAGEBUFFER };
+	static const TraceAnalyzerKind_t xKinds[] = { TRC_KIND_QUEUE, TRC_KIND_SEMAPHORE, TRC_KIND_MUTEX, TRC_KIND_STREAMBUFFER, TRC_KIND_MESSAGEBUFFER };
+
+	if (uiOffset > 4)
+	{
+		uiOffset = 0;
+	}
+
+	*puiClass = uiClasses[uiOffset];
+	*pxKind = xKinds[uiOffset];
+}
+
+/* Converts the variable length records of a TRC_CFG_SNAPSHOT_COMPACT dump,
+which follow debugMarker4 at uiMarkerOffset, to a dump in the standard layout.
+Each record is the event code, the other bytes of its first 4-byte record
+except the DTS, the DTS as a 7-bit varint, then any further 4-byte records.
+XTS events are created again where the DTS does not fit its field. Returns 0
+if the records are corrupt. */
+static uint8_t* prvSnapshotExpand(const uint8_t* puiData, uint32_t uiSize, uint32_t uiEventsOffset, uint32_t uiMarkerOffset, uint32_t* puiExpandedSize)
+{
+	uint32_t uiCompactSize = prvRead32(&puiData[uiMarkerOffset + 4]);
+	uint32_t uiHead = prvRead32(&puiData[uiMarkerOffset + 8]);
+	uint32_t uiUsed = prvRead32(&puiData[uiMarkerOffset + 12]);
+	uint32_t uiCompactOffset = uiMarkerOffset + 16;
+	uint32_t uiTailSize, uiPos, uiRead = 0, uiCount = 0, uiMaxSlots;
+	uint8_t* puiExpanded;
+	uint8_t* puiSlots;
+
+	if (uiCompactSize == 0 || uiCompactOffset + uiCompactSize > uiSize || uiHead >= uiCompactSize || uiUsed > uiCompactSize)
+	{
+		fprintf(stderr, "Bad snapshot, truncated compact event buffer.\n");
+		return 0;
+	}
+
+	/* Every record is at least 3 bytes and gives at most 2 events */
+	uiMaxSlots = uiUsed + 1;
+	uiTailSize = uiSize - (uiCompactOffset + uiCompactSize);
+	puiExpanded = (uint8_t*)prvAlloc(0, uiEventsOffset + uiMaxSlots * 4 + uiTailSize);
+	puiSlots = &puiExpanded[uiEventsOffset];
+	memset(puiSlots, 0, uiMaxSlots * 4);
+
+	uiPos = (uiHead + uiCompactSize - uiUsed) % uiCompactSize;
+
+	while (uiRead < uiUsed)
+	{
+		uint8_t uiRecord[4 + 5];
+		uint32_t uiCode = puiData[uiCompactOffset + uiPos];
+		uint32_t uiDTSOffset = 0;
+		uint32_t uiDTSWidth = prvSnapshotDTS(uiCode, &uiDTSOffset);
+		uint32_t uiLength = uiDTSWidth == 0 ? 4 : (uiDTSWidth == 16 ? 2 : 3);
+		uint32_t uiExtra = 0, uiDTS = 0, uiShift = 0, j;
+		uint8_t* puiEvent;
+
+		/* The fixed part and the varint */
+		for (j = 0; j < uiLength + 5 && uiRead + j < uiUsed; j++)
+		{
+			uiRecord[j] = puiData[uiCompactOffset + (uiPos + j) % uiCompactSize];
+		}
+
+		if (uiDTSWidth != 0)
+		{
+			do
+			{
+				if (uiLength >= j || uiShift > 28)
+				{
+					fprintf(stderr, "Bad snapshot, corrupt compact event buffer.\n");
+					free(puiExpanded);
+					return 0;
+				}
+
+				uiDTS |= (uint32_t)(uiRecord[uiLength] & 0x7F) << uiShift;
+				uiShift += 7;
+			} while (uiRecord[uiLength++] & 0x80);
+
+			if (uiCode >= SNAPSHOT_USER_EVENT && uiCode <= SNAPSHOT_USER_EVENT_LAST)
+			{
+				uiExtra = (uiCode - SNAPSHOT_USER_EVENT) * 4;
+			}
+		}
+
+		if (uiRead + uiLength + uiExtra > uiUsed || uiCount + 2 + uiExtra / 4 > uiMaxSlots)
+		{
+			fprintf(stderr, "Bad snapshot, corrupt compact event buffer.\n");
+			free(puiExpanded);
+			return 0;
+		}
+
+		/* The XTS event that the recorder stored before the event, if any */
+		if (uiDTSWidth == 16 && uiDTS > 0xFFFF)
+		{
+			puiEvent = &puiSlots[uiCount++ * 4];
+			puiEvent[0] = SNAPSHOT_XTS16;
+			puiEvent[1] = 0;
+			puiEvent[2] = (uint8_t)(uiDTS >> 16);
+			puiEvent[3] = (uint8_t)(uiDTS >> 24);
+		}
+		else if (uiDTSWidth == 8 && uiDTS > 0xFF)
+		{
+			puiEvent = &puiSlots[uiCount++ * 4];
+			puiEvent[0] = SNAPSHOT_XTS8;
+			puiEvent[1] = (uint8_t)(uiDTS >> 24);
+			puiEvent[2] = (uint8_t)(uiDTS >> 8);
+			puiEvent[3] = (uint8_t)(uiDTS >> 16);
+		}
+
+		puiEvent = &puiSlots[uiCount++ * 4];
+		puiEvent[0] = (uint8_t)uiCode;
+
+		if (uiDTSWidth == 0)
+		{
+			memcpy(&puiEvent[1], &uiRecord[1], 3);
+		}
+		else if (uiDTSWidth == 16)
+		{
+			puiEvent[1] = uiRecord[1];
+			puiEvent[2] = (uint8_t)uiDTS;
+			puiEvent[3] = (uint8_t)(uiDTS >> 8);
+		}
+		else if (uiDTSOffset == 3)
+		{
+			puiEvent[1] = uiRecord[1];
+			puiEvent[2] = uiRecord[2];
+			puiEvent[3] = (uint8_t)uiDTS;
+		}
+		else
+		{
+			puiEvent[1] = (uint8_t)uiDTS;
+			puiEvent[2] = uiRecord[1];
+			puiEvent[3] = uiRecord[2];
+		}
+
+		for (j = 0; j < uiExtra; j++)
+		{
+			puiSlots[uiCount * 4 + j] = puiData[uiCompactOffset + (uiPos + uiLength + j) % uiCompactSize];
+		}
+		uiCount += uiExtra / 4;
+
+		uiPos = (uiPos + uiLength + uiExtra) % uiCompactSize;
+		uiRead += uiLength + uiExtra;
+	}
+
+	/* The header as it is, the events with one free slot, then what follows the events */
+	memcpy(puiExpanded, puiData, uiEventsOffset);
+	memcpy(&puiSlots[(uiCount + 1) * 4], &puiData[uiCompactOffset + uiCompactSize], uiTailSize);
+	*puiExpandedSize = uiEventsOffset + (uiCount + 1) * 4 + uiTailSize;
+
+	memcpy(&puiExpanded[16], puiExpandedSize, 4);	/* filesize */
+	uiCount++;
+	memcpy(&puiExpanded[24], &uiCount, 4);			/* maxEvents */
+	uiCount--;
+	memcpy(&puiExpanded[28], &uiCount, 4);			/* nextFreeIndex */
+	memset(&puiExpanded[32], 0, 4);					/* bufferIsFull */
+
+	return puiExpanded;
+}
+
+/* Returns 0 if the file could be written */
+static int prvWriteFile(const char* szFile, const uint8_t* puiData, uint32_t uiSize)
+{
+	FILE* pxFile = fopen(szFile, "wb");
+	int iResult = 0;
+
+	if (pxFile == 0 || fwrite(puiData, 1, uiSize, pxFile) != uiSize)
+	{
+		fprintf(stderr, "Could not write %s.\n", szFile);
+		iResult = 1;
+	}
+
+	if (pxFile != 0)
+	{
+		fclose(pxFile);
+	}
+
+	return iResult;
+}
+
+static int prvSnapshotAnalyze(const uint8_t* puiData, uint32_t uiSize, const char* szExpanded)
+{
+	TraceAnalyzerSnapshot_t xSnapshot;
+	uint32_t uiOffset, uiMaxEvents, uiNextFree, uiEventsOffset, uiStart, i;
+	uint32_t uiSymbolTableSize;
+	uint64_t uxTime = 0, uxPendingXTS = 0;
+	int32_t iCurrentTask = -1;
+
+	memset(&xSnapshot, 0, sizeof(xSnapshot));
+	xSnapshot.puiData = puiData;
+	xSnapshot.uiSize = uiSize;
+
+	uiMaxEvents = prvRead32(&puiData[24]);
+	uiNextFree = prvRead32(&puiData[28]);
+	xAnalyzer.uxFrequency = prvRead32(&puiData[36]);
+	xAnalyzer.uiCoreCount = 1;
+	xAnalyzer.szFormat = "snapshot";
+
+	if (prvRead32(&puiData[64]) != 0xF0F0F0F0)
+	{
+		fprintf(stderr, "Bad snapshot, debugMarker0 not found.\n");
+		return 1;
+	}
+
+	/* ObjectPropertyTable */
+	xSnapshot.uiHandleSize = prvRead32(&puiData[68]) ? 2 : 1;
+	xSnapshot.uiClassCount = prvRead32(&puiData[72]);
+	xSnapshot.uiObjBytesSize = prvRead32(&puiData[76]);
+	xSnapshot.uiNumberOfObjectsOffset = 80;
+	uiOffset = xSnapshot.uiNumberOfObjectsOffset + (xSnapshot.uiHandleSize == 2 ?
+		2 * prvRoundUp(xSnapshot.uiClassCount, 2) : prvRoundUp(xSnapshot.uiClassCount, 4));
+	xSnapshot.uiNameLengthOffset = uiOffset;
+	uiOffset += prvRoundUp(xSnapshot.uiClassCount, 4);
+	xSnapshot.uiTotalBytesOffset = uiOffset;
+	uiOffset += prvRoundUp(xSnapshot.uiClassCount, 4);
+	xSnapshot.uiStartIndexOffset = uiOffset;
+	uiOffset += 2 * prvRoundUp(xSnapshot.uiClassCount, 2);
+	xSnapshot.uiObjBytesOffset = uiOffset;
+	uiOffset += prvRoundUp(xSnapshot.uiObjBytesSize, 4);
+
+	if (uiOffset + 4 > uiSize || prvRead32(&puiData[uiOffset]) != 0xF1F1F1F1)
+	{
+		fprintf(stderr, "Bad snapshot, debugMarker1 not found.\n");
+		return 1;
+	}
+
+	xSnapshot.hasNames = 1;
+
+	/* SymbolTable, exampleFloatEncoding and internalErrorOccured */
+	uiOffset += 4;
+	uiSymbolTableSize = prvRead32(&puiData[uiOffset]);
+	uiOffset += 8 + prvRoundUp(uiSymbolTableSize, 4) + 64 * 2 + 4 + 4;
+
+	if (uiOffset + 4 + 80 + 4 > uiSize || prvRead32(&puiData[uiOffset]) != 0xF2F2F2F2 || prvRead32(&puiData[uiOffset + 4 + 80]) != 0xF3F3F3F3)
+	{
+		fprintf(stderr, "Bad snapshot, debugMarker2/3 not found.\n");
+		return 1;
+	}
+
+	uiEventsOffset = uiOffset + 4 + 80 + 4;
+
+	/* TRC_CFG_SNAPSHOT_COMPACT, the events are then in compactData after debugMarker4 */
+	if (uiEventsOffset + uiMaxEvents * 4 + 16 <= uiSize && prvRead32(&puiData[uiEventsOffset + uiMaxEvents * 4]) == 0xF4F4F4F4)
+	{
+		uint8_t* puiExpanded = prvSnapshotExpand(puiData, uiSize, uiEventsOffset, uiEventsOffset + uiMaxEvents * 4, &uiSize);
+		int iResult = 1;
+
+		if (puiExpanded != 0 && (szExpanded == 0 || prvWriteFile(szExpanded, puiExpanded, uiSize) == 0))
+		{
+			iResult = prvSnapshotAnalyze(puiExpanded, uiSize, 0);
+		}
+
+		free(puiExpanded);
+		return iResult;
+	}
+
+	if (szExpanded != 0)
+	{
+		fprintf(stderr, "-o with one FILE is only for snapshots and streams recorded as compact.\n");
+		return 1;
+	}
+
+	if (uiEventsOffset + uiMaxEvents * 4 > uiSize || uiNextFree > uiMaxEvents)
+	{
+		fprintf(stderr, "Bad snapshot, truncated event buffer.\n");
+		return 1;
+	}
+
+	/* In ring buffer mode, the oldest event is the next to be overwritten */
+	uiStart = prvRead32(&puiData[32]) ? uiNextFree : 0;
+
+	for (i = 0; i < (prvRead32(&puiData[32]) ? uiMaxEvents : uiNextFree); i++)
+	{
+		const uint8_t* puiEvent = &puiData[uiEventsOffset + ((uiStart + i) % uiMaxEvents) * 4];
+		uint32_t uiCode = puiEvent[0];
+		uint32_t uiHandle = puiEvent[1];
+		uint32_t uiDTSOffset = 0;
+		uint32_t uiDTSWidth;
+		uint32_t uiClass;
+		TraceAnalyzerKind_t xKind;
+
+		if (uiCode == SNAPSHOT_XTS16)
+		{
+			uxPendingXTS = (uint64_t)prvRead16(&puiEvent[2]) << 16;
+			continue;
+		}
+
+		if (uiCode == SNAPSHOT_XTS8)
+		{
+			uxPendingXTS = ((uint64_t)puiEvent[1] << 24) | ((uint64_t)prvRead16(&puiEvent[2]) << 8);
+			continue;
+		}
+
+		uiDTSWidth = prvSnapshotDTS(uiCode, &uiDTSOffset);
+		if (uiDTSWidth == 0)
+		{
+			continue;
+		}
+
+		uxTime += uxPendingXTS | (uiDTSWidth == 16 ? prvRead16(&puiEvent[uiDTSOffset]) : puiEvent[uiDTSOffset]);
+		uxPendingXTS = 0;
+		prvTime(uxTime);
+
+		switch (uiCode)
+		{
+		case SNAPSHOT_TS_TASK_BEGIN:
+		case SNAPSHOT_TS_TASK_RESUME:
+			prvSnapshotName(&xSnapshot, SNAPSHOT_CLASS_TASK, uiHandle, TRC_KIND_TASK);
+			prvOnSwitch(0, prvSnapshotKey(SNAPSHOT_CLASS_TASK, uiHandle), TRC_KIND_TASK, uxTime);
+			iCurrentTask = xAnalyzer.iCurrent[0];
+			break;
+
+		case SNAPSHOT_TS_ISR_BEGIN:
+		case SNAPSHOT_TS_ISR_RESUME:
+			prvSnapshotName(&xSnapshot, SNAPSHOT_CLASS_ISR, uiHandle, TRC_KIND_ISR);
+			prvOnSwitch(0, prvSnapshotKey(SNAPSHOT_CLASS_ISR, uiHandle), TRC_KIND_ISR, uxTime);
+			break;
+
+		case SNAPSHOT_DIV_TASK_READY:
+			prvSnapshotName(&xSnapshot, SNAPSHOT_CLASS_TASK, uiHandle, TRC_KIND_TASK);
+			prvOnReady(prvSnapshotKey(SNAPSHOT_CLASS_TASK, uiHandle), uxTime);
+			break;
+
+		case SNAPSHOT_TASK_DELAY:
+		case SNAPSHOT_TASK_DELAY_UNTIL:
+			prvOnBlock(0, -1, uxTime);
+			break;
+
+		case SNAPSHOT_TASK_SUSPEND:
+			if (iCurrentTask >= 0 && xAnalyzer.pxObjects[iCurrentTask].uxHandle == prvSnapshotKey(SNAPSHOT_CLASS_TASK, uiHandle))
+			{
+				prvOnBlock(0, -1, uxTime);
+			}
+			break;
+
+		case SNAPSHOT_EVENT_GROUP_SYNC_TRCBLOCK:
+		case SNAPSHOT_EVENT_GROUP_WAIT_BITS_TRCBLOCK:
+			prvSnapshotName(&xSnapshot, SNAPSHOT_CLASS_EVENTGROUP, uiHandle, TRC_KIND_EVENTGROUP);
+			prvOnBlock(0, prvObjectGet(prvSnapshotKey(SNAPSHOT_CLASS_EVENTGROUP, uiHandle), TRC_KIND_EVENTGROUP), uxTime);
+			break;
+
+		case SNAPSHOT_TASK_NOTIFY_TAKE_TRCBLOCK:
+		case SNAPSHOT_TASK_NOTIFY_WAIT_TRCBLOCK:
+			if (iCurrentTask >= 0)
+			{
+				prvOnBlock(0, prvObjectGet(xAnalyzer.pxObjects[iCurrentTask].uxHandle | ((uint64_t)1 << 32), TRC_KIND_NOTIFY), uxTime);
+			}
+			break;
+
+		default:
+			if ((uiCode >= SNAPSHOT_RECEIVE_TRCBLOCK && uiCode < SNAPSHOT_SEND_TRCBLOCK + 8) ||
+				(uiCode >= SNAPSHOT_PEEK_TRCBLOCK && uiCode < SNAPSHOT_PEEK_TRCBLOCK + 3))
+			{
+				prvSnapshotBlockObject((uiCode >= SNAPSHOT_PEEK_TRCBLOCK ? uiCode - SNAPSHOT_PEEK_TRCBLOCK : uiCode) & 7, &uiClass, &xKind);
+				prvSnapshotName(&xSnapshot, uiClass, uiHandle, xKind);
+				prvOnBlock(0, prvObjectGet(prvSnapshotKey(uiClass, uiHandle), xKind), uxTime);
+			}
+			break;
+		}
+	}
+
+	/* Notifications are named after the task */
+	for (i = 0; i < xAnalyzer.uiObjectCount; i++)
+	{
+		if (xAnalyzer.pxObjects[i].xKind == TRC_KIND_NOTIFY)
+		{
+			int32_t iTask = prvObjectGet(xAnalyzer.pxObjects[i].uxHandle & 0xFFFFFFFFU, TRC_KIND_TASK);
+
+			memcpy(xAnalyzer.pxObjects[i].szName, xAnalyzer.pxObjects[iTask].szName, TRC_ANALYZER_NAME_LENGTH);
+		}
+	}
+
+	return 0;
+}
+
+/*******************************************************************************
+ * Streaming (PSF)
+ ******************************************************************************/
+
+#define PSF_HEADER_SIZE 32
+
+/* Size of TraceTimestamp_t */
+static uint32_t prvPSFTimestampSize(uint32_t uiWordSize)
+{
+	return prvRoundUp(4 + (uiWordSize == 8 ? 4 : 0) + uiWordSize + 5 * 4, uiWordSize);
+}
+
+/* Size of TraceEntry_t */
+static uint32_t prvPSFEntrySize(uint32_t uiWordSize, uint32_t uiStateCount, uint32_t uiSymbolSize)
+{
+	return prvRoundUp(uiWordSize + uiStateCount * uiWordSize + 4 + uiSymbolSize, uiWordSize);
+}
+
+static int prvPSFIsCompact(const uint8_t* puiData)
+{
+	return (prvRead32(&puiData[8]) & PSF_OPTION_COMPACT) != 0;
+}
+
+/* Returns the offset of the first event, or 0 if the word size doesn't fit.
+The entry table and the trace start event are known to be within uiSize if it
+isn't 0. */
+static uint32_t prvPSFEventsOffset(const uint8_t* puiData, uint32_t uiSize, uint32_t uiWordSize)
+{
+	uint32_t uiOffset = PSF_HEADER_SIZE + prvPSFTimestampSize(uiWordSize);
+	uint32_t uiEntryCount, uiSymbolSize, uiStateCount, uiEntrySize;
+
+	if (uiOffset + 12 > uiSize)
+	{
+		return 0;
+	}
+
+	uiEntryCount = prvRead32(&puiData[uiOffset]);
+	uiSymbolSize = prvRead32(&puiData[uiOffset + 4]);
+	uiStateCount = prvRead32(&puiData[uiOffset + 8]);
+	uiOffset += 12;
+
+	/* Checked by division so that a corrupt count can't wrap the offset around */
+	if (uiSymbolSize > uiSize || uiStateCount > uiSize / uiWordSize)
+	{
+		return 0;
+	}
+
+	uiEntrySize = prvPSFEntrySize(uiWordSize, uiStateCount, uiSymbolSize);
+	if (uiEntryCount > (uiSize - uiOffset) / uiEntrySize)
+	{
+		return 0;
+	}
+
+	uiOffset += uiEntryCount * uiEntrySize;
+
+	/* The trace start event follows the entry table, after the flags if compact */
+	if (prvPSFIsCompact(puiData))
+	{
+		if (uiOffset + 4 > uiSize || (puiData[uiOffset] & PSF_COMPACT_FLAG_ABSOLUTE) == 0 ||
+			(prvRead16(&puiData[uiOffset + 1]) & 0xFFF) != PSF_EVENT_TRACE_START)
+		{
+			return 0;
+		}
+	}
+	else if (uiOffset + 8 > uiSize || (prvRead16(&puiData[uiOffset]) & 0xFFF) != PSF_EVENT_TRACE_START)
+	{
+		return 0;
+	}
+
+	return uiOffset;
+}
+
+/* Converts the compact event at *puiOffset to a standard event at puiEvent,
+and moves *puiOffset past it. Returns the size of the standard event, or 0 if
+the stream ends within the event or it isn't a compact event. */
+static uint32_t prvPSFCompactEvent(const uint8_t* puiData, uint32_t uiSize, uint32_t* puiOffset, TraceAnalyzerCompactCore_t* pxCores, uint8_t* puiEvent)
+{
+	static const uint32_t auiTagSize[4] = { 1, 2, 2, 4 };
+	uint32_t uiOffset = *puiOffset;
+	uint32_t uiFlags = puiData[uiOffset++];
+	TraceAnalyzerCompactCore_t* pxCore = &pxCores[(uiFlags >> 2) & 0xF];
+	uint32_t uiEventID, uiCount, uiParamCount, uiHigh, uiTags = 0, uiTag, uiValue, i;
+	uint32_t uiTS = 0, uiShift = 0;
+
+	if ((uiFlags & PSF_COMPACT_FLAG_RECORD) == 0 || ((uiFlags & PSF_COMPACT_FLAG_ABSOLUTE) == 0 && !pxCore->hasBase))
+	{
+		fprintf(stderr, "Bad stream, corrupt compact event at offset %u.\n", (unsigned int)*puiOffset);
+		return 0;
+	}
+
+	if (uiOffset + 2 > uiSize)
+	{
+		return 0;
+	}
+
+	uiEventID = prvRead16(&puiData[uiOffset]);
+	uiParamCount = (uiEventID >> 12) & 0xF;
+	uiOffset += 2;
+
+	if (uiFlags & PSF_COMPACT_FLAG_COUNT)
+	{
+		if (uiOffset + 2 > uiSize)
+		{
+			return 0;
+		}
+
+		uiCount = prvRead16(&puiData[uiOffset]);
+		uiOffset += 2;
+	}
+	else
+	{
+		/* The core is in the upper 4 bits on multi-core targets */
+		uiCount = (pxCore->uiCount & 0xF000) | ((pxCore->uiCount + 1) & 0x0FFF);
+	}
+
+	do
+	{
+		if (uiOffset >= uiSize || uiShift > 28)
+		{
+			return 0;
+		}
+
+		uiTS |= (uint32_t)(puiData[uiOffset] & 0x7F) << uiShift;
+		uiShift += 7;
+	} while (puiData[uiOffset++] & 0x80);
+
+	if (uiFlags & PSF_COMPACT_FLAG_ABSOLUTE)
+	{
+		uiHigh = 0;
+	}
+	else
+	{
+		uiTS += pxCore->uiTS;
+		uiHigh = pxCore->uiHigh;
+	}
+
+	for (i = 0; i < uiParamCount; i++)
+	{
+		if ((i % 4) == 0)
+		{
+			if (uiOffset >= uiSize)
+			{
+				return 0;
+			}
+
+			uiTags = puiData[uiOffset++];
+		}
+
+		uiTag = (uiTags >> ((i % 4) * 2)) & 3;
+
+		if (uiOffset + auiTagSize[uiTag] > uiSize)
+		{
+			return 0;
+		}
+
+		switch (uiTag)
+		{
+		case PSF_COMPACT_TAG_8:
+			uiValue = puiData[uiOffset];
+			break;
+
+		case PSF_COMPACT_TAG_16:
+			uiValue = prvRead16(&puiData[uiOffset]);
+			break;
+
+		case PSF_COMPACT_TAG_LOW_16:
+			uiValue = (uiHigh << 16) | prvRead16(&puiData[uiOffset]);
+			break;
+
+		default:
+			uiValue = prvRead32(&puiData[uiOffset]);
+			uiHigh = uiValue >> 16;
+			break;
+		}
+
+		uiOffset += auiTagSize[uiTag];
+		memcpy(&puiEvent[8 + i * 4], &uiValue, 4);
+	}
+
+	memcpy(&puiEvent[0], &uiEventID, 2);
+	memcpy(&puiEvent[2], &uiCount, 2);
+	memcpy(&puiEvent[4], &uiTS, 4);
+
+	pxCore->uiTS = uiTS;
+	pxCore->uiCount = uiCount;
+	pxCore->uiHigh = uiHigh;
+	pxCore->hasBase = 1;
+
+	*puiOffset = uiOffset;
+
+	return 8 + uiParamCount * 4;
+}
+
+/* Converts a TRC_CFG_STREAMING_COMPACT stream to the standard format. The
+uiEventsOffset bytes before the first event, i.e., the header, timestamp info
+and entry table, are copied as they are, except that the header no longer
+says the stream is compact. uiEventsOffset is 0 for the streams of the other
+cores, see prvPSFMerge(). The conversion ends where the stream ends within an
+event, or at a corrupt event. */
+static uint8_t* prvPSFExpand(const uint8_t* puiData, uint32_t uiSize, uint32_t uiEventsOffset, uint32_t* puiExpandedSize)
+{
+	TraceAnalyzerCompactCore_t xCores[TRC_ANALYZER_MAX_CORES];
+	uint32_t uiOffset = uiEventsOffset, uiExpanded = uiEventsOffset, uiEventSize;
+	uint8_t* puiExpanded;
+
+	memset(xCores, 0, sizeof(xCores));
+
+	/* A compact event is at least a quarter of the standard one */
+	puiExpanded = (uint8_t*)prvAlloc(0, uiEventsOffset + (uiSize - uiEventsOffset) * 4);
+	memcpy(puiExpanded, puiData, uiEventsOffset);
+
+	if (uiEventsOffset != 0)
+	{
+		uint32_t uiOptions = prvRead32(&puiData[8]) & ~(uint32_t)PSF_OPTION_COMPACT;
+
+		memcpy(&puiExpanded[8], &uiOptions, 4);
+	}
+
+	while (uiOffset < uiSize)
+	{
+		/* Trailing zero padding, e.g., the rest of a File stream port block */
+		if (puiData[uiOffset] == 0)
+		{
+			uiOffset++;
+			continue;
+		}
+
+		uiEventSize = prvPSFCompactEvent(puiData, uiSize, &uiOffset, xCores, &puiExpanded[uiExpanded]);
+		if (uiEventSize == 0)
+		{
+			break;
+		}
+
+		uiExpanded += uiEventSize;
+	}
+
+	*puiExpandedSize = uiExpanded;
+
+	return puiExpanded;
+}
+
+static int prvPSFAnalyze(const uint8_t* puiData, uint32_t uiSize, uint32_t uiWordSize, const char* szExpanded)
+{
+	uint32_t uiOffset, uiEntryCount, uiSymbolSize, uiStateCount, uiEntrySize, i;
+	uint32_t uiLastTS = 0;
+	uint64_t uxTime = 0;
+
+	xAnalyzer.szFormat = "streaming";
+
+	if (uiWordSize == 0)
+	{
+		/* Detected from the layout, i.e., 4 on 32-bit targets and 8 on 64-bit simulators */
+		uiWordSize = prvPSFEventsOffset(puiData, uiSize, 4) ? 4 : 8;
+	}
+
+	uiOffset = prvPSFEventsOffset(puiData, uiSize, uiWordSize);
+	if (uiOffset == 0)
+	{
+		fprintf(stderr, "Bad stream, trace start event not found after the entry table.\n");
+		return 1;
+	}
+
+	/* TRC_CFG_STREAMING_COMPACT, converted to the standard format first */
+	if (prvPSFIsCompact(puiData))
+	{
+		uint8_t* puiExpanded = prvPSFExpand(puiData, uiSize, uiOffset, &uiSize);
+		int iResult = 1;
+
+		if (szExpanded == 0 || prvWriteFile(szExpanded, puiExpanded, uiSize) == 0)
+		{
+			iResult = prvPSFAnalyze(puiExpanded, uiSize, uiWordSize, 0);
+		}
+
+		free(puiExpanded);
+		return iResult;
+	}
+
+	if (szExpanded != 0)
+	{
+		fprintf(stderr, "-o with one FILE is only for snapshots and streams recorded as compact.\n");
+		return 1;
+	}
+
+	xAnalyzer.uiCoreCount = prvRead32(&puiData[12]);
+	if (xAnalyzer.uiCoreCount == 0 || xAnalyzer.uiCoreCount > TRC_ANALYZER_MAX_CORES)
+	{
+		xAnalyzer.uiCoreCount = 1;
+	}
+
+	/* TraceTimestamp_t.frequency */
+	xAnalyzer.uxFrequency = prvReadWord(&puiData[PSF_HEADER_SIZE + (uiWordSize == 8 ? 8 : 4)], uiWordSize);
+
+	/* Entry table, for the names of the objects created before tracing started */
+	uiOffset = PSF_HEADER_SIZE + prvPSFTimestampSize(uiWordSize);
+	uiEntryCount = prvRead32(&puiData[uiOffset]);
+	uiSymbolSize = prvRead32(&puiData[uiOffset + 4]);
+	uiStateCount = prvRead32(&puiData[uiOffset + 8]);
+	uiEntrySize = prvPSFEntrySize(uiWordSize, uiStateCount, uiSymbolSize);
+	uiOffset += 12;
+
+	for (i = 0; i < uiEntryCount; i++, uiOffset += uiEntrySize)
+	{
+		if (uiOffset + uiEntrySize > uiSize)
+		{
+			fprintf(stderr, "Bad stream, entry table truncated.\n");
+			return 1;
+		}
+
+		prvObjectSetName(prvReadWord(&puiData[uiOffset], uiWordSize), TRC_KIND_UNKNOWN,
+			(const char*)&puiData[uiOffset + uiWordSize + uiStateCount * uiWordSize + 4], uiSymbolSize);
+	}
+
+	while (uiOffset + 8 <= uiSize)
+	{
+		uint32_t uiEventID = prvRead16(&puiData[uiOffset]);
+		uint32_t uiCode = uiEventID & 0xFFF;
+		uint32_t uiEventSize = 8 + ((uiEventID >> 12) & 0xF) * 4;
+		uint32_t uiCore = xAnalyzer.uiCoreCount > 1 ? (prvRead16(&puiData[uiOffset + 2]) >> 12) % xAnalyzer.uiCoreCount : 0;
+		uint32_t uiTS = prvRead32(&puiData[uiOffset + 4]);
+		uint32_t uiParamSize = uiEventSize - 8;
+		const uint8_t* puiParams;
+		uint64_t uxHandle;
+
+		/* Truncated at the end of the stream, e.g., when a capture is stopped.
+		Nothing past the event header may be read before this. */
+		if (uiOffset + uiEventSize > uiSize)
+		{
+			break;
+		}
+
+		puiParams = &puiData[uiOffset + 8];
+		uxHandle = uiParamSize >= uiWordSize ? prvReadWord(puiParams, uiWordSize) : 0;
+		uiOffset += uiEventSize;
+
+		/* Trailing zero padding, e.g., the rest of a File stream port block */
+		if (uiEventID == 0)
+		{
+			continue;
+		}
+
+		/* The timestamp wraps around, so it's extended from the differences */
+		if (xAnalyzer.hasEvents)
+		{
+			uxTime += (uint32_t)(uiTS - uiLastTS);
+		}
+		uiLastTS = uiTS;
+		prvTime(uxTime);
+
+		switch (uiCode)
+		{
+		case PSF_EVENT_OBJ_NAME:
+			if (uiParamSize > uiWordSize)
+			{
+				prvObjectSetName(uxHandle, TRC_KIND_UNKNOWN, (const char*)&puiParams[uiWordSize], uiParamSize - uiWordSize);
+			}
+			break;
+
+		case PSF_EVENT_DEFINE_ISR:
+			if (uiParamSize > uiWordSize + 4)
+			{
+				prvObjectSetName(uxHandle, TRC_KIND_ISR, (const char*)&puiParams[uiWordSize + 4], uiParamSize - uiWordSize - 4);
+			}
+			break;
+
+		case PSF_EVENT_TRACE_START:
+		case PSF_EVENT_TASK_ACTIVATE:
+			/* The trace start event holds the current task as a 32-bit value */
+			if (uiCode == PSF_EVENT_TRACE_START)
+			{
+				uxHandle = uiParamSize >= 4 ? prvRead32(puiParams) : 0;
+			}
+			prvOnSwitch(uiCore, uxHandle, TRC_KIND_TASK, uxTime);
+			break;
+
+		case PSF_EVENT_ISR_BEGIN:
+		case PSF_EVENT_ISR_RESUME:
+			prvOnSwitch(uiCore, uxHandle, TRC_KIND_ISR, uxTime);
+			break;
+
+		case PSF_EVENT_TASK_READY:
+			prvOnReady(uxHandle, uxTime);
+			break;
+
+		case PSF_EVENT_TASK_DELAY:
+		case PSF_EVENT_TASK_DELAY_UNTIL:
+			prvOnBlock(uiCore, -1, uxTime);
+			break;
+
+		case PSF_EVENT_TASK_SUSPEND:
+			if (xAnalyzer.iCurrent[uiCore] >= 0 && xAnalyzer.pxObjects[xAnalyzer.iCurrent[uiCore]].uxHandle == uxHandle)
+			{
+				prvOnBlock(uiCore, -1, uxTime);
+			}
+			break;
+
+		case PSF_EVENT_QUEUE_SEND_BLOCK:
+		case PSF_EVENT_QUEUE_RECEIVE_BLOCK:
+		case PSF_EVENT_QUEUE_PEEK_BLOCK:
+		case PSF_EVENT_QUEUE_SEND_FRONT_BLOCK:
+			prvOnBlock(uiCore, prvObjectGet(uxHandle, TRC_KIND_QUEUE), uxTime);
+			break;
+
+		case PSF_EVENT_SEMAPHORE_GIVE_BLOCK:
+		case PSF_EVENT_SEMAPHORE_TAKE_BLOCK:
+		case PSF_EVENT_SEMAPHORE_PEEK_BLOCK:
+			prvOnBlock(uiCore, prvObjectGet(uxHandle, TRC_KIND_SEMAPHORE), uxTime);
+			break;
+
+		case PSF_EVENT_MUTEX_GIVE_BLOCK:
+		case PSF_EVENT_MUTEX_TAKE_BLOCK:
+		case PSF_EVENT_MUTEX_PEEK_BLOCK:
+		case PSF_EVENT_MUTEX_TAKE_RECURSIVE_BLOCK:
+			prvOnBlock(uiCore, prvObjectGet(uxHandle, TRC_KIND_MUTEX), uxTime);
+			break;
+
+		case PSF_EVENT_EVENTGROUP_SYNC_BLOCK:
+		case PSF_EVENT_EVENTGROUP_WAITBITS_BLOCK:
+			prvOnBlock(uiCore, prvObjectGet(uxHandle, TRC_KIND_EVENTGROUP), uxTime);
+			break;
+
+		case PSF_EVENT_STREAMBUFFER_SEND_BLOCK:
+		case PSF_EVENT_STREAMBUFFER_RECEIVE_BLOCK:
+			prvOnBlock(uiCore, prvObjectGet(uxHandle, TRC_KIND_STREAMBUFFER), uxTime);
+			break;
+
+		case PSF_EVENT_MESSAGEBUFFER_SEND_BLOCK:
+		case PSF_EVENT_MESSAGEBUFFER_RECEIVE_BLOCK:
+			prvOnBlock(uiCore, prvObjectGet(uxHandle, TRC_KIND_MESSAGEBUFFER), uxTime);
+			break;
+
+		case PSF_EVENT_TASK_NOTIFY_WAIT_BLOCK:
+			/* The handle is the waiting task, the notification gets its own entry */
+			prvOnBlock(uiCore, prvObjectGet(uxHandle ^ 1, TRC_KIND_NOTIFY), uxTime);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	/* Notifications are named after the task */
+	for (i = 0; i < xAnalyzer.uiObjectCount; i++)
+	{
+		if (xAnalyzer.pxObjects[i].xKind == TRC_KIND_NOTIFY)
+		{
+			int32_t iTask = prvObjectGet(xAnalyzer.pxObjects[i].uxHandle ^ 1, TRC_KIND_TASK);
+
+			memcpy(xAnalyzer.pxObjects[i].szName, xAnalyzer.pxObjects[iTask].szName, TRC_ANALYZER_NAME_LENGTH);
+		}
+	}
+
+	return 0;
+}
+
+/* Skips padding and returns 1 if a complete event is at the stream's offset */
+static int prvPSFStreamHasEvent(TraceAnalyzerStream_t* pxStream)
+{
+	while (pxStream->uiOffset + 8 <= pxStream->uiSize && prvRead16(&pxStream->puiData[pxStream->uiOffset]) == 0)
+	{
+		pxStream->uiOffset += 8;
+	}
+
+	return pxStream->uiOffset + 8 <= pxStream->uiSize &&
+		pxStream->uiOffset + 8 + ((prvRead16(&pxStream->puiData[pxStream->uiOffset]) >> 12) & 0xF) * 4 <= pxStream->uiSize;
+}
+
+/*
+ * Merges per-core streams into one, by timestamp. Exactly one of them must
+ * start with the PSF header, i.e., the stream of the core that started the
+ * recorder, and the header and entry table are taken from it. The others hold
+ * events only. Each stream is in time order already, so this repeatedly takes
+ * the earliest of the next events, comparing the 32-bit timestamps relative to
+ * the last one taken so that wrap-around is handled.
+ */
+static uint8_t* prvPSFMerge(TraceAnalyzerStream_t* pxStreams, uint32_t uiCount, uint32_t uiWordSize, uint32_t* puiSize)
+{
+	uint8_t* puiMerged;
+	uint32_t uiBase = uiCount, uiTotal = 0, uiOffset, uiLastTS = 0, i;
+
+	for (i = 0; i < uiCount; i++)
+	{
+		uiTotal += pxStreams[i].uiSize;
+
+		if (pxStreams[i].uiSize >= 4 && prvRead32(pxStreams[i].puiData) == TRACE_PSF_ENDIANESS_IDENTIFIER)
+		{
+			if (uiBase != uiCount)
+			{
+				fprintf(stderr, "More than one stream has a PSF header.\n");
+				return 0;
+			}
+			uiBase = i;
+		}
+	}
+
+	if (uiBase == uiCount)
+	{
+		fprintf(stderr, "None of the streams has a PSF header.\n");
+		return 0;
+	}
+
+	if (uiWordSize == 0)
+	{
+		uiWordSize = prvPSFEventsOffset(pxStreams[uiBase].puiData, pxStreams[uiBase].uiSize, 4) ? 4 : 8;
+	}
+
+	uiOffset = prvPSFEventsOffset(pxStreams[uiBase].puiData, pxStreams[uiBase].uiSize, uiWordSize);
+	if (uiOffset == 0)
+	{
+		fprintf(stderr, "Bad stream, trace start event not found after the entry table.\n");
+		return 0;
+	}
+
+	/* TRC_CFG_STREAMING_COMPACT, all streams are converted to the standard format first */
+	if (prvPSFIsCompact(pxStreams[uiBase].puiData))
+	{
+		uiTotal = 0;
+
+		for (i = 0; i < uiCount; i++)
+		{
+			uint8_t* puiExpanded = prvPSFExpand(pxStreams[i].puiData, pxStreams[i].uiSize, i == uiBase ? uiOffset : 0, &pxStreams[i].uiSize);
+
+			free((void*)pxStreams[i].puiData);
+			pxStreams[i].puiData = puiExpanded;
+			uiTotal += pxStreams[i].uiSize;
+		}
+	}
+
+	puiMerged = (uint8_t*)prvAlloc(0, uiTotal);
+	memcpy(puiMerged, pxStreams[uiBase].puiData, uiOffset);
+	pxStreams[uiBase].uiOffset = uiOffset;
+
+	/* Start from the trace start event */
+	uiLastTS = prvRead32(&pxStreams[uiBase].puiData[uiOffset + 4]);
+
+	for (;;)
+	{
+		TraceAnalyzerStream_t* pxNext = 0;
+		int32_t iNextDelta = 0;
+		uint32_t uiEventSize;
+
+		for (i = 0; i < uiCount; i++)
+		{
+			if (prvPSFStreamHasEvent(&pxStreams[i]))
+			{
+				int32_t iDelta = (int32_t)(prvRead32(&pxStreams[i].puiData[pxStreams[i].uiOffset + 4]) - uiLastTS);
+
+				if (pxNext == 0 || iDelta < iNextDelta)
+				{
+					pxNext = &pxStreams[i];
+					iNextDelta = iDelta;
+				}
+			}
+		}
+
+		if (pxNext == 0)
+		{
+			break;
+		}
+
+		uiEventSize = 8 + ((prvRead16(&pxNext->puiData[pxNext->uiOffset]) >> 12) & 0xF) * 4;
+		memcpy(&puiMerged[uiOffset], &pxNext->puiData[pxNext->uiOffset], uiEventSize);
+		uiLastTS = prvRead32(&pxNext->puiData[pxNext->uiOffset + 4]);
+		pxNext->uiOffset += uiEventSize;
+		uiOffset += uiEventSize;
+	}
+
+	*puiSize = uiOffset;
+
+	return puiMerged;
+}
+
+/*******************************************************************************
+ * Output
+ ******************************************************************************/
+
+static double prvToMicroseconds(uint64_t uxTicks)
+{
+	/* Raw ticks if the frequency is unknown */
+	if (xAnalyzer.uxFrequency == 0)
+	{
+		return (double)uxTicks;
+	}
+
+	return (double)uxTicks * 1000000.0 / (double)xAnalyzer.uxFrequency;
+}
+
+static int prvCompare(const void* pvA, const void* pvB)
+{
+	uint64_t uxA = *(const uint64_t*)pvA;
+	uint64_t uxB = *(const uint64_t*)pvB;
+
+	return (uxA > uxB) - (uxA < uxB);
+}
+
+/* Nearest rank percentile of the sorted response times */
+static double prvPercentile(const TraceAnalyzerObject_t* pxObject, uint32_t uiPercent)
+{
+	uint32_t uiRank;
+
+	if (pxObject->uiResponseCount == 0)
+	{
+		return 0.0;
+	}
+
+	uiRank = (uint32_t)(((uint64_t)uiPercent * pxObject->uiResponseCount + 99) / 100);
+	if (uiRank == 0)
+	{
+		uiRank = 1;
+	}
+
+	return prvToMicroseconds(pxObject->puxResponseTimes[uiRank - 1]);
+}
+
+static void prvOutput(int isJSON)
+{
+	uint64_t uxDuration = xAnalyzer.uxLast - xAnalyzer.uxFirst;
+	const char* szSeparator = "";
+	uint32_t i;
+
+	/* Whatever runs at the end of the trace */
+	for (i = 0; i < TRC_ANALYZER_MAX_CORES; i++)
+	{
+		if (xAnalyzer.iCurrent[i] >= 0)
+		{
+			xAnalyzer.pxObjects[xAnalyzer.iCurrent[i]].uxRunTime += xAnalyzer.uxLast - xAnalyzer.uxCurrentSince[i];
+		}
+	}
+
+	for (i = 0; i < xAnalyzer.uiObjectCount; i++)
+	{
+		if (xAnalyzer.pxObjects[i].uiResponseCount == 0)
+		{
+			continue;
+		}
+
+		qsort(xAnalyzer.pxObjects[i].puxResponseTimes, xAnalyzer.pxObjects[i].uiResponseCount, sizeof(uint64_t), prvCompare);
+	}
+
+	if (isJSON)
+	{
+		printf("{\n\t\"format\": \"%s\",\n\t\"frequency\": %llu,\n\t\"events\": %u,\n\t\"duration_us\": %.3f,\n\t\"tasks\": [",
+			xAnalyzer.szFormat, (unsigned long long)xAnalyzer.uxFrequency, xAnalyzer.uiEvents, prvToMicroseconds(uxDuration));
+	}
+	else
+	{
+		printf("name,type,cpu_percent,run_time_us,activations,responses,response_p50_us,response_p90_us,response_p99_us,response_max_us\n");
+	}
+
+	for (i = 0; i < xAnalyzer.uiObjectCount; i++)
+	{
+		const TraceAnalyzerObject_t* pxObject = &xAnalyzer.pxObjects[i];
+		double dCPU = uxDuration ? 100.0 * (double)pxObject->uxRunTime / ((double)uxDuration * xAnalyzer.uiCoreCount) : 0.0;
+
+		if (pxObject->xKind != TRC_KIND_TASK && pxObject->xKind != TRC_KIND_ISR)
+		{
+			continue;
+		}
+
+		if (isJSON)
+		{
+			printf("%s\n\t\t{ \"name\": \"%s\", \"type\": \"%s\", \"cpu_percent\": %.3f, \"run_time_us\": %.3f, \"activations\": %u, \"responses\": %u, "
+				"\"response_p50_us\": %.3f, \"response_p90_us\": %.3f, \"response_p99_us\": %.3f, \"response_max_us\": %.3f }",
+				szSeparator, pxObject->szName, pszKindNames[pxObject->xKind], dCPU, prvToMicroseconds(pxObject->uxRunTime), pxObject->uiActivations,
+				pxObject->uiResponseCount, prvPercentile(pxObject, 50), prvPercentile(pxObject, 90), prvPercentile(pxObject, 99), prvPercentile(pxObject, 100));
+			szSeparator = ",";
+		}
+		else
+		{
+			printf("%s,%s,%.3f,%.3f,%u,%u,%.3f,%.3f,%.3f,%.3f\n",
+				pxObject->szName, pszKindNames[pxObject->xKind], dCPU, prvToMicroseconds(pxObject->uxRunTime), pxObject->uiActivations,
+				pxObject->uiResponseCount, prvPercentile(pxObject, 50), prvPercentile(pxObject, 90), prvPercentile(pxObject, 99), prvPercentile(pxObject, 100));
+		}
+	}
+
+	if (isJSON)
+	{
+		printf("\n\t],\n\t\"objects\": [");
+	}
+	else
+	{
+		printf("\nname,type,block_count,block_total_us,block_mean_us,block_max_us\n");
+	}
+
+	szSeparator = "";
+	for (i = 0; i < xAnalyzer.uiObjectCount; i++)
+	{
+		const TraceAnalyzerObject_t* pxObject = &xAnalyzer.pxObjects[i];
+		double dMean = pxObject->uiBlockCount ? prvToMicroseconds(pxObject->uxBlockTime) / pxObject->uiBlockCount : 0.0;
+
+		if (pxObject->uiBlockCount == 0)
+		{
+			continue;
+		}
+
+		if (isJSON)
+		{
+			printf("%s\n\t\t{ \"name\": \"%s\", \"type\": \"%s\", \"block_count\": %u, \"block_total_us\": %.3f, \"block_mean_us\": %.3f, \"block_max_us\": %.3f }",
+				szSeparator, pxObject->szName, pszKindNames[pxObject->xKind], pxObject->uiBlockCount,
+				prvToMicroseconds(pxObject->uxBlockTime), dMean, prvToMicroseconds(pxObject->uxBlockMax));
+			szSeparator = ",";
+		}
+		else
+		{
+			printf("%s,%s,%u,%.3f,%.3f,%.3f\n",
+				pxObject->szName, pszKindNames[pxObject->xKind], pxObject->uiBlockCount,
+				prvToMicroseconds(pxObject->uxBlockTime), dMean, prvToMicroseconds(pxObject->uxBlockMax));
+		}
+	}
+
+	if (isJSON)
+	{
+		printf("\n\t]\n}\n");
+	}
+}
+
+/* Returns the number of tasks whose p99 response time exceeds its limit */
+static uint32_t prvCheckLimits(const TraceAnalyzerLimit_t* pxLimits, uint32_t uiLimitCount)
+{
+	uint32_t uiViolations = 0;
+	uint32_t i, j;
+
+	for (i = 0; i < uiLimitCount; i++)
+	{
+		for (j = 0; j < xAnalyzer.uiObjectCount; j++)
+		{
+			const TraceAnalyzerObject_t* pxObject = &xAnalyzer.pxObjects[j];
+
+			if (pxObject->xKind == TRC_KIND_TASK && strcmp(pxObject->szName, pxLimits[i].szTask) == 0 &&
+				prvPercentile(pxObject, 99) > pxLimits[i].dResponseP99)
+			{
+				fprintf(stderr, "%s: response time p99 %.3f us exceeds the limit %.3f us.\n",
+					pxObject->szName, prvPercentile(pxObject, 99), pxLimits[i].dResponseP99);
+				uiViolations++;
+			}
+		}
+	}
+
+	return uiViolations;
+}
+
+static void prvUsage(void)
+{
+	fprintf(stderr,
+		"Usage: trcAnalyzer [-j] [-w 4|8] [-l TASK=US]... [-o OUT] FILE...\n"
+		"\n"
+		"  FILE        Snapshot dump (e.g., Trace.dump) or stream (e.g., trace.psf).\n"
+		"              Several streams, one per core, are merged by timestamp\n"
+		"  -j          JSON output instead of CSV\n"
+		"  -w 4|8      Pointer size of the target, for streams. Detected by default\n"
+		"  -l TASK=US  Fail (exit code 2) if the p99 response time of TASK exceeds US\n"
+		"  -o OUT      Also save the merged stream, or a compact snapshot or stream\n"
+		"              converted to the standard format, to OUT, e.g., for Tracealyzer\n");
+}
+
+/* Returns the contents of the file, or 0 if it can't be read */
+static uint8_t* prvReadFile(const char* szFile, uint32_t* puiSize)
+{
+	uint8_t* puiData = 0;
+	long lSize;
+	FILE* pxFile;
+
+	pxFile = fopen(szFile, "rb");
+	if (pxFile == 0)
+	{
+		fprintf(stderr, "Could not open %s.\n", szFile);
+		return 0;
+	}
+
+	fseek(pxFile, 0, SEEK_END);
+	lSize = ftell(pxFile);
+	fseek(pxFile, 0, SEEK_SET);
+
+	/* Always allocated, so that an empty file (e.g., the stream of an idle core) isn't an error */
+	puiData = (uint8_t*)prvAlloc(0, lSize > 0 ? (size_t)lSize : 1);
+	if (lSize > 0 && fread(puiData, 1, (size_t)lSize, pxFile) != (size_t)lSize)
+	{
+		lSize = 0;
+	}
+	fclose(pxFile);
+
+	*puiSize = lSize > 0 ? (uint32_t)lSize : 0;
+
+	return puiData;
+}
+
+int main(int argc, char* argv[])
+{
+	TraceAnalyzerLimit_t xLimits[TRC_ANALYZER_MAX_LIMITS];
+	uint32_t uiLimitCount = 0;
+	uint32_t uiWordSize = 0;
+	const char* pszFiles[TRC_ANALYZER_MAX_CORES];
+	TraceAnalyzerStream_t xStreams[TRC_ANALYZER_MAX_CORES];
+	uint32_t uiFileCount = 0;
+	const char* szFile;
+	const char* szMerged = 0;
+	int isJSON = 0;
+	uint8_t* puiData = 0;
+	uint32_t uiSize = 0;
+	int i, iResult;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-j") == 0)
+		{
+			isJSON = 1;
+		}
+		else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+		{
+			uiWordSize = (uint32_t)atoi(argv[++i]);
+			if (uiWordSize != 4 && uiWordSize != 8)
+			{
+				prvUsage();
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc && uiLimitCount < TRC_ANALYZER_MAX_LIMITS)
+		{
+			char* szValue = strchr(argv[++i], '=');
+
+			if (szValue == 0)
+			{
+				prvUsage();
+				return 1;
+			}
+
+			*szValue = 0;
+			xLimits[uiLimitCount].szTask = argv[i];
+			xLimits[uiLimitCount].dResponseP99 = atof(szValue + 1);
+			uiLimitCount++;
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+		{
+			szMerged = argv[++i];
+		}
+		else if (argv[i][0] != '-' && uiFileCount < TRC_ANALYZER_MAX_CORES)
+		{
+			pszFiles[uiFileCount++] = argv[i];
+		}
+		else
+		{
+			prvUsage();
+			return 1;
+		}
+	}
+
+	if (uiFileCount == 0)
+	{
+		prvUsage();
+		return 1;
+	}
+
+	szFile = pszFiles[0];
+
+	if (uiFileCount == 1)
+	{
+		puiData = prvReadFile(szFile, &uiSize);
+	}
+	else
+	{
+		for (i = 0; i < (int)uiFileCount; i++)
+		{
+			xStreams[i].puiData = prvReadFile(pszFiles[i], &xStreams[i].uiSize);
+			xStreams[i].uiOffset = 0;
+
+			if (xStreams[i].puiData == 0)
+			{
+				return 1;
+			}
+		}
+
+		puiData = prvPSFMerge(xStreams, uiFileCount, uiWordSize, &uiSize);
+
+		for (i = 0; i < (int)uiFileCount; i++)
+		{
+			free((void*)xStreams[i].puiData);
+		}
+
+		if (puiData != 0 && szMerged != 0 && prvWriteFile(szMerged, puiData, uiSize) != 0)
+		{
+			uiSize = 0;
+		}
+
+		szMerged = 0;
+		szFile = "The merged stream";
+	}
+
+	if (puiData == 0)
+	{
+		return 1;
+	}
+
+	if (uiSize < 128)
+	{
+		fprintf(stderr, "%s is too small to be a trace.\n", szFile);
+		free(puiData);
+		return 1;
+	}
+
+	memset(&xAnalyzer, 0, sizeof(xAnalyzer));
+	for (i = 0; i < TRC_ANALYZER_MAX_CORES; i++)
+	{
+		xAnalyzer.iCurrent[i] = -1;
+	}
+
+	if (prvRead32(puiData) == TRACE_PSF_ENDIANESS_IDENTIFIER)
+	{
+		iResult = prvPSFAnalyze(puiData, uiSize, uiWordSize, szMerged);
+	}
+	else if (puiData[0] == 0x01 && puiData[1] == 0x02 && puiData[2] == 0x03 && puiData[3] == 0x04 &&
+		puiData[4] == 0x71 && puiData[8] == 0xF1)
+	{
+		iResult = prvSnapshotAnalyze(puiData, uiSize, szMerged);
+	}
+	else
+	{
+		fprintf(stderr, "%s is not a snapshot or a little endian stream.\n", szFile);
+		iResult = 1;
+	}
+
+	free(puiData);
+
+	if (iResult != 0)
+	{
+		return iResult;
+	}
+
+	prvOutput(isJSON);
+
+	return prvCheckLimits(xLimits, uiLimitCount) ? 2 : 0;
+}
@@ -0,0 +1,228 @@
+/*
+ * Trace Recorder for Tracealyzer v4.6.0
+ * Copyright 2021 Percepio AB
+ * www.percepio.com
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host test of trcAnalyzer.c. Builds a small stream in memory, checks what is
+ * reported for it, and then analyzes every truncation of it, as a File or UART
+ * capture that was stopped ends partway through an event. Each truncated copy
+ * is allocated at its exact size, so building with -fsanitize=address catches
+ * any read past the end of the stream. The analyzer reports each stream cut
+ * before its trace start event as bad, which is expected. Run by
+ * "make analyzer_test" in FreeRTOS/Demo/Posix_GCC.
+ */
+
+#define main prvAnalyzerMain
+#include "trcAnalyzer.c"
+#undef main
+
+#define TEST_TASK_A			0x1000
+#define TEST_TASK_B			0x2000
+#define TEST_SYMBOL_SIZE	16
+
+static uint8_t uiStream[512];
+static uint32_t uiStreamSize;
+static uint32_t uiEventsOffset;
+
+static void prvPut32(uint32_t uiValue)
+{
+	uiStream[uiStreamSize++] = (uint8_t)uiValue;
+	uiStream[uiStreamSize++] = (uint8_t)(uiValue >> 8);
+	uiStream[uiStreamSize++] = (uint8_t)(uiValue >> 16);
+	uiStream[uiStreamSize++] = (uint8_t)(uiValue >> 24);
+}
+
+static void prvPutEntry(uint32_t uiHandle, const char* szName)
+{
+	prvPut32(uiHandle);
+	prvPut32(0);												/* State */
+	prvPut32(0);												/* Options */
+	strncpy((char*)&uiStream[uiStreamSize], szName, TEST_SYMBOL_SIZE);
+	uiStreamSize += TEST_SYMBOL_SIZE;
+}
+
+static void prvPutEvent(uint32_t uiCode, uint32_t uiTS, uint32_t uiParam)
+{
+	static uint32_t uiCount = 0;
+
+	prvPut32(uiCode | (1 << 12) | (uiCount++ << 16));		/* One parameter */
+	prvPut32(uiTS);
+	prvPut32(uiParam);
+}
+
+/* A 32-bit target, with A running, then B becoming ready, running and
+delaying, three times */
+static void prvBuildStream(void)
+{
+	uint32_t i;
+
+	memset(uiStream, 0, sizeof(uiStream));
+	uiStreamSize = 0;
+
+	/* Header */
+	prvPut32(TRACE_PSF_ENDIANESS_IDENTIFIER);
+	prvPut32(0);
+	prvPut32(0);												/* Options */
+	prvPut32(1);												/* Cores */
+	uiStreamSize = PSF_HEADER_SIZE;
+
+	/* TraceTimestamp_t, with the frequency second */
+	prvPut32(0);
+	prvPut32(1000000);
+	uiStreamSize = PSF_HEADER_SIZE + prvPSFTimestampSize(4);
+
+	/* Entry table */
+	prvPut32(2);
+	prvPut32(TEST_SYMBOL_SIZE);
+	prvPut32(1);
+	prvPutEntry(TEST_TASK_A, "TaskA");
+	prvPutEntry(TEST_TASK_B, "TaskB");
+
+	uiEventsOffset = uiStreamSize;
+
+	prvPutEvent(PSF_EVENT_TRACE_START, 0, TEST_TASK_A);
+	for (i = 0; i < 3; i++)
+	{
+		prvPutEvent(PSF_EVENT_TASK_READY, 100 + i * 1000, TEST_TASK_B);
+		prvPutEvent(PSF_EVENT_TASK_ACTIVATE, 110 + i * 1000, TEST_TASK_B);
+		prvPutEvent(PSF_EVENT_TASK_DELAY, 150 + i * 1000, 10);
+		prvPutEvent(PSF_EVENT_TASK_ACTIVATE, 150 + i * 1000, TEST_TASK_A);
+	}
+}
+
+static void prvReset(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < xAnalyzer.uiObjectCount; i++)
+	{
+		free(xAnalyzer.pxObjects[i].puxResponseTimes);
+	}
+	free(xAnalyzer.pxObjects);
+
+	memset(&xAnalyzer, 0, sizeof(xAnalyzer));
+	for (i = 0; i < TRC_ANALYZER_MAX_CORES; i++)
+	{
+		xAnalyzer.iCurrent[i] = -1;
+	}
+}
+
+/* Analyzes the first uiSize bytes of the stream from a buffer of that size */
+static int prvAnalyzeCopy(uint32_t uiSize)
+{
+	uint8_t* puiCopy = (uint8_t*)malloc(uiSize > 0 ? uiSize : 1);
+	int iResult;
+
+	memcpy(puiCopy, uiStream, uiSize);
+	prvReset();
+	iResult = prvPSFAnalyze(puiCopy, uiSize, 0, 0);
+	free(puiCopy);
+
+	return iResult;
+}
+
+static const TraceAnalyzerObject_t* prvFind(const char* szName)
+{
+	uint32_t i;
+
+	for (i = 0; i < xAnalyzer.uiObjectCount; i++)
+	{
+		if (strcmp(xAnalyzer.pxObjects[i].szName, szName) == 0)
+		{
+			return &xAnalyzer.pxObjects[i];
+		}
+	}
+
+	return 0;
+}
+
+static int prvTestComplete(void)
+{
+	const TraceAnalyzerObject_t* pxTaskB;
+
+	if (prvAnalyzeCopy(uiStreamSize) != 0)
+	{
+		printf("complete: not analyzed\n");
+		return 1;
+	}
+
+	pxTaskB = prvFind("TaskB");
+	if (xAnalyzer.uiEvents != 13 || prvFind("TaskA") == 0 || pxTaskB == 0 ||
+		pxTaskB->uiResponseCount != 3 || pxTaskB->puxResponseTimes[0] != 50)
+	{
+		printf("complete: %u events, TaskB %s\n", xAnalyzer.uiEvents, pxTaskB ? "wrong" : "missing");
+		return 1;
+	}
+
+	return 0;
+}
+
+/* Every length, including those that end within the header, the entry table
+and an event. The events are 12 bytes each. */
+static int prvTestTruncated(void)
+{
+	uint32_t uiSize, uiExpected;
+	int iResult;
+
+	for (uiSize = 0; uiSize < uiStreamSize; uiSize++)
+	{
+		iResult = prvAnalyzeCopy(uiSize);
+
+		if (uiSize < uiEventsOffset + 8)
+		{
+			if (iResult == 0)
+			{
+				printf("truncated at %u: analyzed without a trace start event\n", uiSize);
+				return 1;
+			}
+			continue;
+		}
+
+		uiExpected = (uiSize - uiEventsOffset) / 12;
+		if (iResult != 0 || xAnalyzer.uiEvents != uiExpected)
+		{
+			printf("truncated at %u: %u events, expected %u\n", uiSize, xAnalyzer.uiEvents, uiExpected);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* An entry count so large that the table size wraps around */
+static int prvTestCorruptEntryCount(void)
+{
+	uint32_t uiCountOffset = PSF_HEADER_SIZE + prvPSFTimestampSize(4);
+	int iResult;
+
+	uiStream[uiCountOffset + 3] = 0x40;
+	iResult = prvAnalyzeCopy(uiStreamSize);
+	uiStream[uiCountOffset + 3] = 0;
+
+	if (iResult == 0)
+	{
+		printf("corrupt entry count: analyzed\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	int iFailures = 0;
+
+	prvBuildStream();
+
+	iFailures += prvTestComplete();
+	iFailures += prvTestTruncated();
+	iFailures += prvTestCorruptEntryCount();
+
+	prvReset();
+
+	printf("trcAnalyzerTest: %s\n", iFailures ? "FAILED" : "passed");
+
+	return iFailures ? 1 : 0;
+}
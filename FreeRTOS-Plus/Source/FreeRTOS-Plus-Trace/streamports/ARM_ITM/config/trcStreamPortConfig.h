@@ -28,6 +28,25 @@ extern "C" {
  ******************************************************************************/
 #define TRC_CFG_STREAM_PORT_ITM_PORT 1
 
+/*******************************************************************************
+ * TRC_CFG_STREAM_PORT_ITM_PORT_COUNT
+ *
+ * Valid values: 1 - (32 - TRC_CFG_STREAM_PORT_ITM_PORT)
+ *
+ * How many consecutive ITM ports, starting at TRC_CFG_STREAM_PORT_ITM_PORT,
+ * the trace data is striped across. Each 32-bit word goes to the next port in
+ * turn, so the host gets one log per port and must interleave them word by
+ * word, in port order, to rebuild the trace. All ports must be enabled in
+ * ITM->TER, otherwise nothing is written.
+ *
+ * Striping lets a probe that decodes stimulus ports in parallel drain the
+ * TPIU FIFO sooner. With 1 the stream is identical to the single port mode.
+ *
+ * Default: 1
+ *
+ ******************************************************************************/
+#define TRC_CFG_STREAM_PORT_ITM_PORT_COUNT 1
+
 #ifdef __cplusplus
 }
 #endif
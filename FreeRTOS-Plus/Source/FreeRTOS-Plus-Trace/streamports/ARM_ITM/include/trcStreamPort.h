@@ -73,12 +73,23 @@ extern "C" {
 #error "Invalid ITM port defined in trcStreamPortConfig.h."
 #endif
 
+#ifndef TRC_CFG_STREAM_PORT_ITM_PORT_COUNT
+#define TRC_CFG_STREAM_PORT_ITM_PORT_COUNT 1
+#endif
+
+#if ((TRC_CFG_STREAM_PORT_ITM_PORT_COUNT) < 1) || (((TRC_CFG_STREAM_PORT_ITM_PORT) + (TRC_CFG_STREAM_PORT_ITM_PORT_COUNT)) > 32)
+#error "Invalid ITM port count defined in trcStreamPortConfig.h."
+#endif
+
+/* The ITM ports that must be enabled for the trace to be written */
+#define TRC_STREAM_PORT_ITM_PORT_MASK ((0xFFFFFFFFUL >> (32 - (TRC_CFG_STREAM_PORT_ITM_PORT_COUNT))) << (TRC_CFG_STREAM_PORT_ITM_PORT))
+
 /* Important for the ITM port - no RAM buffer, direct writes. In most other ports this can be skipped (default is 1) */
 #define TRC_USE_INTERNAL_BUFFER 0
 
 typedef struct TraceStreamPortBuffer
 {
-	uint8_t buffer[sizeof(TraceUnsignedBaseType_t)];
+	uint8_t buffer[sizeof(uint32_t) * 2];
 } TraceStreamPortBuffer_t;
 
 traceResult prvTraceItmWrite(void* ptrData, uint32_t size, int32_t* ptrBytesWritten);
@@ -102,6 +113,19 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
 
 #define xTraceStreamPortOnTraceEnd() TRC_COMMA_EXPR_TO_STATEMENT_EXPR_1(TRC_SUCCESS)
 
+/**
+ * @brief Gets the number of words that found the ITM FIFO full.
+ *
+ * Each stall is a word the recorder had to wait for, with interrupts disabled.
+ * A growing count means SWO is too slow for the trace data rate.
+ *
+ * @param[out] puiStalls Stalled words since the stream port was initialized
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceItmGetStalls(uint32_t* puiStalls);
+
 #ifdef __cplusplus
 }
 #endif
@@ -66,7 +66,8 @@
 
 typedef struct TraceStreamPortFile
 {
-	uint8_t buffer[sizeof(TraceUnsignedBaseType_t)];
+	uint32_t uiNextPort;	/* Offset from TRC_CFG_STREAM_PORT_ITM_PORT of the port taking the next word */
+	uint32_t uiStalls;		/* Words that found the ITM FIFO full */
 } TraceStreamPortFile_t;
 
 static TraceStreamPortFile_t* pxStreamPortFile;
@@ -82,34 +83,47 @@ volatile char tz_host_command_data[32];
  * A debugger IDE may write to these functions using a macro. 
  * An example for Keil is included (Keil-uVision-Tracealyzer-ITM-Exporter.ini). */
 
-#define itm_write_32(__data) \
-{\
-	if ((CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) &&					/* Trace enabled? */ \
-		(ITM->TCR & ITM_TCR_ITMENA_Msk) &&									/* ITM enabled? */ \
-		(ITM->TER & (1UL << (TRC_CFG_STREAM_PORT_ITM_PORT))))								/* ITM port enabled? */ \
-	{ \
-		while (ITM->PORT[TRC_CFG_STREAM_PORT_ITM_PORT].u32 == 0) { /* Do nothing */ }	/* Block until room in ITM FIFO - This stream port is always in "blocking mode", since intended for high-speed ITM! */ \
-		ITM->PORT[TRC_CFG_STREAM_PORT_ITM_PORT].u32 = __data;								/* Write the data */ \
-	} \
-}
+#define itm_enabled() \
+	((CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) &&								/* Trace enabled? */ \
+	(ITM->TCR & ITM_TCR_ITMENA_Msk) &&												/* ITM enabled? */ \
+	((ITM->TER & TRC_STREAM_PORT_ITM_PORT_MASK) == TRC_STREAM_PORT_ITM_PORT_MASK))	/* ITM ports enabled? */
 
 /* This is assumed to execute from within the recorder, with interrupts disabled */
 traceResult prvTraceItmWrite(void* ptrData, uint32_t size, int32_t* ptrBytesWritten)
 {
 	uint32_t* ptr32 = (uint32_t*)ptrData;
+	uint32_t uiPort;
+	uint32_t i;
 
 	TRC_ASSERT(size % 4 == 0);
 	TRC_ASSERT(ptrBytesWritten != 0);
 
-	*ptrBytesWritten = 0;
-
-	while (*ptrBytesWritten < (int32_t)size)
+	/* The enable bits are checked once per block, not for every word */
+	if (itm_enabled())
 	{
-		itm_write_32(*ptr32);
-		ptr32++;
-		*ptrBytesWritten += 4;
+		uiPort = pxStreamPortFile->uiNextPort;
+
+		for (i = 0; i < size / 4; i++)
+		{
+			/* Only spin if the FIFO is full - This stream port is always in "blocking mode", since intended for high-speed ITM! */
+			if (ITM->PORT[(TRC_CFG_STREAM_PORT_ITM_PORT) + uiPort].u32 == 0)
+			{
+				pxStreamPortFile->uiStalls++;
+
+				while (ITM->PORT[(TRC_CFG_STREAM_PORT_ITM_PORT) + uiPort].u32 == 0) { /* Do nothing */ }
+			}
+
+			ITM->PORT[(TRC_CFG_STREAM_PORT_ITM_PORT) + uiPort].u32 = ptr32[i];
+
+			/* The stripe continues across blocks so the host can interleave the port logs */
+			uiPort = (uiPort + 1) % (TRC_CFG_STREAM_PORT_ITM_PORT_COUNT);
+		}
+
+		pxStreamPortFile->uiNextPort = uiPort;
 	}
 
+	*ptrBytesWritten = (int32_t)size;
+
 	return TRC_SUCCESS;
 }
 
@@ -153,6 +167,25 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer)
 
 	pxStreamPortFile = (TraceStreamPortFile_t*)pxBuffer;
 
+	pxStreamPortFile->uiNextPort = 0;
+	pxStreamPortFile->uiStalls = 0;
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceItmGetStalls(uint32_t* puiStalls)
+{
+	/* This should never fail */
+	TRC_ASSERT(puiStalls != 0);
+
+	/* We need to check this */
+	if (pxStreamPortFile == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	*puiStalls = pxStreamPortFile->uiStalls;
+
 	return TRC_SUCCESS;
 }
 
@@ -0,0 +1,193 @@
+/*
+* Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+ * The configuration for trace streaming ("stream ports").
+*/
+
+#ifndef TRC_STREAM_PORT_CONFIG_H
+#define TRC_STREAM_PORT_CONFIG_H
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <trcTypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Backpressure policies, what a destination does with the events it can't take */
+#define TRC_STREAM_PORT_POLICY_DROP			(0U) /* Drop the event and keep going */
+#define TRC_STREAM_PORT_POLICY_BLOCK		(1U) /* Wait until the event fits, RTT only */
+#define TRC_STREAM_PORT_POLICY_DETACH		(2U) /* Stop writing to this destination until tracing is started again */
+#define TRC_STREAM_PORT_POLICY_STOP			(3U) /* Stop the recorder */
+#define TRC_STREAM_PORT_POLICY_OVERWRITE	(4U) /* Overwrite the oldest events, ring buffer only */
+
+/**
+ * @def TRC_CFG_STREAM_PORT_USE_RTT
+ *
+ * @brief Streams the trace through SEGGER RTT, like the Jlink_RTT stream
+ * port. Tracealyzer commands are also read from RTT.
+ *
+ * Default value is 1.
+ */
+#define TRC_CFG_STREAM_PORT_USE_RTT 1
+
+/**
+ * @def TRC_CFG_STREAM_PORT_USE_FILE
+ *
+ * @brief Writes the trace to a file through stdio.h (fwrite), like the File
+ * stream port. The file is opened when tracing starts and closed when it
+ * stops.
+ *
+ * Default value is 0.
+ */
+#define TRC_CFG_STREAM_PORT_USE_FILE 0
+
+/**
+ * @def TRC_CFG_STREAM_PORT_USE_RINGBUFFER
+ *
+ * @brief Keeps the trace in a ring buffer in RAM, like the RingBuffer stream
+ * port. The ring buffer also holds the header, timestamp information and entry
+ * table, so it can be read with a debugger and loaded into Tracealyzer as a
+ * memory dump.
+ *
+ * Default value is 1.
+ */
+#define TRC_CFG_STREAM_PORT_USE_RINGBUFFER 1
+
+/**
+ * @def TRC_CFG_STREAM_PORT_RTT_POLICY
+ *
+ * @brief What RTT does when the up buffer is full.
+ *
+ * Possible values:
+ * - TRC_STREAM_PORT_POLICY_DROP (default)
+ * - TRC_STREAM_PORT_POLICY_BLOCK
+ * - TRC_STREAM_PORT_POLICY_DETACH
+ * - TRC_STREAM_PORT_POLICY_STOP
+ *
+ * With TRC_STREAM_PORT_POLICY_BLOCK, every event waits for the J-Link probe
+ * to make room, which also delays the other destinations. With the other
+ * policies, RTT never waits and Tracealyzer reports the lost events.
+ */
+#define TRC_CFG_STREAM_PORT_RTT_POLICY TRC_STREAM_PORT_POLICY_DROP
+
+/**
+ * @def TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_SIZE
+ *
+ * @brief Defines the size of the "up" RTT buffer (target -> host) to use for writing
+ * the trace data, for RTT buffer 1 or higher.
+ *
+ * Default value is 5000.
+ */
+#define TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_SIZE 5000
+
+/**
+ * @def TRC_CFG_STREAM_PORT_RTT_DOWN_BUFFER_SIZE
+ *
+ * @brief Defines the size of the "down" RTT buffer (host -> target) to use for reading
+ * commands from Tracealyzer, for RTT buffer 1 or higher.
+ *
+ * Default value is 32.
+ */
+#define TRC_CFG_STREAM_PORT_RTT_DOWN_BUFFER_SIZE 32
+
+/**
+ * @def TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX
+ *
+ * @brief Defines the RTT buffer to use for writing the trace data. Make sure that
+ * the PC application has the same setting (File->Settings).
+ *
+ * Default value is 1.
+ */
+#define TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX 1
+
+/**
+ * @def TRC_CFG_STREAM_PORT_RTT_DOWN_BUFFER_INDEX
+ *
+ * @brief Defines the RTT buffer to use for reading the trace data. Make sure that
+ * the PC application has the same setting (File->Settings).
+ *
+ * Default value is 1.
+ */
+#define TRC_CFG_STREAM_PORT_RTT_DOWN_BUFFER_INDEX 1
+
+/**
+ * @def TRC_CFG_STREAM_PORT_FILE_POLICY
+ *
+ * @brief What the file does when a write fails. fwrite only returns once the
+ * data is written, so a failed write means the file can't take more data.
+ *
+ * Possible values:
+ * - TRC_STREAM_PORT_POLICY_DROP
+ * - TRC_STREAM_PORT_POLICY_DETACH (default)
+ * - TRC_STREAM_PORT_POLICY_STOP
+ */
+#define TRC_CFG_STREAM_PORT_FILE_POLICY TRC_STREAM_PORT_POLICY_DETACH
+
+/**
+ * @def TRC_CFG_STREAM_PORT_TRACE_FILE
+ *
+ * @brief The name of the trace file.
+ *
+ * Default value is "trace.psf".
+ */
+#define TRC_CFG_STREAM_PORT_TRACE_FILE "trace.psf"
+
+/**
+ * @def TRC_CFG_STREAM_PORT_RINGBUFFER_POLICY
+ *
+ * @brief What the ring buffer does when it is full.
+ *
+ * Possible values:
+ * - TRC_STREAM_PORT_POLICY_OVERWRITE (default)
+ * - TRC_STREAM_PORT_POLICY_DROP
+ * - TRC_STREAM_PORT_POLICY_DETACH
+ * - TRC_STREAM_PORT_POLICY_STOP
+ *
+ * With TRC_STREAM_PORT_POLICY_OVERWRITE, the oldest events are overwritten and
+ * the ring buffer keeps the events leading up to e.g. an error. With
+ * TRC_STREAM_PORT_POLICY_DETACH, it keeps the first events after tracing was
+ * started, e.g. the startup sequence, while the other destinations go on.
+ */
+#define TRC_CFG_STREAM_PORT_RINGBUFFER_POLICY TRC_STREAM_PORT_POLICY_OVERWRITE
+
+/**
+ * @def TRC_CFG_STREAM_PORT_BUFFER_SIZE
+ *
+ * @brief Defines the size of the ring buffer use for storing trace events.
+ *
+ * Default value is 10000.
+ */
+#define TRC_CFG_STREAM_PORT_BUFFER_SIZE 10000
+
+/**
+ * @def TRC_CFG_STREAM_PORT_RINGBUFFER_TRIGGER_EVENTS
+ *
+ * @brief Configures how many events are stored in the ring buffer after
+ * xTraceTrigger().
+ *
+ * Once these events have been stored, the ring buffer is detached and no
+ * longer overwritten, while the other destinations go on. The recorder is only
+ * stopped if no other destination is left. With 0, the ring buffer is detached
+ * at the trigger.
+ *
+ * Default value is 100.
+ */
+#define TRC_CFG_STREAM_PORT_RINGBUFFER_TRIGGER_EVENTS 100
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*(TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)*/
+
+#endif /*(TRC_USE_TRACEALYZER_RECORDER == 1)*/
+
+#endif /* TRC_STREAM_PORT_CONFIG_H */
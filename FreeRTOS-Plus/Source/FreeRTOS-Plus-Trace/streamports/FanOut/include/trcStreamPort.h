@@ -0,0 +1,345 @@
+/*
+* Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* The interface definitions for trace streaming ("stream ports").
+* This "stream port" sets up the recorder to stream to several destinations
+* at once: SEGGER RTT, a file and a Ring Buffer.
+*/
+
+#ifndef TRC_STREAM_PORT_H
+#define TRC_STREAM_PORT_H
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <trcTypes.h>
+#include <trcStreamPortConfig.h>
+#include <trcRecorder.h>
+
+#if (TRC_CFG_STREAM_PORT_USE_RTT == 1)
+/* The RTT driver is shared with the Jlink_RTT stream port */
+#include "../../Jlink_RTT/include/SEGGER_RTT_Conf.h"
+#include "../../Jlink_RTT/include/SEGGER_RTT.h"
+#endif
+
+#if (TRC_CFG_STREAM_PORT_USE_FILE == 1)
+#include <stdio.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (TRC_CFG_STREAM_PORT_USE_RTT == 0) && (TRC_CFG_STREAM_PORT_USE_FILE == 0) && (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 0)
+#error "Trace Recorder: At least one of TRC_CFG_STREAM_PORT_USE_RTT, TRC_CFG_STREAM_PORT_USE_FILE and TRC_CFG_STREAM_PORT_USE_RINGBUFFER must be 1 in trcStreamPortConfig.h."
+#endif
+
+#if (TRC_CFG_STREAM_PORT_USE_RTT == 1) && (TRC_CFG_STREAM_PORT_RTT_POLICY == TRC_STREAM_PORT_POLICY_OVERWRITE)
+#error "Trace Recorder: TRC_STREAM_PORT_POLICY_OVERWRITE is only supported by the ring buffer."
+#endif
+
+#if (TRC_CFG_STREAM_PORT_USE_FILE == 1) && ((TRC_CFG_STREAM_PORT_FILE_POLICY == TRC_STREAM_PORT_POLICY_OVERWRITE) || (TRC_CFG_STREAM_PORT_FILE_POLICY == TRC_STREAM_PORT_POLICY_BLOCK))
+#error "Trace Recorder: TRC_CFG_STREAM_PORT_FILE_POLICY must be TRC_STREAM_PORT_POLICY_DROP, TRC_STREAM_PORT_POLICY_DETACH or TRC_STREAM_PORT_POLICY_STOP."
+#endif
+
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1) && (TRC_CFG_STREAM_PORT_RINGBUFFER_POLICY == TRC_STREAM_PORT_POLICY_BLOCK)
+#error "Trace Recorder: TRC_STREAM_PORT_POLICY_BLOCK is only supported by RTT."
+#endif
+
+/**
+ * @def TRC_EXTERNAL_BUFFERS
+ *
+ * @brief With the ring buffer, this Stream Port houses the EntryTable and
+ * Timestamp buffers, and writes them to the other destinations when tracing
+ * begins.
+ */
+#define TRC_EXTERNAL_BUFFERS (TRC_CFG_STREAM_PORT_USE_RINGBUFFER)
+
+/**
+ * @def TRC_SEND_NAME_ONLY_ON_DELETE
+ *
+ * @brief Names are only sent when objects are deleted if nothing is streamed
+ * live, since the ring buffer keeps the entry table.
+ */
+#if (TRC_CFG_STREAM_PORT_USE_RTT == 0) && (TRC_CFG_STREAM_PORT_USE_FILE == 0)
+#define TRC_SEND_NAME_ONLY_ON_DELETE 1
+#else
+#define TRC_SEND_NAME_ONLY_ON_DELETE 0
+#endif
+
+/**
+ * @def TRC_USE_INTERNAL_BUFFER
+ *
+ * @brief This Stream Port writes every event to its destinations when it is
+ * committed.
+ */
+#define TRC_USE_INTERNAL_BUFFER 0
+
+/* Destination indexes, see xTraceFanOutGetStatus(...) */
+#define TRC_STREAM_PORT_DESTINATION_RTT			(0U)
+#define TRC_STREAM_PORT_DESTINATION_FILE		(1U)
+#define TRC_STREAM_PORT_DESTINATION_RINGBUFFER	(2U)
+#define TRC_STREAM_PORT_DESTINATION_COUNT		(3U)
+
+/* Aligned */
+#define TRC_STREAM_PORT_RTT_UP_BUFFER_SIZE ((((TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_SIZE) + sizeof(TraceUnsignedBaseType_t) - 1) / sizeof(TraceUnsignedBaseType_t)) * sizeof(TraceUnsignedBaseType_t))
+
+/* Aligned */
+#define TRC_STREAM_PORT_RTT_DOWN_BUFFER_SIZE ((((TRC_CFG_STREAM_PORT_RTT_DOWN_BUFFER_SIZE) + sizeof(TraceUnsignedBaseType_t) - 1) / sizeof(TraceUnsignedBaseType_t)) * sizeof(TraceUnsignedBaseType_t))
+
+#define TRC_STREAM_PORT_BUFFER_SIZE ((((TRC_CFG_STREAM_PORT_BUFFER_SIZE) + sizeof(uint32_t) - 1) / sizeof(uint32_t)) * sizeof(uint32_t))
+
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+
+/**
+* @brief
+*/
+typedef struct TraceMultiCoreBuffer
+{
+	uint32_t uiSize;
+	uint8_t uiBuffer[TRC_STREAM_PORT_BUFFER_SIZE];
+} TraceMultiCoreBuffer_t;
+
+/**
+ * @brief The ring buffer, laid out as in the RingBuffer stream port so that
+ * memory dumps load the same way.
+ */
+typedef struct TraceRingBuffer
+{
+	volatile uint8_t START_MARKERS[12];
+	TraceHeaderBuffer_t xHeaderBuffer;
+	TraceTimestampBuffer_t xTimestampInfo;
+	TraceEntryTableBuffer_t xEntryTableBuffer;
+	TraceMultiCoreBuffer_t xEventBuffer;
+	volatile uint8_t END_MARKERS[12];
+} TraceRingBuffer_t;
+
+#endif /* (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1) */
+
+/**
+ * @brief The state of one destination.
+ */
+typedef struct TraceStreamPortDestination
+{
+	uint32_t uiAttached;				/**< Written to. Cleared by TRC_STREAM_PORT_POLICY_DETACH */
+	uint32_t uiDroppedEvents;			/**< Events and blocks the destination couldn't take */
+} TraceStreamPortDestination_t;
+
+/**
+ * @brief
+ */
+typedef struct TraceStreamPortData
+{
+	TraceStreamPortDestination_t xDestinations[TRC_STREAM_PORT_DESTINATION_COUNT];
+#if (TRC_CFG_STREAM_PORT_USE_FILE == 1)
+	FILE* pxFile;
+#endif
+#if (TRC_CFG_STREAM_PORT_USE_RTT == 1)
+	uint8_t bufferUp[TRC_STREAM_PORT_RTT_UP_BUFFER_SIZE];
+	uint8_t bufferDown[TRC_STREAM_PORT_RTT_DOWN_BUFFER_SIZE];
+#endif
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+	TraceMultiCoreEventBuffer_t xMultiCoreEventBuffer;
+	uint32_t uiTriggered;
+	uint32_t uiTriggerEventsLeft;
+	TraceRingBuffer_t xRingBuffer;
+#endif
+} TraceStreamPortData_t;
+
+/**
+ * @brief A function writing data to an interface, like xTraceStreamPortWriteData.
+ */
+typedef traceResult (*TraceRingBufferWrite_t)(void* pvData, uint32_t uiSize, int32_t* piBytesWritten);
+
+extern TraceStreamPortData_t* pxStreamPortData;
+
+/**
+* @def TRC_STREAM_PORT_DATA_BUFFER_SIZE
+* @brief The buffer size, aligned to base type.
+*/
+#define TRC_STREAM_PORT_DATA_BUFFER_SIZE (sizeof(TraceStreamPortData_t))
+
+/**
+ * @brief A structure representing the trace stream port buffer.
+ */
+typedef struct TraceStreamPortBuffer
+{
+	uint8_t buffer[(TRC_STREAM_PORT_DATA_BUFFER_SIZE)];
+} TraceStreamPortBuffer_t;
+
+/**
+ * @internal Stream port initialize callback.
+ *
+ * This function is called by the recorder as part of its initialization phase.
+ *
+ * @param[in] pxBuffer Buffer
+ *
+ * @retval TRC_FAIL Initialization failed
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
+
+/**
+ * @brief Allocates data from the stream port.
+ *
+ * While the ring buffer is attached, the event is written in place in the
+ * ring buffer, and the same block is then written to the other destinations.
+ *
+ * @param[in] uiSize Allocation size
+ * @param[out] ppvData Allocation data pointer
+ *
+ * @retval TRC_FAIL Allocate failed
+ * @retval TRC_SUCCESS Success
+ */
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+traceResult xTraceStreamPortAllocate(uint32_t uiSize, void** ppvData);
+#else
+#define xTraceStreamPortAllocate(uiSize, ppvData) ((void)(uiSize), xTraceStaticBufferGet(ppvData))
+#endif
+
+/**
+ * @brief Commits data to the stream port. The data is given to every attached
+ * destination, and each one handles being full by its own policy.
+ *
+ * @param[in] pvData Data to commit
+ * @param[in] uiSize Data to commit size
+ * @param[out] piBytesCommitted Bytes commited, 0 if no attached destination took the data
+ *
+ * @retval TRC_FAIL Commit failed
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceStreamPortCommit(void* pvData, uint32_t uiSize, int32_t* piBytesCommitted);
+
+/**
+ * @brief Writes data to the attached live destinations, RTT and the file.
+ *
+ * @param[in] pvData Data to write
+ * @param[in] uiSize Data to write size
+ * @param[out] piBytesWritten Bytes written, 0 if no attached destination took the data
+ *
+ * @retval TRC_FAIL Write failed
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceStreamPortWriteData(void* pvData, uint32_t uiSize, int32_t* piBytesWritten);
+
+/**
+ * @brief Reads data through the stream port interface. Commands are only read
+ * from RTT.
+ *
+ * @param[in] pvData Destination data buffer
+ * @param[in] uiSize Destination data buffer size
+ * @param[out] piBytesRead Bytes read
+ *
+ * @retval TRC_FAIL Read failed
+ * @retval TRC_SUCCESS Success
+ */
+#if (TRC_CFG_STREAM_PORT_USE_RTT == 1)
+#define xTraceStreamPortReadData(pvData, uiSize, piBytesRead) ((SEGGER_RTT_HASDATA(TRC_CFG_STREAM_PORT_RTT_DOWN_BUFFER_INDEX)) ? (*(piBytesRead) = (int32_t)SEGGER_RTT_Read((TRC_CFG_STREAM_PORT_RTT_DOWN_BUFFER_INDEX), (char*)(pvData), uiSize), TRC_SUCCESS) : TRC_SUCCESS)
+#else
+#define xTraceStreamPortReadData(pvData, uiSize, piBytesRead) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_4((void)pvData, (void)uiSize, (void)piBytesRead, TRC_SUCCESS)
+#endif
+
+/**
+ * @brief Callback for when recorder is enabled
+ *
+ * @param[in] uiStartOption Start option used when enabling trace recorder
+ *
+ * @retval TRC_FAIL Read failed
+ * @retval TRC_SUCCESS Success
+ */
+#if (TRC_CFG_STREAM_PORT_USE_RTT == 1)
+traceResult xTraceStreamPortOnEnable(uint32_t uiStartOption);
+#else
+#define xTraceStreamPortOnEnable(uiStartOption) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2((void)(uiStartOption), TRC_SUCCESS)
+#endif
+
+/**
+ * @brief Callback for when recorder is disabled
+ *
+ * @retval TRC_FAIL Read failed
+ * @retval TRC_SUCCESS Success
+ */
+#define xTraceStreamPortOnDisable() TRC_COMMA_EXPR_TO_STATEMENT_EXPR_1(TRC_SUCCESS)
+
+/**
+ * @brief Callback for when tracing begins. Attaches all destinations again.
+ *
+ * @retval TRC_FAIL Read failed
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceStreamPortOnTraceBegin(void);
+
+/**
+ * @brief Callback for when tracing ends
+ *
+ * @retval TRC_FAIL Read failed
+ * @retval TRC_SUCCESS Success
+ */
+#if (TRC_CFG_STREAM_PORT_USE_FILE == 1)
+traceResult xTraceStreamPortOnTraceEnd(void);
+#else
+#define xTraceStreamPortOnTraceEnd() TRC_COMMA_EXPR_TO_STATEMENT_EXPR_1(TRC_SUCCESS)
+#endif
+
+/**
+ * @brief Gets the state of a destination.
+ *
+ * @param[in] uiDestination Destination, e.g. TRC_STREAM_PORT_DESTINATION_RTT
+ * @param[out] puiAttached 1 if the destination is written to
+ * @param[out] puiDroppedEvents Events the destination couldn't take since tracing began
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceFanOutGetStatus(uint32_t uiDestination, uint32_t* puiAttached, uint32_t* puiDroppedEvents);
+
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+
+/**
+ * @brief Callback for when the trace is triggered. The ring buffer is detached
+ * after TRC_CFG_STREAM_PORT_RINGBUFFER_TRIGGER_EVENTS more events.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+#define xTraceStreamPortOnTrigger() xTraceRingBufferTrigger()
+
+/**
+ * @internal Starts the countdown to the freeze.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceRingBufferTrigger(void);
+
+/**
+ * @brief Writes the ring buffer, as it is in RAM, through a write function.
+ * The data can be loaded into Tracealyzer like a memory dump taken with a
+ * debugger.
+ *
+ * The ring buffer must be detached, or the recorder stopped, first so the
+ * buffer doesn't change meanwhile.
+ *
+ * @param[in] xWrite Write function, called until all data has been written
+ *
+ * @retval TRC_FAIL Ring buffer in use, or the write failed or made no progress
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceRingBufferDump(TraceRingBufferWrite_t xWrite);
+
+#endif /* (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*(TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)*/
+
+#endif /*(TRC_USE_TRACEALYZER_RECORDER == 1)*/
+
+#endif /* TRC_STREAM_PORT_H */
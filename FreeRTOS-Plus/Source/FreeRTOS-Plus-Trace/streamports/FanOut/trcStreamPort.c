@@ -0,0 +1,516 @@
+/*
+* Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* Supporting functions for trace streaming, used by the "stream ports"
+* for reading and writing data to the interface.
+* This "stream port" sets up the recorder to stream to several destinations
+* at once: SEGGER RTT, a file and a Ring Buffer.
+*/
+
+#include <trcRecorder.h>
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+#if (TRC_CFG_STREAMING_COMPACT == 1)
+#error "The ring buffer is read as standard events, TRC_CFG_STREAMING_COMPACT must be 0"
+#endif
+
+/* Backwards compatibility with plugins */
+typedef TraceRingBuffer_t RecorderData;
+RecorderData* RecorderDataPtr = 0;
+#endif
+
+TraceStreamPortData_t* pxStreamPortData;
+
+/* Handles a destination that couldn't take an event, by its policy */
+static void prvTraceStreamPortDropped(uint32_t uiDestination, uint32_t uiPolicy);
+
+/* Stops writing to a destination, and stops the recorder if it was the last one */
+static void prvTraceStreamPortDetach(uint32_t uiDestination);
+
+/* Gets the number of attached destinations */
+static uint32_t prvTraceStreamPortGetAttachedCount(void);
+
+/* Writes to the attached live destinations, returns how many took the data */
+static uint32_t prvTraceStreamPortWriteLive(void* pvData, uint32_t uiSize);
+
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+/* Writes the ring buffer's header, timestamp info and entry table to the live destinations */
+static void prvTraceStreamPortWriteBuffers(void);
+#endif
+
+traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer)
+{
+	uint32_t i;
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+	TraceRingBuffer_t* pxRingBuffer;
+#endif
+
+	TRC_ASSERT_EQUAL_SIZE(TraceStreamPortBuffer_t, TraceStreamPortData_t);
+
+	if (pxBuffer == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	pxStreamPortData = (TraceStreamPortData_t*)pxBuffer;
+
+	for (i = 0; i < (TRC_STREAM_PORT_DESTINATION_COUNT); i++)
+	{
+		pxStreamPortData->xDestinations[i].uiAttached = 0;
+		pxStreamPortData->xDestinations[i].uiDroppedEvents = 0;
+	}
+
+#if (TRC_CFG_STREAM_PORT_USE_FILE == 1)
+	pxStreamPortData->pxFile = 0;
+#endif
+
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+	RecorderDataPtr = pxRingBuffer = &pxStreamPortData->xRingBuffer;
+
+	pxStreamPortData->uiTriggered = 0;
+	pxStreamPortData->uiTriggerEventsLeft = 0;
+
+	pxRingBuffer->xEventBuffer.uiSize = sizeof(pxRingBuffer->xEventBuffer.uiBuffer);
+
+#if (TRC_CFG_STREAM_PORT_RINGBUFFER_POLICY == TRC_STREAM_PORT_POLICY_OVERWRITE)
+	if (xTraceMultiCoreEventBufferInitialize(&pxStreamPortData->xMultiCoreEventBuffer, TRC_EVENT_BUFFER_OPTION_OVERWRITE, pxRingBuffer->xEventBuffer.uiBuffer, sizeof(pxRingBuffer->xEventBuffer.uiBuffer)) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+#else
+	if (xTraceMultiCoreEventBufferInitialize(&pxStreamPortData->xMultiCoreEventBuffer, TRC_EVENT_BUFFER_OPTION_SKIP, pxRingBuffer->xEventBuffer.uiBuffer, sizeof(pxRingBuffer->xEventBuffer.uiBuffer)) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+#endif
+
+	if (xTraceHeaderInitialize(&pxRingBuffer->xHeaderBuffer) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+
+	if (xTraceEntryTableInitialize(&pxRingBuffer->xEntryTableBuffer) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+
+	if (xTraceTimestampInitialize(&pxRingBuffer->xTimestampInfo) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+
+	pxRingBuffer->END_MARKERS[0] = 0x0A;
+	pxRingBuffer->END_MARKERS[1] = 0x0B;
+	pxRingBuffer->END_MARKERS[2] = 0x0C;
+	pxRingBuffer->END_MARKERS[3] = 0x0D;
+
+	pxRingBuffer->END_MARKERS[4] = 0x71;
+	pxRingBuffer->END_MARKERS[5] = 0x72;
+	pxRingBuffer->END_MARKERS[6] = 0x73;
+	pxRingBuffer->END_MARKERS[7] = 0x74;
+
+	pxRingBuffer->END_MARKERS[8] = 0xF1;
+	pxRingBuffer->END_MARKERS[9] = 0xF2;
+	pxRingBuffer->END_MARKERS[10] = 0xF3;
+	pxRingBuffer->END_MARKERS[11] = 0xF4;
+
+	pxRingBuffer->START_MARKERS[0] = 0x05;
+	pxRingBuffer->START_MARKERS[1] = 0x06;
+	pxRingBuffer->START_MARKERS[2] = 0x07;
+	pxRingBuffer->START_MARKERS[3] = 0x08;
+
+	pxRingBuffer->START_MARKERS[4] = 0x75;
+	pxRingBuffer->START_MARKERS[5] = 0x76;
+	pxRingBuffer->START_MARKERS[6] = 0x77;
+	pxRingBuffer->START_MARKERS[7] = 0x78;
+
+	pxRingBuffer->START_MARKERS[8] = 0xF5;
+	pxRingBuffer->START_MARKERS[9] = 0xF6;
+	pxRingBuffer->START_MARKERS[10] = 0xF7;
+	pxRingBuffer->START_MARKERS[11] = 0xF8;
+#endif
+
+	return TRC_SUCCESS;
+}
+
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+traceResult xTraceStreamPortAllocate(uint32_t uiSize, void** ppvData)
+{
+	/* A detached ring buffer must not be written, even in place */
+	if (pxStreamPortData->xDestinations[TRC_STREAM_PORT_DESTINATION_RINGBUFFER].uiAttached == 0)
+	{
+		return xTraceStaticBufferGet(ppvData);
+	}
+
+	return xTraceMultiCoreEventBufferAllocate(&pxStreamPortData->xMultiCoreEventBuffer, uiSize, ppvData);
+}
+#endif
+
+traceResult xTraceStreamPortCommit(void* pvData, uint32_t uiSize, int32_t* piBytesCommitted)
+{
+	uint32_t uiAccepted = 0;
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+	int32_t iBytesCommitted = 0;
+#endif
+
+	if (pvData == 0)
+	{
+		return TRC_FAIL;
+	}
+
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+	/* Commits are made inside the event critical section */
+	if (pxStreamPortData->xDestinations[TRC_STREAM_PORT_DESTINATION_RINGBUFFER].uiAttached != 0)
+	{
+		xTraceMultiCoreEventBufferCommit(&pxStreamPortData->xMultiCoreEventBuffer, pvData, uiSize, &iBytesCommitted);
+
+		if (uiSize > 0 && iBytesCommitted == 0)
+		{
+			prvTraceStreamPortDropped(TRC_STREAM_PORT_DESTINATION_RINGBUFFER, TRC_CFG_STREAM_PORT_RINGBUFFER_POLICY);
+		}
+		else
+		{
+			uiAccepted++;
+
+			if (pxStreamPortData->uiTriggered != 0)
+			{
+				if (pxStreamPortData->uiTriggerEventsLeft > 0)
+				{
+					pxStreamPortData->uiTriggerEventsLeft--;
+				}
+
+				if (pxStreamPortData->uiTriggerEventsLeft == 0)
+				{
+					/* Freeze the buffer */
+					prvTraceStreamPortDetach(TRC_STREAM_PORT_DESTINATION_RINGBUFFER);
+				}
+			}
+		}
+	}
+#endif
+
+	/* The live destinations get the same block, wherever it was allocated */
+	uiAccepted += prvTraceStreamPortWriteLive(pvData, uiSize);
+
+	/* With nothing attached the data can't ever be taken, so it isn't retried */
+	*piBytesCommitted = (uiAccepted > 0 || prvTraceStreamPortGetAttachedCount() == 0) ? (int32_t)uiSize : 0;
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceStreamPortWriteData(void* pvData, uint32_t uiSize, int32_t* piBytesWritten)
+{
+	uint32_t uiAccepted;
+
+	if (pvData == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	uiAccepted = prvTraceStreamPortWriteLive(pvData, uiSize);
+
+	*piBytesWritten = (uiAccepted > 0 || prvTraceStreamPortGetAttachedCount() == 0) ? (int32_t)uiSize : 0;
+
+	return TRC_SUCCESS;
+}
+
+#if (TRC_CFG_STREAM_PORT_USE_RTT == 1)
+traceResult xTraceStreamPortOnEnable(uint32_t uiStartOption)
+{
+	(void)uiStartOption;
+
+	/* Configure the RTT buffers. Only the block policy waits for room, the
+	 * others need an event to be written whole or not at all. */
+#if (TRC_CFG_STREAM_PORT_RTT_POLICY == TRC_STREAM_PORT_POLICY_BLOCK)
+	SEGGER_RTT_ConfigUpBuffer(TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX, "TzData", pxStreamPortData->bufferUp, sizeof(pxStreamPortData->bufferUp), SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL);
+	SEGGER_RTT_ConfigDownBuffer(TRC_CFG_STREAM_PORT_RTT_DOWN_BUFFER_INDEX, "TzCtrl", pxStreamPortData->bufferDown, sizeof(pxStreamPortData->bufferDown), SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL);
+#else
+	SEGGER_RTT_ConfigUpBuffer(TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX, "TzData", pxStreamPortData->bufferUp, sizeof(pxStreamPortData->bufferUp), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+	SEGGER_RTT_ConfigDownBuffer(TRC_CFG_STREAM_PORT_RTT_DOWN_BUFFER_INDEX, "TzCtrl", pxStreamPortData->bufferDown, sizeof(pxStreamPortData->bufferDown), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+#endif
+
+	return TRC_SUCCESS;
+}
+#endif
+
+traceResult xTraceStreamPortOnTraceBegin(void)
+{
+	uint32_t i;
+
+	if (pxStreamPortData == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	for (i = 0; i < (TRC_STREAM_PORT_DESTINATION_COUNT); i++)
+	{
+		pxStreamPortData->xDestinations[i].uiAttached = 0;
+		pxStreamPortData->xDestinations[i].uiDroppedEvents = 0;
+	}
+
+#if (TRC_CFG_STREAM_PORT_USE_RTT == 1)
+	pxStreamPortData->xDestinations[TRC_STREAM_PORT_DESTINATION_RTT].uiAttached = 1;
+#endif
+
+#if (TRC_CFG_STREAM_PORT_USE_FILE == 1)
+	if (pxStreamPortData->pxFile == 0)
+	{
+		pxStreamPortData->pxFile = fopen(TRC_CFG_STREAM_PORT_TRACE_FILE, "wb");
+	}
+
+	/* The other destinations go on without it */
+	pxStreamPortData->xDestinations[TRC_STREAM_PORT_DESTINATION_FILE].uiAttached = (pxStreamPortData->pxFile != 0) ? 1 : 0;
+#endif
+
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+	/* A new trace can be triggered again */
+	pxStreamPortData->uiTriggered = 0;
+	pxStreamPortData->uiTriggerEventsLeft = 0;
+
+	pxStreamPortData->xDestinations[TRC_STREAM_PORT_DESTINATION_RINGBUFFER].uiAttached = 1;
+
+	/* The recorder doesn't store these when the stream port houses them */
+	prvTraceStreamPortWriteBuffers();
+
+	return xTraceMultiCoreEventBufferClear(&pxStreamPortData->xMultiCoreEventBuffer);
+#else
+	return TRC_SUCCESS;
+#endif
+}
+
+#if (TRC_CFG_STREAM_PORT_USE_FILE == 1)
+traceResult xTraceStreamPortOnTraceEnd(void)
+{
+	if (pxStreamPortData == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	if (pxStreamPortData->pxFile != 0)
+	{
+		fclose(pxStreamPortData->pxFile);
+		pxStreamPortData->pxFile = 0;
+	}
+
+	pxStreamPortData->xDestinations[TRC_STREAM_PORT_DESTINATION_FILE].uiAttached = 0;
+
+	return TRC_SUCCESS;
+}
+#endif
+
+traceResult xTraceFanOutGetStatus(uint32_t uiDestination, uint32_t* puiAttached, uint32_t* puiDroppedEvents)
+{
+	/* This should never fail */
+	TRC_ASSERT(puiAttached != 0);
+
+	/* This should never fail */
+	TRC_ASSERT(puiDroppedEvents != 0);
+
+	/* We need to check this */
+	if (pxStreamPortData == 0 || uiDestination >= (TRC_STREAM_PORT_DESTINATION_COUNT))
+	{
+		return TRC_FAIL;
+	}
+
+	*puiAttached = pxStreamPortData->xDestinations[uiDestination].uiAttached;
+	*puiDroppedEvents = pxStreamPortData->xDestinations[uiDestination].uiDroppedEvents;
+
+	return TRC_SUCCESS;
+}
+
+#if (TRC_CFG_STREAM_PORT_USE_RINGBUFFER == 1)
+traceResult xTraceRingBufferTrigger(void)
+{
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	/* Only the first trigger counts */
+	if (pxStreamPortData->uiTriggered == 0 && pxStreamPortData->xDestinations[TRC_STREAM_PORT_DESTINATION_RINGBUFFER].uiAttached != 0)
+	{
+		pxStreamPortData->uiTriggered = 1;
+		pxStreamPortData->uiTriggerEventsLeft = (TRC_CFG_STREAM_PORT_RINGBUFFER_TRIGGER_EVENTS);
+
+		if (pxStreamPortData->uiTriggerEventsLeft == 0)
+		{
+			/* Freeze the buffer */
+			prvTraceStreamPortDetach(TRC_STREAM_PORT_DESTINATION_RINGBUFFER);
+		}
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceRingBufferDump(TraceRingBufferWrite_t xWrite)
+{
+	uint8_t* puiData;
+	uint32_t uiBytesLeft;
+	int32_t iBytesWritten;
+
+	/* This should never fail */
+	TRC_ASSERT(xWrite != 0);
+
+	/* We need to check this */
+	if (pxStreamPortData == 0 || (xTraceIsRecorderEnabled() && pxStreamPortData->xDestinations[TRC_STREAM_PORT_DESTINATION_RINGBUFFER].uiAttached != 0))
+	{
+		return TRC_FAIL;
+	}
+
+	puiData = (uint8_t*)&pxStreamPortData->xRingBuffer;
+	uiBytesLeft = sizeof(pxStreamPortData->xRingBuffer);
+
+	while (uiBytesLeft > 0)
+	{
+		iBytesWritten = 0;
+
+		if (xWrite(puiData, uiBytesLeft, &iBytesWritten) == TRC_FAIL || iBytesWritten <= 0)
+		{
+			return TRC_FAIL;
+		}
+
+		if ((uint32_t)iBytesWritten > uiBytesLeft)
+		{
+			iBytesWritten = (int32_t)uiBytesLeft;
+		}
+
+		puiData += iBytesWritten;
+		uiBytesLeft -= (uint32_t)iBytesWritten;
+	}
+
+	return TRC_SUCCESS;
+}
+
+/* Same format as prvTraceStoreHeader(), prvTraceStoreTimestampInfo() and
+ * prvTraceStoreEntryTable() in trcStreamingRecorder.c */
+static void prvTraceStreamPortWriteBuffers(void)
+{
+	uint32_t i;
+	uint32_t uiEntryTableInfo[3];
+	TraceEntryHandle_t xEntryHandle;
+	void* pvEntryAddress;
+
+	prvTraceStreamPortWriteLive(&pxStreamPortData->xRingBuffer.xHeaderBuffer, sizeof(TraceHeaderBuffer_t));
+	prvTraceStreamPortWriteLive(&pxStreamPortData->xRingBuffer.xTimestampInfo, sizeof(TraceTimestampBuffer_t));
+
+	xTraceEntryGetCount(&uiEntryTableInfo[0]);
+	uiEntryTableInfo[1] = TRC_ENTRY_TABLE_SLOT_SYMBOL_SIZE;
+	uiEntryTableInfo[2] = TRC_ENTRY_TABLE_STATE_COUNT;
+
+	prvTraceStreamPortWriteLive(uiEntryTableInfo, sizeof(uiEntryTableInfo));
+
+	for (i = 0; i < (TRC_ENTRY_TABLE_SLOTS); i++)
+	{
+		xTraceEntryGetAtIndex(i, &xEntryHandle);
+		xTraceEntryGetAddress(xEntryHandle, &pvEntryAddress);
+		/* We only send used entry slots */
+		if (pvEntryAddress != 0)
+		{
+			prvTraceStreamPortWriteLive((void*)xEntryHandle, sizeof(TraceEntry_t));
+		}
+	}
+}
+#endif
+
+static void prvTraceStreamPortDropped(uint32_t uiDestination, uint32_t uiPolicy)
+{
+	pxStreamPortData->xDestinations[uiDestination].uiDroppedEvents++;
+
+	switch (uiPolicy)
+	{
+		case TRC_STREAM_PORT_POLICY_DETACH:
+		{
+			prvTraceStreamPortDetach(uiDestination);
+
+			break;
+		}
+
+		case TRC_STREAM_PORT_POLICY_STOP:
+		{
+			xTraceDisable();
+
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+}
+
+static void prvTraceStreamPortDetach(uint32_t uiDestination)
+{
+	pxStreamPortData->xDestinations[uiDestination].uiAttached = 0;
+
+	/* Stop when there's nothing left to write to */
+	if (prvTraceStreamPortGetAttachedCount() == 0)
+	{
+		xTraceDisable();
+	}
+}
+
+static uint32_t prvTraceStreamPortGetAttachedCount(void)
+{
+	uint32_t i;
+	uint32_t uiCount = 0;
+
+	for (i = 0; i < (TRC_STREAM_PORT_DESTINATION_COUNT); i++)
+	{
+		uiCount += pxStreamPortData->xDestinations[i].uiAttached;
+	}
+
+	return uiCount;
+}
+
+static uint32_t prvTraceStreamPortWriteLive(void* pvData, uint32_t uiSize)
+{
+	uint32_t uiAccepted = 0;
+
+	(void)pvData;
+	(void)uiSize;
+
+#if (TRC_CFG_STREAM_PORT_USE_RTT == 1)
+	if (pxStreamPortData->xDestinations[TRC_STREAM_PORT_DESTINATION_RTT].uiAttached != 0)
+	{
+		/* The up buffer doesn't trim, so an event is written whole or not at all */
+		if (SEGGER_RTT_Write((TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX), (const char*)pvData, uiSize) == uiSize)
+		{
+			uiAccepted++;
+		}
+		else
+		{
+			prvTraceStreamPortDropped(TRC_STREAM_PORT_DESTINATION_RTT, TRC_CFG_STREAM_PORT_RTT_POLICY);
+		}
+	}
+#endif
+
+#if (TRC_CFG_STREAM_PORT_USE_FILE == 1)
+	if (pxStreamPortData->xDestinations[TRC_STREAM_PORT_DESTINATION_FILE].uiAttached != 0)
+	{
+		if (fwrite(pvData, 1, uiSize, pxStreamPortData->pxFile) == uiSize)
+		{
+			uiAccepted++;
+		}
+		else
+		{
+			prvTraceStreamPortDropped(TRC_STREAM_PORT_DESTINATION_FILE, TRC_CFG_STREAM_PORT_FILE_POLICY);
+		}
+	}
+#endif
+
+	return uiAccepted;
+}
+
+#endif /*(TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)*/
+
+#endif /*(TRC_USE_TRACEALYZER_RECORDER == 1)*/
@@ -15,6 +15,10 @@
 extern "C" {
 #endif
 
+/* File backends */
+#define TRC_STREAM_PORT_FILE_BACKEND_STDIO			(0U)
+#define TRC_STREAM_PORT_FILE_BACKEND_RELIANCE_EDGE	(1U)
+
 /* Default file name */
 #ifndef TRC_CFG_STREAM_PORT_TRACE_FILE
 #define TRC_CFG_STREAM_PORT_TRACE_FILE "trace.psf"
@@ -32,6 +36,37 @@ then the internal buffer must be enabled to avoid infinite recursion. */
 ******************************************************************************/
 #define TRC_CFG_STREAM_PORT_BUFFER_SIZE 10000
 
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_FILE_BACKEND
+*
+* Selects how the file is written.
+*
+* TRC_STREAM_PORT_FILE_BACKEND_STDIO writes through stdio.h (fwrite), e.g. on
+* the Win32 and Posix simulators.
+*
+* TRC_STREAM_PORT_FILE_BACKEND_RELIANCE_EDGE writes through the Reliance Edge
+* POSIX-like API (red_write), e.g. to an SD card on the target. The file system
+* must be initialized and mounted (red_init, red_mount) before tracing starts,
+* and TRC_CFG_STREAM_PORT_TRACE_FILE must be a path on a mounted volume. Since
+* Reliance Edge takes a mutex, the internal buffer must be enabled.
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_FILE_BACKEND TRC_STREAM_PORT_FILE_BACKEND_STDIO
+
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE
+*
+* Specifies the size of the blocks written to the file. The trace data is
+* gathered in a buffer of this size and written when the buffer is full, and
+* when tracing stops, so that the file is written in few large writes instead
+* of one per event or transfer. Data that is at least a whole block is written
+* directly. Set to 0 to write the data as it comes.
+*
+* With the internal buffer, the blocks are written by the TzCtrl task, so the
+* internal buffer must hold the events produced while a block is written.
+* Reduce the block size on targets with little RAM.
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE 65536
+
 #ifdef __cplusplus
 }
 #endif
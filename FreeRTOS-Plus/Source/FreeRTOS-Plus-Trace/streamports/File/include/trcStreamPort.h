@@ -19,7 +19,12 @@
 #include <stdint.h>
 #include <trcTypes.h>
 #include <trcStreamPortConfig.h>
+
+#if (TRC_CFG_STREAM_PORT_FILE_BACKEND == TRC_STREAM_PORT_FILE_BACKEND_RELIANCE_EDGE)
+#include <redposix.h>
+#else
 #include <stdio.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,11 +37,31 @@ extern "C" {
 #define TRC_CFG_STREAM_PORT_TRACE_FILE "trace.psf"
 #endif
 
+/* Default block size */
+#ifndef TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE
+#define TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE 0
+#endif
+
+#if (TRC_CFG_STREAM_PORT_FILE_BACKEND == TRC_STREAM_PORT_FILE_BACKEND_RELIANCE_EDGE) && (TRC_USE_INTERNAL_BUFFER == 0)
+#error "Trace Recorder: TRC_STREAM_PORT_FILE_BACKEND_RELIANCE_EDGE takes a mutex, so TRC_CFG_STREAM_PORT_USE_INTERNAL_BUFFER must be 1."
+#endif
+
+/* Aligned */
+#define TRC_STREAM_PORT_INTERNAL_BUFFER_SIZE ((((TRC_CFG_STREAM_PORT_BUFFER_SIZE) + sizeof(uint32_t) - 1) / sizeof(uint32_t)) * sizeof(uint32_t))
+
 typedef struct TraceStreamPortFile
 {
+#if (TRC_CFG_STREAM_PORT_FILE_BACKEND == TRC_STREAM_PORT_FILE_BACKEND_RELIANCE_EDGE)
+	int32_t iFile;								/* -1 while closed */
+#else
 	FILE* pxFile;
+#endif
+#if (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE > 0)
+	uint32_t uiBlockUsed;
+	uint8_t uiBlock[TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE];
+#endif
 #if (TRC_USE_INTERNAL_BUFFER)
-	uint8_t buffer[TRC_STREAM_PORT_BUFFER_SIZE];
+	uint8_t buffer[TRC_STREAM_PORT_INTERNAL_BUFFER_SIZE];
 #endif
 } TraceStreamPortFile_t;
 
@@ -51,17 +76,22 @@ typedef struct TraceStreamPortBuffer
 
 traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
 
+#if (TRC_USE_INTERNAL_BUFFER == 1)
+#define xTraceStreamPortAllocate xTraceInternalEventBufferAllocate
+#else
 #define xTraceStreamPortAllocate(uiSize, ppvData) ((void)(uiSize), xTraceStaticBufferGet(ppvData))
+#endif
 
 #if (TRC_USE_INTERNAL_BUFFER == 1)
 /* Push to internal buffer. It will call on xTraceStreamPortWriteData() periodically. */
-#define xTraceStreamPortCommit(pvData, uiSize, piBytesCommitted) xTraceInternalEventBufferPush(pvData, uiSize, piBytesCommitted)
+#define xTraceStreamPortCommit(pvData, uiSize, piBytesCommitted) xTraceInternalEventBufferCommit(pvData, uiSize, piBytesCommitted)
 #else
 /* Write directly to file */
 #define xTraceStreamPortCommit(pvData, uiSize, piBytesCommitted) xTraceStreamPortWriteData(pvData, uiSize, piBytesCommitted)
 #endif
 
-#define xTraceStreamPortWriteData(pvData, uiSize, piBytesWritten) (*(piBytesWritten) = fwrite(pvData, 1, uiSize, pxStreamPortFile->pxFile), TRC_SUCCESS)
+/* Gathers the data in blocks, see TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE */
+traceResult xTraceStreamPortWriteData(void* pvData, uint32_t uiSize, int32_t* piBytesWritten);
 
 #define xTraceStreamPortReadData(pvData, uiSize, piBytesRead) ((void)(pvData), (void)(uiSize), (void)(piBytesRead), TRC_SUCCESS)
 
@@ -19,6 +19,20 @@
 
 TraceStreamPortFile_t* pxStreamPortFile;
 
+/* Opens the trace file */
+static traceResult prvTraceStreamPortFileOpen(void);
+
+/* Closes the trace file */
+static void prvTraceStreamPortFileClose(void);
+
+/* Writes data to the trace file, all of it or fails */
+static traceResult prvTraceStreamPortFileWrite(void* pvData, uint32_t uiSize);
+
+#if (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE > 0)
+/* Writes the gathered block */
+static traceResult prvTraceStreamPortFileFlush(void);
+#endif
+
 traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer)
 {
 	TRC_ASSERT_EQUAL_SIZE(TraceStreamPortBuffer_t, TraceStreamPortFile_t);
@@ -26,7 +40,15 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer)
 	TRC_ASSERT(pxBuffer != 0);
 
 	pxStreamPortFile = (TraceStreamPortFile_t*)pxBuffer;
+#if (TRC_CFG_STREAM_PORT_FILE_BACKEND == TRC_STREAM_PORT_FILE_BACKEND_RELIANCE_EDGE)
+	pxStreamPortFile->iFile = -1;
+#else
 	pxStreamPortFile->pxFile = 0;
+#endif
+
+#if (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE > 0)
+	pxStreamPortFile->uiBlockUsed = 0;
+#endif
 
 #if (TRC_USE_INTERNAL_BUFFER == 1)
 	return xTraceInternalEventBufferInitialize(pxStreamPortFile->buffer, sizeof(pxStreamPortFile->buffer));
@@ -35,15 +57,166 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer)
 #endif
 }
 
+traceResult xTraceStreamPortWriteData(void* pvData, uint32_t uiSize, int32_t* piBytesWritten)
+{
+#if (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE > 0)
+	uint8_t* puiData = (uint8_t*)pvData;
+	uint32_t uiBytesLeft = uiSize;
+	uint32_t uiChunk;
+#endif
+
+#if (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE > 0)
+	while (uiBytesLeft > 0)
+	{
+		if (pxStreamPortFile->uiBlockUsed == 0 && uiBytesLeft >= (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE))
+		{
+			/* Whole blocks don't need to be gathered first */
+			uiChunk = (uiBytesLeft / (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE)) * (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE);
+
+			if (prvTraceStreamPortFileWrite(puiData, uiChunk) == TRC_FAIL)
+			{
+				break;
+			}
+		}
+		else
+		{
+			uiChunk = (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE) - pxStreamPortFile->uiBlockUsed;
+			uiChunk = uiChunk < uiBytesLeft ? uiChunk : uiBytesLeft;
+
+			TRC_MEMCPY(&pxStreamPortFile->uiBlock[pxStreamPortFile->uiBlockUsed], puiData, uiChunk);
+			pxStreamPortFile->uiBlockUsed += uiChunk;
+
+			if (pxStreamPortFile->uiBlockUsed == (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE) && prvTraceStreamPortFileFlush() == TRC_FAIL)
+			{
+				break;
+			}
+		}
+
+		puiData += uiChunk;
+		uiBytesLeft -= uiChunk;
+	}
+
+	if (uiBytesLeft > 0)
+	{
+		/* Reported as written anyway, so the data is dropped instead of
+		 * retried forever while the file keeps failing */
+		*piBytesWritten = (int32_t)uiSize;
+
+		return TRC_FAIL;
+	}
+#else
+	if (prvTraceStreamPortFileWrite(pvData, uiSize) == TRC_FAIL)
+	{
+		/* Reported as written anyway, so the data is dropped instead of
+		 * retried forever while the file keeps failing */
+		*piBytesWritten = (int32_t)uiSize;
+
+		return TRC_FAIL;
+	}
+#endif
+
+	*piBytesWritten = (int32_t)uiSize;
+
+	return TRC_SUCCESS;
+}
+
 traceResult xTraceStreamPortOnTraceBegin(void)
 {
 	if (pxStreamPortFile == 0)
 	{
 		return TRC_FAIL;
 	}
-	
+
+#if (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE > 0)
+	pxStreamPortFile->uiBlockUsed = 0;
+#endif
+
+	return prvTraceStreamPortFileOpen();
+}
+
+traceResult xTraceStreamPortOnTraceEnd(void)
+{
+	if (pxStreamPortFile == 0)
+	{
+		return TRC_FAIL;
+	}
+
+#if (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE > 0)
+	/* The rest of the trace */
+	(void)prvTraceStreamPortFileFlush();
+#endif
+
+	prvTraceStreamPortFileClose();
+
+	return TRC_SUCCESS;
+}
+
+#if (TRC_CFG_STREAM_PORT_FILE_BLOCK_SIZE > 0)
+static traceResult prvTraceStreamPortFileFlush(void)
+{
+	uint32_t uiBlockUsed = pxStreamPortFile->uiBlockUsed;
+
+	if (uiBlockUsed == 0)
+	{
+		return TRC_SUCCESS;
+	}
+
+	/* Dropped on failure, the file can't be trusted to take it later */
+	pxStreamPortFile->uiBlockUsed = 0;
+
+	return prvTraceStreamPortFileWrite(pxStreamPortFile->uiBlock, uiBlockUsed);
+}
+#endif
+
+#if (TRC_CFG_STREAM_PORT_FILE_BACKEND == TRC_STREAM_PORT_FILE_BACKEND_RELIANCE_EDGE)
+
+static traceResult prvTraceStreamPortFileOpen(void)
+{
+	if (pxStreamPortFile->iFile == -1)
+	{
+		pxStreamPortFile->iFile = red_open(TRC_CFG_STREAM_PORT_TRACE_FILE, RED_O_WRONLY | RED_O_CREAT | RED_O_TRUNC);
+		if (pxStreamPortFile->iFile == -1)
+		{
+			return TRC_FAIL;
+		}
+	}
+
+	return TRC_SUCCESS;
+}
+
+static void prvTraceStreamPortFileClose(void)
+{
+	if (pxStreamPortFile->iFile != -1)
+	{
+		/* Commits the trace to the media */
+		(void)red_fsync(pxStreamPortFile->iFile);
+		(void)red_close(pxStreamPortFile->iFile);
+		pxStreamPortFile->iFile = -1;
+	}
+}
+
+static traceResult prvTraceStreamPortFileWrite(void* pvData, uint32_t uiSize)
+{
+	if (pxStreamPortFile->iFile == -1)
+	{
+		return TRC_FAIL;
+	}
+
+	if (red_write(pxStreamPortFile->iFile, pvData, uiSize) != (int32_t)uiSize)
+	{
+		return TRC_FAIL;
+	}
+
+	return TRC_SUCCESS;
+}
+
+#else /* (TRC_CFG_STREAM_PORT_FILE_BACKEND == TRC_STREAM_PORT_FILE_BACKEND_RELIANCE_EDGE) */
+
+static traceResult prvTraceStreamPortFileOpen(void)
+{
 	if (pxStreamPortFile->pxFile == 0)
 	{
+#if defined(_MSC_VER)
 		errno_t err = fopen_s(&pxStreamPortFile->pxFile, TRC_CFG_STREAM_PORT_TRACE_FILE, "wb");
 		if (err != 0)
 		{
@@ -51,32 +224,51 @@ traceResult xTraceStreamPortOnTraceBegin(void)
 
 			return TRC_FAIL;
 		}
+#else
+		pxStreamPortFile->pxFile = fopen(TRC_CFG_STREAM_PORT_TRACE_FILE, "wb");
+		if (pxStreamPortFile->pxFile == 0)
+		{
+			printf("Could not open trace file.\n");
+
+			return TRC_FAIL;
+		}
+#endif
 		else
 		{
 			printf("Trace file created.\n");
 		}
 	}
-	
+
 	return TRC_SUCCESS;
 }
 
-traceResult xTraceStreamPortOnTraceEnd(void)
+static void prvTraceStreamPortFileClose(void)
 {
-	if (pxStreamPortFile == 0)
-	{
-		return TRC_FAIL;
-	}
-	
 	if (pxStreamPortFile->pxFile != 0)
 	{
 		fclose(pxStreamPortFile->pxFile);
 		pxStreamPortFile->pxFile = 0;
 		printf("Trace file closed.\n");
 	}
-	
+}
+
+static traceResult prvTraceStreamPortFileWrite(void* pvData, uint32_t uiSize)
+{
+	if (pxStreamPortFile->pxFile == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	if (fwrite(pvData, 1, uiSize, pxStreamPortFile->pxFile) != uiSize)
+	{
+		return TRC_FAIL;
+	}
+
 	return TRC_SUCCESS;
 }
 
+#endif /* (TRC_CFG_STREAM_PORT_FILE_BACKEND == TRC_STREAM_PORT_FILE_BACKEND_RELIANCE_EDGE) */
+
 #endif /*(TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)*/
 
 #endif /*(TRC_USE_TRACEALYZER_RECORDER == 1)*/
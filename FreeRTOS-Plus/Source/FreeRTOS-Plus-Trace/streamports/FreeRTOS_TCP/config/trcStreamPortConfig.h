@@ -0,0 +1,48 @@
+/*
+ * Trace Recorder for Tracealyzer v4.6.0
+ * Copyright 2021 Percepio AB
+ * www.percepio.com
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * The configuration for trace streaming ("stream ports").
+ */
+
+#ifndef TRC_STREAM_PORT_CONFIG_H
+#define TRC_STREAM_PORT_CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_TCPIP_PORT
+*
+* Specifies the TCP/IP port.
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_TCPIP_PORT 8888
+
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_BUFFER_SIZE
+*
+* Specifies the size of the internal buffer. Events are kept here while the
+* socket can't take them, so it should hold the events produced during a few
+* TzCtrl periods. Events that don't fit are dropped and counted.
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_BUFFER_SIZE 10000
+
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_TCP_TX_BUFFER_SIZE
+*
+* Specifies the size of the socket's transmit stream, which the trace data is
+* written into. A few segments (see ipconfigTCP_MSS) let the stack keep the
+* link busy while the TzCtrl task sleeps. Set to 0 to use the default of the
+* stack (ipconfigTCP_TX_BUFFER_LENGTH).
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_TCP_TX_BUFFER_SIZE 0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRC_STREAM_PORT_CONFIG_H */
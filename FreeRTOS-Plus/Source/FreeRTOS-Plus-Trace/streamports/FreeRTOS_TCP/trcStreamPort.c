@@ -0,0 +1,336 @@
+/*
+ * Trace Recorder for Tracealyzer v4.6.0
+ * Copyright 2021 Percepio AB
+ * www.percepio.com
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Supporting functions for trace streaming, used by the "stream ports"
+ * for reading and writing data to the interface.
+ * This stream port writes the trace data straight into the transmit stream
+ * of a FreeRTOS+TCP socket.
+ */
+
+#include <trcRecorder.h>
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <FreeRTOS_IP.h>
+#include <FreeRTOS_Sockets.h>
+
+typedef struct TraceStreamPortTCPIP
+{
+	uint8_t buffer[(TRC_STREAM_PORT_BUFFER_SIZE)];
+} TraceStreamPortTCPIP_t;
+
+static TraceStreamPortTCPIP_t* pxStreamPortTCPIP;
+
+static Socket_t xListenSocket = FREERTOS_INVALID_SOCKET;
+static Socket_t xClientSocket = FREERTOS_INVALID_SOCKET;
+
+/* Bytes copied into the transmit stream but not yet handed over to the stack */
+static uint32_t uiPendingBytes = 0;
+
+static int32_t prvSocketSend(void* pvData, uint32_t uiSize, int32_t* piBytesWritten);
+static int32_t prvSocketReceive(void* pvData, uint32_t uiSize, int32_t* piBytesRead);
+static int32_t prvSocketCommit(uint32_t uiSize);
+static int32_t prvSocketInitializeListener(void);
+static int32_t prvSocketAccept(void);
+static void prvCloseClientSocket(void);
+static void prvCloseAllSockets(void);
+
+static int32_t prvSocketCommit(uint32_t uiSize)
+{
+	if (uiSize == 0)
+	{
+		return 0;
+	}
+
+	/* A NULL buffer tells the stack the data is already in the transmit
+	 * stream, at the head returned by FreeRTOS_get_tx_head() */
+	if (FreeRTOS_send(xClientSocket, NULL, (size_t)uiSize, 0) != (BaseType_t)uiSize)
+	{
+		prvCloseClientSocket();
+
+		return -1;
+	}
+
+	uiPendingBytes -= uiSize;
+
+	return 0;
+}
+
+static int32_t prvSocketSend(void* pvData, uint32_t uiSize, int32_t* piBytesWritten)
+{
+	uint8_t* pucHead;
+	BaseType_t xSpace = 0;
+	uint32_t uiBytesToCopy;
+	uint32_t uiMSS;
+	uint32_t uiBytesWritten = 0;
+
+	if (piBytesWritten == 0)
+	{
+		return -1;
+	}
+
+	*piBytesWritten = 0;
+
+	if (xClientSocket == FREERTOS_INVALID_SOCKET)
+	{
+		return -1;
+	}
+
+	while (uiBytesWritten < uiSize)
+	{
+		/* The space is contiguous, up to the tail or the end of the stream */
+		pucHead = FreeRTOS_get_tx_head(xClientSocket, &xSpace);
+
+		if (pucHead == NULL)
+		{
+			prvCloseClientSocket();
+
+			return -1;
+		}
+
+		if ((uint32_t)xSpace <= uiPendingBytes)
+		{
+			if (uiPendingBytes == 0)
+			{
+				/* The transmit stream is full. What is left stays in the
+				 * internal buffer and is written on the next transfer. */
+				break;
+			}
+
+			/* Hand over what there is so the head moves on */
+			if (prvSocketCommit(uiPendingBytes) != 0)
+			{
+				return -1;
+			}
+
+			continue;
+		}
+
+		uiBytesToCopy = (uint32_t)xSpace - uiPendingBytes;
+
+		if (uiBytesToCopy > uiSize - uiBytesWritten)
+		{
+			uiBytesToCopy = uiSize - uiBytesWritten;
+		}
+
+		TRC_MEMCPY(&pucHead[uiPendingBytes], &((uint8_t*)pvData)[uiBytesWritten], uiBytesToCopy);
+
+		uiPendingBytes += uiBytesToCopy;
+		uiBytesWritten += uiBytesToCopy;
+	}
+
+	*piBytesWritten = (int32_t)uiBytesWritten;
+
+	/* Hand over full segments only, the rest goes with the next write or at
+	 * the latest on the next read */
+	uiMSS = (uint32_t)FreeRTOS_mss(xClientSocket);
+
+	if ((uiMSS > 0) && (uiPendingBytes >= uiMSS))
+	{
+		return prvSocketCommit((uiPendingBytes / uiMSS) * uiMSS);
+	}
+
+	return 0;
+}
+
+static int32_t prvSocketReceive(void* pvData, uint32_t uiSize, int32_t* piBytesRead)
+{
+	BaseType_t xResult;
+
+	if (piBytesRead == 0)
+	{
+		return -1;
+	}
+
+	*piBytesRead = 0;
+
+	if (xClientSocket == FREERTOS_INVALID_SOCKET)
+	{
+		return -1;
+	}
+
+	/* This is called once every TzCtrl period, so the data never waits longer
+	 * than that for a segment to fill up */
+	if (prvSocketCommit(uiPendingBytes) != 0)
+	{
+		return -1;
+	}
+
+	xResult = FreeRTOS_recv(xClientSocket, pvData, (size_t)uiSize, 0);
+
+	if (xResult < 0)
+	{
+		/* An interrupted receive isn't an error */
+		if (xResult != -pdFREERTOS_ERRNO_EINTR)
+		{
+			prvCloseClientSocket();
+
+			return -1;
+		}
+
+		xResult = 0;
+	}
+
+	*piBytesRead = (int32_t)xResult;
+
+	return 0;
+}
+
+static int32_t prvSocketInitializeListener(void)
+{
+	struct freertos_sockaddr xAddress = { 0 };
+	TickType_t xTimeout = 0;
+#if (TRC_CFG_STREAM_PORT_TCP_TX_BUFFER_SIZE > 0)
+	int32_t iTxBufferSize = (TRC_CFG_STREAM_PORT_TCP_TX_BUFFER_SIZE);
+#endif
+
+	if (xListenSocket != FREERTOS_INVALID_SOCKET)
+	{
+		return 0;
+	}
+
+	xListenSocket = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP);
+
+	if (xListenSocket == FREERTOS_INVALID_SOCKET)
+	{
+		return -1;
+	}
+
+	/* Accept is polled from the TzCtrl task, so it must not block. The
+	 * options are inherited by the accepted socket. */
+	FreeRTOS_setsockopt(xListenSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof(xTimeout));
+	FreeRTOS_setsockopt(xListenSocket, 0, FREERTOS_SO_SNDTIMEO, &xTimeout, sizeof(xTimeout));
+
+#if (TRC_CFG_STREAM_PORT_TCP_TX_BUFFER_SIZE > 0)
+	FreeRTOS_setsockopt(xListenSocket, 0, FREERTOS_SO_SNDBUF, &iTxBufferSize, sizeof(iTxBufferSize));
+#endif
+
+	xAddress.sin_family = FREERTOS_AF_INET;
+	xAddress.sin_port = FreeRTOS_htons(TRC_CFG_STREAM_PORT_TCPIP_PORT);
+
+	if ((FreeRTOS_bind(xListenSocket, &xAddress, sizeof(xAddress)) != 0) ||
+		(FreeRTOS_listen(xListenSocket, 1) != 0))
+	{
+		FreeRTOS_closesocket(xListenSocket);
+		xListenSocket = FREERTOS_INVALID_SOCKET;
+
+		return -1;
+	}
+
+	return 0;
+}
+
+static int32_t prvSocketAccept(void)
+{
+	struct freertos_sockaddr xRemote;
+	socklen_t xRemoteSize = sizeof(xRemote);
+	Socket_t xSocket;
+
+	if (xListenSocket == FREERTOS_INVALID_SOCKET)
+	{
+		return -1;
+	}
+
+	if (xClientSocket != FREERTOS_INVALID_SOCKET)
+	{
+		return 0;
+	}
+
+	xSocket = FreeRTOS_accept(xListenSocket, &xRemote, &xRemoteSize);
+
+	if (xSocket == NULL)
+	{
+		/* No connection yet */
+		return -1;
+	}
+
+	if (xSocket == FREERTOS_INVALID_SOCKET)
+	{
+		FreeRTOS_closesocket(xListenSocket);
+		xListenSocket = FREERTOS_INVALID_SOCKET;
+
+		return -1;
+	}
+
+	xClientSocket = xSocket;
+	uiPendingBytes = 0;
+
+	return 0;
+}
+
+static void prvCloseClientSocket(void)
+{
+	if (xClientSocket != FREERTOS_INVALID_SOCKET)
+	{
+		FreeRTOS_closesocket(xClientSocket);
+		xClientSocket = FREERTOS_INVALID_SOCKET;
+	}
+
+	uiPendingBytes = 0;
+}
+
+static void prvCloseAllSockets(void)
+{
+	if (xClientSocket != FREERTOS_INVALID_SOCKET)
+	{
+		/* Send what is left before the connection goes */
+		(void)prvSocketCommit(uiPendingBytes);
+	}
+
+	prvCloseClientSocket();
+
+	if (xListenSocket != FREERTOS_INVALID_SOCKET)
+	{
+		FreeRTOS_closesocket(xListenSocket);
+		xListenSocket = FREERTOS_INVALID_SOCKET;
+	}
+}
+
+int32_t prvTraceTcpWrite(void* pvData, uint32_t uiSize, int32_t *piBytesWritten)
+{
+	prvSocketInitializeListener();
+
+	prvSocketAccept();
+
+	return prvSocketSend(pvData, uiSize, piBytesWritten);
+}
+
+int32_t prvTraceTcpRead(void* pvData, uint32_t uiSize, int32_t *piBytesRead)
+{
+	prvSocketInitializeListener();
+
+	prvSocketAccept();
+
+	return prvSocketReceive(pvData, uiSize, piBytesRead);
+}
+
+traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer)
+{
+	TRC_ASSERT_EQUAL_SIZE(TraceStreamPortBuffer_t, TraceStreamPortTCPIP_t);
+
+	if (pxBuffer == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	pxStreamPortTCPIP = (TraceStreamPortTCPIP_t*)pxBuffer;
+
+	return xTraceInternalEventBufferInitialize(pxStreamPortTCPIP->buffer, sizeof(pxStreamPortTCPIP->buffer));
+}
+
+traceResult xTraceStreamPortOnTraceEnd(void)
+{
+	prvCloseAllSockets();
+
+	return TRC_SUCCESS;
+}
+
+#endif /*(TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)*/
+
+#endif /*(TRC_USE_TRACEALYZER_RECORDER == 1)*/
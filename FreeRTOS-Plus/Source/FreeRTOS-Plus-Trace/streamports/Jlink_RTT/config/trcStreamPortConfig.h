@@ -116,6 +116,35 @@ then the internal buffer must be enabled to avoid infinite recursion. */
  */
 #define TRC_CFG_STREAM_PORT_RTT_NO_LOCK_WRITE 0
 
+/**
+ * @def TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_PER_CORE
+ *
+ * @brief Gives each core its own "up" RTT buffer, for multicore (SMP) targets.
+ *
+ * With a single up buffer, the cores take turns writing to it under the RTT
+ * lock, so the cost of each event grows with the number of cores that trace.
+ * When this is enabled, core N writes only to RTT buffer
+ * TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX + N, each of size
+ * TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_SIZE. No other core writes to that buffer,
+ * and events are written inside the recorder's critical section, which
+ * already keeps out interrupts on the same core. So the RTT lock is not taken
+ * at all.
+ *
+ * Each buffer is a separate stream on the host. The buffer of the core that
+ * started the recorder begins with the trace header. Log every buffer to its
+ * own file, e.g., with JLinkRTTLogger, then merge them by timestamp with
+ * extras/TraceAnalyzer/trcAnalyzer:
+ * trcAnalyzer -o merged.psf core0.psf core1.psf
+ *
+ * This requires TRC_CFG_STREAM_PORT_USE_INTERNAL_BUFFER 0, since the internal
+ * buffer is written to RTT from whichever core runs the TzCtrl task, and a
+ * timestamp source that all the cores share. SEGGER_RTT_MAX_NUM_UP_BUFFERS in
+ * SEGGER_RTT_Conf.h must leave room for all the buffers.
+ *
+ * Default: 0
+ */
+#define TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_PER_CORE 0
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,6 +33,29 @@ extern "C" {
 
 #define TRC_USE_INTERNAL_BUFFER (TRC_CFG_STREAM_PORT_USE_INTERNAL_BUFFER)
 
+#if (defined(TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_PER_CORE) && TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_PER_CORE == 1)
+#define TRC_STREAM_PORT_RTT_UP_BUFFER_COUNT (TRC_CFG_CORE_COUNT)
+
+#if (TRC_USE_INTERNAL_BUFFER == 1)
+#error "TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_PER_CORE requires TRC_CFG_STREAM_PORT_USE_INTERNAL_BUFFER 0"
+#endif
+
+#if ((TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX) + (TRC_CFG_CORE_COUNT) > (SEGGER_RTT_MAX_NUM_UP_BUFFERS))
+#error "SEGGER_RTT_MAX_NUM_UP_BUFFERS is too small for one RTT up buffer per core"
+#endif
+
+/* Each core writes only to its own up buffer, so no lock is needed */
+#define TRC_STREAM_PORT_RTT_WRITE(pvData, uiSize) SEGGER_RTT_WriteNoLock((TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX) + (unsigned)TRC_CFG_GET_CURRENT_CORE(), (const char*)(pvData), uiSize)
+#else
+#define TRC_STREAM_PORT_RTT_UP_BUFFER_COUNT 1
+
+#if (defined(TRC_CFG_STREAM_PORT_RTT_NO_LOCK_WRITE) && TRC_CFG_STREAM_PORT_RTT_NO_LOCK_WRITE == 1)
+#define TRC_STREAM_PORT_RTT_WRITE(pvData, uiSize) SEGGER_RTT_WriteNoLock((TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX), (const char*)(pvData), uiSize)
+#else
+#define TRC_STREAM_PORT_RTT_WRITE(pvData, uiSize) SEGGER_RTT_Write((TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX), (const char*)(pvData), uiSize)
+#endif
+#endif
+
 /* Aligned */
 #define TRC_STREAM_PORT_INTERNAL_BUFFER_SIZE ((((TRC_CFG_STREAM_PORT_INTERNAL_BUFFER_SIZE) + sizeof(TraceUnsignedBaseType_t) - 1) / sizeof(TraceUnsignedBaseType_t)) * sizeof(TraceUnsignedBaseType_t))
 
@@ -51,7 +74,7 @@ typedef struct TraceStreamPortBuffer
 #if (TRC_USE_INTERNAL_BUFFER == 1)
 	uint8_t bufferInternal[TRC_STREAM_PORT_INTERNAL_BUFFER_SIZE];
 #endif
-	uint8_t bufferUp[TRC_STREAM_PORT_RTT_UP_BUFFER_SIZE];
+	uint8_t bufferUp[TRC_STREAM_PORT_RTT_UP_BUFFER_COUNT][TRC_STREAM_PORT_RTT_UP_BUFFER_SIZE];
 	uint8_t bufferDown[TRC_STREAM_PORT_RTT_DOWN_BUFFER_SIZE];
 } TraceStreamPortBuffer_t;
 
@@ -76,7 +99,11 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
  * @retval TRC_FAIL Allocate failed
  * @retval TRC_SUCCESS Success
  */
+#if (TRC_USE_INTERNAL_BUFFER == 1)
+#define xTraceStreamPortAllocate xTraceInternalEventBufferAllocate
+#else
 #define xTraceStreamPortAllocate(uiSize, ppvData) ((void)(uiSize), xTraceStaticBufferGet(ppvData))
+#endif
 
 /**
  * @brief Commits data to the stream port, depending on the implementation/configuration of the
@@ -91,7 +118,7 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
  * @retval TRC_SUCCESS Success
  */
 #if (TRC_USE_INTERNAL_BUFFER == 1)
-#define xTraceStreamPortCommit xTraceInternalEventBufferPush
+#define xTraceStreamPortCommit xTraceInternalEventBufferCommit
 #else
 #define xTraceStreamPortCommit xTraceStreamPortWriteData
 #endif
@@ -106,11 +133,7 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
  * @retval TRC_FAIL Write failed
  * @retval TRC_SUCCESS Success
  */
-#if (defined(TRC_CFG_STREAM_PORT_RTT_NO_LOCK_WRITE) && TRC_CFG_STREAM_PORT_RTT_NO_LOCK_WRITE == 1)
-#define xTraceStreamPortWriteData(pvData, uiSize, piBytesWritten) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(piBytesWritten) = (int32_t)SEGGER_RTT_WriteNoLock((TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX), (const char*)pvData, uiSize), TRC_SUCCESS)
-#else
-#define xTraceStreamPortWriteData(pvData, uiSize, piBytesWritten) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(piBytesWritten) = (int32_t)SEGGER_RTT_Write((TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX), (const char*)pvData, uiSize), TRC_SUCCESS)
-#endif
+#define xTraceStreamPortWriteData(pvData, uiSize, piBytesWritten) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2(*(piBytesWritten) = (int32_t)TRC_STREAM_PORT_RTT_WRITE(pvData, uiSize), TRC_SUCCESS)
 
 /**
  * @brief Reads data through the stream port interface.
@@ -24,7 +24,7 @@ typedef struct TraceStreamPortRTT {
 #if (TRC_USE_INTERNAL_BUFFER == 1)
 	uint8_t bufferInternal[TRC_STREAM_PORT_INTERNAL_BUFFER_SIZE];
 #endif
-	uint8_t bufferUp[TRC_STREAM_PORT_RTT_UP_BUFFER_SIZE];
+	uint8_t bufferUp[TRC_STREAM_PORT_RTT_UP_BUFFER_COUNT][TRC_STREAM_PORT_RTT_UP_BUFFER_SIZE];
 	uint8_t bufferDown[TRC_STREAM_PORT_RTT_DOWN_BUFFER_SIZE];
 } TraceStreamPortRTT_t;
 
@@ -50,10 +50,15 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer)
 
 traceResult xTraceStreamPortOnEnable(uint32_t uiStartOption)
 {
+	uint32_t i;
+
 	(void)uiStartOption;
 
-	/* Configure the RTT buffers */
-	SEGGER_RTT_ConfigUpBuffer(TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX, "TzData", pxStreamPortRTT->bufferUp, sizeof(pxStreamPortRTT->bufferUp), TRC_CFG_STREAM_PORT_RTT_MODE);
+	/* Configure the RTT buffers, one up buffer per core if enabled */
+	for (i = 0; i < (TRC_STREAM_PORT_RTT_UP_BUFFER_COUNT); i++)
+	{
+		SEGGER_RTT_ConfigUpBuffer((TRC_CFG_STREAM_PORT_RTT_UP_BUFFER_INDEX) + i, "TzData", pxStreamPortRTT->bufferUp[i], sizeof(pxStreamPortRTT->bufferUp[i]), TRC_CFG_STREAM_PORT_RTT_MODE);
+	}
 	SEGGER_RTT_ConfigDownBuffer(TRC_CFG_STREAM_PORT_RTT_DOWN_BUFFER_INDEX, "TzCtrl", pxStreamPortRTT->bufferDown, sizeof(pxStreamPortRTT->bufferDown), TRC_CFG_STREAM_PORT_RTT_MODE);
 
 	return TRC_SUCCESS;
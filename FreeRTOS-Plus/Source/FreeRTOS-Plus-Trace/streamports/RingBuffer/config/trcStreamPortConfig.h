@@ -49,6 +49,19 @@ extern "C" {
  */
 #define TRC_CFG_STREAM_PORT_RINGBUFFER_MODE TRC_STREAM_PORT_RINGBUFFER_MODE_OVERWRITE_WHEN_FULL
 
+/**
+ * @def TRC_CFG_STREAM_PORT_RINGBUFFER_TRIGGER_EVENTS
+ * 
+ * @brief Configures how many events are recorded after xTraceTrigger().
+ * 
+ * Once these events have been recorded, the recording is stopped and the ring
+ * buffer is no longer overwritten. The rest of the buffer holds the events
+ * leading up to the trigger, so a small value keeps more of the history and a
+ * large value more of the aftermath. With 0, the recording stops at the
+ * trigger.
+ */
+#define TRC_CFG_STREAM_PORT_RINGBUFFER_TRIGGER_EVENTS 100
+
 #ifdef __cplusplus
 }
 #endif
@@ -76,9 +76,16 @@ typedef struct TraceRingBuffer
 typedef struct TraceStreamPortData
 {
 	TraceMultiCoreEventBuffer_t xMultiCoreEventBuffer;
+	uint32_t uiTriggered;
+	uint32_t uiTriggerEventsLeft;
 	TraceRingBuffer_t xRingBuffer;
 } TraceStreamPortData_t;
 
+/**
+ * @brief A function writing data to an interface, like xTraceStreamPortWriteData.
+ */
+typedef traceResult (*TraceRingBufferWrite_t)(void* pvData, uint32_t uiSize, int32_t* piBytesWritten);
+
 extern TraceStreamPortData_t* pxStreamPortData;
 
 /**
@@ -116,7 +123,7 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
  * @retval TRC_FAIL Allocate failed
  * @retval TRC_SUCCESS Success
  */
-#define xTraceStreamPortAllocate(uiSize, ppvData) ((void)uiSize, xTraceStaticBufferGet(ppvData))
+#define xTraceStreamPortAllocate(uiSize, ppvData) xTraceMultiCoreEventBufferAllocate(&pxStreamPortData->xMultiCoreEventBuffer, uiSize, ppvData)
 
 /**
  * @brief Commits data to the stream port, depending on the implementation/configuration of the
@@ -190,6 +197,38 @@ traceResult xTraceStreamPortOnTraceBegin();
  */
 #define xTraceStreamPortOnTraceEnd() TRC_COMMA_EXPR_TO_STATEMENT_EXPR_1(TRC_SUCCESS)
 
+/**
+ * @brief Callback for when the trace is triggered. The recording stops after
+ * TRC_CFG_STREAM_PORT_RINGBUFFER_TRIGGER_EVENTS more events.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+#define xTraceStreamPortOnTrigger() xTraceRingBufferTrigger()
+
+/**
+ * @internal Starts the countdown to the freeze.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceRingBufferTrigger(void);
+
+/**
+ * @brief Writes the ring buffer, as it is in RAM, through a write function.
+ * This lets the trace kept after xTraceTrigger() be saved through any interface,
+ * e.g. a UART, a file or the write function of another stream port. The data
+ * can be loaded into Tracealyzer like a memory dump taken with a debugger.
+ *
+ * The recorder must be stopped first, so the buffer doesn't change meanwhile.
+ *
+ * @param[in] xWrite Write function, called until all data has been written
+ *
+ * @retval TRC_FAIL Recorder running, or the write failed or made no progress
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceRingBufferDump(TraceRingBufferWrite_t xWrite);
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,6 +16,10 @@
 
 #if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
 
+#if (TRC_CFG_STREAMING_COMPACT == 1)
+#error "The ring buffer is read as standard events, TRC_CFG_STREAMING_COMPACT must be 0"
+#endif
+
 /* Backwards compatibility with plugins */
 typedef TraceRingBuffer_t RecorderData;
 RecorderData* RecorderDataPtr = 0;
@@ -36,6 +40,9 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer)
 	pxStreamPortData = (TraceStreamPortData_t*)pxBuffer;
 	RecorderDataPtr = pxRingBuffer = &pxStreamPortData->xRingBuffer;
 
+	pxStreamPortData->uiTriggered = 0;
+	pxStreamPortData->uiTriggerEventsLeft = 0;
+
 	pxRingBuffer->xEventBuffer.uiSize = sizeof(pxRingBuffer->xEventBuffer.uiBuffer);
 	
 #if (TRC_CFG_STREAM_PORT_RINGBUFFER_MODE == TRC_STREAM_PORT_RINGBUFFER_MODE_OVERWRITE_WHEN_FULL)
@@ -105,7 +112,7 @@ traceResult xTraceStreamPortCommit(void* pvData, uint32_t uiSize, int32_t* piByt
 		return TRC_FAIL;
 	}
 
-	xTraceMultiCoreEventBufferPush(&pxStreamPortData->xMultiCoreEventBuffer, pvData, uiSize, piBytesCommitted);
+	xTraceMultiCoreEventBufferCommit(&pxStreamPortData->xMultiCoreEventBuffer, pvData, uiSize, piBytesCommitted);
 
 #if (TRC_CFG_STREAM_PORT_RINGBUFFER_MODE == TRC_STREAM_PORT_RINGBUFFER_MODE_STOP_WHEN_FULL)
 	/* If no bytes was written it means that the buffer is full and we should stop
@@ -117,14 +124,95 @@ traceResult xTraceStreamPortCommit(void* pvData, uint32_t uiSize, int32_t* piByt
 	}
 #endif
 
+	/* Commits are made inside the event critical section */
+	if (pxStreamPortData->uiTriggered != 0 && *piBytesCommitted > 0)
+	{
+		if (pxStreamPortData->uiTriggerEventsLeft > 0)
+		{
+			pxStreamPortData->uiTriggerEventsLeft--;
+		}
+
+		if (pxStreamPortData->uiTriggerEventsLeft == 0)
+		{
+			/* Freeze the buffer */
+			xTraceDisable();
+		}
+	}
+
 	return TRC_SUCCESS;
 }
 
 traceResult xTraceStreamPortOnTraceBegin()
 {
+	/* A new trace can be triggered again */
+	pxStreamPortData->uiTriggered = 0;
+	pxStreamPortData->uiTriggerEventsLeft = 0;
+
 	return xTraceMultiCoreEventBufferClear(&pxStreamPortData->xMultiCoreEventBuffer);
 }
 
+traceResult xTraceRingBufferTrigger(void)
+{
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	/* Only the first trigger counts */
+	if (pxStreamPortData->uiTriggered == 0)
+	{
+		pxStreamPortData->uiTriggered = 1;
+		pxStreamPortData->uiTriggerEventsLeft = (TRC_CFG_STREAM_PORT_RINGBUFFER_TRIGGER_EVENTS);
+
+		if (pxStreamPortData->uiTriggerEventsLeft == 0)
+		{
+			xTraceDisable();
+		}
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceRingBufferDump(TraceRingBufferWrite_t xWrite)
+{
+	uint8_t* puiData;
+	uint32_t uiBytesLeft;
+	int32_t iBytesWritten;
+
+	/* This should never fail */
+	TRC_ASSERT(xWrite != 0);
+
+	/* We need to check this */
+	if (pxStreamPortData == 0 || xTraceIsRecorderEnabled())
+	{
+		return TRC_FAIL;
+	}
+
+	puiData = (uint8_t*)&pxStreamPortData->xRingBuffer;
+	uiBytesLeft = sizeof(pxStreamPortData->xRingBuffer);
+
+	while (uiBytesLeft > 0)
+	{
+		iBytesWritten = 0;
+
+		if (xWrite(puiData, uiBytesLeft, &iBytesWritten) == TRC_FAIL || iBytesWritten <= 0)
+		{
+			return TRC_FAIL;
+		}
+
+		if ((uint32_t)iBytesWritten > uiBytesLeft)
+		{
+			iBytesWritten = (int32_t)uiBytesLeft;
+		}
+
+		puiData += iBytesWritten;
+		uiBytesLeft -= (uint32_t)iBytesWritten;
+	}
+
+	return TRC_SUCCESS;
+}
+
 #endif /*(TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)*/
 
 #endif /*(TRC_USE_TRACEALYZER_RECORDER == 1)*/
@@ -32,6 +32,16 @@ extern "C" {
 ******************************************************************************/
 #define TRC_CFG_STREAM_PORT_INTERNAL_BUFFER_SIZE 10000
 
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE
+*
+* Specifies the size of each of the two transmit buffers. While one buffer is
+* sent, the next block is collected in the other, and the USB transmit
+* complete callback starts sending it right away. This keeps the USB pipe busy
+* between TzCtrl runs. Use a multiple of the 64 byte full-speed packet size.
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE 2048
+
 #ifdef __cplusplus
 }
 #endif
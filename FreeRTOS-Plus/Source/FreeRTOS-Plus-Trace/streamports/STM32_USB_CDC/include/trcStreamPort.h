@@ -25,9 +25,19 @@ extern "C" {
 #define TRC_STREAM_PORT_USB_BUFFER_SIZE ((((TRC_CFG_STREAM_PORT_USB_BUFFER_SIZE) + sizeof(TraceUnsignedBaseType_t) - 1) / sizeof(TraceUnsignedBaseType_t)) * sizeof(TraceUnsignedBaseType_t))
 #define TRC_STREAM_PORT_INTERNAL_BUFFER_SIZE ((((TRC_CFG_STREAM_PORT_INTERNAL_BUFFER_SIZE) + sizeof(TraceUnsignedBaseType_t) - 1) / sizeof(TraceUnsignedBaseType_t)) * sizeof(TraceUnsignedBaseType_t))
 
+#ifndef TRC_CFG_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE
+#define TRC_CFG_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE 2048
+#endif
+
+#if ((TRC_CFG_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE) < 64) || ((TRC_CFG_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE) > 65535)
+#error "TRC_CFG_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE must be 64 - 65535, CDC_Transmit_FS() takes a 16-bit length."
+#endif
+
+#define TRC_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE ((((TRC_CFG_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE) + sizeof(TraceUnsignedBaseType_t) - 1) / sizeof(TraceUnsignedBaseType_t)) * sizeof(TraceUnsignedBaseType_t))
+
 typedef struct TraceStreamPortBuffer
 {
-	uint8_t buffer[(TRC_STREAM_PORT_USB_BUFFER_SIZE) + (TRC_STREAM_PORT_INTERNAL_BUFFER_SIZE) + sizeof(TraceUnsignedBaseType_t)];
+	uint8_t buffer[(TRC_STREAM_PORT_USB_BUFFER_SIZE) + (TRC_STREAM_PORT_INTERNAL_BUFFER_SIZE) + (TRC_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE) * 2 + sizeof(TraceUnsignedBaseType_t) * 5];
 } TraceStreamPortBuffer_t;
 
 traceResult prvTraceCDCReceive(void* data, uint32_t uiSize, int32_t* piBytesReceived);
@@ -55,7 +65,7 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
  * @retval TRC_FAIL Allocate failed
  * @retval TRC_SUCCESS Success
  */
-#define xTraceStreamPortAllocate(uiSize, ppvData) ((void)uiSize, xTraceStaticBufferGet(ppvData))
+#define xTraceStreamPortAllocate xTraceInternalEventBufferAllocate
 
 /**
  * @brief Commits data to the stream port, depending on the implementation/configuration of the
@@ -69,7 +79,7 @@ traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
  * @retval TRC_FAIL Commit failed
  * @retval TRC_SUCCESS Success
  */
-#define xTraceStreamPortCommit xTraceInternalEventBufferPush
+#define xTraceStreamPortCommit xTraceInternalEventBufferCommit
 
 /**
  * @brief Writes data through the stream port interface.
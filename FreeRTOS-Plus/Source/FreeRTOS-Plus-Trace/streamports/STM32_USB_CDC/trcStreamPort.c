@@ -20,16 +20,26 @@
 
 static void prvCDCInit(void);
 
+static void prvCDCStartTransmit(void);
+
 static int8_t CDC_Receive_FS_modified(uint8_t* pbuf, uint32_t *puiLength);
 
+static int8_t CDC_TransmitCplt_FS_modified(uint8_t* pBuffer, uint32_t *puiLength, uint8_t uiEndpoint);
+
 extern USBD_CDC_ItfTypeDef USBD_Interface_fops_FS;
 
 static int8_t(*CDC_Receive_FS)(uint8_t* Buf, uint32_t* Len);
 
+static int8_t(*CDC_TransmitCplt_FS)(uint8_t* Buf, uint32_t* Len, uint8_t epnum);
+
 typedef struct TraceStreamPortUSBCommandBuffer {
 	TraceUnsignedBaseType_t idx;
+	volatile TraceUnsignedBaseType_t uiFill;						/* The transmit buffer collecting data, the other one may be in flight */
+	volatile TraceUnsignedBaseType_t uiBusy;						/* 1 while a USB transfer is in flight */
+	volatile TraceUnsignedBaseType_t uiTransmitLength[2];			/* Bytes collected in each transmit buffer */
 	uint8_t bufferUSB[TRC_STREAM_PORT_USB_BUFFER_SIZE];
 	uint8_t bufferInternal[TRC_STREAM_PORT_INTERNAL_BUFFER_SIZE];
+	uint8_t bufferTransmit[2][TRC_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE];
 } TraceStreamPortUSBBuffers_t;
 
 TraceStreamPortUSBBuffers_t* pxUSBBuffers;
@@ -47,6 +57,42 @@ static int8_t CDC_Receive_FS_modified(uint8_t* pBuffer, uint32_t *puiLength)
 	return (USBD_OK);
 }
 
+/* Called from the USB interrupt when a transfer is done. The next block is
+ * handed over right away instead of waiting for TzCtrl to run again. */
+static int8_t CDC_TransmitCplt_FS_modified(uint8_t* pBuffer, uint32_t *puiLength, uint8_t uiEndpoint)
+{
+	pxUSBBuffers->uiBusy = 0;
+
+	prvCDCStartTransmit();
+
+	if (CDC_TransmitCplt_FS != 0)
+	{
+		CDC_TransmitCplt_FS(pBuffer, puiLength, uiEndpoint);
+	}
+
+	return (USBD_OK);
+}
+
+/* Starts sending the buffer being filled if no transfer is in flight. Must
+ * not be interrupted by the USB interrupt, i.e. called from that interrupt or
+ * inside a critical section. */
+static void prvCDCStartTransmit(void)
+{
+	TraceUnsignedBaseType_t uiFill = pxUSBBuffers->uiFill;
+
+	if ((pxUSBBuffers->uiBusy == 0) && (pxUSBBuffers->uiTransmitLength[uiFill] > 0))
+	{
+		if (CDC_Transmit_FS(pxUSBBuffers->bufferTransmit[uiFill], (uint16_t)pxUSBBuffers->uiTransmitLength[uiFill]) == USBD_OK)
+		{
+			pxUSBBuffers->uiBusy = 1;
+
+			/* The other buffer was sent before this one, so it is free */
+			pxUSBBuffers->uiFill = 1 - uiFill;
+			pxUSBBuffers->uiTransmitLength[1 - uiFill] = 0;
+		}
+	}
+}
+
 static void prvCDCInit(void)
 {
 	/* Store the original "Receive" function, from the static initialization */
@@ -55,7 +101,15 @@ static void prvCDCInit(void)
 	/* Update the function pointer with our modified variant */
 	USBD_Interface_fops_FS.Receive = CDC_Receive_FS_modified;
 
+	/* Same for "TransmitCplt", which drives the transmit buffers */
+	CDC_TransmitCplt_FS = USBD_Interface_fops_FS.TransmitCplt;
+	USBD_Interface_fops_FS.TransmitCplt = CDC_TransmitCplt_FS_modified;
+
 	pxUSBBuffers->idx = 0;
+	pxUSBBuffers->uiFill = 0;
+	pxUSBBuffers->uiBusy = 0;
+	pxUSBBuffers->uiTransmitLength[0] = 0;
+	pxUSBBuffers->uiTransmitLength[1] = 0;
 
 	MX_USB_DEVICE_Init();
 }
@@ -101,20 +155,49 @@ traceResult prvTraceCDCTransmit(void* pvData, uint32_t uiSize, int32_t * piBytes
 {
 	static int fail_counter = 0;
 
-	int32_t result;
+	TraceUnsignedBaseType_t uiFill, uiLength, uiCopy;
+	TRACE_ALLOC_CRITICAL_SECTION();
 
 	*piBytesSent = 0;
 
-	result = CDC_Transmit_FS(pvData, uiSize);
-	
-	if (result == USBD_OK)
+	TRACE_ENTER_CRITICAL_SECTION();
+	uiFill = pxUSBBuffers->uiFill;
+	uiLength = pxUSBBuffers->uiTransmitLength[uiFill];
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	uiCopy = (TRC_STREAM_PORT_USB_TRANSMIT_BUFFER_SIZE) - uiLength;
+	if ((TraceUnsignedBaseType_t)uiSize < uiCopy)
+	{
+		uiCopy = (TraceUnsignedBaseType_t)uiSize;
+	}
+
+	/* Copied with interrupts enabled. The transmit complete callback only
+	 * sends the bytes published in uiTransmitLength, and since this is the only
+	 * writer it can't take this buffer and give it back while we copy. */
+	TRC_MEMCPY(&pxUSBBuffers->bufferTransmit[uiFill][uiLength], pvData, uiCopy);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	/* If the callback started sending this buffer meanwhile, the copy is past
+	 * what it sends and is simply written again by the next call */
+	if (pxUSBBuffers->uiFill == uiFill)
+	{
+		pxUSBBuffers->uiTransmitLength[uiFill] = uiLength + uiCopy;
+		*piBytesSent = (int32_t)uiCopy;
+	}
+
+	prvCDCStartTransmit();
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	if (uiCopy > 0)
 	{
 		fail_counter = 0;
-		*piBytesSent = uiSize;
 		return TRC_SUCCESS;
 	}
 	else
 	{
+		/* Both transmit buffers are in use */
 		fail_counter++;
 
 		/* We keep trying to send more pvData. If busy, we delay for a while. This function will be called again afterwards. */
@@ -45,11 +45,15 @@ int32_t prvTraceTcpRead(void* pvData, uint32_t uiSize, int32_t* piBytesRead);
 
 traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
 
+#if (TRC_USE_INTERNAL_BUFFER == 1)
+#define xTraceStreamPortAllocate xTraceInternalEventBufferAllocate
+#else
 #define xTraceStreamPortAllocate(uiSize, ppvData) ((void)(uiSize), xTraceStaticBufferGet(ppvData))
+#endif
 
 #if (TRC_USE_INTERNAL_BUFFER == 1)
 /* Push to internal buffer. It will call on xTraceStreamPortWriteData() periodically. */
-#define xTraceStreamPortCommit xTraceInternalEventBufferPush
+#define xTraceStreamPortCommit xTraceInternalEventBufferCommit
 #else
 /* Write directly */
 #define xTraceStreamPortCommit xTraceStreamPortWriteData
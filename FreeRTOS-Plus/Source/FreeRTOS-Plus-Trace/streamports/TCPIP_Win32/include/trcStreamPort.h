@@ -48,11 +48,15 @@ int32_t prvTraceReadFromSocket(void* data, uint32_t bufsize, int32_t* ptrBytesRe
 
 traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
 
+#if (TRC_USE_INTERNAL_BUFFER == 1)
+#define xTraceStreamPortAllocate xTraceInternalEventBufferAllocate
+#else
 #define xTraceStreamPortAllocate(uiSize, ppvData) ((void)(uiSize), xTraceStaticBufferGet(ppvData))
+#endif
 
 #if (TRC_USE_INTERNAL_BUFFER == 1)
 /* Push to internal buffer. It will call on xTraceStreamPortWriteData() periodically. */
-#define xTraceStreamPortCommit xTraceInternalEventBufferPush
+#define xTraceStreamPortCommit xTraceInternalEventBufferCommit
 #else
 /* Write directly */
 #define xTraceStreamPortCommit xTraceStreamPortWriteData
@@ -21,6 +21,21 @@ typedef struct TraceDiagnostics
 
 static TraceDiagnostics_t *pxDiagnostics;
 
+#if (TRC_CFG_ENABLE_RECORDER_METRICS == 1)
+
+static uint32_t uiMetricsReportTick = 0;
+
+static uint32_t prvTraceDiagnosticsGetElapsed(uint32_t uiStart);
+static uint32_t prvTraceDiagnosticsPerSecond(uint32_t uiCount, uint32_t uiTicks);
+
+#if (TRC_CFG_SCHEDULING_ONLY == 0) && (TRC_CFG_INCLUDE_USER_EVENTS == 1)
+static TraceStringHandle_t xMetricsChannel = 0;
+
+static uint32_t prvTraceDiagnosticsToMicroseconds(uint32_t uiCounts, TraceUnsignedBaseType_t uxFrequency);
+#endif
+
+#endif /* (TRC_CFG_ENABLE_RECORDER_METRICS == 1) */
+
 traceResult xTraceDiagnosticsInitialize(TraceDiagnosticsBuffer_t *pxBuffer)
 {
 	uint32_t i;
@@ -161,6 +176,191 @@ traceResult xTraceDiagnosticsCheckStatus(void)
 	return TRC_SUCCESS;
 }
 
+#if (TRC_CFG_ENABLE_RECORDER_METRICS == 1)
+
+traceResult xTraceDiagnosticsEventCommitted(uint32_t uiSize, int32_t iBytesCommitted, uint32_t uiStart)
+{
+	/* Taken first, so that the time in here is included */
+	TraceBaseType_t xElapsed = (TraceBaseType_t)prvTraceDiagnosticsGetElapsed(uiStart);
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_DIAGNOSTICS));
+
+	if ((iBytesCommitted >= 0) && ((uint32_t)iBytesCommitted == uiSize))
+	{
+		pxDiagnostics->metrics[TRC_DIAGNOSTICS_EVENTS_WRITTEN]++;
+		pxDiagnostics->metrics[TRC_DIAGNOSTICS_BYTES_WRITTEN] += (TraceBaseType_t)uiSize;
+	}
+	else
+	{
+		/* The buffer was full, or the stream port only took part of it */
+		pxDiagnostics->metrics[TRC_DIAGNOSTICS_EVENTS_DROPPED]++;
+	}
+
+	if (xElapsed > pxDiagnostics->metrics[TRC_DIAGNOSTICS_CRITICAL_SECTION_LONGEST])
+	{
+		pxDiagnostics->metrics[TRC_DIAGNOSTICS_CRITICAL_SECTION_LONGEST] = xElapsed;
+	}
+
+	pxDiagnostics->metrics[TRC_DIAGNOSTICS_CRITICAL_SECTION_TOTAL] += xElapsed;
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceDiagnosticsReportMetrics(void)
+{
+	uint32_t uiTick = 0;
+	uint32_t uiTicks;
+	TraceUnsignedBaseType_t uxFrequency = 0;
+	TraceBaseType_t xEvents, xBytes, xLongest, xTotal;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* We need to check this */
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_DIAGNOSTICS))
+	{
+		return TRC_FAIL;
+	}
+
+	if ((TRC_CFG_RECORDER_METRICS_REPORT_PERIOD) == 0)
+	{
+		return TRC_SUCCESS;
+	}
+
+	(void)xTraceTimestampGetOsTickCount(&uiTick);
+
+	uiTicks = uiTick - uiMetricsReportTick;
+
+	if (uiTicks < (TRC_CFG_RECORDER_METRICS_REPORT_PERIOD))
+	{
+		return TRC_SUCCESS;
+	}
+
+	/* The events update these from within their critical sections */
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	xEvents = pxDiagnostics->metrics[TRC_DIAGNOSTICS_EVENTS_WRITTEN];
+	xBytes = pxDiagnostics->metrics[TRC_DIAGNOSTICS_BYTES_WRITTEN];
+	xLongest = pxDiagnostics->metrics[TRC_DIAGNOSTICS_CRITICAL_SECTION_LONGEST];
+	xTotal = pxDiagnostics->metrics[TRC_DIAGNOSTICS_CRITICAL_SECTION_TOTAL];
+
+	pxDiagnostics->metrics[TRC_DIAGNOSTICS_EVENTS_WRITTEN] = 0;
+	pxDiagnostics->metrics[TRC_DIAGNOSTICS_BYTES_WRITTEN] = 0;
+	pxDiagnostics->metrics[TRC_DIAGNOSTICS_CRITICAL_SECTION_LONGEST] = 0;
+	pxDiagnostics->metrics[TRC_DIAGNOSTICS_CRITICAL_SECTION_TOTAL] = 0;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	uiMetricsReportTick = uiTick;
+
+	pxDiagnostics->metrics[TRC_DIAGNOSTICS_EVENTS_PER_SECOND] = (TraceBaseType_t)prvTraceDiagnosticsPerSecond((uint32_t)xEvents, uiTicks);
+	pxDiagnostics->metrics[TRC_DIAGNOSTICS_BYTES_PER_SECOND] = (TraceBaseType_t)prvTraceDiagnosticsPerSecond((uint32_t)xBytes, uiTicks);
+
+#if (TRC_CFG_SCHEDULING_ONLY == 0) && (TRC_CFG_INCLUDE_USER_EVENTS == 1)
+	if (xMetricsChannel == 0)
+	{
+		if (xTraceStringRegister("#Metrics", &xMetricsChannel) == TRC_FAIL)
+		{
+			return TRC_FAIL;
+		}
+	}
+
+	(void)xTraceTimestampGetFrequency(&uxFrequency);
+
+	/* Each report fits in one event, so that they can be plotted */
+	xTracePrintF(xMetricsChannel, "%u events/s, %u bytes/s",
+		(uint32_t)pxDiagnostics->metrics[TRC_DIAGNOSTICS_EVENTS_PER_SECOND],
+		(uint32_t)pxDiagnostics->metrics[TRC_DIAGNOSTICS_BYTES_PER_SECOND]);
+
+	xTracePrintF(xMetricsChannel, "%u dropped, buffer max %u bytes",
+		(uint32_t)pxDiagnostics->metrics[TRC_DIAGNOSTICS_EVENTS_DROPPED],
+		(uint32_t)pxDiagnostics->metrics[TRC_DIAGNOSTICS_BUFFER_HIGH_WATER_MARK]);
+
+	xTracePrintF(xMetricsChannel, "Crit. sections max %u us, total %u us",
+		prvTraceDiagnosticsToMicroseconds((uint32_t)xLongest, uxFrequency),
+		prvTraceDiagnosticsToMicroseconds((uint32_t)xTotal, uxFrequency));
+#else
+	/* Without User Events the metrics can only be read with xTraceDiagnosticsGet(...) */
+	(void)uxFrequency;
+	(void)xLongest;
+	(void)xTotal;
+#endif
+
+	return TRC_SUCCESS;
+}
+
+/**
+ * @brief Gets the timer counts since uiStart. The critical sections are much
+ * shorter than a wraparound, so at most one is handled.
+ *
+ * @param[in] uiStart Timer count at the start.
+ *
+ * @return Timer counts since uiStart.
+ */
+static uint32_t prvTraceDiagnosticsGetElapsed(uint32_t uiStart)
+{
+	uint32_t uiElapsed;
+
+#if (TRC_HWTC_TYPE == TRC_FREE_RUNNING_32BIT_INCR) || (TRC_HWTC_TYPE == TRC_OS_TIMER_INCR) || (TRC_HWTC_TYPE == TRC_CUSTOM_TIMER_INCR)
+	uiElapsed = (uint32_t)(TRC_HWTC_COUNT) - uiStart;
+#else
+	uiElapsed = uiStart - (uint32_t)(TRC_HWTC_COUNT);
+#endif
+
+#if (TRC_HWTC_TYPE == TRC_OS_TIMER_INCR) || (TRC_HWTC_TYPE == TRC_OS_TIMER_DECR)
+	/* The counter restarts every tick */
+	if (uiElapsed > (uint32_t)(TRC_HWTC_PERIOD))
+	{
+		uiElapsed += (uint32_t)(TRC_HWTC_PERIOD);
+	}
+#endif
+
+	return uiElapsed;
+}
+
+/**
+ * @brief Scales a count over a number of OS ticks to a count per second,
+ * without overflowing for byte counts.
+ *
+ * @param[in] uiCount Count.
+ * @param[in] uiTicks OS ticks, larger than 0.
+ *
+ * @return Count per second.
+ */
+static uint32_t prvTraceDiagnosticsPerSecond(uint32_t uiCount, uint32_t uiTicks)
+{
+	return (uiCount / uiTicks) * (TRC_TICK_RATE_HZ) + ((uiCount % uiTicks) * (TRC_TICK_RATE_HZ)) / uiTicks;
+}
+
+#if (TRC_CFG_SCHEDULING_ONLY == 0) && (TRC_CFG_INCLUDE_USER_EVENTS == 1)
+
+/**
+ * @brief Converts timer counts to microseconds.
+ *
+ * @param[in] uiCounts Timer counts.
+ * @param[in] uxFrequency Timer frequency.
+ *
+ * @return Microseconds, or the timer counts if the frequency is not known.
+ */
+static uint32_t prvTraceDiagnosticsToMicroseconds(uint32_t uiCounts, TraceUnsignedBaseType_t uxFrequency)
+{
+	if (uxFrequency == 0)
+	{
+		return uiCounts;
+	}
+
+	if (uxFrequency >= 1000000)
+	{
+		return uiCounts / (uint32_t)(uxFrequency / 1000000);
+	}
+
+	return uiCounts * (uint32_t)(1000000 / uxFrequency);
+}
+
+#endif /* (TRC_CFG_SCHEDULING_ONLY == 0) && (TRC_CFG_INCLUDE_USER_EVENTS == 1) */
+
+#endif /* (TRC_CFG_ENABLE_RECORDER_METRICS == 1) */
+
 #endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
 
 #endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
@@ -0,0 +1,347 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* The implementation of the duration statistics of intervals and states.
+*/
+
+#include <trcRecorder.h>
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#if (TRC_CFG_ENABLE_DURATION_STATS == 1)
+
+static TraceDurationStatsData_t* pxDurationStats;
+
+static TraceDurationStatsEntry_t* prvTraceDurationStatsFind(void* pvHandle, uint32_t uiAdd);
+static void prvTraceDurationStatsReset(TraceDurationStats_t* pxStats);
+
+traceResult xTraceDurationStatsInitialize(TraceDurationStatsBuffer_t* pxBuffer)
+{
+	TRC_ASSERT_EQUAL_SIZE(TraceDurationStatsBuffer_t, TraceDurationStatsData_t);
+
+	/* This should never fail */
+	TRC_ASSERT(pxBuffer != 0);
+
+	pxDurationStats = (TraceDurationStatsData_t*)pxBuffer;
+
+	pxDurationStats->uiEntryCount = 0;
+
+	xTraceSetComponentInitialized(TRC_RECORDER_COMPONENT_DURATION_STATS);
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceDurationStatsStart(void* pvHandle)
+{
+	TraceDurationStatsEntry_t* pxEntry;
+	uint64_t uiNow = 0;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* We need to check this */
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_DURATION_STATS))
+	{
+		return TRC_FAIL;
+	}
+
+	(void)xTraceTimestampGet64(&uiNow);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	pxEntry = prvTraceDurationStatsFind(pvHandle, 1);
+	if (pxEntry == 0)
+	{
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		return TRC_FAIL;
+	}
+
+	pxEntry->uiStartTime = uiNow;
+	pxEntry->uiStarted = 1;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceDurationStatsStop(void* pvHandle)
+{
+	TraceDurationStatsEntry_t* pxEntry;
+	TraceDurationStats_t* pxStats;
+	uint64_t uiNow = 0;
+	uint32_t uiDuration;
+	uint32_t uiBin;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* We need to check this */
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_DURATION_STATS))
+	{
+		return TRC_FAIL;
+	}
+
+	(void)xTraceTimestampGet64(&uiNow);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	pxEntry = prvTraceDurationStatsFind(pvHandle, 0);
+
+	/* Stopped without being started, or there was no room for it */
+	if ((pxEntry == 0) || (pxEntry->uiStarted == 0))
+	{
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		return TRC_FAIL;
+	}
+
+	pxEntry->uiStarted = 0;
+
+	/* A timer read just before the OS tick was handled can be a period behind */
+	if (uiNow <= pxEntry->uiStartTime)
+	{
+		uiDuration = 0;
+	}
+	else if ((uiNow - pxEntry->uiStartTime) > 0xFFFFFFFFU)
+	{
+		uiDuration = 0xFFFFFFFFU;
+	}
+	else
+	{
+		uiDuration = (uint32_t)(uiNow - pxEntry->uiStartTime);
+	}
+
+	pxStats = &pxEntry->xStats;
+
+	if ((pxStats->uiCount == 0) || (uiDuration < pxStats->uiMin))
+	{
+		pxStats->uiMin = uiDuration;
+	}
+
+	if (uiDuration > pxStats->uiMax)
+	{
+		pxStats->uiMax = uiDuration;
+	}
+
+	pxStats->uiCount++;
+	pxStats->uiTotal += uiDuration;
+
+	/* The bin is the position of the highest set bit, the last one open */
+	uiBin = 0;
+	while (((uiDuration >> 1) != 0) && (uiBin < (TRC_CFG_DURATION_STATS_HISTOGRAM_BINS) - 1))
+	{
+		uiDuration >>= 1;
+		uiBin++;
+	}
+
+	pxStats->uiBins[uiBin]++;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceDurationStatsGet(void* pvHandle, TraceDurationStats_t* pxStats)
+{
+	TraceDurationStatsEntry_t* pxEntry;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_DURATION_STATS));
+
+	/* This should never fail */
+	TRC_ASSERT(pxStats != 0);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	pxEntry = prvTraceDurationStatsFind(pvHandle, 0);
+	if (pxEntry == 0)
+	{
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		return TRC_FAIL;
+	}
+
+	*pxStats = pxEntry->xStats;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceDurationStatsGetCount(uint32_t* puiCount)
+{
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_DURATION_STATS));
+
+	/* This should never fail */
+	TRC_ASSERT(puiCount != 0);
+
+	*puiCount = pxDurationStats->uiEntryCount;
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceDurationStatsGetAtIndex(uint32_t uiIndex, TraceDurationStats_t* pxStats)
+{
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_DURATION_STATS));
+
+	/* This should never fail */
+	TRC_ASSERT(pxStats != 0);
+
+	/* We need to check this */
+	if (uiIndex >= pxDurationStats->uiEntryCount)
+	{
+		return TRC_FAIL;
+	}
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	*pxStats = pxDurationStats->xEntries[uiIndex].xStats;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceDurationStatsGetPercentile(const TraceDurationStats_t* pxStats, uint32_t uiPercent, uint32_t* puiDuration)
+{
+	uint32_t uiRank;
+	uint32_t uiSum = 0;
+	uint32_t uiBin;
+
+	/* This should never fail */
+	TRC_ASSERT(pxStats != 0);
+
+	/* This should never fail */
+	TRC_ASSERT(puiDuration != 0);
+
+	/* This should never fail */
+	TRC_ASSERT((uiPercent > 0) && (uiPercent <= 100));
+
+	*puiDuration = 0;
+
+	if (pxStats->uiCount == 0)
+	{
+		return TRC_SUCCESS;
+	}
+
+	/* The nearest rank, rounded up */
+	uiRank = (uint32_t)(((uint64_t)pxStats->uiCount * uiPercent + 99) / 100);
+
+	for (uiBin = 0; uiBin < (TRC_CFG_DURATION_STATS_HISTOGRAM_BINS) - 1; uiBin++)
+	{
+		uiSum += pxStats->uiBins[uiBin];
+		if (uiSum >= uiRank)
+		{
+			break;
+		}
+	}
+
+	/* The last bin is open, and the upper end can't be above the longest */
+	if ((uiBin < (TRC_CFG_DURATION_STATS_HISTOGRAM_BINS) - 1) && (uiBin < 31) && (((2U << uiBin) - 1) < pxStats->uiMax))
+	{
+		*puiDuration = (2U << uiBin) - 1;
+	}
+	else
+	{
+		*puiDuration = pxStats->uiMax;
+	}
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceDurationStatsClear(void)
+{
+	uint32_t i;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_DURATION_STATS));
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	for (i = 0; i < pxDurationStats->uiEntryCount; i++)
+	{
+		prvTraceDurationStatsReset(&pxDurationStats->xEntries[i].xStats);
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+/**
+ * @brief Finds the entry of an interval or state, optionally adding it if
+ * there is room.
+ *
+ * @param[in] pvHandle Interval or state.
+ * @param[in] uiAdd 1 to add it if it isn't found.
+ *
+ * @return The entry, or 0 if not found.
+ */
+static TraceDurationStatsEntry_t* prvTraceDurationStatsFind(void* pvHandle, uint32_t uiAdd)
+{
+	TraceDurationStatsEntry_t* pxEntry;
+	uint32_t i;
+
+	for (i = 0; i < pxDurationStats->uiEntryCount; i++)
+	{
+		if (pxDurationStats->xEntries[i].xStats.pvHandle == pvHandle)
+		{
+			return &pxDurationStats->xEntries[i];
+		}
+	}
+
+	/* Those after the first TRC_CFG_DURATION_STATS_MAX_SLOTS are not counted */
+	if ((uiAdd == 0) || (pvHandle == 0) || (pxDurationStats->uiEntryCount >= (TRC_CFG_DURATION_STATS_MAX_SLOTS)))
+	{
+		return 0;
+	}
+
+	pxEntry = &pxDurationStats->xEntries[pxDurationStats->uiEntryCount];
+	pxDurationStats->uiEntryCount++;
+
+	pxEntry->xStats.pvHandle = pvHandle;
+	prvTraceDurationStatsReset(&pxEntry->xStats);
+	pxEntry->uiStartTime = 0;
+	pxEntry->uiStarted = 0;
+
+	return pxEntry;
+}
+
+/**
+ * @brief Clears the statistics, except the handle.
+ *
+ * @param[in] pxStats Statistics.
+ */
+static void prvTraceDurationStatsReset(TraceDurationStats_t* pxStats)
+{
+	uint32_t i;
+
+	pxStats->uiTotal = 0;
+	pxStats->uiCount = 0;
+	pxStats->uiMin = 0;
+	pxStats->uiMax = 0;
+
+	for (i = 0; i < (TRC_CFG_DURATION_STATS_HISTOGRAM_BINS); i++)
+	{
+		pxStats->uiBins[i] = 0;
+	}
+}
+
+#endif /* (TRC_CFG_ENABLE_DURATION_STATS == 1) */
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
@@ -28,6 +28,28 @@ typedef uint16_t TraceEntryIndex_t;
 typedef uint8_t TraceEntryIndex_t;
 #endif /* (TRC_CFG_ENTRY_TABLE_SLOTS > 256) */
 
+/* The address hash has twice as many slots as there are entries, so probe sequences stay short */
+#define TRC_ENTRY_HASH_SLOTS ((TRC_ENTRY_TABLE_SLOTS) * 2)
+
+#if (TRC_ENTRY_TABLE_SLOTS > 254)
+typedef uint16_t TraceEntryHashSlot_t;
+#define TRC_ENTRY_HASH_EMPTY ((TraceEntryHashSlot_t)UINT16_MAX)
+#else
+typedef uint8_t TraceEntryHashSlot_t;
+#define TRC_ENTRY_HASH_EMPTY ((TraceEntryHashSlot_t)UINT8_MAX)
+#endif /* (TRC_ENTRY_TABLE_SLOTS > 254) */
+
+/* A slot whose entry was deleted, which lookups must probe past */
+#define TRC_ENTRY_HASH_DELETED ((TraceEntryHashSlot_t)(TRC_ENTRY_HASH_EMPTY - 1))
+
+#define CALCULATE_ENTRY_HASH(pvAddress) ((uint32_t)(((uint32_t)((TraceUnsignedBaseType_t)(pvAddress) >> 2)) * 2654435761UL) % (TRC_ENTRY_HASH_SLOTS))
+
+/* Maps object addresses to entry indexes using open addressing with linear probing */
+typedef struct EntryHashTable
+{
+	TraceEntryHashSlot_t axSlots[TRC_ENTRY_HASH_SLOTS];
+} TraceEntryHashTable_t;
+
 typedef struct EntryIndexTable
 {
 	TraceEntryIndex_t axFreeIndexes[TRC_ENTRY_TABLE_SLOTS];
@@ -45,10 +67,25 @@ typedef struct TraceEntryTable
 /* Private function definitions */
 traceResult prvEntryIndexInitialize(TraceEntryIndexTable_t *pxIndexTable);
 traceResult prvEntryIndexTake(TraceEntryIndex_t *pxIndex);
+traceResult prvEntryHashInsert(TraceEntryIndex_t xIndex);
+traceResult prvEntryHashRemove(TraceEntryIndex_t xIndex);
+
+#if (TRC_CFG_ENTRY_RECYCLE == 1)
+traceResult prvEntryRecycle(TraceEntryIndex_t *pxIndex);
+#endif /* (TRC_CFG_ENTRY_RECYCLE == 1) */
 
 /* Variables */
 static TraceEntryTable_t *pxEntryTable;
 static TraceEntryIndexTable_t xIndexTable;
+static TraceEntryHashTable_t xHashTable;
+
+#if (TRC_CFG_ENTRY_RECYCLE == 1)
+/* Set when an entry is created or found, and cleared when the clock hand passes
+ * it. A byte per entry, so that xTraceEntryFind(...) can set it without a
+ * critical section. */
+static uint8_t aucEntryReferenced[TRC_ENTRY_TABLE_SLOTS];
+static uint32_t uiEntryClockHand;
+#endif /* (TRC_CFG_ENTRY_RECYCLE == 1) */
 
 traceResult xTraceEntryTableInitialize(TraceEntryTableBuffer_t *pxBuffer)
 {
@@ -80,6 +117,20 @@ traceResult xTraceEntryTableInitialize(TraceEntryTableBuffer_t *pxBuffer)
 
 	prvEntryIndexInitialize(&xIndexTable);
 
+	for (i = 0; i < TRC_ENTRY_HASH_SLOTS; i++)
+	{
+		xHashTable.axSlots[i] = TRC_ENTRY_HASH_EMPTY;
+	}
+
+#if (TRC_CFG_ENTRY_RECYCLE == 1)
+	for (i = 0; i < TRC_ENTRY_TABLE_SLOTS; i++)
+	{
+		aucEntryReferenced[i] = 0;
+	}
+
+	uiEntryClockHand = 0;
+#endif /* (TRC_CFG_ENTRY_RECYCLE == 1) */
+
 	xTraceSetComponentInitialized(TRC_RECORDER_COMPONENT_ENTRY);
 
 	return TRC_SUCCESS;
@@ -90,6 +141,7 @@ traceResult xTraceEntryCreate(TraceEntryHandle_t *pxEntryHandle)
 	uint32_t i;
 	TraceEntryIndex_t xIndex;
 	TraceEntry_t *pxEntry;
+	traceResult xResult;
 
 	TRACE_ALLOC_CRITICAL_SECTION();
 
@@ -104,15 +156,33 @@ traceResult xTraceEntryCreate(TraceEntryHandle_t *pxEntryHandle)
 
 	TRACE_ENTER_CRITICAL_SECTION();
 
-	if (prvEntryIndexTake(&xIndex) != TRC_SUCCESS)
+	xResult = prvEntryIndexTake(&xIndex);
+
+#if (TRC_CFG_ENTRY_RECYCLE == 1)
+	if (xResult == TRC_FAIL)
+	{
+		/* The table is full, take the entry of an object that hasn't been used for a while */
+		xResult = prvEntryRecycle(&xIndex);
+	}
+#endif /* (TRC_CFG_ENTRY_RECYCLE == 1) */
+
+	if (xResult == TRC_FAIL)
 	{
 		xTraceDiagnosticsIncrease(TRC_DIAGNOSTICS_ENTRY_SLOTS_NO_ROOM);
+		xTraceDiagnosticsIncrease(TRC_DIAGNOSTICS_ENTRY_SLOTS_MISSED);
 
 		TRACE_EXIT_CRITICAL_SECTION();
 
 		return TRC_FAIL;
 	}
 
+	/* The most entries in use at once, for sizing TRC_CFG_ENTRY_SLOTS */
+	xTraceDiagnosticsSetIfHigher(TRC_DIAGNOSTICS_ENTRY_SLOTS_HIGH_WATER_MARK, (TraceBaseType_t)(TRC_ENTRY_TABLE_SLOTS - GET_FREE_INDEX_COUNT()));
+
+#if (TRC_CFG_ENTRY_RECYCLE == 1)
+	aucEntryReferenced[xIndex] = 1;
+#endif /* (TRC_CFG_ENTRY_RECYCLE == 1) */
+
 	pxEntry = &pxEntryTable->axEntries[xIndex];
 	
 	pxEntry->pvAddress = (void*)pxEntry; /* We set a temporary address */
@@ -132,6 +202,33 @@ traceResult xTraceEntryCreate(TraceEntryHandle_t *pxEntryHandle)
 	return TRC_SUCCESS;
 }
 
+traceResult xTraceEntryCreateWithAddress(void* pvAddress, TraceEntryHandle_t* pxEntryHandle)
+{
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(pvAddress != 0);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	if (xTraceEntryCreate(pxEntryHandle) == TRC_FAIL)
+	{
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		return TRC_FAIL;
+	}
+
+	/* The address must be set before the entry can be found through the hash */
+	((TraceEntry_t*)*pxEntryHandle)->pvAddress = pvAddress;
+
+	/* This should never fail */
+	TRC_ASSERT_ALWAYS_EVALUATE(prvEntryHashInsert(CALCULATE_ENTRY_INDEX(*pxEntryHandle)) == TRC_SUCCESS);
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
 traceResult xTraceEntryDelete(TraceEntryHandle_t xEntryHandle)
 {
 	TraceEntryIndex_t xIndex;
@@ -162,6 +259,13 @@ traceResult xTraceEntryDelete(TraceEntryHandle_t xEntryHandle)
 	}
 
 	/* A valid address, so we assume it is OK. */
+	/* Entries created without an address point to themselves and were never hashed */
+	if (((TraceEntry_t*)xEntryHandle)->pvAddress != (void*)xEntryHandle)
+	{
+		/* This should never fail */
+		TRC_ASSERT_ALWAYS_EVALUATE(prvEntryHashRemove(xIndex) == TRC_SUCCESS);
+	}
+
 	/* For good measure, we clear the address field */
 	((TraceEntry_t*)xEntryHandle)->pvAddress = 0;
 
@@ -176,6 +280,8 @@ traceResult xTraceEntryDelete(TraceEntryHandle_t xEntryHandle)
 traceResult xTraceEntryFind(void* pvAddress, TraceEntryHandle_t* pxEntryHandle)
 {
 	uint32_t i;
+	uint32_t uiSlot;
+	TraceEntryHashSlot_t xSlot;
 	TraceEntry_t* pxEntry;
 
 	/* This should never fail */
@@ -187,9 +293,11 @@ traceResult xTraceEntryFind(void* pvAddress, TraceEntryHandle_t* pxEntryHandle)
 	/* This should never fail */
 	TRC_ASSERT(pvAddress != 0);
 
-	for (i = 0; i < TRC_ENTRY_TABLE_SLOTS; i++)
+	/* Entries created without an address use their own address, which isn't hashed */
+	if (VALIDATE_ENTRY_HANDLE(pvAddress))
 	{
-		pxEntry = (TraceEntry_t*)(((uint32_t)pxEntryTable->axEntries) + (i * sizeof(TraceEntry_t)));
+		i = CALCULATE_ENTRY_INDEX(pvAddress);
+		pxEntry = &pxEntryTable->axEntries[i];
 		if (pxEntry->pvAddress == pvAddress)
 		{
 			*pxEntryHandle = (TraceEntryHandle_t)pxEntry;
@@ -198,6 +306,35 @@ traceResult xTraceEntryFind(void* pvAddress, TraceEntryHandle_t* pxEntryHandle)
 		}
 	}
 
+	/* Does not need to be locked, since a slot in use is never moved and only
+	 * changes to deleted when its entry is deleted. */
+	uiSlot = CALCULATE_ENTRY_HASH(pvAddress);
+	for (i = 0; i < TRC_ENTRY_HASH_SLOTS; i++)
+	{
+		xSlot = xHashTable.axSlots[uiSlot];
+		if (xSlot == TRC_ENTRY_HASH_EMPTY)
+		{
+			break;
+		}
+
+		if (xSlot != TRC_ENTRY_HASH_DELETED)
+		{
+			pxEntry = &pxEntryTable->axEntries[xSlot];
+			if (pxEntry->pvAddress == pvAddress)
+			{
+#if (TRC_CFG_ENTRY_RECYCLE == 1)
+				aucEntryReferenced[xSlot] = 1;
+#endif /* (TRC_CFG_ENTRY_RECYCLE == 1) */
+
+				*pxEntryHandle = (TraceEntryHandle_t)pxEntry;
+
+				return TRC_SUCCESS;
+			}
+		}
+
+		uiSlot = (uiSlot + 1) % (TRC_ENTRY_HASH_SLOTS);
+	}
+
 	return TRC_FAIL;
 }
 
@@ -270,14 +407,6 @@ traceResult xTraceEntryGetAtIndex(uint32_t index, TraceEntryHandle_t* pxEntryHan
 
 #if ((TRC_CFG_USE_TRACE_ASSERT) == 1)
 
-traceResult xTraceEntryCreateWithAddress(void* pvAddress, TraceEntryHandle_t* pxEntryHandle)
-{
-	/* This should never fail */
-	TRC_ASSERT(pvAddress != 0);
-
-	return TRC_ENTRY_CREATE_WITH_ADDRESS(pvAddress, pxEntryHandle);
-}
-
 traceResult xTraceEntrySetState(TraceEntryHandle_t xEntryHandle, uint32_t uiStateIndex, TraceUnsignedBaseType_t uxState)
 {
 	/* This should never fail */
@@ -424,6 +553,105 @@ traceResult prvEntryIndexTake(TraceEntryIndex_t *pxIndex)
 	return TRC_SUCCESS;
 }
 
+traceResult prvEntryHashInsert(TraceEntryIndex_t xIndex)
+{
+	/* Critical Section must be active! */
+	uint32_t uiSlot = CALCULATE_ENTRY_HASH(pxEntryTable->axEntries[xIndex].pvAddress);
+
+	/* There are more slots than entries, so a free slot is always found */
+	while ((xHashTable.axSlots[uiSlot] != TRC_ENTRY_HASH_EMPTY) && (xHashTable.axSlots[uiSlot] != TRC_ENTRY_HASH_DELETED))
+	{
+		uiSlot = (uiSlot + 1) % (TRC_ENTRY_HASH_SLOTS);
+	}
+
+	xHashTable.axSlots[uiSlot] = (TraceEntryHashSlot_t)xIndex;
+
+	return TRC_SUCCESS;
+}
+
+traceResult prvEntryHashRemove(TraceEntryIndex_t xIndex)
+{
+	/* Critical Section must be active! */
+	uint32_t i;
+	uint32_t uiSlot = CALCULATE_ENTRY_HASH(pxEntryTable->axEntries[xIndex].pvAddress);
+
+	for (i = 0; i < TRC_ENTRY_HASH_SLOTS; i++)
+	{
+		if (xHashTable.axSlots[uiSlot] == (TraceEntryHashSlot_t)xIndex)
+		{
+			break;
+		}
+
+		/* This should never fail */
+		TRC_ASSERT(xHashTable.axSlots[uiSlot] != TRC_ENTRY_HASH_EMPTY);
+
+		uiSlot = (uiSlot + 1) % (TRC_ENTRY_HASH_SLOTS);
+	}
+
+	xHashTable.axSlots[uiSlot] = TRC_ENTRY_HASH_DELETED;
+
+	/* If the next slot is empty no probe sequence continues past this one, so
+	 * this slot and any deleted slots before it can be made empty again. This
+	 * keeps deleted slots from piling up and lengthening lookups. */
+	if (xHashTable.axSlots[(uiSlot + 1) % (TRC_ENTRY_HASH_SLOTS)] == TRC_ENTRY_HASH_EMPTY)
+	{
+		while (xHashTable.axSlots[uiSlot] == TRC_ENTRY_HASH_DELETED)
+		{
+			xHashTable.axSlots[uiSlot] = TRC_ENTRY_HASH_EMPTY;
+			uiSlot = (uiSlot + (TRC_ENTRY_HASH_SLOTS) - 1) % (TRC_ENTRY_HASH_SLOTS);
+		}
+	}
+
+	return TRC_SUCCESS;
+}
+
+#if (TRC_CFG_ENTRY_RECYCLE == 1)
+
+traceResult prvEntryRecycle(TraceEntryIndex_t *pxIndex)
+{
+	/* Critical Section must be active! */
+	uint32_t i;
+	TraceEntry_t* pxEntry;
+
+	/* Second chance (clock) replacement, which approximates least recently
+	 * used. Entries used since the hand last passed are skipped once, so two
+	 * rounds always find one if any can be recycled. */
+	for (i = 0; i < (TRC_ENTRY_TABLE_SLOTS) * 2; i++)
+	{
+		uiEntryClockHand = (uiEntryClockHand + 1) % (TRC_ENTRY_TABLE_SLOTS);
+		pxEntry = &pxEntryTable->axEntries[uiEntryClockHand];
+
+		/* Only entries mapped to object addresses are recycled, since the
+		 * others are referenced by their handles. */
+		if ((pxEntry->pvAddress == 0) || (pxEntry->pvAddress == (void*)pxEntry))
+		{
+			continue;
+		}
+
+		if (aucEntryReferenced[uiEntryClockHand] != 0)
+		{
+			aucEntryReferenced[uiEntryClockHand] = 0;
+
+			continue;
+		}
+
+		/* This should never fail */
+		TRC_ASSERT_ALWAYS_EVALUATE(prvEntryHashRemove((TraceEntryIndex_t)uiEntryClockHand) == TRC_SUCCESS);
+
+		pxEntry->pvAddress = 0;
+
+		xTraceDiagnosticsIncrease(TRC_DIAGNOSTICS_ENTRY_SLOTS_RECYCLED);
+
+		*pxIndex = (TraceEntryIndex_t)uiEntryClockHand;
+
+		return TRC_SUCCESS;
+	}
+
+	return TRC_FAIL;
+}
+
+#endif /* (TRC_CFG_ENTRY_RECYCLE == 1) */
+
 #endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
 
 #endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
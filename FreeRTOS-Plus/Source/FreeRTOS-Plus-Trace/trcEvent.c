@@ -27,6 +27,184 @@ int32_t DUMMY_iTraceBytesCommitted;
 
 TRACE_ALLOC_CRITICAL_SECTION();
 
+#if (TRC_CFG_STREAMING_COMPACT == 1)
+
+/*
+ * Compact event format (TRC_CFG_STREAMING_COMPACT), little endian, unaligned:
+ *
+ * uint8_t  flags      bit 7 always set (zero bytes are padding), bit 0 absolute,
+ *                     bit 1 event count included, bits 2-5 core
+ * uint16_t EventID    as in TraceBaseEvent_t, including the parameter count
+ * uint16_t EventCount only if bit 1 is set, otherwise the previous event count
+ *                     on the core + 1, with the core bits (12-15) kept
+ * varint   TS         7 bits per byte, lowest first, bit 7 set if more follow.
+ *                     The timestamp if absolute, otherwise the difference to
+ *                     the previous event on the core
+ * uint8_t  tags[]     2 bits per parameter, 4 per byte, lowest bits first
+ * ...      params     1, 2, 2 or 4 bytes each as given by the tag
+ *
+ * Tag 0 is an 8-bit and tag 1 a 16-bit value. Tag 2 is the lower 16 bits of a
+ * value whose upper 16 bits are those of the last tag 3 parameter on the core,
+ * for pointers to the same memory region. Tag 3 is the full 32-bit value. An
+ * absolute event resets the upper 16 bits to 0, and the first event of each
+ * core in a trace session is absolute, so a decoder can start there.
+ */
+#define TRC_COMPACT_FLAG_RECORD 0x80
+#define TRC_COMPACT_FLAG_ABSOLUTE 0x01
+#define TRC_COMPACT_FLAG_COUNT 0x02
+
+#define TRC_COMPACT_TAG_8 0
+#define TRC_COMPACT_TAG_16 1
+#define TRC_COMPACT_TAG_LOW_16 2
+#define TRC_COMPACT_TAG_32 3
+
+#define TRC_COMPACT_NEXT_COUNT(c) ((uint16_t)(((c) & 0xF000) | (((c) + 1) & 0x0FFF)))
+
+static const uint8_t auiCompactTagSize[4] = { 1, 2, 2, 4 };
+
+static uint32_t prvTraceEventCompactTag(uint32_t uiValue, uint16_t* puiHigh)
+{
+	if (uiValue <= 0xFF)
+	{
+		return TRC_COMPACT_TAG_8;
+	}
+
+	if (uiValue <= 0xFFFF)
+	{
+		return TRC_COMPACT_TAG_16;
+	}
+
+	if ((uiValue >> 16) == *puiHigh)
+	{
+		return TRC_COMPACT_TAG_LOW_16;
+	}
+
+	*puiHigh = (uint16_t)(uiValue >> 16);
+
+	return TRC_COMPACT_TAG_32;
+}
+
+/**
+ * @internal Encodes the event built in pxEventData and commits it to the
+ * stream port. The core's previous event is only updated if the stream port
+ * took the whole event, so the next one is encoded relative to what was sent.
+ *
+ * @return The size of the encoded event
+ */
+static uint32_t prvTraceEventCommitCompact(TraceEventData_t* pxEventData, int32_t* piBytesCommitted)
+{
+	TraceCoreEventData_t* pxCoreEventData = &pxTraceEventDataTable->coreEventData[TRC_CFG_GET_CURRENT_CORE()];
+	TraceBaseEvent_t* pxEvent = (TraceBaseEvent_t*)pxEventData->uxEvent;
+	uint32_t* puiParams = (uint32_t*)&pxEvent[1];
+	uint32_t uiParamCount = (pxEventData->size - sizeof(TraceBaseEvent_t)) / sizeof(uint32_t);
+	uint32_t uiFlags = TRC_COMPACT_FLAG_RECORD | ((TRC_CFG_GET_CURRENT_CORE() & 0xF) << 2);
+	uint32_t uiTS = pxEvent->TS;
+	uint32_t uiSize, uiTag, uiValue, i, j;
+	uint16_t uiHigh = pxCoreEventData->compactHigh;
+	uint16_t uiSizeHigh;
+	uint8_t* puiRecord;
+	void* pvRecord;
+
+	if (pxCoreEventData->compactSession != pxTraceRecorderData->uiSessionCounter)
+	{
+		uiFlags |= TRC_COMPACT_FLAG_ABSOLUTE | TRC_COMPACT_FLAG_COUNT;
+		uiHigh = 0;
+	}
+	else
+	{
+		uiTS -= pxCoreEventData->compactTS;
+
+		if (pxEvent->EventCount != TRC_COMPACT_NEXT_COUNT(pxCoreEventData->compactCount))
+		{
+			uiFlags |= TRC_COMPACT_FLAG_COUNT;
+		}
+	}
+
+	/* Flags, EventID, EventCount, tags */
+	uiSize = 3 + ((uiFlags & TRC_COMPACT_FLAG_COUNT) ? 2 : 0) + (uiParamCount + 3) / 4;
+
+	for (uiValue = uiTS; uiValue >= 0x80; uiValue >>= 7)
+	{
+		uiSize++;
+	}
+	uiSize++;
+
+	/* The tags are found again when encoding, from the same upper half */
+	uiSizeHigh = uiHigh;
+	for (i = 0; i < uiParamCount; i++)
+	{
+		uiSize += auiCompactTagSize[prvTraceEventCompactTag(puiParams[i], &uiSizeHigh)];
+	}
+
+	if (xTraceStreamPortAllocate(uiSize, &pvRecord) == TRC_FAIL)
+	{
+		/* Dropped, which the next event's count will show */
+		*piBytesCommitted = 0;
+
+		return uiSize;
+	}
+
+	puiRecord = (uint8_t*)pvRecord;
+
+	*puiRecord++ = (uint8_t)uiFlags;
+	*puiRecord++ = (uint8_t)pxEvent->EventID;
+	*puiRecord++ = (uint8_t)(pxEvent->EventID >> 8);
+
+	if (uiFlags & TRC_COMPACT_FLAG_COUNT)
+	{
+		*puiRecord++ = (uint8_t)pxEvent->EventCount;
+		*puiRecord++ = (uint8_t)(pxEvent->EventCount >> 8);
+	}
+
+	while (uiTS >= 0x80)
+	{
+		*puiRecord++ = (uint8_t)(uiTS | 0x80);
+		uiTS >>= 7;
+	}
+	*puiRecord++ = (uint8_t)uiTS;
+
+	for (i = 0; i < uiParamCount; i += 4)
+	{
+		uint8_t* puiTags = puiRecord++;
+
+		*puiTags = 0;
+
+		for (j = i; j < i + 4 && j < uiParamCount; j++)
+		{
+			uiValue = puiParams[j];
+			uiTag = prvTraceEventCompactTag(uiValue, &uiHigh);
+
+			*puiTags |= (uint8_t)(uiTag << ((j - i) * 2));
+
+			/* The parameters of the 4 tags follow the tag byte */
+			*puiRecord++ = (uint8_t)uiValue;
+			if (uiTag != TRC_COMPACT_TAG_8)
+			{
+				*puiRecord++ = (uint8_t)(uiValue >> 8);
+			}
+			if (uiTag == TRC_COMPACT_TAG_32)
+			{
+				*puiRecord++ = (uint8_t)(uiValue >> 16);
+				*puiRecord++ = (uint8_t)(uiValue >> 24);
+			}
+		}
+	}
+
+	xTraceStreamPortCommit(pvRecord, uiSize, piBytesCommitted);
+
+	if ((*piBytesCommitted >= 0) && ((uint32_t)*piBytesCommitted == uiSize))
+	{
+		pxCoreEventData->compactSession = pxTraceRecorderData->uiSessionCounter;
+		pxCoreEventData->compactTS = pxEvent->TS;
+		pxCoreEventData->compactCount = pxEvent->EventCount;
+		pxCoreEventData->compactHigh = uiHigh;
+	}
+
+	return uiSize;
+}
+
+#endif /* (TRC_CFG_STREAMING_COMPACT == 1) */
+
 traceResult xTraceEventInitialize(TraceEventDataBuffer_t* pxBuffer)
 {
 	TraceCoreEventData_t* pxCoreEventData;
@@ -45,6 +223,14 @@ traceResult xTraceEventInitialize(TraceEventDataBuffer_t* pxBuffer)
 
 		pxCoreEventData->eventCounter = 0;
 
+#if (TRC_CFG_STREAMING_COMPACT == 1)
+		/* The first session is 1, so its first event is absolute */
+		pxCoreEventData->compactSession = 0;
+		pxCoreEventData->compactTS = 0;
+		pxCoreEventData->compactCount = 0;
+		pxCoreEventData->compactHigh = 0;
+#endif
+
 		for (j = 0; j < (TRC_CFG_MAX_ISR_NESTING) + 1; j++)
 		{
 			RESET_EVENT_DATA(&pxCoreEventData->eventData[j]);
@@ -80,18 +266,31 @@ traceResult xTraceEventBeginRawOffline(uint32_t uiSize, TraceEventHandle_t* pxEv
 	/* This should never fail */
 	TRC_ASSERT_CUSTOM_ON_FAIL(pxEventData->pvBlob == 0, TRACE_EXIT_CRITICAL_SECTION(); return TRC_FAIL; );
 
+#if (TRC_CFG_ENABLE_RECORDER_METRICS == 1)
+	pxEventData->start = (uint32_t)(TRC_HWTC_COUNT);
+#endif
+
 	VERIFY_EVENT_SIZE(uiSize);
 
 	pxEventData->size = ((uiSize + (sizeof(uint32_t) - 1)) / sizeof(uint32_t)) * sizeof(uint32_t);	/* 4-byte align */
 
 	pxEventData->offset = 0;
 
+#if (TRC_CFG_STREAMING_COMPACT == 1)
+	/* Built here and allocated in the stream port once its encoded size is known */
+	pxEventData->pvBlob = (void*)pxEventData->uxEvent;
+#else
 	/* This can fail and we should handle it */
 	if (xTraceStreamPortAllocate(pxEventData->size, &pxEventData->pvBlob) == TRC_FAIL)
 	{
+#if (TRC_CFG_ENABLE_RECORDER_METRICS == 1)
+		xTraceDiagnosticsIncrease(TRC_DIAGNOSTICS_EVENTS_DROPPED);
+#endif
+
 		TRACE_EXIT_CRITICAL_SECTION();
 		return TRC_FAIL;
 	}
+#endif
 
 	*pxEventHandle = (TraceEventHandle_t)pxEventData;
 
@@ -142,7 +341,8 @@ traceResult xTraceEventBeginRawOfflineBlocking(uint32_t uiSize, TraceEventHandle
 
 traceResult xTraceEventEndOffline(TraceEventHandle_t xEventHandle)
 {
-	int32_t iBytesCommitted;
+	int32_t iBytesCommitted = 0;
+	uint32_t uiSize;
 
 	/* This should never fail */
 	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_EVENT));
@@ -153,7 +353,19 @@ traceResult xTraceEventEndOffline(TraceEventHandle_t xEventHandle)
 	/* This should never fail */
 	TRC_ASSERT(((TraceEventData_t*)xEventHandle)->pvBlob != 0);
 
-	xTraceStreamPortCommit(((TraceEventData_t*)xEventHandle)->pvBlob, ((TraceEventData_t*)xEventHandle)->size, &iBytesCommitted);
+#if (TRC_CFG_STREAMING_COMPACT == 1)
+	uiSize = prvTraceEventCommitCompact((TraceEventData_t*)xEventHandle, &iBytesCommitted);
+#else
+	uiSize = ((TraceEventData_t*)xEventHandle)->size;
+
+	xTraceStreamPortCommit(((TraceEventData_t*)xEventHandle)->pvBlob, uiSize, &iBytesCommitted);
+#endif
+
+#if (TRC_CFG_ENABLE_RECORDER_METRICS == 1)
+	xTraceDiagnosticsEventCommitted(uiSize, iBytesCommitted, ((TraceEventData_t*)xEventHandle)->start);
+#else
+	(void)uiSize;
+#endif
 
 	RESET_EVENT_DATA((TraceEventData_t*)xEventHandle);
 
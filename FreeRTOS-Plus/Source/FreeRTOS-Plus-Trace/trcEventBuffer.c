@@ -28,6 +28,7 @@ traceResult xTraceEventBufferInitialize(TraceEventBuffer_t* pxTraceEventBuffer,
 	pxTraceEventBuffer->uiTail = 0;
 	pxTraceEventBuffer->uiSize = uiSize;
 	pxTraceEventBuffer->uiFree = uiSize;
+	pxTraceEventBuffer->uiDroppedEvents = 0;
 	pxTraceEventBuffer->puiBuffer = puiBuffer;
 	pxTraceEventBuffer->uiTimerWraparounds = 0;
 
@@ -57,6 +58,11 @@ static traceResult prvTraceEventBufferPop(TraceEventBuffer_t *pxTraceEventBuffer
 	/* Update tail to point to the new last event */
 	pxTraceEventBuffer->uiTail = (pxTraceEventBuffer->uiTail + uiFreeSize) % pxTraceEventBuffer->uiSize;
 
+#if (TRC_CFG_ENABLE_RECORDER_METRICS == 1)
+	/* Overwritten, so it is as lost as a skipped event */
+	xTraceDiagnosticsIncrease(TRC_DIAGNOSTICS_EVENTS_DROPPED);
+#endif
+
 	return TRC_SUCCESS;
 }
 
@@ -76,9 +82,11 @@ traceResult xTraceEventBufferPush(TraceEventBuffer_t *pxTraceEventBuffer, void *
 	/* This should never fail */
 	TRC_ASSERT(uiDataSize <= uiBufferSize);
 
+#if (TRC_CFG_STREAMING_COMPACT == 0)
 	/* Check byte alignment */
 	/* This should never fail */
 	TRC_ASSERT((uiDataSize % 4) == 0);
+#endif
 
 	/* Ensure bytes written start at 0 */
 	/* This should never fail */
@@ -92,6 +100,8 @@ traceResult xTraceEventBufferPush(TraceEventBuffer_t *pxTraceEventBuffer, void *
 	/* In ring buffer mode we cannot provide lock free access since the producer modified
 	 * the head and tail variables in the same call. This option is only safe when used
 	 * with an internal buffer (streaming snapshot) which no consumer accesses.
+	 * TRC_EVENT_BUFFER_OPTION_LOCK_FREE is the mode to use when a consumer on another
+	 * core transfers from the buffer while it is being pushed to.
 	 */
 	switch (pxTraceEventBuffer->uiOptions)
 	{
@@ -183,6 +193,63 @@ traceResult xTraceEventBufferPush(TraceEventBuffer_t *pxTraceEventBuffer, void *
 			break;
 		}
 
+		case TRC_EVENT_BUFFER_OPTION_LOCK_FREE:
+		{
+			/* The producer only writes the head and the consumer only writes the tail,
+			 * so reading the tail here gives a lower bound on the free space even if the
+			 * consumer advances it during the procedure. One word is always left unused
+			 * so that a full buffer can be told apart from an empty one.
+			 */
+			uint32_t uiHead = pxTraceEventBuffer->uiHead;
+			uint32_t uiTail = pxTraceEventBuffer->uiTail;
+			uint32_t uiFreeSpace;
+
+			if (uiHead >= uiTail)
+			{
+				uiFreeSpace = (uiBufferSize - uiHead - sizeof(uint32_t)) + uiTail;
+			}
+			else
+			{
+				uiFreeSpace = uiTail - uiHead - sizeof(uint32_t);
+			}
+
+			if (uiFreeSpace < uiDataSize)
+			{
+				pxTraceEventBuffer->uiDroppedEvents++;
+
+				return TRC_SUCCESS;
+			}
+
+			/* The tail must be read before the space it frees is overwritten */
+			TRC_EVENT_BUFFER_MEMORY_BARRIER();
+
+			/* Copy data */
+			if ((uiBufferSize - uiHead) > uiDataSize)
+			{
+				TRC_MEMCPY(&pxTraceEventBuffer->puiBuffer[uiHead], pxData, uiDataSize);
+
+				uiHead += uiDataSize;
+			}
+			else
+			{
+				TRC_MEMCPY(&pxTraceEventBuffer->puiBuffer[uiHead], pxData, uiBufferSize - uiHead);
+				TRC_MEMCPY(pxTraceEventBuffer->puiBuffer,
+							(void*)(&((uint8_t*)pxData)[(uiBufferSize - uiHead)]),
+							uiDataSize - (uiBufferSize - uiHead));
+
+				uiHead = uiDataSize - (uiBufferSize - uiHead);
+			}
+
+			/* The data must be visible to the consumer before the head which publishes it */
+			TRC_EVENT_BUFFER_MEMORY_BARRIER();
+
+			pxTraceEventBuffer->uiHead = uiHead;
+
+			*piBytesWritten = uiDataSize;
+
+			break;
+		}
+
 		default:
 		{
 			return TRC_FAIL;
@@ -192,6 +259,155 @@ traceResult xTraceEventBufferPush(TraceEventBuffer_t *pxTraceEventBuffer, void *
 	return TRC_SUCCESS;
 }
 
+traceResult xTraceEventBufferAllocate(TraceEventBuffer_t *pxTraceEventBuffer, uint32_t uiDataSize, void **ppvData)
+{
+	uint32_t uiBufferSize;
+	uint32_t uiHead;
+	uint32_t uiTail;
+	uint32_t uiFreeSpace;
+
+	/* This should never fail */
+	TRC_ASSERT(pxTraceEventBuffer != 0);
+
+	/* This should never fail */
+	TRC_ASSERT(ppvData != 0);
+
+	uiBufferSize = pxTraceEventBuffer->uiSize;
+
+	/* This should never fail */
+	TRC_ASSERT(uiDataSize <= uiBufferSize);
+
+#if (TRC_CFG_STREAMING_COMPACT == 0)
+	/* This should never fail */
+	TRC_ASSERT((uiDataSize % 4) == 0);
+#endif
+
+	uiHead = pxTraceEventBuffer->uiHead;
+
+	switch (pxTraceEventBuffer->uiOptions)
+	{
+		case TRC_EVENT_BUFFER_OPTION_OVERWRITE:
+		{
+			/* Make room first, since the event will be written over the oldest events */
+			while (pxTraceEventBuffer->uiFree < uiDataSize)
+			{
+				prvTraceEventBufferPop(pxTraceEventBuffer);
+			}
+
+			uiFreeSpace = uiDataSize;
+
+			break;
+		}
+
+		case TRC_EVENT_BUFFER_OPTION_SKIP:
+		case TRC_EVENT_BUFFER_OPTION_LOCK_FREE:
+		{
+			/* Same free space calculation as xTraceEventBufferPush(...) */
+			uiTail = pxTraceEventBuffer->uiTail;
+
+			if (uiHead >= uiTail)
+			{
+				uiFreeSpace = (uiBufferSize - uiHead - sizeof(uint32_t)) + uiTail;
+			}
+			else
+			{
+				uiFreeSpace = uiTail - uiHead - sizeof(uint32_t);
+			}
+
+			/* The tail must be read before the space it frees is overwritten */
+			TRC_EVENT_BUFFER_MEMORY_BARRIER();
+
+			break;
+		}
+
+		default:
+		{
+			return TRC_FAIL;
+		}
+	}
+
+	/* The event can only be written in place if it doesn't wrap. Otherwise it is
+	 * written to the static buffer and copied by xTraceEventBufferCommit(...), which
+	 * also handles the buffer being full the same way xTraceEventBufferPush(...) does.
+	 */
+	if ((uiFreeSpace >= uiDataSize) && ((uiBufferSize - uiHead) >= uiDataSize))
+	{
+		*ppvData = (void*)&pxTraceEventBuffer->puiBuffer[uiHead];
+
+		return TRC_SUCCESS;
+	}
+
+	return xTraceStaticBufferGet(ppvData);
+}
+
+traceResult xTraceEventBufferCommit(TraceEventBuffer_t *pxTraceEventBuffer, void *pvData, uint32_t uiDataSize, int32_t *piBytesWritten)
+{
+	uint32_t uiHead;
+
+	/* This should never fail */
+	TRC_ASSERT(pxTraceEventBuffer != 0);
+
+	/* This should never fail */
+	TRC_ASSERT(pvData != 0);
+
+	/* This should never fail */
+	TRC_ASSERT(piBytesWritten != 0);
+
+	uiHead = pxTraceEventBuffer->uiHead;
+
+	if (pvData != (void*)&pxTraceEventBuffer->puiBuffer[uiHead])
+	{
+		/* Not written in place */
+		return xTraceEventBufferPush(pxTraceEventBuffer, pvData, uiDataSize, piBytesWritten);
+	}
+
+	/* This should never fail */
+	TRC_ASSERT_ALWAYS_EVALUATE(xTraceTimestampGetWraparounds(&pxTraceEventBuffer->uiTimerWraparounds) == TRC_SUCCESS);
+
+	uiHead += uiDataSize;
+	if (uiHead == pxTraceEventBuffer->uiSize)
+	{
+		uiHead = 0;
+	}
+
+	if (pxTraceEventBuffer->uiOptions == TRC_EVENT_BUFFER_OPTION_OVERWRITE)
+	{
+		pxTraceEventBuffer->uiFree -= uiDataSize;
+	}
+
+	/* The data must be visible to the consumer before the head which publishes it */
+	TRC_EVENT_BUFFER_MEMORY_BARRIER();
+
+	pxTraceEventBuffer->uiHead = uiHead;
+
+	*piBytesWritten = (int32_t)uiDataSize;
+
+	return TRC_SUCCESS;
+}
+
+/**
+ * @brief Clamps the byte count reported by the stream port to what it was given.
+ * 
+ * @param[in] iBytesWritten Bytes the stream port reported as written.
+ * @param[in] uiSize Bytes given to the stream port.
+ * 
+ * @return Bytes that can be released from the buffer.
+ */
+static int32_t prvTraceEventBufferWritten(int32_t iBytesWritten, uint32_t uiSize)
+{
+	if (iBytesWritten < 0)
+	{
+		return 0;
+	}
+
+	if ((uint32_t)iBytesWritten > uiSize)
+	{
+		return (int32_t)uiSize;
+	}
+
+	return iBytesWritten;
+}
+
 traceResult xTraceEventBufferTransfer(TraceEventBuffer_t* pxTraceEventBuffer, int32_t* piBytesWritten)
 {
 	int32_t iBytesWritten = 0;
@@ -214,25 +430,56 @@ traceResult xTraceEventBufferTransfer(TraceEventBuffer_t* pxTraceEventBuffer, in
 		return TRC_SUCCESS;
 	}
 
+#if (TRC_CFG_ENABLE_RECORDER_METRICS == 1)
+	/* Only transfers empty the buffer, so it is the fullest just before one */
+	xTraceDiagnosticsSetIfHigher(TRC_DIAGNOSTICS_BUFFER_HIGH_WATER_MARK,
+		(TraceBaseType_t)(uiHead > uiTail ? uiHead - uiTail : pxTraceEventBuffer->uiSize - uiTail + uiHead));
+#endif
+
+	/* The data must be read only after the head which publishes it */
+	TRC_EVENT_BUFFER_MEMORY_BARRIER();
+
 	/* Check if we can do a direct write or if we have to handle wrapping */
 	if (uiHead > uiTail)
 	{
 		xTraceStreamPortWriteData(&pxTraceEventBuffer->puiBuffer[uiTail], (uiHead - uiTail), &iBytesWritten);
 
-		pxTraceEventBuffer->uiTail = uiHead;
+		iSumBytesWritten = prvTraceEventBufferWritten(iBytesWritten, uiHead - uiTail);
 	}
 	else
 	{
 		xTraceStreamPortWriteData(&pxTraceEventBuffer->puiBuffer[uiTail], (pxTraceEventBuffer->uiSize - uiTail), &iBytesWritten);
 
-		iSumBytesWritten += iBytesWritten;
+		iSumBytesWritten = prvTraceEventBufferWritten(iBytesWritten, pxTraceEventBuffer->uiSize - uiTail);
 
-		xTraceStreamPortWriteData(pxTraceEventBuffer->puiBuffer, uiHead, &iBytesWritten);
+		/* Only continue from the start of the buffer if the end was written completely */
+		if ((uint32_t)iSumBytesWritten == (pxTraceEventBuffer->uiSize - uiTail))
+		{
+			iBytesWritten = 0;
 
-		pxTraceEventBuffer->uiTail = uiHead;
+			xTraceStreamPortWriteData(pxTraceEventBuffer->puiBuffer, uiHead, &iBytesWritten);
+
+			iSumBytesWritten += prvTraceEventBufferWritten(iBytesWritten, uiHead);
+		}
 	}
 
-	iSumBytesWritten += iBytesWritten;
+	/* The data must be read before the tail releases it to the producer */
+	TRC_EVENT_BUFFER_MEMORY_BARRIER();
+
+	if (pxTraceEventBuffer->uiOptions == TRC_EVENT_BUFFER_OPTION_OVERWRITE)
+	{
+		/* Overwrite mode walks the buffer event by event from the tail, so it
+		 * can't keep a partially written event. Whatever the stream port
+		 * didn't take is lost. */
+		pxTraceEventBuffer->uiTail = uiHead;
+	}
+	else
+	{
+		/* Keep what the stream port didn't take so it is retried on the next
+		 * transfer. A full buffer makes the producer skip new events instead,
+		 * which are counted, rather than cutting events out of the stream. */
+		pxTraceEventBuffer->uiTail = (uiTail + (uint32_t)iSumBytesWritten) % pxTraceEventBuffer->uiSize;
+	}
 
 	*piBytesWritten = iSumBytesWritten;
 
@@ -0,0 +1,396 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* The implementation of the heap profiler.
+*/
+
+#include <trcRecorder.h>
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#if (TRC_CFG_ENABLE_HEAP_PROFILER == 1)
+
+/* Size class 0 is below 2^4 = 16 bytes */
+#define TRC_HEAP_PROFILER_SIZE_CLASS_SHIFT 4
+
+static TraceHeapProfilerData_t* pxHeapProfiler;
+
+#if (TRC_CFG_SCHEDULING_ONLY == 0) && (TRC_CFG_INCLUDE_USER_EVENTS == 1)
+static TraceStringHandle_t xHeapChannel = 0;
+#endif
+
+static uint32_t prvTraceHeapProfilerGetCallSite(void* pvCallSite);
+
+traceResult xTraceHeapProfilerInitialize(TraceHeapProfilerBuffer_t* pxBuffer)
+{
+	uint32_t i;
+
+	TRC_ASSERT_EQUAL_SIZE(TraceHeapProfilerBuffer_t, TraceHeapProfilerData_t);
+
+	/* This should never fail */
+	TRC_ASSERT(pxBuffer != 0);
+
+	pxHeapProfiler = (TraceHeapProfilerData_t*)pxBuffer;
+
+	pxHeapProfiler->uiCallSiteCount = 0;
+	pxHeapProfiler->uiAllocationCount = 0;
+	pxHeapProfiler->uiUntracked = 0;
+	pxHeapProfiler->uiReportTick = 0;
+
+	for (i = 0; i < (TRC_HEAP_PROFILER_SIZE_CLASSES); i++)
+	{
+		pxHeapProfiler->uiSizeClasses[i] = 0;
+	}
+
+	xTraceSetComponentInitialized(TRC_RECORDER_COMPONENT_HEAP_PROFILER);
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHeapProfilerAlloc(void* pvAddress, TraceUnsignedBaseType_t uxSize, void* pvCallSite)
+{
+	TraceHeapProfilerCallSite_t* pxCallSite;
+	TraceHeapProfilerAllocation_t* pxAllocation;
+	uint32_t uiIndex;
+	uint32_t uiClass;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* Allocations happen before the recorder is initialized */
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_HEAP_PROFILER))
+	{
+		return TRC_FAIL;
+	}
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	uiIndex = prvTraceHeapProfilerGetCallSite(pvCallSite);
+	pxCallSite = &pxHeapProfiler->xCallSites[uiIndex];
+	pxHeapProfiler->ucChanged[uiIndex] = 1;
+
+	/* If the address is null we assume this was a failed alloc attempt */
+	if (pvAddress == 0)
+	{
+		pxCallSite->uiFailedAllocs++;
+
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		return TRC_SUCCESS;
+	}
+
+	pxCallSite->uiAllocs++;
+	pxCallSite->uxBytes += uxSize;
+
+	for (uiClass = 0; uiClass < (TRC_HEAP_PROFILER_SIZE_CLASSES) - 1; uiClass++)
+	{
+		if (uxSize < ((TraceUnsignedBaseType_t)1 << (TRC_HEAP_PROFILER_SIZE_CLASS_SHIFT + uiClass)))
+		{
+			break;
+		}
+	}
+	pxHeapProfiler->uiSizeClasses[uiClass]++;
+
+	if (pxHeapProfiler->uiAllocationCount < (TRC_CFG_HEAP_PROFILER_MAX_LIVE_ALLOCATIONS))
+	{
+		pxAllocation = &pxHeapProfiler->xAllocations[pxHeapProfiler->uiAllocationCount];
+		pxAllocation->pvAddress = pvAddress;
+		pxAllocation->uxSize = uxSize;
+		pxAllocation->uiCallSite = uiIndex;
+		pxHeapProfiler->uiAllocationCount++;
+
+		pxCallSite->uiLiveAllocs++;
+		pxCallSite->uxLiveBytes += uxSize;
+	}
+	else
+	{
+		/* Its free can't be attributed */
+		pxHeapProfiler->uiUntracked++;
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHeapProfilerFree(void* pvAddress)
+{
+	TraceHeapProfilerCallSite_t* pxCallSite;
+	TraceHeapProfilerAllocation_t* pxAllocation;
+	uint32_t i;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_HEAP_PROFILER))
+	{
+		return TRC_FAIL;
+	}
+
+	if (pvAddress == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	for (i = 0; i < pxHeapProfiler->uiAllocationCount; i++)
+	{
+		pxAllocation = &pxHeapProfiler->xAllocations[i];
+
+		if (pxAllocation->pvAddress == pvAddress)
+		{
+			pxCallSite = &pxHeapProfiler->xCallSites[pxAllocation->uiCallSite];
+			pxCallSite->uiFrees++;
+			pxCallSite->uiLiveAllocs--;
+			pxCallSite->uxLiveBytes -= pxAllocation->uxSize;
+			pxHeapProfiler->ucChanged[pxAllocation->uiCallSite] = 1;
+
+			/* Move the last allocation to this slot */
+			pxHeapProfiler->uiAllocationCount--;
+			*pxAllocation = pxHeapProfiler->xAllocations[pxHeapProfiler->uiAllocationCount];
+
+			TRACE_EXIT_CRITICAL_SECTION();
+
+			return TRC_SUCCESS;
+		}
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	/* Allocated before the recorder was initialized, or untracked */
+	return TRC_FAIL;
+}
+
+traceResult xTraceHeapProfilerGetCallSiteCount(uint32_t* puiCount)
+{
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_HEAP_PROFILER));
+
+	/* This should never fail */
+	TRC_ASSERT(puiCount != 0);
+
+	*puiCount = pxHeapProfiler->uiCallSiteCount;
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHeapProfilerGetCallSite(uint32_t uiIndex, TraceHeapProfilerCallSite_t* pxCallSite)
+{
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_HEAP_PROFILER));
+
+	/* This should never fail */
+	TRC_ASSERT(pxCallSite != 0);
+
+	/* We need to check this */
+	if (uiIndex >= pxHeapProfiler->uiCallSiteCount)
+	{
+		return TRC_FAIL;
+	}
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	*pxCallSite = pxHeapProfiler->xCallSites[uiIndex];
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHeapProfilerGetSizeClass(uint32_t uiClass, uint32_t* puiCount)
+{
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_HEAP_PROFILER));
+
+	/* This should never fail */
+	TRC_ASSERT(puiCount != 0);
+
+	/* This should never fail */
+	TRC_ASSERT(uiClass < (TRC_HEAP_PROFILER_SIZE_CLASSES));
+
+	*puiCount = pxHeapProfiler->uiSizeClasses[uiClass];
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHeapProfilerGetUntracked(uint32_t* puiCount)
+{
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_HEAP_PROFILER));
+
+	/* This should never fail */
+	TRC_ASSERT(puiCount != 0);
+
+	*puiCount = pxHeapProfiler->uiUntracked;
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHeapProfilerReport(void)
+{
+#if (TRC_CFG_SCHEDULING_ONLY == 0) && (TRC_CFG_INCLUDE_USER_EVENTS == 1)
+	TraceHeapProfilerCallSite_t xCallSite;
+	uint32_t uiSizeClasses[TRC_HEAP_PROFILER_SIZE_CLASSES];
+	uint32_t uiLiveAllocs = 0;
+	TraceUnsignedBaseType_t uxLiveBytes = 0;
+	uint32_t uiUntracked;
+	uint32_t uiChanged;
+	uint32_t uiTick = 0;
+	uint32_t i;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* We need to check this */
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_HEAP_PROFILER))
+	{
+		return TRC_FAIL;
+	}
+
+	if ((TRC_CFG_HEAP_PROFILER_REPORT_PERIOD) == 0)
+	{
+		return TRC_SUCCESS;
+	}
+
+	(void)xTraceTimestampGetOsTickCount(&uiTick);
+
+	if ((uiTick - pxHeapProfiler->uiReportTick) < (TRC_CFG_HEAP_PROFILER_REPORT_PERIOD))
+	{
+		return TRC_SUCCESS;
+	}
+
+	pxHeapProfiler->uiReportTick = uiTick;
+
+	if (xHeapChannel == 0)
+	{
+		if (xTraceStringRegister("#Heap", &xHeapChannel) == TRC_FAIL)
+		{
+			return TRC_FAIL;
+		}
+	}
+
+	/* Allocations update these from within their critical sections */
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	for (i = 0; i < pxHeapProfiler->uiCallSiteCount; i++)
+	{
+		uiLiveAllocs += pxHeapProfiler->xCallSites[i].uiLiveAllocs;
+		uxLiveBytes += pxHeapProfiler->xCallSites[i].uxLiveBytes;
+	}
+
+	for (i = 0; i < (TRC_HEAP_PROFILER_SIZE_CLASSES); i++)
+	{
+		uiSizeClasses[i] = pxHeapProfiler->uiSizeClasses[i];
+	}
+
+	uiUntracked = pxHeapProfiler->uiUntracked;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	/* Each report fits in one event. The arguments are read as TraceUnsignedBaseType_t. */
+	xTracePrintF(xHeapChannel, "Live %u blocks %u B, %u untracked", (TraceUnsignedBaseType_t)uiLiveAllocs, uxLiveBytes, (TraceUnsignedBaseType_t)uiUntracked);
+
+	xTracePrintF(xHeapChannel, "Sizes <128 B: %u %u %u %u",
+		(TraceUnsignedBaseType_t)uiSizeClasses[0],
+		(TraceUnsignedBaseType_t)uiSizeClasses[1],
+		(TraceUnsignedBaseType_t)uiSizeClasses[2],
+		(TraceUnsignedBaseType_t)uiSizeClasses[3]);
+
+	xTracePrintF(xHeapChannel, "Sizes 128+ B: %u %u %u %u",
+		(TraceUnsignedBaseType_t)uiSizeClasses[4],
+		(TraceUnsignedBaseType_t)uiSizeClasses[5],
+		(TraceUnsignedBaseType_t)uiSizeClasses[6],
+		(TraceUnsignedBaseType_t)uiSizeClasses[7]);
+
+	/* Only the call sites that allocated or freed since the last report */
+	for (i = 0; i < pxHeapProfiler->uiCallSiteCount; i++)
+	{
+		TRACE_ENTER_CRITICAL_SECTION();
+
+		uiChanged = pxHeapProfiler->ucChanged[i];
+		pxHeapProfiler->ucChanged[i] = 0;
+		xCallSite = pxHeapProfiler->xCallSites[i];
+
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		if (uiChanged != 0)
+		{
+			xTracePrintF(xHeapChannel, "%X: %u allocs %uB, live %u %uB",
+				(TraceUnsignedBaseType_t)xCallSite.pvCallSite,
+				(TraceUnsignedBaseType_t)xCallSite.uiAllocs,
+				xCallSite.uxBytes,
+				(TraceUnsignedBaseType_t)xCallSite.uiLiveAllocs,
+				xCallSite.uxLiveBytes);
+		}
+	}
+#endif
+
+	/* Without User Events the profile can only be read with the Get functions */
+	return TRC_SUCCESS;
+}
+
+/**
+ * @brief Gets the index of a call site, adding it if it is new. When all but
+ * the last slot are used, the remaining call sites share the last one, as
+ * call site 0.
+ *
+ * @param[in] pvCallSite Call site.
+ *
+ * @return Index.
+ */
+static uint32_t prvTraceHeapProfilerGetCallSite(void* pvCallSite)
+{
+	TraceHeapProfilerCallSite_t* pxCallSite;
+	uint32_t i;
+
+	for (i = 0; i < pxHeapProfiler->uiCallSiteCount; i++)
+	{
+		if (pxHeapProfiler->xCallSites[i].pvCallSite == pvCallSite)
+		{
+			return i;
+		}
+	}
+
+	if ((pvCallSite != 0) && (pxHeapProfiler->uiCallSiteCount >= (TRC_CFG_HEAP_PROFILER_MAX_CALL_SITES) - 1))
+	{
+		pvCallSite = 0;
+
+		for (i = 0; i < pxHeapProfiler->uiCallSiteCount; i++)
+		{
+			if (pxHeapProfiler->xCallSites[i].pvCallSite == 0)
+			{
+				return i;
+			}
+		}
+	}
+
+	/* This should never fail, since call site 0 always gets the last slot */
+	TRC_ASSERT_CUSTOM_ON_FAIL(pxHeapProfiler->uiCallSiteCount < (TRC_CFG_HEAP_PROFILER_MAX_CALL_SITES), return (TRC_CFG_HEAP_PROFILER_MAX_CALL_SITES) - 1; );
+
+	i = pxHeapProfiler->uiCallSiteCount;
+	pxHeapProfiler->uiCallSiteCount++;
+
+	pxCallSite = &pxHeapProfiler->xCallSites[i];
+	pxCallSite->pvCallSite = pvCallSite;
+	pxCallSite->uiAllocs = 0;
+	pxCallSite->uiFailedAllocs = 0;
+	pxCallSite->uiFrees = 0;
+	pxCallSite->uiLiveAllocs = 0;
+	pxCallSite->uxBytes = 0;
+	pxCallSite->uxLiveBytes = 0;
+	pxHeapProfiler->ucChanged[i] = 0;
+
+	return i;
+}
+
+#endif /* (TRC_CFG_ENABLE_HEAP_PROFILER == 1) */
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
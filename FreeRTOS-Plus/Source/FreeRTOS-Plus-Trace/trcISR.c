@@ -109,49 +109,51 @@ traceResult xTraceISRRegister(const char* szName, uint32_t uiPriority, TraceISRH
 traceResult xTraceISRBegin(TraceISRHandle_t xISRHandle)
 {
 	TraceEventHandle_t xEventHandle = 0;
-	TRACE_ALLOC_CRITICAL_SECTION();
+	TraceISRCoreInfo_t* pxCoreInfo;
+	int32_t iStackIndex;
 
 	(void)xEventHandle;
 
 	/* This should never fail */
 	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_ISR));
 
-	TRACE_ENTER_CRITICAL_SECTION();
+	/* No critical section is needed, see TraceISRCoreInfo_t. An ISR can't
+	 * move to another core, and any ISR that interrupts this one has restored
+	 * the stack index before we continue. */
+	pxCoreInfo = &pxTraceISRInfo->coreInfos[TRC_CFG_GET_CURRENT_CORE()];
+	iStackIndex = pxCoreInfo->stackIndex + 1;
+
+	if (iStackIndex >= (TRC_CFG_MAX_ISR_NESTING))
+	{
+		xTraceError(TRC_ERROR_ISR_NESTING_OVERFLOW);
+
+		return TRC_FAIL;
+	}
 
 	/* We are at the start of a possible ISR chain.
 	 * No context switches should have been triggered now.
 	 */
-	TraceISRCoreInfo_t* pxCoreInfo = &pxTraceISRInfo->coreInfos[TRC_CFG_GET_CURRENT_CORE()];
-	
-	if (pxCoreInfo->stackIndex == -1)
+	if (iStackIndex == 0)
 	{
 		pxCoreInfo->isPendingContextSwitch = 0;
 	}
 
-	if (pxCoreInfo->stackIndex < (TRC_CFG_MAX_ISR_NESTING) - 1)
-	{
-		pxCoreInfo->stackIndex++;
-		pxCoreInfo->handleStack[pxCoreInfo->stackIndex] = xISRHandle;
+	/* The handle is stored before the stack index is increased, and again
+	 * after, since a nested ISR in between uses the same slot */
+	pxCoreInfo->handleStack[iStackIndex] = xISRHandle;
+	TRC_ISR_COMPILER_BARRIER();
+	pxCoreInfo->stackIndex = iStackIndex;
+	TRC_ISR_COMPILER_BARRIER();
+	pxCoreInfo->handleStack[iStackIndex] = xISRHandle;
 
 #if (TRC_CFG_INCLUDE_ISR_TRACING == 1)
-		/* We need to check this */
-		if (xTraceEventBegin(PSF_EVENT_ISR_BEGIN, sizeof(void*), &xEventHandle) == TRC_SUCCESS)
-		{
-			xTraceEventAddPointer(xEventHandle, (void*)xISRHandle);
-			xTraceEventEnd(xEventHandle);
-		}
-#endif
-	}
-	else
+	/* We need to check this */
+	if (xTraceEventBegin(PSF_EVENT_ISR_BEGIN, sizeof(void*), &xEventHandle) == TRC_SUCCESS)
 	{
-		TRACE_EXIT_CRITICAL_SECTION();
-
-		xTraceError(TRC_ERROR_ISR_NESTING_OVERFLOW);
-		
-		return TRC_FAIL;
+		xTraceEventAddPointer(xEventHandle, (void*)xISRHandle);
+		xTraceEventEnd(xEventHandle);
 	}
-
-	TRACE_EXIT_CRITICAL_SECTION();
+#endif
 
 	return TRC_SUCCESS;
 }
@@ -159,38 +161,42 @@ traceResult xTraceISRBegin(TraceISRHandle_t xISRHandle)
 traceResult xTraceISREnd(TraceBaseType_t xIsTaskSwitchRequired)
 {
 	TraceEventHandle_t xEventHandle = 0;
-	TRACE_ALLOC_CRITICAL_SECTION();
+	TraceISRCoreInfo_t* pxCoreInfo;
+	int32_t iStackIndex;
 
 	(void)xEventHandle;
 
 	/* This should never fail */
 	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_ISR));
 
-	TRACE_ENTER_CRITICAL_SECTION();
-	
-	TraceISRCoreInfo_t* pxCoreInfo = &pxTraceISRInfo->coreInfos[TRC_CFG_GET_CURRENT_CORE()];
+	/* No critical section is needed, see xTraceISRBegin() */
+	pxCoreInfo = &pxTraceISRInfo->coreInfos[TRC_CFG_GET_CURRENT_CORE()];
 
-	/* Is there a pending task-switch? (perhaps from an earlier ISR) */
-	pxCoreInfo->isPendingContextSwitch |= xIsTaskSwitchRequired;
-
-	if (pxCoreInfo->stackIndex > 0)
+	/* Is there a pending task-switch? (perhaps from an earlier ISR)
+	 * Only ever set here, so a nested ISR can't lose an update. */
+	if (xIsTaskSwitchRequired)
 	{
-		pxCoreInfo->stackIndex--;
+		pxCoreInfo->isPendingContextSwitch = 1;
+	}
 
+	iStackIndex = pxCoreInfo->stackIndex - 1;
+	pxCoreInfo->stackIndex = iStackIndex;
+	TRC_ISR_COMPILER_BARRIER();
+
+	if (iStackIndex >= 0)
+	{
 #if (TRC_CFG_INCLUDE_ISR_TRACING == 1)
 		/* Store return to interrupted ISR (if nested ISRs)*/
 		/* We need to check this */
 		if (xTraceEventBegin(PSF_EVENT_ISR_RESUME, sizeof(void*), &xEventHandle) == TRC_SUCCESS)
 		{
-			xTraceEventAddPointer(xEventHandle, (void*)pxCoreInfo->handleStack[pxCoreInfo->stackIndex]);
+			xTraceEventAddPointer(xEventHandle, (void*)pxCoreInfo->handleStack[iStackIndex]);
 			xTraceEventEnd(xEventHandle);
 		}
 #endif
 	}
 	else
 	{
-		pxCoreInfo->stackIndex--;
-
 		/* Store return to interrupted task, if no context switch will occur in between. */
 		if ((pxCoreInfo->isPendingContextSwitch == 0) || (xTraceKernelPortIsSchedulerSuspended()))
 		{
@@ -208,8 +214,6 @@ traceResult xTraceISREnd(TraceBaseType_t xIsTaskSwitchRequired)
 		}
 	}
 
-	TRACE_EXIT_CRITICAL_SECTION();
-
 	return TRC_SUCCESS;
 }
 
@@ -33,7 +33,7 @@ traceResult xTraceInternalEventBufferInitialize(uint8_t* puiBuffer, uint32_t uiS
 
 	/* Send in a an address pointing after the TraceMultiCoreEventBuffer_t */
 	/* We need to check this */
-	if (xTraceMultiCoreEventBufferInitialize(pxInternalEventBuffer, TRC_EVENT_BUFFER_OPTION_SKIP,
+	if (xTraceMultiCoreEventBufferInitialize(pxInternalEventBuffer, TRC_CFG_INTERNAL_EVENT_BUFFER_OPTION,
 		&puiBuffer[sizeof(TraceMultiCoreEventBuffer_t)], uiSize - sizeof(TraceMultiCoreEventBuffer_t)) == TRC_FAIL)
 	{
 		return TRC_FAIL;
@@ -52,6 +52,22 @@ traceResult xTraceInternalEventBufferPush(void *pvData, uint32_t uiSize, int32_t
 	return xTraceMultiCoreEventBufferPush(pxInternalEventBuffer, pvData, uiSize, piBytesWritten);
 }
 
+traceResult xTraceInternalEventBufferAllocate(uint32_t uiSize, void **ppvData)
+{
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_INTERNAL_EVENT_BUFFER));
+	
+	return xTraceMultiCoreEventBufferAllocate(pxInternalEventBuffer, uiSize, ppvData);
+}
+
+traceResult xTraceInternalEventBufferCommit(void *pvData, uint32_t uiSize, int32_t *piBytesWritten)
+{
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_INTERNAL_EVENT_BUFFER));
+	
+	return xTraceMultiCoreEventBufferCommit(pxInternalEventBuffer, pvData, uiSize, piBytesWritten);
+}
+
 traceResult xTraceInternalEventBufferTransfer(int32_t *piBytesWritten)
 {
 	/* This should never fail */
@@ -68,6 +84,20 @@ traceResult xTraceInternalEventBufferClear()
 	return xTraceMultiCoreEventBufferClear(pxInternalEventBuffer);
 }
 
+traceResult xTraceInternalEventBufferGetSize(uint32_t *puiSize)
+{
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_INTERNAL_EVENT_BUFFER));
+
+	/* This should never fail */
+	TRC_ASSERT(puiSize != 0);
+
+	/* All cores get the same share of the buffer */
+	*puiSize = pxInternalEventBuffer->xEventBuffer[0]->uiSize;
+
+	return TRC_SUCCESS;
+}
+
 #endif /* (TRC_USE_INTERNAL_BUFFER == 1) */
 
 #endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
@@ -44,6 +44,9 @@ traceResult xTraceIntervalStart(TraceIntervalHandle_t xIntervalHandle)
 	/* This should never fail */
 	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntrySetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_STATE_INDEX, 1) == TRC_SUCCESS);
 
+	/* Kept also when not tracing */
+	(void)xTraceDurationStatsStart((void*)xIntervalHandle);
+
 	/* We need to check this */
 	if (xTraceEventBegin(PSF_EVENT_INTERVAL_STATECHANGE, sizeof(void*) + sizeof(uint32_t), &xEventHandle) == TRC_SUCCESS)
 	{
@@ -62,6 +65,9 @@ traceResult xTraceIntervalStop(TraceIntervalHandle_t xIntervalHandle)
 	/* This should never fail */
 	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntrySetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_STATE_INDEX, 0) == TRC_SUCCESS);
 
+	/* Kept also when not tracing */
+	(void)xTraceDurationStatsStop((void*)xIntervalHandle);
+
 	/* We need to check this */
 	if (xTraceEventBegin(PSF_EVENT_INTERVAL_STATECHANGE, sizeof(void*) + sizeof(uint32_t), &xEventHandle) == TRC_SUCCESS)
 	{
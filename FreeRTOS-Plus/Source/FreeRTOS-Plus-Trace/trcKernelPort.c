@@ -138,6 +138,20 @@ traceResult xTraceKernelPortGetUnusedStack(void* pvTask, TraceUnsignedBaseType_t
 	return TRC_SUCCESS;
 }
 
+traceResult xTraceKernelPortSuspendScheduler(void)
+{
+	vTaskSuspendAll();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceKernelPortResumeScheduler(void)
+{
+	(void)xTaskResumeAll();
+
+	return TRC_SUCCESS;
+}
+
 #endif
 
 traceResult xTraceKernelPortDelay(uint32_t uiTicks)
@@ -225,13 +239,20 @@ traceResult xTraceKernelPortEnable(void)
 
 static portTASK_FUNCTION(TzCtrl, pvParameters)
 {
+	uint32_t uiDelay = (TRC_CFG_CTRL_TASK_DELAY);
+
 	(void)pvParameters;
 
 	while (1)
 	{
 		xTraceTzCtrl();
 
-		vTaskDelay(TRC_CFG_CTRL_TASK_DELAY);
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+		/* Fixed unless TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY is enabled */
+		(void)xTraceTzCtrlGetDelay(&uiDelay);
+#endif
+
+		vTaskDelay(uiDelay);
 	}
 }
 
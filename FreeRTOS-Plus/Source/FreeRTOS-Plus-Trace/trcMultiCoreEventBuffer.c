@@ -25,7 +25,8 @@ traceResult xTraceMultiCoreEventBufferInitialize(TraceMultiCoreEventBuffer_t* px
 	/* This should never fail */
 	TRC_ASSERT(puiBuffer != 0);
 
-	uint32_t uiBufferSizePerCore = uiSize / TRC_CFG_CORE_COUNT;
+	/* Keep each core's buffer 4-byte aligned, since events may be written to it in place */
+	uint32_t uiBufferSizePerCore = ((uiSize / TRC_CFG_CORE_COUNT) / sizeof(uint32_t)) * sizeof(uint32_t);
 
 	/* This should never fail */
 	TRC_ASSERT(uiBufferSizePerCore != 0);
@@ -62,6 +63,28 @@ traceResult xTraceMultiCoreEventBufferPush(TraceMultiCoreEventBuffer_t* pxTraceM
 	return xTraceEventBufferPush(pxTraceMultiCoreEventBuffer->xEventBuffer[TRC_CFG_GET_CURRENT_CORE()], pvData, uiSize, piBytesWritten);
 }
 
+traceResult xTraceMultiCoreEventBufferAllocate(TraceMultiCoreEventBuffer_t* pxTraceMultiCoreEventBuffer,
+	uint32_t uiSize, void** ppvData)
+{
+	/* This should never fail */
+	TRC_ASSERT(pxTraceMultiCoreEventBuffer != 0);
+
+	TRC_ASSERT((TRC_CFG_GET_CURRENT_CORE()) < (TRC_CFG_CORE_COUNT));
+
+	return xTraceEventBufferAllocate(pxTraceMultiCoreEventBuffer->xEventBuffer[TRC_CFG_GET_CURRENT_CORE()], uiSize, ppvData);
+}
+
+traceResult xTraceMultiCoreEventBufferCommit(TraceMultiCoreEventBuffer_t* pxTraceMultiCoreEventBuffer,
+	void* pvData, uint32_t uiSize, int32_t* piBytesWritten)
+{
+	/* This should never fail */
+	TRC_ASSERT(pxTraceMultiCoreEventBuffer != 0);
+
+	TRC_ASSERT((TRC_CFG_GET_CURRENT_CORE()) < (TRC_CFG_CORE_COUNT));
+
+	return xTraceEventBufferCommit(pxTraceMultiCoreEventBuffer->xEventBuffer[TRC_CFG_GET_CURRENT_CORE()], pvData, uiSize, piBytesWritten);
+}
+
 #endif
 
 traceResult xTraceMultiCoreEventBufferTransfer(TraceMultiCoreEventBuffer_t* pxTraceMultiCoreEventBuffer, int32_t* piBytesWritten)
@@ -79,6 +102,9 @@ traceResult xTraceMultiCoreEventBufferTransfer(TraceMultiCoreEventBuffer_t* pxTr
 
 	for (coreId = 0; coreId < TRC_CFG_CORE_COUNT; coreId++)
 	{
+		/* An empty core buffer doesn't set it */
+		iBytesWritten = 0;
+
 		/* We need to check this */
 		if (xTraceEventBufferTransfer(pxTraceMultiCoreEventBuffer->xEventBuffer[coreId], &iBytesWritten) == TRC_FAIL)
 		{
@@ -23,6 +23,21 @@
 traceResult prvTraceObjectSendState(uint32_t uiEventCode, void* pvObject, TraceUnsignedBaseType_t uxState);
 traceResult prvTraceObjectSendNameEvent(void* pvObject, const char* szName);
 
+#if (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0)
+#define CALCULATE_NAME_CACHE_INDEX(pvObject) ((uint32_t)(((uint32_t)((TraceUnsignedBaseType_t)(pvObject) >> 2)) * 2654435761UL) % (TRC_CFG_OBJECT_NAME_CACHE_SIZE))
+
+/* The last name sent for an object address */
+typedef struct TraceObjectNameCacheEntry
+{
+	void* pvObject;
+	uint32_t uiNameHash;
+} TraceObjectNameCacheEntry_t;
+
+static TraceObjectNameCacheEntry_t axObjectNameCache[TRC_CFG_OBJECT_NAME_CACHE_SIZE];
+
+uint32_t prvTraceObjectNameHash(const char* szName, uint32_t uiLength);
+#endif /* (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0) */
+
 traceResult xTraceObjectRegisterInternal(uint32_t uiEventCode, void* pvObject, const char* szName, TraceUnsignedBaseType_t uxStateCount, TraceUnsignedBaseType_t uxStates[], TraceUnsignedBaseType_t uxOptions, TraceObjectHandle_t* pxObjectHandle)
 {
 	TraceEntryHandle_t xEntryHandle;
@@ -321,11 +336,36 @@ traceResult prvTraceObjectSendNameEvent(void* pvObject, const char* szName)
 {
 	uint32_t i = 0, uiLength = 0, uiValue = 0;
 	TraceEventHandle_t xEventHandle = 0;
+#if (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0)
+	TraceObjectNameCacheEntry_t* pxCacheEntry = &axObjectNameCache[CALCULATE_NAME_CACHE_INDEX(pvObject)];
+	uint32_t uiNameHash;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+#endif /* (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0) */
 
 	for (i = 0; (szName[i] != 0) && (i < (TRC_ENTRY_TABLE_SLOT_SYMBOL_SIZE)); i++) {}
 
 	uiLength = i;
 
+#if (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0)
+	uiNameHash = prvTraceObjectNameHash(szName, uiLength);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	/* The host already has this name for this address */
+	if (pxCacheEntry->pvObject == pvObject && pxCacheEntry->uiNameHash == uiNameHash)
+	{
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		return TRC_SUCCESS;
+	}
+
+	/* Only remembered if the event is written */
+	pxCacheEntry->pvObject = 0;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+#endif /* (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0) */
+
 	if (xTraceEventBegin(PSF_EVENT_OBJ_NAME, sizeof(void*) + uiLength, &xEventHandle) == TRC_SUCCESS)
 	{
 		xTraceEventAddPointer(xEventHandle, pvObject);
@@ -339,11 +379,59 @@ traceResult prvTraceObjectSendNameEvent(void* pvObject, const char* szName)
 		}
 
 		xTraceEventEnd(xEventHandle);
+
+#if (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0)
+		xTraceObjectNameCacheAdd(pvObject, szName);
+#endif /* (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0) */
 	}
 
 	return TRC_SUCCESS;
 }
 
+#if (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0)
+void xTraceObjectNameCacheClear(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < (TRC_CFG_OBJECT_NAME_CACHE_SIZE); i++)
+	{
+		axObjectNameCache[i].pvObject = 0;
+	}
+}
+
+void xTraceObjectNameCacheAdd(void* pvObject, const char* szName)
+{
+	TraceObjectNameCacheEntry_t* pxCacheEntry = &axObjectNameCache[CALCULATE_NAME_CACHE_INDEX(pvObject)];
+	uint32_t i, uiNameHash;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	for (i = 0; (szName[i] != 0) && (i < (TRC_ENTRY_TABLE_SLOT_SYMBOL_SIZE)); i++) {}
+
+	uiNameHash = prvTraceObjectNameHash(szName, i);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	pxCacheEntry->pvObject = pvObject;
+	pxCacheEntry->uiNameHash = uiNameHash;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+}
+
+/* FNV-1a of the name as it is sent */
+uint32_t prvTraceObjectNameHash(const char* szName, uint32_t uiLength)
+{
+	uint32_t i, uiHash = 2166136261UL;
+
+	for (i = 0; i < uiLength; i++)
+	{
+		uiHash = (uiHash ^ (uint8_t)szName[i]) * 16777619UL;
+	}
+
+	return uiHash;
+}
+#endif /* (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0) */
+
 #endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
 
 #endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
@@ -18,7 +18,7 @@
 
 #include <stdarg.h>
 
-static traceResult prvTraceVPrintF(TraceStringHandle_t xChannel, const char* szFormat, uint32_t uiLength, uint32_t uiArgs, va_list *pxVL);
+static traceResult prvTraceVPrintF(TraceStringHandle_t xChannel, const char* szFormat, uint32_t uiLength, uint32_t uiArgs, va_list *pxVL, const TraceUnsignedBaseType_t* puxArgs);
 
 typedef struct TracePrintInfo
 {
@@ -92,7 +92,7 @@ traceResult xTracePrint(TraceStringHandle_t xChannel, const char* szString)
 
 	uiLength = i + 1; /* Null termination */
 
-	return prvTraceVPrintF(xChannel, szString, uiLength, 0, (va_list*)0);
+	return prvTraceVPrintF(xChannel, szString, uiLength, 0, (va_list*)0, (const TraceUnsignedBaseType_t*)0);
 }
 
 /*******************************************************************************
@@ -246,10 +246,35 @@ traceResult xTraceVPrintF(TraceStringHandle_t xChannel, const char* szFormat, va
 
 	uiLength = i + 1; /* Null termination */
 
-	return prvTraceVPrintF(xChannel, szFormat, uiLength, uiArgs, &xVL);
+	return prvTraceVPrintF(xChannel, szFormat, uiLength, uiArgs, &xVL, (const TraceUnsignedBaseType_t*)0);
 }
 
-static traceResult prvTraceVPrintF(TraceStringHandle_t xChannel, const char* szFormat, uint32_t uiLength, uint32_t uiArgs, va_list *pxVL)
+/******************************************************************************
+ * xTracePrintFArgs
+ *
+ * xTracePrintF variant where the caller provides the format string length and
+ * the arguments, so the format string isn't parsed on the target. Normally
+ * used through xTracePrintFLiteral, which works these out at compile time.
+ *
+ ******************************************************************************/
+traceResult xTracePrintFArgs(TraceStringHandle_t xChannel, const char* szFormat, uint32_t uiLength, uint32_t uiArgs, const TraceUnsignedBaseType_t* puxArgs)
+{
+	/* We need to check this */
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_PRINT))
+	{
+		return TRC_FAIL;
+	}
+
+	/* This should never fail */
+	TRC_ASSERT(szFormat != 0);
+
+	/* This should never fail */
+	TRC_ASSERT((uiArgs == 0) || (puxArgs != 0));
+
+	return prvTraceVPrintF(xChannel, szFormat, uiLength, uiArgs, (va_list*)0, puxArgs);
+}
+
+static traceResult prvTraceVPrintF(TraceStringHandle_t xChannel, const char* szFormat, uint32_t uiLength, uint32_t uiArgs, va_list *pxVL, const TraceUnsignedBaseType_t* puxArgs)
 {
 	TraceEventHandle_t xEventHandle = 0;
 	uint32_t i, uiRemaining;
@@ -283,7 +308,14 @@ static traceResult prvTraceVPrintF(TraceStringHandle_t xChannel, const char* szF
 	/* Add all arguments */
 	for (i = 0; i < uiArgs; i++)
 	{
-		xTraceEventAddUnsignedBaseType(xEventHandle, va_arg(*pxVL, TraceUnsignedBaseType_t));
+		if (pxVL != 0)
+		{
+			xTraceEventAddUnsignedBaseType(xEventHandle, va_arg(*pxVL, TraceUnsignedBaseType_t));
+		}
+		else
+		{
+			xTraceEventAddUnsignedBaseType(xEventHandle, puxArgs[i]);
+		}
 	}
 
 	xTraceEventPayloadRemaining(xEventHandle, &uiRemaining);
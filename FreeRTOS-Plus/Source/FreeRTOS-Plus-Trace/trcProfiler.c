@@ -0,0 +1,81 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* The implementation of the sampling profiler.
+*/
+
+#include <trcRecorder.h>
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#if (TRC_CFG_ENABLE_PROFILER == 1)
+
+typedef struct TraceProfiler
+{
+	TraceExtensionHandle_t xExtensionHandle;
+	uint32_t uiSampleEventId;
+} TraceProfiler_t;
+
+static TraceProfiler_t* pxProfiler;
+
+traceResult xTraceProfilerInitialize(TraceProfilerBuffer_t* pxBuffer)
+{
+	TRC_ASSERT_EQUAL_SIZE(TraceProfilerBuffer_t, TraceProfiler_t);
+
+	/* This should never fail */
+	TRC_ASSERT(pxBuffer != 0);
+
+	pxProfiler = (TraceProfiler_t*)pxBuffer;
+
+	/* The extension is stored in the entry table, so the host can tell the
+	 * samples apart from other events */
+	/* We need to check this */
+	if (xTraceExtensionCreate(TRC_PROFILER_EXTENSION_NAME, 1, 0, 0, 1, &pxProfiler->xExtensionHandle) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+
+	/* Looked up once, since it is needed for every sample */
+	/* This should never fail */
+	TRC_ASSERT_ALWAYS_EVALUATE(xTraceExtensionGetEventId(pxProfiler->xExtensionHandle, TRC_PROFILER_EVENT_SAMPLE, &pxProfiler->uiSampleEventId) == TRC_SUCCESS);
+
+	xTraceSetComponentInitialized(TRC_RECORDER_COMPONENT_PROFILER);
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceProfilerSample(void* pvPC)
+{
+	void* pvTask = 0;
+	TraceEventHandle_t xEventHandle = 0;
+
+	/* We need to check this */
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_PROFILER))
+	{
+		return TRC_FAIL;
+	}
+
+	/* The task that was running when the timer interrupted it */
+	(void)xTraceTaskGetCurrent(&pvTask);
+
+	if (xTraceEventBegin(pxProfiler->uiSampleEventId, sizeof(void*) + sizeof(void*), &xEventHandle) == TRC_SUCCESS)
+	{
+		xTraceEventAddPointer(xEventHandle, pvTask);
+		xTraceEventAddPointer(xEventHandle, pvPC);
+		xTraceEventEnd(xEventHandle);
+	}
+
+	return TRC_SUCCESS;
+}
+
+#endif /* (TRC_CFG_ENABLE_PROFILER == 1) */
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
@@ -21,6 +21,10 @@
 #define TRC_CFG_RECORDER_DATA_INIT 1
 #endif
 
+#ifndef TRC_CFG_SYMBOL_CACHE_SIZE
+#define TRC_CFG_SYMBOL_CACHE_SIZE 0
+#endif
+
 #if ((TRC_HWTC_TYPE == TRC_CUSTOM_TIMER_INCR) || (TRC_HWTC_TYPE == TRC_CUSTOM_TIMER_DECR))
 	#error "CUSTOM timestamping mode is not (yet) supported in snapshot mode!"
 #endif
@@ -88,6 +92,37 @@ uint32_t trace_disable_timestamp = 0;
 ******************************************************************************/
 static uint32_t last_timestamp = 0;
 
+#if (TRC_CFG_SNAPSHOT_COMPACT == 1)
+/*******************************************************************************
+* compactPendingXTSCode, compactPendingXTS
+*
+* An XTS event waiting to be folded into the event that follows it, in the
+* compact layout. The code is zero if none is pending. The value holds the
+* upper DTS bits, shifted into place.
+******************************************************************************/
+static uint8_t compactPendingXTSCode = 0;
+static uint32_t compactPendingXTS = 0;
+#endif
+
+#if (TRC_CFG_SYMBOL_CACHE_SIZE > 0)
+/*******************************************************************************
+* symbolCache
+*
+* Maps string addresses to the symbol table entries last opened for them, so
+* repeated labels and format strings skip the checksum and the chain walk.
+* Indexed by TRC_SYMBOL_CACHE_SLOT(name, channel).
+******************************************************************************/
+typedef struct
+{
+	const char* name;
+	uint16_t symbol;
+} TraceSymbolCacheEntry_t;
+
+static TraceSymbolCacheEntry_t symbolCache[TRC_CFG_SYMBOL_CACHE_SIZE];
+
+#define TRC_SYMBOL_CACHE_SLOT(name, channel) ((uint32_t)((((uint32_t)((TraceUnsignedBaseType_t)(name) >> 2)) ^ (uint32_t)(channel)) * 2654435761UL) % (TRC_CFG_SYMBOL_CACHE_SIZE))
+#endif /* (TRC_CFG_SYMBOL_CACHE_SIZE > 0) */
+
 /*******************************************************************************
 * uiTraceSystemState
 *
@@ -223,6 +258,13 @@ void vTraceStoreMemMangEvent(uint32_t ecode, uint32_t address, int32_t signed_si
 static void prvCheckDataToBeOverwrittenForMultiEntryEvents(uint8_t nEntries);
 #endif
 
+#if (TRC_CFG_SNAPSHOT_COMPACT == 1)
+static void prvTraceCompactCommit(void);
+static uint8_t prvTraceCompactLayout(uint8_t code);
+static void prvTraceCompactWrite(const uint8_t* record, uint32_t length);
+static uint32_t prvTraceCompactRecordLength(uint32_t index);
+#endif
+
 static TraceStringHandle_t prvTraceCreateSymbolTableEntry(const char* name,
 										uint8_t crc6,
 										uint8_t len,
@@ -233,6 +275,11 @@ static TraceStringHandle_t prvTraceLookupSymbolTableEntry(const char* name,
 										uint8_t len,
 										TraceStringHandle_t channel);
 
+#if (TRC_CFG_SYMBOL_CACHE_SIZE > 0)
+static TraceStringHandle_t prvTraceLookupSymbolCache(const char* name,
+										TraceStringHandle_t channel);
+#endif
+
 
 #if (TRC_CFG_INCLUDE_ISR_TRACING == 0)
 /* ISR tracing is turned off */
@@ -367,6 +414,14 @@ traceResult xTraceDisable(void)
 	return TRC_SUCCESS;
 }
 
+/* The ring buffer has no room to keep events after the trigger, so stop now */
+traceResult xTraceTrigger(void)
+{
+	prvTraceStop();
+
+	return TRC_SUCCESS;
+}
+
 void vTraceSetStopHook(TRACE_STOP_HOOK stopHookFunction)
 {
 	vTraceStopHookPtr = stopHookFunction;
@@ -384,6 +439,11 @@ void vTraceClear(void)
 	traceErrorMessage = 0;
 	RecorderDataPtr->internalErrorOccured = 0;
 	(void)memset(RecorderDataPtr->eventData, 0, RecorderDataPtr->maxEvents * 4);
+#if (TRC_CFG_SNAPSHOT_COMPACT == 1)
+	RecorderDataPtr->compactHead = 0;
+	RecorderDataPtr->compactUsed = 0;
+	compactPendingXTSCode = 0;
+#endif
 	handle_of_last_logged_task = 0;
 	trcCRITICAL_SECTION_END();
 }
@@ -1492,7 +1552,14 @@ traceResult xTraceVPrintF(TraceStringHandle_t eventLabel, const char* formatStr,
 		 /* prvTraceGetDTS might stop the recorder in some cases... */
 		if (RecorderDataPtr->recorderActive)
 		{
-
+#if (TRC_CFG_SNAPSHOT_COMPACT == 1)
+			/* Stage the whole event, then pack it as one record */
+			(void)memcpy(RecorderDataPtr->eventData, tempDataBuffer, noOfSlots * 4);
+			RecorderDataPtr->eventData[0] = (uint8_t)(USER_EVENT + noOfSlots - 1);
+			RecorderDataPtr->nextFreeIndex = noOfSlots;
+			RecorderDataPtr->numEvents += noOfSlots;
+			prvTraceCompactCommit();
+#else
 			/* If the data does not fit in the remaining main buffer, wrap around to
 			0 if allowed, otherwise stop the recorder and quit). */
 			if (RecorderDataPtr->nextFreeIndex + noOfSlots > RecorderDataPtr->maxEvents)
@@ -1555,7 +1622,7 @@ traceResult xTraceVPrintF(TraceStringHandle_t eventLabel, const char* formatStr,
 			/* Make sure the next entry is cleared correctly */
 			prvCheckDataToBeOverwrittenForMultiEntryEvents(1);
 			#endif
-
+#endif /* (TRC_CFG_SNAPSHOT_COMPACT == 1) */
 		}
 	}
 	trcCRITICAL_SECTION_END();
@@ -1722,7 +1789,11 @@ traceResult xTraceInitialize()
 	RecorderDataPtr->minor_version = TRACE_MINOR_VERSION;
 	RecorderDataPtr->irq_priority_order = TRC_IRQ_PRIORITY_ORDER;
 	RecorderDataPtr->filesize = sizeof(RecorderDataType);
+#if (TRC_CFG_SNAPSHOT_COMPACT == 1)
+	RecorderDataPtr->maxEvents = (TRC_SNAPSHOT_STAGING_SLOTS);
+#else
 	RecorderDataPtr->maxEvents = (TRC_CFG_EVENT_BUFFER_SIZE);
+#endif
 	RecorderDataPtr->debugMarker0 = (int32_t)0xF0F0F0F0;
 	RecorderDataPtr->isUsing16bitHandles = TRC_CFG_USE_16BIT_OBJECT_HANDLES;
 	RecorderDataPtr->isrTailchainingThreshold = TRC_CFG_ISR_TAILCHAINING_THRESHOLD;
@@ -1733,12 +1804,20 @@ traceResult xTraceInitialize()
 	RecorderDataPtr->debugMarker1 = (int32_t)0xF1F1F1F1;
 	RecorderDataPtr->SymbolTable.symTableSize = (TRC_CFG_SYMBOL_TABLE_SIZE);
 	RecorderDataPtr->SymbolTable.nextFreeSymbolIndex = 1;
+#if (TRC_CFG_SYMBOL_CACHE_SIZE > 0)
+	(void)memset(symbolCache, 0, sizeof(symbolCache));
+#endif
 #if (TRC_CFG_INCLUDE_FLOAT_SUPPORT == 1)
 	RecorderDataPtr->exampleFloatEncoding = 1.0f; /* otherwise already zero */
 #endif
 	RecorderDataPtr->debugMarker2 = (int32_t)0xF2F2F2F2;
 	prvStrncpy(RecorderDataPtr->systemInfo, "Trace Recorder Demo", 80);
 	RecorderDataPtr->debugMarker3 = (int32_t)0xF3F3F3F3;
+#if (TRC_CFG_SNAPSHOT_COMPACT == 1)
+	RecorderDataPtr->debugMarker4 = (int32_t)0xF4F4F4F4;
+	RecorderDataPtr->compactSize = (TRC_CFG_EVENT_BUFFER_SIZE) * 4;
+	compactPendingXTSCode = 0;
+#endif
 	RecorderDataPtr->endmarker0 = 0x0A;
 	RecorderDataPtr->endmarker1 = 0x0B;
 	RecorderDataPtr->endmarker2 = 0x0C;
@@ -2600,6 +2679,14 @@ TraceStringHandle_t prvTraceOpenSymbol(const char* name, TraceStringHandle_t use
 	
 	TRACE_ASSERT(name != 0, "prvTraceOpenSymbol: name == NULL", (TraceStringHandle_t)0);
 
+#if (TRC_CFG_SYMBOL_CACHE_SIZE > 0)
+	result = prvTraceLookupSymbolCache(name, userEventChannel);
+	if (result)
+	{
+		return result;
+	}
+#endif
+
 	prvTraceGetChecksum(name, &crc, &len);
 
 	trcCRITICAL_SECTION_BEGIN();
@@ -2608,6 +2695,13 @@ TraceStringHandle_t prvTraceOpenSymbol(const char* name, TraceStringHandle_t use
 	{
 		result = prvTraceCreateSymbolTableEntry(name, crc, len, userEventChannel);
 	}
+#if (TRC_CFG_SYMBOL_CACHE_SIZE > 0)
+	if (result)
+	{
+		symbolCache[TRC_SYMBOL_CACHE_SLOT(name, userEventChannel)].name = name;
+		symbolCache[TRC_SYMBOL_CACHE_SLOT(name, userEventChannel)].symbol = result;
+	}
+#endif
 	trcCRITICAL_SECTION_END();
 
 	return result;
@@ -2750,6 +2844,9 @@ void prvTraceUpdateCounters(void)
 
 	RecorderDataPtr->nextFreeIndex++;
 
+#if (TRC_CFG_SNAPSHOT_COMPACT == 1)
+	prvTraceCompactCommit();
+#else
 	if (RecorderDataPtr->nextFreeIndex >= (TRC_CFG_EVENT_BUFFER_SIZE))
 	{
 #if (TRC_CFG_SNAPSHOT_MODE == TRC_SNAPSHOT_MODE_RING_BUFFER)
@@ -2763,8 +2860,245 @@ void prvTraceUpdateCounters(void)
 #if (TRC_CFG_SNAPSHOT_MODE == TRC_SNAPSHOT_MODE_RING_BUFFER)
 	prvCheckDataToBeOverwrittenForMultiEntryEvents(1);
 #endif
+#endif /* (TRC_CFG_SNAPSHOT_COMPACT == 1) */
 }
 
+#if (TRC_CFG_SNAPSHOT_COMPACT == 1)
+
+/* Record layouts of the compact event buffer, see prvTraceCompactLayout */
+#define TRC_COMPACT_RAW 0		/* code, 3 bytes as in the 4-byte record */
+#define TRC_COMPACT_DTS16 1		/* code, byte 1, DTS (bytes 2-3) */
+#define TRC_COMPACT_DTS8_3 2	/* code, bytes 1-2, DTS (byte 3) */
+#define TRC_COMPACT_DTS8_1 3	/* code, bytes 2-3, DTS (byte 1) */
+
+/*******************************************************************************
+ * prvTraceCompactCommit
+ *
+ * Packs the event staged in eventData, which may span several 4-byte records,
+ * into one variable length record in compactData.
+ *
+ * The record starts with the event code, followed by the other bytes of the
+ * first 4-byte record except the DTS, then the DTS as a 7-bit varint (least
+ * significant group first, bit 7 set on all but the last byte), then any
+ * further 4-byte records as they are. Events without a DTS are stored as
+ * their 4 bytes. An XTS event is not stored, but its bits are added to the
+ * DTS of the event that follows it. To convert back, an XTS event is
+ * created again wherever the DTS does not fit its field, exactly as
+ * prvTraceGetDTS did when the event was recorded.
+ *
+ * This is assumed to execute within a critical section...
+ ******************************************************************************/
+static void prvTraceCompactCommit(void)
+{
+	uint8_t record[(TRC_SNAPSHOT_STAGING_SLOTS) * 4 + 5];
+	const uint8_t* slot = RecorderDataPtr->eventData;
+	uint32_t length = 0;
+	uint32_t dts = 0;
+	uint32_t extra;
+	uint8_t layout;
+
+	if (RecorderDataPtr->nextFreeIndex == 0)
+	{
+		return;
+	}
+
+	extra = (RecorderDataPtr->nextFreeIndex - 1) * 4;
+	RecorderDataPtr->nextFreeIndex = 0;
+
+	if ((slot[0] == XTS8 || slot[0] == XTS16) && compactPendingXTSCode == 0)
+	{
+		compactPendingXTSCode = slot[0];
+		if (slot[0] == XTS16)
+		{
+			compactPendingXTS = (uint32_t)((const XTSEvent*)slot)->xts_16 << 16;
+		}
+		else
+		{
+			compactPendingXTS = ((uint32_t)((const XTSEvent*)slot)->xts_8 << 24) |
+				((uint32_t)((const XTSEvent*)slot)->xts_16 << 8);
+		}
+		return;
+	}
+
+	layout = prvTraceCompactLayout(slot[0]);
+
+	/* An XTS which can't be folded into this event is stored as it was */
+	if (compactPendingXTSCode != 0 &&
+		((compactPendingXTSCode == XTS16) != (layout == TRC_COMPACT_DTS16) || layout == TRC_COMPACT_RAW))
+	{
+		XTSEvent xts;
+
+		xts.type = compactPendingXTSCode;
+		xts.xts_8 = (compactPendingXTSCode == XTS16) ? 0 : (uint8_t)(compactPendingXTS >> 24);
+		xts.xts_16 = (compactPendingXTSCode == XTS16) ? (uint16_t)(compactPendingXTS >> 16) : (uint16_t)(compactPendingXTS >> 8);
+		compactPendingXTSCode = 0;
+
+		prvTraceCompactWrite((const uint8_t*)&xts, 4);
+	}
+
+	record[length++] = slot[0];
+
+	switch (layout)
+	{
+	case TRC_COMPACT_DTS16:
+		record[length++] = slot[1];
+		dts = ((const TSEvent*)slot)->dts;
+		break;
+	case TRC_COMPACT_DTS8_3:
+		record[length++] = slot[1];
+		record[length++] = slot[2];
+		dts = slot[3];
+		break;
+	case TRC_COMPACT_DTS8_1:
+		record[length++] = slot[2];
+		record[length++] = slot[3];
+		dts = slot[1];
+		break;
+	default:
+		record[length++] = slot[1];
+		record[length++] = slot[2];
+		record[length++] = slot[3];
+		break;
+	}
+
+	if (layout != TRC_COMPACT_RAW)
+	{
+		if (compactPendingXTSCode != 0)
+		{
+			dts |= compactPendingXTS;
+			compactPendingXTSCode = 0;
+		}
+
+		while (dts >= 0x80)
+		{
+			record[length++] = (uint8_t)(dts | 0x80);
+			dts >>= 7;
+		}
+		record[length++] = (uint8_t)dts;
+	}
+
+	(void)memcpy(&record[length], &slot[4], extra);
+	length += extra;
+
+	prvTraceCompactWrite(record, length);
+}
+
+/*******************************************************************************
+ * prvTraceCompactLayout
+ *
+ * Returns where the DTS is in the 4-byte record of an event code, as one of
+ * the TRC_COMPACT_ layouts. This must match prvSnapshotDTS in the host tool
+ * (extras/TraceAnalyzer), which converts the records back.
+ ******************************************************************************/
+static uint8_t prvTraceCompactLayout(uint8_t code)
+{
+	/* Events without a DTS, including the object close events */
+	if (code <= DIV_XPS || code == XTS8 || code == XTS16 || code == EVENT_BEING_WRITTEN ||
+		code == RESERVED_DUMMY_CODE || code == XID || code == XTS16L ||
+		code == MEM_MALLOC_ADDR || code == MEM_FREE_ADDR || code == MEM_MALLOC_ADDR_TRCFAILED ||
+		(code >= EVENTGROUP_OBJCLOSE_NAME_TRCSUCCESS && code < EVENTGROUP_CREATE_OBJ_TRCSUCCESS) ||
+		(code >= TRACE_STREAMBUFFER_OBJCLOSE_NAME_TRCSUCCESS && code <= TRACE_MESSAGEBUFFER_OBJCLOSE_PROP_TRCSUCCESS))
+	{
+		return TRC_COMPACT_RAW;
+	}
+
+	/* prvTraceStoreKernelCallWithNumericParamOnly(), user events and memory events */
+	if (code == DIV_NEW_TIME || code == (EVENTGROUP_CREATE_OBJ_TRCFAILED + TRACE_CLASS_MUTEX) ||
+		code == TASK_DELAY_UNTIL || code == TASK_DELAY || code == MEM_MALLOC_SIZE ||
+		code == MEM_FREE_SIZE || code == MEM_MALLOC_SIZE_TRCFAILED ||
+		(code >= USER_EVENT && code <= USER_EVENT_LAST))
+	{
+		return TRC_COMPACT_DTS8_1;
+	}
+
+	/* prvTraceStoreKernelCallWithParam() and the task instance events */
+	if ((code >= TASK_PRIORITY_SET && code <= TASK_PRIORITY_DISINHERIT) ||
+		(code > TIMER_CREATE && code <= TIMER_STOP_FROM_ISR_TRCFAILED && code != TIMER_CREATE_TRCFAILED) ||
+		(code > EVENT_GROUP_CREATE_TRCFAILED && code <= TASK_INSTANCE_FINISHED_DIRECT && code != EVENT_GROUP_DELETE_OBJ) ||
+		(code >= TRACE_TASK_NOTIFY_TAKE && code <= TRACE_TASK_NOTIFY_WAIT_TRCFAILED))
+	{
+		return TRC_COMPACT_DTS8_3;
+	}
+
+	/* prvTraceStoreKernelCall(), task switches, ready and low power events */
+	return TRC_COMPACT_DTS16;
+}
+
+/*******************************************************************************
+ * prvTraceCompactWrite
+ *
+ * Appends a record to compactData. In ring buffer mode, the oldest records
+ * are dropped to make room for it, and an XPS record is always dropped
+ * together with the event it belongs to. Otherwise, the recorder is stopped
+ * once the record does not fit.
+ ******************************************************************************/
+static void prvTraceCompactWrite(const uint8_t* record, uint32_t length)
+{
+	uint32_t size = RecorderDataPtr->compactSize;
+	uint32_t i;
+
+	while (size - RecorderDataPtr->compactUsed < length)
+	{
+#if (TRC_CFG_SNAPSHOT_MODE == TRC_SNAPSHOT_MODE_RING_BUFFER)
+		uint32_t tail = (RecorderDataPtr->compactHead + size - RecorderDataPtr->compactUsed) % size;
+		uint32_t dropped = prvTraceCompactRecordLength(tail);
+
+		if (RecorderDataPtr->compactData[tail] == DIV_XPS && dropped < RecorderDataPtr->compactUsed)
+		{
+			dropped += prvTraceCompactRecordLength((tail + dropped) % size);
+		}
+
+		RecorderDataPtr->compactUsed -= dropped;
+		RecorderDataPtr->bufferIsFull = 1;
+#else
+		vTraceStop();
+		return;
+#endif
+	}
+
+	for (i = 0; i < length; i++)
+	{
+		RecorderDataPtr->compactData[RecorderDataPtr->compactHead] = record[i];
+		RecorderDataPtr->compactHead = (RecorderDataPtr->compactHead + 1) % size;
+	}
+
+	RecorderDataPtr->compactUsed += length;
+}
+
+/*******************************************************************************
+ * prvTraceCompactRecordLength
+ *
+ * Returns the length of the record at the given index in compactData.
+ ******************************************************************************/
+static uint32_t prvTraceCompactRecordLength(uint32_t index)
+{
+	uint32_t size = RecorderDataPtr->compactSize;
+	uint8_t code = RecorderDataPtr->compactData[index];
+	uint8_t layout = prvTraceCompactLayout(code);
+	uint32_t length;
+
+	if (layout == TRC_COMPACT_RAW)
+	{
+		return 4;
+	}
+
+	length = (layout == TRC_COMPACT_DTS16) ? 2 : 3;
+
+	while (RecorderDataPtr->compactData[(index + length) % size] & 0x80)
+	{
+		length++;
+	}
+	length++;
+
+	if (code >= USER_EVENT && code <= USER_EVENT_LAST)
+	{
+		length += (uint32_t)(code - USER_EVENT) * 4;
+	}
+
+	return length;
+}
+#endif /* (TRC_CFG_SNAPSHOT_COMPACT == 1) */
+
 /******************************************************************************
  * prvTraceGetDTS
  *
@@ -2923,6 +3257,56 @@ TraceStringHandle_t prvTraceLookupSymbolTableEntry(const char* name,
 	return i;
 }
 
+#if (TRC_CFG_SYMBOL_CACHE_SIZE > 0)
+/*******************************************************************************
+ * prvTraceLookupSymbolCache
+ *
+ * Find the symbol table entry last opened for this string address and channel,
+ * return 0 if not present.
+ *
+ * This is called without the critical section, so the cache slot may be
+ * updated while it is read. The symbol table entry it points at is therefore
+ * checked against the channel and the current contents of the string rather
+ * than trusted. Entries are never changed once created, so a match is valid.
+ ******************************************************************************/
+TraceStringHandle_t prvTraceLookupSymbolCache(const char* name,
+										TraceStringHandle_t chn)
+{
+	TraceSymbolCacheEntry_t* entry = &symbolCache[TRC_SYMBOL_CACHE_SLOT(name, chn)];
+	uint16_t i;
+	uint16_t j;
+
+	if (entry->name != name)
+	{
+		return 0;
+	}
+
+	i = entry->symbol;
+
+	if ((i == 0) || (i >= RecorderDataPtr->SymbolTable.nextFreeSymbolIndex))
+	{
+		return 0;
+	}
+
+	if ((RecorderDataPtr->SymbolTable.symbytes[i + 2] != (chn & 0x00FF)) ||
+		(RecorderDataPtr->SymbolTable.symbytes[i + 3] != (chn / 0x100)))
+	{
+		return 0;
+	}
+
+	/* Every entry is zero-terminated, so this stops within the table */
+	for (j = 0; RecorderDataPtr->SymbolTable.symbytes[i + 4 + j] == (uint8_t)name[j]; j++)
+	{
+		if (name[j] == '\0')
+		{
+			return i; /* found */
+		}
+	}
+
+	return 0;
+}
+#endif /* (TRC_CFG_SYMBOL_CACHE_SIZE > 0) */
+
 /*******************************************************************************
  * prvTraceCreateSymbolTableEntry
  *
@@ -56,8 +56,6 @@ traceResult xTraceStackMonitorInitialize(TraceStackMonitorBuffer_t *pxBuffer)
 
 traceResult xTraceStackMonitorAdd(void *pvTask)
 {
-	TraceUnsignedBaseType_t uxLowMark;
-	
 	TRACE_ALLOC_CRITICAL_SECTION();
 	
 	/* This should never fail */
@@ -80,13 +78,12 @@ traceResult xTraceStackMonitorAdd(void *pvTask)
 		return TRC_FAIL;
 	}
 
-	if (xTraceKernelPortGetUnusedStack(pvTask, &uxLowMark) == TRC_SUCCESS)
-	{
-		pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].pvTask = pvTask;
-		pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].uxPreviousLowWaterMark = uxLowMark;
+	/* The stack isn't scanned here, this is called while the task is created.
+	 * The first report gets the real low water mark. */
+	pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].pvTask = pvTask;
+	pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].uxPreviousLowWaterMark = (TraceUnsignedBaseType_t)~0;
 
-		pxStackMonitor->uiEntryCount++;
-	}
+	pxStackMonitor->uiEntryCount++;
 	
 	TRACE_EXIT_CRITICAL_SECTION();
 
@@ -167,8 +164,10 @@ traceResult xTraceStackMonitorGetAtIndex(uint32_t uiIndex, void **ppvTask, Trace
 traceResult xTraceStackMonitorReport(void)
 {
 	TraceUnsignedBaseType_t uxLowWaterMark;
+	TraceUnsignedBaseType_t uxPreviousLowWaterMark;
 	TraceEventHandle_t xEventHandle = 0;
-	TraceStackMonitorEntry_t *pxStackMonitorEntry;
+	void* pvTask;
+	uint32_t uiIndex;
 	uint32_t uiToReport;
 	uint32_t i;
 	static uint32_t uiCurrentIndex = 0;
@@ -177,38 +176,73 @@ traceResult xTraceStackMonitorReport(void)
 
 	/* This should never fail */
 	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_STACK_MONITOR));
-	
-	TRACE_ENTER_CRITICAL_SECTION();
 
 	/* Never report more than there are entries */
 	uiToReport = TRC_CFG_STACK_MONITOR_MAX_REPORTS <= pxStackMonitor->uiEntryCount ? TRC_CFG_STACK_MONITOR_MAX_REPORTS : pxStackMonitor->uiEntryCount;
 
 	for (i = 0; i < uiToReport; i++)
 	{
+		/* Scanning a stack takes long, so it is done outside the critical
+		 * section. Instead the scheduler is suspended, so no task can be
+		 * deleted and have its stack freed during the scan. */
+		xTraceKernelPortSuspendScheduler();
+
+		TRACE_ENTER_CRITICAL_SECTION();
+
+		if (pxStackMonitor->uiEntryCount == 0)
+		{
+			/* Tasks were removed since uiToReport was calculated */
+			TRACE_EXIT_CRITICAL_SECTION();
+
+			xTraceKernelPortResumeScheduler();
+
+			break;
+		}
+
 		/* If uiCurrentIndex is too large, reset it */
 		uiCurrentIndex = uiCurrentIndex < pxStackMonitor->uiEntryCount ? uiCurrentIndex : 0;
-		
-		pxStackMonitorEntry = &pxStackMonitor->xEntries[uiCurrentIndex];
 
-		xTraceKernelPortGetUnusedStack(pxStackMonitorEntry->pvTask, &uxLowWaterMark);
+		uiIndex = uiCurrentIndex;
+		pvTask = pxStackMonitor->xEntries[uiIndex].pvTask;
+
+		uiCurrentIndex++;
 
-		if (uxLowWaterMark < pxStackMonitorEntry->uxPreviousLowWaterMark)
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		xTraceKernelPortGetUnusedStack(pvTask, &uxLowWaterMark);
+
+		TRACE_ENTER_CRITICAL_SECTION();
+
+		/* The entries may have been moved by a xTraceStackMonitorRemove(...)
+		 * from another core, so the task is looked up again */
+		if (uiIndex >= pxStackMonitor->uiEntryCount || pxStackMonitor->xEntries[uiIndex].pvTask != pvTask)
+		{
+			TRACE_EXIT_CRITICAL_SECTION();
+
+			xTraceKernelPortResumeScheduler();
+
+			continue;
+		}
+
+		if (uxLowWaterMark < pxStackMonitor->xEntries[uiIndex].uxPreviousLowWaterMark)
 		{
-			pxStackMonitorEntry->uxPreviousLowWaterMark = uxLowWaterMark;
+			pxStackMonitor->xEntries[uiIndex].uxPreviousLowWaterMark = uxLowWaterMark;
 		}
 
+		uxPreviousLowWaterMark = pxStackMonitor->xEntries[uiIndex].uxPreviousLowWaterMark;
+
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		xTraceKernelPortResumeScheduler();
+
 		if (xTraceEventBegin(PSF_EVENT_UNUSED_STACK, sizeof(void*) + sizeof(uint32_t), &xEventHandle) == TRC_SUCCESS)
 		{
-			xTraceEventAddPointer(xEventHandle, pxStackMonitorEntry->pvTask);
-			xTraceEventAdd32(xEventHandle, (uint32_t)pxStackMonitorEntry->uxPreviousLowWaterMark);
+			xTraceEventAddPointer(xEventHandle, pvTask);
+			xTraceEventAdd32(xEventHandle, (uint32_t)uxPreviousLowWaterMark);
 			xTraceEventEnd(xEventHandle);
 		}
-
-		uiCurrentIndex++;
 	}
 
-	TRACE_EXIT_CRITICAL_SECTION();
-
 	return TRC_SUCCESS;
 }
 #endif /* (((TRC_CFG_ENABLE_STACK_MONITOR) == 1) && ((TRC_CFG_SCHEDULING_ONLY) == 0)) */
@@ -66,6 +66,7 @@ traceResult xTraceStateMachineSetState(TraceStateMachineHandle_t xStateMachineHa
 {
 	TraceEventHandle_t xEventHandle = 0;
 	TraceUnsignedBaseType_t uxStateMachine;
+	TraceUnsignedBaseType_t uxPreviousState = 0;
 	
 	/* This should never fail */
 	TRC_ASSERT(xStateMachineHandle != 0);
@@ -80,9 +81,19 @@ traceResult xTraceStateMachineSetState(TraceStateMachineHandle_t xStateMachineHa
 	/* This should never fail */
 	TRC_ASSERT(xStateMachineHandle == (TraceStateMachineHandle_t)uxStateMachine);
 
+	/* This should never fail */
+	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntryGetState((TraceEntryHandle_t)xStateMachineHandle, TRC_STATE_MACHINE_STATE_INDEX, &uxPreviousState) == TRC_SUCCESS);
+
 	/* This should never fail */
 	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntrySetState((TraceEntryHandle_t)xStateMachineHandle, TRC_STATE_MACHINE_STATE_INDEX, (TraceUnsignedBaseType_t)xStateHandle) == TRC_SUCCESS);
 
+	/* The time spent in each state, kept also when not tracing */
+	if (uxPreviousState != 0)
+	{
+		(void)xTraceDurationStatsStop((void*)uxPreviousState);
+	}
+	(void)xTraceDurationStatsStart((void*)xStateHandle);
+
 	/* We need to check this */
 	if (xTraceEventBegin(PSF_EVENT_STATEMACHINE_STATECHANGE, sizeof(void*) + sizeof(void*), &xEventHandle) == TRC_SUCCESS)
 	{
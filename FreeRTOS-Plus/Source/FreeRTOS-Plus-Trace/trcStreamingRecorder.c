@@ -112,6 +112,11 @@ static void prvSetRecorderEnabled(void);
 /* Internal function for stopping the recorder */
 static void prvSetRecorderDisabled(void);
 
+#if (TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY == 1)
+/* Picks the next TzCtrl delay from the bytes transferred after the last one */
+static void prvUpdateTzCtrlDelay(uint32_t uiBytesTransferred);
+#endif
+
 /******************************************************************************
 * xTraceInitialize
 *
@@ -140,6 +145,15 @@ traceResult xTraceInitialize(void)
 	pxTraceRecorderData->uiRecorderEnabled = 0;
 	pxTraceRecorderData->uiTraceSystemState = TRC_STATE_IN_STARTUP;
 
+#if (TRC_CFG_USE_EVENT_FILTER == 1)
+	/* All event codes are enabled by default */
+	xTraceEventFilterSetAll(1);
+#endif
+
+#if (TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY == 1)
+	pxTraceRecorderData->uiTzCtrlDelay = (TRC_CFG_CTRL_TASK_DELAY);
+#endif
+
 #if (TRC_EXTERNAL_BUFFERS == 0)
 	if (xTraceHeaderInitialize(&pxTraceRecorderData->xHeaderBuffer) == TRC_FAIL)
 	{
@@ -207,11 +221,32 @@ traceResult xTraceInitialize(void)
 		return TRC_FAIL;
 	}
 
+	if (xTraceTaskStatsInitialize(&pxTraceRecorderData->xTaskStatsBuffer) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+
+	if (xTraceHeapProfilerInitialize(&pxTraceRecorderData->xHeapProfilerBuffer) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+
+	if (xTraceDurationStatsInitialize(&pxTraceRecorderData->xDurationStatsBuffer) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+
 	if (xTraceKernelPortInitialize(&pxTraceRecorderData->xKernelPortBuffer) == TRC_FAIL)
 	{
 		return TRC_FAIL;
 	}
 
+	/* Last, since it registers its extension in the entry table */
+	if (xTraceProfilerInitialize(&pxTraceRecorderData->xProfilerBuffer) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+
 	xTraceSetComponentInitialized(TRC_RECORDER_COMPONENT_CORE);
 
 	return TRC_SUCCESS;
@@ -255,6 +290,9 @@ traceResult xTraceHeaderInitialize(TraceHeaderBuffer_t *pxBuffer)
 	/* 3rd bit used for TRC_CFG_TEST_MODE */
 	pxHeader->uiOptions |= ((TRC_CFG_TEST_MODE) << 2);
 
+	/* 4th bit used for TRC_CFG_STREAMING_COMPACT */
+	pxHeader->uiOptions |= ((TRC_CFG_STREAMING_COMPACT) << 3);
+
 	return TRC_SUCCESS;
 }
 
@@ -329,6 +367,17 @@ traceResult xTraceDisable(void)
 	return TRC_SUCCESS;
 }
 
+traceResult xTraceTrigger(void)
+{
+	/* We need to check this */
+	if (!xTraceIsRecorderEnabled())
+	{
+		return TRC_FAIL;
+	}
+
+	return xTraceStreamPortOnTrigger();
+}
+
 #if (TRC_CFG_RECORDER_BUFFER_ALLOCATION == TRC_RECORDER_BUFFER_ALLOCATION_CUSTOM)
 traceResult xTraceSetBuffer(TraceRecorderDataBuffer_t* pxBuffer)
 {
@@ -361,6 +410,9 @@ traceResult xTraceTzCtrl(void)
 {
 	TraceCommand_t xCommand;
 	int32_t iBytes = 0;
+#if (TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY == 1)
+	uint32_t uiBytesTransferred = 0;
+#endif
 	
 	do
 	{
@@ -384,6 +436,10 @@ traceResult xTraceTzCtrl(void)
 
 #if (TRC_USE_INTERNAL_BUFFER == 1)
 		xTraceInternalEventBufferTransfer(&iBytes);
+
+#if (TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY == 1)
+		uiBytesTransferred += (uint32_t)iBytes;
+#endif
 #endif
 
 		/* If there was data sent or received (bytes != 0), loop around and repeat, if there is more data to send or receive.
@@ -391,10 +447,16 @@ traceResult xTraceTzCtrl(void)
 
 	} while (iBytes != 0);
 
+#if (TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY == 1)
+	prvUpdateTzCtrlDelay(uiBytesTransferred);
+#endif
+
 	if (xTraceIsRecorderEnabled())
 	{
 		xTraceDiagnosticsCheckStatus();
+		xTraceDiagnosticsReportMetrics();
 		xTraceStackMonitorReport();
+		xTraceHeapProfilerReport();
 	}
 
 	return TRC_SUCCESS;
@@ -410,9 +472,88 @@ void vTraceSetFilterMask(uint16_t filterMask)
 	(void)filterMask;
 }
 
+#if (TRC_CFG_USE_EVENT_FILTER == 1)
+
+traceResult xTraceEventFilterSet(uint32_t uiEventCode, uint32_t uiEnabled)
+{
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(uiEventCode <= 0xFFF);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	if (uiEnabled != 0)
+	{
+		pxTraceRecorderData->uiEventFilter[uiEventCode >> 5] &= ~(1UL << (uiEventCode & 0x1F));
+	}
+	else
+	{
+		pxTraceRecorderData->uiEventFilter[uiEventCode >> 5] |= (1UL << (uiEventCode & 0x1F));
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceEventFilterSetAll(uint32_t uiEnabled)
+{
+	uint32_t i;
+
+	for (i = 0; i < TRC_EVENT_FILTER_WORDS; i++)
+	{
+		pxTraceRecorderData->uiEventFilter[i] = (uiEnabled != 0) ? 0 : 0xFFFFFFFFUL;
+	}
+
+	return TRC_SUCCESS;
+}
+
+#endif /* (TRC_CFG_USE_EVENT_FILTER == 1) */
+
 /******************************************************************************/
 /*** INTERNAL FUNCTIONS *******************************************************/
 /******************************************************************************/
+
+#if (TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY == 1)
+
+static void prvUpdateTzCtrlDelay(uint32_t uiBytesTransferred)
+{
+	uint32_t uiBufferSize = 0;
+	uint32_t uiBytesPerTick;
+	uint32_t uiDelay = (TRC_CFG_CTRL_TASK_DELAY);
+
+	(void)xTraceInternalEventBufferGetSize(&uiBufferSize);
+
+	if (uiBytesTransferred > 0)
+	{
+		/* Rounded up, so that the delay errs on the short side */
+		uiBytesPerTick = (uiBytesTransferred + pxTraceRecorderData->uiTzCtrlDelay - 1) / pxTraceRecorderData->uiTzCtrlDelay;
+
+		/* Sleep until the buffer is expected to be half full */
+		uiDelay = (uiBufferSize / 2) / uiBytesPerTick;
+	}
+
+	/* Back off gradually, since a burst after a long sleep is what overflows */
+	if (uiDelay > pxTraceRecorderData->uiTzCtrlDelay * 2)
+	{
+		uiDelay = pxTraceRecorderData->uiTzCtrlDelay * 2;
+	}
+
+	if (uiDelay > (TRC_CFG_CTRL_TASK_DELAY))
+	{
+		uiDelay = (TRC_CFG_CTRL_TASK_DELAY);
+	}
+
+	if (uiDelay == 0)
+	{
+		uiDelay = 1;
+	}
+
+	pxTraceRecorderData->uiTzCtrlDelay = uiDelay;
+}
+
+#endif /* (TRC_CFG_CTRL_TASK_ADAPTIVE_DELAY == 1) */
 /* Internal function for starting/stopping the recorder. */
 static void prvSetRecorderEnabled(void)
 {
@@ -440,13 +581,17 @@ static void prvSetRecorderEnabled(void)
 	
 	xTraceStreamPortOnTraceBegin();
 
+	/* Names sent in earlier traces must be sent again, unless in the entry table */
+	xTraceObjectNameCacheClear();
+
+	/* Counted first, so that the first compact event of each core is absolute */
+	pxTraceRecorderData->uiSessionCounter++;
+
 	prvTraceStoreHeader();
 	prvTraceStoreTimestampInfo();
 	prvTraceStoreEntryTable();
 	prvTraceStoreStartEvent();
 
-	pxTraceRecorderData->uiSessionCounter++;
-
 	pxTraceRecorderData->uiRecorderEnabled = 1;
 
 	TRACE_EXIT_CRITICAL_SECTION();
@@ -506,6 +651,9 @@ static void prvTraceStoreEntryTable(void)
 	TraceEntryHandle_t xEntryHandle;
 	uint32_t uiEntryCount;
 	void *pvEntryAddress;
+#if (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0)
+	const char* szSymbol;
+#endif /* (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0) */
 
 	xTraceEntryGetCount(&uiEntryCount);
 	
@@ -529,6 +677,12 @@ static void prvTraceStoreEntryTable(void)
 			{
 				xTraceEventAddData(xEventHandle, (void*)xEntryHandle, sizeof(TraceEntry_t));
 				xTraceEventEndOfflineBlocking(xEventHandle);
+
+#if (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0)
+				/* The host now has the name, so it isn't sent again if set to the same */
+				xTraceEntryGetSymbol(xEntryHandle, &szSymbol);
+				xTraceObjectNameCacheAdd(pvEntryAddress, szSymbol);
+#endif /* (TRC_CFG_OBJECT_NAME_CACHE_SIZE > 0) */
 			}
 		}
 	}
@@ -586,6 +740,18 @@ static void prvProcessCommand(TraceCommand_t* cmd)
 				prvSetRecorderDisabled();
 			}
 		  	break;
+#if (TRC_CFG_USE_EVENT_FILTER == 1)
+		case CMD_SET_EVENT_FILTER:
+			if (cmd->param4 == 1)
+			{
+				xTraceEventFilterSetAll(cmd->param1);
+			}
+			else
+			{
+				xTraceEventFilterSet((((uint32_t)cmd->param3 << 8) | cmd->param2) & 0xFFF, cmd->param1);
+			}
+			break;
+#endif
 		default:
 		  	break;
 	}
@@ -52,6 +52,8 @@ traceResult xTraceTaskUnregister(TraceTaskHandle_t xTaskHandle, TraceUnsignedBas
 	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntryGetAddress((TraceEntryHandle_t)xTaskHandle, &pvTask) == TRC_SUCCESS);
 	
 	xTraceStackMonitorRemove(pvTask);
+
+	xTraceTaskStatsRemove(pvTask);
 	
 	return xTraceObjectUnregister((TraceObjectHandle_t)xTaskHandle, PSF_EVENT_TASK_DELETE, uxPriority);
 }
@@ -113,6 +115,9 @@ traceResult xTraceTaskSwitch(void *pvTask, TraceUnsignedBaseType_t uxPriority)
 
 	TRACE_ALLOC_CRITICAL_SECTION();
 
+	/* Kept also when not tracing */
+	xTraceTaskStatsSwitch(pvTask);
+
 	if (xTraceIsRecorderEnabled() == 0)
 	{
 		return xResult;
@@ -143,22 +148,31 @@ traceResult xTraceTaskSwitch(void *pvTask, TraceUnsignedBaseType_t uxPriority)
 	return xResult;
 }
 
-#if (TRC_CFG_INCLUDE_READY_EVENTS == 1)
+#if (TRC_CFG_INCLUDE_READY_EVENTS == 1) || (TRC_CFG_ENABLE_TASK_STATS == 1)
 traceResult xTraceTaskReady(void *pvTask)
 {
 	traceResult xResult = TRC_FAIL;
+#if (TRC_CFG_INCLUDE_READY_EVENTS == 1)
 	TraceEventHandle_t xEventHandle = 0;
+#endif
+
+	/* Kept also when not tracing */
+	xTraceTaskStatsReady(pvTask);
 
+#if (TRC_CFG_INCLUDE_READY_EVENTS == 1)
 	if (xTraceEventBegin(PSF_EVENT_TASK_READY, sizeof(void*), &xEventHandle) == TRC_SUCCESS)
 	{
 		xTraceEventAddPointer(xEventHandle, pvTask);
 		xTraceEventEnd(xEventHandle);
 		xResult = TRC_SUCCESS;
 	}
+#else
+	xResult = TRC_SUCCESS;
+#endif
 
 	return xResult;
 }
-#endif /* (TRC_CFG_INCLUDE_READY_EVENTS == 1) */
+#endif /* (TRC_CFG_INCLUDE_READY_EVENTS == 1) || (TRC_CFG_ENABLE_TASK_STATS == 1) */
 
 traceResult xTraceTaskInstanceFinishedNow(void)
 {
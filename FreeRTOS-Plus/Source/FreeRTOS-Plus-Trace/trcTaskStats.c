@@ -0,0 +1,419 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* The implementation of the task statistics.
+*/
+
+#include <trcRecorder.h>
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#if (TRC_CFG_ENABLE_TASK_STATS == 1)
+
+/* The task has been made ready and waits to be switched in */
+#define TRC_TASK_STATS_FLAG_READY	0x00000001U
+
+/* The task has been switched in at least once */
+#define TRC_TASK_STATS_FLAG_HAS_RUN	0x00000002U
+
+static TraceTaskStatsData_t* pxTaskStats;
+
+static uint64_t prvTraceTaskStatsGetTime(void);
+static uint32_t prvTraceTaskStatsGetElapsed(uint64_t uiFrom, uint64_t uiTo);
+static TraceTaskStatsEntry_t* prvTraceTaskStatsFind(void* pvTask, uint32_t uiAdd);
+static uint32_t prvTraceTaskStatsIsRunning(void* pvTask, uint32_t* puiCore);
+
+traceResult xTraceTaskStatsInitialize(TraceTaskStatsBuffer_t* pxBuffer)
+{
+	uint32_t i;
+
+	TRC_ASSERT_EQUAL_SIZE(TraceTaskStatsBuffer_t, TraceTaskStatsData_t);
+
+	/* This should never fail */
+	TRC_ASSERT(pxBuffer != 0);
+
+	pxTaskStats = (TraceTaskStatsData_t*)pxBuffer;
+
+	pxTaskStats->uiEntryCount = 0;
+
+	for (i = 0; i < (TRC_CFG_CORE_COUNT); i++)
+	{
+		pxTaskStats->pvCurrent[i] = 0;
+		pxTaskStats->uiSwitchInTime[i] = 0;
+	}
+
+	xTraceSetComponentInitialized(TRC_RECORDER_COMPONENT_TASK_STATS);
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceTaskStatsSwitch(void* pvTask)
+{
+	TraceTaskStatsEntry_t* pxEntry;
+	uint64_t uiNow;
+	uint32_t uiCore;
+	uint32_t uiLatency;
+	uint32_t uiLimit;
+	uint32_t uiBin;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* Task switches happen before the recorder is initialized */
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_TASK_STATS))
+	{
+		return TRC_FAIL;
+	}
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	uiCore = (uint32_t)TRC_CFG_GET_CURRENT_CORE();
+
+	/* The kernel calls this on every scheduling decision, also when the same
+	 * task keeps running */
+	if (pxTaskStats->pvCurrent[uiCore] == pvTask)
+	{
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		return TRC_SUCCESS;
+	}
+
+	uiNow = prvTraceTaskStatsGetTime();
+
+	if (pxTaskStats->pvCurrent[uiCore] != 0)
+	{
+		pxEntry = prvTraceTaskStatsFind(pxTaskStats->pvCurrent[uiCore], 0);
+		if (pxEntry != 0)
+		{
+			pxEntry->xStats.uiRunTime += prvTraceTaskStatsGetElapsed(pxTaskStats->uiSwitchInTime[uiCore], uiNow);
+		}
+	}
+
+	pxEntry = prvTraceTaskStatsFind(pvTask, 1);
+	if (pxEntry != 0)
+	{
+		pxEntry->xStats.uiSwitchIns++;
+
+		if ((pxEntry->uiFlags & TRC_TASK_STATS_FLAG_READY) != 0)
+		{
+			uiLatency = prvTraceTaskStatsGetElapsed(pxEntry->uiReadyTime, uiNow);
+
+			if (uiLatency > pxEntry->xStats.uiLatencyMax)
+			{
+				pxEntry->xStats.uiLatencyMax = uiLatency;
+			}
+
+			/* Every bin twice as wide as the previous one, the last one open */
+			uiLimit = 1U << (TRC_CFG_TASK_STATS_LATENCY_SHIFT);
+			for (uiBin = 0; uiBin < (TRC_CFG_TASK_STATS_HISTOGRAM_BINS) - 1; uiBin++)
+			{
+				if (uiLatency < uiLimit)
+				{
+					break;
+				}
+
+				if (uiLimit >= 0x80000000U)
+				{
+					uiBin = (TRC_CFG_TASK_STATS_HISTOGRAM_BINS) - 1;
+					break;
+				}
+
+				uiLimit <<= 1;
+			}
+
+			pxEntry->xStats.uiLatencyBins[uiBin]++;
+		}
+		else if ((pxEntry->uiFlags & TRC_TASK_STATS_FLAG_HAS_RUN) != 0)
+		{
+			/* It was never made ready, so it was still ready since it was
+			 * switched out */
+			pxEntry->xStats.uiPreemptions++;
+		}
+
+		pxEntry->uiFlags = TRC_TASK_STATS_FLAG_HAS_RUN;
+	}
+
+	pxTaskStats->pvCurrent[uiCore] = pvTask;
+	pxTaskStats->uiSwitchInTime[uiCore] = uiNow;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceTaskStatsReady(void* pvTask)
+{
+	TraceTaskStatsEntry_t* pxEntry;
+	uint32_t uiCore;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_TASK_STATS))
+	{
+		return TRC_FAIL;
+	}
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	/* A running task is moved between the ready lists when its priority
+	 * changes, that is not a wakeup */
+	if (prvTraceTaskStatsIsRunning(pvTask, &uiCore) == 0)
+	{
+		pxEntry = prvTraceTaskStatsFind(pvTask, 1);
+
+		/* The latency is counted from the first time it was made ready */
+		if ((pxEntry != 0) && ((pxEntry->uiFlags & TRC_TASK_STATS_FLAG_READY) == 0))
+		{
+			pxEntry->uiReadyTime = prvTraceTaskStatsGetTime();
+			pxEntry->uiFlags |= TRC_TASK_STATS_FLAG_READY;
+		}
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceTaskStatsRemove(void* pvTask)
+{
+	uint32_t i;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	if (!xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_TASK_STATS))
+	{
+		return TRC_FAIL;
+	}
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	for (i = 0; i < pxTaskStats->uiEntryCount; i++)
+	{
+		if (pxTaskStats->xEntries[i].xStats.pvTask == pvTask)
+		{
+			/* Move the last entry to this slot */
+			pxTaskStats->uiEntryCount--;
+			pxTaskStats->xEntries[i] = pxTaskStats->xEntries[pxTaskStats->uiEntryCount];
+
+			TRACE_EXIT_CRITICAL_SECTION();
+
+			return TRC_SUCCESS;
+		}
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_FAIL;
+}
+
+traceResult xTraceTaskStatsGetCount(uint32_t* puiCount)
+{
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_TASK_STATS));
+
+	/* This should never fail */
+	TRC_ASSERT(puiCount != 0);
+
+	*puiCount = pxTaskStats->uiEntryCount;
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceTaskStatsGetAtIndex(uint32_t uiIndex, TraceTaskStats_t* pxStats)
+{
+	uint32_t uiCore;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_TASK_STATS));
+
+	/* This should never fail */
+	TRC_ASSERT(pxStats != 0);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	/* We need to check this, since tasks can be deleted after the count was read */
+	if (uiIndex >= pxTaskStats->uiEntryCount)
+	{
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		return TRC_FAIL;
+	}
+
+	*pxStats = pxTaskStats->xEntries[uiIndex].xStats;
+
+	/* Include the time the task has been running so far */
+	if (prvTraceTaskStatsIsRunning(pxStats->pvTask, &uiCore) != 0)
+	{
+		pxStats->uiRunTime += prvTraceTaskStatsGetElapsed(pxTaskStats->uiSwitchInTime[uiCore], prvTraceTaskStatsGetTime());
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceTaskStatsClear(void)
+{
+	TraceTaskStats_t* pxStats;
+	uint64_t uiNow;
+	uint32_t i;
+	uint32_t j;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_TASK_STATS));
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	uiNow = prvTraceTaskStatsGetTime();
+
+	for (i = 0; i < pxTaskStats->uiEntryCount; i++)
+	{
+		pxStats = &pxTaskStats->xEntries[i].xStats;
+
+		pxStats->uiRunTime = 0;
+		pxStats->uiSwitchIns = 0;
+		pxStats->uiPreemptions = 0;
+		pxStats->uiLatencyMax = 0;
+
+		for (j = 0; j < (TRC_CFG_TASK_STATS_HISTOGRAM_BINS); j++)
+		{
+			pxStats->uiLatencyBins[j] = 0;
+		}
+
+		/* The task state is kept, so a pending wakeup is still measured */
+	}
+
+	for (i = 0; i < (TRC_CFG_CORE_COUNT); i++)
+	{
+		pxTaskStats->uiSwitchInTime[i] = uiNow;
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+/**
+ * @brief Gets the time in timer counts as a 64-bit value, using the timer
+ * wraparounds tracked by the timestamps.
+ *
+ * @return Time.
+ */
+static uint64_t prvTraceTaskStatsGetTime(void)
+{
+	uint64_t uiTime = 0;
+
+	(void)xTraceTimestampGet64(&uiTime);
+
+	return uiTime;
+}
+
+/**
+ * @brief Gets the time between two 64-bit times, 0 if the time appears to go
+ * backwards and saturated at 32 bits.
+ *
+ * @param[in] uiFrom Earlier time.
+ * @param[in] uiTo Later time.
+ *
+ * @return Elapsed timer counts.
+ */
+static uint32_t prvTraceTaskStatsGetElapsed(uint64_t uiFrom, uint64_t uiTo)
+{
+	/* A timer read just before the OS tick was handled can be a period behind */
+	if (uiTo <= uiFrom)
+	{
+		return 0;
+	}
+
+	if ((uiTo - uiFrom) > 0xFFFFFFFFU)
+	{
+		return 0xFFFFFFFFU;
+	}
+
+	return (uint32_t)(uiTo - uiFrom);
+}
+
+/**
+ * @brief Finds the entry of a task, optionally adding it if there is room.
+ *
+ * @param[in] pvTask Task.
+ * @param[in] uiAdd 1 to add the task if it isn't found.
+ *
+ * @return The entry, or 0 if not found.
+ */
+static TraceTaskStatsEntry_t* prvTraceTaskStatsFind(void* pvTask, uint32_t uiAdd)
+{
+	TraceTaskStatsEntry_t* pxEntry;
+	uint32_t i;
+
+	for (i = 0; i < pxTaskStats->uiEntryCount; i++)
+	{
+		if (pxTaskStats->xEntries[i].xStats.pvTask == pvTask)
+		{
+			return &pxTaskStats->xEntries[i];
+		}
+	}
+
+	/* Tasks after the first TRC_CFG_TASK_STATS_MAX_TASKS are not counted */
+	if ((uiAdd == 0) || (pvTask == 0) || (pxTaskStats->uiEntryCount >= (TRC_CFG_TASK_STATS_MAX_TASKS)))
+	{
+		return 0;
+	}
+
+	pxEntry = &pxTaskStats->xEntries[pxTaskStats->uiEntryCount];
+	pxTaskStats->uiEntryCount++;
+
+	pxEntry->xStats.pvTask = pvTask;
+	pxEntry->xStats.uiRunTime = 0;
+	pxEntry->xStats.uiSwitchIns = 0;
+	pxEntry->xStats.uiPreemptions = 0;
+	pxEntry->xStats.uiLatencyMax = 0;
+	for (i = 0; i < (TRC_CFG_TASK_STATS_HISTOGRAM_BINS); i++)
+	{
+		pxEntry->xStats.uiLatencyBins[i] = 0;
+	}
+	pxEntry->uiReadyTime = 0;
+	pxEntry->uiFlags = 0;
+
+	return pxEntry;
+}
+
+/**
+ * @brief Checks if a task is running on any core.
+ *
+ * @param[in] pvTask Task.
+ * @param[out] puiCore The core it runs on.
+ *
+ * @return 1 if running, otherwise 0.
+ */
+static uint32_t prvTraceTaskStatsIsRunning(void* pvTask, uint32_t* puiCore)
+{
+	uint32_t i;
+
+	for (i = 0; i < (TRC_CFG_CORE_COUNT); i++)
+	{
+		if (pxTaskStats->pvCurrent[i] == pvTask)
+		{
+			*puiCore = i;
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+#endif /* (TRC_CFG_ENABLE_TASK_STATS == 1) */
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
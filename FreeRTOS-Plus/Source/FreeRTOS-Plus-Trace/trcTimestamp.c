@@ -16,6 +16,11 @@
 
 TraceTimestamp_t *pxTraceTimestamp;
 
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_TICK)
+/* Odd while the OS tick updates the wraparounds and the latest timestamp */
+static volatile uint32_t uiTickSequence;
+#endif
+
 traceResult xTraceTimestampInitialize(TraceTimestampBuffer_t *pxBuffer)
 {
 	TRC_ASSERT_EQUAL_SIZE(TraceTimestampBuffer_t, TraceTimestamp_t);
@@ -37,11 +42,141 @@ traceResult xTraceTimestampInitialize(TraceTimestampBuffer_t *pxBuffer)
 	pxTraceTimestamp->latestTimestamp = pxTraceTimestamp->period - 1;
 #endif
 
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_TICK)
+	uiTickSequence = 0;
+
+	/* Start from the current count, so the first tick doesn't see a wraparound */
+	pxTraceTimestamp->latestTimestamp = TRC_HWTC_COUNT;
+#endif
+
 	xTraceSetComponentInitialized(TRC_RECORDER_COMPONENT_TIMESTAMP);
 
 	return TRC_SUCCESS;
 }
 
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_TICK)
+
+traceResult prvTraceTimestampGetWraparounds(uint32_t* puiTimerWraparounds)
+{
+	uint32_t uiSequence;
+	uint32_t uiWraparounds;
+	uint32_t uiLatestTimestamp;
+	uint32_t uiTimestamp;
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_TIMESTAMP));
+
+	/* This should never fail */
+	TRC_ASSERT(puiTimerWraparounds != 0);
+
+	/* The OS tick updates these in a critical section, so only an OS tick on
+	 * another core can be in the middle of it. Then we read them again. */
+	do
+	{
+		uiSequence = uiTickSequence;
+		TRC_EVENT_BUFFER_MEMORY_BARRIER();
+
+		uiWraparounds = pxTraceTimestamp->wraparounds;
+		uiLatestTimestamp = pxTraceTimestamp->latestTimestamp;
+		uiTimestamp = TRC_HWTC_COUNT;
+
+		TRC_EVENT_BUFFER_MEMORY_BARRIER();
+	} while (((uiSequence & 1) != 0) || (uiSequence != uiTickSequence));
+
+	/* The timer may have wrapped around since the last OS tick */
+#if ((TRC_HWTC_TYPE == TRC_FREE_RUNNING_32BIT_INCR) || (TRC_HWTC_TYPE == TRC_CUSTOM_TIMER_INCR))
+	if (uiTimestamp < uiLatestTimestamp)
+#else
+	if (uiTimestamp > uiLatestTimestamp)
+#endif
+	{
+		uiWraparounds++;
+	}
+
+	*puiTimerWraparounds = uiWraparounds;
+
+	return TRC_SUCCESS;
+}
+
+#endif /* ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_TICK) */
+
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) != TRC_TIMESTAMP_WRAPAROUNDS_EVENT)
+
+traceResult prvTraceTimestampSetOsTickCount(uint32_t uiOsTickCount)
+{
+	uint32_t uiTimestamp;
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_TIMESTAMP));
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	uiTimestamp = TRC_HWTC_COUNT;
+
+	pxTraceTimestamp->osTickCount = uiOsTickCount;
+
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_HWTC)
+	/* Not needed for the timestamps, but keeps the timestamp info sent to the host up to date */
+	pxTraceTimestamp->wraparounds = TRC_HWTC_COUNT_WRAPAROUNDS;
+#else
+	uiTickSequence++;
+	TRC_EVENT_BUFFER_MEMORY_BARRIER();
+
+#if ((TRC_HWTC_TYPE == TRC_FREE_RUNNING_32BIT_INCR) || (TRC_HWTC_TYPE == TRC_CUSTOM_TIMER_INCR))
+	if (uiTimestamp < pxTraceTimestamp->latestTimestamp)
+#else
+	if (uiTimestamp > pxTraceTimestamp->latestTimestamp)
+#endif
+	{
+		pxTraceTimestamp->wraparounds++;
+	}
+#endif
+
+	pxTraceTimestamp->latestTimestamp = uiTimestamp;
+
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_TICK)
+	TRC_EVENT_BUFFER_MEMORY_BARRIER();
+	uiTickSequence++;
+#endif
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+#endif /* ((TRC_TIMESTAMP_WRAPAROUNDS) != TRC_TIMESTAMP_WRAPAROUNDS_EVENT) */
+
+traceResult xTraceTimestampGet64(uint64_t* puiTime)
+{
+	uint32_t uiTimestamp = 0;
+	uint32_t uiWraparounds = 0;
+
+	/* This should never fail */
+	TRC_ASSERT(puiTime != 0);
+
+	/* The timestamp first, since that can update the wraparounds */
+	xTraceTimestampGet(&uiTimestamp);
+	xTraceTimestampGetWraparounds(&uiWraparounds);
+
+#if (TRC_HWTC_TYPE == TRC_FREE_RUNNING_32BIT_INCR)
+	*puiTime = ((uint64_t)uiWraparounds << 32) + uiTimestamp;
+#elif (TRC_HWTC_TYPE == TRC_FREE_RUNNING_32BIT_DECR)
+	*puiTime = ((uint64_t)uiWraparounds << 32) + (0xFFFFFFFFU - uiTimestamp);
+#elif (TRC_HWTC_TYPE == TRC_OS_TIMER_INCR)
+	/* The wraparounds are the OS ticks, and the upper bits are the OS tick */
+	*puiTime = (uint64_t)uiWraparounds * (TRC_HWTC_PERIOD) + (uiTimestamp & 0x00FFFFFFU);
+#elif (TRC_HWTC_TYPE == TRC_OS_TIMER_DECR)
+	*puiTime = (uint64_t)uiWraparounds * (TRC_HWTC_PERIOD) + ((TRC_HWTC_PERIOD) - 1 - (uiTimestamp & 0x00FFFFFFU));
+#elif (TRC_HWTC_TYPE == TRC_CUSTOM_TIMER_INCR)
+	*puiTime = (uint64_t)uiWraparounds * (TRC_HWTC_PERIOD) + uiTimestamp;
+#else
+	*puiTime = (uint64_t)uiWraparounds * (TRC_HWTC_PERIOD) + ((TRC_HWTC_PERIOD) - 1 - uiTimestamp);
+#endif
+
+	return TRC_SUCCESS;
+}
+
 #if ((TRC_CFG_USE_TRACE_ASSERT) == 1)
 
 traceResult xTraceTimestampGet(uint32_t *puiTimestamp)
@@ -52,6 +187,12 @@ traceResult xTraceTimestampGet(uint32_t *puiTimestamp)
 	/* This should never fail */
 	TRC_ASSERT(puiTimestamp != 0);
 
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) != TRC_TIMESTAMP_WRAPAROUNDS_EVENT)
+	/* The wraparounds are kept track of elsewhere, so this is only a read */
+	*puiTimestamp = TRC_HWTC_COUNT;
+
+	return TRC_SUCCESS;
+#else
 	switch (pxTraceTimestamp->type)
 	{
 	case TRC_FREE_RUNNING_32BIT_INCR:
@@ -82,6 +223,7 @@ traceResult xTraceTimestampGet(uint32_t *puiTimestamp)
 	pxTraceTimestamp->latestTimestamp = *puiTimestamp;
 	
 	return TRC_SUCCESS;
+#endif
 }
 
 traceResult xTraceTimestampGetWraparounds(uint32_t* puiTimerWraparounds)
@@ -92,7 +234,13 @@ traceResult xTraceTimestampGetWraparounds(uint32_t* puiTimerWraparounds)
 	/* This should never fail */
 	TRC_ASSERT(puiTimerWraparounds != 0);
 
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_HWTC)
+	*puiTimerWraparounds = TRC_HWTC_COUNT_WRAPAROUNDS;
+#elif ((TRC_TIMESTAMP_WRAPAROUNDS) == TRC_TIMESTAMP_WRAPAROUNDS_TICK)
+	return prvTraceTimestampGetWraparounds(puiTimerWraparounds);
+#else
 	*puiTimerWraparounds = pxTraceTimestamp->wraparounds;
+#endif
 
 	return TRC_SUCCESS;
 }
@@ -119,12 +267,16 @@ traceResult xTraceTimestampSetPeriod(uint32_t uiPeriod)
 
 traceResult xTraceTimestampSetOsTickCount(uint32_t uiOsTickCount)
 {
+#if ((TRC_TIMESTAMP_WRAPAROUNDS) != TRC_TIMESTAMP_WRAPAROUNDS_EVENT)
+	return prvTraceTimestampSetOsTickCount(uiOsTickCount);
+#else
 	/* This should never fail */
 	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_TIMESTAMP));
 
 	pxTraceTimestamp->osTickCount = uiOsTickCount;
 
 	return TRC_SUCCESS;
+#endif
 }
 
 traceResult xTraceTimestampGetFrequency(TraceUnsignedBaseType_t *puxFrequency)
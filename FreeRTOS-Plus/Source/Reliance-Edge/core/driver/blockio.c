@@ -34,11 +34,180 @@
     of times.  This behavior caters to the type of unreliable hardware and
     drivers that are sometimes found in the IoT world, where one operation may
     fail but the next may still succeed.
+
+    Requests are split to fit the geometry reported by the block device: no
+    request is larger than the device's maximum transfer size, and writes do
+    not span erase block boundaries.
+
+    When REDCONF_STATS is enabled, this module also holds the per-volume I/O
+    statistics, and counts (and optionally times) the block device requests.
 */
 #include <redfs.h>
 #include <redcore.h>
 
 
+/** @brief Block device geometry, converted into units of logical blocks.
+*/
+typedef struct
+{
+    /** The most blocks to transfer with one request; zero if unlimited.
+    */
+    uint32_t    ulMaxBlocks;
+
+    /** The number of blocks in an erase block; zero if writes need not be
+        split on erase block boundaries.
+    */
+    uint32_t    ulEraseBlocks;
+
+  #if (REDCONF_READ_ONLY == 1) && (REDCONF_READ_MAP > 0U)
+    /** The address at which the block device is mapped; `NULL` if it is not
+        mapped.
+    */
+    const uint8_t *pbMapping;
+  #endif
+} IOGEOMETRY;
+
+
+static uint32_t IoRequestLength(uint8_t bVolNum, uint32_t ulBlockStart, uint32_t ulBlockCount, bool fWrite);
+
+
+/*  Geometry of each volume's block device; zeroed (no limits) until the block
+    device is opened and RedIoGetGeometry() is called.
+*/
+static IOGEOMETRY gaIoGeometry[REDCONF_VOLUME_COUNT];
+
+#if REDCONF_STATS == 1
+REDIOSTATS gaRedIoStats[REDCONF_VOLUME_COUNT];
+#endif
+
+
+/** @brief Query and record the geometry of a volume's block device.
+
+    Must be called after the block device is opened, before it is used for
+    I/O.
+
+    @param bVolNum  The volume whose block device geometry is to be queried.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p bVolNum is an invalid volume number; or the block
+                        device reported an invalid geometry.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedIoGetGeometry(
+    uint8_t         bVolNum)
+{
+    REDSTATUS       ret;
+
+    if(bVolNum >= REDCONF_VOLUME_COUNT)
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        BDEVGEOMETRY    geo = {0U, 0U, NULL};
+
+        ret = RedOsBDevGetGeometry(bVolNum, &geo);
+
+        if(ret == 0)
+        {
+            uint8_t     bSectorShift = gaRedVolume[bVolNum].bBlockSectorShift;
+            IOGEOMETRY *pGeo = &gaIoGeometry[bVolNum];
+
+            /*  A maximum transfer smaller than a block cannot be honored,
+                since the core never transfers less than a block.
+            */
+            if((geo.ulMaxTransfer != 0U) && ((geo.ulMaxTransfer >> bSectorShift) == 0U))
+            {
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                pGeo->ulMaxBlocks = geo.ulMaxTransfer >> bSectorShift;
+
+                /*  Erase blocks no larger than a logical block never split a
+                    block write, so they are ignored.
+                */
+                pGeo->ulEraseBlocks = geo.ulEraseSectors >> bSectorShift;
+                if(pGeo->ulEraseBlocks == 1U)
+                {
+                    pGeo->ulEraseBlocks = 0U;
+                }
+
+              #if (REDCONF_READ_ONLY == 1) && (REDCONF_READ_MAP > 0U)
+                pGeo->pbMapping = CAST_VOID_PTR_TO_CONST_UINT8_PTR(geo.pMapping);
+              #endif
+            }
+        }
+    }
+
+    return ret;
+}
+
+
+#if (REDCONF_READ_ONLY == 1) && (REDCONF_READ_MAP > 0U)
+/** @brief Get a pointer to a logical block in a memory-mapped block device.
+
+    @param bVolNum  The volume whose block device is to be accessed.
+    @param ulBlock  The block number.
+
+    @return A pointer to the block within the block device's mapping; or
+            `NULL` if the block device is not mapped or @p ulBlock is invalid.
+*/
+const uint8_t *RedIoMappedBlock(
+    uint8_t         bVolNum,
+    uint32_t        ulBlock)
+{
+    const uint8_t  *pbBlock = NULL;
+
+    if((bVolNum >= REDCONF_VOLUME_COUNT) || (ulBlock >= gaRedVolume[bVolNum].ulBlockCount))
+    {
+        REDERROR();
+    }
+    else if(gaIoGeometry[bVolNum].pbMapping != NULL)
+    {
+        pbBlock = &gaIoGeometry[bVolNum].pbMapping[(uint64_t)ulBlock << BLOCK_SIZE_P2];
+    }
+    else
+    {
+        /*  Not mapped; return NULL.
+        */
+    }
+
+    return pbBlock;
+}
+#endif
+
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_ALLOC_ERASE_AWARE == 1)
+/** @brief Get the erase block size of a volume's block device.
+
+    @param bVolNum  The volume whose block device is to be queried.
+
+    @return The number of blocks in an erase block; zero if the block device
+            did not report an erase block larger than a logical block.
+*/
+uint32_t RedIoEraseBlocks(
+    uint8_t     bVolNum)
+{
+    uint32_t    ulEraseBlocks = 0U;
+
+    if(bVolNum >= REDCONF_VOLUME_COUNT)
+    {
+        REDERROR();
+    }
+    else
+    {
+        ulEraseBlocks = gaIoGeometry[bVolNum].ulEraseBlocks;
+    }
+
+    return ulEraseBlocks;
+}
+#endif
+
+
 /** @brief Read a range of logical blocks.
 
     @param bVolNum      The volume whose block device is being read from.
@@ -71,22 +240,42 @@ REDSTATUS RedIoRead(
     }
     else
     {
-        uint8_t  bSectorShift = gaRedVolume[bVolNum].bBlockSectorShift;
-        uint64_t ullSectorStart = (uint64_t)ulBlockStart << bSectorShift;
-        uint32_t ulSectorCount = ulBlockCount << bSectorShift;
-        uint8_t  bRetryIdx;
+        uint8_t     bSectorShift = gaRedVolume[bVolNum].bBlockSectorShift;
+        uint8_t    *pbBuffer = CAST_VOID_PTR_TO_UINT8_PTR(pBuffer);
+        uint32_t    ulBlocksRead = 0U;
 
         REDASSERT(bSectorShift < 32U);
-        REDASSERT((ulSectorCount >> bSectorShift) == ulBlockCount);
+        REDASSERT(((ulBlockCount << bSectorShift) >> bSectorShift) == ulBlockCount);
 
-        for(bRetryIdx = 0U; bRetryIdx <= gpRedVolConf->bBlockIoRetries; bRetryIdx++)
+        while((ret == 0) && (ulBlocksRead < ulBlockCount))
         {
-            ret = RedOsBDevRead(bVolNum, ullSectorStart, ulSectorCount, pBuffer);
-
-            if(ret == 0)
+            uint32_t ulBlock = ulBlockStart + ulBlocksRead;
+            uint32_t ulCount = IoRequestLength(bVolNum, ulBlock, ulBlockCount - ulBlocksRead, false);
+            uint8_t  bRetryIdx;
+          #if REDCONF_STATS_LATENCY == 1
+            REDTIMESTAMP tsStart = RedOsTimestamp();
+          #endif
+
+            for(bRetryIdx = 0U; bRetryIdx <= gpRedVolConf->bBlockIoRetries; bRetryIdx++)
             {
-                break;
+                ret = RedOsBDevRead(bVolNum, (uint64_t)ulBlock << bSectorShift, ulCount << bSectorShift,
+                                    &pbBuffer[ulBlocksRead << BLOCK_SIZE_P2]);
+
+                if(ret == 0)
+                {
+                    break;
+                }
             }
+
+          #if REDCONF_STATS == 1
+            gaRedIoStats[bVolNum].ullDevReads++;
+            gaRedIoStats[bVolNum].ullDevReadBlocks += ulCount;
+          #endif
+          #if REDCONF_STATS_LATENCY == 1
+            RedIoStatsLatency(gaRedIoStats[bVolNum].aulDevReadLatency, tsStart);
+          #endif
+
+            ulBlocksRead += ulCount;
         }
     }
 
@@ -129,22 +318,42 @@ REDSTATUS RedIoWrite(
     }
     else
     {
-        uint8_t  bSectorShift = gaRedVolume[bVolNum].bBlockSectorShift;
-        uint64_t ullSectorStart = (uint64_t)ulBlockStart << bSectorShift;
-        uint32_t ulSectorCount = ulBlockCount << bSectorShift;
-        uint8_t  bRetryIdx;
+        uint8_t         bSectorShift = gaRedVolume[bVolNum].bBlockSectorShift;
+        const uint8_t  *pbBuffer = CAST_VOID_PTR_TO_CONST_UINT8_PTR(pBuffer);
+        uint32_t        ulBlocksWritten = 0U;
 
         REDASSERT(bSectorShift < 32U);
-        REDASSERT((ulSectorCount >> bSectorShift) == ulBlockCount);
+        REDASSERT(((ulBlockCount << bSectorShift) >> bSectorShift) == ulBlockCount);
 
-        for(bRetryIdx = 0U; bRetryIdx <= gpRedVolConf->bBlockIoRetries; bRetryIdx++)
+        while((ret == 0) && (ulBlocksWritten < ulBlockCount))
         {
-            ret = RedOsBDevWrite(bVolNum, ullSectorStart, ulSectorCount, pBuffer);
-
-            if(ret == 0)
+            uint32_t ulBlock = ulBlockStart + ulBlocksWritten;
+            uint32_t ulCount = IoRequestLength(bVolNum, ulBlock, ulBlockCount - ulBlocksWritten, true);
+            uint8_t  bRetryIdx;
+          #if REDCONF_STATS_LATENCY == 1
+            REDTIMESTAMP tsStart = RedOsTimestamp();
+          #endif
+
+            for(bRetryIdx = 0U; bRetryIdx <= gpRedVolConf->bBlockIoRetries; bRetryIdx++)
             {
-                break;
+                ret = RedOsBDevWrite(bVolNum, (uint64_t)ulBlock << bSectorShift, ulCount << bSectorShift,
+                                     &pbBuffer[ulBlocksWritten << BLOCK_SIZE_P2]);
+
+                if(ret == 0)
+                {
+                    break;
+                }
             }
+
+          #if REDCONF_STATS == 1
+            gaRedIoStats[bVolNum].ullDevWrites++;
+            gaRedIoStats[bVolNum].ullDevWriteBlocks += ulCount;
+          #endif
+          #if REDCONF_STATS_LATENCY == 1
+            RedIoStatsLatency(gaRedIoStats[bVolNum].aulDevWriteLatency, tsStart);
+          #endif
+
+            ulBlocksWritten += ulCount;
         }
     }
 
@@ -178,6 +387,9 @@ REDSTATUS RedIoFlush(
     else
     {
         uint8_t  bRetryIdx;
+      #if REDCONF_STATS_LATENCY == 1
+        REDTIMESTAMP tsStart = RedOsTimestamp();
+      #endif
 
         for(bRetryIdx = 0U; bRetryIdx <= gpRedVolConf->bBlockIoRetries; bRetryIdx++)
         {
@@ -188,6 +400,13 @@ REDSTATUS RedIoFlush(
                 break;
             }
         }
+
+      #if REDCONF_STATS == 1
+        gaRedIoStats[bVolNum].ullDevFlushes++;
+      #endif
+      #if REDCONF_STATS_LATENCY == 1
+        RedIoStatsLatency(gaRedIoStats[bVolNum].aulDevFlushLatency, tsStart);
+      #endif
     }
 
     CRITICAL_ASSERT(ret == 0);
@@ -196,3 +415,78 @@ REDSTATUS RedIoFlush(
 }
 #endif /* REDCONF_READ_ONLY == 0 */
 
+
+#if REDCONF_STATS_LATENCY == 1
+/** @brief Record the latency of a request in a latency histogram.
+
+    @param paulHistogram    The histogram to update; an array of
+                            RED_STATS_LATENCY_BUCKETS counters.
+    @param tsStart          The time at which the request started.
+*/
+void RedIoStatsLatency(
+    uint32_t       *paulHistogram,
+    REDTIMESTAMP    tsStart)
+{
+    uint64_t        ullMicrosecs = RedOsTimePassed(tsStart);
+    uint32_t        ulBucket = 0U;
+
+    while((ullMicrosecs > 0U) && (ulBucket < (RED_STATS_LATENCY_BUCKETS - 1U)))
+    {
+        ullMicrosecs >>= 1U;
+        ulBucket++;
+    }
+
+    paulHistogram[ulBucket]++;
+}
+#endif
+
+
+/** @brief Determine how many blocks to transfer with the next block device
+           request.
+
+    @param bVolNum      The volume whose block device is being accessed.
+    @param ulBlockStart The first block of the request.
+    @param ulBlockCount The number of blocks remaining to be transferred.
+    @param fWrite       Whether the request is a write, which must not span an
+                        erase block boundary.
+
+    @return The number of blocks to transfer, between one and @p ulBlockCount.
+*/
+static uint32_t IoRequestLength(
+    uint8_t             bVolNum,
+    uint32_t            ulBlockStart,
+    uint32_t            ulBlockCount,
+    bool                fWrite)
+{
+    const IOGEOMETRY   *pGeo = &gaIoGeometry[bVolNum];
+    uint32_t            ulCount = ulBlockCount;
+
+    if((pGeo->ulMaxBlocks != 0U) && (ulCount > pGeo->ulMaxBlocks))
+    {
+        ulCount = pGeo->ulMaxBlocks;
+    }
+
+    if(fWrite && (pGeo->ulEraseBlocks != 0U))
+    {
+        uint32_t ulEraseOffset;
+        uint32_t ulEraseRemaining;
+
+        /*  Erase blocks are almost always a power of two in size, so avoid the
+            division where possible: some targets have no hardware divider.
+        */
+        if((pGeo->ulEraseBlocks & (pGeo->ulEraseBlocks - 1U)) == 0U)
+        {
+            ulEraseOffset = ulBlockStart & (pGeo->ulEraseBlocks - 1U);
+        }
+        else
+        {
+            ulEraseOffset = ulBlockStart % pGeo->ulEraseBlocks;
+        }
+
+        ulEraseRemaining = pGeo->ulEraseBlocks - ulEraseOffset;
+
+        ulCount = REDMIN(ulCount, ulEraseRemaining);
+    }
+
+    return ulCount;
+}
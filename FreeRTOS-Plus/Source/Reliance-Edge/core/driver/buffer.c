@@ -31,6 +31,14 @@
     volumes).  Block buffers may be either dirty or clean.  Most I/O passes
     through this module.  When a buffer is needed for a block which is not in
     the cache, a "victim" is selected via a simple LRU scheme.
+
+    By default, the LRU order is kept in an array which is shifted whenever a
+    buffer is used; when REDCONF_BUFFER_LRU_LIST is enabled, it is instead kept
+    in a doubly-linked list, which makes each update constant-time.
+
+    When REDCONF_BUFFER_HASH is enabled, buffers are also indexed by a small
+    hash table keyed by volume and block number, so that looking up a block
+    does not require a scan of every buffer head.
 */
 #include <redfs.h>
 #include <redcore.h>
@@ -82,7 +90,16 @@
   #endif
 #endif
 
-#if REDCONF_BUFFER_COUNT < MINIMUM_BUFFER_COUNT
+/*  Each outstanding read map pins one buffer, which is then unavailable to
+    the rest of the driver.
+*/
+#if REDCONF_BUFFER_COUNT < (MINIMUM_BUFFER_COUNT + REDCONF_READ_MAP)
+#error "REDCONF_BUFFER_COUNT is too low for the configuration"
+#endif
+
+/*  File copy: The source and destination files all the way down, plus imap.
+*/
+#if COPYFILE_SUPPORTED && (REDCONF_BUFFER_COUNT < (INODE_BUFFERS + INODE_BUFFERS + IMAP_BUFFERS + REDCONF_READ_MAP))
 #error "REDCONF_BUFFER_COUNT is too low for the configuration"
 #endif
 
@@ -95,7 +112,7 @@
     type.
 */
 #define BFLAG_META_MASK (uint16_t)((uint32_t)BFLAG_META_MASTER | BFLAG_META_IMAP | BFLAG_META_INODE | BFLAG_META_INDIR | BFLAG_META_DINDIR)
-#define BFLAG_MASK (uint16_t)((uint32_t)BFLAG_DIRTY | BFLAG_NEW | BFLAG_META_MASK)
+#define BFLAG_MASK (uint16_t)((uint32_t)BFLAG_DIRTY | BFLAG_NEW | BFLAG_DIRECTORY | BFLAG_META_MASK)
 
 
 /*  An invalid block number.  Used to indicate buffers which are not currently
@@ -104,6 +121,33 @@
 #define BBLK_INVALID UINT32_MAX
 
 
+#if REDCONF_BUFFER_HASH == 1
+/*  The number of hash buckets is the smallest power of two which is no less
+    than the number of buffers, so the average chain length is at most one.
+*/
+  #if REDCONF_BUFFER_COUNT <= 16U
+    #define BUFFER_HASH_BUCKETS 16U
+  #elif REDCONF_BUFFER_COUNT <= 32U
+    #define BUFFER_HASH_BUCKETS 32U
+  #elif REDCONF_BUFFER_COUNT <= 64U
+    #define BUFFER_HASH_BUCKETS 64U
+  #elif REDCONF_BUFFER_COUNT <= 128U
+    #define BUFFER_HASH_BUCKETS 128U
+  #else
+    #define BUFFER_HASH_BUCKETS 256U
+  #endif
+
+  #define BUFFER_HASH_MASK (BUFFER_HASH_BUCKETS - 1U)
+#endif
+
+
+/*  An invalid buffer index.  Used to terminate the hash chains and the MRU
+    list.  Since REDCONF_BUFFER_COUNT cannot exceed 255, this is never a valid
+    index.
+*/
+#define BIDX_INVALID UINT8_MAX
+
+
 /** @brief Metadata stored for each block buffer.
 
     To make better use of CPU caching when searching the BUFFERHEAD array, this
@@ -126,6 +170,23 @@ typedef struct
     */
     uint16_t    uNumUsed;
 
+  #if REDCONF_BUFFER_LRU_LIST == 1
+    /** Index of the most-recently-used (MRU) buffer: the head of the MRU list.
+    */
+    uint8_t     bMRU;
+
+    /** Index of the least-recently-used (LRU) buffer: the tail of the MRU list.
+    */
+    uint8_t     bLRU;
+
+    /** MRU list links.  Each buffer appears in the list once and only once.
+        abNewer[bIdx] is the index of the next more recently used buffer, or
+        BIDX_INVALID for the MRU buffer; abOlder[bIdx] is the index of the next
+        less recently used buffer, or BIDX_INVALID for the LRU buffer.
+    */
+    uint8_t     abNewer[REDCONF_BUFFER_COUNT];
+    uint8_t     abOlder[REDCONF_BUFFER_COUNT];
+  #else
     /** MRU array.  Each element of the array stores a buffer index; each buffer
         index appears in the array once and only once.  The first element of the
         array is the most-recently-used (MRU) buffer, followed by the next most
@@ -133,11 +194,25 @@ typedef struct
         recently-used (LRU) buffer.
     */
     uint8_t     abMRU[REDCONF_BUFFER_COUNT];
+  #endif
 
     /** Buffer heads, storing metadata for each buffer.
     */
     BUFFERHEAD  aHead[REDCONF_BUFFER_COUNT];
 
+  #if REDCONF_BUFFER_HASH == 1
+    /** Hash bucket heads, indexed by BufferHash().  Each element stores the
+        index of the first buffer in the bucket's chain, or BIDX_INVALID if the
+        bucket is empty.  Only buffers with a valid block number are hashed.
+    */
+    uint8_t     abHashHead[BUFFER_HASH_BUCKETS];
+
+    /** Hash chain links.  Each element stores the index of the next buffer in
+        the same hash bucket, or BIDX_INVALID at the end of the chain.
+    */
+    uint8_t     abHashNext[REDCONF_BUFFER_COUNT];
+  #endif
+
     /** Array of memory for the block buffers themselves.
 
         Force 64-bit alignment of the aabBuffer array to ensure that it is safe
@@ -151,17 +226,30 @@ static bool BufferIsValid(const uint8_t  *pbBuffer, uint16_t uFlags);
 static bool BufferToIdx(const void *pBuffer, uint8_t *pbIdx);
 #if REDCONF_READ_ONLY == 0
 static REDSTATUS BufferWrite(uint8_t bIdx);
+#if REDCONF_WRITE_COALESCE > 1U
+static REDSTATUS BufferWriteRun(const uint8_t *pabIdx, uint32_t ulCount);
+#endif
 static REDSTATUS BufferFinalize(uint8_t *pbBuffer, uint16_t uFlags);
 #endif
 static void BufferMakeLRU(uint8_t bIdx);
 static void BufferMakeMRU(uint8_t bIdx);
+#if REDCONF_BUFFER_LRU_LIST == 1
+static void BufferUnlink(uint8_t bIdx);
+#endif
+static REDSTATUS BufferDiscard(uint8_t bIdx);
 static bool BufferFind(uint32_t ulBlock, uint8_t *pbIdx);
+#if REDCONF_BUFFER_DATA_MAX > 0U
+static bool BufferFindDataVictim(uint8_t *pbIdx);
+#endif
+static void BufferSetBlock(uint8_t bIdx, uint8_t bVolNum, uint32_t ulBlock);
+#if REDCONF_BUFFER_HASH == 1
+static uint32_t BufferHash(uint8_t bVolNum, uint32_t ulBlock);
+#endif
 
 #ifdef REDCONF_ENDIAN_SWAP
-static void BufferEndianSwap(const void *pBuffer, uint16_t uFlags);
+static void BufferEndianSwap(void *pBuffer, uint16_t uFlags);
 static void BufferEndianSwapHeader(NODEHEADER *pHeader);
 static void BufferEndianSwapMaster(MASTERBLOCK *pMaster);
-static void BufferEndianSwapMetaRoot(METAROOT *pMetaRoot);
 static void BufferEndianSwapInode(INODE *pInode);
 static void BufferEndianSwapIndir(INDIR *pIndir);
 #endif
@@ -169,6 +257,13 @@ static void BufferEndianSwapIndir(INDIR *pIndir);
 
 static BUFFERCTX gBufCtx;
 
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_WRITE_COALESCE > 1U)
+/*  Staging area used to gather runs of dirty buffers for adjacent blocks, so
+    that they can be written with a single I/O request.
+*/
+static ALIGNED_2D_BYTE_ARRAY(gCoalesce, aabBuffer, REDCONF_WRITE_COALESCE, REDCONF_BLOCK_SIZE);
+#endif
+
 
 /** @brief Initialize the buffers.
 */
@@ -183,9 +278,24 @@ void RedBufferInit(void)
         /*  When the buffers have been freshly initialized, acquire the buffers
             in the order in which they appear in the array.
         */
+      #if REDCONF_BUFFER_LRU_LIST == 1
+        gBufCtx.abNewer[bIdx] = (bIdx == (REDCONF_BUFFER_COUNT - 1U)) ? BIDX_INVALID : (uint8_t)(bIdx + 1U);
+        gBufCtx.abOlder[bIdx] = (bIdx == 0U) ? BIDX_INVALID : (uint8_t)(bIdx - 1U);
+      #else
         gBufCtx.abMRU[bIdx] = (uint8_t)((REDCONF_BUFFER_COUNT - bIdx) - 1U);
+      #endif
         gBufCtx.aHead[bIdx].ulBlock = BBLK_INVALID;
     }
+
+  #if REDCONF_BUFFER_LRU_LIST == 1
+    gBufCtx.bMRU = (uint8_t)(REDCONF_BUFFER_COUNT - 1U);
+    gBufCtx.bLRU = 0U;
+  #endif
+
+  #if REDCONF_BUFFER_HASH == 1
+    RedMemSet(gBufCtx.abHashHead, BIDX_INVALID, sizeof(gBufCtx.abHashHead));
+    RedMemSet(gBufCtx.abHashNext, BIDX_INVALID, sizeof(gBufCtx.abHashNext));
+  #endif
 }
 
 
@@ -217,8 +327,16 @@ REDSTATUS RedBufferGet(
     }
     else
     {
+      #if REDCONF_STATS == 1
+        gaRedIoStats[gbRedVolNum].ullBufferGets++;
+      #endif
+
         if(BufferFind(ulBlock, &bIdx))
         {
+          #if REDCONF_STATS == 1
+            gaRedIoStats[gbRedVolNum].ullBufferHits++;
+          #endif
+
             /*  Error if the buffer exists and BFLAG_NEW was specified, since
                 the new flag is used when a block is newly allocated/created, so
                 the block was previously free and and there should never be an
@@ -247,17 +365,34 @@ REDSTATUS RedBufferGet(
             BUFFERHEAD *pHead;
 
             /*  Search for the least recently used buffer which is not
-                referenced.
+                referenced.  If file data already has its share of the buffers,
+                a buffer for file data replaces another one, so that streaming
+                through file data cannot evict the metadata and directory data
+                which most operations need.
             */
-            for(bIdx = (uint8_t)(REDCONF_BUFFER_COUNT - 1U); bIdx > 0U; bIdx--)
+          #if REDCONF_BUFFER_DATA_MAX > 0U
+            if(((uFlags & (uint16_t)((uint32_t)BFLAG_META | BFLAG_DIRECTORY)) != 0U) || !BufferFindDataVictim(&bIdx))
+          #endif
             {
-                if(gBufCtx.aHead[gBufCtx.abMRU[bIdx]].bRefCount == 0U)
+              #if REDCONF_BUFFER_LRU_LIST == 1
+                bIdx = gBufCtx.bLRU;
+                while((gBufCtx.aHead[bIdx].bRefCount != 0U) && (bIdx != gBufCtx.bMRU))
                 {
-                    break;
+                    bIdx = gBufCtx.abNewer[bIdx];
                 }
+              #else
+                for(bIdx = (uint8_t)(REDCONF_BUFFER_COUNT - 1U); bIdx > 0U; bIdx--)
+                {
+                    if(gBufCtx.aHead[gBufCtx.abMRU[bIdx]].bRefCount == 0U)
+                    {
+                        break;
+                    }
+                }
+
+                bIdx = gBufCtx.abMRU[bIdx];
+              #endif
             }
 
-            bIdx = gBufCtx.abMRU[bIdx];
             pHead = &gBufCtx.aHead[bIdx];
 
             if(pHead->bRefCount == 0U)
@@ -297,7 +432,7 @@ REDSTATUS RedBufferGet(
                         buffer were to be used subsequently with its partially
                         erroneous contents, bad things could happen.
                     */
-                    pHead->ulBlock = BBLK_INVALID;
+                    BufferSetBlock(bIdx, pHead->bVolNum, BBLK_INVALID);
 
                     ret = RedIoRead(gbRedVolNum, ulBlock, 1U, gBufCtx.b.aabBuffer[bIdx]);
 
@@ -331,8 +466,7 @@ REDSTATUS RedBufferGet(
 
             if(ret == 0)
             {
-                pHead->bVolNum = gbRedVolNum;
-                pHead->ulBlock = ulBlock;
+                BufferSetBlock(bIdx, gbRedVolNum, ulBlock);
                 pHead->uFlags = 0U;
             }
         }
@@ -396,6 +530,102 @@ void RedBufferPut(
 }
 
 
+#if REDCONF_READ_MAP > 0U
+/** @brief Pin a file data buffer, so that it can be handed out by reference.
+
+    The buffer is detached from its block: it keeps its contents and its
+    reference, but it is no longer found by RedBufferGet(), nor flushed or
+    discarded.  Later changes to the block do not show through the pinned
+    buffer, and the block can be freed or its volume unmounted while the buffer
+    is pinned.  A dirty buffer is written out before it is detached.
+
+    @param pBuffer  The buffer to pin.  Must be a file data buffer which is
+                    referenced once, by the caller; that reference is kept
+                    until RedBufferUnpin() is called.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EINVAL Invalid parameters.
+*/
+REDSTATUS RedBufferPin(
+    const void *pBuffer)
+{
+    REDSTATUS   ret = 0;
+    uint8_t     bIdx;
+
+    if(!BufferToIdx(pBuffer, &bIdx))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else if((gBufCtx.aHead[bIdx].bRefCount != 1U) || ((gBufCtx.aHead[bIdx].uFlags & BFLAG_META) != 0U))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+      #if REDCONF_READ_ONLY == 0
+        if((gBufCtx.aHead[bIdx].uFlags & BFLAG_DIRTY) != 0U)
+        {
+            ret = BufferWrite(bIdx);
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            BufferSetBlock(bIdx, gBufCtx.aHead[bIdx].bVolNum, BBLK_INVALID);
+            gBufCtx.aHead[bIdx].uFlags = 0U;
+
+            /*  The buffer cannot be reused while it is pinned, and it is not
+                worth keeping once it is unpinned.
+            */
+            BufferMakeLRU(bIdx);
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Release a buffer pinned by RedBufferPin().
+
+    @param pBuffer  The pinned buffer to release.
+*/
+void RedBufferUnpin(
+    const void *pBuffer)
+{
+    uint8_t     bIdx;
+
+    /*  BufferToIdx() cannot be used, since a pinned buffer has no block.
+    */
+    for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
+    {
+        if(pBuffer == &gBufCtx.b.aabBuffer[bIdx][0U])
+        {
+            break;
+        }
+    }
+
+    if(    (bIdx == REDCONF_BUFFER_COUNT)
+        || (gBufCtx.aHead[bIdx].ulBlock != BBLK_INVALID)
+        || (gBufCtx.aHead[bIdx].bRefCount != 1U))
+    {
+        REDERROR();
+    }
+    else
+    {
+        REDASSERT(gBufCtx.uNumUsed > 0U);
+
+        gBufCtx.aHead[bIdx].bRefCount = 0U;
+        gBufCtx.uNumUsed--;
+    }
+}
+#endif /* REDCONF_READ_MAP > 0U */
+
+
 #if REDCONF_READ_ONLY == 0
 /** @brief Flush all buffers for the active volume in the given range of blocks.
 
@@ -424,7 +654,12 @@ REDSTATUS RedBufferFlush(
     }
     else
     {
-        uint8_t bIdx;
+      #if REDCONF_WRITE_COALESCE > 1U
+        uint8_t     abDirty[REDCONF_BUFFER_COUNT];
+        uint32_t    ulDirtyCount = 0U;
+        uint32_t    ulIdx;
+      #endif
+        uint8_t     bIdx;
 
         for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
         {
@@ -436,6 +671,21 @@ REDSTATUS RedBufferFlush(
                 && (pHead->ulBlock >= ulBlockStart)
                 && (pHead->ulBlock < (ulBlockStart + ulBlockCount)))
             {
+              #if REDCONF_WRITE_COALESCE > 1U
+                /*  Insert the buffer into the list of dirty buffers, which is
+                    kept sorted by block number.
+                */
+                ulIdx = ulDirtyCount;
+
+                while((ulIdx > 0U) && (gBufCtx.aHead[abDirty[ulIdx - 1U]].ulBlock > pHead->ulBlock))
+                {
+                    abDirty[ulIdx] = abDirty[ulIdx - 1U];
+                    ulIdx--;
+                }
+
+                abDirty[ulIdx] = bIdx;
+                ulDirtyCount++;
+              #else
                 ret = BufferWrite(bIdx);
 
                 if(ret == 0)
@@ -446,8 +696,48 @@ REDSTATUS RedBufferFlush(
                 {
                     break;
                 }
+              #endif
             }
         }
+
+      #if REDCONF_WRITE_COALESCE > 1U
+        /*  Write the dirty buffers in block order, merging buffers for adjacent
+            blocks into a single write.
+        */
+        ulIdx = 0U;
+
+        while((ret == 0) && (ulIdx < ulDirtyCount))
+        {
+            uint32_t ulRunLen = 1U;
+            uint32_t ulRunIdx;
+
+            while(    ((ulIdx + ulRunLen) < ulDirtyCount)
+                   && (ulRunLen < REDCONF_WRITE_COALESCE)
+                   && (gBufCtx.aHead[abDirty[ulIdx + ulRunLen]].ulBlock == (gBufCtx.aHead[abDirty[ulIdx]].ulBlock + ulRunLen)))
+            {
+                ulRunLen++;
+            }
+
+            if(ulRunLen == 1U)
+            {
+                ret = BufferWrite(abDirty[ulIdx]);
+            }
+            else
+            {
+                ret = BufferWriteRun(&abDirty[ulIdx], ulRunLen);
+            }
+
+            if(ret == 0)
+            {
+                for(ulRunIdx = 0U; ulRunIdx < ulRunLen; ulRunIdx++)
+                {
+                    gBufCtx.aHead[abDirty[ulIdx + ulRunIdx]].uFlags &= (~BFLAG_DIRTY);
+                }
+
+                ulIdx += ulRunLen;
+            }
+        }
+      #endif
     }
 
     return ret;
@@ -500,7 +790,7 @@ void RedBufferBranch(
         REDASSERT((pHead->uFlags & BFLAG_DIRTY) == 0U);
 
         pHead->uFlags |= BFLAG_DIRTY;
-        pHead->ulBlock = ulBlockNew;
+        BufferSetBlock(bIdx, pHead->bVolNum, ulBlockNew);
     }
 }
 
@@ -525,7 +815,7 @@ void RedBufferDiscard(
         REDASSERT(gBufCtx.uNumUsed > 0U);
 
         gBufCtx.aHead[bIdx].bRefCount = 0U;
-        gBufCtx.aHead[bIdx].ulBlock = BBLK_INVALID;
+        BufferSetBlock(bIdx, gBufCtx.aHead[bIdx].bVolNum, BBLK_INVALID);
 
         gBufCtx.uNumUsed--;
 
@@ -563,42 +853,186 @@ REDSTATUS RedBufferDiscardRange(
     }
     else
     {
-        uint8_t bIdx;
+        bool fScan = true;
 
-        for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
+      #if REDCONF_BUFFER_HASH == 1
+        /*  Each block freed by a truncate or unlink is discarded individually.
+            For a range that small, looking up each block in the hash index is
+            much cheaper than examining every buffer.
+        */
+        if(ulBlockCount < REDCONF_BUFFER_COUNT)
         {
-            BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+            uint32_t ulIdx;
 
-            if(    (pHead->bVolNum == gbRedVolNum)
-                && (pHead->ulBlock != BBLK_INVALID)
-                && (pHead->ulBlock >= ulBlockStart)
-                && (pHead->ulBlock < (ulBlockStart + ulBlockCount)))
+            fScan = false;
+
+            for(ulIdx = 0U; (ret == 0) && (ulIdx < ulBlockCount); ulIdx++)
+            {
+                uint8_t bIdx;
+
+                if(BufferFind(ulBlockStart + ulIdx, &bIdx))
+                {
+                    ret = BufferDiscard(bIdx);
+                }
+            }
+        }
+      #endif
+
+        if(fScan)
+        {
+            uint8_t bIdx;
+
+            for(bIdx = 0U; (ret == 0) && (bIdx < REDCONF_BUFFER_COUNT); bIdx++)
+            {
+                const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+                if(    (pHead->bVolNum == gbRedVolNum)
+                    && (pHead->ulBlock != BBLK_INVALID)
+                    && (pHead->ulBlock >= ulBlockStart)
+                    && (pHead->ulBlock < (ulBlockStart + ulBlockCount)))
+                {
+                    ret = BufferDiscard(bIdx);
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+
+#if REDCONF_READ_AHEAD > 0U
+/** @brief Speculatively read a range of file data blocks into the buffers.
+
+    The blocks are read with a single I/O request into a group of buffers which
+    are adjacent in memory.  Only buffers which are unused, or which hold clean
+    file data and are not referenced, are repurposed: read-ahead never evicts
+    metadata or dirty buffers.
+
+    Blocks at the start of the range which are already buffered are skipped,
+    and the range is truncated at the next block which is already buffered.
+    If fewer than two blocks would be read, nothing is done, since the block
+    would be read just as efficiently on demand.
+
+    @param ulBlockStart The first block of the range.  The range must be a
+                        contiguous extent of file data blocks.
+    @param ulBlockCount The number of blocks in the range.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EINVAL Invalid parameters.
+*/
+REDSTATUS RedBufferReadAhead(
+    uint32_t    ulBlockStart,
+    uint32_t    ulBlockCount)
+{
+    REDSTATUS   ret = 0;
+
+    if(    (ulBlockStart >= gpRedVolume->ulBlockCount)
+        || ((gpRedVolume->ulBlockCount - ulBlockStart) < ulBlockCount)
+        || (ulBlockCount == 0U))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        uint32_t    ulStart = ulBlockStart;
+        uint32_t    ulCount = REDMIN(ulBlockCount, REDCONF_READ_AHEAD);
+        uint32_t    ulIdx;
+        uint8_t     bIdx;
+        uint8_t     bRunStart = 0U;
+        uint32_t    ulRunLen = 0U;
+
+        while((ulCount > 0U) && BufferFind(ulStart, &bIdx))
+        {
+            ulStart++;
+            ulCount--;
+        }
+
+        for(ulIdx = 1U; ulIdx < ulCount; ulIdx++)
+        {
+            if(BufferFind(ulStart + ulIdx, &bIdx))
+            {
+                ulCount = ulIdx;
+                break;
+            }
+        }
+
+        /*  Find the first run of adjacent buffers which may be repurposed and
+            is long enough for the whole range; failing that, use the longest
+            such run.
+        */
+        if(ulCount >= 2U)
+        {
+            uint8_t     bCurStart = 0U;
+            uint32_t    ulCurLen = 0U;
+
+            for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
             {
-                if(pHead->bRefCount == 0U)
+                const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+                if(    (pHead->bRefCount == 0U)
+                    && (    (pHead->ulBlock == BBLK_INVALID)
+                         || ((pHead->uFlags & (uint16_t)((uint32_t)BFLAG_DIRTY | BFLAG_META)) == 0U)))
                 {
-                    pHead->ulBlock = BBLK_INVALID;
+                    if(ulCurLen == 0U)
+                    {
+                        bCurStart = bIdx;
+                    }
+
+                    ulCurLen++;
 
-                    BufferMakeLRU(bIdx);
+                    if(ulCurLen > ulRunLen)
+                    {
+                        bRunStart = bCurStart;
+                        ulRunLen = ulCurLen;
+
+                        if(ulRunLen == ulCount)
+                        {
+                            break;
+                        }
+                    }
                 }
                 else
                 {
-                    /*  This should never happen.  There are three general cases
-                        when this function is used:
-
-                        1) Discarding every block, as happens during unmount
-                           and at the end of format.  There should no longer be
-                           any referenced buffers at those points.
-                        2) Discarding a block which has become free.  All
-                           buffers for such blocks should be put or branched
-                           beforehand.
-                        3) Discarding of blocks that were just written straight
-                           to disk, leaving stale data in the buffer.  The write
-                           code should never reference buffers for these blocks,
-                           since they would not be needed or used.
-                    */
-                    CRITICAL_ERROR();
-                    ret = -RED_EBUSY;
-                    break;
+                    ulCurLen = 0U;
+                }
+            }
+
+            ulCount = REDMIN(ulCount, ulRunLen);
+        }
+
+        if(ulCount >= 2U)
+        {
+            for(ulIdx = 0U; ulIdx < ulCount; ulIdx++)
+            {
+                bIdx = (uint8_t)(bRunStart + ulIdx);
+                BufferSetBlock(bIdx, gBufCtx.aHead[bIdx].bVolNum, BBLK_INVALID);
+            }
+
+            /*  The buffers in the run are adjacent rows of the aabBuffer array,
+                so they can be read into as one contiguous region.
+            */
+            ret = RedIoRead(gbRedVolNum, ulStart, ulCount, gBufCtx.b.aabBuffer[bRunStart]);
+
+            if(ret == 0)
+            {
+                for(ulIdx = 0U; ulIdx < ulCount; ulIdx++)
+                {
+                    bIdx = (uint8_t)(bRunStart + ulIdx);
+                    BufferSetBlock(bIdx, gbRedVolNum, ulStart + ulIdx);
+                    gBufCtx.aHead[bIdx].uFlags = 0U;
+                    BufferMakeMRU(bIdx);
+                }
+            }
+            else
+            {
+                for(ulIdx = 0U; ulIdx < ulCount; ulIdx++)
+                {
+                    BufferMakeLRU((uint8_t)(bRunStart + ulIdx));
                 }
             }
         }
@@ -606,6 +1040,7 @@ REDSTATUS RedBufferDiscardRange(
 
     return ret;
 }
+#endif /* REDCONF_READ_AHEAD > 0U */
 
 
 /** Determine whether a metadata buffer is valid.
@@ -799,6 +1234,13 @@ static REDSTATUS BufferWrite(
             BufferEndianSwap(gBufCtx.b.aabBuffer[bIdx], pHead->uFlags);
           #endif
         }
+
+      #if REDCONF_STATS == 1
+        if(ret == 0)
+        {
+            gaRedIoStats[pHead->bVolNum].ullBufferWrites++;
+        }
+      #endif
     }
     else
     {
@@ -810,6 +1252,81 @@ static REDSTATUS BufferWrite(
 }
 
 
+#if REDCONF_WRITE_COALESCE > 1U
+/** @brief Write out a run of dirty buffers for adjacent blocks.
+
+    The buffers are finalized and copied into a staging area, which is then
+    written with a single I/O request.
+
+    @param pabIdx   Array of indexes of the buffers to write, in block order.
+                    The buffers must be for adjacent blocks on the same volume.
+    @param ulCount  The number of buffers in @p pabIdx.  Must not exceed
+                    REDCONF_WRITE_COALESCE.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EINVAL Invalid parameters.
+*/
+static REDSTATUS BufferWriteRun(
+    const uint8_t  *pabIdx,
+    uint32_t        ulCount)
+{
+    REDSTATUS       ret = 0;
+
+    if((pabIdx == NULL) || (ulCount == 0U) || (ulCount > REDCONF_WRITE_COALESCE))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        const BUFFERHEAD   *pFirst = &gBufCtx.aHead[pabIdx[0U]];
+        uint32_t            ulIdx;
+
+        for(ulIdx = 0U; (ret == 0) && (ulIdx < ulCount); ulIdx++)
+        {
+            uint8_t             bIdx = pabIdx[ulIdx];
+            const BUFFERHEAD   *pHead = &gBufCtx.aHead[bIdx];
+
+            REDASSERT((pHead->uFlags & BFLAG_DIRTY) != 0U);
+            REDASSERT(pHead->bVolNum == pFirst->bVolNum);
+            REDASSERT(pHead->ulBlock == (pFirst->ulBlock + ulIdx));
+
+            if((pHead->uFlags & BFLAG_META) != 0U)
+            {
+                ret = BufferFinalize(gBufCtx.b.aabBuffer[bIdx], pHead->uFlags);
+            }
+
+            if(ret == 0)
+            {
+                RedMemCpy(gCoalesce.aabBuffer[ulIdx], gBufCtx.b.aabBuffer[bIdx], REDCONF_BLOCK_SIZE);
+
+              #ifdef REDCONF_ENDIAN_SWAP
+                BufferEndianSwap(gBufCtx.b.aabBuffer[bIdx], pHead->uFlags);
+              #endif
+            }
+        }
+
+        if(ret == 0)
+        {
+            ret = RedIoWrite(pFirst->bVolNum, pFirst->ulBlock, ulCount, gCoalesce.aabBuffer[0U]);
+        }
+
+      #if REDCONF_STATS == 1
+        if(ret == 0)
+        {
+            gaRedIoStats[pFirst->bVolNum].ullBufferWrites += ulCount;
+        }
+      #endif
+    }
+
+    return ret;
+}
+#endif /* REDCONF_WRITE_COALESCE > 1U */
+
+
 /** @brief Finalize a metadata buffer.
 
     This updates the CRC and the sequence number.  It also sets the signature,
@@ -1011,8 +1528,6 @@ static void BufferEndianSwapInode(
     }
     else
     {
-        uint32_t ulIdx;
-
         pInode->ullSize = RedRev64(pInode->ullSize);
 
       #if REDCONF_INODE_BLOCKS == 1
@@ -1035,10 +1550,8 @@ static void BufferEndianSwapInode(
         pInode->ulPInode = RedRev32(pInode->ulPInode);
       #endif
 
-        for(ulIdx = 0; ulIdx < INODE_ENTRIES; ulIdx++)
-        {
-            pInode->aulEntries[ulIdx] = RedRev32(pInode->aulEntries[ulIdx]);
-        }
+        /*  The entries are swapped on access; see NODE_ENTRY_GET().
+        */
     }
 }
 
@@ -1057,14 +1570,10 @@ static void BufferEndianSwapIndir(
     }
     else
     {
-        uint32_t ulIdx;
-
         pIndir->ulInode = RedRev32(pIndir->ulInode);
 
-        for(ulIdx = 0; ulIdx < INDIR_ENTRIES; ulIdx++)
-        {
-            pIndir->aulEntries[ulIdx] = RedRev32(pIndir->aulEntries[ulIdx]);
-        }
+        /*  The entries are swapped on access; see NODE_ENTRY_GET().
+        */
     }
 }
 
@@ -1072,6 +1581,97 @@ static void BufferEndianSwapIndir(
 #endif /* #ifdef REDCONF_ENDIAN_SWAP */
 
 
+#if REDCONF_BUFFER_LRU_LIST == 1
+/** @brief Mark a buffer as least recently used.
+
+    @param bIdx The index of the buffer to make LRU.
+*/
+static void BufferMakeLRU(
+    uint8_t bIdx)
+{
+    if(bIdx >= REDCONF_BUFFER_COUNT)
+    {
+        REDERROR();
+    }
+    else if(bIdx != gBufCtx.bLRU)
+    {
+        BufferUnlink(bIdx);
+
+        gBufCtx.abNewer[bIdx] = gBufCtx.bLRU;
+        gBufCtx.abOlder[bIdx] = BIDX_INVALID;
+        gBufCtx.abOlder[gBufCtx.bLRU] = bIdx;
+        gBufCtx.bLRU = bIdx;
+    }
+    else
+    {
+        /*  Buffer already LRU, nothing to do.
+        */
+    }
+}
+
+
+/** @brief Mark a buffer as most recently used.
+
+    @param bIdx The index of the buffer to make MRU.
+*/
+static void BufferMakeMRU(
+    uint8_t bIdx)
+{
+    if(bIdx >= REDCONF_BUFFER_COUNT)
+    {
+        REDERROR();
+    }
+    else if(bIdx != gBufCtx.bMRU)
+    {
+        BufferUnlink(bIdx);
+
+        gBufCtx.abOlder[bIdx] = gBufCtx.bMRU;
+        gBufCtx.abNewer[bIdx] = BIDX_INVALID;
+        gBufCtx.abNewer[gBufCtx.bMRU] = bIdx;
+        gBufCtx.bMRU = bIdx;
+    }
+    else
+    {
+        /*  Buffer already MRU, nothing to do.
+        */
+    }
+}
+
+
+/** @brief Remove a buffer from the MRU list.
+
+    The caller is responsible for reinserting the buffer into the list.  Since
+    there is more than one buffer, the list is never left empty.
+
+    @param bIdx The index of the buffer to remove from the list.
+*/
+static void BufferUnlink(
+    uint8_t     bIdx)
+{
+    uint8_t     bNewer = gBufCtx.abNewer[bIdx];
+    uint8_t     bOlder = gBufCtx.abOlder[bIdx];
+
+    if(bNewer == BIDX_INVALID)
+    {
+        gBufCtx.bMRU = bOlder;
+    }
+    else
+    {
+        gBufCtx.abOlder[bNewer] = bOlder;
+    }
+
+    if(bOlder == BIDX_INVALID)
+    {
+        gBufCtx.bLRU = bNewer;
+    }
+    else
+    {
+        gBufCtx.abNewer[bOlder] = bNewer;
+    }
+}
+
+#else
+
 /** @brief Mark a buffer as least recently used.
 
     @param bIdx The index of the buffer to make LRU.
@@ -1167,6 +1767,52 @@ static void BufferMakeMRU(
     }
 }
 
+#endif /* REDCONF_BUFFER_LRU_LIST == 1 */
+
+
+/** @brief Discard a buffer, marking it invalid.
+
+    @param bIdx The index of the buffer to discard.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBUSY  The buffer is referenced.
+*/
+static REDSTATUS BufferDiscard(
+    uint8_t     bIdx)
+{
+    BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+    REDSTATUS   ret = 0;
+
+    if(pHead->bRefCount == 0U)
+    {
+        BufferSetBlock(bIdx, pHead->bVolNum, BBLK_INVALID);
+
+        BufferMakeLRU(bIdx);
+    }
+    else
+    {
+        /*  This should never happen.  There are three general cases when
+            RedBufferDiscardRange() is used:
+
+            1) Discarding every block, as happens during unmount and at the end
+               of format.  There should no longer be any referenced buffers at
+               those points.
+            2) Discarding a block which has become free.  All buffers for such
+               blocks should be put or branched beforehand.
+            3) Discarding of blocks that were just written straight to disk,
+               leaving stale data in the buffer.  The write code should never
+               reference buffers for these blocks, since they would not be
+               needed or used.
+        */
+        CRITICAL_ERROR();
+        ret = -RED_EBUSY;
+    }
+
+    return ret;
+}
+
 
 /** @brief Find a block in the buffers.
 
@@ -1192,6 +1838,23 @@ static bool BufferFind(
     }
     else
     {
+      #if REDCONF_BUFFER_HASH == 1
+        uint8_t bIdx = gBufCtx.abHashHead[BufferHash(gbRedVolNum, ulBlock)];
+
+        while(bIdx != BIDX_INVALID)
+        {
+            const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+            if((pHead->bVolNum == gbRedVolNum) && (pHead->ulBlock == ulBlock))
+            {
+                *pbIdx = bIdx;
+                ret = true;
+                break;
+            }
+
+            bIdx = gBufCtx.abHashNext[bIdx];
+        }
+      #else
         uint8_t bIdx;
 
         for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
@@ -1205,8 +1868,165 @@ static bool BufferFind(
                 break;
             }
         }
+      #endif
     }
 
     return ret;
 }
 
+
+#if REDCONF_BUFFER_DATA_MAX > 0U
+/** @brief Find a file data buffer to replace, if file data has all the buffers
+           it is allowed.
+
+    @param pbIdx    If true is returned, populated with the index of the least
+                    recently used file data buffer which is not referenced.
+
+    Directory data blocks (BFLAG_DIRECTORY) are not counted as file data.
+
+    @return Whether at least #REDCONF_BUFFER_DATA_MAX buffers hold file data,
+            and one of them can be replaced.
+*/
+static bool BufferFindDataVictim(
+    uint8_t    *pbIdx)
+{
+    bool        fFound = false;
+    uint32_t    ulDataCount = 0U;
+    uint8_t     bIdx;
+
+    for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
+    {
+        const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+        if((pHead->ulBlock != BBLK_INVALID) && ((pHead->uFlags & (uint16_t)((uint32_t)BFLAG_META | BFLAG_DIRECTORY)) == 0U))
+        {
+            ulDataCount++;
+        }
+    }
+
+    if(ulDataCount >= REDCONF_BUFFER_DATA_MAX)
+    {
+      #if REDCONF_BUFFER_LRU_LIST == 1
+        bIdx = gBufCtx.bLRU;
+
+        while(bIdx != BIDX_INVALID)
+        {
+            const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+            if((pHead->bRefCount == 0U) && (pHead->ulBlock != BBLK_INVALID) && ((pHead->uFlags & (uint16_t)((uint32_t)BFLAG_META | BFLAG_DIRECTORY)) == 0U))
+            {
+                *pbIdx = bIdx;
+                fFound = true;
+                break;
+            }
+
+            bIdx = gBufCtx.abNewer[bIdx];
+        }
+      #else
+        uint8_t bMruIdx = REDCONF_BUFFER_COUNT;
+
+        while(bMruIdx > 0U)
+        {
+            const BUFFERHEAD *pHead;
+
+            bMruIdx--;
+            bIdx = gBufCtx.abMRU[bMruIdx];
+            pHead = &gBufCtx.aHead[bIdx];
+
+            if((pHead->bRefCount == 0U) && (pHead->ulBlock != BBLK_INVALID) && ((pHead->uFlags & (uint16_t)((uint32_t)BFLAG_META | BFLAG_DIRECTORY)) == 0U))
+            {
+                *pbIdx = bIdx;
+                fFound = true;
+                break;
+            }
+        }
+      #endif
+    }
+
+    return fFound;
+}
+#endif /* REDCONF_BUFFER_DATA_MAX > 0U */
+
+
+/** @brief Change the block associated with a buffer.
+
+    All changes to the block number or volume number of a buffer head must go
+    through this function, so that the hash index (if enabled) remains
+    consistent with the buffer heads.
+
+    @param bIdx     The index of the buffer to update.
+    @param bVolNum  The volume number for the buffer.
+    @param ulBlock  The new block number for the buffer; or BBLK_INVALID to
+                    mark the buffer as unused.
+*/
+static void BufferSetBlock(
+    uint8_t     bIdx,
+    uint8_t     bVolNum,
+    uint32_t    ulBlock)
+{
+    if(bIdx >= REDCONF_BUFFER_COUNT)
+    {
+        REDERROR();
+    }
+    else
+    {
+        BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+      #if REDCONF_BUFFER_HASH == 1
+        if(pHead->ulBlock != BBLK_INVALID)
+        {
+            uint8_t *pbLink = &gBufCtx.abHashHead[BufferHash(pHead->bVolNum, pHead->ulBlock)];
+
+            /*  Unlink the buffer from the chain for its old block.
+            */
+            while((*pbLink != bIdx) && (*pbLink != BIDX_INVALID))
+            {
+                pbLink = &gBufCtx.abHashNext[*pbLink];
+            }
+
+            REDASSERT(*pbLink == bIdx);
+
+            if(*pbLink == bIdx)
+            {
+                *pbLink = gBufCtx.abHashNext[bIdx];
+            }
+
+            gBufCtx.abHashNext[bIdx] = BIDX_INVALID;
+        }
+      #endif
+
+        pHead->bVolNum = bVolNum;
+        pHead->ulBlock = ulBlock;
+
+      #if REDCONF_BUFFER_HASH == 1
+        if(ulBlock != BBLK_INVALID)
+        {
+            uint32_t ulBucket = BufferHash(bVolNum, ulBlock);
+
+            gBufCtx.abHashNext[bIdx] = gBufCtx.abHashHead[ulBucket];
+            gBufCtx.abHashHead[ulBucket] = bIdx;
+        }
+      #endif
+    }
+}
+
+
+#if REDCONF_BUFFER_HASH == 1
+/** @brief Compute the hash bucket for a block.
+
+    Block numbers are used almost directly: metadata and data blocks tend to be
+    spread across the volume, and sequential blocks land in adjacent buckets.
+
+    @param bVolNum  The volume number of the block.
+    @param ulBlock  The block number.
+
+    @return The index of the hash bucket for the block.
+*/
+static uint32_t BufferHash(
+    uint8_t     bVolNum,
+    uint32_t    ulBlock)
+{
+    return (ulBlock + bVolNum) & BUFFER_HASH_MASK;
+}
+#endif
+
@@ -52,9 +52,28 @@ static REDSTATUS CoreRename(uint32_t ulSrcPInode, const char *pszSrcName, uint32
 #if REDCONF_READ_ONLY == 0
 static REDSTATUS CoreFileWrite(uint32_t ulInode, uint64_t ullStart, uint32_t *pulLen, const void *pBuffer);
 #endif
+#if WRITEV_SUPPORTED
+static REDSTATUS CoreFileWriteV(uint32_t ulInode, uint64_t ullStart, const REDIOVEC *paIov, uint32_t ulIovCount, uint32_t *pulLen);
+#endif
+#if COPYFILE_SUPPORTED
+static REDSTATUS CoreFileCopy(uint32_t ulSrcInode, uint64_t ullSrcStart, uint32_t ulDstInode, uint64_t ullDstStart, uint32_t *pulLen);
+#endif
 #if TRUNCATE_SUPPORTED
 static REDSTATUS CoreFileTruncate(uint32_t ulInode, uint64_t ullSize);
 #endif
+#if FALLOCATE_SUPPORTED
+static REDSTATUS CoreFileAllocate(uint32_t ulInode, uint64_t ullStart, uint64_t ullLen);
+#endif
+#if REDCONF_READ_ONLY == 0
+static REDSTATUS CoreAutoTransact(uint32_t ulBytes);
+static bool CoreVolFullRetry(void);
+#endif
+#if REDCONF_API_POSIX == 1
+static void CoreStatFill(uint32_t ulInode, const INODEMETA *pMeta, REDSTAT *pStat);
+#endif
+#if (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_READDIR == 1)
+static REDSTATUS CoreDirReadBatch(CINODE *pInode, uint32_t *pulPos, REDDIRENT *paDirEnt, uint32_t ulMax, bool fStat, bool fSnapshot, uint32_t *pulCount);
+#endif
 
 
 VOLUME gaRedVolume[REDCONF_VOLUME_COUNT];
@@ -67,6 +86,19 @@ METAROOT       *gpRedMR = &gaCoreVol[0U].aMR[0U];
 
 CONST_IF_ONE_VOLUME uint8_t gbRedVolNum = 0;
 
+#if REDCONF_READ_MAP > 0U
+/** @brief A read map handed out by RedCoreFileReadMap().
+*/
+typedef struct
+{
+    const uint8_t  *pbBlock;    /**< Mapped block; NULL if the entry is unused. */
+    const uint8_t  *pbData;     /**< The pointer given to the caller, within pbBlock. */
+    bool            fPinned;    /**< Whether pbBlock is a pinned block buffer. */
+} READMAP;
+
+static READMAP gaReadMap[REDCONF_READ_MAP];
+#endif
+
 
 /** @brief Initialize the Reliance Edge file system driver.
 
@@ -102,6 +134,12 @@ REDSTATUS RedCoreInit(void)
 
     RedMemSet(gaRedVolume, 0U, sizeof(gaRedVolume));
     RedMemSet(gaCoreVol, 0U, sizeof(gaCoreVol));
+  #if REDCONF_STATS == 1
+    RedMemSet(gaRedIoStats, 0U, sizeof(gaRedIoStats));
+  #endif
+  #if REDCONF_READ_MAP > 0U
+    RedMemSet(gaReadMap, 0U, sizeof(gaReadMap));
+  #endif
 
     RedBufferInit();
 
@@ -169,6 +207,9 @@ REDSTATUS RedCoreInit(void)
               #if REDCONF_READ_ONLY == 0
                 pVol->ulTransMask = REDCONF_TRANSACT_DEFAULT;
               #endif
+              #if (REDCONF_READ_ONLY == 0) && (REDCONF_ATIME == 1)
+                pVol->ulRelatimeAge = REDCONF_RELATIME_DEFAULT;
+              #endif
 
                 pVol->ullMaxInodeSize = INODE_SIZE_MAX;
 
@@ -414,6 +455,13 @@ REDSTATUS RedCoreVolUnmount(void)
 {
     REDSTATUS ret = 0;
 
+  #if SNAPSHOT_SUPPORTED
+    /*  Unmounting releases the snapshot, if one is pinned.
+    */
+    gpRedCoreVol->fSnapshot = false;
+    gpRedCoreVol->fSnapshotTransact = false;
+  #endif
+
   #if REDCONF_READ_ONLY == 0
     if(!gpRedVolume->fReadOnly && ((gpRedVolume->ulTransMask & RED_TRANSACT_UMOUNT) != 0U))
     {
@@ -454,6 +502,8 @@ REDSTATUS RedCoreVolUnmount(void)
     @return A negated ::REDSTATUS code indicating the operation result.
 
     @retval 0           Operation was successful.
+    @retval -RED_EBUSY  A snapshot is pinned; the transaction point will be
+                        committed when it is released.
     @retval -RED_EINVAL The volume is not mounted.
     @retval -RED_EIO    A disk I/O error occurred.
     @retval -RED_EROFS  The file system volume is read-only.
@@ -462,6 +512,93 @@ REDSTATUS RedCoreVolTransact(void)
 {
     REDSTATUS ret;
 
+    if(!gpRedVolume->fMounted)
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(gpRedVolume->fReadOnly)
+    {
+        ret = -RED_EROFS;
+    }
+  #if SNAPSHOT_SUPPORTED
+    else if(gpRedCoreVol->fSnapshot)
+    {
+        gpRedCoreVol->fSnapshotTransact = true;
+        ret = -RED_EBUSY;
+    }
+  #endif
+    else
+    {
+        ret = RedVolTransact();
+    }
+
+    return ret;
+}
+
+
+/** @brief Roll back to the last transaction point.
+
+    Discards the working state: the volume reverts to its committed state, as
+    if it had been unmounted without transacting and mounted again.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The volume is not mounted.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EROFS  The file system volume is read-only.
+*/
+REDSTATUS RedCoreVolRollback(void)
+{
+    REDSTATUS ret;
+
+    if(!gpRedVolume->fMounted)
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(gpRedVolume->fReadOnly)
+    {
+        ret = -RED_EROFS;
+    }
+    else
+    {
+        /*  Blocks are never written in place while they belong to the
+            committed state, so the committed state is intact on disk; only
+            the buffers and the in-memory metaroots need to be reloaded.
+        */
+        ret = RedBufferDiscardRange(0U, gpRedVolume->ulBlockCount);
+
+        if(ret == 0)
+        {
+            ret = RedVolMountMetaroot();
+        }
+
+        if(ret == 0)
+        {
+            gpRedCoreVol->fBranched = false;
+        }
+    }
+
+    return ret;
+}
+
+
+#if TRANSACT_TASK_SUPPORTED
+/** @brief Hand a transaction point to the commit task.
+
+    The transaction point is committed later, by the commit task, in a call
+    to RedCoreVolTransactAsyncCommit().
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The volume is not mounted.
+    @retval -RED_EROFS  The file system volume is read-only.
+*/
+REDSTATUS RedCoreVolTransactAsync(void)
+{
+    REDSTATUS ret;
+
     if(!gpRedVolume->fMounted)
     {
         ret = -RED_EINVAL;
@@ -471,12 +608,152 @@ REDSTATUS RedCoreVolTransact(void)
         ret = -RED_EROFS;
     }
     else
+    {
+        gpRedCoreVol->fTransactAsync = true;
+        RedOsWorkerSignal();
+        ret = 0;
+    }
+
+    return ret;
+}
+
+
+/** @brief Commit the transaction point handed to the commit task, if it has
+           not been committed already.
+
+    Called by the commit task.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBUSY  A snapshot is pinned; the transaction point will be
+                        committed when it is released.
+    @retval -RED_EINVAL The volume was unmounted without committing the
+                        transaction point.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EROFS  The file system volume is read-only.
+*/
+REDSTATUS RedCoreVolTransactAsyncCommit(void)
+{
+    REDSTATUS ret = 0;
+
+    /*  The flag is cleared by every successful transaction point, so if it is
+        clear, some other transaction point already did the work.
+    */
+    if(gpRedCoreVol->fTransactAsync)
+    {
+        ret = RedCoreVolTransact();
+    }
+
+    return ret;
+}
+#endif
+
+
+/** @brief Commit an automatic transaction point.
+
+    Called after an operation whose event is in the automatic transaction mask.
+    With group commit enabled (REDCONF_TRANSACT_GROUP_MS is nonzero), the
+    transaction is deferred while the last one was committed less than
+    REDCONF_TRANSACT_GROUP_MS milliseconds ago, and became part of the next
+    one, provided fewer than REDCONF_TRANSACT_GROUP_BYTES bytes (if nonzero)
+    have been written since.  A deferred transaction is committed by the next
+    automatic transaction outside the window, or by an explicit one, such as
+    from red_fsync() or red_transact().  While a snapshot is pinned, the
+    transaction is deferred until the snapshot is released.  With
+    #RED_TRANSACT_ASYNC in the transaction mask, the transaction is handed to
+    the commit task instead of being committed here.
+
+    @param ulBytes  The number of bytes written by the operation.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS CoreAutoTransact(
+    uint32_t    ulBytes)
+{
+    REDSTATUS   ret = 0;
+    bool        fCommit = true;
+
+  #if REDCONF_TRANSACT_GROUP_MS > 0U
+    gpRedCoreVol->ulGroupBytes += REDMIN(ulBytes, UINT32_MAX - gpRedCoreVol->ulGroupBytes);
+
+    if(RedOsTimePassed(gpRedCoreVol->tsGroupStart) < ((uint64_t)REDCONF_TRANSACT_GROUP_MS * 1000U))
+    {
+        fCommit = false;
+    }
+
+    #if REDCONF_TRANSACT_GROUP_BYTES > 0U
+    if(gpRedCoreVol->ulGroupBytes >= REDCONF_TRANSACT_GROUP_BYTES)
+    {
+        fCommit = true;
+    }
+    #endif
+  #else
+    (void)ulBytes;
+  #endif
+
+  #if SNAPSHOT_SUPPORTED
+    if(gpRedCoreVol->fSnapshot)
+    {
+        gpRedCoreVol->fSnapshotTransact = true;
+        fCommit = false;
+    }
+  #endif
+
+  #if TRANSACT_TASK_SUPPORTED
+    if(fCommit && ((gpRedVolume->ulTransMask & RED_TRANSACT_ASYNC) != 0U))
+    {
+        gpRedCoreVol->fTransactAsync = true;
+        RedOsWorkerSignal();
+        fCommit = false;
+    }
+  #endif
+
+    if(fCommit)
     {
         ret = RedVolTransact();
     }
 
     return ret;
 }
+
+
+/** @brief Determine whether to commit a transaction point and try again after
+           an operation failed because the volume is full.
+
+    That is only worthwhile if volume full automatic transaction points are
+    enabled and the transaction point would free some blocks.  With deferred
+    deletion, the blocks of all deleted files still on the orphan list are
+    freed first, so that they count.  A pinned snapshot holds off transaction
+    points, so the operation fails instead.
+
+    @return Whether to transact and retry the operation.
+*/
+static bool CoreVolFullRetry(void)
+{
+    bool fRetry = (gpRedVolume->ulTransMask & RED_TRANSACT_VOLFULL) != 0U;
+
+  #if DEFERRED_DELETE_SUPPORTED
+    if(fRetry && (gpRedMR->ulOrphanHead != INODE_INVALID))
+    {
+        fRetry = RedInodeOrphanReclaim(UINT32_MAX) == 0;
+    }
+  #endif
+
+    fRetry = fRetry && (gpRedCoreVol->ulAlmostFreeBlocks > 0U);
+
+  #if SNAPSHOT_SUPPORTED
+    if(gpRedCoreVol->fSnapshot)
+    {
+        fRetry = false;
+    }
+  #endif
+
+    return fRetry;
+}
 #endif /* REDCONF_READ_ONLY == 0 */
 
 
@@ -535,63 +812,30 @@ REDSTATUS RedCoreVolStat(
 #endif /* REDCONF_API_POSIX == 1 */
 
 
-#if (REDCONF_READ_ONLY == 0) && ((REDCONF_API_POSIX == 1) || (REDCONF_API_FSE_TRANSMASKSET == 1))
-/** @brief Update the transaction mask.
-
-    The following events are available when using the FSE API:
-
-    - #RED_TRANSACT_UMOUNT
-    - #RED_TRANSACT_WRITE
-    - #RED_TRANSACT_TRUNCATE
-    - #RED_TRANSACT_VOLFULL
-
-    The following events are available when using the POSIX-like API:
-
-    - #RED_TRANSACT_UMOUNT
-    - #RED_TRANSACT_CREAT
-    - #RED_TRANSACT_UNLINK
-    - #RED_TRANSACT_MKDIR
-    - #RED_TRANSACT_RENAME
-    - #RED_TRANSACT_LINK
-    - #RED_TRANSACT_CLOSE
-    - #RED_TRANSACT_WRITE
-    - #RED_TRANSACT_FSYNC
-    - #RED_TRANSACT_TRUNCATE
-    - #RED_TRANSACT_VOLFULL
-
-    The #RED_TRANSACT_MANUAL macro (by itself) may be used to disable all
-    automatic transaction events.  The #RED_TRANSACT_MASK macro is a bitmask of
-    all transaction flags, excluding those representing excluded functionality.
+#if REDCONF_STATS == 1
+/** @brief Query the I/O statistics of the current volume.
 
-    Attempting to enable events for excluded functionality will result in an
-    error.
+    The volume does not need to be mounted.
 
-    @param ulEventMask  A bitwise-OR'd mask of automatic transaction events to
-                        be set as the current transaction mode.
+    @param pStats   The buffer to populate with the statistics.
 
     @return A negated ::REDSTATUS code indicating the operation result.
 
     @retval 0           Operation was successful.
-    @retval -RED_EINVAL The volume is not mounted; or @p ulEventMask contains
-                        invalid bits.
-    @retval -RED_EROFS  The file system volume is read-only.
+    @retval -RED_EINVAL @p pStats is `NULL`.
 */
-REDSTATUS RedCoreTransMaskSet(
-    uint32_t  ulEventMask)
+REDSTATUS RedCoreVolStats(
+    REDIOSTATS *pStats)
 {
-    REDSTATUS ret;
+    REDSTATUS   ret;
 
-    if(!gpRedVolume->fMounted || ((ulEventMask & RED_TRANSACT_MASK) != ulEventMask))
+    if(pStats == NULL)
     {
         ret = -RED_EINVAL;
     }
-    else if(gpRedVolume->fReadOnly)
-    {
-        ret = -RED_EROFS;
-    }
     else
     {
-        gpRedVolume->ulTransMask = ulEventMask;
+        *pStats = gaRedIoStats[gbRedVolNum];
         ret = 0;
     }
 
@@ -600,37 +844,33 @@ REDSTATUS RedCoreTransMaskSet(
 #endif
 
 
-#if (REDCONF_API_POSIX == 1) || (REDCONF_API_FSE_TRANSMASKGET == 1)
-/** @brief Read the transaction mask.
-
-    If the volume is read-only, the returned event mask is always zero.
+#if SCRUB_SUPPORTED
+/** @brief Verify part of the current volume.
 
-    @param pulEventMask Populated with a bitwise-OR'd mask of automatic
-                        transaction events which represent the current
-                        transaction mode for the volume.
+    @param pScrub           The scrub progress, updated on return.  Zero it to
+                            start a new scrub.
+    @param ulMaxMicrosecs   The time slice, in microseconds.
 
     @return A negated ::REDSTATUS code indicating the operation result.
 
     @retval 0           Operation was successful.
-    @retval -RED_EINVAL The volume is not mounted; or @p pulEventMask is `NULL`.
+    @retval -RED_EINVAL Volume is not mounted; or @p pScrub is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred, or a metadata node is
+                        corrupt.
 */
-REDSTATUS RedCoreTransMaskGet(
-    uint32_t *pulEventMask)
+REDSTATUS RedCoreVolScrub(
+    REDSCRUB   *pScrub,
+    uint32_t    ulMaxMicrosecs)
 {
-    REDSTATUS ret;
+    REDSTATUS   ret;
 
-    if(!gpRedVolume->fMounted || (pulEventMask == NULL))
+    if((pScrub == NULL) || (!gpRedVolume->fMounted))
     {
         ret = -RED_EINVAL;
     }
     else
     {
-      #if REDCONF_READ_ONLY == 1
-        *pulEventMask = 0U;
-      #else
-        *pulEventMask = gpRedVolume->ulTransMask;
-      #endif
-        ret = 0;
+        ret = RedVolScrub(pScrub, ulMaxMicrosecs);
     }
 
     return ret;
@@ -638,40 +878,33 @@ REDSTATUS RedCoreTransMaskGet(
 #endif
 
 
-#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
-/** @brief Create a file or directory.
+#if DEFERRED_DELETE_SUPPORTED
+/** @brief Free some of the blocks of deleted files on the current volume.
 
-    @param ulPInode The inode number of the parent directory.
-    @param pszName  A null-terminated name for the new inode.
-    @param fDir     Whether to create a directory (true) or file (false).
-    @param pulInode On successful return, populated with the inode number of the
-                    new file or directory.
+    Large files which are deleted are put on an orphan list rather than being
+    freed as part of the unlink, see RedInodeDelete().  This frees a bounded
+    number of their blocks, and can be called repeatedly, such as from a low
+    priority task, until the list is empty.  If unlink automatic transaction
+    points are enabled, one is committed if any blocks were freed.
+
+    @param ulMaxBlocks  The maximum number of blocks to free.
+    @param pfMore       Populated with whether any deleted files remain to be
+                        reclaimed.
 
     @return A negated ::REDSTATUS code indicating the operation result.
 
-    @retval 0                   Operation was successful.
-    @retval -RED_EINVAL         The volume is not mounted; or @p pszName is not
-                                a valid name; or @p pulInode is `NULL`.
-    @retval -RED_EIO            A disk I/O error occurred.
-    @retval -RED_EROFS          The file system volume is read-only.
-    @retval -RED_ENOTDIR        @p ulPInode is not a directory.
-    @retval -RED_EBADF          @p ulPInode is not a valid inode.
-    @retval -RED_ENOSPC         There is not enough space on the volume to
-                                createthe new directory entry; or the directory
-                                is full.
-    @retval -RED_ENFILE         No available inode slots.
-    @retval -RED_ENAMETOOLONG   @p pszName is too long.
-    @retval -RED_EEXIST         @p pszName already exists in @p ulPInode.
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The volume is not mounted; or @p pfMore is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EROFS  The file system volume is read-only.
 */
-REDSTATUS RedCoreCreate(
-    uint32_t    ulPInode,
-    const char *pszName,
-    bool        fDir,
-    uint32_t   *pulInode)
+REDSTATUS RedCoreVolReclaim(
+    uint32_t    ulMaxBlocks,
+    bool       *pfMore)
 {
-    REDSTATUS   ret;
+    REDSTATUS   ret = 0;
 
-    if(!gpRedVolume->fMounted)
+    if((pfMore == NULL) || (!gpRedVolume->fMounted))
     {
         ret = -RED_EINVAL;
     }
@@ -681,11 +914,287 @@ REDSTATUS RedCoreCreate(
     }
     else
     {
-        ret = CoreCreate(ulPInode, pszName, fDir, pulInode);
-
-        if(    (ret == -RED_ENOSPC)
-            && ((gpRedVolume->ulTransMask & RED_TRANSACT_VOLFULL) != 0U)
-            && (gpRedCoreVol->ulAlmostFreeBlocks > 0U))
+        if(gpRedMR->ulOrphanHead != INODE_INVALID)
+        {
+            ret = RedInodeOrphanReclaim(ulMaxBlocks);
+
+            if((ret == 0) && ((gpRedVolume->ulTransMask & RED_TRANSACT_UNLINK) != 0U))
+            {
+                ret = CoreAutoTransact(0U);
+            }
+        }
+
+        *pfMore = gpRedMR->ulOrphanHead != INODE_INVALID;
+    }
+
+    return ret;
+}
+#endif
+
+
+#if SNAPSHOT_SUPPORTED
+/** @brief Pin or release a snapshot of the current volume.
+
+    Pinning commits a transaction point, and then pins the resulting committed
+    state as a snapshot which stays readable, via the RedCoreSnap*() functions,
+    until it is released.  The working state keeps changing while the snapshot
+    is pinned, but since it is never allowed to overwrite blocks of the
+    committed state, the snapshot is left intact as long as no further
+    transaction point is committed.  So until the snapshot is released,
+    automatic transaction points are deferred, explicit ones fail with
+    -RED_EBUSY, and no space is reclaimed from the snapshot when the volume is
+    full.  Releasing the snapshot commits the transaction points which were
+    held off, if any.
+
+    @param fPin Whether to pin a snapshot (true) or release it (false).
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBUSY  @p fPin is true and a snapshot is already pinned.
+    @retval -RED_EINVAL The volume is not mounted; or @p fPin is false and no
+                        snapshot is pinned.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedCoreVolSnapshot(
+    bool        fPin)
+{
+    REDSTATUS   ret = 0;
+
+    if(!gpRedVolume->fMounted)
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(fPin)
+    {
+        if(gpRedCoreVol->fSnapshot)
+        {
+            ret = -RED_EBUSY;
+        }
+        else
+        {
+            if(!gpRedVolume->fReadOnly)
+            {
+                ret = RedVolTransact();
+            }
+
+            if(ret == 0)
+            {
+                gpRedCoreVol->fSnapshot = true;
+                gpRedCoreVol->fSnapshotTransact = false;
+            }
+        }
+    }
+    else if(!gpRedCoreVol->fSnapshot)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        gpRedCoreVol->fSnapshot = false;
+
+        if(gpRedCoreVol->fSnapshotTransact)
+        {
+            gpRedCoreVol->fSnapshotTransact = false;
+            ret = RedVolTransact();
+        }
+    }
+
+    return ret;
+}
+#endif
+
+
+#if (REDCONF_READ_ONLY == 0) && ((REDCONF_API_POSIX == 1) || (REDCONF_API_FSE_TRANSMASKSET == 1))
+/** @brief Update the transaction mask.
+
+    The following events are available when using the FSE API:
+
+    - #RED_TRANSACT_UMOUNT
+    - #RED_TRANSACT_WRITE
+    - #RED_TRANSACT_TRUNCATE
+    - #RED_TRANSACT_VOLFULL
+
+    The following events are available when using the POSIX-like API:
+
+    - #RED_TRANSACT_UMOUNT
+    - #RED_TRANSACT_CREAT
+    - #RED_TRANSACT_UNLINK
+    - #RED_TRANSACT_MKDIR
+    - #RED_TRANSACT_RENAME
+    - #RED_TRANSACT_LINK
+    - #RED_TRANSACT_CLOSE
+    - #RED_TRANSACT_WRITE
+    - #RED_TRANSACT_FSYNC
+    - #RED_TRANSACT_TRUNCATE
+    - #RED_TRANSACT_VOLFULL
+
+    The #RED_TRANSACT_MANUAL macro (by itself) may be used to disable all
+    automatic transaction events.  The #RED_TRANSACT_MASK macro is a bitmask of
+    all transaction flags, excluding those representing excluded functionality.
+
+    Attempting to enable events for excluded functionality will result in an
+    error.
+
+    @param ulEventMask  A bitwise-OR'd mask of automatic transaction events to
+                        be set as the current transaction mode.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The volume is not mounted; or @p ulEventMask contains
+                        invalid bits.
+    @retval -RED_EROFS  The file system volume is read-only.
+*/
+REDSTATUS RedCoreTransMaskSet(
+    uint32_t  ulEventMask)
+{
+    REDSTATUS ret;
+
+    if(!gpRedVolume->fMounted || ((ulEventMask & RED_TRANSACT_MASK) != ulEventMask))
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(gpRedVolume->fReadOnly)
+    {
+        ret = -RED_EROFS;
+    }
+    else
+    {
+        gpRedVolume->ulTransMask = ulEventMask;
+        ret = 0;
+    }
+
+    return ret;
+}
+#endif
+
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_ATIME == 1)
+/** @brief Set the relatime age for the mounted volume.
+
+    With an age of zero (strict mode), every read of a file or directory
+    updates its access time, which branches the inode and dirties metadata
+    even for read-only workloads.  With a nonzero age, a read updates the
+    access time only if the access time is not newer than the modification or
+    change time, or if it is at least @p ulMaxAge seconds old.  An age of
+    `UINT32_MAX` effectively limits updates to the first read after a write.
+
+    The setting is not persistent: it reverts to #REDCONF_RELATIME_DEFAULT
+    when the volume is next initialized.
+
+    @param ulMaxAge The relatime age, in seconds; zero for strict access time
+                    updates.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The volume is not mounted.
+*/
+REDSTATUS RedCoreRelatimeSet(
+    uint32_t    ulMaxAge)
+{
+    REDSTATUS   ret;
+
+    if(!gpRedVolume->fMounted)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        gpRedVolume->ulRelatimeAge = ulMaxAge;
+        ret = 0;
+    }
+
+    return ret;
+}
+#endif
+
+
+#if (REDCONF_API_POSIX == 1) || (REDCONF_API_FSE_TRANSMASKGET == 1)
+/** @brief Read the transaction mask.
+
+    If the volume is read-only, the returned event mask is always zero.
+
+    @param pulEventMask Populated with a bitwise-OR'd mask of automatic
+                        transaction events which represent the current
+                        transaction mode for the volume.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The volume is not mounted; or @p pulEventMask is `NULL`.
+*/
+REDSTATUS RedCoreTransMaskGet(
+    uint32_t *pulEventMask)
+{
+    REDSTATUS ret;
+
+    if(!gpRedVolume->fMounted || (pulEventMask == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+      #if REDCONF_READ_ONLY == 1
+        *pulEventMask = 0U;
+      #else
+        *pulEventMask = gpRedVolume->ulTransMask;
+      #endif
+        ret = 0;
+    }
+
+    return ret;
+}
+#endif
+
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
+/** @brief Create a file or directory.
+
+    @param ulPInode The inode number of the parent directory.
+    @param pszName  A null-terminated name for the new inode.
+    @param fDir     Whether to create a directory (true) or file (false).
+    @param pulInode On successful return, populated with the inode number of the
+                    new file or directory.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0                   Operation was successful.
+    @retval -RED_EINVAL         The volume is not mounted; or @p pszName is not
+                                a valid name; or @p pulInode is `NULL`.
+    @retval -RED_EIO            A disk I/O error occurred.
+    @retval -RED_EROFS          The file system volume is read-only.
+    @retval -RED_ENOTDIR        @p ulPInode is not a directory.
+    @retval -RED_EBADF          @p ulPInode is not a valid inode.
+    @retval -RED_ENOSPC         There is not enough space on the volume to
+                                createthe new directory entry; or the directory
+                                is full.
+    @retval -RED_ENFILE         No available inode slots.
+    @retval -RED_ENAMETOOLONG   @p pszName is too long.
+    @retval -RED_EEXIST         @p pszName already exists in @p ulPInode.
+*/
+REDSTATUS RedCoreCreate(
+    uint32_t    ulPInode,
+    const char *pszName,
+    bool        fDir,
+    uint32_t   *pulInode)
+{
+    REDSTATUS   ret;
+
+    if(!gpRedVolume->fMounted)
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(gpRedVolume->fReadOnly)
+    {
+        ret = -RED_EROFS;
+    }
+    else
+    {
+        ret = CoreCreate(ulPInode, pszName, fDir, pulInode);
+
+        if((ret == -RED_ENOSPC) && CoreVolFullRetry())
         {
             ret = RedVolTransact();
 
@@ -699,11 +1208,11 @@ REDSTATUS RedCoreCreate(
         {
             if(fDir && ((gpRedVolume->ulTransMask & RED_TRANSACT_MKDIR) != 0U))
             {
-                ret = RedVolTransact();
+                ret = CoreAutoTransact(0U);
             }
             else if(!fDir && ((gpRedVolume->ulTransMask & RED_TRANSACT_CREAT) != 0U))
             {
-                ret = RedVolTransact();
+                ret = CoreAutoTransact(0U);
             }
             else
             {
@@ -857,9 +1366,7 @@ REDSTATUS RedCoreLink(
     {
         ret = CoreLink(ulPInode, pszName, ulInode);
 
-        if(    (ret == -RED_ENOSPC)
-            && ((gpRedVolume->ulTransMask & RED_TRANSACT_VOLFULL) != 0U)
-            && (gpRedCoreVol->ulAlmostFreeBlocks > 0U))
+        if((ret == -RED_ENOSPC) && CoreVolFullRetry())
         {
             ret = RedVolTransact();
 
@@ -871,7 +1378,7 @@ REDSTATUS RedCoreLink(
 
         if((ret == 0) && ((gpRedVolume->ulTransMask & RED_TRANSACT_LINK) != 0U))
         {
-            ret = RedVolTransact();
+            ret = CoreAutoTransact(0U);
         }
     }
 
@@ -1033,9 +1540,7 @@ REDSTATUS RedCoreUnlink(
     {
         ret = CoreUnlink(ulPInode, pszName);
 
-        if(    (ret == -RED_ENOSPC)
-            && ((gpRedVolume->ulTransMask & RED_TRANSACT_VOLFULL) != 0U)
-            && (gpRedCoreVol->ulAlmostFreeBlocks > 0U))
+        if((ret == -RED_ENOSPC) && CoreVolFullRetry())
         {
             ret = RedVolTransact();
 
@@ -1047,7 +1552,7 @@ REDSTATUS RedCoreUnlink(
 
         if((ret == 0) && ((gpRedVolume->ulTransMask & RED_TRANSACT_UNLINK) != 0U))
         {
-            ret = RedVolTransact();
+            ret = CoreAutoTransact(0U);
         }
     }
 
@@ -1189,6 +1694,12 @@ REDSTATUS RedCoreLookup(
     {
         ret = -RED_EINVAL;
     }
+  #if REDCONF_DENTRY_CACHE > 0U
+    else if(RedDirDentryLookup(ulPInode, pszName, pulInode))
+    {
+        ret = (*pulInode == INODE_INVALID) ? -RED_ENOENT : 0;
+    }
+  #endif
     else
     {
         CINODE ino;
@@ -1285,9 +1796,7 @@ REDSTATUS RedCoreRename(
     {
         ret = CoreRename(ulSrcPInode, pszSrcName, ulDstPInode, pszDstName);
 
-        if(    (ret == -RED_ENOSPC)
-            && ((gpRedVolume->ulTransMask & RED_TRANSACT_VOLFULL) != 0U)
-            && (gpRedCoreVol->ulAlmostFreeBlocks > 0U))
+        if((ret == -RED_ENOSPC) && CoreVolFullRetry())
         {
             ret = RedVolTransact();
 
@@ -1299,7 +1808,7 @@ REDSTATUS RedCoreRename(
 
         if((ret == 0) && ((gpRedVolume->ulTransMask & RED_TRANSACT_RENAME) != 0U))
         {
-            ret = RedVolTransact();
+            ret = CoreAutoTransact(0U);
         }
     }
 
@@ -1461,48 +1970,60 @@ REDSTATUS RedCoreStat(
     }
     else
     {
-        CINODE ino;
+        INODEMETA meta;
 
-        ino.ulInode = ulInode;
-        ret = RedInodeMount(&ino, FTYPE_EITHER, false);
+        ret = RedInodeMetaGet(ulInode, FTYPE_EITHER, &meta);
         if(ret == 0)
         {
-            RedMemSet(pStat, 0U, sizeof(*pStat));
-
-            pStat->st_dev = gbRedVolNum;
-            pStat->st_ino = ulInode;
-            pStat->st_mode = ino.pInodeBuf->uMode;
-          #if REDCONF_API_POSIX_LINK == 1
-            pStat->st_nlink = ino.pInodeBuf->uNLink;
-          #else
-            pStat->st_nlink = 1U;
-          #endif
-            pStat->st_size = ino.pInodeBuf->ullSize;
-          #if REDCONF_INODE_TIMESTAMPS == 1
-            pStat->st_atime = ino.pInodeBuf->ulATime;
-            pStat->st_mtime = ino.pInodeBuf->ulMTime;
-            pStat->st_ctime = ino.pInodeBuf->ulCTime;
-          #endif
-          #if REDCONF_INODE_BLOCKS == 1
-            pStat->st_blocks = ino.pInodeBuf->ulBlocks;
-          #endif
-
-            RedInodePut(&ino, 0U);
+            CoreStatFill(ulInode, &meta, pStat);
         }
     }
 
     return ret;
 }
-#endif /* REDCONF_API_POSIX == 1 */
 
 
-#if REDCONF_API_FSE == 1
-/** @brief Get the size of a file.
+/** @brief Populate a ::REDSTAT buffer from the metadata of an inode.
 
-    @param ulInode  The inode number of the file whose size is to be retrieved.
-    @param pullSize On successful exit, populated with the file size.
+    @param ulInode  The inode number.
+    @param pMeta    The metadata of the inode.
+    @param pStat    Pointer to the ::REDSTAT buffer to populate.
+*/
+static void CoreStatFill(
+    uint32_t            ulInode,
+    const INODEMETA    *pMeta,
+    REDSTAT            *pStat)
+{
+    RedMemSet(pStat, 0U, sizeof(*pStat));
 
-    @return A negated ::REDSTATUS code indicating the operation result.
+    pStat->st_dev = gbRedVolNum;
+    pStat->st_ino = ulInode;
+    pStat->st_mode = pMeta->uMode;
+  #if REDCONF_API_POSIX_LINK == 1
+    pStat->st_nlink = pMeta->uNLink;
+  #else
+    pStat->st_nlink = 1U;
+  #endif
+    pStat->st_size = pMeta->ullSize;
+  #if REDCONF_INODE_TIMESTAMPS == 1
+    pStat->st_atime = pMeta->ulATime;
+    pStat->st_mtime = pMeta->ulMTime;
+    pStat->st_ctime = pMeta->ulCTime;
+  #endif
+  #if REDCONF_INODE_BLOCKS == 1
+    pStat->st_blocks = pMeta->ulBlocks;
+  #endif
+}
+#endif /* REDCONF_API_POSIX == 1 */
+
+
+#if REDCONF_API_FSE == 1
+/** @brief Get the size of a file.
+
+    @param ulInode  The inode number of the file whose size is to be retrieved.
+    @param pullSize On successful exit, populated with the file size.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
 
     @retval 0           Operation was successful.
     @retval -RED_EBADF  @p ulInode is not a valid inode.
@@ -1522,15 +2043,12 @@ REDSTATUS RedCoreFileSizeGet(
     }
     else
     {
-        CINODE ino;
+        INODEMETA meta;
 
-        ino.ulInode = ulInode;
-        ret = RedInodeMount(&ino, FTYPE_FILE, false);
+        ret = RedInodeMetaGet(ulInode, FTYPE_FILE, &meta);
         if(ret == 0)
         {
-            *pullSize = ino.pInodeBuf->ullSize;
-
-            RedInodePut(&ino, 0U);
+            *pullSize = meta.ullSize;
         }
     }
 
@@ -1582,16 +2100,119 @@ REDSTATUS RedCoreFileRead(
     {
       #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
         bool    fUpdateAtime = (*pulLen > 0U) && !gpRedVolume->fReadOnly;
-      #else
-        bool    fUpdateAtime = false;
       #endif
         CINODE  ino;
 
         ino.ulInode = ulInode;
-        ret = RedInodeMount(&ino, FTYPE_FILE, fUpdateAtime);
+        ret = RedInodeMount(&ino, FTYPE_FILE, false);
         if(ret == 0)
         {
-            ret = RedInodeDataRead(&ino, ullStart, pulLen, pBuffer);
+          #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
+            if(fUpdateAtime)
+            {
+                ret = RedInodeAtimeBranch(&ino, &fUpdateAtime);
+            }
+
+            if(ret == 0)
+          #endif
+            {
+                ret = RedInodeDataRead(&ino, ullStart, pulLen, pBuffer);
+            }
+
+          #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
+            RedInodePut(&ino, ((ret == 0) && fUpdateAtime) ? IPUT_UPDATE_ATIME : 0U);
+          #else
+            RedInodePut(&ino, 0U);
+          #endif
+        }
+    }
+
+    return ret;
+}
+
+
+#if REDCONF_READ_MAP > 0U
+/** @brief Map file data for reading, without copying it.
+
+    Rather than copying the data into a caller buffer, the block buffer which
+    holds it is pinned and a pointer into it is returned.  On a read-only volume
+    whose block device is memory-mapped, the pointer is into the mapping, and
+    no buffer is used.  The mapped data is a snapshot: later changes to the
+    file do not show through it.  At most one block is mapped, so the mapped
+    length is truncated at the next block boundary as well as at the
+    end-of-file.  At most #REDCONF_READ_MAP maps may be outstanding at once;
+    each must be released with RedCoreFileReadUnmap().
+
+    @param ulInode  The inode number of the file to read.
+    @param ullStart The file offset to read from.
+    @param pulLen   On entry, contains the maximum number of bytes to map; on
+                    successful exit, contains the number of bytes actually
+                    mapped.  Zero means that @p ullStart is at or beyond the
+                    end-of-file, and nothing was mapped.
+    @param ppBuffer On successful exit, if any data was mapped, populated with
+                    a read-only pointer to the data.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EBADF      @p ulInode is not a valid inode number.
+    @retval -RED_EBUSY      #REDCONF_READ_MAP maps are already outstanding.
+    @retval -RED_EINVAL     The volume is not mounted; or @p pulLen or
+                            @p ppBuffer is `NULL`.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_EISDIR     The inode is a directory inode.
+    @retval -RED_ENODATA    The data at @p ullStart is sparse, so there is no
+                            buffer to map; RedCoreFileRead() must be used.
+*/
+REDSTATUS RedCoreFileReadMap(
+    uint32_t        ulInode,
+    uint64_t        ullStart,
+    uint32_t       *pulLen,
+    const void    **ppBuffer)
+{
+    REDSTATUS       ret = 0;
+    uint32_t        ulMap;
+
+    for(ulMap = 0U; ulMap < REDCONF_READ_MAP; ulMap++)
+    {
+        if(gaReadMap[ulMap].pbBlock == NULL)
+        {
+            break;
+        }
+    }
+
+    if(!gpRedVolume->fMounted || (pulLen == NULL) || (ppBuffer == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(ulMap == REDCONF_READ_MAP)
+    {
+        ret = -RED_EBUSY;
+    }
+    else
+    {
+      #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
+        bool            fUpdateAtime = (*pulLen > 0U) && !gpRedVolume->fReadOnly;
+      #endif
+        CINODE          ino;
+        const uint8_t  *pbBlock = NULL;
+        bool            fPinned = false;
+
+        ino.ulInode = ulInode;
+        ret = RedInodeMount(&ino, FTYPE_FILE, false);
+        if(ret == 0)
+        {
+          #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
+            if(fUpdateAtime)
+            {
+                ret = RedInodeAtimeBranch(&ino, &fUpdateAtime);
+            }
+
+            if(ret == 0)
+          #endif
+            {
+                ret = RedInodeDataReadMap(&ino, ullStart, pulLen, &pbBlock, &fPinned);
+            }
 
           #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
             RedInodePut(&ino, ((ret == 0) && fUpdateAtime) ? IPUT_UPDATE_ATIME : 0U);
@@ -1599,10 +2220,59 @@ REDSTATUS RedCoreFileRead(
             RedInodePut(&ino, 0U);
           #endif
         }
+
+        if((ret == 0) && (*pulLen > 0U))
+        {
+            gaReadMap[ulMap].pbBlock = pbBlock;
+            gaReadMap[ulMap].pbData = &pbBlock[ullStart & (REDCONF_BLOCK_SIZE - 1U)];
+            gaReadMap[ulMap].fPinned = fPinned;
+            *ppBuffer = gaReadMap[ulMap].pbData;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Release file data mapped by RedCoreFileReadMap().
+
+    The volume which the data was mapped from need not be current, nor even
+    mounted.
+
+    @param pBuffer  The pointer returned by RedCoreFileReadMap().
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p pBuffer is not an outstanding read map.
+*/
+REDSTATUS RedCoreFileReadUnmap(
+    const void *pBuffer)
+{
+    REDSTATUS   ret = -RED_EINVAL;
+    uint32_t    ulMap;
+
+    if(pBuffer != NULL)
+    {
+        for(ulMap = 0U; ulMap < REDCONF_READ_MAP; ulMap++)
+        {
+            if((gaReadMap[ulMap].pbBlock != NULL) && (gaReadMap[ulMap].pbData == pBuffer))
+            {
+                if(gaReadMap[ulMap].fPinned)
+                {
+                    RedBufferUnpin(gaReadMap[ulMap].pbBlock);
+                }
+
+                gaReadMap[ulMap].pbBlock = NULL;
+                ret = 0;
+                break;
+            }
+        }
     }
 
     return ret;
 }
+#endif /* REDCONF_READ_MAP > 0U */
 
 
 #if REDCONF_READ_ONLY == 0
@@ -1662,9 +2332,7 @@ REDSTATUS RedCoreFileWrite(
     {
         ret = CoreFileWrite(ulInode, ullStart, pulLen, pBuffer);
 
-        if(    (ret == -RED_ENOSPC)
-            && ((gpRedVolume->ulTransMask & RED_TRANSACT_VOLFULL) != 0U)
-            && (gpRedCoreVol->ulAlmostFreeBlocks > 0U))
+        if((ret == -RED_ENOSPC) && CoreVolFullRetry())
         {
             ret = RedVolTransact();
 
@@ -1676,7 +2344,7 @@ REDSTATUS RedCoreFileWrite(
 
         if((ret == 0) && ((gpRedVolume->ulTransMask & RED_TRANSACT_WRITE) != 0U))
         {
-            ret = RedVolTransact();
+            ret = CoreAutoTransact(*pulLen);
         }
     }
 
@@ -1734,39 +2402,58 @@ static REDSTATUS CoreFileWrite(
 
     return ret;
 }
-#endif /* REDCONF_READ_ONLY == 0 */
 
 
-#if TRUNCATE_SUPPORTED
-/** @brief Set the file size.
+#if WRITEV_SUPPORTED
+/** @brief Write a scatter-gather list of buffers to a file.
 
-    Allows the file size to be increased, decreased, or to remain the same.  If
-    the file size is increased, the new area is sparse (will read as zeroes).
-    If the file size is decreased, the data beyond the new end-of-file will
-    return to free space once it is no longer part of the committed state
-    (either immediately or after the next transaction point).
+    The buffers are written one after another, starting at @p ullStart, with
+    the file mounted once for the whole list.  At most one automatic
+    transaction point is made, after all of the buffers have been written.
 
-    @param ulInode  The inode of the file to truncate.
-    @param ullSize  The new file size, in bytes.
+    A short write -- where the number of bytes written is less than requested
+    -- indicates either that the file system ran out of space but was still
+    able to write some of the request; or that the request would have caused
+    the file to exceed the maximum file size, but some of the data could be
+    written prior to the file size limit.
+
+    If an error is returned, either none of the data was written or a critical
+    error occurred (like an I/O error) and the file system volume will be
+    read-only.
+
+    @param ulInode      The file number of the file to write.
+    @param ullStart     The file offset to write at.
+    @param paIov        The buffers containing the data to be written.
+    @param ulIovCount   The number of entries in @p paIov.
+    @param pulLen       On successful exit, populated with the total number of
+                        bytes actually written.
 
     @return A negated ::REDSTATUS code indicating the operation result.
 
     @retval 0           Operation was successful.
-    @retval -RED_EBADF  @p ulInode is not a valid inode number.
-    @retval -RED_EFBIG  @p ullSize exceeds the maximum file size.
-    @retval -RED_EINVAL The volume is not mounted.
+    @retval -RED_EBADF  @p ulInode is not a valid file number.
+    @retval -RED_EFBIG  No data can be written to the given file offset since
+                        the resulting file size would exceed the maximum file
+                        size.
+    @retval -RED_EINVAL The volume is not mounted; or @p paIov or @p pulLen is
+                        `NULL`; or a segment with a nonzero length has a `NULL`
+                        buffer.
     @retval -RED_EIO    A disk I/O error occurred.
     @retval -RED_EISDIR The inode is a directory inode.
-    @retval -RED_ENOSPC Insufficient free space to perform the truncate.
+    @retval -RED_ENOSPC No data can be written because there is insufficient
+                        free space.
     @retval -RED_EROFS  The file system volume is read-only.
 */
-REDSTATUS RedCoreFileTruncate(
-    uint32_t    ulInode,
-    uint64_t    ullSize)
+REDSTATUS RedCoreFileWriteV(
+    uint32_t        ulInode,
+    uint64_t        ullStart,
+    const REDIOVEC *paIov,
+    uint32_t        ulIovCount,
+    uint32_t       *pulLen)
 {
-    REDSTATUS   ret;
+    REDSTATUS       ret;
 
-    if(!gpRedVolume->fMounted)
+    if((!gpRedVolume->fMounted) || (paIov == NULL) || (pulLen == NULL))
     {
         ret = -RED_EINVAL;
     }
@@ -1776,23 +2463,21 @@ REDSTATUS RedCoreFileTruncate(
     }
     else
     {
-        ret = CoreFileTruncate(ulInode, ullSize);
+        ret = CoreFileWriteV(ulInode, ullStart, paIov, ulIovCount, pulLen);
 
-        if(    (ret == -RED_ENOSPC)
-            && ((gpRedVolume->ulTransMask & RED_TRANSACT_VOLFULL) != 0U)
-            && (gpRedCoreVol->ulAlmostFreeBlocks > 0U))
+        if((ret == -RED_ENOSPC) && CoreVolFullRetry())
         {
             ret = RedVolTransact();
 
             if(ret == 0)
             {
-                ret = CoreFileTruncate(ulInode, ullSize);
+                ret = CoreFileWriteV(ulInode, ullStart, paIov, ulIovCount, pulLen);
             }
         }
 
-        if((ret == 0) && ((gpRedVolume->ulTransMask & RED_TRANSACT_TRUNCATE) != 0U))
+        if((ret == 0) && ((gpRedVolume->ulTransMask & RED_TRANSACT_WRITE) != 0U))
         {
-            ret = RedVolTransact();
+            ret = CoreAutoTransact(*pulLen);
         }
     }
 
@@ -1800,26 +2485,40 @@ REDSTATUS RedCoreFileTruncate(
 }
 
 
-/** @brief Set the file size.
+/** @brief Write a scatter-gather list of buffers to a file.
 
-    @param ulInode  The inode of the file to truncate.
-    @param ullSize  The new file size, in bytes.
+    Each buffer goes through RedInodeDataWrite(), so the block-aligned parts
+    of each buffer are written directly from the caller's memory.
+
+    @param ulInode      The file number of the file to write.
+    @param ullStart     The file offset to write at.
+    @param paIov        The buffers containing the data to be written.
+    @param ulIovCount   The number of entries in @p paIov.
+    @param pulLen       On successful exit, populated with the total number of
+                        bytes actually written.
 
     @return A negated ::REDSTATUS code indicating the operation result.
 
     @retval 0           Operation was successful.
-    @retval -RED_EBADF  @p ulInode is not a valid inode number.
-    @retval -RED_EFBIG  @p ullSize exceeds the maximum file size.
+    @retval -RED_EBADF  @p ulInode is not a valid file number.
+    @retval -RED_EFBIG  No data can be written to the given file offset since
+                        the resulting file size would exceed the maximum file
+                        size.
+    @retval -RED_EINVAL A segment with a nonzero length has a `NULL` buffer.
     @retval -RED_EIO    A disk I/O error occurred.
     @retval -RED_EISDIR The inode is a directory inode.
-    @retval -RED_ENOSPC Insufficient free space to perform the truncate.
+    @retval -RED_ENOSPC No data can be written because there is insufficient
+                        free space.
     @retval -RED_EROFS  The file system volume is read-only.
 */
-static REDSTATUS CoreFileTruncate(
-    uint32_t    ulInode,
-    uint64_t    ullSize)
+static REDSTATUS CoreFileWriteV(
+    uint32_t        ulInode,
+    uint64_t        ullStart,
+    const REDIOVEC *paIov,
+    uint32_t        ulIovCount,
+    uint32_t       *pulLen)
 {
-    REDSTATUS   ret;
+    REDSTATUS       ret;
 
     if(gpRedVolume->fReadOnly)
     {
@@ -1827,21 +2526,57 @@ static REDSTATUS CoreFileTruncate(
     }
     else
     {
-        CINODE      ino;
+        CINODE ino;
 
         ino.ulInode = ulInode;
         ret = RedInodeMount(&ino, FTYPE_FILE, true);
         if(ret == 0)
         {
-          #if RESERVED_BLOCKS > 0U
-            gpRedCoreVol->fUseReservedBlocks = (ullSize < ino.pInodeBuf->ullSize);
-          #endif
+            uint32_t ulTotal = 0U;
+            uint32_t ulCount = ulIovCount;
+            uint32_t ulIdx;
 
-            ret = RedInodeDataTruncate(&ino, ullSize);
+            for(ulIdx = 0U; ulIdx < ulCount; ulIdx++)
+            {
+                uint32_t ulLen = paIov[ulIdx].iov_len;
 
-          #if RESERVED_BLOCKS > 0U
-            gpRedCoreVol->fUseReservedBlocks = false;
-          #endif
+                if(ulLen > 0U)
+                {
+                    ret = RedInodeDataWrite(&ino, ullStart + ulTotal, &ulLen, paIov[ulIdx].iov_base);
+
+                    if(ret == 0)
+                    {
+                        ulTotal += ulLen;
+
+                        /*  Stop after a short write: the rest of the list
+                            would fail the same way.
+                        */
+                        if(ulLen < paIov[ulIdx].iov_len)
+                        {
+                            ulCount = ulIdx;
+                        }
+                    }
+                    else
+                    {
+                        /*  If earlier buffers were written, running out of
+                            space or hitting the maximum file size makes this
+                            a short write, just as it would within a single
+                            buffer.
+                        */
+                        if((ulTotal > 0U) && ((ret == -RED_ENOSPC) || (ret == -RED_EFBIG)))
+                        {
+                            ret = 0;
+                        }
+
+                        ulCount = ulIdx;
+                    }
+                }
+            }
+
+            if(ret == 0)
+            {
+                *pulLen = ulTotal;
+            }
 
             RedInodePut(&ino, (ret == 0) ? (uint8_t)(IPUT_UPDATE_MTIME | IPUT_UPDATE_CTIME) : 0U);
         }
@@ -1849,73 +2584,923 @@ static REDSTATUS CoreFileTruncate(
 
     return ret;
 }
-#endif /* TRUNCATE_SUPPORTED */
+#endif /* WRITEV_SUPPORTED */
 
 
-#if (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_READDIR == 1)
-/** @brief Read from a directory.
+#if COPYFILE_SUPPORTED
+/** @brief Copy data from one file to another.
 
-    If files are added to the directory after it is opened, the new files may
-    or may not be returned by this function.  If files are deleted, the deleted
-    files will not be returned.
+    The data is copied within the file system, without passing through a
+    caller buffer.
 
-    @param ulInode  The directory inode to read from.
-    @param pulPos   A token which stores the position within the directory.  To
-                    read from the beginning of the directory, populate with
-                    zero.
-    @param pszName  Pointer to a buffer which must be big enough to store a
-                    maximum size name, including a null terminator.  On
-                    successful exit, populated with the name of the next
-                    directory entry.
-    @param pulInode On successful return, populated with the inode number of the
-                    next directory entry.
+    @param ulSrcInode   The file number of the file to copy from.
+    @param ullSrcStart  The file offset in the source file to copy from.
+    @param ulDstInode   The file number of the file to copy to.
+    @param ullDstStart  The file offset in the destination file to copy to.
+    @param pulLen       On entry, the number of bytes to copy; on successful
+                        exit, the number of bytes actually copied.  Fewer bytes
+                        are copied if the end of the source file is reached, or
+                        if the destination file runs out of space or reaches the
+                        maximum file size.
 
     @return A negated ::REDSTATUS code indicating the operation result.
 
-    @retval 0               Operation was successful.
-    @retval -RED_EBADF      @p ulInode is not a valid inode number.
-    @retval -RED_EINVAL     The volume is not mounted.
-    @retval -RED_EIO        A disk I/O error occurred.
-    @retval -RED_ENOENT     There are no more entries in the directory.
-    @retval -RED_ENOTDIR    @p ulInode refers to a file.
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  @p ulSrcInode or @p ulDstInode is not a valid file
+                        number.
+    @retval -RED_EFBIG  No data can be copied to the given destination offset
+                        since the resulting file size would exceed the maximum
+                        file size.
+    @retval -RED_EINVAL The volume is not mounted; or @p ulSrcInode and
+                        @p ulDstInode are the same file; or @p pulLen is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EISDIR Either inode is a directory inode.
+    @retval -RED_ENOSPC No data can be copied because there is insufficient
+                        free space.
+    @retval -RED_EROFS  The file system volume is read-only.
 */
-REDSTATUS RedCoreDirRead(
-    uint32_t    ulInode,
-    uint32_t   *pulPos,
-    char       *pszName,
-    uint32_t   *pulInode)
+REDSTATUS RedCoreFileCopy(
+    uint32_t    ulSrcInode,
+    uint64_t    ullSrcStart,
+    uint32_t    ulDstInode,
+    uint64_t    ullDstStart,
+    uint32_t   *pulLen)
 {
     REDSTATUS   ret;
 
-    if(!gpRedVolume->fMounted)
+    if(!gpRedVolume->fMounted || (ulSrcInode == ulDstInode) || (pulLen == NULL))
     {
         ret = -RED_EINVAL;
     }
+    else if(gpRedVolume->fReadOnly)
+    {
+        ret = -RED_EROFS;
+    }
     else
     {
-        CINODE ino;
+        uint32_t ulLen = *pulLen;
 
-        ino.ulInode = ulInode;
-        ret = RedInodeMount(&ino, FTYPE_DIR, false);
+        ret = CoreFileCopy(ulSrcInode, ullSrcStart, ulDstInode, ullDstStart, &ulLen);
 
-        if(ret == 0)
+        if((ret == -RED_ENOSPC) && CoreVolFullRetry())
         {
-            ret = RedDirEntryRead(&ino, pulPos, pszName, pulInode);
+            ret = RedVolTransact();
 
-          #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
-            if((ret == 0) && !gpRedVolume->fReadOnly)
+            if(ret == 0)
             {
-                ret = RedInodeBranch(&ino);
+                ulLen = *pulLen;
+                ret = CoreFileCopy(ulSrcInode, ullSrcStart, ulDstInode, ullDstStart, &ulLen);
             }
+        }
 
-            RedInodePut(&ino, ((ret == 0) && !gpRedVolume->fReadOnly) ? IPUT_UPDATE_ATIME : 0U);
-          #else
-            RedInodePut(&ino, 0U);
-          #endif
+        if(ret == 0)
+        {
+            *pulLen = ulLen;
+
+            if((gpRedVolume->ulTransMask & RED_TRANSACT_WRITE) != 0U)
+            {
+                ret = CoreAutoTransact(ulLen);
+            }
         }
     }
 
     return ret;
 }
-#endif /* (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_READDIR == 1) */
+
+
+/** @brief Copy data from one file to another.
+
+    @param ulSrcInode   The file number of the file to copy from.
+    @param ullSrcStart  The file offset in the source file to copy from.
+    @param ulDstInode   The file number of the file to copy to.
+    @param ullDstStart  The file offset in the destination file to copy to.
+    @param pulLen       On entry, the number of bytes to copy; on successful
+                        exit, the number of bytes actually copied.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  @p ulSrcInode or @p ulDstInode is not a valid file
+                        number.
+    @retval -RED_EFBIG  No data can be copied to the given destination offset
+                        since the resulting file size would exceed the maximum
+                        file size.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EISDIR Either inode is a directory inode.
+    @retval -RED_ENOSPC No data can be copied because there is insufficient
+                        free space.
+*/
+static REDSTATUS CoreFileCopy(
+    uint32_t    ulSrcInode,
+    uint64_t    ullSrcStart,
+    uint32_t    ulDstInode,
+    uint64_t    ullDstStart,
+    uint32_t   *pulLen)
+{
+  #if REDCONF_ATIME == 1
+    bool        fUpdateAtime = *pulLen > 0U;
+  #endif
+    CINODE      src;
+    REDSTATUS   ret;
+
+    src.ulInode = ulSrcInode;
+    ret = RedInodeMount(&src, FTYPE_FILE, false);
+    if(ret == 0)
+    {
+        CINODE dst;
+
+      #if REDCONF_ATIME == 1
+        if(fUpdateAtime)
+        {
+            ret = RedInodeAtimeBranch(&src, &fUpdateAtime);
+        }
+
+        if(ret == 0)
+      #endif
+        {
+            dst.ulInode = ulDstInode;
+            ret = RedInodeMount(&dst, FTYPE_FILE, true);
+            if(ret == 0)
+            {
+                ret = RedInodeDataCopy(&src, ullSrcStart, &dst, ullDstStart, pulLen);
+
+                RedInodePut(&dst, (ret == 0) ? (uint8_t)(IPUT_UPDATE_MTIME | IPUT_UPDATE_CTIME) : 0U);
+            }
+        }
+
+      #if REDCONF_ATIME == 1
+        RedInodePut(&src, ((ret == 0) && fUpdateAtime) ? IPUT_UPDATE_ATIME : 0U);
+      #else
+        RedInodePut(&src, 0U);
+      #endif
+    }
+
+    return ret;
+}
+#endif /* COPYFILE_SUPPORTED */
+#endif /* REDCONF_READ_ONLY == 0 */
+
+
+#if TRUNCATE_SUPPORTED
+/** @brief Set the file size.
+
+    Allows the file size to be increased, decreased, or to remain the same.  If
+    the file size is increased, the new area is sparse (will read as zeroes).
+    If the file size is decreased, the data beyond the new end-of-file will
+    return to free space once it is no longer part of the committed state
+    (either immediately or after the next transaction point).
+
+    @param ulInode  The inode of the file to truncate.
+    @param ullSize  The new file size, in bytes.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  @p ulInode is not a valid inode number.
+    @retval -RED_EFBIG  @p ullSize exceeds the maximum file size.
+    @retval -RED_EINVAL The volume is not mounted.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EISDIR The inode is a directory inode.
+    @retval -RED_ENOSPC Insufficient free space to perform the truncate.
+    @retval -RED_EROFS  The file system volume is read-only.
+*/
+REDSTATUS RedCoreFileTruncate(
+    uint32_t    ulInode,
+    uint64_t    ullSize)
+{
+    REDSTATUS   ret;
+
+    if(!gpRedVolume->fMounted)
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(gpRedVolume->fReadOnly)
+    {
+        ret = -RED_EROFS;
+    }
+    else
+    {
+        ret = CoreFileTruncate(ulInode, ullSize);
+
+        if((ret == -RED_ENOSPC) && CoreVolFullRetry())
+        {
+            ret = RedVolTransact();
+
+            if(ret == 0)
+            {
+                ret = CoreFileTruncate(ulInode, ullSize);
+            }
+        }
+
+        if((ret == 0) && ((gpRedVolume->ulTransMask & RED_TRANSACT_TRUNCATE) != 0U))
+        {
+            ret = CoreAutoTransact(0U);
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Set the file size.
+
+    @param ulInode  The inode of the file to truncate.
+    @param ullSize  The new file size, in bytes.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  @p ulInode is not a valid inode number.
+    @retval -RED_EFBIG  @p ullSize exceeds the maximum file size.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EISDIR The inode is a directory inode.
+    @retval -RED_ENOSPC Insufficient free space to perform the truncate.
+    @retval -RED_EROFS  The file system volume is read-only.
+*/
+static REDSTATUS CoreFileTruncate(
+    uint32_t    ulInode,
+    uint64_t    ullSize)
+{
+    REDSTATUS   ret;
+
+    if(gpRedVolume->fReadOnly)
+    {
+        ret = -RED_EROFS;
+    }
+    else
+    {
+        CINODE      ino;
+
+        ino.ulInode = ulInode;
+        ret = RedInodeMount(&ino, FTYPE_FILE, true);
+        if(ret == 0)
+        {
+          #if RESERVED_BLOCKS > 0U
+            gpRedCoreVol->fUseReservedBlocks = (ullSize < ino.pInodeBuf->ullSize);
+          #endif
+
+            ret = RedInodeDataTruncate(&ino, ullSize);
+
+          #if RESERVED_BLOCKS > 0U
+            gpRedCoreVol->fUseReservedBlocks = false;
+          #endif
+
+            RedInodePut(&ino, (ret == 0) ? (uint8_t)(IPUT_UPDATE_MTIME | IPUT_UPDATE_CTIME) : 0U);
+        }
+    }
+
+    return ret;
+}
+#endif /* TRUNCATE_SUPPORTED */
+
+
+#if FALLOCATE_SUPPORTED
+/** @brief Allocate the data blocks for a range of a file.
+
+    Sparse parts of the range are allocated and zeroed.  Writes to the range
+    in the same transaction then do not have to allocate blocks.  If the range
+    extends beyond the end of the file, the file size is increased.
+
+    @param ulInode  The inode of the file.
+    @param ullStart The file offset at which the range starts.
+    @param ullLen   The length of the range, in bytes.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  @p ulInode is not a valid inode number.
+    @retval -RED_EFBIG  The range extends beyond the maximum file size.
+    @retval -RED_EINVAL The volume is not mounted.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EISDIR The inode is a directory inode.
+    @retval -RED_ENOSPC Insufficient free space to allocate the range.
+    @retval -RED_EROFS  The file system volume is read-only.
+*/
+REDSTATUS RedCoreFileAllocate(
+    uint32_t    ulInode,
+    uint64_t    ullStart,
+    uint64_t    ullLen)
+{
+    REDSTATUS   ret;
+
+    if(!gpRedVolume->fMounted)
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(gpRedVolume->fReadOnly)
+    {
+        ret = -RED_EROFS;
+    }
+    else
+    {
+        ret = CoreFileAllocate(ulInode, ullStart, ullLen);
+
+        if((ret == -RED_ENOSPC) && CoreVolFullRetry())
+        {
+            ret = RedVolTransact();
+
+            if(ret == 0)
+            {
+                ret = CoreFileAllocate(ulInode, ullStart, ullLen);
+            }
+        }
+
+        if((ret == 0) && ((gpRedVolume->ulTransMask & RED_TRANSACT_WRITE) != 0U))
+        {
+            ret = CoreAutoTransact(0U);
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Allocate the data blocks for a range of a file.
+
+    @param ulInode  The inode of the file.
+    @param ullStart The file offset at which the range starts.
+    @param ullLen   The length of the range, in bytes.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  @p ulInode is not a valid inode number.
+    @retval -RED_EFBIG  The range extends beyond the maximum file size.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EISDIR The inode is a directory inode.
+    @retval -RED_ENOSPC Insufficient free space to allocate the range.
+*/
+static REDSTATUS CoreFileAllocate(
+    uint32_t    ulInode,
+    uint64_t    ullStart,
+    uint64_t    ullLen)
+{
+    CINODE      ino;
+    REDSTATUS   ret;
+
+    ino.ulInode = ulInode;
+    ret = RedInodeMount(&ino, FTYPE_FILE, true);
+    if(ret == 0)
+    {
+        ret = RedInodeDataAllocate(&ino, ullStart, ullLen);
+
+        RedInodePut(&ino, (ret == 0) ? (uint8_t)(IPUT_UPDATE_MTIME | IPUT_UPDATE_CTIME) : 0U);
+    }
+
+    return ret;
+}
+#endif /* FALLOCATE_SUPPORTED */
+
+
+#if (REDCONF_READ_ONLY == 0) && COMPRESSION_SUPPORTED
+/** @brief Mark a file as compressed.
+
+    Data written to the file from then on is compressed, one cluster of
+    #REDCONF_COMPRESS_CLUSTER blocks at a time, wherever that saves space.
+    Data already in the file stays as it is until it is rewritten.  The mark
+    is persistent.
+
+    @param ulInode  The inode of the file.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  @p ulInode is not a valid inode number.
+    @retval -RED_EINVAL The volume is not mounted.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EISDIR The inode is a directory inode.
+    @retval -RED_ENOSPC Insufficient free space to branch the inode.
+    @retval -RED_EROFS  The file system volume is read-only.
+*/
+REDSTATUS RedCoreFileCompress(
+    uint32_t    ulInode)
+{
+    REDSTATUS   ret;
+
+    if(!gpRedVolume->fMounted)
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(gpRedVolume->fReadOnly)
+    {
+        ret = -RED_EROFS;
+    }
+    else
+    {
+        CINODE ino;
+
+        ino.ulInode = ulInode;
+        ret = RedInodeMount(&ino, FTYPE_FILE, true);
+        if(ret == 0)
+        {
+            ino.pInodeBuf->uMode |= RED_S_ICOMPR;
+
+            RedInodePut(&ino, IPUT_UPDATE_CTIME);
+        }
+    }
+
+    return ret;
+}
+#endif
+
+
+#if (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_READDIR == 1)
+/** @brief Read from a directory.
+
+    If files are added to the directory after it is opened, the new files may
+    or may not be returned by this function.  If files are deleted, the deleted
+    files will not be returned.
+
+    @param ulInode  The directory inode to read from.
+    @param pulPos   A token which stores the position within the directory.  To
+                    read from the beginning of the directory, populate with
+                    zero.
+    @param pszName  Pointer to a buffer which must be big enough to store a
+                    maximum size name, including a null terminator.  On
+                    successful exit, populated with the name of the next
+                    directory entry.
+    @param pulInode On successful return, populated with the inode number of the
+                    next directory entry.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EBADF      @p ulInode is not a valid inode number.
+    @retval -RED_EINVAL     The volume is not mounted.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_ENOENT     There are no more entries in the directory.
+    @retval -RED_ENOTDIR    @p ulInode refers to a file.
+*/
+REDSTATUS RedCoreDirRead(
+    uint32_t    ulInode,
+    uint32_t   *pulPos,
+    char       *pszName,
+    uint32_t   *pulInode)
+{
+    REDSTATUS   ret;
+
+    if(!gpRedVolume->fMounted)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        CINODE ino;
+
+        ino.ulInode = ulInode;
+        ret = RedInodeMount(&ino, FTYPE_DIR, false);
+
+        if(ret == 0)
+        {
+          #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
+            bool fUpdateAtime = false;
+          #endif
+
+            ret = RedDirEntryRead(&ino, pulPos, pszName, pulInode);
+
+          #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
+            if((ret == 0) && !gpRedVolume->fReadOnly)
+            {
+                ret = RedInodeAtimeBranch(&ino, &fUpdateAtime);
+            }
+
+            RedInodePut(&ino, ((ret == 0) && fUpdateAtime) ? IPUT_UPDATE_ATIME : 0U);
+          #else
+            RedInodePut(&ino, 0U);
+          #endif
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Read several entries from a directory.
+
+    Equivalent to calling RedCoreDirRead() and, if @p fStat is true,
+    RedCoreStat() for each entry, except that the directory inode is mounted
+    (and its access time updated) only once for the whole batch, and that the
+    directory block stays buffered from one entry to the next.
+
+    @param ulInode  The directory inode to read from.
+    @param pulPos   A token which stores the position within the directory.  To
+                    read from the beginning of the directory, populate with
+                    zero.  On return, populated with the position following the
+                    last entry returned.
+    @param paDirEnt The array of ::REDDIRENT structures to populate.  The
+                    d_stat member is only populated if @p fStat is true.
+    @param ulMax    The number of elements in @p paDirEnt.
+    @param fStat    Whether to populate the d_stat member of each entry.
+    @param pulCount On successful return, populated with the number of entries
+                    read, which is less than @p ulMax only if the end of the
+                    directory was reached.
+
+    @return A negated ::REDSTATUS code indicating the operation result.  If an
+            error occurs after one or more entries have been read, those entries
+            are returned successfully, and the error is returned by the next
+            call.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EBADF      @p ulInode is not a valid inode number.
+    @retval -RED_EINVAL     The volume is not mounted; @p pulPos, @p paDirEnt,
+                            or @p pulCount is `NULL`; or @p ulMax is zero.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_ENOTDIR    @p ulInode refers to a file.
+*/
+REDSTATUS RedCoreDirReadBatch(
+    uint32_t    ulInode,
+    uint32_t   *pulPos,
+    REDDIRENT  *paDirEnt,
+    uint32_t    ulMax,
+    bool        fStat,
+    uint32_t   *pulCount)
+{
+    REDSTATUS   ret;
+
+    if(!gpRedVolume->fMounted || (pulPos == NULL) || (paDirEnt == NULL) || (ulMax == 0U) || (pulCount == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        CINODE ino;
+
+        ino.ulInode = ulInode;
+        ret = RedInodeMount(&ino, FTYPE_DIR, false);
+
+        if(ret == 0)
+        {
+          #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
+            bool fUpdateAtime = false;
+          #endif
+
+            ret = CoreDirReadBatch(&ino, pulPos, paDirEnt, ulMax, fStat, false, pulCount);
+
+          #if (REDCONF_ATIME == 1) && (REDCONF_READ_ONLY == 0)
+            if((ret == 0) && (*pulCount > 0U) && !gpRedVolume->fReadOnly)
+            {
+                ret = RedInodeAtimeBranch(&ino, &fUpdateAtime);
+            }
+
+            RedInodePut(&ino, ((ret == 0) && fUpdateAtime) ? IPUT_UPDATE_ATIME : 0U);
+          #else
+            RedInodePut(&ino, 0U);
+          #endif
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Read several entries from a mounted directory inode.
+
+    @param pInode       The mounted directory inode to read from.
+    @param pulPos       A token which stores the position within the directory.
+    @param paDirEnt     The array of ::REDDIRENT structures to populate.
+    @param ulMax        The number of elements in @p paDirEnt.
+    @param fStat        Whether to populate the d_stat member of each entry.
+    @param fSnapshot    Whether @p pInode was mounted from the pinned snapshot,
+                        in which case the entries are also looked up in the
+                        snapshot.
+    @param pulCount     On successful return, populated with the number of
+                        entries read.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+*/
+static REDSTATUS CoreDirReadBatch(
+    CINODE     *pInode,
+    uint32_t   *pulPos,
+    REDDIRENT  *paDirEnt,
+    uint32_t    ulMax,
+    bool        fStat,
+    bool        fSnapshot,
+    uint32_t   *pulCount)
+{
+    REDSTATUS   ret = 0;
+    uint32_t    ulCount = 0U;
+
+    while((ret == 0) && (ulCount < ulMax))
+    {
+        REDDIRENT  *pDirEnt = &paDirEnt[ulCount];
+        uint32_t    ulPos = *pulPos;
+
+        ret = RedDirEntryRead(pInode, &ulPos, pDirEnt->d_name, &pDirEnt->d_ino);
+
+        if((ret == 0) && fStat)
+        {
+            INODEMETA meta;
+
+          #if SNAPSHOT_SUPPORTED
+            if(fSnapshot)
+            {
+                ret = RedInodeSnapMetaGet(pDirEnt->d_ino, &meta);
+            }
+            else
+          #endif
+            {
+                ret = RedInodeMetaGet(pDirEnt->d_ino, FTYPE_EITHER, &meta);
+            }
+
+            if(ret == 0)
+            {
+                CoreStatFill(pDirEnt->d_ino, &meta, &pDirEnt->d_stat);
+            }
+        }
+
+        /*  Only move past an entry once it has been returned in full, so an
+            entry whose stat failed is read again by the next call.
+        */
+        if(ret == 0)
+        {
+            *pulPos = ulPos;
+            ulCount++;
+        }
+    }
+
+  #if !SNAPSHOT_SUPPORTED
+    (void)fSnapshot;
+  #endif
+
+    /*  Reaching the end of the directory is not an error for a batch read, nor
+        is an error after some entries were read: that error will recur on the
+        next call, when it can be reported with nothing else to return.
+    */
+    if((ret == -RED_ENOENT) || (ulCount > 0U))
+    {
+        ret = 0;
+    }
+
+    if(ret == 0)
+    {
+        *pulCount = ulCount;
+    }
+
+    return ret;
+}
+#endif /* (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_READDIR == 1) */
+
+
+#if SNAPSHOT_SUPPORTED
+/** @brief Look up the inode number of a file or directory in the pinned
+           snapshot.
+
+    @param ulPInode The inode number of the parent directory.
+    @param pszName  The null-terminated name of the file or directory to look
+                    up.
+    @param pulInode On successful return, populated with the inode number named
+                    by @p pszName.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EBADF      @p ulPInode is not a valid inode in the snapshot.
+    @retval -RED_EINVAL     The volume is not mounted; no snapshot is pinned;
+                            @p pszName is `NULL`; or @p pulInode is `NULL`.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_ENOENT     @p pszName does not name an existing file or
+                            directory in the snapshot.
+    @retval -RED_ENOTDIR    @p ulPInode is not a directory.
+*/
+REDSTATUS RedCoreSnapLookup(
+    uint32_t    ulPInode,
+    const char *pszName,
+    uint32_t   *pulInode)
+{
+    REDSTATUS   ret;
+
+    if((pulInode == NULL) || !gpRedVolume->fMounted || !gpRedCoreVol->fSnapshot)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        CINODE ino;
+
+        ino.ulInode = ulPInode;
+        ret = RedInodeMountSnapshot(&ino, FTYPE_DIR);
+
+        if(ret == 0)
+        {
+            ret = RedDirEntryLookup(&ino, pszName, NULL, pulInode);
+
+            RedInodePut(&ino, 0U);
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Get the status of a file or directory in the pinned snapshot.
+
+    @param ulInode  The inode number of the file or directory whose information
+                    is to be retrieved.
+    @param pStat    Pointer to a ::REDSTAT buffer to populate.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  @p ulInode is not a valid inode in the snapshot.
+    @retval -RED_EINVAL The volume is not mounted; no snapshot is pinned; or
+                        @p pStat is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedCoreSnapStat(
+    uint32_t    ulInode,
+    REDSTAT    *pStat)
+{
+    REDSTATUS   ret;
+
+    if(!gpRedVolume->fMounted || !gpRedCoreVol->fSnapshot || (pStat == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        INODEMETA meta;
+
+        ret = RedInodeSnapMetaGet(ulInode, &meta);
+        if(ret == 0)
+        {
+            CoreStatFill(ulInode, &meta, pStat);
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Read from a file in the pinned snapshot.
+
+    Behaves like RedCoreFileRead(), except that the data is read as it was when
+    the snapshot was pinned, and the access time is not updated.
+
+    @param ulInode  The inode number of the file to read.
+    @param ullStart The file offset to read from.
+    @param pulLen   On entry, contains the number of bytes to read; on
+                    successful exit, contains the number of bytes actually
+                    read.
+    @param pBuffer  The buffer to populate with the data read.  Must be big
+                    enough for the read request.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  @p ulInode is not a valid inode number in the snapshot.
+    @retval -RED_EINVAL The volume is not mounted; no snapshot is pinned; or
+                        @p pBuffer is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EISDIR The inode is a directory inode.
+*/
+REDSTATUS RedCoreSnapFileRead(
+    uint32_t    ulInode,
+    uint64_t    ullStart,
+    uint32_t   *pulLen,
+    void       *pBuffer)
+{
+    REDSTATUS   ret;
+
+    if(!gpRedVolume->fMounted || !gpRedCoreVol->fSnapshot || (pulLen == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        CINODE ino;
+
+        ino.ulInode = ulInode;
+        ret = RedInodeMountSnapshot(&ino, FTYPE_FILE);
+        if(ret == 0)
+        {
+            ret = RedInodeDataRead(&ino, ullStart, pulLen, pBuffer);
+
+            RedInodePut(&ino, 0U);
+        }
+    }
+
+    return ret;
+}
+
+
+#if REDCONF_API_POSIX_READDIR == 1
+/** @brief Read from a directory in the pinned snapshot.
+
+    @param ulInode  The directory inode to read from.
+    @param pulPos   A token which stores the position within the directory.  To
+                    read from the beginning of the directory, populate with
+                    zero.
+    @param pszName  Pointer to a buffer which must be big enough to store a
+                    maximum size name, including a null terminator.  On
+                    successful exit, populated with the name of the next
+                    directory entry.
+    @param pulInode On successful return, populated with the inode number of the
+                    next directory entry.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EBADF      @p ulInode is not a valid inode number in the
+                            snapshot.
+    @retval -RED_EINVAL     The volume is not mounted; or no snapshot is pinned.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_ENOENT     There are no more entries in the directory.
+    @retval -RED_ENOTDIR    @p ulInode refers to a file.
+*/
+REDSTATUS RedCoreSnapDirRead(
+    uint32_t    ulInode,
+    uint32_t   *pulPos,
+    char       *pszName,
+    uint32_t   *pulInode)
+{
+    REDSTATUS   ret;
+
+    if(!gpRedVolume->fMounted || !gpRedCoreVol->fSnapshot)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        CINODE ino;
+
+        ino.ulInode = ulInode;
+        ret = RedInodeMountSnapshot(&ino, FTYPE_DIR);
+
+        if(ret == 0)
+        {
+            ret = RedDirEntryRead(&ino, pulPos, pszName, pulInode);
+
+            RedInodePut(&ino, 0U);
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Read several entries from a directory in the pinned snapshot.
+
+    Behaves like RedCoreDirReadBatch(), except that the entries, and their
+    status if @p fStat is true, are read as they were when the snapshot was
+    pinned.
+
+    @param ulInode  The directory inode to read from.
+    @param pulPos   A token which stores the position within the directory.  To
+                    read from the beginning of the directory, populate with
+                    zero.
+    @param paDirEnt The array of ::REDDIRENT structures to populate.
+    @param ulMax    The number of elements in @p paDirEnt.
+    @param fStat    Whether to populate the d_stat member of each entry.
+    @param pulCount On successful return, populated with the number of entries
+                    read.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EBADF      @p ulInode is not a valid inode number in the
+                            snapshot.
+    @retval -RED_EINVAL     The volume is not mounted; no snapshot is pinned;
+                            @p pulPos, @p paDirEnt, or @p pulCount is `NULL`;
+                            or @p ulMax is zero.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_ENOTDIR    @p ulInode refers to a file.
+*/
+REDSTATUS RedCoreSnapDirReadBatch(
+    uint32_t    ulInode,
+    uint32_t   *pulPos,
+    REDDIRENT  *paDirEnt,
+    uint32_t    ulMax,
+    bool        fStat,
+    uint32_t   *pulCount)
+{
+    REDSTATUS   ret;
+
+    if(    !gpRedVolume->fMounted
+        || !gpRedCoreVol->fSnapshot
+        || (pulPos == NULL)
+        || (paDirEnt == NULL)
+        || (ulMax == 0U)
+        || (pulCount == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        CINODE ino;
+
+        ino.ulInode = ulInode;
+        ret = RedInodeMountSnapshot(&ino, FTYPE_DIR);
+
+        if(ret == 0)
+        {
+            ret = CoreDirReadBatch(&ino, pulPos, paDirEnt, ulMax, fStat, true, pulCount);
+
+            RedInodePut(&ino, 0U);
+        }
+    }
+
+    return ret;
+}
+#endif
+#endif /* SNAPSHOT_SUPPORTED */
 
@@ -68,6 +68,49 @@ typedef struct
 } DIRENT;
 
 
+#if REDCONF_DIR_CACHE > 0U
+/** @brief An entry in the directory lookup cache.
+
+    The cache remembers where names were found, so that a lookup which hits
+    only has to read the one directory block which holds the entry.  Cached
+    positions are always checked against the directory entry itself, so a stale
+    cache entry costs one block read but can never produce a wrong result.
+*/
+typedef struct
+{
+    uint32_t    ulPInode;   /**< Directory inode number; INODE_INVALID if unused. */
+    uint32_t    ulHash;     /**< Hash of the directory inode number and the name. */
+    uint32_t    ulEntryIdx; /**< Position of the entry within the directory. */
+} DIRCACHE;
+
+static DIRCACHE gaaDirCache[REDCONF_VOLUME_COUNT][REDCONF_DIR_CACHE];
+#endif
+
+
+#if REDCONF_DENTRY_CACHE > 0U
+/** @brief An entry in the dentry cache.
+
+    Unlike the directory lookup cache, which only remembers where a name was
+    found, the dentry cache remembers what the name resolved to, including
+    names which were not found, so that a hit resolves the name without
+    mounting the directory at all.  Entries are therefore kept exact: they are
+    updated or removed whenever a directory entry is written or deleted,
+    removed when their directory is freed, and discarded when the volume is
+    mounted.
+*/
+typedef struct
+{
+    uint32_t    ulPInode;   /**< Directory inode number; INODE_INVALID if unused. */
+    uint32_t    ulHash;     /**< Hash of the directory inode number and the name. */
+    uint32_t    ulInode;    /**< Inode number of the name; INODE_INVALID if the name does not exist. */
+    uint32_t    ulEntryIdx; /**< Position of the entry within the directory, if it exists. */
+    char        acName[REDCONF_NAME_MAX]; /**< The name; not null terminated if of the maximum length. */
+} DENTRY;
+
+static DENTRY gaaDentryCache[REDCONF_VOLUME_COUNT][REDCONF_DENTRY_CACHE];
+#endif
+
+
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_RENAME == 1)
 static REDSTATUS DirCyclicRenameCheck(uint32_t ulSrcInode, const CINODE *pDstPInode);
 #endif
@@ -76,6 +119,25 @@ static REDSTATUS DirEntryWrite(CINODE *pPInode, uint32_t ulIdx, uint32_t ulInode
 static uint64_t DirEntryIndexToOffset(uint32_t ulIdx);
 #endif
 static uint32_t DirOffsetToEntryIndex(uint64_t ullOffset);
+static REDSTATUS DirEntryScan(CINODE *pPInode, const char *pszName, uint32_t ulNameLen, uint32_t *pulEntryIdx, uint32_t *pulInode);
+static bool DirEntryNameMatch(const DIRENT *pDirent, const char *pszName, uint32_t ulNameLen);
+#if (REDCONF_DIR_CACHE > 0U) || (REDCONF_DENTRY_CACHE > 0U)
+static uint32_t DirCacheHash(uint32_t ulPInode, const char *pszName, uint32_t ulNameLen);
+#endif
+#if REDCONF_DIR_CACHE > 0U
+static REDSTATUS DirCacheLookup(CINODE *pPInode, const char *pszName, uint32_t ulNameLen, uint32_t ulHash, uint32_t *pulEntryIdx, uint32_t *pulInode);
+static void DirCacheInsert(uint32_t ulPInode, uint32_t ulHash, uint32_t ulEntryIdx);
+#if REDCONF_READ_ONLY == 0
+static void DirCacheRemove(uint32_t ulPInode, uint32_t ulEntryIdx);
+#endif
+#endif
+#if REDCONF_DENTRY_CACHE > 0U
+static DENTRY *DentryFind(uint32_t ulPInode, uint32_t ulHash, const char *pszName, uint32_t ulNameLen);
+static void DentryInsert(uint32_t ulPInode, uint32_t ulHash, const char *pszName, uint32_t ulNameLen, uint32_t ulInode, uint32_t ulEntryIdx);
+#if REDCONF_READ_ONLY == 0
+static void DentryRemove(uint32_t ulPInode, uint32_t ulEntryIdx);
+#endif
+#endif
 
 
 #if REDCONF_READ_ONLY == 0
@@ -253,6 +315,10 @@ REDSTATUS RedDirEntryDelete(
         /*  Truncate the directory, deleting the requested entry and any empty
             dirents at the end of the directory.
         */
+      #if REDCONF_DENTRY_CACHE > 0U
+        DentryRemove(pPInode->ulInode, ulDeleteIdx);
+      #endif
+
         if(ret == 0)
         {
             ret = RedInodeDataTruncate(pPInode, DirEntryIndexToOffset(ulTruncIdx));
@@ -332,120 +398,63 @@ REDSTATUS RedDirEntryLookup(
         }
         else
         {
-            uint32_t    ulIdx = 0U;
-            uint32_t    ulDirentCount = DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize);
-            uint32_t    ulFreeIdx = DIR_INDEX_INVALID;  /* Index of first free dirent. */
+            uint32_t ulEntryIdx = DIR_INDEX_INVALID;
+            uint32_t ulInode = INODE_INVALID;
 
-            /*  Loop over the directory blocks, searching each block for a
-                dirent that matches the given name.
-            */
-            while((ret == 0) && (ulIdx < ulDirentCount))
+          #if SNAPSHOT_SUPPORTED && ((REDCONF_DIR_CACHE > 0U) || (REDCONF_DENTRY_CACHE > 0U))
+            if(pPInode->fSnapshot)
             {
-                ret = RedInodeDataSeekAndRead(pPInode, ulIdx / DIRENTS_PER_BLOCK);
-
-                if(ret == 0)
-                {
-                    const DIRENT *pDirents = CAST_CONST_DIRENT_PTR(pPInode->pbData);
-                    uint32_t      ulBlockLastIdx = REDMIN(DIRENTS_PER_BLOCK, ulDirentCount - ulIdx);
-                    uint32_t      ulBlockIdx;
+                /*  The name caches describe the working state, so they are
+                    neither used nor updated for snapshot directories.
+                */
+                ret = DirEntryScan(pPInode, pszName, ulNameLen, &ulEntryIdx, &ulInode);
+            }
+            else
+          #endif
+            {
+              #if REDCONF_DIR_CACHE > 0U
+                uint32_t ulHash = DirCacheHash(pPInode->ulInode, pszName, ulNameLen);
 
-                    for(ulBlockIdx = 0U; ulBlockIdx < ulBlockLastIdx; ulBlockIdx++)
-                    {
-                        const DIRENT *pDirent = &pDirents[ulBlockIdx];
+                ret = DirCacheLookup(pPInode, pszName, ulNameLen, ulHash, &ulEntryIdx, &ulInode);
 
-                        if(pDirent->ulInode != INODE_INVALID)
-                        {
-                            /*  The name in the dirent will not be null
-                                terminated if it is of the maximum length, so
-                                use a bounded string compare and then make sure
-                                there is nothing more to the name.
-                            */
-                            if(    (RedStrNCmp(pDirent->acName, pszName, ulNameLen) == 0)
-                                && ((ulNameLen == REDCONF_NAME_MAX) || (pDirent->acName[ulNameLen] == '\0')))
-                            {
-                                /*  Found a matching dirent, stop and return its
-                                    information.
-                                */
-                                if(pulInode != NULL)
-                                {
-                                    *pulInode = pDirent->ulInode;
-
-                                  #ifdef REDCONF_ENDIAN_SWAP
-                                    *pulInode = RedRev32(*pulInode);
-                                  #endif
-                                }
-
-                                ulIdx += ulBlockIdx;
-                                break;
-                            }
-                        }
-                        else if(ulFreeIdx == DIR_INDEX_INVALID)
-                        {
-                            ulFreeIdx = ulIdx + ulBlockIdx;
-                        }
-                        else
-                        {
-                            /*  The directory entry is free, but we already found a free one, so there's
-                                nothing to do here.
-                            */
-                        }
-                    }
+                if(ret == -RED_ENOENT)
+                {
+                    ret = DirEntryScan(pPInode, pszName, ulNameLen, &ulEntryIdx, &ulInode);
 
-                    if(ulBlockIdx < ulBlockLastIdx)
+                    if(ret == 0)
                     {
-                        /*  If we broke out of the for loop, we found a matching
-                            dirent and can stop the search.
-                        */
-                        break;
+                        DirCacheInsert(pPInode->ulInode, ulHash, ulEntryIdx);
                     }
+                }
+              #else
+                ret = DirEntryScan(pPInode, pszName, ulNameLen, &ulEntryIdx, &ulInode);
+              #endif
 
-                    ulIdx += ulBlockLastIdx;
+              #if REDCONF_DENTRY_CACHE > 0U
+                if(ret == 0)
+                {
+                    DentryInsert(pPInode->ulInode, DirCacheHash(pPInode->ulInode, pszName, ulNameLen), pszName, ulNameLen, ulInode, ulEntryIdx);
                 }
-                else if(ret == -RED_ENODATA)
+                else if(ret == -RED_ENOENT)
                 {
-                    if(ulFreeIdx == DIR_INDEX_INVALID)
-                    {
-                        ulFreeIdx = ulIdx;
-                    }
-
-                    ret = 0;
-                    ulIdx += DIRENTS_PER_BLOCK;
+                    DentryInsert(pPInode->ulInode, DirCacheHash(pPInode->ulInode, pszName, ulNameLen), pszName, ulNameLen, INODE_INVALID, DIR_INDEX_INVALID);
                 }
                 else
                 {
-                    /*  Unexpected error, let the loop terminate, no action
-                        here.
+                    /*  Unexpected error, nothing to remember.
                     */
                 }
+              #endif
             }
 
-            if(ret == 0)
+            if((ret == 0) && (pulInode != NULL))
             {
-                /*  If we made it all the way to the end of the directory
-                    without stopping, then the given name does not exist in the
-                    directory.
-                */
-                if(ulIdx == ulDirentCount)
-                {
-                    /*  If the directory had no sparse dirents, then the first
-                        free dirent is beyond the end of the directory.  If the
-                        directory is already the maximum size, then there is no
-                        free dirent.
-                    */
-                    if((ulFreeIdx == DIR_INDEX_INVALID) && (ulDirentCount < DIRENTS_MAX))
-                    {
-                        ulFreeIdx = ulDirentCount;
-                    }
-
-                    ulIdx = ulFreeIdx;
-
-                    ret = -RED_ENOENT;
-                }
+                *pulInode = ulInode;
+            }
 
-                if(pulEntryIdx != NULL)
-                {
-                    *pulEntryIdx = ulIdx;
-                }
+            if(((ret == 0) || (ret == -RED_ENOENT)) && (pulEntryIdx != NULL))
+            {
+                *pulEntryIdx = ulEntryIdx;
             }
         }
     }
@@ -569,6 +578,103 @@ REDSTATUS RedDirEntryRead(
 #endif
 
 
+#if SCRUB_SUPPORTED
+/** @brief Verify the directory entries in one block of a directory.
+
+    Each directory entry in use must have a name, and must point at a valid
+    inode number which is allocated.
+
+    @param pPInode  A pointer to the cached inode structure of the directory.
+    @param ulBlock  The block offset within the directory.
+    @param pfValid  On successful return, populated with whether every
+                    directory entry in the block is consistent.  A sparse block
+                    is consistent.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EINVAL     @p pPInode is not a mounted cached inode structure;
+                            or @p pfValid is `NULL`.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_ENOTDIR    @p pPInode is not a directory.
+*/
+REDSTATUS RedDirBlockCheck(
+    CINODE     *pPInode,
+    uint32_t    ulBlock,
+    bool       *pfValid)
+{
+    REDSTATUS   ret;
+
+    if(!CINODE_IS_MOUNTED(pPInode) || (pfValid == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(!pPInode->fDirectory)
+    {
+        ret = -RED_ENOTDIR;
+    }
+    else
+    {
+        *pfValid = true;
+
+        ret = RedInodeDataSeekAndRead(pPInode, ulBlock);
+
+        if(ret == 0)
+        {
+            const DIRENT *pDirents = CAST_CONST_DIRENT_PTR(pPInode->pbData);
+            uint32_t      ulDirentCount = DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize);
+            uint32_t      ulBlockLastIdx = 0U;
+            uint32_t      ulBlockIdx;
+
+            if(ulDirentCount > (ulBlock * DIRENTS_PER_BLOCK))
+            {
+                ulBlockLastIdx = REDMIN(DIRENTS_PER_BLOCK, ulDirentCount - (ulBlock * DIRENTS_PER_BLOCK));
+            }
+
+            for(ulBlockIdx = 0U; (ret == 0) && (ulBlockIdx < ulBlockLastIdx); ulBlockIdx++)
+            {
+                uint32_t ulInode = pDirents[ulBlockIdx].ulInode;
+
+              #ifdef REDCONF_ENDIAN_SWAP
+                ulInode = RedRev32(ulInode);
+              #endif
+
+                if(ulInode != INODE_INVALID)
+                {
+                    if(!INODE_IS_VALID(ulInode) || (pDirents[ulBlockIdx].acName[0U] == '\0'))
+                    {
+                        *pfValid = false;
+                    }
+                    else
+                    {
+                        bool fFree;
+
+                        ret = RedInodeIsFree(ulInode, &fFree);
+
+                        if((ret == 0) && fFree)
+                        {
+                            *pfValid = false;
+                        }
+                    }
+                }
+            }
+        }
+        else if(ret == -RED_ENODATA)
+        {
+            ret = 0;
+        }
+        else
+        {
+            /*  Unexpected error; nothing else to do.
+            */
+        }
+    }
+
+    return ret;
+}
+#endif
+
+
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_RENAME == 1)
 /** Rename a directory entry.
 
@@ -901,7 +1007,44 @@ static REDSTATUS DirEntryWrite(
 
         RedStrNCpy(de.acName, pszName, ulNameLen);
 
+      #if REDCONF_DENTRY_CACHE > 0U
+        /*  Forget what was at this position, and any negative entry for the
+            new name, before the write, so that a failed write cannot leave
+            either behind.
+        */
+        DentryRemove(pPInode->ulInode, ulIdx);
+
+        if(ulInode != INODE_INVALID)
+        {
+            DENTRY *pEntry = DentryFind(pPInode->ulInode, DirCacheHash(pPInode->ulInode, pszName, ulNameLen), pszName, ulNameLen);
+
+            if(pEntry != NULL)
+            {
+                pEntry->ulPInode = INODE_INVALID;
+            }
+        }
+      #endif
+
         ret = RedInodeDataWrite(pPInode, ullOffset, &ulLen, &de);
+
+      #if REDCONF_DENTRY_CACHE > 0U
+        if((ret == 0) && (ulInode != INODE_INVALID))
+        {
+            DentryInsert(pPInode->ulInode, DirCacheHash(pPInode->ulInode, pszName, ulNameLen), pszName, ulNameLen, ulInode, ulIdx);
+        }
+      #endif
+
+      #if REDCONF_DIR_CACHE > 0U
+        if(ret == 0)
+        {
+            DirCacheRemove(pPInode->ulInode, ulIdx);
+
+            if(ulInode != INODE_INVALID)
+            {
+                DirCacheInsert(pPInode->ulInode, DirCacheHash(pPInode->ulInode, pszName, ulNameLen), ulIdx);
+            }
+        }
+      #endif
     }
 
     return ret;
@@ -954,5 +1097,498 @@ static uint32_t DirOffsetToEntryIndex(
 }
 
 
+/** @brief Search a directory for a name, one directory block at a time.
+
+    @param pPInode      A pointer to the cached inode structure of the directory
+                        to search.
+    @param pszName      The name of the desired entry.
+    @param ulNameLen    The length of @p pszName.
+    @param pulEntryIdx  On successful return, populated with the position of the
+                        entry.  If returning an -RED_ENOENT error, populated with
+                        the position of the first available entry, or set to
+                        DIR_INDEX_INVALID if the directory is full.
+    @param pulInode     On successful return, populated with the inode number
+                        that the name points to.  Optional; may be `NULL`.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_ENOENT     @p pszName does not name an existing file or
+                            directory.
+    @retval -RED_EINVAL     @p pulEntryIdx is `NULL`.
+*/
+static REDSTATUS DirEntryScan(
+    CINODE     *pPInode,
+    const char *pszName,
+    uint32_t    ulNameLen,
+    uint32_t   *pulEntryIdx,
+    uint32_t   *pulInode)
+{
+    REDSTATUS   ret = 0;
+
+    if(pulEntryIdx == NULL)
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        uint32_t    ulIdx = 0U;
+        uint32_t    ulDirentCount = DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize);
+        uint32_t    ulFreeIdx = DIR_INDEX_INVALID;  /* Index of first free dirent. */
+
+        /*  Loop over the directory blocks, searching each block for a
+            dirent that matches the given name.
+        */
+        while((ret == 0) && (ulIdx < ulDirentCount))
+        {
+            ret = RedInodeDataSeekAndRead(pPInode, ulIdx / DIRENTS_PER_BLOCK);
+
+            if(ret == 0)
+            {
+                const DIRENT *pDirents = CAST_CONST_DIRENT_PTR(pPInode->pbData);
+                uint32_t      ulBlockLastIdx = REDMIN(DIRENTS_PER_BLOCK, ulDirentCount - ulIdx);
+                uint32_t      ulBlockIdx;
+
+                for(ulBlockIdx = 0U; ulBlockIdx < ulBlockLastIdx; ulBlockIdx++)
+                {
+                    const DIRENT *pDirent = &pDirents[ulBlockIdx];
+
+                    if(pDirent->ulInode != INODE_INVALID)
+                    {
+                        if(DirEntryNameMatch(pDirent, pszName, ulNameLen))
+                        {
+                            /*  Found a matching dirent, stop and return its
+                                information.
+                            */
+                            if(pulInode != NULL)
+                            {
+                                *pulInode = pDirent->ulInode;
+
+                              #ifdef REDCONF_ENDIAN_SWAP
+                                *pulInode = RedRev32(*pulInode);
+                              #endif
+                            }
+
+                            ulIdx += ulBlockIdx;
+                            break;
+                        }
+                    }
+                    else if(ulFreeIdx == DIR_INDEX_INVALID)
+                    {
+                        ulFreeIdx = ulIdx + ulBlockIdx;
+                    }
+                    else
+                    {
+                        /*  The directory entry is free, but we already found a free one, so there's
+                            nothing to do here.
+                        */
+                    }
+                }
+
+                if(ulBlockIdx < ulBlockLastIdx)
+                {
+                    /*  If we broke out of the for loop, we found a matching
+                        dirent and can stop the search.
+                    */
+                    break;
+                }
+
+                ulIdx += ulBlockLastIdx;
+            }
+            else if(ret == -RED_ENODATA)
+            {
+                if(ulFreeIdx == DIR_INDEX_INVALID)
+                {
+                    ulFreeIdx = ulIdx;
+                }
+
+                ret = 0;
+                ulIdx += DIRENTS_PER_BLOCK;
+            }
+            else
+            {
+                /*  Unexpected error, let the loop terminate, no action
+                    here.
+                */
+            }
+        }
+
+        if(ret == 0)
+        {
+            /*  If we made it all the way to the end of the directory
+                without stopping, then the given name does not exist in the
+                directory.
+            */
+            if(ulIdx == ulDirentCount)
+            {
+                /*  If the directory had no sparse dirents, then the first
+                    free dirent is beyond the end of the directory.  If the
+                    directory is already the maximum size, then there is no
+                    free dirent.
+                */
+                if((ulFreeIdx == DIR_INDEX_INVALID) && (ulDirentCount < DIRENTS_MAX))
+                {
+                    ulFreeIdx = ulDirentCount;
+                }
+
+                ulIdx = ulFreeIdx;
+
+                ret = -RED_ENOENT;
+            }
+
+            *pulEntryIdx = ulIdx;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Determine whether a directory entry has a given name.
+
+    @param pDirent      The directory entry to examine.
+    @param pszName      The name to compare against.
+    @param ulNameLen    The length of @p pszName.
+
+    @return Whether the name of @p pDirent is @p pszName.
+*/
+static bool DirEntryNameMatch(
+    const DIRENT   *pDirent,
+    const char     *pszName,
+    uint32_t        ulNameLen)
+{
+    /*  The name in the dirent will not be null terminated if it is of the
+        maximum length, so use a bounded string compare and then make sure
+        there is nothing more to the name.
+    */
+    return (RedStrNCmp(pDirent->acName, pszName, ulNameLen) == 0)
+        && ((ulNameLen == REDCONF_NAME_MAX) || (pDirent->acName[ulNameLen] == '\0'));
+}
+
+
+#if (REDCONF_DIR_CACHE > 0U) || (REDCONF_DENTRY_CACHE > 0U)
+/** @brief Compute the directory lookup cache hash of a name.
+
+    @param ulPInode     The inode number of the directory.
+    @param pszName      The name.
+    @param ulNameLen    The length of @p pszName.
+
+    @return The hash value.
+*/
+static uint32_t DirCacheHash(
+    uint32_t    ulPInode,
+    const char *pszName,
+    uint32_t    ulNameLen)
+{
+    uint32_t    ulHash = 2166136261U ^ ulPInode; /* FNV-1a */
+    uint32_t    ulIdx;
+
+    for(ulIdx = 0U; ulIdx < ulNameLen; ulIdx++)
+    {
+        ulHash ^= (uint8_t)pszName[ulIdx];
+        ulHash *= 16777619U;
+    }
+
+    return ulHash;
+}
+#endif
+
+
+#if REDCONF_DIR_CACHE > 0U
+/** @brief Look up a name in the directory lookup cache.
+
+    On a hit, the directory entry at the cached position is read to confirm
+    that it still has the name.
+
+    @param pPInode      A pointer to the cached inode structure of the directory
+                        to search.
+    @param pszName      The name of the desired entry.
+    @param ulNameLen    The length of @p pszName.
+    @param ulHash       The hash of @p pszName, from DirCacheHash().
+    @param pulEntryIdx  On successful return, populated with the position of the
+                        entry.
+    @param pulInode     On successful return, populated with the inode number
+                        that the name points to.  Optional; may be `NULL`.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_ENOENT     The name is not in the cache.
+*/
+static REDSTATUS DirCacheLookup(
+    CINODE     *pPInode,
+    const char *pszName,
+    uint32_t    ulNameLen,
+    uint32_t    ulHash,
+    uint32_t   *pulEntryIdx,
+    uint32_t   *pulInode)
+{
+    DIRCACHE   *pEntry = &gaaDirCache[gbRedVolNum][ulHash % REDCONF_DIR_CACHE];
+    REDSTATUS   ret = -RED_ENOENT;
+
+    if(    (pEntry->ulPInode == pPInode->ulInode)
+        && (pEntry->ulHash == ulHash)
+        && (pEntry->ulEntryIdx < DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize)))
+    {
+        uint32_t ulEntryIdx = pEntry->ulEntryIdx;
+
+        ret = RedInodeDataSeekAndRead(pPInode, ulEntryIdx / DIRENTS_PER_BLOCK);
+
+        if(ret == 0)
+        {
+            const DIRENT *pDirent = &CAST_CONST_DIRENT_PTR(pPInode->pbData)[ulEntryIdx % DIRENTS_PER_BLOCK];
+
+            if((pDirent->ulInode != INODE_INVALID) && DirEntryNameMatch(pDirent, pszName, ulNameLen))
+            {
+                *pulEntryIdx = ulEntryIdx;
+
+                if(pulInode != NULL)
+                {
+                    *pulInode = pDirent->ulInode;
+
+                  #ifdef REDCONF_ENDIAN_SWAP
+                    *pulInode = RedRev32(*pulInode);
+                  #endif
+                }
+            }
+            else
+            {
+                ret = -RED_ENOENT;
+            }
+        }
+        else if(ret == -RED_ENODATA)
+        {
+            ret = -RED_ENOENT;
+        }
+        else
+        {
+            /*  Unexpected error, return it.
+            */
+        }
+
+        /*  The cache entry is stale.
+        */
+        if(ret == -RED_ENOENT)
+        {
+            pEntry->ulPInode = INODE_INVALID;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Remember the position of a name in the directory lookup cache.
+
+    @param ulPInode     The inode number of the directory.
+    @param ulHash       The hash of the name, from DirCacheHash().
+    @param ulEntryIdx   The position of the entry within the directory.
+*/
+static void DirCacheInsert(
+    uint32_t    ulPInode,
+    uint32_t    ulHash,
+    uint32_t    ulEntryIdx)
+{
+    DIRCACHE   *pEntry = &gaaDirCache[gbRedVolNum][ulHash % REDCONF_DIR_CACHE];
+
+    pEntry->ulPInode = ulPInode;
+    pEntry->ulHash = ulHash;
+    pEntry->ulEntryIdx = ulEntryIdx;
+}
+
+
+#if REDCONF_READ_ONLY == 0
+/** @brief Forget any cached name at a given directory position.
+
+    @param ulPInode     The inode number of the directory.
+    @param ulEntryIdx   The position of the entry within the directory.
+*/
+static void DirCacheRemove(
+    uint32_t    ulPInode,
+    uint32_t    ulEntryIdx)
+{
+    uint32_t    ulIdx;
+
+    for(ulIdx = 0U; ulIdx < REDCONF_DIR_CACHE; ulIdx++)
+    {
+        DIRCACHE *pEntry = &gaaDirCache[gbRedVolNum][ulIdx];
+
+        if((pEntry->ulPInode == ulPInode) && (pEntry->ulEntryIdx == ulEntryIdx))
+        {
+            pEntry->ulPInode = INODE_INVALID;
+        }
+    }
+}
+#endif
+#endif /* REDCONF_DIR_CACHE > 0U */
+
+
+#if REDCONF_DENTRY_CACHE > 0U
+/** @brief Resolve a name using only the dentry cache.
+
+    @param ulPInode The inode number of the directory.
+    @param pszName  The name to resolve, terminated by either a null or a path
+                    separator.
+    @param pulInode On a hit, populated with the inode number that the name
+                    points to, or INODE_INVALID if the name is known not to
+                    exist.
+
+    @return Whether the name was found in the cache.
+*/
+bool RedDirDentryLookup(
+    uint32_t        ulPInode,
+    const char     *pszName,
+    uint32_t       *pulInode)
+{
+    const DENTRY   *pEntry = NULL;
+
+    if((pszName != NULL) && (pulInode != NULL))
+    {
+        uint32_t ulNameLen = RedNameLen(pszName);
+
+        if((ulNameLen > 0U) && (ulNameLen <= REDCONF_NAME_MAX))
+        {
+            pEntry = DentryFind(ulPInode, DirCacheHash(ulPInode, pszName, ulNameLen), pszName, ulNameLen);
+        }
+    }
+
+    if(pEntry != NULL)
+    {
+        *pulInode = pEntry->ulInode;
+    }
+
+    return pEntry != NULL;
+}
+
+
+/** @brief Forget every cached name in a directory which is being freed.
+
+    Negative entries may remain for an empty directory; they must not outlive
+    it, since its inode number may be reused.
+
+    @param ulPInode The inode number of the directory.
+*/
+void RedDirDentryPurge(
+    uint32_t    ulPInode)
+{
+    uint32_t    ulIdx;
+
+    for(ulIdx = 0U; ulIdx < REDCONF_DENTRY_CACHE; ulIdx++)
+    {
+        DENTRY *pEntry = &gaaDentryCache[gbRedVolNum][ulIdx];
+
+        if(pEntry->ulPInode == ulPInode)
+        {
+            pEntry->ulPInode = INODE_INVALID;
+        }
+    }
+}
+
+
+/** @brief Forget every cached name on the current volume.
+
+    Called whenever the volume is mounted, since the cache is only valid for
+    the working state it was filled from.
+*/
+void RedDirDentryReset(void)
+{
+    uint32_t ulIdx;
+
+    for(ulIdx = 0U; ulIdx < REDCONF_DENTRY_CACHE; ulIdx++)
+    {
+        gaaDentryCache[gbRedVolNum][ulIdx].ulPInode = INODE_INVALID;
+    }
+}
+
+
+/** @brief Find a name in the dentry cache.
+
+    @param ulPInode     The inode number of the directory.
+    @param ulHash       The hash of the name, from DirCacheHash().
+    @param pszName      The name.
+    @param ulNameLen    The length of @p pszName.
+
+    @return The cache entry for the name, or `NULL` if it is not cached.
+*/
+static DENTRY *DentryFind(
+    uint32_t    ulPInode,
+    uint32_t    ulHash,
+    const char *pszName,
+    uint32_t    ulNameLen)
+{
+    DENTRY     *pEntry = &gaaDentryCache[gbRedVolNum][ulHash % REDCONF_DENTRY_CACHE];
+
+    if(    (pEntry->ulPInode != ulPInode)
+        || (pEntry->ulHash != ulHash)
+        || (RedStrNCmp(pEntry->acName, pszName, ulNameLen) != 0)
+        || ((ulNameLen < REDCONF_NAME_MAX) && (pEntry->acName[ulNameLen] != '\0')))
+    {
+        pEntry = NULL;
+    }
+
+    return pEntry;
+}
+
+
+/** @brief Remember what a name resolved to in the dentry cache.
+
+    @param ulPInode     The inode number of the directory.
+    @param ulHash       The hash of the name, from DirCacheHash().
+    @param pszName      The name.
+    @param ulNameLen    The length of @p pszName.
+    @param ulInode      The inode number the name points to, or INODE_INVALID
+                        if the name does not exist.
+    @param ulEntryIdx   The position of the entry within the directory; ignored
+                        if @p ulInode is INODE_INVALID.
+*/
+static void DentryInsert(
+    uint32_t    ulPInode,
+    uint32_t    ulHash,
+    const char *pszName,
+    uint32_t    ulNameLen,
+    uint32_t    ulInode,
+    uint32_t    ulEntryIdx)
+{
+    DENTRY     *pEntry = &gaaDentryCache[gbRedVolNum][ulHash % REDCONF_DENTRY_CACHE];
+
+    pEntry->ulPInode = ulPInode;
+    pEntry->ulHash = ulHash;
+    pEntry->ulInode = ulInode;
+    pEntry->ulEntryIdx = (ulInode == INODE_INVALID) ? DIR_INDEX_INVALID : ulEntryIdx;
+
+    RedMemSet(pEntry->acName, 0U, sizeof(pEntry->acName));
+    RedStrNCpy(pEntry->acName, pszName, ulNameLen);
+}
+
+
+#if REDCONF_READ_ONLY == 0
+/** @brief Forget the cached name, if any, at a given directory position.
+
+    @param ulPInode     The inode number of the directory.
+    @param ulEntryIdx   The position of the entry within the directory.
+*/
+static void DentryRemove(
+    uint32_t    ulPInode,
+    uint32_t    ulEntryIdx)
+{
+    uint32_t    ulIdx;
+
+    for(ulIdx = 0U; ulIdx < REDCONF_DENTRY_CACHE; ulIdx++)
+    {
+        DENTRY *pEntry = &gaaDentryCache[gbRedVolNum][ulIdx];
+
+        if((pEntry->ulPInode == ulPInode) && (pEntry->ulEntryIdx == ulEntryIdx))
+        {
+            pEntry->ulPInode = INODE_INVALID;
+        }
+    }
+}
+#endif
+#endif /* REDCONF_DENTRY_CACHE > 0U */
+
+
 #endif /* REDCONF_API_POSIX == 1 */
 
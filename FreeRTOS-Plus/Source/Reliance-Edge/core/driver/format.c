@@ -58,10 +58,15 @@ REDSTATUS RedVolFormat(void)
         MASTERBLOCK    *pMB;
         REDSTATUS       ret2;
 
+        ret = RedIoGetGeometry(gbRedVolNum);
+
         /*  Overwrite the master block with zeroes, so that if formatting is
             interrupted, the volume will not be mountable.
         */
-        ret = RedBufferGet(BLOCK_NUM_MASTER, BFLAG_NEW | BFLAG_DIRTY, CAST_VOID_PTR_PTR(&pMB));
+        if(ret == 0)
+        {
+            ret = RedBufferGet(BLOCK_NUM_MASTER, BFLAG_NEW | BFLAG_DIRTY, CAST_VOID_PTR_PTR(&pMB));
+        }
 
         if(ret == 0)
         {
@@ -75,7 +80,11 @@ REDSTATUS RedVolFormat(void)
             ret = RedIoFlush(gbRedVolNum);
         }
 
-      #if REDCONF_IMAP_EXTERNAL == 1
+        /*  With a quick format, the external imap nodes are not written here.
+            The high-water mark in the metaroot starts at zero, so all of the
+            nodes are treated as free until the driver first writes them.
+        */
+      #if (REDCONF_IMAP_EXTERNAL == 1) && (REDCONF_FORMAT_QUICK == 0)
         if((ret == 0) && !gpRedCoreVol->fImapInline)
         {
             uint32_t ulImapBlock;
@@ -113,6 +122,18 @@ REDSTATUS RedVolFormat(void)
             gpRedMR->ulFreeInodes = gpRedVolConf->ulInodeCount;
           #endif
             gpRedMR->ulAllocNextBlock = gpRedCoreVol->ulFirstAllocableBN;
+          #if (REDCONF_API_POSIX == 1) && (REDCONF_DEFERRED_DELETE > 0U)
+            gpRedMR->ulOrphanHead = INODE_INVALID;
+          #endif
+
+          #if REDCONF_ALLOC_ERASE_AWARE == 1
+            gpRedCoreVol->ulAllocMetaBlock = 0U;
+            gpRedCoreVol->fEraseBlocksFull = false;
+          #endif
+
+          #if REDCONF_IMAP_SUMMARY > 0U
+            RedImapSummaryReset();
+          #endif
 
             /*  The branched flag is typically set automatically when bits in
                 the imap change.  It is set here explicitly because the imap has
@@ -201,6 +222,15 @@ REDSTATUS RedVolFormat(void)
           #if (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_LINK == 1)
             pMB->bFlags |= MBFLAG_INODE_NLINK;
           #endif
+          #if (REDCONF_API_POSIX == 1) && (REDCONF_DEFERRED_DELETE > 0U)
+            pMB->bFlags |= MBFLAG_ORPHAN_LIST;
+          #endif
+          #if REDCONF_FORMAT_QUICK == 1
+            pMB->bFlags |= MBFLAG_IMAP_HIGH_WATER;
+          #endif
+          #if REDCONF_COMPRESSION == 1
+            pMB->bFlags |= MBFLAG_COMPRESSION;
+          #endif
 
             ret = RedBufferFlush(BLOCK_NUM_MASTER, 1U);
 
@@ -28,11 +28,33 @@
     This module implements routines for working with the imap, a bitmap which
     tracks which blocks are allocated or free.  Some of the functionality is
     delegated to imapinline.c and imapextern.c.
+
+    Blocks are allocated by moving an allocation pointer forward through the
+    volume.  When REDCONF_ALLOC_ERASE_AWARE is enabled and the block device
+    reports its erase block size, metadata and file data are given separate
+    allocation pointers, and each pointer which reaches the end of an erase
+    block moves on to an erase block which is entirely free, if there is one.
+    Each erase block is thus filled by one kind of write before the next is
+    started, and frequently rewritten metadata does not share erase blocks with
+    file data, which reduces garbage collection in the flash device.
 */
 #include <redfs.h>
 #include <redcore.h>
 
 
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_IMAP_SUMMARY > 0U)
+#define SUMMARY_BITS    (REDCONF_IMAP_SUMMARY * 8U)
+
+static bool SummaryIsFull(uint32_t ulBlock);
+static void SummarySet(uint32_t ulBlock, bool fFull);
+#endif
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_ALLOC_ERASE_AWARE == 1)
+static REDSTATUS EraseBlockSeek(uint32_t ulEraseBlocks, uint32_t *pulNext);
+static REDSTATUS EraseBlockIsFree(uint32_t ulStart, uint32_t ulEnd, bool *pfFree);
+#endif
+
+
 /** @brief Get the allocation bit of a block from either metaroot.
 
     Will pass the call down either to the inline imap or to the external imap
@@ -170,6 +192,14 @@ REDSTATUS RedImapBlockSet(
         {
             bool fWasAllocated;
 
+          #if REDCONF_IMAP_SUMMARY > 0U
+            /*  The block is now either free or almost free; either way, it
+                will be free no later than the next transaction, so its range
+                can no longer be considered full.
+            */
+            SummarySet(ulBlock, false);
+          #endif
+
             /*  Whether the block became free or almost free depends on its
                 previous allocation state.  If it was used, then it is now
                 almost free.  Otherwise, it was new and is now free.
@@ -197,6 +227,8 @@ REDSTATUS RedImapBlockSet(
 
 /** @brief Allocate one block.
 
+    @param type     What the block is for, which may determine where it is
+                    allocated.
     @param pulBlock On successful return, populated with the allocated block
                     number.
 
@@ -208,9 +240,10 @@ REDSTATUS RedImapBlockSet(
     @retval -RED_ENOSPC Insufficient free space to perform the allocation.
 */
 REDSTATUS RedImapAllocBlock(
+    ALLOCTYPE   type,
     uint32_t   *pulBlock)
 {
-    REDSTATUS   ret;
+    REDSTATUS   ret = 0;
 
     if(pulBlock == NULL)
     {
@@ -223,38 +256,108 @@ REDSTATUS RedImapAllocBlock(
     }
     else
     {
-        uint32_t ulStopBlock = gpRedMR->ulAllocNextBlock;
-        bool     fAllocated = false;
+        uint32_t *pulNext = &gpRedMR->ulAllocNextBlock;
+        uint32_t  ulBlocksLeft = gpRedVolume->ulBlocksAllocable;
+        bool      fAllocated = false;
+      #if REDCONF_IMAP_SUMMARY > 0U
+        bool      fRangeFull = false;
+      #endif
+
+      #if REDCONF_ALLOC_ERASE_AWARE == 1
+        uint32_t  ulEraseBlocks = RedIoEraseBlocks(gbRedVolNum);
 
-        do
+        if(ulEraseBlocks != 0U)
         {
-            ALLOCSTATE state;
+            if(type == ALLOCTYPE_META)
+            {
+                pulNext = &gpRedCoreVol->ulAllocMetaBlock;
+            }
 
-            ret = RedImapBlockState(gpRedMR->ulAllocNextBlock, &state);
-            CRITICAL_ASSERT(ret == 0);
+            ret = EraseBlockSeek(ulEraseBlocks, pulNext);
+        }
+      #else
+        (void)type;
+      #endif
 
-            if(ret == 0)
+        while((ret == 0) && !fAllocated && (ulBlocksLeft > 0U))
+        {
+            uint32_t    ulBlock = *pulNext;
+            uint32_t    ulSkip = 1U;
+          #if REDCONF_IMAP_SUMMARY > 0U
+            uint32_t    ulRangeSize = 1UL << gpRedCoreVol->bImapSummaryShift;
+            uint32_t    ulRangeOffset = (ulBlock - gpRedCoreVol->ulFirstAllocableBN) & (ulRangeSize - 1U);
+            uint32_t    ulRangeLeft = REDMIN(ulRangeSize - ulRangeOffset, gpRedVolume->ulBlockCount - ulBlock);
+
+            if(SummaryIsFull(ulBlock))
+            {
+                /*  No free blocks in the rest of this range, skip over it.
+                */
+                ulSkip = ulRangeLeft;
+            }
+            else
+          #endif
             {
-                if(state == ALLOCSTATE_FREE)
+                ALLOCSTATE state;
+
+                ret = RedImapBlockState(ulBlock, &state);
+                CRITICAL_ASSERT(ret == 0);
+
+                if(ret == 0)
                 {
-                    ret = RedImapBlockSet(gpRedMR->ulAllocNextBlock, true);
-                    CRITICAL_ASSERT(ret == 0);
+                  #if REDCONF_IMAP_SUMMARY > 0U
+                    /*  A range can be marked full only if it was examined from
+                        its first block to its last.
+                    */
+                    if(ulRangeOffset == 0U)
+                    {
+                        fRangeFull = true;
+                    }
+                  #endif
+
+                    if(state == ALLOCSTATE_FREE)
+                    {
+                        ret = RedImapBlockSet(ulBlock, true);
+                        CRITICAL_ASSERT(ret == 0);
 
-                    *pulBlock = gpRedMR->ulAllocNextBlock;
-                    fAllocated = true;
+                        *pulBlock = ulBlock;
+                        fAllocated = true;
+                    }
+                  #if REDCONF_IMAP_SUMMARY > 0U
+                    else if(state == ALLOCSTATE_AFREE)
+                    {
+                        /*  Almost free blocks become free at the next
+                            transaction, so a range containing one is not full.
+                        */
+                        fRangeFull = false;
+                    }
+                    else if(fRangeFull && (ulRangeLeft == 1U))
+                    {
+                        SummarySet(ulBlock, true);
+                    }
+                    else
+                    {
+                        /*  Not the last block of a range which is known to be
+                            full; nothing to record.
+                        */
+                    }
+                  #endif
                 }
+            }
 
-                /*  Increment the next block number, wrapping it when the end of
+            if(ret == 0)
+            {
+                /*  Advance the next block number, wrapping it when the end of
                     the volume is reached.
                 */
-                gpRedMR->ulAllocNextBlock++;
-                if(gpRedMR->ulAllocNextBlock == gpRedVolume->ulBlockCount)
+                *pulNext += ulSkip;
+                if(*pulNext == gpRedVolume->ulBlockCount)
                 {
-                    gpRedMR->ulAllocNextBlock = gpRedCoreVol->ulFirstAllocableBN;
+                    *pulNext = gpRedCoreVol->ulFirstAllocableBN;
                 }
+
+                ulBlocksLeft -= REDMIN(ulSkip, ulBlocksLeft);
             }
         }
-        while((ret == 0) && !fAllocated && (gpRedMR->ulAllocNextBlock != ulStopBlock));
 
         if((ret == 0) && !fAllocated)
         {
@@ -269,6 +372,297 @@ REDSTATUS RedImapAllocBlock(
 
     return ret;
 }
+
+
+/** @brief Allocate a run of physically contiguous blocks.
+
+    The first block is allocated as with RedImapAllocBlock(); the run is then
+    extended for as long as the blocks which immediately follow it are free, up
+    to @p ulMaxBlocks.  Since allocation proceeds forward from the allocation
+    pointer, this yields contiguous extents unless the free space is
+    fragmented.
+
+    The caller is responsible for ensuring that @p ulMaxBlocks does not exceed
+    the number of blocks it is allowed to allocate, taking reserved blocks into
+    account.
+
+    @param ulMaxBlocks  The maximum number of blocks to allocate.
+    @param pulBlock     On successful return, populated with the first block
+                        number of the allocated run.
+    @param pulCount     On successful return, populated with the number of
+                        blocks allocated, from 1 to @p ulMaxBlocks.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p ulMaxBlocks is zero; or @p pulBlock or @p pulCount is
+                        `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOSPC Insufficient free space to perform the allocation.
+*/
+REDSTATUS RedImapAllocRun(
+    uint32_t    ulMaxBlocks,
+    uint32_t   *pulBlock,
+    uint32_t   *pulCount)
+{
+    REDSTATUS   ret;
+
+    if((ulMaxBlocks == 0U) || (pulBlock == NULL) || (pulCount == NULL))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        ret = RedImapAllocBlock(ALLOCTYPE_DATA, pulBlock);
+
+        if(ret == 0)
+        {
+            uint32_t ulCount = 1U;
+            bool     fExtend = true;
+
+            /*  RedImapAllocBlock() leaves the allocation pointer on the block
+                after the one it allocated, unless it wrapped to the start of
+                the volume, in which case the run cannot be extended.
+            */
+            while(    (ret == 0)
+                   && fExtend
+                   && (ulCount < ulMaxBlocks)
+                   && (gpRedMR->ulFreeBlocks > 0U)
+                   && (gpRedMR->ulAllocNextBlock == (*pulBlock + ulCount)))
+            {
+                ALLOCSTATE state;
+
+                ret = RedImapBlockState(gpRedMR->ulAllocNextBlock, &state);
+                CRITICAL_ASSERT(ret == 0);
+
+                if((ret == 0) && (state != ALLOCSTATE_FREE))
+                {
+                    fExtend = false;
+                }
+
+                if((ret == 0) && fExtend)
+                {
+                    ret = RedImapBlockSet(gpRedMR->ulAllocNextBlock, true);
+                    CRITICAL_ASSERT(ret == 0);
+                }
+
+                if((ret == 0) && fExtend)
+                {
+                    ulCount++;
+
+                    gpRedMR->ulAllocNextBlock++;
+                    if(gpRedMR->ulAllocNextBlock == gpRedVolume->ulBlockCount)
+                    {
+                        gpRedMR->ulAllocNextBlock = gpRedCoreVol->ulFirstAllocableBN;
+                    }
+                }
+            }
+
+            if(ret == 0)
+            {
+                *pulCount = ulCount;
+            }
+        }
+    }
+
+    return ret;
+}
+
+
+#if REDCONF_IMAP_SUMMARY > 0U
+/** @brief Discard the allocation summary for the current volume.
+
+    Must be called whenever the imap is loaded or reinitialized, since the
+    summary describes the imap in memory.  Also sizes the summary ranges for
+    the current volume.
+*/
+void RedImapSummaryReset(void)
+{
+    uint8_t bShift = 0U;
+
+    while(((gpRedVolume->ulBlocksAllocable - 1U) >> bShift) >= SUMMARY_BITS)
+    {
+        bShift++;
+    }
+
+    gpRedCoreVol->bImapSummaryShift = bShift;
+    RedMemSet(gpRedCoreVol->abImapSummary, 0U, sizeof(gpRedCoreVol->abImapSummary));
+}
+
+
+/** @brief Determine whether the summary range containing a block is full.
+
+    @param ulBlock  An allocable block number.
+
+    @return Whether the range containing @p ulBlock is known to have no free
+            blocks.
+*/
+static bool SummaryIsFull(
+    uint32_t    ulBlock)
+{
+    uint32_t    ulBit = (ulBlock - gpRedCoreVol->ulFirstAllocableBN) >> gpRedCoreVol->bImapSummaryShift;
+
+    REDASSERT(ulBit < SUMMARY_BITS);
+
+    return RedBitGet(gpRedCoreVol->abImapSummary, ulBit);
+}
+
+
+/** @brief Update the summary range containing a block.
+
+    @param ulBlock  An allocable block number.
+    @param fFull    Whether the range containing @p ulBlock is known to have no
+                    free blocks.
+*/
+static void SummarySet(
+    uint32_t    ulBlock,
+    bool        fFull)
+{
+    uint32_t    ulBit = (ulBlock - gpRedCoreVol->ulFirstAllocableBN) >> gpRedCoreVol->bImapSummaryShift;
+
+    REDASSERT(ulBit < SUMMARY_BITS);
+
+    if(fFull)
+    {
+        RedBitSet(gpRedCoreVol->abImapSummary, ulBit);
+    }
+    else
+    {
+        RedBitClear(gpRedCoreVol->abImapSummary, ulBit);
+    }
+}
+#endif /* REDCONF_IMAP_SUMMARY > 0U */
+
+
+#if REDCONF_ALLOC_ERASE_AWARE == 1
+/** @brief Move an allocation pointer which is at the start of an erase block
+           to an erase block which is entirely free.
+
+    A pointer in the middle of an erase block is left alone, so that the rest
+    of that erase block is filled first.  A pointer at the start of one is moved
+    to the first empty erase block at or after it, wrapping at the end of the
+    volume.  If there is no empty erase block, the pointer is left alone and
+    the allocation takes the next free block, as it would without an erase
+    block size.
+
+    @param ulEraseBlocks    The number of blocks in an erase block.
+    @param pulNext          The allocation pointer to move.  Zero if it has not
+                            been placed yet, in which case it is moved to an
+                            empty erase block or else to the file data
+                            allocation pointer.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS EraseBlockSeek(
+    uint32_t    ulEraseBlocks,
+    uint32_t   *pulNext)
+{
+    REDSTATUS   ret = 0;
+    uint32_t    ulOffset;
+
+    if((ulEraseBlocks & (ulEraseBlocks - 1U)) == 0U)
+    {
+        ulOffset = *pulNext & (ulEraseBlocks - 1U);
+    }
+    else
+    {
+        ulOffset = *pulNext % ulEraseBlocks;
+    }
+
+    if((ulOffset == 0U) && !gpRedCoreVol->fEraseBlocksFull)
+    {
+        uint32_t    ulStart = *pulNext;
+        uint32_t    ulTries = (gpRedVolume->ulBlockCount / ulEraseBlocks) + 1U;
+        bool        fFound = false;
+
+        while((ret == 0) && !fFound && (ulTries > 0U))
+        {
+            uint32_t ulEnd = ulStart + REDMIN(ulEraseBlocks, gpRedVolume->ulBlockCount - ulStart);
+
+            /*  An erase block shared with the blocks before the first allocable
+                block is never empty.
+            */
+            if(ulStart >= gpRedCoreVol->ulFirstAllocableBN)
+            {
+                ret = EraseBlockIsFree(ulStart, ulEnd, &fFound);
+            }
+
+            if((ret == 0) && !fFound)
+            {
+                ulStart = (ulEnd == gpRedVolume->ulBlockCount) ? 0U : ulEnd;
+                ulTries--;
+            }
+        }
+
+        if(ret == 0)
+        {
+            if(fFound)
+            {
+                *pulNext = ulStart;
+            }
+            else
+            {
+                gpRedCoreVol->fEraseBlocksFull = true;
+            }
+        }
+    }
+
+    if((ret == 0) && (*pulNext == 0U))
+    {
+        *pulNext = gpRedMR->ulAllocNextBlock;
+    }
+
+    return ret;
+}
+
+
+/** @brief Determine whether a range of blocks is entirely free.
+
+    @param ulStart  The first block in the range.
+    @param ulEnd    The block after the last one in the range.
+    @param pfFree   On successful return, populated with whether every block in
+                    the range is free.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS EraseBlockIsFree(
+    uint32_t    ulStart,
+    uint32_t    ulEnd,
+    bool       *pfFree)
+{
+    REDSTATUS   ret = 0;
+    uint32_t    ulBlock = ulStart;
+    bool        fFree = true;
+
+    while((ret == 0) && fFree && (ulBlock < ulEnd))
+    {
+        ALLOCSTATE state;
+
+        ret = RedImapBlockState(ulBlock, &state);
+
+        if((ret == 0) && (state != ALLOCSTATE_FREE))
+        {
+            fFree = false;
+        }
+
+        ulBlock++;
+    }
+
+    if(ret == 0)
+    {
+        *pfFree = fFree;
+    }
+
+    return ret;
+}
+#endif /* REDCONF_ALLOC_ERASE_AWARE == 1 */
 #endif /* REDCONF_READ_ONLY == 0 */
 
 
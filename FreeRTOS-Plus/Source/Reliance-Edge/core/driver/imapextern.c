@@ -40,6 +40,9 @@
 #if REDCONF_READ_ONLY == 0
 static REDSTATUS ImapNodeBranch(uint32_t ulImapNode, IMAPNODE **ppImap);
 static bool ImapNodeIsBranched(uint32_t ulImapNode);
+#if REDCONF_FORMAT_QUICK == 1
+static REDSTATUS ImapNodeInit(uint32_t ulImapNode);
+#endif
 #endif
 
 
@@ -95,13 +98,26 @@ REDSTATUS RedImapEBlockGet(
         }
       #endif
 
-        ret = RedBufferGet(RedImapNodeBlock(bMRToRead, ulImapNode), BFLAG_META_IMAP, CAST_VOID_PTR_PTR(&pImap));
-
-        if(ret == 0)
+      #if REDCONF_FORMAT_QUICK == 1
+        /*  Imap nodes past the high-water mark have never been written, so
+            every block they cover is free and there is nothing to read.
+        */
+        if(ulImapNode >= gpRedCoreVol->aMR[bMRToRead].ulImapHighWater)
         {
-            *pfAllocated = RedBitGet(pImap->abEntries, ulOffset % IMAPNODE_ENTRIES);
+            *pfAllocated = false;
+            ret = 0;
+        }
+        else
+      #endif
+        {
+            ret = RedBufferGet(RedImapNodeBlock(bMRToRead, ulImapNode), BFLAG_META_IMAP, CAST_VOID_PTR_PTR(&pImap));
 
-            RedBufferPut(pImap);
+            if(ret == 0)
+            {
+                *pfAllocated = RedBitGet(pImap->abEntries, ulOffset % IMAPNODE_ENTRIES);
+
+                RedBufferPut(pImap);
+            }
         }
     }
 
@@ -204,9 +220,16 @@ static REDSTATUS ImapNodeBranch(
     }
     else if(ImapNodeIsBranched(ulImapNode))
     {
-        /*  Imap node is already branched, so just get it buffered dirty.
-        */
-        ret = RedBufferGet(RedImapNodeBlock(gpRedCoreVol->bCurMR, ulImapNode), BFLAG_META_IMAP | BFLAG_DIRTY, CAST_VOID_PTR_PTR(ppImap));
+      #if REDCONF_FORMAT_QUICK == 1
+        ret = ImapNodeInit(ulImapNode);
+
+        if(ret == 0)
+      #endif
+        {
+            /*  Imap node is already branched, so just get it buffered dirty.
+            */
+            ret = RedBufferGet(RedImapNodeBlock(gpRedCoreVol->bCurMR, ulImapNode), BFLAG_META_IMAP | BFLAG_DIRTY, CAST_VOID_PTR_PTR(ppImap));
+        }
     }
     else
     {
@@ -261,12 +284,63 @@ static bool ImapNodeIsBranched(
 {
     bool        fNodeBitSetInMetaroot0 = RedBitGet(gpRedCoreVol->aMR[0U].abEntries, ulImapNode);
     bool        fNodeBitSetInMetaroot1 = RedBitGet(gpRedCoreVol->aMR[1U].abEntries, ulImapNode);
+    bool        fBranched;
 
     /*  If the imap node is not branched, both metaroots will point to the same
         copy of the node.
     */
-    return fNodeBitSetInMetaroot0 != fNodeBitSetInMetaroot1;
+    fBranched = fNodeBitSetInMetaroot0 != fNodeBitSetInMetaroot1;
+
+  #if REDCONF_FORMAT_QUICK == 1
+    /*  A node past the committed state high-water mark does not exist in the
+        committed state, so the working state may write it in place.
+    */
+    if(ulImapNode >= gpRedCoreVol->aMR[1U - gpRedCoreVol->bCurMR].ulImapHighWater)
+    {
+        fBranched = true;
+    }
+  #endif
+
+    return fBranched;
+}
+
+
+#if REDCONF_FORMAT_QUICK == 1
+/** @brief Write zeroed copies of the imap nodes up to and including the given
+           node, if they are past the working state high-water mark.
+
+    The high-water mark must only cover nodes which have been written, so any
+    nodes skipped over on the way to @p ulImapNode are zeroed as well.
+
+    @param ulImapNode   The imap node about to be modified.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS ImapNodeInit(
+    uint32_t    ulImapNode)
+{
+    REDSTATUS   ret = 0;
+
+    while((ret == 0) && (gpRedMR->ulImapHighWater <= ulImapNode))
+    {
+        IMAPNODE *pImap;
+
+        ret = RedBufferGet(RedImapNodeBlock(gpRedCoreVol->bCurMR, gpRedMR->ulImapHighWater), (uint16_t)((uint32_t)BFLAG_META_IMAP | BFLAG_NEW | BFLAG_DIRTY), CAST_VOID_PTR_PTR(&pImap));
+
+        if(ret == 0)
+        {
+            RedBufferPut(pImap);
+
+            gpRedMR->ulImapHighWater++;
+        }
+    }
+
+    return ret;
 }
+#endif
 #endif /* REDCONF_READ_ONLY == 0 */
 
 
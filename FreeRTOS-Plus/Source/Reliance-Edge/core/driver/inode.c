@@ -35,14 +35,61 @@ static REDSTATUS InodeIsBranched(uint32_t ulInode, bool *pfIsBranched);
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
 static REDSTATUS InodeFindFree(uint32_t *pulInode);
 #endif
+#if DELETE_SUPPORTED && DEFERRED_DELETE_SUPPORTED
+static REDSTATUS InodeOrphan(CINODE *pInode);
+#endif
 #if REDCONF_READ_ONLY == 0
 static REDSTATUS InodeGetWriteableCopy(uint32_t ulInode, uint8_t *pbWhich);
 #endif
-static REDSTATUS InodeGetCurrentCopy(uint32_t ulInode, uint8_t *pbWhich);
+static REDSTATUS InodeMount(CINODE *pInode, uint8_t bMR, FTYPE type, bool fBranch);
+static REDSTATUS InodeGetCurrentCopy(uint8_t bMR, uint32_t ulInode, uint8_t *pbWhich);
 #if REDCONF_READ_ONLY == 0
 static REDSTATUS InodeBitSet(uint32_t ulInode, uint8_t bWhich, bool fAllocated);
 #endif
 static uint32_t InodeBlock(uint32_t ulInode, uint8_t bWhich);
+static void InodeMetaCopy(INODEMETA *pMeta, const INODE *pInodeBuf);
+#if REDCONF_INODE_CACHE > 0U
+static void InodeCacheUpdate(const CINODE *pInode);
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
+static void InodeCacheRemove(uint32_t ulInode);
+#endif
+#endif
+
+
+#if REDCONF_INODE_CACHE > 0U
+/** @brief An entry in the inode metadata cache.
+
+    The cache remembers the stat metadata of recently used inodes, so that
+    querying it (red_fstat(), red_lseek() with #RED_SEEK_END, and so on) does
+    not need an inode buffer, or the imap lookups which locate the inode.
+    Entries are refreshed from the inode buffer whenever a cached inode
+    structure is put, which is the only way an inode is modified, so they are
+    never stale.
+
+    Each entry also remembers the seek coordinates the inode was put with, so
+    that the next operation on the inode, such as the next read or write of a
+    sequential stream, steps from them rather than computing its coordinates
+    from scratch.  Only the entry indexes are remembered, which depend on
+    nothing but the logical block: the physical block numbers along the path
+    may have changed by the next operation, and are looked up again.
+*/
+typedef struct
+{
+    uint32_t    ulInode;        /**< Inode number; INODE_INVALID if unused. */
+    INODEMETA   meta;           /**< The metadata of the inode. */
+    bool        fCoordHint;     /**< Whether the seek coordinates below are valid. */
+    uint32_t    ulLogicalBlock; /**< Logical block of the remembered coordinates. */
+    uint16_t    uInodeEntry;    /**< Inode entry of the remembered coordinates. */
+  #if DINDIR_POINTERS > 0U
+    uint16_t    uDindirEntry;   /**< Double indirect entry of the remembered coordinates. */
+  #endif
+  #if REDCONF_DIRECT_POINTERS < INODE_ENTRIES
+    uint16_t    uIndirEntry;    /**< Indirect entry of the remembered coordinates. */
+  #endif
+} INODECACHE;
+
+static INODECACHE gaaInodeCache[REDCONF_VOLUME_COUNT][REDCONF_INODE_CACHE];
+#endif
 
 
 /** @brief Mount an existing inode.
@@ -71,6 +118,75 @@ REDSTATUS RedInodeMount(
     CINODE     *pInode,
     FTYPE       type,
     bool        fBranch)
+{
+    return InodeMount(pInode, gpRedCoreVol->bCurMR, type, fBranch);
+}
+
+
+#if SNAPSHOT_SUPPORTED
+/** @brief Mount an existing inode as it is in the pinned snapshot.
+
+    The snapshot is the committed state, which is never modified while it is
+    pinned.  The inode is mounted read-only: it must not be branched or
+    written, and the caches of the working state are not used or updated for
+    it.
+
+    @param pInode   A pointer to the cached inode structure.  The
+                    pInode->ulInode field must already be initialized with the
+                    inode number to mount.  All other fields will be discarded.
+    @param type     The expected inode type.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EINVAL     Invalid parameters.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_EBADF      The inode number is free in the snapshot; or the
+                            inode number is not valid.
+    @retval -RED_EISDIR     @p type is ::FTYPE_FILE and the inode is a directory.
+    @retval -RED_ENOTDIR    @p type is ::FTYPE_DIR and the inode is a file.
+*/
+REDSTATUS RedInodeMountSnapshot(
+    CINODE     *pInode,
+    FTYPE       type)
+{
+    REDSTATUS   ret;
+
+    REDASSERT(gpRedCoreVol->fSnapshot);
+
+    ret = InodeMount(pInode, 1U - gpRedCoreVol->bCurMR, type, false);
+
+    if(ret == 0)
+    {
+        /*  Whether the working state has branched the inode is irrelevant:
+            the snapshot copy is never written.
+        */
+        pInode->fBranched = false;
+    }
+
+    return ret;
+}
+#endif
+
+
+/** @brief Mount an existing inode, as it is in the state of a given metaroot.
+
+    @param pInode   A pointer to the cached inode structure.  The
+                    pInode->ulInode field must already be initialized with the
+                    inode number to mount.  All other fields will be discarded.
+    @param bMR      The metaroot index: either the working state metaroot, or
+                    (for the pinned snapshot) the committed state metaroot.
+    @param type     The expected inode type.
+    @param fBranch  Whether to branch the inode.
+
+    @return A negated ::REDSTATUS code indicating the operation result; see
+            RedInodeMount().
+*/
+static REDSTATUS InodeMount(
+    CINODE     *pInode,
+    uint8_t     bMR,
+    FTYPE       type,
+    bool        fBranch)
 {
     REDSTATUS   ret = 0;
 
@@ -104,7 +220,11 @@ REDSTATUS RedInodeMount(
         RedMemSet(pInode, 0U, sizeof(*pInode));
         pInode->ulInode = ulInode;
 
-        ret = InodeGetCurrentCopy(pInode->ulInode, &bWhich);
+      #if SNAPSHOT_SUPPORTED
+        pInode->fSnapshot = bMR != gpRedCoreVol->bCurMR;
+      #endif
+
+        ret = InodeGetCurrentCopy(bMR, pInode->ulInode, &bWhich);
 
         if(ret == 0)
         {
@@ -151,6 +271,30 @@ REDSTATUS RedInodeMount(
             }
         }
 
+      #if REDCONF_INODE_CACHE > 0U
+        if(ret == 0)
+        {
+            const INODECACHE *pEntry = &gaaInodeCache[gbRedVolNum][pInode->ulInode % REDCONF_INODE_CACHE];
+
+          #if SNAPSHOT_SUPPORTED
+            if(!pInode->fSnapshot && (pEntry->ulInode == pInode->ulInode) && pEntry->fCoordHint)
+          #else
+            if((pEntry->ulInode == pInode->ulInode) && pEntry->fCoordHint)
+          #endif
+            {
+                pInode->fCoordHint = true;
+                pInode->ulLogicalBlock = pEntry->ulLogicalBlock;
+                pInode->uInodeEntry = pEntry->uInodeEntry;
+              #if DINDIR_POINTERS > 0U
+                pInode->uDindirEntry = pEntry->uDindirEntry;
+              #endif
+              #if REDCONF_DIRECT_POINTERS < INODE_ENTRIES
+                pInode->uIndirEntry = pEntry->uIndirEntry;
+              #endif
+            }
+        }
+      #endif
+
       #if REDCONF_READ_ONLY == 0
         if((ret == 0) && fBranch)
         {
@@ -168,6 +312,140 @@ REDSTATUS RedInodeMount(
 }
 
 
+/** @brief Get the stat metadata of an inode.
+
+    If the inode is in the inode metadata cache, the metadata is returned
+    without mounting the inode.
+
+    @param ulInode  The inode number.
+    @param type     The expected inode type.
+    @param pMeta    On successful return, populated with the inode metadata.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EINVAL     @p pMeta is `NULL`.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_EBADF      The inode number is free; or the inode number is not
+                            valid.
+    @retval -RED_EISDIR     @p type is ::FTYPE_FILE and the inode is a directory.
+    @retval -RED_ENOTDIR    @p type is ::FTYPE_DIR and the inode is a file.
+*/
+REDSTATUS RedInodeMetaGet(
+    uint32_t    ulInode,
+    FTYPE       type,
+    INODEMETA  *pMeta)
+{
+    REDSTATUS   ret;
+
+    if(pMeta == NULL)
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else if(!INODE_IS_VALID(ulInode))
+    {
+        ret = -RED_EBADF;
+    }
+    else
+    {
+        bool fCached = false;
+
+      #if REDCONF_INODE_CACHE > 0U
+        const INODECACHE *pEntry = &gaaInodeCache[gbRedVolNum][ulInode % REDCONF_INODE_CACHE];
+
+        if(pEntry->ulInode == ulInode)
+        {
+            *pMeta = pEntry->meta;
+            fCached = true;
+        }
+      #endif
+
+        if(fCached)
+        {
+            ret = 0;
+
+          #if REDCONF_API_POSIX == 1
+            if((type == FTYPE_DIR) && !RED_S_ISDIR(pMeta->uMode))
+            {
+                ret = -RED_ENOTDIR;
+            }
+            else if((type == FTYPE_FILE) && RED_S_ISDIR(pMeta->uMode))
+            {
+                ret = -RED_EISDIR;
+            }
+            else
+            {
+                /*  The inode is of the expected type.
+                */
+            }
+          #endif
+        }
+        else
+        {
+            CINODE ino;
+
+            ino.ulInode = ulInode;
+            ret = RedInodeMount(&ino, type, false);
+
+            if(ret == 0)
+            {
+                InodeMetaCopy(pMeta, ino.pInodeBuf);
+
+                RedInodePut(&ino, 0U);
+            }
+        }
+    }
+
+    return ret;
+}
+
+
+
+#if SNAPSHOT_SUPPORTED
+/** @brief Get the stat metadata of an inode as it is in the pinned snapshot.
+
+    @param ulInode  The inode number.
+    @param pMeta    On successful return, populated with the inode metadata.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EINVAL     @p pMeta is `NULL`.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_EBADF      The inode number is free in the snapshot; or the
+                            inode number is not valid.
+*/
+REDSTATUS RedInodeSnapMetaGet(
+    uint32_t    ulInode,
+    INODEMETA  *pMeta)
+{
+    REDSTATUS   ret;
+
+    if(pMeta == NULL)
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        CINODE ino;
+
+        ino.ulInode = ulInode;
+        ret = RedInodeMountSnapshot(&ino, FTYPE_EITHER);
+
+        if(ret == 0)
+        {
+            InodeMetaCopy(pMeta, ino.pInodeBuf);
+
+            RedInodePut(&ino, 0U);
+        }
+    }
+
+    return ret;
+}
+#endif
+
 #if (REDCONF_READ_ONLY == 0) && ((REDCONF_API_POSIX == 1) || FORMAT_SUPPORTED)
 /** @brief Create an inode.
 
@@ -316,6 +594,12 @@ REDSTATUS RedInodeCreate(
 #if DELETE_SUPPORTED
 /** @brief Delete an inode.
 
+    With deferred deletion enabled (REDCONF_DEFERRED_DELETE is nonzero), a file
+    with more than REDCONF_DEFERRED_DELETE blocks of data is not freed here:
+    instead it is added to the orphan list in the metaroot, and its blocks are
+    freed later by RedInodeOrphanReclaim().  The inode stays mounted in that
+    case, so the caller must still put it.
+
     @param pInode   Pointer to the cached inode structure.
 
     @return A negated ::REDSTATUS code indicating the operation result.
@@ -336,14 +620,23 @@ REDSTATUS RedInodeDelete(
     }
     else
     {
-        if(pInode->pInodeBuf->ullSize != 0U)
+      #if DEFERRED_DELETE_SUPPORTED
+        if(!pInode->fDirectory && (pInode->pInodeBuf->ullSize > ((uint64_t)REDCONF_DEFERRED_DELETE << BLOCK_SIZE_P2)))
         {
-            ret = RedInodeDataTruncate(pInode, UINT64_SUFFIX(0));
+            ret = InodeOrphan(pInode);
         }
-
-        if(ret == 0)
+        else
+      #endif
         {
-            ret = RedInodeFree(pInode);
+            if(pInode->pInodeBuf->ullSize != 0U)
+            {
+                ret = RedInodeDataTruncate(pInode, UINT64_SUFFIX(0));
+            }
+
+            if(ret == 0)
+            {
+                ret = RedInodeFree(pInode);
+            }
         }
     }
 
@@ -351,6 +644,42 @@ REDSTATUS RedInodeDelete(
 }
 
 
+#if DEFERRED_DELETE_SUPPORTED
+/** @brief Add an inode which has no more names to the orphan list.
+
+    This takes constant time however large the file is.  The orphan list is
+    linked through the ulPInode field of the orphaned inodes, which is only
+    meaningful for directories, and its head is in the metaroot, so the list
+    is committed (or not) atomically with the directory entry deletion.
+
+    @param pInode   A pointer to the cached inode structure.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS InodeOrphan(
+    CINODE     *pInode)
+{
+    REDSTATUS   ret;
+
+    ret = RedInodeBranch(pInode);
+
+    if(ret == 0)
+    {
+      #if REDCONF_API_POSIX_LINK == 1
+        pInode->pInodeBuf->uNLink = 0U;
+      #endif
+        pInode->pInodeBuf->ulPInode = gpRedMR->ulOrphanHead;
+        gpRedMR->ulOrphanHead = pInode->ulInode;
+    }
+
+    return ret;
+}
+#endif
+
+
 /** @brief Decrement an inode link count and delete the inode if the link count
            falls to zero.
 
@@ -392,6 +721,92 @@ REDSTATUS RedInodeLinkDec(
 #endif /* DELETE_SUPPORTED */
 
 
+#if DEFERRED_DELETE_SUPPORTED
+/** @brief Free the blocks of deleted files on the orphan list.
+
+    Files are truncated from the end, at most @p ulMaxBlocks blocks at a time,
+    and each file's inode is freed and removed from the list once it is empty.
+    Every intermediate state is a consistent volume: the orphan is a smaller
+    file which is still on the list, so whichever state the next transaction
+    point commits, reclamation resumes from it after the volume is next
+    mounted.  The freed blocks become available for allocation after the next
+    transaction point, as usual.
+
+    @param ulMaxBlocks  The maximum number of file data blocks to free.  An
+                        orphan with no data blocks counts as one block, and at
+                        least one block is always freed if the list is not
+                        empty.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  The orphan list contains an inode which is free.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedInodeOrphanReclaim(
+    uint32_t    ulMaxBlocks)
+{
+    REDSTATUS   ret = 0;
+    uint32_t    ulBudget = (ulMaxBlocks == 0U) ? 1U : ulMaxBlocks;
+
+    while((ret == 0) && (ulBudget > 0U) && (gpRedMR->ulOrphanHead != INODE_INVALID))
+    {
+        CINODE ino;
+
+        ino.ulInode = gpRedMR->ulOrphanHead;
+        ret = RedInodeMount(&ino, FTYPE_FILE, true);
+
+        if(ret == 0)
+        {
+            uint32_t ulBlocks = (uint32_t)((ino.pInodeBuf->ullSize + (REDCONF_BLOCK_SIZE - 1U)) >> BLOCK_SIZE_P2);
+
+          #if RESERVED_BLOCKS > 0U
+            gpRedCoreVol->fUseReservedBlocks = true;
+          #endif
+
+            if(ulBlocks > ulBudget)
+            {
+                uint32_t ulKeep = ulBlocks - ulBudget;
+
+              #if COMPRESSION_SUPPORTED
+                /*  Truncating partway into a compressed cluster would expand
+                    it, using space instead of freeing it.
+                */
+                if((ino.pInodeBuf->uMode & RED_S_ICOMPR) != 0U)
+                {
+                    ulKeep -= ulKeep % CLUSTER_BLOCKS;
+                }
+              #endif
+
+                ret = RedInodeDataTruncate(&ino, (uint64_t)ulKeep << BLOCK_SIZE_P2);
+                ulBudget = 0U;
+            }
+            else
+            {
+                ret = RedInodeDataTruncate(&ino, UINT64_SUFFIX(0));
+
+                if(ret == 0)
+                {
+                    gpRedMR->ulOrphanHead = ino.pInodeBuf->ulPInode;
+                    ret = RedInodeFree(&ino);
+                }
+
+                ulBudget -= (ulBlocks == 0U) ? 1U : ulBlocks;
+            }
+
+          #if RESERVED_BLOCKS > 0U
+            gpRedCoreVol->fUseReservedBlocks = false;
+          #endif
+
+            RedInodePut(&ino, 0U);
+        }
+    }
+
+    return ret;
+}
+#endif /* DEFERRED_DELETE_SUPPORTED */
+
+
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
 /** @brief Free an inode.
 
@@ -420,6 +835,17 @@ REDSTATUS RedInodeFree(
         RedBufferDiscard(pInode->pInodeBuf);
         pInode->pInodeBuf = NULL;
 
+      #if REDCONF_INODE_CACHE > 0U
+        InodeCacheRemove(pInode->ulInode);
+      #endif
+
+      #if REDCONF_DENTRY_CACHE > 0U
+        if(pInode->fDirectory)
+        {
+            RedDirDentryPurge(pInode->ulInode);
+        }
+      #endif
+
         /*  Determine which of the two slots for the inode is currently
             allocated, and free that slot.
         */
@@ -466,6 +892,11 @@ REDSTATUS RedInodeFree(
             }
         }
 
+        if((ret == 0) && (pInode->ulInode < gpRedCoreVol->ulInodeFreeHint))
+        {
+            gpRedCoreVol->ulInodeFreeHint = pInode->ulInode;
+        }
+
         pInode->ulInode = INODE_INVALID;
 
         if(ret == 0)
@@ -542,6 +973,15 @@ void RedInodePut(
             (void)bTimeFields;
           #endif
 
+          #if REDCONF_INODE_CACHE > 0U
+          #if SNAPSHOT_SUPPORTED
+            if(!pInode->fSnapshot)
+          #endif
+            {
+                InodeCacheUpdate(pInode);
+            }
+          #endif
+
             RedBufferPut(pInode->pInodeBuf);
             pInode->pInodeBuf = NULL;
         }
@@ -776,6 +1216,63 @@ REDSTATUS RedInodeBranch(
 #endif /* REDCONF_READ_ONLY == 0 */
 
 
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_ATIME == 1)
+/** @brief Branch an inode which is being read, if its access time is due to
+           be updated.
+
+    With strict access time updates, every read updates the access time.  With
+    relaxed updates (see RedCoreRelatimeSet()), the access time is only updated
+    if it is not newer than the modification or change time, or if it has
+    reached the configured age.  Otherwise the inode is left alone, so the read
+    dirties no metadata.
+
+    @param pInode   Pointer to the cached inode structure which has already been
+                    mounted.
+    @param pfUpdate On successful return, populated with whether the access
+                    time should be updated, by passing #IPUT_UPDATE_ATIME to
+                    RedInodePut().  If true, the inode has been branched.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL Invalid parameters.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedInodeAtimeBranch(
+    CINODE     *pInode,
+    bool       *pfUpdate)
+{
+    REDSTATUS   ret = 0;
+
+    if(!CINODE_IS_MOUNTED(pInode) || (pfUpdate == NULL))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        const INODE *pInodeBuf = pInode->pInodeBuf;
+        uint32_t     ulAge = gpRedVolume->ulRelatimeAge;
+
+        /*  If the clock has gone backward, the access time looks like it is
+            from the future; the subtraction wraps and the update goes ahead.
+        */
+        *pfUpdate =    (ulAge == 0U)
+                    || (pInodeBuf->ulATime <= pInodeBuf->ulMTime)
+                    || (pInodeBuf->ulATime <= pInodeBuf->ulCTime)
+                    || ((RedOsClockGetTime() - pInodeBuf->ulATime) >= ulAge);
+
+        if(*pfUpdate)
+        {
+            ret = RedInodeBranch(pInode);
+        }
+    }
+
+    return ret;
+}
+#endif
+
+
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
 /** @brief Find a free inode number.
 
@@ -808,7 +1305,10 @@ static REDSTATUS InodeFindFree(
 
         ret = 0;
 
-        for(ulInode = INODE_FIRST_FREE; ulInode < (INODE_FIRST_VALID + gpRedVolConf->ulInodeCount); ulInode++)
+        /*  Every inode number below the hint is in use, so start the search
+            there rather than rescanning the front of the inode table.
+        */
+        for(ulInode = gpRedCoreVol->ulInodeFreeHint; ulInode < (INODE_FIRST_VALID + gpRedVolConf->ulInodeCount); ulInode++)
         {
             bool fFree;
 
@@ -825,6 +1325,7 @@ static REDSTATUS InodeFindFree(
             if(ulInode < (INODE_FIRST_VALID + gpRedVolConf->ulInodeCount))
             {
                 *pulInode = ulInode;
+                gpRedCoreVol->ulInodeFreeHint = ulInode;
             }
             else
             {
@@ -841,7 +1342,7 @@ static REDSTATUS InodeFindFree(
 #endif
 
 
-#if ((REDCONF_READ_ONLY == 0) && ((REDCONF_API_POSIX == 1) || FORMAT_SUPPORTED)) || (REDCONF_CHECKER == 1)
+#if ((REDCONF_READ_ONLY == 0) && ((REDCONF_API_POSIX == 1) || FORMAT_SUPPORTED)) || (REDCONF_CHECKER == 1) || SCRUB_SUPPORTED
 /** @brief Determine whether an inode number is available.
 
     @param ulInode  The node number to examine.
@@ -962,6 +1463,7 @@ static REDSTATUS InodeGetWriteableCopy(
 
 /** @brief Determine which copy of the inode is current.
 
+    @param bMR      The metaroot index: either 0 or 1.
     @param ulInode  The inode number to examine.
     @param pbWhich  On successful return, populated with which copy of the inode
                     (either 0 or 1) is current.
@@ -975,6 +1477,7 @@ static REDSTATUS InodeGetWriteableCopy(
     @retval -RED_EIO    A disk I/O error occurred.
 */
 static REDSTATUS InodeGetCurrentCopy(
+    uint8_t     bMR,
     uint32_t    ulInode,
     uint8_t    *pbWhich)
 {
@@ -989,10 +1492,10 @@ static REDSTATUS InodeGetCurrentCopy(
     {
         bool fSlot0Allocated;
 
-        /*  The current inode slot is the one which is allocated in the working
-            state metaroot.
+        /*  The current inode slot is the one which is allocated in the given
+            metaroot; usually that of the working state.
         */
-        ret = RedInodeBitGet(gpRedCoreVol->bCurMR, ulInode, 0U, &fSlot0Allocated);
+        ret = RedInodeBitGet(bMR, ulInode, 0U, &fSlot0Allocated);
         if(ret == 0)
         {
             if(fSlot0Allocated)
@@ -1003,7 +1506,7 @@ static REDSTATUS InodeGetCurrentCopy(
             {
                 bool fSlot1Allocated;
 
-                ret = RedInodeBitGet(gpRedCoreVol->bCurMR, ulInode, 1U, &fSlot1Allocated);
+                ret = RedInodeBitGet(bMR, ulInode, 1U, &fSlot1Allocated);
                 if(ret == 0)
                 {
                     if(fSlot1Allocated)
@@ -1118,3 +1621,99 @@ static uint32_t InodeBlock(
     return gpRedCoreVol->ulInodeTableStartBN + ((ulInode - INODE_FIRST_VALID) * 2U) + bWhich;
 }
 
+
+/** @brief Copy the stat metadata out of an inode buffer.
+
+    @param pMeta        The metadata structure to populate.
+    @param pInodeBuf    The inode buffer.
+*/
+static void InodeMetaCopy(
+    INODEMETA      *pMeta,
+    const INODE    *pInodeBuf)
+{
+    pMeta->ullSize = pInodeBuf->ullSize;
+  #if REDCONF_INODE_BLOCKS == 1
+    pMeta->ulBlocks = pInodeBuf->ulBlocks;
+  #endif
+  #if REDCONF_INODE_TIMESTAMPS == 1
+    pMeta->ulATime = pInodeBuf->ulATime;
+    pMeta->ulMTime = pInodeBuf->ulMTime;
+    pMeta->ulCTime = pInodeBuf->ulCTime;
+  #endif
+    pMeta->uMode = pInodeBuf->uMode;
+  #if (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_LINK == 1)
+    pMeta->uNLink = pInodeBuf->uNLink;
+  #endif
+}
+
+
+#if REDCONF_INODE_CACHE > 0U
+/** @brief Forget every inode in the inode metadata cache of the current volume.
+
+    Called whenever the volume is mounted, since the cache is only valid for
+    the working state it was filled from.
+*/
+void RedInodeCacheReset(void)
+{
+    uint32_t ulIdx;
+
+    for(ulIdx = 0U; ulIdx < REDCONF_INODE_CACHE; ulIdx++)
+    {
+        gaaInodeCache[gbRedVolNum][ulIdx].ulInode = INODE_INVALID;
+    }
+}
+
+
+/** @brief Remember the metadata of an inode in the inode metadata cache.
+
+    The seek coordinates are remembered too, if the inode was seeked; if not,
+    those remembered from an earlier operation on the same inode are kept.
+
+    @param pInode   A pointer to the mounted cached inode structure.
+*/
+static void InodeCacheUpdate(
+    const CINODE   *pInode)
+{
+    INODECACHE     *pEntry = &gaaInodeCache[gbRedVolNum][pInode->ulInode % REDCONF_INODE_CACHE];
+
+    if(pEntry->ulInode != pInode->ulInode)
+    {
+        pEntry->ulInode = pInode->ulInode;
+        pEntry->fCoordHint = false;
+    }
+
+    InodeMetaCopy(&pEntry->meta, pInode->pInodeBuf);
+
+    if(pInode->fCoordInited)
+    {
+        pEntry->fCoordHint = true;
+        pEntry->ulLogicalBlock = pInode->ulLogicalBlock;
+        pEntry->uInodeEntry = pInode->uInodeEntry;
+      #if DINDIR_POINTERS > 0U
+        pEntry->uDindirEntry = pInode->uDindirEntry;
+      #endif
+      #if REDCONF_DIRECT_POINTERS < INODE_ENTRIES
+        pEntry->uIndirEntry = pInode->uIndirEntry;
+      #endif
+    }
+}
+
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
+/** @brief Forget an inode in the inode metadata cache.
+
+    @param ulInode  The inode number which is being freed.
+*/
+static void InodeCacheRemove(
+    uint32_t    ulInode)
+{
+    INODECACHE *pEntry = &gaaInodeCache[gbRedVolNum][ulInode % REDCONF_INODE_CACHE];
+
+    if(pEntry->ulInode == ulInode)
+    {
+        pEntry->ulInode = INODE_INVALID;
+    }
+}
+#endif
+#endif /* REDCONF_INODE_CACHE > 0U */
+
@@ -53,6 +53,83 @@ typedef enum
 } BRANCHDEPTH;
 
 
+#if REDCONF_READ_AHEAD > 0U
+/** @brief Sequential read detection state for a volume.
+
+    Cached inode structures only live for the duration of a single call into
+    the core, so the state of the read stream is remembered separately.  Only
+    the most recently read file on each volume is tracked.
+*/
+typedef struct
+{
+    uint32_t    ulInode;        /**< The inode most recently read. */
+    uint64_t    ullNextOffset;  /**< File offset immediately after the most recent read. */
+    uint32_t    ulWindowEnd;    /**< First file block offset beyond the read-ahead window. */
+} READAHEAD;
+
+static READAHEAD gaReadAhead[REDCONF_VOLUME_COUNT];
+#endif
+
+
+#if REDCONF_READ_ONLY == 0
+/** @brief A run of contiguous blocks allocated in advance for file data.
+
+    While WriteAligned() is branching the file data blocks of a large write,
+    new data blocks are handed out from a run allocated in one imap pass, so
+    that the data is physically contiguous and can be written with a few large
+    device writes.  Blocks left over at the end of the write are freed.
+*/
+typedef struct
+{
+    uint32_t    ulWanted;   /**< File data blocks remaining in the write. */
+    uint32_t    ulNext;     /**< First unused block of the run. */
+    uint32_t    ulCount;    /**< Number of unused blocks in the run. */
+} WRITERUN;
+
+static WRITERUN gWriteRun;
+#endif
+
+
+#if COMPRESSION_SUPPORTED
+/*  Whether the data of a cached inode is compressed.
+*/
+#define INODE_IS_COMPRESSED(pInode) (((pInode)->pInodeBuf->uMode & RED_S_ICOMPR) != 0U)
+
+/*  Size of the header at the start of a compressed cluster, which holds the
+    length of the compressed data as a little-endian 32-bit value.
+*/
+#define CLUSTER_HEADER_SIZE (4U)
+
+/** @brief The most recently decompressed cluster.
+
+    A compressed file is divided into clusters of CLUSTER_BLOCKS blocks.  When
+    a cluster is compressed, the entry for its first block is set to
+    BLOCK_COMPRESSED, the compressed data is stored in the blocks of the
+    following entries, and the remaining entries are sparse.  A compressed
+    cluster always lies wholly within the file.
+
+    Small sequential reads would otherwise decompress the same cluster once
+    per read, so the last cluster decompressed is remembered.  The data buffer
+    doubles as the work area for compressing and expanding clusters.
+*/
+typedef struct
+{
+    bool        fValid;         /**< Whether the members below describe abData. */
+    uint8_t     bVolNum;        /**< The volume of the cluster. */
+    uint32_t    ulInode;        /**< The inode of the cluster. */
+    uint32_t    ulCluster;      /**< The cluster number within the inode. */
+    uint32_t    ulStreamBlock;  /**< First block of the compressed data, which changes whenever the cluster is rewritten. */
+    uint8_t     abData[CLUSTER_SIZE];   /**< The uncompressed cluster. */
+} CLUSTERCACHE;
+
+static CLUSTERCACHE gCluster;
+static uint8_t gabStream[CLUSTER_SIZE - REDCONF_BLOCK_SIZE];
+#if COPYFILE_SUPPORTED
+static uint8_t gabCopyBlock[REDCONF_BLOCK_SIZE];
+#endif
+#endif
+
+
 #if REDCONF_READ_ONLY == 0
 #if DELETE_SUPPORTED || TRUNCATE_SUPPORTED
 static REDSTATUS Shrink(CINODE *pInode, uint64_t ullSize);
@@ -62,11 +139,18 @@ static REDSTATUS TruncDindir(CINODE *pInode, bool *pfFreed);
 #if REDCONF_DIRECT_POINTERS < INODE_ENTRIES
 static REDSTATUS TruncIndir(CINODE *pInode, bool *pfFreed);
 #endif
+#endif
+#if DELETE_SUPPORTED || TRUNCATE_SUPPORTED || COMPRESSION_SUPPORTED
 static REDSTATUS TruncDataBlock(const CINODE *pInode, uint32_t *pulBlock, bool fPropagate);
 #endif
+static REDSTATUS WriteRange(CINODE *pInode, uint64_t ullStart, uint32_t *pulLen, const uint8_t *pbBuffer);
 static REDSTATUS ExpandPrepare(CINODE *pInode);
+#if COPYFILE_SUPPORTED
+static REDSTATUS CopyHole(CINODE *pInode, uint64_t ullStart, uint32_t *pulLen);
+#endif
 #endif
 static void SeekCoord(CINODE *pInode, uint32_t ulBlock);
+static REDSTATUS ReadRange(CINODE *pInode, uint64_t ullStart, uint32_t ulLen, uint8_t *pbBuffer);
 static REDSTATUS ReadUnaligned(CINODE *pInode, uint64_t ullStart, uint32_t ulLen, uint8_t *pbBuffer);
 static REDSTATUS ReadAligned(CINODE *pInode, uint32_t ulBlockStart, uint32_t ulBlockCount, uint8_t *pbBuffer);
 #if REDCONF_READ_ONLY == 0
@@ -74,12 +158,31 @@ static REDSTATUS WriteUnaligned(CINODE *pInode, uint64_t ullStart, uint32_t ulLe
 static REDSTATUS WriteAligned(CINODE *pInode, uint32_t ulBlockStart, uint32_t *pulBlockCount, const uint8_t *pbBuffer);
 #endif
 static REDSTATUS GetExtent(CINODE *pInode, uint32_t ulBlockStart, uint32_t *pulExtentStart, uint32_t *pulExtentLen);
+#if REDCONF_READ_AHEAD > 0U
+static bool ReadAheadDetect(const CINODE *pInode, uint64_t ullStart, uint32_t ulLen);
+static void ReadAhead(CINODE *pInode, uint32_t ulBlock);
+#endif
 #if REDCONF_READ_ONLY == 0
 static REDSTATUS BranchBlock(CINODE *pInode, BRANCHDEPTH depth, bool fBuffer);
-static REDSTATUS BranchOneBlock(uint32_t *pulBlock, void **ppBuffer, uint16_t uBFlag);
+static REDSTATUS BranchOneBlock(uint32_t *pulBlock, void **ppBuffer, uint16_t uBFlag, ALLOCTYPE allocType);
 static REDSTATUS BranchBlockCost(const CINODE *pInode, BRANCHDEPTH depth, uint32_t *pulCost);
+static REDSTATUS AllocDataBlock(uint32_t *pulBlock);
+static REDSTATUS WriteRunRelease(void);
+static uint32_t WriteRunMetaCost(uint32_t ulDataBlocks);
 static uint32_t FreeBlockCount(void);
 #endif
+#if COMPRESSION_SUPPORTED
+static REDSTATUS CompressedRead(CINODE *pInode, uint64_t ullStart, uint32_t ulLen, uint8_t *pbBuffer);
+static REDSTATUS ClusterIsCompressed(CINODE *pInode, uint32_t ulCluster, bool *pfCompressed);
+static REDSTATUS ClusterLoad(CINODE *pInode, uint32_t ulCluster);
+#if REDCONF_READ_ONLY == 0
+static REDSTATUS CompressedWrite(CINODE *pInode, uint64_t ullStart, uint32_t *pulLen, const uint8_t *pbBuffer);
+static REDSTATUS ClusterPack(CINODE *pInode, uint32_t ulCluster, const uint8_t *pbData, bool *pfPacked);
+static REDSTATUS ClusterExpand(CINODE *pInode, uint32_t ulCluster);
+static REDSTATUS ClusterEntrySet(CINODE *pInode, uint32_t ulBlock, uint32_t ulValue);
+static bool ClusterSpaceAvailable(void);
+#endif
+#endif
 
 
 /** @brief Read data from an inode.
@@ -122,10 +225,7 @@ REDSTATUS RedInodeDataRead(
     }
     else
     {
-        uint8_t    *pbBuffer = CAST_VOID_PTR_TO_UINT8_PTR(pBuffer);
-        uint32_t    ulReadIndex = 0U;
         uint32_t    ulLen = *pulLen;
-        uint32_t    ulRemaining;
 
         /*  Reading beyond the end of the file is not allowed.  If the requested
             read extends beyond the end of the file, truncate the read length so
@@ -136,60 +236,234 @@ REDSTATUS RedInodeDataRead(
             ulLen = (uint32_t)(pInode->pInodeBuf->ullSize - ullStart);
         }
 
-        ulRemaining = ulLen;
+      #if COMPRESSION_SUPPORTED
+        if(INODE_IS_COMPRESSED(pInode))
+        {
+            ret = CompressedRead(pInode, ullStart, ulLen, CAST_VOID_PTR_TO_UINT8_PTR(pBuffer));
+        }
+        else
+      #endif
+        {
+            ret = ReadRange(pInode, ullStart, ulLen, CAST_VOID_PTR_TO_UINT8_PTR(pBuffer));
+        }
 
-        /*  Unaligned partial block at start.
-        */
-        if((ullStart & (REDCONF_BLOCK_SIZE - 1U)) != 0U)
+        if(ret == 0)
         {
-            uint32_t ulBytesInFirstBlock = REDCONF_BLOCK_SIZE - (uint32_t)(ullStart & (REDCONF_BLOCK_SIZE - 1U));
-            uint32_t ulThisRead = REDMIN(ulRemaining, ulBytesInFirstBlock);
+            *pulLen = ulLen;
+        }
+    }
 
-            ret = ReadUnaligned(pInode, ullStart, ulThisRead, pbBuffer);
+    return ret;
+}
 
-            if(ret == 0)
-            {
-                ulReadIndex += ulThisRead;
-                ulRemaining -= ulThisRead;
-            }
+
+/** @brief Read a range of an inode which lies within the file.
+
+    @param pInode   A pointer to the cached inode structure.
+    @param ullStart The file offset at which to read.
+    @param ulLen    The number of bytes to read.  The range must not extend
+                    beyond the end of the file.
+    @param pbBuffer The buffer to read into.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EINVAL Invalid parameters.
+*/
+static REDSTATUS ReadRange(
+    CINODE     *pInode,
+    uint64_t    ullStart,
+    uint32_t    ulLen,
+    uint8_t    *pbBuffer)
+{
+    REDSTATUS   ret = 0;
+    uint32_t    ulReadIndex = 0U;
+    uint32_t    ulRemaining = ulLen;
+  #if REDCONF_READ_AHEAD > 0U
+    bool        fSequential = ReadAheadDetect(pInode, ullStart, ulLen);
+  #endif
+
+    /*  Unaligned partial block at start.
+    */
+    if((ullStart & (REDCONF_BLOCK_SIZE - 1U)) != 0U)
+    {
+        uint32_t ulBytesInFirstBlock = REDCONF_BLOCK_SIZE - (uint32_t)(ullStart & (REDCONF_BLOCK_SIZE - 1U));
+        uint32_t ulThisRead = REDMIN(ulRemaining, ulBytesInFirstBlock);
+
+      #if REDCONF_READ_AHEAD > 0U
+        if(fSequential)
+        {
+            ReadAhead(pInode, (uint32_t)(ullStart >> BLOCK_SIZE_P2));
         }
+      #endif
 
-        /*  Whole blocks.
-        */
-        if((ret == 0) && (ulRemaining >= REDCONF_BLOCK_SIZE))
+        ret = ReadUnaligned(pInode, ullStart, ulThisRead, pbBuffer);
+
+        if(ret == 0)
         {
-            uint32_t ulBlockOffset = (uint32_t)((ullStart + ulReadIndex) >> BLOCK_SIZE_P2);
-            uint32_t ulBlockCount = ulRemaining >> BLOCK_SIZE_P2;
+            ulReadIndex += ulThisRead;
+            ulRemaining -= ulThisRead;
+        }
+    }
+
+    /*  Whole blocks.
+    */
+    if((ret == 0) && (ulRemaining >= REDCONF_BLOCK_SIZE))
+    {
+        uint32_t ulBlockOffset = (uint32_t)((ullStart + ulReadIndex) >> BLOCK_SIZE_P2);
+        uint32_t ulBlockCount = ulRemaining >> BLOCK_SIZE_P2;
 
-            REDASSERT(((ullStart + ulReadIndex) & (REDCONF_BLOCK_SIZE - 1U)) == 0U);
+        REDASSERT(((ullStart + ulReadIndex) & (REDCONF_BLOCK_SIZE - 1U)) == 0U);
 
-            ret = ReadAligned(pInode, ulBlockOffset, ulBlockCount, &pbBuffer[ulReadIndex]);
+        ret = ReadAligned(pInode, ulBlockOffset, ulBlockCount, &pbBuffer[ulReadIndex]);
 
-            if(ret == 0)
-            {
-                ulReadIndex += ulBlockCount << BLOCK_SIZE_P2;
-                ulRemaining -= ulBlockCount << BLOCK_SIZE_P2;
-            }
+        if(ret == 0)
+        {
+            ulReadIndex += ulBlockCount << BLOCK_SIZE_P2;
+            ulRemaining -= ulBlockCount << BLOCK_SIZE_P2;
         }
+    }
 
-        /*  Aligned partial block at end.
-        */
-        if((ret == 0) && (ulRemaining > 0U))
+    /*  Aligned partial block at end.
+    */
+    if((ret == 0) && (ulRemaining > 0U))
+    {
+        REDASSERT(ulRemaining < REDCONF_BLOCK_SIZE);
+        REDASSERT(((ullStart + ulReadIndex) & (REDCONF_BLOCK_SIZE - 1U)) == 0U);
+
+      #if REDCONF_READ_AHEAD > 0U
+        if(fSequential)
         {
-            REDASSERT(ulRemaining < REDCONF_BLOCK_SIZE);
-            REDASSERT(((ullStart + ulReadIndex) & (REDCONF_BLOCK_SIZE - 1U)) == 0U);
+            ReadAhead(pInode, (uint32_t)((ullStart + ulReadIndex) >> BLOCK_SIZE_P2));
+        }
+      #endif
+
+        ret = ReadUnaligned(pInode, ullStart + ulReadIndex, ulRemaining, &pbBuffer[ulReadIndex]);
+    }
+
+    return ret;
+}
+
+
+#if REDCONF_READ_MAP > 0U
+/** @brief Map data from an inode for reading, without copying it.
+
+    The block containing @p ullStart is read into a block buffer, which is
+    pinned with RedBufferPin() and returned by reference.  If the volume is
+    read-only and its block device is memory-mapped, the block never changes,
+    so a pointer into the mapping is returned instead, using no buffer.  At
+    most one block is mapped: the length is truncated at the end of the block
+    and at the end of the file.
+
+    @param pInode   A pointer to the cached inode structure of the inode from
+                    which to read.
+    @param ullStart The file offset at which to read.
+    @param pulLen   On input, the maximum number of bytes to map.  On
+                    successful return, populated with the number of bytes
+                    actually mapped, which is zero if @p ullStart is at or
+                    beyond the end of the file.
+    @param ppbBlock On successful return, if any data was mapped, populated
+                    with the block; the data starts at offset
+                    `ullStart % REDCONF_BLOCK_SIZE` within it.
+    @param pfPinned On successful return, if any data was mapped, populated
+                    with whether the block is a pinned block buffer, which must
+                    be released with RedBufferUnpin().
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0               Operation was successful.
+    @retval -RED_EIO        A disk I/O error occurred.
+    @retval -RED_EINVAL     @p pInode is not a mounted cached inode pointer; or
+                            @p pulLen, @p ppbBlock, or @p pfPinned is `NULL`.
+    @retval -RED_ENODATA    The block at @p ullStart is sparse, or the file is
+                            compressed, so there is no data to map.
+*/
+REDSTATUS RedInodeDataReadMap(
+    CINODE         *pInode,
+    uint64_t        ullStart,
+    uint32_t       *pulLen,
+    const uint8_t **ppbBlock,
+    bool           *pfPinned)
+{
+    REDSTATUS       ret = 0;
+
+    if(!CINODE_IS_MOUNTED(pInode) || (pulLen == NULL) || (ppbBlock == NULL) || (pfPinned == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else if((ullStart >= pInode->pInodeBuf->ullSize) || (*pulLen == 0U))
+    {
+        *pulLen = 0U;
+    }
+  #if COMPRESSION_SUPPORTED
+    else if(INODE_IS_COMPRESSED(pInode))
+    {
+        /*  Compressed data has no block to map; the caller must copy it out
+            with RedInodeDataRead().
+        */
+        ret = -RED_ENODATA;
+    }
+  #endif
+    else
+    {
+        uint32_t    ulBlock = (uint32_t)(ullStart >> BLOCK_SIZE_P2);
+        uint32_t    ulLen = REDMIN(*pulLen, REDCONF_BLOCK_SIZE - (uint32_t)(ullStart & (REDCONF_BLOCK_SIZE - 1U)));
 
-            ret = ReadUnaligned(pInode, ullStart + ulReadIndex, ulRemaining, &pbBuffer[ulReadIndex]);
+        if((pInode->pInodeBuf->ullSize - ullStart) < ulLen)
+        {
+            ulLen = (uint32_t)(pInode->pInodeBuf->ullSize - ullStart);
         }
 
+      #if REDCONF_READ_ONLY == 1
+        const uint8_t *pbMapped = NULL;
+
+        ret = RedInodeDataSeek(pInode, ulBlock);
+
         if(ret == 0)
         {
+            pbMapped = RedIoMappedBlock(gbRedVolNum, pInode->ulDataBlock);
+        }
+
+        if(pbMapped != NULL)
+        {
+            *ppbBlock = pbMapped;
+            *pfPinned = false;
             *pulLen = ulLen;
         }
+        else if(ret == 0)
+      #endif
+        {
+          #if REDCONF_READ_AHEAD > 0U
+            if(ReadAheadDetect(pInode, ullStart, ulLen))
+            {
+                ReadAhead(pInode, ulBlock);
+            }
+          #endif
+
+            ret = RedInodeDataSeekAndRead(pInode, ulBlock);
+
+            if(ret == 0)
+            {
+                ret = RedBufferPin(pInode->pbData);
+            }
+
+            if(ret == 0)
+            {
+                /*  The pinned buffer now belongs to the caller; RedInodePut()
+                    must not release it.
+                */
+                *ppbBlock = pInode->pbData;
+                *pfPinned = true;
+                pInode->pbData = NULL;
+                *pulLen = ulLen;
+            }
+        }
     }
 
     return ret;
 }
+#endif /* REDCONF_READ_MAP > 0U */
 
 
 #if REDCONF_READ_ONLY == 0
@@ -239,129 +513,547 @@ REDSTATUS RedInodeDataWrite(
     else
     {
         const uint8_t  *pbBuffer = CAST_VOID_PTR_TO_CONST_UINT8_PTR(pBuffer);
-        uint32_t        ulWriteIndex = 0U;
         uint32_t        ulLen = *pulLen;
-        uint32_t        ulRemaining;
 
         if((INODE_SIZE_MAX - ullStart) < ulLen)
         {
             ulLen = (uint32_t)(INODE_SIZE_MAX - ullStart);
         }
 
-        ulRemaining = ulLen;
-
-        /*  If the write is beyond the current end of the file, and the current
-            end of the file is not block-aligned, then there may be some data
-            that needs to be zeroed in the last block.
-        */
-        if(ullStart > pInode->pInodeBuf->ullSize)
+      #if COMPRESSION_SUPPORTED
+        if(INODE_IS_COMPRESSED(pInode))
         {
-            ret = ExpandPrepare(pInode);
+            ret = CompressedWrite(pInode, ullStart, &ulLen, pbBuffer);
+        }
+        else
+      #endif
+        {
+            ret = WriteRange(pInode, ullStart, &ulLen, pbBuffer);
         }
 
-        /*  Partial block at start.
-        */
-        if((ret == 0) && (((ullStart & (REDCONF_BLOCK_SIZE - 1U)) != 0U) || (ulRemaining < REDCONF_BLOCK_SIZE)))
+        if(ret == 0)
         {
-            uint32_t ulBytesInFirstBlock = REDCONF_BLOCK_SIZE - (uint32_t)(ullStart & (REDCONF_BLOCK_SIZE - 1U));
-            uint32_t ulThisWrite = REDMIN(ulRemaining, ulBytesInFirstBlock);
+            *pulLen = ulLen;
+        }
+    }
 
-            ret = WriteUnaligned(pInode, ullStart, ulThisWrite, pbBuffer);
+    return ret;
+}
 
-            if(ret == 0)
-            {
-                ulWriteIndex += ulThisWrite;
-                ulRemaining -= ulThisWrite;
-            }
-        }
 
-        /*  Whole blocks.
-        */
-        if((ret == 0) && (ulRemaining >= REDCONF_BLOCK_SIZE))
-        {
-            uint32_t ulBlockOffset = (uint32_t)((ullStart + ulWriteIndex) >> BLOCK_SIZE_P2);
-            uint32_t ulBlockCount = ulRemaining >> BLOCK_SIZE_P2;
-            uint32_t ulBlocksWritten = ulBlockCount;
+/** @brief Write a range of an inode, extending the file if needed.
 
-            REDASSERT(((ullStart + ulWriteIndex) & (REDCONF_BLOCK_SIZE - 1U)) == 0U);
+    @param pInode   A pointer to the cached inode structure.
+    @param ullStart The file offset at which to write.
+    @param pulLen   On input, the number of bytes to write, which must be
+                    nonzero and must not extend beyond the maximum file size.
+                    On successful return, populated with the number of bytes
+                    actually written.
+    @param pbBuffer The buffer to write from.
 
-            ret = WriteAligned(pInode, ulBlockOffset, &ulBlocksWritten, &pbBuffer[ulWriteIndex]);
+    @return A negated ::REDSTATUS code indicating the operation result.
 
-            if((ret == -RED_ENOSPC) && (ulWriteIndex > 0U))
-            {
-                ulBlocksWritten = 0U;
-                ret = 0;
-            }
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL Invalid parameters.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOSPC No data can be written because there is insufficient
+                        free space.
+*/
+static REDSTATUS WriteRange(
+    CINODE         *pInode,
+    uint64_t        ullStart,
+    uint32_t       *pulLen,
+    const uint8_t  *pbBuffer)
+{
+    REDSTATUS       ret = 0;
+    uint32_t        ulWriteIndex = 0U;
+    uint32_t        ulRemaining = *pulLen;
 
-            if(ret == 0)
-            {
-                ulWriteIndex += ulBlocksWritten << BLOCK_SIZE_P2;
-                ulRemaining -= ulBlocksWritten << BLOCK_SIZE_P2;
+    /*  If the write is beyond the current end of the file, and the current
+        end of the file is not block-aligned, then there may be some data
+        that needs to be zeroed in the last block.
+    */
+    if(ullStart > pInode->pInodeBuf->ullSize)
+    {
+        ret = ExpandPrepare(pInode);
+    }
 
-                if(ulBlocksWritten < ulBlockCount)
-                {
-                    ulRemaining = 0U;
-                }
-            }
-        }
+    /*  Partial block at start.
+    */
+    if((ret == 0) && (((ullStart & (REDCONF_BLOCK_SIZE - 1U)) != 0U) || (ulRemaining < REDCONF_BLOCK_SIZE)))
+    {
+        uint32_t ulBytesInFirstBlock = REDCONF_BLOCK_SIZE - (uint32_t)(ullStart & (REDCONF_BLOCK_SIZE - 1U));
+        uint32_t ulThisWrite = REDMIN(ulRemaining, ulBytesInFirstBlock);
 
-        /*  Partial block at end.
-        */
-        if((ret == 0) && (ulRemaining > 0U))
+        ret = WriteUnaligned(pInode, ullStart, ulThisWrite, pbBuffer);
+
+        if(ret == 0)
         {
-            REDASSERT(ulRemaining < REDCONF_BLOCK_SIZE);
-            REDASSERT(((ullStart + ulWriteIndex) & (REDCONF_BLOCK_SIZE - 1U)) == 0U);
-            REDASSERT(ulWriteIndex > 0U);
+            ulWriteIndex += ulThisWrite;
+            ulRemaining -= ulThisWrite;
+        }
+    }
 
-            ret = WriteUnaligned(pInode, ullStart + ulWriteIndex, ulRemaining, &pbBuffer[ulWriteIndex]);
+    /*  Whole blocks.
+    */
+    if((ret == 0) && (ulRemaining >= REDCONF_BLOCK_SIZE))
+    {
+        uint32_t ulBlockOffset = (uint32_t)((ullStart + ulWriteIndex) >> BLOCK_SIZE_P2);
+        uint32_t ulBlockCount = ulRemaining >> BLOCK_SIZE_P2;
+        uint32_t ulBlocksWritten = ulBlockCount;
 
-            if(ret == -RED_ENOSPC)
-            {
-                ret = 0;
-            }
-            else if(ret == 0)
-            {
-                ulWriteIndex += ulRemaining;
+        REDASSERT(((ullStart + ulWriteIndex) & (REDCONF_BLOCK_SIZE - 1U)) == 0U);
 
-                REDASSERT(ulWriteIndex == ulLen);
-            }
-            else
-            {
-                /*  Unexpected error, return it.
-                */
-            }
+        ret = WriteAligned(pInode, ulBlockOffset, &ulBlocksWritten, &pbBuffer[ulWriteIndex]);
+
+        if((ret == -RED_ENOSPC) && (ulWriteIndex > 0U))
+        {
+            ulBlocksWritten = 0U;
+            ret = 0;
         }
 
         if(ret == 0)
         {
-            *pulLen = ulWriteIndex;
+            ulWriteIndex += ulBlocksWritten << BLOCK_SIZE_P2;
+            ulRemaining -= ulBlocksWritten << BLOCK_SIZE_P2;
 
-            if((ullStart + ulWriteIndex) > pInode->pInodeBuf->ullSize)
+            if(ulBlocksWritten < ulBlockCount)
             {
-                pInode->pInodeBuf->ullSize = ullStart + ulWriteIndex;
+                ulRemaining = 0U;
             }
         }
     }
 
+    /*  Partial block at end.
+    */
+    if((ret == 0) && (ulRemaining > 0U))
+    {
+        REDASSERT(ulRemaining < REDCONF_BLOCK_SIZE);
+        REDASSERT(((ullStart + ulWriteIndex) & (REDCONF_BLOCK_SIZE - 1U)) == 0U);
+        REDASSERT(ulWriteIndex > 0U);
+
+        ret = WriteUnaligned(pInode, ullStart + ulWriteIndex, ulRemaining, &pbBuffer[ulWriteIndex]);
+
+        if(ret == -RED_ENOSPC)
+        {
+            ret = 0;
+        }
+        else if(ret == 0)
+        {
+            ulWriteIndex += ulRemaining;
+
+            REDASSERT(ulWriteIndex == *pulLen);
+        }
+        else
+        {
+            /*  Unexpected error, return it.
+            */
+        }
+    }
+
+    if(ret == 0)
+    {
+        *pulLen = ulWriteIndex;
+
+        if((ullStart + ulWriteIndex) > pInode->pInodeBuf->ullSize)
+        {
+            pInode->pInodeBuf->ullSize = ullStart + ulWriteIndex;
+        }
+    }
+
     return ret;
 }
 
 
-#if DELETE_SUPPORTED || TRUNCATE_SUPPORTED
-/** @brief Change the size of an inode.
+#if FALLOCATE_SUPPORTED
+/** @brief Allocate the data blocks for a range of an inode.
+
+    Sparse blocks in the range are allocated and zeroed, along with the
+    indirect and double indirect nodes which point at them.  Later writes to
+    the range in the same transaction then overwrite the blocks in place and
+    do not have to allocate.  When enough contiguous free space exists, the
+    new blocks are allocated as one run.  If the range extends beyond the end
+    of the file, the file size is increased.
+
+    File data is copied-on-write.  Once a block is part of the committed
+    state, the first write to it still branches it to a new location.
 
     @param pInode   A pointer to the cached inode structure.
-    @praam ullSize  The new file size for the inode.
+    @param ullStart The file offset at which the range starts.
+    @param ullLen   The length of the range, in bytes.
 
     @return A negated ::REDSTATUS code indicating the operation result.
 
     @retval 0           Operation was successful.
-    @retval -RED_EFBIG  @p ullSize is greater than the maximum file size.
-    @retval -RED_EINVAL @p pInode is not a mounted cached inode pointer.
+    @retval -RED_EFBIG  The range extends beyond the maximum file size.
+    @retval -RED_EINVAL @p pInode is not a dirty cached inode pointer.
     @retval -RED_EIO    A disk I/O error occurred.
-    @retval -RED_ENOSPC Insufficient free space to perform the truncate.
+    @retval -RED_ENOSPC Insufficient free space to allocate the range.  Part of
+                        the range may have been allocated, and the file size
+                        may have been increased to cover that part.
 */
-REDSTATUS RedInodeDataTruncate(
+REDSTATUS RedInodeDataAllocate(
+    CINODE     *pInode,
+    uint64_t    ullStart,
+    uint64_t    ullLen)
+{
+    REDSTATUS   ret = 0;
+
+    if(!CINODE_IS_DIRTY(pInode))
+    {
+        ret = -RED_EINVAL;
+    }
+    else if((ullStart > INODE_SIZE_MAX) || (ullLen > (INODE_SIZE_MAX - ullStart)))
+    {
+        ret = -RED_EFBIG;
+    }
+    else if(ullLen == 0U)
+    {
+        /*  Do nothing, just return success.
+        */
+    }
+    else
+    {
+        uint64_t    ullEnd = ullStart + ullLen;
+        uint32_t    ulBlock = (uint32_t)(ullStart >> BLOCK_SIZE_P2);
+        uint32_t    ulBlockEnd = (uint32_t)((ullEnd + (REDCONF_BLOCK_SIZE - 1U)) >> BLOCK_SIZE_P2);
+
+        if(ullEnd > pInode->pInodeBuf->ullSize)
+        {
+            ret = ExpandPrepare(pInode);
+        }
+
+        while((ret == 0) && (ulBlock < ulBlockEnd))
+        {
+            ret = RedInodeDataSeek(pInode, ulBlock);
+
+          #if COMPRESSION_SUPPORTED
+            /*  The sparse entries of a compressed cluster hold no data of
+                their own, so they are left alone.
+            */
+            if((ret == -RED_ENODATA) && INODE_IS_COMPRESSED(pInode) && ((ulBlock % CLUSTER_BLOCKS) != 0U))
+            {
+                bool fCompressed;
+
+                ret = ClusterIsCompressed(pInode, ulBlock / CLUSTER_BLOCKS, &fCompressed);
+
+                if((ret == 0) && !fCompressed)
+                {
+                    ret = RedInodeDataSeek(pInode, ulBlock);
+                }
+            }
+          #endif
+
+            if(ret == -RED_ENODATA)
+            {
+                /*  Let AllocDataBlock() know how many data blocks might still
+                    need to be allocated.
+                */
+                gWriteRun.ulWanted = ulBlockEnd - ulBlock;
+
+                ret = BranchBlock(pInode, BRANCHDEPTH_FILE_DATA, true);
+            }
+
+            if(ret == 0)
+            {
+                ulBlock++;
+
+                /*  Grow the file as the blocks are allocated.  If the disk
+                    fills up, no allocated blocks are left beyond the end of
+                    the file.
+                */
+                if(pInode->pInodeBuf->ullSize < ullEnd)
+                {
+                    pInode->pInodeBuf->ullSize = REDMIN(ullEnd, (uint64_t)ulBlock << BLOCK_SIZE_P2);
+                }
+            }
+        }
+
+        gWriteRun.ulWanted = 0U;
+
+        /*  Free any blocks which were allocated in advance but not used.
+        */
+        if(ret == 0)
+        {
+            ret = WriteRunRelease();
+        }
+        else
+        {
+            REDSTATUS ret2 = WriteRunRelease();
+
+            CRITICAL_ASSERT(ret2 == 0);
+            (void)ret2;
+        }
+    }
+
+    return ret;
+}
+#endif /* FALLOCATE_SUPPORTED */
+
+
+#if COPYFILE_SUPPORTED
+/** @brief Copy data from one inode to another.
+
+    The data is copied one source block at a time: the block is read into a
+    buffer and written to the destination directly from that buffer, so the
+    data is never copied through an intermediate buffer, and when both offsets
+    are block-aligned, each whole block goes straight into the aligned write
+    path.  Sparse regions of the source read as zeroes in the destination.  A
+    compressed source has no block to write from, so its data is decompressed
+    into a staging buffer instead.
+
+    @param pSrcInode    A pointer to the cached inode structure of the inode
+                        from which to copy.
+    @param ullSrcStart  The file offset in @p pSrcInode at which to start.
+    @param pDstInode    A pointer to the cached inode structure of the inode
+                        into which to copy.
+    @param ullDstStart  The file offset in @p pDstInode at which to start.
+    @param pulLen       On input, the number of bytes to attempt to copy.  On
+                        successful return, populated with the number of bytes
+                        actually copied.  This is less than requested if the
+                        end of the source was reached, or if the destination
+                        ran out of space or reached the maximum file size after
+                        some of the data was copied.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EFBIG  @p ullDstStart is greater than or equal to the maximum
+                        file size, and there is data to copy.
+    @retval -RED_EINVAL @p pSrcInode is not a mounted cached inode pointer; or
+                        @p pDstInode is not a dirty cached inode pointer; or
+                        the two are the same inode; or @p pulLen is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOSPC No data can be copied because there is insufficient
+                        free space.
+*/
+REDSTATUS RedInodeDataCopy(
+    CINODE     *pSrcInode,
+    uint64_t    ullSrcStart,
+    CINODE     *pDstInode,
+    uint64_t    ullDstStart,
+    uint32_t   *pulLen)
+{
+    REDSTATUS   ret = 0;
+
+    if(    !CINODE_IS_MOUNTED(pSrcInode)
+        || !CINODE_IS_DIRTY(pDstInode)
+        || (pSrcInode->ulInode == pDstInode->ulInode)
+        || (pulLen == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        uint32_t    ulLen = *pulLen;
+        uint32_t    ulCopied = 0U;
+
+        if(ullSrcStart >= pSrcInode->pInodeBuf->ullSize)
+        {
+            ulLen = 0U;
+        }
+        else if((pSrcInode->pInodeBuf->ullSize - ullSrcStart) < ulLen)
+        {
+            ulLen = (uint32_t)(pSrcInode->pInodeBuf->ullSize - ullSrcStart);
+        }
+        else
+        {
+            /*  The whole request is within the source file.
+            */
+        }
+
+      #if REDCONF_READ_AHEAD > 0U
+        /*  A copy is a sequential read of the source by definition, so the
+            read-ahead window is used whether or not the copy continues an
+            earlier read stream.
+        */
+        (void)ReadAheadDetect(pSrcInode, ullSrcStart, ulLen);
+      #endif
+
+        while((ret == 0) && (ulCopied < ulLen))
+        {
+            uint64_t    ullSrcOffset = ullSrcStart + ulCopied;
+            uint32_t    ulBlock = (uint32_t)(ullSrcOffset >> BLOCK_SIZE_P2);
+            uint32_t    ulBlockOffset = (uint32_t)(ullSrcOffset & (REDCONF_BLOCK_SIZE - 1U));
+            uint32_t    ulThisCopy = REDMIN(ulLen - ulCopied, REDCONF_BLOCK_SIZE - ulBlockOffset);
+            uint32_t    ulThisCopied = ulThisCopy;
+
+          #if COMPRESSION_SUPPORTED
+            if(INODE_IS_COMPRESSED(pSrcInode))
+            {
+                ret = CompressedRead(pSrcInode, ullSrcOffset, ulThisCopy, gabCopyBlock);
+
+                if(ret == 0)
+                {
+                    ret = RedInodeDataWrite(pDstInode, ullDstStart + ulCopied, &ulThisCopied, gabCopyBlock);
+                }
+            }
+            else
+          #endif
+            {
+              #if REDCONF_READ_AHEAD > 0U
+                ReadAhead(pSrcInode, ulBlock);
+              #endif
+
+                ret = RedInodeDataSeekAndRead(pSrcInode, ulBlock);
+
+                if(ret == 0)
+                {
+                    ret = RedInodeDataWrite(pDstInode, ullDstStart + ulCopied, &ulThisCopied, &pSrcInode->pbData[ulBlockOffset]);
+                }
+                else if(ret == -RED_ENODATA)
+                {
+                    ret = CopyHole(pDstInode, ullDstStart + ulCopied, &ulThisCopied);
+                }
+                else
+                {
+                    /*  Unexpected error, return it.
+                    */
+                }
+            }
+
+            if(ret == 0)
+            {
+                ulCopied += ulThisCopied;
+
+                /*  A short write means the destination is full.
+                */
+                if(ulThisCopied < ulThisCopy)
+                {
+                    ulLen = ulCopied;
+                }
+            }
+        }
+
+        /*  As with a write, running out of space (or file size) part of the
+            way through is a short copy rather than an error.
+        */
+        if(((ret == -RED_ENOSPC) || (ret == -RED_EFBIG)) && (ulCopied > 0U))
+        {
+            ret = 0;
+        }
+
+        if(ret == 0)
+        {
+            *pulLen = ulCopied;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Copy a sparse region of the source to the destination.
+
+    Where the destination's existing data is overwritten, zeroes are written.
+    Beyond the end of the destination, the region is left sparse and only the
+    file size is increased.
+
+    @param pInode       A pointer to the cached inode structure of the
+                        destination.
+    @param ullStart     The file offset at which to start.
+    @param pulLen       On input, the length of the sparse region, which must
+                        not span more than one block.  On successful return,
+                        populated with the number of bytes copied.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EFBIG  @p ullStart is at or beyond the maximum file size.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOSPC No data can be copied because there is insufficient
+                        free space.
+*/
+static REDSTATUS CopyHole(
+    CINODE     *pInode,
+    uint64_t    ullStart,
+    uint32_t   *pulLen)
+{
+    static const uint8_t abZeroes[64U] = {0U};
+    REDSTATUS   ret = 0;
+    uint32_t    ulLen = *pulLen;
+    uint32_t    ulCopied = 0U;
+
+    REDASSERT(ulLen <= REDCONF_BLOCK_SIZE);
+
+    if(ullStart >= INODE_SIZE_MAX)
+    {
+        ret = -RED_EFBIG;
+    }
+    else if((INODE_SIZE_MAX - ullStart) < ulLen)
+    {
+        ulLen = (uint32_t)(INODE_SIZE_MAX - ullStart);
+    }
+    else
+    {
+        /*  The whole region fits within the maximum file size.
+        */
+    }
+
+    while((ret == 0) && (ulCopied < ulLen) && ((ullStart + ulCopied) < pInode->pInodeBuf->ullSize))
+    {
+        uint32_t ulThisWrite = REDMIN(ulLen - ulCopied, (uint32_t)sizeof(abZeroes));
+        uint32_t ulWritten = ulThisWrite;
+
+        ret = RedInodeDataWrite(pInode, ullStart + ulCopied, &ulWritten, abZeroes);
+
+        if(ret == 0)
+        {
+            ulCopied += ulWritten;
+
+            if(ulWritten < ulThisWrite)
+            {
+                ulLen = ulCopied;
+            }
+        }
+    }
+
+    if((ret == 0) && (ulCopied < ulLen))
+    {
+        /*  The rest of the region is beyond the end of the destination.
+        */
+        if((ullStart + ulCopied) > pInode->pInodeBuf->ullSize)
+        {
+            ret = ExpandPrepare(pInode);
+        }
+
+        if(ret == 0)
+        {
+            pInode->pInodeBuf->ullSize = ullStart + ulLen;
+            ulCopied = ulLen;
+        }
+    }
+
+    if(((ret == -RED_ENOSPC) || (ret == -RED_EFBIG)) && (ulCopied > 0U))
+    {
+        ret = 0;
+    }
+
+    if(ret == 0)
+    {
+        *pulLen = ulCopied;
+    }
+
+    return ret;
+}
+#endif /* COPYFILE_SUPPORTED */
+
+
+#if DELETE_SUPPORTED || TRUNCATE_SUPPORTED
+/** @brief Change the size of an inode.
+
+    @param pInode   A pointer to the cached inode structure.
+    @praam ullSize  The new file size for the inode.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EFBIG  @p ullSize is greater than the maximum file size.
+    @retval -RED_EINVAL @p pInode is not a mounted cached inode pointer.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOSPC Insufficient free space to perform the truncate.
+*/
+REDSTATUS RedInodeDataTruncate(
     CINODE     *pInode,
     uint64_t    ullSize)
 {
@@ -387,7 +1079,28 @@ REDSTATUS RedInodeDataTruncate(
         }
         else if(ullSize < pInode->pInodeBuf->ullSize)
         {
-            ret = Shrink(pInode, ullSize);
+          #if COMPRESSION_SUPPORTED
+            /*  A compressed cluster must lie wholly within the file, so if the
+                new end of the file splits one, it is expanded first.
+            */
+            if(INODE_IS_COMPRESSED(pInode) && ((ullSize & (CLUSTER_SIZE - 1U)) != 0U))
+            {
+                uint32_t    ulCluster = (uint32_t)(ullSize >> BLOCK_SIZE_P2) / CLUSTER_BLOCKS;
+                bool        fCompressed;
+
+                ret = ClusterIsCompressed(pInode, ulCluster, &fCompressed);
+
+                if((ret == 0) && fCompressed)
+                {
+                    ret = ClusterExpand(pInode, ulCluster);
+                }
+            }
+
+            if(ret == 0)
+          #endif
+            {
+                ret = Shrink(pInode, ullSize);
+            }
         }
         else
         {
@@ -466,7 +1179,7 @@ static REDSTATUS Shrink(
                 {
                     if(fFreed)
                     {
-                        pInode->pInodeBuf->aulEntries[pInode->uInodeEntry] = BLOCK_SPARSE;
+                        NODE_ENTRY_SET(pInode->pInodeBuf->aulEntries[pInode->uInodeEntry], BLOCK_SPARSE);
                     }
 
                     /*  The next seek will go to the beginning of the next
@@ -501,7 +1214,7 @@ static REDSTATUS Shrink(
                 {
                     if(fFreed)
                     {
-                        pInode->pInodeBuf->aulEntries[uOrigInodeEntry] = BLOCK_SPARSE;
+                        NODE_ENTRY_SET(pInode->pInodeBuf->aulEntries[uOrigInodeEntry], BLOCK_SPARSE);
                     }
 
                     /*  The next seek will go to the beginning of the next
@@ -559,7 +1272,7 @@ static REDSTATUS TruncDindir(
         */
         for(uEntry = 0U; !fBranch && (uEntry < pInode->uDindirEntry); uEntry++)
         {
-            fBranch = pInode->pDindir->aulEntries[uEntry] != BLOCK_SPARSE;
+            fBranch = NODE_ENTRY_GET(pInode->pDindir->aulEntries[uEntry]) != BLOCK_SPARSE;
         }
 
         /*  Unless we already know for a fact that the double indirect is going
@@ -568,11 +1281,11 @@ static REDSTATUS TruncDindir(
             deleted, we know this indirect pointer is going away, and that might
             mean the double indirect is going to be deleted also.
         */
-        if(!fBranch && (pInode->pDindir->aulEntries[pInode->uDindirEntry] != BLOCK_SPARSE))
+        if(!fBranch && (NODE_ENTRY_GET(pInode->pDindir->aulEntries[pInode->uDindirEntry]) != BLOCK_SPARSE))
         {
             for(uEntry = 0U; !fBranch && (uEntry < pInode->uIndirEntry); uEntry++)
             {
-                fBranch = pInode->pIndir->aulEntries[uEntry] != BLOCK_SPARSE;
+                fBranch = NODE_ENTRY_GET(pInode->pIndir->aulEntries[uEntry]) != BLOCK_SPARSE;
             }
         }
 
@@ -619,7 +1332,7 @@ static REDSTATUS TruncDindir(
 
                         if(fBranch && fIndirFreed)
                         {
-                            pInode->pDindir->aulEntries[uEntry] = BLOCK_SPARSE;
+                            NODE_ENTRY_SET(pInode->pDindir->aulEntries[uEntry], BLOCK_SPARSE);
                         }
                     }
                 }
@@ -692,7 +1405,7 @@ static REDSTATUS TruncIndir(
         */
         for(uEntry = 0U; !fBranch && (uEntry < pInode->uIndirEntry); uEntry++)
         {
-            fBranch = pInode->pIndir->aulEntries[uEntry] != BLOCK_SPARSE;
+            fBranch = NODE_ENTRY_GET(pInode->pIndir->aulEntries[uEntry]) != BLOCK_SPARSE;
         }
 
         if(fBranch)
@@ -729,12 +1442,16 @@ static REDSTATUS TruncIndir(
     return ret;
 }
 #endif /* REDCONF_DIRECT_POINTERS < INODE_ENTRIES */
+#endif /* DELETE_SUPPORTED || TRUNCATE_SUPPORTED */
 
 
+#if DELETE_SUPPORTED || TRUNCATE_SUPPORTED || COMPRESSION_SUPPORTED
 /** @brief Truncate a file data block.
 
     @param pInode       A pointer to the cached inode structure.
-    @param pulBlock     On entry, contains the block to be truncated.  On
+    @param pulBlock     Pointer to the node entry for the block, which is
+                        accessed with NODE_ENTRY_GET() and NODE_ENTRY_SET().
+                        On entry, contains the block to be truncated.  On
                         successful return, if @p fPropagate is true, populated
                         with BLOCK_SPARSE, otherwise unmodified.
     @param fPropagate   Whether the parent node is being branched.
@@ -757,9 +1474,23 @@ static REDSTATUS TruncDataBlock(
         REDERROR();
         ret = -RED_EINVAL;
     }
-    else if(*pulBlock != BLOCK_SPARSE)
+  #if COMPRESSION_SUPPORTED
+    else if(NODE_ENTRY_GET(*pulBlock) == BLOCK_COMPRESSED)
     {
-        ret = RedImapBlockSet(*pulBlock, false);
+        /*  The compressed cluster marker is not a real block, so there is
+            nothing to free; the compressed data is in the entries after it.
+        */
+        gCluster.fValid = false;
+
+        if(fPropagate)
+        {
+            NODE_ENTRY_SET(*pulBlock, BLOCK_SPARSE);
+        }
+    }
+  #endif
+    else if(NODE_ENTRY_GET(*pulBlock) != BLOCK_SPARSE)
+    {
+        ret = RedImapBlockSet(NODE_ENTRY_GET(*pulBlock), false);
 
       #if REDCONF_INODE_BLOCKS == 1
         if(ret == 0)
@@ -778,7 +1509,7 @@ static REDSTATUS TruncDataBlock(
 
         if((ret == 0) && fPropagate)
         {
-            *pulBlock = BLOCK_SPARSE;
+            NODE_ENTRY_SET(*pulBlock, BLOCK_SPARSE);
         }
     }
     else
@@ -789,7 +1520,7 @@ static REDSTATUS TruncDataBlock(
 
     return ret;
 }
-#endif /* DELETE_SUPPORTED || TRUNCATE_SUPPORTED */
+#endif /* DELETE_SUPPORTED || TRUNCATE_SUPPORTED || COMPRESSION_SUPPORTED */
 
 
 /** @brief Prepare to increase the file size.
@@ -877,9 +1608,18 @@ REDSTATUS RedInodeDataSeekAndRead(
 
     if((ret == 0) && (pInode->pbData == NULL))
     {
+        uint16_t uFlags = 0U;
+
         REDASSERT(pInode->ulDataBlock != BLOCK_SPARSE);
 
-        ret = RedBufferGet(pInode->ulDataBlock, 0U, CAST_VOID_PTR_PTR(&pInode->pbData));
+      #if (REDCONF_BUFFER_DATA_MAX > 0U) && (REDCONF_API_POSIX == 1)
+        if(pInode->fDirectory)
+        {
+            uFlags = BFLAG_DIRECTORY;
+        }
+      #endif
+
+        ret = RedBufferGet(pInode->ulDataBlock, uFlags, CAST_VOID_PTR_PTR(&pInode->pbData));
     }
 
     return ret;
@@ -936,7 +1676,7 @@ REDSTATUS RedInodeDataSeek(
 
                 if(ret == 0)
                 {
-                    pInode->ulIndirBlock = pInode->pDindir->aulEntries[pInode->uDindirEntry];
+                    pInode->ulIndirBlock = NODE_ENTRY_GET(pInode->pDindir->aulEntries[pInode->uDindirEntry]);
                 }
             }
         }
@@ -960,7 +1700,7 @@ REDSTATUS RedInodeDataSeek(
 
                 if(ret == 0)
                 {
-                    pInode->ulDataBlock = pInode->pIndir->aulEntries[pInode->uIndirEntry];
+                    pInode->ulDataBlock = NODE_ENTRY_GET(pInode->pIndir->aulEntries[pInode->uIndirEntry]);
                 }
             }
         }
@@ -976,6 +1716,22 @@ REDSTATUS RedInodeDataSeek(
 }
 
 
+#if COMPRESSION_SUPPORTED
+/** @brief Forget the decompressed cluster of the current volume.
+
+    Called when the in-memory state of the volume is discarded, since the
+    block which identifies the cached cluster might then hold other data.
+*/
+void RedInodeDataClusterReset(void)
+{
+    if(gCluster.bVolNum == gbRedVolNum)
+    {
+        gCluster.fValid = false;
+    }
+}
+#endif
+
+
 /** @brief Seek to the coordinates.
 
     Compute the new coordinates, and put any buffers which are not needed or are
@@ -994,6 +1750,32 @@ static void SeekCoord(
     }
     else if((pInode->ulLogicalBlock != ulBlock) || !pInode->fCoordInited)
     {
+      #if (REDCONF_INDIRECT_POINTERS > 0U) || (DINDIR_POINTERS > 0U)
+        /*  Sequential access usually seeks to the block after the current one,
+            whose coordinates can be stepped from the current coordinates
+            without any division.  Targets without a hardware divider have to
+            call a library routine for each of the divisions below.
+        */
+        bool fEntriesValid = pInode->fCoordInited;
+        bool fSameBlock = false;
+        bool fNextBlock;
+
+      #if REDCONF_INODE_CACHE > 0U
+        /*  The first seek after the inode is mounted can step from the
+            coordinates the inode was last put with, which is where the
+            previous read or write of a sequential stream left off.  Only the
+            entries are valid: the block numbers and buffers are not.
+        */
+        if(!fEntriesValid && pInode->fCoordHint)
+        {
+            fEntriesValid = true;
+            fSameBlock = ulBlock == pInode->ulLogicalBlock;
+        }
+      #endif
+
+        fNextBlock = fEntriesValid && (ulBlock == (pInode->ulLogicalBlock + 1U));
+      #endif
+
         RedInodePutData(pInode);
         pInode->ulLogicalBlock = ulBlock;
 
@@ -1007,7 +1789,7 @@ static void SeekCoord(
           #endif
 
             pInode->uInodeEntry = (uint16_t)ulBlock;
-            pInode->ulDataBlock = pInode->pInodeBuf->aulEntries[pInode->uInodeEntry];
+            pInode->ulDataBlock = NODE_ENTRY_GET(pInode->pInodeBuf->aulEntries[pInode->uInodeEntry]);
 
           #if DINDIR_POINTERS > 0U
             pInode->uDindirEntry = COORD_ENTRY_INVALID;
@@ -1025,12 +1807,38 @@ static void SeekCoord(
         if(ulBlock < (INODE_INDIR_BLOCKS + REDCONF_DIRECT_POINTERS))
       #endif
         {
-            uint32_t ulIndirRangeOffset = ulBlock - REDCONF_DIRECT_POINTERS;
-            uint16_t uInodeEntry = (uint16_t)((ulIndirRangeOffset / INDIR_ENTRIES) + REDCONF_DIRECT_POINTERS);
-            uint16_t uIndirEntry = (uint16_t)(ulIndirRangeOffset % INDIR_ENTRIES);
+            uint16_t uInodeEntry;
+            uint16_t uIndirEntry;
 
-          #if DINDIR_POINTERS > 0U
-            RedInodePutDindir(pInode);
+            /*  If the previous block was also in the indirect range, step to
+                the next entry.
+            */
+            if(fNextBlock && (ulBlock > REDCONF_DIRECT_POINTERS))
+            {
+                uInodeEntry = pInode->uInodeEntry;
+                uIndirEntry = (uint16_t)(pInode->uIndirEntry + 1U);
+
+                if(uIndirEntry == INDIR_ENTRIES)
+                {
+                    uInodeEntry++;
+                    uIndirEntry = 0U;
+                }
+            }
+            else if(fSameBlock)
+            {
+                uInodeEntry = pInode->uInodeEntry;
+                uIndirEntry = pInode->uIndirEntry;
+            }
+            else
+            {
+                uint32_t ulIndirRangeOffset = ulBlock - REDCONF_DIRECT_POINTERS;
+
+                uInodeEntry = (uint16_t)((ulIndirRangeOffset / INDIR_ENTRIES) + REDCONF_DIRECT_POINTERS);
+                uIndirEntry = (uint16_t)(ulIndirRangeOffset % INDIR_ENTRIES);
+            }
+
+          #if DINDIR_POINTERS > 0U
+            RedInodePutDindir(pInode);
           #endif
 
             /*  If the inode entry is not changing, then the previous indirect
@@ -1043,7 +1851,7 @@ static void SeekCoord(
 
                 pInode->uInodeEntry = uInodeEntry;
 
-                pInode->ulIndirBlock = pInode->pInodeBuf->aulEntries[pInode->uInodeEntry];
+                pInode->ulIndirBlock = NODE_ENTRY_GET(pInode->pInodeBuf->aulEntries[pInode->uInodeEntry]);
             }
 
           #if DINDIR_POINTERS > 0U
@@ -1064,11 +1872,46 @@ static void SeekCoord(
       #endif
       #if DINDIR_POINTERS > 0U
         {
-            uint32_t ulDindirRangeOffset = (ulBlock - REDCONF_DIRECT_POINTERS) - INODE_INDIR_BLOCKS;
-            uint16_t uInodeEntry = (uint16_t)((ulDindirRangeOffset / DINDIR_DATA_BLOCKS) + REDCONF_DIRECT_POINTERS + REDCONF_INDIRECT_POINTERS);
-            uint32_t ulDindirNodeOffset = ulDindirRangeOffset % DINDIR_DATA_BLOCKS;
-            uint16_t uDindirEntry = (uint16_t)(ulDindirNodeOffset / INDIR_ENTRIES);
-            uint16_t uIndirEntry = (uint16_t)(ulDindirNodeOffset % INDIR_ENTRIES);
+            uint16_t uInodeEntry;
+            uint16_t uDindirEntry;
+            uint16_t uIndirEntry;
+
+            /*  If the previous block was also in the double indirect range,
+                step to the next entry.
+            */
+            if(fNextBlock && (ulBlock > (REDCONF_DIRECT_POINTERS + INODE_INDIR_BLOCKS)))
+            {
+                uInodeEntry = pInode->uInodeEntry;
+                uDindirEntry = pInode->uDindirEntry;
+                uIndirEntry = (uint16_t)(pInode->uIndirEntry + 1U);
+
+                if(uIndirEntry == INDIR_ENTRIES)
+                {
+                    uDindirEntry++;
+                    uIndirEntry = 0U;
+
+                    if(uDindirEntry == INDIR_ENTRIES)
+                    {
+                        uInodeEntry++;
+                        uDindirEntry = 0U;
+                    }
+                }
+            }
+            else if(fSameBlock)
+            {
+                uInodeEntry = pInode->uInodeEntry;
+                uDindirEntry = pInode->uDindirEntry;
+                uIndirEntry = pInode->uIndirEntry;
+            }
+            else
+            {
+                uint32_t ulDindirRangeOffset = (ulBlock - REDCONF_DIRECT_POINTERS) - INODE_INDIR_BLOCKS;
+                uint32_t ulDindirNodeOffset = ulDindirRangeOffset % DINDIR_DATA_BLOCKS;
+
+                uInodeEntry = (uint16_t)((ulDindirRangeOffset / DINDIR_DATA_BLOCKS) + REDCONF_DIRECT_POINTERS + REDCONF_INDIRECT_POINTERS);
+                uDindirEntry = (uint16_t)(ulDindirNodeOffset / INDIR_ENTRIES);
+                uIndirEntry = (uint16_t)(ulDindirNodeOffset % INDIR_ENTRIES);
+            }
 
             /*  If the inode entry is not changing, then the previous double
                 indirect is still the correct one.  Otherwise, the old double
@@ -1081,7 +1924,7 @@ static void SeekCoord(
 
                 pInode->uInodeEntry = uInodeEntry;
 
-                pInode->ulDindirBlock = pInode->pInodeBuf->aulEntries[pInode->uInodeEntry];
+                pInode->ulDindirBlock = NODE_ENTRY_GET(pInode->pInodeBuf->aulEntries[pInode->uInodeEntry]);
             }
             /*  If neither the inode entry nor double indirect entry are
                 changing, then the previous indirect is still the correct one.
@@ -1358,6 +2201,11 @@ static REDSTATUS WriteAligned(
 
             if((ret == 0) || (ret == -RED_ENODATA))
             {
+                /*  Let AllocDataBlock() know how many data blocks might still
+                    need to be allocated for this write.
+                */
+                gWriteRun.ulWanted = ulBlockCount - ulBlockIndex;
+
                 ret = BranchBlock(pInode, BRANCHDEPTH_FILE_DATA, false);
 
                 if(ret == -RED_ENOSPC)
@@ -1377,6 +2225,22 @@ static REDSTATUS WriteAligned(
             }
         }
 
+        gWriteRun.ulWanted = 0U;
+
+        /*  Free any blocks which were allocated in advance but not used.
+        */
+        if(ret == 0)
+        {
+            ret = WriteRunRelease();
+        }
+        else
+        {
+            REDSTATUS ret2 = WriteRunRelease();
+
+            CRITICAL_ASSERT(ret2 == 0);
+            (void)ret2;
+        }
+
         ulBlockCount = ulBlockIndex;
         ulBlockIndex = 0U;
 
@@ -1493,6 +2357,78 @@ static REDSTATUS GetExtent(
 }
 
 
+#if REDCONF_READ_AHEAD > 0U
+/** @brief Determine whether a read continues a sequential read stream.
+
+    A read is sequential if it is from the same file as the previous read on
+    the volume, and starts where that read ended.
+
+    @param pInode   A pointer to the cached inode structure.
+    @param ullStart The file offset at which the read starts.
+    @param ulLen    The number of bytes being read.
+
+    @return Whether the read continues a sequential read stream.
+*/
+static bool ReadAheadDetect(
+    const CINODE   *pInode,
+    uint64_t        ullStart,
+    uint32_t        ulLen)
+{
+    READAHEAD      *pRA = &gaReadAhead[gbRedVolNum];
+    bool            fSequential = (pRA->ulInode == pInode->ulInode) && (pRA->ullNextOffset == ullStart);
+
+    if(!fSequential)
+    {
+        pRA->ulInode = pInode->ulInode;
+        pRA->ulWindowEnd = 0U;
+    }
+
+    pRA->ullNextOffset = ullStart + ulLen;
+
+    return fSequential;
+}
+
+
+/** @brief Prefetch file data ahead of a sequential reader.
+
+    When a sequential reader reaches the end of the current read-ahead window,
+    the next REDCONF_READ_AHEAD blocks (or fewer, if the data is fragmented or
+    the end of the file is reached) are read into the buffers with a single
+    I/O request.
+
+    Read-ahead is only an optimization, so errors are not returned: if a block
+    cannot be prefetched, the error will be reported when the block is read.
+
+    @param pInode   A pointer to the cached inode structure.
+    @param ulBlock  The file block offset which is about to be read.
+*/
+static void ReadAhead(
+    CINODE     *pInode,
+    uint32_t    ulBlock)
+{
+    READAHEAD  *pRA = &gaReadAhead[gbRedVolNum];
+
+    if(ulBlock >= pRA->ulWindowEnd)
+    {
+        uint32_t    ulFileBlocks = (uint32_t)((pInode->pInodeBuf->ullSize + (REDCONF_BLOCK_SIZE - 1U)) >> BLOCK_SIZE_P2);
+        uint32_t    ulExtentStart;
+        uint32_t    ulExtentLen = REDMIN(REDCONF_READ_AHEAD, ulFileBlocks - ulBlock);
+
+        if(GetExtent(pInode, ulBlock, &ulExtentStart, &ulExtentLen) == 0)
+        {
+            (void)RedBufferReadAhead(ulExtentStart, ulExtentLen);
+        }
+        else
+        {
+            ulExtentLen = 1U;
+        }
+
+        pRA->ulWindowEnd = ulBlock + ulExtentLen;
+    }
+}
+#endif /* REDCONF_READ_AHEAD > 0U */
+
+
 #if REDCONF_READ_ONLY == 0
 /** @brief Allocate or branch the file metadata path and data block if necessary.
 
@@ -1519,7 +2455,10 @@ static REDSTATUS BranchBlock(
 
     ret = BranchBlockCost(pInode, depth, &ulCost);
 
-    if((ret == 0) && (ulCost > FreeBlockCount()))
+    /*  Blocks already allocated for this write count toward the free space,
+        since they are used for the file data first.
+    */
+    if((ret == 0) && (ulCost > (FreeBlockCount() + gWriteRun.ulCount)))
     {
         ret = -RED_ENOSPC;
     }
@@ -1529,7 +2468,7 @@ static REDSTATUS BranchBlock(
       #if DINDIR_POINTERS > 0U
         if(pInode->uDindirEntry != COORD_ENTRY_INVALID)
         {
-            ret = BranchOneBlock(&pInode->ulDindirBlock, CAST_VOID_PTR_PTR(&pInode->pDindir), BFLAG_META_DINDIR);
+            ret = BranchOneBlock(&pInode->ulDindirBlock, CAST_VOID_PTR_PTR(&pInode->pDindir), BFLAG_META_DINDIR, ALLOCTYPE_META);
 
             if(ret == 0)
             {
@@ -1537,7 +2476,7 @@ static REDSTATUS BranchBlock(
                 */
                 pInode->pDindir->ulInode = pInode->ulInode;
 
-                pInode->pInodeBuf->aulEntries[pInode->uInodeEntry] = pInode->ulDindirBlock;
+                NODE_ENTRY_SET(pInode->pInodeBuf->aulEntries[pInode->uInodeEntry], pInode->ulDindirBlock);
             }
         }
 
@@ -1547,7 +2486,7 @@ static REDSTATUS BranchBlock(
         {
             if((pInode->uIndirEntry != COORD_ENTRY_INVALID) && (depth >= BRANCHDEPTH_INDIR))
             {
-                ret = BranchOneBlock(&pInode->ulIndirBlock, CAST_VOID_PTR_PTR(&pInode->pIndir), BFLAG_META_INDIR);
+                ret = BranchOneBlock(&pInode->ulIndirBlock, CAST_VOID_PTR_PTR(&pInode->pIndir), BFLAG_META_INDIR, ALLOCTYPE_META);
 
                 if(ret == 0)
                 {
@@ -1558,12 +2497,12 @@ static REDSTATUS BranchBlock(
                   #if DINDIR_POINTERS > 0U
                     if(pInode->uDindirEntry != COORD_ENTRY_INVALID)
                     {
-                        pInode->pDindir->aulEntries[pInode->uDindirEntry] = pInode->ulIndirBlock;
+                        NODE_ENTRY_SET(pInode->pDindir->aulEntries[pInode->uDindirEntry], pInode->ulIndirBlock);
                     }
                     else
                   #endif
                     {
-                        pInode->pInodeBuf->aulEntries[pInode->uInodeEntry] = pInode->ulIndirBlock;
+                        NODE_ENTRY_SET(pInode->pInodeBuf->aulEntries[pInode->uInodeEntry], pInode->ulIndirBlock);
                     }
                 }
             }
@@ -1578,20 +2517,31 @@ static REDSTATUS BranchBlock(
                 bool    fAllocedNew = (pInode->ulDataBlock == BLOCK_SPARSE);
               #endif
                 void  **ppBufPtr = (fBuffer || (pInode->pbData != NULL)) ? CAST_VOID_PTR_PTR(&pInode->pbData) : NULL;
+                ALLOCTYPE allocType = ALLOCTYPE_DATA;
+
+              #if REDCONF_API_POSIX == 1
+                /*  Directory data is rewritten by every change to the
+                    directory's entries, so it is placed with the metadata.
+                */
+                if(pInode->fDirectory)
+                {
+                    allocType = ALLOCTYPE_META;
+                }
+              #endif
 
-                ret = BranchOneBlock(&pInode->ulDataBlock, ppBufPtr, 0U);
+                ret = BranchOneBlock(&pInode->ulDataBlock, ppBufPtr, 0U, allocType);
 
                 if(ret == 0)
                 {
                   #if REDCONF_DIRECT_POINTERS < INODE_ENTRIES
                     if(pInode->uIndirEntry != COORD_ENTRY_INVALID)
                     {
-                        pInode->pIndir->aulEntries[pInode->uIndirEntry] = pInode->ulDataBlock;
+                        NODE_ENTRY_SET(pInode->pIndir->aulEntries[pInode->uIndirEntry], pInode->ulDataBlock);
                     }
                     else
                   #endif
                     {
-                        pInode->pInodeBuf->aulEntries[pInode->uInodeEntry] = pInode->ulDataBlock;
+                        NODE_ENTRY_SET(pInode->pInodeBuf->aulEntries[pInode->uInodeEntry], pInode->ulDataBlock);
                     }
 
                   #if REDCONF_INODE_BLOCKS == 1
@@ -1641,6 +2591,8 @@ static REDSTATUS BranchBlock(
                     buffer for the block.
     @param uBFlag   The buffer type flags: BFLAG_META_DINDIR, BFLAG_META_INDIR,
                     or zero for file data.
+    @param allocType    What the block is for, passed to the allocator if a
+                        new block is allocated.
 
     @retval 0           Operation was successful.
     @retval -RED_EIO    A disk I/O error occurred.
@@ -1649,7 +2601,8 @@ static REDSTATUS BranchBlock(
 static REDSTATUS BranchOneBlock(
     uint32_t   *pulBlock,
     void      **ppBuffer,
-    uint16_t    uBFlag)
+    uint16_t    uBFlag,
+    ALLOCTYPE   allocType)
 {
     REDSTATUS   ret = 0;
 
@@ -1692,7 +2645,14 @@ static REDSTATUS BranchOneBlock(
                 /*  Block does not exist or is committed state, so allocate a
                     new block for the branch.
                 */
-                ret = RedImapAllocBlock(pulBlock);
+                if(allocType == ALLOCTYPE_DATA)
+                {
+                    ret = AllocDataBlock(pulBlock);
+                }
+                else
+                {
+                    ret = RedImapAllocBlock(allocType, pulBlock);
+                }
 
                 if(ret == 0)
                 {
@@ -1886,6 +2846,120 @@ static REDSTATUS BranchBlockCost(
 }
 
 
+/** @brief Allocate a file data block.
+
+    During a large write, the block is taken from a run of contiguous blocks
+    allocated in advance, which is (re)filled as needed.  Otherwise, or if the
+    volume is too full to allocate a run, a single block is allocated.
+
+    @param pulBlock On successful return, populated with the allocated block
+                    number.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOSPC Insufficient free space to perform the allocation.
+*/
+static REDSTATUS AllocDataBlock(
+    uint32_t   *pulBlock)
+{
+    REDSTATUS   ret = 0;
+
+    if((gWriteRun.ulCount == 0U) && (gWriteRun.ulWanted > 1U))
+    {
+        uint32_t ulWanted = gWriteRun.ulWanted;
+
+        /*  Only allocate a run if there is enough free space left over for the
+            metadata which the rest of the write might need to branch;
+            otherwise, those metadata allocations could fail.  Near a full
+            disk, this falls back to allocating one block at a time, with the
+            same out-of-space behavior as before.
+        */
+        if(FreeBlockCount() >= (ulWanted + WriteRunMetaCost(ulWanted)))
+        {
+            ret = RedImapAllocRun(ulWanted, &gWriteRun.ulNext, &gWriteRun.ulCount);
+        }
+    }
+
+    if(ret == 0)
+    {
+        if(gWriteRun.ulCount > 0U)
+        {
+            *pulBlock = gWriteRun.ulNext;
+            gWriteRun.ulNext++;
+            gWriteRun.ulCount--;
+        }
+        else
+        {
+            ret = RedImapAllocBlock(ALLOCTYPE_DATA, pulBlock);
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Free the unused remainder of the run allocated for a write.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS WriteRunRelease(void)
+{
+    REDSTATUS   ret = 0;
+    uint32_t    ulRunEnd = gWriteRun.ulNext + gWriteRun.ulCount;
+
+    while((ret == 0) && (gWriteRun.ulCount > 0U))
+    {
+        gWriteRun.ulCount--;
+        ret = RedImapBlockSet(gWriteRun.ulNext + gWriteRun.ulCount, false);
+    }
+
+    /*  If nothing was allocated after the run, rewind the allocation pointer so
+        that the next write continues where this one left off.
+    */
+    if((ret == 0) && (ulRunEnd != gWriteRun.ulNext))
+    {
+        uint32_t ulAfterRun = (ulRunEnd == gpRedVolume->ulBlockCount) ? gpRedCoreVol->ulFirstAllocableBN : ulRunEnd;
+
+        if(gpRedMR->ulAllocNextBlock == ulAfterRun)
+        {
+            gpRedMR->ulAllocNextBlock = gWriteRun.ulNext;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Compute the number of metadata blocks which might need to be
+           branched to write a run of file data blocks.
+
+    This is an upper bound: a run of blocks spans at most two more indirect
+    nodes than it fills, and each of those might have to branch its double
+    indirect as well.
+
+    @param ulDataBlocks The number of consecutive file data blocks.
+
+    @return The maximum number of metadata blocks to be branched.
+*/
+static uint32_t WriteRunMetaCost(
+    uint32_t    ulDataBlocks)
+{
+  #if DINDIR_POINTERS > 0U
+    return ((ulDataBlocks / INDIR_ENTRIES) + 2U) * 2U;
+  #elif REDCONF_DIRECT_POINTERS < INODE_ENTRIES
+    return (ulDataBlocks / INDIR_ENTRIES) + 2U;
+  #else
+    (void)ulDataBlocks;
+    return 0U;
+  #endif
+}
+
+
 /** @brief Yields the number of currently available free blocks.
 
     Accounts for reserved blocks, subtracting the number of reserved blocks if
@@ -1915,3 +2989,577 @@ static uint32_t FreeBlockCount(void)
 }
 #endif /* REDCONF_READ_ONLY == 0 */
 
+
+#if COMPRESSION_SUPPORTED
+/** @brief Read a range of a compressed inode which lies within the file.
+
+    Compressed clusters are served from the cluster cache, decompressing them
+    as needed; the rest of the range is read as usual.
+
+    @param pInode   A pointer to the cached inode structure.
+    @param ullStart The file offset at which to read.
+    @param ulLen    The number of bytes to read.  The range must not extend
+                    beyond the end of the file.
+    @param pbBuffer The buffer to read into.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred, or compressed data is
+                        corrupt.
+    @retval -RED_EINVAL Invalid parameters.
+*/
+static REDSTATUS CompressedRead(
+    CINODE     *pInode,
+    uint64_t    ullStart,
+    uint32_t    ulLen,
+    uint8_t    *pbBuffer)
+{
+    REDSTATUS   ret = 0;
+    uint32_t    ulReadIndex = 0U;
+
+    while((ret == 0) && (ulReadIndex < ulLen))
+    {
+        uint64_t    ullOffset = ullStart + ulReadIndex;
+        uint32_t    ulCluster = (uint32_t)(ullOffset >> BLOCK_SIZE_P2) / CLUSTER_BLOCKS;
+        uint32_t    ulClusterOffset = (uint32_t)(ullOffset & (CLUSTER_SIZE - 1U));
+        uint32_t    ulThisRead = REDMIN(ulLen - ulReadIndex, CLUSTER_SIZE - ulClusterOffset);
+        bool        fCompressed;
+
+        ret = ClusterIsCompressed(pInode, ulCluster, &fCompressed);
+
+        if(ret == 0)
+        {
+            if(fCompressed)
+            {
+                ret = ClusterLoad(pInode, ulCluster);
+
+                if(ret == 0)
+                {
+                    RedMemCpy(&pbBuffer[ulReadIndex], &gCluster.abData[ulClusterOffset], ulThisRead);
+                }
+            }
+            else
+            {
+                ret = ReadRange(pInode, ullOffset, ulThisRead, &pbBuffer[ulReadIndex]);
+            }
+        }
+
+        if(ret == 0)
+        {
+            ulReadIndex += ulThisRead;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Determine whether a cluster of a compressed inode is compressed.
+
+    @param pInode       A pointer to the cached inode structure.
+    @param ulCluster    The cluster number within the inode.
+    @param pfCompressed On successful return, populated with whether the
+                        cluster is compressed.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EINVAL Invalid parameters.
+*/
+static REDSTATUS ClusterIsCompressed(
+    CINODE     *pInode,
+    uint32_t    ulCluster,
+    bool       *pfCompressed)
+{
+    REDSTATUS   ret = RedInodeDataSeek(pInode, ulCluster * CLUSTER_BLOCKS);
+
+    if(ret == 0)
+    {
+        *pfCompressed = (pInode->ulDataBlock == BLOCK_COMPRESSED);
+    }
+    else if(ret == -RED_ENODATA)
+    {
+        *pfCompressed = false;
+        ret = 0;
+    }
+    else
+    {
+        /*  Unexpected error, return it.
+        */
+    }
+
+    return ret;
+}
+
+
+/** @brief Decompress a cluster into the cluster cache.
+
+    Nothing is read if the cache already holds the cluster.
+
+    @param pInode       A pointer to the cached inode structure.
+    @param ulCluster    The cluster number within the inode, which must be
+                        compressed.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred, or the compressed data is
+                        corrupt.
+    @retval -RED_EINVAL Invalid parameters.
+*/
+static REDSTATUS ClusterLoad(
+    CINODE     *pInode,
+    uint32_t    ulCluster)
+{
+    uint32_t    ulStreamStart = (ulCluster * CLUSTER_BLOCKS) + 1U;
+    REDSTATUS   ret = RedInodeDataSeek(pInode, ulStreamStart);
+
+    if(ret == -RED_ENODATA)
+    {
+        /*  A compressed cluster always has at least one block of data.
+        */
+        ret = -RED_EIO;
+    }
+    else if(    (ret == 0)
+             && (    !gCluster.fValid
+                  || (gCluster.bVolNum != gbRedVolNum)
+                  || (gCluster.ulInode != pInode->ulInode)
+                  || (gCluster.ulCluster != ulCluster)
+                  || (gCluster.ulStreamBlock != pInode->ulDataBlock)))
+    {
+        uint32_t ulStreamBlock = pInode->ulDataBlock;
+
+        gCluster.fValid = false;
+
+        ret = ReadAligned(pInode, ulStreamStart, CLUSTER_BLOCKS - 1U, gabStream);
+
+        if(ret == 0)
+        {
+            uint32_t ulStreamLen =    (uint32_t)gabStream[0U]
+                                   | ((uint32_t)gabStream[1U] << 8U)
+                                   | ((uint32_t)gabStream[2U] << 16U)
+                                   | ((uint32_t)gabStream[3U] << 24U);
+
+            if(    (ulStreamLen > (sizeof(gabStream) - CLUSTER_HEADER_SIZE))
+                || !RedLzDecompress(&gabStream[CLUSTER_HEADER_SIZE], ulStreamLen, gCluster.abData, CLUSTER_SIZE))
+            {
+                ret = -RED_EIO;
+            }
+        }
+
+        if(ret == 0)
+        {
+            gCluster.bVolNum = gbRedVolNum;
+            gCluster.ulInode = pInode->ulInode;
+            gCluster.ulCluster = ulCluster;
+            gCluster.ulStreamBlock = ulStreamBlock;
+            gCluster.fValid = true;
+        }
+    }
+    else
+    {
+        /*  Cache hit, or an unexpected error.
+        */
+    }
+
+    return ret;
+}
+
+
+#if REDCONF_READ_ONLY == 0
+/** @brief Write to a compressed inode.
+
+    The write is split at cluster boundaries.  A piece which covers a whole
+    cluster is compressed straight from @p pbBuffer.  A compressed cluster
+    which is partly overwritten is expanded to ordinary blocks first.  A piece
+    which fills out a cluster lying wholly within the file, as an append does
+    once the cluster is complete, compresses the cluster from its blocks.
+    Clusters which do not compress are left as ordinary blocks.
+
+    @param pInode   A pointer to the cached inode structure.
+    @param ullStart The file offset at which to write.
+    @param pulLen   On input, the number of bytes to write, which must be
+                    nonzero and must not extend beyond the maximum file size.
+                    On successful return, populated with the number of bytes
+                    actually written.
+    @param pbBuffer The buffer to write from.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL Invalid parameters.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOSPC No data can be written because there is insufficient
+                        free space.
+*/
+static REDSTATUS CompressedWrite(
+    CINODE         *pInode,
+    uint64_t        ullStart,
+    uint32_t       *pulLen,
+    const uint8_t  *pbBuffer)
+{
+    REDSTATUS       ret = 0;
+    uint32_t        ulLen = *pulLen;
+    uint32_t        ulWriteIndex = 0U;
+
+    if(ullStart > pInode->pInodeBuf->ullSize)
+    {
+        ret = ExpandPrepare(pInode);
+    }
+
+    while((ret == 0) && (ulWriteIndex < ulLen))
+    {
+        uint64_t    ullOffset = ullStart + ulWriteIndex;
+        uint32_t    ulCluster = (uint32_t)(ullOffset >> BLOCK_SIZE_P2) / CLUSTER_BLOCKS;
+        uint32_t    ulClusterOffset = (uint32_t)(ullOffset & (CLUSTER_SIZE - 1U));
+        uint32_t    ulThisWrite = REDMIN(ulLen - ulWriteIndex, CLUSTER_SIZE - ulClusterOffset);
+        uint64_t    ullClusterEnd = ((uint64_t)ulCluster + 1U) * CLUSTER_SIZE;
+        bool        fCompressed;
+        bool        fPacked = false;
+
+        ret = ClusterIsCompressed(pInode, ulCluster, &fCompressed);
+
+        if((ret == 0) && (ulThisWrite == CLUSTER_SIZE))
+        {
+            ret = ClusterPack(pInode, ulCluster, &pbBuffer[ulWriteIndex], &fPacked);
+
+            if((ret == 0) && !fPacked && fCompressed)
+            {
+                /*  The new data does not compress.  All of the old data is
+                    being overwritten, so the cluster is simply turned back
+                    into ordinary blocks.  Check for space up front, so that
+                    the old compressed data cannot be left half overwritten.
+                */
+                if(!ClusterSpaceAvailable())
+                {
+                    ret = -RED_ENOSPC;
+                }
+                else
+                {
+                    ret = ClusterEntrySet(pInode, ulCluster * CLUSTER_BLOCKS, BLOCK_SPARSE);
+                }
+            }
+        }
+        else if((ret == 0) && fCompressed)
+        {
+            ret = ClusterExpand(pInode, ulCluster);
+        }
+        else
+        {
+            /*  Partial write to an ordinary cluster, or an error.
+            */
+        }
+
+        if((ret == 0) && fPacked)
+        {
+            ulWriteIndex += ulThisWrite;
+
+            if(ullClusterEnd > pInode->pInodeBuf->ullSize)
+            {
+                pInode->pInodeBuf->ullSize = ullClusterEnd;
+            }
+        }
+        else if(ret == 0)
+        {
+            uint32_t ulWritten = ulThisWrite;
+
+            ret = WriteRange(pInode, ullOffset, &ulWritten, &pbBuffer[ulWriteIndex]);
+
+            if(ret == 0)
+            {
+                ulWriteIndex += ulWritten;
+
+                if(ulWritten < ulThisWrite)
+                {
+                    /*  The disk is full.
+                    */
+                    ulLen = ulWriteIndex;
+                }
+                else if(    (ulThisWrite < CLUSTER_SIZE)
+                         && ((ullOffset + ulThisWrite) == ullClusterEnd)
+                         && (ullClusterEnd <= pInode->pInodeBuf->ullSize))
+                {
+                    ret = ClusterPack(pInode, ulCluster, NULL, &fPacked);
+                }
+                else
+                {
+                    /*  The cluster is incomplete, or was not compressible.
+                    */
+                }
+            }
+        }
+        else
+        {
+            /*  Error, return it.
+            */
+        }
+    }
+
+    /*  As with an ordinary write, running out of space part of the way through
+        is a short write rather than an error.
+    */
+    if((ret == -RED_ENOSPC) && (ulWriteIndex > 0U))
+    {
+        ret = 0;
+    }
+
+    if(ret == 0)
+    {
+        *pulLen = ulWriteIndex;
+    }
+
+    return ret;
+}
+
+
+/** @brief Compress a cluster, if it is compressible and there is room.
+
+    On success, the entry for the first block of the cluster is
+    BLOCK_COMPRESSED, the compressed data is in the entries which follow it,
+    and the remaining entries are sparse.
+
+    @param pInode       A pointer to the cached inode structure.
+    @param ulCluster    The cluster number within the inode.  The cluster must
+                        lie wholly within the file once written.
+    @param pbData       The uncompressed data for the cluster; or `NULL` to
+                        compress the data already in the cluster, which must
+                        not be compressed.
+    @param pfPacked     On successful return, populated with whether the
+                        cluster was compressed.  If not, nothing was changed.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL Invalid parameters.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS ClusterPack(
+    CINODE         *pInode,
+    uint32_t        ulCluster,
+    const uint8_t  *pbData,
+    bool           *pfPacked)
+{
+    REDSTATUS       ret = 0;
+    uint32_t        ulFirst = ulCluster * CLUSTER_BLOCKS;
+    const uint8_t  *pbSrc = pbData;
+
+    *pfPacked = false;
+    gCluster.fValid = false;
+
+    if(pbSrc == NULL)
+    {
+        uint32_t ulIdx;
+
+        for(ulIdx = 0U; (ret == 0) && (ulIdx < CLUSTER_BLOCKS); ulIdx++)
+        {
+            ret = ReadUnaligned(pInode, (uint64_t)(ulFirst + ulIdx) << BLOCK_SIZE_P2, REDCONF_BLOCK_SIZE, &gCluster.abData[ulIdx << BLOCK_SIZE_P2]);
+        }
+
+        pbSrc = gCluster.abData;
+    }
+
+    if((ret == 0) && ClusterSpaceAvailable())
+    {
+        uint32_t ulStreamLen = RedLzCompress(pbSrc, CLUSTER_SIZE, &gabStream[CLUSTER_HEADER_SIZE], sizeof(gabStream) - CLUSTER_HEADER_SIZE);
+
+        if(ulStreamLen > 0U)
+        {
+            uint32_t ulTotalLen = ulStreamLen + CLUSTER_HEADER_SIZE;
+            uint32_t ulStreamBlocks = (ulTotalLen + (REDCONF_BLOCK_SIZE - 1U)) >> BLOCK_SIZE_P2;
+            uint32_t ulWritten = ulStreamBlocks;
+            uint32_t ulIdx;
+
+            gabStream[0U] = (uint8_t)ulStreamLen;
+            gabStream[1U] = (uint8_t)(ulStreamLen >> 8U);
+            gabStream[2U] = (uint8_t)(ulStreamLen >> 16U);
+            gabStream[3U] = (uint8_t)(ulStreamLen >> 24U);
+            RedMemSet(&gabStream[ulTotalLen], 0U, (ulStreamBlocks << BLOCK_SIZE_P2) - ulTotalLen);
+
+            ret = ClusterEntrySet(pInode, ulFirst, BLOCK_COMPRESSED);
+
+            if(ret == 0)
+            {
+                ret = WriteAligned(pInode, ulFirst + 1U, &ulWritten, gabStream);
+            }
+
+            /*  Space was checked in advance.
+            */
+            if((ret == -RED_ENOSPC) || ((ret == 0) && (ulWritten != ulStreamBlocks)))
+            {
+                CRITICAL_ERROR();
+                ret = -RED_EFUBAR;
+            }
+
+            for(ulIdx = ulFirst + 1U + ulStreamBlocks; (ret == 0) && (ulIdx < (ulFirst + CLUSTER_BLOCKS)); ulIdx++)
+            {
+                ret = ClusterEntrySet(pInode, ulIdx, BLOCK_SPARSE);
+            }
+
+            if(ret == 0)
+            {
+                *pfPacked = true;
+
+                /*  Data gathered from the blocks is still in the cache, and is
+                    now the decompressed form of the new compressed data.
+                */
+                if(pbSrc == gCluster.abData)
+                {
+                    ret = RedInodeDataSeek(pInode, ulFirst + 1U);
+
+                    if(ret == 0)
+                    {
+                        gCluster.bVolNum = gbRedVolNum;
+                        gCluster.ulInode = pInode->ulInode;
+                        gCluster.ulCluster = ulCluster;
+                        gCluster.ulStreamBlock = pInode->ulDataBlock;
+                        gCluster.fValid = true;
+                    }
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Turn a compressed cluster back into ordinary blocks.
+
+    @param pInode       A pointer to the cached inode structure.
+    @param ulCluster    The cluster number within the inode, which must be
+                        compressed.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL Invalid parameters.
+    @retval -RED_EIO    A disk I/O error occurred, or the compressed data is
+                        corrupt.
+    @retval -RED_ENOSPC Insufficient free space to expand the cluster.
+*/
+static REDSTATUS ClusterExpand(
+    CINODE     *pInode,
+    uint32_t    ulCluster)
+{
+    REDSTATUS   ret = 0;
+    uint32_t    ulFirst = ulCluster * CLUSTER_BLOCKS;
+
+    /*  Check for space up front, so that the compressed data cannot be left
+        half overwritten.
+    */
+    if(!ClusterSpaceAvailable())
+    {
+        ret = -RED_ENOSPC;
+    }
+    else
+    {
+        ret = ClusterLoad(pInode, ulCluster);
+    }
+
+    /*  Clearing the marker invalidates the cache, but leaves the decompressed
+        data intact.
+    */
+    if(ret == 0)
+    {
+        ret = ClusterEntrySet(pInode, ulFirst, BLOCK_SPARSE);
+    }
+
+    if(ret == 0)
+    {
+        uint32_t ulWritten = CLUSTER_BLOCKS;
+
+        ret = WriteAligned(pInode, ulFirst, &ulWritten, gCluster.abData);
+
+        if((ret == -RED_ENOSPC) || ((ret == 0) && (ulWritten != CLUSTER_BLOCKS)))
+        {
+            CRITICAL_ERROR();
+            ret = -RED_EFUBAR;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Set the entry for a block of a compressed inode.
+
+    The block previously in the entry, if any, is freed.
+
+    @param pInode   A pointer to the cached inode structure.
+    @param ulBlock  The file block offset of the entry.
+    @param ulValue  The new entry: BLOCK_SPARSE or BLOCK_COMPRESSED.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL Invalid parameters.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOSPC Insufficient free space to branch the indirect nodes.
+*/
+static REDSTATUS ClusterEntrySet(
+    CINODE     *pInode,
+    uint32_t    ulBlock,
+    uint32_t    ulValue)
+{
+    REDSTATUS   ret = RedInodeDataSeek(pInode, ulBlock);
+
+    if((ret == -RED_ENODATA) && (ulValue == BLOCK_SPARSE))
+    {
+        /*  Already sparse.
+        */
+        ret = 0;
+    }
+    else if((ret == 0) || (ret == -RED_ENODATA))
+    {
+        ret = BranchBlock(pInode, BRANCHDEPTH_INDIR, false);
+
+        if(ret == 0)
+        {
+            uint32_t *pulEntry;
+
+          #if REDCONF_DIRECT_POINTERS < INODE_ENTRIES
+            if(pInode->uIndirEntry != COORD_ENTRY_INVALID)
+            {
+                pulEntry = &pInode->pIndir->aulEntries[pInode->uIndirEntry];
+            }
+            else
+          #endif
+            {
+                pulEntry = &pInode->pInodeBuf->aulEntries[pInode->uInodeEntry];
+            }
+
+            RedInodePutData(pInode);
+
+            ret = TruncDataBlock(pInode, pulEntry, true);
+
+            if(ret == 0)
+            {
+                NODE_ENTRY_SET(*pulEntry, ulValue);
+                pInode->ulDataBlock = ulValue;
+            }
+        }
+    }
+    else
+    {
+        /*  Unexpected error, return it.
+        */
+    }
+
+    return ret;
+}
+
+
+/** @brief Determine whether there is room to rewrite a whole cluster.
+
+    @return Whether a cluster's worth of data blocks, along with the metadata
+            blocks which might need to be branched to write them, is free.
+*/
+static bool ClusterSpaceAvailable(void)
+{
+    return FreeBlockCount() >= (CLUSTER_BLOCKS + WriteRunMetaCost(CLUSTER_BLOCKS));
+}
+#endif /* REDCONF_READ_ONLY == 0 */
+#endif /* COMPRESSION_SUPPORTED */
+
@@ -0,0 +1,372 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                   Copyright (c) 2014-2015 Datalight, Inc.
+                       All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license may obtain a commercial license
+    before incorporating Reliance Edge into proprietary software for
+    distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+    more information.
+*/
+/** @file
+    @brief Implements incremental verification (scrubbing) of a mounted volume.
+
+    A scrub walks the volume a little at a time.  Each call verifies imap
+    nodes, inodes, and the blocks of files and directories until its time slice
+    is used up, and records where it stopped, so that the next call carries on
+    from there.  Between calls the volume is available as usual, so a scrub can
+    run from a low-priority task without stopping other file system activity.
+
+    The following are verified:
+
+    - Each imap node, as referenced by either metaroot, passes the metadata
+      node checks (signature, CRC, and sequence number).
+    - Each inode in use, along with its indirect and double indirect nodes,
+      passes the same checks, and its size is within the maximum inode size.
+    - Each block pointed at by an inode is an allocable block which is
+      allocated.
+    - Each directory entry in use has a name and points at an allocated inode.
+    - Each file data block can be read from the block device.
+*/
+#include <redfs.h>
+
+#if SCRUB_SUPPORTED
+
+#include <redcore.h>
+
+
+static REDSTATUS ScrubImap(REDSCRUB *pScrub);
+static REDSTATUS ScrubInode(REDSCRUB *pScrub, REDTIMESTAMP tsStart, uint32_t ulMaxMicrosecs);
+static REDSTATUS ScrubBlock(CINODE *pInode, uint32_t ulBlock, bool *pfValid);
+static void ScrubError(REDSCRUB *pScrub);
+
+
+/*  File data is read into this buffer, rather than into a block buffer, so
+    that scrubbing does not displace blocks which are in use.
+*/
+static ALIGNED_2D_BYTE_ARRAY(gScrub, aabBuffer, 1U, REDCONF_BLOCK_SIZE);
+
+
+/** @brief Verify part of the current volume, continuing from where the last
+           call left off.
+
+    Work is done in small units (one imap node, one inode, or one block of an
+    inode) until @p ulMaxMicrosecs have passed.  At least one unit is done by
+    every call, so progress is made even when @p ulMaxMicrosecs is zero.  The
+    call also returns early when a pass over the volume is completed.
+
+    Inconsistencies are counted in @p pScrub, and scrubbing continues past
+    them.  Errors which prevent scrubbing, such as a disk I/O error or a
+    corrupt metadata node, are returned; @p pScrub is then left at the unit
+    which failed.
+
+    @param pScrub           The scrub progress, updated on return.
+    @param ulMaxMicrosecs   The time slice, in microseconds.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p pScrub is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred, or a metadata node is
+                        corrupt.
+*/
+REDSTATUS RedVolScrub(
+    REDSCRUB       *pScrub,
+    uint32_t        ulMaxMicrosecs)
+{
+    REDSTATUS       ret = 0;
+
+    if(pScrub == NULL)
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        REDTIMESTAMP    tsStart = RedOsTimestamp();
+        bool            fDone = false;
+
+        while((ret == 0) && !fDone)
+        {
+            if(pScrub->ulInode == 0U)
+            {
+                ret = ScrubImap(pScrub);
+            }
+            else if(INODE_IS_VALID(pScrub->ulInode))
+            {
+                ret = ScrubInode(pScrub, tsStart, ulMaxMicrosecs);
+            }
+            else
+            {
+                /*  Every inode has been verified, so the pass is complete.
+                */
+                pScrub->ulImapNode = 0U;
+                pScrub->ulInode = 0U;
+                pScrub->ulBlock = 0U;
+                pScrub->ulPasses++;
+                fDone = true;
+            }
+
+            if(!fDone)
+            {
+                fDone = RedOsTimePassed(tsStart) >= ulMaxMicrosecs;
+            }
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Verify the next imap node, or move on to the inodes if the imap has
+           been verified.
+
+    @param pScrub   The scrub progress.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred, or the imap node is corrupt.
+*/
+static REDSTATUS ScrubImap(
+    REDSCRUB   *pScrub)
+{
+    REDSTATUS   ret = 0;
+
+  #if REDCONF_IMAP_EXTERNAL == 1
+    if(!gpRedCoreVol->fImapInline && (pScrub->ulImapNode < gpRedCoreVol->ulImapNodeCount))
+    {
+        uint8_t bMR;
+
+        /*  Reading the node through the buffers verifies it.  If the node has
+            not been branched, both metaroots point at the same copy.
+        */
+        for(bMR = 0U; (ret == 0) && (bMR < 2U); bMR++)
+        {
+            IMAPNODE *pImap;
+
+          #if REDCONF_FORMAT_QUICK == 1
+            /*  Nodes past the high-water mark have never been written.
+            */
+            if(pScrub->ulImapNode < gpRedCoreVol->aMR[bMR].ulImapHighWater)
+          #endif
+            {
+                ret = RedBufferGet(RedImapNodeBlock(bMR, pScrub->ulImapNode), BFLAG_META_IMAP, CAST_VOID_PTR_PTR(&pImap));
+                if(ret == 0)
+                {
+                    RedBufferPut(pImap);
+                }
+            }
+        }
+
+        if(ret == 0)
+        {
+            pScrub->ulImapNode++;
+        }
+    }
+    else
+  #endif
+    {
+        /*  The inline imap is part of the metaroot, which was verified when
+            the volume was mounted.
+        */
+        pScrub->ulInode = INODE_FIRST_VALID;
+        pScrub->ulBlock = 0U;
+    }
+
+    return ret;
+}
+
+
+/** @brief Verify the blocks of the current inode, until the inode is done or
+           the time slice is used up.
+
+    @param pScrub           The scrub progress.
+    @param tsStart          When the time slice started.
+    @param ulMaxMicrosecs   The length of the time slice, in microseconds.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred, or a metadata node is
+                        corrupt.
+*/
+static REDSTATUS ScrubInode(
+    REDSCRUB       *pScrub,
+    REDTIMESTAMP    tsStart,
+    uint32_t        ulMaxMicrosecs)
+{
+    CINODE          ino;
+    REDSTATUS       ret;
+
+    ino.ulInode = pScrub->ulInode;
+    ret = RedInodeMount(&ino, FTYPE_EITHER, false);
+
+    if(ret == -RED_EBADF)
+    {
+        /*  The inode is free, so there is nothing to verify.
+        */
+        pScrub->ulInode++;
+        pScrub->ulBlock = 0U;
+        ret = 0;
+    }
+    else if(ret == 0)
+    {
+        bool fInodeDone = true;
+
+        if(ino.pInodeBuf->ullSize > gpRedVolume->ullMaxInodeSize)
+        {
+            ScrubError(pScrub);
+        }
+        else
+        {
+            uint32_t    ulBlockCount = (uint32_t)((ino.pInodeBuf->ullSize + (REDCONF_BLOCK_SIZE - 1U)) >> BLOCK_SIZE_P2);
+            bool        fTimeUp = false;
+
+            while((ret == 0) && !fTimeUp && (pScrub->ulBlock < ulBlockCount))
+            {
+                bool fValid;
+
+                ret = ScrubBlock(&ino, pScrub->ulBlock, &fValid);
+
+                if(ret == 0)
+                {
+                    if(!fValid)
+                    {
+                        ScrubError(pScrub);
+                    }
+
+                    pScrub->ulBlock++;
+                    fTimeUp = RedOsTimePassed(tsStart) >= ulMaxMicrosecs;
+                }
+            }
+
+            /*  If stopped partway through the inode, the next call resumes
+                with the same inode.
+            */
+            fInodeDone = (ret == 0) && (pScrub->ulBlock >= ulBlockCount);
+        }
+
+        if(fInodeDone)
+        {
+            pScrub->ulInode++;
+            pScrub->ulBlock = 0U;
+        }
+
+        RedInodePut(&ino, 0U);
+    }
+    else
+    {
+        /*  The inode could not be read; return the error.
+        */
+    }
+
+    return ret;
+}
+
+
+/** @brief Verify one block of an inode.
+
+    @param pInode   The mounted inode.
+    @param ulBlock  The block offset within the inode.
+    @param pfValid  On successful return, populated with whether the block was
+                    found to be consistent.  A sparse block is consistent.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred, or a metadata node is
+                        corrupt.
+*/
+static REDSTATUS ScrubBlock(
+    CINODE     *pInode,
+    uint32_t    ulBlock,
+    bool       *pfValid)
+{
+    REDSTATUS   ret;
+
+    *pfValid = true;
+
+    ret = RedInodeDataSeek(pInode, ulBlock);
+
+    if(ret == -RED_ENODATA)
+    {
+        ret = 0;
+    }
+  #if COMPRESSION_SUPPORTED
+    else if((ret == 0) && (pInode->ulDataBlock == BLOCK_COMPRESSED))
+    {
+        /*  Compressed cluster marker: not a block, nothing to check.
+        */
+    }
+  #endif
+    else if(ret == 0)
+    {
+        uint32_t    ulDataBlock = pInode->ulDataBlock;
+
+        if((ulDataBlock < gpRedCoreVol->ulFirstAllocableBN) || (ulDataBlock >= gpRedVolume->ulBlockCount))
+        {
+            *pfValid = false;
+        }
+        else
+        {
+            ALLOCSTATE  state;
+
+            ret = RedImapBlockState(ulDataBlock, &state);
+
+            if((ret == 0) && (state != ALLOCSTATE_USED) && (state != ALLOCSTATE_NEW))
+            {
+                *pfValid = false;
+            }
+        }
+
+        if((ret == 0) && *pfValid)
+        {
+            if(pInode->fDirectory)
+            {
+                ret = RedDirBlockCheck(pInode, ulBlock, pfValid);
+            }
+            else
+            {
+                ret = RedIoRead(gbRedVolNum, ulDataBlock, 1U, gScrub.aabBuffer[0U]);
+            }
+        }
+    }
+    else
+    {
+        /*  An indirect or double indirect node could not be read; return the
+            error.
+        */
+    }
+
+    return ret;
+}
+
+
+/** @brief Record an inconsistency in the current inode.
+
+    @param pScrub   The scrub progress.
+*/
+static void ScrubError(
+    REDSCRUB   *pScrub)
+{
+    pScrub->ulErrors++;
+    pScrub->ulErrorInode = pScrub->ulInode;
+}
+
+#endif /* SCRUB_SUPPORTED */
+
@@ -54,7 +54,12 @@ REDSTATUS RedVolMount(void)
 
     if(ret == 0)
     {
-        ret = RedVolMountMaster();
+        ret = RedIoGetGeometry(gbRedVolNum);
+
+        if(ret == 0)
+        {
+            ret = RedVolMountMaster();
+        }
 
         if(ret == 0)
         {
@@ -109,7 +114,10 @@ REDSTATUS RedVolMountMaster(void)
             || (pMB->bBlockSizeP2 != BLOCK_SIZE_P2)
             || (((pMB->bFlags & MBFLAG_API_POSIX) != 0U) != (REDCONF_API_POSIX == 1))
             || (((pMB->bFlags & MBFLAG_INODE_TIMESTAMPS) != 0U) != (REDCONF_INODE_TIMESTAMPS == 1))
-            || (((pMB->bFlags & MBFLAG_INODE_BLOCKS) != 0U) != (REDCONF_INODE_BLOCKS == 1)))
+            || (((pMB->bFlags & MBFLAG_INODE_BLOCKS) != 0U) != (REDCONF_INODE_BLOCKS == 1))
+            || (((pMB->bFlags & MBFLAG_ORPHAN_LIST) != 0U) != ((REDCONF_API_POSIX == 1) && (REDCONF_DEFERRED_DELETE > 0U)))
+            || (((pMB->bFlags & MBFLAG_IMAP_HIGH_WATER) != 0U) != (REDCONF_FORMAT_QUICK == 1))
+            || (((pMB->bFlags & MBFLAG_COMPRESSION) != 0U) != (REDCONF_COMPRESSION == 1)))
         {
             ret = -RED_EIO;
         }
@@ -155,12 +163,13 @@ REDSTATUS RedVolMountMetaroot(void)
 {
     REDSTATUS ret;
 
-    ret = RedIoRead(gbRedVolNum, BLOCK_NUM_FIRST_METAROOT, 1U, &gpRedCoreVol->aMR[0U]);
+    /*  The metaroots are adjacent on disk and in memory, so read them both
+        with a single device request.  Mount time matters on devices which are
+        often power cycled, and each request has a fixed overhead on most media.
+    */
+    REDASSERT(sizeof(gpRedCoreVol->aMR[0U]) == REDCONF_BLOCK_SIZE);
 
-    if(ret == 0)
-    {
-        ret = RedIoRead(gbRedVolNum, BLOCK_NUM_FIRST_METAROOT + 1U, 1U, &gpRedCoreVol->aMR[1U]);
-    }
+    ret = RedIoRead(gbRedVolNum, BLOCK_NUM_FIRST_METAROOT, 2U, gpRedCoreVol->aMR);
 
     /*  Determine which metaroot is the most recent copy that was written
         completely.
@@ -222,6 +231,13 @@ REDSTATUS RedVolMountMetaroot(void)
                 */
                 ret = -RED_EIO;
             }
+          #if REDCONF_FORMAT_QUICK == 1
+            else if(    !gpRedCoreVol->fImapInline
+                     && (gpRedCoreVol->aMR[bMR].ulImapHighWater > gpRedCoreVol->ulImapNodeCount))
+            {
+                ret = -RED_EIO;
+            }
+          #endif
             else
             {
                 gpRedCoreVol->bCurMR = bMR;
@@ -264,6 +280,40 @@ REDSTATUS RedVolMountMetaroot(void)
         gpRedCoreVol->aMR[1U - gpRedCoreVol->bCurMR] = *gpRedMR;
         gpRedCoreVol->bCurMR = 1U - gpRedCoreVol->bCurMR;
         gpRedMR = &gpRedCoreVol->aMR[gpRedCoreVol->bCurMR];
+
+      #if (REDCONF_READ_ONLY == 0) && (REDCONF_IMAP_SUMMARY > 0U)
+        RedImapSummaryReset();
+      #endif
+
+      #if REDCONF_INODE_CACHE > 0U
+        RedInodeCacheReset();
+      #endif
+
+      #if COMPRESSION_SUPPORTED
+        RedInodeDataClusterReset();
+      #endif
+
+      #if (REDCONF_API_POSIX == 1) && (REDCONF_DENTRY_CACHE > 0U)
+        RedDirDentryReset();
+      #endif
+
+      #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
+        gpRedCoreVol->ulInodeFreeHint = INODE_FIRST_FREE;
+      #endif
+
+      #if (REDCONF_READ_ONLY == 0) && (REDCONF_ALLOC_ERASE_AWARE == 1)
+        gpRedCoreVol->ulAllocMetaBlock = 0U;
+        gpRedCoreVol->fEraseBlocksFull = false;
+      #endif
+
+      #if (REDCONF_READ_ONLY == 0) && (REDCONF_TRANSACT_GROUP_MS > 0U)
+        gpRedCoreVol->tsGroupStart = RedOsTimestamp();
+        gpRedCoreVol->ulGroupBytes = 0U;
+      #endif
+
+      #if TRANSACT_TASK_SUPPORTED
+        gpRedCoreVol->fTransactAsync = false;
+      #endif
     }
 
     return ret;
@@ -359,9 +409,20 @@ REDSTATUS RedVolTransact(void)
 
     if(gpRedCoreVol->fBranched)
     {
+      #if REDCONF_STATS_LATENCY == 1
+        REDTIMESTAMP tsStart = RedOsTimestamp();
+      #endif
+
         gpRedMR->ulFreeBlocks += gpRedCoreVol->ulAlmostFreeBlocks;
         gpRedCoreVol->ulAlmostFreeBlocks = 0U;
 
+      #if REDCONF_ALLOC_ERASE_AWARE == 1
+        /*  The almost free blocks are now free, so there may be empty erase
+            blocks again.
+        */
+        gpRedCoreVol->fEraseBlocksFull = false;
+      #endif
+
         ret = RedBufferFlush(0U, gpRedVolume->ulBlockCount);
 
         if(ret == 0)
@@ -440,11 +501,32 @@ REDSTATUS RedVolTransact(void)
             gpRedMR = &gpRedCoreVol->aMR[gpRedCoreVol->bCurMR];
 
             gpRedCoreVol->fBranched = false;
+
+          #if REDCONF_TRANSACT_GROUP_MS > 0U
+            gpRedCoreVol->tsGroupStart = RedOsTimestamp();
+            gpRedCoreVol->ulGroupBytes = 0U;
+          #endif
+
+          #if REDCONF_STATS == 1
+            gaRedIoStats[gbRedVolNum].ullTransactions++;
+          #endif
+          #if REDCONF_STATS_LATENCY == 1
+            RedIoStatsLatency(gaRedIoStats[gbRedVolNum].aulTransactLatency, tsStart);
+          #endif
         }
 
         CRITICAL_ASSERT(ret == 0);
     }
 
+  #if TRANSACT_TASK_SUPPORTED
+    /*  Anything handed to the commit task has been committed now.
+    */
+    if(ret == 0)
+    {
+        gpRedCoreVol->fTransactAsync = false;
+    }
+  #endif
+
     return ret;
 }
 #endif
@@ -460,12 +542,22 @@ static void MetaRootEndianSwap(
     }
     else
     {
+        /*  The header CRC is swapped where it is computed and checked.
+        */
+        pMetaRoot->hdr.ulSignature = RedRev32(pMetaRoot->hdr.ulSignature);
+        pMetaRoot->hdr.ullSequence = RedRev64(pMetaRoot->hdr.ullSequence);
         pMetaRoot->ulSectorCRC = RedRev32(pMetaRoot->ulSectorCRC);
         pMetaRoot->ulFreeBlocks = RedRev32(pMetaRoot->ulFreeBlocks);
       #if REDCONF_API_POSIX == 1
         pMetaRoot->ulFreeInodes = RedRev32(pMetaRoot->ulFreeInodes);
       #endif
         pMetaRoot->ulAllocNextBlock = RedRev32(pMetaRoot->ulAllocNextBlock);
+      #if (REDCONF_API_POSIX == 1) && (REDCONF_DEFERRED_DELETE > 0U)
+        pMetaRoot->ulOrphanHead = RedRev32(pMetaRoot->ulOrphanHead);
+      #endif
+      #if REDCONF_FORMAT_QUICK == 1
+        pMetaRoot->ulImapHighWater = RedRev32(pMetaRoot->ulImapHighWater);
+      #endif
     }
 }
 #endif
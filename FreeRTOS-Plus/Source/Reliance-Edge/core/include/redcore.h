@@ -43,11 +43,28 @@
 #define META_SIG_INDIR      (0x49444E49U)   /* 'INDI' */
 
 
+REDSTATUS RedIoGetGeometry(uint8_t bVolNum);
 REDSTATUS RedIoRead(uint8_t bVolNum, uint32_t ulBlockStart, uint32_t ulBlockCount, void *pBuffer);
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedIoWrite(uint8_t bVolNum, uint32_t ulBlockStart, uint32_t ulBlockCount, const void *pBuffer);
 REDSTATUS RedIoFlush(uint8_t bVolNum);
 #endif
+#if (REDCONF_READ_ONLY == 1) && (REDCONF_READ_MAP > 0U)
+const uint8_t *RedIoMappedBlock(uint8_t bVolNum, uint32_t ulBlock);
+#endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_ALLOC_ERASE_AWARE == 1)
+uint32_t RedIoEraseBlocks(uint8_t bVolNum);
+#endif
+
+#if REDCONF_STATS == 1
+/*  I/O statistics for each volume; defined in blockio.c.
+*/
+extern REDIOSTATS gaRedIoStats[REDCONF_VOLUME_COUNT];
+
+#if REDCONF_STATS_LATENCY == 1
+void RedIoStatsLatency(uint32_t *paulHistogram, REDTIMESTAMP tsStart);
+#endif
+#endif
 
 
 /** Indicates a block buffer is dirty (its contents are different than the
@@ -82,6 +99,11 @@ REDSTATUS RedIoFlush(uint8_t bVolNum);
 */
 #define BFLAG_META_DINDIR   ((uint16_t)(0x0040U | BFLAG_META))
 
+/** Indicates that a file data block buffer belongs to a directory.  This is
+    only a hint for buffer replacement; see REDCONF_BUFFER_DATA_MAX.
+*/
+#define BFLAG_DIRECTORY     ((uint16_t) 0x0080U)
+
 /** Indicates that a block buffer is a metadata node.  Callers of RedBufferGet()
     should not use this flag; instead, use one of the BFLAG_META_* flags.
 */
@@ -100,6 +122,13 @@ void RedBufferDiscard(const void *pBuffer);
 #endif
 #endif
 REDSTATUS RedBufferDiscardRange(uint32_t ulBlockStart, uint32_t ulBlockCount);
+#if REDCONF_READ_AHEAD > 0U
+REDSTATUS RedBufferReadAhead(uint32_t ulBlockStart, uint32_t ulBlockCount);
+#endif
+#if REDCONF_READ_MAP > 0U
+REDSTATUS RedBufferPin(const void *pBuffer);
+void RedBufferUnpin(const void *pBuffer);
+#endif
 
 
 /** @brief Allocation state of a block.
@@ -112,10 +141,23 @@ typedef enum
     ALLOCSTATE_AFREE    /**< Will become free after a transaction; not writeable. */
 } ALLOCSTATE;
 
+/** @brief What a block is being allocated for; a hint to the allocation
+           policy.
+*/
+typedef enum
+{
+    ALLOCTYPE_DATA,     /**< File data, which is seldom rewritten. */
+    ALLOCTYPE_META      /**< Indirect nodes and directory data, which are rewritten often. */
+} ALLOCTYPE;
+
 REDSTATUS RedImapBlockGet(uint8_t bMR, uint32_t ulBlock, bool *pfAllocated);
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedImapBlockSet(uint32_t ulBlock, bool fAllocated);
-REDSTATUS RedImapAllocBlock(uint32_t *pulBlock);
+REDSTATUS RedImapAllocBlock(ALLOCTYPE type, uint32_t *pulBlock);
+REDSTATUS RedImapAllocRun(uint32_t ulMaxBlocks, uint32_t *pulBlock, uint32_t *pulCount);
+#if REDCONF_IMAP_SUMMARY > 0U
+void RedImapSummaryReset(void);
+#endif
 #endif
 REDSTATUS RedImapBlockState(uint32_t ulBlock, ALLOCSTATE *pState);
 
@@ -144,6 +186,12 @@ typedef struct
     bool        fDirty;         /**< True if the inode buffer is dirty. */
   #endif
     bool        fCoordInited;   /**< True after the first seek. */
+  #if REDCONF_INODE_CACHE > 0U
+    bool        fCoordHint;     /**< True if the seek coordinates were remembered from the last time the inode was put. */
+  #endif
+  #if SNAPSHOT_SUPPORTED
+    bool        fSnapshot;      /**< True if the inode is from the pinned snapshot. */
+  #endif
 
     INODE      *pInodeBuf;      /**< Pointer to the inode buffer. */
   #if DINDIR_POINTERS > 0U
@@ -185,10 +233,37 @@ typedef struct
 #define IPUT_UPDATE_MASK    (IPUT_UPDATE_ATIME|IPUT_UPDATE_MTIME|IPUT_UPDATE_CTIME)
 
 
+/** @brief The metadata of an inode which is reported by stat, as returned by
+           RedInodeMetaGet().
+*/
+typedef struct
+{
+    uint64_t    ullSize;        /**< Size of the inode, in bytes. */
+  #if REDCONF_INODE_BLOCKS == 1
+    uint32_t    ulBlocks;       /**< Total number file data blocks allocated to the inode. */
+  #endif
+  #if REDCONF_INODE_TIMESTAMPS == 1
+    uint32_t    ulATime;        /**< Time of last access (seconds since January 1, 1970). */
+    uint32_t    ulMTime;        /**< Time of last modification (seconds since January 1, 1970). */
+    uint32_t    ulCTime;        /**< Time of last status change (seconds since January 1, 1970). */
+  #endif
+    uint16_t    uMode;          /**< Inode type (file or directory) and permissions (reserved). */
+  #if (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_LINK == 1)
+    uint16_t    uNLink;         /**< Link count, number of names pointing to the inode. */
+  #endif
+} INODEMETA;
+
+
 REDSTATUS RedInodeMount(CINODE *pInode, FTYPE type, bool fBranch);
+#if SNAPSHOT_SUPPORTED
+REDSTATUS RedInodeMountSnapshot(CINODE *pInode, FTYPE type);
+#endif
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedInodeBranch(CINODE *pInode);
 #endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_ATIME == 1)
+REDSTATUS RedInodeAtimeBranch(CINODE *pInode, bool *pfUpdate);
+#endif
 #if (REDCONF_READ_ONLY == 0) && ((REDCONF_API_POSIX == 1) || FORMAT_SUPPORTED)
 REDSTATUS RedInodeCreate(CINODE *pInode, uint32_t ulPInode, uint16_t uMode);
 #endif
@@ -196,6 +271,9 @@ REDSTATUS RedInodeCreate(CINODE *pInode, uint32_t ulPInode, uint16_t uMode);
 REDSTATUS RedInodeDelete(CINODE *pInode);
 REDSTATUS RedInodeLinkDec(CINODE *pInode);
 #endif
+#if DEFERRED_DELETE_SUPPORTED
+REDSTATUS RedInodeOrphanReclaim(uint32_t ulMaxBlocks);
+#endif
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
 REDSTATUS RedInodeFree(CINODE *pInode);
 #endif
@@ -208,20 +286,39 @@ void RedInodePutDindir(CINODE *pInode);
 void RedInodePutIndir(CINODE *pInode);
 #endif
 void RedInodePutData(CINODE *pInode);
-#if ((REDCONF_READ_ONLY == 0) && ((REDCONF_API_POSIX == 1) || FORMAT_SUPPORTED)) || (REDCONF_CHECKER == 1)
+REDSTATUS RedInodeMetaGet(uint32_t ulInode, FTYPE type, INODEMETA *pMeta);
+#if SNAPSHOT_SUPPORTED
+REDSTATUS RedInodeSnapMetaGet(uint32_t ulInode, INODEMETA *pMeta);
+#endif
+#if REDCONF_INODE_CACHE > 0U
+void RedInodeCacheReset(void);
+#endif
+#if ((REDCONF_READ_ONLY == 0) && ((REDCONF_API_POSIX == 1) || FORMAT_SUPPORTED)) || (REDCONF_CHECKER == 1) || SCRUB_SUPPORTED
 REDSTATUS RedInodeIsFree(uint32_t ulInode, bool *pfFree);
 #endif
 REDSTATUS RedInodeBitGet(uint8_t bMR, uint32_t ulInode, uint8_t bWhich, bool *pfAllocated);
 
 REDSTATUS RedInodeDataRead(CINODE *pInode, uint64_t ullStart, uint32_t *pulLen, void *pBuffer);
+#if REDCONF_READ_MAP > 0U
+REDSTATUS RedInodeDataReadMap(CINODE *pInode, uint64_t ullStart, uint32_t *pulLen, const uint8_t **ppbBlock, bool *pfPinned);
+#endif
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedInodeDataWrite(CINODE *pInode, uint64_t ullStart, uint32_t *pulLen, const void *pBuffer);
 #if DELETE_SUPPORTED || TRUNCATE_SUPPORTED
 REDSTATUS RedInodeDataTruncate(CINODE *pInode, uint64_t ullSize);
 #endif
 #endif
+#if FALLOCATE_SUPPORTED
+REDSTATUS RedInodeDataAllocate(CINODE *pInode, uint64_t ullStart, uint64_t ullLen);
+#endif
+#if COPYFILE_SUPPORTED
+REDSTATUS RedInodeDataCopy(CINODE *pSrcInode, uint64_t ullSrcStart, CINODE *pDstInode, uint64_t ullDstStart, uint32_t *pulLen);
+#endif
 REDSTATUS RedInodeDataSeekAndRead(CINODE *pInode, uint32_t ulBlock);
 REDSTATUS RedInodeDataSeek(CINODE *pInode, uint32_t ulBlock);
+#if COMPRESSION_SUPPORTED
+void RedInodeDataClusterReset(void);
+#endif
 
 #if REDCONF_API_POSIX == 1
 #if REDCONF_READ_ONLY == 0
@@ -231,12 +328,20 @@ REDSTATUS RedDirEntryCreate(CINODE *pPInode, const char *pszName, uint32_t ulIno
 REDSTATUS RedDirEntryDelete(CINODE *pPInode, uint32_t ulDeleteIdx);
 #endif
 REDSTATUS RedDirEntryLookup(CINODE *pPInode, const char *pszName, uint32_t *pulEntryIdx, uint32_t *pulInode);
+#if REDCONF_DENTRY_CACHE > 0U
+bool RedDirDentryLookup(uint32_t ulPInode, const char *pszName, uint32_t *pulInode);
+void RedDirDentryPurge(uint32_t ulPInode);
+void RedDirDentryReset(void);
+#endif
 #if (REDCONF_API_POSIX_READDIR == 1) || (REDCONF_CHECKER == 1)
 REDSTATUS RedDirEntryRead(CINODE *pPInode, uint32_t *pulIdx, char *pszName, uint32_t *pulInode);
 #endif
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_RENAME == 1)
 REDSTATUS RedDirEntryRename(CINODE *pSrcPInode, const char *pszSrcName, CINODE *pSrcInode, CINODE *pDstPInode, const char *pszDstName, CINODE *pDstInode);
 #endif
+#if SCRUB_SUPPORTED
+REDSTATUS RedDirBlockCheck(CINODE *pPInode, uint32_t ulBlock, bool *pfValid);
+#endif
 #endif
 
 REDSTATUS RedVolMount(void);
@@ -252,6 +357,10 @@ REDSTATUS RedVolSeqNumIncrement(void);
 REDSTATUS RedVolFormat(void);
 #endif
 
+#if SCRUB_SUPPORTED
+REDSTATUS RedVolScrub(REDSCRUB *pScrub, uint32_t ulMaxMicrosecs);
+#endif
+
 
 #endif
 
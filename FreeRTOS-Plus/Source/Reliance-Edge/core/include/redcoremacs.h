@@ -33,6 +33,16 @@
 
 #define BLOCK_SPARSE        (0U)
 
+#if REDCONF_COMPRESSION == 1
+/*  In a compressed file, the entry for the first block of a compressed cluster
+    holds this value instead of a block number; see inodedata.c.
+*/
+#define BLOCK_COMPRESSED    (0xFFFFFFFFU)
+
+#define CLUSTER_BLOCKS      (REDCONF_COMPRESS_CLUSTER)
+#define CLUSTER_SIZE        (CLUSTER_BLOCKS * REDCONF_BLOCK_SIZE)
+#endif
+
 #define DINDIR_POINTERS     ((INODE_ENTRIES - REDCONF_DIRECT_POINTERS) - REDCONF_INDIRECT_POINTERS)
 #define DINDIR_DATA_BLOCKS  (INDIR_ENTRIES * INDIR_ENTRIES)
 
@@ -78,6 +78,72 @@ typedef struct
     */
     bool        fUseReservedBlocks;
   #endif
+
+  #if (REDCONF_READ_ONLY == 0) && (REDCONF_IMAP_SUMMARY > 0U)
+    /** Allocation summary: one bit for each range of allocable blocks, set if
+        the range is known to contain no free blocks.  This is a hint used to
+        speed up allocation; it is rebuilt from scratch after each mount.
+    */
+    uint8_t     abImapSummary[REDCONF_IMAP_SUMMARY];
+
+    /** Log base 2 of the number of blocks summarized by each bit of
+        abImapSummary.
+    */
+    uint8_t     bImapSummaryShift;
+  #endif
+
+  #if (REDCONF_READ_ONLY == 0) && (REDCONF_ALLOC_ERASE_AWARE == 1)
+    /** Allocation pointer for metadata, kept apart from the one in the
+        metaroot (which is used for file data) so that the two fill different
+        erase blocks.  Zero until the first metadata allocation after each
+        mount.
+    */
+    uint32_t    ulAllocMetaBlock;
+
+    /** Whether a search found no erase block which is entirely free.  This is
+        a hint to avoid repeating the search; it is cleared by each transaction
+        point, which can free blocks.
+    */
+    bool        fEraseBlocksFull;
+  #endif
+
+  #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
+    /** The lowest inode number which might be free: every inode number below
+        it is known to be in use.  This is a hint used to speed up inode
+        creation; it is reset after each mount.
+    */
+    uint32_t    ulInodeFreeHint;
+  #endif
+
+  #if (REDCONF_READ_ONLY == 0) && (REDCONF_TRANSACT_GROUP_MS > 0U)
+    /** When the last transaction point was committed (or the volume mounted),
+        which starts the group commit window.
+    */
+    REDTIMESTAMP tsGroupStart;
+
+    /** The number of bytes written since the last transaction point.
+    */
+    uint32_t    ulGroupBytes;
+  #endif
+
+  #if SNAPSHOT_SUPPORTED
+    /** Whether the committed state is pinned as a snapshot, which holds off
+        transaction points until it is released.
+    */
+    bool        fSnapshot;
+
+    /** Whether a transaction point was held off by the snapshot, and must be
+        committed when it is released.
+    */
+    bool        fSnapshotTransact;
+  #endif
+
+  #if TRANSACT_TASK_SUPPORTED
+    /** Whether a transaction point was handed to the commit task, and has not
+        been committed since.
+    */
+    bool        fTransactAsync;
+  #endif
 } COREVOLUME;
 
 /*  Pointer to the core volume currently being accessed; populated during
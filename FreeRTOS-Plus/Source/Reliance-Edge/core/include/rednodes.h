@@ -55,6 +55,15 @@ typedef struct
 /** Flag set in the master block when (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_LINK == 1). */
 #define MBFLAG_INODE_NLINK      (0x08U)
 
+/** Flag set in the master block when (REDCONF_API_POSIX == 1) && (REDCONF_DEFERRED_DELETE > 0U). */
+#define MBFLAG_ORPHAN_LIST      (0x10U)
+
+/** Flag set in the master block when REDCONF_FORMAT_QUICK == 1. */
+#define MBFLAG_IMAP_HIGH_WATER  (0x20U)
+
+/** Flag set in the master block when REDCONF_COMPRESSION == 1. */
+#define MBFLAG_COMPRESSION      (0x40U)
+
 
 /** @brief Node which identifies the volume and stores static volume information.
 */
@@ -75,10 +84,17 @@ typedef struct
 } MASTERBLOCK;
 
 
-#if REDCONF_API_POSIX == 1
-#define METAROOT_HEADER_SIZE    (NODEHEADER_SIZE + 16U) /* Size in bytes of the metaroot header fields. */
+#if (REDCONF_API_POSIX == 1) && (REDCONF_DEFERRED_DELETE > 0U)
+#define METAROOT_FIELDS_SIZE    (20U)
+#elif REDCONF_API_POSIX == 1
+#define METAROOT_FIELDS_SIZE    (16U)
 #else
-#define METAROOT_HEADER_SIZE    (NODEHEADER_SIZE + 12U) /* Size in bytes of the metaroot header fields. */
+#define METAROOT_FIELDS_SIZE    (12U)
+#endif
+#if REDCONF_FORMAT_QUICK == 1
+#define METAROOT_HEADER_SIZE    (NODEHEADER_SIZE + METAROOT_FIELDS_SIZE + 4U) /* Size in bytes of the metaroot header fields. */
+#else
+#define METAROOT_HEADER_SIZE    (NODEHEADER_SIZE + METAROOT_FIELDS_SIZE) /* Size in bytes of the metaroot header fields. */
 #endif
 #define METAROOT_ENTRY_BYTES    (REDCONF_BLOCK_SIZE - METAROOT_HEADER_SIZE) /* Number of bytes remaining in the metaroot block for entries. */
 #define METAROOT_ENTRIES        (METAROOT_ENTRY_BYTES * 8U)
@@ -95,6 +111,12 @@ typedef struct
     uint32_t    ulFreeInodes;       /**< Number of inode slots that are free. */
   #endif
     uint32_t    ulAllocNextBlock;   /**< Forward allocation pointer. */
+  #if (REDCONF_API_POSIX == 1) && (REDCONF_DEFERRED_DELETE > 0U)
+    uint32_t    ulOrphanHead;       /**< First deleted inode whose blocks are still to be freed; INODE_INVALID if none. */
+  #endif
+  #if REDCONF_FORMAT_QUICK == 1
+    uint32_t    ulImapHighWater;    /**< Number of external imap nodes ever written; later nodes are implicitly all free. */
+  #endif
 
     /** Imap bitmap.  With inline imaps, this is the imap bitmap that indicates
         which inode blocks are used and which allocable blocks are used.
@@ -191,5 +213,21 @@ typedef struct
 } INDIR, DINDIR;
 
 
+/*  The entries of inodes, indirects, and double indirects are only accessed
+    with these macros.  With REDCONF_ENDIAN_SWAP, the entry arrays are left in
+    on-disk byte order in the buffers, and each entry is swapped when it is
+    accessed, since an operation uses only a few of the hundreds of entries in
+    each node.  The other fields of the nodes are swapped when the buffer is
+    read or written, as before.
+*/
+#ifdef REDCONF_ENDIAN_SWAP
+#define NODE_ENTRY_GET(ulEntry)         RedRev32(ulEntry)
+#define NODE_ENTRY_SET(ulEntry, ulVal)  ((ulEntry) = RedRev32(ulVal))
+#else
+#define NODE_ENTRY_GET(ulEntry)         (ulEntry)
+#define NODE_ENTRY_SET(ulEntry, ulVal)  ((ulEntry) = (ulVal))
+#endif
+
+
 #endif
 
@@ -407,6 +407,119 @@ int32_t RedFseWrite(
 
     return ret;
 }
+
+
+/** @brief Write to several files atomically.
+
+    The writes are carried out in order, all under one acquisition of the file
+    system lock, and are committed together by a single transaction point
+    before this function returns.  Either all of them are committed or, if any
+    of them fails, none are: the working state is rolled back to the
+    transaction point before the batch.  A write which could only be done in
+    part counts as a failure.
+
+    Automatic transaction points are suspended for the duration of the batch,
+    since they would commit part of it.  If the volume has uncommitted changes
+    from before the call, they are committed first, so that a failed batch
+    does not discard them.
+
+    @param bVolNum  The volume number of the files to write.
+    @param paWrite  The array of writes to carry out.
+    @param ulCount  The number of elements in @p paWrite.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EBADF  A file number in @p paWrite is not a valid file number.
+    @retval -RED_EFBIG  A write would make its file exceed the maximum file
+                        size.
+    @retval -RED_EINVAL @p bVolNum is an invalid volume number or not mounted;
+                        or @p paWrite is `NULL`; or a buffer pointer in
+                        @p paWrite is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOSPC There is not enough free space for all of the writes.
+    @retval -RED_EROFS  The file system volume is read-only.
+*/
+REDSTATUS RedFseWriteBatch(
+    uint8_t             bVolNum,
+    const REDFSEWRITE  *paWrite,
+    uint32_t            ulCount)
+{
+    REDSTATUS           ret;
+
+    if(paWrite == NULL)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        ret = FseEnter(bVolNum);
+    }
+
+    if(ret == 0)
+    {
+        uint32_t ulTransMask = gpRedVolume->ulTransMask;
+
+        gpRedVolume->ulTransMask = RED_TRANSACT_MANUAL;
+
+        ret = RedCoreVolTransact();
+
+        if(ret == 0)
+        {
+            uint32_t ulIdx;
+
+            for(ulIdx = 0U; (ret == 0) && (ulIdx < ulCount); ulIdx++)
+            {
+                const REDFSEWRITE  *pWrite = &paWrite[ulIdx];
+                const uint8_t      *pbBuffer = CAST_VOID_PTR_TO_CONST_UINT8_PTR(pWrite->pBuffer);
+                uint32_t            ulDone = 0U;
+
+                /*  A short write leaves the rest to a second call, which
+                    reports why the rest could not be written.
+                */
+                while((ret == 0) && (ulDone < pWrite->ulLength))
+                {
+                    uint32_t ulWriteLen = pWrite->ulLength - ulDone;
+
+                    ret = RedCoreFileWrite(pWrite->ulFileNum, pWrite->ullFileOffset + ulDone, &ulWriteLen, &pbBuffer[ulDone]);
+
+                    if((ret == 0) && (ulWriteLen == 0U))
+                    {
+                        REDERROR();
+                        ret = -RED_EFUBAR;
+                    }
+                    else if(ret == 0)
+                    {
+                        ulDone += ulWriteLen;
+                    }
+                    else
+                    {
+                        /*  The write failed; the batch is rolled back below.
+                        */
+                    }
+                }
+            }
+
+            if(ret == 0)
+            {
+                ret = RedCoreVolTransact();
+            }
+            else
+            {
+                /*  If the volume went read-only after a critical error, the
+                    working state will never be committed anyway.
+                */
+                (void)RedCoreVolRollback();
+            }
+        }
+
+        gpRedVolume->ulTransMask = ulTransMask;
+
+        FseLeave();
+    }
+
+    return ret;
+}
 #endif
 
 
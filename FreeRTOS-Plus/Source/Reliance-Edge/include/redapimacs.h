@@ -53,7 +53,7 @@
 /** Transact after a successful red_close(). */
 #define RED_TRANSACT_CLOSE      0x00000040U
 
-/** Transact after a successful red_write() or RedFseWrite(). */
+/** Transact after a successful red_write(), red_writev(), or RedFseWrite(). */
 #define RED_TRANSACT_WRITE      0x00000080U
 
 /** Transact after a successful red_fsync(). */
@@ -65,6 +65,11 @@
 /** Transact to free space in disk full situations. */
 #define RED_TRANSACT_VOLFULL    0x00000400U
 
+/** Hand the other automatic transaction points to the commit task, rather
+    than committing them in the calling task; requires REDCONF_TRANSACT_TASK.
+*/
+#define RED_TRANSACT_ASYNC      0x00000800U
+
 #if REDCONF_READ_ONLY == 1
 
 /** Mask of all supported automatic transaction events. */
@@ -72,6 +77,12 @@
 
 #elif REDCONF_API_POSIX == 1
 
+#if REDCONF_TRANSACT_TASK == 1
+#define RED_TRANSACT_MASK_ASYNC RED_TRANSACT_ASYNC
+#else
+#define RED_TRANSACT_MASK_ASYNC 0U
+#endif
+
 /** @brief Mask of all supported automatic transaction events.
 */
 #define RED_TRANSACT_MASK                                                   \
@@ -86,7 +97,8 @@
     RED_TRANSACT_WRITE                                                  |   \
     RED_TRANSACT_FSYNC                                                  |   \
     ((REDCONF_API_POSIX_FTRUNCATE == 1) ? RED_TRANSACT_TRUNCATE : 0U)   |   \
-    RED_TRANSACT_VOLFULL                                                    \
+    RED_TRANSACT_VOLFULL                                                |   \
+    RED_TRANSACT_MASK_ASYNC                                                 \
 )
 
 #else /* REDCONF_API_FSE == 1 */
@@ -172,6 +172,101 @@
   #error "Configuration error: REDCONF_CHECKER must be defined."
 #endif
 
+/*  The following settings were added after version 2.0 of the configuration
+    utility.  Older redconf.h files do not define them, so default them to the
+    original behavior.
+*/
+#ifndef REDCONF_BUFFER_HASH
+  #define REDCONF_BUFFER_HASH 0
+#endif
+#ifndef REDCONF_BUFFER_LRU_LIST
+  #define REDCONF_BUFFER_LRU_LIST 0
+#endif
+#ifndef REDCONF_BUFFER_DATA_MAX
+  #define REDCONF_BUFFER_DATA_MAX 0U
+#endif
+#ifndef REDCONF_READ_AHEAD
+  #define REDCONF_READ_AHEAD 0U
+#endif
+#ifndef REDCONF_WRITE_COALESCE
+  #define REDCONF_WRITE_COALESCE 0U
+#endif
+#ifndef REDCONF_CRC_HOOK
+  #define REDCONF_CRC_HOOK 0
+#endif
+#ifndef REDCONF_IMAP_SUMMARY
+  #define REDCONF_IMAP_SUMMARY 0U
+#endif
+#ifndef REDCONF_DIR_CACHE
+  #define REDCONF_DIR_CACHE 0U
+#endif
+#ifndef REDCONF_INODE_CACHE
+  #define REDCONF_INODE_CACHE 0U
+#endif
+#ifndef REDCONF_DENTRY_CACHE
+  #define REDCONF_DENTRY_CACHE 0U
+#endif
+#ifndef REDCONF_READ_MAP
+  #define REDCONF_READ_MAP 0U
+#endif
+#ifndef REDCONF_MEM_WORDWISE
+  #define REDCONF_MEM_WORDWISE 0
+#endif
+#ifndef REDCONF_MEM_HOOK
+  #define REDCONF_MEM_HOOK 0
+#endif
+#ifndef REDCONF_TRANSACT_GROUP_MS
+  #define REDCONF_TRANSACT_GROUP_MS 0U
+#endif
+#ifndef REDCONF_TRANSACT_GROUP_BYTES
+  #define REDCONF_TRANSACT_GROUP_BYTES 0U
+#endif
+#ifndef REDCONF_TRANSACT_TASK
+  #define REDCONF_TRANSACT_TASK 0
+#endif
+#ifndef REDCONF_API_POSIX_COPYFILE
+  #define REDCONF_API_POSIX_COPYFILE 0
+#endif
+#ifndef REDCONF_API_POSIX_FALLOCATE
+  #define REDCONF_API_POSIX_FALLOCATE 0
+#endif
+#ifndef REDCONF_API_POSIX_VECTORIO
+  #define REDCONF_API_POSIX_VECTORIO 0
+#endif
+#ifndef REDCONF_API_POSIX_SCRUB
+  #define REDCONF_API_POSIX_SCRUB 0
+#endif
+#ifndef REDCONF_API_POSIX_SNAPSHOT
+  #define REDCONF_API_POSIX_SNAPSHOT 0
+#endif
+#ifndef REDCONF_STATS
+  #define REDCONF_STATS 0
+#endif
+#ifndef REDCONF_STATS_LATENCY
+  #define REDCONF_STATS_LATENCY 0
+#endif
+#ifndef REDCONF_TASK_LOCAL
+  #define REDCONF_TASK_LOCAL 0
+#endif
+#ifndef REDCONF_ALLOC_ERASE_AWARE
+  #define REDCONF_ALLOC_ERASE_AWARE 0
+#endif
+#ifndef REDCONF_DEFERRED_DELETE
+  #define REDCONF_DEFERRED_DELETE 0U
+#endif
+#ifndef REDCONF_FORMAT_QUICK
+  #define REDCONF_FORMAT_QUICK 0
+#endif
+#ifndef REDCONF_COMPRESSION
+  #define REDCONF_COMPRESSION 0
+#endif
+#ifndef REDCONF_COMPRESS_CLUSTER
+  #define REDCONF_COMPRESS_CLUSTER 4U
+#endif
+#ifndef REDCONF_RELATIME_DEFAULT
+  #define REDCONF_RELATIME_DEFAULT 0U
+#endif
+
 
 #if (REDCONF_READ_ONLY != 0) && (REDCONF_READ_ONLY != 1)
   #error "Configuration error: REDCONF_READ_ONLY must be either 0 or 1"
@@ -225,6 +320,26 @@
     #error "Configuration error: REDCONF_API_POSIX_READDIR must be either 0 or 1."
   #endif
 
+  #if (REDCONF_API_POSIX_COPYFILE != 0) && (REDCONF_API_POSIX_COPYFILE != 1)
+    #error "Configuration error: REDCONF_API_POSIX_COPYFILE must be either 0 or 1."
+  #endif
+
+  #if (REDCONF_API_POSIX_FALLOCATE != 0) && (REDCONF_API_POSIX_FALLOCATE != 1)
+    #error "Configuration error: REDCONF_API_POSIX_FALLOCATE must be either 0 or 1."
+  #endif
+
+  #if (REDCONF_API_POSIX_VECTORIO != 0) && (REDCONF_API_POSIX_VECTORIO != 1)
+    #error "Configuration error: REDCONF_API_POSIX_VECTORIO must be either 0 or 1."
+  #endif
+
+  #if (REDCONF_API_POSIX_SCRUB != 0) && (REDCONF_API_POSIX_SCRUB != 1)
+    #error "Configuration error: REDCONF_API_POSIX_SCRUB must be either 0 or 1."
+  #endif
+
+  #if (REDCONF_API_POSIX_SNAPSHOT != 0) && (REDCONF_API_POSIX_SNAPSHOT != 1)
+    #error "Configuration error: REDCONF_API_POSIX_SNAPSHOT must be either 0 or 1."
+  #endif
+
   #if (REDCONF_NAME_MAX < 1U) || (REDCONF_NAME_MAX > (REDCONF_BLOCK_SIZE - 4U))
     #error "Configuration error: invalid value of REDCONF_NAME_MAX"
   #endif
@@ -263,6 +378,10 @@
   #error "Configuration error: invalid value of REDCONF_TASK_COUNT"
 #endif
 
+#if (REDCONF_TASK_LOCAL != 0) && (REDCONF_TASK_LOCAL != 1)
+  #error "Configuration error: REDCONF_TASK_LOCAL must be either 0 or 1."
+#endif
+
 #if (REDCONF_ENDIAN_BIG != 0) && (REDCONF_ENDIAN_BIG != 1)
   #error "Configuration error: REDCONF_ENDIAN_BIG must be either 0 or 1."
 #endif
@@ -338,6 +457,95 @@
   #error "Configuration error: REDCONF_CHECKER must be either 0 or 1."
 #endif
 
+#if (REDCONF_BUFFER_HASH != 0) && (REDCONF_BUFFER_HASH != 1)
+  #error "Configuration error: REDCONF_BUFFER_HASH must be either 0 or 1."
+#endif
+
+#if (REDCONF_BUFFER_LRU_LIST != 0) && (REDCONF_BUFFER_LRU_LIST != 1)
+  #error "Configuration error: REDCONF_BUFFER_LRU_LIST must be either 0 or 1."
+#endif
+
+#if REDCONF_BUFFER_DATA_MAX > REDCONF_BUFFER_COUNT
+  #error "Configuration error: REDCONF_BUFFER_DATA_MAX cannot be greater than REDCONF_BUFFER_COUNT."
+#endif
+
+/*  Read-ahead only uses buffers which are free or hold clean file data, but a
+    window larger than half the buffers would leave too little room for the
+    metadata cache.
+*/
+#if REDCONF_READ_AHEAD > (REDCONF_BUFFER_COUNT / 2U)
+  #error "Configuration error: REDCONF_READ_AHEAD cannot be greater than half of REDCONF_BUFFER_COUNT."
+#endif
+
+#if REDCONF_WRITE_COALESCE > REDCONF_BUFFER_COUNT
+  #error "Configuration error: REDCONF_WRITE_COALESCE cannot be greater than REDCONF_BUFFER_COUNT."
+#endif
+
+#if (REDCONF_CRC_HOOK != 0) && (REDCONF_CRC_HOOK != 1)
+  #error "Configuration error: REDCONF_CRC_HOOK must be either 0 or 1."
+#endif
+
+#if (REDCONF_MEM_WORDWISE != 0) && (REDCONF_MEM_WORDWISE != 1)
+  #error "Configuration error: REDCONF_MEM_WORDWISE must be either 0 or 1."
+#endif
+
+#if (REDCONF_MEM_HOOK != 0) && (REDCONF_MEM_HOOK != 1)
+  #error "Configuration error: REDCONF_MEM_HOOK must be either 0 or 1."
+#endif
+
+#if (REDCONF_ALLOC_ERASE_AWARE != 0) && (REDCONF_ALLOC_ERASE_AWARE != 1)
+  #error "Configuration error: REDCONF_ALLOC_ERASE_AWARE must be either 0 or 1."
+#endif
+
+#if (REDCONF_DEFERRED_DELETE > 0U) && (REDCONF_API_POSIX == 0)
+  #error "Configuration error: REDCONF_DEFERRED_DELETE requires REDCONF_API_POSIX to be 1."
+#endif
+
+#if (REDCONF_FORMAT_QUICK != 0) && (REDCONF_FORMAT_QUICK != 1)
+  #error "Configuration error: REDCONF_FORMAT_QUICK must be either 0 or 1."
+#endif
+#if (REDCONF_FORMAT_QUICK == 1) && (REDCONF_IMAP_EXTERNAL == 0)
+  #error "Configuration error: REDCONF_FORMAT_QUICK requires REDCONF_IMAP_EXTERNAL to be 1."
+#endif
+
+#if (REDCONF_COMPRESSION != 0) && (REDCONF_COMPRESSION != 1)
+  #error "Configuration error: REDCONF_COMPRESSION must be either 0 or 1."
+#endif
+#if (REDCONF_COMPRESSION == 1) && (REDCONF_API_POSIX == 0)
+  #error "Configuration error: REDCONF_COMPRESSION requires REDCONF_API_POSIX to be 1."
+#endif
+/*  A compressed cluster must save at least one block, and the compressor
+    addresses a cluster with 16-bit offsets.
+*/
+#if (REDCONF_COMPRESSION == 1) && (    (REDCONF_COMPRESS_CLUSTER < 2U) \
+                                    || ((REDCONF_COMPRESS_CLUSTER & (REDCONF_COMPRESS_CLUSTER - 1U)) != 0U) \
+                                    || ((REDCONF_COMPRESS_CLUSTER * REDCONF_BLOCK_SIZE) > 65536U))
+  #error "Configuration error: REDCONF_COMPRESS_CLUSTER must be a power of two, at least 2, and at most 64 KB of blocks."
+#endif
+
+#if (REDCONF_TRANSACT_GROUP_BYTES > 0U) && (REDCONF_TRANSACT_GROUP_MS == 0U)
+  #error "Configuration error: REDCONF_TRANSACT_GROUP_BYTES requires REDCONF_TRANSACT_GROUP_MS to be nonzero."
+#endif
+
+#if (REDCONF_TRANSACT_TASK != 0) && (REDCONF_TRANSACT_TASK != 1)
+  #error "Configuration error: REDCONF_TRANSACT_TASK must be either 0 or 1."
+#endif
+#if (REDCONF_TRANSACT_TASK == 1) && ((REDCONF_API_POSIX == 0) || (REDCONF_TASK_COUNT < 2U))
+  #error "Configuration error: REDCONF_TRANSACT_TASK requires REDCONF_API_POSIX to be 1 and REDCONF_TASK_COUNT to be at least 2."
+#endif
+
+#if (REDCONF_STATS != 0) && (REDCONF_STATS != 1)
+  #error "Configuration error: REDCONF_STATS must be either 0 or 1."
+#endif
+
+#if (REDCONF_STATS_LATENCY != 0) && (REDCONF_STATS_LATENCY != 1)
+  #error "Configuration error: REDCONF_STATS_LATENCY must be either 0 or 1."
+#endif
+
+#if (REDCONF_STATS_LATENCY == 1) && (REDCONF_STATS == 0)
+  #error "Configuration error: REDCONF_STATS_LATENCY requires REDCONF_STATS."
+#endif
+
 
 #if (REDCONF_DISCARDS == 1) && (RED_KIT == RED_KIT_GPL)
   #error "REDCONF_DISCARDS not supported in Reliance Edge under GPL. Contact sales@datalight.com to upgrade."
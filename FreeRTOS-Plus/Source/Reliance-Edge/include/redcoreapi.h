@@ -46,10 +46,27 @@ REDSTATUS RedCoreVolMount(void);
 REDSTATUS RedCoreVolUnmount(void);
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedCoreVolTransact(void);
+REDSTATUS RedCoreVolRollback(void);
+#endif
+#if TRANSACT_TASK_SUPPORTED
+REDSTATUS RedCoreVolTransactAsync(void);
+REDSTATUS RedCoreVolTransactAsyncCommit(void);
 #endif
 #if REDCONF_API_POSIX == 1
 REDSTATUS RedCoreVolStat(REDSTATFS *pStatFS);
 #endif
+#if REDCONF_STATS == 1
+REDSTATUS RedCoreVolStats(REDIOSTATS *pStats);
+#endif
+#if SCRUB_SUPPORTED
+REDSTATUS RedCoreVolScrub(REDSCRUB *pScrub, uint32_t ulMaxMicrosecs);
+#endif
+#if DEFERRED_DELETE_SUPPORTED
+REDSTATUS RedCoreVolReclaim(uint32_t ulMaxBlocks, bool *pfMore);
+#endif
+#if SNAPSHOT_SUPPORTED
+REDSTATUS RedCoreVolSnapshot(bool fPin);
+#endif
 
 #if (REDCONF_READ_ONLY == 0) && ((REDCONF_API_POSIX == 1) || (REDCONF_API_FSE_TRANSMASKSET == 1))
 REDSTATUS RedCoreTransMaskSet(uint32_t ulEventMask);
@@ -57,6 +74,9 @@ REDSTATUS RedCoreTransMaskSet(uint32_t ulEventMask);
 #if (REDCONF_API_POSIX == 1) || (REDCONF_API_FSE_TRANSMASKGET == 1)
 REDSTATUS RedCoreTransMaskGet(uint32_t *pulEventMask);
 #endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_ATIME == 1)
+REDSTATUS RedCoreRelatimeSet(uint32_t ulMaxAge);
+#endif
 
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
 REDSTATUS RedCoreCreate(uint32_t ulPInode, const char *pszName, bool fDir, uint32_t *pulInode);
@@ -81,15 +101,42 @@ REDSTATUS RedCoreFileSizeGet(uint32_t ulInode, uint64_t *pullSize);
 #endif
 
 REDSTATUS RedCoreFileRead(uint32_t ulInode, uint64_t ullStart, uint32_t *pulLen, void *pBuffer);
+#if REDCONF_READ_MAP > 0U
+REDSTATUS RedCoreFileReadMap(uint32_t ulInode, uint64_t ullStart, uint32_t *pulLen, const void **ppBuffer);
+REDSTATUS RedCoreFileReadUnmap(const void *pBuffer);
+#endif
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedCoreFileWrite(uint32_t ulInode, uint64_t ullStart, uint32_t *pulLen, const void *pBuffer);
 #endif
+#if WRITEV_SUPPORTED
+REDSTATUS RedCoreFileWriteV(uint32_t ulInode, uint64_t ullStart, const REDIOVEC *paIov, uint32_t ulIovCount, uint32_t *pulLen);
+#endif
+#if COPYFILE_SUPPORTED
+REDSTATUS RedCoreFileCopy(uint32_t ulSrcInode, uint64_t ullSrcStart, uint32_t ulDstInode, uint64_t ullDstStart, uint32_t *pulLen);
+#endif
 #if TRUNCATE_SUPPORTED
 REDSTATUS RedCoreFileTruncate(uint32_t ulInode, uint64_t ullSize);
 #endif
+#if FALLOCATE_SUPPORTED
+REDSTATUS RedCoreFileAllocate(uint32_t ulInode, uint64_t ullStart, uint64_t ullLen);
+#endif
+#if (REDCONF_READ_ONLY == 0) && COMPRESSION_SUPPORTED
+REDSTATUS RedCoreFileCompress(uint32_t ulInode);
+#endif
 
 #if (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_READDIR == 1)
 REDSTATUS RedCoreDirRead(uint32_t ulInode, uint32_t *pulPos, char *pszName, uint32_t *pulInode);
+REDSTATUS RedCoreDirReadBatch(uint32_t ulInode, uint32_t *pulPos, REDDIRENT *paDirEnt, uint32_t ulMax, bool fStat, uint32_t *pulCount);
+#endif
+
+#if SNAPSHOT_SUPPORTED
+REDSTATUS RedCoreSnapLookup(uint32_t ulPInode, const char *pszName, uint32_t *pulInode);
+REDSTATUS RedCoreSnapStat(uint32_t ulInode, REDSTAT *pStat);
+REDSTATUS RedCoreSnapFileRead(uint32_t ulInode, uint64_t ullStart, uint32_t *pulLen, void *pBuffer);
+#if REDCONF_API_POSIX_READDIR == 1
+REDSTATUS RedCoreSnapDirRead(uint32_t ulInode, uint32_t *pulPos, char *pszName, uint32_t *pulInode);
+REDSTATUS RedCoreSnapDirReadBatch(uint32_t ulInode, uint32_t *pulPos, REDDIRENT *paDirEnt, uint32_t ulMax, bool fStat, uint32_t *pulCount);
+#endif
 #endif
 
 
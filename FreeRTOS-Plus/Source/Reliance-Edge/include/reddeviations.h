@@ -119,6 +119,18 @@
 #define CAST_CONST_UINT32_PTR(PTR) ((const uint32_t *)(const void *)(PTR))
 
 
+/** @brief Cast a pointer to a uint32_t pointer.
+
+    Usages of this macro may deviate from MISRA C:2012 Rule 11.5 (advisory) and
+    Rule 11.3 (required), for the same reasons as CAST_CONST_UINT32_PTR().  It
+    is only used by the word-wide memory functions, on pointers which have been
+    checked to be aligned.
+
+    As Rule 11.3 is required, a separate deviation record is required.
+*/
+#define CAST_UINT32_PTR(PTR) ((uint32_t *)(void *)(PTR))
+
+
 /** @brief Cast a pointer to a pointer to (void **).
 
     Usages of this macro deviate from MISRA C:2012 Rule 11.3 (required).
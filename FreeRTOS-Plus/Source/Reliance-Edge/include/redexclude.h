@@ -42,6 +42,52 @@
     && (    ((REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_FTRUNCATE == 1)) \
          || ((REDCONF_API_FSE == 1) && (REDCONF_API_FSE_TRUNCATE == 1))))
 
+#define COPYFILE_SUPPORTED \
+  ( \
+       (REDCONF_READ_ONLY == 0) \
+    && (REDCONF_API_POSIX == 1) \
+    && (REDCONF_API_POSIX_COPYFILE == 1))
+
+#define FALLOCATE_SUPPORTED \
+  ( \
+       (REDCONF_READ_ONLY == 0) \
+    && (REDCONF_API_POSIX == 1) \
+    && (REDCONF_API_POSIX_FALLOCATE == 1))
+
+#define WRITEV_SUPPORTED \
+  ( \
+       (REDCONF_READ_ONLY == 0) \
+    && (REDCONF_API_POSIX == 1) \
+    && (REDCONF_API_POSIX_VECTORIO == 1))
+
+#define SCRUB_SUPPORTED \
+  ( \
+       (REDCONF_API_POSIX == 1) \
+    && (REDCONF_API_POSIX_SCRUB == 1))
+
+#define SNAPSHOT_SUPPORTED \
+  ( \
+       (REDCONF_READ_ONLY == 0) \
+    && (REDCONF_API_POSIX == 1) \
+    && (REDCONF_API_POSIX_SNAPSHOT == 1))
+
+#define DEFERRED_DELETE_SUPPORTED \
+  ( \
+       (REDCONF_READ_ONLY == 0) \
+    && (REDCONF_API_POSIX == 1) \
+    && (REDCONF_DEFERRED_DELETE > 0U))
+
+#define COMPRESSION_SUPPORTED \
+  ( \
+       (REDCONF_API_POSIX == 1) \
+    && (REDCONF_COMPRESSION == 1))
+
+#define TRANSACT_TASK_SUPPORTED \
+  ( \
+       (REDCONF_READ_ONLY == 0) \
+    && (REDCONF_API_POSIX == 1) \
+    && (REDCONF_TRANSACT_TASK == 1))
+
 #define FORMAT_SUPPORTED \
     ( \
          (REDCONF_READ_ONLY == 0) \
@@ -69,6 +69,19 @@ extern "C" {
 #define RED_FILENUM_FIRST_VALID (2U)
 
 
+#if REDCONF_READ_ONLY == 0
+/** @brief One write in a batch given to RedFseWriteBatch().
+*/
+typedef struct
+{
+    uint32_t    ulFileNum;      /**< The file number of the file to write. */
+    uint64_t    ullFileOffset;  /**< The file offset to write at. */
+    uint32_t    ulLength;       /**< The number of bytes to write. */
+    const void *pBuffer;        /**< The data to write; at least ulLength bytes. */
+} REDFSEWRITE;
+#endif
+
+
 REDSTATUS RedFseInit(void);
 REDSTATUS RedFseUninit(void);
 REDSTATUS RedFseMount(uint8_t bVolNum);
@@ -79,6 +92,7 @@ REDSTATUS RedFseFormat(uint8_t bVolNum);
 int32_t RedFseRead(uint8_t bVolNum, uint32_t ulFileNum, uint64_t ullFileOffset, uint32_t ulLength, void *pBuffer);
 #if REDCONF_READ_ONLY == 0
 int32_t RedFseWrite(uint8_t bVolNum, uint32_t ulFileNum, uint64_t ullFileOffset, uint32_t ulLength, const void *pBuffer);
+REDSTATUS RedFseWriteBatch(uint8_t bVolNum, const REDFSEWRITE *paWrite, uint32_t ulCount);
 #endif
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_FSE_TRUNCATE == 1)
 REDSTATUS RedFseTruncate(uint8_t bVolNum, uint32_t ulFileNum, uint64_t ullNewFileSize);
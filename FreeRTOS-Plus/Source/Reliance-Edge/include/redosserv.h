@@ -40,8 +40,32 @@ typedef enum
     BDEV_O_RDWR     /**< Open block device for read and write access. */
 } BDEVOPENMODE;
 
+/** @brief Geometry of a block device, which the core uses to shape its I/O
+           requests.
+*/
+typedef struct
+{
+    /** The largest number of sectors that can be transferred by a single
+        read or write request, or zero if there is no limit.
+    */
+    uint32_t    ulMaxTransfer;
+
+    /** The number of sectors in an erase block, or zero if the media has no
+        erase blocks (or they are unknown).  Writes which span an erase block
+        boundary are split at the boundary.
+    */
+    uint32_t    ulEraseSectors;
+
+    /** If the whole block device is mapped into the address space and can be
+        read through the mapping, the address of its first sector; otherwise
+        `NULL`.
+    */
+    const void *pMapping;
+} BDEVGEOMETRY;
+
 REDSTATUS RedOsBDevOpen(uint8_t bVolNum, BDEVOPENMODE mode);
 REDSTATUS RedOsBDevClose(uint8_t bVolNum);
+REDSTATUS RedOsBDevGetGeometry(uint8_t bVolNum, BDEVGEOMETRY *pGeometry);
 REDSTATUS RedOsBDevRead(uint8_t bVolNum, uint64_t ullSectorStart, uint32_t ulSectorCount, void *pBuffer);
 
 #if REDCONF_READ_ONLY == 0
@@ -62,6 +86,15 @@ void RedOsMutexRelease(void);
 #endif
 #if (REDCONF_TASK_COUNT > 1U) && (REDCONF_API_POSIX == 1)
 uint32_t RedOsTaskId(void);
+#if REDCONF_TASK_LOCAL == 1
+void *RedOsTaskLocalGet(void);
+void RedOsTaskLocalSet(void *pValue);
+#endif
+#endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1) && (REDCONF_TRANSACT_TASK == 1)
+REDSTATUS RedOsWorkerStart(void (*pfnWork)(void));
+void RedOsWorkerSignal(void);
+void RedOsWorkerStop(void);
 #endif
 
 REDSTATUS RedOsClockInit(void);
@@ -31,6 +31,9 @@
 
 REDSTATUS RedPathSplit(const char *pszPath, uint8_t *pbVolNum, const char **ppszLocalPath);
 REDSTATUS RedPathLookup(const char *pszLocalPath, uint32_t *pulInode);
+#if SNAPSHOT_SUPPORTED
+REDSTATUS RedPathSnapLookup(const char *pszLocalPath, uint32_t *pulInode);
+#endif
 REDSTATUS RedPathToName(const char *pszLocalPath, uint32_t *pulPInode, const char **ppszName);
 
 
@@ -73,6 +73,16 @@ extern "C" {
 /** Truncate file to size zero. */
 #define RED_O_TRUNC     0x00000040U
 
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_SNAPSHOT == 1)
+/** Open in the snapshot pinned by red_snapshot(); use with #RED_O_RDONLY. */
+#define RED_O_SNAPSHOT  0x00000080U
+#endif
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_COMPRESSION == 1)
+/** Compress data subsequently written to the file; see #RED_S_ICOMPR. */
+#define RED_O_COMPRESS  0x00000100U
+#endif
+
 
 /** @brief Last file system error (errno).
 
@@ -120,16 +130,17 @@ typedef enum
 /** @brief Opaque directory handle.
 */
 typedef struct sREDHANDLE REDDIR;
+#endif
 
 
-/** @brief Directory entry information.
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_TRANSACT_TASK == 1)
+/** @brief Completion notification for red_transact_async().
+
+    @param iErrno   Zero if the transaction point was committed; otherwise, the
+                    #red_errno value describing why it was not.
+    @param pContext The context pointer given to red_transact_async().
 */
-typedef struct
-{
-    uint32_t    d_ino;  /**< File serial number (inode number). */
-    char        d_name[REDCONF_NAME_MAX+1U];    /**< Name of entry. */
-    REDSTAT     d_stat; /**< File information (POSIX extension). */
-} REDDIRENT;
+typedef void (*REDTRANSACTCB)(int32_t iErrno, void *pContext);
 #endif
 
 
@@ -143,11 +154,30 @@ int32_t red_format(const char *pszVolume);
 #if REDCONF_READ_ONLY == 0
 int32_t red_transact(const char *pszVolume);
 #endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_TRANSACT_TASK == 1)
+int32_t red_transact_async(const char *pszVolume, REDTRANSACTCB pfnDone, void *pContext);
+#endif
 #if REDCONF_READ_ONLY == 0
 int32_t red_settransmask(const char *pszVolume, uint32_t ulEventMask);
 #endif
 int32_t red_gettransmask(const char *pszVolume, uint32_t *pulEventMask);
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_ATIME == 1)
+int32_t red_setrelatime(const char *pszVolume, uint32_t ulMaxAge);
+#endif
 int32_t red_statvfs(const char *pszVolume, REDSTATFS *pStatvfs);
+#if REDCONF_STATS == 1
+int32_t red_getstats(const char *pszVolume, REDIOSTATS *pStats);
+#endif
+#if REDCONF_API_POSIX_SCRUB == 1
+int32_t red_scrub(const char *pszVolume, REDSCRUB *pScrub, uint32_t ulMaxMicrosecs);
+#endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_DEFERRED_DELETE > 0U)
+int32_t red_reclaim(const char *pszVolume, uint32_t ulMaxBlocks);
+#endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_SNAPSHOT == 1)
+int32_t red_snapshot(const char *pszVolume);
+int32_t red_snapshot_release(const char *pszVolume);
+#endif
 int32_t red_open(const char *pszPath, uint32_t ulOpenMode);
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_UNLINK == 1)
 int32_t red_unlink(const char *pszPath);
@@ -166,9 +196,22 @@ int32_t red_link(const char *pszPath, const char *pszHardLink);
 #endif
 int32_t red_close(int32_t iFildes);
 int32_t red_read(int32_t iFildes, void *pBuffer, uint32_t ulLength);
+#if REDCONF_READ_MAP > 0U
+int32_t red_read_map(int32_t iFildes, uint32_t ulLength, const void **ppBuffer);
+int32_t red_read_unmap(const void *pBuffer);
+#endif
 #if REDCONF_READ_ONLY == 0
 int32_t red_write(int32_t iFildes, const void *pBuffer, uint32_t ulLength);
 #endif
+#if REDCONF_API_POSIX_VECTORIO == 1
+int32_t red_readv(int32_t iFildes, const REDIOVEC *paIov, uint32_t ulIovCount);
+#endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_VECTORIO == 1)
+int32_t red_writev(int32_t iFildes, const REDIOVEC *paIov, uint32_t ulIovCount);
+#endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_COPYFILE == 1)
+int32_t red_copyfile(int32_t iSrcFildes, int32_t iDstFildes, uint32_t ulLength);
+#endif
 #if REDCONF_READ_ONLY == 0
 int32_t red_fsync(int32_t iFildes);
 #endif
@@ -176,12 +219,19 @@ int64_t red_lseek(int32_t iFildes, int64_t llOffset, REDWHENCE whence);
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_FTRUNCATE == 1)
 int32_t red_ftruncate(int32_t iFildes, uint64_t ullSize);
 #endif
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_FALLOCATE == 1)
+int32_t red_fallocate(int32_t iFildes, uint64_t ullOffset, uint64_t ullLen);
+#endif
 int32_t red_fstat(int32_t iFildes, REDSTAT *pStat);
 #if REDCONF_API_POSIX_READDIR == 1
 REDDIR *red_opendir(const char *pszPath);
 REDDIRENT *red_readdir(REDDIR *pDirStream);
+int32_t red_readdir_batch(REDDIR *pDirStream, REDDIRENT *paDirEnt, uint32_t ulCount, bool fStat);
 void red_rewinddir(REDDIR *pDirStream);
 int32_t red_closedir(REDDIR *pDirStream);
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_SNAPSHOT == 1)
+REDDIR *red_snapshot_opendir(const char *pszPath);
+#endif
 #endif
 REDSTATUS *red_errnoptr(void);
 
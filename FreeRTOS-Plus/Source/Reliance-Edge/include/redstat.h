@@ -34,6 +34,11 @@
 /** Mode bit for a regular file. */
 #define RED_S_IFREG  0x8000U
 
+/** Mode bit for a regular file whose data is stored compressed; see
+    #RED_O_COMPRESS.
+*/
+#define RED_S_ICOMPR 0x1000U
+
 /** @brief Test for a directory.
 */
 #define RED_S_ISDIR(m)  (((m) & RED_S_IFDIR) != 0U)
@@ -90,5 +95,85 @@ typedef struct
 } REDSTATFS;
 
 
+#if (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_READDIR == 1)
+/** @brief Directory entry information, as returned by red_readdir() and
+           red_readdir_batch().
+*/
+typedef struct
+{
+    uint32_t    d_ino;  /**< File serial number (inode number). */
+    char        d_name[REDCONF_NAME_MAX+1U];    /**< Name of entry. */
+    REDSTAT     d_stat; /**< File information (POSIX extension). */
+} REDDIRENT;
+#endif
+
+
+#if (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_VECTORIO == 1)
+/** @brief One segment of a scatter-gather list for red_readv() and
+           red_writev().
+*/
+typedef struct
+{
+    void       *iov_base;   /**< Start of the segment buffer. */
+    uint32_t    iov_len;    /**< Size of the segment buffer, in bytes. */
+} REDIOVEC;
+#endif
+
+
+#if REDCONF_STATS == 1
+/** The number of buckets in each latency histogram of ::REDIOSTATS. */
+#define RED_STATS_LATENCY_BUCKETS 20U
+
+/** @brief I/O statistics for a file system volume.
+
+    The counters accumulate from the time the driver is initialized; to measure
+    a workload, take the difference between two snapshots.
+*/
+typedef struct
+{
+    uint64_t    ullBufferGets;      /**< Number of block buffer requests. */
+    uint64_t    ullBufferHits;      /**< Number of block buffer requests for blocks which were already buffered. */
+    uint64_t    ullBufferWrites;    /**< Number of dirty block buffers written. */
+    uint64_t    ullDevReads;        /**< Number of block device read requests. */
+    uint64_t    ullDevReadBlocks;   /**< Number of blocks read from the block device. */
+    uint64_t    ullDevWrites;       /**< Number of block device write requests. */
+    uint64_t    ullDevWriteBlocks;  /**< Number of blocks written to the block device. */
+    uint64_t    ullDevFlushes;      /**< Number of block device flush requests. */
+    uint64_t    ullTransactions;    /**< Number of transaction points committed. */
+  #if REDCONF_STATS_LATENCY == 1
+    /*  Latency histograms, timed with RedOsTimestamp().  Bucket 0 counts the
+        requests which took less than one microsecond; bucket n counts those
+        which took at least 2^(n-1) and less than 2^n microseconds; the last
+        bucket also counts everything slower.
+    */
+    uint32_t    aulDevReadLatency[RED_STATS_LATENCY_BUCKETS];   /**< Block device read latency histogram. */
+    uint32_t    aulDevWriteLatency[RED_STATS_LATENCY_BUCKETS];  /**< Block device write latency histogram. */
+    uint32_t    aulDevFlushLatency[RED_STATS_LATENCY_BUCKETS];  /**< Block device flush latency histogram. */
+    uint32_t    aulTransactLatency[RED_STATS_LATENCY_BUCKETS];  /**< Transaction point latency histogram. */
+  #endif
+} REDIOSTATS;
+#endif
+
+
+#if (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_SCRUB == 1)
+/** @brief Progress of a volume scrub, carried from one red_scrub() call to the
+           next.
+
+    Zero-initialize the structure to start scrubbing from the beginning of the
+    volume.  The position fields are managed by red_scrub() and should not be
+    modified by the caller.
+*/
+typedef struct
+{
+    uint32_t    ulImapNode;     /**< Next imap node to verify. */
+    uint32_t    ulInode;        /**< Next inode to verify; zero while the imap is being verified. */
+    uint32_t    ulBlock;        /**< Next block offset to verify within ulInode. */
+    uint32_t    ulPasses;       /**< Number of complete passes over the volume. */
+    uint32_t    ulErrors;       /**< Number of inconsistencies found. */
+    uint32_t    ulErrorInode;   /**< The inode in which the most recent inconsistency was found. */
+} REDSCRUB;
+#endif
+
+
 #endif
 
@@ -45,6 +45,11 @@
       && (REDCONF_API_POSIX_RMDIR == 1) && (REDCONF_API_POSIX_RENAME == 1) && (REDCONF_API_POSIX_LINK == 1) \
       && (REDCONF_API_POSIX_FTRUNCATE == 1) && (REDCONF_API_POSIX_READDIR == 1))
 
+#define FSBENCH_SUPPORTED  \
+    (    ((RED_KIT == RED_KIT_GPL) || (RED_KIT == RED_KIT_SANDBOX)) \
+      && (REDCONF_OUTPUT == 1) && (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1) \
+      && (REDCONF_API_POSIX_UNLINK == 1) && (REDCONF_API_POSIX_MKDIR == 1) && (REDCONF_API_POSIX_RMDIR == 1))
+
 #define FSE_STRESS_TEST_SUPPORTED \
     (    ((RED_KIT == RED_KIT_COMMERCIAL) || (RED_KIT == RED_KIT_SANDBOX)) \
       && (REDCONF_OUTPUT == 1) && (REDCONF_READ_ONLY == 0) && (REDCONF_API_FSE == 1) \
@@ -106,6 +111,29 @@ void FsstressDefaultParams(FSSTRESSPARAM *pParam);
 int FsstressStart(const FSSTRESSPARAM *pParam);
 #endif
 
+#if FSBENCH_SUPPORTED
+typedef struct
+{
+    const char *pszVolume;          /**< Volume path prefix. */
+    const char *pszDir;             /**< --dir */
+    bool        fSequential;        /**< --tests=s */
+    bool        fRandom;            /**< --tests=r */
+    bool        fSmallFiles;        /**< --tests=f */
+    bool        fTransact;          /**< --tests=t */
+    uint32_t    ulFileSize;         /**< --size */
+    uint32_t    ulIOSize;           /**< --io-size */
+    uint32_t    ulRandOps;          /**< --rand-ops */
+    uint32_t    ulFiles;            /**< --files */
+    uint32_t    ulSmallFileSize;    /**< --file-size */
+    uint32_t    ulTransacts;        /**< --transacts */
+    uint64_t    ullSeed;            /**< --seed */
+} FSBENCHPARAM;
+
+PARAMSTATUS FsbenchParseParams(int argc, char *argv[], FSBENCHPARAM *pParam, uint8_t *pbVolNum, const char **ppszDevice);
+void FsbenchDefaultParams(FSBENCHPARAM *pParam);
+int FsbenchStart(const FSBENCHPARAM *pParam);
+#endif
+
 #if STOCH_POSIX_TEST_SUPPORTED
 typedef struct
 {
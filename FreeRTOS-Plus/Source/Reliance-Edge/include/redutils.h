@@ -41,6 +41,15 @@ void RedMemCpy(void *pDest, const void *pSrc, uint32_t ulLen);
 void RedMemMove(void *pDest, const void *pSrc, uint32_t ulLen);
 void RedMemSet(void *pDest, uint8_t bVal, uint32_t ulLen);
 int32_t RedMemCmp(const void *pMem1, const void *pMem2, uint32_t ulLen);
+#if REDCONF_MEM_HOOK == 1
+/** @brief Signature of a memory copy engine registered with RedMemCpySetHook().
+
+    Returns true if the copy was done; false to have it done in software.
+*/
+typedef bool (*REDMEMCPYHOOK)(void *pDest, const void *pSrc, uint32_t ulLen);
+
+void RedMemCpySetHook(REDMEMCPYHOOK pfnHook);
+#endif
 
 uint32_t RedStrLen(const char *pszStr);
 int32_t RedStrCmp(const char *pszStr1, const char *pszStr2);
@@ -49,11 +58,23 @@ void RedStrNCpy(char *pszDst, const char *pszSrc, uint32_t ulLen);
 
 uint32_t RedCrc32Update(uint32_t ulInitCrc32, const void *pBuffer, uint32_t ulLength);
 uint32_t RedCrcNode(const void *pBuffer);
+#if REDCONF_CRC_HOOK == 1
+/** @brief Signature of a CRC32 implementation registered with RedCrc32SetHook().
+*/
+typedef uint32_t (*REDCRC32HOOK)(uint32_t ulInitCrc32, const void *pBuffer, uint32_t ulLength);
+
+void RedCrc32SetHook(REDCRC32HOOK pfnHook);
+#endif
 
 #if REDCONF_API_POSIX == 1
 uint32_t RedNameLen(const char *pszName);
 #endif
 
+#if REDCONF_COMPRESSION == 1
+uint32_t RedLzCompress(const uint8_t *pbSrc, uint32_t ulSrcLen, uint8_t *pbDst, uint32_t ulDstMax);
+bool RedLzDecompress(const uint8_t *pbSrc, uint32_t ulSrcLen, uint8_t *pbDst, uint32_t ulDstLen);
+#endif
+
 bool RedBitGet(const uint8_t *pbBitmap, uint32_t ulBit);
 void RedBitSet(uint8_t *pbBitmap, uint32_t ulBit);
 void RedBitClear(uint8_t *pbBitmap, uint32_t ulBit);
@@ -96,6 +96,14 @@ typedef struct
     /** The active automatic transaction mask.
     */
     uint32_t    ulTransMask;
+
+  #if REDCONF_ATIME == 1
+    /** Zero for strict access time updates.  Otherwise, reads update the
+        access time only if it is not newer than the modification or change
+        time, or is at least this many seconds old.
+    */
+    uint32_t    ulRelatimeAge;
+  #endif
   #endif
 
     /** The power of 2 difference between sector size and block size.
@@ -0,0 +1,80 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                   Copyright (c) 2014-2015 Datalight, Inc.
+                       All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license may obtain a commercial license
+    before incorporating Reliance Edge into proprietary software for
+    distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+    more information.
+*/
+/** @file
+    @brief Asynchronous block device interface for the FreeRTOS port.
+
+    This is an extension to the block device service which is specific to the
+    FreeRTOS port.  When BDEV_ASYNC_QUEUE_DEPTH in osbdev.c is non-zero, block
+    device requests are serviced by a dedicated I/O task.  Requests may be
+    submitted without waiting for them to finish, and the submitting task is
+    told about completion via a direct-to-task notification at the last
+    notification index, so configTASK_NOTIFICATION_ARRAY_ENTRIES must be at
+    least 2 and that index must not be used otherwise.  Several requests
+    may be in flight at once; they are scheduled by the priority of the
+    submitting task, as described in osbdev.c.  RedOsBDevFlush() is queued
+    too, and is carried out after every request for the volume submitted
+    before it, and before any submitted after it.
+*/
+#ifndef REDOSBDEVASYNC_H
+#define REDOSBDEVASYNC_H
+
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+
+/** @brief An asynchronous block device request.
+
+    The caller owns the memory for the request, which must remain valid until
+    RedOsBDevAsyncWait() has returned for it.  The members are managed by the
+    block device service and should not be accessed directly.
+*/
+typedef struct sREDBDEVREQ
+{
+    uint8_t             bVolNum;        /**< Volume whose block device is accessed. */
+    bool                fWrite;         /**< Whether this is a write (true) or read (false). */
+    bool                fFlush;         /**< Whether this is a flush, in which case fWrite is false and there is no transfer. */
+    uint64_t            ullSectorStart; /**< The starting sector number. */
+    uint32_t            ulSectorCount;  /**< The number of sectors to transfer. */
+    void               *pBuffer;        /**< The buffer to transfer to or from. */
+    TaskHandle_t        xTask;          /**< The task to notify on completion. */
+    UBaseType_t         uxPriority;     /**< Priority of the submitting task when submitted. */
+    TickType_t          xSubmitted;     /**< Tick count when submitted. */
+    struct sREDBDEVREQ *pNext;          /**< Next request in the I/O task's pending list. */
+    volatile REDSTATUS  ret;            /**< Result of the request, valid once fDone is set. */
+    volatile bool       fDone;          /**< Set by the I/O task when the request is complete. */
+} REDBDEVREQ;
+
+
+REDSTATUS RedOsBDevReadAsync(REDBDEVREQ *pReq, uint8_t bVolNum, uint64_t ullSectorStart, uint32_t ulSectorCount, void *pBuffer);
+#if REDCONF_READ_ONLY == 0
+REDSTATUS RedOsBDevWriteAsync(REDBDEVREQ *pReq, uint8_t bVolNum, uint64_t ullSectorStart, uint32_t ulSectorCount, const void *pBuffer);
+#endif
+bool RedOsBDevAsyncIsDone(const REDBDEVREQ *pReq);
+REDSTATUS RedOsBDevAsyncWait(REDBDEVREQ *pReq);
+
+
+#endif
+
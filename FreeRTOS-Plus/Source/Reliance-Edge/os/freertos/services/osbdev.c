@@ -26,10 +26,13 @@
     @brief Implements block device I/O.
 */
 #include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
 
 #include <redfs.h>
 #include <redvolume.h>
 #include <redosdeviations.h>
+#include <redosbdevasync.h>
 
 
 /*------------------------------------------------------------------------------
@@ -102,6 +105,22 @@
 */
 #define BDEV_RAM_DISK       (4U)
 
+/** @brief The memory-mapped example implementation.
+
+    This implementation is for storage which is mapped into the address space,
+    such as QSPI NOR flash in memory-mapped (execute-in-place) mode.  Reads are
+    copied out of the mapping, and the mapping is reported to the core: when
+    #REDCONF_READ_ONLY is enabled, red_read_map() returns pointers straight
+    into the mapping, without copying the data or using a block buffer.
+
+    The storage is assumed to be read-only, like NOR flash, which cannot be
+    programmed through its mapping.  The volume image must be written by other
+    means, and the block device cannot be opened for writing.  To update the
+    volume in place, DiskWrite() and DiskFlush() must be extended to program
+    the flash through its controller.
+*/
+#define BDEV_MEMORY_MAPPED  (5U)
+
 /** @brief Pick which example implementation is compiled.
 
     Must be one of:
@@ -110,17 +129,121 @@
     - #BDEV_ATMEL_SDMMC
     - #BDEV_STM32_SDIO
     - #BDEV_RAM_DISK
+    - #BDEV_MEMORY_MAPPED
 */
 #define BDEV_EXAMPLE_IMPLEMENTATION BDEV_RAM_DISK
 
 
+/** @brief Maximum number of asynchronous requests which may be queued.
+
+    When this is non-zero, block device reads and writes are serviced by a
+    dedicated I/O task, and the asynchronous interface in redosbdevasync.h may
+    be used to submit requests without waiting for them to complete.  The
+    synchronous RedOsBDevRead(), RedOsBDevWrite() and RedOsBDevFlush()
+    functions are routed through the same queue, so that the driver only ever
+    transfers or flushes data from one task.  RedOsBDevOpen(),
+    RedOsBDevClose() and RedOsBDevGetGeometry() still call the driver from the
+    calling task, so they must not be called while requests for the same
+    volume are in flight.
+
+    When this is zero, the asynchronous interface is still available, but
+    requests are carried out synchronously by the submitting task.
+
+    Rather than servicing requests in arrival order, the I/O task schedules
+    the requests which are pending when the driver becomes idle:
+
+    - The request whose submitting task had the highest priority goes first,
+      so a small read by a control task is not stuck behind a large background
+      transfer.  Requests of equal priority go in the order submitted.
+    - A request which has waited #BDEV_ASYNC_DEADLINE_TICKS or longer goes
+      ahead of any request which has not, so low priority I/O is delayed but
+      never starved.
+    - Pending requests which continue the chosen request, both on the disk and
+      in memory, are merged with it into one driver call.
+    - Requests never overtake an earlier request for overlapping sectors of
+      the same volume unless both are reads, so a read always sees the data of
+      a write submitted before it.
+    - A flush is a barrier for its volume: it never overtakes an earlier
+      request for the volume, and no later request for the volume overtakes
+      it, so it commits exactly the writes submitted before it.
+
+    The priority of the submitting task is sampled with uxTaskPriorityGet(),
+    so INCLUDE_uxTaskPriorityGet must be enabled in FreeRTOSConfig.h.
+
+    This scheduling only helps code which calls the asynchronous interface
+    directly.  The file system itself holds the global file system mutex
+    across each request and calls RedOsBDevRead(), RedOsBDevWrite() and
+    RedOsBDevFlush(), which wait for their request, so it never has more
+    than one request pending.  File system I/O by a high priority task
+    therefore still waits for the file system I/O of any other task to
+    finish, on every volume, and nothing in Reliance Edge itself submits
+    asynchronous requests.
+*/
+#define BDEV_ASYNC_QUEUE_DEPTH      0U
+
+#if BDEV_ASYNC_QUEUE_DEPTH > 0U
+/** @brief Priority of the block device I/O task.
+*/
+#define BDEV_ASYNC_TASK_PRIORITY    (configMAX_PRIORITIES - 1U)
+
+/** @brief Stack depth, in words, of the block device I/O task.
+*/
+#define BDEV_ASYNC_TASK_STACK       (configMINIMAL_STACK_SIZE * 2U)
+
+/** @brief Index of the task notification used to report request completion.
+
+    The last index is used, so the default index stays free for the
+    application.  It must not be used for anything else by a task which
+    submits requests.
+*/
+#define BDEV_ASYNC_NOTIFY_INDEX     (configTASK_NOTIFICATION_ARRAY_ENTRIES - 1U)
+
+/** @brief How long, in ticks, a request may wait before it is serviced ahead
+           of higher priority requests.
+*/
+#define BDEV_ASYNC_DEADLINE_TICKS   pdMS_TO_TICKS(100U)
+
+/** @brief Most sectors to transfer with one merged driver call; zero disables
+           merging.
+
+    Must not exceed the maximum transfer reported by DiskGetGeometry(), if it
+    reports one.
+*/
+#define BDEV_ASYNC_MERGE_SECTORS    128U
+
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES < 2
+  #error "configTASK_NOTIFICATION_ARRAY_ENTRIES must be at least 2 when BDEV_ASYNC_QUEUE_DEPTH is non-zero"
+#endif
+#endif
+
+
 static REDSTATUS DiskOpen(uint8_t bVolNum, BDEVOPENMODE mode);
 static REDSTATUS DiskClose(uint8_t bVolNum);
+static REDSTATUS DiskGetGeometry(uint8_t bVolNum, BDEVGEOMETRY *pGeometry);
 static REDSTATUS DiskRead(uint8_t bVolNum, uint64_t ullSectorStart, uint32_t ulSectorCount, void *pBuffer);
 #if REDCONF_READ_ONLY == 0
 static REDSTATUS DiskWrite(uint8_t bVolNum, uint64_t ullSectorStart, uint32_t ulSectorCount, const void *pBuffer);
 static REDSTATUS DiskFlush(uint8_t bVolNum);
 #endif
+static REDSTATUS AsyncSubmit(REDBDEVREQ *pReq);
+#if BDEV_ASYNC_QUEUE_DEPTH > 0U
+static REDSTATUS AsyncInit(void);
+static void AsyncTask(void *pParam);
+static REDBDEVREQ *AsyncSchedule(REDBDEVREQ **ppPending);
+static bool AsyncMayOvertake(const REDBDEVREQ *pPending, const REDBDEVREQ *pReq);
+static REDBDEVREQ *AsyncMerge(REDBDEVREQ **ppPending, REDBDEVREQ *pReq, uint32_t *pulSectorCount);
+static bool AsyncContinues(const REDBDEVREQ *pFirst, const REDBDEVREQ *pSecond);
+
+
+static QueueHandle_t gxAsyncQueue;
+static TaskHandle_t gxAsyncTask;
+#if defined(configSUPPORT_STATIC_ALLOCATION) && (configSUPPORT_STATIC_ALLOCATION == 1)
+static StaticQueue_t gxAsyncQueueBuffer;
+static uint8_t gabAsyncQueueStorage[BDEV_ASYNC_QUEUE_DEPTH * sizeof(REDBDEVREQ *)];
+static StaticTask_t gxAsyncTaskBuffer;
+static StackType_t gaxAsyncTaskStack[BDEV_ASYNC_TASK_STACK];
+#endif
+#endif
 
 
 /** @brief Initialize a block device.
@@ -156,7 +279,14 @@ REDSTATUS RedOsBDevOpen(
     }
     else
     {
-        ret = DiskOpen(bVolNum, mode);
+      #if BDEV_ASYNC_QUEUE_DEPTH > 0U
+        ret = AsyncInit();
+
+        if(ret == 0)
+      #endif
+        {
+            ret = DiskOpen(bVolNum, mode);
+        }
     }
 
     return ret;
@@ -201,6 +331,45 @@ REDSTATUS RedOsBDevClose(
 }
 
 
+/** @brief Retrieve the geometry of a block device.
+
+    The core uses the geometry to size its requests: it will not issue a read
+    or write larger than the maximum transfer size, nor a write which spans an
+    erase block boundary.
+
+    The behavior of calling this function is undefined if the block device is
+    closed.
+
+    @param bVolNum      The volume number of the volume whose block device
+                        geometry is being queried.
+    @param pGeometry    Populated with the geometry of the block device.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p bVolNum is an invalid volume number or @p pGeometry
+                        is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedOsBDevGetGeometry(
+    uint8_t         bVolNum,
+    BDEVGEOMETRY   *pGeometry)
+{
+    REDSTATUS       ret;
+
+    if((bVolNum >= REDCONF_VOLUME_COUNT) || (pGeometry == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        ret = DiskGetGeometry(bVolNum, pGeometry);
+    }
+
+    return ret;
+}
+
+
 /** @brief Read sectors from a physical block device.
 
     The behavior of calling this function is undefined if the block device is
@@ -237,7 +406,18 @@ REDSTATUS RedOsBDevRead(
     }
     else
     {
+      #if BDEV_ASYNC_QUEUE_DEPTH > 0U
+        REDBDEVREQ req;
+
+        ret = RedOsBDevReadAsync(&req, bVolNum, ullSectorStart, ulSectorCount, pBuffer);
+
+        if(ret == 0)
+        {
+            ret = RedOsBDevAsyncWait(&req);
+        }
+      #else
         ret = DiskRead(bVolNum, ullSectorStart, ulSectorCount, pBuffer);
+      #endif
     }
 
     return ret;
@@ -281,51 +461,660 @@ REDSTATUS RedOsBDevWrite(
     }
     else
     {
+      #if BDEV_ASYNC_QUEUE_DEPTH > 0U
+        REDBDEVREQ req;
+
+        ret = RedOsBDevWriteAsync(&req, bVolNum, ullSectorStart, ulSectorCount, pBuffer);
+
+        if(ret == 0)
+        {
+            ret = RedOsBDevAsyncWait(&req);
+        }
+      #else
         ret = DiskWrite(bVolNum, ullSectorStart, ulSectorCount, pBuffer);
+      #endif
+    }
+
+    return ret;
+}
+
+
+/** @brief Flush any caches beneath the file system.
+
+    This function must synchronously flush all software and hardware caches
+    beneath the file system, ensuring that all sectors written previously are
+    committed to permanent storage.
+
+    When #BDEV_ASYNC_QUEUE_DEPTH is non-zero, the flush is queued like a
+    write, and is carried out by the I/O task once every request for the
+    volume submitted before it, including asynchronous writes which have not
+    been waited for, has been carried out.
+
+    If the environment has no caching beneath the file system, the
+    implementation of this function can do nothing and return success.
+
+    The behavior of calling this function is undefined if the block device is
+    closed or if it was opened with ::BDEV_O_RDONLY.
+
+    @param bVolNum  The volume number of the volume whose block device is being
+                    flushed.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p bVolNum is an invalid volume number.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedOsBDevFlush(
+    uint8_t     bVolNum)
+{
+    REDSTATUS   ret;
+
+    if(bVolNum >= REDCONF_VOLUME_COUNT)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+      #if BDEV_ASYNC_QUEUE_DEPTH > 0U
+        REDBDEVREQ req;
+
+        req.bVolNum = bVolNum;
+        req.fWrite = false;
+        req.fFlush = true;
+        req.ullSectorStart = 0U;
+        req.ulSectorCount = 0U;
+        req.pBuffer = NULL;
+
+        ret = AsyncSubmit(&req);
+
+        if(ret == 0)
+        {
+            ret = RedOsBDevAsyncWait(&req);
+        }
+      #else
+        ret = DiskFlush(bVolNum);
+      #endif
+    }
+
+    return ret;
+}
+#endif /* REDCONF_READ_ONLY == 0 */
+
+
+/** @brief Submit an asynchronous read of sectors from a block device.
+
+    The request is queued and this function returns without waiting for the
+    data to be read.  The caller must not access @p pBuffer until
+    RedOsBDevAsyncWait() has returned for @p pReq.
+
+    @param pReq             Request structure, which must remain valid until the
+                            request has been waited for.
+    @param bVolNum          The volume number of the volume whose block device
+                            is being read from.
+    @param ullSectorStart   The starting sector number.
+    @param ulSectorCount    The number of sectors to read.
+    @param pBuffer          The buffer into which to read the sector data.
+
+    @return A negated ::REDSTATUS code indicating the operation result.  A
+            successful return only means that the request was submitted; the
+            result of the read is returned by RedOsBDevAsyncWait().
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p pReq or @p pBuffer is `NULL`, @p bVolNum is an
+                        invalid volume number, or @p ullStartSector and/or
+                        @p ulSectorCount refer to an invalid range of sectors.
+*/
+REDSTATUS RedOsBDevReadAsync(
+    REDBDEVREQ *pReq,
+    uint8_t     bVolNum,
+    uint64_t    ullSectorStart,
+    uint32_t    ulSectorCount,
+    void       *pBuffer)
+{
+    REDSTATUS   ret;
+
+    if(    (pReq == NULL)
+        || (bVolNum >= REDCONF_VOLUME_COUNT)
+        || (ullSectorStart >= gaRedVolConf[bVolNum].ullSectorCount)
+        || ((gaRedVolConf[bVolNum].ullSectorCount - ullSectorStart) < ulSectorCount)
+        || (pBuffer == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        pReq->bVolNum = bVolNum;
+        pReq->fWrite = false;
+        pReq->fFlush = false;
+        pReq->ullSectorStart = ullSectorStart;
+        pReq->ulSectorCount = ulSectorCount;
+        pReq->pBuffer = pBuffer;
+
+        ret = AsyncSubmit(pReq);
+    }
+
+    return ret;
+}
+
+
+#if REDCONF_READ_ONLY == 0
+/** @brief Submit an asynchronous write of sectors to a block device.
+
+    The request is queued and this function returns without waiting for the
+    data to be written.  The caller must not modify @p pBuffer until
+    RedOsBDevAsyncWait() has returned for @p pReq.
+
+    @param pReq             Request structure, which must remain valid until the
+                            request has been waited for.
+    @param bVolNum          The volume number of the volume whose block device
+                            is being written to.
+    @param ullSectorStart   The starting sector number.
+    @param ulSectorCount    The number of sectors to write.
+    @param pBuffer          The buffer from which to write the sector data.
+
+    @return A negated ::REDSTATUS code indicating the operation result.  A
+            successful return only means that the request was submitted; the
+            result of the write is returned by RedOsBDevAsyncWait().
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p pReq or @p pBuffer is `NULL`, @p bVolNum is an
+                        invalid volume number, or @p ullStartSector and/or
+                        @p ulSectorCount refer to an invalid range of sectors.
+*/
+REDSTATUS RedOsBDevWriteAsync(
+    REDBDEVREQ *pReq,
+    uint8_t     bVolNum,
+    uint64_t    ullSectorStart,
+    uint32_t    ulSectorCount,
+    const void *pBuffer)
+{
+    REDSTATUS   ret;
+
+    if(    (pReq == NULL)
+        || (bVolNum >= REDCONF_VOLUME_COUNT)
+        || (ullSectorStart >= gaRedVolConf[bVolNum].ullSectorCount)
+        || ((gaRedVolConf[bVolNum].ullSectorCount - ullSectorStart) < ulSectorCount)
+        || (pBuffer == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        pReq->bVolNum = bVolNum;
+        pReq->fWrite = true;
+        pReq->fFlush = false;
+        pReq->ullSectorStart = ullSectorStart;
+        pReq->ulSectorCount = ulSectorCount;
+        pReq->pBuffer = CAST_AWAY_CONST(void, pBuffer);
+
+        ret = AsyncSubmit(pReq);
+    }
+
+    return ret;
+}
+#endif /* REDCONF_READ_ONLY == 0 */
+
+
+/** @brief Determine whether an asynchronous request has completed.
+
+    @param pReq The request to check.
+
+    @return Whether the request has completed.
+*/
+bool RedOsBDevAsyncIsDone(
+    const REDBDEVREQ   *pReq)
+{
+    return (pReq != NULL) && pReq->fDone;
+}
+
+
+/** @brief Wait for an asynchronous request to complete.
+
+    Must be called from the task which submitted the request.  The task blocks
+    until it is notified of completion, so no CPU time is spent while the
+    transfer is in progress.
+
+    @param pReq The request to wait for.
+
+    @return The result of the request, as a negated ::REDSTATUS code.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p pReq is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedOsBDevAsyncWait(
+    REDBDEVREQ *pReq)
+{
+    REDSTATUS   ret;
+
+    if(pReq == NULL)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+      #if BDEV_ASYNC_QUEUE_DEPTH > 0U
+        REDASSERT(pReq->xTask == xTaskGetCurrentTaskHandle());
+
+        /*  Each completed request gives the notification once, so when several
+            requests are in flight, a notification might be for a different
+            request than this one.  In that case, the notification count is
+            still consumed here, and the other request will be found to be done
+            without blocking when it is waited for.
+        */
+        while(!pReq->fDone)
+        {
+            (void)ulTaskNotifyTakeIndexed(BDEV_ASYNC_NOTIFY_INDEX, pdFALSE, portMAX_DELAY);
+        }
+
+        /*  The request is often done before it is waited for, in which case
+            nothing above took its notification.  Discard any which are left
+            over, so the count does not grow with each request.  This cannot
+            lose the notification of a request this task later waits for: a
+            request is marked done before its notification is given, and the
+            wait above does not block for a request already marked done.
+        */
+        (void)ulTaskNotifyValueClearIndexed(NULL, BDEV_ASYNC_NOTIFY_INDEX, UINT32_MAX);
+      #endif
+
+        ret = pReq->ret;
     }
 
     return ret;
 }
 
 
-/** @brief Flush any caches beneath the file system.
+/** @brief Queue an asynchronous request.
+
+    @param pReq The request to submit, with the transfer parameters populated.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0   Operation was successful.
+*/
+static REDSTATUS AsyncSubmit(
+    REDBDEVREQ *pReq)
+{
+    pReq->ret = 0;
+    pReq->fDone = false;
+    pReq->xTask = xTaskGetCurrentTaskHandle();
+
+  #if BDEV_ASYNC_QUEUE_DEPTH > 0U
+    pReq->uxPriority = uxTaskPriorityGet(NULL);
+    pReq->xSubmitted = xTaskGetTickCount();
+    pReq->pNext = NULL;
+
+    REDASSERT(gxAsyncQueue != NULL);
+
+    while(xQueueSend(gxAsyncQueue, &pReq, portMAX_DELAY) != pdTRUE)
+    {
+    }
+  #else
+    /*  No I/O task: carry out the request now.
+    */
+  #if REDCONF_READ_ONLY == 0
+    if(pReq->fFlush)
+    {
+        pReq->ret = DiskFlush(pReq->bVolNum);
+    }
+    else if(pReq->fWrite)
+    {
+        pReq->ret = DiskWrite(pReq->bVolNum, pReq->ullSectorStart, pReq->ulSectorCount, pReq->pBuffer);
+    }
+    else
+  #endif
+    {
+        pReq->ret = DiskRead(pReq->bVolNum, pReq->ullSectorStart, pReq->ulSectorCount, pReq->pBuffer);
+    }
+
+    pReq->fDone = true;
+  #endif
+
+    return 0;
+}
+
+
+#if BDEV_ASYNC_QUEUE_DEPTH > 0U
+/** @brief Create the request queue and the I/O task, if not already created.
+
+    The queue and task are shared by all volumes and are never deleted, since
+    block devices may be opened and closed repeatedly.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_ENOMEM The queue or task could not be allocated.
+*/
+static REDSTATUS AsyncInit(void)
+{
+    REDSTATUS ret = 0;
+
+    if(gxAsyncQueue == NULL)
+    {
+      #if defined(configSUPPORT_STATIC_ALLOCATION) && (configSUPPORT_STATIC_ALLOCATION == 1)
+        gxAsyncQueue = xQueueCreateStatic(BDEV_ASYNC_QUEUE_DEPTH, sizeof(REDBDEVREQ *), gabAsyncQueueStorage, &gxAsyncQueueBuffer);
+        gxAsyncTask = xTaskCreateStatic(AsyncTask, "RedBDev", BDEV_ASYNC_TASK_STACK, NULL, BDEV_ASYNC_TASK_PRIORITY,
+                                        gaxAsyncTaskStack, &gxAsyncTaskBuffer);
+
+        /*  The static creation functions only fail for NULL buffers.
+        */
+        REDASSERT((gxAsyncQueue != NULL) && (gxAsyncTask != NULL));
+      #else
+        gxAsyncQueue = xQueueCreate(BDEV_ASYNC_QUEUE_DEPTH, sizeof(REDBDEVREQ *));
+
+        if(gxAsyncQueue == NULL)
+        {
+            ret = -RED_ENOMEM;
+        }
+        else if(xTaskCreate(AsyncTask, "RedBDev", BDEV_ASYNC_TASK_STACK, NULL, BDEV_ASYNC_TASK_PRIORITY, &gxAsyncTask) != pdPASS)
+        {
+            vQueueDelete(gxAsyncQueue);
+            gxAsyncQueue = NULL;
+            ret = -RED_ENOMEM;
+        }
+        else
+        {
+            /*  Queue and task created.
+            */
+        }
+      #endif
+    }
+
+    return ret;
+}
+
+
+/** @brief Block device I/O task.
+
+    Moves queued requests onto a pending list, in the order submitted.  Each
+    time the driver is idle, the next request is chosen from the pending list
+    by AsyncSchedule(), merged with any requests which continue it, and
+    carried out; then the submitting tasks are notified.
+
+    @param pParam   Unused.
+*/
+static void AsyncTask(
+    void       *pParam)
+{
+    REDBDEVREQ *pPending = NULL;
+    REDBDEVREQ *pTail = NULL;
+
+    (void)pParam;
+
+    for(;;)
+    {
+        REDBDEVREQ *pReq;
+
+        /*  Block only when there is nothing to do; otherwise, collect whatever
+            was submitted while the last request was being carried out.
+        */
+        while(xQueueReceive(gxAsyncQueue, &pReq, (pPending == NULL) ? portMAX_DELAY : 0U) == pdTRUE)
+        {
+            if(pTail == NULL)
+            {
+                pPending = pReq;
+            }
+            else
+            {
+                pTail->pNext = pReq;
+            }
+
+            pTail = pReq;
+        }
+
+        if(pPending != NULL)
+        {
+            uint32_t    ulSectorCount;
+            REDSTATUS   ret;
+
+            pReq = AsyncSchedule(&pPending);
+            pReq = AsyncMerge(&pPending, pReq, &ulSectorCount);
+
+            pTail = pPending;
+            while((pTail != NULL) && (pTail->pNext != NULL))
+            {
+                pTail = pTail->pNext;
+            }
+
+          #if REDCONF_READ_ONLY == 0
+            if(pReq->fFlush)
+            {
+                ret = DiskFlush(pReq->bVolNum);
+            }
+            else if(pReq->fWrite)
+            {
+                ret = DiskWrite(pReq->bVolNum, pReq->ullSectorStart, ulSectorCount, pReq->pBuffer);
+            }
+            else
+          #endif
+            {
+                ret = DiskRead(pReq->bVolNum, pReq->ullSectorStart, ulSectorCount, pReq->pBuffer);
+            }
+
+            while(pReq != NULL)
+            {
+                REDBDEVREQ     *pNext = pReq->pNext;
+                TaskHandle_t    xTask = pReq->xTask;
+
+                /*  Once fDone is set, the submitter may reuse the request
+                    memory, so the next pointer and task handle were saved
+                    beforehand.
+                */
+                pReq->ret = ret;
+                pReq->fDone = true;
+
+                (void)xTaskNotifyGiveIndexed(xTask, BDEV_ASYNC_NOTIFY_INDEX);
+
+                pReq = pNext;
+            }
+        }
+    }
+}
+
+
+/** @brief Choose the next request to carry out and unlink it.
+
+    @param ppPending    The pending list, in the order submitted; must not be
+                        empty.
+
+    @return The chosen request, no longer on the pending list.
+*/
+static REDBDEVREQ *AsyncSchedule(
+    REDBDEVREQ    **ppPending)
+{
+    TickType_t      xNow = xTaskGetTickCount();
+    REDBDEVREQ     *pBest = NULL;
+    REDBDEVREQ     *pReq;
+    REDBDEVREQ    **ppLink;
+
+    /*  The first expired request is the oldest one; failing that, the first
+        request of the highest priority.
+    */
+    for(pReq = *ppPending; pReq != NULL; pReq = pReq->pNext)
+    {
+        bool fExpired = (TickType_t)(xNow - pReq->xSubmitted) >= BDEV_ASYNC_DEADLINE_TICKS;
+
+        if(fExpired)
+        {
+            pBest = pReq;
+            break;
+        }
+
+        if((pBest == NULL) || (pReq->uxPriority > pBest->uxPriority))
+        {
+            pBest = pReq;
+        }
+    }
+
+    /*  If the chosen request would overtake an earlier request which it
+        conflicts with, carry out the earliest such request instead.  That one
+        has nothing earlier to conflict with, or the search continues from it.
+    */
+    for(pReq = *ppPending; pReq != pBest; )
+    {
+        if(!AsyncMayOvertake(pReq, pBest))
+        {
+            pBest = pReq;
+            pReq = *ppPending;
+        }
+        else
+        {
+            pReq = pReq->pNext;
+        }
+    }
+
+    for(ppLink = ppPending; *ppLink != pBest; ppLink = &(*ppLink)->pNext)
+    {
+    }
+
+    *ppLink = pBest->pNext;
+    pBest->pNext = NULL;
+
+    return pBest;
+}
+
+
+/** @brief Determine whether a request may be carried out before an earlier
+           pending request.
+
+    @param pPending The earlier pending request.
+    @param pReq     The later request.
+
+    @return Whether @p pReq may go before @p pPending.
+*/
+static bool AsyncMayOvertake(
+    const REDBDEVREQ   *pPending,
+    const REDBDEVREQ   *pReq)
+{
+    bool                fMayOvertake;
+
+    if(pPending->bVolNum != pReq->bVolNum)
+    {
+        fMayOvertake = true;
+    }
+    else if(pPending->fFlush || pReq->fFlush)
+    {
+        /*  A flush is a barrier for its volume, in both directions.
+        */
+        fMayOvertake = false;
+    }
+    else
+    {
+        fMayOvertake =    (!pPending->fWrite && !pReq->fWrite)
+                       || ((pPending->ullSectorStart + pPending->ulSectorCount) <= pReq->ullSectorStart)
+                       || ((pReq->ullSectorStart + pReq->ulSectorCount) <= pPending->ullSectorStart);
+    }
+
+    return fMayOvertake;
+}
+
+
+/** @brief Merge pending requests which continue a request into one transfer.
+
+    @param ppPending        The pending list, from which merged requests are
+                            unlinked.
+    @param pReq             The request chosen by AsyncSchedule().
+    @param pulSectorCount   Populated with the number of sectors covered by the
+                            merged requests.
+
+    @return The first of the merged requests, in disk order, linked to the
+            others via their pNext members.  Its starting sector and buffer
+            are those of the merged transfer.
+*/
+static REDBDEVREQ *AsyncMerge(
+    REDBDEVREQ    **ppPending,
+    REDBDEVREQ     *pReq,
+    uint32_t       *pulSectorCount)
+{
+    REDBDEVREQ     *pFirst = pReq;
+    REDBDEVREQ     *pLast = pReq;
+    uint32_t        ulSectorCount = pReq->ulSectorCount;
+    bool            fMerged;
+
+    do
+    {
+        REDBDEVREQ    **ppLink;
+        REDBDEVREQ     *pCand = NULL;
+
+        fMerged = false;
+
+        for(ppLink = ppPending; *ppLink != NULL; ppLink = &(*ppLink)->pNext)
+        {
+            pCand = *ppLink;
+
+            if(    (ulSectorCount < BDEV_ASYNC_MERGE_SECTORS)
+                && (pCand->ulSectorCount <= (BDEV_ASYNC_MERGE_SECTORS - ulSectorCount))
+                && (AsyncContinues(pLast, pCand) || AsyncContinues(pCand, pFirst)))
+            {
+                const REDBDEVREQ *pEarlier;
+
+                /*  The candidate may only join if it may overtake every
+                    request submitted before it which is still pending.
+                */
+                fMerged = true;
+                for(pEarlier = *ppPending; pEarlier != pCand; pEarlier = pEarlier->pNext)
+                {
+                    if(!AsyncMayOvertake(pEarlier, pCand))
+                    {
+                        fMerged = false;
+                        break;
+                    }
+                }
+
+                if(fMerged)
+                {
+                    break;
+                }
+            }
+        }
+
+        if(fMerged)
+        {
+            *ppLink = pCand->pNext;
+            ulSectorCount += pCand->ulSectorCount;
+
+            if(AsyncContinues(pLast, pCand))
+            {
+                pLast->pNext = pCand;
+                pCand->pNext = NULL;
+                pLast = pCand;
+            }
+            else
+            {
+                pCand->pNext = pFirst;
+                pFirst = pCand;
+            }
+        }
+    } while(fMerged);
 
-    This function must synchronously flush all software and hardware caches
-    beneath the file system, ensuring that all sectors written previously are
-    committed to permanent storage.
+    *pulSectorCount = ulSectorCount;
 
-    If the environment has no caching beneath the file system, the
-    implementation of this function can do nothing and return success.
+    return pFirst;
+}
 
-    The behavior of calling this function is undefined if the block device is
-    closed or if it was opened with ::BDEV_O_RDONLY.
 
-    @param bVolNum  The volume number of the volume whose block device is being
-                    flushed.
+/** @brief Determine whether one request continues another, both on the disk
+           and in memory, such that they can be carried out as one transfer.
 
-    @return A negated ::REDSTATUS code indicating the operation result.
+    @param pFirst   The request which would come first.
+    @param pSecond  The request which would come second.
 
-    @retval 0           Operation was successful.
-    @retval -RED_EINVAL @p bVolNum is an invalid volume number.
-    @retval -RED_EIO    A disk I/O error occurred.
+    @return Whether @p pSecond continues @p pFirst.
 */
-REDSTATUS RedOsBDevFlush(
-    uint8_t     bVolNum)
+static bool AsyncContinues(
+    const REDBDEVREQ   *pFirst,
+    const REDBDEVREQ   *pSecond)
 {
-    REDSTATUS   ret;
-
-    if(bVolNum >= REDCONF_VOLUME_COUNT)
-    {
-        ret = -RED_EINVAL;
-    }
-    else
-    {
-        ret = DiskFlush(bVolNum);
-    }
-
-    return ret;
+    return    !pFirst->fFlush
+           && !pSecond->fFlush
+           && (pFirst->bVolNum == pSecond->bVolNum)
+           && (pFirst->fWrite == pSecond->fWrite)
+           && ((pFirst->ullSectorStart + pFirst->ulSectorCount) == pSecond->ullSectorStart)
+           && ((CAST_VOID_PTR_TO_UINT8_PTR(pFirst->pBuffer) + ((uint32_t)pFirst->ulSectorCount * gaRedVolConf[pFirst->bVolNum].ulSectorSize))
+               == CAST_VOID_PTR_TO_UINT8_PTR(pSecond->pBuffer));
 }
-#endif /* REDCONF_READ_ONLY == 0 */
+#endif /* BDEV_ASYNC_QUEUE_DEPTH > 0U */
 
 
 #if BDEV_EXAMPLE_IMPLEMENTATION == BDEV_F_DRIVER
@@ -441,6 +1230,31 @@ static REDSTATUS DiskClose(
 }
 
 
+/** @brief Retrieve the geometry of a disk.
+
+    @param bVolNum      The volume number of the volume whose block device
+                        geometry is being queried.
+    @param pGeometry    Populated with the geometry of the block device.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0   Operation was successful.
+*/
+static REDSTATUS DiskGetGeometry(
+    uint8_t         bVolNum,
+    BDEVGEOMETRY   *pGeometry)
+{
+    /*  The F_DRIVER interface takes a 32-bit sector count and has no notion of
+        erase blocks.
+    */
+    (void)bVolNum;
+    pGeometry->ulMaxTransfer = 0U;
+    pGeometry->ulEraseSectors = 0U;
+    pGeometry->pMapping = NULL;
+    return 0;
+}
+
+
 /** @brief Read sectors from a disk.
 
     @param bVolNum          The volume number of the volume whose block device
@@ -685,6 +1499,42 @@ static REDSTATUS DiskClose(
 }
 
 
+/** @brief Retrieve the geometry of a disk.
+
+    @param bVolNum      The volume number of the volume whose block device
+                        geometry is being queried.
+    @param pGeometry    Populated with the geometry of the block device.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0   Operation was successful.
+*/
+static REDSTATUS DiskGetGeometry(
+    uint8_t         bVolNum,
+    BDEVGEOMETRY   *pGeometry)
+{
+    DWORD           dwEraseSectors;
+
+    pGeometry->ulMaxTransfer = MAX_SECTOR_TRANSFER;
+    pGeometry->pMapping = NULL;
+
+    /*  GET_BLOCK_SIZE reports the erase block size in sectors, or 1 if it is
+        unknown.  Not all disk_ioctl() implementations support it, so failure
+        is not an error.
+    */
+    if(disk_ioctl(bVolNum, GET_BLOCK_SIZE, &dwEraseSectors) == RES_OK)
+    {
+        pGeometry->ulEraseSectors = (uint32_t)dwEraseSectors;
+    }
+    else
+    {
+        pGeometry->ulEraseSectors = 0U;
+    }
+
+    return 0;
+}
+
+
 /** @brief Read sectors from a disk.
 
     @param bVolNum          The volume number of the volume whose block device
@@ -914,6 +1764,28 @@ static REDSTATUS DiskClose(
 }
 
 
+/** @brief Retrieve the geometry of a disk.
+
+    @param bVolNum      The volume number of the volume whose block device
+                        geometry is being queried.
+    @param pGeometry    Populated with the geometry of the block device.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0   Operation was successful.
+*/
+static REDSTATUS DiskGetGeometry(
+    uint8_t         bVolNum,
+    BDEVGEOMETRY   *pGeometry)
+{
+    (void)bVolNum;
+    pGeometry->ulMaxTransfer = MAX_SECTOR_TRANSFER;
+    pGeometry->ulEraseSectors = 0U;
+    pGeometry->pMapping = NULL;
+    return 0;
+}
+
+
 /** @brief Read sectors from a disk.
 
     @param bVolNum          The volume number of the volume whose block device
@@ -1167,6 +2039,32 @@ static REDSTATUS DiskClose(
 }
 
 
+/** @brief Retrieve the geometry of a disk.
+
+    @param bVolNum      The volume number of the volume whose block device
+                        geometry is being queried.
+    @param pGeometry    Populated with the geometry of the block device.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0   Operation was successful.
+*/
+static REDSTATUS DiskGetGeometry(
+    uint8_t         bVolNum,
+    BDEVGEOMETRY   *pGeometry)
+{
+    /*  Unaligned buffers are transferred one sector at a time through
+        gaulAlignedBuffer, but aligned buffers of any length are transferred
+        directly.
+    */
+    (void)bVolNum;
+    pGeometry->ulMaxTransfer = 0U;
+    pGeometry->ulEraseSectors = 0U;
+    pGeometry->pMapping = NULL;
+    return 0;
+}
+
+
 /** @brief Read sectors from a disk.
 
     @param bVolNum          The volume number of the volume whose block device
@@ -1441,6 +2339,28 @@ static REDSTATUS DiskClose(
 }
 
 
+/** @brief Retrieve the geometry of a disk.
+
+    @param bVolNum      The volume number of the volume whose block device
+                        geometry is being queried.
+    @param pGeometry    Populated with the geometry of the block device.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0   Operation was successful.
+*/
+static REDSTATUS DiskGetGeometry(
+    uint8_t         bVolNum,
+    BDEVGEOMETRY   *pGeometry)
+{
+    (void)bVolNum;
+    pGeometry->ulMaxTransfer = 0U;
+    pGeometry->ulEraseSectors = 0U;
+    pGeometry->pMapping = NULL;
+    return 0;
+}
+
+
 /** @brief Read sectors from a disk.
 
     @param bVolNum          The volume number of the volume whose block device
@@ -1545,6 +2465,181 @@ static REDSTATUS DiskFlush(
 }
 #endif /* REDCONF_READ_ONLY == 0 */
 
+#elif BDEV_EXAMPLE_IMPLEMENTATION == BDEV_MEMORY_MAPPED
+
+/** @brief Address at which the storage is mapped.
+
+    The volumes are laid out one after another from this address, in volume
+    number order, each taking the size given by its sector size and sector
+    count.  The default is the QSPI memory-mapped region on STM32 parts.
+*/
+#define MAPPED_BASE_ADDRESS (0x90000000U)
+
+
+static const uint8_t *gapbMapping[REDCONF_VOLUME_COUNT];
+
+
+/** @brief Initialize a disk.
+
+    @param bVolNum  The volume number of the volume whose block device is being
+                    initialized.
+    @param mode     The open mode, indicating the type of access required.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EROFS  Write access was requested; the mapping is read-only.
+*/
+static REDSTATUS DiskOpen(
+    uint8_t         bVolNum,
+    BDEVOPENMODE    mode)
+{
+    REDSTATUS       ret = 0;
+
+    if(mode != BDEV_O_RDONLY)
+    {
+        ret = -RED_EROFS;
+    }
+    else
+    {
+        uintptr_t   ptrAddress = MAPPED_BASE_ADDRESS;
+        uint8_t     bIdx;
+
+        for(bIdx = 0U; bIdx < bVolNum; bIdx++)
+        {
+            ptrAddress += (uintptr_t)(gaRedVolConf[bIdx].ullSectorCount * gaRedVolConf[bIdx].ulSectorSize);
+        }
+
+        gapbMapping[bVolNum] = (const uint8_t *)ptrAddress;
+    }
+
+    return ret;
+}
+
+
+/** @brief Uninitialize a disk.
+
+    @param bVolNum  The volume number of the volume whose block device is being
+                    uninitialized.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0   Operation was successful.
+*/
+static REDSTATUS DiskClose(
+    uint8_t     bVolNum)
+{
+    gapbMapping[bVolNum] = NULL;
+    return 0;
+}
+
+
+/** @brief Retrieve the geometry of a disk.
+
+    @param bVolNum      The volume number of the volume whose block device
+                        geometry is being queried.
+    @param pGeometry    Populated with the geometry of the block device.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0   Operation was successful.
+*/
+static REDSTATUS DiskGetGeometry(
+    uint8_t         bVolNum,
+    BDEVGEOMETRY   *pGeometry)
+{
+    pGeometry->ulMaxTransfer = 0U;
+    pGeometry->ulEraseSectors = 0U;
+    pGeometry->pMapping = gapbMapping[bVolNum];
+    return 0;
+}
+
+
+/** @brief Read sectors from a disk.
+
+    @param bVolNum          The volume number of the volume whose block device
+                            is being read from.
+    @param ullSectorStart   The starting sector number.
+    @param ulSectorCount    The number of sectors to read.
+    @param pBuffer          The buffer into which to read the sector data.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL The disk is not open.
+*/
+static REDSTATUS DiskRead(
+    uint8_t     bVolNum,
+    uint64_t    ullSectorStart,
+    uint32_t    ulSectorCount,
+    void       *pBuffer)
+{
+    REDSTATUS   ret;
+
+    if(gapbMapping[bVolNum] == NULL)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        uint64_t ullByteOffset = ullSectorStart * gaRedVolConf[bVolNum].ulSectorSize;
+        uint32_t ulByteCount = ulSectorCount * gaRedVolConf[bVolNum].ulSectorSize;
+
+        RedMemCpy(pBuffer, &gapbMapping[bVolNum][ullByteOffset], ulByteCount);
+
+        ret = 0;
+    }
+
+    return ret;
+}
+
+
+#if REDCONF_READ_ONLY == 0
+/** @brief Write sectors to a disk.
+
+    The disk is never open for writing, so this is never called.
+
+    @param bVolNum          The volume number of the volume whose block device
+                            is being written to.
+    @param ullSectorStart   The starting sector number.
+    @param ulSectorCount    The number of sectors to write.
+    @param pBuffer          The buffer from which to write the sector data.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval -RED_EROFS  The mapping is read-only.
+*/
+static REDSTATUS DiskWrite(
+    uint8_t     bVolNum,
+    uint64_t    ullSectorStart,
+    uint32_t    ulSectorCount,
+    const void *pBuffer)
+{
+    (void)bVolNum;
+    (void)ullSectorStart;
+    (void)ulSectorCount;
+    (void)pBuffer;
+    return -RED_EROFS;
+}
+
+
+/** @brief Flush any caches beneath the file system.
+
+    @param bVolNum  The volume number of the volume whose block device is being
+                    flushed.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0   Operation was successful.
+*/
+static REDSTATUS DiskFlush(
+    uint8_t     bVolNum)
+{
+    (void)bVolNum;
+    return 0;
+}
+#endif /* REDCONF_READ_ONLY == 0 */
+
 #else
 
 #error "Invalid BDEV_EXAMPLE_IMPLEMENTATION value"
@@ -38,6 +38,20 @@
   #error "INCLUDE_xTaskGetCurrentTaskHandle must be 1 when REDCONF_TASK_COUNT > 1 and REDCONF_API_POSIX == 1"
 #endif
 
+#if REDCONF_TASK_LOCAL == 1
+/*  The index of the FreeRTOS thread local storage pointer which holds the
+    task-local value of the file system.  It must not be used for anything
+    else; define it in redconf.h to pick a different index.
+*/
+#ifndef REDOSCONF_TLS_INDEX
+#define REDOSCONF_TLS_INDEX 0
+#endif
+
+#if configNUM_THREAD_LOCAL_STORAGE_POINTERS <= REDOSCONF_TLS_INDEX
+  #error "configNUM_THREAD_LOCAL_STORAGE_POINTERS must be greater than REDOSCONF_TLS_INDEX when REDCONF_TASK_LOCAL == 1"
+#endif
+#endif
+
 
 /** @brief Get the current task ID.
 
@@ -64,5 +78,29 @@ uint32_t RedOsTaskId(void)
     return ulTaskPtr + 1U;
 }
 
+
+#if REDCONF_TASK_LOCAL == 1
+/** @brief Get the task-local value of the file system for the current task.
+
+    @return The value last set by RedOsTaskLocalSet() in the current task, or
+            `NULL` if it has never been set.
+*/
+void *RedOsTaskLocalGet(void)
+{
+    return pvTaskGetThreadLocalStoragePointer(NULL, REDOSCONF_TLS_INDEX);
+}
+
+
+/** @brief Set the task-local value of the file system for the current task.
+
+    @param pValue   The value to set.
+*/
+void RedOsTaskLocalSet(
+    void   *pValue)
+{
+    vTaskSetThreadLocalStoragePointer(NULL, REDOSCONF_TLS_INDEX, pValue);
+}
+#endif
+
 #endif
 
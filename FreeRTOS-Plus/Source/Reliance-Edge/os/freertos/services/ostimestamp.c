@@ -26,7 +26,11 @@
     @brief Implements timestamp functions.
 
     The functionality implemented herein is not needed for the file system
-    driver, only to provide accurate results with performance tests.
+    driver, only to provide accurate results with performance tests, unless
+    group commit is enabled (REDCONF_TRANSACT_GROUP_MS is nonzero), in which
+    case the driver uses it to time the group commit window, or scrubbing is
+    enabled (REDCONF_API_POSIX_SCRUB is true), in which case the driver uses
+    it to time each red_scrub() call.
 */
 #include <FreeRTOS.h>
 #include <task.h>
@@ -0,0 +1,170 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                   Copyright (c) 2014-2015 Datalight, Inc.
+                       All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license may obtain a commercial license
+    before incorporating Reliance Edge into proprietary software for
+    distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+    more information.
+*/
+/** @file
+    @brief Implements the background worker task used by the commit task.
+*/
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <redfs.h>
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1) && (REDCONF_TRANSACT_TASK == 1)
+
+#if INCLUDE_xTaskGetCurrentTaskHandle != 1
+  #error "INCLUDE_xTaskGetCurrentTaskHandle must be 1 when REDCONF_TRANSACT_TASK == 1"
+#endif
+
+/*  Priority of the worker task.  It is low by default, so that transaction
+    points are committed when the tasks using the file system are idle; define
+    it in redconf.h to pick a different priority.
+*/
+#ifndef REDOSCONF_WORKER_PRIORITY
+#define REDOSCONF_WORKER_PRIORITY   (tskIDLE_PRIORITY + 1U)
+#endif
+
+/*  Stack depth, in words, of the worker task.
+*/
+#ifndef REDOSCONF_WORKER_STACK
+#define REDOSCONF_WORKER_STACK      (configMINIMAL_STACK_SIZE * 4U)
+#endif
+
+
+static void WorkerTask(void *pParam);
+
+
+static TaskHandle_t gxWorkerTask;
+static void (* volatile gpfnWorkerWork)(void);
+static volatile TaskHandle_t gxWorkerStopper;
+#if defined(configSUPPORT_STATIC_ALLOCATION) && (configSUPPORT_STATIC_ALLOCATION == 1)
+static StaticTask_t gxWorkerTaskBuffer;
+static StackType_t gaxWorkerTaskStack[REDOSCONF_WORKER_STACK];
+#endif
+
+
+/** @brief Start the worker task.
+
+    The task is created the first time, and is never deleted; once stopped, it
+    sits idle until started again.
+
+    @param pfnWork  The function to call each time the worker is signaled.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_ENOMEM The task could not be allocated.
+*/
+REDSTATUS RedOsWorkerStart(
+    void      (*pfnWork)(void))
+{
+    REDSTATUS   ret = 0;
+
+    gpfnWorkerWork = pfnWork;
+
+    if(gxWorkerTask == NULL)
+    {
+      #if defined(configSUPPORT_STATIC_ALLOCATION) && (configSUPPORT_STATIC_ALLOCATION == 1)
+        gxWorkerTask = xTaskCreateStatic(WorkerTask, "RedCommit", REDOSCONF_WORKER_STACK, NULL, REDOSCONF_WORKER_PRIORITY,
+                                         gaxWorkerTaskStack, &gxWorkerTaskBuffer);
+
+        /*  The static creation function only fails for NULL buffers.
+        */
+        REDASSERT(gxWorkerTask != NULL);
+      #else
+        if(xTaskCreate(WorkerTask, "RedCommit", REDOSCONF_WORKER_STACK, NULL, REDOSCONF_WORKER_PRIORITY, &gxWorkerTask) != pdPASS)
+        {
+            gpfnWorkerWork = NULL;
+            ret = -RED_ENOMEM;
+        }
+      #endif
+    }
+
+    return ret;
+}
+
+
+/** @brief Signal the worker task to run its work function.
+
+    Does not wait.  Signals which arrive before the worker gets to run are
+    merged into one run.
+*/
+void RedOsWorkerSignal(void)
+{
+    (void)xTaskNotifyGive(gxWorkerTask);
+}
+
+
+/** @brief Stop the worker task.
+
+    Waits for the work function to return, if it is running.  Signals which
+    have not been handled yet may be dropped; the caller must finish any such
+    work itself.
+*/
+void RedOsWorkerStop(void)
+{
+    gxWorkerStopper = xTaskGetCurrentTaskHandle();
+
+    (void)xTaskNotifyGive(gxWorkerTask);
+
+    while(gxWorkerStopper != NULL)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+
+/** @brief Worker task.
+
+    Calls the work function each time the task is notified, and acknowledges
+    stop requests.
+
+    @param pParam   Unused.
+*/
+static void WorkerTask(
+    void   *pParam)
+{
+    (void)pParam;
+
+    for(;;)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if(gpfnWorkerWork != NULL)
+        {
+            gpfnWorkerWork();
+        }
+
+        if(gxWorkerStopper != NULL)
+        {
+            TaskHandle_t xStopper = gxWorkerStopper;
+
+            gpfnWorkerWork = NULL;
+            gxWorkerStopper = NULL;
+
+            (void)xTaskNotifyGive(xStopper);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                   Copyright (c) 2014-2015 Datalight, Inc.
+                       All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license may obtain a commercial license
+    before incorporating Reliance Edge into proprietary software for
+    distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+    more information.
+*/
+/** @file
+    @brief Macros to encapsulate MISRA C:2012 deviations in OS-specific code.
+
+    The host port is not intended for use on a target, and so is not held to
+    MISRA C; these macros exist so that code shared with the target ports
+    compiles unchanged.
+*/
+#ifndef REDOSDEVIATIONS_H
+#define REDOSDEVIATIONS_H
+
+
+#if REDCONF_OUTPUT == 1
+/*  Needed for PRINT_ASSERT().
+*/
+#include <stdio.h>
+#endif
+
+
+#if (REDCONF_ASSERTS == 1) && (REDCONF_OUTPUT == 1)
+/** Print a formatted message for an assertion.
+
+    Written to stderr, so that it is not lost in buffered stdout when the
+    process aborts.
+*/
+#define PRINT_ASSERT(file, line) \
+    fprintf(stderr, "Assertion failed in \"%s\" at line %u\n", ((file) == NULL) ? "" : (file), (unsigned)(line))
+#endif
+
+
+/** Ignore the return value of a function (cast to void).
+*/
+#define IGNORE_ERRORS(fn) ((void) (fn))
+
+
+#endif
+
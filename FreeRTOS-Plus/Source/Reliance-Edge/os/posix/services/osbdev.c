@@ -0,0 +1,599 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                   Copyright (c) 2014-2015 Datalight, Inc.
+                       All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license may obtain a commercial license
+    before incorporating Reliance Edge into proprietary software for
+    distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+    more information.
+*/
+/** @file
+    @brief Implements block device I/O.
+
+    The host block device is a regular file which is mapped into memory.  Reads
+    and writes copy to and from the mapping, so the file system runs at memory
+    speed, which makes it practical to profile the core under perf, gprof, or a
+    sanitizer.  To model real media, a fixed latency can be injected into every
+    read, write, and flush request.
+
+    Each volume's image file is named with RedOsBDevConfig() before the volume
+    is formatted or mounted; the tools pass it their device argument.  The
+    specification is a path, optionally followed by the read, write, and flush
+    latencies in microseconds, separated by commas: for example,
+    "/tmp/red.bin,50,200,2000".  Omitted latencies default to
+    #REDOSCONF_BDEV_READ_LATENCY_US, #REDOSCONF_BDEV_WRITE_LATENCY_US, and
+    #REDOSCONF_BDEV_FLUSH_LATENCY_US.  If no path is configured, "redvolN.bin"
+    in the current directory is used, where N is the volume number.
+
+    The file is created if it does not exist, and extended to the size of the
+    volume if it is smaller, so a new image reads as zeroes until formatted.
+*/
+#define _POSIX_C_SOURCE 200809L /* For clock_nanosleep() and ftruncate(). */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <redfs.h>
+#include <redvolume.h>
+#include <redosdeviations.h>
+
+
+/** @brief Default latency injected into every read request, in microseconds.
+
+    Define in redconf.h to override.
+*/
+#ifndef REDOSCONF_BDEV_READ_LATENCY_US
+#define REDOSCONF_BDEV_READ_LATENCY_US  0U
+#endif
+
+/** @brief Default latency injected into every write request, in microseconds.
+
+    Define in redconf.h to override.
+*/
+#ifndef REDOSCONF_BDEV_WRITE_LATENCY_US
+#define REDOSCONF_BDEV_WRITE_LATENCY_US 0U
+#endif
+
+/** @brief Default latency injected into every flush request, in microseconds.
+
+    Define in redconf.h to override.
+*/
+#ifndef REDOSCONF_BDEV_FLUSH_LATENCY_US
+#define REDOSCONF_BDEV_FLUSH_LATENCY_US 0U
+#endif
+
+/** @brief Whether a flush writes the mapping back to the file with msync().
+
+    Data written to a shared mapping survives the process exiting or crashing
+    without this; it is only needed to survive a host crash.  It is off by
+    default, since the cost of msync() depends on the host's storage, which is
+    not what is being measured: use the flush latency to model the media.
+*/
+#ifndef REDOSCONF_BDEV_MSYNC
+#define REDOSCONF_BDEV_MSYNC            0
+#endif
+
+/** @brief The longest block device specification accepted by
+           RedOsBDevConfig(), including the null terminator.
+*/
+#define BDEV_SPEC_MAX   256U
+
+
+/** @brief State of the block device for one volume.
+*/
+typedef struct
+{
+    char        szPath[BDEV_SPEC_MAX];  /**< Path of the image file; empty if not configured. */
+    uint32_t    ulReadLatencyUs;        /**< Latency injected into reads. */
+    uint32_t    ulWriteLatencyUs;       /**< Latency injected into writes. */
+    uint32_t    ulFlushLatencyUs;       /**< Latency injected into flushes. */
+    bool        fConfigured;            /**< Whether RedOsBDevConfig() has been called. */
+    int         iFd;                    /**< The open image file, or -1. */
+    uint8_t    *pbMap;                  /**< The mapping of the image file, or NULL if closed. */
+    size_t      ulMapSize;              /**< The size of the mapping, in bytes. */
+} HOSTDISK;
+
+
+static void DiskDelay(uint32_t ulMicrosecs);
+static bool SpecLatencyParse(const char **ppszSpec, uint32_t *pulLatencyUs);
+
+
+static HOSTDISK gaDisk[REDCONF_VOLUME_COUNT];
+
+
+/** @brief Configure the block device for a volume.
+
+    Must be called while the block device is closed.  The specification is
+    described in the comment at the top of this file.
+
+    @param bVolNum      The volume number of the volume whose block device is
+                        being configured.
+    @param pszBDevSpec  The block device specification.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0                   Operation was successful.
+    @retval -RED_EBUSY          The block device is open.
+    @retval -RED_EINVAL         @p bVolNum is an invalid volume number; or
+                                @p pszBDevSpec is `NULL` or malformed.
+    @retval -RED_ENAMETOOLONG   The path in @p pszBDevSpec is too long.
+*/
+REDSTATUS RedOsBDevConfig(
+    uint8_t     bVolNum,
+    const char *pszBDevSpec)
+{
+    REDSTATUS   ret = 0;
+
+    if((bVolNum >= REDCONF_VOLUME_COUNT) || (pszBDevSpec == NULL) || (pszBDevSpec[0U] == '\0') || (pszBDevSpec[0U] == ','))
+    {
+        ret = -RED_EINVAL;
+    }
+    else if(gaDisk[bVolNum].pbMap != NULL)
+    {
+        ret = -RED_EBUSY;
+    }
+    else
+    {
+        HOSTDISK   *pDisk = &gaDisk[bVolNum];
+        const char *pszLatency = strchr(pszBDevSpec, ',');
+        size_t      ulPathLen = (pszLatency == NULL) ? strlen(pszBDevSpec) : (size_t)(pszLatency - pszBDevSpec);
+
+        pDisk->ulReadLatencyUs = REDOSCONF_BDEV_READ_LATENCY_US;
+        pDisk->ulWriteLatencyUs = REDOSCONF_BDEV_WRITE_LATENCY_US;
+        pDisk->ulFlushLatencyUs = REDOSCONF_BDEV_FLUSH_LATENCY_US;
+
+        if(ulPathLen >= sizeof(pDisk->szPath))
+        {
+            ret = -RED_ENAMETOOLONG;
+        }
+        else if(    !SpecLatencyParse(&pszLatency, &pDisk->ulReadLatencyUs)
+                 || !SpecLatencyParse(&pszLatency, &pDisk->ulWriteLatencyUs)
+                 || !SpecLatencyParse(&pszLatency, &pDisk->ulFlushLatencyUs)
+                 || (pszLatency != NULL))
+        {
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            RedMemCpy(pDisk->szPath, pszBDevSpec, (uint32_t)ulPathLen);
+            pDisk->szPath[ulPathLen] = '\0';
+            pDisk->fConfigured = true;
+        }
+
+        if(ret != 0)
+        {
+            pDisk->fConfigured = false;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Initialize a block device.
+
+    This function is called when the file system needs access to a block
+    device.
+
+    Upon successful return, the block device should be fully initialized and
+    ready to service read/write/flush/close requests.
+
+    The behavior of calling this function on a block device which is already
+    open is undefined.
+
+    @param bVolNum  The volume number of the volume whose block device is being
+                    initialized.
+    @param mode     The open mode, indicating the type of access required.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p bVolNum is an invalid volume number.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedOsBDevOpen(
+    uint8_t         bVolNum,
+    BDEVOPENMODE    mode)
+{
+    REDSTATUS       ret = 0;
+
+    if(bVolNum >= REDCONF_VOLUME_COUNT)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        HOSTDISK       *pDisk = &gaDisk[bVolNum];
+        const VOLCONF  *pVolConf = &gaRedVolConf[bVolNum];
+        uint64_t        ullSize = pVolConf->ullSectorCount * pVolConf->ulSectorSize;
+        bool            fWrite = mode != BDEV_O_RDONLY;
+        struct stat     st;
+
+        pDisk->iFd = -1;
+
+        if(!pDisk->fConfigured)
+        {
+            (void)snprintf(pDisk->szPath, sizeof(pDisk->szPath), "redvol%u.bin", (unsigned)bVolNum);
+            pDisk->ulReadLatencyUs = REDOSCONF_BDEV_READ_LATENCY_US;
+            pDisk->ulWriteLatencyUs = REDOSCONF_BDEV_WRITE_LATENCY_US;
+            pDisk->ulFlushLatencyUs = REDOSCONF_BDEV_FLUSH_LATENCY_US;
+        }
+
+        if(ullSize > (uint64_t)SIZE_MAX)
+        {
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            pDisk->iFd = open(pDisk->szPath, fWrite ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+            if(pDisk->iFd == -1)
+            {
+                ret = -RED_EIO;
+            }
+        }
+
+        if(ret == 0)
+        {
+            if(fstat(pDisk->iFd, &st) != 0)
+            {
+                ret = -RED_EIO;
+            }
+            else if((uint64_t)st.st_size < ullSize)
+            {
+                /*  Extending the file leaves a hole, which costs no disk space
+                    on the host, and reads back as zeroes.
+                */
+                if(!fWrite || (ftruncate(pDisk->iFd, (off_t)ullSize) != 0))
+                {
+                    ret = -RED_EIO;
+                }
+            }
+            else
+            {
+                /*  The image is big enough.
+                */
+            }
+        }
+
+        if(ret == 0)
+        {
+            void *pMap = mmap(NULL, (size_t)ullSize, fWrite ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, pDisk->iFd, 0);
+
+            if(pMap == MAP_FAILED)
+            {
+                ret = -RED_EIO;
+            }
+            else
+            {
+                pDisk->pbMap = pMap;
+                pDisk->ulMapSize = (size_t)ullSize;
+            }
+        }
+
+        if((ret != 0) && (pDisk->iFd != -1))
+        {
+            IGNORE_ERRORS(close(pDisk->iFd));
+            pDisk->iFd = -1;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Uninitialize a block device.
+
+    This function is called when the file system no longer needs access to a
+    block device.  If any resource were allocated by RedOsBDevOpen() to service
+    block device requests, they should be freed at this time.
+
+    Upon successful return, the block device must be in such a state that it
+    can be opened again.
+
+    The behavior of calling this function on a block device which is already
+    closed is undefined.
+
+    @param bVolNum  The volume number of the volume whose block device is being
+                    uninitialized.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p bVolNum is an invalid volume number, or the block
+                        device is not open.
+*/
+REDSTATUS RedOsBDevClose(
+    uint8_t     bVolNum)
+{
+    REDSTATUS   ret = 0;
+
+    if((bVolNum >= REDCONF_VOLUME_COUNT) || (gaDisk[bVolNum].pbMap == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        HOSTDISK *pDisk = &gaDisk[bVolNum];
+
+        IGNORE_ERRORS(munmap(pDisk->pbMap, pDisk->ulMapSize));
+        IGNORE_ERRORS(close(pDisk->iFd));
+
+        pDisk->pbMap = NULL;
+        pDisk->ulMapSize = 0U;
+        pDisk->iFd = -1;
+    }
+
+    return ret;
+}
+
+
+/** @brief Retrieve the geometry of a block device.
+
+    The core uses the geometry to size its requests: it will not issue a read
+    or write larger than the maximum transfer size, nor a write which spans an
+    erase block boundary.
+
+    The mapping is deliberately not reported, so that reads are copied into
+    block buffers as they would be on a target with a block device driver.
+
+    The behavior of calling this function is undefined if the block device is
+    closed.
+
+    @param bVolNum      The volume number of the volume whose block device
+                        geometry is being queried.
+    @param pGeometry    Populated with the geometry of the block device.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p bVolNum is an invalid volume number or @p pGeometry
+                        is `NULL`.
+*/
+REDSTATUS RedOsBDevGetGeometry(
+    uint8_t         bVolNum,
+    BDEVGEOMETRY   *pGeometry)
+{
+    REDSTATUS       ret = 0;
+
+    if((bVolNum >= REDCONF_VOLUME_COUNT) || (pGeometry == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        pGeometry->ulMaxTransfer = 0U;
+        pGeometry->ulEraseSectors = 0U;
+        pGeometry->pMapping = NULL;
+    }
+
+    return ret;
+}
+
+
+/** @brief Read sectors from a physical block device.
+
+    The behavior of calling this function is undefined if the block device is
+    closed or if it was opened with ::BDEV_O_WRONLY.
+
+    @param bVolNum          The volume number of the volume whose block device
+                            is being read from.
+    @param ullSectorStart   The starting sector number.
+    @param ulSectorCount    The number of sectors to read.
+    @param pBuffer          The buffer into which to read the sector data.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p bVolNum is an invalid volume number, @p pBuffer is
+                        `NULL`, or @p ullStartSector and/or @p ulSectorCount
+                        refer to an invalid range of sectors.
+*/
+REDSTATUS RedOsBDevRead(
+    uint8_t     bVolNum,
+    uint64_t    ullSectorStart,
+    uint32_t    ulSectorCount,
+    void       *pBuffer)
+{
+    REDSTATUS   ret = 0;
+
+    if(    (bVolNum >= REDCONF_VOLUME_COUNT)
+        || (gaDisk[bVolNum].pbMap == NULL)
+        || (ullSectorStart >= gaRedVolConf[bVolNum].ullSectorCount)
+        || ((gaRedVolConf[bVolNum].ullSectorCount - ullSectorStart) < ulSectorCount)
+        || (pBuffer == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        uint64_t ullByteOffset = ullSectorStart * gaRedVolConf[bVolNum].ulSectorSize;
+        uint32_t ulByteCount = ulSectorCount * gaRedVolConf[bVolNum].ulSectorSize;
+
+        DiskDelay(gaDisk[bVolNum].ulReadLatencyUs);
+
+        RedMemCpy(pBuffer, &gaDisk[bVolNum].pbMap[ullByteOffset], ulByteCount);
+    }
+
+    return ret;
+}
+
+
+#if REDCONF_READ_ONLY == 0
+/** @brief Write sectors to a physical block device.
+
+    The behavior of calling this function is undefined if the block device is
+    closed or if it was opened with ::BDEV_O_RDONLY.
+
+    @param bVolNum          The volume number of the volume whose block device
+                            is being written to.
+    @param ullSectorStart   The starting sector number.
+    @param ulSectorCount    The number of sectors to write.
+    @param pBuffer          The buffer from which to write the sector data.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p bVolNum is an invalid volume number, @p pBuffer is
+                        `NULL`, or @p ullStartSector and/or @p ulSectorCount
+                        refer to an invalid range of sectors.
+*/
+REDSTATUS RedOsBDevWrite(
+    uint8_t     bVolNum,
+    uint64_t    ullSectorStart,
+    uint32_t    ulSectorCount,
+    const void *pBuffer)
+{
+    REDSTATUS   ret = 0;
+
+    if(    (bVolNum >= REDCONF_VOLUME_COUNT)
+        || (gaDisk[bVolNum].pbMap == NULL)
+        || (ullSectorStart >= gaRedVolConf[bVolNum].ullSectorCount)
+        || ((gaRedVolConf[bVolNum].ullSectorCount - ullSectorStart) < ulSectorCount)
+        || (pBuffer == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        uint64_t ullByteOffset = ullSectorStart * gaRedVolConf[bVolNum].ulSectorSize;
+        uint32_t ulByteCount = ulSectorCount * gaRedVolConf[bVolNum].ulSectorSize;
+
+        DiskDelay(gaDisk[bVolNum].ulWriteLatencyUs);
+
+        RedMemCpy(&gaDisk[bVolNum].pbMap[ullByteOffset], pBuffer, ulByteCount);
+    }
+
+    return ret;
+}
+
+
+/** @brief Flush any caches beneath the file system.
+
+    This function must synchronously flush all software and hardware caches
+    beneath the file system, ensuring that all sectors written previously are
+    committed to permanent storage.
+
+    The behavior of calling this function is undefined if the block device is
+    closed or if it was opened with ::BDEV_O_RDONLY.
+
+    @param bVolNum  The volume number of the volume whose block device is being
+                    flushed.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p bVolNum is an invalid volume number.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+REDSTATUS RedOsBDevFlush(
+    uint8_t     bVolNum)
+{
+    REDSTATUS   ret = 0;
+
+    if((bVolNum >= REDCONF_VOLUME_COUNT) || (gaDisk[bVolNum].pbMap == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        DiskDelay(gaDisk[bVolNum].ulFlushLatencyUs);
+
+      #if REDOSCONF_BDEV_MSYNC == 1
+        if(msync(gaDisk[bVolNum].pbMap, gaDisk[bVolNum].ulMapSize, MS_SYNC) != 0)
+        {
+            ret = -RED_EIO;
+        }
+      #endif
+    }
+
+    return ret;
+}
+#endif /* REDCONF_READ_ONLY == 0 */
+
+
+/** @brief Wait for an injected latency to pass.
+
+    The wait sleeps rather than spins, so that it looks like waiting for I/O to
+    a profiler, and does not count as file system CPU time.
+
+    @param ulMicrosecs  The latency, in microseconds.  Nothing is done if this
+                        is zero.
+*/
+static void DiskDelay(
+    uint32_t        ulMicrosecs)
+{
+    if(ulMicrosecs > 0U)
+    {
+        struct timespec ts;
+
+        ts.tv_sec = (time_t)(ulMicrosecs / 1000000U);
+        ts.tv_nsec = (long)(ulMicrosecs % 1000000U) * 1000L;
+
+        while(clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR)
+        {
+        }
+    }
+}
+
+
+/** @brief Parse one latency from a block device specification.
+
+    @param ppszSpec     On entry, points at the comma which precedes the
+                        latency, or `NULL` if the specification has no more
+                        latencies.  Advanced past the latency on return, to
+                        the next comma or to `NULL` at the end.
+    @param pulLatencyUs Populated with the latency, if there is one; left
+                        unchanged otherwise.
+
+    @return Whether the latency was well-formed (or absent).
+*/
+static bool SpecLatencyParse(
+    const char    **ppszSpec,
+    uint32_t       *pulLatencyUs)
+{
+    bool            fOk = true;
+
+    if(*ppszSpec != NULL)
+    {
+        const char     *pszStart = &(*ppszSpec)[1U];
+        char           *pszEnd;
+        unsigned long   ulValue;
+
+        errno = 0;
+        ulValue = strtoul(pszStart, &pszEnd, 10);
+
+        if((pszEnd == pszStart) || (errno != 0) || (ulValue > UINT32_MAX) || ((*pszEnd != ',') && (*pszEnd != '\0')))
+        {
+            fOk = false;
+        }
+        else
+        {
+            *pulLatencyUs = (uint32_t)ulValue;
+            *ppszSpec = (*pszEnd == ',') ? pszEnd : NULL;
+        }
+    }
+
+    return fOk;
+}
+
@@ -0,0 +1,86 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                   Copyright (c) 2014-2015 Datalight, Inc.
+                       All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license may obtain a commercial license
+    before incorporating Reliance Edge into proprietary software for
+    distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+    more information.
+*/
+/** @file
+    @brief Implements task functions.
+*/
+#define _GNU_SOURCE /* For syscall(). */
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <redfs.h>
+
+#if (REDCONF_TASK_COUNT > 1U) && (REDCONF_API_POSIX == 1)
+
+#if REDCONF_TASK_LOCAL == 1
+/*  The task-local value of the file system for each thread.
+*/
+static _Thread_local void *gpTaskLocal;
+#endif
+
+
+/** @brief Get the current task ID.
+
+    This task ID must be unique for all tasks using the file system.
+
+    @return The task ID.  Must not be 0.
+*/
+uint32_t RedOsTaskId(void)
+{
+    /*  The Linux thread ID is unique among live threads and is never zero.
+        pthread_self() would do as well, but it is opaque, and is commonly a
+        pointer which does not fit in 32 bits.
+    */
+    long lTid = syscall(SYS_gettid);
+
+    REDASSERT((lTid > 0) && ((unsigned long)lTid <= UINT32_MAX));
+    return (uint32_t)lTid;
+}
+
+
+#if REDCONF_TASK_LOCAL == 1
+/** @brief Get the task-local value of the file system for the current task.
+
+    @return The value last set by RedOsTaskLocalSet() in the current task, or
+            `NULL` if it has never been set.
+*/
+void *RedOsTaskLocalGet(void)
+{
+    return gpTaskLocal;
+}
+
+
+/** @brief Set the task-local value of the file system for the current task.
+
+    @param pValue   The value to set.
+*/
+void RedOsTaskLocalSet(
+    void   *pValue)
+{
+    gpTaskLocal = pValue;
+}
+#endif
+
+#endif
+
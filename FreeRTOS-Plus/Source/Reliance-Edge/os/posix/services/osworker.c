@@ -0,0 +1,147 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                   Copyright (c) 2014-2015 Datalight, Inc.
+                       All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license may obtain a commercial license
+    before incorporating Reliance Edge into proprietary software for
+    distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+    more information.
+*/
+/** @file
+    @brief Implements the background worker thread used by the commit task.
+*/
+#include <pthread.h>
+
+#include <redfs.h>
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1) && (REDCONF_TRANSACT_TASK == 1)
+
+#include <redosdeviations.h>
+
+
+static void *WorkerThread(void *pParam);
+
+
+static pthread_t gWorkerThread;
+static pthread_mutex_t gWorkerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gWorkerCond = PTHREAD_COND_INITIALIZER;
+static void (*gpfnWorkerWork)(void);
+static bool gfWorkerSignaled;
+static bool gfWorkerStop;
+
+
+/** @brief Start the worker thread.
+
+    @param pfnWork  The function to call each time the worker is signaled.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_ENOMEM The thread could not be created.
+*/
+REDSTATUS RedOsWorkerStart(
+    void      (*pfnWork)(void))
+{
+    REDSTATUS   ret = 0;
+
+    gpfnWorkerWork = pfnWork;
+    gfWorkerSignaled = false;
+    gfWorkerStop = false;
+
+    if(pthread_create(&gWorkerThread, NULL, WorkerThread, NULL) != 0)
+    {
+        ret = -RED_ENOMEM;
+    }
+
+    return ret;
+}
+
+
+/** @brief Signal the worker thread to run its work function.
+
+    Does not wait.  Signals which arrive before the worker gets to run are
+    merged into one run.
+*/
+void RedOsWorkerSignal(void)
+{
+    IGNORE_ERRORS(pthread_mutex_lock(&gWorkerMutex));
+    gfWorkerSignaled = true;
+    IGNORE_ERRORS(pthread_cond_signal(&gWorkerCond));
+    IGNORE_ERRORS(pthread_mutex_unlock(&gWorkerMutex));
+}
+
+
+/** @brief Stop the worker thread.
+
+    Waits for the work function to return, if it is running.  Signals which
+    have not been handled yet may be dropped; the caller must finish any such
+    work itself.
+*/
+void RedOsWorkerStop(void)
+{
+    IGNORE_ERRORS(pthread_mutex_lock(&gWorkerMutex));
+    gfWorkerStop = true;
+    IGNORE_ERRORS(pthread_cond_signal(&gWorkerCond));
+    IGNORE_ERRORS(pthread_mutex_unlock(&gWorkerMutex));
+
+    IGNORE_ERRORS(pthread_join(gWorkerThread, NULL));
+}
+
+
+/** @brief Worker thread.
+
+    Calls the work function each time the thread is signaled, until it is
+    stopped.
+
+    @param pParam   Unused.
+
+    @return Always `NULL`.
+*/
+static void *WorkerThread(
+    void   *pParam)
+{
+    (void)pParam;
+
+    for(;;)
+    {
+        bool fStop;
+
+        IGNORE_ERRORS(pthread_mutex_lock(&gWorkerMutex));
+
+        while(!gfWorkerSignaled && !gfWorkerStop)
+        {
+            IGNORE_ERRORS(pthread_cond_wait(&gWorkerCond, &gWorkerMutex));
+        }
+
+        gfWorkerSignaled = false;
+        fStop = gfWorkerStop;
+
+        IGNORE_ERRORS(pthread_mutex_unlock(&gWorkerMutex));
+
+        if(fStop)
+        {
+            break;
+        }
+
+        gpfnWorkerWork();
+    }
+
+    return NULL;
+}
+
+#endif
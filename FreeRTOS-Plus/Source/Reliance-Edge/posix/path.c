@@ -243,6 +243,82 @@ REDSTATUS RedPathLookup(
 }
 
 
+#if SNAPSHOT_SUPPORTED
+/** @brief Lookup the inode named by the given path in the pinned snapshot.
+
+    Like RedPathLookup(), except that every name in the path is looked up in
+    the snapshot pinned by red_snapshot(), rather than in the working state.
+
+    @param pszLocalPath The path to lookup; this is a local path, without any
+                        volume prefix.
+    @param pulInode     On successful return, populated with the number of the
+                        inode named by @p pszLocalPath in the snapshot.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0                   Operation was successful.
+    @retval -RED_EINVAL         @p pszLocalPath is `NULL`; or @p pulInode is
+                                `NULL`; or no snapshot is pinned.
+    @retval -RED_EIO            A disk I/O error occurred.
+    @retval -RED_ENOENT         @p pszLocalPath is an empty string; or
+                                @p pszLocalPath does not name an existing file
+                                or directory in the snapshot.
+    @retval -RED_ENOTDIR        A component of the path other than the last is
+                                not a directory.
+    @retval -RED_ENAMETOOLONG   The length of a component of @p pszLocalPath is
+                                longer than #REDCONF_NAME_MAX.
+*/
+REDSTATUS RedPathSnapLookup(
+    const char *pszLocalPath,
+    uint32_t   *pulInode)
+{
+    REDSTATUS   ret;
+
+    if((pszLocalPath == NULL) || (pulInode == NULL))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else if(pszLocalPath[0U] == '\0')
+    {
+        ret = -RED_ENOENT;
+    }
+    else
+    {
+        uint32_t ulInode = INODE_ROOTDIR;
+        uint32_t ulPathIdx = 0U;
+
+        ret = 0;
+
+        /*  Starting from the root directory, look up each name in the
+            directory named by the names before it.
+        */
+        while((ret == 0) && PathHasMoreNames(&pszLocalPath[ulPathIdx]))
+        {
+            while(pszLocalPath[ulPathIdx] == REDCONF_PATH_SEPARATOR)
+            {
+                ulPathIdx++;
+            }
+
+            ret = RedCoreSnapLookup(ulInode, &pszLocalPath[ulPathIdx], &ulInode);
+
+            if(ret == 0)
+            {
+                ulPathIdx += RedNameLen(&pszLocalPath[ulPathIdx]);
+            }
+        }
+
+        if(ret == 0)
+        {
+            *pulInode = ulInode;
+        }
+    }
+
+    return ret;
+}
+#endif
+
+
 /** @brief Given a path, return the parent inode number and a pointer to the
            last component in the path (the name).
 
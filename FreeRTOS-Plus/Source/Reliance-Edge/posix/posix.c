@@ -79,12 +79,23 @@
 
 /*  Mask of all RED_O_* values.
 */
-#define RED_O_MASK  (RED_O_RDONLY|RED_O_WRONLY|RED_O_RDWR|RED_O_APPEND|RED_O_CREAT|RED_O_EXCL|RED_O_TRUNC)
+#if SNAPSHOT_SUPPORTED
+#define RED_O_MASK_SNAPSHOT RED_O_SNAPSHOT
+#else
+#define RED_O_MASK_SNAPSHOT 0U
+#endif
+#if (REDCONF_READ_ONLY == 0) && COMPRESSION_SUPPORTED
+#define RED_O_MASK_COMPRESS RED_O_COMPRESS
+#else
+#define RED_O_MASK_COMPRESS 0U
+#endif
+#define RED_O_MASK  (RED_O_RDONLY|RED_O_WRONLY|RED_O_RDWR|RED_O_APPEND|RED_O_CREAT|RED_O_EXCL|RED_O_TRUNC|RED_O_MASK_SNAPSHOT|RED_O_MASK_COMPRESS)
 
 #define HFLAG_DIRECTORY 0x01U   /* Handle is for a directory. */
 #define HFLAG_READABLE  0x02U   /* Handle is readable. */
 #define HFLAG_WRITEABLE 0x04U   /* Handle is writeable. */
 #define HFLAG_APPENDING 0x08U   /* Handle was opened in append mode. */
+#define HFLAG_SNAPSHOT  0x10U   /* Handle reads the pinned snapshot. */
 
 /*  @brief Handle structure, used to implement file descriptors and directory
            streams.
@@ -114,6 +125,20 @@ typedef struct
 } TASKSLOT;
 #endif
 
+/*-------------------------------------------------------------------
+    Commit Task
+-------------------------------------------------------------------*/
+
+#if TRANSACT_TASK_SUPPORTED
+/*  @brief Completion notification waiting on the commit task.
+*/
+typedef struct
+{
+    REDTRANSACTCB   pfnDone;    /**< Function to call; NULL if none is pending. */
+    void           *pContext;   /**< Context pointer to pass to pfnDone. */
+} TRANSACTNOTIFY;
+#endif
+
 /*-------------------------------------------------------------------
     Local Prototypes
 -------------------------------------------------------------------*/
@@ -129,6 +154,9 @@ static void FildesUnpack(int32_t iFildes, uint16_t *puHandleIdx, uint8_t *pbVolN
 #if REDCONF_API_POSIX_READDIR == 1
 static bool DirStreamIsValid(const REDDIR *pDirStream);
 #endif
+#if REDCONF_API_POSIX_VECTORIO == 1
+static REDSTATUS IovecLength(const REDIOVEC *paIov, uint32_t ulIovCount, uint32_t *pulLength);
+#endif
 static REDSTATUS PosixEnter(void);
 static void PosixLeave(void);
 static REDSTATUS ModeTypeCheck(uint16_t uMode, FTYPE expectedType);
@@ -136,9 +164,13 @@ static REDSTATUS ModeTypeCheck(uint16_t uMode, FTYPE expectedType);
 static REDSTATUS InodeUnlinkCheck(uint32_t ulInode);
 #endif
 #if REDCONF_TASK_COUNT > 1U
+static uint32_t TaskFind(uint32_t ulTaskId);
 static REDSTATUS TaskRegister(uint32_t *pulTaskIdx);
 #endif
 static int32_t PosixReturn(REDSTATUS iError);
+#if TRANSACT_TASK_SUPPORTED
+static void TransactTask(void);
+#endif
 
 /*-------------------------------------------------------------------
     Globals
@@ -149,6 +181,9 @@ static REDHANDLE gaHandle[REDCONF_HANDLE_COUNT];        /* Array of all handles.
 #if REDCONF_TASK_COUNT > 1U
 static TASKSLOT gaTask[REDCONF_TASK_COUNT];             /* Array of task slots. */
 #endif
+#if TRANSACT_TASK_SUPPORTED
+static TRANSACTNOTIFY gaTransactNotify[REDCONF_VOLUME_COUNT]; /* Notifications for red_transact_async(). */
+#endif
 
 /*  Array of volume mount "generations".  These are incremented for a volume
     each time that volume is mounted.  The generation number (along with the
@@ -180,6 +215,8 @@ static uint16_t gauGeneration[REDCONF_VOLUME_COUNT];
 
     <b>Errno values</b>
     - #RED_EINVAL: The volume path prefix configuration is invalid.
+    - #RED_ENOMEM: The commit task (REDCONF_TRANSACT_TASK) could not be
+      created.
 */
 int32_t red_init(void)
 {
@@ -192,6 +229,20 @@ int32_t red_init(void)
     else
     {
         ret = RedCoreInit();
+
+      #if TRANSACT_TASK_SUPPORTED
+        if(ret == 0)
+        {
+            RedMemSet(gaTransactNotify, 0U, sizeof(gaTransactNotify));
+
+            ret = RedOsWorkerStart(TransactTask);
+            if(ret != 0)
+            {
+                (void)RedCoreUninit();
+            }
+        }
+      #endif
+
         if(ret == 0)
         {
             RedMemSet(gaHandle, 0U, sizeof(gaHandle));
@@ -268,6 +319,18 @@ int32_t red_uninit(void)
           #endif
         }
 
+      #if TRANSACT_TASK_SUPPORTED
+        /*  Stop the commit task before the FS mutex goes away.  Any
+            notifications it did not get to are delivered here; with the driver
+            uninitialized, they report failure.
+        */
+        if(ret == 0)
+        {
+            RedOsWorkerStop();
+            TransactTask();
+        }
+      #endif
+
         if(ret == 0)
         {
             ret = RedCoreUninit();
@@ -388,6 +451,8 @@ int32_t red_mount(
     which is unmounting or unmounted.  If the volume has open handles, the
     unmount will fail.
 
+    If a snapshot is pinned by red_snapshot(), unmounting releases it.
+
     An error is returned if the volume is already unmounted.
 
     @param pszVolume    A path prefix identifying the volume to unmount.
@@ -566,6 +631,88 @@ int32_t red_transact(
 #endif
 
 
+#if TRANSACT_TASK_SUPPORTED
+/** @brief Commit a transaction point on a volume in the background.
+
+    Hands the transaction point to the commit task and returns without waiting
+    for it.  The commit task flushes the dirty buffers and writes the metaroot
+    just as red_transact() would.  Everything written to the volume before this
+    call is part of the transaction point; later changes may or may not be.
+
+    When the commit is done, or has failed, the commit task calls @p pfnDone
+    with the result.  It is called without the file system locked, so it may
+    call file system functions, but it holds up later commits while it runs.
+    Only one notification can be waiting per volume: a second request with a
+    different notification fails with #RED_EBUSY until the first has been
+    delivered.  A request repeating the waiting notification is merged with it.
+
+    @param pszVolume    A path prefix identifying the volume to transact.
+    @param pfnDone      The function to call when the transaction point is
+                        committed; may be `NULL` if no notification is wanted.
+    @param pContext     Passed to @p pfnDone.
+
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EBUSY: A different notification is already waiting for this
+      volume.
+    - #RED_EINVAL: Volume is not mounted; or @p pszVolume is `NULL`.
+    - #RED_ENOENT: @p pszVolume is not a valid volume path prefix.
+    - #RED_EROFS: The file system volume is read-only.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_transact_async(
+    const char     *pszVolume,
+    REDTRANSACTCB   pfnDone,
+    void           *pContext)
+{
+    REDSTATUS       ret;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        uint8_t bVolNum;
+
+        ret = RedPathSplit(pszVolume, &bVolNum, NULL);
+
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(bVolNum);
+        }
+      #endif
+
+        if((ret == 0) && (pfnDone != NULL))
+        {
+            TRANSACTNOTIFY *pNotify = &gaTransactNotify[bVolNum];
+
+            if(    (pNotify->pfnDone != NULL)
+                && ((pNotify->pfnDone != pfnDone) || (pNotify->pContext != pContext)))
+            {
+                ret = -RED_EBUSY;
+            }
+        }
+
+        if(ret == 0)
+        {
+            ret = RedCoreVolTransactAsync();
+        }
+
+        if((ret == 0) && (pfnDone != NULL))
+        {
+            gaTransactNotify[bVolNum].pfnDone = pfnDone;
+            gaTransactNotify[bVolNum].pContext = pContext;
+        }
+
+        PosixLeave();
+    }
+
+    return PosixReturn(ret);
+}
+#endif
+
+
 #if REDCONF_READ_ONLY == 0
 /** @brief Update the transaction mask.
 
@@ -582,6 +729,13 @@ int32_t red_transact(
     - #RED_TRANSACT_FSYNC
     - #RED_TRANSACT_TRUNCATE
     - #RED_TRANSACT_VOLFULL
+    - #RED_TRANSACT_ASYNC
+
+    With #RED_TRANSACT_ASYNC (which requires REDCONF_TRANSACT_TASK), the
+    automatic transaction points for the other events are handed to the commit
+    task, so the calling task does not wait for them.  The transaction points
+    for #RED_TRANSACT_UMOUNT, #RED_TRANSACT_FSYNC, and #RED_TRANSACT_VOLFULL are
+    always committed before the call returns.
 
     The #RED_TRANSACT_MANUAL macro (by itself) may be used to disable all
     automatic transaction events.  The #RED_TRANSACT_MASK macro is a bitmask
@@ -689,6 +843,65 @@ int32_t red_gettransmask(
 }
 
 
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_ATIME == 1)
+/** @brief Set the relatime age for a file system volume.
+
+    By default (an age of zero), every read of a file or directory updates its
+    access time, which turns read-mostly workloads into metadata writes.  With
+    a nonzero age, a read updates the access time only if the access time is
+    not newer than the modification or change time, or if it is at least
+    @p ulMaxAge seconds old.  An age of `UINT32_MAX` effectively restricts
+    access time updates to the first read after each write.
+
+    The setting is not persistent: it reverts to #REDCONF_RELATIME_DEFAULT
+    when the volume is next initialized.
+
+    @param pszVolume    The path prefix of the volume whose relatime age is
+                        being changed.
+    @param ulMaxAge     The relatime age, in seconds; zero for strict access
+                        time updates.
+
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EINVAL: Volume is not mounted; or @p pszVolume is `NULL`.
+    - #RED_ENOENT: @p pszVolume is not a valid volume path prefix.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_setrelatime(
+    const char *pszVolume,
+    uint32_t    ulMaxAge)
+{
+    REDSTATUS   ret;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        uint8_t bVolNum;
+
+        ret = RedPathSplit(pszVolume, &bVolNum, NULL);
+
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(bVolNum);
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            ret = RedCoreRelatimeSet(ulMaxAge);
+        }
+
+        PosixLeave();
+    }
+
+    return PosixReturn(ret);
+}
+#endif
+
+
 /** @brief Query file system status information.
 
     @p pszVolume should name a valid volume prefix or a valid root directory;
@@ -738,178 +951,120 @@ int32_t red_statvfs(
     return PosixReturn(ret);
 }
 
+#if REDCONF_STATS == 1
+/** @brief Query the I/O statistics of a file system volume.
 
-/** @brief Open a file or directory.
-
-    Exactly one file access mode must be specified:
-
-    - #RED_O_RDONLY: Open for reading only.
-    - #RED_O_WRONLY: Open for writing only.
-    - #RED_O_RDWR: Open for reading and writing.
-
-    Directories can only be opened with `RED_O_RDONLY`.
-
-    The following flags may also be used:
-
-    - #RED_O_APPEND: Set the file offset to the end-of-file prior to each
-      write.
-    - #RED_O_CREAT: Create the named file if it does not exist.
-    - #RED_O_EXCL: In combination with `RED_O_CREAT`, return an error if the
-      path already exists.
-    - #RED_O_TRUNC: Truncate the opened file to size zero.  Only supported when
-      #REDCONF_API_POSIX_FTRUNCATE is true.
-
-    #RED_O_CREAT, #RED_O_EXCL, and #RED_O_TRUNC are invalid with #RED_O_RDONLY.
-    #RED_O_EXCL is invalid without #RED_O_CREAT.
-
-    If the volume is read-only, #RED_O_RDONLY is the only valid open flag; use
-    of any other flag will result in an error.
-
-    If #RED_O_TRUNC frees data which is in the committed state, it will not
-    return to free space until after a transaction point.
-
-    The returned file descriptor must later be closed with red_close().
+    The statistics include block buffer hits and misses, block device requests
+    and blocks transferred, and transaction points; and, if
+    #REDCONF_STATS_LATENCY is true, histograms of block device and transaction
+    latency.  See the ::REDIOSTATS type for the details.  The volume does not
+    need to be mounted.
 
-    Unlike POSIX open, there is no optional third argument for the permissions
-    (which Reliance Edge does not use) and other open flags (like `O_SYNC`) are
-    not supported.
+    @p pszVolume should name a valid volume prefix or a valid root directory.
 
-    @param pszPath      The path to the file or directory.
-    @param ulOpenMode   The open flags (mask of `RED_O_` values).
+    @param pszVolume    The path prefix of the volume to query.
+    @param pStats       The buffer to populate with the statistics.
 
-    @return On success, a nonnegative file descriptor is returned.  On error,
-            -1 is returned and #red_errno is set appropriately.
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
 
     <b>Errno values</b>
-    - #RED_EEXIST: Using #RED_O_CREAT and #RED_O_EXCL, and the indicated path
-      already exists.
-    - #RED_EINVAL: @p ulOpenMode is invalid; or @p pszPath is `NULL`; or the
-      volume containing the path is not mounted.
-    - #RED_EIO: A disk I/O error occurred.
-    - #RED_EISDIR: The path names a directory and @p ulOpenMode includes
-      #RED_O_WRONLY or #RED_O_RDWR.
-    - #RED_EMFILE: There are no available file descriptors.
-    - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
-      #REDCONF_NAME_MAX.
-    - #RED_ENFILE: Attempting to create a file but the file system has used all
-      available inode slots.
-    - #RED_ENOENT: #RED_O_CREAT is not set and the named file does not exist; or
-      #RED_O_CREAT is set and the parent directory does not exist; or the
-      volume does not exist; or the @p pszPath argument, after removing the
-      volume prefix, points to an empty string.
-    - #RED_ENOSPC: The file does not exist and #RED_O_CREAT was specified, but
-      there is insufficient free space to expand the directory or to create the
-      new file.
-    - #RED_ENOTDIR: A component of the prefix in @p pszPath does not name a
-      directory.
-    - #RED_EROFS: The path resides on a read-only file system and a write
-      operation was requested.
+    - #RED_EINVAL: @p pszVolume is `NULL`; or @p pStats is `NULL`.
+    - #RED_ENOENT: @p pszVolume is not a valid volume path prefix.
     - #RED_EUSERS: Cannot become a file system user: too many users.
 */
-int32_t red_open(
-    const char *pszPath,
-    uint32_t    ulOpenMode)
+int32_t red_getstats(
+    const char *pszVolume,
+    REDIOSTATS *pStats)
 {
-    int32_t     iFildes = -1;   /* Init'd to quiet warnings. */
     REDSTATUS   ret;
 
-  #if REDCONF_READ_ONLY == 1
-    if(ulOpenMode != RED_O_RDONLY)
-    {
-        ret = -RED_EROFS;
-    }
-  #else
-    if(    (ulOpenMode != (ulOpenMode & RED_O_MASK))
-        || ((ulOpenMode & (RED_O_RDONLY|RED_O_WRONLY|RED_O_RDWR)) == 0U)
-        || (((ulOpenMode & RED_O_RDONLY) != 0U) && ((ulOpenMode & (RED_O_WRONLY|RED_O_RDWR)) != 0U))
-        || (((ulOpenMode & RED_O_WRONLY) != 0U) && ((ulOpenMode & (RED_O_RDONLY|RED_O_RDWR)) != 0U))
-        || (((ulOpenMode & RED_O_RDWR) != 0U) && ((ulOpenMode & (RED_O_RDONLY|RED_O_WRONLY)) != 0U))
-        || (((ulOpenMode & (RED_O_TRUNC|RED_O_CREAT|RED_O_EXCL)) != 0U) && ((ulOpenMode & RED_O_RDONLY) != 0U))
-        || (((ulOpenMode & RED_O_EXCL) != 0U) && ((ulOpenMode & RED_O_CREAT) == 0U)))
-    {
-        ret = -RED_EINVAL;
-    }
-  #if REDCONF_API_POSIX_FTRUNCATE == 0
-    else if((ulOpenMode & RED_O_TRUNC) != 0U)
-    {
-        ret = -RED_EINVAL;
-    }
-  #endif
-  #endif
-    else
-    {
-        ret = PosixEnter();
-    }
-
+    ret = PosixEnter();
     if(ret == 0)
     {
-        ret = FildesOpen(pszPath, ulOpenMode, FTYPE_EITHER, &iFildes);
+        uint8_t bVolNum;
 
-        PosixLeave();
-    }
+        ret = RedPathSplit(pszVolume, &bVolNum, NULL);
 
-    if(ret != 0)
-    {
-        iFildes = PosixReturn(ret);
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(bVolNum);
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            ret = RedCoreVolStats(pStats);
+        }
+
+        PosixLeave();
     }
 
-    return iFildes;
+    return PosixReturn(ret);
 }
+#endif
 
 
-#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_UNLINK == 1)
-/** @brief Delete a file or directory.
+#if REDCONF_API_POSIX_SCRUB == 1
+/** @brief Verify part of a mounted file system volume.
 
-    The given name is deleted and the link count of the corresponding inode is
-    decremented.  If the link count falls to zero (no remaining hard links),
-    the inode will be deleted.
+    Scrubbing checks the metadata of the volume, and reads back the file data,
+    a little at a time: each call works for about @p ulMaxMicrosecs and then
+    returns, recording in @p pScrub where to carry on.  Between calls, the
+    volume can be used as usual, so a scrub can be run from a low-priority task
+    without holding up other file system users for long.  Zero @p pScrub to
+    start at the beginning of the volume; once a pass over the volume has been
+    completed, `pScrub->ulPasses` is incremented and the next call starts a
+    new pass.
 
-    Unlike POSIX unlink, deleting a file or directory with open handles (file
-    descriptors or directory streams) will fail with an #RED_EBUSY error.  This
-    only applies when deleting an inode with a link count of one; if a file has
-    multiple names (hard links), all but the last name may be deleted even if
-    the file is open.
+    Inconsistencies (such as a file block which is not allocated, or a
+    directory entry which points at a free inode) are counted in
+    `pScrub->ulErrors`, and scrubbing continues past them.
 
-    If the path names a directory which is not empty, the unlink will fail.
+    @p pszVolume should name a valid volume prefix or a valid root directory.
 
-    If the deletion frees data in the committed state, it will not return to
-    free space until after a transaction point.
-
-    Unlike POSIX unlink, this function can fail when the disk is full.  To fix
-    this, transact and try again: Reliance Edge guarantees that it is possible
-    to delete at least one file or directory after a transaction point.  If disk
-    full automatic transactions are enabled, this will happen automatically.
-
-    @param pszPath  The path of the file or directory to delete.
+    @param pszVolume        The path prefix of the volume to scrub.
+    @param pScrub           The scrub progress, updated on return.
+    @param ulMaxMicrosecs   How long to work for, in microseconds.  At least one
+                            imap node, inode, or block is verified by every
+                            call, even if this is zero.
 
     @return On success, zero is returned.  On error, -1 is returned and
             #red_errno is set appropriately.
 
     <b>Errno values</b>
-    - #RED_EBUSY: @p pszPath points to an inode with open handles and a link
-      count of one.
-    - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
-      not mounted.
-    - #RED_EIO: A disk I/O error occurred.
-    - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
-      #REDCONF_NAME_MAX.
-    - #RED_ENOENT: The path does not name an existing file; or the @p pszPath
-      argument, after removing the volume prefix, points to an empty string.
-    - #RED_ENOTDIR: A component of the path prefix is not a directory.
-    - #RED_ENOTEMPTY: The path names a directory which is not empty.
-    - #RED_ENOSPC: The file system does not have enough space to modify the
-      parent directory to perform the deletion.
+    - #RED_EINVAL: @p pszVolume is `NULL`; or the volume containing
+      @p pszVolume is not mounted; or @p pScrub is `NULL`.
+    - #RED_EIO: A disk I/O error occurred, or a metadata node is corrupt.
+    - #RED_ENOENT: @p pszVolume is not a valid volume path prefix.
     - #RED_EUSERS: Cannot become a file system user: too many users.
 */
-int32_t red_unlink(
-    const char *pszPath)
+int32_t red_scrub(
+    const char *pszVolume,
+    REDSCRUB   *pScrub,
+    uint32_t    ulMaxMicrosecs)
 {
     REDSTATUS   ret;
 
     ret = PosixEnter();
     if(ret == 0)
     {
-        ret = UnlinkSub(pszPath, FTYPE_EITHER);
+        uint8_t bVolNum;
+
+        ret = RedPathSplit(pszVolume, &bVolNum, NULL);
+
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(bVolNum);
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            ret = RedCoreVolScrub(pScrub, ulMaxMicrosecs);
+        }
 
         PosixLeave();
     }
@@ -919,45 +1074,55 @@ int32_t red_unlink(
 #endif
 
 
-#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_MKDIR == 1)
-/** @brief Create a new directory.
+#if DEFERRED_DELETE_SUPPORTED
+/** @brief Free some of the space held by deleted files on a volume.
 
-    Unlike POSIX mkdir, this function has no second argument for the
-    permissions (which Reliance Edge does not use).
+    With deferred deletion enabled (REDCONF_DEFERRED_DELETE is nonzero), when
+    red_unlink() or red_rename() deletes a file which is larger than
+    REDCONF_DEFERRED_DELETE blocks, the file's name goes away at once, but
+    its data blocks are only freed later, by this function.  That keeps the
+    latency of deleting a large file short and bounded.  Call it repeatedly,
+    such as from a low-priority task, until it returns zero.  Until then, the
+    space held by the deleted files is not counted as free by red_statvfs(),
+    though it is reclaimed automatically if the volume fills up and
+    #RED_TRANSACT_VOLFULL is in the transaction mask.
 
-    @param pszPath  The name and location of the directory to create.
+    If #RED_TRANSACT_UNLINK is in the transaction mask, a transaction point is
+    made after any blocks are freed.
 
-    @return On success, zero is returned.  On error, -1 is returned and
+    @p pszVolume should name a valid volume prefix or a valid root directory.
+
+    @param pszVolume    The path prefix of the volume to reclaim space on.
+    @param ulMaxBlocks  The maximum number of blocks to free.  At least one
+                        block is freed if there are any deleted files left,
+                        even if this is zero.
+
+    @return On success, one is returned if there are deleted files left to
+            reclaim, or zero if there are none.  On error, -1 is returned and
             #red_errno is set appropriately.
 
     <b>Errno values</b>
-    - #RED_EEXIST: @p pszPath points to an existing file or directory.
-    - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
-      not mounted.
+    - #RED_EINVAL: @p pszVolume is `NULL`; or the volume containing
+      @p pszVolume is not mounted.
     - #RED_EIO: A disk I/O error occurred.
-    - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
-      #REDCONF_NAME_MAX.
-    - #RED_ENOENT: A component of the path prefix does not name an existing
-      directory; or the @p pszPath argument, after removing the volume prefix,
-      points to an empty string.
-    - #RED_ENOSPC: The file system does not have enough space for the new
-      directory or to extend the parent directory of the new directory.
-    - #RED_ENOTDIR: A component of the path prefix is not a directory.
-    - #RED_EROFS: The parent directory resides on a read-only file system.
+    - #RED_ENOENT: @p pszVolume is not a valid volume path prefix.
+    - #RED_EROFS: The file system volume is read-only.
     - #RED_EUSERS: Cannot become a file system user: too many users.
 */
-int32_t red_mkdir(
-    const char *pszPath)
+int32_t red_reclaim(
+    const char *pszVolume,
+    uint32_t    ulMaxBlocks)
 {
     REDSTATUS   ret;
+    bool        fMore = false;
+    int32_t     iReturn;
 
     ret = PosixEnter();
     if(ret == 0)
     {
-        const char *pszLocalPath;
-        uint8_t     bVolNum;
+        uint8_t bVolNum;
 
-        ret = RedPathSplit(pszPath, &bVolNum, &pszLocalPath);
+        ret = RedPathSplit(pszVolume, &bVolNum, NULL);
 
       #if REDCONF_VOLUME_COUNT > 1U
         if(ret == 0)
@@ -968,208 +1133,613 @@ int32_t red_mkdir(
 
         if(ret == 0)
         {
-            const char *pszName;
-            uint32_t    ulPInode;
-
-            ret = RedPathToName(pszLocalPath, &ulPInode, &pszName);
-
-            if(ret == 0)
-            {
-                uint32_t ulInode;
-
-                ret = RedCoreCreate(ulPInode, pszName, true, &ulInode);
-            }
+            ret = RedCoreVolReclaim(ulMaxBlocks, &fMore);
         }
 
         PosixLeave();
     }
 
-    return PosixReturn(ret);
+    if(ret == 0)
+    {
+        iReturn = fMore ? 1 : 0;
+    }
+    else
+    {
+        iReturn = PosixReturn(ret);
+    }
+
+    return iReturn;
 }
 #endif
 
 
-#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_RMDIR == 1)
-/** @brief Delete a directory.
-
-    The given directory name is deleted and the corresponding directory inode
-    will be deleted.
-
-    Unlike POSIX rmdir, deleting a directory with open handles (file
-    descriptors or directory streams) will fail with an #RED_EBUSY error.
-
-    If the path names a directory which is not empty, the deletion will fail.
-    If the path names the root directory of a file system volume, the deletion
-    will fail.
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_SNAPSHOT == 1)
+/** @brief Pin the committed state of a volume as a read-only snapshot.
 
-    If the path names a regular file, the deletion will fail.  This provides
-    type checking and may be useful in cases where an application knows the
-    path to be deleted should name a directory.
+    A transaction point is made, and the state it commits is then kept intact
+    until red_snapshot_release() is called: files and directories can be opened
+    as they were at that moment by passing #RED_O_SNAPSHOT to red_open(), or
+    with red_snapshot_opendir(), while other tasks go on modifying the volume.
+    This is useful for backups, or for reading a consistent set of files.
 
-    If the deletion frees data in the committed state, it will not return to
-    free space until after a transaction point.
+    Reliance Edge never overwrites committed blocks, so the snapshot costs no
+    copying.  In exchange, no transaction points can be made while it is pinned:
+    automatic transactions are deferred until the snapshot is released, and
+    explicit ones fail with #RED_EBUSY.  Blocks freed by the working state are
+    not reclaimed either, so a long-lived snapshot can cause #RED_ENOSPC
+    errors.  Unmounting the volume releases the snapshot.
 
-    Unlike POSIX rmdir, this function can fail when the disk is full.  To fix
-    this, transact and try again: Reliance Edge guarantees that it is possible
-    to delete at least one file or directory after a transaction point.  If disk
-    full automatic transactions are enabled, this will happen automatically.
+    @p pszVolume should name a valid volume prefix or a valid root directory.
 
-    @param pszPath  The path of the directory to delete.
+    @param pszVolume    The path prefix of the volume to snapshot.
 
     @return On success, zero is returned.  On error, -1 is returned and
             #red_errno is set appropriately.
 
     <b>Errno values</b>
-    - #RED_EBUSY: @p pszPath points to a directory with open handles.
-    - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
-      not mounted.
+    - #RED_EBUSY: A snapshot is already pinned on the volume.
+    - #RED_EINVAL: @p pszVolume is `NULL`; or the volume containing
+      @p pszVolume is not mounted.
     - #RED_EIO: A disk I/O error occurred.
-    - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
-      #REDCONF_NAME_MAX.
-    - #RED_ENOENT: The path does not name an existing directory; or the
-      @p pszPath argument, after removing the volume prefix, points to an empty
-      string.
-    - #RED_ENOTDIR: A component of the path is not a directory.
-    - #RED_ENOTEMPTY: The path names a directory which is not empty.
-    - #RED_ENOSPC: The file system does not have enough space to modify the
-      parent directory to perform the deletion.
-    - #RED_EROFS: The directory to be removed resides on a read-only file
-      system.
+    - #RED_ENOENT: @p pszVolume is not a valid volume path prefix.
     - #RED_EUSERS: Cannot become a file system user: too many users.
 */
-int32_t red_rmdir(
-    const char *pszPath)
+int32_t red_snapshot(
+    const char *pszVolume)
 {
     REDSTATUS   ret;
 
     ret = PosixEnter();
     if(ret == 0)
     {
-        ret = UnlinkSub(pszPath, FTYPE_DIR);
+        uint8_t bVolNum;
+
+        ret = RedPathSplit(pszVolume, &bVolNum, NULL);
+
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(bVolNum);
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            ret = RedCoreVolSnapshot(true);
+        }
 
         PosixLeave();
     }
 
     return PosixReturn(ret);
 }
-#endif
-
-
-#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_RENAME == 1)
-/** @brief Rename a file or directory.
 
-    Both paths must reside on the same file system volume.  Attempting to use
-    this API to move a file to a different volume will result in an error.
 
-    If @p pszNewPath names an existing file or directory, the behavior depends
-    on the configuration.  If #REDCONF_RENAME_ATOMIC is false, and if the
-    destination name exists, this function always fails and sets #red_errno to
-    #RED_EEXIST.  This behavior is contrary to POSIX.
+/** @brief Release the snapshot pinned by red_snapshot().
 
-    If #REDCONF_RENAME_ATOMIC is true, and if the new name exists, then in one
-    atomic operation, @p pszNewPath is unlinked and @p pszOldPath is renamed to
-    @p pszNewPath.  Both @p pszNewPath and @p pszOldPath must be of the same
-    type (both files or both directories).  As with red_unlink(), if
-    @p pszNewPath is a directory, it must be empty.  The major exception to this
-    behavior is that if both @p pszOldPath and @p pszNewPath are links to the
-    same inode, then the rename does nothing and both names continue to exist.
-    Unlike POSIX rename, if @p pszNewPath points to an inode with a link count
-    of one and open handles (file descriptors or directory streams), the
-    rename will fail with #RED_EBUSY.
+    Any transaction points which were deferred while the snapshot was pinned
+    are made now.  All file descriptors and directory streams opened in the
+    snapshot must be closed first.
 
-    If the rename deletes the old destination, it may free data in the
-    committed state, which will not return to free space until after a
-    transaction point.  Similarly, if the deleted inode was part of the
-    committed state, the inode slot will not be available until after a
-    transaction point.
+    @p pszVolume should name a valid volume prefix or a valid root directory.
 
-    @param pszOldPath   The path of the file or directory to rename.
-    @param pszNewPath   The new name and location after the rename.
+    @param pszVolume    The path prefix of the volume whose snapshot is to be
+                        released.
 
     @return On success, zero is returned.  On error, -1 is returned and
             #red_errno is set appropriately.
 
     <b>Errno values</b>
-    - #RED_EBUSY: #REDCONF_RENAME_ATOMIC is true and @p pszNewPath points to an
-      inode with open handles and a link count of one.
-    - #RED_EEXIST: #REDCONF_RENAME_ATOMIC is false and @p pszNewPath exists.
-    - #RED_EINVAL: @p pszOldPath is `NULL`; or @p pszNewPath is `NULL`; or the
-      volume containing the path is not mounted.
+    - #RED_EBUSY: There are still open handles in the snapshot.
+    - #RED_EINVAL: @p pszVolume is `NULL`; or the volume containing
+      @p pszVolume is not mounted; or no snapshot is pinned on the volume.
     - #RED_EIO: A disk I/O error occurred.
-    - #RED_EISDIR: The @p pszNewPath argument names a directory and the
-      @p pszOldPath argument names a non-directory.
-    - #RED_ENAMETOOLONG: The length of a component of either @p pszOldPath or
-      @p pszNewPath is longer than #REDCONF_NAME_MAX.
-    - #RED_ENOENT: The link named by @p pszOldPath does not name an existing
-      entry; or either @p pszOldPath or @p pszNewPath, after removing the volume
-      prefix, point to an empty string.
-    - #RED_ENOTDIR: A component of either path prefix is not a directory; or
-      @p pszOldPath names a directory and @p pszNewPath names a file.
-    - #RED_ENOTEMPTY: The path named by @p pszNewPath is a directory which is
-      not empty.
-    - #RED_ENOSPC: The file system does not have enough space to extend the
-      directory that would contain @p pszNewPath.
-    - #RED_EROFS: The directory to be removed resides on a read-only file
-      system.
+    - #RED_ENOENT: @p pszVolume is not a valid volume path prefix.
     - #RED_EUSERS: Cannot become a file system user: too many users.
-    - #RED_EXDEV: @p pszOldPath and @p pszNewPath are on different file system
-      volumes.
 */
-int32_t red_rename(
-    const char *pszOldPath,
-    const char *pszNewPath)
+int32_t red_snapshot_release(
+    const char *pszVolume)
 {
     REDSTATUS   ret;
 
     ret = PosixEnter();
     if(ret == 0)
     {
-        const char *pszOldLocalPath;
-        uint8_t     bOldVolNum;
+        uint8_t bVolNum;
 
-        ret = RedPathSplit(pszOldPath, &bOldVolNum, &pszOldLocalPath);
+        ret = RedPathSplit(pszVolume, &bVolNum, NULL);
 
         if(ret == 0)
         {
-            const char *pszNewLocalPath;
-            uint8_t     bNewVolNum;
-
-            ret = RedPathSplit(pszNewPath, &bNewVolNum, &pszNewLocalPath);
+            uint16_t    uHandleIdx;
 
-            if((ret == 0) && (bOldVolNum != bNewVolNum))
+            for(uHandleIdx = 0U; (ret == 0) && (uHandleIdx < REDCONF_HANDLE_COUNT); uHandleIdx++)
             {
-                ret = -RED_EXDEV;
-            }
+                const REDHANDLE *pHandle = &gaHandle[uHandleIdx];
 
-          #if REDCONF_VOLUME_COUNT > 1U
-            if(ret == 0)
-            {
-                ret = RedCoreVolSetCurrent(bOldVolNum);
+                if(    (pHandle->ulInode != INODE_INVALID) && (pHandle->bVolNum == bVolNum)
+                    && ((pHandle->bFlags & HFLAG_SNAPSHOT) != 0U))
+                {
+                    ret = -RED_EBUSY;
+                }
             }
-          #endif
+        }
 
-            if(ret == 0)
-            {
-                const char *pszOldName;
-                uint32_t    ulOldPInode;
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(bVolNum);
+        }
+      #endif
 
-                ret = RedPathToName(pszOldLocalPath, &ulOldPInode, &pszOldName);
+        if(ret == 0)
+        {
+            ret = RedCoreVolSnapshot(false);
+        }
 
-                if(ret == 0)
-                {
-                    const char *pszNewName;
-                    uint32_t    ulNewPInode;
+        PosixLeave();
+    }
 
-                    ret = RedPathToName(pszNewLocalPath, &ulNewPInode, &pszNewName);
+    return PosixReturn(ret);
+}
+#endif
 
-                  #if REDCONF_RENAME_ATOMIC == 1
-                    if(ret == 0)
-                    {
-                        uint32_t ulDestInode;
 
-                        ret = RedCoreLookup(ulNewPInode, pszNewName, &ulDestInode);
-                        if(ret == 0)
-                        {
+
+/** @brief Open a file or directory.
+
+    Exactly one file access mode must be specified:
+
+    - #RED_O_RDONLY: Open for reading only.
+    - #RED_O_WRONLY: Open for writing only.
+    - #RED_O_RDWR: Open for reading and writing.
+
+    Directories can only be opened with `RED_O_RDONLY`.
+
+    The following flags may also be used:
+
+    - #RED_O_APPEND: Set the file offset to the end-of-file prior to each
+      write.
+    - #RED_O_CREAT: Create the named file if it does not exist.
+    - #RED_O_EXCL: In combination with `RED_O_CREAT`, return an error if the
+      path already exists.
+    - #RED_O_TRUNC: Truncate the opened file to size zero.  Only supported when
+      #REDCONF_API_POSIX_FTRUNCATE is true.
+
+    - #RED_O_SNAPSHOT: Open the file or directory as it exists in the snapshot
+      pinned by red_snapshot(), rather than its current state.  Only supported
+      when #REDCONF_API_POSIX_SNAPSHOT is true, and only valid with
+      #RED_O_RDONLY.
+    - #RED_O_COMPRESS: Mark the file as compressed.  Data written to the file
+      from then on is compressed wherever that saves space, which suits files
+      that are mostly appended to.  The mark is persistent, so later opens need
+      not repeat the flag.  Only supported when #REDCONF_COMPRESSION is true,
+      and invalid with #RED_O_RDONLY.
+
+    #RED_O_CREAT, #RED_O_EXCL, and #RED_O_TRUNC are invalid with #RED_O_RDONLY.
+    #RED_O_EXCL is invalid without #RED_O_CREAT.
+
+    If the volume is read-only, #RED_O_RDONLY is the only valid open flag; use
+    of any other flag will result in an error.
+
+    If #RED_O_TRUNC frees data which is in the committed state, it will not
+    return to free space until after a transaction point.
+
+    The returned file descriptor must later be closed with red_close().
+
+    Unlike POSIX open, there is no optional third argument for the permissions
+    (which Reliance Edge does not use) and other open flags (like `O_SYNC`) are
+    not supported.
+
+    @param pszPath      The path to the file or directory.
+    @param ulOpenMode   The open flags (mask of `RED_O_` values).
+
+    @return On success, a nonnegative file descriptor is returned.  On error,
+            -1 is returned and #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EEXIST: Using #RED_O_CREAT and #RED_O_EXCL, and the indicated path
+      already exists.
+    - #RED_EINVAL: @p ulOpenMode is invalid; or @p pszPath is `NULL`; or the
+      volume containing the path is not mounted; or #RED_O_SNAPSHOT is set and
+      no snapshot is pinned on the volume.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_EISDIR: The path names a directory and @p ulOpenMode includes
+      #RED_O_WRONLY or #RED_O_RDWR.
+    - #RED_EMFILE: There are no available file descriptors.
+    - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
+      #REDCONF_NAME_MAX.
+    - #RED_ENFILE: Attempting to create a file but the file system has used all
+      available inode slots.
+    - #RED_ENOENT: #RED_O_CREAT is not set and the named file does not exist; or
+      #RED_O_CREAT is set and the parent directory does not exist; or the
+      volume does not exist; or the @p pszPath argument, after removing the
+      volume prefix, points to an empty string.
+    - #RED_ENOSPC: The file does not exist and #RED_O_CREAT was specified, but
+      there is insufficient free space to expand the directory or to create the
+      new file.
+    - #RED_ENOTDIR: A component of the prefix in @p pszPath does not name a
+      directory.
+    - #RED_EROFS: The path resides on a read-only file system and a write
+      operation was requested.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_open(
+    const char *pszPath,
+    uint32_t    ulOpenMode)
+{
+    int32_t     iFildes = -1;   /* Init'd to quiet warnings. */
+    REDSTATUS   ret;
+
+  #if REDCONF_READ_ONLY == 1
+    if(ulOpenMode != RED_O_RDONLY)
+    {
+        ret = -RED_EROFS;
+    }
+  #else
+    if(    (ulOpenMode != (ulOpenMode & RED_O_MASK))
+        || ((ulOpenMode & (RED_O_RDONLY|RED_O_WRONLY|RED_O_RDWR)) == 0U)
+        || (((ulOpenMode & RED_O_RDONLY) != 0U) && ((ulOpenMode & (RED_O_WRONLY|RED_O_RDWR)) != 0U))
+        || (((ulOpenMode & RED_O_WRONLY) != 0U) && ((ulOpenMode & (RED_O_RDONLY|RED_O_RDWR)) != 0U))
+        || (((ulOpenMode & RED_O_RDWR) != 0U) && ((ulOpenMode & (RED_O_RDONLY|RED_O_WRONLY)) != 0U))
+        || (((ulOpenMode & (RED_O_TRUNC|RED_O_CREAT|RED_O_EXCL)) != 0U) && ((ulOpenMode & RED_O_RDONLY) != 0U))
+        || (((ulOpenMode & RED_O_EXCL) != 0U) && ((ulOpenMode & RED_O_CREAT) == 0U)))
+    {
+        ret = -RED_EINVAL;
+    }
+  #if REDCONF_API_POSIX_FTRUNCATE == 0
+    else if((ulOpenMode & RED_O_TRUNC) != 0U)
+    {
+        ret = -RED_EINVAL;
+    }
+  #endif
+  #if SNAPSHOT_SUPPORTED
+    else if(((ulOpenMode & RED_O_SNAPSHOT) != 0U) && (ulOpenMode != (RED_O_RDONLY|RED_O_SNAPSHOT)))
+    {
+        ret = -RED_EINVAL;
+    }
+  #endif
+  #if COMPRESSION_SUPPORTED
+    else if(((ulOpenMode & RED_O_COMPRESS) != 0U) && ((ulOpenMode & RED_O_RDONLY) != 0U))
+    {
+        ret = -RED_EINVAL;
+    }
+  #endif
+  #endif
+    else
+    {
+        ret = PosixEnter();
+    }
+
+    if(ret == 0)
+    {
+        ret = FildesOpen(pszPath, ulOpenMode, FTYPE_EITHER, &iFildes);
+
+        PosixLeave();
+    }
+
+    if(ret != 0)
+    {
+        iFildes = PosixReturn(ret);
+    }
+
+    return iFildes;
+}
+
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_UNLINK == 1)
+/** @brief Delete a file or directory.
+
+    The given name is deleted and the link count of the corresponding inode is
+    decremented.  If the link count falls to zero (no remaining hard links),
+    the inode will be deleted.
+
+    Unlike POSIX unlink, deleting a file or directory with open handles (file
+    descriptors or directory streams) will fail with an #RED_EBUSY error.  This
+    only applies when deleting an inode with a link count of one; if a file has
+    multiple names (hard links), all but the last name may be deleted even if
+    the file is open.
+
+    If the path names a directory which is not empty, the unlink will fail.
+
+    If the deletion frees data in the committed state, it will not return to
+    free space until after a transaction point.
+
+    Unlike POSIX unlink, this function can fail when the disk is full.  To fix
+    this, transact and try again: Reliance Edge guarantees that it is possible
+    to delete at least one file or directory after a transaction point.  If disk
+    full automatic transactions are enabled, this will happen automatically.
+
+    @param pszPath  The path of the file or directory to delete.
+
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EBUSY: @p pszPath points to an inode with open handles and a link
+      count of one.
+    - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
+      not mounted.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
+      #REDCONF_NAME_MAX.
+    - #RED_ENOENT: The path does not name an existing file; or the @p pszPath
+      argument, after removing the volume prefix, points to an empty string.
+    - #RED_ENOTDIR: A component of the path prefix is not a directory.
+    - #RED_ENOTEMPTY: The path names a directory which is not empty.
+    - #RED_ENOSPC: The file system does not have enough space to modify the
+      parent directory to perform the deletion.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_unlink(
+    const char *pszPath)
+{
+    REDSTATUS   ret;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        ret = UnlinkSub(pszPath, FTYPE_EITHER);
+
+        PosixLeave();
+    }
+
+    return PosixReturn(ret);
+}
+#endif
+
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_MKDIR == 1)
+/** @brief Create a new directory.
+
+    Unlike POSIX mkdir, this function has no second argument for the
+    permissions (which Reliance Edge does not use).
+
+    @param pszPath  The name and location of the directory to create.
+
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EEXIST: @p pszPath points to an existing file or directory.
+    - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
+      not mounted.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
+      #REDCONF_NAME_MAX.
+    - #RED_ENOENT: A component of the path prefix does not name an existing
+      directory; or the @p pszPath argument, after removing the volume prefix,
+      points to an empty string.
+    - #RED_ENOSPC: The file system does not have enough space for the new
+      directory or to extend the parent directory of the new directory.
+    - #RED_ENOTDIR: A component of the path prefix is not a directory.
+    - #RED_EROFS: The parent directory resides on a read-only file system.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_mkdir(
+    const char *pszPath)
+{
+    REDSTATUS   ret;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        const char *pszLocalPath;
+        uint8_t     bVolNum;
+
+        ret = RedPathSplit(pszPath, &bVolNum, &pszLocalPath);
+
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(bVolNum);
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            const char *pszName;
+            uint32_t    ulPInode;
+
+            ret = RedPathToName(pszLocalPath, &ulPInode, &pszName);
+
+            if(ret == 0)
+            {
+                uint32_t ulInode;
+
+                ret = RedCoreCreate(ulPInode, pszName, true, &ulInode);
+            }
+        }
+
+        PosixLeave();
+    }
+
+    return PosixReturn(ret);
+}
+#endif
+
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_RMDIR == 1)
+/** @brief Delete a directory.
+
+    The given directory name is deleted and the corresponding directory inode
+    will be deleted.
+
+    Unlike POSIX rmdir, deleting a directory with open handles (file
+    descriptors or directory streams) will fail with an #RED_EBUSY error.
+
+    If the path names a directory which is not empty, the deletion will fail.
+    If the path names the root directory of a file system volume, the deletion
+    will fail.
+
+    If the path names a regular file, the deletion will fail.  This provides
+    type checking and may be useful in cases where an application knows the
+    path to be deleted should name a directory.
+
+    If the deletion frees data in the committed state, it will not return to
+    free space until after a transaction point.
+
+    Unlike POSIX rmdir, this function can fail when the disk is full.  To fix
+    this, transact and try again: Reliance Edge guarantees that it is possible
+    to delete at least one file or directory after a transaction point.  If disk
+    full automatic transactions are enabled, this will happen automatically.
+
+    @param pszPath  The path of the directory to delete.
+
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EBUSY: @p pszPath points to a directory with open handles.
+    - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
+      not mounted.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
+      #REDCONF_NAME_MAX.
+    - #RED_ENOENT: The path does not name an existing directory; or the
+      @p pszPath argument, after removing the volume prefix, points to an empty
+      string.
+    - #RED_ENOTDIR: A component of the path is not a directory.
+    - #RED_ENOTEMPTY: The path names a directory which is not empty.
+    - #RED_ENOSPC: The file system does not have enough space to modify the
+      parent directory to perform the deletion.
+    - #RED_EROFS: The directory to be removed resides on a read-only file
+      system.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_rmdir(
+    const char *pszPath)
+{
+    REDSTATUS   ret;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        ret = UnlinkSub(pszPath, FTYPE_DIR);
+
+        PosixLeave();
+    }
+
+    return PosixReturn(ret);
+}
+#endif
+
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_RENAME == 1)
+/** @brief Rename a file or directory.
+
+    Both paths must reside on the same file system volume.  Attempting to use
+    this API to move a file to a different volume will result in an error.
+
+    If @p pszNewPath names an existing file or directory, the behavior depends
+    on the configuration.  If #REDCONF_RENAME_ATOMIC is false, and if the
+    destination name exists, this function always fails and sets #red_errno to
+    #RED_EEXIST.  This behavior is contrary to POSIX.
+
+    If #REDCONF_RENAME_ATOMIC is true, and if the new name exists, then in one
+    atomic operation, @p pszNewPath is unlinked and @p pszOldPath is renamed to
+    @p pszNewPath.  Both @p pszNewPath and @p pszOldPath must be of the same
+    type (both files or both directories).  As with red_unlink(), if
+    @p pszNewPath is a directory, it must be empty.  The major exception to this
+    behavior is that if both @p pszOldPath and @p pszNewPath are links to the
+    same inode, then the rename does nothing and both names continue to exist.
+    Unlike POSIX rename, if @p pszNewPath points to an inode with a link count
+    of one and open handles (file descriptors or directory streams), the
+    rename will fail with #RED_EBUSY.
+
+    If the rename deletes the old destination, it may free data in the
+    committed state, which will not return to free space until after a
+    transaction point.  Similarly, if the deleted inode was part of the
+    committed state, the inode slot will not be available until after a
+    transaction point.
+
+    @param pszOldPath   The path of the file or directory to rename.
+    @param pszNewPath   The new name and location after the rename.
+
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EBUSY: #REDCONF_RENAME_ATOMIC is true and @p pszNewPath points to an
+      inode with open handles and a link count of one.
+    - #RED_EEXIST: #REDCONF_RENAME_ATOMIC is false and @p pszNewPath exists.
+    - #RED_EINVAL: @p pszOldPath is `NULL`; or @p pszNewPath is `NULL`; or the
+      volume containing the path is not mounted.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_EISDIR: The @p pszNewPath argument names a directory and the
+      @p pszOldPath argument names a non-directory.
+    - #RED_ENAMETOOLONG: The length of a component of either @p pszOldPath or
+      @p pszNewPath is longer than #REDCONF_NAME_MAX.
+    - #RED_ENOENT: The link named by @p pszOldPath does not name an existing
+      entry; or either @p pszOldPath or @p pszNewPath, after removing the volume
+      prefix, point to an empty string.
+    - #RED_ENOTDIR: A component of either path prefix is not a directory; or
+      @p pszOldPath names a directory and @p pszNewPath names a file.
+    - #RED_ENOTEMPTY: The path named by @p pszNewPath is a directory which is
+      not empty.
+    - #RED_ENOSPC: The file system does not have enough space to extend the
+      directory that would contain @p pszNewPath.
+    - #RED_EROFS: The directory to be removed resides on a read-only file
+      system.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+    - #RED_EXDEV: @p pszOldPath and @p pszNewPath are on different file system
+      volumes.
+*/
+int32_t red_rename(
+    const char *pszOldPath,
+    const char *pszNewPath)
+{
+    REDSTATUS   ret;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        const char *pszOldLocalPath;
+        uint8_t     bOldVolNum;
+
+        ret = RedPathSplit(pszOldPath, &bOldVolNum, &pszOldLocalPath);
+
+        if(ret == 0)
+        {
+            const char *pszNewLocalPath;
+            uint8_t     bNewVolNum;
+
+            ret = RedPathSplit(pszNewPath, &bNewVolNum, &pszNewLocalPath);
+
+            if((ret == 0) && (bOldVolNum != bNewVolNum))
+            {
+                ret = -RED_EXDEV;
+            }
+
+          #if REDCONF_VOLUME_COUNT > 1U
+            if(ret == 0)
+            {
+                ret = RedCoreVolSetCurrent(bOldVolNum);
+            }
+          #endif
+
+            if(ret == 0)
+            {
+                const char *pszOldName;
+                uint32_t    ulOldPInode;
+
+                ret = RedPathToName(pszOldLocalPath, &ulOldPInode, &pszOldName);
+
+                if(ret == 0)
+                {
+                    const char *pszNewName;
+                    uint32_t    ulNewPInode;
+
+                    ret = RedPathToName(pszNewLocalPath, &ulNewPInode, &pszNewName);
+
+                  #if REDCONF_RENAME_ATOMIC == 1
+                    if(ret == 0)
+                    {
+                        uint32_t ulDestInode;
+
+                        ret = RedCoreLookup(ulNewPInode, pszNewName, &ulDestInode);
+                        if(ret == 0)
+                        {
                             ret = InodeUnlinkCheck(ulDestInode);
                         }
                         else if(ret == -RED_ENOENT)
@@ -1186,205 +1756,739 @@ int32_t red_rename(
 
                     if(ret == 0)
                     {
-                        ret = RedCoreRename(ulOldPInode, pszOldName, ulNewPInode, pszNewName);
+                        ret = RedCoreRename(ulOldPInode, pszOldName, ulNewPInode, pszNewName);
+                    }
+                }
+            }
+        }
+
+        PosixLeave();
+    }
+
+    return PosixReturn(ret);
+}
+#endif
+
+
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_LINK == 1)
+/** @brief Create a hard link.
+
+    This creates an additional name (link) for the file named by @p pszPath.
+    The new name refers to the same file with the same contents.  If a name is
+    deleted, but the underlying file has other names, the file continues to
+    exist.  The link count (accessible via red_fstat()) indicates the number of
+    names that a file has.  All of a file's names are on equal footing: there
+    is nothing special about the original name.
+
+    If @p pszPath names a directory, the operation will fail.
+
+    @param pszPath      The path indicating the inode for the new link.
+    @param pszHardLink  The name and location for the new link.
+
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EEXIST: @p pszHardLink resolves to an existing file.
+    - #RED_EINVAL: @p pszPath or @p pszHardLink is `NULL`; or the volume
+      containing the paths is not mounted.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_EMLINK: Creating the link would exceed the maximum link count of the
+      inode named by @p pszPath.
+    - #RED_ENAMETOOLONG: The length of a component of either @p pszPath or
+      @p pszHardLink is longer than #REDCONF_NAME_MAX.
+    - #RED_ENOENT: A component of either path prefix does not exist; or the file
+      named by @p pszPath does not exist; or either @p pszPath or
+      @p pszHardLink, after removing the volume prefix, point to an empty
+      string.
+    - #RED_ENOSPC: There is insufficient free space to expand the directory that
+      would contain the link.
+    - #RED_ENOTDIR: A component of either path prefix is not a directory.
+    - #RED_EPERM: The @p pszPath argument names a directory.
+    - #RED_EROFS: The requested link requires writing in a directory on a
+      read-only file system.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+    - #RED_EXDEV: @p pszPath and @p pszHardLink are on different file system
+      volumes.
+*/
+int32_t red_link(
+    const char *pszPath,
+    const char *pszHardLink)
+{
+    REDSTATUS   ret;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        const char *pszLocalPath;
+        uint8_t     bVolNum;
+
+        ret = RedPathSplit(pszPath, &bVolNum, &pszLocalPath);
+
+        if(ret == 0)
+        {
+            const char *pszLinkLocalPath;
+            uint8_t     bLinkVolNum;
+
+            ret = RedPathSplit(pszHardLink, &bLinkVolNum, &pszLinkLocalPath);
+
+            if((ret == 0) && (bVolNum != bLinkVolNum))
+            {
+                ret = -RED_EXDEV;
+            }
+
+          #if REDCONF_VOLUME_COUNT > 1U
+            if(ret == 0)
+            {
+                ret = RedCoreVolSetCurrent(bVolNum);
+            }
+          #endif
+
+            if(ret == 0)
+            {
+                uint32_t    ulInode;
+
+                ret = RedPathLookup(pszLocalPath, &ulInode);
+
+                if(ret == 0)
+                {
+                    const char *pszLinkName;
+                    uint32_t    ulLinkPInode;
+
+                    ret = RedPathToName(pszLinkLocalPath, &ulLinkPInode, &pszLinkName);
+
+                    if(ret == 0)
+                    {
+                        ret = RedCoreLink(ulLinkPInode, pszLinkName, ulInode);
+                    }
+                }
+            }
+        }
+
+        PosixLeave();
+    }
+
+    return PosixReturn(ret);
+}
+#endif
+
+
+/** @brief Close a file descriptor.
+
+    @param iFildes  The file descriptor to close.
+
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EBADF: @p iFildes is not a valid file descriptor.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_close(
+    int32_t     iFildes)
+{
+    REDSTATUS   ret;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        ret = FildesClose(iFildes);
+
+        PosixLeave();
+    }
+
+    return PosixReturn(ret);
+}
+
+
+/** @brief Read from an open file.
+
+    The read takes place at the file offset associated with @p iFildes and
+    advances the file offset by the number of bytes actually read.
+
+    Data which has not yet been written, but which is before the end-of-file
+    (sparse data), will read as zeroes.  A short read -- where the number of
+    bytes read is less than requested -- indicates that the requested read was
+    partially or, if zero bytes were read, entirely beyond the end-of-file.
+
+    @param iFildes  The file descriptor from which to read.
+    @param pBuffer  The buffer to populate with data read.  Must be at least
+                    @p ulLength bytes in size.
+    @param ulLength Number of bytes to attempt to read.
+
+    @return On success, returns a nonnegative value indicating the number of
+            bytes actually read.  On error, -1 is returned and #red_errno is
+            set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
+      for reading.
+    - #RED_EINVAL: @p pBuffer is `NULL`; or @p ulLength exceeds INT32_MAX and
+      cannot be returned properly.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_EISDIR: The @p iFildes is a file descriptor for a directory.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_read(
+    int32_t     iFildes,
+    void       *pBuffer,
+    uint32_t    ulLength)
+{
+    uint32_t    ulLenRead = 0U;
+    REDSTATUS   ret;
+    int32_t     iReturn;
+
+    if(ulLength > (uint32_t)INT32_MAX)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        ret = PosixEnter();
+    }
+
+    if(ret == 0)
+    {
+        REDHANDLE  *pHandle;
+
+        ret = FildesToHandle(iFildes, FTYPE_FILE, &pHandle);
+
+        if((ret == 0) && ((pHandle->bFlags & HFLAG_READABLE) == 0U))
+        {
+            ret = -RED_EBADF;
+        }
+
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(pHandle->bVolNum);
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            ulLenRead = ulLength;
+
+          #if SNAPSHOT_SUPPORTED
+            if((pHandle->bFlags & HFLAG_SNAPSHOT) != 0U)
+            {
+                ret = RedCoreSnapFileRead(pHandle->ulInode, pHandle->ullOffset, &ulLenRead, pBuffer);
+            }
+            else
+          #endif
+            {
+                ret = RedCoreFileRead(pHandle->ulInode, pHandle->ullOffset, &ulLenRead, pBuffer);
+            }
+        }
+
+        if(ret == 0)
+        {
+            REDASSERT(ulLenRead <= ulLength);
+
+            pHandle->ullOffset += ulLenRead;
+        }
+
+        PosixLeave();
+    }
+
+    if(ret == 0)
+    {
+        iReturn = (int32_t)ulLenRead;
+    }
+    else
+    {
+        iReturn = PosixReturn(ret);
+    }
+
+    return iReturn;
+}
+
+
+#if REDCONF_API_POSIX_VECTORIO == 1
+/** @brief Read from an open file into a scatter-gather list of buffers.
+
+    Equivalent to a sequence of red_read() calls, one for each buffer in
+    @p paIov, except that the whole list is read while holding the file system
+    lock just once.  The read takes place at the file offset associated with
+    @p iFildes and advances the file offset by the number of bytes actually
+    read.  Buffers are filled in order, each one completely before the next.
+
+    A short read -- where the number of bytes read is less than the total size
+    of the buffers -- indicates that the requested read was partially or, if
+    zero bytes were read, entirely beyond the end-of-file.
+
+    @param iFildes      The file descriptor from which to read.
+    @param paIov        The buffers to populate with data read.
+    @param ulIovCount   The number of entries in @p paIov.
+
+    @return On success, returns a nonnegative value indicating the number of
+            bytes actually read.  On error, -1 is returned and #red_errno is
+            set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
+      for reading.
+    - #RED_EINVAL: @p paIov is `NULL`; or @p ulIovCount is zero; or a buffer
+      with a nonzero length is `NULL`; or the total length of the buffers
+      exceeds INT32_MAX and cannot be returned properly.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_EISDIR: The @p iFildes is a file descriptor for a directory.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_readv(
+    int32_t         iFildes,
+    const REDIOVEC *paIov,
+    uint32_t        ulIovCount)
+{
+    uint32_t        ulLength;
+    uint32_t        ulLenRead = 0U;
+    REDSTATUS       ret;
+    int32_t         iReturn;
+
+    ret = IovecLength(paIov, ulIovCount, &ulLength);
+
+    if(ret == 0)
+    {
+        ret = PosixEnter();
+    }
+
+    if(ret == 0)
+    {
+        REDHANDLE  *pHandle;
+
+        ret = FildesToHandle(iFildes, FTYPE_FILE, &pHandle);
+
+        if((ret == 0) && ((pHandle->bFlags & HFLAG_READABLE) == 0U))
+        {
+            ret = -RED_EBADF;
+        }
+
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(pHandle->bVolNum);
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            uint32_t ulCount = ulIovCount;
+            uint32_t ulIdx;
+
+            for(ulIdx = 0U; (ret == 0) && (ulIdx < ulCount); ulIdx++)
+            {
+                uint32_t ulLen = paIov[ulIdx].iov_len;
+
+                if(ulLen > 0U)
+                {
+                  #if SNAPSHOT_SUPPORTED
+                    if((pHandle->bFlags & HFLAG_SNAPSHOT) != 0U)
+                    {
+                        ret = RedCoreSnapFileRead(pHandle->ulInode, pHandle->ullOffset + ulLenRead, &ulLen, paIov[ulIdx].iov_base);
+                    }
+                    else
+                  #endif
+                    {
+                        ret = RedCoreFileRead(pHandle->ulInode, pHandle->ullOffset + ulLenRead, &ulLen, paIov[ulIdx].iov_base);
+                    }
+
+                    if(ret == 0)
+                    {
+                        ulLenRead += ulLen;
+
+                        /*  A short read means the end-of-file was reached, so
+                            there is nothing more to read into the remaining
+                            buffers.
+                        */
+                        if(ulLen < paIov[ulIdx].iov_len)
+                        {
+                            ulCount = ulIdx;
+                        }
                     }
                 }
             }
         }
 
+        if(ret == 0)
+        {
+            REDASSERT(ulLenRead <= ulLength);
+
+            pHandle->ullOffset += ulLenRead;
+        }
+
         PosixLeave();
     }
 
-    return PosixReturn(ret);
+    if(ret == 0)
+    {
+        iReturn = (int32_t)ulLenRead;
+    }
+    else
+    {
+        iReturn = PosixReturn(ret);
+    }
+
+    return iReturn;
 }
-#endif
+#endif /* REDCONF_API_POSIX_VECTORIO == 1 */
 
 
-#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_LINK == 1)
-/** @brief Create a hard link.
+#if REDCONF_READ_MAP > 0U
+/** @brief Map data from an open file for reading, without copying it.
 
-    This creates an additional name (link) for the file named by @p pszPath.
-    The new name refers to the same file with the same contents.  If a name is
-    deleted, but the underlying file has other names, the file continues to
-    exist.  The link count (accessible via red_fstat()) indicates the number of
-    names that a file has.  All of a file's names are on equal footing: there
-    is nothing special about the original name.
+    This is like red_read(), except that instead of copying the data into a
+    caller buffer, it returns a read-only pointer to the data in the file
+    system's block buffer, which stays reserved for the caller until it is
+    released with red_read_unmap().  This saves a copy when the data is just
+    going to be passed along, for instance to a network stack.
 
-    If @p pszPath names a directory, the operation will fail.
+    The map takes place at the file offset associated with @p iFildes and
+    advances the file offset by the number of bytes actually mapped.  At most
+    one block is mapped, so the mapped length may be shorter than requested
+    even when the end-of-file has not been reached; zero bytes are mapped only
+    at or beyond the end-of-file.  The mapped data is a snapshot: subsequent
+    writes to the file do not alter it.
 
-    @param pszPath      The path indicating the inode for the new link.
-    @param pszHardLink  The name and location for the new link.
+    At most #REDCONF_READ_MAP maps may be outstanding at once.  Each of them
+    keeps a block buffer out of use, so they should be released promptly.  The
+    exception is a read-only (#REDCONF_READ_ONLY) volume on a memory-mapped
+    block device, where the mapped data points straight into the block
+    device's mapping and no buffer is used.
 
-    @return On success, zero is returned.  On error, -1 is returned and
-            #red_errno is set appropriately.
+    @param iFildes  The file descriptor from which to read.
+    @param ulLength Maximum number of bytes to map.
+    @param ppBuffer On success, if a nonzero value is returned, populated with
+                    a pointer to the mapped data.
+
+    @return On success, returns a nonnegative value indicating the number of
+            bytes actually mapped.  On error, -1 is returned and #red_errno is
+            set appropriately.
 
     <b>Errno values</b>
-    - #RED_EEXIST: @p pszHardLink resolves to an existing file.
-    - #RED_EINVAL: @p pszPath or @p pszHardLink is `NULL`; or the volume
-      containing the paths is not mounted.
+    - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
+      for reading.
+    - #RED_EBUSY: #REDCONF_READ_MAP maps are already outstanding.
+    - #RED_EINVAL: @p ppBuffer is `NULL`; or @p ulLength exceeds INT32_MAX and
+      cannot be returned properly.
     - #RED_EIO: A disk I/O error occurred.
-    - #RED_EMLINK: Creating the link would exceed the maximum link count of the
-      inode named by @p pszPath.
-    - #RED_ENAMETOOLONG: The length of a component of either @p pszPath or
-      @p pszHardLink is longer than #REDCONF_NAME_MAX.
-    - #RED_ENOENT: A component of either path prefix does not exist; or the file
-      named by @p pszPath does not exist; or either @p pszPath or
-      @p pszHardLink, after removing the volume prefix, point to an empty
-      string.
-    - #RED_ENOSPC: There is insufficient free space to expand the directory that
-      would contain the link.
-    - #RED_ENOTDIR: A component of either path prefix is not a directory.
-    - #RED_EPERM: The @p pszPath argument names a directory.
-    - #RED_EROFS: The requested link requires writing in a directory on a
-      read-only file system.
+    - #RED_EISDIR: The @p iFildes is a file descriptor for a directory.
+    - #RED_ENODATA: The data at the file offset is sparse (it has not been
+      written), or the file is compressed (see #RED_O_COMPRESS), so there is
+      no buffer to map; use red_read() instead, which will read sparse data
+      as zeroes and decompress compressed data.
     - #RED_EUSERS: Cannot become a file system user: too many users.
-    - #RED_EXDEV: @p pszPath and @p pszHardLink are on different file system
-      volumes.
 */
-int32_t red_link(
-    const char *pszPath,
-    const char *pszHardLink)
+int32_t red_read_map(
+    int32_t     iFildes,
+    uint32_t    ulLength,
+    const void **ppBuffer)
 {
+    uint32_t    ulLenMapped = 0U;
     REDSTATUS   ret;
+    int32_t     iReturn;
+
+    if(ulLength > (uint32_t)INT32_MAX)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        ret = PosixEnter();
+    }
 
-    ret = PosixEnter();
     if(ret == 0)
     {
-        const char *pszLocalPath;
-        uint8_t     bVolNum;
+        REDHANDLE  *pHandle;
 
-        ret = RedPathSplit(pszPath, &bVolNum, &pszLocalPath);
+        ret = FildesToHandle(iFildes, FTYPE_FILE, &pHandle);
+
+        if((ret == 0) && ((pHandle->bFlags & HFLAG_READABLE) == 0U))
+        {
+            ret = -RED_EBADF;
+        }
+
+      #if SNAPSHOT_SUPPORTED
+        /*  Snapshot reads are not buffer-cached, so there is nothing to map.
+        */
+        if((ret == 0) && ((pHandle->bFlags & HFLAG_SNAPSHOT) != 0U))
+        {
+            ret = -RED_EBADF;
+        }
+      #endif
 
+      #if REDCONF_VOLUME_COUNT > 1U
         if(ret == 0)
         {
-            const char *pszLinkLocalPath;
-            uint8_t     bLinkVolNum;
+            ret = RedCoreVolSetCurrent(pHandle->bVolNum);
+        }
+      #endif
 
-            ret = RedPathSplit(pszHardLink, &bLinkVolNum, &pszLinkLocalPath);
+        if(ret == 0)
+        {
+            ulLenMapped = ulLength;
+            ret = RedCoreFileReadMap(pHandle->ulInode, pHandle->ullOffset, &ulLenMapped, ppBuffer);
+        }
 
-            if((ret == 0) && (bVolNum != bLinkVolNum))
-            {
-                ret = -RED_EXDEV;
-            }
+        if(ret == 0)
+        {
+            REDASSERT(ulLenMapped <= ulLength);
 
-          #if REDCONF_VOLUME_COUNT > 1U
-            if(ret == 0)
-            {
-                ret = RedCoreVolSetCurrent(bVolNum);
-            }
-          #endif
+            pHandle->ullOffset += ulLenMapped;
+        }
 
-            if(ret == 0)
-            {
-                uint32_t    ulInode;
+        PosixLeave();
+    }
 
-                ret = RedPathLookup(pszLocalPath, &ulInode);
+    if(ret == 0)
+    {
+        iReturn = (int32_t)ulLenMapped;
+    }
+    else
+    {
+        iReturn = PosixReturn(ret);
+    }
 
-                if(ret == 0)
-                {
-                    const char *pszLinkName;
-                    uint32_t    ulLinkPInode;
+    return iReturn;
+}
 
-                    ret = RedPathToName(pszLinkLocalPath, &ulLinkPInode, &pszLinkName);
 
-                    if(ret == 0)
-                    {
-                        ret = RedCoreLink(ulLinkPInode, pszLinkName, ulInode);
-                    }
-                }
-            }
-        }
+/** @brief Release data mapped by red_read_map().
+
+    The file descriptor which the data was mapped from may already have been
+    closed, and its volume unmounted.
+
+    @param pBuffer  The pointer populated by red_read_map().
+
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EINVAL: @p pBuffer is not a pointer to outstanding mapped data.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_read_unmap(
+    const void *pBuffer)
+{
+    REDSTATUS   ret;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        ret = RedCoreFileReadUnmap(pBuffer);
 
         PosixLeave();
     }
 
     return PosixReturn(ret);
 }
-#endif
+#endif /* REDCONF_READ_MAP > 0U */
 
 
-/** @brief Close a file descriptor.
+#if REDCONF_READ_ONLY == 0
+/** @brief Write to an open file.
 
-    @param iFildes  The file descriptor to close.
+    The write takes place at the file offset associated with @p iFildes and
+    advances the file offset by the number of bytes actually written.
+    Alternatively, if @p iFildes was opened with #RED_O_APPEND, the file offset
+    is set to the end-of-file before the write begins, and likewise advances by
+    the number of bytes actually written.
 
-    @return On success, zero is returned.  On error, -1 is returned and
-            #red_errno is set appropriately.
+    A short write -- where the number of bytes written is less than requested
+    -- indicates either that the file system ran out of space but was still
+    able to write some of the request; or that the request would have caused
+    the file to exceed the maximum file size, but some of the data could be
+    written prior to the file size limit.
+
+    If an error is returned (-1), either none of the data was written or a
+    critical error occurred (like an I/O error) and the file system volume will
+    be read-only.
+
+    @param iFildes  The file descriptor to write to.
+    @param pBuffer  The buffer containing the data to be written.  Must be at
+                    least @p ulLength bytes in size.
+    @param ulLength Number of bytes to attempt to write.
+
+    @return On success, returns a nonnegative value indicating the number of
+            bytes actually written.  On error, -1 is returned and #red_errno is
+            set appropriately.
 
     <b>Errno values</b>
-    - #RED_EBADF: @p iFildes is not a valid file descriptor.
+    - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
+      for writing.  This includes the case where the file descriptor is for a
+      directory.
+    - #RED_EFBIG: No data can be written to the current file offset since the
+      resulting file size would exceed the maximum file size.
+    - #RED_EINVAL: @p pBuffer is `NULL`; or @p ulLength exceeds INT32_MAX and
+      cannot be returned properly.
     - #RED_EIO: A disk I/O error occurred.
+    - #RED_ENOSPC: No data can be written because there is insufficient free
+      space.
     - #RED_EUSERS: Cannot become a file system user: too many users.
 */
-int32_t red_close(
-    int32_t     iFildes)
+int32_t red_write(
+    int32_t     iFildes,
+    const void *pBuffer,
+    uint32_t    ulLength)
 {
+    uint32_t    ulLenWrote = 0U;
     REDSTATUS   ret;
+    int32_t     iReturn;
+
+    if(ulLength > (uint32_t)INT32_MAX)
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        ret = PosixEnter();
+    }
+
+    if(ret == 0)
+    {
+        REDHANDLE *pHandle;
+
+        ret = FildesToHandle(iFildes, FTYPE_FILE, &pHandle);
+        if(ret == -RED_EISDIR)
+        {
+            /*  POSIX says that if a file descriptor is not writable, the
+                errno should be -RED_EBADF.  Directory file descriptors are
+                never writable, and unlike for read(), the spec does not
+                list -RED_EISDIR as an allowed errno.  Therefore -RED_EBADF
+                takes precedence.
+            */
+            ret = -RED_EBADF;
+        }
+
+        if((ret == 0) && ((pHandle->bFlags & HFLAG_WRITEABLE) == 0U))
+        {
+            ret = -RED_EBADF;
+        }
+
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(pHandle->bVolNum);
+        }
+      #endif
+
+        if((ret == 0) && ((pHandle->bFlags & HFLAG_APPENDING) != 0U))
+        {
+            REDSTAT s;
+
+            ret = RedCoreStat(pHandle->ulInode, &s);
+            if(ret == 0)
+            {
+                pHandle->ullOffset = s.st_size;
+            }
+        }
+
+        if(ret == 0)
+        {
+            ulLenWrote = ulLength;
+            ret = RedCoreFileWrite(pHandle->ulInode, pHandle->ullOffset, &ulLenWrote, pBuffer);
+        }
+
+        if(ret == 0)
+        {
+            REDASSERT(ulLenWrote <= ulLength);
+
+            pHandle->ullOffset += ulLenWrote;
+        }
+
+        PosixLeave();
+    }
 
-    ret = PosixEnter();
     if(ret == 0)
     {
-        ret = FildesClose(iFildes);
-
-        PosixLeave();
+        iReturn = (int32_t)ulLenWrote;
+    }
+    else
+    {
+        iReturn = PosixReturn(ret);
     }
 
-    return PosixReturn(ret);
+    return iReturn;
 }
+#endif
 
 
-/** @brief Read from an open file.
+#if WRITEV_SUPPORTED
+/** @brief Write a scatter-gather list of buffers to an open file.
 
-    The read takes place at the file offset associated with @p iFildes and
-    advances the file offset by the number of bytes actually read.
+    Equivalent to a single red_write() of the concatenation of the buffers in
+    @p paIov: the whole list is written while holding the file system lock just
+    once, and if #RED_TRANSACT_WRITE is enabled, there is one automatic
+    transaction point after all of the buffers have been written, rather than
+    one for each buffer.  The write takes place at the file offset associated
+    with @p iFildes and advances the file offset by the number of bytes
+    actually written.  Alternatively, if @p iFildes was opened with
+    #RED_O_APPEND, the file offset is set to the end-of-file before the write
+    begins, and likewise advances by the number of bytes actually written.
 
-    Data which has not yet been written, but which is before the end-of-file
-    (sparse data), will read as zeroes.  A short read -- where the number of
-    bytes read is less than requested -- indicates that the requested read was
-    partially or, if zero bytes were read, entirely beyond the end-of-file.
+    A short write -- where the number of bytes written is less than the total
+    size of the buffers -- indicates either that the file system ran out of
+    space but was still able to write some of the request; or that the request
+    would have caused the file to exceed the maximum file size, but some of the
+    data could be written prior to the file size limit.
 
-    @param iFildes  The file descriptor from which to read.
-    @param pBuffer  The buffer to populate with data read.  Must be at least
-                    @p ulLength bytes in size.
-    @param ulLength Number of bytes to attempt to read.
+    If an error is returned (-1), either none of the data was written or a
+    critical error occurred (like an I/O error) and the file system volume will
+    be read-only.
+
+    @param iFildes      The file descriptor to write to.
+    @param paIov        The buffers containing the data to be written.
+    @param ulIovCount   The number of entries in @p paIov.
 
     @return On success, returns a nonnegative value indicating the number of
-            bytes actually read.  On error, -1 is returned and #red_errno is
+            bytes actually written.  On error, -1 is returned and #red_errno is
             set appropriately.
 
     <b>Errno values</b>
     - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
-      for reading.
-    - #RED_EINVAL: @p pBuffer is `NULL`; or @p ulLength exceeds INT32_MAX and
-      cannot be returned properly.
+      for writing.  This includes the case where the file descriptor is for a
+      directory.
+    - #RED_EFBIG: No data can be written to the current file offset since the
+      resulting file size would exceed the maximum file size.
+    - #RED_EINVAL: @p paIov is `NULL`; or @p ulIovCount is zero; or a buffer
+      with a nonzero length is `NULL`; or the total length of the buffers
+      exceeds INT32_MAX and cannot be returned properly.
     - #RED_EIO: A disk I/O error occurred.
-    - #RED_EISDIR: The @p iFildes is a file descriptor for a directory.
+    - #RED_ENOSPC: No data can be written because there is insufficient free
+      space.
     - #RED_EUSERS: Cannot become a file system user: too many users.
 */
-int32_t red_read(
-    int32_t     iFildes,
-    void       *pBuffer,
-    uint32_t    ulLength)
+int32_t red_writev(
+    int32_t         iFildes,
+    const REDIOVEC *paIov,
+    uint32_t        ulIovCount)
 {
-    uint32_t    ulLenRead = 0U;
-    REDSTATUS   ret;
-    int32_t     iReturn;
+    uint32_t        ulLength;
+    uint32_t        ulLenWrote = 0U;
+    REDSTATUS       ret;
+    int32_t         iReturn;
 
-    if(ulLength > (uint32_t)INT32_MAX)
-    {
-        ret = -RED_EINVAL;
-    }
-    else
+    ret = IovecLength(paIov, ulIovCount, &ulLength);
+
+    if(ret == 0)
     {
         ret = PosixEnter();
     }
 
     if(ret == 0)
     {
-        REDHANDLE  *pHandle;
+        REDHANDLE *pHandle;
 
         ret = FildesToHandle(iFildes, FTYPE_FILE, &pHandle);
+        if(ret == -RED_EISDIR)
+        {
+            /*  Same as red_write(): directory file descriptors are never
+                writable, so -RED_EBADF takes precedence.
+            */
+            ret = -RED_EBADF;
+        }
 
-        if((ret == 0) && ((pHandle->bFlags & HFLAG_READABLE) == 0U))
+        if((ret == 0) && ((pHandle->bFlags & HFLAG_WRITEABLE) == 0U))
         {
             ret = -RED_EBADF;
         }
@@ -1396,17 +2500,27 @@ int32_t red_read(
         }
       #endif
 
+        if((ret == 0) && ((pHandle->bFlags & HFLAG_APPENDING) != 0U))
+        {
+            REDSTAT s;
+
+            ret = RedCoreStat(pHandle->ulInode, &s);
+            if(ret == 0)
+            {
+                pHandle->ullOffset = s.st_size;
+            }
+        }
+
         if(ret == 0)
         {
-            ulLenRead = ulLength;
-            ret = RedCoreFileRead(pHandle->ulInode, pHandle->ullOffset, &ulLenRead, pBuffer);
+            ret = RedCoreFileWriteV(pHandle->ulInode, pHandle->ullOffset, paIov, ulIovCount, &ulLenWrote);
         }
 
         if(ret == 0)
         {
-            REDASSERT(ulLenRead <= ulLength);
+            REDASSERT(ulLenWrote <= ulLength);
 
-            pHandle->ullOffset += ulLenRead;
+            pHandle->ullOffset += ulLenWrote;
         }
 
         PosixLeave();
@@ -1414,7 +2528,7 @@ int32_t red_read(
 
     if(ret == 0)
     {
-        iReturn = (int32_t)ulLenRead;
+        iReturn = (int32_t)ulLenWrote;
     }
     else
     {
@@ -1423,55 +2537,61 @@ int32_t red_read(
 
     return iReturn;
 }
+#endif /* WRITEV_SUPPORTED */
 
 
-#if REDCONF_READ_ONLY == 0
-/** @brief Write to an open file.
+#if COPYFILE_SUPPORTED
+/** @brief Copy data from one open file to another.
 
-    The write takes place at the file offset associated with @p iFildes and
-    advances the file offset by the number of bytes actually written.
-    Alternatively, if @p iFildes was opened with #RED_O_APPEND, the file offset
-    is set to the end-of-file before the write begins, and likewise advances by
-    the number of bytes actually written.
+    The copy starts at the file offset associated with @p iSrcFildes and is
+    written at the file offset associated with @p iDstFildes (or, if
+    @p iDstFildes was opened with #RED_O_APPEND, at the end-of-file), and both
+    file offsets advance by the number of bytes actually copied.  The data is
+    copied within the file system, one block at a time, rather than being read
+    into and written from an application buffer.  Sparse regions of the source
+    file read as zeroes in the destination file.
 
-    A short write -- where the number of bytes written is less than requested
-    -- indicates either that the file system ran out of space but was still
-    able to write some of the request; or that the request would have caused
-    the file to exceed the maximum file size, but some of the data could be
-    written prior to the file size limit.
+    A short copy -- where the number of bytes copied is less than requested --
+    indicates that the end of the source file was reached (if zero bytes were
+    copied, the source file offset is at or beyond the end-of-file); or that
+    the destination file ran out of space or reached the maximum file size
+    after some of the data was copied.
 
-    If an error is returned (-1), either none of the data was written or a
+    If an error is returned (-1), either none of the data was copied or a
     critical error occurred (like an I/O error) and the file system volume will
     be read-only.
 
-    @param iFildes  The file descriptor to write to.
-    @param pBuffer  The buffer containing the data to be written.  Must be at
-                    least @p ulLength bytes in size.
-    @param ulLength Number of bytes to attempt to write.
+    @param iSrcFildes   The file descriptor to copy from.
+    @param iDstFildes   The file descriptor to copy to.
+    @param ulLength     Number of bytes to attempt to copy.
 
     @return On success, returns a nonnegative value indicating the number of
-            bytes actually written.  On error, -1 is returned and #red_errno is
+            bytes actually copied.  On error, -1 is returned and #red_errno is
             set appropriately.
 
     <b>Errno values</b>
-    - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
-      for writing.  This includes the case where the file descriptor is for a
-      directory.
-    - #RED_EFBIG: No data can be written to the current file offset since the
-      resulting file size would exceed the maximum file size.
-    - #RED_EINVAL: @p pBuffer is `NULL`; or @p ulLength exceeds INT32_MAX and
-      cannot be returned properly.
+    - #RED_EBADF: The @p iSrcFildes argument is not a valid file descriptor
+      open for reading; or the @p iDstFildes argument is not a valid file
+      descriptor open for writing.  This includes the case where
+      @p iDstFildes is a file descriptor for a directory.
+    - #RED_EFBIG: No data can be copied to the destination file offset since
+      the resulting file size would exceed the maximum file size.
+    - #RED_EINVAL: @p iSrcFildes and @p iDstFildes refer to the same file; or
+      @p ulLength exceeds INT32_MAX and cannot be returned properly.
     - #RED_EIO: A disk I/O error occurred.
-    - #RED_ENOSPC: No data can be written because there is insufficient free
+    - #RED_EISDIR: The @p iSrcFildes is a file descriptor for a directory.
+    - #RED_ENOSPC: No data can be copied because there is insufficient free
       space.
     - #RED_EUSERS: Cannot become a file system user: too many users.
+    - #RED_EXDEV: @p iSrcFildes and @p iDstFildes are on different file system
+      volumes.
 */
-int32_t red_write(
-    int32_t     iFildes,
-    const void *pBuffer,
+int32_t red_copyfile(
+    int32_t     iSrcFildes,
+    int32_t     iDstFildes,
     uint32_t    ulLength)
 {
-    uint32_t    ulLenWrote = 0U;
+    uint32_t    ulLenCopied = 0U;
     REDSTATUS   ret;
     int32_t     iReturn;
 
@@ -1486,54 +2606,78 @@ int32_t red_write(
 
     if(ret == 0)
     {
-        REDHANDLE *pHandle;
+        REDHANDLE  *pSrcHandle;
+        REDHANDLE  *pDstHandle = NULL;
 
-        ret = FildesToHandle(iFildes, FTYPE_FILE, &pHandle);
-        if(ret == -RED_EISDIR)
+        ret = FildesToHandle(iSrcFildes, FTYPE_FILE, &pSrcHandle);
+
+        if((ret == 0) && ((pSrcHandle->bFlags & HFLAG_READABLE) == 0U))
         {
-            /*  POSIX says that if a file descriptor is not writable, the
-                errno should be -RED_EBADF.  Directory file descriptors are
-                never writable, and unlike for read(), the spec does not
-                list -RED_EISDIR as an allowed errno.  Therefore -RED_EBADF
-                takes precedence.
-            */
             ret = -RED_EBADF;
         }
 
-        if((ret == 0) && ((pHandle->bFlags & HFLAG_WRITEABLE) == 0U))
+      #if SNAPSHOT_SUPPORTED
+        /*  The copy shares blocks with the working state of the source, so it
+            cannot be made from the snapshot.
+        */
+        if((ret == 0) && ((pSrcHandle->bFlags & HFLAG_SNAPSHOT) != 0U))
+        {
+            ret = -RED_EBADF;
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            ret = FildesToHandle(iDstFildes, FTYPE_FILE, &pDstHandle);
+            if(ret == -RED_EISDIR)
+            {
+                /*  Directory file descriptors are never writable, so as with
+                    red_write(), -RED_EBADF takes precedence.
+                */
+                ret = -RED_EBADF;
+            }
+        }
+
+        if((ret == 0) && ((pDstHandle->bFlags & HFLAG_WRITEABLE) == 0U))
         {
             ret = -RED_EBADF;
         }
 
       #if REDCONF_VOLUME_COUNT > 1U
+        if((ret == 0) && (pSrcHandle->bVolNum != pDstHandle->bVolNum))
+        {
+            ret = -RED_EXDEV;
+        }
+
         if(ret == 0)
         {
-            ret = RedCoreVolSetCurrent(pHandle->bVolNum);
+            ret = RedCoreVolSetCurrent(pSrcHandle->bVolNum);
         }
       #endif
 
-        if((ret == 0) && ((pHandle->bFlags & HFLAG_APPENDING) != 0U))
+        if((ret == 0) && ((pDstHandle->bFlags & HFLAG_APPENDING) != 0U))
         {
             REDSTAT s;
 
-            ret = RedCoreStat(pHandle->ulInode, &s);
+            ret = RedCoreStat(pDstHandle->ulInode, &s);
             if(ret == 0)
             {
-                pHandle->ullOffset = s.st_size;
+                pDstHandle->ullOffset = s.st_size;
             }
         }
 
         if(ret == 0)
         {
-            ulLenWrote = ulLength;
-            ret = RedCoreFileWrite(pHandle->ulInode, pHandle->ullOffset, &ulLenWrote, pBuffer);
+            ulLenCopied = ulLength;
+            ret = RedCoreFileCopy(pSrcHandle->ulInode, pSrcHandle->ullOffset, pDstHandle->ulInode, pDstHandle->ullOffset, &ulLenCopied);
         }
 
         if(ret == 0)
         {
-            REDASSERT(ulLenWrote <= ulLength);
+            REDASSERT(ulLenCopied <= ulLength);
 
-            pHandle->ullOffset += ulLenWrote;
+            pSrcHandle->ullOffset += ulLenCopied;
+            pDstHandle->ullOffset += ulLenCopied;
         }
 
         PosixLeave();
@@ -1541,7 +2685,7 @@ int32_t red_write(
 
     if(ret == 0)
     {
-        iReturn = (int32_t)ulLenWrote;
+        iReturn = (int32_t)ulLenCopied;
     }
     else
     {
@@ -1550,7 +2694,7 @@ int32_t red_write(
 
     return iReturn;
 }
-#endif
+#endif /* COPYFILE_SUPPORTED */
 
 
 #if REDCONF_READ_ONLY == 0
@@ -1713,7 +2857,17 @@ int64_t red_lseek(
                 {
                     REDSTAT s;
 
-                    ret = RedCoreStat(pHandle->ulInode, &s);
+                  #if SNAPSHOT_SUPPORTED
+                    if((pHandle->bFlags & HFLAG_SNAPSHOT) != 0U)
+                    {
+                        ret = RedCoreSnapStat(pHandle->ulInode, &s);
+                    }
+                    else
+                  #endif
+                    {
+                        ret = RedCoreStat(pHandle->ulInode, &s);
+                    }
+
                     if(ret == 0)
                     {
                         REDASSERT(s.st_size <= (uint64_t)INT64_MAX);
@@ -1848,6 +3002,89 @@ int32_t red_ftruncate(
 }
 #endif
 
+#if FALLOCATE_SUPPORTED
+/** @brief Allocate space for a range of a file in advance.
+
+    Sparse parts of the range from @p ullOffset to @p ullOffset + @p ullLen
+    are allocated and zeroed, and the file size is increased if the range
+    extends beyond the end-of-file.  Data already in the range is unchanged.
+    When enough contiguous free space exists, the new blocks are allocated as
+    one run.
+
+    Until the next transaction point, writes to the range overwrite the
+    allocated blocks in place and do not have to allocate blocks or metadata,
+    so they are faster and more predictable.  Reliance Edge never overwrites
+    committed data, so after a transaction point the first write to each
+    block allocates a new block, as usual.  This also means that, unlike
+    POSIX posix_fallocate(), allocating space now does not guarantee that
+    later writes will not fail with #RED_ENOSPC.
+
+    The value of the file offset is not modified by this function.  For
+    automatic transactions, this function is a #RED_TRANSACT_WRITE event.
+
+    @param iFildes      The file descriptor of the file.
+    @param ullOffset    The file offset at which the range starts.
+    @param ullLen       The length of the range, in bytes.
+
+    @return On success, zero is returned.  On error, -1 is returned and
+            #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
+      for writing.  This includes the case where the file descriptor is for a
+      directory.
+    - #RED_EFBIG: The range extends beyond the maximum file size.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_ENOSPC: Insufficient free space to allocate the range.  Part of the
+      range may have been allocated, and the file size may have been increased
+      to cover that part.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_fallocate(
+    int32_t     iFildes,
+    uint64_t    ullOffset,
+    uint64_t    ullLen)
+{
+    REDSTATUS   ret;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        REDHANDLE *pHandle;
+
+        ret = FildesToHandle(iFildes, FTYPE_FILE, &pHandle);
+        if(ret == -RED_EISDIR)
+        {
+            /*  Similar to red_write() (see comment there), the RED_EBADF error
+                for a non-writable file descriptor takes precedence.
+            */
+            ret = -RED_EBADF;
+        }
+
+        if((ret == 0) && ((pHandle->bFlags & HFLAG_WRITEABLE) == 0U))
+        {
+            ret = -RED_EBADF;
+        }
+
+      #if REDCONF_VOLUME_COUNT > 1U
+        if(ret == 0)
+        {
+            ret = RedCoreVolSetCurrent(pHandle->bVolNum);
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            ret = RedCoreFileAllocate(pHandle->ulInode, ullOffset, ullLen);
+        }
+
+        PosixLeave();
+    }
+
+    return PosixReturn(ret);
+}
+#endif /* FALLOCATE_SUPPORTED */
+
 
 /** @brief Get the status of a file or directory.
 
@@ -1888,18 +3125,83 @@ int32_t red_fstat(
 
         if(ret == 0)
         {
-            ret = RedCoreStat(pHandle->ulInode, pStat);
+          #if SNAPSHOT_SUPPORTED
+            if((pHandle->bFlags & HFLAG_SNAPSHOT) != 0U)
+            {
+                ret = RedCoreSnapStat(pHandle->ulInode, pStat);
+            }
+            else
+          #endif
+            {
+                ret = RedCoreStat(pHandle->ulInode, pStat);
+            }
+        }
+
+        PosixLeave();
+    }
+
+    return PosixReturn(ret);
+}
+
+
+#if REDCONF_API_POSIX_READDIR == 1
+/** @brief Open a directory stream for reading.
+
+    @param pszPath  The path of the directory to open.
+
+    @return On success, returns a pointer to a ::REDDIR object that can be used
+            with red_readdir() and red_closedir().  On error, returns `NULL`
+            and #red_errno is set appropriately.
+
+    <b>Errno values</b>
+    - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
+      not mounted.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_ENOENT: A component of @p pszPath does not exist; or the @p pszPath
+      argument, after removing the volume prefix, points to an empty string.
+    - #RED_ENOTDIR: A component of @p pszPath is a not a directory.
+    - #RED_EMFILE: There are no available file descriptors.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+REDDIR *red_opendir(
+    const char *pszPath)
+{
+    int32_t     iFildes;
+    REDSTATUS   ret;
+    REDDIR     *pDir = NULL;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        ret = FildesOpen(pszPath, RED_O_RDONLY, FTYPE_DIR, &iFildes);
+        if(ret == 0)
+        {
+            uint16_t uHandleIdx;
+
+            FildesUnpack(iFildes, &uHandleIdx, NULL, NULL);
+            pDir = &gaHandle[uHandleIdx];
         }
 
         PosixLeave();
     }
 
-    return PosixReturn(ret);
+    REDASSERT((pDir == NULL) == (ret != 0));
+
+    if(pDir == NULL)
+    {
+        red_errno = -ret;
+    }
+
+    return pDir;
 }
 
 
-#if REDCONF_API_POSIX_READDIR == 1
-/** @brief Open a directory stream for reading.
+#if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_SNAPSHOT == 1)
+/** @brief Open a directory stream for reading the snapshot.
+
+    Like red_opendir(), except that the directory, and the entries returned by
+    red_readdir(), are as they were when the snapshot was pinned by
+    red_snapshot().
 
     @param pszPath  The path of the directory to open.
 
@@ -1909,15 +3211,16 @@ int32_t red_fstat(
 
     <b>Errno values</b>
     - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
-      not mounted.
+      not mounted; or no snapshot is pinned on the volume.
     - #RED_EIO: A disk I/O error occurred.
-    - #RED_ENOENT: A component of @p pszPath does not exist; or the @p pszPath
-      argument, after removing the volume prefix, points to an empty string.
+    - #RED_ENOENT: A component of @p pszPath does not exist in the snapshot; or
+      the @p pszPath argument, after removing the volume prefix, points to an
+      empty string.
     - #RED_ENOTDIR: A component of @p pszPath is a not a directory.
     - #RED_EMFILE: There are no available file descriptors.
     - #RED_EUSERS: Cannot become a file system user: too many users.
 */
-REDDIR *red_opendir(
+REDDIR *red_snapshot_opendir(
     const char *pszPath)
 {
     int32_t     iFildes;
@@ -1927,7 +3230,7 @@ REDDIR *red_opendir(
     ret = PosixEnter();
     if(ret == 0)
     {
-        ret = FildesOpen(pszPath, RED_O_RDONLY, FTYPE_DIR, &iFildes);
+        ret = FildesOpen(pszPath, RED_O_RDONLY|RED_O_SNAPSHOT, FTYPE_DIR, &iFildes);
         if(ret == 0)
         {
             uint16_t uHandleIdx;
@@ -1948,6 +3251,7 @@ REDDIR *red_opendir(
 
     return pDir;
 }
+#endif
 
 
 /** @brief Read from a directory stream.
@@ -2011,7 +3315,16 @@ REDDIRENT *red_readdir(
             REDASSERT(pDirStream->ullOffset <= UINT32_MAX);
             ulDirPosition = (uint32_t)pDirStream->ullOffset;
 
-            ret = RedCoreDirRead(pDirStream->ulInode, &ulDirPosition, pDirStream->dirent.d_name, &pDirStream->dirent.d_ino);
+          #if SNAPSHOT_SUPPORTED
+            if((pDirStream->bFlags & HFLAG_SNAPSHOT) != 0U)
+            {
+                ret = RedCoreSnapDirRead(pDirStream->ulInode, &ulDirPosition, pDirStream->dirent.d_name, &pDirStream->dirent.d_ino);
+            }
+            else
+          #endif
+            {
+                ret = RedCoreDirRead(pDirStream->ulInode, &ulDirPosition, pDirStream->dirent.d_name, &pDirStream->dirent.d_ino);
+            }
 
             pDirStream->ullOffset = ulDirPosition;
 
@@ -2019,7 +3332,17 @@ REDDIRENT *red_readdir(
             {
                 /*  POSIX extension: return stat information with the dirent.
                 */
-                ret = RedCoreStat(pDirStream->dirent.d_ino, &pDirStream->dirent.d_stat);
+              #if SNAPSHOT_SUPPORTED
+                if((pDirStream->bFlags & HFLAG_SNAPSHOT) != 0U)
+                {
+                    ret = RedCoreSnapStat(pDirStream->dirent.d_ino, &pDirStream->dirent.d_stat);
+                }
+                else
+              #endif
+                {
+                    ret = RedCoreStat(pDirStream->dirent.d_ino, &pDirStream->dirent.d_stat);
+                }
+
                 if(ret == 0)
                 {
                     pDirEnt = &pDirStream->dirent;
@@ -2053,6 +3376,107 @@ REDDIRENT *red_readdir(
 }
 
 
+/** @brief Read several entries from a directory stream.
+
+    Equivalent to calling red_readdir() up to @p ulCount times and copying each
+    returned ::REDDIRENT into @p paDirEnt, except that the directory inode is
+    mounted only once for the whole batch, and the entries' status information
+    is only read if @p fStat is true.  Listing a large directory this way, with
+    a batch of a few dozen entries, avoids most of the per-entry overhead of
+    red_readdir().
+
+    Reads and red_readdir() calls on the same directory stream may be freely
+    mixed: both continue from where the previous read left off.
+
+    @param pDirStream   The directory stream to read from.
+    @param paDirEnt     The array of ::REDDIRENT structures to populate.
+    @param ulCount      The number of elements in @p paDirEnt.
+    @param fStat        Whether to populate the d_stat member of each entry.  If
+                        false, d_stat is left unmodified, and the entries can be
+                        listed without reading their inodes.
+
+    @return On success, returns the number of entries read, which is less than
+            @p ulCount only if the end of the directory was reached, and zero if
+            there were no more entries to read.  On error, -1 is returned and
+            #red_errno is set appropriately.  If an error occurs after one or
+            more entries have been read, those entries are returned and the
+            error is reported by the next call.
+
+    <b>Errno values</b>
+    - #RED_EBADF: @p pDirStream is not an open directory stream.
+    - #RED_EINVAL: @p paDirEnt is `NULL`; or @p ulCount is zero or exceeds
+      INT32_MAX.
+    - #RED_EIO: A disk I/O error occurred.
+    - #RED_EUSERS: Cannot become a file system user: too many users.
+*/
+int32_t red_readdir_batch(
+    REDDIR     *pDirStream,
+    REDDIRENT  *paDirEnt,
+    uint32_t    ulCount,
+    bool        fStat)
+{
+    REDSTATUS   ret;
+    uint32_t    ulEntries = 0U;
+    int32_t     iReturn;
+
+    ret = PosixEnter();
+    if(ret == 0)
+    {
+        if(!DirStreamIsValid(pDirStream))
+        {
+            ret = -RED_EBADF;
+        }
+        else if((paDirEnt == NULL) || (ulCount == 0U) || (ulCount > (uint32_t)INT32_MAX))
+        {
+            ret = -RED_EINVAL;
+        }
+      #if REDCONF_VOLUME_COUNT > 1U
+        else
+        {
+            ret = RedCoreVolSetCurrent(pDirStream->bVolNum);
+        }
+      #endif
+
+        if(ret == 0)
+        {
+            uint32_t ulDirPosition;
+
+            /*  The directory position is stored in the file offset; see
+                red_readdir().
+            */
+            REDASSERT(pDirStream->ullOffset <= UINT32_MAX);
+            ulDirPosition = (uint32_t)pDirStream->ullOffset;
+
+          #if SNAPSHOT_SUPPORTED
+            if((pDirStream->bFlags & HFLAG_SNAPSHOT) != 0U)
+            {
+                ret = RedCoreSnapDirReadBatch(pDirStream->ulInode, &ulDirPosition, paDirEnt, ulCount, fStat, &ulEntries);
+            }
+            else
+          #endif
+            {
+                ret = RedCoreDirReadBatch(pDirStream->ulInode, &ulDirPosition, paDirEnt, ulCount, fStat, &ulEntries);
+            }
+
+            pDirStream->ullOffset = ulDirPosition;
+        }
+
+        PosixLeave();
+    }
+
+    if(ret == 0)
+    {
+        iReturn = (int32_t)ulEntries;
+    }
+    else
+    {
+        iReturn = PosixReturn(ret);
+    }
+
+    return iReturn;
+}
+
+
 /** @brief Rewind a directory stream to read it from the beginning.
 
     Similar to closing the directory object and opening it again, but without
@@ -2172,18 +3596,14 @@ REDSTATUS *red_errnoptr(void)
 
         /*  If this task has used the file system before, it will already have
             a task slot, which includes the task-specific errno.
-        */
-        RedOsMutexAcquire();
-
-        for(ulIdx = 0U; ulIdx < REDCONF_TASK_COUNT; ulIdx++)
-        {
-            if(gaTask[ulIdx].ulTaskId == ulTaskId)
-            {
-                break;
-            }
-        }
 
-        RedOsMutexRelease();
+            The FS mutex is not needed for this search, so that reading errno
+            never waits for a file system operation in another task to finish.
+            A slot only ever changes from free to owned, and only the calling
+            task can claim a slot with its own ID, so concurrent registrations
+            by other tasks cannot change the outcome of the search.
+        */
+        ulIdx = TaskFind(ulTaskId);
 
         if(ulIdx == REDCONF_TASK_COUNT)
         {
@@ -2343,7 +3763,9 @@ static REDSTATUS UnlinkSub(
 
     @retval 0                   Operation was successful.
     @retval -RED_EINVAL         @p piFildes is `NULL`; or @p pszPath is `NULL`;
-                                or the volume is not mounted.
+                                or the volume is not mounted; or
+                                #RED_O_SNAPSHOT is set and no snapshot is
+                                pinned.
     @retval -RED_EMFILE         There are no available handles.
     @retval -RED_EEXIST         Using #RED_O_CREAT and #RED_O_EXCL, and the
                                 indicated path already exists.
@@ -2387,7 +3809,12 @@ static REDSTATUS FildesOpen(
         {
             ret = -RED_EINVAL;
         }
-      #if REDCONF_READ_ONLY == 0
+      #if SNAPSHOT_SUPPORTED
+        else if(gaRedVolume[bVolNum].fReadOnly && ((ulOpenMode & ~RED_O_SNAPSHOT) != RED_O_RDONLY))
+        {
+            ret = -RED_EROFS;
+        }
+      #elif REDCONF_READ_ONLY == 0
         else if(gaRedVolume[bVolNum].fReadOnly && (ulOpenMode != RED_O_RDONLY))
         {
             ret = -RED_EROFS;
@@ -2455,6 +3882,13 @@ static REDSTATUS FildesOpen(
                         }
                     }
                     else
+                  #endif
+                  #if SNAPSHOT_SUPPORTED
+                    if((ulOpenMode & RED_O_SNAPSHOT) != 0U)
+                    {
+                        ret = RedPathSnapLookup(pszLocalPath, &ulInode);
+                    }
+                    else
                   #endif
                     {
                         ret = RedPathLookup(pszLocalPath, &ulInode);
@@ -2472,7 +3906,17 @@ static REDSTATUS FildesOpen(
                     {
                         REDSTAT s;
 
-                        ret = RedCoreStat(ulInode, &s);
+                      #if SNAPSHOT_SUPPORTED
+                        if((ulOpenMode & RED_O_SNAPSHOT) != 0U)
+                        {
+                            ret = RedCoreSnapStat(ulInode, &s);
+                        }
+                        else
+                      #endif
+                        {
+                            ret = RedCoreStat(ulInode, &s);
+                        }
+
                         if(ret == 0)
                         {
                             uMode = s.st_mode;
@@ -2501,6 +3945,13 @@ static REDSTATUS FildesOpen(
                   #endif
                 }
 
+              #if (REDCONF_READ_ONLY == 0) && COMPRESSION_SUPPORTED
+                if((ret == 0) && ((ulOpenMode & RED_O_COMPRESS) != 0U) && ((uMode & RED_S_ICOMPR) == 0U))
+                {
+                    ret = RedCoreFileCompress(ulInode);
+                }
+              #endif
+
                 if(ret == 0)
                 {
                     int32_t iFildes;
@@ -2534,6 +3985,13 @@ static REDSTATUS FildesOpen(
                     }
                   #endif
 
+                  #if SNAPSHOT_SUPPORTED
+                    if((ulOpenMode & RED_O_SNAPSHOT) != 0U)
+                    {
+                        pHandle->bFlags |= HFLAG_SNAPSHOT;
+                    }
+                  #endif
+
                     iFildes = FildesPack(uHandleIdx, bVolNum);
                     if(iFildes == -1)
                     {
@@ -2593,7 +4051,27 @@ static REDSTATUS FildesClose(
 
         if((ret == 0) && ((ulTransMask & RED_TRANSACT_CLOSE) != 0U))
         {
-            ret = RedCoreVolTransact();
+          #if TRANSACT_TASK_SUPPORTED
+            if((ulTransMask & RED_TRANSACT_ASYNC) != 0U)
+            {
+                ret = RedCoreVolTransactAsync();
+            }
+            else
+          #endif
+            {
+                ret = RedCoreVolTransact();
+            }
+
+          #if SNAPSHOT_SUPPORTED
+            /*  While a snapshot is pinned, the transaction is deferred until
+                the snapshot is released; that is not a reason to fail the
+                close.
+            */
+            if(ret == -RED_EBUSY)
+            {
+                ret = 0;
+            }
+          #endif
         }
     }
   #endif
@@ -2829,6 +4307,64 @@ static bool DirStreamIsValid(
 #endif
 
 
+#if REDCONF_API_POSIX_VECTORIO == 1
+/** @brief Validate a scatter-gather list and compute its total length.
+
+    @param paIov        The scatter-gather list.
+    @param ulIovCount   The number of entries in @p paIov.
+    @param pulLength    On successful return, populated with the sum of the
+                        segment lengths.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p paIov is `NULL`; or @p ulIovCount is zero; or a
+                        segment with a nonzero length has a `NULL` buffer; or
+                        the total length exceeds INT32_MAX.
+*/
+static REDSTATUS IovecLength(
+    const REDIOVEC *paIov,
+    uint32_t        ulIovCount,
+    uint32_t       *pulLength)
+{
+    REDSTATUS       ret = 0;
+
+    if((paIov == NULL) || (ulIovCount == 0U) || (pulLength == NULL))
+    {
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        uint32_t ulTotal = 0U;
+        uint32_t ulIdx;
+
+        for(ulIdx = 0U; (ret == 0) && (ulIdx < ulIovCount); ulIdx++)
+        {
+            if((paIov[ulIdx].iov_base == NULL) && (paIov[ulIdx].iov_len > 0U))
+            {
+                ret = -RED_EINVAL;
+            }
+            else if(paIov[ulIdx].iov_len > ((uint32_t)INT32_MAX - ulTotal))
+            {
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                ulTotal += paIov[ulIdx].iov_len;
+            }
+        }
+
+        if(ret == 0)
+        {
+            *pulLength = ulTotal;
+        }
+    }
+
+    return ret;
+}
+#endif
+
+
 /** @brief Enter the file system driver.
 
     @return A negated ::REDSTATUS code indicating the operation result.
@@ -2959,7 +4495,15 @@ static REDSTATUS InodeUnlinkCheck(
     {
         for(uHandleIdx = 0U; uHandleIdx < REDCONF_HANDLE_COUNT; uHandleIdx++)
         {
+            /*  Snapshot handles read the committed copy of the inode, which is
+                unaffected by deleting it from the working state.
+            */
+          #if SNAPSHOT_SUPPORTED
+            if(    (gaHandle[uHandleIdx].ulInode == ulInode) && (gaHandle[uHandleIdx].bVolNum == gbRedVolNum)
+                && ((gaHandle[uHandleIdx].bFlags & HFLAG_SNAPSHOT) == 0U))
+          #else
             if((gaHandle[uHandleIdx].ulInode == ulInode) && (gaHandle[uHandleIdx].bVolNum == gbRedVolNum))
+          #endif
             {
                 ret = -RED_EBUSY;
                 break;
@@ -2973,6 +4517,51 @@ static REDSTATUS InodeUnlinkCheck(
 
 
 #if REDCONF_TASK_COUNT > 1U
+/** @brief Find the task slot owned by a task.
+
+    If #REDCONF_TASK_LOCAL is true, the slot is remembered in task-local
+    storage, so that it is usually found without searching.  The remembered
+    slot is only trusted if the task still owns it: it is stale if the driver
+    was uninitialized and initialized again since it was remembered.
+
+    @param ulTaskId The ID of the calling task, from RedOsTaskId().
+
+    @return The index of the task slot owned by the task, or
+            #REDCONF_TASK_COUNT if the task is not registered.
+*/
+static uint32_t TaskFind(
+    uint32_t        ulTaskId)
+{
+    uint32_t        ulIdx = REDCONF_TASK_COUNT;
+
+  #if REDCONF_TASK_LOCAL == 1
+    const TASKSLOT *pTask = RedOsTaskLocalGet();
+
+    if((pTask != NULL) && (pTask->ulTaskId == ulTaskId))
+    {
+        ulIdx = (uint32_t)(pTask - &gaTask[0U]);
+    }
+    else
+  #endif
+    {
+        /*  Scan the task slots.
+        */
+        for(ulIdx = 0U; (ulIdx < REDCONF_TASK_COUNT) && (gaTask[ulIdx].ulTaskId != ulTaskId); ulIdx++)
+        {
+        }
+
+      #if REDCONF_TASK_LOCAL == 1
+        if(ulIdx < REDCONF_TASK_COUNT)
+        {
+            RedOsTaskLocalSet(&gaTask[ulIdx]);
+        }
+      #endif
+    }
+
+    return ulIdx;
+}
+
+
 /** @brief Register a task as a file system user, if it is not already
            registered as one.
 
@@ -2992,33 +4581,24 @@ static REDSTATUS TaskRegister(
     uint32_t   *pulTaskIdx)
 {
     uint32_t    ulTaskId = RedOsTaskId();
-    uint32_t    ulFirstFreeIdx = REDCONF_TASK_COUNT;
     uint32_t    ulIdx;
     REDSTATUS   ret;
 
     REDASSERT(ulTaskId != 0U);
 
-    /*  Scan the task slots to determine if the task is registered as a file
-        system task.
+    /*  Determine if the task is registered as a file system task.
     */
-    for(ulIdx = 0U; ulIdx < REDCONF_TASK_COUNT; ulIdx++)
-    {
-        if(gaTask[ulIdx].ulTaskId == ulTaskId)
-        {
-            break;
-        }
-
-        if((ulFirstFreeIdx == REDCONF_TASK_COUNT) && (gaTask[ulIdx].ulTaskId == 0U))
-        {
-            ulFirstFreeIdx = ulIdx;
-        }
-    }
+    ulIdx = TaskFind(ulTaskId);
 
     if(ulIdx == REDCONF_TASK_COUNT)
     {
-        /*  Task not already registered.
+        /*  Task not already registered, so look for a free slot.
         */
-        if(ulFirstFreeIdx == REDCONF_TASK_COUNT)
+        for(ulIdx = 0U; (ulIdx < REDCONF_TASK_COUNT) && (gaTask[ulIdx].ulTaskId != 0U); ulIdx++)
+        {
+        }
+
+        if(ulIdx == REDCONF_TASK_COUNT)
         {
             /*  Cannot register task, no more slots.
             */
@@ -3028,8 +4608,12 @@ static REDSTATUS TaskRegister(
         {
             /*  Registering task.
             */
-            ulIdx = ulFirstFreeIdx;
             gaTask[ulIdx].ulTaskId = ulTaskId;
+
+          #if REDCONF_TASK_LOCAL == 1
+            RedOsTaskLocalSet(&gaTask[ulIdx]);
+          #endif
+
             ret = 0;
         }
     }
@@ -3084,5 +4668,52 @@ static int32_t PosixReturn(
 }
 
 
+#if TRANSACT_TASK_SUPPORTED
+/** @brief Body of the commit task, run each time it is signaled.
+
+    Commits the transaction points handed to the commit task, one volume at a
+    time, and delivers the completion notifications.  The FS mutex is held
+    while committing, but not while calling the notification functions.  The
+    commit task does not take a task slot, since it never needs an errno.
+*/
+static void TransactTask(void)
+{
+    uint8_t bVolNum;
+
+    for(bVolNum = 0U; bVolNum < REDCONF_VOLUME_COUNT; bVolNum++)
+    {
+        TRANSACTNOTIFY  notify;
+        REDSTATUS       ret;
+
+        RedOsMutexAcquire();
+
+        notify = gaTransactNotify[bVolNum];
+        gaTransactNotify[bVolNum].pfnDone = NULL;
+
+        if(!gfPosixInited)
+        {
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            ret = RedCoreVolSetCurrent(bVolNum);
+
+            if(ret == 0)
+            {
+                ret = RedCoreVolTransactAsyncCommit();
+            }
+        }
+
+        RedOsMutexRelease();
+
+        if(notify.pfnDone != NULL)
+        {
+            notify.pfnDone(-ret, notify.pContext);
+        }
+    }
+}
+#endif
+
+
 #endif /* REDCONF_API_POSIX == 1 */
 
@@ -0,0 +1,1166 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                   Copyright (c) 2014-2015 Datalight, Inc.
+                       All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license may obtain a commercial license
+    before incorporating Reliance Edge into proprietary software for
+    distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+    more information.
+*/
+/** @file
+    @brief File system throughput and latency benchmark.
+
+    Measures sequential and random read/write throughput and IOPS, small file
+    create and unlink rates, and the latency distribution of individual I/O,
+    create, unlink, and transaction point operations, using the POSIX-like
+    API.  All of the files used by the benchmark are kept in a
+    single directory of its own, so it leaves the rest of the volume alone and
+    several instances may be run at once by giving each a different directory.
+
+    Block size and buffer count are compile-time settings in Reliance Edge, so
+    comparing configurations means running the benchmark once per build.  For
+    repeatable numbers, run it on a freshly formatted volume and use the same
+    seed for each run.
+*/
+#include <redposix.h>
+#include <redtests.h>
+
+#if FSBENCH_SUPPORTED
+
+#include <redosserv.h>
+#include <redutils.h>
+#include <redmacs.h>
+#include <redvolume.h>
+#include <redgetopt.h>
+#include <redtoolcmn.h>
+
+
+/*  Size of the I/O buffer, which is the largest I/O size supported.
+*/
+#define FSBENCH_BUFFER_SIZE     (32U * 1024U)
+
+/*  Maximum number of latency samples kept for one test.  Tests with more
+    operations than this sample every Nth operation.
+*/
+#define FSBENCH_MAX_SAMPLES     1000U
+
+/*  Maximum length of the path of a benchmark file.
+*/
+#define FSBENCH_PATH_MAX        256U
+
+/*  Letters which may be given to the --tests option, in the order in which the
+    tests are run.
+*/
+#define FSBENCH_TESTS           "srft"
+
+
+static int32_t BenchRun(const FSBENCHPARAM *pParam);
+static int32_t BenchFileIo(const FSBENCHPARAM *pParam, bool fRandom, bool fWrite, bool fReport, uint64_t *pullSeed);
+static int32_t BenchSmallFiles(const FSBENCHPARAM *pParam);
+static int32_t BenchTransact(const FSBENCHPARAM *pParam, uint64_t *pullSeed);
+static int32_t BenchWriteAt(int32_t iFildes, uint64_t ullOffset, uint32_t ulLen);
+static void BenchPath(const FSBENCHPARAM *pParam, const char *pszName, char *pszPath);
+static uint32_t BenchSampleStride(uint32_t ulOps);
+static uint32_t BenchMicrosecs(REDTIMESTAMP tsStart);
+static void BenchPrintThroughput(const char *pszTest, uint64_t ullBytes, uint32_t ulOps, uint64_t ullMicrosecs);
+static void BenchPrintRate(const char *pszTest, uint32_t ulOps, uint64_t ullMicrosecs);
+static void BenchPrintLatency(const char *pszTest, uint32_t ulCount);
+static void BenchPrintError(const char *pszFunc, const char *pszPath);
+#if REDCONF_STATS == 1
+static void BenchStatsStart(const FSBENCHPARAM *pParam);
+static void BenchStatsPrint(const FSBENCHPARAM *pParam);
+#endif
+static void SortSamples(uint32_t *paulSamples, uint32_t ulCount);
+static void usage(const char *pszProgName);
+
+
+static uint8_t gabBuffer[FSBENCH_BUFFER_SIZE];
+static uint32_t gaulSamples[FSBENCH_MAX_SAMPLES];
+#if REDCONF_STATS == 1
+static REDIOSTATS gStatsStart;
+#endif
+
+
+/** @brief Parse parameters for fsbench.
+
+    @param argc         The number of arguments from main().
+    @param argv         The vector of arguments from main().
+    @param pParam       Populated with the fsbench parameters.
+    @param pbVolNum     If non-NULL, populated with the volume number.
+    @param ppszDevice   If non-NULL, populated with the device name argument or
+                        NULL if no device argument is provided.
+
+    @return The result of parsing the parameters.
+*/
+PARAMSTATUS FsbenchParseParams(
+    int             argc,
+    char           *argv[],
+    FSBENCHPARAM   *pParam,
+    uint8_t        *pbVolNum,
+    const char    **ppszDevice)
+{
+    int             c;
+    uint8_t         bVolNum;
+    const char     *pszTests = NULL;
+    const char     *pszEnd;
+    const REDOPTION aLongopts[] =
+    {
+        { "tests", red_required_argument, NULL, 't' },
+        { "size", red_required_argument, NULL, 's' },
+        { "io-size", red_required_argument, NULL, 'i' },
+        { "rand-ops", red_required_argument, NULL, 'r' },
+        { "files", red_required_argument, NULL, 'f' },
+        { "file-size", red_required_argument, NULL, 'z' },
+        { "transacts", red_required_argument, NULL, 'x' },
+        { "dir", red_required_argument, NULL, 'd' },
+        { "seed", red_required_argument, NULL, 'S' },
+        { "dev", red_required_argument, NULL, 'D' },
+        { "help", red_no_argument, NULL, 'H' },
+        { NULL }
+    };
+
+    /*  If run without parameters, treat as a help request.
+    */
+    if(argc <= 1)
+    {
+        goto Help;
+    }
+
+    /*  Assume no device argument to start with.
+    */
+    if(ppszDevice != NULL)
+    {
+        *ppszDevice = NULL;
+    }
+
+    /*  Set default parameters.
+    */
+    FsbenchDefaultParams(pParam);
+
+    while((c = RedGetoptLong(argc, argv, "t:s:i:r:f:z:x:d:S:D:H", aLongopts, NULL)) != -1)
+    {
+        switch(c)
+        {
+            case 't': /* --tests */
+                pszTests = red_optarg;
+                break;
+            case 's': /* --size */
+                pszEnd = RedSizeToUL(red_optarg, &pParam->ulFileSize);
+                if((pszEnd == NULL) || (*pszEnd != '\0'))
+                {
+                    RedPrintf("Invalid file size: %s\n", red_optarg);
+                    goto BadOpt;
+                }
+                break;
+            case 'i': /* --io-size */
+                pszEnd = RedSizeToUL(red_optarg, &pParam->ulIOSize);
+                if((pszEnd == NULL) || (*pszEnd != '\0'))
+                {
+                    RedPrintf("Invalid I/O size: %s\n", red_optarg);
+                    goto BadOpt;
+                }
+                break;
+            case 'r': /* --rand-ops */
+                pParam->ulRandOps = (uint32_t)RedAtoI(red_optarg);
+                break;
+            case 'f': /* --files */
+                pParam->ulFiles = (uint32_t)RedAtoI(red_optarg);
+                break;
+            case 'z': /* --file-size */
+                pszEnd = RedSizeToUL(red_optarg, &pParam->ulSmallFileSize);
+                if((pszEnd == NULL) || (*pszEnd != '\0'))
+                {
+                    RedPrintf("Invalid small file size: %s\n", red_optarg);
+                    goto BadOpt;
+                }
+                break;
+            case 'x': /* --transacts */
+                pParam->ulTransacts = (uint32_t)RedAtoI(red_optarg);
+                break;
+            case 'd': /* --dir */
+                pParam->pszDir = red_optarg;
+                break;
+            case 'S': /* --seed */
+                pszEnd = RedNtoULL(red_optarg, &pParam->ullSeed);
+                if((pszEnd == NULL) || (*pszEnd != '\0'))
+                {
+                    RedPrintf("Invalid seed: %s\n", red_optarg);
+                    goto BadOpt;
+                }
+                break;
+            case 'D': /* --dev */
+                if(ppszDevice != NULL)
+                {
+                    *ppszDevice = red_optarg;
+                }
+                break;
+            case 'H': /* --help */
+                goto Help;
+            case '?': /* Unknown or ambiguous option */
+            case ':': /* Option missing required argument */
+            default:
+                goto BadOpt;
+        }
+    }
+
+    if(pszTests != NULL)
+    {
+        uint32_t ulIdx;
+
+        pParam->fSequential = false;
+        pParam->fRandom = false;
+        pParam->fSmallFiles = false;
+        pParam->fTransact = false;
+
+        for(ulIdx = 0U; pszTests[ulIdx] != '\0'; ulIdx++)
+        {
+            switch(pszTests[ulIdx])
+            {
+                case 's':
+                    pParam->fSequential = true;
+                    break;
+                case 'r':
+                    pParam->fRandom = true;
+                    break;
+                case 'f':
+                    pParam->fSmallFiles = true;
+                    break;
+                case 't':
+                    pParam->fTransact = true;
+                    break;
+                default:
+                    RedPrintf("Invalid test letter '%c'; must be one of \"%s\"\n", pszTests[ulIdx], FSBENCH_TESTS);
+                    goto BadOpt;
+            }
+        }
+    }
+
+    if((pParam->ulIOSize == 0U) || (pParam->ulIOSize > FSBENCH_BUFFER_SIZE))
+    {
+        RedPrintf("I/O size must be from 1 to %u bytes\n", (unsigned)FSBENCH_BUFFER_SIZE);
+        goto BadOpt;
+    }
+
+    if(pParam->ulFileSize < pParam->ulIOSize)
+    {
+        RedPrintf("File size must be at least the I/O size\n");
+        goto BadOpt;
+    }
+
+    if(pParam->ulSmallFileSize > FSBENCH_BUFFER_SIZE)
+    {
+        RedPrintf("Small file size must be at most %u bytes\n", (unsigned)FSBENCH_BUFFER_SIZE);
+        goto BadOpt;
+    }
+
+    if((pParam->ulTransacts == 0U) || (pParam->ulTransacts > FSBENCH_MAX_SAMPLES))
+    {
+        RedPrintf("Transaction count must be from 1 to %u\n", (unsigned)FSBENCH_MAX_SAMPLES);
+        goto BadOpt;
+    }
+
+    /*  RedGetoptLong() has permuted argv to move all non-option arguments to
+        the end.  We expect to find a volume identifier.
+    */
+    if(red_optind >= argc)
+    {
+        RedPrintf("Missing volume argument\n");
+        goto BadOpt;
+    }
+
+    bVolNum = RedFindVolumeNumber(argv[red_optind]);
+    if(bVolNum == REDCONF_VOLUME_COUNT)
+    {
+        RedPrintf("Error: \"%s\" is not a valid volume identifier.\n", argv[red_optind]);
+        goto BadOpt;
+    }
+
+    pParam->pszVolume = gaRedVolConf[bVolNum].pszPathPrefix;
+
+    if(pbVolNum != NULL)
+    {
+        *pbVolNum = bVolNum;
+    }
+
+    red_optind++; /* Move past volume parameter. */
+    if(red_optind < argc)
+    {
+        int32_t ii;
+
+        for(ii = red_optind; ii < argc; ii++)
+        {
+            RedPrintf("Error: Unexpected command-line argument \"%s\".\n", argv[ii]);
+        }
+
+        goto BadOpt;
+    }
+
+    return PARAMSTATUS_OK;
+
+  BadOpt:
+
+    RedPrintf("%s - invalid parameters\n", argv[0U]);
+    usage(argv[0U]);
+    return PARAMSTATUS_BAD;
+
+  Help:
+
+    usage(argv[0U]);
+    return PARAMSTATUS_HELP;
+}
+
+
+/** @brief Set default fsbench parameters.
+
+    @param pParam   Populated with the default fsbench parameters.
+*/
+void FsbenchDefaultParams(
+    FSBENCHPARAM *pParam)
+{
+    RedMemSet(pParam, 0U, sizeof(*pParam));
+    pParam->pszVolume = gaRedVolConf[0U].pszPathPrefix;
+    pParam->pszDir = "fsbench";
+    pParam->fSequential = true;
+    pParam->fRandom = true;
+    pParam->fSmallFiles = true;
+    pParam->fTransact = true;
+    pParam->ulFileSize = 1024U * 1024U;
+    pParam->ulIOSize = 4096U;
+    pParam->ulRandOps = 256U;
+    pParam->ulFiles = 100U;
+    pParam->ulSmallFileSize = 512U;
+    pParam->ulTransacts = 100U;
+    pParam->ullSeed = 1U;
+}
+
+
+/** @brief Start fsbench.
+
+    The volume must already be mounted, and should have room for a file of
+    FSBENCHPARAM::ulFileSize bytes.  The benchmark directory must not exist.
+
+    @param pParam   fsbench parameters, either from FsbenchParseParams() or
+                    constructed programatically.
+
+    @return Zero on success, otherwise nonzero.
+*/
+int FsbenchStart(
+    const FSBENCHPARAM *pParam)
+{
+    int32_t     ret;
+    char        szPath[FSBENCH_PATH_MAX];
+    uint32_t    ulIdx;
+    uint64_t    ullFillSeed = pParam->ullSeed;
+
+    if((pParam->ulIOSize == 0U) || (pParam->ulIOSize > FSBENCH_BUFFER_SIZE) || (pParam->ulFileSize < pParam->ulIOSize)
+        || (pParam->ulSmallFileSize > FSBENCH_BUFFER_SIZE) || (pParam->ulTransacts == 0U) || (pParam->ulTransacts > FSBENCH_MAX_SAMPLES))
+    {
+        RedPrintf("fsbench: invalid parameters\n");
+        ret = -1;
+    }
+    else
+    {
+        ret = -RedOsTimestampInit();
+        if(ret != 0)
+        {
+            RedPrintf("fsbench: timestamp initialization failed with error %d\n", (int)-ret);
+        }
+    }
+
+    if(ret == 0)
+    {
+        RedPrintf("fsbench: volume \"%s\", block size %u, %u buffers, seed %llu\n", pParam->pszVolume,
+            (unsigned)REDCONF_BLOCK_SIZE, (unsigned)REDCONF_BUFFER_COUNT, (unsigned long long)pParam->ullSeed);
+        RedPrintf("fsbench: file size %u, I/O size %u\n", (unsigned)pParam->ulFileSize, (unsigned)pParam->ulIOSize);
+
+        /*  The data written is of no consequence, but random data keeps the
+            results honest on media which compresses or deduplicates.
+        */
+        for(ulIdx = 0U; ulIdx < FSBENCH_BUFFER_SIZE; ulIdx++)
+        {
+            gabBuffer[ulIdx] = (uint8_t)RedRand64(&ullFillSeed);
+        }
+
+        BenchPath(pParam, NULL, szPath);
+        ret = red_mkdir(szPath);
+        if(ret != 0)
+        {
+            BenchPrintError("red_mkdir", szPath);
+        }
+        else
+        {
+            ret = BenchRun(pParam);
+        }
+
+        (void)RedOsTimestampUninit();
+    }
+
+    return (ret == 0) ? 0 : 1;
+}
+
+
+/** @brief Run the selected tests in the benchmark directory, then remove it.
+
+    @param pParam   fsbench parameters.
+
+    @return Zero on success, otherwise -1.
+*/
+static int32_t BenchRun(
+    const FSBENCHPARAM *pParam)
+{
+    int32_t             ret = 0;
+    uint64_t            ullSeed = pParam->ullSeed;
+    bool                fNeedFile = pParam->fSequential || pParam->fRandom || pParam->fTransact;
+    char                szPath[FSBENCH_PATH_MAX];
+
+    /*  All of the file I/O tests work on the same file.  If the sequential
+        test is not selected, lay the file down without reporting on it, so
+        that the other tests have something to work with.
+    */
+    if(fNeedFile)
+    {
+        ret = BenchFileIo(pParam, false, true, pParam->fSequential, &ullSeed);
+    }
+
+    if((ret == 0) && pParam->fSequential)
+    {
+        ret = BenchFileIo(pParam, false, false, true, &ullSeed);
+    }
+
+    if((ret == 0) && pParam->fRandom)
+    {
+        ret = BenchFileIo(pParam, true, true, true, &ullSeed);
+
+        if(ret == 0)
+        {
+            ret = BenchFileIo(pParam, true, false, true, &ullSeed);
+        }
+    }
+
+    if((ret == 0) && pParam->fSmallFiles)
+    {
+        ret = BenchSmallFiles(pParam);
+    }
+
+    if((ret == 0) && pParam->fTransact)
+    {
+        ret = BenchTransact(pParam, &ullSeed);
+    }
+
+    /*  Clean up, even if a test failed.
+    */
+    if(fNeedFile)
+    {
+        BenchPath(pParam, "data", szPath);
+        (void)red_unlink(szPath);
+    }
+
+    BenchPath(pParam, NULL, szPath);
+    if((red_rmdir(szPath) != 0) && (ret == 0))
+    {
+        BenchPrintError("red_rmdir", szPath);
+        ret = -1;
+    }
+
+    if((red_transact(pParam->pszVolume) != 0) && (ret == 0))
+    {
+        BenchPrintError("red_transact", pParam->pszVolume);
+        ret = -1;
+    }
+
+    return ret;
+}
+
+
+/** @brief Time reads or writes of the benchmark data file.
+
+    Writes are followed by a red_fsync(), which is included in the throughput
+    time, so that the result reflects data which has made it to the media.  The
+    latency samples cover only the individual red_read() or red_write() calls
+    (and, for random I/O, the preceding seek).
+
+    @param pParam   fsbench parameters.
+    @param fRandom  Whether to do FSBENCHPARAM::ulRandOps I/O operations at
+                    random I/O-size-aligned offsets (true) or to read or write
+                    the whole file sequentially (false).
+    @param fWrite   Whether to write (true) or read (false).
+    @param fReport  Whether to print the result.
+    @param pullSeed Random number generator seed.
+
+    @return Zero on success, otherwise -1.
+*/
+static int32_t BenchFileIo(
+    const FSBENCHPARAM *pParam,
+    bool                fRandom,
+    bool                fWrite,
+    bool                fReport,
+    uint64_t           *pullSeed)
+{
+    char                szPath[FSBENCH_PATH_MAX];
+    int32_t             iFildes;
+    int32_t             ret = 0;
+    uint32_t            ulIOCount = pParam->ulFileSize / pParam->ulIOSize;
+    uint32_t            ulOps = fRandom ? pParam->ulRandOps : ulIOCount;
+    uint32_t            ulIdx;
+    uint32_t            ulStride = BenchSampleStride(ulOps);
+    uint32_t            ulSamples = 0U;
+    REDTIMESTAMP        tsStart;
+    uint64_t            ullMicrosecs;
+
+    BenchPath(pParam, "data", szPath);
+
+    if(fWrite && !fRandom)
+    {
+        iFildes = red_open(szPath, RED_O_RDWR | RED_O_CREAT | RED_O_TRUNC);
+    }
+    else
+    {
+        iFildes = red_open(szPath, fWrite ? RED_O_RDWR : RED_O_RDONLY);
+    }
+
+    if(iFildes < 0)
+    {
+        BenchPrintError("red_open", szPath);
+        ret = -1;
+    }
+    else
+    {
+      #if REDCONF_STATS == 1
+        BenchStatsStart(pParam);
+      #endif
+
+        tsStart = RedOsTimestamp();
+
+        for(ulIdx = 0U; ulIdx < ulOps; ulIdx++)
+        {
+            REDTIMESTAMP    tsOp = RedOsTimestamp();
+            int32_t         iLen;
+
+            if(fRandom && (red_lseek(iFildes, (int64_t)(RedRand64(pullSeed) % ulIOCount) * pParam->ulIOSize, RED_SEEK_SET) < 0))
+            {
+                BenchPrintError("red_lseek", szPath);
+                ret = -1;
+            }
+            else
+            {
+                if(fWrite)
+                {
+                    iLen = red_write(iFildes, gabBuffer, pParam->ulIOSize);
+                }
+                else
+                {
+                    iLen = red_read(iFildes, gabBuffer, pParam->ulIOSize);
+                }
+
+                if(iLen != (int32_t)pParam->ulIOSize)
+                {
+                    BenchPrintError(fWrite ? "red_write" : "red_read", szPath);
+                    ret = -1;
+                }
+            }
+
+            if(ret != 0)
+            {
+                ulOps = ulIdx;
+            }
+            else if((ulIdx % ulStride) == 0U)
+            {
+                gaulSamples[ulSamples] = BenchMicrosecs(tsOp);
+                ulSamples++;
+            }
+            else
+            {
+                /*  Not a sampled operation.
+                */
+            }
+        }
+
+        if((ret == 0) && fWrite && (red_fsync(iFildes) != 0))
+        {
+            BenchPrintError("red_fsync", szPath);
+            ret = -1;
+        }
+
+        ullMicrosecs = RedOsTimePassed(tsStart);
+
+        if((ret == 0) && fReport)
+        {
+            char szTest[32U];
+
+            RedSNPrintf(szTest, sizeof(szTest), "%s %s", fRandom ? "random" : "sequential", fWrite ? "write" : "read");
+            BenchPrintThroughput(szTest, (uint64_t)ulOps * pParam->ulIOSize, ulOps, ullMicrosecs);
+            BenchPrintLatency("", ulSamples);
+
+          #if REDCONF_STATS == 1
+            BenchStatsPrint(pParam);
+          #endif
+        }
+
+        if((red_close(iFildes) != 0) && (ret == 0))
+        {
+            BenchPrintError("red_close", szPath);
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Time the creation and deletion of many small files.
+
+    Each phase ends with a transaction point, which is included in the rate
+    but not in the latency samples.  A create sample covers the open, write,
+    and close of one file; an unlink sample covers one red_unlink().
+
+    @param pParam   fsbench parameters.
+
+    @return Zero on success, otherwise -1.
+*/
+static int32_t BenchSmallFiles(
+    const FSBENCHPARAM *pParam)
+{
+    char                szPath[FSBENCH_PATH_MAX];
+    int32_t             ret = 0;
+    uint32_t            ulCreated = 0U;
+    uint32_t            ulIdx;
+    uint32_t            ulStride = BenchSampleStride(pParam->ulFiles);
+    uint32_t            ulSamples = 0U;
+    REDTIMESTAMP        tsStart;
+    uint64_t            ullMicrosecs;
+
+  #if REDCONF_STATS == 1
+    BenchStatsStart(pParam);
+  #endif
+
+    tsStart = RedOsTimestamp();
+
+    while((ret == 0) && (ulCreated < pParam->ulFiles))
+    {
+        REDTIMESTAMP    tsOp;
+        int32_t         iFildes;
+        char            szName[16U];
+
+        RedSNPrintf(szName, sizeof(szName), "f%lu", (unsigned long)ulCreated);
+        BenchPath(pParam, szName, szPath);
+
+        tsOp = RedOsTimestamp();
+
+        iFildes = red_open(szPath, RED_O_WRONLY | RED_O_CREAT | RED_O_EXCL);
+        if(iFildes < 0)
+        {
+            BenchPrintError("red_open", szPath);
+            ret = -1;
+        }
+        else
+        {
+            ulCreated++;
+
+            if((pParam->ulSmallFileSize > 0U) && (red_write(iFildes, gabBuffer, pParam->ulSmallFileSize) != (int32_t)pParam->ulSmallFileSize))
+            {
+                BenchPrintError("red_write", szPath);
+                ret = -1;
+            }
+
+            if((red_close(iFildes) != 0) && (ret == 0))
+            {
+                BenchPrintError("red_close", szPath);
+                ret = -1;
+            }
+
+            if((ret == 0) && (((ulCreated - 1U) % ulStride) == 0U))
+            {
+                gaulSamples[ulSamples] = BenchMicrosecs(tsOp);
+                ulSamples++;
+            }
+        }
+    }
+
+    if((ret == 0) && (red_transact(pParam->pszVolume) != 0))
+    {
+        BenchPrintError("red_transact", pParam->pszVolume);
+        ret = -1;
+    }
+
+    ullMicrosecs = RedOsTimePassed(tsStart);
+
+    if(ret == 0)
+    {
+        BenchPrintRate("file create", ulCreated, ullMicrosecs);
+        BenchPrintLatency("", ulSamples);
+
+      #if REDCONF_STATS == 1
+        BenchStatsPrint(pParam);
+        BenchStatsStart(pParam);
+      #endif
+    }
+
+    ulStride = BenchSampleStride(ulCreated);
+    ulSamples = 0U;
+
+    /*  Delete whatever was created, even if the create phase failed.
+    */
+    tsStart = RedOsTimestamp();
+
+    for(ulIdx = 0U; ulIdx < ulCreated; ulIdx++)
+    {
+        REDTIMESTAMP    tsOp;
+        char            szName[16U];
+
+        RedSNPrintf(szName, sizeof(szName), "f%lu", (unsigned long)ulIdx);
+        BenchPath(pParam, szName, szPath);
+
+        tsOp = RedOsTimestamp();
+
+        if(red_unlink(szPath) != 0)
+        {
+            if(ret == 0)
+            {
+                BenchPrintError("red_unlink", szPath);
+                ret = -1;
+            }
+        }
+        else if((ulIdx % ulStride) == 0U)
+        {
+            gaulSamples[ulSamples] = BenchMicrosecs(tsOp);
+            ulSamples++;
+        }
+        else
+        {
+            /*  Not a sampled operation.
+            */
+        }
+    }
+
+    if((ret == 0) && (red_transact(pParam->pszVolume) != 0))
+    {
+        BenchPrintError("red_transact", pParam->pszVolume);
+        ret = -1;
+    }
+
+    ullMicrosecs = RedOsTimePassed(tsStart);
+
+    if(ret == 0)
+    {
+        BenchPrintRate("file unlink", ulCreated, ullMicrosecs);
+        BenchPrintLatency("", ulSamples);
+
+      #if REDCONF_STATS == 1
+        BenchStatsPrint(pParam);
+      #endif
+    }
+
+    return ret;
+}
+
+
+/** @brief Measure the latency of transaction points.
+
+    Before each transaction point, one I/O-size chunk of the data file is
+    rewritten at a random offset, so that every transaction has something to
+    commit.  Only the red_transact() call is timed.
+
+    @param pParam   fsbench parameters.
+    @param pullSeed Random number generator seed.
+
+    @return Zero on success, otherwise -1.
+*/
+static int32_t BenchTransact(
+    const FSBENCHPARAM *pParam,
+    uint64_t           *pullSeed)
+{
+    char                szPath[FSBENCH_PATH_MAX];
+    int32_t             iFildes;
+    int32_t             ret = 0;
+    uint32_t            ulIOCount = pParam->ulFileSize / pParam->ulIOSize;
+    uint32_t            ulCount = pParam->ulTransacts;
+    uint32_t            ulIdx;
+
+    BenchPath(pParam, "data", szPath);
+
+    iFildes = red_open(szPath, RED_O_RDWR);
+    if(iFildes < 0)
+    {
+        BenchPrintError("red_open", szPath);
+        ret = -1;
+    }
+    else
+    {
+      #if REDCONF_STATS == 1
+        BenchStatsStart(pParam);
+      #endif
+
+        for(ulIdx = 0U; ulIdx < ulCount; ulIdx++)
+        {
+            ret = BenchWriteAt(iFildes, (RedRand64(pullSeed) % ulIOCount) * pParam->ulIOSize, pParam->ulIOSize);
+
+            if(ret != 0)
+            {
+                BenchPrintError("red_write", szPath);
+            }
+            else
+            {
+                REDTIMESTAMP tsStart = RedOsTimestamp();
+
+                ret = red_transact(pParam->pszVolume);
+
+                if(ret != 0)
+                {
+                    BenchPrintError("red_transact", pParam->pszVolume);
+                }
+                else
+                {
+                    gaulSamples[ulIdx] = BenchMicrosecs(tsStart);
+                }
+            }
+
+            if(ret != 0)
+            {
+                ulCount = ulIdx;
+            }
+        }
+
+        if(ret == 0)
+        {
+            BenchPrintLatency("transaction latency", ulCount);
+
+          #if REDCONF_STATS == 1
+            BenchStatsPrint(pParam);
+          #endif
+        }
+
+        if((red_close(iFildes) != 0) && (ret == 0))
+        {
+            BenchPrintError("red_close", szPath);
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Write the start of the I/O buffer at a given file offset.
+
+    @param iFildes      File descriptor to write.
+    @param ullOffset    File offset to write at.
+    @param ulLen        Number of bytes to write.
+
+    @return Zero on success, otherwise -1.
+*/
+static int32_t BenchWriteAt(
+    int32_t     iFildes,
+    uint64_t    ullOffset,
+    uint32_t    ulLen)
+{
+    int32_t     ret = 0;
+
+    if(red_lseek(iFildes, (int64_t)ullOffset, RED_SEEK_SET) < 0)
+    {
+        ret = -1;
+    }
+    else if(red_write(iFildes, gabBuffer, ulLen) != (int32_t)ulLen)
+    {
+        ret = -1;
+    }
+    else
+    {
+        /*  Success.
+        */
+    }
+
+    return ret;
+}
+
+
+/** @brief Build the path of the benchmark directory or a file within it.
+
+    @param pParam   fsbench parameters.
+    @param pszName  Name of the file, or NULL for the directory itself.
+    @param pszPath  Populated with the path.  Must be FSBENCH_PATH_MAX bytes.
+*/
+static void BenchPath(
+    const FSBENCHPARAM *pParam,
+    const char         *pszName,
+    char               *pszPath)
+{
+    if(pszName == NULL)
+    {
+        RedSNPrintf(pszPath, FSBENCH_PATH_MAX, "%s%c%s", pParam->pszVolume, REDCONF_PATH_SEPARATOR, pParam->pszDir);
+    }
+    else
+    {
+        RedSNPrintf(pszPath, FSBENCH_PATH_MAX, "%s%c%s%c%s", pParam->pszVolume, REDCONF_PATH_SEPARATOR,
+            pParam->pszDir, REDCONF_PATH_SEPARATOR, pszName);
+    }
+}
+
+
+/** @brief Determine how often to sample the latency of a test's operations.
+
+    @param ulOps    Number of operations the test will do.
+
+    @return Sample every operation whose index is a multiple of this value.
+            Never zero, and never so small that more than FSBENCH_MAX_SAMPLES
+            samples are taken.
+*/
+static uint32_t BenchSampleStride(
+    uint32_t    ulOps)
+{
+    uint32_t    ulStride = (ulOps / FSBENCH_MAX_SAMPLES) + 1U;
+
+    return ulStride;
+}
+
+
+/** @brief Get the time passed since a timestamp, for use as a latency sample.
+
+    @param tsStart  Timestamp from the start of the operation.
+
+    @return Microseconds since @p tsStart, saturated to UINT32_MAX.
+*/
+static uint32_t BenchMicrosecs(
+    REDTIMESTAMP    tsStart)
+{
+    uint64_t        ullMicrosecs = RedOsTimePassed(tsStart);
+
+    return (ullMicrosecs > UINT32_MAX) ? UINT32_MAX : (uint32_t)ullMicrosecs;
+}
+
+
+/** @brief Print a throughput result.
+
+    @param pszTest      Name of the test.
+    @param ullBytes     Number of bytes transferred.
+    @param ulOps        Number of I/O operations.
+    @param ullMicrosecs Elapsed time, in microseconds.
+*/
+static void BenchPrintThroughput(
+    const char *pszTest,
+    uint64_t    ullBytes,
+    uint32_t    ulOps,
+    uint64_t    ullMicrosecs)
+{
+    char        szMBPerSec[16U];
+    uint64_t    ullKBPerSec = 0U;
+    uint64_t    ullIOPS = 0U;
+
+    if(ullMicrosecs > 0U)
+    {
+        ullKBPerSec = RedMulDiv64(ullBytes, 1000000U, ullMicrosecs * 1024U);
+        ullIOPS = RedMulDiv64(ulOps, 1000000U, ullMicrosecs);
+    }
+
+    RedPrintf("%-20s %llu bytes in %llu us: %s MB/s, %llu IOPS\n", pszTest, (unsigned long long)ullBytes,
+        (unsigned long long)ullMicrosecs, RedRatio(szMBPerSec, sizeof(szMBPerSec), ullKBPerSec, 1024U, 2U),
+        (unsigned long long)ullIOPS);
+}
+
+
+/** @brief Print an operation rate result.
+
+    @param pszTest      Name of the test.
+    @param ulOps        Number of operations.
+    @param ullMicrosecs Elapsed time, in microseconds.
+*/
+static void BenchPrintRate(
+    const char *pszTest,
+    uint32_t    ulOps,
+    uint64_t    ullMicrosecs)
+{
+    uint64_t    ullPerSec = 0U;
+
+    if(ullMicrosecs > 0U)
+    {
+        ullPerSec = RedMulDiv64(ulOps, 1000000U, ullMicrosecs);
+    }
+
+    RedPrintf("%-20s %u files in %llu us: %llu files/s\n", pszTest, (unsigned)ulOps,
+        (unsigned long long)ullMicrosecs, (unsigned long long)ullPerSec);
+}
+
+
+/** @brief Sort and print the latency samples in gaulSamples.
+
+    @param pszTest  Name of the test, or an empty string when continuing the
+                    output of a test whose name has already been printed.
+    @param ulCount  The number of samples.
+*/
+static void BenchPrintLatency(
+    const char *pszTest,
+    uint32_t    ulCount)
+{
+    if(ulCount > 0U)
+    {
+        uint64_t ullTotal = 0U;
+        uint32_t ulIdx;
+
+        SortSamples(gaulSamples, ulCount);
+
+        for(ulIdx = 0U; ulIdx < ulCount; ulIdx++)
+        {
+            ullTotal += gaulSamples[ulIdx];
+        }
+
+        RedPrintf("%-20s %u samples, mean %llu us\n", pszTest, (unsigned)ulCount,
+            (unsigned long long)(ullTotal / ulCount));
+        RedPrintf("%-20s min %u  p50 %u  p90 %u  p99 %u  max %u us\n", "",
+            (unsigned)gaulSamples[0U],
+            (unsigned)gaulSamples[((ulCount - 1U) * 50U) / 100U],
+            (unsigned)gaulSamples[((ulCount - 1U) * 90U) / 100U],
+            (unsigned)gaulSamples[((ulCount - 1U) * 99U) / 100U],
+            (unsigned)gaulSamples[ulCount - 1U]);
+    }
+}
+
+
+/** @brief Print a message for a failed POSIX-like API call.
+
+    @param pszFunc  Name of the function which failed.
+    @param pszPath  Path or volume which was being accessed.
+*/
+static void BenchPrintError(
+    const char *pszFunc,
+    const char *pszPath)
+{
+    RedPrintf("fsbench: %s(\"%s\") failed with errno %d\n", pszFunc, pszPath, (int)red_errno);
+}
+
+
+#if REDCONF_STATS == 1
+/** @brief Record the I/O statistics at the start of a test.
+
+    @param pParam   fsbench parameters.
+*/
+static void BenchStatsStart(
+    const FSBENCHPARAM *pParam)
+{
+    if(red_getstats(pParam->pszVolume, &gStatsStart) != 0)
+    {
+        RedMemSet(&gStatsStart, 0U, sizeof(gStatsStart));
+    }
+}
+
+
+/** @brief Print the I/O done since BenchStatsStart().
+
+    @param pParam   fsbench parameters.
+*/
+static void BenchStatsPrint(
+    const FSBENCHPARAM *pParam)
+{
+    REDIOSTATS stats;
+
+    if(red_getstats(pParam->pszVolume, &stats) == 0)
+    {
+        char szHitPct[16U];
+
+        RedPrintf("%-20s dev reads %llu (%llu blocks), writes %llu (%llu blocks), flushes %llu; buffer hits %s%%\n", "",
+            (unsigned long long)(stats.ullDevReads - gStatsStart.ullDevReads),
+            (unsigned long long)(stats.ullDevReadBlocks - gStatsStart.ullDevReadBlocks),
+            (unsigned long long)(stats.ullDevWrites - gStatsStart.ullDevWrites),
+            (unsigned long long)(stats.ullDevWriteBlocks - gStatsStart.ullDevWriteBlocks),
+            (unsigned long long)(stats.ullDevFlushes - gStatsStart.ullDevFlushes),
+            RedRatio(szHitPct, sizeof(szHitPct), (stats.ullBufferHits - gStatsStart.ullBufferHits) * 100U,
+                stats.ullBufferGets - gStatsStart.ullBufferGets, 1U));
+    }
+}
+#endif
+
+
+/** @brief Sort latency samples in ascending order.
+
+    An insertion sort is plenty for the number of samples involved.
+
+    @param paulSamples  The samples to sort.
+    @param ulCount      The number of samples.
+*/
+static void SortSamples(
+    uint32_t   *paulSamples,
+    uint32_t    ulCount)
+{
+    uint32_t    ulIdx;
+
+    for(ulIdx = 1U; ulIdx < ulCount; ulIdx++)
+    {
+        uint32_t ulSample = paulSamples[ulIdx];
+        uint32_t ulPos = ulIdx;
+
+        while((ulPos > 0U) && (paulSamples[ulPos - 1U] > ulSample))
+        {
+            paulSamples[ulPos] = paulSamples[ulPos - 1U];
+            ulPos--;
+        }
+
+        paulSamples[ulPos] = ulSample;
+    }
+}
+
+
+/** @brief Print usage information.
+
+    @param pszProgName  Name of the program, from argv[0].
+*/
+static void usage(
+    const char *pszProgName)
+{
+    RedPrintf("usage: %s VolumeID [Options]\n", pszProgName);
+    RedPrintf("File system throughput and latency benchmark.\n\n");
+    RedPrintf("Where:\n");
+    RedPrintf("  VolumeID\n");
+    RedPrintf("      A volume number (e.g., 2) or a volume path prefix (e.g., VOL1: or /data)\n");
+    RedPrintf("      of the volume to test.\n");
+    RedPrintf("And 'Options' are any of the following:\n");
+    RedPrintf("  --tests=list, -t list\n");
+    RedPrintf("      Specifies which tests to run, as a string of letters: s (sequential\n");
+    RedPrintf("      read/write), r (random read/write), f (small file create/unlink), and\n");
+    RedPrintf("      t (transaction latency).  Default \"%s\".\n", FSBENCH_TESTS);
+    RedPrintf("  --size=size, -s size\n");
+    RedPrintf("      Specifies the size of the data file, in KB unless a B or MB suffix is\n");
+    RedPrintf("      used (default 1MB).\n");
+    RedPrintf("  --io-size=size, -i size\n");
+    RedPrintf("      Specifies the size of each read and write, in KB unless a B or MB suffix\n");
+    RedPrintf("      is used (default 4KB, maximum %uKB).\n", (unsigned)(FSBENCH_BUFFER_SIZE / 1024U));
+    RedPrintf("  --rand-ops=count, -r count\n");
+    RedPrintf("      Specifies the number of random reads and of random writes (default 256).\n");
+    RedPrintf("  --files=count, -f count\n");
+    RedPrintf("      Specifies the number of small files to create and unlink (default 100).\n");
+    RedPrintf("  --file-size=size, -z size\n");
+    RedPrintf("      Specifies the size of each small file, in KB unless a B or MB suffix is\n");
+    RedPrintf("      used (default 512B).\n");
+    RedPrintf("  --transacts=count, -x count\n");
+    RedPrintf("      Specifies the number of transaction latency samples (default 100,\n");
+    RedPrintf("      maximum %u).\n", (unsigned)FSBENCH_MAX_SAMPLES);
+    RedPrintf("  --dir=name, -d name\n");
+    RedPrintf("      Specifies the name of the directory, in the volume root, which holds the\n");
+    RedPrintf("      benchmark files.  It must not already exist.  Default \"fsbench\".\n");
+    RedPrintf("  --seed=value, -S value\n");
+    RedPrintf("      Specifies the seed for the random number generator (default 1).\n");
+    RedPrintf("  --dev=devname, -D devname\n");
+    RedPrintf("      Specifies the device name.  This is typically only meaningful when\n");
+    RedPrintf("      running the test on a host machine.  This can be \"ram\" to test on a RAM\n");
+    RedPrintf("      disk, the path and name of a file disk (e.g., red.bin); or an OS-specific\n");
+    RedPrintf("      reference to a device (on Windows, a drive letter like G: or a device name\n");
+    RedPrintf("      like \\\\.\\PhysicalDrive7).\n");
+    RedPrintf("  --help, -H\n");
+    RedPrintf("      Prints this usage text and exits.\n\n");
+}
+
+
+#endif /* FSBENCH_SUPPORTED */
+
@@ -39,6 +39,17 @@
 #define CRC_BITWISE     (0U)
 #define CRC_SARWATE     (1U)
 #define CRC_SLICEBY8    (2U)
+#define CRC_ARMV8       (3U)
+
+
+static uint32_t Crc32Software(uint32_t ulInitCrc32, const void *pBuffer, uint32_t ulLength);
+
+
+#if REDCONF_CRC_HOOK == 1
+/*  Optional CRC implementation registered at run time; see RedCrc32SetHook().
+*/
+static REDCRC32HOOK gpfnCrc32Hook = NULL;
+#endif
 
 
 #if REDCONF_CRC_ALGORITHM == CRC_BITWISE
@@ -65,7 +76,7 @@
 
     @return The updated CRC value.
 */
-uint32_t RedCrc32Update(
+static uint32_t Crc32Software(
     uint32_t    ulInitCrc32,
     const void *pBuffer,
     uint32_t    ulLength)
@@ -117,7 +128,7 @@ uint32_t RedCrc32Update(
 
     @return The updated CRC value.
 */
-uint32_t RedCrc32Update(
+static uint32_t Crc32Software(
     uint32_t    ulInitCrc32,
     const void *pBuffer,
     uint32_t    ulLength)
@@ -197,7 +208,7 @@ uint32_t RedCrc32Update(
 
     @return The updated CRC value.
 */
-uint32_t RedCrc32Update(
+static uint32_t Crc32Software(
     uint32_t    ulInitCrc32,
     const void *pBuffer,
     uint32_t    ulLength)
@@ -558,10 +569,152 @@ uint32_t RedCrc32Update(
     return ulCrc32;
 }
 
+#elif REDCONF_CRC_ALGORITHM == CRC_ARMV8
+
+#include <arm_acle.h>
+
+#ifndef __ARM_FEATURE_CRC32
+#error "CRC_ARMV8 requires a target with the ARMv8 CRC32 instructions"
+#endif
+
+
+/** @brief Compute a CRC32 for the given data buffer.
+
+    Uses the ARMv8 CRC32 instructions, which implement the same (reflected)
+    CCITT-32 polynomial as the table-driven algorithms, so the results are
+    identical and volumes remain compatible.
+
+    For CCITT-32 compliance, the initial CRC must be set to 0.  To CRC multiple
+    buffers, call this function with the previously returned CRC value.
+
+    @param ulInitCrc32  Starting CRC value.
+    @param pBuffer      Data buffer to calculate the CRC from.
+    @param ulLength     Number of bytes of data in the given buffer.
+
+    @return The updated CRC value.
+*/
+static uint32_t Crc32Software(
+    uint32_t    ulInitCrc32,
+    const void *pBuffer,
+    uint32_t    ulLength)
+{
+    uint32_t    ulCrc32;
+
+    if(pBuffer == NULL)
+    {
+        REDERROR();
+        ulCrc32 = SUSPICIOUS_CRC_VALUE;
+    }
+    else
+    {
+        const uint8_t  *pbBuffer = CAST_VOID_PTR_TO_CONST_UINT8_PTR(pBuffer);
+        uint32_t        ulIdx = 0U;
+
+        ulCrc32 = ~ulInitCrc32;
+
+        /*  Handle the unaligned initial bytes (if any) one at a time, so that
+            the word loads below are aligned.
+        */
+        while((ulIdx < ulLength) && !IS_ALIGNED_PTR(&pbBuffer[ulIdx]))
+        {
+            ulCrc32 = __crc32b(ulCrc32, pbBuffer[ulIdx]);
+            ulIdx++;
+        }
+
+        while((ulLength - ulIdx) >= 4U)
+        {
+          #if REDCONF_ENDIAN_BIG == 1
+            uint32_t ulWord = pbBuffer[ulIdx] | ((uint32_t)pbBuffer[ulIdx+1U] << 8U) |
+                              ((uint32_t)pbBuffer[ulIdx+2U] << 16U) | ((uint32_t)pbBuffer[ulIdx+3U] << 24U);
+          #else
+            uint32_t ulWord = *CAST_CONST_UINT32_PTR(&pbBuffer[ulIdx]);
+          #endif
+
+            ulCrc32 = __crc32w(ulCrc32, ulWord);
+            ulIdx += 4U;
+        }
+
+        while(ulIdx < ulLength)
+        {
+            ulCrc32 = __crc32b(ulCrc32, pbBuffer[ulIdx]);
+            ulIdx++;
+        }
+
+        ulCrc32 = ~ulCrc32;
+    }
+
+    return ulCrc32;
+}
+
 #else
 
-#error "REDCONF_CRC_ALGORITHM must be set to CRC_BITWISE, CRC_SARWATE, or CRC_SLICEBY8"
+#error "REDCONF_CRC_ALGORITHM must be set to CRC_BITWISE, CRC_SARWATE, CRC_SLICEBY8, or CRC_ARMV8"
+
+#endif
+
+
+/** @brief Compute a CRC32 for the given data buffer.
+
+    For CCITT-32 compliance, the initial CRC must be set to 0.  To CRC multiple
+    buffers, call this function with the previously returned CRC value.
+
+    The algorithm selected by REDCONF_CRC_ALGORITHM is used, unless a hook has
+    been registered with RedCrc32SetHook().
+
+    @param ulInitCrc32  Starting CRC value.
+    @param pBuffer      Data buffer to calculate the CRC from.
+    @param ulLength     Number of bytes of data in the given buffer.
 
+    @return The updated CRC value.
+*/
+uint32_t RedCrc32Update(
+    uint32_t    ulInitCrc32,
+    const void *pBuffer,
+    uint32_t    ulLength)
+{
+    uint32_t    ulCrc32;
+
+  #if REDCONF_CRC_HOOK == 1
+    REDCRC32HOOK pfnHook = gpfnCrc32Hook;
+
+    if((pfnHook != NULL) && (pBuffer != NULL))
+    {
+        ulCrc32 = pfnHook(ulInitCrc32, pBuffer, ulLength);
+    }
+    else
+  #endif
+    {
+        ulCrc32 = Crc32Software(ulInitCrc32, pBuffer, ulLength);
+    }
+
+    return ulCrc32;
+}
+
+
+#if REDCONF_CRC_HOOK == 1
+/** @brief Register a CRC32 implementation to use instead of the software one.
+
+    This allows a CRC peripheral (for example, the STM32 CRC unit) to be used,
+    and allows the choice to be made at run time, such as after probing the
+    hardware.  The hook must produce exactly the same results as
+    RedCrc32Update() does without it: the reflected CCITT-32 polynomial, with
+    the CRC inverted on input and output, and with @p ulInitCrc32 used to chain
+    calls.  For the STM32 CRC unit, this means enabling the input (byte) and
+    output bit reversal and loading the initial value register with the
+    inverted @p ulInitCrc32.  If the peripheral is shared with other software,
+    the hook is responsible for serializing access to it.
+
+    The hook should be registered before the file system is initialized, or
+    while no file system operation is in progress.
+
+    @param pfnHook  The CRC32 implementation to use; or `NULL` to revert to the
+                    algorithm selected by REDCONF_CRC_ALGORITHM.
+*/
+void RedCrc32SetHook(
+    REDCRC32HOOK    pfnHook)
+{
+    gpfnCrc32Hook = pfnHook;
+}
 #endif
 
 
@@ -0,0 +1,421 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                   Copyright (c) 2014-2015 Datalight, Inc.
+                       All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license may obtain a commercial license
+    before incorporating Reliance Edge into proprietary software for
+    distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+    more information.
+*/
+/** @file
+    @brief Implements a small LZ77-class compressor for file data.
+
+    The format is a sequence of records, each of which is a token byte, the
+    literal bytes, and a back reference.  The high nibble of the token is the
+    number of literals and the low nibble is the match length minus
+    LZ_MIN_MATCH; a nibble of 15 is followed by extension bytes which are added
+    to it, the last of which is less than 255.  The back reference is a two
+    byte little-endian offset, which is followed by the match length extension
+    bytes, if any.  The last record has only literals, and the stream ends
+    after them.
+
+    The compressor is greedy and keeps a single hash table of recent
+    positions, so it trades some compression ratio for speed and a small,
+    fixed amount of memory.  The decompressor checks every length and offset
+    against the buffers, so a corrupt stream fails rather than overrunning.
+*/
+#include <redfs.h>
+
+#if REDCONF_COMPRESSION == 1
+
+
+#define LZ_MIN_MATCH    (4U)
+#define LZ_HASH_BITS    (10U)
+#define LZ_HASH_ENTRIES (1U << LZ_HASH_BITS)
+#define LZ_MAX_OFFSET   (0xFFFFU)
+#define LZ_NIBBLE_MAX   (15U)
+
+
+static uint32_t LzRead32(const uint8_t *pbData);
+static uint32_t LzHash(uint32_t ulValue);
+static bool LzPutRecord(uint8_t *pbDst, uint32_t ulDstMax, uint32_t *pulOut, const uint8_t *pbLiterals, uint32_t ulLitLen, uint32_t ulOffset, uint32_t ulMatchLen);
+static bool LzPutLength(uint8_t *pbDst, uint32_t ulDstMax, uint32_t *pulOut, uint32_t ulLen);
+static bool LzGetLength(const uint8_t *pbSrc, uint32_t ulSrcLen, uint32_t *pulIn, uint32_t *pulLen);
+
+
+/*  Position of the most recent occurrence of each hashed four byte sequence.
+    Only one compression runs at a time, since the core holds the file system
+    lock, so one table is shared.
+*/
+static uint16_t gauHashTable[LZ_HASH_ENTRIES];
+
+
+/** @brief Compress a buffer.
+
+    @param pbSrc    The data to compress.
+    @param ulSrcLen The length of @p pbSrc, which may be at most 64 KB.
+    @param pbDst    The buffer to compress into.
+    @param ulDstMax The size of @p pbDst.
+
+    @return The length of the compressed data, or zero if it would not fit in
+            @p ulDstMax bytes.
+*/
+uint32_t RedLzCompress(
+    const uint8_t  *pbSrc,
+    uint32_t        ulSrcLen,
+    uint8_t        *pbDst,
+    uint32_t        ulDstMax)
+{
+    uint32_t        ulOut = 0U;
+
+    if((pbSrc == NULL) || (pbDst == NULL) || (ulSrcLen > (LZ_MAX_OFFSET + 1U)))
+    {
+        REDERROR();
+    }
+    else
+    {
+        uint32_t    ulPos = 0U;
+        uint32_t    ulAnchor = 0U;
+        bool        fFits = true;
+
+        RedMemSet(gauHashTable, 0U, sizeof(gauHashTable));
+
+        while(fFits && ((ulSrcLen - ulPos) >= LZ_MIN_MATCH))
+        {
+            uint32_t ulHash = LzHash(LzRead32(&pbSrc[ulPos]));
+            uint32_t ulCand = gauHashTable[ulHash];
+
+            gauHashTable[ulHash] = (uint16_t)ulPos;
+
+            /*  Every candidate is verified, so a stale or empty table entry
+                only costs a comparison.
+            */
+            if((ulCand < ulPos) && (LzRead32(&pbSrc[ulCand]) == LzRead32(&pbSrc[ulPos])))
+            {
+                uint32_t ulMatchLen = LZ_MIN_MATCH;
+
+                while(((ulPos + ulMatchLen) < ulSrcLen) && (pbSrc[ulCand + ulMatchLen] == pbSrc[ulPos + ulMatchLen]))
+                {
+                    ulMatchLen++;
+                }
+
+                fFits = LzPutRecord(pbDst, ulDstMax, &ulOut, &pbSrc[ulAnchor], ulPos - ulAnchor, ulPos - ulCand, ulMatchLen);
+
+                ulPos += ulMatchLen;
+                ulAnchor = ulPos;
+            }
+            else
+            {
+                ulPos++;
+            }
+        }
+
+        if(fFits)
+        {
+            fFits = LzPutRecord(pbDst, ulDstMax, &ulOut, &pbSrc[ulAnchor], ulSrcLen - ulAnchor, 0U, 0U);
+        }
+
+        if(!fFits)
+        {
+            ulOut = 0U;
+        }
+    }
+
+    return ulOut;
+}
+
+
+/** @brief Decompress a buffer.
+
+    @param pbSrc    The compressed data.
+    @param ulSrcLen The length of @p pbSrc.
+    @param pbDst    The buffer to decompress into.
+    @param ulDstLen The length of the original data.
+
+    @return Whether @p pbSrc was well formed and decompressed to exactly
+            @p ulDstLen bytes.
+*/
+bool RedLzDecompress(
+    const uint8_t  *pbSrc,
+    uint32_t        ulSrcLen,
+    uint8_t        *pbDst,
+    uint32_t        ulDstLen)
+{
+    bool            fOk = true;
+    uint32_t        ulIn = 0U;
+    uint32_t        ulOut = 0U;
+
+    if((pbSrc == NULL) || (pbDst == NULL))
+    {
+        REDERROR();
+        fOk = false;
+    }
+
+    while(fOk && (ulIn < ulSrcLen))
+    {
+        uint32_t    ulToken = pbSrc[ulIn];
+        uint32_t    ulLen = ulToken >> 4U;
+
+        ulIn++;
+
+        if(ulLen == LZ_NIBBLE_MAX)
+        {
+            fOk = LzGetLength(pbSrc, ulSrcLen, &ulIn, &ulLen);
+        }
+
+        if(fOk && ((ulLen > (ulSrcLen - ulIn)) || (ulLen > (ulDstLen - ulOut))))
+        {
+            fOk = false;
+        }
+
+        if(fOk)
+        {
+            RedMemCpy(&pbDst[ulOut], &pbSrc[ulIn], ulLen);
+            ulIn += ulLen;
+            ulOut += ulLen;
+
+            /*  The last record has no back reference.
+            */
+            if(ulIn < ulSrcLen)
+            {
+                uint32_t ulOffset;
+
+                if((ulSrcLen - ulIn) < 2U)
+                {
+                    fOk = false;
+                }
+                else
+                {
+                    ulOffset = (uint32_t)pbSrc[ulIn] | ((uint32_t)pbSrc[ulIn + 1U] << 8U);
+                    ulIn += 2U;
+                    ulLen = ulToken & LZ_NIBBLE_MAX;
+
+                    if(ulLen == LZ_NIBBLE_MAX)
+                    {
+                        fOk = LzGetLength(pbSrc, ulSrcLen, &ulIn, &ulLen);
+                    }
+
+                    ulLen += LZ_MIN_MATCH;
+
+                    if(fOk && ((ulOffset == 0U) || (ulOffset > ulOut) || (ulLen > (ulDstLen - ulOut))))
+                    {
+                        fOk = false;
+                    }
+                }
+
+                if(fOk)
+                {
+                    /*  The match may overlap the bytes it produces, so it is
+                        copied forward one byte at a time.
+                    */
+                    while(ulLen > 0U)
+                    {
+                        pbDst[ulOut] = pbDst[ulOut - ulOffset];
+                        ulOut++;
+                        ulLen--;
+                    }
+                }
+            }
+        }
+    }
+
+    return fOk && (ulOut == ulDstLen);
+}
+
+
+/** @brief Read four bytes, in an order which does not depend on the host.
+
+    @param pbData   The bytes to read.
+
+    @return The four bytes as a 32-bit value.
+*/
+static uint32_t LzRead32(
+    const uint8_t  *pbData)
+{
+    return (uint32_t)pbData[0U] | ((uint32_t)pbData[1U] << 8U) | ((uint32_t)pbData[2U] << 16U) | ((uint32_t)pbData[3U] << 24U);
+}
+
+
+/** @brief Hash four bytes into an index in the hash table.
+
+    @param ulValue  The four bytes, from LzRead32().
+
+    @return An index less than LZ_HASH_ENTRIES.
+*/
+static uint32_t LzHash(
+    uint32_t    ulValue)
+{
+    return (ulValue * 2654435761U) >> (32U - LZ_HASH_BITS);
+}
+
+
+/** @brief Append a record to the compressed data.
+
+    @param pbDst        The compressed data buffer.
+    @param ulDstMax     The size of @p pbDst.
+    @param pulOut       On entry, the length of the compressed data so far; on
+                        return, updated to include the record.
+    @param pbLiterals   The literal bytes.
+    @param ulLitLen     The number of literal bytes.
+    @param ulOffset     The distance back to the match.
+    @param ulMatchLen   The length of the match, or zero for the last record,
+                        which has no back reference.
+
+    @return Whether the record fit.
+*/
+static bool LzPutRecord(
+    uint8_t        *pbDst,
+    uint32_t        ulDstMax,
+    uint32_t       *pulOut,
+    const uint8_t  *pbLiterals,
+    uint32_t        ulLitLen,
+    uint32_t        ulOffset,
+    uint32_t        ulMatchLen)
+{
+    uint32_t        ulMatchCode = (ulMatchLen == 0U) ? 0U : (ulMatchLen - LZ_MIN_MATCH);
+    bool            fFits = *pulOut < ulDstMax;
+
+    if(fFits)
+    {
+        pbDst[*pulOut] = (uint8_t)((REDMIN(ulLitLen, LZ_NIBBLE_MAX) << 4U) | REDMIN(ulMatchCode, LZ_NIBBLE_MAX));
+        (*pulOut)++;
+
+        if(ulLitLen >= LZ_NIBBLE_MAX)
+        {
+            fFits = LzPutLength(pbDst, ulDstMax, pulOut, ulLitLen - LZ_NIBBLE_MAX);
+        }
+    }
+
+    if(fFits && (ulLitLen > 0U))
+    {
+        if(ulLitLen > (ulDstMax - *pulOut))
+        {
+            fFits = false;
+        }
+        else
+        {
+            RedMemCpy(&pbDst[*pulOut], pbLiterals, ulLitLen);
+            *pulOut += ulLitLen;
+        }
+    }
+
+    if(fFits && (ulMatchLen > 0U))
+    {
+        if((ulDstMax - *pulOut) < 2U)
+        {
+            fFits = false;
+        }
+        else
+        {
+            pbDst[*pulOut] = (uint8_t)(ulOffset & 0xFFU);
+            pbDst[*pulOut + 1U] = (uint8_t)(ulOffset >> 8U);
+            *pulOut += 2U;
+
+            if(ulMatchCode >= LZ_NIBBLE_MAX)
+            {
+                fFits = LzPutLength(pbDst, ulDstMax, pulOut, ulMatchCode - LZ_NIBBLE_MAX);
+            }
+        }
+    }
+
+    return fFits;
+}
+
+
+/** @brief Append the extension bytes of a length.
+
+    @param pbDst    The compressed data buffer.
+    @param ulDstMax The size of @p pbDst.
+    @param pulOut   On entry, the length of the compressed data so far; on
+                    return, updated to include the extension bytes.
+    @param ulLen    The part of the length beyond what the token holds.
+
+    @return Whether the extension bytes fit.
+*/
+static bool LzPutLength(
+    uint8_t    *pbDst,
+    uint32_t    ulDstMax,
+    uint32_t   *pulOut,
+    uint32_t    ulLen)
+{
+    uint32_t    ulRemaining = ulLen;
+    bool        fFits = true;
+
+    while(fFits)
+    {
+        if(*pulOut >= ulDstMax)
+        {
+            fFits = false;
+        }
+        else
+        {
+            uint32_t ulByte = REDMIN(ulRemaining, 255U);
+
+            pbDst[*pulOut] = (uint8_t)ulByte;
+            (*pulOut)++;
+            ulRemaining -= ulByte;
+
+            if(ulByte < 255U)
+            {
+                break;
+            }
+        }
+    }
+
+    return fFits;
+}
+
+
+/** @brief Read the extension bytes of a length.
+
+    @param pbSrc    The compressed data.
+    @param ulSrcLen The length of @p pbSrc.
+    @param pulIn    On entry, the offset of the extension bytes; on return,
+                    the offset after them.
+    @param pulLen   On entry, the length from the token; on return, with the
+                    extension bytes added.
+
+    @return Whether the extension bytes were within @p pbSrc.
+*/
+static bool LzGetLength(
+    const uint8_t  *pbSrc,
+    uint32_t        ulSrcLen,
+    uint32_t       *pulIn,
+    uint32_t       *pulLen)
+{
+    bool            fOk = true;
+    uint32_t        ulByte = 255U;
+
+    while(fOk && (ulByte == 255U))
+    {
+        if(*pulIn >= ulSrcLen)
+        {
+            fOk = false;
+        }
+        else
+        {
+            ulByte = pbSrc[*pulIn];
+            (*pulIn)++;
+            *pulLen += ulByte;
+        }
+    }
+
+    return fOk;
+}
+
+#endif /* REDCONF_COMPRESSION == 1 */
@@ -26,10 +26,15 @@
     @brief Default implementations of memory manipulation functions.
 
     These implementations are intended to be small and simple, and thus forego
-    all optimizations.  If the C library is available, or if there are better
+    most optimizations.  If the C library is available, or if there are better
     third-party implementations available in the system, those can be used
     instead by defining the appropriate macros in redconf.h.
 
+    Setting REDCONF_MEM_WORDWISE to 1 makes RedMemCpy() and RedMemSet() work a
+    32-bit word at a time when the buffers are aligned, which is the case for
+    most block buffer copies.  Setting REDCONF_MEM_HOOK to 1 allows large copies
+    to be handed to a memory-to-memory DMA engine; see RedMemCpySetHook().
+
     These functions are not intended to be completely 100% ANSI C compatible
     implementations, but rather are designed to meet the needs of Reliance Edge.
     The compatibility is close enough that ANSI C compatible implementations
@@ -52,6 +57,13 @@ static int32_t RedMemCmpUnchecked(const void *pMem1, const void *pMem2, uint32_t
 #endif
 
 
+#if REDCONF_MEM_HOOK == 1
+/*  Optional memory copy engine registered at run time; see RedMemCpySetHook().
+*/
+static REDMEMCPYHOOK gpfnMemCpyHook = NULL;
+#endif
+
+
 /** @brief Copy memory from one address to another.
 
     The source and destination memory buffers should not overlap.  If the
@@ -72,11 +84,45 @@ void RedMemCpy(
     }
     else
     {
-        RedMemCpyUnchecked(pDest, pSrc, ulLen);
+      #if REDCONF_MEM_HOOK == 1
+        REDMEMCPYHOOK pfnHook = gpfnMemCpyHook;
+
+        /*  Only copies of at least a block are worth the cost of setting up
+            the copy engine.
+        */
+        if((pfnHook == NULL) || (ulLen < REDCONF_BLOCK_SIZE) || !pfnHook(pDest, pSrc, ulLen))
+      #endif
+        {
+            RedMemCpyUnchecked(pDest, pSrc, ulLen);
+        }
     }
 }
 
 
+#if REDCONF_MEM_HOOK == 1
+/** @brief Register a memory copy engine to use for large copies.
+
+    This allows a memory-to-memory DMA controller to do full block copies.  The
+    hook is called for RedMemCpy() requests of REDCONF_BLOCK_SIZE bytes or
+    more.  It must finish the copy before returning, and it may decline a
+    request (for instance, because a buffer is not reachable by the DMA
+    controller) by returning false, in which case the copy is done in software.
+    The hook is not used by RedMemMove().
+
+    The hook should be registered before the driver is initialized, or at any
+    rate while no file system operation is in progress.
+
+    @param pfnHook  The copy engine to use; or `NULL` to do all copies in
+                    software.
+*/
+void RedMemCpySetHook(
+    REDMEMCPYHOOK   pfnHook)
+{
+    gpfnMemCpyHook = pfnHook;
+}
+#endif
+
+
 #ifndef RedMemCpyUnchecked
 /** @brief Copy memory from one address to another.
 
@@ -93,11 +139,42 @@ static void RedMemCpyUnchecked(
 {
     uint8_t        *pbDest = CAST_VOID_PTR_TO_UINT8_PTR(pDest);
     const uint8_t  *pbSrc = CAST_VOID_PTR_TO_CONST_UINT8_PTR(pSrc);
-    uint32_t        ulIdx;
+    uint32_t        ulIdx = 0U;
 
-    for(ulIdx = 0U; ulIdx < ulLen; ulIdx++)
+  #if REDCONF_MEM_WORDWISE == 1
+    if(IS_ALIGNED_PTR(pbDest) && IS_ALIGNED_PTR(pbSrc))
+    {
+        uint32_t       *pulDest = CAST_UINT32_PTR(pbDest);
+        const uint32_t *pulSrc = CAST_CONST_UINT32_PTR(pbSrc);
+        uint32_t        ulWords = ulLen >> 2U;
+        uint32_t        ulWord = 0U;
+
+        /*  Unrolled by four, so that the compiler can use load and store
+            multiple instructions where the CPU has them.
+        */
+        while((ulWords - ulWord) >= 4U)
+        {
+            pulDest[ulWord] = pulSrc[ulWord];
+            pulDest[ulWord + 1U] = pulSrc[ulWord + 1U];
+            pulDest[ulWord + 2U] = pulSrc[ulWord + 2U];
+            pulDest[ulWord + 3U] = pulSrc[ulWord + 3U];
+            ulWord += 4U;
+        }
+
+        while(ulWord < ulWords)
+        {
+            pulDest[ulWord] = pulSrc[ulWord];
+            ulWord++;
+        }
+
+        ulIdx = ulWords << 2U;
+    }
+  #endif
+
+    while(ulIdx < ulLen)
     {
         pbDest[ulIdx] = pbSrc[ulIdx];
+        ulIdx++;
     }
 }
 #endif
@@ -213,11 +290,39 @@ static void RedMemSetUnchecked(
     uint32_t    ulLen)
 {
     uint8_t    *pbDest = CAST_VOID_PTR_TO_UINT8_PTR(pDest);
-    uint32_t    ulIdx;
+    uint32_t    ulIdx = 0U;
 
-    for(ulIdx = 0U; ulIdx < ulLen; ulIdx++)
+  #if REDCONF_MEM_WORDWISE == 1
+    if(IS_ALIGNED_PTR(pbDest))
+    {
+        uint32_t   *pulDest = CAST_UINT32_PTR(pbDest);
+        uint32_t    ulVal = (uint32_t)bVal * 0x01010101U;
+        uint32_t    ulWords = ulLen >> 2U;
+        uint32_t    ulWord = 0U;
+
+        while((ulWords - ulWord) >= 4U)
+        {
+            pulDest[ulWord] = ulVal;
+            pulDest[ulWord + 1U] = ulVal;
+            pulDest[ulWord + 2U] = ulVal;
+            pulDest[ulWord + 3U] = ulVal;
+            ulWord += 4U;
+        }
+
+        while(ulWord < ulWords)
+        {
+            pulDest[ulWord] = ulVal;
+            ulWord++;
+        }
+
+        ulIdx = ulWords << 2U;
+    }
+  #endif
+
+    while(ulIdx < ulLen)
     {
         pbDest[ulIdx] = bVal;
+        ulIdx++;
     }
 }
 #endif
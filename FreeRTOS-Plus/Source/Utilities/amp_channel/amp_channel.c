@@ -0,0 +1,372 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file amp_channel.c
+ * @brief Zero-copy channel for passing data between cores in an AMP system.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "amp_channel.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Write back part of the shared memory, if the port requires it.
+ */
+static void prvClean( const AmpChannel_t * pxChannel,
+                      const void * pvAddress,
+                      size_t xLength );
+
+/**
+ * @brief Discard cached copies of part of the shared memory, if the port
+ * requires it.
+ */
+static void prvInvalidate( const AmpChannel_t * pxChannel,
+                           const void * pvAddress,
+                           size_t xLength );
+
+/**
+ * @brief Return the start of the slot used for the free running index
+ * @p ulIndex.
+ */
+static uint8_t * prvSlot( const AmpChannel_t * pxChannel,
+                          uint32_t ulIndex );
+
+/**
+ * @brief Return pdTRUE if this end of the channel can proceed - there is a
+ * free slot on the sending core, or a committed slot on the receiving core.
+ */
+static BaseType_t prvIsReady( AmpChannel_t * pxChannel );
+
+/**
+ * @brief Block the calling task until prvIsReady() returns pdTRUE or the block
+ * time expires.
+ */
+static BaseType_t prvWaitUntilReady( AmpChannel_t * pxChannel,
+                                     TickType_t xTicksToWait );
+
+/**
+ * @brief Publish this core's index, then interrupt the other core if a task
+ * there has blocked since the doorbell was last rung.
+ */
+static void prvPublish( AmpChannel_t * pxChannel,
+                        AmpChannelIndex_t * pxOwn,
+                        const AmpChannelIndex_t * pxPeer,
+                        uint32_t ulNewIndex );
+
+/*-----------------------------------------------------------*/
+
+static void prvClean( const AmpChannel_t * pxChannel,
+                      const void * pvAddress,
+                      size_t xLength )
+{
+    if( pxChannel->pxPort->vCacheClean != NULL )
+    {
+        pxChannel->pxPort->vCacheClean( pxChannel->pvPortContext, pvAddress, xLength );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvInvalidate( const AmpChannel_t * pxChannel,
+                           const void * pvAddress,
+                           size_t xLength )
+{
+    if( pxChannel->pxPort->vCacheInvalidate != NULL )
+    {
+        pxChannel->pxPort->vCacheInvalidate( pxChannel->pvPortContext, pvAddress, xLength );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t * prvSlot( const AmpChannel_t * pxChannel,
+                          uint32_t ulIndex )
+{
+    return &( pxChannel->pucSlots[ ( size_t ) ( ulIndex & ( pxChannel->ulSlotCount - 1U ) ) * pxChannel->xSlotStride ] );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsReady( AmpChannel_t * pxChannel )
+{
+    AmpChannelShared_t * pxShared = pxChannel->pxShared;
+    BaseType_t xReady;
+
+    if( pxChannel->xIsSender != pdFALSE )
+    {
+        /* A slot is free if fewer than ulSlotCount slots are committed but not
+         * yet released. */
+        prvInvalidate( pxChannel, &( pxShared->xReceiver ), sizeof( pxShared->xReceiver ) );
+        xReady = ( ( pxShared->xSender.ulIndex - pxShared->xReceiver.ulIndex ) < pxChannel->ulSlotCount ) ? pdTRUE : pdFALSE;
+    }
+    else
+    {
+        prvInvalidate( pxChannel, &( pxShared->xSender ), sizeof( pxShared->xSender ) );
+        xReady = ( pxShared->xSender.ulIndex != pxChannel->ulNextSlot ) ? pdTRUE : pdFALSE;
+    }
+
+    /* Don't read the slot before the index that says it is ready. */
+    ampchannelMEMORY_BARRIER();
+
+    return xReady;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWaitUntilReady( AmpChannel_t * pxChannel,
+                                     TickType_t xTicksToWait )
+{
+    AmpChannelIndex_t * pxOwn;
+    TimeOut_t xTimeOut;
+    BaseType_t xReady;
+
+    pxOwn = ( pxChannel->xIsSender != pdFALSE ) ? &( pxChannel->pxShared->xSender ) : &( pxChannel->pxShared->xReceiver );
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ; ; )
+    {
+        xReady = prvIsReady( pxChannel );
+
+        if( ( xReady != pdFALSE ) || ( xTicksToWait == ( TickType_t ) 0 ) )
+        {
+            break;
+        }
+
+        /* Tell the other core a task is waiting.  The handle is set first so
+         * a doorbell that arrives as soon as the arm count changes can wake
+         * the task, and any notification left from an earlier wait is
+         * discarded. */
+        ( void ) ulTaskNotifyTakeIndexed( ampchannelNOTIFY_INDEX, pdTRUE, 0 );
+        pxChannel->xWaitingTask = xTaskGetCurrentTaskHandle();
+        pxOwn->ulArmCount++;
+        ampchannelMEMORY_BARRIER();
+        prvClean( pxChannel, pxOwn, sizeof( *pxOwn ) );
+
+        /* The other core might have moved its index before it saw the new arm
+         * count, in which case it did not ring the doorbell. */
+        if( prvIsReady( pxChannel ) == pdFALSE )
+        {
+            ( void ) ulTaskNotifyTakeIndexed( ampchannelNOTIFY_INDEX, pdTRUE, xTicksToWait );
+        }
+
+        pxChannel->xWaitingTask = NULL;
+
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            /* Use up the remaining time with one last check. */
+            xTicksToWait = 0;
+        }
+    }
+
+    return xReady;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPublish( AmpChannel_t * pxChannel,
+                        AmpChannelIndex_t * pxOwn,
+                        const AmpChannelIndex_t * pxPeer,
+                        uint32_t ulNewIndex )
+{
+    uint32_t ulPeerArmCount;
+
+    /* Everything written to the slot must be visible before the index. */
+    ampchannelMEMORY_BARRIER();
+    pxOwn->ulIndex = ulNewIndex;
+    ampchannelMEMORY_BARRIER();
+    prvClean( pxChannel, pxOwn, sizeof( *pxOwn ) );
+
+    /* Only interrupt the other core if its task has blocked since the last
+     * time it was interrupted.  While both cores are busy no interrupts are
+     * generated at all. */
+    prvInvalidate( pxChannel, pxPeer, sizeof( *pxPeer ) );
+    ulPeerArmCount = pxPeer->ulArmCount;
+
+    if( ulPeerArmCount != pxChannel->ulPeerArmCountAnswered )
+    {
+        pxChannel->ulPeerArmCountAnswered = ulPeerArmCount;
+        pxChannel->pxPort->vRingDoorbell( pxChannel->pvPortContext );
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAmpChannelInit( AmpChannel_t * pxChannel,
+                            void * pvSharedMemory,
+                            size_t xSharedMemorySize,
+                            UBaseType_t uxSlotCount,
+                            size_t xSlotDataSize,
+                            BaseType_t xIsSender,
+                            const AmpChannelPort_t * pxPort,
+                            void * pvPortContext )
+{
+    BaseType_t xReturn = pdFAIL;
+    AmpChannelIndex_t * pxOwn;
+
+    configASSERT( pxChannel != NULL );
+    configASSERT( pvSharedMemory != NULL );
+    configASSERT( pxPort != NULL );
+    configASSERT( pxPort->vRingDoorbell != NULL );
+
+    if( ( uxSlotCount > 0U ) &&
+        ( ( uxSlotCount & ( uxSlotCount - 1U ) ) == 0U ) &&
+        ( xSlotDataSize <= ( size_t ) UINT32_MAX ) &&
+        ( xSharedMemorySize >= ampchannelSHARED_MEMORY_SIZE( uxSlotCount, xSlotDataSize ) ) &&
+        ( ( ( ( size_t ) pvSharedMemory ) & ( ampchannelCACHE_LINE_SIZE - 1U ) ) == 0U ) )
+    {
+        memset( pxChannel, 0x00, sizeof( *pxChannel ) );
+        pxChannel->pxShared = ( AmpChannelShared_t * ) pvSharedMemory;
+        pxChannel->pucSlots = ( ( uint8_t * ) pvSharedMemory ) + sizeof( AmpChannelShared_t );
+        pxChannel->xSlotStride = ampchannelSLOT_STRIDE( xSlotDataSize );
+        pxChannel->xSlotDataSize = xSlotDataSize;
+        pxChannel->ulSlotCount = ( uint32_t ) uxSlotCount;
+        pxChannel->xIsSender = xIsSender;
+        pxChannel->pxPort = pxPort;
+        pxChannel->pvPortContext = pvPortContext;
+
+        /* Each core only ever writes its own index. */
+        pxOwn = ( xIsSender != pdFALSE ) ? &( pxChannel->pxShared->xSender ) : &( pxChannel->pxShared->xReceiver );
+        memset( pxOwn, 0x00, sizeof( *pxOwn ) );
+        ampchannelMEMORY_BARRIER();
+        prvClean( pxChannel, pxOwn, sizeof( *pxOwn ) );
+
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void * pvAmpChannelSendAcquire( AmpChannel_t * pxChannel,
+                                TickType_t xTicksToWait )
+{
+    void * pvReturn = NULL;
+
+    configASSERT( pxChannel != NULL );
+    configASSERT( pxChannel->xIsSender != pdFALSE );
+    configASSERT( pxChannel->xSlotHeld == pdFALSE );
+
+    if( prvWaitUntilReady( pxChannel, xTicksToWait ) != pdFALSE )
+    {
+        /* The data follows the length. */
+        pvReturn = prvSlot( pxChannel, pxChannel->ulNextSlot ) + sizeof( uint32_t );
+        pxChannel->xSlotHeld = pdTRUE;
+    }
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vAmpChannelSendCommit( AmpChannel_t * pxChannel,
+                            size_t xLength )
+{
+    uint8_t * pucSlot;
+    uint32_t ulLength = ( uint32_t ) xLength;
+
+    configASSERT( pxChannel != NULL );
+    configASSERT( pxChannel->xSlotHeld != pdFALSE );
+    configASSERT( xLength <= pxChannel->xSlotDataSize );
+
+    pucSlot = prvSlot( pxChannel, pxChannel->ulNextSlot );
+    memcpy( pucSlot, &ulLength, sizeof( ulLength ) );
+    prvClean( pxChannel, pucSlot, sizeof( uint32_t ) + xLength );
+
+    pxChannel->xSlotHeld = pdFALSE;
+    pxChannel->ulNextSlot++;
+
+    prvPublish( pxChannel, &( pxChannel->pxShared->xSender ), &( pxChannel->pxShared->xReceiver ), pxChannel->ulNextSlot );
+}
+/*-----------------------------------------------------------*/
+
+const void * pvAmpChannelReceive( AmpChannel_t * pxChannel,
+                                  size_t * pxLength,
+                                  TickType_t xTicksToWait )
+{
+    const void * pvReturn = NULL;
+    uint8_t * pucSlot;
+    uint32_t ulLength;
+
+    configASSERT( pxChannel != NULL );
+    configASSERT( pxChannel->xIsSender == pdFALSE );
+    configASSERT( pxLength != NULL );
+
+    *pxLength = 0;
+
+    if( prvWaitUntilReady( pxChannel, xTicksToWait ) != pdFALSE )
+    {
+        pucSlot = prvSlot( pxChannel, pxChannel->ulNextSlot );
+
+        /* The length is read first so only the part of the slot holding data
+         * is invalidated.  The slot is never written by this core, so
+         * invalidating it cannot lose anything. */
+        prvInvalidate( pxChannel, pucSlot, sizeof( uint32_t ) );
+        memcpy( &ulLength, pucSlot, sizeof( ulLength ) );
+        configASSERT( ulLength <= pxChannel->xSlotDataSize );
+
+        prvInvalidate( pxChannel, pucSlot, sizeof( uint32_t ) + ( size_t ) ulLength );
+
+        *pxLength = ( size_t ) ulLength;
+        pvReturn = pucSlot + sizeof( uint32_t );
+        pxChannel->ulNextSlot++;
+    }
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vAmpChannelReceiveRelease( AmpChannel_t * pxChannel )
+{
+    AmpChannelShared_t * pxShared;
+
+    configASSERT( pxChannel != NULL );
+    configASSERT( pxChannel->xIsSender == pdFALSE );
+
+    pxShared = pxChannel->pxShared;
+
+    /* A slot must have been received before it can be released. */
+    configASSERT( pxShared->xReceiver.ulIndex != pxChannel->ulNextSlot );
+
+    prvPublish( pxChannel, &( pxShared->xReceiver ), &( pxShared->xSender ), pxShared->xReceiver.ulIndex + 1U );
+}
+/*-----------------------------------------------------------*/
+
+void vAmpChannelDoorbellFromISR( AmpChannel_t * pxChannel,
+                                 BaseType_t * pxHigherPriorityTaskWoken )
+{
+    TaskHandle_t xTask;
+
+    configASSERT( pxChannel != NULL );
+
+    xTask = pxChannel->xWaitingTask;
+
+    if( xTask != NULL )
+    {
+        vTaskNotifyGiveIndexedFromISR( xTask, ampchannelNOTIFY_INDEX, pxHigherPriorityTaskWoken );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,264 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file amp_channel.h
+ * @brief Zero-copy channel for passing data between cores in an AMP system.
+ *
+ * A channel moves data in one direction between two cores that each run their
+ * own FreeRTOS kernel, through memory both cores can access.  The shared
+ * memory holds a ring of fixed size slots.  The sending core writes directly
+ * into a slot and commits it, and the receiving core reads the same slot in
+ * place and releases it, so the data is never copied by the channel.  Slots
+ * are committed, received and released in order.
+ *
+ * Each cache line of the shared memory is only ever written by one core, so the
+ * channel works on parts where the cores' caches are not coherent, provided
+ * AmpChannelPort_t supplies cache clean and invalidate functions.  The slots
+ * and the shared memory must then be aligned to ampchannelCACHE_LINE_SIZE.
+ *
+ * A core only interrupts the other when the other core has a task blocked on
+ * the channel, and at most once per time that task blocks.  A steady stream of
+ * data between two busy cores therefore causes no interrupts at all.  The
+ * application routes the inter-core interrupt to vAmpChannelDoorbellFromISR().
+ *
+ * Each end of a channel must only be used by one task at a time.
+ */
+
+#ifndef AMP_CHANNEL_H
+#define AMP_CHANNEL_H
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief The size of a cache line.  Anything written by one core is kept in
+ * cache lines that the other core never writes.
+ */
+#ifndef ampchannelCACHE_LINE_SIZE
+    #define ampchannelCACHE_LINE_SIZE    64U
+#endif
+
+/**
+ * @brief The task notification index used by tasks blocked on a channel.
+ */
+#ifndef ampchannelNOTIFY_INDEX
+    #define ampchannelNOTIFY_INDEX    0
+#endif
+
+/**
+ * @brief Orders the accesses to shared memory made by this core.  Must be a
+ * hardware barrier, for example a DMB on ARM, not just a compiler barrier.
+ */
+#ifndef ampchannelMEMORY_BARRIER
+    #if defined( __GNUC__ )
+        #define ampchannelMEMORY_BARRIER()    __sync_synchronize()
+    #else
+        #error Define ampchannelMEMORY_BARRIER() to a hardware memory barrier.
+    #endif
+#endif
+
+/**
+ * @brief Round a size up to a whole number of cache lines.
+ */
+#define ampchannelROUND_UP( xSize ) \
+    ( ( ( ( size_t ) ( xSize ) ) + ampchannelCACHE_LINE_SIZE - 1U ) & ~( ( size_t ) ampchannelCACHE_LINE_SIZE - 1U ) )
+
+/**
+ * @brief The distance between the starts of two slots holding up to
+ * @p xSlotDataSize bytes.  Each slot starts with the length of its data.
+ */
+#define ampchannelSLOT_STRIDE( xSlotDataSize ) \
+    ampchannelROUND_UP( sizeof( uint32_t ) + ( size_t ) ( xSlotDataSize ) )
+
+/**
+ * @brief The number of bytes of shared memory a channel needs.
+ */
+#define ampchannelSHARED_MEMORY_SIZE( uxSlotCount, xSlotDataSize ) \
+    ( sizeof( AmpChannelShared_t ) + ( ( size_t ) ( uxSlotCount ) * ampchannelSLOT_STRIDE( xSlotDataSize ) ) )
+
+/**
+ * @brief The state one core publishes to the other.  Padded to a cache line so
+ * it is only written by one core.
+ */
+typedef struct AmpChannelIndex
+{
+    volatile uint32_t ulIndex;    /**< Sending core: slots committed.  Receiving core: slots released.  Both free running. */
+    volatile uint32_t ulArmCount; /**< Incremented each time this core's task blocks on the channel. */
+    uint8_t ucPad[ ampchannelCACHE_LINE_SIZE - ( 2U * sizeof( uint32_t ) ) ];
+} AmpChannelIndex_t;
+
+/**
+ * @brief The start of the shared memory.  The slots follow.
+ */
+typedef struct AmpChannelShared
+{
+    AmpChannelIndex_t xSender;   /**< Only written by the sending core. */
+    AmpChannelIndex_t xReceiver; /**< Only written by the receiving core. */
+} AmpChannelShared_t;
+
+/**
+ * @brief Functions, provided by the application, that perform the hardware
+ * specific parts of the channel.
+ */
+typedef struct AmpChannelPort
+{
+    /**
+     * @brief Write back the cache lines covering the address range to memory.
+     * NULL if the shared memory is not cached or the caches are coherent.
+     */
+    void ( * vCacheClean )( void * pvContext,
+                            const void * pvAddress,
+                            size_t xLength );
+
+    /**
+     * @brief Discard the cache lines covering the address range so the next
+     * read comes from memory.  NULL if vCacheClean is NULL.
+     */
+    void ( * vCacheInvalidate )( void * pvContext,
+                                 const void * pvAddress,
+                                 size_t xLength );
+
+    /**
+     * @brief Interrupt the other core, which then calls
+     * vAmpChannelDoorbellFromISR() for its end of the channel.
+     */
+    void ( * vRingDoorbell )( void * pvContext );
+} AmpChannelPort_t;
+
+/**
+ * @brief One core's end of a channel.  Held in memory local to that core.  The
+ * members are only used within amp_channel.c.
+ */
+typedef struct AmpChannel
+{
+    AmpChannelShared_t * pxShared;
+    uint8_t * pucSlots;
+    size_t xSlotStride;
+    size_t xSlotDataSize;
+    uint32_t ulSlotCount;                /**< A power of two. */
+    BaseType_t xIsSender;
+    const AmpChannelPort_t * pxPort;
+    void * pvPortContext;
+    uint32_t ulNextSlot;                 /**< Sender: the slot to acquire.  Receiver: the slot to receive. */
+    BaseType_t xSlotHeld;                /**< Sender only: a slot has been acquired and not yet committed. */
+    uint32_t ulPeerArmCountAnswered;     /**< The other core's arm count the last time the doorbell was rung. */
+    TaskHandle_t volatile xWaitingTask;  /**< The task blocked on this end of the channel, if any. */
+} AmpChannel_t;
+
+/**
+ * @brief Initialise one core's end of a channel.
+ *
+ * Each core calls this for its own end, with the address of the shared memory
+ * as seen by that core.  Each core clears its own part of the shared memory,
+ * so both must have done so before the channel is used.
+ *
+ * @param[out] pxChannel The end of the channel to initialise.
+ * @param[in] pvSharedMemory At least ampchannelSHARED_MEMORY_SIZE() bytes,
+ * aligned to ampchannelCACHE_LINE_SIZE.
+ * @param[in] xSharedMemorySize The size of pvSharedMemory.
+ * @param[in] uxSlotCount The number of slots, which must be a power of two.
+ * @param[in] xSlotDataSize The largest amount of data a slot can hold.
+ * @param[in] xIsSender pdTRUE on the sending core, pdFALSE on the receiving
+ * core.
+ * @param[in] pxPort Hardware specific functions.  Must remain valid.
+ * @param[in] pvPortContext Passed to the functions in pxPort.
+ *
+ * @return pdPASS if the channel was initialised, pdFAIL if the parameters are
+ * not valid.
+ */
+BaseType_t xAmpChannelInit( AmpChannel_t * pxChannel,
+                            void * pvSharedMemory,
+                            size_t xSharedMemorySize,
+                            UBaseType_t uxSlotCount,
+                            size_t xSlotDataSize,
+                            BaseType_t xIsSender,
+                            const AmpChannelPort_t * pxPort,
+                            void * pvPortContext );
+
+/**
+ * @brief Obtain the next free slot to write data into.  Sending core only.
+ *
+ * @param[in] pxChannel The sending end of the channel.
+ * @param[in] xTicksToWait How long to wait for the receiving core to release
+ * a slot if none are free.
+ *
+ * @return A buffer of xSlotDataSize bytes, or NULL if no slot became free.  It
+ * must be passed to vAmpChannelSendCommit() before another slot is acquired.
+ */
+void * pvAmpChannelSendAcquire( AmpChannel_t * pxChannel,
+                                TickType_t xTicksToWait );
+
+/**
+ * @brief Pass the slot returned by pvAmpChannelSendAcquire() to the receiving
+ * core.  Sending core only.
+ *
+ * @param[in] pxChannel The sending end of the channel.
+ * @param[in] xLength The number of bytes written into the slot.
+ */
+void vAmpChannelSendCommit( AmpChannel_t * pxChannel,
+                            size_t xLength );
+
+/**
+ * @brief Obtain the oldest slot committed by the sending core.  Receiving core
+ * only.  More than one slot can be received before any are released.
+ *
+ * @param[in] pxChannel The receiving end of the channel.
+ * @param[out] pxLength The number of bytes in the slot.
+ * @param[in] xTicksToWait How long to wait for data if there is none.
+ *
+ * @return The data, which remains valid until the slot is released, or NULL if
+ * no data arrived.
+ */
+const void * pvAmpChannelReceive( AmpChannel_t * pxChannel,
+                                  size_t * pxLength,
+                                  TickType_t xTicksToWait );
+
+/**
+ * @brief Return the oldest received slot to the sending core.  Receiving core
+ * only.
+ *
+ * @param[in] pxChannel The receiving end of the channel.
+ */
+void vAmpChannelReceiveRelease( AmpChannel_t * pxChannel );
+
+/**
+ * @brief Called from the inter-core interrupt to wake a task blocked on this
+ * core's end of the channel.
+ *
+ * @param[in] pxChannel This core's end of the channel.
+ * @param[out] pxHigherPriorityTaskWoken Set to pdTRUE if a context switch
+ * should be requested before the interrupt exits.
+ */
+void vAmpChannelDoorbellFromISR( AmpChannel_t * pxChannel,
+                                 BaseType_t * pxHigherPriorityTaskWoken );
+
+#endif /* AMP_CHANNEL_H */
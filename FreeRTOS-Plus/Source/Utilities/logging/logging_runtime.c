@@ -0,0 +1,144 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file logging_runtime.c
+ * @brief Registry of run-time log levels, see logging_runtime.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "logging_runtime.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A level set with xLoggingSetLevel(), kept for modules that register
+ * later.
+ */
+typedef struct LogOverride
+{
+    char cName[ LOG_RUNTIME_MAX_NAME_LENGTH ];
+    uint8_t ucLevel;
+} LogOverride_t;
+
+/**
+ * @brief Registered modules, most recent first.
+ */
+static LogModule_t * pxModules = NULL;
+
+/**
+ * @brief Levels set with xLoggingSetLevel().  Unused entries have an empty name.
+ */
+static LogOverride_t xOverrides[ LOG_RUNTIME_MAX_OVERRIDES ];
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingModuleRegister( LogModule_t * pxModule,
+                                   uint8_t ucLevel )
+{
+    size_t i;
+
+    taskENTER_CRITICAL();
+    {
+        /* Another task may have registered the module in the meantime. */
+        if( pxModule->ucLevel == LOG_MODULE_UNREGISTERED )
+        {
+            pxModule->ucLevel = pxModule->ucDefaultLevel;
+
+            for( i = 0; i < LOG_RUNTIME_MAX_OVERRIDES; i++ )
+            {
+                if( strcmp( xOverrides[ i ].cName, pxModule->pcName ) == 0 )
+                {
+                    pxModule->ucLevel = xOverrides[ i ].ucLevel;
+                    break;
+                }
+            }
+
+            pxModule->pxNext = pxModules;
+            pxModules = pxModule;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return ( pxModule->ucLevel >= ucLevel ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingSetLevel( const char * pcName,
+                             uint8_t ucLevel )
+{
+    BaseType_t xReturn = pdFAIL;
+    LogModule_t * pxModule;
+    LogOverride_t * pxFree = NULL;
+    size_t i;
+
+    if( ( pcName != NULL ) && ( ucLevel != LOG_MODULE_UNREGISTERED ) )
+    {
+        taskENTER_CRITICAL();
+        {
+            for( pxModule = pxModules; pxModule != NULL; pxModule = pxModule->pxNext )
+            {
+                if( strcmp( pxModule->pcName, pcName ) == 0 )
+                {
+                    pxModule->ucLevel = ucLevel;
+                }
+            }
+
+            if( ( pcName[ 0 ] != '\0' ) && ( strlen( pcName ) < LOG_RUNTIME_MAX_NAME_LENGTH ) )
+            {
+                for( i = 0; ( i < LOG_RUNTIME_MAX_OVERRIDES ) && ( xReturn == pdFAIL ); i++ )
+                {
+                    if( strcmp( xOverrides[ i ].cName, pcName ) == 0 )
+                    {
+                        xOverrides[ i ].ucLevel = ucLevel;
+                        xReturn = pdPASS;
+                    }
+                    else if( ( pxFree == NULL ) && ( xOverrides[ i ].cName[ 0 ] == '\0' ) )
+                    {
+                        pxFree = &( xOverrides[ i ] );
+                    }
+                }
+
+                if( ( xReturn == pdFAIL ) && ( pxFree != NULL ) )
+                {
+                    ( void ) strcpy( pxFree->cName, pcName );
+                    pxFree->ucLevel = ucLevel;
+                    xReturn = pdPASS;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,139 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file logging_runtime.h
+ * @brief Run-time log levels per LIBRARY_LOG_NAME.
+ *
+ * Used by logging_stack.h when LOG_RUNTIME_FILTER is set to 1.  Each
+ * translation unit that includes logging_stack.h then owns a #LogModule_t that
+ * holds the current level of its LIBRARY_LOG_NAME.  The logging macros compare
+ * that level against the level of the message before evaluating any argument,
+ * so a disabled message costs one load and one compare.
+ *
+ * A module registers itself the first time it logs.  xLoggingSetLevel() changes
+ * the level of every registered module with a given name, and remembers the
+ * level for modules of that name that register later.
+ *
+ * Requires a C99 compiler, as each module is held in a static variable inside a
+ * static inline function.
+ */
+
+#ifndef LOGGING_RUNTIME_H
+#define LOGGING_RUNTIME_H
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/**
+ * @brief Maximum number of levels set with xLoggingSetLevel() that are
+ * remembered for modules that have not registered yet.
+ */
+#ifndef LOG_RUNTIME_MAX_OVERRIDES
+    #define LOG_RUNTIME_MAX_OVERRIDES    8
+#endif
+
+/**
+ * @brief Maximum length of a LIBRARY_LOG_NAME passed to xLoggingSetLevel(),
+ * including the terminator.
+ */
+#ifndef LOG_RUNTIME_MAX_NAME_LENGTH
+    #define LOG_RUNTIME_MAX_NAME_LENGTH    24
+#endif
+
+/**
+ * @brief Value of LogModule_t::ucLevel before the module registers.  It is
+ * higher than every level, so the first message takes the slow path that
+ * registers the module.
+ */
+#define LOG_MODULE_UNREGISTERED    ( 0xFFU )
+
+/**
+ * @brief The run-time state of one translation unit's LIBRARY_LOG_NAME.
+ */
+typedef struct LogModule
+{
+    const char * pcName;       /**< LIBRARY_LOG_NAME of the translation unit. */
+    volatile uint8_t ucLevel;  /**< Current level, or #LOG_MODULE_UNREGISTERED. */
+    uint8_t ucDefaultLevel;    /**< LIBRARY_LOG_LEVEL of the translation unit. */
+    struct LogModule * pxNext; /**< Next registered module. */
+} LogModule_t;
+
+/**
+ * @brief Register a module on its first message.  Called by the logging
+ * macros, not by applications.
+ *
+ * @param[in] pxModule The module to register.
+ * @param[in] ucLevel The level of the message being logged.
+ *
+ * @return pdTRUE if the message should be logged, otherwise pdFALSE.
+ */
+BaseType_t xLoggingModuleRegister( LogModule_t * pxModule,
+                                   uint8_t ucLevel );
+
+/**
+ * @brief Set the level of every module called @p pcName, now and when
+ * modules of that name register later.
+ *
+ * @param[in] pcName A LIBRARY_LOG_NAME, for example "MQTT".
+ * @param[in] ucLevel One of LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO or
+ * LOG_DEBUG.  Messages above a module's LIBRARY_LOG_LEVEL_MAX were compiled
+ * out and stay disabled.
+ *
+ * @return pdPASS if the level was recorded, pdFAIL if @p pcName is too long or
+ * LOG_RUNTIME_MAX_OVERRIDES names already have a level set.  Modules that are
+ * already registered are updated in either case.
+ */
+BaseType_t xLoggingSetLevel( const char * pcName,
+                             uint8_t ucLevel );
+
+#if defined( LIBRARY_LOG_NAME )
+
+/** @cond DO_NOT_DOCUMENT */
+
+    static inline LogModule_t * pxLoggingThisModule( void )
+    {
+        static LogModule_t xModule = { LIBRARY_LOG_NAME, LOG_MODULE_UNREGISTERED, LIBRARY_LOG_LEVEL, NULL };
+
+        return &xModule;
+    }
+
+/** @endcond */
+
+/**
+ * @brief Whether a message at @p xLevel is enabled for this translation unit.
+ */
+    #define LOG_RUNTIME_ENABLED( xLevel )                                          \
+    ( ( pxLoggingThisModule()->ucLevel >= ( uint8_t ) ( xLevel ) ) &&              \
+      ( ( pxLoggingThisModule()->ucLevel != LOG_MODULE_UNREGISTERED ) ||           \
+        ( xLoggingModuleRegister( pxLoggingThisModule(), ( uint8_t ) ( xLevel ) ) != pdFALSE ) ) )
+
+#endif /* if defined( LIBRARY_LOG_NAME ) */
+
+#endif /* ifndef LOGGING_RUNTIME_H */
@@ -78,6 +78,60 @@
     #define SdkLog( message )    vLoggingPrintf message
 #endif
 
+/**
+ * @brief Macro that each logging interface expands to, once per log line.
+ * @p pcLevel is the level name as a string literal, @p message the
+ * parenthesized format and arguments passed to the logging interface.
+ *
+ * @note The default definition emits the line as three #SdkLog calls: the
+ * metadata prefix, the message and a line break.  A backend that wants each
+ * line as a single record, such as logging_deferred.h, defines this macro
+ * before this file is included.
+ */
+#ifndef SdkLogLine
+    #define SdkLogLine( pcLevel, message )                                                            \
+    SdkLog( ( "[" pcLevel "] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); \
+    SdkLog( message );                                                                            \
+    SdkLog( ( "\r\n" ) )
+#endif
+
+/**
+ * @brief Set LOG_RUNTIME_FILTER to 1 to make the level of each LIBRARY_LOG_NAME
+ * adjustable at run time with xLoggingSetLevel(), see logging_runtime.h.
+ * LIBRARY_LOG_LEVEL is then the level a library starts at, and
+ * LIBRARY_LOG_LEVEL_MAX (LIBRARY_LOG_LEVEL by default) the highest level
+ * compiled in.  Messages above LIBRARY_LOG_LEVEL_MAX cost nothing, and messages
+ * disabled at run time cost one load and compare.  Defaults to 0, levels fixed
+ * at build time.
+ */
+#ifndef LOG_RUNTIME_FILTER
+    #define LOG_RUNTIME_FILTER    0
+#endif
+
+#if ( LOG_RUNTIME_FILTER == 1 )
+    #include "logging_runtime.h"
+
+    #ifndef LIBRARY_LOG_LEVEL_MAX
+        #define LIBRARY_LOG_LEVEL_MAX    LIBRARY_LOG_LEVEL
+    #endif
+
+    #define LOG_COMPILED_LEVEL    LIBRARY_LOG_LEVEL_MAX
+
+/**
+ * @brief Emit a log line if @p xLevel is enabled for this library at run time.
+ */
+    #define LogAtLevel( xLevel, pcLevel, message ) \
+    do {                                            \
+        if( LOG_RUNTIME_ENABLED( xLevel ) )         \
+        {                                           \
+            SdkLogLine( pcLevel, message );         \
+        }                                           \
+    } while( 0 )
+#else
+    #define LOG_COMPILED_LEVEL                        LIBRARY_LOG_LEVEL
+    #define LogAtLevel( xLevel, pcLevel, message )    SdkLogLine( pcLevel, message )
+#endif /* if ( LOG_RUNTIME_FILTER == 1 ) */
+
 /**
  * Disable definition of logging interface macros when generating doxygen output,
  * to avoid conflict with documentation of macros at the end of the file.
@@ -91,39 +145,39 @@
     ( LIBRARY_LOG_LEVEL != LOG_DEBUG ) )
     #error "Please define LIBRARY_LOG_LEVEL as either LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO, or LOG_DEBUG."
 #else
-    #if LIBRARY_LOG_LEVEL == LOG_DEBUG
+    #if LOG_COMPILED_LEVEL == LOG_DEBUG
         /* All log level messages will logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )    SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogWarn( message )     SdkLog( ( "[WARN] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogInfo( message )     SdkLog( ( "[INFO] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogDebug( message )    SdkLog( ( "[DEBUG] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    LogAtLevel( LOG_NONE, "ALWAYS", message )
+        #define LogError( message )    LogAtLevel( LOG_ERROR, "ERROR", message )
+        #define LogWarn( message )     LogAtLevel( LOG_WARN, "WARN", message )
+        #define LogInfo( message )     LogAtLevel( LOG_INFO, "INFO", message )
+        #define LogDebug( message )    LogAtLevel( LOG_DEBUG, "DEBUG", message )
 
-    #elif LIBRARY_LOG_LEVEL == LOG_INFO
+    #elif LOG_COMPILED_LEVEL == LOG_INFO
         /* Only INFO, WARNING, ERROR, and ALWAYS messages will be logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )    SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogWarn( message )     SdkLog( ( "[WARN] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogInfo( message )     SdkLog( ( "[INFO] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    LogAtLevel( LOG_NONE, "ALWAYS", message )
+        #define LogError( message )    LogAtLevel( LOG_ERROR, "ERROR", message )
+        #define LogWarn( message )     LogAtLevel( LOG_WARN, "WARN", message )
+        #define LogInfo( message )     LogAtLevel( LOG_INFO, "INFO", message )
         #define LogDebug( message )
 
-    #elif LIBRARY_LOG_LEVEL == LOG_WARN
+    #elif LOG_COMPILED_LEVEL == LOG_WARN
         /* Only WARNING, ERROR, and ALWAYS messages will be logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )    SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogWarn( message )     SdkLog( ( "[WARN] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    LogAtLevel( LOG_NONE, "ALWAYS", message )
+        #define LogError( message )    LogAtLevel( LOG_ERROR, "ERROR", message )
+        #define LogWarn( message )     LogAtLevel( LOG_WARN, "WARN", message )
         #define LogInfo( message )
         #define LogDebug( message )
 
-    #elif LIBRARY_LOG_LEVEL == LOG_ERROR
+    #elif LOG_COMPILED_LEVEL == LOG_ERROR
         /* Only ERROR and ALWAYS messages will be logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )    SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    LogAtLevel( LOG_NONE, "ALWAYS", message )
+        #define LogError( message )    LogAtLevel( LOG_ERROR, "ERROR", message )
         #define LogWarn( message )
         #define LogInfo( message )
         #define LogDebug( message )
 
-    #else /* if LIBRARY_LOG_LEVEL == LOG_NONE */
+    #else /* if LOG_COMPILED_LEVEL == LOG_NONE */
 
         #define LogAlways( message )
         #define LogError( message )
@@ -131,7 +185,7 @@
         #define LogInfo( message )
         #define LogDebug( message )
 
-    #endif /* if LIBRARY_LOG_LEVEL == LOG_NONE */
+    #endif /* if LOG_COMPILED_LEVEL == LOG_NONE */
 #endif /* if !defined( LIBRARY_LOG_LEVEL ) || ( ( LIBRARY_LOG_LEVEL != LOG_NONE ) && ( LIBRARY_LOG_LEVEL != LOG_ERROR ) && ( LIBRARY_LOG_LEVEL != LOG_WARN ) && ( LIBRARY_LOG_LEVEL != LOG_INFO ) && ( LIBRARY_LOG_LEVEL != LOG_DEBUG ) ) */
 
 #endif /* ifndef LOGGING_STACK_H */
@@ -0,0 +1,142 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file logging_tokenized.h
+ * @brief Tokenized logging backend for the logging macros in logging_stack.h.
+ *
+ * Include this header before logging_stack.h (for example from the library
+ * configuration headers) to replace every LogXxx() call with a short binary
+ * record instead of a formatted string:
+ *
+ * - The format string, prefixed with the level, library name, file and line,
+ * is placed in the #LOG_TOKEN_SECTION section.  Its address is the record's
+ * 32-bit token.
+ * - Each argument is converted to a 32-bit word.
+ * - The token and the arguments are passed to vLoggingTokenizedWrite(), which
+ * the application implements to send them to the host.
+ *
+ * No formatting is done on the target.  The linker script should keep
+ * #LOG_TOKEN_SECTION in the ELF file but out of the flash image, so the
+ * strings cost no flash either, for example with GNU ld:
+ *
+ * @code
+ * .log_tokens (INFO) : { KEEP( *( .log_tokens ) ) }
+ * @endcode
+ *
+ * tools/log_detokenizer/detokenize.py turns the records back into text using
+ * the strings in the ELF file.
+ *
+ * @note Up to eight arguments are supported.  Integers, characters and
+ * pointers are sent as their lower 32 bits.  %s arguments are sent as
+ * pointers, and the decoder can only show strings that are constant data in the
+ * ELF file.  Floating point and 64-bit arguments are not supported.
+ */
+
+#ifndef LOGGING_TOKENIZED_H
+#define LOGGING_TOKENIZED_H
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Name of the section that holds the tokenized format strings.
+ */
+#ifndef LOG_TOKEN_SECTION
+    #define LOG_TOKEN_SECTION    ".log_tokens"
+#endif
+
+/**
+ * @brief Attribute that places a format string in #LOG_TOKEN_SECTION and keeps
+ * it even though nothing reads it.  Override for compilers other than GCC and
+ * Clang.
+ */
+#ifndef LOG_TOKEN_SECTION_ATTRIBUTE
+    #define LOG_TOKEN_SECTION_ATTRIBUTE    __attribute__( ( section( LOG_TOKEN_SECTION ), used ) )
+#endif
+
+/**
+ * @brief Send one log record to the host.  Implemented by the application.
+ *
+ * @param[in] pulWords The token followed by one word per argument.
+ * @param[in] uxWordCount Number of words in @p pulWords, at least one.
+ *
+ * @note The decoder expects each record framed as one byte holding
+ * @p uxWordCount followed by the words in little endian byte order.
+ */
+void vLoggingTokenizedWrite( const uint32_t * pulWords,
+                             size_t uxWordCount );
+
+/** @cond DO_NOT_DOCUMENT */
+
+#define LOG_TOKEN_STRINGIFY_( x )    # x
+#define LOG_TOKEN_STRINGIFY( x )     LOG_TOKEN_STRINGIFY_( x )
+#define LOG_TOKEN_CONCAT_( a, b )    a ## b
+#define LOG_TOKEN_CONCAT( a, b )     LOG_TOKEN_CONCAT_( a, b )
+#define LOG_TOKEN_UNPAREN( ... )     __VA_ARGS__
+
+/* The number of arguments after the format string. */
+#define LOG_TOKEN_ARG_COUNT( ... ) \
+    LOG_TOKEN_ARG_COUNT_( __VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0, unused )
+#define LOG_TOKEN_ARG_COUNT_( fmt, a1, a2, a3, a4, a5, a6, a7, a8, count, ... )    count
+
+/* The format string alone. */
+#define LOG_TOKEN_FORMAT( ... )                LOG_TOKEN_FORMAT_( __VA_ARGS__, unused )
+#define LOG_TOKEN_FORMAT_( fmt, ... )          fmt
+
+/* The arguments after the format string, each converted to a word and preceded
+ * by a comma. */
+#define LOG_TOKEN_WORD( a )                    , ( uint32_t ) ( uintptr_t ) ( a )
+#define LOG_TOKEN_WORDS( ... ) \
+    LOG_TOKEN_CONCAT( LOG_TOKEN_WORDS_, LOG_TOKEN_ARG_COUNT( __VA_ARGS__ ) )( __VA_ARGS__ )
+#define LOG_TOKEN_WORDS_0( fmt )
+#define LOG_TOKEN_WORDS_1( fmt, a1 )                                        LOG_TOKEN_WORD( a1 )
+#define LOG_TOKEN_WORDS_2( fmt, a1, a2 )                                    LOG_TOKEN_WORDS_1( fmt, a1 ) LOG_TOKEN_WORD( a2 )
+#define LOG_TOKEN_WORDS_3( fmt, a1, a2, a3 )                                LOG_TOKEN_WORDS_2( fmt, a1, a2 ) LOG_TOKEN_WORD( a3 )
+#define LOG_TOKEN_WORDS_4( fmt, a1, a2, a3, a4 )                            LOG_TOKEN_WORDS_3( fmt, a1, a2, a3 ) LOG_TOKEN_WORD( a4 )
+#define LOG_TOKEN_WORDS_5( fmt, a1, a2, a3, a4, a5 )                        LOG_TOKEN_WORDS_4( fmt, a1, a2, a3, a4 ) LOG_TOKEN_WORD( a5 )
+#define LOG_TOKEN_WORDS_6( fmt, a1, a2, a3, a4, a5, a6 )                    LOG_TOKEN_WORDS_5( fmt, a1, a2, a3, a4, a5 ) LOG_TOKEN_WORD( a6 )
+#define LOG_TOKEN_WORDS_7( fmt, a1, a2, a3, a4, a5, a6, a7 )                LOG_TOKEN_WORDS_6( fmt, a1, a2, a3, a4, a5, a6 ) LOG_TOKEN_WORD( a7 )
+#define LOG_TOKEN_WORDS_8( fmt, a1, a2, a3, a4, a5, a6, a7, a8 )            LOG_TOKEN_WORDS_7( fmt, a1, a2, a3, a4, a5, a6, a7 ) LOG_TOKEN_WORD( a8 )
+
+#define LOG_TOKEN_RECORD( pcLevel, ... )                                                                            \
+    do {                                                                                                            \
+        static const char pcLogTokenString[] LOG_TOKEN_SECTION_ATTRIBUTE =                                          \
+            "[" pcLevel "] [" LIBRARY_LOG_NAME "] [" __FILE__ ":" LOG_TOKEN_STRINGIFY( __LINE__ ) "] "              \
+            LOG_TOKEN_FORMAT( __VA_ARGS__ );                                                                        \
+        const uint32_t ulLogTokenWords[] = { ( uint32_t ) ( uintptr_t ) pcLogTokenString LOG_TOKEN_WORDS( __VA_ARGS__ ) }; \
+        vLoggingTokenizedWrite( ulLogTokenWords, sizeof( ulLogTokenWords ) / sizeof( ulLogTokenWords[ 0 ] ) );     \
+    } while( 0 )
+
+/** @endcond */
+
+/**
+ * @brief Emit each log line as a tokenized record.
+ */
+#define SdkLogLine( pcLevel, message )    LOG_TOKEN_RECORD( pcLevel, LOG_TOKEN_UNPAREN message )
+
+#endif /* ifndef LOGGING_TOKENIZED_H */
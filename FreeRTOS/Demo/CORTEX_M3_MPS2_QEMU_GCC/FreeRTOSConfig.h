@@ -132,6 +132,22 @@ unsigned long ulGetRunTimeCounterValue( void ); /* Prototype of function that re
 extern void vLoggingPrintf( const char * pcFormatString,
                             ... );
 
+/* Output the results of the benchmarks in Demo/Common/Minimal. */
+#define configDEMO_REPORT( X )    vLoggingPrintf X
+
+/* The tickless idle benchmark, built with "make TICKLESS_BENCHMARK=1", times
+ * the port's sleep entry and exit using TIMER1, which main_tickless.c leaves
+ * free running from 0xffffffff down. */
+#if ( mainCREATE_TICKLESS_BENCHMARK_ONLY == 1 )
+    void vTicklessBenchmarkPreSleep( uint32_t ulExpectedIdleTime );
+    void vTicklessBenchmarkPostSleep( uint32_t ulExpectedIdleTime );
+
+    #define configUSE_TICKLESS_IDLE                    1
+    #define configPRE_SLEEP_PROCESSING( x )            vTicklessBenchmarkPreSleep( ( uint32_t ) ( x ) )
+    #define configPOST_SLEEP_PROCESSING( x )           vTicklessBenchmarkPostSleep( ( uint32_t ) ( x ) )
+    #define configTICKLESS_BENCHMARK_CYCLE_COUNT()    ( ~( *( ( volatile uint32_t * ) 0x40001004UL ) ) )
+#endif
+
 #ifdef HEAP3
     #define xPortGetMinimumEverFreeHeapSize    ( x )
     #define xPortGetFreeHeapSize               ( x )
@@ -41,6 +41,7 @@ void vApplicationIdleHook( void );
 void vApplicationTickHook( void );
 void vFullDemoIdleFunction( void );
 void vFullDemoTickHookFunction( void );
+void vTicklessBenchmarkIdleHook( void );
 void vApplicationGetTimerTaskMemory( StaticTask_t ** ppxTimerTaskTCBBuffer,
                                      StackType_t ** ppxTimerTaskStackBuffer,
                                      uint32_t * pulTimerTaskStackSize );
@@ -49,6 +50,7 @@ void vApplicationGetIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
                                     uint32_t * pulIdleTaskStackSize );
 void main_blinky( void );
 void main_full( void );
+void main_tickless( void );
 
 extern void initialise_monitor_handles( void );
 
@@ -64,6 +66,10 @@ int main()
     {
         main_full();
     }
+    #elif ( mainCREATE_TICKLESS_BENCHMARK_ONLY == 1 )
+    {
+        main_tickless();
+    }
     #else
     {
         #error "Invalid Selection...\nPlease Select a Demo application from the main command"
@@ -114,6 +120,11 @@ void vApplicationIdleHook( void )
          * blinky demo does not use the idle task hook. */
         vFullDemoIdleFunction();
     }
+    #elif ( mainCREATE_TICKLESS_BENCHMARK_ONLY == 1 )
+    {
+        /* Marks the start of sleep entry for the tickless benchmark. */
+        vTicklessBenchmarkIdleHook();
+    }
     #endif
 }
 /*-----------------------------------------------------------*/
@@ -0,0 +1,69 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Runs the tickless idle benchmark implemented in
+ * FreeRTOS/Demo/Common/Minimal/TicklessBenchmark.c on its own, so the idle
+ * task is the only thing that runs between the benchmark's timers.  Build with
+ * "make TICKLESS_BENCHMARK=1".
+ *
+ * The benchmark needs a counter that keeps running while the processor is in
+ * WFI, which the SysTick cannot provide as the port stops it.  CMSDK TIMER1 is
+ * therefore left free running from the peripheral clock, counting down from
+ * 0xffffffff, and configTICKLESS_BENCHMARK_CYCLE_COUNT() in FreeRTOSConfig.h
+ * inverts its value to give a count that goes up.  The results are in
+ * peripheral clock cycles.
+ */
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include "CMSIS/CMSDK_CM3.h"
+
+#include "TicklessBenchmark.h"
+
+#define mainTICKLESS_BENCHMARK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+
+void main_tickless( void )
+{
+    /* Start TIMER1 running with its interrupt disabled. */
+    CMSDK_TIMER1->CTRL = 0UL;
+    CMSDK_TIMER1->RELOAD = 0xffffffffUL;
+    CMSDK_TIMER1->VALUE = 0xffffffffUL;
+    CMSDK_TIMER1->CTRL = CMSDK_TIMER_CTRL_EN_Msk;
+
+    vStartTicklessBenchmark( mainTICKLESS_BENCHMARK_PRIORITY );
+
+    /* Start the tasks and timer running. */
+    vTaskStartScheduler();
+
+    /* If all is well, the scheduler will now be running, and the following
+     * line will never be reached.  If the following line does execute, then
+     * there was insufficient FreeRTOS heap memory available for the Idle and/or
+     * timer tasks to be created. */
+    for( ; ; )
+    {
+    }
+}
@@ -81,5 +81,9 @@ configKERNEL_INTERRUPT_PRIORITY setting.  Here 15 corresponds to the lowest
 NVIC value of 255. */
 #define configLIBRARY_KERNEL_INTERRUPT_PRIORITY	15
 
+/* The serial driver moves data by DMA, so have the comtest tasks use its block
+interface rather than sending and receiving a character at a time. */
+#define comtestUSE_BLOCK_MODE					1
+
 #endif /* FREERTOS_CONFIG_H */
 
@@ -25,13 +25,24 @@
  */
 
 /*
-	BASIC INTERRUPT DRIVEN SERIAL PORT DRIVER FOR UART0.
+	DMA DRIVEN SERIAL PORT DRIVER FOR USART1.
+
+	Transmitted data is written to a stream buffer and moved to the USART by
+	DMA channel 4, a block at a time.  Received data is written by DMA channel 5
+	into a small circular buffer, which is copied into a stream buffer when it
+	is half full, when it is full, and when the line goes idle - so the task
+	reading it is woken once per burst rather than once per character.
+
+	Both stream buffers assume a single writing task and a single reading task,
+	as used by the comtest tasks.
 */
 
+/* Standard includes. */
+#include <string.h>
+
 /* Scheduler includes. */
 #include "FreeRTOS.h"
-#include "queue.h"
-#include "semphr.h"
+#include "stream_buffer.h"
 
 /* Library includes. */
 #include "stm32f10x_lib.h"
@@ -41,20 +52,50 @@
 /*-----------------------------------------------------------*/
 
 /* Misc defines. */
-#define serINVALID_QUEUE				( ( QueueHandle_t ) 0 )
+#define serINVALID_STREAM				( ( StreamBufferHandle_t ) 0 )
 #define serNO_BLOCK						( ( TickType_t ) 0 )
-#define serTX_BLOCK_TIME				( 40 / portTICK_PERIOD_MS )
+
+/* Size of the buffers the DMA reads from and writes to.  At 921600 baud the
+receive buffer fills in under 1ms, but the half transfer interrupt gives the
+ISR half of that to copy the data out. */
+#define serTX_DMA_BUFFER_SIZE			( 64 )
+#define serRX_DMA_BUFFER_SIZE			( 64 )
 
 /*-----------------------------------------------------------*/
 
-/* The queue used to hold received characters. */
-static QueueHandle_t xRxedChars;
-static QueueHandle_t xCharsForTx;
+/* Stream buffers used to hold received and to be transmitted characters. */
+static StreamBufferHandle_t xRxedChars;
+static StreamBufferHandle_t xCharsForTx;
+
+/* The buffers accessed by the DMA. */
+static unsigned char ucTxDMABuffer[ serTX_DMA_BUFFER_SIZE ];
+static unsigned char ucRxDMABuffer[ serRX_DMA_BUFFER_SIZE ];
+
+/* pdTRUE while DMA channel 4 is transmitting.  Only accessed from the
+interrupts, which all run at the same priority. */
+static portBASE_TYPE xTxInProgress = pdFALSE;
+
+/* Index into ucRxDMABuffer of the next byte not yet copied into xRxedChars. */
+static unsigned portBASE_TYPE uxRxTail = 0;
 
 /*-----------------------------------------------------------*/
 
-/* UART interrupt handler. */
+/* Interrupt handlers, installed in stm32f10x_vector.c. */
 void vUARTInterruptHandler( void );
+void vSerialTxDMAHandler( void );
+void vSerialRxDMAHandler( void );
+
+/*
+ * Start a DMA transfer of whatever is waiting in xCharsForTx.  Called from an
+ * interrupt.
+ */
+static void prvStartTxDMA( portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/*
+ * Copy everything the DMA has written since the last call into xRxedChars.
+ * Called from an interrupt.
+ */
+static void prvCopyRxDMA( portBASE_TYPE *pxHigherPriorityTaskWoken );
 
 /*-----------------------------------------------------------*/
 
@@ -67,17 +108,20 @@ xComPortHandle xReturn;
 USART_InitTypeDef USART_InitStructure;
 NVIC_InitTypeDef NVIC_InitStructure;
 GPIO_InitTypeDef GPIO_InitStructure;
+DMA_InitTypeDef DMA_InitStructure;
 
-	/* Create the queues used to hold Rx/Tx characters. */
-	xRxedChars = xQueueCreate( uxQueueLength, ( unsigned portBASE_TYPE ) sizeof( signed char ) );
-	xCharsForTx = xQueueCreate( uxQueueLength + 1, ( unsigned portBASE_TYPE ) sizeof( signed char ) );
+	/* Create the stream buffers used to hold Rx/Tx characters.  A reader is
+	woken as soon as any data is available. */
+	xRxedChars = xStreamBufferCreate( uxQueueLength, 1 );
+	xCharsForTx = xStreamBufferCreate( uxQueueLength, 1 );
 	
-	/* If the queue/semaphore was created correctly then setup the serial port
+	/* If the stream buffers were created correctly then setup the serial port
 	hardware. */
-	if( ( xRxedChars != serINVALID_QUEUE ) && ( xCharsForTx != serINVALID_QUEUE ) )
+	if( ( xRxedChars != serINVALID_STREAM ) && ( xCharsForTx != serINVALID_STREAM ) )
 	{
-		/* Enable USART1 clock */
+		/* Enable USART1 and DMA clocks */
 		RCC_APB2PeriphClockCmd( RCC_APB2Periph_USART1 | RCC_APB2Periph_GPIOA, ENABLE );	
+		RCC_AHBPeriphClockCmd( RCC_AHBPeriph_DMA, ENABLE );
 
 		/* Configure USART1 Rx (PA10) as input floating */
 		GPIO_InitStructure.GPIO_Pin = GPIO_Pin_10;
@@ -102,14 +146,53 @@ GPIO_InitTypeDef GPIO_InitStructure;
 		USART_InitStructure.USART_LastBit = USART_LastBit_Disable;
 		
 		USART_Init( USART1, &USART_InitStructure );
-		
-		USART_ITConfig( USART1, USART_IT_RXNE, ENABLE );
+
+		/* DMA channel 4 moves data from ucTxDMABuffer to the USART.  The
+		memory address and length are set each time a transfer starts. */
+		DMA_DeInit( DMA_Channel4 );
+		DMA_InitStructure.DMA_PeripheralBaseAddr = ( u32 ) &( USART1->DR );
+		DMA_InitStructure.DMA_MemoryBaseAddr = ( u32 ) ucTxDMABuffer;
+		DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+		DMA_InitStructure.DMA_BufferSize = serTX_DMA_BUFFER_SIZE;
+		DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+		DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+		DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+		DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+		DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+		DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+		DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+		DMA_Init( DMA_Channel4, &DMA_InitStructure );
+		DMA_ITConfig( DMA_Channel4, DMA_IT_TC, ENABLE );
+
+		/* DMA channel 5 writes received data into ucRxDMABuffer continuously,
+		interrupting when each half is full. */
+		DMA_DeInit( DMA_Channel5 );
+		DMA_InitStructure.DMA_MemoryBaseAddr = ( u32 ) ucRxDMABuffer;
+		DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+		DMA_InitStructure.DMA_BufferSize = serRX_DMA_BUFFER_SIZE;
+		DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+		DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+		DMA_Init( DMA_Channel5, &DMA_InitStructure );
+		DMA_ITConfig( DMA_Channel5, DMA_IT_HT | DMA_IT_TC, ENABLE );
+		DMA_Cmd( DMA_Channel5, ENABLE );
+
+		USART_DMACmd( USART1, USART_DMAReq_Tx | USART_DMAReq_Rx, ENABLE );
+
+		/* The idle line interrupt collects the end of a burst that did not
+		fill half of the receive buffer. */
+		USART_ITConfig( USART1, USART_IT_IDLE, ENABLE );
 		
 		NVIC_InitStructure.NVIC_IRQChannel = USART1_IRQChannel;
 		NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = configLIBRARY_KERNEL_INTERRUPT_PRIORITY;
 		NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
 		NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
 		NVIC_Init( &NVIC_InitStructure );
+
+		NVIC_InitStructure.NVIC_IRQChannel = DMAChannel4_IRQChannel;
+		NVIC_Init( &NVIC_InitStructure );
+
+		NVIC_InitStructure.NVIC_IRQChannel = DMAChannel5_IRQChannel;
+		NVIC_Init( &NVIC_InitStructure );
 		
 		USART_Cmd( USART1, ENABLE );		
 	}
@@ -126,12 +209,9 @@ GPIO_InitTypeDef GPIO_InitStructure;
 
 signed portBASE_TYPE xSerialGetChar( xComPortHandle pxPort, signed char *pcRxedChar, TickType_t xBlockTime )
 {
-	/* The port handle is not required as this driver only supports one port. */
-	( void ) pxPort;
-
 	/* Get the next character from the buffer.  Return false if no characters
 	are available, or arrive before xBlockTime expires. */
-	if( xQueueReceive( xRxedChars, pcRxedChar, xBlockTime ) )
+	if( xSerialGetBlock( pxPort, ( char * ) pcRxedChar, 1, xBlockTime ) == 1 )
 	{
 		return pdTRUE;
 	}
@@ -142,27 +222,25 @@ signed portBASE_TYPE xSerialGetChar( xComPortHandle pxPort, signed char *pcRxedC
 }
 /*-----------------------------------------------------------*/
 
-void vSerialPutString( xComPortHandle pxPort, const signed char * const pcString, unsigned short usStringLength )
+size_t xSerialGetBlock( xComPortHandle pxPort, char *pcBuffer, size_t xBufferLength, TickType_t xBlockTime )
 {
-signed char *pxNext;
-
-	/* A couple of parameters that this port does not use. */
-	( void ) usStringLength;
+	/* The port handle is not required as this driver only supports one port. */
 	( void ) pxPort;
 
-	/* NOTE: This implementation does not handle the queue being full as no
-	block time is used! */
+	/* Returns as soon as any data is available, which after a burst is
+	everything received up to the line going idle. */
+	return xStreamBufferReceive( xRxedChars, pcBuffer, xBufferLength, xBlockTime );
+}
+/*-----------------------------------------------------------*/
 
-	/* The port handle is not required as this driver only supports UART1. */
-	( void ) pxPort;
+void vSerialPutString( xComPortHandle pxPort, const signed char * const pcString, unsigned short usStringLength )
+{
+	/* A parameter that this port does not use. */
+	( void ) usStringLength;
 
-	/* Send each character in the string, one at a time. */
-	pxNext = ( signed char * ) pcString;
-	while( *pxNext )
-	{
-		xSerialPutChar( pxPort, *pxNext, serNO_BLOCK );
-		pxNext++;
-	}
+	/* NOTE: This implementation does not handle the buffer being full as no
+	block time is used! */
+	xSerialPutBlock( pxPort, ( const char * ) pcString, strlen( ( const char * ) pcString ), serNO_BLOCK );
 }
 /*-----------------------------------------------------------*/
 
@@ -170,10 +248,9 @@ signed portBASE_TYPE xSerialPutChar( xComPortHandle pxPort, signed char cOutChar
 {
 signed portBASE_TYPE xReturn;
 
-	if( xQueueSend( xCharsForTx, &cOutChar, xBlockTime ) == pdPASS )
+	if( xSerialPutBlock( pxPort, ( const char * ) &cOutChar, 1, xBlockTime ) == 1 )
 	{
 		xReturn = pdPASS;
-		USART_ITConfig( USART1, USART_IT_TXE, ENABLE );
 	}
 	else
 	{
@@ -184,44 +261,129 @@ signed portBASE_TYPE xReturn;
 }
 /*-----------------------------------------------------------*/
 
+size_t xSerialPutBlock( xComPortHandle pxPort, const char *pcData, size_t xLength, TickType_t xBlockTime )
+{
+size_t xSent;
+
+	/* The port handle is not required as this driver only supports USART1. */
+	( void ) pxPort;
+
+	xSent = xStreamBufferSend( xCharsForTx, pcData, xLength, xBlockTime );
+
+	if( xSent > 0 )
+	{
+		/* The stream buffer is only read from interrupts, so rather than start
+		the DMA here let the TXE interrupt start it if it is not already
+		running. */
+		USART_ITConfig( USART1, USART_IT_TXE, ENABLE );
+	}
+
+	return xSent;
+}
+/*-----------------------------------------------------------*/
+
 void vSerialClose( xComPortHandle xPort )
 {
 	/* Not supported as not required by the demo application. */
 }
 /*-----------------------------------------------------------*/
 
+static void prvStartTxDMA( portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+size_t xLength;
+
+	xLength = xStreamBufferReceiveFromISR( xCharsForTx, ucTxDMABuffer, sizeof( ucTxDMABuffer ), pxHigherPriorityTaskWoken );
+
+	if( xLength > 0 )
+	{
+		/* The channel must be disabled while its length is written. */
+		DMA_Cmd( DMA_Channel4, DISABLE );
+		DMA_Channel4->CNDTR = ( u32 ) xLength;
+		DMA_Cmd( DMA_Channel4, ENABLE );
+		xTxInProgress = pdTRUE;
+	}
+	else
+	{
+		xTxInProgress = pdFALSE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyRxDMA( portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+unsigned portBASE_TYPE uxHead;
+
+	/* The DMA counts down the bytes remaining before it wraps. */
+	uxHead = serRX_DMA_BUFFER_SIZE - ( unsigned portBASE_TYPE ) DMA_GetCurrDataCounter( DMA_Channel5 );
+
+	if( uxHead == serRX_DMA_BUFFER_SIZE )
+	{
+		uxHead = 0;
+	}
+
+	if( uxHead < uxRxTail )
+	{
+		/* The data wraps past the end of the buffer. */
+		xStreamBufferSendFromISR( xRxedChars, &( ucRxDMABuffer[ uxRxTail ] ), serRX_DMA_BUFFER_SIZE - uxRxTail, pxHigherPriorityTaskWoken );
+		uxRxTail = 0;
+	}
+
+	if( uxHead > uxRxTail )
+	{
+		xStreamBufferSendFromISR( xRxedChars, &( ucRxDMABuffer[ uxRxTail ] ), uxHead - uxRxTail, pxHigherPriorityTaskWoken );
+	}
+
+	uxRxTail = uxHead;
+}
+/*-----------------------------------------------------------*/
+
 void vUARTInterruptHandler( void )
 {
 portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-char cChar;
 
 	if( USART_GetITStatus( USART1, USART_IT_TXE ) == SET )
 	{
-		/* The interrupt was caused by the THR becoming empty.  Are there any
-		more characters to transmit? */
-		if( xQueueReceiveFromISR( xCharsForTx, &cChar, &xHigherPriorityTaskWoken ) == pdTRUE )
+		/* Data was added to xCharsForTx.  If the DMA is already running it
+		will collect the data when it completes. */
+		USART_ITConfig( USART1, USART_IT_TXE, DISABLE );
+
+		if( xTxInProgress == pdFALSE )
 		{
-			/* A character was retrieved from the queue so can be sent to the
-			THR now. */
-			USART_SendData( USART1, cChar );
+			prvStartTxDMA( &xHigherPriorityTaskWoken );
 		}
-		else
-		{
-			USART_ITConfig( USART1, USART_IT_TXE, DISABLE );		
-		}		
 	}
 	
-	if( USART_GetITStatus( USART1, USART_IT_RXNE ) == SET )
+	if( USART_GetITStatus( USART1, USART_IT_IDLE ) == SET )
 	{
-		cChar = USART_ReceiveData( USART1 );
-		xQueueSendFromISR( xRxedChars, &cChar, &xHigherPriorityTaskWoken );
+		/* The idle flag is cleared by reading the status register, done
+		above, followed by the data register. */
+		( void ) USART_ReceiveData( USART1 );
+		prvCopyRxDMA( &xHigherPriorityTaskWoken );
 	}	
 	
 	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
 }
+/*-----------------------------------------------------------*/
+
+void vSerialTxDMAHandler( void )
+{
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
+	DMA_ClearITPendingBit( DMA_IT_GL4 );
 
+	/* Send the next block, if there is one. */
+	prvStartTxDMA( &xHigherPriorityTaskWoken );
 
+	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
 
+void vSerialRxDMAHandler( void )
+{
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
-	
+	DMA_ClearITPendingBit( DMA_IT_GL5 );
+	prvCopyRxDMA( &xHigherPriorityTaskWoken );
+
+	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+}
@@ -38,12 +38,12 @@
 //#define _CAN
 
 /************************************* DMA ************************************/
-//#define _DMA
+#define _DMA
 //#define _DMA_Channel1
 //#define _DMA_Channel2
 //#define _DMA_Channel3
-//#define _DMA_Channel4
-//#define _DMA_Channel5
+#define _DMA_Channel4
+#define _DMA_Channel5
 //#define _DMA_Channel6
 //#define _DMA_Channel7
 
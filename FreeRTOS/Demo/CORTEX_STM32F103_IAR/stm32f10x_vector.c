@@ -26,6 +26,8 @@ extern void xPortPendSVHandler( void );
 extern void xPortSysTickHandler( void );
 extern void vTimer2IntHandler( void );
 extern void vUARTInterruptHandler( void );
+extern void vSerialTxDMAHandler( void );
+extern void vSerialRxDMAHandler( void );
 extern void vPortSVCHandler( void );
 
 /* Private typedef -----------------------------------------------------------*/
@@ -75,8 +77,8 @@ const intvec_elem __vector_table[] =
   DMAChannel1_IRQHandler,
   DMAChannel2_IRQHandler,
   DMAChannel3_IRQHandler,
-  DMAChannel4_IRQHandler,
-  DMAChannel5_IRQHandler,
+  vSerialTxDMAHandler,
+  vSerialRxDMAHandler,
   DMAChannel6_IRQHandler,
   DMAChannel7_IRQHandler,
   ADC_IRQHandler,
@@ -28,6 +28,11 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+#if ( mpudemoENABLE_BENCHMARK == 1 )
+    /* Standard includes. */
+    #include <string.h>
+#endif
+
 /**
  * @brief Size of the shared memory region.
  */
@@ -63,6 +68,107 @@ static uint8_t ucSharedMemory[ SHARED_MEMORY_SIZE ] __attribute__( ( aligned( 32
 static volatile uint8_t ucROTaskFaultTracker[ SHARED_MEMORY_SIZE ] __attribute__( ( aligned( 32 ) ) ) = { 0 };
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Set to 1 in FreeRTOSConfig.h to measure the cost of MPU region
+ * switching.
+ */
+#ifndef mpudemoENABLE_BENCHMARK
+    #define mpudemoENABLE_BENCHMARK    0
+#endif
+
+#if ( mpudemoENABLE_BENCHMARK == 1 )
+
+/**
+ * @brief Number of round trips timed for every figure in
+ * MPUBenchmarkResults_t.
+ */
+    #define mpudemoBENCHMARK_ITERATIONS        ( 256UL )
+
+/**
+ * @brief Largest number of task regions measured - 8, or fewer if the port
+ * cannot give a task that many.
+ */
+    #define mpudemoBENCHMARK_MAX_REGIONS       ( ( portNUM_CONFIGURABLE_REGIONS < 8UL ) ? portNUM_CONFIGURABLE_REGIONS : 8UL )
+
+/**
+ * @brief Number of activities sharing one region set in the grouping
+ * measurement.
+ */
+    #define mpudemoBENCHMARK_NUM_ACTIVITIES    ( 4UL )
+
+/**
+ * @brief A worker's parameters are packed into pvParameters because an
+ * unprivileged worker cannot read a parameter structure in privileged RAM.
+ */
+    #define mpudemoWORKER_PARAMETERS( ulNext, ulActivities, ulDataRegions ) \
+    ( ( void * ) ( ( uintptr_t ) ( ( ulNext ) | ( ( ulActivities ) << 8UL ) | ( ( ulDataRegions ) << 16UL ) ) ) )
+    #define mpudemoWORKER_NEXT( ulParameters )            ( ( ulParameters ) & 0xFFUL )
+    #define mpudemoWORKER_ACTIVITIES( ulParameters )      ( ( ( ulParameters ) >> 8UL ) & 0xFFUL )
+    #define mpudemoWORKER_DATA_REGIONS( ulParameters )    ( ( ulParameters ) >> 16UL )
+
+/**
+ * @brief DWT registers used to count cycles. Only privileged code may access
+ * them, which is why the benchmark task itself is privileged.
+ */
+    #define mpudemoDEMCR                 ( *( ( volatile uint32_t * ) 0xE000EDFCUL ) )
+    #define mpudemoDEMCR_TRCENA          ( 1UL << 24UL )
+    #define mpudemoDWT_CTRL              ( *( ( volatile uint32_t * ) 0xE0001000UL ) )
+    #define mpudemoDWT_CTRL_CYCCNTENA    ( 1UL << 0UL )
+    #define mpudemoDWT_CYCCNT            ( *( ( volatile uint32_t * ) 0xE0001004UL ) )
+
+/**
+ * @brief Results of the MPU benchmark, all in CPU cycles.
+ *
+ * Switch costs are averages over mpudemoBENCHMARK_ITERATIONS round trips
+ * between the benchmark task and a worker, and include the task notification
+ * used to force each switch. Only differences between the figures are
+ * attributable to the MPU.
+ */
+    typedef struct MPUBenchmarkResults
+    {
+        uint32_t ulComplete;                                                   /**< Set to 1 once every other field has been filled in. */
+        uint32_t ulCycleCounterWorks;                                          /**< 0 if DWT_CYCCNT is not implemented, e.g. on Cortex-M23. */
+        uint32_t ulPrivilegedSwitchCycles;                                     /**< Switch to and from a privileged worker with no regions. */
+        uint32_t ulRestrictedSwitchCycles[ mpudemoBENCHMARK_MAX_REGIONS ];     /**< Index N: switch to and from an unprivileged worker with N + 1 regions. */
+        uint32_t ulSeparateTasksCyclesPerActivity;                             /**< Activities sharing a region set, one task each. */
+        uint32_t ulGroupedTaskCyclesPerActivity;                               /**< The same activities run by one task per region set. */
+    } MPUBenchmarkResults_t;
+
+/**
+ * @brief Benchmark results - inspect with a debugger once ulComplete is 1.
+ */
+    volatile MPUBenchmarkResults_t xMPUBenchmarkResults = { 0 };
+
+/**
+ * @brief Handle of the benchmark task, which workers at the end of the chain
+ * notify.
+ */
+    static TaskHandle_t xBenchmarkTask = NULL;
+
+/**
+ * @brief Task each worker notifies once it has run its activities, indexed by
+ * the worker's mpudemoWORKER_NEXT parameter, i.e. worker N notifies entry
+ * N + 1.
+ *
+ * This is always the first region of an unprivileged worker, which is why it
+ * is exactly 32 bytes.
+ */
+    static TaskHandle_t xBenchmarkChain[ 32 / sizeof( TaskHandle_t ) ] __attribute__( ( aligned( 32 ) ) );
+
+/**
+ * @brief Memory touched by the activities, one 32 byte region per row.
+ */
+    static uint32_t ulBenchmarkData[ mpudemoBENCHMARK_MAX_REGIONS ][ 8 ] __attribute__( ( aligned( 32 ) ) );
+
+/**
+ * @brief Workers currently alive and their stacks.
+ */
+    static TaskHandle_t xBenchmarkWorkers[ mpudemoBENCHMARK_NUM_ACTIVITIES ];
+    static StackType_t xBenchmarkWorkerStacks[ mpudemoBENCHMARK_NUM_ACTIVITIES ][ configMINIMAL_STACK_SIZE ] __attribute__( ( aligned( 32 ) ) );
+
+#endif /* mpudemoENABLE_BENCHMARK */
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Implements the task which has Read Only access to the memory region
  * ucSharedMemory.
@@ -79,6 +185,54 @@ static void prvROAccessTask( void * pvParameters );
  */
 static void prvRWAccessTask( void * pvParameters );
 
+#if ( mpudemoENABLE_BENCHMARK == 1 )
+
+/**
+ * @brief Implements the privileged task which creates the workers, times
+ * round trips through them and fills in xMPUBenchmarkResults.
+ *
+ * @param pvParameters[in] Parameters as passed during task creation.
+ */
+    static void prvBenchmarkTask( void * pvParameters );
+
+/**
+ * @brief Implements a worker which, each time it is notified, runs its
+ * activities and notifies the next task in xBenchmarkChain.
+ *
+ * @param pvParameters[in] Packed with mpudemoWORKER_PARAMETERS.
+ */
+    static void prvBenchmarkWorkerTask( void * pvParameters );
+
+/**
+ * @brief Creates worker ulWorker.
+ *
+ * An unprivileged worker gets xBenchmarkChain as its first region and
+ * ulNumRegions - 1 rows of ulBenchmarkData as the rest. A privileged worker
+ * gets no regions.
+ *
+ * @param ulWorker[in] Index of the worker, its stack and its handle.
+ * @param ulNumRegions[in] Number of regions, 0 for a privileged worker.
+ * @param ulActivities[in] Number of activities the worker runs per round.
+ */
+    static void prvCreateBenchmarkWorker( uint32_t ulWorker,
+                                          uint32_t ulNumRegions,
+                                          uint32_t ulActivities );
+
+/**
+ * @brief Deletes the first ulNumWorkers workers.
+ *
+ * @param ulNumWorkers[in] Number of workers to delete.
+ */
+    static void prvDeleteBenchmarkWorkers( uint32_t ulNumWorkers );
+
+/**
+ * @brief Times mpudemoBENCHMARK_ITERATIONS trips round the worker chain.
+ *
+ * @return The average number of cycles per round trip.
+ */
+    static uint32_t prvMeasureRoundTrip( void );
+
+#endif /* mpudemoENABLE_BENCHMARK */
 /*-----------------------------------------------------------*/
 
 static void prvROAccessTask( void * pvParameters )
@@ -280,9 +434,187 @@ void vStartMPUDemo( void )
 
     /* Create an unprivileged task with RW access to ucSharedMemory. */
     xTaskCreateRestricted( &( xRWAccessTaskParameters ), NULL );
+
+    #if ( mpudemoENABLE_BENCHMARK == 1 )
+    {
+        static StackType_t xBenchmarkTaskStack[ configMINIMAL_STACK_SIZE ] __attribute__( ( aligned( 32 ) ) );
+        TaskParameters_t xBenchmarkTaskParameters =
+        {
+            .pvTaskCode     = prvBenchmarkTask,
+            .pcName         = "MPUBench",
+            .usStackDepth   = configMINIMAL_STACK_SIZE,
+            .pvParameters   = NULL,
+            .uxPriority     = ( tskIDLE_PRIORITY + 1 ) | portPRIVILEGE_BIT,
+            .puxStackBuffer = xBenchmarkTaskStack,
+        };
+
+        /* Create a privileged task which measures the MPU overhead. */
+        xTaskCreateRestricted( &( xBenchmarkTaskParameters ), NULL );
+    }
+    #endif /* mpudemoENABLE_BENCHMARK */
 }
 /*-----------------------------------------------------------*/
 
+#if ( mpudemoENABLE_BENCHMARK == 1 )
+
+    static void prvBenchmarkWorkerTask( void * pvParameters )
+    {
+        uint32_t ulParameters = ( uint32_t ) ( uintptr_t ) pvParameters;
+        uint32_t ulActivity, ulRegion;
+
+        for( ; ; )
+        {
+            ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+            /* An activity touches every data region the worker has, so an
+             * unprivileged worker faults if its regions are not in place. */
+            for( ulActivity = 0; ulActivity < mpudemoWORKER_ACTIVITIES( ulParameters ); ulActivity++ )
+            {
+                for( ulRegion = 0; ulRegion < mpudemoWORKER_DATA_REGIONS( ulParameters ); ulRegion++ )
+                {
+                    ulBenchmarkData[ ulRegion ][ 0 ] += 1;
+                }
+            }
+
+            xTaskNotifyGive( xBenchmarkChain[ mpudemoWORKER_NEXT( ulParameters ) ] );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvCreateBenchmarkWorker( uint32_t ulWorker,
+                                          uint32_t ulNumRegions,
+                                          uint32_t ulActivities )
+    {
+        TaskParameters_t xWorkerTaskParameters;
+        uint32_t ulDataRegions = ( ulNumRegions > 0 ) ? ( ulNumRegions - 1UL ) : 0UL;
+        uint32_t ulRegion;
+
+        memset( &( xWorkerTaskParameters ), 0, sizeof( xWorkerTaskParameters ) );
+        xWorkerTaskParameters.pvTaskCode = prvBenchmarkWorkerTask;
+        xWorkerTaskParameters.pcName = "MPUWorker";
+        xWorkerTaskParameters.usStackDepth = configMINIMAL_STACK_SIZE;
+        xWorkerTaskParameters.pvParameters = mpudemoWORKER_PARAMETERS( ulWorker + 1UL, ulActivities, ulDataRegions );
+        xWorkerTaskParameters.uxPriority = tskIDLE_PRIORITY + 2;
+        xWorkerTaskParameters.puxStackBuffer = &( xBenchmarkWorkerStacks[ ulWorker ][ 0 ] );
+
+        if( ulNumRegions == 0 )
+        {
+            xWorkerTaskParameters.uxPriority |= portPRIVILEGE_BIT;
+        }
+        else
+        {
+            xWorkerTaskParameters.xRegions[ 0 ].pvBaseAddress = ( void * ) xBenchmarkChain;
+            xWorkerTaskParameters.xRegions[ 0 ].ulLengthInBytes = 32;
+            xWorkerTaskParameters.xRegions[ 0 ].ulParameters = tskMPU_REGION_READ_ONLY | tskMPU_REGION_EXECUTE_NEVER;
+
+            for( ulRegion = 0; ulRegion < ulDataRegions; ulRegion++ )
+            {
+                xWorkerTaskParameters.xRegions[ ulRegion + 1UL ].pvBaseAddress = ( void * ) ulBenchmarkData[ ulRegion ];
+                xWorkerTaskParameters.xRegions[ ulRegion + 1UL ].ulLengthInBytes = 32;
+                xWorkerTaskParameters.xRegions[ ulRegion + 1UL ].ulParameters = tskMPU_REGION_READ_WRITE | tskMPU_REGION_EXECUTE_NEVER;
+            }
+        }
+
+        /* The worker has the higher priority, so it runs straight away and
+         * blocks waiting for its first notification. */
+        xTaskCreateRestricted( &( xWorkerTaskParameters ), &( xBenchmarkWorkers[ ulWorker ] ) );
+        configASSERT( xBenchmarkWorkers[ ulWorker ] != NULL );
+
+        /* Workers are created in order, so the newest one is the last in
+         * the chain and hands back to the benchmark task. */
+        xBenchmarkChain[ ulWorker ] = xBenchmarkWorkers[ ulWorker ];
+        xBenchmarkChain[ ulWorker + 1UL ] = xBenchmarkTask;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvDeleteBenchmarkWorkers( uint32_t ulNumWorkers )
+    {
+        uint32_t ulWorker;
+
+        /* Workers are blocked, not running, so deleting them frees them
+         * immediately and their stacks can be reused at once. */
+        for( ulWorker = 0; ulWorker < ulNumWorkers; ulWorker++ )
+        {
+            vTaskDelete( xBenchmarkWorkers[ ulWorker ] );
+            xBenchmarkWorkers[ ulWorker ] = NULL;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static uint32_t prvMeasureRoundTrip( void )
+    {
+        uint32_t ulStart, ulEnd, i;
+
+        ulStart = mpudemoDWT_CYCCNT;
+
+        for( i = 0; i < mpudemoBENCHMARK_ITERATIONS; i++ )
+        {
+            xTaskNotifyGive( xBenchmarkWorkers[ 0 ] );
+            ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+
+        ulEnd = mpudemoDWT_CYCCNT;
+
+        return ( ulEnd - ulStart ) / mpudemoBENCHMARK_ITERATIONS;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvBenchmarkTask( void * pvParameters )
+    {
+        uint32_t ulStart, ulNumRegions, ulWorker;
+        ( void ) pvParameters;
+
+        xBenchmarkTask = xTaskGetCurrentTaskHandle();
+
+        /* Start the cycle counter and check that it is actually implemented -
+         * it is optional in ARMv8-M and absent on Cortex-M23. */
+        mpudemoDEMCR |= mpudemoDEMCR_TRCENA;
+        mpudemoDWT_CTRL |= mpudemoDWT_CTRL_CYCCNTENA;
+
+        ulStart = mpudemoDWT_CYCCNT;
+        __asm volatile ( "nop" );
+        __asm volatile ( "nop" );
+        xMPUBenchmarkResults.ulCycleCounterWorks = ( mpudemoDWT_CYCCNT != ulStart ) ? 1UL : 0UL;
+
+        /* Each round trip below is two switches: into the worker and back. */
+        prvCreateBenchmarkWorker( 0, 0, 1 );
+        xMPUBenchmarkResults.ulPrivilegedSwitchCycles = prvMeasureRoundTrip() / 2UL;
+        prvDeleteBenchmarkWorkers( 1 );
+
+        for( ulNumRegions = 1; ulNumRegions <= mpudemoBENCHMARK_MAX_REGIONS; ulNumRegions++ )
+        {
+            prvCreateBenchmarkWorker( 0, ulNumRegions, 1 );
+            xMPUBenchmarkResults.ulRestrictedSwitchCycles[ ulNumRegions - 1UL ] = prvMeasureRoundTrip() / 2UL;
+            prvDeleteBenchmarkWorkers( 1 );
+        }
+
+        /* Activities which all use the same region set, deployed one per
+         * task. Every hand-off between them is a task switch, and every task
+         * switch reprograms the MPU with a region set identical to the one it
+         * replaces. */
+        for( ulWorker = 0; ulWorker < mpudemoBENCHMARK_NUM_ACTIVITIES; ulWorker++ )
+        {
+            prvCreateBenchmarkWorker( ulWorker, mpudemoBENCHMARK_MAX_REGIONS, 1 );
+        }
+
+        xMPUBenchmarkResults.ulSeparateTasksCyclesPerActivity = prvMeasureRoundTrip() / mpudemoBENCHMARK_NUM_ACTIVITIES;
+        prvDeleteBenchmarkWorkers( mpudemoBENCHMARK_NUM_ACTIVITIES );
+
+        /* The same activities grouped into one task per region set. Moving
+         * from one activity to the next no longer switches tasks, so the MPU
+         * is only reprogrammed when the region set actually changes. */
+        prvCreateBenchmarkWorker( 0, mpudemoBENCHMARK_MAX_REGIONS, mpudemoBENCHMARK_NUM_ACTIVITIES );
+        xMPUBenchmarkResults.ulGroupedTaskCyclesPerActivity = prvMeasureRoundTrip() / mpudemoBENCHMARK_NUM_ACTIVITIES;
+        prvDeleteBenchmarkWorkers( 1 );
+
+        xMPUBenchmarkResults.ulComplete = 1UL;
+
+        vTaskDelete( NULL );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mpudemoENABLE_BENCHMARK */
+
 portDONT_DISCARD void vHandleMemoryFault( uint32_t * pulFaultStackAddress )
 {
     uint32_t ulPC;
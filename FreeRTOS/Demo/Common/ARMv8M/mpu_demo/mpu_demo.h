@@ -38,6 +38,15 @@
  * gracefully by moving the Program Counter to the next instruction to the one
  * which generated the fault. If any other memory access violation occurs, the
  * fault handler will get stuck in an infinite loop.
+ *
+ * If mpudemoENABLE_BENCHMARK is set to 1 in FreeRTOSConfig.h, a privileged
+ * task is also created which uses the DWT cycle counter to measure the cost
+ * of switching to a privileged task and to unprivileged tasks with 1 to 8
+ * regions. It also compares activities sharing one region set deployed one
+ * per task, where every hand-off reprograms the MPU with an identical region
+ * set, with the same activities grouped into a single task, where it does
+ * not. The results are left in xMPUBenchmarkResults for inspection with a
+ * debugger once its ulComplete member is 1.
  */
 void vStartMPUDemo( void );
 
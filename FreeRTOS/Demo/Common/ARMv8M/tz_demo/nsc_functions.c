@@ -37,6 +37,44 @@ static uint32_t ulSecureCounter = 0;
  * @brief typedef for non-secure callback.
  */
 typedef void ( *NonSecureCallback_t )( void ) __attribute__( ( cmse_nonsecure_call ) );
+
+/**
+ * @brief DWT cycle counter used to timestamp gateway entry.
+ *
+ * The DWT is not banked between security states, so the count read here is
+ * directly comparable with the one read by the non-secure caller.
+ */
+#define secureDWT_CYCCNT    ( *( ( volatile uint32_t * ) 0xE0001004UL ) )
+
+/**
+ * @brief Key mixed into each benchmark operation.
+ *
+ * Stands in for key material which never leaves the secure side.
+ */
+static const uint32_t ulSecureKey = 0x5A17C3E9UL;
+
+/**
+ * @brief Number of times any benchmark gateway has been entered.
+ */
+static uint32_t ulBenchmarkGatewayCalls = 0;
+
+/**
+ * @brief A small keyed transform standing in for one secure operation.
+ *
+ * Cheap enough that the gateway transition dominates the cost of a single
+ * call, which is exactly the case batching is meant to address.
+ */
+static uint32_t prvSecureOperation( uint32_t ulInput );
+/*-----------------------------------------------------------*/
+
+static uint32_t prvSecureOperation( uint32_t ulInput )
+{
+    uint32_t ulValue = ulInput ^ ulSecureKey;
+
+    ulValue = ( ulValue << 5 ) | ( ulValue >> 27 );
+
+    return ulValue * 0x9E3779B1UL;
+}
 /*-----------------------------------------------------------*/
 
 secureportNON_SECURE_CALLABLE uint32_t NSCFunction( Callback_t pxCallback )
@@ -56,3 +94,62 @@ secureportNON_SECURE_CALLABLE uint32_t NSCFunction( Callback_t pxCallback )
     return ulSecureCounter;
 }
 /*-----------------------------------------------------------*/
+
+secureportNON_SECURE_CALLABLE uint32_t NSCBenchmarkTimestamp( void )
+{
+    ulBenchmarkGatewayCalls += 1;
+
+    /* Nothing else happens between the SG instruction and this read, so the
+     * value returned splits a round trip into entry and exit costs. */
+    return secureDWT_CYCCNT;
+}
+/*-----------------------------------------------------------*/
+
+secureportNON_SECURE_CALLABLE uint32_t NSCBenchmarkOperation( uint32_t ulInput )
+{
+    ulBenchmarkGatewayCalls += 1;
+
+    return prvSecureOperation( ulInput );
+}
+/*-----------------------------------------------------------*/
+
+secureportNON_SECURE_CALLABLE uint32_t NSCBenchmarkBatch( uint32_t * pulData,
+                                                          uint32_t ulCount )
+{
+    uint32_t * pulCheckedData;
+    uint32_t i;
+
+    ulBenchmarkGatewayCalls += 1;
+
+    /* The buffer comes from the non-secure side, so make sure the caller is
+     * allowed to read and write all of it before touching it. The check is
+     * part of what a real batched gateway pays per call and is therefore
+     * deliberately included in the measurement. */
+    if( ( ulCount == 0 ) || ( ulCount > ( UINT32_MAX / sizeof( uint32_t ) ) ) )
+    {
+        return 0;
+    }
+
+    pulCheckedData = cmse_check_address_range( pulData,
+                                               ulCount * sizeof( uint32_t ),
+                                               CMSE_NONSECURE | CMSE_MPU_READWRITE );
+
+    if( pulCheckedData == NULL )
+    {
+        return 0;
+    }
+
+    for( i = 0; i < ulCount; i++ )
+    {
+        pulCheckedData[ i ] = prvSecureOperation( pulCheckedData[ i ] );
+    }
+
+    return ulCount;
+}
+/*-----------------------------------------------------------*/
+
+secureportNON_SECURE_CALLABLE uint32_t NSCBenchmarkGatewayCalls( void )
+{
+    return ulBenchmarkGatewayCalls;
+}
+/*-----------------------------------------------------------*/
@@ -47,4 +47,45 @@ typedef void ( * Callback_t ) ( void );
  */
 uint32_t NSCFunction( Callback_t pxCallback );
 
+/**
+ * @brief Returns the DWT cycle count read on the secure side.
+ *
+ * The gateway does nothing else, so timestamping just before and just after
+ * the call measures the cost of entering and leaving the secure state.
+ *
+ * @return The value of DWT_CYCCNT sampled inside the secure state.
+ */
+uint32_t NSCBenchmarkTimestamp( void );
+
+/**
+ * @brief Performs one secure operation per gateway call.
+ *
+ * @param ulInput[in] The value to transform with the secure key.
+ *
+ * @return The transformed value.
+ */
+uint32_t NSCBenchmarkOperation( uint32_t ulInput );
+
+/**
+ * @brief Performs ulCount secure operations in a single gateway call.
+ *
+ * Each word of pulData is replaced by the value NSCBenchmarkOperation would
+ * have returned for it.
+ *
+ * @param pulData[in, out] Non-secure buffer of ulCount words.
+ * @param ulCount[in] Number of words in pulData.
+ *
+ * @return ulCount on success, 0 if the buffer is not accessible to the
+ * non-secure caller.
+ */
+uint32_t NSCBenchmarkBatch( uint32_t * pulData,
+                            uint32_t ulCount );
+
+/**
+ * @brief Returns the number of times any benchmark gateway has been entered.
+ *
+ * @return The secure side count of benchmark gateway calls.
+ */
+uint32_t NSCBenchmarkGatewayCalls( void );
+
 #endif /* __NSC_FUNCTIONS_H__ */
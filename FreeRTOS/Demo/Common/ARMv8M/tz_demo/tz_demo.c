@@ -44,6 +44,91 @@
 static uint32_t ulNonSecureCounter[ 8 ] __attribute__( ( aligned( 32 ) ) ) = { 0 };
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Set to 1 in FreeRTOSConfig.h to measure the cost of secure calls.
+ */
+#ifndef tzdemoENABLE_BENCHMARK
+    #define tzdemoENABLE_BENCHMARK    0
+#endif
+
+#if ( tzdemoENABLE_BENCHMARK == 1 )
+
+/**
+ * @brief Number of samples taken for every figure in TZBenchmarkResults_t.
+ */
+    #define tzdemoBENCHMARK_ITERATIONS         ( 256UL )
+
+/**
+ * @brief Batch sizes measured are 1, 2, 4 ... up to this many operations.
+ */
+    #define tzdemoBENCHMARK_NUM_BATCH_SIZES    ( 5UL )
+    #define tzdemoBENCHMARK_MAX_BATCH_SIZE     ( 1UL << ( tzdemoBENCHMARK_NUM_BATCH_SIZES - 1UL ) )
+
+/**
+ * @brief Commands sent from the benchmark task to its partner task.
+ */
+    #define tzdemoPARTNER_REPLY                      ( 1UL )
+    #define tzdemoPARTNER_ALLOCATE_SECURE_CONTEXT    ( 2UL )
+    #define tzdemoPARTNER_EXIT                       ( 3UL )
+
+/**
+ * @brief DWT registers used to count cycles.
+ *
+ * Only privileged code may access them, which is why the benchmark tasks are
+ * privileged unlike the rest of this demo.
+ */
+    #define tzdemoDEMCR                ( *( ( volatile uint32_t * ) 0xE000EDFCUL ) )
+    #define tzdemoDEMCR_TRCENA         ( 1UL << 24UL )
+    #define tzdemoDWT_CTRL             ( *( ( volatile uint32_t * ) 0xE0001000UL ) )
+    #define tzdemoDWT_CTRL_CYCCNTENA   ( 1UL << 0UL )
+    #define tzdemoDWT_CTRL_CYCDISS     ( 1UL << 23UL )
+    #define tzdemoDWT_CYCCNT           ( *( ( volatile uint32_t * ) 0xE0001004UL ) )
+
+/**
+ * @brief Results of the secure call benchmark, all in CPU cycles.
+ *
+ * Call costs are the minimum over tzdemoBENCHMARK_ITERATIONS samples so that
+ * the odd tick interrupt does not skew them. Task switch costs are averages
+ * and include the task notification used to force the switch - only the
+ * difference between the two switch figures is attributable to TrustZone.
+ */
+    typedef struct TZBenchmarkResults
+    {
+        uint32_t ulComplete;                                                      /**< Set to 1 once every other field has been filled in. */
+        uint32_t ulCycleCounterWorks;                                             /**< 0 if DWT_CYCCNT is not implemented, e.g. on Cortex-M23. */
+        uint32_t ulSecureCyclesHidden;                                            /**< 1 if DWT_CYCCNT stops in the secure state, making secure side time invisible. */
+        uint32_t ulNonSecureCallCycles;                                           /**< Round trip through an empty non-secure function - the baseline. */
+        uint32_t ulSecureCallCycles;                                              /**< Round trip through an empty NSC gateway. */
+        uint32_t ulSecureEntryCycles;                                             /**< Non-secure call to the first secure instruction. */
+        uint32_t ulSecureExitCycles;                                              /**< Last secure instruction back to the non-secure caller. */
+        uint32_t ulTaskSwitchCycles;                                              /**< Switch between two tasks without a secure context. */
+        uint32_t ulSecureTaskSwitchCycles;                                        /**< Switch between two tasks which both have a secure context. */
+        uint32_t ulBatchSize[ tzdemoBENCHMARK_NUM_BATCH_SIZES ];                  /**< Operations per batch for the two arrays below. */
+        uint32_t ulSeparateCallCyclesPerOperation[ tzdemoBENCHMARK_NUM_BATCH_SIZES ]; /**< One gateway call per operation. */
+        uint32_t ulBatchedCallCyclesPerOperation[ tzdemoBENCHMARK_NUM_BATCH_SIZES ];  /**< One gateway call for the whole batch. */
+    } TZBenchmarkResults_t;
+
+/**
+ * @brief Benchmark results - inspect with a debugger once ulComplete is 1.
+ */
+    volatile TZBenchmarkResults_t xTZBenchmarkResults = { 0 };
+
+/**
+ * @brief Handles of the two benchmark tasks so they can notify each other.
+ */
+    static TaskHandle_t xBenchmarkTask = NULL;
+    static TaskHandle_t xBenchmarkPartnerTask = NULL;
+
+/**
+ * @brief Buffers holding the operands of the batch benchmark.
+ */
+    static uint32_t ulBatchInput[ tzdemoBENCHMARK_MAX_BATCH_SIZE ];
+    static uint32_t ulSeparateOutput[ tzdemoBENCHMARK_MAX_BATCH_SIZE ];
+    static uint32_t ulBatchedOutput[ tzdemoBENCHMARK_MAX_BATCH_SIZE ];
+
+#endif /* tzdemoENABLE_BENCHMARK */
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Creates all the tasks for TZ demo.
  */
@@ -63,6 +148,62 @@ static void prvCallback( void );
  * @param pvParameters[in] Parameters as passed during task creation.
  */
 static void prvSecureCallingTask( void * pvParameters );
+
+#if ( tzdemoENABLE_BENCHMARK == 1 )
+
+/**
+ * @brief Creates the two privileged tasks which run the benchmark.
+ */
+    static void prvCreateBenchmarkTasks( void );
+
+/**
+ * @brief Implements the task which measures the cost of secure calls and
+ * fills in xTZBenchmarkResults.
+ *
+ * @param pvParameters[in] Parameters as passed during task creation.
+ */
+    static void prvBenchmarkTask( void * pvParameters );
+
+/**
+ * @brief Implements the higher priority task which the benchmark task
+ * switches to and from to measure the task switch cost.
+ *
+ * @param pvParameters[in] Parameters as passed during task creation.
+ */
+    static void prvBenchmarkPartnerTask( void * pvParameters );
+
+/**
+ * @brief Non-secure equivalent of NSCBenchmarkTimestamp used as the baseline.
+ *
+ * @return The value of DWT_CYCCNT.
+ */
+    static uint32_t prvNonSecureTimestamp( void ) __attribute__( ( noinline ) );
+
+/**
+ * @brief Returns the average cost of one switch between the benchmark task
+ * and its partner task.
+ *
+ * @return The average number of cycles per task switch.
+ */
+    static uint32_t prvMeasureTaskSwitch( void );
+
+/**
+ * @brief Measures the cost of the empty gateway and of the non-secure
+ * baseline.
+ */
+    static void prvMeasureCallCost( void );
+
+/**
+ * @brief Measures the cost per operation of ulBatchSize operations, once
+ * with a gateway call per operation and once with a single batched call.
+ *
+ * @param ulIndex[in] Index into the batch arrays of xTZBenchmarkResults.
+ * @param ulBatchSize[in] Number of operations to perform.
+ */
+    static void prvMeasureBatch( uint32_t ulIndex,
+                                 uint32_t ulBatchSize );
+
+#endif /* tzdemoENABLE_BENCHMARK */
 /*-----------------------------------------------------------*/
 
 void vStartTZDemo( void )
@@ -86,6 +227,12 @@ void vStartTZDemo( void )
 
     /* Create an unprivileged task which calls secure functions. */
     xTaskCreateRestricted( &( xSecureCallingTaskParameters ), NULL );
+
+    #if ( tzdemoENABLE_BENCHMARK == 1 )
+    {
+        prvCreateBenchmarkTasks();
+    }
+    #endif
 }
 /*-----------------------------------------------------------*/
 
@@ -131,3 +278,249 @@ static void prvSecureCallingTask( void * pvParameters )
     }
 }
 /*-----------------------------------------------------------*/
+
+#if ( tzdemoENABLE_BENCHMARK == 1 )
+
+    static void prvCreateBenchmarkTasks( void )
+    {
+        static StackType_t xBenchmarkTaskStack[ configMINIMAL_STACK_SIZE ] __attribute__( ( aligned( 32 ) ) );
+        static StackType_t xBenchmarkPartnerTaskStack[ configMINIMAL_STACK_SIZE ] __attribute__( ( aligned( 32 ) ) );
+        TaskParameters_t xBenchmarkTaskParameters =
+        {
+            .pvTaskCode     = prvBenchmarkTask,
+            .pcName         = "TZBench",
+            .usStackDepth   = configMINIMAL_STACK_SIZE,
+            .pvParameters   = NULL,
+            .uxPriority     = ( tskIDLE_PRIORITY + 1 ) | portPRIVILEGE_BIT,
+            .puxStackBuffer = xBenchmarkTaskStack,
+            .xRegions       =
+            {
+                { 0, 0, 0 },
+                { 0, 0, 0 },
+                { 0, 0, 0 },
+            }
+        };
+        TaskParameters_t xBenchmarkPartnerTaskParameters =
+        {
+            .pvTaskCode     = prvBenchmarkPartnerTask,
+            .pcName         = "TZBenchPtnr",
+            .usStackDepth   = configMINIMAL_STACK_SIZE,
+            .pvParameters   = NULL,
+            .uxPriority     = ( tskIDLE_PRIORITY + 2 ) | portPRIVILEGE_BIT,
+            .puxStackBuffer = xBenchmarkPartnerTaskStack,
+            .xRegions       =
+            {
+                { 0, 0, 0 },
+                { 0, 0, 0 },
+                { 0, 0, 0 },
+            }
+        };
+
+        /* The partner only uses xBenchmarkTask once the benchmark task has
+         * notified it, so creating the partner first is always safe. */
+        xTaskCreateRestricted( &( xBenchmarkPartnerTaskParameters ), &( xBenchmarkPartnerTask ) );
+        xTaskCreateRestricted( &( xBenchmarkTaskParameters ), &( xBenchmarkTask ) );
+    }
+/*-----------------------------------------------------------*/
+
+    static uint32_t prvNonSecureTimestamp( void )
+    {
+        return tzdemoDWT_CYCCNT;
+    }
+/*-----------------------------------------------------------*/
+
+    static uint32_t prvMeasureTaskSwitch( void )
+    {
+        uint32_t ulStart, ulEnd, i;
+
+        ulStart = tzdemoDWT_CYCCNT;
+
+        for( i = 0; i < tzdemoBENCHMARK_ITERATIONS; i++ )
+        {
+            /* The partner has the higher priority, so notifying it switches to
+             * it and its reply switches back - two switches per iteration. */
+            xTaskNotify( xBenchmarkPartnerTask, tzdemoPARTNER_REPLY, eSetValueWithOverwrite );
+            ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+
+        ulEnd = tzdemoDWT_CYCCNT;
+
+        return ( ulEnd - ulStart ) / ( 2UL * tzdemoBENCHMARK_ITERATIONS );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvMeasureCallCost( void )
+    {
+        uint32_t ulStart, ulInside, ulEnd, i;
+        uint32_t ulNonSecure = UINT32_MAX, ulSecure = UINT32_MAX;
+        uint32_t ulEntry = UINT32_MAX, ulExit = UINT32_MAX;
+
+        for( i = 0; i < tzdemoBENCHMARK_ITERATIONS; i++ )
+        {
+            ulStart = tzdemoDWT_CYCCNT;
+            ( void ) prvNonSecureTimestamp();
+            ulEnd = tzdemoDWT_CYCCNT;
+
+            if( ( ulEnd - ulStart ) < ulNonSecure )
+            {
+                ulNonSecure = ulEnd - ulStart;
+            }
+
+            ulStart = tzdemoDWT_CYCCNT;
+            ulInside = NSCBenchmarkTimestamp();
+            ulEnd = tzdemoDWT_CYCCNT;
+
+            if( ( ulEnd - ulStart ) < ulSecure )
+            {
+                ulSecure = ulEnd - ulStart;
+            }
+
+            if( ( ulInside - ulStart ) < ulEntry )
+            {
+                ulEntry = ulInside - ulStart;
+            }
+
+            if( ( ulEnd - ulInside ) < ulExit )
+            {
+                ulExit = ulEnd - ulInside;
+            }
+        }
+
+        xTZBenchmarkResults.ulNonSecureCallCycles = ulNonSecure;
+        xTZBenchmarkResults.ulSecureCallCycles = ulSecure;
+        xTZBenchmarkResults.ulSecureEntryCycles = ulEntry;
+        xTZBenchmarkResults.ulSecureExitCycles = ulExit;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvMeasureBatch( uint32_t ulIndex,
+                                 uint32_t ulBatchSize )
+    {
+        uint32_t ulStart, ulEnd, ulProcessed, i, j;
+        uint32_t ulSeparate = UINT32_MAX, ulBatched = UINT32_MAX;
+
+        for( i = 0; i < tzdemoBENCHMARK_ITERATIONS; i++ )
+        {
+            for( j = 0; j < ulBatchSize; j++ )
+            {
+                ulBatchInput[ j ] = ( i * tzdemoBENCHMARK_MAX_BATCH_SIZE ) + j;
+                ulBatchedOutput[ j ] = ulBatchInput[ j ];
+            }
+
+            ulStart = tzdemoDWT_CYCCNT;
+
+            for( j = 0; j < ulBatchSize; j++ )
+            {
+                ulSeparateOutput[ j ] = NSCBenchmarkOperation( ulBatchInput[ j ] );
+            }
+
+            ulEnd = tzdemoDWT_CYCCNT;
+
+            if( ( ulEnd - ulStart ) < ulSeparate )
+            {
+                ulSeparate = ulEnd - ulStart;
+            }
+
+            ulStart = tzdemoDWT_CYCCNT;
+            ulProcessed = NSCBenchmarkBatch( ulBatchedOutput, ulBatchSize );
+            ulEnd = tzdemoDWT_CYCCNT;
+
+            configASSERT( ulProcessed == ulBatchSize );
+            ( void ) ulProcessed;
+
+            if( ( ulEnd - ulStart ) < ulBatched )
+            {
+                ulBatched = ulEnd - ulStart;
+            }
+
+            /* Both ways of calling must compute the same thing. */
+            for( j = 0; j < ulBatchSize; j++ )
+            {
+                configASSERT( ulSeparateOutput[ j ] == ulBatchedOutput[ j ] );
+            }
+        }
+
+        xTZBenchmarkResults.ulBatchSize[ ulIndex ] = ulBatchSize;
+        xTZBenchmarkResults.ulSeparateCallCyclesPerOperation[ ulIndex ] = ulSeparate / ulBatchSize;
+        xTZBenchmarkResults.ulBatchedCallCyclesPerOperation[ ulIndex ] = ulBatched / ulBatchSize;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvBenchmarkTask( void * pvParameters )
+    {
+        uint32_t ulStart, ulGatewayCalls, i;
+
+        ( void ) pvParameters;
+
+        /* Start the cycle counter and check that it is actually implemented -
+         * it is optional in ARMv8-M and absent on Cortex-M23. */
+        tzdemoDEMCR |= tzdemoDEMCR_TRCENA;
+        tzdemoDWT_CTRL |= tzdemoDWT_CTRL_CYCCNTENA;
+
+        ulStart = tzdemoDWT_CYCCNT;
+        __asm volatile ( "nop" );
+        __asm volatile ( "nop" );
+        xTZBenchmarkResults.ulCycleCounterWorks = ( tzdemoDWT_CYCCNT != ulStart ) ? 1UL : 0UL;
+        xTZBenchmarkResults.ulSecureCyclesHidden = ( ( tzdemoDWT_CTRL & tzdemoDWT_CTRL_CYCDISS ) != 0UL ) ? 1UL : 0UL;
+
+        /* Neither task has a secure context yet, so no secure state needs to
+         * be saved or restored on a switch. */
+        xTZBenchmarkResults.ulTaskSwitchCycles = prvMeasureTaskSwitch();
+
+        /* Give both tasks a secure context and measure again. The difference
+         * is the cost of switching the secure stack. */
+        portALLOCATE_SECURE_CONTEXT( configMINIMAL_SECURE_STACK_SIZE );
+        xTaskNotify( xBenchmarkPartnerTask, tzdemoPARTNER_ALLOCATE_SECURE_CONTEXT, eSetValueWithOverwrite );
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        xTZBenchmarkResults.ulSecureTaskSwitchCycles = prvMeasureTaskSwitch();
+
+        xTaskNotify( xBenchmarkPartnerTask, tzdemoPARTNER_EXIT, eSetValueWithOverwrite );
+
+        ulGatewayCalls = NSCBenchmarkGatewayCalls();
+
+        prvMeasureCallCost();
+
+        for( i = 0; i < tzdemoBENCHMARK_NUM_BATCH_SIZES; i++ )
+        {
+            prvMeasureBatch( i, 1UL << i );
+        }
+
+        /* Check the secure side saw every call made from here. One empty
+         * gateway call per call cost sample, plus per batch size one call per
+         * operation and one batched call, for every iteration. */
+        configASSERT( ( NSCBenchmarkGatewayCalls() - ulGatewayCalls ) ==
+                      ( tzdemoBENCHMARK_ITERATIONS * ( 1UL + ( ( 2UL * tzdemoBENCHMARK_MAX_BATCH_SIZE ) - 1UL ) + tzdemoBENCHMARK_NUM_BATCH_SIZES ) ) );
+
+        xTZBenchmarkResults.ulComplete = 1UL;
+
+        vTaskDelete( NULL );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvBenchmarkPartnerTask( void * pvParameters )
+    {
+        uint32_t ulCommand = 0;
+
+        ( void ) pvParameters;
+
+        while( ulCommand != tzdemoPARTNER_EXIT )
+        {
+            xTaskNotifyWait( 0UL, UINT32_MAX, &( ulCommand ), portMAX_DELAY );
+
+            if( ulCommand == tzdemoPARTNER_ALLOCATE_SECURE_CONTEXT )
+            {
+                portALLOCATE_SECURE_CONTEXT( configMINIMAL_SECURE_STACK_SIZE );
+            }
+
+            if( ulCommand != tzdemoPARTNER_EXIT )
+            {
+                xTaskNotifyGive( xBenchmarkTask );
+            }
+        }
+
+        vTaskDelete( NULL );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* tzdemoENABLE_BENCHMARK */
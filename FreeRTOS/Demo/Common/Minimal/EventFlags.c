@@ -0,0 +1,537 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Event flags that interrupts set directly, and tasks that test them.
+ *
+ * xEventGroupSetBitsFromISR() posts the set to the timer service task, so an
+ * event signalled by an interrupt reaches the waiting task only after the
+ * timer task has run.  Event flags bound the number of waiting tasks to
+ * configEVENT_FLAGS_MAX_WAITERS, so the set can be done in the interrupt,
+ * which notifies each waiting task whose condition it meets.
+ *
+ * The latency task waits for a bit set by the tick hook, alternately through
+ * event flags and, if the timer service and xTimerPendFunctionCall() are
+ * included, through an event group.  The interrupt reads
+ * configEVENT_FLAGS_CYCLE_COUNT() as it sets the bit and the task reads it
+ * again as soon as it runs.  After efLATENCY_SAMPLES of each the average and
+ * worst case are reported once through configDEMO_REPORT().
+ *
+ * The tick hook also sets a second bit each time, and a low priority task sets
+ * a third.  Another task waits for both with clear on exit, which tests tasks
+ * waiting for all of a set of bits, bits set from both a task and an
+ * interrupt, and more than one task waiting on the same flags.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+/* Demo includes. */
+#include "EventFlags.h"
+#include "DemoReport.h"
+
+/* Read a free running count in the interrupt and the task.  It need only count
+ * in the same units in both. */
+#ifndef configEVENT_FLAGS_CYCLE_COUNT
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        #define configEVENT_FLAGS_CYCLE_COUNT()    ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+    #else
+        /* The latency is then reported as 0, but the flags are still tested. */
+        #define configEVENT_FLAGS_CYCLE_COUNT()    ( ( uint32_t ) 0 )
+    #endif
+#endif
+
+/* The event group comparison needs the set to be deferred to the timer task. */
+#if ( ( configUSE_TIMERS == 1 ) && ( INCLUDE_xTimerPendFunctionCall == 1 ) )
+    #define efMEASURE_EVENT_GROUP    1
+#else
+    #define efMEASURE_EVENT_GROUP    0
+#endif
+
+/* The bits used by the tests. */
+#define efLATENCY_BIT            ( ( EventBits_t ) 0x01 )
+#define efISR_BIT                ( ( EventBits_t ) 0x02 )
+#define efTASK_BIT               ( ( EventBits_t ) 0x04 )
+#define efALL_BITS               ( efISR_BIT | efTASK_BIT )
+
+/* What the latency task is waiting on, so the interrupt knows what to set. */
+#define efWAITING_ON_NOTHING     0
+#define efWAITING_ON_FLAGS       1
+#define efWAITING_ON_GROUP       2
+
+/* The number of interrupt to task latencies measured for each before the
+ * result is reported. */
+#define efLATENCY_SAMPLES        64
+
+/* The interrupt sets the bits every efISR_PERIOD ticks, and the set task sets
+ * its bit every efTASK_SET_PERIOD ticks. */
+#define efISR_PERIOD             ( 10UL )
+#define efTASK_SET_PERIOD        pdMS_TO_TICKS( ( TickType_t ) 15 )
+
+/* The longest the waiting tasks wait before an error is latched. */
+#define efRX_BLOCK_TIME          pdMS_TO_TICKS( ( TickType_t ) 500 )
+
+/* The latency task runs at the highest priority so that it is the task the
+ * interrupt, or the timer task, switches to. */
+#define efLATENCY_TASK_PRIORITY  ( configMAX_PRIORITIES - 1 )
+
+/*
+ * Returns pdTRUE if uxCurrentBits meets a wait for uxBitsToWaitFor.
+ */
+static BaseType_t prvConditionMet( EventBits_t uxCurrentBits,
+                                   EventBits_t uxBitsToWaitFor,
+                                   BaseType_t xWaitForAllBits );
+
+/*
+ * The tasks described at the top of this file.
+ */
+static void prvLatencyTask( void * pvParameters );
+static void prvWaitAllTask( void * pvParameters );
+static void prvSetTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static EventFlags_t xEventFlags;
+
+#if ( efMEASURE_EVENT_GROUP == 1 )
+    static EventGroupHandle_t xEventGroup = NULL;
+#endif
+
+/* Written by the latency task before it waits, and by the interrupt when it
+ * has set the bit. */
+static volatile BaseType_t xWaitingOn = efWAITING_ON_NOTHING;
+static volatile uint32_t ulSetTime = 0;
+
+/* Set to pdFAIL if an error is detected.  The cycle counters are only
+ * incremented while xEventFlagsStatus equals pdPASS. */
+static volatile BaseType_t xEventFlagsStatus = pdPASS;
+static volatile uint32_t ulLatencyCycles = 0, ulWaitAllCycles = 0;
+
+/*-----------------------------------------------------------*/
+
+void vEventFlagsInit( EventFlags_t * pxFlags )
+{
+    UBaseType_t x;
+
+    configASSERT( pxFlags );
+
+    pxFlags->uxEventBits = 0;
+
+    for( x = 0; x < configEVENT_FLAGS_MAX_WAITERS; x++ )
+    {
+        pxFlags->xWaiters[ x ].xTask = NULL;
+        pxFlags->xWaiters[ x ].xNotified = pdFALSE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xEventFlagsSet( EventFlags_t * pxFlags,
+                            EventBits_t uxBitsToSet )
+{
+    EventFlagsWaiter_t * pxWaiter;
+    EventBits_t uxReturn;
+    UBaseType_t x;
+
+    configASSERT( pxFlags );
+
+    taskENTER_CRITICAL();
+    {
+        pxFlags->uxEventBits |= uxBitsToSet;
+        uxReturn = pxFlags->uxEventBits;
+
+        /* Notify inside the critical section so a waiting task cannot time
+         * out, and perhaps be deleted, between being chosen and notified. */
+        for( x = 0; x < configEVENT_FLAGS_MAX_WAITERS; x++ )
+        {
+            pxWaiter = &( pxFlags->xWaiters[ x ] );
+
+            if( ( pxWaiter->xTask != NULL ) && ( pxWaiter->xNotified == pdFALSE ) &&
+                ( prvConditionMet( uxReturn, pxWaiter->uxBitsToWaitFor, pxWaiter->xWaitForAllBits ) != pdFALSE ) )
+            {
+                pxWaiter->xNotified = pdTRUE;
+                xTaskNotifyGiveIndexed( pxWaiter->xTask, configEVENT_FLAGS_NOTIFY_INDEX );
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xEventFlagsSetFromISR( EventFlags_t * pxFlags,
+                                   EventBits_t uxBitsToSet,
+                                   BaseType_t * pxHigherPriorityTaskWoken )
+{
+    EventFlagsWaiter_t * pxWaiter;
+    EventBits_t uxReturn;
+    UBaseType_t x, uxSavedInterruptStatus;
+
+    configASSERT( pxFlags );
+
+    /* At most configEVENT_FLAGS_MAX_WAITERS tasks are notified, so the time
+     * spent with interrupts masked is bounded. */
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        pxFlags->uxEventBits |= uxBitsToSet;
+        uxReturn = pxFlags->uxEventBits;
+
+        for( x = 0; x < configEVENT_FLAGS_MAX_WAITERS; x++ )
+        {
+            pxWaiter = &( pxFlags->xWaiters[ x ] );
+
+            if( ( pxWaiter->xTask != NULL ) && ( pxWaiter->xNotified == pdFALSE ) &&
+                ( prvConditionMet( uxReturn, pxWaiter->uxBitsToWaitFor, pxWaiter->xWaitForAllBits ) != pdFALSE ) )
+            {
+                pxWaiter->xNotified = pdTRUE;
+                vTaskNotifyGiveIndexedFromISR( pxWaiter->xTask, configEVENT_FLAGS_NOTIFY_INDEX, pxHigherPriorityTaskWoken );
+            }
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xEventFlagsClear( EventFlags_t * pxFlags,
+                              EventBits_t uxBitsToClear )
+{
+    EventBits_t uxReturn;
+
+    configASSERT( pxFlags );
+
+    /* Return the bits as they were before they were cleared, as
+     * xEventGroupClearBits() does. */
+    taskENTER_CRITICAL();
+    {
+        uxReturn = pxFlags->uxEventBits;
+        pxFlags->uxEventBits &= ~uxBitsToClear;
+    }
+    taskEXIT_CRITICAL();
+
+    return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xEventFlagsGet( EventFlags_t * pxFlags )
+{
+    configASSERT( pxFlags );
+
+    return pxFlags->uxEventBits;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xEventFlagsWait( EventFlags_t * pxFlags,
+                             EventBits_t uxBitsToWaitFor,
+                             BaseType_t xClearOnExit,
+                             BaseType_t xWaitForAllBits,
+                             TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+    EventFlagsWaiter_t * pxWaiter = NULL;
+    EventBits_t uxReturn;
+    BaseType_t xDone = pdFALSE;
+    UBaseType_t x;
+
+    configASSERT( pxFlags );
+    configASSERT( uxBitsToWaitFor != 0 );
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ; ; )
+    {
+        taskENTER_CRITICAL();
+        {
+            uxReturn = pxFlags->uxEventBits;
+
+            if( prvConditionMet( uxReturn, uxBitsToWaitFor, xWaitForAllBits ) != pdFALSE )
+            {
+                if( xClearOnExit != pdFALSE )
+                {
+                    pxFlags->uxEventBits &= ~uxBitsToWaitFor;
+                }
+
+                xDone = pdTRUE;
+            }
+            else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+            {
+                xDone = pdTRUE;
+            }
+            else if( pxWaiter == NULL )
+            {
+                for( x = 0; x < configEVENT_FLAGS_MAX_WAITERS; x++ )
+                {
+                    if( pxFlags->xWaiters[ x ].xTask == NULL )
+                    {
+                        pxWaiter = &( pxFlags->xWaiters[ x ] );
+                        pxWaiter->xTask = xTaskGetCurrentTaskHandle();
+                        pxWaiter->uxBitsToWaitFor = uxBitsToWaitFor;
+                        pxWaiter->xWaitForAllBits = xWaitForAllBits;
+                        pxWaiter->xNotified = pdFALSE;
+                        break;
+                    }
+                }
+
+                /* More tasks are waiting than configEVENT_FLAGS_MAX_WAITERS
+                 * allows.  Return as if the wait had timed out. */
+                configASSERT( pxWaiter );
+
+                if( pxWaiter == NULL )
+                {
+                    xDone = pdTRUE;
+                }
+            }
+            else
+            {
+                /* Woken, but another task cleared the bits on exit before this
+                 * one ran, or the notification was left from an earlier wait.
+                 * Let the next set notify this task again. */
+                pxWaiter->xNotified = pdFALSE;
+            }
+
+            if( ( xDone != pdFALSE ) && ( pxWaiter != NULL ) )
+            {
+                pxWaiter->xTask = NULL;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xDone != pdFALSE )
+        {
+            break;
+        }
+
+        ( void ) ulTaskNotifyTakeIndexed( configEVENT_FLAGS_NOTIFY_INDEX, pdTRUE, xTicksToWait );
+    }
+
+    return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvConditionMet( EventBits_t uxCurrentBits,
+                                   EventBits_t uxBitsToWaitFor,
+                                   BaseType_t xWaitForAllBits )
+{
+    BaseType_t xReturn;
+
+    if( xWaitForAllBits == pdFALSE )
+    {
+        xReturn = ( ( uxCurrentBits & uxBitsToWaitFor ) != 0 ) ? pdTRUE : pdFALSE;
+    }
+    else
+    {
+        xReturn = ( ( uxCurrentBits & uxBitsToWaitFor ) == uxBitsToWaitFor ) ? pdTRUE : pdFALSE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vStartEventFlagsTasks( void )
+{
+    vEventFlagsInit( &xEventFlags );
+
+    #if ( efMEASURE_EVENT_GROUP == 1 )
+    {
+        xEventGroup = xEventGroupCreate();
+        configASSERT( xEventGroup );
+    }
+    #endif
+
+    xTaskCreate( prvLatencyTask, "EFLat", configMINIMAL_STACK_SIZE, NULL, efLATENCY_TASK_PRIORITY, NULL );
+    xTaskCreate( prvWaitAllTask, "EFAll", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL );
+    xTaskCreate( prvSetTask, "EFSet", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvLatencyTask( void * pvParameters )
+{
+    uint32_t ulLatency, ulTotal[ 3 ] = { 0 }, ulWorst[ 3 ] = { 0 };
+    UBaseType_t uxSamples = 0;
+    BaseType_t xPath = efWAITING_ON_FLAGS, xReported = pdFALSE;
+    EventBits_t uxBits;
+
+    /* Remove compiler warnings. */
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        xWaitingOn = xPath;
+
+        #if ( efMEASURE_EVENT_GROUP == 1 )
+            if( xPath == efWAITING_ON_GROUP )
+            {
+                uxBits = xEventGroupWaitBits( xEventGroup, efLATENCY_BIT, pdTRUE, pdFALSE, efRX_BLOCK_TIME );
+            }
+            else
+        #endif
+        {
+            uxBits = xEventFlagsWait( &xEventFlags, efLATENCY_BIT, pdTRUE, pdFALSE, efRX_BLOCK_TIME );
+        }
+
+        ulLatency = configEVENT_FLAGS_CYCLE_COUNT() - ulSetTime;
+
+        if( ( uxBits & efLATENCY_BIT ) == 0 )
+        {
+            /* Timed out, so the set was lost. */
+            xEventFlagsStatus = pdFAIL;
+        }
+
+        ulTotal[ xPath ] += ulLatency;
+
+        if( ulLatency > ulWorst[ xPath ] )
+        {
+            ulWorst[ xPath ] = ulLatency;
+        }
+
+        if( xEventFlagsStatus == pdPASS )
+        {
+            ulLatencyCycles++;
+        }
+
+        uxSamples++;
+
+        if( uxSamples >= efLATENCY_SAMPLES )
+        {
+            uxSamples = 0;
+
+            #if ( efMEASURE_EVENT_GROUP == 1 )
+                if( xPath == efWAITING_ON_FLAGS )
+                {
+                    xPath = efWAITING_ON_GROUP;
+                }
+                else
+            #endif
+            {
+                xPath = efWAITING_ON_FLAGS;
+
+                if( xReported == pdFALSE )
+                {
+                    xReported = pdTRUE;
+
+                    configDEMO_REPORT( ( "Event flags ISR to task: average %u, worst %u\r\n",
+                                         ( unsigned ) ( ulTotal[ efWAITING_ON_FLAGS ] / efLATENCY_SAMPLES ),
+                                         ( unsigned ) ulWorst[ efWAITING_ON_FLAGS ] ) );
+
+                    #if ( efMEASURE_EVENT_GROUP == 1 )
+                        configDEMO_REPORT( ( "Event group ISR to task: average %u, worst %u\r\n",
+                                             ( unsigned ) ( ulTotal[ efWAITING_ON_GROUP ] / efLATENCY_SAMPLES ),
+                                             ( unsigned ) ulWorst[ efWAITING_ON_GROUP ] ) );
+                    #endif
+                }
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitAllTask( void * pvParameters )
+{
+    EventBits_t uxBits;
+
+    /* Remove compiler warnings. */
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        uxBits = xEventFlagsWait( &xEventFlags, efALL_BITS, pdTRUE, pdTRUE, efRX_BLOCK_TIME );
+
+        if( ( uxBits & efALL_BITS ) != efALL_BITS )
+        {
+            /* Timed out, so a set was lost. */
+            xEventFlagsStatus = pdFAIL;
+        }
+        else if( xEventFlagsStatus == pdPASS )
+        {
+            ulWaitAllCycles++;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetTask( void * pvParameters )
+{
+    /* Remove compiler warnings. */
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        vTaskDelay( efTASK_SET_PERIOD );
+        ( void ) xEventFlagsSet( &xEventFlags, efTASK_BIT );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vEventFlagsSetFromISRTest( void )
+{
+    static uint32_t ulCallCount = 0;
+    BaseType_t xPath;
+
+    /* It is intended that this function is called from the tick hook
+     * function, so each call is one tick period apart. */
+    ulCallCount++;
+
+    if( ulCallCount >= efISR_PERIOD )
+    {
+        ulCallCount = 0;
+        xPath = xWaitingOn;
+        xWaitingOn = efWAITING_ON_NOTHING;
+        ulSetTime = configEVENT_FLAGS_CYCLE_COUNT();
+
+        #if ( efMEASURE_EVENT_GROUP == 1 )
+            if( xPath == efWAITING_ON_GROUP )
+            {
+                /* Try again next time if the timer command queue is full. */
+                if( xEventGroupSetBitsFromISR( xEventGroup, efLATENCY_BIT, NULL ) != pdPASS )
+                {
+                    xWaitingOn = xPath;
+                }
+            }
+        #endif
+
+        ( void ) xEventFlagsSetFromISR( &xEventFlags, ( xPath == efWAITING_ON_FLAGS ) ? ( efISR_BIT | efLATENCY_BIT ) : efISR_BIT, NULL );
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreEventFlagsTasksStillRunning( void )
+{
+    static uint32_t ulLastLatencyCycles = 0, ulLastWaitAllCycles = 0;
+
+    if( ( ulLastLatencyCycles == ulLatencyCycles ) || ( ulLastWaitAllCycles == ulWaitAllCycles ) )
+    {
+        xEventFlagsStatus = pdFAIL;
+    }
+
+    ulLastLatencyCycles = ulLatencyCycles;
+    ulLastWaitAllCycles = ulWaitAllCycles;
+
+    return xEventFlagsStatus;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,880 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures how long a heap takes to allocate and free, and how fragmented it
+ * becomes, under workloads shaped like those of a device running TLS and HTTP
+ * connections.  Nothing is checked - the results are reported through
+ * configDEMO_REPORT().
+ *
+ * xHeapBenchmarkGenerateWorkload() models hbCONNECTIONS connections, each of
+ * which repeatedly:
+ *
+ * + Opens - allocating the blocks that live as long as the connection: for
+ *   TLS the SSL context and configuration and the input and output record
+ *   buffers, and for plain HTTP the connection state and the response buffer.
+ * + For TLS only, handshakes - allocating and freeing many small and medium
+ *   blocks, as certificate parsing and bignum arithmetic do, then keeping a
+ *   session and a copy of the peer certificate once the handshake is done.
+ * + Makes between one and four requests - allocating a header buffer, strings
+ *   and body chunks that are freed in between, then freeing what is left at
+ *   the end of the request.
+ * + Closes - freeing the connection's blocks in a random order.
+ *
+ * Each step of the workload is taken by a connection chosen at random, so
+ * blocks with short and long lifetimes are interleaved in the heap as they are
+ * on a real device, which is what causes fragmentation.
+ *
+ * The task created by vStartHeapBenchmarkTask() replays each workload against
+ * the heap that pvPortMalloc() uses and against a TLSF heap (TLSFHeap.c) of
+ * hbTLSF_HEAP_SIZE bytes.  Both are accessed with the scheduler suspended, so
+ * the same locking cost is included in each.  The system heap is left in
+ * whatever state the workload leaves it in, so the results are most
+ * meaningful if nothing else is using the heap while the benchmark runs.
+ * Allocations that fail are counted but not timed.  The workload must fit in
+ * the heap, or vApplicationMallocFailedHook() will be called, so reduce
+ * hbCONNECTIONS or the buffer sizes on devices with small heaps.
+ *
+ * Times are read with configHEAP_BENCHMARK_CYCLE_COUNT(), which should be
+ * defined in FreeRTOSConfig.h to read a free running cycle counter.  If it is
+ * not defined then the run time stats counter is used.  The fragmentation
+ * measurements need vPortGetHeapStats(), which heap_4.c, heap_5.c and
+ * TLSFHeap.c provide; set hbUSE_HEAP_STATS to 0 for any other heap.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo program include files. */
+#include "TLSFHeap.h"
+#include "HeapBenchmark.h"
+#include "DemoReport.h"
+
+#if ( INCLUDE_vTaskDelete != 1 )
+    #error This file uses vTaskDelete() so INCLUDE_vTaskDelete must be set to 1 in FreeRTOSConfig.h.
+#endif
+
+#ifndef configHEAP_BENCHMARK_CYCLE_COUNT
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        #define configHEAP_BENCHMARK_CYCLE_COUNT()    ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+    #else
+        #error Define configHEAP_BENCHMARK_CYCLE_COUNT() in FreeRTOSConfig.h to return a free running cycle count.
+    #endif
+#endif
+
+/* Set to 0 if the heap does not provide vPortGetHeapStats(). */
+#ifndef hbUSE_HEAP_STATS
+    #define hbUSE_HEAP_STATS    1
+#endif
+
+/* The number of connections open at once in the generated workloads. */
+#ifndef hbCONNECTIONS
+    #define hbCONNECTIONS    2
+#endif
+
+/* The number of events in each workload replayed by the task. */
+#ifndef hbWORKLOAD_EVENTS
+    #define hbWORKLOAD_EVENTS    1024
+#endif
+
+/* The size of the region given to the TLSF heap. */
+#ifndef hbTLSF_HEAP_SIZE
+    #define hbTLSF_HEAP_SIZE    ( 40U * 1024U )
+#endif
+
+/* The size of each TLS record buffer, which is the negotiated maximum
+ * fragment length plus room for the record header, IV and MAC. */
+#ifndef hbTLS_RECORD_BUFFER_SIZE
+    #define hbTLS_RECORD_BUFFER_SIZE    ( 2048U + 256U )
+#endif
+
+/* The size of the buffer an HTTP response is received into. */
+#ifndef hbHTTP_BUFFER_SIZE
+    #define hbHTTP_BUFFER_SIZE    1024U
+#endif
+
+/* The seed of the first workload.  Each workload uses the next seed. */
+#ifndef hbSEED
+    #define hbSEED    0x1234UL
+#endif
+
+/* The most blocks a connection holds for its lifetime, and the most short
+ * lived blocks it holds at once. */
+#define hbMAX_LONG_LIVED    6
+#define hbMAX_TEMPORARY     24
+
+#if ( ( hbCONNECTIONS * ( hbMAX_LONG_LIVED + hbMAX_TEMPORARY ) ) > hbMAX_SLOTS )
+    #error hbMAX_SLOTS is too small for hbCONNECTIONS connections.
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The stages a generated connection goes through. */
+typedef enum
+{
+    eOpen,      /* Allocating the blocks kept until the connection closes. */
+    eHandshake, /* Allocating and freeing short lived handshake blocks. */
+    eEstablish, /* Allocating the blocks kept once the handshake is done. */
+    eRequest,   /* Allocating and freeing the blocks of one request. */
+    eDrain,     /* Freeing the short lived blocks left at the end of a stage. */
+    eClose      /* Freeing the blocks kept for the connection. */
+} eConnectionState;
+
+typedef struct HeapBenchmarkConnection
+{
+    BaseType_t xTLS;
+    eConnectionState eState;
+    eConnectionState eStateAfterDrain;
+    UBaseType_t uxSteps;    /* Steps left in the handshake or request. */
+    UBaseType_t uxRequests; /* Requests left before the connection closes. */
+    UBaseType_t uxLongLived;
+    UBaseType_t uxTemporary;
+    uint16_t usLongLived[ hbMAX_LONG_LIVED ];
+    uint16_t usTemporary[ hbMAX_TEMPORARY ];
+} HeapBenchmarkConnection_t;
+
+/* Times collected for allocations or for frees. */
+typedef struct HeapBenchmarkStats
+{
+    uint32_t ulMin;
+    uint32_t ulMax;
+    uint32_t ulTotal;
+    uint32_t ulCount;
+} HeapBenchmarkStats_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task that runs each workload against each heap in turn.
+ */
+static void prvHeapBenchmarkTask( void * pvParameters );
+
+/*
+ * Write the next event of pxConnection to the workload being generated.
+ */
+static void prvConnectionStep( HeapBenchmarkConnection_t * pxConnection );
+
+/*
+ * Write an event that allocates xSize bytes into a free slot, and store the
+ * slot at pusSlot, or write an event that frees usSlot.
+ */
+static void prvAddAllocate( uint16_t * pusSlot,
+                            uint32_t ulSize );
+static void prvAddFree( uint16_t usSlot );
+
+/*
+ * Remove a randomly chosen slot from pusSlots, which holds *puxCount slots,
+ * and write an event that frees it.
+ */
+static void prvFreeRandom( uint16_t * pusSlots,
+                           UBaseType_t * puxCount );
+
+/*
+ * Returns a pseudo random number less than uxRange.
+ */
+static UBaseType_t prvRandom( UBaseType_t uxRange );
+
+/*
+ * The allocator interface for the heap used by pvPortMalloc() and for the
+ * TLSF heap.
+ */
+static void * prvSystemMalloc( void * pvContext,
+                               size_t xSize );
+static void prvSystemFree( void * pvContext,
+                           void * pv );
+static void * prvTLSFMalloc( void * pvContext,
+                             size_t xSize );
+static void prvTLSFFree( void * pvContext,
+                         void * pv );
+static size_t prvTLSFGetFreeSize( void * pvContext );
+static size_t prvTLSFGetLargestFreeBlockSize( void * pvContext );
+
+#if ( hbUSE_HEAP_STATS == 1 )
+    static size_t prvSystemGetFreeSize( void * pvContext );
+    static size_t prvSystemGetLargestFreeBlockSize( void * pvContext );
+#endif
+
+/*
+ * Collect and output the samples.
+ */
+static void prvResetStats( HeapBenchmarkStats_t * pxStats );
+static void prvAddSample( HeapBenchmarkStats_t * pxStats,
+                          uint32_t ulStart,
+                          uint32_t ulEnd );
+static void prvReport( const char * pcWorkload,
+                       const HeapBenchmarkAllocator_t * pxAllocator,
+                       size_t xEventCount,
+                       const HeapBenchmarkResult_t * pxResult );
+
+/*-----------------------------------------------------------*/
+
+/* The blocks the long lived allocations of a connection are made from. */
+static const uint32_t ulTLSOpenSizes[] = { 460U, 320U, hbTLS_RECORD_BUFFER_SIZE, hbTLS_RECORD_BUFFER_SIZE };
+static const uint32_t ulTLSEstablishSizes[] = { 160U, 1100U };
+static const uint32_t ulHTTPOpenSizes[] = { 180U, hbHTTP_BUFFER_SIZE };
+
+static const char * const pcWorkloadNames[] = { "tls", "http", "mixed" };
+
+/* The state of the workload being generated. */
+static uint32_t ulRandom = 0;
+static eHeapBenchmarkWorkload eGeneratedWorkload = eHeapBenchmarkTLS;
+static HeapBenchmarkConnection_t xConnections[ hbCONNECTIONS ];
+static HeapBenchmarkEvent_t * pxGeneratedEvents = NULL;
+static size_t xGeneratedEvents = 0;
+static uint16_t usFreeSlots[ hbMAX_SLOTS ];
+static UBaseType_t uxFreeSlots = 0;
+
+/* The blocks held by the workload being replayed. */
+static void * pvSlots[ hbMAX_SLOTS ];
+static uint32_t ulSlotSizes[ hbMAX_SLOTS ];
+
+/* Set when all the benchmarks have run. */
+static volatile BaseType_t xBenchmarksComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+size_t xHeapBenchmarkGenerateWorkload( eHeapBenchmarkWorkload eWorkload,
+                                       uint32_t ulSeed,
+                                       HeapBenchmarkEvent_t * pxEvents,
+                                       size_t xMaxEvents )
+{
+    UBaseType_t x, y;
+
+    configASSERT( pxEvents );
+
+    ulRandom = ulSeed;
+    eGeneratedWorkload = eWorkload;
+    pxGeneratedEvents = pxEvents;
+    xGeneratedEvents = 0;
+
+    for( x = 0; x < hbMAX_SLOTS; x++ )
+    {
+        usFreeSlots[ x ] = ( uint16_t ) ( hbMAX_SLOTS - 1U - x );
+    }
+
+    uxFreeSlots = hbMAX_SLOTS;
+
+    memset( xConnections, 0x00, sizeof( xConnections ) );
+
+    for( x = 0; x < hbCONNECTIONS; x++ )
+    {
+        xConnections[ x ].eState = eOpen;
+        xConnections[ x ].xTLS = ( eWorkload == eHeapBenchmarkHTTP ) ? pdFALSE : pdTRUE;
+
+        if( ( eWorkload == eHeapBenchmarkMixed ) && ( ( x & 1U ) != 0U ) )
+        {
+            xConnections[ x ].xTLS = pdFALSE;
+        }
+    }
+
+    /* Each step writes one event and allocates at most one block, so stop
+     * while there is still room to free every block that is allocated. */
+    while( ( xGeneratedEvents + ( hbMAX_SLOTS - uxFreeSlots ) + 2U ) <= xMaxEvents )
+    {
+        prvConnectionStep( &xConnections[ prvRandom( hbCONNECTIONS ) ] );
+    }
+
+    for( x = 0; x < hbCONNECTIONS; x++ )
+    {
+        for( y = 0; y < xConnections[ x ].uxTemporary; y++ )
+        {
+            prvAddFree( xConnections[ x ].usTemporary[ y ] );
+        }
+
+        for( y = 0; y < xConnections[ x ].uxLongLived; y++ )
+        {
+            prvAddFree( xConnections[ x ].usLongLived[ y ] );
+        }
+    }
+
+    return xGeneratedEvents;
+}
+/*-----------------------------------------------------------*/
+
+void vHeapBenchmarkReplay( const HeapBenchmarkAllocator_t * pxAllocator,
+                           const HeapBenchmarkEvent_t * pxEvents,
+                           size_t xEventCount,
+                           HeapBenchmarkResult_t * pxResult )
+{
+    HeapBenchmarkStats_t xAllocStats, xFreeStats;
+    size_t x, xRequested = 0, xFree, xLargest;
+    uint32_t ulStart, ulEnd, ulFragmentation;
+    uint16_t usSlot;
+    void * pv;
+
+    configASSERT( pxAllocator );
+    configASSERT( pxEvents );
+    configASSERT( pxResult );
+
+    memset( pxResult, 0x00, sizeof( HeapBenchmarkResult_t ) );
+    memset( pvSlots, 0x00, sizeof( pvSlots ) );
+    prvResetStats( &xAllocStats );
+    prvResetStats( &xFreeStats );
+    pxResult->xMinimumFreeBytes = ( size_t ) -1;
+
+    for( x = 0; x < xEventCount; x++ )
+    {
+        usSlot = pxEvents[ x ].usSlot;
+        configASSERT( usSlot < hbMAX_SLOTS );
+
+        if( pxEvents[ x ].ulSize != 0U )
+        {
+            configASSERT( pvSlots[ usSlot ] == NULL );
+
+            ulStart = configHEAP_BENCHMARK_CYCLE_COUNT();
+            pv = pxAllocator->pvMalloc( pxAllocator->pvContext, ( size_t ) pxEvents[ x ].ulSize );
+            ulEnd = configHEAP_BENCHMARK_CYCLE_COUNT();
+
+            pxResult->ulAllocations++;
+
+            if( pv == NULL )
+            {
+                pxResult->ulFailedAllocations++;
+            }
+            else
+            {
+                prvAddSample( &xAllocStats, ulStart, ulEnd );
+                pvSlots[ usSlot ] = pv;
+                ulSlotSizes[ usSlot ] = pxEvents[ x ].ulSize;
+                xRequested += ( size_t ) pxEvents[ x ].ulSize;
+
+                if( xRequested > pxResult->xPeakRequestedBytes )
+                {
+                    pxResult->xPeakRequestedBytes = xRequested;
+                }
+            }
+        }
+        else if( pvSlots[ usSlot ] != NULL )
+        {
+            ulStart = configHEAP_BENCHMARK_CYCLE_COUNT();
+            pxAllocator->vFree( pxAllocator->pvContext, pvSlots[ usSlot ] );
+            ulEnd = configHEAP_BENCHMARK_CYCLE_COUNT();
+
+            prvAddSample( &xFreeStats, ulStart, ulEnd );
+            pxResult->ulFrees++;
+            pvSlots[ usSlot ] = NULL;
+            xRequested -= ( size_t ) ulSlotSizes[ usSlot ];
+        }
+        else
+        {
+            /* The allocation this frees failed. */
+        }
+
+        /* Sample the state of the heap outside of the timed sections. */
+        if( pxAllocator->xGetFreeSize != NULL )
+        {
+            xFree = pxAllocator->xGetFreeSize( pxAllocator->pvContext );
+
+            if( xFree < pxResult->xMinimumFreeBytes )
+            {
+                pxResult->xMinimumFreeBytes = xFree;
+            }
+
+            if( ( pxAllocator->xGetLargestFreeBlockSize != NULL ) && ( xFree > 0U ) )
+            {
+                xLargest = pxAllocator->xGetLargestFreeBlockSize( pxAllocator->pvContext );
+                ulFragmentation = ( uint32_t ) ( ( ( xFree - xLargest ) * 100U ) / xFree );
+
+                if( ulFragmentation > pxResult->ulWorstFragmentation )
+                {
+                    pxResult->ulWorstFragmentation = ulFragmentation;
+                }
+            }
+        }
+    }
+
+    /* Free anything a recorded workload did not. */
+    for( x = 0; x < hbMAX_SLOTS; x++ )
+    {
+        if( pvSlots[ x ] != NULL )
+        {
+            pxAllocator->vFree( pxAllocator->pvContext, pvSlots[ x ] );
+            pvSlots[ x ] = NULL;
+        }
+    }
+
+    if( pxResult->xMinimumFreeBytes == ( size_t ) -1 )
+    {
+        pxResult->xMinimumFreeBytes = 0;
+    }
+
+    pxResult->ulMinAllocCycles = ( xAllocStats.ulCount != 0U ) ? xAllocStats.ulMin : 0U;
+    pxResult->ulAverageAllocCycles = ( xAllocStats.ulCount != 0U ) ? ( xAllocStats.ulTotal / xAllocStats.ulCount ) : 0U;
+    pxResult->ulMaxAllocCycles = xAllocStats.ulMax;
+    pxResult->ulMinFreeCycles = ( xFreeStats.ulCount != 0U ) ? xFreeStats.ulMin : 0U;
+    pxResult->ulAverageFreeCycles = ( xFreeStats.ulCount != 0U ) ? ( xFreeStats.ulTotal / xFreeStats.ulCount ) : 0U;
+    pxResult->ulMaxFreeCycles = xFreeStats.ulMax;
+}
+/*-----------------------------------------------------------*/
+
+void vStartHeapBenchmarkTask( UBaseType_t uxPriority )
+{
+    xTaskCreate( prvHeapBenchmarkTask, "HeapBench", configMINIMAL_STACK_SIZE * 2, NULL, uxPriority, NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreHeapBenchmarksComplete( void )
+{
+    return xBenchmarksComplete;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapBenchmarkTask( void * pvParameters )
+{
+    static HeapBenchmarkEvent_t xEvents[ hbWORKLOAD_EVENTS ];
+    static uint8_t ucTLSFRegion[ hbTLSF_HEAP_SIZE ];
+    static TLSFHeap_t xTLSFHeap;
+    HeapBenchmarkAllocator_t xSystemAllocator, xTLSFAllocator;
+    HeapBenchmarkResult_t xResult;
+    size_t xEventCount;
+    UBaseType_t x;
+
+    /* The parameter is not used. */
+    ( void ) pvParameters;
+
+    memset( &xSystemAllocator, 0x00, sizeof( xSystemAllocator ) );
+    xSystemAllocator.pcName = "system";
+    xSystemAllocator.pvMalloc = prvSystemMalloc;
+    xSystemAllocator.vFree = prvSystemFree;
+
+    #if ( hbUSE_HEAP_STATS == 1 )
+        {
+            xSystemAllocator.xGetFreeSize = prvSystemGetFreeSize;
+            xSystemAllocator.xGetLargestFreeBlockSize = prvSystemGetLargestFreeBlockSize;
+        }
+    #endif
+
+    xTLSFAllocator.pcName = "tlsf";
+    xTLSFAllocator.pvMalloc = prvTLSFMalloc;
+    xTLSFAllocator.vFree = prvTLSFFree;
+    xTLSFAllocator.xGetFreeSize = prvTLSFGetFreeSize;
+    xTLSFAllocator.xGetLargestFreeBlockSize = prvTLSFGetLargestFreeBlockSize;
+    xTLSFAllocator.pvContext = &xTLSFHeap;
+
+    configDEMO_REPORT( ( "Heap benchmark: %u connections, %u events per workload\r\n",
+                         ( unsigned ) hbCONNECTIONS,
+                         ( unsigned ) hbWORKLOAD_EVENTS ) );
+
+    for( x = 0; x < ( sizeof( pcWorkloadNames ) / sizeof( pcWorkloadNames[ 0 ] ) ); x++ )
+    {
+        xEventCount = xHeapBenchmarkGenerateWorkload( ( eHeapBenchmarkWorkload ) x, hbSEED + ( uint32_t ) x, xEvents, hbWORKLOAD_EVENTS );
+
+        vHeapBenchmarkReplay( &xSystemAllocator, xEvents, xEventCount, &xResult );
+        prvReport( pcWorkloadNames[ x ], &xSystemAllocator, xEventCount, &xResult );
+
+        /* Start each workload with an empty TLSF heap. */
+        ( void ) xTLSFHeapInitialise( &xTLSFHeap, ucTLSFRegion, sizeof( ucTLSFRegion ) );
+        vHeapBenchmarkReplay( &xTLSFAllocator, xEvents, xEventCount, &xResult );
+        prvReport( pcWorkloadNames[ x ], &xTLSFAllocator, xEventCount, &xResult );
+    }
+
+    configDEMO_REPORT( ( "Heap benchmark: complete\r\n" ) );
+    xBenchmarksComplete = pdTRUE;
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvConnectionStep( HeapBenchmarkConnection_t * pxConnection )
+{
+    BaseType_t xEventWritten = pdFALSE;
+    UBaseType_t uxIndex, uxRandom;
+
+    while( xEventWritten == pdFALSE )
+    {
+        switch( pxConnection->eState )
+        {
+            case eOpen:
+                uxIndex = pxConnection->uxLongLived;
+
+                if( ( pxConnection->xTLS != pdFALSE ) && ( uxIndex < ( sizeof( ulTLSOpenSizes ) / sizeof( ulTLSOpenSizes[ 0 ] ) ) ) )
+                {
+                    prvAddAllocate( &pxConnection->usLongLived[ pxConnection->uxLongLived++ ], ulTLSOpenSizes[ uxIndex ] );
+                    xEventWritten = pdTRUE;
+                }
+                else if( ( pxConnection->xTLS == pdFALSE ) && ( uxIndex < ( sizeof( ulHTTPOpenSizes ) / sizeof( ulHTTPOpenSizes[ 0 ] ) ) ) )
+                {
+                    prvAddAllocate( &pxConnection->usLongLived[ pxConnection->uxLongLived++ ], ulHTTPOpenSizes[ uxIndex ] );
+                    xEventWritten = pdTRUE;
+                }
+                else if( pxConnection->xTLS != pdFALSE )
+                {
+                    pxConnection->eState = eHandshake;
+                    pxConnection->uxSteps = 40U + prvRandom( 60U );
+                }
+                else
+                {
+                    pxConnection->eState = eRequest;
+                    pxConnection->uxSteps = 0;
+                    pxConnection->uxRequests = 1U + prvRandom( 4U );
+                }
+
+                break;
+
+            case eHandshake:
+
+                if( pxConnection->uxSteps == 0U )
+                {
+                    pxConnection->eState = eDrain;
+                    pxConnection->eStateAfterDrain = eEstablish;
+                }
+                else
+                {
+                    pxConnection->uxSteps--;
+
+                    if( ( pxConnection->uxTemporary == hbMAX_TEMPORARY ) ||
+                        ( ( pxConnection->uxTemporary > 0U ) && ( prvRandom( 100U ) < 45U ) ) )
+                    {
+                        prvFreeRandom( pxConnection->usTemporary, &pxConnection->uxTemporary );
+                    }
+                    else
+                    {
+                        /* Mostly ASN.1 and name parsing, then bignums and key
+                         * exchange, and occasionally a certificate. */
+                        uxRandom = prvRandom( 100U );
+
+                        if( uxRandom < 60U )
+                        {
+                            uxRandom = 16U + prvRandom( 240U );
+                        }
+                        else if( uxRandom < 90U )
+                        {
+                            uxRandom = 256U + prvRandom( 512U );
+                        }
+                        else
+                        {
+                            uxRandom = 768U + prvRandom( 1280U );
+                        }
+
+                        prvAddAllocate( &pxConnection->usTemporary[ pxConnection->uxTemporary++ ], ( uint32_t ) uxRandom );
+                    }
+
+                    xEventWritten = pdTRUE;
+                }
+
+                break;
+
+            case eEstablish:
+                uxIndex = pxConnection->uxLongLived - ( sizeof( ulTLSOpenSizes ) / sizeof( ulTLSOpenSizes[ 0 ] ) );
+
+                if( uxIndex < ( sizeof( ulTLSEstablishSizes ) / sizeof( ulTLSEstablishSizes[ 0 ] ) ) )
+                {
+                    prvAddAllocate( &pxConnection->usLongLived[ pxConnection->uxLongLived++ ], ulTLSEstablishSizes[ uxIndex ] );
+                    xEventWritten = pdTRUE;
+                }
+                else
+                {
+                    pxConnection->eState = eRequest;
+                    pxConnection->uxSteps = 0;
+                    pxConnection->uxRequests = 1U + prvRandom( 4U );
+                }
+
+                break;
+
+            case eRequest:
+
+                if( pxConnection->uxSteps == 0U )
+                {
+                    if( pxConnection->uxTemporary > 0U )
+                    {
+                        /* The previous request has finished. */
+                        pxConnection->eState = eDrain;
+                        pxConnection->eStateAfterDrain = eRequest;
+                    }
+                    else if( pxConnection->uxRequests == 0U )
+                    {
+                        pxConnection->eState = eClose;
+                    }
+                    else
+                    {
+                        /* Start a request with its header buffer. */
+                        pxConnection->uxRequests--;
+                        pxConnection->uxSteps = 10U + prvRandom( 20U );
+                        prvAddAllocate( &pxConnection->usTemporary[ pxConnection->uxTemporary++ ], ( uint32_t ) ( 256U + prvRandom( 768U ) ) );
+                        xEventWritten = pdTRUE;
+                    }
+                }
+                else
+                {
+                    pxConnection->uxSteps--;
+
+                    if( ( pxConnection->uxTemporary == hbMAX_TEMPORARY ) ||
+                        ( ( pxConnection->uxTemporary > 1U ) && ( prvRandom( 100U ) < 40U ) ) )
+                    {
+                        prvFreeRandom( pxConnection->usTemporary, &pxConnection->uxTemporary );
+                    }
+                    else if( prvRandom( 100U ) < 45U )
+                    {
+                        /* A URL, header value or JSON string. */
+                        prvAddAllocate( &pxConnection->usTemporary[ pxConnection->uxTemporary++ ], ( uint32_t ) ( 16U + prvRandom( 112U ) ) );
+                    }
+                    else
+                    {
+                        /* A chunk of the body, up to one TCP segment. */
+                        prvAddAllocate( &pxConnection->usTemporary[ pxConnection->uxTemporary++ ], ( uint32_t ) ( 512U + prvRandom( 949U ) ) );
+                    }
+
+                    xEventWritten = pdTRUE;
+                }
+
+                break;
+
+            case eDrain:
+
+                if( pxConnection->uxTemporary > 0U )
+                {
+                    pxConnection->uxTemporary--;
+                    prvAddFree( pxConnection->usTemporary[ pxConnection->uxTemporary ] );
+                    xEventWritten = pdTRUE;
+                }
+                else
+                {
+                    pxConnection->eState = pxConnection->eStateAfterDrain;
+                }
+
+                break;
+
+            case eClose:
+            default:
+
+                if( pxConnection->uxLongLived > 0U )
+                {
+                    prvFreeRandom( pxConnection->usLongLived, &pxConnection->uxLongLived );
+                    xEventWritten = pdTRUE;
+                }
+                else
+                {
+                    /* Open the next connection, which in the mixed workload
+                     * can be either kind. */
+                    if( eGeneratedWorkload == eHeapBenchmarkMixed )
+                    {
+                        pxConnection->xTLS = ( prvRandom( 2U ) == 0U ) ? pdTRUE : pdFALSE;
+                    }
+
+                    pxConnection->eState = eOpen;
+                }
+
+                break;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddAllocate( uint16_t * pusSlot,
+                            uint32_t ulSize )
+{
+    configASSERT( uxFreeSlots > 0U );
+
+    uxFreeSlots--;
+    *pusSlot = usFreeSlots[ uxFreeSlots ];
+    pxGeneratedEvents[ xGeneratedEvents ].ulSize = ulSize;
+    pxGeneratedEvents[ xGeneratedEvents ].usSlot = *pusSlot;
+    xGeneratedEvents++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddFree( uint16_t usSlot )
+{
+    usFreeSlots[ uxFreeSlots ] = usSlot;
+    uxFreeSlots++;
+    pxGeneratedEvents[ xGeneratedEvents ].ulSize = 0;
+    pxGeneratedEvents[ xGeneratedEvents ].usSlot = usSlot;
+    xGeneratedEvents++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFreeRandom( uint16_t * pusSlots,
+                           UBaseType_t * puxCount )
+{
+    UBaseType_t uxIndex = prvRandom( *puxCount );
+
+    prvAddFree( pusSlots[ uxIndex ] );
+    ( *puxCount )--;
+    pusSlots[ uxIndex ] = pusSlots[ *puxCount ];
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvRandom( UBaseType_t uxRange )
+{
+    /* Utility function to generate a pseudo random number, as used by the
+     * other standard demo files. */
+    ulRandom = ( ulRandom * 1103515245UL ) + 12345UL;
+
+    return ( UBaseType_t ) ( ( ulRandom >> 16 ) & 0x7fffUL ) % uxRange;
+}
+/*-----------------------------------------------------------*/
+
+static void * prvSystemMalloc( void * pvContext,
+                               size_t xSize )
+{
+    ( void ) pvContext;
+
+    return pvPortMalloc( xSize );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSystemFree( void * pvContext,
+                           void * pv )
+{
+    ( void ) pvContext;
+
+    vPortFree( pv );
+}
+/*-----------------------------------------------------------*/
+
+#if ( hbUSE_HEAP_STATS == 1 )
+
+    static size_t prvSystemGetFreeSize( void * pvContext )
+    {
+        ( void ) pvContext;
+
+        return xPortGetFreeHeapSize();
+    }
+/*-----------------------------------------------------------*/
+
+    static size_t prvSystemGetLargestFreeBlockSize( void * pvContext )
+    {
+        HeapStats_t xHeapStats;
+
+        ( void ) pvContext;
+
+        vPortGetHeapStats( &xHeapStats );
+
+        return xHeapStats.xSizeOfLargestFreeBlockInBytes;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* hbUSE_HEAP_STATS */
+
+static void * prvTLSFMalloc( void * pvContext,
+                             size_t xSize )
+{
+    void * pv;
+
+    /* Lock as pvPortMalloc() does, so the comparison is fair. */
+    vTaskSuspendAll();
+    {
+        pv = pvTLSFHeapMalloc( ( TLSFHeap_t * ) pvContext, xSize );
+    }
+    ( void ) xTaskResumeAll();
+
+    return pv;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTLSFFree( void * pvContext,
+                         void * pv )
+{
+    vTaskSuspendAll();
+    {
+        vTLSFHeapFree( ( TLSFHeap_t * ) pvContext, pv );
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvTLSFGetFreeSize( void * pvContext )
+{
+    return xTLSFHeapGetFreeSize( ( TLSFHeap_t * ) pvContext );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvTLSFGetLargestFreeBlockSize( void * pvContext )
+{
+    return xTLSFHeapGetLargestFreeBlockSize( ( TLSFHeap_t * ) pvContext );
+}
+/*-----------------------------------------------------------*/
+
+static void prvResetStats( HeapBenchmarkStats_t * pxStats )
+{
+    pxStats->ulMin = UINT32_MAX;
+    pxStats->ulMax = 0;
+    pxStats->ulTotal = 0;
+    pxStats->ulCount = 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddSample( HeapBenchmarkStats_t * pxStats,
+                          uint32_t ulStart,
+                          uint32_t ulEnd )
+{
+    uint32_t ulCycles = ulEnd - ulStart;
+
+    if( ulCycles < pxStats->ulMin )
+    {
+        pxStats->ulMin = ulCycles;
+    }
+
+    if( ulCycles > pxStats->ulMax )
+    {
+        pxStats->ulMax = ulCycles;
+    }
+
+    pxStats->ulTotal += ulCycles;
+    pxStats->ulCount++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char * pcWorkload,
+                       const HeapBenchmarkAllocator_t * pxAllocator,
+                       size_t xEventCount,
+                       const HeapBenchmarkResult_t * pxResult )
+{
+    configDEMO_REPORT( ( "Heap benchmark: %s %s: %u events, malloc min %u avg %u max %u, free min %u avg %u max %u cycles\r\n",
+                         pcWorkload,
+                         pxAllocator->pcName,
+                         ( unsigned ) xEventCount,
+                         ( unsigned ) pxResult->ulMinAllocCycles,
+                         ( unsigned ) pxResult->ulAverageAllocCycles,
+                         ( unsigned ) pxResult->ulMaxAllocCycles,
+                         ( unsigned ) pxResult->ulMinFreeCycles,
+                         ( unsigned ) pxResult->ulAverageFreeCycles,
+                         ( unsigned ) pxResult->ulMaxFreeCycles ) );
+
+    if( pxAllocator->xGetLargestFreeBlockSize != NULL )
+    {
+        configDEMO_REPORT( ( "Heap benchmark: %s %s: %u failed allocations, peak %u bytes requested, minimum free %u bytes, worst fragmentation %u%%\r\n",
+                             pcWorkload,
+                             pxAllocator->pcName,
+                             ( unsigned ) pxResult->ulFailedAllocations,
+                             ( unsigned ) pxResult->xPeakRequestedBytes,
+                             ( unsigned ) pxResult->xMinimumFreeBytes,
+                             ( unsigned ) pxResult->ulWorstFragmentation ) );
+    }
+    else
+    {
+        configDEMO_REPORT( ( "Heap benchmark: %s %s: %u failed allocations, peak %u bytes requested\r\n",
+                             pcWorkload,
+                             pxAllocator->pcName,
+                             ( unsigned ) pxResult->ulFailedAllocations,
+                             ( unsigned ) pxResult->xPeakRequestedBytes ) );
+    }
+}
+/*-----------------------------------------------------------*/
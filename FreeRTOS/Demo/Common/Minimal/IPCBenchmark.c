@@ -0,0 +1,897 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures the cost of the kernel's inter-task communication primitives, in
+ * cycles, so the primitives used by an application can be chosen using data
+ * from the port it runs on.  Unlike the other files in this directory nothing
+ * is checked - the results are reported through configDEMO_REPORT().
+ *
+ * A controlling task runs at the priority passed to
+ * vStartIPCBenchmarkTask().  For each benchmark it creates helper tasks one
+ * priority higher, so every operation that unblocks a helper causes an
+ * immediate context switch, and measures:
+ *
+ * + Queue round trip - send to a queue, the helper receives the item and
+ *   sends it back on a second queue, receive it back.
+ * + Wake latency - the time from giving a binary semaphore, or giving a direct
+ *   to task notification, to the blocked helper running.
+ * + Stream buffer throughput - sending to a stream buffer in chunks of
+ *   different sizes while the helper receives them.
+ * + Mutex take/give - taking and giving back a mutex, and a recursive mutex,
+ *   that no other task holds or waits for.
+ * + Mutex handoff - the time from giving a mutex to the blocked helper
+ *   holding it.
+ * + Mutex inheritance chain - each of N helpers, at increasing priorities,
+ *   holds a mutex and is blocked on the mutex held by the helper below it, the
+ *   lowest one being blocked on a mutex held by the controlling task.  Each
+ *   task that blocks raises the priority of the holder it blocks on.  The time
+ *   is measured from the controlling task giving its mutex to the top helper
+ *   holding the mutex it waits for, so it includes N handoffs and the priority
+ *   of each holder being restored as it gives its mutex.  This is measured for
+ *   N from 1 to ipcbMUTEX_CHAIN_DEPTH.
+ * + Event group broadcast - the time for setting a bit to unblock and run
+ *   every one of ipcbEVENT_WAITERS helpers.
+ *
+ * Each benchmark is run twice, the second time with ipcbCONTENDERS tasks at
+ * the controlling task's priority that repeatedly access the same object and
+ * yield.  The minimum, average and maximum of ipcbITERATIONS samples are
+ * reported.  The controlling task deletes itself once all the benchmarks have
+ * run.
+ *
+ * Cycles are read with configIPC_BENCHMARK_CYCLE_COUNT(), which should be
+ * defined in FreeRTOSConfig.h to read a free running cycle counter, for
+ * example the DWT cycle counter on Cortex-M.  If it is not defined then the
+ * run time stats counter is used, in which case the results are in run time
+ * stats counts rather than cycles.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "event_groups.h"
+
+/* Demo program include files. */
+#include "IPCBenchmark.h"
+#include "DemoReport.h"
+
+#if ( INCLUDE_vTaskDelete != 1 )
+    #error This file uses vTaskDelete() so INCLUDE_vTaskDelete must be set to 1 in FreeRTOSConfig.h.
+#endif
+
+#ifndef configIPC_BENCHMARK_CYCLE_COUNT
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        #define configIPC_BENCHMARK_CYCLE_COUNT()    ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+    #else
+        #error Define configIPC_BENCHMARK_CYCLE_COUNT() in FreeRTOSConfig.h to return a free running cycle count.
+    #endif
+#endif
+
+/* The number of samples taken of each measurement. */
+#ifndef ipcbITERATIONS
+    #define ipcbITERATIONS    100
+#endif
+
+/* The number of tasks that access the object being measured during the
+ * contended run of each benchmark. */
+#ifndef ipcbCONTENDERS
+    #define ipcbCONTENDERS    2
+#endif
+
+/* The longest chain of mutex holders measured.  The top helper of the chain
+ * runs ipcbMUTEX_CHAIN_DEPTH priorities above the controlling task. */
+#ifndef ipcbMUTEX_CHAIN_DEPTH
+    #define ipcbMUTEX_CHAIN_DEPTH    3
+#endif
+
+/* The number of tasks woken by each event group broadcast. */
+#ifndef ipcbEVENT_WAITERS
+    #define ipcbEVENT_WAITERS    3
+#endif
+
+/* Stream buffer chunk sizes, the largest of which must not be bigger than
+ * ipcbSTREAM_BUFFER_SIZE. */
+#define ipcbSTREAM_BUFFER_SIZE     512
+#define ipcbMAX_CHUNK_SIZE         256
+static const size_t xChunkSizes[] = { 1, 4, 16, 64, 256 };
+
+/* The event group bit waited on by the broadcast helpers. */
+#define ipcbBROADCAST_BIT          ( ( EventBits_t ) 0x01 )
+
+/* A block time of 0 just means "don't block". */
+#define ipcbDONT_BLOCK             0
+
+/* Time given to the idle task to free the memory of deleted tasks. */
+#define ipcbCLEAN_UP_DELAY         pdMS_TO_TICKS( 50 )
+
+/*-----------------------------------------------------------*/
+
+/* Cycle counts collected for one measurement. */
+typedef struct IPCBenchmarkStats
+{
+    uint32_t ulMin;
+    uint32_t ulMax;
+    uint32_t ulTotal;
+    uint32_t ulCount;
+} IPCBenchmarkStats_t;
+
+/* The function a contending task calls on each loop, and the object it is
+ * passed. */
+typedef void (* ContendFunction_t)( void * pvObject );
+
+/* Passed to each helper in a mutex inheritance chain. */
+typedef struct IPCBenchmarkChainLink
+{
+    SemaphoreHandle_t xHeld;     /* The mutex the helper holds. */
+    SemaphoreHandle_t xWaitedOn; /* The mutex held by the task below it. */
+    BaseType_t xIsTop;           /* pdTRUE for the highest priority helper. */
+} IPCBenchmarkChainLink_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task that runs each benchmark in turn.
+ */
+static void prvBenchmarkTask( void * pvParameters );
+
+/*
+ * The benchmarks.  Each creates the objects and helper tasks it needs, then
+ * deletes them again before returning.
+ */
+static void prvQueueRoundTrip( BaseType_t xContended );
+static void prvWakeLatency( BaseType_t xContended );
+static void prvStreamBufferThroughput( BaseType_t xContended );
+static void prvMutexTakeGive( BaseType_t xContended );
+static void prvMutexHandoff( BaseType_t xContended );
+static void prvMutexInheritanceChain( BaseType_t xContended );
+static void prvEventGroupBroadcast( BaseType_t xContended );
+
+/*
+ * The helper tasks, which run at one priority above the controlling task.
+ */
+static void prvQueueEchoTask( void * pvParameters );
+static void prvNotifyWaitTask( void * pvParameters );
+static void prvSemaphoreWaitTask( void * pvParameters );
+static void prvStreamReceiveTask( void * pvParameters );
+static void prvMutexWaitTask( void * pvParameters );
+static void prvMutexChainTask( void * pvParameters );
+static void prvEventWaitTask( void * pvParameters );
+
+/*
+ * Create ipcbCONTENDERS tasks, at the priority of the controlling task, that
+ * call pxFunction( pvObject ) then yield, in a loop.  pxFunction can be NULL
+ * in which case the tasks only compete for CPU time.
+ */
+static void prvStartContenders( BaseType_t xContended,
+                                ContendFunction_t pxFunction,
+                                void * pvObject );
+static void prvStopContenders( void );
+static void prvContenderTask( void * pvParameters );
+
+/*
+ * Functions called by the contending tasks.
+ */
+static void prvContendQueue( void * pvObject );
+static void prvContendSemaphore( void * pvObject );
+static void prvContendStreamBuffer( void * pvObject );
+static void prvContendEventGroup( void * pvObject );
+
+/*
+ * Collect and output the samples.
+ */
+static void prvResetStats( IPCBenchmarkStats_t * pxStats );
+static void prvAddSample( IPCBenchmarkStats_t * pxStats,
+                          uint32_t ulStart,
+                          uint32_t ulEnd );
+static void prvReport( const char * pcName,
+                       uint32_t ulParameter,
+                       BaseType_t xContended,
+                       const IPCBenchmarkStats_t * pxStats );
+
+/*-----------------------------------------------------------*/
+
+/* The priority of the controlling task.  Helper tasks run one above. */
+static UBaseType_t uxControllerPriority = tskIDLE_PRIORITY;
+
+/* The cost of reading the cycle counter twice, subtracted from each sample. */
+static uint32_t ulCycleCountOverhead = 0;
+
+/* Written by a helper task with the cycle count at which it ran. */
+static volatile uint32_t ulHelperRunCycles = 0;
+
+/* The contending tasks, and what they do. */
+static TaskHandle_t xContenders[ ipcbCONTENDERS ];
+static ContendFunction_t pxContendFunction = NULL;
+static void * pvContendObject = NULL;
+
+/* Set when all the benchmarks have run. */
+static volatile BaseType_t xBenchmarksComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartIPCBenchmarkTask( UBaseType_t uxPriority )
+{
+    /* The helper tasks run at one priority higher, or up to
+     * ipcbMUTEX_CHAIN_DEPTH priorities higher in a mutex inheritance chain. */
+    configASSERT( ( uxPriority + 1U ) < ( UBaseType_t ) configMAX_PRIORITIES );
+    configASSERT( ( uxPriority + ipcbMUTEX_CHAIN_DEPTH ) < ( UBaseType_t ) configMAX_PRIORITIES );
+
+    uxControllerPriority = uxPriority;
+    xTaskCreate( prvBenchmarkTask, "IPCBench", configMINIMAL_STACK_SIZE * 2, NULL, uxPriority, NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreIPCBenchmarksComplete( void )
+{
+    return xBenchmarksComplete;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    uint32_t ulStart, ulEnd, x;
+    BaseType_t xContended;
+
+    /* The parameter is not used. */
+    ( void ) pvParameters;
+
+    /* Find the smallest number of cycles between two consecutive reads of the
+     * cycle counter. */
+    ulCycleCountOverhead = UINT32_MAX;
+
+    for( x = 0; x < 16; x++ )
+    {
+        ulStart = configIPC_BENCHMARK_CYCLE_COUNT();
+        ulEnd = configIPC_BENCHMARK_CYCLE_COUNT();
+
+        if( ( ulEnd - ulStart ) < ulCycleCountOverhead )
+        {
+            ulCycleCountOverhead = ulEnd - ulStart;
+        }
+    }
+
+    configDEMO_REPORT( ( "IPC benchmark: %u samples, %u contenders, cycle counter overhead %u\r\n",
+                         ( unsigned ) ipcbITERATIONS,
+                         ( unsigned ) ipcbCONTENDERS,
+                         ( unsigned ) ulCycleCountOverhead ) );
+
+    for( xContended = pdFALSE; xContended <= pdTRUE; xContended++ )
+    {
+        prvQueueRoundTrip( xContended );
+        prvWakeLatency( xContended );
+        prvStreamBufferThroughput( xContended );
+        prvMutexTakeGive( xContended );
+        prvMutexHandoff( xContended );
+        prvMutexInheritanceChain( xContended );
+        prvEventGroupBroadcast( xContended );
+    }
+
+    configDEMO_REPORT( ( "IPC benchmark: complete\r\n" ) );
+    xBenchmarksComplete = pdTRUE;
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueRoundTrip( BaseType_t xContended )
+{
+    QueueHandle_t xQueues[ 2 ];
+    TaskHandle_t xEchoTask;
+    IPCBenchmarkStats_t xStats;
+    uint32_t ulValue = 0, ulStart, x;
+
+    xQueues[ 0 ] = xQueueCreate( 1, sizeof( uint32_t ) );
+    xQueues[ 1 ] = xQueueCreate( 1, sizeof( uint32_t ) );
+    configASSERT( xQueues[ 0 ] );
+    configASSERT( xQueues[ 1 ] );
+
+    xTaskCreate( prvQueueEchoTask, "IPCEcho", configMINIMAL_STACK_SIZE, ( void * ) xQueues, uxControllerPriority + 1, &xEchoTask );
+    prvStartContenders( xContended, prvContendQueue, ( void * ) xQueues[ 0 ] );
+    prvResetStats( &xStats );
+
+    for( x = 0; x < ipcbITERATIONS; x++ )
+    {
+        /* The echo task has a higher priority so has sent the value back
+         * before xQueueSend() returns. */
+        ulStart = configIPC_BENCHMARK_CYCLE_COUNT();
+        xQueueSend( xQueues[ 0 ], &x, portMAX_DELAY );
+        xQueueReceive( xQueues[ 1 ], &ulValue, portMAX_DELAY );
+        prvAddSample( &xStats, ulStart, configIPC_BENCHMARK_CYCLE_COUNT() );
+
+        configASSERT( ulValue == x );
+    }
+
+    prvStopContenders();
+    vTaskDelete( xEchoTask );
+    vTaskDelay( ipcbCLEAN_UP_DELAY );
+    vQueueDelete( xQueues[ 0 ] );
+    vQueueDelete( xQueues[ 1 ] );
+
+    prvReport( "queue round trip", 0, xContended, &xStats );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWakeLatency( BaseType_t xContended )
+{
+    SemaphoreHandle_t xSemaphore;
+    TaskHandle_t xWaitTask;
+    IPCBenchmarkStats_t xStats;
+    uint32_t ulStart, x;
+
+    /* Direct to task notification. */
+    xTaskCreate( prvNotifyWaitTask, "IPCNtfy", configMINIMAL_STACK_SIZE, NULL, uxControllerPriority + 1, &xWaitTask );
+    prvStartContenders( xContended, NULL, NULL );
+    prvResetStats( &xStats );
+
+    for( x = 0; x < ipcbITERATIONS; x++ )
+    {
+        ulStart = configIPC_BENCHMARK_CYCLE_COUNT();
+        xTaskNotifyGive( xWaitTask );
+        prvAddSample( &xStats, ulStart, ulHelperRunCycles );
+    }
+
+    prvStopContenders();
+    vTaskDelete( xWaitTask );
+    prvReport( "notify wake", 0, xContended, &xStats );
+
+    /* Binary semaphore. */
+    xSemaphore = xSemaphoreCreateBinary();
+    configASSERT( xSemaphore );
+
+    xTaskCreate( prvSemaphoreWaitTask, "IPCSem", configMINIMAL_STACK_SIZE, ( void * ) xSemaphore, uxControllerPriority + 1, &xWaitTask );
+    prvStartContenders( xContended, prvContendSemaphore, ( void * ) xSemaphore );
+    prvResetStats( &xStats );
+
+    for( x = 0; x < ipcbITERATIONS; x++ )
+    {
+        ulStart = configIPC_BENCHMARK_CYCLE_COUNT();
+        xSemaphoreGive( xSemaphore );
+        prvAddSample( &xStats, ulStart, ulHelperRunCycles );
+    }
+
+    prvStopContenders();
+    vTaskDelete( xWaitTask );
+    vTaskDelay( ipcbCLEAN_UP_DELAY );
+    vSemaphoreDelete( xSemaphore );
+
+    prvReport( "semaphore wake", 0, xContended, &xStats );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamBufferThroughput( BaseType_t xContended )
+{
+    static uint8_t ucData[ ipcbMAX_CHUNK_SIZE ];
+    StreamBufferHandle_t xStreamBuffer;
+    TaskHandle_t xReceiveTask;
+    IPCBenchmarkStats_t xStats;
+    uint32_t ulStart, x;
+    size_t xChunk;
+
+    memset( ucData, 0xa5, sizeof( ucData ) );
+
+    /* A trigger level of 1 wakes the receiving task on every send. */
+    xStreamBuffer = xStreamBufferCreate( ipcbSTREAM_BUFFER_SIZE, 1 );
+    configASSERT( xStreamBuffer );
+
+    xTaskCreate( prvStreamReceiveTask, "IPCStrm", configMINIMAL_STACK_SIZE, ( void * ) xStreamBuffer, uxControllerPriority + 1, &xReceiveTask );
+    prvStartContenders( xContended, prvContendStreamBuffer, ( void * ) xStreamBuffer );
+
+    for( xChunk = 0; xChunk < ( sizeof( xChunkSizes ) / sizeof( xChunkSizes[ 0 ] ) ); xChunk++ )
+    {
+        configASSERT( xChunkSizes[ xChunk ] <= ipcbMAX_CHUNK_SIZE );
+        prvResetStats( &xStats );
+
+        for( x = 0; x < ipcbITERATIONS; x++ )
+        {
+            /* The sample includes the receiving task waking and copying the
+             * data out. */
+            ulStart = configIPC_BENCHMARK_CYCLE_COUNT();
+            xStreamBufferSend( xStreamBuffer, ucData, xChunkSizes[ xChunk ], portMAX_DELAY );
+            prvAddSample( &xStats, ulStart, configIPC_BENCHMARK_CYCLE_COUNT() );
+        }
+
+        prvReport( "stream buffer chunk", ( uint32_t ) xChunkSizes[ xChunk ], xContended, &xStats );
+    }
+
+    prvStopContenders();
+    vTaskDelete( xReceiveTask );
+    vTaskDelay( ipcbCLEAN_UP_DELAY );
+    vStreamBufferDelete( xStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMutexTakeGive( BaseType_t xContended )
+{
+    SemaphoreHandle_t xMutex;
+    IPCBenchmarkStats_t xStats;
+    uint32_t ulStart, x;
+
+    xMutex = xSemaphoreCreateMutex();
+    configASSERT( xMutex );
+
+    prvStartContenders( xContended, prvContendSemaphore, ( void * ) xMutex );
+    prvResetStats( &xStats );
+
+    for( x = 0; x < ipcbITERATIONS; x++ )
+    {
+        ulStart = configIPC_BENCHMARK_CYCLE_COUNT();
+        xSemaphoreTake( xMutex, portMAX_DELAY );
+        xSemaphoreGive( xMutex );
+        prvAddSample( &xStats, ulStart, configIPC_BENCHMARK_CYCLE_COUNT() );
+    }
+
+    prvStopContenders();
+    vTaskDelay( ipcbCLEAN_UP_DELAY );
+    vSemaphoreDelete( xMutex );
+
+    prvReport( "mutex take/give", 0, xContended, &xStats );
+
+    #if ( configUSE_RECURSIVE_MUTEXES == 1 )
+    {
+        xMutex = xSemaphoreCreateRecursiveMutex();
+        configASSERT( xMutex );
+
+        prvResetStats( &xStats );
+
+        /* The contending tasks only use the non-recursive API, so they run
+         * without touching the recursive mutex. */
+        prvStartContenders( xContended, NULL, NULL );
+
+        for( x = 0; x < ipcbITERATIONS; x++ )
+        {
+            ulStart = configIPC_BENCHMARK_CYCLE_COUNT();
+            xSemaphoreTakeRecursive( xMutex, portMAX_DELAY );
+            xSemaphoreGiveRecursive( xMutex );
+            prvAddSample( &xStats, ulStart, configIPC_BENCHMARK_CYCLE_COUNT() );
+        }
+
+        prvStopContenders();
+        vTaskDelay( ipcbCLEAN_UP_DELAY );
+        vSemaphoreDelete( xMutex );
+
+        prvReport( "recursive mutex take/give", 0, xContended, &xStats );
+    }
+    #endif /* configUSE_RECURSIVE_MUTEXES */
+}
+/*-----------------------------------------------------------*/
+
+static void prvMutexHandoff( BaseType_t xContended )
+{
+    SemaphoreHandle_t xMutex;
+    TaskHandle_t xWaitTask;
+    IPCBenchmarkStats_t xStats;
+    uint32_t ulStart, x;
+
+    xMutex = xSemaphoreCreateMutex();
+    configASSERT( xMutex );
+
+    xTaskCreate( prvMutexWaitTask, "IPCMtx", configMINIMAL_STACK_SIZE, ( void * ) xMutex, uxControllerPriority + 1, &xWaitTask );
+    prvStartContenders( xContended, prvContendSemaphore, ( void * ) xMutex );
+    prvResetStats( &xStats );
+
+    for( x = 0; x < ipcbITERATIONS; x++ )
+    {
+        /* Hold the mutex, then let the helper block on it. */
+        xSemaphoreTake( xMutex, portMAX_DELAY );
+        xTaskNotifyGive( xWaitTask );
+
+        /* Giving the mutex unblocks the helper, which records when it
+         * obtained the mutex then gives it back. */
+        ulStart = configIPC_BENCHMARK_CYCLE_COUNT();
+        xSemaphoreGive( xMutex );
+        prvAddSample( &xStats, ulStart, ulHelperRunCycles );
+    }
+
+    prvStopContenders();
+    vTaskDelete( xWaitTask );
+    vTaskDelay( ipcbCLEAN_UP_DELAY );
+    vSemaphoreDelete( xMutex );
+
+    prvReport( "mutex handoff", 0, xContended, &xStats );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMutexInheritanceChain( BaseType_t xContended )
+{
+    SemaphoreHandle_t xMutexes[ ipcbMUTEX_CHAIN_DEPTH + 1 ];
+    IPCBenchmarkChainLink_t xLinks[ ipcbMUTEX_CHAIN_DEPTH ];
+    TaskHandle_t xChainTasks[ ipcbMUTEX_CHAIN_DEPTH ];
+    IPCBenchmarkStats_t xStats;
+    uint32_t ulStart, x;
+    BaseType_t xDepth, xLink;
+
+    /* xMutexes[ 0 ] is held by the controlling task, xMutexes[ n ] by the nth
+     * helper. */
+    for( xLink = 0; xLink <= ipcbMUTEX_CHAIN_DEPTH; xLink++ )
+    {
+        xMutexes[ xLink ] = xSemaphoreCreateMutex();
+        configASSERT( xMutexes[ xLink ] );
+    }
+
+    for( xDepth = 1; xDepth <= ipcbMUTEX_CHAIN_DEPTH; xDepth++ )
+    {
+        for( xLink = 0; xLink < xDepth; xLink++ )
+        {
+            xLinks[ xLink ].xHeld = xMutexes[ xLink + 1 ];
+            xLinks[ xLink ].xWaitedOn = xMutexes[ xLink ];
+            xLinks[ xLink ].xIsTop = ( xLink == ( xDepth - 1 ) ) ? pdTRUE : pdFALSE;
+            xTaskCreate( prvMutexChainTask, "IPCChn", configMINIMAL_STACK_SIZE, ( void * ) &( xLinks[ xLink ] ), uxControllerPriority + 1 + ( UBaseType_t ) xLink, &( xChainTasks[ xLink ] ) );
+        }
+
+        prvStartContenders( xContended, prvContendSemaphore, ( void * ) xMutexes[ 0 ] );
+        prvResetStats( &xStats );
+
+        for( x = 0; x < ipcbITERATIONS; x++ )
+        {
+            xSemaphoreTake( xMutexes[ 0 ], portMAX_DELAY );
+
+            /* Build the chain from the bottom.  Each helper preempts this task,
+             * takes its own mutex and blocks on the one below it, raising the
+             * priority of that mutex's holder. */
+            for( xLink = 0; xLink < xDepth; xLink++ )
+            {
+                xTaskNotifyGive( xChainTasks[ xLink ] );
+            }
+
+            /* Giving the mutex unblocks the bottom helper, which gives its own
+             * mutex to the next, and so on up to the top helper. */
+            ulStart = configIPC_BENCHMARK_CYCLE_COUNT();
+            xSemaphoreGive( xMutexes[ 0 ] );
+            prvAddSample( &xStats, ulStart, ulHelperRunCycles );
+
+            /* The chain has unwound, so this task is back at its own
+             * priority. */
+            #if ( INCLUDE_uxTaskPriorityGet == 1 )
+            {
+                configASSERT( uxTaskPriorityGet( NULL ) == uxControllerPriority );
+            }
+            #endif
+        }
+
+        prvStopContenders();
+
+        for( xLink = 0; xLink < xDepth; xLink++ )
+        {
+            vTaskDelete( xChainTasks[ xLink ] );
+        }
+
+        vTaskDelay( ipcbCLEAN_UP_DELAY );
+
+        prvReport( "mutex inheritance chain", ( uint32_t ) xDepth, xContended, &xStats );
+    }
+
+    for( xLink = 0; xLink <= ipcbMUTEX_CHAIN_DEPTH; xLink++ )
+    {
+        vSemaphoreDelete( xMutexes[ xLink ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvEventGroupBroadcast( BaseType_t xContended )
+{
+    EventGroupHandle_t xEventGroup;
+    TaskHandle_t xWaitTasks[ ipcbEVENT_WAITERS ];
+    IPCBenchmarkStats_t xStats;
+    uint32_t ulStart, x;
+    BaseType_t xWaiter;
+
+    xEventGroup = xEventGroupCreate();
+    configASSERT( xEventGroup );
+
+    for( xWaiter = 0; xWaiter < ipcbEVENT_WAITERS; xWaiter++ )
+    {
+        xTaskCreate( prvEventWaitTask, "IPCEvt", configMINIMAL_STACK_SIZE, ( void * ) xEventGroup, uxControllerPriority + 1, &( xWaitTasks[ xWaiter ] ) );
+    }
+
+    prvStartContenders( xContended, prvContendEventGroup, ( void * ) xEventGroup );
+    prvResetStats( &xStats );
+
+    for( x = 0; x < ipcbITERATIONS; x++ )
+    {
+        /* All the waiting tasks have run by the time xEventGroupSetBits()
+         * returns. */
+        ulStart = configIPC_BENCHMARK_CYCLE_COUNT();
+        xEventGroupSetBits( xEventGroup, ipcbBROADCAST_BIT );
+        prvAddSample( &xStats, ulStart, configIPC_BENCHMARK_CYCLE_COUNT() );
+
+        /* Clear the bit, then release the waiting tasks so they wait for it
+         * again. */
+        xEventGroupClearBits( xEventGroup, ipcbBROADCAST_BIT );
+
+        for( xWaiter = 0; xWaiter < ipcbEVENT_WAITERS; xWaiter++ )
+        {
+            xTaskNotifyGive( xWaitTasks[ xWaiter ] );
+        }
+    }
+
+    prvStopContenders();
+
+    for( xWaiter = 0; xWaiter < ipcbEVENT_WAITERS; xWaiter++ )
+    {
+        vTaskDelete( xWaitTasks[ xWaiter ] );
+    }
+
+    vTaskDelay( ipcbCLEAN_UP_DELAY );
+    vEventGroupDelete( xEventGroup );
+
+    prvReport( "event group broadcast", ipcbEVENT_WAITERS, xContended, &xStats );
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueEchoTask( void * pvParameters )
+{
+    QueueHandle_t * pxQueues = ( QueueHandle_t * ) pvParameters;
+    uint32_t ulValue;
+
+    for( ; ; )
+    {
+        xQueueReceive( pxQueues[ 0 ], &ulValue, portMAX_DELAY );
+        xQueueSend( pxQueues[ 1 ], &ulValue, portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvNotifyWaitTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        ulHelperRunCycles = configIPC_BENCHMARK_CYCLE_COUNT();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSemaphoreWaitTask( void * pvParameters )
+{
+    SemaphoreHandle_t xSemaphore = ( SemaphoreHandle_t ) pvParameters;
+
+    for( ; ; )
+    {
+        xSemaphoreTake( xSemaphore, portMAX_DELAY );
+        ulHelperRunCycles = configIPC_BENCHMARK_CYCLE_COUNT();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamReceiveTask( void * pvParameters )
+{
+    static uint8_t ucReceived[ ipcbMAX_CHUNK_SIZE ];
+    StreamBufferHandle_t xStreamBuffer = ( StreamBufferHandle_t ) pvParameters;
+
+    for( ; ; )
+    {
+        xStreamBufferReceive( xStreamBuffer, ucReceived, sizeof( ucReceived ), portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvMutexWaitTask( void * pvParameters )
+{
+    SemaphoreHandle_t xMutex = ( SemaphoreHandle_t ) pvParameters;
+
+    for( ; ; )
+    {
+        /* Wait until the controlling task holds the mutex. */
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        xSemaphoreTake( xMutex, portMAX_DELAY );
+        ulHelperRunCycles = configIPC_BENCHMARK_CYCLE_COUNT();
+        xSemaphoreGive( xMutex );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvMutexChainTask( void * pvParameters )
+{
+    const IPCBenchmarkChainLink_t * pxLink = ( const IPCBenchmarkChainLink_t * ) pvParameters;
+
+    for( ; ; )
+    {
+        /* Wait until the task below holds the mutex this task waits on. */
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        xSemaphoreTake( pxLink->xHeld, portMAX_DELAY );
+        xSemaphoreTake( pxLink->xWaitedOn, portMAX_DELAY );
+
+        if( pxLink->xIsTop != pdFALSE )
+        {
+            ulHelperRunCycles = configIPC_BENCHMARK_CYCLE_COUNT();
+        }
+
+        /* Mutexes must be given in the reverse order to which they were
+         * taken.  Giving xHeld lets the task above, if any, run. */
+        xSemaphoreGive( pxLink->xWaitedOn );
+        xSemaphoreGive( pxLink->xHeld );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvEventWaitTask( void * pvParameters )
+{
+    EventGroupHandle_t xEventGroup = ( EventGroupHandle_t ) pvParameters;
+
+    for( ; ; )
+    {
+        xEventGroupWaitBits( xEventGroup, ipcbBROADCAST_BIT, pdFALSE, pdTRUE, portMAX_DELAY );
+
+        /* Don't wait for the bit again until the controlling task has
+         * cleared it. */
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvStartContenders( BaseType_t xContended,
+                                ContendFunction_t pxFunction,
+                                void * pvObject )
+{
+    BaseType_t x;
+
+    if( xContended != pdFALSE )
+    {
+        pxContendFunction = pxFunction;
+        pvContendObject = pvObject;
+
+        for( x = 0; x < ipcbCONTENDERS; x++ )
+        {
+            xTaskCreate( prvContenderTask, "IPCCont", configMINIMAL_STACK_SIZE, NULL, uxControllerPriority, &( xContenders[ x ] ) );
+        }
+    }
+    else
+    {
+        for( x = 0; x < ipcbCONTENDERS; x++ )
+        {
+            xContenders[ x ] = NULL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvStopContenders( void )
+{
+    BaseType_t x;
+
+    for( x = 0; x < ipcbCONTENDERS; x++ )
+    {
+        if( xContenders[ x ] != NULL )
+        {
+            vTaskDelete( xContenders[ x ] );
+            xContenders[ x ] = NULL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvContenderTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        if( pxContendFunction != NULL )
+        {
+            pxContendFunction( pvContendObject );
+        }
+
+        taskYIELD();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvContendQueue( void * pvObject )
+{
+    uint32_t ulValue;
+
+    ( void ) xQueuePeek( ( QueueHandle_t ) pvObject, &ulValue, ipcbDONT_BLOCK );
+}
+/*-----------------------------------------------------------*/
+
+static void prvContendSemaphore( void * pvObject )
+{
+    /* Only succeeds while neither the controlling task nor the helper holds
+     * the semaphore, in which case it is given straight back. */
+    if( xSemaphoreTake( ( SemaphoreHandle_t ) pvObject, ipcbDONT_BLOCK ) == pdPASS )
+    {
+        xSemaphoreGive( ( SemaphoreHandle_t ) pvObject );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvContendStreamBuffer( void * pvObject )
+{
+    ( void ) xStreamBufferSpacesAvailable( ( StreamBufferHandle_t ) pvObject );
+}
+/*-----------------------------------------------------------*/
+
+static void prvContendEventGroup( void * pvObject )
+{
+    ( void ) xEventGroupGetBits( ( EventGroupHandle_t ) pvObject );
+}
+/*-----------------------------------------------------------*/
+
+static void prvResetStats( IPCBenchmarkStats_t * pxStats )
+{
+    pxStats->ulMin = UINT32_MAX;
+    pxStats->ulMax = 0;
+    pxStats->ulTotal = 0;
+    pxStats->ulCount = 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddSample( IPCBenchmarkStats_t * pxStats,
+                          uint32_t ulStart,
+                          uint32_t ulEnd )
+{
+    uint32_t ulCycles = ulEnd - ulStart;
+
+    if( ulCycles > ulCycleCountOverhead )
+    {
+        ulCycles -= ulCycleCountOverhead;
+    }
+    else
+    {
+        ulCycles = 0;
+    }
+
+    if( ulCycles < pxStats->ulMin )
+    {
+        pxStats->ulMin = ulCycles;
+    }
+
+    if( ulCycles > pxStats->ulMax )
+    {
+        pxStats->ulMax = ulCycles;
+    }
+
+    pxStats->ulTotal += ulCycles;
+    pxStats->ulCount++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char * pcName,
+                       uint32_t ulParameter,
+                       BaseType_t xContended,
+                       const IPCBenchmarkStats_t * pxStats )
+{
+    uint32_t ulAverage = ( pxStats->ulCount > 0 ) ? ( pxStats->ulTotal / pxStats->ulCount ) : 0;
+
+    configDEMO_REPORT( ( "IPC benchmark: %s (%u)%s: min %u avg %u max %u cycles\r\n",
+                         pcName,
+                         ( unsigned ) ulParameter,
+                         ( xContended != pdFALSE ) ? " contended" : "",
+                         ( unsigned ) pxStats->ulMin,
+                         ( unsigned ) ulAverage,
+                         ( unsigned ) pxStats->ulMax ) );
+}
+/*-----------------------------------------------------------*/
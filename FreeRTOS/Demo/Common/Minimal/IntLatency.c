@@ -0,0 +1,439 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures the time from a timer interrupt to the task that the interrupt
+ * unblocks running, so the worst case interrupt to task latency can be
+ * quantified on each port.  Like IPCBenchmark.c nothing is checked - the
+ * results are reported through configDEMO_REPORT().
+ *
+ * The application must arrange for xIntLatencyTimerHandler() to be called
+ * periodically from a timer interrupt, in the same way the IntQueue.c tests
+ * require xFirstTimerHandler() and xSecondTimerHandler() to be called, and
+ * must pass the value it returns to portYIELD_FROM_ISR() (or the port's
+ * equivalent).  The interrupt must run at or below
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY so it can use the FromISR API, which
+ * means it is masked by critical sections.  A rate of a few hundred to a few
+ * thousand Hz is suitable.
+ *
+ * The handler reads the cycle counter then unblocks the measuring task using
+ * either a direct to task notification or a binary semaphore.  The measuring
+ * task reads the cycle counter again as soon as it runs, and records the
+ * difference in a histogram that has one bucket per power of two.  A new
+ * sample is not started until the measuring task has recorded the previous
+ * one, so the latency of one sample is never hidden by the next.
+ *
+ * Each wake mechanism is measured:
+ *
+ * + With no load, so the measuring task only competes with the idle task.
+ * + With intlatLOAD_TASKS tasks that use all the CPU time they are given.
+ * + With intlatLOAD_TASKS tasks that spend most of their time in critical
+ *   sections of intlatCRITICAL_SECTION_CYCLES cycles, which delay the
+ *   interrupt itself.
+ *
+ * The load tasks run at the priority passed to vStartInterruptLatencyTasks().
+ * The loaded runs are made with the measuring task at one priority above the
+ * load tasks, so the interrupt switches straight to it, and at the same
+ * priority as the load tasks, so it waits for its turn in the time slice.
+ * The measuring task deletes itself once all the runs are complete.
+ *
+ * Cycles are read with configINT_LATENCY_CYCLE_COUNT(), which should be
+ * defined in FreeRTOSConfig.h to read a free running cycle counter, for
+ * example the DWT cycle counter on Cortex-M.  If it is not defined then
+ * configIPC_BENCHMARK_CYCLE_COUNT() is used, and if that is not defined either
+ * then the run time stats counter is used, in which case the results are in
+ * run time stats counts rather than cycles.  The time taken by the hardware
+ * to enter the interrupt is not included in the measurement.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Demo program include files. */
+#include "IntLatency.h"
+#include "DemoReport.h"
+
+#if ( INCLUDE_vTaskDelete != 1 )
+    #error This file uses vTaskDelete() so INCLUDE_vTaskDelete must be set to 1 in FreeRTOSConfig.h.
+#endif
+
+#if ( INCLUDE_vTaskPrioritySet != 1 )
+    #error This file uses vTaskPrioritySet() so INCLUDE_vTaskPrioritySet must be set to 1 in FreeRTOSConfig.h.
+#endif
+
+#ifndef configINT_LATENCY_CYCLE_COUNT
+    #if defined( configIPC_BENCHMARK_CYCLE_COUNT )
+        #define configINT_LATENCY_CYCLE_COUNT()    configIPC_BENCHMARK_CYCLE_COUNT()
+    #elif ( configGENERATE_RUN_TIME_STATS == 1 )
+        #define configINT_LATENCY_CYCLE_COUNT()    ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+    #else
+        #error Define configINT_LATENCY_CYCLE_COUNT() in FreeRTOSConfig.h to return a free running cycle count.
+    #endif
+#endif
+
+/* The number of samples taken in each run. */
+#ifndef intlatSAMPLES
+    #define intlatSAMPLES    1000
+#endif
+
+/* The number of tasks that load the CPU during the loaded runs. */
+#ifndef intlatLOAD_TASKS
+    #define intlatLOAD_TASKS    2
+#endif
+
+/* The length of each critical section entered by the load tasks during the
+ * critical section runs. */
+#ifndef intlatCRITICAL_SECTION_CYCLES
+    #define intlatCRITICAL_SECTION_CYCLES    500UL
+#endif
+
+/* One bucket per power of two, so every uint32_t has a bucket. */
+#define intlatHISTOGRAM_BUCKETS    32
+
+/* Time given to the idle task to free the memory of deleted tasks. */
+#define intlatCLEAN_UP_DELAY       pdMS_TO_TICKS( 50 )
+
+/* How the interrupt unblocks the measuring task.  intlatWAKE_NONE is used
+ * between runs, when the interrupt does nothing. */
+#define intlatWAKE_NONE            0
+#define intlatWAKE_NOTIFY          1
+#define intlatWAKE_SEMAPHORE       2
+
+/* What the load tasks do. */
+#define intlatLOAD_NONE            0
+#define intlatLOAD_CPU             1
+#define intlatLOAD_CRITICAL        2
+
+/*-----------------------------------------------------------*/
+
+/* The samples collected during one run. */
+typedef struct IntLatencyStats
+{
+    uint32_t ulMin;
+    uint32_t ulMax;
+    uint32_t ulTotal;
+    uint32_t ulBuckets[ intlatHISTOGRAM_BUCKETS ];
+} IntLatencyStats_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task that is unblocked by the interrupt, and that runs each
+ * combination of wake mechanism, load and priority in turn.
+ */
+static void prvLatencyTask( void * pvParameters );
+
+/*
+ * Collect intlatSAMPLES samples using the given wake mechanism.
+ */
+static void prvRun( BaseType_t xWakeMechanism,
+                    IntLatencyStats_t * pxStats );
+
+/*
+ * The load tasks.  pvParameters is intlatLOAD_CPU or intlatLOAD_CRITICAL.
+ */
+static void prvLoadTask( void * pvParameters );
+
+/*
+ * Record a sample, and output the results of a run.
+ */
+static void prvAddSample( IntLatencyStats_t * pxStats,
+                          uint32_t ulCycles );
+static void prvReport( BaseType_t xWakeMechanism,
+                       BaseType_t xLoad,
+                       BaseType_t xSamePriority,
+                       const IntLatencyStats_t * pxStats );
+
+/*-----------------------------------------------------------*/
+
+/* The measuring task, which the interrupt notifies. */
+static TaskHandle_t xLatencyTask = NULL;
+
+/* The semaphore the interrupt gives during the semaphore runs. */
+static SemaphoreHandle_t xLatencySemaphore = NULL;
+
+/* The priority of the load tasks. */
+static UBaseType_t uxLoadPriority = tskIDLE_PRIORITY;
+
+/* How the interrupt wakes the measuring task, one of the intlatWAKE_
+ * definitions above. */
+static volatile BaseType_t xWakeMechanismInUse = intlatWAKE_NONE;
+
+/* Set by the interrupt when it starts a sample, and cleared by the measuring
+ * task when it has recorded it. */
+static volatile BaseType_t xSamplePending = pdFALSE;
+
+/* The cycle count read by the interrupt when it started the pending
+ * sample. */
+static volatile uint32_t ulInterruptCycles = 0;
+
+/* Set when all the runs are complete. */
+static volatile BaseType_t xLatencyTestsComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartInterruptLatencyTasks( UBaseType_t uxPriority )
+{
+    /* The measuring task runs at up to one priority higher. */
+    configASSERT( ( uxPriority + 1U ) < ( UBaseType_t ) configMAX_PRIORITIES );
+
+    uxLoadPriority = uxPriority;
+
+    xLatencySemaphore = xSemaphoreCreateBinary();
+    configASSERT( xLatencySemaphore );
+
+    xTaskCreate( prvLatencyTask, "IntLat", configMINIMAL_STACK_SIZE * 2, NULL, uxPriority + 1, &xLatencyTask );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreInterruptLatencyTestsComplete( void )
+{
+    return xLatencyTestsComplete;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIntLatencyTimerHandler( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    BaseType_t xWakeMechanism = xWakeMechanismInUse;
+
+    /* Only start a sample if the measuring task has recorded the last one. */
+    if( ( xWakeMechanism != intlatWAKE_NONE ) && ( xSamplePending == pdFALSE ) )
+    {
+        ulInterruptCycles = configINT_LATENCY_CYCLE_COUNT();
+        xSamplePending = pdTRUE;
+
+        if( xWakeMechanism == intlatWAKE_NOTIFY )
+        {
+            vTaskNotifyGiveFromISR( xLatencyTask, &xHigherPriorityTaskWoken );
+        }
+        else
+        {
+            xSemaphoreGiveFromISR( xLatencySemaphore, &xHigherPriorityTaskWoken );
+        }
+    }
+
+    return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLatencyTask( void * pvParameters )
+{
+    static IntLatencyStats_t xStats;
+    TaskHandle_t xLoadTasks[ intlatLOAD_TASKS ];
+    BaseType_t xWakeMechanism, xLoad, xSamePriority, x;
+
+    /* The parameter is not used. */
+    ( void ) pvParameters;
+
+    configDEMO_REPORT( ( "Interrupt latency: %u samples per run, %u load tasks\r\n",
+                         ( unsigned ) intlatSAMPLES,
+                         ( unsigned ) intlatLOAD_TASKS ) );
+
+    for( xWakeMechanism = intlatWAKE_NOTIFY; xWakeMechanism <= intlatWAKE_SEMAPHORE; xWakeMechanism++ )
+    {
+        for( xLoad = intlatLOAD_NONE; xLoad <= intlatLOAD_CRITICAL; xLoad++ )
+        {
+            for( xSamePriority = pdFALSE; xSamePriority <= pdTRUE; xSamePriority++ )
+            {
+                /* Without load there is nothing to share a priority with. */
+                if( ( xLoad == intlatLOAD_NONE ) && ( xSamePriority != pdFALSE ) )
+                {
+                    continue;
+                }
+
+                if( xLoad != intlatLOAD_NONE )
+                {
+                    for( x = 0; x < intlatLOAD_TASKS; x++ )
+                    {
+                        xTaskCreate( prvLoadTask, "IntLoad", configMINIMAL_STACK_SIZE, ( void * ) xLoad, uxLoadPriority, &( xLoadTasks[ x ] ) );
+                    }
+                }
+
+                if( xSamePriority != pdFALSE )
+                {
+                    vTaskPrioritySet( NULL, uxLoadPriority );
+                }
+
+                prvRun( xWakeMechanism, &xStats );
+
+                /* Return to the higher priority before deleting the load
+                 * tasks, so they cannot preempt this task part way through. */
+                vTaskPrioritySet( NULL, uxLoadPriority + 1 );
+
+                if( xLoad != intlatLOAD_NONE )
+                {
+                    for( x = 0; x < intlatLOAD_TASKS; x++ )
+                    {
+                        vTaskDelete( xLoadTasks[ x ] );
+                    }
+
+                    vTaskDelay( intlatCLEAN_UP_DELAY );
+                }
+
+                prvReport( xWakeMechanism, xLoad, xSamePriority, &xStats );
+            }
+        }
+    }
+
+    configDEMO_REPORT( ( "Interrupt latency: complete\r\n" ) );
+    xLatencyTestsComplete = pdTRUE;
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRun( BaseType_t xWakeMechanism,
+                    IntLatencyStats_t * pxStats )
+{
+    uint32_t ulCycles, x;
+
+    pxStats->ulMin = UINT32_MAX;
+    pxStats->ulMax = 0;
+    pxStats->ulTotal = 0;
+
+    for( x = 0; x < intlatHISTOGRAM_BUCKETS; x++ )
+    {
+        pxStats->ulBuckets[ x ] = 0;
+    }
+
+    /* Make sure nothing is left over from the previous run before the
+     * interrupt starts taking samples. */
+    ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+    ( void ) xSemaphoreTake( xLatencySemaphore, 0 );
+    xSamplePending = pdFALSE;
+    xWakeMechanismInUse = xWakeMechanism;
+
+    for( x = 0; x < intlatSAMPLES; x++ )
+    {
+        if( xWakeMechanism == intlatWAKE_NOTIFY )
+        {
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+        else
+        {
+            ( void ) xSemaphoreTake( xLatencySemaphore, portMAX_DELAY );
+        }
+
+        ulCycles = configINT_LATENCY_CYCLE_COUNT() - ulInterruptCycles;
+        xSamplePending = pdFALSE;
+
+        prvAddSample( pxStats, ulCycles );
+    }
+
+    xWakeMechanismInUse = intlatWAKE_NONE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoadTask( void * pvParameters )
+{
+    BaseType_t xLoad = ( BaseType_t ) pvParameters;
+    volatile uint32_t ulCounter = 0;
+    uint32_t ulStart;
+
+    for( ; ; )
+    {
+        if( xLoad == intlatLOAD_CRITICAL )
+        {
+            /* Hold off the interrupt for intlatCRITICAL_SECTION_CYCLES. */
+            taskENTER_CRITICAL();
+            {
+                ulStart = configINT_LATENCY_CYCLE_COUNT();
+
+                while( ( configINT_LATENCY_CYCLE_COUNT() - ulStart ) < intlatCRITICAL_SECTION_CYCLES )
+                {
+                    ulCounter++;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        /* Leave a short gap in which the interrupt can execute. */
+        ulCounter++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddSample( IntLatencyStats_t * pxStats,
+                          uint32_t ulCycles )
+{
+    BaseType_t xBucket = 0;
+    uint32_t ulValue = ulCycles;
+
+    if( ulCycles < pxStats->ulMin )
+    {
+        pxStats->ulMin = ulCycles;
+    }
+
+    if( ulCycles > pxStats->ulMax )
+    {
+        pxStats->ulMax = ulCycles;
+    }
+
+    pxStats->ulTotal += ulCycles;
+
+    /* Bucket n holds samples from 2^n up to but not including 2^(n+1), with
+     * 0 also going in bucket 0. */
+    while( ulValue > 1UL )
+    {
+        ulValue >>= 1;
+        xBucket++;
+    }
+
+    pxStats->ulBuckets[ xBucket ]++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( BaseType_t xWakeMechanism,
+                       BaseType_t xLoad,
+                       BaseType_t xSamePriority,
+                       const IntLatencyStats_t * pxStats )
+{
+    static const char * const pcLoadNames[] = { "no load", "CPU load", "critical section load" };
+    BaseType_t x;
+
+    configDEMO_REPORT( ( "Interrupt latency: %s, %s%s: min %u avg %u max %u\r\n",
+                         ( xWakeMechanism == intlatWAKE_NOTIFY ) ? "notify" : "semaphore",
+                         pcLoadNames[ xLoad ],
+                         ( xSamePriority != pdFALSE ) ? ", same priority" : "",
+                         ( unsigned ) pxStats->ulMin,
+                         ( unsigned ) ( pxStats->ulTotal / intlatSAMPLES ),
+                         ( unsigned ) pxStats->ulMax ) );
+
+    for( x = 0; x < intlatHISTOGRAM_BUCKETS; x++ )
+    {
+        if( pxStats->ulBuckets[ x ] != 0 )
+        {
+            configDEMO_REPORT( ( "    [2^%u, 2^%u): %u\r\n",
+                                 ( unsigned ) x,
+                                 ( unsigned ) ( x + 1 ),
+                                 ( unsigned ) pxStats->ulBuckets[ x ] ) );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,246 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A pairing heap.  Each item has a list of children, all with values no lower
+ * than its own, so the root is the item with the lowest value.  Two heaps are
+ * melded by making the root with the higher value the first child of the other,
+ * which is all an insert does.  Removing an item melds its children in pairs
+ * from left to right, then melds the pairs from right to left, which is what
+ * keeps the amortised cost logarithmic.
+ *
+ * The first child of an item points back to its parent through pxPrevious,
+ * and every other child to its previous sibling, so any item can be unlinked
+ * without searching, as a task's event list item is when its timeout expires.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "PairingHeap.h"
+
+/*
+ * Returns pdTRUE if pxA should leave the heap before pxB.
+ */
+static BaseType_t prvIsBefore( const PairingHeapItem_t * pxA,
+                               const PairingHeapItem_t * pxB );
+
+/*
+ * Meld two heap roots, either of which can be NULL, and return the new root.
+ */
+static PairingHeapItem_t * prvMeld( PairingHeapItem_t * pxA,
+                                    PairingHeapItem_t * pxB );
+
+/*
+ * Meld a list of siblings into one heap and return its root.
+ */
+static PairingHeapItem_t * prvMergePairs( PairingHeapItem_t * pxFirst );
+
+/*-----------------------------------------------------------*/
+
+void vPairingHeapInitialise( PairingHeap_t * const pxHeap )
+{
+    configASSERT( pxHeap );
+
+    pxHeap->pxRoot = NULL;
+    pxHeap->uxNumberOfItems = ( UBaseType_t ) 0U;
+    pxHeap->uxNextInsertOrder = ( UBaseType_t ) 0U;
+}
+/*-----------------------------------------------------------*/
+
+void vPairingHeapInitialiseItem( PairingHeapItem_t * const pxItem )
+{
+    configASSERT( pxItem );
+
+    pxItem->pxChild = NULL;
+    pxItem->pxSibling = NULL;
+    pxItem->pxPrevious = NULL;
+    pxItem->pxContainer = NULL;
+}
+/*-----------------------------------------------------------*/
+
+void vPairingHeapInsert( PairingHeap_t * const pxHeap,
+                         PairingHeapItem_t * const pxNewItem )
+{
+    configASSERT( pxHeap );
+    configASSERT( pxNewItem );
+
+    /* An item can only be in one heap at a time. */
+    configASSERT( pxNewItem->pxContainer == NULL );
+
+    pxNewItem->uxInsertOrder = pxHeap->uxNextInsertOrder;
+    pxHeap->uxNextInsertOrder++;
+
+    pxNewItem->pxChild = NULL;
+    pxNewItem->pxSibling = NULL;
+    pxNewItem->pxPrevious = NULL;
+    pxNewItem->pxContainer = pxHeap;
+
+    pxHeap->pxRoot = prvMeld( pxHeap->pxRoot, pxNewItem );
+    ( pxHeap->uxNumberOfItems )++;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPairingHeapRemove( PairingHeapItem_t * const pxItemToRemove )
+{
+    PairingHeap_t * pxHeap;
+    PairingHeapItem_t * pxSubHeap;
+
+    configASSERT( pxItemToRemove );
+
+    pxHeap = pxItemToRemove->pxContainer;
+    configASSERT( pxHeap );
+
+    pxSubHeap = prvMergePairs( pxItemToRemove->pxChild );
+
+    if( pxItemToRemove == pxHeap->pxRoot )
+    {
+        pxHeap->pxRoot = pxSubHeap;
+    }
+    else
+    {
+        /* Unlink the item, and with it its children, from its parent. */
+        if( pxItemToRemove->pxPrevious->pxChild == pxItemToRemove )
+        {
+            pxItemToRemove->pxPrevious->pxChild = pxItemToRemove->pxSibling;
+        }
+        else
+        {
+            pxItemToRemove->pxPrevious->pxSibling = pxItemToRemove->pxSibling;
+        }
+
+        if( pxItemToRemove->pxSibling != NULL )
+        {
+            pxItemToRemove->pxSibling->pxPrevious = pxItemToRemove->pxPrevious;
+        }
+
+        pxHeap->pxRoot = prvMeld( pxHeap->pxRoot, pxSubHeap );
+    }
+
+    pxItemToRemove->pxChild = NULL;
+    pxItemToRemove->pxSibling = NULL;
+    pxItemToRemove->pxPrevious = NULL;
+    pxItemToRemove->pxContainer = NULL;
+    ( pxHeap->uxNumberOfItems )--;
+
+    return pxHeap->uxNumberOfItems;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsBefore( const PairingHeapItem_t * pxA,
+                               const PairingHeapItem_t * pxB )
+{
+    BaseType_t xReturn;
+
+    if( pxA->xItemValue != pxB->xItemValue )
+    {
+        xReturn = ( pxA->xItemValue < pxB->xItemValue ) ? pdTRUE : pdFALSE;
+    }
+    else
+    {
+        /* The insert order wraps, so compare the distance between the two
+         * rather than the values themselves. */
+        xReturn = ( ( UBaseType_t ) ( pxB->uxInsertOrder - pxA->uxInsertOrder ) <= ( ( ( UBaseType_t ) ~( UBaseType_t ) 0U ) >> 1 ) ) ? pdTRUE : pdFALSE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static PairingHeapItem_t * prvMeld( PairingHeapItem_t * pxA,
+                                    PairingHeapItem_t * pxB )
+{
+    PairingHeapItem_t * pxTemp;
+
+    if( pxA == NULL )
+    {
+        pxA = pxB;
+    }
+    else if( pxB != NULL )
+    {
+        if( prvIsBefore( pxB, pxA ) != pdFALSE )
+        {
+            pxTemp = pxA;
+            pxA = pxB;
+            pxB = pxTemp;
+        }
+
+        /* pxB becomes the first child of pxA. */
+        pxB->pxSibling = pxA->pxChild;
+
+        if( pxB->pxSibling != NULL )
+        {
+            pxB->pxSibling->pxPrevious = pxB;
+        }
+
+        pxB->pxPrevious = pxA;
+        pxA->pxChild = pxB;
+    }
+
+    if( pxA != NULL )
+    {
+        pxA->pxSibling = NULL;
+        pxA->pxPrevious = NULL;
+    }
+
+    return pxA;
+}
+/*-----------------------------------------------------------*/
+
+static PairingHeapItem_t * prvMergePairs( PairingHeapItem_t * pxFirst )
+{
+    PairingHeapItem_t * pxPairs = NULL;
+    PairingHeapItem_t * pxA;
+    PairingHeapItem_t * pxB;
+    PairingHeapItem_t * pxNext;
+    PairingHeapItem_t * pxRoot = NULL;
+
+    /* First pass: meld the siblings in pairs from left to right, keeping the
+     * results in a list linked through pxSibling in reverse order. */
+    while( pxFirst != NULL )
+    {
+        pxA = pxFirst;
+        pxB = pxA->pxSibling;
+        pxNext = ( pxB != NULL ) ? pxB->pxSibling : NULL;
+
+        pxA = prvMeld( pxA, pxB );
+        pxA->pxSibling = pxPairs;
+        pxPairs = pxA;
+        pxFirst = pxNext;
+    }
+
+    /* Second pass: meld the pairs into one heap from right to left. */
+    while( pxPairs != NULL )
+    {
+        pxNext = pxPairs->pxSibling;
+        pxRoot = prvMeld( pxRoot, pxPairs );
+        pxPairs = pxNext;
+    }
+
+    return pxRoot;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,485 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A queue multiplexer, and tasks that test it.
+ *
+ * A queue multiplexer lets one task wait on many queues without the cost of a
+ * queue set.  A queue set must be created with a length equal to the sum of
+ * the lengths of its member queues, and every send to a member queue also
+ * posts the member's handle to the set.  A multiplexer is instead one bit per
+ * member queue plus a direct to task notification.  A send sets the queue's
+ * bit inside a short critical section, and only the send that sets the first
+ * bit since the waiting task last looked notifies it.  The waiting task takes
+ * every set bit at once, then empties each queue whose bit was set.
+ *
+ * The test creates qmuxNUM_QUEUES queues, sized to show a gateway task waiting
+ * on configQUEUE_MUX_MAX_SOURCES queues.  A transmit task, and an interrupt if
+ * vQueueMuxAccessFromISR() is called from the tick hook, send to the queues in
+ * a pseudo random order.  Each value holds the number of the queue it was sent
+ * to and a count that increases with every send, and the receive task checks
+ * both.  After every burst of sends the transmit task waits for the receive
+ * task to run, then checks that every value it sent was received, which would
+ * not be the case if a notification had been lost.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo includes. */
+#include "QueueMux.h"
+
+/* The number of queues the receive task waits on, and the length of each. */
+#define qmuxNUM_QUEUES           configQUEUE_MUX_MAX_SOURCES
+#define qmuxQUEUE_LENGTH         2
+
+/* A value is qmuxFROM_ISR if it was sent by the interrupt, the count of sends
+ * shifted up by qmuxCOUNT_SHIFT, and the number of the queue it was sent to in
+ * the bits below that. */
+#define qmuxFROM_ISR             ( 0x80000000UL )
+#define qmuxCOUNT_SHIFT          ( 8 )
+#define qmuxSOURCE_MASK          ( 0xffUL )
+#define qmuxCOUNT_MASK           ( 0x7fffffUL )
+
+/* The number of values the transmit task sends before it waits for them all to
+ * be received. */
+#define qmuxTX_BURST             ( qmuxNUM_QUEUES * 3 )
+
+/* Block times used in this demo. */
+#define qmuxDONT_BLOCK           0
+#define qmuxRX_BLOCK_TIME        pdMS_TO_TICKS( ( TickType_t ) 500 )
+#define qmuxTX_LOOP_DELAY        pdMS_TO_TICKS( ( TickType_t ) 20 )
+
+/* The number of qmuxTX_LOOP_DELAY periods the transmit task waits for the
+ * receive task to catch up.  A lost notification leaves values in the queues
+ * indefinitely, so is still detected. */
+#define qmuxMAX_RX_WAITS         10
+
+/* The interrupt sends a value every qmuxISR_TX_PERIOD ticks. */
+#define qmuxISR_TX_PERIOD        ( 20UL )
+
+#if ( qmuxNUM_QUEUES > ( qmuxSOURCE_MASK + 1 ) )
+    #error The test cannot encode more than 256 queue numbers.
+#endif
+
+/*
+ * The tasks that send to and receive from the queues.
+ */
+static void prvQueueMuxSendingTask( void * pvParameters );
+static void prvQueueMuxReceivingTask( void * pvParameters );
+
+/*
+ * Check that a value was received from the queue it was sent to, and that its
+ * count is after that of the last value from the same sender on the same
+ * queue.
+ */
+static void prvCheckReceivedValue( UBaseType_t uxSource,
+                                   uint32_t ulReceived );
+
+/*-----------------------------------------------------------*/
+
+/* The queues, and the multiplexer the receive task waits on. */
+static QueueHandle_t xQueues[ qmuxNUM_QUEUES ] = { NULL };
+static QueueMux_t xQueueMux;
+
+/* The count of the last value received on each queue from the task and from
+ * the interrupt respectively. */
+static uint32_t ulLastTaskCount[ qmuxNUM_QUEUES ] = { 0 };
+static uint32_t ulLastISRCount[ qmuxNUM_QUEUES ] = { 0 };
+
+/* The number of values sent by the transmit task and received from it. */
+static volatile uint32_t ulTaskValuesSent = 0, ulTaskValuesReceived = 0;
+
+/* Set to pdFAIL if an error is detected.  ulCycleCounter is only incremented
+ * while xQueueMuxStatus equals pdPASS. */
+static volatile BaseType_t xQueueMuxStatus = pdPASS;
+static volatile uint32_t ulCycleCounter = 0;
+
+/*-----------------------------------------------------------*/
+
+void vQueueMuxInit( QueueMux_t * pxMux )
+{
+    UBaseType_t x;
+
+    configASSERT( pxMux );
+
+    pxMux->xWaitingTask = NULL;
+    pxMux->xNotified = pdFALSE;
+
+    for( x = 0; x < qmuxBITMAP_WORDS; x++ )
+    {
+        pxMux->ulReady[ x ] = 0;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vQueueMuxSignal( QueueMux_t * pxMux,
+                      UBaseType_t uxSource )
+{
+    TaskHandle_t xTaskToNotify = NULL;
+
+    configASSERT( uxSource < configQUEUE_MUX_MAX_SOURCES );
+
+    taskENTER_CRITICAL();
+    {
+        pxMux->ulReady[ uxSource / 32 ] |= ( 1UL << ( uxSource % 32 ) );
+
+        /* Only the first signal after the waiting task last looked needs to
+         * notify it, as it takes all the bits that are set when it runs. */
+        if( ( pxMux->xNotified == pdFALSE ) && ( pxMux->xWaitingTask != NULL ) )
+        {
+            pxMux->xNotified = pdTRUE;
+            xTaskToNotify = pxMux->xWaitingTask;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xTaskToNotify != NULL )
+    {
+        xTaskNotifyGiveIndexed( xTaskToNotify, configQUEUE_MUX_NOTIFY_INDEX );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vQueueMuxSignalFromISR( QueueMux_t * pxMux,
+                             UBaseType_t uxSource,
+                             BaseType_t * pxHigherPriorityTaskWoken )
+{
+    TaskHandle_t xTaskToNotify = NULL;
+    UBaseType_t uxSavedInterruptStatus;
+
+    configASSERT( uxSource < configQUEUE_MUX_MAX_SOURCES );
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        pxMux->ulReady[ uxSource / 32 ] |= ( 1UL << ( uxSource % 32 ) );
+
+        if( ( pxMux->xNotified == pdFALSE ) && ( pxMux->xWaitingTask != NULL ) )
+        {
+            pxMux->xNotified = pdTRUE;
+            xTaskToNotify = pxMux->xWaitingTask;
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    if( xTaskToNotify != NULL )
+    {
+        vTaskNotifyGiveIndexedFromISR( xTaskToNotify, configQUEUE_MUX_NOTIFY_INDEX, pxHigherPriorityTaskWoken );
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueMuxSend( QueueMux_t * pxMux,
+                          UBaseType_t uxSource,
+                          QueueHandle_t xQueue,
+                          const void * pvItemToQueue,
+                          TickType_t xTicksToWait )
+{
+    BaseType_t xReturn;
+
+    /* The item must be in the queue before the bit is set, so the waiting task
+     * always finds it. */
+    xReturn = xQueueSend( xQueue, pvItemToQueue, xTicksToWait );
+
+    if( xReturn == pdPASS )
+    {
+        vQueueMuxSignal( pxMux, uxSource );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueMuxSendFromISR( QueueMux_t * pxMux,
+                                 UBaseType_t uxSource,
+                                 QueueHandle_t xQueue,
+                                 const void * pvItemToQueue,
+                                 BaseType_t * pxHigherPriorityTaskWoken )
+{
+    BaseType_t xReturn;
+
+    xReturn = xQueueSendFromISR( xQueue, pvItemToQueue, pxHigherPriorityTaskWoken );
+
+    if( xReturn == pdPASS )
+    {
+        vQueueMuxSignalFromISR( pxMux, uxSource, pxHigherPriorityTaskWoken );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueMuxWait( QueueMux_t * pxMux,
+                          uint32_t pulReady[ qmuxBITMAP_WORDS ],
+                          TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+    uint32_t ulAnyReady;
+    UBaseType_t x;
+    BaseType_t xReturn = pdFALSE;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ; ; )
+    {
+        ulAnyReady = 0;
+
+        /* Take every bit that is set, so the next signal notifies this task
+         * again. */
+        taskENTER_CRITICAL();
+        {
+            pxMux->xWaitingTask = xTaskGetCurrentTaskHandle();
+            pxMux->xNotified = pdFALSE;
+
+            for( x = 0; x < qmuxBITMAP_WORDS; x++ )
+            {
+                pulReady[ x ] = pxMux->ulReady[ x ];
+                pxMux->ulReady[ x ] = 0;
+                ulAnyReady |= pulReady[ x ];
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( ulAnyReady != 0 )
+        {
+            xReturn = pdTRUE;
+            break;
+        }
+
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            break;
+        }
+
+        /* The notification might have been sent for bits that were taken by
+         * the previous call, in which case the loop goes round again. */
+        ( void ) ulTaskNotifyTakeIndexed( configQUEUE_MUX_NOTIFY_INDEX, pdTRUE, xTicksToWait );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueMuxNextSource( uint32_t pulReady[ qmuxBITMAP_WORDS ],
+                                UBaseType_t * puxSource )
+{
+    UBaseType_t x, uxBit;
+    BaseType_t xReturn = pdFALSE;
+
+    for( x = 0; x < qmuxBITMAP_WORDS; x++ )
+    {
+        if( pulReady[ x ] != 0 )
+        {
+            for( uxBit = 0; ( pulReady[ x ] & ( 1UL << uxBit ) ) == 0; uxBit++ )
+            {
+            }
+
+            pulReady[ x ] &= ~( 1UL << uxBit );
+            *puxSource = ( x * 32 ) + uxBit;
+            xReturn = pdTRUE;
+            break;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vStartQueueMuxTasks( void )
+{
+    UBaseType_t x;
+
+    vQueueMuxInit( &xQueueMux );
+
+    for( x = 0; x < qmuxNUM_QUEUES; x++ )
+    {
+        xQueues[ x ] = xQueueCreate( qmuxQUEUE_LENGTH, sizeof( uint32_t ) );
+        configASSERT( xQueues[ x ] );
+
+        if( xQueues[ x ] == NULL )
+        {
+            return;
+        }
+    }
+
+    xTaskCreate( prvQueueMuxReceivingTask, "MuxRx", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL );
+    xTaskCreate( prvQueueMuxSendingTask, "MuxTx", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueMuxSendingTask( void * pvParameters )
+{
+    uint32_t ulCount = 0, ulValue, ulRandom = 0x12345678UL;
+    UBaseType_t uxSource, uxSent, uxWaits;
+
+    /* Remove compiler warnings. */
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        for( uxSent = 0; uxSent < qmuxTX_BURST; )
+        {
+            /* Choose the next queue pseudo randomly. */
+            ulRandom = ( ulRandom * 1103515245UL ) + 12345UL;
+            uxSource = ( UBaseType_t ) ( ( ulRandom >> 16 ) % qmuxNUM_QUEUES );
+
+            ulCount = ( ulCount + 1 ) & qmuxCOUNT_MASK;
+            ulValue = ( ulCount << qmuxCOUNT_SHIFT ) | ( uint32_t ) uxSource;
+
+            /* The queue might be full, in which case the count is skipped,
+             * which the receive task allows for. */
+            if( xQueueMuxSend( &xQueueMux, uxSource, xQueues[ uxSource ], &ulValue, qmuxDONT_BLOCK ) == pdPASS )
+            {
+                ulTaskValuesSent++;
+                uxSent++;
+            }
+            else
+            {
+                /* Let the receive task empty some queues. */
+                taskYIELD();
+            }
+        }
+
+        /* Give the receive task time to empty every queue, then check that it
+         * was woken for every value sent.  It runs at the same priority as
+         * this task, so may need more than one time slice. */
+        for( uxWaits = 0; ( uxWaits < qmuxMAX_RX_WAITS ) && ( ulTaskValuesReceived != ulTaskValuesSent ); uxWaits++ )
+        {
+            vTaskDelay( qmuxTX_LOOP_DELAY );
+        }
+
+        if( ulTaskValuesReceived != ulTaskValuesSent )
+        {
+            xQueueMuxStatus = pdFAIL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueMuxReceivingTask( void * pvParameters )
+{
+    uint32_t ulReady[ qmuxBITMAP_WORDS ], ulReceived;
+    UBaseType_t uxSource;
+
+    /* Remove compiler warnings. */
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        if( xQueueMuxWait( &xQueueMux, ulReady, qmuxRX_BLOCK_TIME ) != pdFALSE )
+        {
+            while( xQueueMuxNextSource( ulReady, &uxSource ) != pdFALSE )
+            {
+                /* Empty the queue, as only one bit is set however many items
+                 * were sent.  The queue may already be empty. */
+                while( xQueueReceive( xQueues[ uxSource ], &ulReceived, qmuxDONT_BLOCK ) == pdPASS )
+                {
+                    prvCheckReceivedValue( uxSource, ulReceived );
+                }
+            }
+
+            if( xQueueMuxStatus == pdPASS )
+            {
+                ulCycleCounter++;
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckReceivedValue( UBaseType_t uxSource,
+                                   uint32_t ulReceived )
+{
+    uint32_t ulCount, *pulLastCount;
+
+    if( ( ulReceived & qmuxSOURCE_MASK ) != ( uint32_t ) uxSource )
+    {
+        xQueueMuxStatus = pdFAIL;
+    }
+
+    if( ( ulReceived & qmuxFROM_ISR ) != 0 )
+    {
+        pulLastCount = &( ulLastISRCount[ uxSource ] );
+    }
+    else
+    {
+        pulLastCount = &( ulLastTaskCount[ uxSource ] );
+        ulTaskValuesReceived++;
+    }
+
+    /* Counts are skipped when a queue is full, and wrap, so the count must
+     * only be ahead of the last count by less than half the range. */
+    ulCount = ( ulReceived >> qmuxCOUNT_SHIFT ) & qmuxCOUNT_MASK;
+
+    if( ( ulCount == *pulLastCount ) ||
+        ( ( ( ulCount - *pulLastCount ) & qmuxCOUNT_MASK ) > ( qmuxCOUNT_MASK / 2 ) ) )
+    {
+        xQueueMuxStatus = pdFAIL;
+    }
+
+    *pulLastCount = ulCount;
+}
+/*-----------------------------------------------------------*/
+
+void vQueueMuxAccessFromISR( void )
+{
+    static uint32_t ulCallCount = 0, ulCount = 0;
+    uint32_t ulValue;
+    UBaseType_t uxSource;
+
+    /* It is intended that this function is called from the tick hook
+     * function, so each call is one tick period apart. */
+    ulCallCount++;
+
+    if( ( ulCallCount > qmuxISR_TX_PERIOD ) && ( xQueues[ qmuxNUM_QUEUES - 1 ] != NULL ) )
+    {
+        ulCallCount = 0;
+
+        ulCount = ( ulCount + 1 ) & qmuxCOUNT_MASK;
+        uxSource = ( UBaseType_t ) ( ulCount % qmuxNUM_QUEUES );
+        ulValue = qmuxFROM_ISR | ( ulCount << qmuxCOUNT_SHIFT ) | ( uint32_t ) uxSource;
+
+        ( void ) xQueueMuxSendFromISR( &xQueueMux, uxSource, xQueues[ uxSource ], &ulValue, NULL );
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreQueueMuxTasksStillRunning( void )
+{
+    static uint32_t ulLastCycleCounter = 0;
+
+    if( ulLastCycleCounter == ulCycleCounter )
+    {
+        xQueueMuxStatus = pdFAIL;
+    }
+
+    ulLastCycleCounter = ulCycleCounter;
+
+    return xQueueMuxStatus;
+}
+/*-----------------------------------------------------------*/
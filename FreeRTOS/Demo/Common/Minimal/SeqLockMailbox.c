@@ -0,0 +1,389 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A latest value mailbox that neither readers nor the writer lock, and tasks
+ * that test it.  See SeqLockMailbox.h for how it works.
+ *
+ * The writer task publishes a value made of slmITEM_WORDS words, every one of
+ * which holds the number of writes made so far, in bursts of
+ * slmWRITES_PER_BURST.  Reader tasks at a lower, the same and a higher
+ * priority than the writer, and the tick hook, read the mailbox as often as
+ * they can.  Each checks that every word of the value it reads is the same,
+ * which would not be the case if a read had overlapped a write, and that
+ * neither the value nor the sequence number returned with it ever go
+ * backwards.
+ *
+ * The higher priority reader and the tick hook interrupt the writer part way
+ * through writes, and the lower priority reader is interrupted by the writer
+ * part way through reads, so both sides of the sequence check are exercised.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "SeqLockMailbox.h"
+
+/* The number of words in the value the demo publishes.  64 words is 256 bytes
+ * on a 32-bit architecture. */
+#define slmITEM_WORDS               64
+
+/* The writer writes slmWRITES_PER_BURST values, then waits a tick. */
+#define slmWRITES_PER_BURST         50
+
+/* The readers that do not run at the idle priority wait a tick after every
+ * slmREADS_PER_BURST reads so lower priority tasks can run. */
+#define slmREADS_PER_BURST          20
+
+#define slmNUM_READERS              3
+#define slmWRITER_PRIORITY          ( tskIDLE_PRIORITY + 2 )
+
+/* The value the demo publishes. */
+typedef struct SeqLockMailboxItem
+{
+    UBaseType_t uxWords[ slmITEM_WORDS ];
+} SeqLockMailboxItem_t;
+
+/*
+ * Check a value read along with its sequence number, returning pdFAIL if it is
+ * torn, or if it or its sequence number are older than the last the same
+ * reader read.  The last sequence number and value are updated for the next
+ * check.
+ */
+static BaseType_t prvCheckItem( const SeqLockMailboxItem_t * pxItem,
+                                UBaseType_t uxSequence,
+                                UBaseType_t * puxLastSequence,
+                                UBaseType_t * puxLastValue );
+
+/*
+ * Returns pdTRUE if uxNow is behind uxBefore, allowing for either having
+ * wrapped.
+ */
+static BaseType_t prvHasGoneBackwards( UBaseType_t uxBefore,
+                                       UBaseType_t uxNow );
+
+/*
+ * The tasks described at the top of this file.
+ */
+static void prvWriterTask( void * pvParameters );
+static void prvReaderTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static SeqLockMailbox_t xMailbox;
+static uint8_t ucMailboxStorage[ seqlockMAILBOX_STORAGE_SIZE( sizeof( SeqLockMailboxItem_t ) ) ];
+
+/* The priorities of the reader tasks, relative to the writer. */
+static const UBaseType_t uxReaderPriorities[ slmNUM_READERS ] =
+{
+    tskIDLE_PRIORITY,
+    slmWRITER_PRIORITY,
+    slmWRITER_PRIORITY + 1
+};
+
+/* Set to pdFAIL if an error is detected.  The cycle counters are only
+ * incremented while xSeqLockMailboxStatus equals pdPASS. */
+static volatile BaseType_t xSeqLockMailboxStatus = pdPASS;
+static volatile uint32_t ulWriterCycles = 0;
+static volatile uint32_t ulReaderCycles[ slmNUM_READERS ] = { 0 };
+static volatile uint32_t ulISRReadCycles = 0;
+
+/*-----------------------------------------------------------*/
+
+void vSeqLockMailboxInit( SeqLockMailbox_t * pxMailbox,
+                          void * pvStorage,
+                          size_t xItemSize )
+{
+    configASSERT( pxMailbox );
+    configASSERT( pvStorage );
+    configASSERT( xItemSize > 0U );
+
+    pxMailbox->uxSequence = 0;
+    pxMailbox->xItemSize = xItemSize;
+    pxMailbox->pucStorage = ( uint8_t * ) pvStorage;
+}
+/*-----------------------------------------------------------*/
+
+void vSeqLockMailboxWrite( SeqLockMailbox_t * pxMailbox,
+                           const void * pvItem )
+{
+    UBaseType_t uxNextSequence;
+
+    configASSERT( pxMailbox );
+    configASSERT( pvItem );
+
+    /* Readers are directed to copy uxSequence & 1, so fill the other copy.  A
+     * reader still copying the copy written before that last one will find
+     * the sequence number has changed once this write is published. */
+    uxNextSequence = pxMailbox->uxSequence + 1U;
+
+    /* A sequence number of 0 means nothing has been written, so skip it when
+     * the sequence number wraps.  Skipping to 2 keeps the copy alternating. */
+    if( uxNextSequence == 0U )
+    {
+        uxNextSequence = 2U;
+    }
+
+    ( void ) memcpy( &( pxMailbox->pucStorage[ ( uxNextSequence & 1U ) * pxMailbox->xItemSize ] ), pvItem, pxMailbox->xItemSize );
+
+    /* The copy must be complete before it is published. */
+    configSEQLOCK_MAILBOX_MEMORY_BARRIER();
+    pxMailbox->uxSequence = uxNextSequence;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xSeqLockMailboxRead( SeqLockMailbox_t * pxMailbox,
+                                void * pvBuffer,
+                                UBaseType_t * puxSequence )
+{
+    UBaseType_t uxSequence;
+    BaseType_t xReturn = pdFALSE;
+
+    configASSERT( pxMailbox );
+    configASSERT( pvBuffer );
+
+    do
+    {
+        uxSequence = pxMailbox->uxSequence;
+
+        if( uxSequence == 0U )
+        {
+            /* Nothing has been written yet. */
+            break;
+        }
+
+        /* The sequence number must be read before the value it points to. */
+        configSEQLOCK_MAILBOX_MEMORY_BARRIER();
+        ( void ) memcpy( pvBuffer, &( pxMailbox->pucStorage[ ( uxSequence & 1U ) * pxMailbox->xItemSize ] ), pxMailbox->xItemSize );
+
+        /* The copy must be complete before the sequence number is checked
+         * again.  If a write was published in the meantime the writer might
+         * have gone on to overwrite the copy just read. */
+        configSEQLOCK_MAILBOX_MEMORY_BARRIER();
+
+        if( pxMailbox->uxSequence == uxSequence )
+        {
+            xReturn = pdTRUE;
+        }
+    } while( xReturn == pdFALSE );
+
+    if( ( xReturn != pdFALSE ) && ( puxSequence != NULL ) )
+    {
+        *puxSequence = uxSequence;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vStartSeqLockMailboxTasks( void )
+{
+    UBaseType_t x;
+
+    vSeqLockMailboxInit( &xMailbox, ucMailboxStorage, sizeof( SeqLockMailboxItem_t ) );
+
+    xTaskCreate( prvWriterTask, "SLWrite", configMINIMAL_STACK_SIZE, NULL, slmWRITER_PRIORITY, NULL );
+
+    for( x = 0; x < slmNUM_READERS; x++ )
+    {
+        /* The item is on the stack of each task, so allow for it. */
+        xTaskCreate( prvReaderTask, "SLRead", configMINIMAL_STACK_SIZE + ( sizeof( SeqLockMailboxItem_t ) / sizeof( StackType_t ) ),
+                     ( void * ) x, uxReaderPriorities[ x ], NULL );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvHasGoneBackwards( UBaseType_t uxBefore,
+                                       UBaseType_t uxNow )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    /* Both count up and wrap, so uxNow is behind if it is more than half the
+     * range of a UBaseType_t ahead. */
+    if( ( UBaseType_t ) ( uxNow - uxBefore ) > ( ( ( UBaseType_t ) ~( UBaseType_t ) 0 ) >> 1 ) )
+    {
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCheckItem( const SeqLockMailboxItem_t * pxItem,
+                                UBaseType_t uxSequence,
+                                UBaseType_t * puxLastSequence,
+                                UBaseType_t * puxLastValue )
+{
+    BaseType_t xReturn = pdPASS;
+    UBaseType_t x;
+
+    for( x = 1; x < slmITEM_WORDS; x++ )
+    {
+        if( pxItem->uxWords[ x ] != pxItem->uxWords[ 0 ] )
+        {
+            xReturn = pdFAIL;
+        }
+    }
+
+    if( ( prvHasGoneBackwards( *puxLastSequence, uxSequence ) != pdFALSE ) ||
+        ( prvHasGoneBackwards( *puxLastValue, pxItem->uxWords[ 0 ] ) != pdFALSE ) )
+    {
+        xReturn = pdFAIL;
+    }
+
+    *puxLastSequence = uxSequence;
+    *puxLastValue = pxItem->uxWords[ 0 ];
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriterTask( void * pvParameters )
+{
+    /* Static to keep it off the stack. */
+    static SeqLockMailboxItem_t xItem;
+    UBaseType_t uxWrites = 0, x, y;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        for( x = 0; x < slmWRITES_PER_BURST; x++ )
+        {
+            uxWrites++;
+
+            for( y = 0; y < slmITEM_WORDS; y++ )
+            {
+                xItem.uxWords[ y ] = uxWrites;
+            }
+
+            vSeqLockMailboxWrite( &xMailbox, &xItem );
+        }
+
+        if( xSeqLockMailboxStatus == pdPASS )
+        {
+            ulWriterCycles++;
+        }
+
+        vTaskDelay( 1 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReaderTask( void * pvParameters )
+{
+    SeqLockMailboxItem_t xItem;
+    UBaseType_t uxReader = ( UBaseType_t ) pvParameters;
+    UBaseType_t uxSequence, uxLastSequence = 0, uxLastValue = 0, uxReads = 0;
+
+    for( ; ; )
+    {
+        if( xSeqLockMailboxRead( &xMailbox, &xItem, &uxSequence ) != pdFALSE )
+        {
+            if( prvCheckItem( &xItem, uxSequence, &uxLastSequence, &uxLastValue ) != pdPASS )
+            {
+                xSeqLockMailboxStatus = pdFAIL;
+            }
+
+            if( xSeqLockMailboxStatus == pdPASS )
+            {
+                ulReaderCycles[ uxReader ]++;
+            }
+        }
+
+        if( uxReaderPriorities[ uxReader ] == tskIDLE_PRIORITY )
+        {
+            taskYIELD();
+        }
+        else
+        {
+            uxReads++;
+
+            if( uxReads >= slmREADS_PER_BURST )
+            {
+                uxReads = 0;
+                vTaskDelay( 1 );
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vSeqLockMailboxReadFromISRTest( void )
+{
+    /* Static to keep it off the interrupt stack. */
+    static SeqLockMailboxItem_t xItem;
+    static UBaseType_t uxLastSequence = 0, uxLastValue = 0;
+    UBaseType_t uxSequence;
+
+    /* The interrupt may have interrupted the writer part way through a write,
+     * in which case it reads the value before the one being written. */
+    if( xSeqLockMailboxRead( &xMailbox, &xItem, &uxSequence ) != pdFALSE )
+    {
+        if( prvCheckItem( &xItem, uxSequence, &uxLastSequence, &uxLastValue ) != pdPASS )
+        {
+            xSeqLockMailboxStatus = pdFAIL;
+        }
+
+        if( xSeqLockMailboxStatus == pdPASS )
+        {
+            ulISRReadCycles++;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreSeqLockMailboxTasksStillRunning( void )
+{
+    static uint32_t ulLastWriterCycles = 0, ulLastISRReadCycles = 0;
+    static uint32_t ulLastReaderCycles[ slmNUM_READERS ] = { 0 };
+    UBaseType_t x;
+
+    if( ( ulLastWriterCycles == ulWriterCycles ) || ( ulLastISRReadCycles == ulISRReadCycles ) )
+    {
+        xSeqLockMailboxStatus = pdFAIL;
+    }
+
+    ulLastWriterCycles = ulWriterCycles;
+    ulLastISRReadCycles = ulISRReadCycles;
+
+    for( x = 0; x < slmNUM_READERS; x++ )
+    {
+        if( ulLastReaderCycles[ x ] == ulReaderCycles[ x ] )
+        {
+            xSeqLockMailboxStatus = pdFAIL;
+        }
+
+        ulLastReaderCycles[ x ] = ulReaderCycles[ x ];
+    }
+
+    return xSeqLockMailboxStatus;
+}
@@ -0,0 +1,654 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * An arena that RTOS objects are created from without a heap, and a task that
+ * tests it.
+ *
+ * The arena is one static array, aligned at run time to
+ * configSTATIC_ARENA_ALIGNMENT, split into the regions listed by
+ * StaticArenaRegion_t.  Each region's size is fixed at compile time by the
+ * configSTATIC_ARENA_ settings, and each keeps the offset of its next free
+ * byte.  Creating an object moves that offset on by the object's size rounded
+ * up to the alignment, inside a critical section, then passes the memory to
+ * the object's xXxxCreateStatic() function.  A task or a queue needs memory
+ * from two regions, so both are checked before either is taken.
+ *
+ * The demo task is itself created from the arena.  It creates a queue, a
+ * binary semaphore, a mutex, a counting semaphore, a timer and an event group
+ * from the arena, checking that each is aligned and that its region shrank by
+ * exactly one slot.  It also checks a queue that does not fit is refused
+ * without taking anything.  It then repeatedly uses each object, waiting on
+ * an event bit that the timer's callback sets.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "event_groups.h"
+
+/* Demo includes. */
+#include "StaticArena.h"
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+/* Round xBytes up to a whole number of configSTATIC_ARENA_ALIGNMENT bytes. */
+    #define arenaALIGNMENT_MASK        ( ( size_t ) configSTATIC_ARENA_ALIGNMENT - ( size_t ) 1 )
+    #define arenaALIGN_UP( xBytes )    ( ( ( size_t ) ( xBytes ) + arenaALIGNMENT_MASK ) & ~arenaALIGNMENT_MASK )
+
+/* The size of each region. */
+    #define arenaTASKS_SIZE            ( ( size_t ) configSTATIC_ARENA_TASKS * arenaALIGN_UP( sizeof( StaticTask_t ) ) )
+    #define arenaQUEUES_SIZE           ( ( size_t ) configSTATIC_ARENA_QUEUES * arenaALIGN_UP( sizeof( StaticQueue_t ) ) )
+    #define arenaSEMAPHORES_SIZE       ( ( size_t ) configSTATIC_ARENA_SEMAPHORES * arenaALIGN_UP( sizeof( StaticSemaphore_t ) ) )
+    #define arenaTIMERS_SIZE           ( ( size_t ) configSTATIC_ARENA_TIMERS * arenaALIGN_UP( sizeof( StaticTimer_t ) ) )
+    #define arenaEVENT_GROUPS_SIZE     ( ( size_t ) configSTATIC_ARENA_EVENT_GROUPS * arenaALIGN_UP( sizeof( StaticEventGroup_t ) ) )
+    #define arenaSTACKS_SIZE           arenaALIGN_UP( ( size_t ) configSTATIC_ARENA_STACK_WORDS * sizeof( StackType_t ) )
+    #define arenaQUEUE_STORAGE_SIZE    arenaALIGN_UP( configSTATIC_ARENA_QUEUE_STORAGE_BYTES )
+
+/* The offset of the end of each region from the aligned start of the arena.
+ * The control blocks come first, so those of different types that are used
+ * together are close to each other. */
+    #define arenaTASKS_END             ( arenaTASKS_SIZE )
+    #define arenaQUEUES_END            ( arenaTASKS_END + arenaQUEUES_SIZE )
+    #define arenaSEMAPHORES_END        ( arenaQUEUES_END + arenaSEMAPHORES_SIZE )
+    #define arenaTIMERS_END            ( arenaSEMAPHORES_END + arenaTIMERS_SIZE )
+    #define arenaEVENT_GROUPS_END      ( arenaTIMERS_END + arenaEVENT_GROUPS_SIZE )
+    #define arenaSTACKS_END            ( arenaEVENT_GROUPS_END + arenaSTACKS_SIZE )
+    #define arenaQUEUE_STORAGE_END     ( arenaSTACKS_END + arenaQUEUE_STORAGE_SIZE )
+
+/* Demo task settings.  The queue's storage must fit in the default
+ * configSTATIC_ARENA_QUEUE_STORAGE_BYTES. */
+    #define arenaQUEUE_LENGTH          ( 4 )
+    #define arenaCOUNTING_MAX          ( 3 )
+    #define arenaTIMER_PERIOD          pdMS_TO_TICKS( ( TickType_t ) 20 )
+    #define arenaTIMER_BIT             ( ( EventBits_t ) 0x01 )
+    #define arenaBLOCK_TIME            pdMS_TO_TICKS( ( TickType_t ) 500 )
+    #define arenaDEMO_STACK_SIZE       ( configMINIMAL_STACK_SIZE * 2 )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Take xObjectBytes from eObjectRegion and xStorageBytes from eStorageRegion,
+ * or nothing if either does not have room.  *ppvStorage is set to NULL if
+ * xStorageBytes is 0.
+ */
+    static BaseType_t prvArenaTake( StaticArenaRegion_t eObjectRegion,
+                                    size_t xObjectBytes,
+                                    void ** ppvObject,
+                                    StaticArenaRegion_t eStorageRegion,
+                                    size_t xStorageBytes,
+                                    void ** ppvStorage );
+
+/*
+ * The aligned start of the arena.
+ */
+    static uint8_t * prvArenaStart( void );
+
+/*
+ * The demo task described at the top of this file, the timer callback it uses,
+ * and the function that creates and checks its objects.
+ */
+    static void prvStaticArenaTask( void * pvParameters );
+    static void prvTimerCallback( TimerHandle_t xTimer );
+    static BaseType_t prvCreateDemoObjects( void );
+    static BaseType_t prvUseDemoObjects( void );
+
+/*
+ * Check the handle returned by a create function is aligned and that creating
+ * it took exactly xSlotBytes from eRegion, whose free size was xFreeBefore.
+ */
+    static BaseType_t prvCheckSlot( void * pvHandle,
+                                    StaticArenaRegion_t eRegion,
+                                    size_t xFreeBefore,
+                                    size_t xSlotBytes );
+
+/*-----------------------------------------------------------*/
+
+/* The arena, with room to move its start up to the alignment. */
+    static uint8_t ucArena[ arenaQUEUE_STORAGE_END + configSTATIC_ARENA_ALIGNMENT ];
+
+/* The offset of the next free byte, and of the end, of each region. */
+    static size_t xRegionNext[ eStaticArenaNumberOfRegions ] =
+    {
+        0,
+        arenaTASKS_END,
+        arenaQUEUES_END,
+        arenaSEMAPHORES_END,
+        arenaTIMERS_END,
+        arenaEVENT_GROUPS_END,
+        arenaSTACKS_END
+    };
+
+    static const size_t xRegionEnd[ eStaticArenaNumberOfRegions ] =
+    {
+        arenaTASKS_END,
+        arenaQUEUES_END,
+        arenaSEMAPHORES_END,
+        arenaTIMERS_END,
+        arenaEVENT_GROUPS_END,
+        arenaSTACKS_END,
+        arenaQUEUE_STORAGE_END
+    };
+
+/* The objects used by the demo task. */
+    static QueueHandle_t xDemoQueue = NULL;
+    static SemaphoreHandle_t xDemoBinarySemaphore = NULL;
+    static SemaphoreHandle_t xDemoMutex = NULL;
+    static SemaphoreHandle_t xDemoCountingSemaphore = NULL;
+    static TimerHandle_t xDemoTimer = NULL;
+    static EventGroupHandle_t xDemoEventGroup = NULL;
+
+/* Set to pdFAIL if an error is detected.  The cycle counter is only
+ * incremented while xStaticArenaStatus equals pdPASS. */
+    static volatile BaseType_t xStaticArenaStatus = pdPASS;
+    static volatile uint32_t ulStaticArenaCycles = 0;
+
+/*-----------------------------------------------------------*/
+
+    static uint8_t * prvArenaStart( void )
+    {
+        return ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) &( ucArena[ arenaALIGNMENT_MASK ] ) ) & ( ~( ( portPOINTER_SIZE_TYPE ) arenaALIGNMENT_MASK ) ) );
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvArenaTake( StaticArenaRegion_t eObjectRegion,
+                                    size_t xObjectBytes,
+                                    void ** ppvObject,
+                                    StaticArenaRegion_t eStorageRegion,
+                                    size_t xStorageBytes,
+                                    void ** ppvStorage )
+    {
+        uint8_t * pucStart = prvArenaStart();
+        size_t xObjectSlot, xStorageSlot;
+        BaseType_t xReturn = pdFAIL;
+
+        configASSERT( eObjectRegion != eStorageRegion );
+
+        /* A request larger than the whole region can never be met, and is
+         * refused before rounding it up could wrap. */
+        if( ( xObjectBytes <= arenaQUEUE_STORAGE_END ) && ( xStorageBytes <= arenaQUEUE_STORAGE_END ) )
+        {
+            xObjectSlot = arenaALIGN_UP( xObjectBytes );
+            xStorageSlot = arenaALIGN_UP( xStorageBytes );
+
+            taskENTER_CRITICAL();
+            {
+                if( ( ( xRegionEnd[ eObjectRegion ] - xRegionNext[ eObjectRegion ] ) >= xObjectSlot ) &&
+                    ( ( xRegionEnd[ eStorageRegion ] - xRegionNext[ eStorageRegion ] ) >= xStorageSlot ) )
+                {
+                    *ppvObject = ( void * ) &( pucStart[ xRegionNext[ eObjectRegion ] ] );
+                    xRegionNext[ eObjectRegion ] += xObjectSlot;
+
+                    if( xStorageSlot != ( size_t ) 0 )
+                    {
+                        *ppvStorage = ( void * ) &( pucStart[ xRegionNext[ eStorageRegion ] ] );
+                        xRegionNext[ eStorageRegion ] += xStorageSlot;
+                    }
+                    else
+                    {
+                        *ppvStorage = NULL;
+                    }
+
+                    xReturn = pdPASS;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xStaticArenaTaskCreate( TaskFunction_t pxTaskCode,
+                                       const char * const pcName,
+                                       const configSTACK_DEPTH_TYPE uxStackDepth,
+                                       void * const pvParameters,
+                                       UBaseType_t uxPriority,
+                                       TaskHandle_t * const pxCreatedTask )
+    {
+        void * pvTaskBuffer;
+        void * pvStackBuffer;
+        TaskHandle_t xCreatedTask;
+        BaseType_t xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+
+        if( prvArenaTake( eStaticArenaTasks, sizeof( StaticTask_t ), &pvTaskBuffer,
+                          eStaticArenaStacks, ( size_t ) uxStackDepth * sizeof( StackType_t ), &pvStackBuffer ) != pdFAIL )
+        {
+            xCreatedTask = xTaskCreateStatic( pxTaskCode, pcName, uxStackDepth, pvParameters, uxPriority,
+                                              ( StackType_t * ) pvStackBuffer, ( StaticTask_t * ) pvTaskBuffer );
+
+            if( xCreatedTask != NULL )
+            {
+                if( pxCreatedTask != NULL )
+                {
+                    *pxCreatedTask = xCreatedTask;
+                }
+
+                xReturn = pdPASS;
+            }
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    QueueHandle_t xStaticArenaQueueCreate( const UBaseType_t uxQueueLength,
+                                           const UBaseType_t uxItemSize )
+    {
+        void * pvQueueBuffer;
+        void * pvStorage;
+        QueueHandle_t xReturn = NULL;
+
+        /* Refuse a storage size that overflows, as xQueueCreate() does. */
+        if( ( uxItemSize == ( UBaseType_t ) 0 ) || ( ( ( size_t ) uxQueueLength ) <= ( ( ( size_t ) -1 ) / ( size_t ) uxItemSize ) ) )
+        {
+            if( prvArenaTake( eStaticArenaQueues, sizeof( StaticQueue_t ), &pvQueueBuffer,
+                              eStaticArenaQueueStorage, ( size_t ) uxQueueLength * ( size_t ) uxItemSize, &pvStorage ) != pdFAIL )
+            {
+                xReturn = xQueueCreateStatic( uxQueueLength, uxItemSize, ( uint8_t * ) pvStorage, ( StaticQueue_t * ) pvQueueBuffer );
+            }
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    SemaphoreHandle_t xStaticArenaSemaphoreCreateBinary( void )
+    {
+        void * pvSemaphoreBuffer;
+        void * pvUnused;
+        SemaphoreHandle_t xReturn = NULL;
+
+        if( prvArenaTake( eStaticArenaSemaphores, sizeof( StaticSemaphore_t ), &pvSemaphoreBuffer,
+                          eStaticArenaQueueStorage, 0, &pvUnused ) != pdFAIL )
+        {
+            xReturn = xSemaphoreCreateBinaryStatic( ( StaticSemaphore_t * ) pvSemaphoreBuffer );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( configUSE_MUTEXES == 1 )
+
+        SemaphoreHandle_t xStaticArenaSemaphoreCreateMutex( void )
+        {
+            void * pvSemaphoreBuffer;
+            void * pvUnused;
+            SemaphoreHandle_t xReturn = NULL;
+
+            if( prvArenaTake( eStaticArenaSemaphores, sizeof( StaticSemaphore_t ), &pvSemaphoreBuffer,
+                              eStaticArenaQueueStorage, 0, &pvUnused ) != pdFAIL )
+            {
+                xReturn = xSemaphoreCreateMutexStatic( ( StaticSemaphore_t * ) pvSemaphoreBuffer );
+            }
+
+            return xReturn;
+        }
+
+    #endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+    #if ( configUSE_RECURSIVE_MUTEXES == 1 )
+
+        SemaphoreHandle_t xStaticArenaSemaphoreCreateRecursiveMutex( void )
+        {
+            void * pvSemaphoreBuffer;
+            void * pvUnused;
+            SemaphoreHandle_t xReturn = NULL;
+
+            if( prvArenaTake( eStaticArenaSemaphores, sizeof( StaticSemaphore_t ), &pvSemaphoreBuffer,
+                              eStaticArenaQueueStorage, 0, &pvUnused ) != pdFAIL )
+            {
+                xReturn = xSemaphoreCreateRecursiveMutexStatic( ( StaticSemaphore_t * ) pvSemaphoreBuffer );
+            }
+
+            return xReturn;
+        }
+
+    #endif /* configUSE_RECURSIVE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+    #if ( configUSE_COUNTING_SEMAPHORES == 1 )
+
+        SemaphoreHandle_t xStaticArenaSemaphoreCreateCounting( UBaseType_t uxMaxCount,
+                                                               UBaseType_t uxInitialCount )
+        {
+            void * pvSemaphoreBuffer;
+            void * pvUnused;
+            SemaphoreHandle_t xReturn = NULL;
+
+            if( prvArenaTake( eStaticArenaSemaphores, sizeof( StaticSemaphore_t ), &pvSemaphoreBuffer,
+                              eStaticArenaQueueStorage, 0, &pvUnused ) != pdFAIL )
+            {
+                xReturn = xSemaphoreCreateCountingStatic( uxMaxCount, uxInitialCount, ( StaticSemaphore_t * ) pvSemaphoreBuffer );
+            }
+
+            return xReturn;
+        }
+
+    #endif /* configUSE_COUNTING_SEMAPHORES */
+/*-----------------------------------------------------------*/
+
+    #if ( configUSE_TIMERS == 1 )
+
+        TimerHandle_t xStaticArenaTimerCreate( const char * const pcTimerName,
+                                               const TickType_t xTimerPeriodInTicks,
+                                               const BaseType_t xAutoReload,
+                                               void * const pvTimerID,
+                                               TimerCallbackFunction_t pxCallbackFunction )
+        {
+            void * pvTimerBuffer;
+            void * pvUnused;
+            TimerHandle_t xReturn = NULL;
+
+            if( prvArenaTake( eStaticArenaTimers, sizeof( StaticTimer_t ), &pvTimerBuffer,
+                              eStaticArenaQueueStorage, 0, &pvUnused ) != pdFAIL )
+            {
+                xReturn = xTimerCreateStatic( pcTimerName, xTimerPeriodInTicks, xAutoReload, pvTimerID,
+                                              pxCallbackFunction, ( StaticTimer_t * ) pvTimerBuffer );
+            }
+
+            return xReturn;
+        }
+
+    #endif /* configUSE_TIMERS */
+/*-----------------------------------------------------------*/
+
+    EventGroupHandle_t xStaticArenaEventGroupCreate( void )
+    {
+        void * pvEventGroupBuffer;
+        void * pvUnused;
+        EventGroupHandle_t xReturn = NULL;
+
+        if( prvArenaTake( eStaticArenaEventGroups, sizeof( StaticEventGroup_t ), &pvEventGroupBuffer,
+                          eStaticArenaQueueStorage, 0, &pvUnused ) != pdFAIL )
+        {
+            xReturn = xEventGroupCreateStatic( ( StaticEventGroup_t * ) pvEventGroupBuffer );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    size_t xStaticArenaGetFreeBytes( StaticArenaRegion_t eRegion )
+    {
+        size_t xReturn;
+
+        configASSERT( eRegion < eStaticArenaNumberOfRegions );
+
+        taskENTER_CRITICAL();
+        {
+            xReturn = xRegionEnd[ eRegion ] - xRegionNext[ eRegion ];
+        }
+        taskEXIT_CRITICAL();
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vStartStaticArenaTasks( UBaseType_t uxPriority )
+    {
+        if( xStaticArenaTaskCreate( prvStaticArenaTask, "Arena", arenaDEMO_STACK_SIZE, NULL, uxPriority, NULL ) != pdPASS )
+        {
+            xStaticArenaStatus = pdFAIL;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvCheckSlot( void * pvHandle,
+                                    StaticArenaRegion_t eRegion,
+                                    size_t xFreeBefore,
+                                    size_t xSlotBytes )
+    {
+        BaseType_t xReturn = pdPASS;
+
+        if( pvHandle == NULL )
+        {
+            xReturn = pdFAIL;
+        }
+        else if( ( ( ( portPOINTER_SIZE_TYPE ) pvHandle ) & ( ( portPOINTER_SIZE_TYPE ) arenaALIGNMENT_MASK ) ) != 0 )
+        {
+            xReturn = pdFAIL;
+        }
+        else if( xStaticArenaGetFreeBytes( eRegion ) != ( xFreeBefore - arenaALIGN_UP( xSlotBytes ) ) )
+        {
+            xReturn = pdFAIL;
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvCreateDemoObjects( void )
+    {
+        BaseType_t xReturn = pdPASS;
+        size_t xFree, xStorageFree;
+
+        /* A queue whose storage does not fit must not take a queue either.
+         * This is checked first, while the queue region still has room. */
+        xFree = xStaticArenaGetFreeBytes( eStaticArenaQueues );
+        xStorageFree = xStaticArenaGetFreeBytes( eStaticArenaQueueStorage );
+
+        if( ( xStaticArenaQueueCreate( 1, ( UBaseType_t ) ( xStorageFree + 1 ) ) != NULL ) ||
+            ( xStaticArenaGetFreeBytes( eStaticArenaQueues ) != xFree ) ||
+            ( xStaticArenaGetFreeBytes( eStaticArenaQueueStorage ) != xStorageFree ) )
+        {
+            xReturn = pdFAIL;
+        }
+
+        xDemoQueue = xStaticArenaQueueCreate( arenaQUEUE_LENGTH, sizeof( uint32_t ) );
+
+        if( ( prvCheckSlot( xDemoQueue, eStaticArenaQueues, xFree, sizeof( StaticQueue_t ) ) != pdPASS ) ||
+            ( xStaticArenaGetFreeBytes( eStaticArenaQueueStorage ) != ( xStorageFree - arenaALIGN_UP( arenaQUEUE_LENGTH * sizeof( uint32_t ) ) ) ) )
+        {
+            xReturn = pdFAIL;
+        }
+
+        xFree = xStaticArenaGetFreeBytes( eStaticArenaSemaphores );
+        xDemoBinarySemaphore = xStaticArenaSemaphoreCreateBinary();
+
+        if( prvCheckSlot( xDemoBinarySemaphore, eStaticArenaSemaphores, xFree, sizeof( StaticSemaphore_t ) ) != pdPASS )
+        {
+            xReturn = pdFAIL;
+        }
+
+        #if ( configUSE_MUTEXES == 1 )
+        {
+            xFree = xStaticArenaGetFreeBytes( eStaticArenaSemaphores );
+            xDemoMutex = xStaticArenaSemaphoreCreateMutex();
+
+            if( prvCheckSlot( xDemoMutex, eStaticArenaSemaphores, xFree, sizeof( StaticSemaphore_t ) ) != pdPASS )
+            {
+                xReturn = pdFAIL;
+            }
+        }
+        #endif
+
+        #if ( configUSE_COUNTING_SEMAPHORES == 1 )
+        {
+            xFree = xStaticArenaGetFreeBytes( eStaticArenaSemaphores );
+            xDemoCountingSemaphore = xStaticArenaSemaphoreCreateCounting( arenaCOUNTING_MAX, 0 );
+
+            if( prvCheckSlot( xDemoCountingSemaphore, eStaticArenaSemaphores, xFree, sizeof( StaticSemaphore_t ) ) != pdPASS )
+            {
+                xReturn = pdFAIL;
+            }
+        }
+        #endif
+
+        xFree = xStaticArenaGetFreeBytes( eStaticArenaEventGroups );
+        xDemoEventGroup = xStaticArenaEventGroupCreate();
+
+        if( prvCheckSlot( xDemoEventGroup, eStaticArenaEventGroups, xFree, sizeof( StaticEventGroup_t ) ) != pdPASS )
+        {
+            xReturn = pdFAIL;
+        }
+
+        #if ( configUSE_TIMERS == 1 )
+        {
+            xFree = xStaticArenaGetFreeBytes( eStaticArenaTimers );
+            xDemoTimer = xStaticArenaTimerCreate( "Arena", arenaTIMER_PERIOD, pdTRUE, NULL, prvTimerCallback );
+
+            if( prvCheckSlot( xDemoTimer, eStaticArenaTimers, xFree, sizeof( StaticTimer_t ) ) != pdPASS )
+            {
+                xReturn = pdFAIL;
+            }
+            else if( xTimerStart( xDemoTimer, arenaBLOCK_TIME ) != pdPASS )
+            {
+                xReturn = pdFAIL;
+            }
+        }
+        #endif
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvTimerCallback( TimerHandle_t xTimer )
+    {
+        ( void ) xTimer;
+
+        xEventGroupSetBits( xDemoEventGroup, arenaTIMER_BIT );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvStaticArenaTask( void * pvParameters )
+    {
+        ( void ) pvParameters;
+
+        /* The demo objects are created after the scheduler has started, so
+         * taking memory from the arena is tested from a task as well as from
+         * main(), where this task was created. */
+        if( prvCreateDemoObjects() != pdPASS )
+        {
+            xStaticArenaStatus = pdFAIL;
+        }
+
+        for( ; ; )
+        {
+            if( xStaticArenaStatus == pdPASS )
+            {
+                if( prvUseDemoObjects() == pdPASS )
+                {
+                    ulStaticArenaCycles++;
+                }
+                else
+                {
+                    xStaticArenaStatus = pdFAIL;
+                }
+            }
+            else
+            {
+                /* Leave the objects alone, as some may not exist. */
+                vTaskDelay( arenaBLOCK_TIME );
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvUseDemoObjects( void )
+    {
+        static uint32_t ulSent = 0;
+        uint32_t ulReceived;
+        EventBits_t uxBits;
+        BaseType_t xReturn = pdPASS;
+
+        ulSent++;
+
+        if( ( xQueueSend( xDemoQueue, &ulSent, 0 ) != pdPASS ) ||
+            ( xQueueReceive( xDemoQueue, &ulReceived, 0 ) != pdPASS ) ||
+            ( ulReceived != ulSent ) )
+        {
+            xReturn = pdFAIL;
+        }
+
+        if( ( xSemaphoreGive( xDemoBinarySemaphore ) != pdPASS ) ||
+            ( xSemaphoreTake( xDemoBinarySemaphore, 0 ) != pdPASS ) )
+        {
+            xReturn = pdFAIL;
+        }
+
+        #if ( configUSE_MUTEXES == 1 )
+        {
+            if( ( xSemaphoreTake( xDemoMutex, 0 ) != pdPASS ) ||
+                ( xSemaphoreGive( xDemoMutex ) != pdPASS ) )
+            {
+                xReturn = pdFAIL;
+            }
+        }
+        #endif
+
+        #if ( configUSE_COUNTING_SEMAPHORES == 1 )
+        {
+            if( ( xSemaphoreGive( xDemoCountingSemaphore ) != pdPASS ) ||
+                ( xSemaphoreTake( xDemoCountingSemaphore, 0 ) != pdPASS ) )
+            {
+                xReturn = pdFAIL;
+            }
+        }
+        #endif
+
+        #if ( configUSE_TIMERS == 1 )
+        {
+            /* Wait for the timer created from the arena to set the bit. */
+            uxBits = xEventGroupWaitBits( xDemoEventGroup, arenaTIMER_BIT, pdTRUE, pdTRUE, arenaBLOCK_TIME );
+        }
+        #else
+        {
+            xEventGroupSetBits( xDemoEventGroup, arenaTIMER_BIT );
+            uxBits = xEventGroupClearBits( xDemoEventGroup, arenaTIMER_BIT );
+            vTaskDelay( arenaTIMER_PERIOD );
+        }
+        #endif
+
+        if( ( uxBits & arenaTIMER_BIT ) == 0 )
+        {
+            xReturn = pdFAIL;
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xAreStaticArenaTasksStillRunning( void )
+    {
+        static uint32_t ulLastStaticArenaCycles = 0;
+
+        if( ulLastStaticArenaCycles == ulStaticArenaCycles )
+        {
+            xStaticArenaStatus = pdFAIL;
+        }
+
+        ulLastStaticArenaCycles = ulStaticArenaCycles;
+
+        return xStaticArenaStatus;
+    }
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
@@ -33,6 +33,18 @@
  * a few bytes of pcStringToSend to a stream buffer ever few times that it
  * executes.  A task reads the bytes from the stream buffer, looking for the
  * substring, and flagging an error if the received data is invalid.
+ *
+ * If sbiCOALESCE_BYTES is set to a non-zero value the receiving task is only
+ * woken once sbiCOALESCE_BYTES bytes are waiting, or sbiCOALESCE_TIMEOUT_US
+ * microseconds after the first waiting byte arrived, whichever comes first.
+ * That is the pattern to use for a fast peripheral, such as a UART, where
+ * waking the task for every few bytes would cost more than processing them.
+ * The byte count is the stream buffer's trigger level.  The timeout is a one
+ * shot hardware timer, started by sbiSTART_COALESCE_TIMER() and stopped by
+ * sbiSTOP_COALESCE_TIMER(), whose interrupt calls
+ * vStreamBufferCoalesceTimeoutFromISR().  If those macros are not defined the
+ * timer is emulated by counting calls to vBasicStreamBufferSendFromISR(),
+ * which is called from the tick hook.
  */
 
 /* Standard includes. */
@@ -50,6 +62,30 @@
 #define sbiSTREAM_BUFFER_LENGTH_BYTES        ( ( size_t ) 100 )
 #define sbiSTREAM_BUFFER_TRIGGER_LEVEL_10    ( ( BaseType_t ) 10 )
 
+/* The number of bytes that wakes the receiving task in coalescing mode.  0
+ * disables coalescing. */
+#ifndef sbiCOALESCE_BYTES
+    #define sbiCOALESCE_BYTES    0
+#endif
+
+/* The longest time a byte waits before the receiving task is woken in
+ * coalescing mode. */
+#ifndef sbiCOALESCE_TIMEOUT_US
+    #define sbiCOALESCE_TIMEOUT_US    1000UL
+#endif
+
+#if ( sbiCOALESCE_BYTES > 0 )
+    #ifndef sbiSTART_COALESCE_TIMER
+
+/* Emulate a one shot timer using the tick, rounding up to at least one
+ * tick. */
+        #define sbiEMULATED_TIMER_TICKS                                                         \
+    ( ( ( ( uint64_t ) sbiCOALESCE_TIMEOUT_US * configTICK_RATE_HZ ) + 999999ULL ) / 1000000ULL )
+        #define sbiSTART_COALESCE_TIMER( ulMicroseconds )    ( xEmulatedTimerTicks = ( TickType_t ) sbiEMULATED_TIMER_TICKS )
+        #define sbiSTOP_COALESCE_TIMER()                     ( xEmulatedTimerTicks = 0 )
+    #endif
+#endif /* sbiCOALESCE_BYTES */
+
 /*-----------------------------------------------------------*/
 
 /* Implements the task that receives a stream of bytes from the interrupt. */
@@ -76,16 +112,38 @@ static BaseType_t xDemoStatus = pdPASS;
  * running as expected. */
 static uint32_t ulCycleCount = 0;
 
+#if ( sbiCOALESCE_BYTES > 0 )
+
+/* Set while the coalescing timer is running, which is while there are fewer
+ * than sbiCOALESCE_BYTES bytes that have not yet woken the task. */
+    static volatile BaseType_t xCoalesceTimerRunning = pdFALSE;
+
+    #ifdef sbiEMULATED_TIMER_TICKS
+        /* Ticks until the emulated timer expires, or 0 if it is not running. */
+        static TickType_t xEmulatedTimerTicks = 0;
+    #endif
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vStartStreamBufferInterruptDemo( void )
 {
     /* Create the stream buffer that sends data from the interrupt to the
      * task, and create the task. */
-    xStreamBuffer = xStreamBufferCreate( /* The buffer length in bytes. */
-        sbiSTREAM_BUFFER_LENGTH_BYTES,
-        /* The stream buffer's trigger level. */
-        sbiSTREAM_BUFFER_TRIGGER_LEVEL_10 );
+    #if ( sbiCOALESCE_BYTES > 0 )
+    {
+        /* The trigger level provides the byte count part of coalescing. */
+        configASSERT( ( size_t ) sbiCOALESCE_BYTES <= sbiSTREAM_BUFFER_LENGTH_BYTES );
+        xStreamBuffer = xStreamBufferCreate( sbiSTREAM_BUFFER_LENGTH_BYTES, sbiCOALESCE_BYTES );
+    }
+    #else
+    {
+        xStreamBuffer = xStreamBufferCreate( /* The buffer length in bytes. */
+            sbiSTREAM_BUFFER_LENGTH_BYTES,
+            /* The stream buffer's trigger level. */
+            sbiSTREAM_BUFFER_TRIGGER_LEVEL_10 );
+    }
+    #endif
 
     xTaskCreate( prvReceivingTask,         /* The function that implements the task. */
                  "StrIntRx",               /* Human readable name for the task. */
@@ -98,8 +156,9 @@ void vStartStreamBufferInterruptDemo( void )
 
 static void prvReceivingTask( void * pvParameters )
 {
-    char cRxBuffer[ 20 ];
+    char cRxBuffer[ 20 ], cChunk[ 16 ];
     BaseType_t xNextByte = 0;
+    size_t xReceived, x;
 
     /* Remove warning about unused parameters. */
     ( void ) pvParameters;
@@ -116,63 +175,71 @@ static void prvReceivingTask( void * pvParameters )
 
     for( ; ; )
     {
-        /* Keep receiving characters until the end of the string is received.
+        /* Receive everything that is waiting, up to the size of cChunk, so
+         * one wake up processes all the bytes that were coalesced.
          * Note:  An infinite block time is used to simplify the example.  Infinite
          * block times are not recommended in production code as they do not allow
          * for error recovery. */
-        xStreamBufferReceive( /* The stream buffer data is being received from. */
+        xReceived = xStreamBufferReceive( /* The stream buffer data is being received from. */
             xStreamBuffer,
             /* Where to place received data. */
-            ( void * ) &( cRxBuffer[ xNextByte ] ),
-            /* The number of bytes to receive. */
-            sizeof( char ),
+            ( void * ) cChunk,
+            /* The maximum number of bytes to receive. */
+            sizeof( cChunk ),
 
             /* The time to wait for the next data if the buffer
              * is empty. */
             portMAX_DELAY );
 
-        /* If xNextByte is 0 then this task is looking for the start of the
-         * string, which is 'H'. */
-        if( xNextByte == 0 )
-        {
-            if( cRxBuffer[ xNextByte ] == 'H' )
-            {
-                /* The start of the string has been found.  Now receive
-                 * characters until the end of the string is found. */
-                xNextByte++;
-            }
-        }
-        else
+        /* Keep processing characters until the end of the string is
+         * received. */
+        for( x = 0; x < xReceived; x++ )
         {
-            /* Receiving characters while looking for the end of the string,
-             * which is an 'S'. */
-            if( cRxBuffer[ xNextByte ] == 'S' )
-            {
-                /* The string has now been received.  Check its validity. */
-                if( strcmp( cRxBuffer, pcStringToReceive ) != 0 )
-                {
-                    xDemoStatus = pdFAIL;
-                }
-
-                /* Return to start looking for the beginning of the string
-                 * again. */
-                memset( cRxBuffer, 0x00, sizeof( cRxBuffer ) );
-                xNextByte = 0;
+            cRxBuffer[ xNextByte ] = cChunk[ x ];
 
-                /* Increment the cycle count as an indication to the check task
-                 * that this demo is still running. */
-                if( xDemoStatus == pdPASS )
+            /* If xNextByte is 0 then this task is looking for the start of the
+             * string, which is 'H'. */
+            if( xNextByte == 0 )
+            {
+                if( cRxBuffer[ xNextByte ] == 'H' )
                 {
-                    ulCycleCount++;
+                    /* The start of the string has been found.  Now receive
+                     * characters until the end of the string is found. */
+                    xNextByte++;
                 }
             }
             else
             {
-                /* Receive the next character the next time around, while
-                 * continuing to look for the end of the string. */
-                xNextByte++;
+                /* Receiving characters while looking for the end of the string,
+                 * which is an 'S'. */
+                if( cRxBuffer[ xNextByte ] == 'S' )
+                {
+                    /* The string has now been received.  Check its validity. */
+                    if( strcmp( cRxBuffer, pcStringToReceive ) != 0 )
+                    {
+                        xDemoStatus = pdFAIL;
+                    }
+
+                    /* Return to start looking for the beginning of the string
+                     * again. */
+                    memset( cRxBuffer, 0x00, sizeof( cRxBuffer ) );
+                    xNextByte = 0;
+
+                    /* Increment the cycle count as an indication to the check task
+                     * that this demo is still running. */
+                    if( xDemoStatus == pdPASS )
+                    {
+                        ulCycleCount++;
+                    }
+                }
+                else
+                {
+                    /* Receive the next character the next time around, while
+                     * continuing to look for the end of the string. */
+                    xNextByte++;
 
-                configASSERT( ( size_t ) xNextByte < sizeof( cRxBuffer ) );
+                    configASSERT( ( size_t ) xNextByte < sizeof( cRxBuffer ) );
+                }
             }
         }
     }
@@ -185,6 +252,22 @@ void vBasicStreamBufferSendFromISR( void )
     const BaseType_t xCallsBetweenSends = 100, xBytesToSend = 4;
     static BaseType_t xCallCount = 0;
 
+    #ifdef sbiEMULATED_TIMER_TICKS
+    {
+        /* This function is called from the tick hook, so can stand in for the
+         * coalescing timer's interrupt. */
+        if( xEmulatedTimerTicks > 0 )
+        {
+            xEmulatedTimerTicks--;
+
+            if( xEmulatedTimerTicks == 0 )
+            {
+                vStreamBufferCoalesceTimeoutFromISR( NULL );
+            }
+        }
+    }
+    #endif
+
     /* Is it time to write to the stream buffer again? */
     xCallCount++;
 
@@ -198,6 +281,29 @@ void vBasicStreamBufferSendFromISR( void )
                                   xBytesToSend,
                                   NULL );
 
+        #if ( sbiCOALESCE_BYTES > 0 )
+        {
+            if( xStreamBufferBytesAvailable( xStreamBuffer ) >= ( size_t ) sbiCOALESCE_BYTES )
+            {
+                /* Reaching the trigger level has woken the task, so the
+                 * timeout is no longer needed. */
+                if( xCoalesceTimerRunning != pdFALSE )
+                {
+                    xCoalesceTimerRunning = pdFALSE;
+                    sbiSTOP_COALESCE_TIMER();
+                }
+            }
+            else if( xCoalesceTimerRunning == pdFALSE )
+            {
+                /* These are the first bytes that have not woken the task, so
+                 * the task must be woken within sbiCOALESCE_TIMEOUT_US even if
+                 * no more arrive. */
+                xCoalesceTimerRunning = pdTRUE;
+                sbiSTART_COALESCE_TIMER( sbiCOALESCE_TIMEOUT_US );
+            }
+        }
+        #endif /* sbiCOALESCE_BYTES */
+
         /* Send the next four bytes the next time around, wrapping to the start
          * of the string if necessary. */
         xNextByteToSend += xBytesToSend;
@@ -210,6 +316,23 @@ void vBasicStreamBufferSendFromISR( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( sbiCOALESCE_BYTES > 0 )
+
+    void vStreamBufferCoalesceTimeoutFromISR( BaseType_t * pxHigherPriorityTaskWoken )
+    {
+        xCoalesceTimerRunning = pdFALSE;
+
+        /* Wake the task for the bytes that have not reached the trigger
+         * level.  This has no effect if the task is not waiting. */
+        if( xStreamBufferBytesAvailable( xStreamBuffer ) > 0 )
+        {
+            ( void ) xStreamBufferSendCompletedFromISR( xStreamBuffer, pxHigherPriorityTaskWoken );
+        }
+    }
+
+#endif /* sbiCOALESCE_BYTES */
+/*-----------------------------------------------------------*/
+
 BaseType_t xIsInterruptStreamBufferDemoStillRunning( void )
 {
     uint32_t ulLastCycleCount = 0;
@@ -0,0 +1,677 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A two level segregated fit allocator, as described in TLSFHeap.h.
+ *
+ * Every block starts with a header holding its size and a pointer to the
+ * block before it in memory, so a freed block can be merged with both of its
+ * neighbours without searching.  The payload of a free block holds the links
+ * of the free list it is in.  The region ends with a zero length block that is
+ * never free, which stops the merge at the end of the region, and the first
+ * block has no previous block, which stops it at the start.
+ *
+ * Finding a list is a pair of find first set operations on the bitmaps, which
+ * GCC compiles to a count leading or trailing zeros instruction where the
+ * architecture has one.
+ *
+ * When configUSE_TLSF_HEAP is 1 this file also implements the heap functions
+ * the kernel uses, in place of heap_n.c.  Demo/Common/Minimal/HeapBenchmark.c
+ * compares the allocator with the heap the application is built with.
+ */
+
+/* Standard includes. */
+#include <stddef.h>
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+
+#ifndef configUSE_TLSF_HEAP
+    #define configUSE_TLSF_HEAP    0
+#endif
+
+#if ( configUSE_TLSF_HEAP == 1 )
+    #include "task.h"
+#endif
+
+/* Demo includes. */
+#include "TLSFHeap.h"
+
+/* Bit 0 of a block's size is set while the block is free. */
+#define tlsfBLOCK_FREE          ( ( size_t ) 1 )
+#define tlsfSIZE_MASK           ( ~( tlsfALIGNMENT - 1 ) )
+
+#define tlsfROUND_UP( x )       ( ( ( x ) + ( tlsfALIGNMENT - 1 ) ) & tlsfSIZE_MASK )
+
+/* The part of the header always present, and the smallest payload, which must
+ * be big enough to hold the free list links. */
+#define tlsfHEADER_SIZE         tlsfROUND_UP( offsetof( TLSFBlock_t, pxNextFree ) )
+#define tlsfMINIMUM_PAYLOAD     ( ( tlsfROUND_UP( sizeof( TLSFBlock_t ) ) > ( tlsfHEADER_SIZE + tlsfALIGNMENT ) ) ? ( tlsfROUND_UP( sizeof( TLSFBlock_t ) ) - tlsfHEADER_SIZE ) : tlsfALIGNMENT )
+
+/* The largest payload a block can have, and the largest request that can be
+ * rounded up to a list boundary without going past it. */
+#define tlsfMAXIMUM_PAYLOAD     ( ( ( size_t ) 2 << configTLSF_FL_INDEX_MAX ) - tlsfALIGNMENT )
+#define tlsfMAXIMUM_REQUEST     ( ( ( size_t ) 2 << configTLSF_FL_INDEX_MAX ) - ( ( size_t ) 1 << ( configTLSF_FL_INDEX_MAX - tlsfSL_INDEX_COUNT_LOG2 ) ) )
+
+#define tlsfBLOCK_SIZE( pxBlock )         ( ( pxBlock )->xSize & tlsfSIZE_MASK )
+#define tlsfBLOCK_IS_FREE( pxBlock )      ( ( ( pxBlock )->xSize & tlsfBLOCK_FREE ) != ( size_t ) 0 )
+#define tlsfBLOCK_TO_PAYLOAD( pxBlock )   ( ( void * ) ( ( ( uint8_t * ) ( pxBlock ) ) + tlsfHEADER_SIZE ) )
+#define tlsfPAYLOAD_TO_BLOCK( pv )        ( ( TLSFBlock_t * ) ( ( ( uint8_t * ) ( pv ) ) - tlsfHEADER_SIZE ) )
+#define tlsfNEXT_BLOCK( pxBlock )         ( ( TLSFBlock_t * ) ( ( ( uint8_t * ) ( pxBlock ) ) + tlsfHEADER_SIZE + tlsfBLOCK_SIZE( pxBlock ) ) )
+
+/* Bit scans of a non-zero 32-bit value. */
+#if defined( __GNUC__ )
+    #define tlsfFIND_FIRST_SET( ulValue )    ( ( UBaseType_t ) __builtin_ctzl( ( unsigned long ) ( ulValue ) ) )
+    #define tlsfFIND_LAST_SET( ulValue )     ( ( UBaseType_t ) ( ( ( sizeof( unsigned long ) * 8U ) - 1U ) - ( size_t ) __builtin_clzl( ( unsigned long ) ( ulValue ) ) ) )
+#else
+    #define tlsfFIND_FIRST_SET( ulValue )    prvFindFirstSet( ulValue )
+    #define tlsfFIND_LAST_SET( ulValue )     prvFindLastSet( ulValue )
+#endif
+
+/*-----------------------------------------------------------*/
+
+typedef struct TLSFBlock
+{
+    struct TLSFBlock * pxPreviousPhysical; /* The block before this one in memory, or NULL for the first block. */
+    size_t xSize;                          /* The payload size, with tlsfBLOCK_FREE in bit 0. */
+
+    /* Only valid while the block is free, in which case they overlay the
+     * start of the payload. */
+    struct TLSFBlock * pxNextFree;
+    struct TLSFBlock * pxPreviousFree;
+} TLSFBlock_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The indexes of the list that holds free blocks of xSize bytes.
+ */
+static void prvMapping( size_t xSize,
+                        UBaseType_t * puxFirstLevel,
+                        UBaseType_t * puxSecondLevel );
+
+/*
+ * Find a list holding blocks of at least xSize bytes, and return the block at
+ * its head, or NULL if there is no such list.  The indexes of the list are
+ * returned so the block can be removed from it.
+ */
+static TLSFBlock_t * prvFindSuitableBlock( const TLSFHeap_t * pxHeap,
+                                           size_t xSize,
+                                           UBaseType_t * puxFirstLevel,
+                                           UBaseType_t * puxSecondLevel );
+
+/*
+ * Add a block to, and remove a block from, the list for its size.
+ */
+static void prvInsertFreeBlock( TLSFHeap_t * pxHeap,
+                                TLSFBlock_t * pxBlock );
+static void prvRemoveFreeBlock( TLSFHeap_t * pxHeap,
+                                TLSFBlock_t * pxBlock,
+                                UBaseType_t uxFirstLevel,
+                                UBaseType_t uxSecondLevel );
+
+/*
+ * Leave xSize bytes in pxBlock and return the rest, if it is big enough to be
+ * a block of its own, to the free lists.
+ */
+static void prvSplitBlock( TLSFHeap_t * pxHeap,
+                           TLSFBlock_t * pxBlock,
+                           size_t xSize );
+
+#if !defined( __GNUC__ )
+    static UBaseType_t prvFindFirstSet( uint32_t ulValue );
+    static UBaseType_t prvFindLastSet( uint32_t ulValue );
+#endif
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xTLSFHeapInitialise( TLSFHeap_t * const pxHeap,
+                                void * pvRegion,
+                                size_t xRegionSize )
+{
+    BaseType_t xReturn = pdFAIL;
+    size_t xAddress, xPayload;
+    TLSFBlock_t * pxBlock;
+
+    configASSERT( pxHeap );
+    configASSERT( pvRegion );
+
+    memset( pxHeap, 0x00, sizeof( TLSFHeap_t ) );
+
+    /* Align the start of the region, then leave room for the first block's
+     * header and for the end marker's header. */
+    xAddress = ( size_t ) pvRegion;
+    xAddress = tlsfROUND_UP( xAddress );
+
+    if( ( xAddress - ( size_t ) pvRegion ) < xRegionSize )
+    {
+        xPayload = ( xRegionSize - ( xAddress - ( size_t ) pvRegion ) ) & tlsfSIZE_MASK;
+
+        if( xPayload >= ( ( 2U * tlsfHEADER_SIZE ) + tlsfMINIMUM_PAYLOAD ) )
+        {
+            xPayload -= 2U * tlsfHEADER_SIZE;
+
+            /* Memory past the largest block the lists can index is not used. */
+            if( xPayload > tlsfMAXIMUM_PAYLOAD )
+            {
+                xPayload = tlsfMAXIMUM_PAYLOAD;
+            }
+
+            pxBlock = ( TLSFBlock_t * ) xAddress;
+            pxBlock->pxPreviousPhysical = NULL;
+            pxBlock->xSize = xPayload | tlsfBLOCK_FREE;
+            pxHeap->pxFirstBlock = pxBlock;
+
+            pxHeap->pxLastBlock = tlsfNEXT_BLOCK( pxBlock );
+            pxHeap->pxLastBlock->pxPreviousPhysical = pxBlock;
+            pxHeap->pxLastBlock->xSize = 0;
+
+            prvInsertFreeBlock( pxHeap, pxBlock );
+
+            pxHeap->xFreeBytesRemaining = tlsfHEADER_SIZE + xPayload;
+            pxHeap->xMinimumEverFreeBytesRemaining = pxHeap->xFreeBytesRemaining;
+            xReturn = pdPASS;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void * pvTLSFHeapMalloc( TLSFHeap_t * const pxHeap,
+                         size_t xWantedSize )
+{
+    void * pvReturn = NULL;
+    TLSFBlock_t * pxBlock;
+    UBaseType_t uxFirstLevel, uxSecondLevel;
+    size_t xSize;
+
+    configASSERT( pxHeap );
+
+    if( ( xWantedSize > ( size_t ) 0 ) && ( xWantedSize <= tlsfMAXIMUM_REQUEST ) )
+    {
+        xSize = tlsfROUND_UP( xWantedSize );
+
+        if( xSize < tlsfMINIMUM_PAYLOAD )
+        {
+            xSize = tlsfMINIMUM_PAYLOAD;
+        }
+
+        pxBlock = prvFindSuitableBlock( pxHeap, xSize, &uxFirstLevel, &uxSecondLevel );
+
+        if( pxBlock != NULL )
+        {
+            prvRemoveFreeBlock( pxHeap, pxBlock, uxFirstLevel, uxSecondLevel );
+            prvSplitBlock( pxHeap, pxBlock, xSize );
+            pxBlock->xSize &= ~tlsfBLOCK_FREE;
+
+            pxHeap->xFreeBytesRemaining -= tlsfHEADER_SIZE + tlsfBLOCK_SIZE( pxBlock );
+
+            if( pxHeap->xFreeBytesRemaining < pxHeap->xMinimumEverFreeBytesRemaining )
+            {
+                pxHeap->xMinimumEverFreeBytesRemaining = pxHeap->xFreeBytesRemaining;
+            }
+
+            pxHeap->xNumberOfSuccessfulAllocations++;
+            pvReturn = tlsfBLOCK_TO_PAYLOAD( pxBlock );
+        }
+    }
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vTLSFHeapFree( TLSFHeap_t * const pxHeap,
+                    void * pv )
+{
+    TLSFBlock_t * pxBlock;
+    TLSFBlock_t * pxNeighbour;
+    UBaseType_t uxFirstLevel, uxSecondLevel;
+
+    configASSERT( pxHeap );
+
+    if( pv != NULL )
+    {
+        pxBlock = tlsfPAYLOAD_TO_BLOCK( pv );
+
+        /* The block must belong to this heap and must not already be free. */
+        configASSERT( ( pxBlock >= pxHeap->pxFirstBlock ) && ( pxBlock < pxHeap->pxLastBlock ) );
+        configASSERT( !tlsfBLOCK_IS_FREE( pxBlock ) );
+
+        pxHeap->xFreeBytesRemaining += tlsfHEADER_SIZE + tlsfBLOCK_SIZE( pxBlock );
+        pxHeap->xNumberOfSuccessfulFrees++;
+        pxBlock->xSize |= tlsfBLOCK_FREE;
+
+        /* Merge with the block before, if it is free. */
+        pxNeighbour = pxBlock->pxPreviousPhysical;
+
+        if( ( pxNeighbour != NULL ) && tlsfBLOCK_IS_FREE( pxNeighbour ) )
+        {
+            prvMapping( tlsfBLOCK_SIZE( pxNeighbour ), &uxFirstLevel, &uxSecondLevel );
+            prvRemoveFreeBlock( pxHeap, pxNeighbour, uxFirstLevel, uxSecondLevel );
+            pxNeighbour->xSize += tlsfHEADER_SIZE + tlsfBLOCK_SIZE( pxBlock );
+            pxBlock = pxNeighbour;
+            tlsfNEXT_BLOCK( pxBlock )->pxPreviousPhysical = pxBlock;
+        }
+
+        /* Merge with the block after, if it is free.  The end marker is
+         * never free. */
+        pxNeighbour = tlsfNEXT_BLOCK( pxBlock );
+
+        if( tlsfBLOCK_IS_FREE( pxNeighbour ) )
+        {
+            prvMapping( tlsfBLOCK_SIZE( pxNeighbour ), &uxFirstLevel, &uxSecondLevel );
+            prvRemoveFreeBlock( pxHeap, pxNeighbour, uxFirstLevel, uxSecondLevel );
+            pxBlock->xSize += tlsfHEADER_SIZE + tlsfBLOCK_SIZE( pxNeighbour );
+            tlsfNEXT_BLOCK( pxBlock )->pxPreviousPhysical = pxBlock;
+        }
+
+        prvInsertFreeBlock( pxHeap, pxBlock );
+    }
+}
+/*-----------------------------------------------------------*/
+
+size_t xTLSFHeapGetFreeSize( const TLSFHeap_t * const pxHeap )
+{
+    configASSERT( pxHeap );
+
+    return pxHeap->xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xTLSFHeapGetMinimumEverFreeSize( const TLSFHeap_t * const pxHeap )
+{
+    configASSERT( pxHeap );
+
+    return pxHeap->xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xTLSFHeapGetLargestFreeBlockSize( const TLSFHeap_t * const pxHeap )
+{
+    size_t xLargest = 0;
+    UBaseType_t uxFirstLevel, uxSecondLevel;
+    const TLSFBlock_t * pxBlock;
+
+    configASSERT( pxHeap );
+
+    if( pxHeap->ulFirstLevelMap != 0U )
+    {
+        uxFirstLevel = tlsfFIND_LAST_SET( pxHeap->ulFirstLevelMap );
+        uxSecondLevel = tlsfFIND_LAST_SET( pxHeap->ulSecondLevelMap[ uxFirstLevel ] );
+
+        for( pxBlock = pxHeap->pxFreeLists[ uxFirstLevel ][ uxSecondLevel ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+        {
+            if( tlsfBLOCK_SIZE( pxBlock ) > xLargest )
+            {
+                xLargest = tlsfBLOCK_SIZE( pxBlock );
+            }
+        }
+
+        xLargest += tlsfHEADER_SIZE;
+    }
+
+    return xLargest;
+}
+/*-----------------------------------------------------------*/
+
+void vTLSFHeapGetHeapStats( const TLSFHeap_t * const pxHeap,
+                            HeapStats_t * pxHeapStats )
+{
+    const TLSFBlock_t * pxBlock;
+    size_t xBlockSize, xLargest = 0, xSmallest = ( size_t ) -1, xBlocks = 0;
+
+    configASSERT( pxHeap );
+    configASSERT( pxHeapStats );
+
+    for( pxBlock = pxHeap->pxFirstBlock; pxBlock != pxHeap->pxLastBlock; pxBlock = tlsfNEXT_BLOCK( pxBlock ) )
+    {
+        if( tlsfBLOCK_IS_FREE( pxBlock ) )
+        {
+            xBlockSize = tlsfHEADER_SIZE + tlsfBLOCK_SIZE( pxBlock );
+            xBlocks++;
+
+            if( xBlockSize > xLargest )
+            {
+                xLargest = xBlockSize;
+            }
+
+            if( xBlockSize < xSmallest )
+            {
+                xSmallest = xBlockSize;
+            }
+        }
+    }
+
+    if( xBlocks == 0U )
+    {
+        xSmallest = 0;
+    }
+
+    pxHeapStats->xAvailableHeapSpaceInBytes = pxHeap->xFreeBytesRemaining;
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = xLargest;
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xSmallest;
+    pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+    pxHeapStats->xMinimumEverFreeBytesRemaining = pxHeap->xMinimumEverFreeBytesRemaining;
+    pxHeapStats->xNumberOfSuccessfulAllocations = pxHeap->xNumberOfSuccessfulAllocations;
+    pxHeapStats->xNumberOfSuccessfulFrees = pxHeap->xNumberOfSuccessfulFrees;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMapping( size_t xSize,
+                        UBaseType_t * puxFirstLevel,
+                        UBaseType_t * puxSecondLevel )
+{
+    UBaseType_t uxMostSignificantBit;
+
+    if( xSize < tlsfSMALL_BLOCK_SIZE )
+    {
+        *puxFirstLevel = 0;
+        *puxSecondLevel = ( UBaseType_t ) ( xSize >> tlsfALIGNMENT_LOG2 );
+    }
+    else
+    {
+        uxMostSignificantBit = tlsfFIND_LAST_SET( ( uint32_t ) xSize );
+        *puxSecondLevel = ( UBaseType_t ) ( ( xSize >> ( uxMostSignificantBit - tlsfSL_INDEX_COUNT_LOG2 ) ) ^ tlsfSL_INDEX_COUNT );
+        *puxFirstLevel = uxMostSignificantBit - ( tlsfFL_INDEX_SHIFT - 1U );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static TLSFBlock_t * prvFindSuitableBlock( const TLSFHeap_t * pxHeap,
+                                           size_t xSize,
+                                           UBaseType_t * puxFirstLevel,
+                                           UBaseType_t * puxSecondLevel )
+{
+    TLSFBlock_t * pxBlock = NULL;
+    UBaseType_t uxFirstLevel, uxSecondLevel;
+    uint32_t ulMap;
+
+    /* Round up to the next list boundary so every block in the list found is
+     * at least xSize bytes. */
+    if( xSize >= tlsfSMALL_BLOCK_SIZE )
+    {
+        xSize += ( ( size_t ) 1 << ( tlsfFIND_LAST_SET( ( uint32_t ) xSize ) - tlsfSL_INDEX_COUNT_LOG2 ) ) - 1U;
+    }
+
+    prvMapping( xSize, &uxFirstLevel, &uxSecondLevel );
+
+    /* First a list in the same first level range, then the smallest list in
+     * a higher range. */
+    ulMap = pxHeap->ulSecondLevelMap[ uxFirstLevel ] & ( ~0UL << uxSecondLevel );
+
+    if( ulMap == 0U )
+    {
+        ulMap = pxHeap->ulFirstLevelMap & ( ~0UL << ( uxFirstLevel + 1U ) );
+
+        if( ulMap != 0U )
+        {
+            uxFirstLevel = tlsfFIND_FIRST_SET( ulMap );
+            ulMap = pxHeap->ulSecondLevelMap[ uxFirstLevel ];
+        }
+    }
+
+    if( ulMap != 0U )
+    {
+        uxSecondLevel = tlsfFIND_FIRST_SET( ulMap );
+        pxBlock = pxHeap->pxFreeLists[ uxFirstLevel ][ uxSecondLevel ];
+        *puxFirstLevel = uxFirstLevel;
+        *puxSecondLevel = uxSecondLevel;
+    }
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( TLSFHeap_t * pxHeap,
+                                TLSFBlock_t * pxBlock )
+{
+    UBaseType_t uxFirstLevel, uxSecondLevel;
+    TLSFBlock_t * pxHead;
+
+    prvMapping( tlsfBLOCK_SIZE( pxBlock ), &uxFirstLevel, &uxSecondLevel );
+
+    pxHead = pxHeap->pxFreeLists[ uxFirstLevel ][ uxSecondLevel ];
+    pxBlock->pxNextFree = pxHead;
+    pxBlock->pxPreviousFree = NULL;
+
+    if( pxHead != NULL )
+    {
+        pxHead->pxPreviousFree = pxBlock;
+    }
+
+    pxHeap->pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] = pxBlock;
+    pxHeap->ulFirstLevelMap |= 1UL << uxFirstLevel;
+    pxHeap->ulSecondLevelMap[ uxFirstLevel ] |= 1UL << uxSecondLevel;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( TLSFHeap_t * pxHeap,
+                                TLSFBlock_t * pxBlock,
+                                UBaseType_t uxFirstLevel,
+                                UBaseType_t uxSecondLevel )
+{
+    if( pxBlock->pxNextFree != NULL )
+    {
+        pxBlock->pxNextFree->pxPreviousFree = pxBlock->pxPreviousFree;
+    }
+
+    if( pxBlock->pxPreviousFree != NULL )
+    {
+        pxBlock->pxPreviousFree->pxNextFree = pxBlock->pxNextFree;
+    }
+    else
+    {
+        /* The block was at the head of its list. */
+        pxHeap->pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] = pxBlock->pxNextFree;
+
+        if( pxBlock->pxNextFree == NULL )
+        {
+            pxHeap->ulSecondLevelMap[ uxFirstLevel ] &= ~( 1UL << uxSecondLevel );
+
+            if( pxHeap->ulSecondLevelMap[ uxFirstLevel ] == 0U )
+            {
+                pxHeap->ulFirstLevelMap &= ~( 1UL << uxFirstLevel );
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSplitBlock( TLSFHeap_t * pxHeap,
+                           TLSFBlock_t * pxBlock,
+                           size_t xSize )
+{
+    TLSFBlock_t * pxRemainder;
+    size_t xBlockSize = tlsfBLOCK_SIZE( pxBlock );
+
+    if( ( xBlockSize - xSize ) >= ( tlsfHEADER_SIZE + tlsfMINIMUM_PAYLOAD ) )
+    {
+        pxBlock->xSize = xSize | ( pxBlock->xSize & tlsfBLOCK_FREE );
+
+        pxRemainder = tlsfNEXT_BLOCK( pxBlock );
+        pxRemainder->pxPreviousPhysical = pxBlock;
+        pxRemainder->xSize = ( xBlockSize - xSize - tlsfHEADER_SIZE ) | tlsfBLOCK_FREE;
+        tlsfNEXT_BLOCK( pxRemainder )->pxPreviousPhysical = pxRemainder;
+
+        prvInsertFreeBlock( pxHeap, pxRemainder );
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if !defined( __GNUC__ )
+
+    static UBaseType_t prvFindFirstSet( uint32_t ulValue )
+    {
+        UBaseType_t uxBit = 0;
+
+        while( ( ulValue & 1UL ) == 0U )
+        {
+            ulValue >>= 1;
+            uxBit++;
+        }
+
+        return uxBit;
+    }
+/*-----------------------------------------------------------*/
+
+    static UBaseType_t prvFindLastSet( uint32_t ulValue )
+    {
+        UBaseType_t uxBit = 0;
+
+        while( ulValue > 1UL )
+        {
+            ulValue >>= 1;
+            uxBit++;
+        }
+
+        return uxBit;
+    }
+
+#endif /* if !defined( __GNUC__ ) */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TLSF_HEAP == 1 )
+
+    #if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+        #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+    #endif
+
+    /* The memory pvPortMalloc() allocates from. */
+    #if ( configAPPLICATION_ALLOCATED_HEAP == 1 )
+        extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+    #else
+        PRIVILEGED_DATA static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+    #endif
+
+    PRIVILEGED_DATA static TLSFHeap_t xHeap;
+    PRIVILEGED_DATA static BaseType_t xHeapInitialised = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+    void * pvPortMalloc( size_t xWantedSize )
+    {
+        void * pvReturn;
+
+        vTaskSuspendAll();
+        {
+            if( xHeapInitialised == pdFALSE )
+            {
+                xHeapInitialised = xTLSFHeapInitialise( &xHeap, ucHeap, configTOTAL_HEAP_SIZE );
+                configASSERT( xHeapInitialised == pdPASS );
+            }
+
+            pvReturn = pvTLSFHeapMalloc( &xHeap, xWantedSize );
+            traceMALLOC( pvReturn, xWantedSize );
+        }
+        ( void ) xTaskResumeAll();
+
+        #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+            {
+                if( pvReturn == NULL )
+                {
+                    extern void vApplicationMallocFailedHook( void );
+                    vApplicationMallocFailedHook();
+                }
+            }
+        #endif
+
+        configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+
+        return pvReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortFree( void * pv )
+    {
+        if( pv != NULL )
+        {
+            vTaskSuspendAll();
+            {
+                traceFREE( pv, tlsfBLOCK_SIZE( tlsfPAYLOAD_TO_BLOCK( pv ) ) );
+                vTLSFHeapFree( &xHeap, pv );
+            }
+            ( void ) xTaskResumeAll();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void * pvPortCalloc( size_t xNum,
+                         size_t xSize )
+    {
+        void * pv = NULL;
+
+        if( ( xSize == 0U ) || ( xNum <= ( ( ( size_t ) -1 ) / xSize ) ) )
+        {
+            pv = pvPortMalloc( xNum * xSize );
+
+            if( pv != NULL )
+            {
+                memset( pv, 0, xNum * xSize );
+            }
+        }
+
+        return pv;
+    }
+/*-----------------------------------------------------------*/
+
+    size_t xPortGetFreeHeapSize( void )
+    {
+        return xHeap.xFreeBytesRemaining;
+    }
+/*-----------------------------------------------------------*/
+
+    size_t xPortGetMinimumEverFreeHeapSize( void )
+    {
+        return xHeap.xMinimumEverFreeBytesRemaining;
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortInitialiseBlocks( void )
+    {
+        /* This just exists to keep the linker quiet. */
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortGetHeapStats( HeapStats_t * pxHeapStats )
+    {
+        vTaskSuspendAll();
+        {
+            if( xHeapInitialised == pdFALSE )
+            {
+                memset( pxHeapStats, 0x00, sizeof( HeapStats_t ) );
+            }
+            else
+            {
+                vTLSFHeapGetHeapStats( &xHeap, pxHeapStats );
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TLSF_HEAP */
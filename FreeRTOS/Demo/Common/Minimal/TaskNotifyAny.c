@@ -0,0 +1,324 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Waiting for any of a set of notification indices, and tasks that test it.
+ * See TaskNotifyAny.h for how it works.
+ *
+ * A waiting task waits for three indices.  A sender task uses one as a
+ * counting semaphore and writes an increasing number to another, and the tick
+ * hook uses the third as a counting semaphore.  Every naPARTIAL_WAIT_CYCLE
+ * cycles the waiting task waits for the tick hook's index alone, which leaves
+ * the others to be picked up by the next wait.  The waiting task checks it is
+ * only told about indices it waited for, never receives more than was sent or
+ * an older number than the last, and keeps up with the senders.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "TaskNotifyAny.h"
+
+#if ( configTASK_NOTIFICATION_ARRAY_ENTRIES < 4 )
+    #error This file needs configTASK_NOTIFICATION_ARRAY_ENTRIES to be at least 4, three indices for the demo plus one for configTASK_NOTIFY_ANY_INDEX.
+#endif
+
+/* The indices the demo uses. */
+#define naCOUNT_INDEX               0
+#define naVALUE_INDEX               1
+#define naISR_INDEX                 2
+#define naALL_INDICES               ( notifyANY_INDEX_BIT( naCOUNT_INDEX ) | notifyANY_INDEX_BIT( naVALUE_INDEX ) | notifyANY_INDEX_BIT( naISR_INDEX ) )
+
+/* The sender gives naCOUNT_INDEX naSEND_BURST times, writing naVALUE_INDEX
+ * after each, every naSEND_PERIOD.  The tick hook gives naISR_INDEX every
+ * naISR_PERIOD ticks. */
+#define naSEND_BURST                3
+#define naSEND_PERIOD               pdMS_TO_TICKS( ( TickType_t ) 5 )
+#define naISR_PERIOD                ( 5UL )
+
+/* Every naPARTIAL_WAIT_CYCLE cycles the waiting task waits for naISR_INDEX
+ * only. */
+#define naPARTIAL_WAIT_CYCLE        4
+
+/* The longest the waiting task waits before an error is latched.  The tick
+ * hook notifies it far more often than this. */
+#define naRX_BLOCK_TIME             pdMS_TO_TICKS( ( TickType_t ) 500 )
+
+/* The most gives the waiting task can be behind by when it is checked.  It
+ * normally keeps up, but allow for it being held off by higher priority
+ * tasks. */
+#define naMAX_BACKLOG               ( 100UL )
+
+#define naSENDER_PRIORITY           ( tskIDLE_PRIORITY + 1 )
+#define naWAITER_PRIORITY           ( tskIDLE_PRIORITY + 2 )
+
+/*
+ * The tasks described at the top of this file.
+ */
+static void prvWaiterTask( void * pvParameters );
+static void prvSenderTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static TaskHandle_t xWaiterTask = NULL;
+
+/* Incremented before each give or write, so a count received never exceeds
+ * the count sent. */
+static volatile uint32_t ulCountSent = 0, ulValueSent = 0, ulISRSent = 0;
+static volatile uint32_t ulCountReceived = 0, ulISRReceived = 0;
+
+/* Set to pdFAIL if an error is detected.  The cycle counter is only
+ * incremented while xTaskNotifyAnyStatus equals pdPASS. */
+static volatile BaseType_t xTaskNotifyAnyStatus = pdPASS;
+static volatile uint32_t ulWaiterCycles = 0;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xTaskNotifyAnyIndexed( TaskHandle_t xTaskToNotify,
+                                  UBaseType_t uxIndexToNotify,
+                                  uint32_t ulValue,
+                                  eNotifyAction eAction )
+{
+    BaseType_t xReturn;
+
+    configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+    configASSERT( uxIndexToNotify < 32U );
+    configASSERT( uxIndexToNotify != configTASK_NOTIFY_ANY_INDEX );
+
+    /* Update the index before ringing the doorbell, so a task woken by the
+     * doorbell finds the value. */
+    xReturn = xTaskNotifyIndexed( xTaskToNotify, uxIndexToNotify, ulValue, eAction );
+
+    if( xReturn != pdFAIL )
+    {
+        ( void ) xTaskNotifyIndexed( xTaskToNotify, configTASK_NOTIFY_ANY_INDEX, notifyANY_INDEX_BIT( uxIndexToNotify ), eSetBits );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTaskNotifyAnyIndexedFromISR( TaskHandle_t xTaskToNotify,
+                                         UBaseType_t uxIndexToNotify,
+                                         uint32_t ulValue,
+                                         eNotifyAction eAction,
+                                         BaseType_t * pxHigherPriorityTaskWoken )
+{
+    BaseType_t xReturn;
+
+    configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+    configASSERT( uxIndexToNotify < 32U );
+    configASSERT( uxIndexToNotify != configTASK_NOTIFY_ANY_INDEX );
+
+    xReturn = xTaskNotifyIndexedFromISR( xTaskToNotify, uxIndexToNotify, ulValue, eAction, pxHigherPriorityTaskWoken );
+
+    if( xReturn != pdFAIL )
+    {
+        ( void ) xTaskNotifyIndexedFromISR( xTaskToNotify, configTASK_NOTIFY_ANY_INDEX, notifyANY_INDEX_BIT( uxIndexToNotify ), eSetBits, pxHigherPriorityTaskWoken );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulTaskNotifyWaitAny( uint32_t ulIndexMask,
+                              TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+    uint32_t ulFired;
+
+    configASSERT( ulIndexMask != 0U );
+    configASSERT( ( ulIndexMask & notifyANY_INDEX_BIT( configTASK_NOTIFY_ANY_INDEX ) ) == 0U );
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ; ; )
+    {
+        /* Claim the bits waited for, leaving any others for a later wait.
+         * The value is read and cleared atomically, so a bit set at the same
+         * time is either returned now or left set. */
+        ulFired = ulTaskNotifyValueClearIndexed( NULL, configTASK_NOTIFY_ANY_INDEX, ulIndexMask ) & ulIndexMask;
+
+        if( ulFired != 0U )
+        {
+            break;
+        }
+
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            break;
+        }
+
+        /* A bit set after the value was cleared leaves a notification
+         * pending, so this does not block if one was.  The task can also be
+         * woken by a bit it is not waiting for, or by one it has already
+         * claimed, in which case it waits again for the remaining time. */
+        ( void ) xTaskNotifyWaitIndexed( configTASK_NOTIFY_ANY_INDEX, 0, 0, NULL, xTicksToWait );
+    }
+
+    return ulFired;
+}
+/*-----------------------------------------------------------*/
+
+void vStartTaskNotifyAnyTasks( void )
+{
+    xTaskCreate( prvWaiterTask, "NAWait", configMINIMAL_STACK_SIZE, NULL, naWAITER_PRIORITY, &xWaiterTask );
+    xTaskCreate( prvSenderTask, "NASend", configMINIMAL_STACK_SIZE, NULL, naSENDER_PRIORITY, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaiterTask( void * pvParameters )
+{
+    uint32_t ulMask, ulFired, ulValue, ulLastValue = 0, ulCycle = 0;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ulCycle++;
+
+        if( ( ulCycle % naPARTIAL_WAIT_CYCLE ) == 0U )
+        {
+            ulMask = notifyANY_INDEX_BIT( naISR_INDEX );
+        }
+        else
+        {
+            ulMask = naALL_INDICES;
+        }
+
+        ulFired = ulTaskNotifyWaitAny( ulMask, naRX_BLOCK_TIME );
+
+        if( ( ulFired == 0U ) || ( ( ulFired & ~ulMask ) != 0U ) )
+        {
+            xTaskNotifyAnyStatus = pdFAIL;
+        }
+
+        /* An index that fired may hold nothing new if its value was picked up
+         * along with an earlier notification. */
+        if( ( ulFired & notifyANY_INDEX_BIT( naCOUNT_INDEX ) ) != 0U )
+        {
+            ulCountReceived += ulTaskNotifyTakeIndexed( naCOUNT_INDEX, pdTRUE, 0 );
+        }
+
+        if( ( ulFired & notifyANY_INDEX_BIT( naISR_INDEX ) ) != 0U )
+        {
+            ulISRReceived += ulTaskNotifyTakeIndexed( naISR_INDEX, pdTRUE, 0 );
+        }
+
+        if( ( ulFired & notifyANY_INDEX_BIT( naVALUE_INDEX ) ) != 0U )
+        {
+            if( xTaskNotifyWaitIndexed( naVALUE_INDEX, 0, 0, &ulValue, 0 ) != pdFALSE )
+            {
+                if( ( ulValue < ulLastValue ) || ( ulValue > ulValueSent ) )
+                {
+                    xTaskNotifyAnyStatus = pdFAIL;
+                }
+
+                ulLastValue = ulValue;
+            }
+        }
+
+        if( ( ulCountReceived > ulCountSent ) || ( ulISRReceived > ulISRSent ) )
+        {
+            xTaskNotifyAnyStatus = pdFAIL;
+        }
+
+        if( xTaskNotifyAnyStatus == pdPASS )
+        {
+            ulWaiterCycles++;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSenderTask( void * pvParameters )
+{
+    UBaseType_t x;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        vTaskDelay( naSEND_PERIOD );
+
+        for( x = 0; x < naSEND_BURST; x++ )
+        {
+            ulCountSent++;
+            ( void ) xTaskNotifyAnyGiveIndexed( xWaiterTask, naCOUNT_INDEX );
+
+            ulValueSent++;
+            ( void ) xTaskNotifyAnyIndexed( xWaiterTask, naVALUE_INDEX, ulValueSent, eSetValueWithOverwrite );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vTaskNotifyAnyISRTest( void )
+{
+    static uint32_t ulCallCount = 0;
+
+    /* The tick hook can run before the waiting task is created. */
+    if( xWaiterTask != NULL )
+    {
+        ulCallCount++;
+
+        if( ( ulCallCount % naISR_PERIOD ) == 0UL )
+        {
+            /* The tick interrupt switches to the waiting task if it should, so
+             * there is no need to know whether it was woken. */
+            ulISRSent++;
+            vTaskNotifyAnyGiveIndexedFromISR( xWaiterTask, naISR_INDEX, NULL );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreTaskNotifyAnyTasksStillRunning( void )
+{
+    static uint32_t ulLastWaiterCycles = 0;
+    uint32_t ulCountReceivedNow, ulISRReceivedNow;
+
+    if( ulLastWaiterCycles == ulWaiterCycles )
+    {
+        xTaskNotifyAnyStatus = pdFAIL;
+    }
+
+    ulLastWaiterCycles = ulWaiterCycles;
+
+    /* Read what has been received before what has been sent, so neither can
+     * move on past the other in between. */
+    ulCountReceivedNow = ulCountReceived;
+    ulISRReceivedNow = ulISRReceived;
+
+    if( ( ( ulCountSent - ulCountReceivedNow ) > naMAX_BACKLOG ) || ( ( ulISRSent - ulISRReceivedNow ) > naMAX_BACKLOG ) )
+    {
+        xTaskNotifyAnyStatus = pdFAIL;
+    }
+
+    return xTaskNotifyAnyStatus;
+}
@@ -0,0 +1,568 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A pool of reusable tasks, and tasks that test it.
+ *
+ * Tasks that are repeatedly created and deleted, as in death.c and dynamic.c,
+ * pay for a TCB and stack allocation, a stack fill, and the idle task freeing
+ * the memory again, every time.  A pool creates its workers once and parks
+ * each on a task notification.  xTaskPoolRun() takes a parked worker, sets its
+ * priority and hands it the job.  When the job returns the worker drops back
+ * to the parked priority and rejoins the pool.
+ *
+ * The benchmark task repeatedly starts a higher priority job, alternately by
+ * creating a task that then deletes itself, as the suicidal tasks in death.c
+ * do, and by running it on a pooled worker.  It reads configTASK_POOL_CYCLE_COUNT()
+ * before it starts the job, the job reads it again as soon as it runs, and the
+ * benchmark task reads it once more when it runs again after the job has
+ * finished.  After tpLATENCY_SAMPLES of each the average and worst case start
+ * latency, and the average round trip, are reported once through
+ * configDEMO_REPORT().
+ *
+ * Between samples the benchmark task also occupies every worker with jobs that
+ * block, then checks the pool is empty, that xTaskPoolRun() fails, and that
+ * the workers return to the pool once their jobs finish.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "TaskPool.h"
+#include "DemoReport.h"
+
+/* Read a free running count before and after starting a job.  It need only
+ * count in the same units each time. */
+#ifndef configTASK_POOL_CYCLE_COUNT
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        #define configTASK_POOL_CYCLE_COUNT()    ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+    #else
+        /* The latency is then reported as 0, but the pool is still tested. */
+        #define configTASK_POOL_CYCLE_COUNT()    ( ( uint32_t ) 0 )
+    #endif
+#endif
+
+/* The number of workers in the demo pool, and the stack each has. */
+#define tpNUM_WORKERS           2
+#define tpSTACK_SIZE            ( configMINIMAL_STACK_SIZE )
+
+/* The number of jobs started each way before the result is reported. */
+#define tpLATENCY_SAMPLES       64
+
+/* The benchmark task starts a job every tpSAMPLE_PERIOD ticks, which leaves
+ * the idle task time to free the tasks that deleted themselves. */
+#define tpSAMPLE_PERIOD         pdMS_TO_TICKS( ( TickType_t ) 10 )
+
+/* The pool is emptied after every tpSAMPLES_PER_HOLD samples, by jobs that
+ * block for tpHOLD_TIME. */
+#define tpSAMPLES_PER_HOLD      16
+#define tpHOLD_TIME             pdMS_TO_TICKS( ( TickType_t ) 20 )
+
+/*
+ * The function each worker runs.  pvParameters is the worker's
+ * TaskPoolWorker_t.
+ */
+static void prvWorkerTask( void * pvParameters );
+
+/*
+ * Initialise a worker and, if its task was created, add it to the pool.
+ */
+static BaseType_t prvAddWorker( TaskPool_t * pxPool,
+                                TaskPoolWorker_t * pxWorker,
+                                TaskHandle_t xTask );
+
+/*
+ * The tasks and jobs described at the top of this file.
+ */
+static void prvBenchmarkTask( void * pvParameters );
+static void prvCreatedJob( void * pvParameters );
+static void prvPooledJob( void * pvParameters );
+static void prvHoldJob( void * pvParameters );
+
+/*
+ * Start one job in the way the benchmark task is measuring and return the
+ * time from starting it to it running, and from starting it to it finishing.
+ */
+static BaseType_t prvTimeJob( BaseType_t xUsePool,
+                              UBaseType_t uxJobPriority,
+                              uint32_t * pulStartLatency,
+                              uint32_t * pulRoundTrip );
+
+/*
+ * Occupy every worker, check the pool is empty, then check the workers return.
+ */
+static BaseType_t prvCheckHoldingAllWorkers( UBaseType_t uxJobPriority );
+
+/*-----------------------------------------------------------*/
+
+static TaskPool_t xDemoPool;
+static TaskPoolWorker_t xDemoWorkers[ tpNUM_WORKERS ];
+
+/* Written by the job as soon as it runs. */
+static volatile uint32_t ulJobStartTime = 0;
+static volatile BaseType_t xJobRan = pdFALSE;
+
+/* Set to pdFAIL if an error is detected.  The cycle counter is only
+ * incremented while xTaskPoolStatus equals pdPASS. */
+static volatile BaseType_t xTaskPoolStatus = pdPASS;
+static volatile uint32_t ulBenchmarkCycles = 0;
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAddWorker( TaskPool_t * pxPool,
+                                TaskPoolWorker_t * pxWorker,
+                                TaskHandle_t xTask )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    if( xTask != NULL )
+    {
+        pxWorker->xTask = xTask;
+        pxWorker->pxFunction = NULL;
+        pxWorker->pvParameters = NULL;
+        pxWorker->pxPool = pxPool;
+
+        /* The worker does not look at its structure until it is notified, so
+         * it can be added after it has been created. */
+        taskENTER_CRITICAL();
+        {
+            pxWorker->pxNextFree = pxPool->pxFreeWorkers;
+            pxPool->pxFreeWorkers = pxWorker;
+            ( pxPool->uxFreeWorkers )++;
+        }
+        taskEXIT_CRITICAL();
+
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+    BaseType_t xTaskPoolCreate( TaskPool_t * pxPool,
+                                TaskPoolWorker_t * pxWorkers,
+                                UBaseType_t uxNumberOfWorkers,
+                                const char * const pcName,
+                                const configSTACK_DEPTH_TYPE uxStackDepth,
+                                UBaseType_t uxParkedPriority )
+    {
+        TaskHandle_t xTask;
+        BaseType_t xReturn = pdPASS;
+        UBaseType_t x;
+
+        configASSERT( pxPool );
+        configASSERT( pxWorkers );
+        configASSERT( uxParkedPriority < configMAX_PRIORITIES );
+
+        pxPool->pxFreeWorkers = NULL;
+        pxPool->uxFreeWorkers = 0;
+        pxPool->uxParkedPriority = uxParkedPriority;
+
+        for( x = 0; x < uxNumberOfWorkers; x++ )
+        {
+            xTask = NULL;
+
+            if( xTaskCreate( prvWorkerTask, pcName, uxStackDepth, &( pxWorkers[ x ] ), uxParkedPriority, &xTask ) != pdPASS )
+            {
+                xTask = NULL;
+            }
+
+            if( prvAddWorker( pxPool, &( pxWorkers[ x ] ), xTask ) != pdPASS )
+            {
+                xReturn = pdFAIL;
+                break;
+            }
+        }
+
+        return xReturn;
+    }
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+    BaseType_t xTaskPoolCreateStatic( TaskPool_t * pxPool,
+                                      TaskPoolWorker_t * pxWorkers,
+                                      UBaseType_t uxNumberOfWorkers,
+                                      const char * const pcName,
+                                      const configSTACK_DEPTH_TYPE uxStackDepth,
+                                      UBaseType_t uxParkedPriority,
+                                      StackType_t * puxStackBuffer,
+                                      StaticTask_t * pxTaskBuffers )
+    {
+        TaskHandle_t xTask;
+        BaseType_t xReturn = pdPASS;
+        UBaseType_t x;
+
+        configASSERT( pxPool );
+        configASSERT( pxWorkers );
+        configASSERT( puxStackBuffer );
+        configASSERT( pxTaskBuffers );
+        configASSERT( uxParkedPriority < configMAX_PRIORITIES );
+
+        pxPool->pxFreeWorkers = NULL;
+        pxPool->uxFreeWorkers = 0;
+        pxPool->uxParkedPriority = uxParkedPriority;
+
+        for( x = 0; x < uxNumberOfWorkers; x++ )
+        {
+            xTask = xTaskCreateStatic( prvWorkerTask,
+                                       pcName,
+                                       uxStackDepth,
+                                       &( pxWorkers[ x ] ),
+                                       uxParkedPriority,
+                                       &( puxStackBuffer[ x * uxStackDepth ] ),
+                                       &( pxTaskBuffers[ x ] ) );
+
+            if( prvAddWorker( pxPool, &( pxWorkers[ x ] ), xTask ) != pdPASS )
+            {
+                xReturn = pdFAIL;
+                break;
+            }
+        }
+
+        return xReturn;
+    }
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+BaseType_t xTaskPoolRun( TaskPool_t * pxPool,
+                         TaskPoolFunction_t pxFunction,
+                         void * pvParameters,
+                         UBaseType_t uxPriority,
+                         TaskHandle_t * const pxCreatedTask )
+{
+    TaskPoolWorker_t * pxWorker;
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( pxPool );
+    configASSERT( pxFunction );
+    configASSERT( uxPriority < configMAX_PRIORITIES );
+
+    taskENTER_CRITICAL();
+    {
+        pxWorker = pxPool->pxFreeWorkers;
+
+        if( pxWorker != NULL )
+        {
+            pxPool->pxFreeWorkers = pxWorker->pxNextFree;
+            ( pxPool->uxFreeWorkers )--;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( pxWorker != NULL )
+    {
+        /* The worker belongs to this call until the job returns, and does not
+         * read the job until it is notified. */
+        pxWorker->pxFunction = pxFunction;
+        pxWorker->pvParameters = pvParameters;
+        pxWorker->pxNextFree = NULL;
+
+        if( pxCreatedTask != NULL )
+        {
+            *pxCreatedTask = pxWorker->xTask;
+        }
+
+        /* Raise the worker to the job's priority before it is unblocked, so it
+         * preempts this task straight away if it should, as a newly created
+         * task would. */
+        vTaskPrioritySet( pxWorker->xTask, uxPriority );
+        ( void ) xTaskNotifyGiveIndexed( pxWorker->xTask, configTASK_POOL_NOTIFY_INDEX );
+
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxTaskPoolGetFreeCount( const TaskPool_t * pxPool )
+{
+    configASSERT( pxPool );
+
+    return pxPool->uxFreeWorkers;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void * pvParameters )
+{
+    TaskPoolWorker_t * pxWorker = ( TaskPoolWorker_t * ) pvParameters;
+    TaskPool_t * pxPool = pxWorker->pxPool;
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTakeIndexed( configTASK_POOL_NOTIFY_INDEX, pdTRUE, portMAX_DELAY );
+
+        /* A notification sent by a previous job's code, rather than by
+         * xTaskPoolRun(), leaves the worker parked. */
+        if( pxWorker->pxFunction != NULL )
+        {
+            pxWorker->pxFunction( pxWorker->pvParameters );
+            pxWorker->pxFunction = NULL;
+
+            /* Drop back to the parked priority and rejoin the pool together,
+             * so a task that takes this worker as soon as it is back cannot
+             * have the priority it set overwritten, and the task that runs
+             * when this one drops its priority finds the worker in the pool.
+             * The switch away, if any, happens as the critical section is
+             * left. */
+            taskENTER_CRITICAL();
+            {
+                vTaskPrioritySet( NULL, pxPool->uxParkedPriority );
+                pxWorker->pxNextFree = pxPool->pxFreeWorkers;
+                pxPool->pxFreeWorkers = pxWorker;
+                ( pxPool->uxFreeWorkers )++;
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vStartTaskPoolTasks( UBaseType_t uxPriority )
+{
+    /* The jobs run above the benchmark task so it measures how long they take
+     * to start. */
+    configASSERT( ( uxPriority + 1 ) < configMAX_PRIORITIES );
+
+    if( xTaskPoolCreate( &xDemoPool, xDemoWorkers, tpNUM_WORKERS, "TPWork", tpSTACK_SIZE, tskIDLE_PRIORITY ) == pdPASS )
+    {
+        xTaskCreate( prvBenchmarkTask, "TPBench", configMINIMAL_STACK_SIZE, NULL, uxPriority, NULL );
+    }
+    else
+    {
+        xTaskPoolStatus = pdFAIL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCreatedJob( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    ulJobStartTime = configTASK_POOL_CYCLE_COUNT();
+    xJobRan = pdTRUE;
+
+    /* A created task must delete itself when it is done. */
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPooledJob( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    ulJobStartTime = configTASK_POOL_CYCLE_COUNT();
+    xJobRan = pdTRUE;
+
+    /* A pooled job just returns. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHoldJob( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    vTaskDelay( tpHOLD_TIME );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTimeJob( BaseType_t xUsePool,
+                              UBaseType_t uxJobPriority,
+                              uint32_t * pulStartLatency,
+                              uint32_t * pulRoundTrip )
+{
+    uint32_t ulStartTime;
+    BaseType_t xReturn;
+
+    xJobRan = pdFALSE;
+    ulStartTime = configTASK_POOL_CYCLE_COUNT();
+
+    if( xUsePool != pdFALSE )
+    {
+        xReturn = xTaskPoolRun( &xDemoPool, prvPooledJob, NULL, uxJobPriority, NULL );
+    }
+    else
+    {
+        xReturn = xTaskCreate( prvCreatedJob, "TPDie", tpSTACK_SIZE, NULL, uxJobPriority, NULL );
+    }
+
+    /* The job has a higher priority, so it has already run, and finished, by
+     * the time this task runs again. */
+    *pulRoundTrip = configTASK_POOL_CYCLE_COUNT() - ulStartTime;
+    *pulStartLatency = ulJobStartTime - ulStartTime;
+
+    if( xJobRan == pdFALSE )
+    {
+        xReturn = pdFAIL;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCheckHoldingAllWorkers( UBaseType_t uxJobPriority )
+{
+    BaseType_t xReturn = pdPASS;
+    UBaseType_t x;
+
+    for( x = 0; x < tpNUM_WORKERS; x++ )
+    {
+        if( xTaskPoolRun( &xDemoPool, prvHoldJob, NULL, uxJobPriority, NULL ) != pdPASS )
+        {
+            xReturn = pdFAIL;
+        }
+    }
+
+    /* Each job has run until it blocked, so every worker is busy. */
+    if( uxTaskPoolGetFreeCount( &xDemoPool ) != 0 )
+    {
+        xReturn = pdFAIL;
+    }
+
+    if( xTaskPoolRun( &xDemoPool, prvPooledJob, NULL, uxJobPriority, NULL ) != pdFAIL )
+    {
+        xReturn = pdFAIL;
+    }
+
+    vTaskDelay( tpHOLD_TIME * 2 );
+
+    if( uxTaskPoolGetFreeCount( &xDemoPool ) != tpNUM_WORKERS )
+    {
+        xReturn = pdFAIL;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    UBaseType_t uxJobPriority, uxSamples = 0;
+    uint32_t ulStartLatency, ulRoundTrip;
+    uint32_t ulCreateStartTotal = 0, ulCreateStartWorst = 0, ulCreateRoundTripTotal = 0;
+    uint32_t ulPoolStartTotal = 0, ulPoolStartWorst = 0, ulPoolRoundTripTotal = 0;
+    BaseType_t xReported = pdFALSE;
+
+    ( void ) pvParameters;
+
+    uxJobPriority = uxTaskPriorityGet( NULL ) + 1;
+
+    for( ; ; )
+    {
+        vTaskDelay( tpSAMPLE_PERIOD );
+
+        /* Create and delete a task, as death.c does. */
+        if( prvTimeJob( pdFALSE, uxJobPriority, &ulStartLatency, &ulRoundTrip ) != pdPASS )
+        {
+            xTaskPoolStatus = pdFAIL;
+        }
+        else if( xReported == pdFALSE )
+        {
+            ulCreateStartTotal += ulStartLatency;
+            ulCreateRoundTripTotal += ulRoundTrip;
+
+            if( ulStartLatency > ulCreateStartWorst )
+            {
+                ulCreateStartWorst = ulStartLatency;
+            }
+        }
+
+        vTaskDelay( tpSAMPLE_PERIOD );
+
+        /* Run the same job on a pooled worker. */
+        if( prvTimeJob( pdTRUE, uxJobPriority, &ulStartLatency, &ulRoundTrip ) != pdPASS )
+        {
+            xTaskPoolStatus = pdFAIL;
+        }
+        else if( xReported == pdFALSE )
+        {
+            ulPoolStartTotal += ulStartLatency;
+            ulPoolRoundTripTotal += ulRoundTrip;
+
+            if( ulStartLatency > ulPoolStartWorst )
+            {
+                ulPoolStartWorst = ulStartLatency;
+            }
+        }
+
+        /* The worker must be back in the pool before this task runs again. */
+        if( uxTaskPoolGetFreeCount( &xDemoPool ) != tpNUM_WORKERS )
+        {
+            xTaskPoolStatus = pdFAIL;
+        }
+
+        uxSamples++;
+
+        if( ( xReported == pdFALSE ) && ( uxSamples == tpLATENCY_SAMPLES ) )
+        {
+            configDEMO_REPORT( ( "Task create to start: average %u, worst %u, create to delete: average %u\r\n",
+                                 ( unsigned ) ( ulCreateStartTotal / tpLATENCY_SAMPLES ),
+                                 ( unsigned ) ulCreateStartWorst,
+                                 ( unsigned ) ( ulCreateRoundTripTotal / tpLATENCY_SAMPLES ) ) );
+            configDEMO_REPORT( ( "Task pool run to start: average %u, worst %u, run to return: average %u\r\n",
+                                 ( unsigned ) ( ulPoolStartTotal / tpLATENCY_SAMPLES ),
+                                 ( unsigned ) ulPoolStartWorst,
+                                 ( unsigned ) ( ulPoolRoundTripTotal / tpLATENCY_SAMPLES ) ) );
+            xReported = pdTRUE;
+        }
+
+        if( ( uxSamples % tpSAMPLES_PER_HOLD ) == 0 )
+        {
+            if( prvCheckHoldingAllWorkers( uxJobPriority ) != pdPASS )
+            {
+                xTaskPoolStatus = pdFAIL;
+            }
+        }
+
+        if( xTaskPoolStatus == pdPASS )
+        {
+            ulBenchmarkCycles++;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreTaskPoolTasksStillRunning( void )
+{
+    static uint32_t ulLastBenchmarkCycles = 0;
+
+    if( ulLastBenchmarkCycles == ulBenchmarkCycles )
+    {
+        xTaskPoolStatus = pdFAIL;
+    }
+
+    ulLastBenchmarkCycles = ulBenchmarkCycles;
+
+    return xTaskPoolStatus;
+}
@@ -0,0 +1,390 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures what tickless idle costs and saves on each port, so a port can be
+ * characterised before it is used in a low power application.  Like
+ * IPCBenchmark.c nothing is checked - the results are reported through
+ * configDEMO_REPORT().
+ *
+ * The load is a set of sparse auto-reload software timers, which is the usual
+ * shape of a low power application.  Each run starts a different set of
+ * timers, lets them run for ticklessRUN_DURATION_MS, then reports:
+ *
+ * + The number of times per second the processor woke, compared with the
+ *   configTICK_RATE_HZ wakes per second the periodic tick would cause.
+ * + The proportion of the run the processor spent asleep.
+ * + Wakes that did not lead to a timer callback, which are caused by
+ *   something other than the timers, for example a tick timer that cannot be
+ *   programmed far enough ahead.
+ * + Sleep entry time - the time from the last call of the idle hook to the
+ *   processor going to sleep, most of which is the port stopping the tick and
+ *   reprogramming the tick timer.
+ * + Wake to run latency - the time from the processor waking for a timer's
+ *   expiry to that timer's callback running, which includes the port
+ *   restarting the tick, stepping the tick count and switching to the timer
+ *   task.
+ *
+ * The application must set configUSE_TICKLESS_IDLE to 1, call
+ * vTicklessBenchmarkIdleHook() from its idle hook, and define
+ * configPRE_SLEEP_PROCESSING() and configPOST_SLEEP_PROCESSING() to call
+ * vTicklessBenchmarkPreSleep() and vTicklessBenchmarkPostSleep() respectively.
+ * The task that controls the benchmark deletes itself once all the runs are
+ * complete.
+ *
+ * Times are read with configTICKLESS_BENCHMARK_CYCLE_COUNT(), which must be
+ * defined in FreeRTOSConfig.h to read a free running counter that keeps
+ * counting while the processor is asleep.  Cycle counters such as the
+ * Cortex-M DWT counter stop in sleep on most devices, so unlike IntLatency.c
+ * there is no fallback to configIPC_BENCHMARK_CYCLE_COUNT() - normally a
+ * hardware timer is used instead.  The counter must not wrap more than once
+ * during a run.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* Demo program include files. */
+#include "TicklessBenchmark.h"
+#include "DemoReport.h"
+
+#if ( configUSE_TICKLESS_IDLE == 0 )
+    #error This file measures tickless idle so configUSE_TICKLESS_IDLE must be set to 1 in FreeRTOSConfig.h.
+#endif
+
+#if ( INCLUDE_vTaskDelete != 1 )
+    #error This file uses vTaskDelete() so INCLUDE_vTaskDelete must be set to 1 in FreeRTOSConfig.h.
+#endif
+
+#ifndef configTICKLESS_BENCHMARK_CYCLE_COUNT
+    #error Define configTICKLESS_BENCHMARK_CYCLE_COUNT() in FreeRTOSConfig.h to return a free running count that does not stop while the processor is asleep.
+#endif
+
+/* The length of each run. */
+#ifndef ticklessRUN_DURATION_MS
+    #define ticklessRUN_DURATION_MS    10000
+#endif
+
+/* The most timers used by any run. */
+#define ticklessMAX_TIMERS             4
+
+/* Time given to the timer task to process the commands that stop the timers
+ * at the end of a run. */
+#define ticklessCLEAN_UP_DELAY         pdMS_TO_TICKS( 50 )
+
+/*-----------------------------------------------------------*/
+
+/* The timer periods used by one run, in milliseconds.  Unused entries are 0. */
+typedef struct TicklessRun
+{
+    const char * pcName;
+    uint32_t ulPeriodsMs[ ticklessMAX_TIMERS ];
+} TicklessRun_t;
+
+/* The measurements collected during one run, in counts of
+ * configTICKLESS_BENCHMARK_CYCLE_COUNT(). */
+typedef struct TicklessStats
+{
+    uint32_t ulSleeps;
+    uint32_t ulIdleWakes;
+    uint32_t ulAsleep;
+    uint32_t ulEntryMin;
+    uint32_t ulEntryMax;
+    uint32_t ulEntryTotal;
+    uint32_t ulWakeSamples;
+    uint32_t ulWakeMin;
+    uint32_t ulWakeMax;
+    uint32_t ulWakeTotal;
+} TicklessStats_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task that runs each set of timers in turn and reports the results.
+ */
+static void prvTicklessBenchmarkTask( void * pvParameters );
+
+/*
+ * The callback used by every timer.  Records the wake to run latency if this
+ * is the first callback since the processor woke.
+ */
+static void prvTimerCallback( TimerHandle_t xTimer );
+
+/*
+ * Output the results of a run that lasted ulElapsed counts.
+ */
+static void prvReport( const TicklessRun_t * pxRun,
+                       uint32_t ulElapsed );
+
+/*-----------------------------------------------------------*/
+
+/* The sets of timers, from a single slow timer to several timers whose
+ * expiries rarely coincide. */
+static const TicklessRun_t xRuns[] =
+{
+    { "1000ms",           { 1000, 0,   0,    0    } },
+    { "100/250/1000ms",   { 100,  250, 1000, 0    } },
+    { "10/70/330/1000ms", { 10,   70,  330,  1000 } }
+};
+
+static TimerHandle_t xTimers[ ticklessMAX_TIMERS ] = { NULL };
+
+/* Written by the hooks and the timer callback while xMeasuring is pdTRUE, and
+ * read by the benchmark task once it is pdFALSE again. */
+static TicklessStats_t xStats;
+static volatile BaseType_t xMeasuring = pdFALSE;
+
+/* The count read by the last call of the idle hook. */
+static volatile uint32_t ulIdleHookCount = 0;
+
+/* The count read immediately before the processor last went to sleep. */
+static volatile uint32_t ulSleepCount = 0;
+
+/* The count read immediately after the processor last woke, and whether a
+ * timer callback has run since. */
+static volatile uint32_t ulWakeCount = 0;
+static volatile BaseType_t xWakePending = pdFALSE;
+
+/* Set when all the runs are complete. */
+static volatile BaseType_t xTicklessBenchmarkComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartTicklessBenchmark( UBaseType_t uxPriority )
+{
+    BaseType_t x;
+
+    for( x = 0; x < ticklessMAX_TIMERS; x++ )
+    {
+        /* The period is set by each run. */
+        xTimers[ x ] = xTimerCreate( "Tickless", 1, pdTRUE, NULL, prvTimerCallback );
+        configASSERT( xTimers[ x ] );
+    }
+
+    xTaskCreate( prvTicklessBenchmarkTask, "Tickless", configMINIMAL_STACK_SIZE * 2, NULL, uxPriority, NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsTicklessBenchmarkComplete( void )
+{
+    return xTicklessBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+void vTicklessBenchmarkIdleHook( void )
+{
+    /* The idle task calls the idle hook before it decides whether to sleep,
+     * so the last call before a sleep marks the start of sleep entry. */
+    ulIdleHookCount = configTICKLESS_BENCHMARK_CYCLE_COUNT();
+}
+/*-----------------------------------------------------------*/
+
+void vTicklessBenchmarkPreSleep( uint32_t ulExpectedIdleTime )
+{
+    uint32_t ulEntry;
+
+    ( void ) ulExpectedIdleTime;
+
+    /* Called with interrupts disabled, after the port has reprogrammed the
+     * tick timer and immediately before the processor sleeps. */
+    ulSleepCount = configTICKLESS_BENCHMARK_CYCLE_COUNT();
+
+    if( xMeasuring != pdFALSE )
+    {
+        /* A wake that did not lead to a timer callback before the processor
+         * went back to sleep was not caused by the timers. */
+        if( xWakePending != pdFALSE )
+        {
+            xStats.ulIdleWakes++;
+            xWakePending = pdFALSE;
+        }
+
+        ulEntry = ulSleepCount - ulIdleHookCount;
+
+        if( ulEntry < xStats.ulEntryMin )
+        {
+            xStats.ulEntryMin = ulEntry;
+        }
+
+        if( ulEntry > xStats.ulEntryMax )
+        {
+            xStats.ulEntryMax = ulEntry;
+        }
+
+        xStats.ulEntryTotal += ulEntry;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vTicklessBenchmarkPostSleep( uint32_t ulExpectedIdleTime )
+{
+    ( void ) ulExpectedIdleTime;
+
+    /* Called with interrupts still disabled, so the interrupt that woke the
+     * processor has not executed yet. */
+    ulWakeCount = configTICKLESS_BENCHMARK_CYCLE_COUNT();
+
+    if( xMeasuring != pdFALSE )
+    {
+        xStats.ulSleeps++;
+        xStats.ulAsleep += ulWakeCount - ulSleepCount;
+        xWakePending = pdTRUE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimerCallback( TimerHandle_t xTimer )
+{
+    uint32_t ulLatency;
+
+    ( void ) xTimer;
+
+    /* Only the first callback after a wake is measured, as any others that
+     * expire at the same time wait for it to complete. */
+    taskENTER_CRITICAL();
+    {
+        if( ( xMeasuring != pdFALSE ) && ( xWakePending != pdFALSE ) )
+        {
+            ulLatency = configTICKLESS_BENCHMARK_CYCLE_COUNT() - ulWakeCount;
+            xWakePending = pdFALSE;
+
+            if( ulLatency < xStats.ulWakeMin )
+            {
+                xStats.ulWakeMin = ulLatency;
+            }
+
+            if( ulLatency > xStats.ulWakeMax )
+            {
+                xStats.ulWakeMax = ulLatency;
+            }
+
+            xStats.ulWakeTotal += ulLatency;
+            xStats.ulWakeSamples++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvTicklessBenchmarkTask( void * pvParameters )
+{
+    const TicklessRun_t * pxRun;
+    uint32_t ulStart, ulElapsed;
+    BaseType_t xRun, x;
+
+    ( void ) pvParameters;
+
+    configDEMO_REPORT( ( "Tickless benchmark: %u runs of %ums, tick rate %uHz\r\n",
+                         ( unsigned ) ( sizeof( xRuns ) / sizeof( xRuns[ 0 ] ) ),
+                         ( unsigned ) ticklessRUN_DURATION_MS,
+                         ( unsigned ) configTICK_RATE_HZ ) );
+
+    for( xRun = 0; xRun < ( BaseType_t ) ( sizeof( xRuns ) / sizeof( xRuns[ 0 ] ) ); xRun++ )
+    {
+        pxRun = &( xRuns[ xRun ] );
+
+        memset( &xStats, 0x00, sizeof( xStats ) );
+        xStats.ulEntryMin = UINT32_MAX;
+        xStats.ulWakeMin = UINT32_MAX;
+        xWakePending = pdFALSE;
+
+        /* Changing the period of a dormant timer also starts it. */
+        for( x = 0; x < ticklessMAX_TIMERS; x++ )
+        {
+            if( pxRun->ulPeriodsMs[ x ] != 0UL )
+            {
+                xTimerChangePeriod( xTimers[ x ], pdMS_TO_TICKS( pxRun->ulPeriodsMs[ x ] ), portMAX_DELAY );
+            }
+        }
+
+        ulStart = configTICKLESS_BENCHMARK_CYCLE_COUNT();
+        xMeasuring = pdTRUE;
+
+        vTaskDelay( pdMS_TO_TICKS( ticklessRUN_DURATION_MS ) );
+
+        xMeasuring = pdFALSE;
+        ulElapsed = configTICKLESS_BENCHMARK_CYCLE_COUNT() - ulStart;
+
+        for( x = 0; x < ticklessMAX_TIMERS; x++ )
+        {
+            xTimerStop( xTimers[ x ], portMAX_DELAY );
+        }
+
+        vTaskDelay( ticklessCLEAN_UP_DELAY );
+
+        prvReport( pxRun, ulElapsed );
+    }
+
+    for( x = 0; x < ticklessMAX_TIMERS; x++ )
+    {
+        xTimerDelete( xTimers[ x ], portMAX_DELAY );
+    }
+
+    xTicklessBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const TicklessRun_t * pxRun,
+                       uint32_t ulElapsed )
+{
+    uint32_t ulWakesPerSecond, ulPercentAsleep;
+
+    ulWakesPerSecond = ( xStats.ulSleeps * 1000UL ) / ( uint32_t ) ticklessRUN_DURATION_MS;
+
+    /* Divide the elapsed time rather than multiply the time asleep so the
+     * calculation cannot overflow. */
+    ulPercentAsleep = xStats.ulAsleep / ( ( ulElapsed / 100UL ) + 1UL );
+
+    configDEMO_REPORT( ( "Tickless %s: %u wakes/s (periodic tick %u/s), %u%% asleep, %u non-timer wakes\r\n",
+                         pxRun->pcName,
+                         ( unsigned ) ulWakesPerSecond,
+                         ( unsigned ) configTICK_RATE_HZ,
+                         ( unsigned ) ulPercentAsleep,
+                         ( unsigned ) xStats.ulIdleWakes ) );
+
+    if( xStats.ulSleeps != 0UL )
+    {
+        configDEMO_REPORT( ( "    sleep entry: min %u avg %u max %u\r\n",
+                             ( unsigned ) xStats.ulEntryMin,
+                             ( unsigned ) ( xStats.ulEntryTotal / xStats.ulSleeps ),
+                             ( unsigned ) xStats.ulEntryMax ) );
+    }
+
+    if( xStats.ulWakeSamples != 0UL )
+    {
+        configDEMO_REPORT( ( "    wake to run: min %u avg %u max %u\r\n",
+                             ( unsigned ) xStats.ulWakeMin,
+                             ( unsigned ) ( xStats.ulWakeTotal / xStats.ulWakeSamples ),
+                             ( unsigned ) xStats.ulWakeMax ) );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,344 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A hierarchical timer wheel, for applications that run many more timers than
+ * the kernel's timer service is designed for, such as the retransmission and
+ * keep-alive timers of a protocol stack.
+ *
+ * The first level has one slot per tick for the next twROOT_SLOTS ticks.  Each
+ * level above has twLEVEL_SLOTS slots, each covering as many ticks as the whole
+ * level below it.  A timer is added to the lowest level that reaches its expiry
+ * time, which takes constant time, and each slot is a doubly linked list so a
+ * timer is also removed in constant time.  When the first level wraps, the next
+ * slot of the level above is emptied into the levels below it, so a timer is
+ * moved at most once per level before it expires.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+
+/* Demo includes. */
+#include "TimerWheel.h"
+
+#define twROOT_MASK    ( ( TickType_t ) ( twROOT_SLOTS - 1U ) )
+#define twLEVEL_MASK    ( ( TickType_t ) ( twLEVEL_SLOTS - 1U ) )
+
+/* The shift that gives the slot index in the top level. */
+#define twTOP_SHIFT    ( configTIMER_WHEEL_ROOT_BITS + ( configTIMER_WHEEL_LEVEL_BITS * ( configTIMER_WHEEL_LEVELS - 2 ) ) )
+
+#if ( configTIMER_WHEEL_LEVELS < 2 )
+    #error configTIMER_WHEEL_LEVELS must be at least 2.
+#endif
+
+/*
+ * Add pxTimer to the slot that is emptied at, or moved down a level before, its
+ * expiry time.
+ */
+static void prvInsertTimer( TimerWheel_t * pxWheel,
+                            WheelTimer_t * pxTimer );
+
+/*
+ * Remove pxTimer from whichever list it is in.
+ */
+static void prvRemoveTimer( WheelTimer_t * pxTimer );
+
+/*
+ * Move every timer in *ppxSlot to the level below, now that their expiry time
+ * is within its reach.
+ */
+static void prvCascadeSlot( TimerWheel_t * pxWheel,
+                            WheelTimer_t ** ppxSlot );
+
+/*
+ * Move timers down from the upper levels as required, then expire the timers
+ * in the first level slot for xTick.
+ */
+static void prvProcessTick( TimerWheel_t * pxWheel,
+                            TickType_t xTick );
+
+/*-----------------------------------------------------------*/
+
+void vTimerWheelInit( TimerWheel_t * pxWheel,
+                      TickType_t xNow )
+{
+    UBaseType_t x, y;
+
+    configASSERT( pxWheel );
+
+    /* The top level slot index must be within a tick count. */
+    configASSERT( twTOP_SHIFT < ( sizeof( TickType_t ) * 8U ) );
+
+    pxWheel->xCurrentTick = xNow;
+    pxWheel->uxActiveTimers = 0;
+
+    for( x = 0; x < twROOT_SLOTS; x++ )
+    {
+        pxWheel->pxRootSlots[ x ] = NULL;
+    }
+
+    for( y = 0; y < ( configTIMER_WHEEL_LEVELS - 1 ); y++ )
+    {
+        for( x = 0; x < twLEVEL_SLOTS; x++ )
+        {
+            pxWheel->pxLevelSlots[ y ][ x ] = NULL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vWheelTimerInit( WheelTimer_t * pxTimer,
+                      WheelTimerCallback_t pxCallback,
+                      void * pvTimerID )
+{
+    configASSERT( pxTimer );
+    configASSERT( pxCallback );
+
+    pxTimer->pxNext = NULL;
+    pxTimer->ppxPrevNext = NULL;
+    pxTimer->xExpiryTime = 0;
+    pxTimer->xPeriod = 0;
+    pxTimer->pxCallback = pxCallback;
+    pxTimer->pvTimerID = pvTimerID;
+}
+/*-----------------------------------------------------------*/
+
+void vWheelTimerStart( TimerWheel_t * pxWheel,
+                       WheelTimer_t * pxTimer,
+                       TickType_t xDelay,
+                       TickType_t xPeriod )
+{
+    configASSERT( pxWheel );
+    configASSERT( pxTimer );
+
+    /* Starting an active timer restarts it. */
+    if( pxTimer->ppxPrevNext != NULL )
+    {
+        prvRemoveTimer( pxTimer );
+        pxWheel->uxActiveTimers--;
+    }
+
+    /* The current tick has already been processed, so the soonest a timer can
+     * expire is the next tick. */
+    if( xDelay == 0 )
+    {
+        xDelay = 1;
+    }
+
+    pxTimer->xExpiryTime = pxWheel->xCurrentTick + xDelay;
+    pxTimer->xPeriod = xPeriod;
+    prvInsertTimer( pxWheel, pxTimer );
+    pxWheel->uxActiveTimers++;
+}
+/*-----------------------------------------------------------*/
+
+void vWheelTimerStop( TimerWheel_t * pxWheel,
+                      WheelTimer_t * pxTimer )
+{
+    configASSERT( pxWheel );
+    configASSERT( pxTimer );
+
+    if( pxTimer->ppxPrevNext != NULL )
+    {
+        prvRemoveTimer( pxTimer );
+        pxWheel->uxActiveTimers--;
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWheelTimerIsActive( const WheelTimer_t * pxTimer )
+{
+    configASSERT( pxTimer );
+
+    return ( pxTimer->ppxPrevNext != NULL ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void * pvWheelTimerGetID( const WheelTimer_t * pxTimer )
+{
+    configASSERT( pxTimer );
+
+    return pxTimer->pvTimerID;
+}
+/*-----------------------------------------------------------*/
+
+void vTimerWheelAdvance( TimerWheel_t * pxWheel,
+                         TickType_t xNow )
+{
+    configASSERT( pxWheel );
+
+    /* Every tick is processed in turn, as each can be the one at which an
+     * upper level slot moves down. */
+    while( pxWheel->xCurrentTick != xNow )
+    {
+        pxWheel->xCurrentTick++;
+        prvProcessTick( pxWheel, pxWheel->xCurrentTick );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertTimer( TimerWheel_t * pxWheel,
+                            WheelTimer_t * pxTimer )
+{
+    TickType_t xDelta = pxTimer->xExpiryTime - pxWheel->xCurrentTick;
+    WheelTimer_t ** ppxSlot = NULL;
+    UBaseType_t uxLevel, uxShift = configTIMER_WHEEL_ROOT_BITS;
+
+    if( xDelta < ( TickType_t ) twROOT_SLOTS )
+    {
+        /* Includes a delta of 0, for a timer moved down at the tick it
+         * expires, as that tick's first level slot has not been processed
+         * yet. */
+        ppxSlot = &( pxWheel->pxRootSlots[ pxTimer->xExpiryTime & twROOT_MASK ] );
+    }
+    else
+    {
+        for( uxLevel = 0; uxLevel < ( configTIMER_WHEEL_LEVELS - 1 ); uxLevel++ )
+        {
+            if( ( xDelta >> uxShift ) < ( TickType_t ) twLEVEL_SLOTS )
+            {
+                ppxSlot = &( pxWheel->pxLevelSlots[ uxLevel ][ ( pxTimer->xExpiryTime >> uxShift ) & twLEVEL_MASK ] );
+                break;
+            }
+
+            uxShift += configTIMER_WHEEL_LEVEL_BITS;
+        }
+
+        if( ppxSlot == NULL )
+        {
+            /* Beyond the reach of the wheel.  Use the top level slot that is
+             * moved down last, at which point the timer is filed again. */
+            ppxSlot = &( pxWheel->pxLevelSlots[ configTIMER_WHEEL_LEVELS - 2 ][ ( pxWheel->xCurrentTick >> twTOP_SHIFT ) & twLEVEL_MASK ] );
+        }
+    }
+
+    pxTimer->pxNext = *ppxSlot;
+
+    if( pxTimer->pxNext != NULL )
+    {
+        pxTimer->pxNext->ppxPrevNext = &( pxTimer->pxNext );
+    }
+
+    pxTimer->ppxPrevNext = ppxSlot;
+    *ppxSlot = pxTimer;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveTimer( WheelTimer_t * pxTimer )
+{
+    *( pxTimer->ppxPrevNext ) = pxTimer->pxNext;
+
+    if( pxTimer->pxNext != NULL )
+    {
+        pxTimer->pxNext->ppxPrevNext = pxTimer->ppxPrevNext;
+    }
+
+    pxTimer->pxNext = NULL;
+    pxTimer->ppxPrevNext = NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCascadeSlot( TimerWheel_t * pxWheel,
+                            WheelTimer_t ** ppxSlot )
+{
+    WheelTimer_t * pxList = *ppxSlot;
+    WheelTimer_t * pxTimer;
+
+    /* Take the whole list first, as a timer beyond the reach of the wheel is
+     * filed back into the slot being emptied. */
+    *ppxSlot = NULL;
+
+    if( pxList != NULL )
+    {
+        pxList->ppxPrevNext = &pxList;
+    }
+
+    while( pxList != NULL )
+    {
+        pxTimer = pxList;
+        prvRemoveTimer( pxTimer );
+        prvInsertTimer( pxWheel, pxTimer );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessTick( TimerWheel_t * pxWheel,
+                            TickType_t xTick )
+{
+    WheelTimer_t ** ppxSlot = &( pxWheel->pxRootSlots[ xTick & twROOT_MASK ] );
+    WheelTimer_t * pxExpired;
+    WheelTimer_t * pxTimer;
+    UBaseType_t uxLevel, uxShift = configTIMER_WHEEL_ROOT_BITS;
+    TickType_t xIndex;
+
+    /* Each time a level wraps, move the next slot of the level above down. */
+    if( ( xTick & twROOT_MASK ) == 0 )
+    {
+        for( uxLevel = 0; uxLevel < ( configTIMER_WHEEL_LEVELS - 1 ); uxLevel++ )
+        {
+            xIndex = ( xTick >> uxShift ) & twLEVEL_MASK;
+            prvCascadeSlot( pxWheel, &( pxWheel->pxLevelSlots[ uxLevel ][ xIndex ] ) );
+
+            if( xIndex != 0 )
+            {
+                break;
+            }
+
+            uxShift += configTIMER_WHEEL_LEVEL_BITS;
+        }
+    }
+
+    /* Take the expired timers as a list of their own, so callbacks can start
+     * and stop any timer, including ones that have not been called yet. */
+    pxExpired = *ppxSlot;
+    *ppxSlot = NULL;
+
+    if( pxExpired != NULL )
+    {
+        pxExpired->ppxPrevNext = &pxExpired;
+    }
+
+    while( pxExpired != NULL )
+    {
+        pxTimer = pxExpired;
+        prvRemoveTimer( pxTimer );
+        pxWheel->uxActiveTimers--;
+
+        configASSERT( pxTimer->xExpiryTime == xTick );
+
+        /* Reload from the expiry time, not from now, so periodic timers do
+         * not drift.  The callback can still stop or restart the timer. */
+        if( pxTimer->xPeriod != 0 )
+        {
+            pxTimer->xExpiryTime += pxTimer->xPeriod;
+            prvInsertTimer( pxWheel, pxTimer );
+            pxWheel->uxActiveTimers++;
+        }
+
+        pxTimer->pxCallback( pxTimer );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -54,6 +54,17 @@
  * transmitted so neither the Tx or Rx queue should ever hold more than a few
  * characters.
  *
+ * When comtestUSE_BLOCK_MODE is set to 1 the Tx task posts the whole sequence
+ * with one call to xSerialPutBlock(), and the Rx task checks whatever
+ * xSerialGetBlock() returns, which need not line up with the sequence.  This
+ * is for ports that transfer data by DMA, where a queue operation per
+ * character would use more CPU time than moving the data.
+ *
+ * When comtestTHROUGHPUT_TEST is set to 1 the Tx task sends the sequence back
+ * to back rather than sleeping between sends, so the port runs flat out.  In
+ * either case ulComTestGetThroughput() returns the rate at which the Rx task
+ * received data, in bytes per second.
+ *
  */
 
 /* Scheduler include files. */
@@ -91,6 +102,33 @@
 #define comBUFFER_LEN                  ( ( UBaseType_t ) ( comLAST_BYTE - comFIRST_BYTE ) + ( UBaseType_t ) 1 )
 #define comINITIAL_RX_COUNT_VALUE      ( 0 )
 
+#ifndef comtestUSE_BLOCK_MODE
+    #define comtestUSE_BLOCK_MODE      0
+#endif
+
+#ifndef comtestTHROUGHPUT_TEST
+    #define comtestTHROUGHPUT_TEST     0
+#endif
+
+#if ( comtestTHROUGHPUT_TEST == 1 )
+
+/* The Tx task blocks until there is room to send, so it never sleeps. */
+    #define comTX_BLOCK_TIME           comRX_BLOCK_TIME
+#else
+    #define comTX_BLOCK_TIME           comNO_BLOCK
+#endif
+
+#if ( comtestUSE_BLOCK_MODE == 1 )
+
+/* The port buffers a few sequences so the DMA always has data to move. */
+    #define comSERIAL_BUFFER_LEN       ( comBUFFER_LEN * ( UBaseType_t ) 4 )
+#else
+    #define comSERIAL_BUFFER_LEN       comBUFFER_LEN
+#endif
+
+/* The received data rate is calculated over this period. */
+#define comTHROUGHPUT_PERIOD           pdMS_TO_TICKS( 1000 )
+
 /* Handle to the com port used by both tasks. */
 static xComPortHandle xPort = NULL;
 
@@ -110,6 +148,16 @@ static UBaseType_t uxBaseLED = 0;
  * time the sequence is incorrect the the variable will stop being incremented. */
 static volatile UBaseType_t uxRxLoops = comINITIAL_RX_COUNT_VALUE;
 
+/* The received data rate in bytes per second, as returned by
+ * ulComTestGetThroughput(). */
+static volatile uint32_t ulRxBytesPerSecond = 0;
+
+/*
+ * Adds xBytes to the count of bytes received, updating ulRxBytesPerSecond at
+ * the end of each comTHROUGHPUT_PERIOD.
+ */
+static void prvUpdateThroughput( size_t xBytes );
+
 /*-----------------------------------------------------------*/
 
 void vAltStartComTestTasks( UBaseType_t uxPriority,
@@ -118,7 +166,7 @@ void vAltStartComTestTasks( UBaseType_t uxPriority,
 {
     /* Initialise the com port then spawn the Rx and Tx tasks. */
     uxBaseLED = uxLED;
-    xSerialPortInitMinimal( ulBaudRate, comBUFFER_LEN );
+    xSerialPortInitMinimal( ulBaudRate, comSERIAL_BUFFER_LEN );
 
     /* The Tx task is spawned with a lower priority than the Rx task. */
     xTaskCreate( vComTxTask, "COMTx", comSTACK_SIZE, NULL, uxPriority - 1, ( TaskHandle_t * ) NULL );
@@ -129,44 +177,141 @@ void vAltStartComTestTasks( UBaseType_t uxPriority,
 static portTASK_FUNCTION( vComTxTask, pvParameters )
 {
     char cByteToSend;
-    TickType_t xTimeToWait;
+
+    #if ( comtestTHROUGHPUT_TEST == 0 )
+        TickType_t xTimeToWait;
+    #endif
+
+    #if ( comtestUSE_BLOCK_MODE == 1 )
+        char cSequence[ comBUFFER_LEN ];
+
+        for( cByteToSend = comFIRST_BYTE; cByteToSend <= comLAST_BYTE; cByteToSend++ )
+        {
+            cSequence[ cByteToSend - comFIRST_BYTE ] = cByteToSend;
+        }
+    #endif
 
     /* Just to stop compiler warnings. */
     ( void ) pvParameters;
 
     for( ; ; )
     {
-        /* Simply transmit a sequence of characters from comFIRST_BYTE to
-         * comLAST_BYTE. */
-        for( cByteToSend = comFIRST_BYTE; cByteToSend <= comLAST_BYTE; cByteToSend++ )
+        #if ( comtestUSE_BLOCK_MODE == 1 )
         {
-            if( xSerialPutChar( xPort, cByteToSend, comNO_BLOCK ) == pdPASS )
+            /* Transmit the whole sequence in one go. */
+            if( xSerialPutBlock( xPort, cSequence, comBUFFER_LEN, comTX_BLOCK_TIME ) == comBUFFER_LEN )
             {
                 vParTestToggleLED( uxBaseLED + comTX_LED_OFFSET );
             }
         }
+        #else
+        {
+            /* Simply transmit a sequence of characters from comFIRST_BYTE to
+             * comLAST_BYTE. */
+            for( cByteToSend = comFIRST_BYTE; cByteToSend <= comLAST_BYTE; cByteToSend++ )
+            {
+                if( xSerialPutChar( xPort, cByteToSend, comTX_BLOCK_TIME ) == pdPASS )
+                {
+                    vParTestToggleLED( uxBaseLED + comTX_LED_OFFSET );
+                }
+            }
+        }
+        #endif /* comtestUSE_BLOCK_MODE */
 
-        /* Turn the LED off while we are not doing anything. */
-        vParTestSetLED( uxBaseLED + comTX_LED_OFFSET, pdFALSE );
+        /* When measuring throughput the next sequence is sent immediately to
+         * keep the port busy. */
+        #if ( comtestTHROUGHPUT_TEST == 0 )
+        {
+            /* Turn the LED off while we are not doing anything. */
+            vParTestSetLED( uxBaseLED + comTX_LED_OFFSET, pdFALSE );
+
+            /* We have posted all the characters in the string - wait before
+             * re-sending.  Wait a pseudo-random time as this will provide a
+             * better test. */
+            xTimeToWait = xTaskGetTickCount() + comOFFSET_TIME;
+
+            /* Make sure we don't wait too long... */
+            xTimeToWait %= comTX_MAX_BLOCK_TIME;
+
+            /* ...but we do want to wait. */
+            if( xTimeToWait < comTX_MIN_BLOCK_TIME )
+            {
+                xTimeToWait = comTX_MIN_BLOCK_TIME;
+            }
+
+            vTaskDelay( xTimeToWait );
+        }
+        #endif /* comtestTHROUGHPUT_TEST */
+    }
+} /*lint !e715 !e818 pvParameters is required for a task function even if it is not referenced. */
+/*-----------------------------------------------------------*/
+
+#if ( comtestUSE_BLOCK_MODE == 1 )
+
+static portTASK_FUNCTION( vComRxTask, pvParameters )
+{
+    char cRxBuffer[ comBUFFER_LEN ];
+    char cExpectedByte = comFIRST_BYTE;
+    size_t xReceived, x;
+    BaseType_t xResyncRequired = pdFALSE, xErrorOccurred = pdFALSE;
 
-        /* We have posted all the characters in the string - wait before
-         * re-sending.  Wait a pseudo-random time as this will provide a better
-         * test. */
-        xTimeToWait = xTaskGetTickCount() + comOFFSET_TIME;
+    /* Just to stop compiler warnings. */
+    ( void ) pvParameters;
 
-        /* Make sure we don't wait too long... */
-        xTimeToWait %= comTX_MAX_BLOCK_TIME;
+    for( ; ; )
+    {
+        /* Block until some data is available.  A burst can end anywhere in the
+         * sequence, so the expected byte carries over from one block to the
+         * next. */
+        xReceived = xSerialGetBlock( xPort, cRxBuffer, sizeof( cRxBuffer ), comRX_BLOCK_TIME );
+        prvUpdateThroughput( xReceived );
 
-        /* ...but we do want to wait. */
-        if( xTimeToWait < comTX_MIN_BLOCK_TIME )
+        for( x = 0; x < xReceived; x++ )
         {
-            xTimeToWait = comTX_MIN_BLOCK_TIME;
+            if( ( xResyncRequired == pdFALSE ) && ( cRxBuffer[ x ] == cExpectedByte ) )
+            {
+                if( cExpectedByte == comLAST_BYTE )
+                {
+                    cExpectedByte = comFIRST_BYTE;
+
+                    if( xErrorOccurred < comTOTAL_PERMISSIBLE_ERRORS )
+                    {
+                        /* Increment the count of successful loops, as in the
+                         * character by character version below. */
+                        uxRxLoops++;
+                    }
+                }
+                else
+                {
+                    cExpectedByte++;
+                }
+            }
+            else
+            {
+                if( xResyncRequired == pdFALSE )
+                {
+                    /* Out of sequence - note the error and discard data until
+                     * the sequence is about to restart. */
+                    xErrorOccurred++;
+                    xResyncRequired = pdTRUE;
+                }
+
+                if( cRxBuffer[ x ] == comLAST_BYTE )
+                {
+                    xResyncRequired = pdFALSE;
+                    cExpectedByte = comFIRST_BYTE;
+                }
+            }
         }
 
-        vTaskDelay( xTimeToWait );
+        if( xReceived > 0 )
+        {
+            vParTestToggleLED( uxBaseLED + comRX_LED_OFFSET );
+        }
     }
 } /*lint !e715 !e818 pvParameters is required for a task function even if it is not referenced. */
-/*-----------------------------------------------------------*/
+
+#else /* comtestUSE_BLOCK_MODE */
 
 static portTASK_FUNCTION( vComRxTask, pvParameters )
 {
@@ -186,6 +331,8 @@ static portTASK_FUNCTION( vComRxTask, pvParameters )
              * available. */
             if( xSerialGetChar( xPort, &cByteRxed, comRX_BLOCK_TIME ) )
             {
+                prvUpdateThroughput( 1 );
+
                 /* Was this the byte we were expecting?  If so, toggle the LED,
                 * otherwise we are out on sync and should break out of the loop
                 * until the expected character sequence is about to restart. */
@@ -212,7 +359,10 @@ static portTASK_FUNCTION( vComRxTask, pvParameters )
             while( cByteRxed != comLAST_BYTE )
             {
                 /* Block until the next char is available. */
-                xSerialGetChar( xPort, &cByteRxed, comRX_BLOCK_TIME );
+                if( xSerialGetChar( xPort, &cByteRxed, comRX_BLOCK_TIME ) )
+                {
+                    prvUpdateThroughput( 1 );
+                }
             }
 
             /* Note that an error occurred which caused us to have to resync.
@@ -239,6 +389,33 @@ static portTASK_FUNCTION( vComRxTask, pvParameters )
         }
     }
 } /*lint !e715 !e818 pvParameters is required for a task function even if it is not referenced. */
+
+#endif /* comtestUSE_BLOCK_MODE */
+/*-----------------------------------------------------------*/
+
+static void prvUpdateThroughput( size_t xBytes )
+{
+    static TickType_t xPeriodStart = 0;
+    static uint32_t ulBytesThisPeriod = 0;
+    TickType_t xElapsed;
+
+    ulBytesThisPeriod += ( uint32_t ) xBytes;
+    xElapsed = xTaskGetTickCount() - xPeriodStart;
+
+    /* Only called from the Rx task, so the statics need no protection. */
+    if( xElapsed >= comTHROUGHPUT_PERIOD )
+    {
+        ulRxBytesPerSecond = ( uint32_t ) ( ( ( uint64_t ) ulBytesThisPeriod * configTICK_RATE_HZ ) / xElapsed );
+        ulBytesThisPeriod = 0;
+        xPeriodStart += xElapsed;
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulComTestGetThroughput( void )
+{
+    return ulRxBytesPerSecond;
+}
 /*-----------------------------------------------------------*/
 
 BaseType_t xAreComTestTasksStillRunning( void )
@@ -47,6 +47,15 @@
 
 /* Demo program include files. */
 #include "flop.h"
+#include "DemoReport.h"
+
+/* Set mathINCLUDE_SWITCH_BENCHMARK to 1 to include
+ * vStartMathSwitchBenchmark(), which measures the cost of a context switch
+ * between two integer only tasks, two floating point tasks, and one of each,
+ * so the cost of saving the floating point context can be seen. */
+#ifndef mathINCLUDE_SWITCH_BENCHMARK
+    #define mathINCLUDE_SWITCH_BENCHMARK    0
+#endif
 
 #ifndef mathSTACK_SIZE
     #define mathSTACK_SIZE     configMINIMAL_STACK_SIZE
@@ -344,3 +353,220 @@ BaseType_t xAreMathsTaskStillRunning( void )
 
     return xReturn;
 }
+
+/*-----------------------------------------------------------*/
+
+#if ( mathINCLUDE_SWITCH_BENCHMARK == 1 )
+
+/* The number of times each benchmark task yields. */
+    #ifndef mathBENCHMARK_SWITCHES
+        #define mathBENCHMARK_SWITCHES    ( 1000UL )
+    #endif
+
+    #ifndef configMATH_BENCHMARK_CYCLE_COUNT
+        #if ( configGENERATE_RUN_TIME_STATS == 1 )
+            #define configMATH_BENCHMARK_CYCLE_COUNT()    ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+        #else
+            #error Define configMATH_BENCHMARK_CYCLE_COUNT() in FreeRTOSConfig.h to return a free running cycle count.
+        #endif
+    #endif
+
+/* The calculation each floating point benchmark task performs between yields,
+ * which keeps a value live in a floating point register across the switch. */
+    #define mathBENCHMARK_STEP( x )    ( ( ( x ) * 1.0001 ) + 0.5 )
+
+/* Combinations of tasks measured, each given as whether the two tasks use the
+ * FPU. */
+    static const BaseType_t xBenchmarkUsesFPU[][ 2 ] =
+    {
+        { pdFALSE, pdFALSE },
+        { pdTRUE,  pdTRUE  },
+        { pdTRUE,  pdFALSE }
+    };
+
+    static const char * const pcBenchmarkNames[] = { "int/int", "fpu/fpu", "fpu/int" };
+
+    static TaskHandle_t xBenchmarkController = NULL;
+    static UBaseType_t uxBenchmarkPriority = 0;
+    static volatile uint32_t ulBenchmarkEnd = 0;
+    static volatile BaseType_t xBenchmarkFinished = 0;
+    static volatile BaseType_t xBenchmarkErrors = 0;
+
+    static portTASK_FUNCTION_PROTO( vMathBenchmarkController, pvParameters );
+    static portTASK_FUNCTION_PROTO( vMathBenchmarkFPUTask, pvParameters );
+    static portTASK_FUNCTION_PROTO( vMathBenchmarkIntegerTask, pvParameters );
+
+/*-----------------------------------------------------------*/
+
+    void vStartMathSwitchBenchmark( UBaseType_t uxPriority )
+    {
+        /* The benchmark tasks run at uxPriority and the controller one above,
+         * so uxPriority should be above every other task in the application. */
+        uxBenchmarkPriority = uxPriority;
+        xTaskCreate( vMathBenchmarkController, "MathBench", mathSTACK_SIZE, NULL, uxPriority + 1, &xBenchmarkController );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvBenchmarkTaskDone( BaseType_t xCorrect )
+    {
+        taskENTER_CRITICAL();
+        {
+            /* The measurement ends when the first task finishes, as after that
+             * the other no longer has anything to switch to. */
+            if( xBenchmarkFinished == 0 )
+            {
+                ulBenchmarkEnd = configMATH_BENCHMARK_CYCLE_COUNT();
+            }
+
+            if( xCorrect == pdFALSE )
+            {
+                xBenchmarkErrors++;
+            }
+
+            xBenchmarkFinished++;
+
+            if( xBenchmarkFinished == 2 )
+            {
+                xTaskNotifyGive( xBenchmarkController );
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    static portTASK_FUNCTION( vMathBenchmarkFPUTask, pvParameters )
+    {
+        portDOUBLE dValue = 1.0;
+        uint32_t ulSwitch;
+        const portDOUBLE dExpected = *( ( portDOUBLE * ) pvParameters );
+
+        portTASK_USES_FLOATING_POINT();
+
+        /* Wait to be started by the controller. */
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        for( ulSwitch = 0; ulSwitch < mathBENCHMARK_SWITCHES; ulSwitch++ )
+        {
+            dValue = mathBENCHMARK_STEP( dValue );
+            taskYIELD();
+        }
+
+        /* A wrong answer means the floating point context was corrupted.  The
+         * tolerance allows for the compiler fusing the multiply and add
+         * differently here and in the controller. */
+        prvBenchmarkTaskDone( ( fabs( dValue - dExpected ) > ( dExpected * 0.001 ) ) ? pdFALSE : pdTRUE );
+        vTaskDelete( NULL );
+    }
+/*-----------------------------------------------------------*/
+
+    static portTASK_FUNCTION( vMathBenchmarkIntegerTask, pvParameters )
+    {
+        uint32_t ulValue = 1UL, ulSwitch;
+
+        /* This task never calls portTASK_USES_FLOATING_POINT() or executes a
+         * floating point instruction, so ports that track FPU use per task do
+         * not save a floating point context for it. */
+        ( void ) pvParameters;
+
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        for( ulSwitch = 0; ulSwitch < mathBENCHMARK_SWITCHES; ulSwitch++ )
+        {
+            ulValue = ( ulValue * 1103515245UL ) + 12345UL;
+            taskYIELD();
+        }
+
+        prvBenchmarkTaskDone( ( ulValue != 0UL ) ? pdTRUE : pdFALSE );
+        vTaskDelete( NULL );
+    }
+/*-----------------------------------------------------------*/
+
+    static uint32_t prvMeasureSwitch( const BaseType_t * pxUsesFPU,
+                                      portDOUBLE * pdExpected )
+    {
+        TaskHandle_t xTasks[ 2 ];
+        BaseType_t x;
+        uint32_t ulStart;
+
+        xBenchmarkFinished = 0;
+
+        for( x = 0; x < 2; x++ )
+        {
+            if( pxUsesFPU[ x ] != pdFALSE )
+            {
+                xTaskCreate( vMathBenchmarkFPUTask, "MathBFPU", mathSTACK_SIZE, ( void * ) pdExpected, uxBenchmarkPriority, &( xTasks[ x ] ) );
+            }
+            else
+            {
+                xTaskCreate( vMathBenchmarkIntegerTask, "MathBInt", mathSTACK_SIZE, NULL, uxBenchmarkPriority, &( xTasks[ x ] ) );
+            }
+        }
+
+        /* Give the tasks time to reach their wait for the start signal. */
+        vTaskDelay( 2 );
+
+        /* Both tasks become ready, but cannot run until this task blocks.
+         * From then until the first finishes they alternate on every yield. */
+        xTaskNotifyGive( xTasks[ 0 ] );
+        xTaskNotifyGive( xTasks[ 1 ] );
+        ulStart = configMATH_BENCHMARK_CYCLE_COUNT();
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        /* Let the idle task free the deleted tasks. */
+        vTaskDelay( 2 );
+
+        return ( ulBenchmarkEnd - ulStart ) / ( 2UL * mathBENCHMARK_SWITCHES );
+    }
+/*-----------------------------------------------------------*/
+
+    static portTASK_FUNCTION( vMathBenchmarkController, pvParameters )
+    {
+        portDOUBLE dExpected = 1.0;
+        uint32_t ulSwitch, ulCycles[ sizeof( xBenchmarkUsesFPU ) / sizeof( xBenchmarkUsesFPU[ 0 ] ) ];
+        BaseType_t xCase, xLazy;
+
+        ( void ) pvParameters;
+
+        /* The answer the floating point tasks should reach. */
+        portTASK_USES_FLOATING_POINT();
+
+        for( ulSwitch = 0; ulSwitch < mathBENCHMARK_SWITCHES; ulSwitch++ )
+        {
+            dExpected = mathBENCHMARK_STEP( dExpected );
+        }
+
+        /* mathBENCHMARK_SET_LAZY_STACKING() can be defined to turn lazy
+         * stacking of the FPU registers on and off, where the port supports it,
+         * for example by setting the LSPEN bit of FPCCR on Cortex-M. */
+        for( xLazy = pdTRUE; xLazy >= pdFALSE; xLazy-- )
+        {
+            #ifdef mathBENCHMARK_SET_LAZY_STACKING
+                mathBENCHMARK_SET_LAZY_STACKING( xLazy );
+            #endif
+
+            for( xCase = 0; xCase < ( BaseType_t ) ( sizeof( xBenchmarkUsesFPU ) / sizeof( xBenchmarkUsesFPU[ 0 ] ) ); xCase++ )
+            {
+                ulCycles[ xCase ] = prvMeasureSwitch( xBenchmarkUsesFPU[ xCase ], &dExpected );
+            }
+
+            configDEMO_REPORT( ( "Context switch cycles%s: %s %u, %s %u, %s %u, errors %d\r\n",
+                                 ( xLazy != pdFALSE ) ? "" : " (no lazy stacking)",
+                                 pcBenchmarkNames[ 0 ], ( unsigned ) ulCycles[ 0 ],
+                                 pcBenchmarkNames[ 1 ], ( unsigned ) ulCycles[ 1 ],
+                                 pcBenchmarkNames[ 2 ], ( unsigned ) ulCycles[ 2 ],
+                                 ( int ) xBenchmarkErrors ) );
+
+            #ifndef mathBENCHMARK_SET_LAZY_STACKING
+                /* Lazy stacking cannot be changed, so there is only one run. */
+                break;
+            #endif
+        }
+
+        #ifdef mathBENCHMARK_SET_LAZY_STACKING
+            mathBENCHMARK_SET_LAZY_STACKING( pdTRUE );
+        #endif
+
+        vTaskDelete( NULL );
+    }
+
+#endif /* mathINCLUDE_SWITCH_BENCHMARK */
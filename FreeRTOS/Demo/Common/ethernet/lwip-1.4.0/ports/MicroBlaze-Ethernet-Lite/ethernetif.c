@@ -39,10 +39,23 @@
 #include "lwip/mem.h"
 #include "lwip/pbuf.h"
 #include "lwip/sys.h"
+#include "lwip/tcpip.h"
 #include <lwip/stats.h>
 #include <lwip/snmp.h>
 #include "netif/etharp.h"
 
+/* Set to 1 when the MAC inserts the IP, UDP and TCP checksums into transmitted
+frames and drops received frames that have bad checksums.  lwIP 1.4.0 can only
+skip the software checksums for all interfaces at once, so the CHECKSUM_GEN_x
+and CHECKSUM_CHECK_x options in lwipopts.h must then be set to 0 too.  The AXI
+Ethernet Lite MAC does not compute checksums, so this must remain 0. */
+#define netifHW_CHECKSUM_OFFLOAD	0
+
+#if ( netifHW_CHECKSUM_OFFLOAD == 0 ) && ( ( CHECKSUM_GEN_IP == 0 ) || ( CHECKSUM_GEN_UDP == 0 ) || ( CHECKSUM_GEN_TCP == 0 ) || \
+										   ( CHECKSUM_CHECK_IP == 0 ) || ( CHECKSUM_CHECK_UDP == 0 ) || ( CHECKSUM_CHECK_TCP == 0 ) )
+	#error lwipopts.h disables software checksums, but the MAC does not compute them.
+#endif
+
 /* Define those to better describe your network interface. */
 #define IFNAME0 'e'
 #define IFNAME1 'l'
@@ -57,17 +70,51 @@
 
 #define netifMAX_MTU 1500
 
+/* The largest frame that can be read from or written to the Ethernet Lite
+buffers, rounded up to a whole number of words. */
+#define netifMAX_FRAME_SIZE 1520
+
+/* Received frames are read by a task rather than in the interrupt.  The task
+reads up to netifRX_BATCH_SIZE frames from the MAC at a time and passes them
+to the tcpip thread in a single message. */
+#ifndef netifRX_BATCH_SIZE
+	#define netifRX_BATCH_SIZE			( 8 )
+#endif
+
+#ifndef netifRX_TASK_PRIORITY
+	#define netifRX_TASK_PRIORITY		( configMAX_PRIORITIES - 1 )
+#endif
+
+#ifndef netifRX_TASK_STACK_SIZE
+	#define netifRX_TASK_STACK_SIZE		( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
 struct xEthernetIf
 {
 	struct eth_addr *ethaddr;
 	/* Add whatever per-interface state that is needed here. */
 };
 
+/* A batch of received frames passed to the tcpip thread in one message. */
+struct xRxBatch
+{
+	struct netif *pxNetIf;
+	BaseType_t xFrameCount;
+	struct pbuf *pxFrames[ netifRX_BATCH_SIZE ];
+};
+
 /*
  * Copy the received data into a pbuf.
  */
 static struct pbuf *prvLowLevelInput( const unsigned char * const pucInputData, unsigned short usDataLength );
 
+/*
+ * Allocate a pbuf that can hold a whole frame in one contiguous payload, so
+ * the frame can be read from the MAC directly into the pbuf.  Returns NULL if
+ * no such pbuf is available.
+ */
+static struct pbuf *prvAllocateRxPbuf( void );
+
 /*
  * Send data from a pbuf to the hardware.
  */
@@ -85,12 +132,38 @@ static void prvLowLevelInit( struct netif *pxNetIf );
 static void prvRxHandler( void *pvNetIf );
 static void prvTxHandler( void *pvUnused );
 
+/*
+ * The task that reads received frames from the MAC after prvRxHandler() has
+ * masked the MAC interrupts, and unmasks them again once the MAC is empty.
+ */
+static void prvRxTask( void *pvParameters );
+
+/*
+ * Read one frame from the MAC.  *pxFrameWasRead is set to pdFALSE if the MAC
+ * held no frame.  The returned pbuf is NULL if the frame had to be dropped.
+ */
+static struct pbuf *prvReceiveFrame( BaseType_t *pxFrameWasRead );
+
+/*
+ * Read up to netifRX_BATCH_SIZE frames from the MAC and pass them to the
+ * tcpip thread.  Returns the number of frames read.
+ */
+static BaseType_t prvReceiveBatch( struct netif *pxNetIf );
+
+/*
+ * Called in the tcpip thread to process a batch of received frames.
+ */
+static void prvInputBatch( void *pvBatch );
+
 
 /*-----------------------------------------------------------*/
 
 /* The instance of the xEmacLite IP being used in this driver. */
 static XEmacLite xEMACInstance;
 
+/* The task that reads received frames. */
+static TaskHandle_t xRxTaskHandle = NULL;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -143,6 +216,11 @@ unsigned portBASE_TYPE uxOriginalPriority;
 		/* Flush any frames already received */
 		XEmacLite_FlushReceive( &xEMACInstance );
 
+		/* Create the task that reads received frames before the interrupt
+		that wakes it is enabled. */
+		xTaskCreate( prvRxTask, "EthRx", netifRX_TASK_STACK_SIZE, ( void * ) pxNetIf, netifRX_TASK_PRIORITY, &xRxTaskHandle );
+		configASSERT( xRxTaskHandle != NULL );
+
 		/* Set Rx, Tx interrupt handlers */
 		XEmacLite_SetRecvHandler( &xEMACInstance, ( void * ) pxNetIf, prvRxHandler );
 		XEmacLite_SetSendHandler( &xEMACInstance, NULL, prvTxHandler );
@@ -192,7 +270,7 @@ static err_t prvLowLevelOutput( struct netif *pxNetIf, struct pbuf *p )
 	to the FreeRTOS coding standard. */
 
 struct pbuf *q;
-static unsigned char ucBuffer[ 1520 ] __attribute__((aligned(32)));
+static unsigned char ucBuffer[ netifMAX_FRAME_SIZE ] __attribute__((aligned(32)));
 unsigned char *pucBuffer = ucBuffer;
 unsigned char *pucChar;
 struct eth_hdr *pxHeader;
@@ -345,6 +423,26 @@ struct pbuf *p = NULL, *q;
 
 	return p;  
 }
+/*-----------------------------------------------------------*/
+
+static struct pbuf *prvAllocateRxPbuf( void )
+{
+struct pbuf *p;
+
+	/* With PBUF_POOL_BUFSIZE large enough for a whole frame this returns a
+	single pbuf.  If the pool is configured with smaller buffers the pbuf is
+	chained, cannot be passed to XEmacLite_Recv(), and is released again so
+	the caller falls back to receiving through the bounce buffer. */
+	p = pbuf_alloc( PBUF_RAW, netifMAX_FRAME_SIZE + ETH_PAD_SIZE, PBUF_POOL );
+
+	if( ( p != NULL ) && ( p->next != NULL ) )
+	{
+		pbuf_free( p );
+		p = NULL;
+	}
+
+	return p;
+}
 
 /**
  * Should be called at the beginning of the program to set up the
@@ -410,55 +508,189 @@ struct xEthernetIf *pxEthernetIf;
 
 static void prvRxHandler( void *pvNetIf )
 {
-	/* This is taken from lwIP example code and therefore does not conform
-	to the FreeRTOS coding standard. */
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-struct eth_hdr *pxHeader;
-struct pbuf *p;
-unsigned short usInputLength;
-static unsigned char ucBuffer[ 1520 ] __attribute__((aligned(32)));
-extern portBASE_TYPE xInsideISR;
-struct netif *pxNetIf = ( struct netif * ) pvNetIf;
+	( void ) pvNetIf;
 
 	XIntc_AckIntr( XPAR_ETHERNET_LITE_BASEADDR, XPAR_ETHERNET_LITE_IP2INTC_IRPT_MASK );
 
-	/* Ensure the pbuf handling functions don't attempt to use critical
-	sections. */
-	xInsideISR++;
+	/* Mask the MAC interrupts and leave the frames for prvRxTask() to read.
+	The interrupts are not unmasked until the MAC has been drained, so a flood
+	of frames cannot hold the CPU in interrupt context. */
+	XEmacLite_DisableInterrupts( &xEMACInstance );
+	vTaskNotifyGiveFromISR( xRxTaskHandle, &xHigherPriorityTaskWoken );
+	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
 
-	usInputLength = ( long ) XEmacLite_Recv( &xEMACInstance, ucBuffer );
+static void prvRxTask( void *pvParameters )
+{
+struct netif *pxNetIf = ( struct netif * ) pvParameters;
+BaseType_t xFramesReceived;
 
-	/* move received packet into a new pbuf */
-	p = prvLowLevelInput( ucBuffer, usInputLength );
+	for( ;; )
+	{
+		/* Wait for prvRxHandler() to report that frames are waiting. */
+		ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+		/* Keep polling while every pass fills a whole batch, yielding between
+		batches so equal priority tasks, including the tcpip thread, can run. */
+		do
+		{
+			xFramesReceived = prvReceiveBatch( pxNetIf );
+
+			if( xFramesReceived == netifRX_BATCH_SIZE )
+			{
+				taskYIELD();
+			}
+		} while( xFramesReceived == netifRX_BATCH_SIZE );
+
+		XEmacLite_EnableInterrupts( &xEMACInstance );
+
+		/* A frame that arrived after the last empty read but before the
+		interrupts were enabled again might not raise a new interrupt, so poll
+		once more.  If the interrupt fires as well the only cost is one extra
+		empty pass. */
+		prvReceiveBatch( pxNetIf );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static struct pbuf *prvReceiveFrame( BaseType_t *pxFrameWasRead )
+{
+struct pbuf *p;
+unsigned short usInputLength;
+static unsigned char ucBuffer[ netifMAX_FRAME_SIZE ] __attribute__((aligned(32)));
+
+	/* Read the frame straight into a pbuf if one is available, so it is only
+	copied once, out of the Ethernet Lite buffer. */
+	p = prvAllocateRxPbuf();
 
-	/* no packet could be read, silently ignore this */
 	if( p != NULL )
 	{
-		/* points to packet payload, which starts with an Ethernet header */
-		pxHeader = p->payload;
+		usInputLength = ( unsigned short ) XEmacLite_Recv( &xEMACInstance, &( ( unsigned char * ) p->payload )[ ETH_PAD_SIZE ] );
 
-		switch( htons( pxHeader->type ) )
+		if( usInputLength > 0U )
+		{
+			/* Trim the pbuf to the frame that was actually received. */
+			pbuf_realloc( p, usInputLength + ETH_PAD_SIZE );
+			LINK_STATS_INC( link.recv );
+		}
+		else
 		{
-			/* IP or ARP packet? */
-			case ETHTYPE_IP:
-			case ETHTYPE_ARP:
-								/* full packet send to tcpip_thread to process */
-								if( pxNetIf->input( p, pxNetIf ) != ERR_OK )
-								{
-									LWIP_DEBUGF(NETIF_DEBUG, ( "ethernetif_input: IP input error\n" ) );
-									pbuf_free(p);
-									p = NULL;
-								}
-								break;
-
-			default:
-								pbuf_free( p );
-								p = NULL;
+			pbuf_free( p );
+			p = NULL;
+		}
+	}
+	else
+	{
+		/* The frame must still be read to free the Ethernet Lite buffer.
+		prvLowLevelInput() drops it if no pbuf can be allocated. */
+		usInputLength = ( unsigned short ) XEmacLite_Recv( &xEMACInstance, ucBuffer );
+
+		/* move received packet into a new pbuf */
+		p = prvLowLevelInput( ucBuffer, usInputLength );
+	}
+
+	*pxFrameWasRead = ( usInputLength > 0U ) ? pdTRUE : pdFALSE;
+
+	return p;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReceiveBatch( struct netif *pxNetIf )
+{
+struct eth_hdr *pxHeader;
+struct pbuf *p;
+struct xRxBatch *pxBatch;
+struct pbuf *pxFrames[ netifRX_BATCH_SIZE ];
+BaseType_t xFramesReceived, xFramesToPass = 0, x, xFrameWasRead;
+
+	for( xFramesReceived = 0; xFramesReceived < netifRX_BATCH_SIZE; xFramesReceived++ )
+	{
+		p = prvReceiveFrame( &xFrameWasRead );
+
+		if( xFrameWasRead == pdFALSE )
+		{
+			/* The MAC is empty. */
 			break;
 		}
+
+		/* no packet could be allocated, silently drop this frame */
+		if( p != NULL )
+		{
+			/* points to packet payload, which starts with an Ethernet header */
+			pxHeader = p->payload;
+
+			switch( htons( pxHeader->type ) )
+			{
+				/* IP or ARP packet? */
+				case ETHTYPE_IP:
+				case ETHTYPE_ARP:
+									pxFrames[ xFramesToPass ] = p;
+									xFramesToPass++;
+									break;
+
+				default:
+									pbuf_free( p );
+									break;
+			}
+		}
+	}
+
+	if( xFramesToPass > 0 )
+	{
+		/* Pass the whole batch to the tcpip thread in one message rather than
+		posting each frame to its mailbox separately. */
+		pxBatch = ( struct xRxBatch * ) mem_malloc( sizeof( struct xRxBatch ) );
+
+		if( pxBatch != NULL )
+		{
+			pxBatch->pxNetIf = pxNetIf;
+			pxBatch->xFrameCount = xFramesToPass;
+			memcpy( pxBatch->pxFrames, pxFrames, xFramesToPass * sizeof( struct pbuf * ) );
+
+			if( tcpip_callback_with_block( prvInputBatch, pxBatch, 1 ) != ERR_OK )
+			{
+				for( x = 0; x < xFramesToPass; x++ )
+				{
+					pbuf_free( pxFrames[ x ] );
+				}
+
+				mem_free( pxBatch );
+			}
+		}
+		else
+		{
+			/* Fall back to passing the frames one at a time. */
+			for( x = 0; x < xFramesToPass; x++ )
+			{
+				if( pxNetIf->input( pxFrames[ x ], pxNetIf ) != ERR_OK )
+				{
+					LWIP_DEBUGF(NETIF_DEBUG, ( "ethernetif_input: IP input error\n" ) );
+					pbuf_free( pxFrames[ x ] );
+				}
+			}
+		}
+	}
+
+	return xFramesReceived;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInputBatch( void *pvBatch )
+{
+struct xRxBatch *pxBatch = ( struct xRxBatch * ) pvBatch;
+BaseType_t x;
+
+	/* Runs in the tcpip thread, so the frames can be passed straight to
+	ethernet_input(), which frees each pbuf once it has been processed. */
+	for( x = 0; x < pxBatch->xFrameCount; x++ )
+	{
+		ethernet_input( pxBatch->pxFrames[ x ], pxBatch->pxNetIf );
 	}
 
-	xInsideISR--;
+	mem_free( pxBatch );
 }
 /*-----------------------------------------------------------*/
 
@@ -0,0 +1,182 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Word at a time Internet checksum for the lwIP ports.  lwIP's own
+ * lwip_standard_chksum() adds the data 16 bits at a time.  This version adds
+ * 32-bit words into a wide accumulator, and on ARMv7-M (Cortex-M3, M4 and M7)
+ * adds four words per iteration using the carry flag, which roughly halves the
+ * time spent checksumming received TCP segments.
+ *
+ * To use it, build this file with the port and define the following in the
+ * port's arch/cc.h (the bundled ports already do):
+ *
+ * #define LWIP_CHKSUM usPortChecksum
+ */
+
+/* lwIP includes. */
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/inet_chksum.h"
+
+/* Sum of the 16-byte blocks at the start of a 32-bit aligned buffer.  Returns
+the number of bytes consumed, and adds the sum to *pulSum. */
+static int prvSumBlocks( const u32_t *pulData, int iLength, u32_t *pulSum );
+
+/*-----------------------------------------------------------*/
+
+#if defined( __GNUC__ ) && ( defined( __ARM_ARCH_7M__ ) || defined( __ARM_ARCH_7EM__ ) )
+
+	static int prvSumBlocks( const u32_t *pulData, int iLength, u32_t *pulSum )
+	{
+	u32_t ulBlocks = ( u32_t ) iLength >> 4UL;
+	u32_t ulSum = *pulSum, ulA, ulB, ulC, ulD;
+
+		if( ulBlocks != 0UL )
+		{
+			/* Add four words with a chain of add-with-carry instructions, then
+			fold the final carry back in before the loop counter changes the
+			flags. */
+			__asm volatile
+			(
+				"1:									\n"
+				"	ldr		%[a], [%[p]], #4		\n"
+				"	ldr		%[b], [%[p]], #4		\n"
+				"	ldr		%[c], [%[p]], #4		\n"
+				"	ldr		%[d], [%[p]], #4		\n"
+				"	adds	%[s], %[s], %[a]		\n"
+				"	adcs	%[s], %[s], %[b]		\n"
+				"	adcs	%[s], %[s], %[c]		\n"
+				"	adcs	%[s], %[s], %[d]		\n"
+				"	adc		%[s], %[s], #0			\n"
+				"	subs	%[n], %[n], #1			\n"
+				"	bne		1b						\n"
+				: [s] "+r" ( ulSum ), [p] "+r" ( pulData ), [n] "+r" ( ulBlocks ),
+				  [a] "=&r" ( ulA ), [b] "=&r" ( ulB ), [c] "=&r" ( ulC ), [d] "=&r" ( ulD )
+				:
+				: "cc", "memory"
+			);
+		}
+
+		*pulSum = ulSum;
+
+		return iLength & ~0x0f;
+	}
+
+#else /* ARMv7-M */
+
+	static int prvSumBlocks( const u32_t *pulData, int iLength, u32_t *pulSum )
+	{
+	int iBlocks = iLength >> 4;
+	unsigned long long ullSum = *pulSum;
+
+		/* A 64-bit accumulator cannot overflow for any buffer lwIP passes in,
+		and compilers turn the additions into add and add-with-carry pairs on
+		32-bit targets such as MicroBlaze. */
+		while( iBlocks > 0 )
+		{
+			ullSum += pulData[ 0 ];
+			ullSum += pulData[ 1 ];
+			ullSum += pulData[ 2 ];
+			ullSum += pulData[ 3 ];
+			pulData += 4;
+			iBlocks--;
+		}
+
+		/* Fold to 32 bits.  Twice, as the first fold can carry. */
+		ullSum = ( ullSum >> 32 ) + ( ullSum & 0xffffffffULL );
+		ullSum = ( ullSum >> 32 ) + ( ullSum & 0xffffffffULL );
+		*pulSum = ( u32_t ) ullSum;
+
+		return iLength & ~0x0f;
+	}
+
+#endif /* ARMv7-M */
+/*-----------------------------------------------------------*/
+
+u16_t usPortChecksum( void *pvData, int iLength )
+{
+u8_t *pucData = ( u8_t * ) pvData;
+u16_t usEnds = 0;
+u32_t ulSum = 0UL, ulWords = 0UL;
+int iOdd = ( ( mem_ptr_t ) pucData & 1 );
+int iConsumed;
+
+	/* This returns the same value as lwip_standard_chksum(): the non-inverted
+	Internet sum of the data in host order. */
+
+	/* Get aligned to 16 bits.  The byte is added in the high half, and the
+	result is swapped back at the end. */
+	if( ( iOdd != 0 ) && ( iLength > 0 ) )
+	{
+		( ( u8_t * ) &usEnds )[ 1 ] = *pucData;
+		pucData++;
+		iLength--;
+	}
+
+	/* Get aligned to 32 bits. */
+	if( ( ( ( mem_ptr_t ) pucData & 2 ) != 0 ) && ( iLength > 1 ) )
+	{
+		ulSum += *( u16_t * ) pucData;
+		pucData += 2;
+		iLength -= 2;
+	}
+
+	/* Add the bulk of the data a word at a time. */
+	iConsumed = prvSumBlocks( ( const u32_t * ) pucData, iLength, &ulWords );
+	pucData += iConsumed;
+	iLength -= iConsumed;
+
+	ulSum += FOLD_U32T( ulWords );
+
+	/* Then the remaining half words and byte. */
+	while( iLength > 1 )
+	{
+		ulSum += *( u16_t * ) pucData;
+		pucData += 2;
+		iLength -= 2;
+	}
+
+	if( iLength > 0 )
+	{
+		( ( u8_t * ) &usEnds )[ 0 ] = *pucData;
+	}
+
+	ulSum += usEnds;
+
+	/* Fold 32-bit sum to 16 bits. */
+	ulSum = FOLD_U32T( ulSum );
+	ulSum = FOLD_U32T( ulSum );
+
+	/* Swap if alignment was odd. */
+	if( iOdd != 0 )
+	{
+		ulSum = SWAP_BYTES_IN_WORD( ulSum );
+	}
+
+	return ( u16_t ) ulSum;
+}
+/*-----------------------------------------------------------*/
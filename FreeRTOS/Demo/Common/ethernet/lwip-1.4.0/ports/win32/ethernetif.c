@@ -32,6 +32,7 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "semphr.h"
 
 /* lwIP includes. */
 #include "lwip/opt.h"
@@ -42,6 +43,22 @@
 #include <lwip/stats.h>
 #include <lwip/snmp.h>
 #include "netif/etharp.h"
+#if NO_SYS == 0
+	#include "lwip/tcpip.h"
+#endif
+
+/* Set to 1 when the MAC inserts the IP, UDP and TCP checksums into transmitted
+frames and drops received frames that have bad checksums.  lwIP 1.4.0 can only
+skip the software checksums for all interfaces at once, so the CHECKSUM_GEN_x
+and CHECKSUM_CHECK_x options in lwipopts.h must then be set to 0 too.  WinPCap
+passes raw frames to and from the host adapter without computing checksums, so
+this must remain 0. */
+#define netifHW_CHECKSUM_OFFLOAD	0
+
+#if ( netifHW_CHECKSUM_OFFLOAD == 0 ) && ( ( CHECKSUM_GEN_IP == 0 ) || ( CHECKSUM_GEN_UDP == 0 ) || ( CHECKSUM_GEN_TCP == 0 ) || \
+										   ( CHECKSUM_CHECK_IP == 0 ) || ( CHECKSUM_CHECK_UDP == 0 ) || ( CHECKSUM_CHECK_TCP == 0 ) )
+	#error lwipopts.h disables software checksums, but the MAC does not compute them.
+#endif
 
 /* Define those to better describe your network interface. */
 #define IFNAME0 'w'
@@ -49,12 +66,35 @@
 
 #define netifMAX_MTU 1500
 
+/* Frames sent by lwIP are queued and handed to WinPCap in batches of up to
+netifTX_BATCH_SIZE frames, so each batch costs a single call into the driver.
+The queue is flushed when it is full, and otherwise by the interrupt simulator
+task, which lwIP wakes when it queues a frame. */
+#define netifTX_BATCH_SIZE		16
+#define netifMAX_FRAME_SIZE		1520
+#define netifTX_QUEUE_BYTES		( netifTX_BATCH_SIZE * ( netifMAX_FRAME_SIZE + sizeof( struct pcap_pkthdr ) ) )
+
+/* Up to netifRX_BATCH_SIZE received frames are read from WinPCap in one call,
+and passed into the tcpip thread with a single message. */
+#define netifRX_BATCH_SIZE		16
+
+/* How long the interrupt simulator task waits between polls when neither
+frames to send nor received frames are pending. */
+#define netifPOLL_PERIOD		( ( TickType_t ) 5 )
+
 struct xEthernetIf
 {
 	struct eth_addr *ethaddr;
 	/* Add whatever per-interface state that is needed here. */
 };
 
+/* Frames received in one poll, passed to the tcpip thread together. */
+struct xReceiveBatch
+{
+	u16_t usCount;
+	struct pbuf *pxFrames[ netifRX_BATCH_SIZE ];
+};
+
 /*
  * Place received packet in a pbuf and send a message to the tcpip task to let
  * it know new data has arrived.
@@ -71,6 +111,35 @@ static struct pbuf *prvLowLevelInput( const unsigned char * const pucInputData,
  */
 static err_t prvLowLevelOutput( struct netif *pxNetIf, struct pbuf *p );
 
+/*
+ * Add a frame to the transmit queue, sending the queue first if the frame does
+ * not fit, and afterwards if the batch is full.
+ */
+static BaseType_t prvQueueFrameForTransmission( const unsigned char * const pucFrame, u16_t usLength );
+
+/*
+ * Send all the queued frames with a single WinPCap call.  Must be called with
+ * xTransmitQueueMutex held.
+ */
+static void prvFlushTransmitQueue( void );
+
+/*
+ * Called by pcap_dispatch() for each received frame.
+ */
+static void prvFrameReceived( u_char *pucUser, const struct pcap_pkthdr *pxHeader, const u_char *pucPacketData );
+
+/*
+ * Pass the frames received during the last poll to lwIP.
+ */
+static void prvDeliverReceiveBatch( void );
+
+#if NO_SYS == 0
+	/*
+	 * Runs in the tcpip thread to input a batch of received frames.
+	 */
+	static void prvInputReceiveBatch( void *pvBatch );
+#endif
+
 /*
  * Perform any hardware and/or driver initialisation necessary.
  */
@@ -111,6 +180,18 @@ static char cErrorBuffer[ PCAP_ERRBUF_SIZE ];
 /* The network interface that was opened. */
 static struct netif *pxlwIPNetIf = NULL;
 
+/* Frames waiting to be sent, and the mutex that guards them as they are queued
+by the tcpip thread and sent by the interrupt simulator task. */
+static pcap_send_queue *pxTransmitQueue = NULL;
+static unsigned long ulQueuedFrames = 0UL;
+static SemaphoreHandle_t xTransmitQueueMutex = NULL;
+
+/* Frames received during the current poll. */
+static struct xReceiveBatch *pxReceiveBatch = NULL;
+
+/* The task that simulates the MAC interrupt. */
+static TaskHandle_t xInterruptSimulatorTask = NULL;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -181,7 +262,7 @@ static err_t prvLowLevelOutput( struct netif *pxNetIf, struct pbuf *p )
 	to the FreeRTOS coding standard. */
 
 struct pbuf *q;
-static unsigned char ucBuffer[ 1520 ];
+static unsigned char ucBuffer[ netifMAX_FRAME_SIZE ];
 unsigned char *pucBuffer = ucBuffer;
 unsigned char *pucChar;
 struct eth_hdr *pxHeader;
@@ -237,8 +318,9 @@ err_t xReturn = ERR_OK;
 
 	if( xReturn == ERR_OK )
 	{
-		/* signal that packet should be sent */
-		if( pcap_sendpacket( pxOpenedInterfaceHandle, pucBuffer, usTotalLength ) < 0 ) 
+		/* Queue the packet.  It is sent with the other packets queued before
+		the interrupt simulator task next runs, or sooner if the batch fills. */
+		if( prvQueueFrameForTransmission( pucBuffer, usTotalLength ) != pdPASS ) 
 		{
 			LINK_STATS_INC( link.memerr );
 			LINK_STATS_INC( link.drop );
@@ -353,8 +435,25 @@ struct pbuf *p;
 			/* IP or ARP packet? */
 			case ETHTYPE_IP:
 			case ETHTYPE_ARP:
-								/* full packet send to tcpip_thread to process */
-								if( pxlwIPNetIf->input( p, pxlwIPNetIf ) != ERR_OK )
+								/* Add the packet to the batch that is passed to
+								lwIP once the current poll completes. */
+								if( pxReceiveBatch == NULL )
+								{
+									pxReceiveBatch = mem_malloc( sizeof( struct xReceiveBatch ) );
+
+									if( pxReceiveBatch != NULL )
+									{
+										pxReceiveBatch->usCount = 0;
+									}
+								}
+
+								if( pxReceiveBatch != NULL )
+								{
+									LWIP_ASSERT( "pxReceiveBatch->usCount < netifRX_BATCH_SIZE", ( pxReceiveBatch->usCount < netifRX_BATCH_SIZE ) );
+									pxReceiveBatch->pxFrames[ pxReceiveBatch->usCount ] = p;
+									pxReceiveBatch->usCount++;
+								}
+								else if( pxlwIPNetIf->input( p, pxlwIPNetIf ) != ERR_OK )
 								{ 
 									LWIP_DEBUGF(NETIF_DEBUG, ( "ethernetif_input: IP input error\n" ) );
 									pbuf_free(p);
@@ -544,11 +643,140 @@ long x;
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvQueueFrameForTransmission( const unsigned char * const pucFrame, u16_t usLength )
+{
+struct pcap_pkthdr xHeader;
+BaseType_t xReturn = pdPASS;
+
+	memset( &xHeader, 0x00, sizeof( xHeader ) );
+	xHeader.caplen = usLength;
+	xHeader.len = usLength;
+
+	xSemaphoreTake( xTransmitQueueMutex, portMAX_DELAY );
+	{
+		if( pcap_sendqueue_queue( pxTransmitQueue, &xHeader, pucFrame ) != 0 )
+		{
+			/* There is no room left, so send what is already queued. */
+			prvFlushTransmitQueue();
+
+			if( pcap_sendqueue_queue( pxTransmitQueue, &xHeader, pucFrame ) != 0 )
+			{
+				xReturn = pdFAIL;
+			}
+		}
+
+		if( xReturn == pdPASS )
+		{
+			ulQueuedFrames++;
+
+			if( ulQueuedFrames >= netifTX_BATCH_SIZE )
+			{
+				prvFlushTransmitQueue();
+			}
+		}
+	}
+	xSemaphoreGive( xTransmitQueueMutex );
+
+	if( xReturn == pdPASS )
+	{
+		/* Wake the interrupt simulator task to send the frame, along with any
+		other frames queued before it gets to run. */
+		xTaskNotifyGive( xInterruptSimulatorTask );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFlushTransmitQueue( void )
+{
+	if( ulQueuedFrames != 0UL )
+	{
+		if( pcap_sendqueue_transmit( pxOpenedInterfaceHandle, pxTransmitQueue, 0 ) < pxTransmitQueue->len )
+		{
+			/* Not all of the queued frames were sent. */
+			LINK_STATS_INC( link.memerr );
+			LINK_STATS_INC( link.drop );
+			snmp_inc_ifoutdiscards( pxlwIPNetIf );
+		}
+
+		/* Empty the queue so it can be reused. */
+		pxTransmitQueue->len = 0;
+		ulQueuedFrames = 0UL;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvFrameReceived( u_char *pucUser, const struct pcap_pkthdr *pxHeader, const u_char *pucPacketData )
+{
+	( void ) pucUser;
+
+	if( pxlwIPNetIf != NULL )
+	{
+		prvEthernetInput( pucPacketData, pxHeader->caplen );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvDeliverReceiveBatch( void )
+{
+struct xReceiveBatch *pxBatch = pxReceiveBatch;
+u16_t x;
+
+	pxReceiveBatch = NULL;
+
+	if( pxBatch != NULL )
+	{
+		#if NO_SYS == 0
+		{
+			/* If lwIP would post each frame to the tcpip thread anyway then
+			post the whole batch as one message instead. */
+			if( ( pxlwIPNetIf->input == tcpip_input ) && ( tcpip_callback( prvInputReceiveBatch, pxBatch ) == ERR_OK ) )
+			{
+				pxBatch = NULL;
+			}
+		}
+		#endif
+
+		if( pxBatch != NULL )
+		{
+			for( x = 0; x < pxBatch->usCount; x++ )
+			{
+				if( pxlwIPNetIf->input( pxBatch->pxFrames[ x ], pxlwIPNetIf ) != ERR_OK )
+				{
+					LWIP_DEBUGF(NETIF_DEBUG, ( "ethernetif_input: IP input error\n" ) );
+					pbuf_free( pxBatch->pxFrames[ x ] );
+				}
+			}
+
+			mem_free( pxBatch );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if NO_SYS == 0
+
+	static void prvInputReceiveBatch( void *pvBatch )
+	{
+	struct xReceiveBatch *pxBatch = ( struct xReceiveBatch * ) pvBatch;
+	u16_t x;
+
+		/* Do for each frame what the tcpip thread does for a frame passed in
+		by tcpip_input(). */
+		for( x = 0; x < pxBatch->usCount; x++ )
+		{
+			ethernet_input( pxBatch->pxFrames[ x ], pxlwIPNetIf );
+		}
+
+		mem_free( pxBatch );
+	}
+
+#endif /* NO_SYS */
+/*-----------------------------------------------------------*/
+
 static void prvInterruptSimulator( void *pvParameters )
 {
-static struct pcap_pkthdr *pxHeader;
-const unsigned char *pucPacketData;
-extern QueueHandle_t xEMACEventQueue;
 long lResult;
 
 	/* Just to kill the compiler warning. */
@@ -556,20 +784,23 @@ long lResult;
 
 	for( ;; )
 	{
-		/* Get the next packet. */
-		lResult = pcap_next_ex( pxOpenedInterfaceHandle, &pxHeader, &pucPacketData );
-		if( lResult == 1 )
+		/* Send the frames lwIP queued since the last time around. */
+		xSemaphoreTake( xTransmitQueueMutex, portMAX_DELAY );
 		{
-			if( pxlwIPNetIf != NULL )
-			{
-				prvEthernetInput( pucPacketData, pxHeader->len );
-			}
+			prvFlushTransmitQueue();
 		}
-		else
+		xSemaphoreGive( xTransmitQueueMutex );
+
+		/* Read up to a batch of received frames with a single call, then pass
+		them to lwIP. */
+		lResult = pcap_dispatch( pxOpenedInterfaceHandle, netifRX_BATCH_SIZE, prvFrameReceived, NULL );
+		prvDeliverReceiveBatch();
+
+		if( lResult <= 0 )
 		{
-			/* There is no real way of simulating an interrupt.  
-			Make sure other tasks can run. */
-			vTaskDelay( 5 );
+			/* There is no real way of simulating an interrupt.  Make sure other
+			tasks can run, but wake early if lwIP queues a frame to send. */
+			ulTaskNotifyTake( pdTRUE, netifPOLL_PERIOD );
 		}
 	}
 }
@@ -606,9 +837,15 @@ unsigned long ulNetMask;
 		}
 	}
 
+	/* Create the queue used to send frames in batches. */
+	pxTransmitQueue = pcap_sendqueue_alloc( netifTX_QUEUE_BYTES );
+	xTransmitQueueMutex = xSemaphoreCreateMutex();
+	configASSERT( pxTransmitQueue );
+	configASSERT( xTransmitQueueMutex );
+
 	/* Create a task that simulates an interrupt in a real system.  This will
 	block waiting for packets, then send a message to the uIP task when data
 	is available. */
-	xTaskCreate( prvInterruptSimulator, "MAC_ISR", configMINIMAL_STACK_SIZE, NULL, configMAC_ISR_SIMULATOR_PRIORITY, NULL );
+	xTaskCreate( prvInterruptSimulator, "MAC_ISR", configMINIMAL_STACK_SIZE, NULL, configMAC_ISR_SIMULATOR_PRIORITY, &xInterruptSimulatorTask );
 }
 
@@ -106,4 +106,8 @@ u32_t dns_lookup_external_hosts_file(const char *name);
 
 #define LWIP_RAND() ((u32_t)rand())
 
+/* Use the word at a time checksum from ports/common/chksum.c. */
+u16_t usPortChecksum( void *pvData, int iLength );
+#define LWIP_CHKSUM usPortChecksum
+
 #endif /* __ARCH_CC_H__ */
@@ -37,15 +37,46 @@
 #include "queue.h"
 #include "semphr.h"
 
-#define SYS_MBOX_NULL					( ( QueueHandle_t ) NULL )
+/* Set to 1 to implement mailboxes as a ring of pointers protected by
+scheduler suspension, with the reading task woken by a direct to task
+notification, or 0 to implement each mailbox as a FreeRTOS queue.  The
+lightweight mailboxes support any number of posting tasks but only one task
+fetching from each mailbox at a time, which is how lwIP uses them. */
+#ifndef sysarchLIGHTWEIGHT_MBOX
+	#define sysarchLIGHTWEIGHT_MBOX			1
+#endif
+
+/* The task notification index used to wake a task blocked on a lightweight
+mailbox.  Defaults to the last index so index 0 remains free for the
+application. */
+#ifndef sysarchMBOX_NOTIFICATION_INDEX
+	#define sysarchMBOX_NOTIFICATION_INDEX	( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+#endif
+
+/* Set to 1 to implement sys_arch_protect() by suspending the scheduler, or 0
+to use a critical section.  Suspending the scheduler is much cheaper on the
+Windows port, where a critical section takes a Windows mutex, and is safe
+because lwIP is only called from tasks in this port - the simulated MAC
+interrupt is itself a task. */
+#ifndef sysarchPROTECT_WITH_SCHEDULER_LOCK
+	#define sysarchPROTECT_WITH_SCHEDULER_LOCK	1
+#endif
+
 #define SYS_SEM_NULL					( ( SemaphoreHandle_t ) NULL )
 #define SYS_DEFAULT_THREAD_STACK_DEPTH	configMINIMAL_STACK_SIZE
 
 typedef SemaphoreHandle_t sys_sem_t;
 typedef SemaphoreHandle_t sys_mutex_t;
-typedef QueueHandle_t sys_mbox_t;
 typedef TaskHandle_t sys_thread_t;
 
+#if( sysarchLIGHTWEIGHT_MBOX == 1 )
+	typedef struct xSYS_MBOX * sys_mbox_t;
+	#define SYS_MBOX_NULL				( ( sys_mbox_t ) NULL )
+#else
+	typedef QueueHandle_t sys_mbox_t;
+	#define SYS_MBOX_NULL				( ( QueueHandle_t ) NULL )
+#endif
+
 typedef unsigned long sys_prot_t;
 
 #define sys_mbox_valid( x ) ( ( ( *x ) == NULL) ? pdFALSE : pdTRUE )
@@ -48,6 +48,8 @@
 #include "lwip/mem.h"
 #include "lwip/stats.h"
 
+#if( sysarchLIGHTWEIGHT_MBOX == 0 )
+
 /*---------------------------------------------------------------------------*
  * Routine:  sys_mbox_new
  *---------------------------------------------------------------------------*
@@ -259,6 +261,342 @@ unsigned long ulReturn;
 	return ulReturn;
 }
 
+#else /* sysarchLIGHTWEIGHT_MBOX */
+
+/* A mailbox is a ring of message pointers.  The ring is only ever accessed
+with the scheduler suspended, which is cheap, and a task notification is only
+sent when the reading task is actually blocked. */
+struct xSYS_MBOX
+{
+	void **ppvMessages;
+	UBaseType_t uxLength;
+	UBaseType_t uxReadIndex;
+	UBaseType_t uxMessagesWaiting;
+
+	/* The task blocked waiting for a message, or NULL. */
+	TaskHandle_t xWaitingReader;
+};
+
+/* Ticks a task posting to a full mailbox waits before trying again.  lwIP
+sizes its mailboxes so they are rarely full, so polling is used rather than
+adding a second wait list to every mailbox. */
+#define sysarchMBOX_FULL_RETRY_TICKS	( ( TickType_t ) 1 )
+
+/*---------------------------------------------------------------------------*
+ * Routine:  prvMailboxTryPost
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Adds a message to the mailbox if there is space, and wakes the task
+ *      waiting to read from the mailbox, if any.
+ * Outputs:
+ *      BaseType_t              -- pdTRUE if the message was posted.
+ *---------------------------------------------------------------------------*/
+static BaseType_t prvMailboxTryPost( struct xSYS_MBOX *pxMailBox, void *pvMessage )
+{
+BaseType_t xReturn = pdFALSE;
+TaskHandle_t xReaderToWake = NULL;
+
+	vTaskSuspendAll();
+	{
+		if( pxMailBox->uxMessagesWaiting < pxMailBox->uxLength )
+		{
+			pxMailBox->ppvMessages[ ( pxMailBox->uxReadIndex + pxMailBox->uxMessagesWaiting ) % pxMailBox->uxLength ] = pvMessage;
+			pxMailBox->uxMessagesWaiting++;
+
+			xReaderToWake = pxMailBox->xWaitingReader;
+			pxMailBox->xWaitingReader = NULL;
+			xReturn = pdTRUE;
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	if( xReaderToWake != NULL )
+	{
+		xTaskNotifyGiveIndexed( xReaderToWake, sysarchMBOX_NOTIFICATION_INDEX );
+	}
+
+	return xReturn;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  prvMailboxTryFetch
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Removes the oldest message from the mailbox.  If the mailbox is empty
+ *      and xRegisterAsReader is pdTRUE the calling task is recorded as the
+ *      task to notify when a message is posted.
+ * Outputs:
+ *      BaseType_t              -- pdTRUE if a message was removed.
+ *---------------------------------------------------------------------------*/
+static BaseType_t prvMailboxTryFetch( struct xSYS_MBOX *pxMailBox, void **ppvMessage, BaseType_t xRegisterAsReader )
+{
+BaseType_t xReturn = pdFALSE;
+
+	vTaskSuspendAll();
+	{
+		if( pxMailBox->uxMessagesWaiting > 0U )
+		{
+			*ppvMessage = pxMailBox->ppvMessages[ pxMailBox->uxReadIndex ];
+			pxMailBox->uxReadIndex = ( pxMailBox->uxReadIndex + 1U ) % pxMailBox->uxLength;
+			pxMailBox->uxMessagesWaiting--;
+			xReturn = pdTRUE;
+		}
+		else if( xRegisterAsReader != pdFALSE )
+		{
+			/* Only one task may wait on a mailbox at a time. */
+			configASSERT( ( pxMailBox->xWaitingReader == NULL ) || ( pxMailBox->xWaitingReader == xTaskGetCurrentTaskHandle() ) );
+			pxMailBox->xWaitingReader = xTaskGetCurrentTaskHandle();
+		}
+		else if( pxMailBox->xWaitingReader == xTaskGetCurrentTaskHandle() )
+		{
+			/* Giving up waiting. */
+			pxMailBox->xWaitingReader = NULL;
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	return xReturn;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_new
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Creates a new mailbox
+ * Inputs:
+ *      int size                -- Size of elements in the mailbox
+ * Outputs:
+ *      sys_mbox_t              -- Handle to new mailbox
+ *---------------------------------------------------------------------------*/
+err_t sys_mbox_new( sys_mbox_t *pxMailBox, int iSize )
+{
+err_t xReturn = ERR_MEM;
+struct xSYS_MBOX *pxNewMailBox = NULL;
+
+	if( iSize > 0 )
+	{
+		/* The ring of message pointers follows the mailbox structure in the
+		same allocation. */
+		pxNewMailBox = pvPortMalloc( sizeof( struct xSYS_MBOX ) + ( ( size_t ) iSize * sizeof( void * ) ) );
+	}
+
+	if( pxNewMailBox != NULL )
+	{
+		pxNewMailBox->ppvMessages = ( void ** ) &( pxNewMailBox[ 1 ] );
+		pxNewMailBox->uxLength = ( UBaseType_t ) iSize;
+		pxNewMailBox->uxReadIndex = 0U;
+		pxNewMailBox->uxMessagesWaiting = 0U;
+		pxNewMailBox->xWaitingReader = NULL;
+
+		xReturn = ERR_OK;
+		SYS_STATS_INC_USED( mbox );
+	}
+	else
+	{
+		SYS_STATS_INC( mbox.err );
+	}
+
+	*pxMailBox = pxNewMailBox;
+
+	return xReturn;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_free
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Deallocates a mailbox. If there are messages still present in the
+ *      mailbox when the mailbox is deallocated, it is an indication of a
+ *      programming error in lwIP and the developer should be notified.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *---------------------------------------------------------------------------*/
+void sys_mbox_free( sys_mbox_t *pxMailBox )
+{
+	configASSERT( ( *pxMailBox )->uxMessagesWaiting == 0U );
+	configASSERT( ( *pxMailBox )->xWaitingReader == NULL );
+
+	#if SYS_STATS
+	{
+		if( ( *pxMailBox )->uxMessagesWaiting != 0U )
+		{
+			SYS_STATS_INC( mbox.err );
+		}
+
+		SYS_STATS_DEC( mbox.used );
+	}
+	#endif /* SYS_STATS */
+
+	vPortFree( *pxMailBox );
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_post
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Post the "msg" to the mailbox.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void *data              -- Pointer to data to post
+ *---------------------------------------------------------------------------*/
+void sys_mbox_post( sys_mbox_t *pxMailBox, void *pxMessageToPost )
+{
+	while( prvMailboxTryPost( *pxMailBox, pxMessageToPost ) != pdTRUE )
+	{
+		vTaskDelay( sysarchMBOX_FULL_RETRY_TICKS );
+	}
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_trypost
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Try to post the "msg" to the mailbox.  Returns immediately with
+ *      error if cannot.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void *msg               -- Pointer to data to post
+ * Outputs:
+ *      err_t                   -- ERR_OK if message posted, else ERR_MEM
+ *                                  if not.
+ *---------------------------------------------------------------------------*/
+err_t sys_mbox_trypost( sys_mbox_t *pxMailBox, void *pxMessageToPost )
+{
+err_t xReturn;
+
+	if( prvMailboxTryPost( *pxMailBox, pxMessageToPost ) == pdTRUE )
+	{
+		xReturn = ERR_OK;
+	}
+	else
+	{
+		/* The mailbox was already full. */
+		xReturn = ERR_MEM;
+		SYS_STATS_INC( mbox.err );
+	}
+
+	return xReturn;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_mbox_fetch
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Blocks the thread until a message arrives in the mailbox, but does
+ *      not block the thread longer than "timeout" milliseconds.  A timeout
+ *      of 0 waits indefinitely.  See the queue based implementation above
+ *      for the full description.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void **msg              -- Pointer to pointer to msg received
+ *      u32_t timeout           -- Number of milliseconds until timeout
+ * Outputs:
+ *      u32_t                   -- SYS_ARCH_TIMEOUT if timeout, else number
+ *                                  of milliseconds until received.
+ *---------------------------------------------------------------------------*/
+u32_t sys_arch_mbox_fetch( sys_mbox_t *pxMailBox, void **ppvBuffer, u32_t ulTimeOut )
+{
+void *pvDummy;
+TickType_t xStartTime, xElapsed, xTicksToWait;
+TimeOut_t xTimeOut;
+unsigned long ulReturn;
+
+	xStartTime = xTaskGetTickCount();
+
+	if( NULL == ppvBuffer )
+	{
+		ppvBuffer = &pvDummy;
+	}
+
+	if( ulTimeOut != 0UL )
+	{
+		xTicksToWait = ulTimeOut / portTICK_PERIOD_MS;
+	}
+	else
+	{
+		xTicksToWait = portMAX_DELAY;
+	}
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for( ;; )
+	{
+		if( prvMailboxTryFetch( *pxMailBox, ppvBuffer, pdTRUE ) == pdTRUE )
+		{
+			xElapsed = ( xTaskGetTickCount() - xStartTime ) * portTICK_PERIOD_MS;
+
+			if( ( ulTimeOut == 0UL ) && ( xElapsed == 0UL ) )
+			{
+				xElapsed = 1UL;
+			}
+
+			ulReturn = xElapsed;
+			break;
+		}
+
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+		{
+			/* Stop waiting, but take a message that was posted between the
+			last check and now rather than leaving it in the mailbox. */
+			if( prvMailboxTryFetch( *pxMailBox, ppvBuffer, pdFALSE ) == pdTRUE )
+			{
+				ulReturn = ( xTaskGetTickCount() - xStartTime ) * portTICK_PERIOD_MS;
+			}
+			else
+			{
+				*ppvBuffer = NULL;
+				ulReturn = SYS_ARCH_TIMEOUT;
+			}
+
+			break;
+		}
+
+		/* A notification left over from an earlier timed out wait only
+		causes one extra pass around the loop. */
+		( void ) ulTaskNotifyTakeIndexed( sysarchMBOX_NOTIFICATION_INDEX, pdTRUE, xTicksToWait );
+	}
+
+	return ulReturn;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_mbox_tryfetch
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Similar to sys_arch_mbox_fetch, but if message is not ready
+ *      immediately, we'll return with SYS_MBOX_EMPTY.  On success, 0 is
+ *      returned.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void **msg              -- Pointer to pointer to msg received
+ * Outputs:
+ *      u32_t                   -- SYS_MBOX_EMPTY if no messages.  Otherwise,
+ *                                  return ERR_OK.
+ *---------------------------------------------------------------------------*/
+u32_t sys_arch_mbox_tryfetch( sys_mbox_t *pxMailBox, void **ppvBuffer )
+{
+void *pvDummy;
+unsigned long ulReturn;
+
+	if( ppvBuffer== NULL )
+	{
+		ppvBuffer = &pvDummy;
+	}
+
+	if( prvMailboxTryFetch( *pxMailBox, ppvBuffer, pdFALSE ) == pdTRUE )
+	{
+		ulReturn = ERR_OK;
+	}
+	else
+	{
+		ulReturn = SYS_MBOX_EMPTY;
+	}
+
+	return ulReturn;
+}
+
+#endif /* sysarchLIGHTWEIGHT_MBOX */
+
 /*---------------------------------------------------------------------------*
  * Routine:  sys_sem_new
  *---------------------------------------------------------------------------*
@@ -503,7 +841,17 @@ sys_thread_t xReturn;
  *---------------------------------------------------------------------------*/
 sys_prot_t sys_arch_protect( void )
 {
-	vPortEnterCritical();
+	#if( sysarchPROTECT_WITH_SCHEDULER_LOCK == 1 )
+	{
+		/* Scheduler suspension nests, so recursive calls are safe. */
+		vTaskSuspendAll();
+	}
+	#else
+	{
+		vPortEnterCritical();
+	}
+	#endif
+
 	return ( sys_prot_t ) 1;
 }
 
@@ -521,7 +869,16 @@ sys_prot_t sys_arch_protect( void )
 void sys_arch_unprotect( sys_prot_t xValue )
 {
 	(void) xValue;
-	taskEXIT_CRITICAL();
+
+	#if( sysarchPROTECT_WITH_SCHEDULER_LOCK == 1 )
+	{
+		( void ) xTaskResumeAll();
+	}
+	#else
+	{
+		taskEXIT_CRITICAL();
+	}
+	#endif
 }
 
 /*
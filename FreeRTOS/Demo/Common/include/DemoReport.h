@@ -0,0 +1,50 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef DEMO_REPORT_H
+#define DEMO_REPORT_H
+
+/* The benchmarks in Demo/Common/Minimal report their results through
+ * configDEMO_REPORT().  The parameter is a printf() style format string and
+ * its arguments in brackets, for example:
+ *
+ * configDEMO_REPORT( ( "%u cycles\r\n", ( unsigned ) ulCycles ) );
+ *
+ * Define it in FreeRTOSConfig.h to output the results, for example:
+ *
+ * #define configDEMO_REPORT( X )    vLoggingPrintf X
+ *
+ * By default the results are measured but not output.  The arguments are then
+ * only passed to sizeof(), so they are not evaluated, nothing is called, and
+ * values computed only for the report do not cause unused variable warnings.
+ * iDemoReportDiscard() is never defined. */
+#ifndef configDEMO_REPORT
+    int iDemoReportDiscard( const char * pcFormat,
+                            ... );
+    #define configDEMO_REPORT( X )    ( void ) sizeof( iDemoReportDiscard X )
+#endif
+
+#endif /* DEMO_REPORT_H */
@@ -0,0 +1,91 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef EVENT_FLAGS_H
+#define EVENT_FLAGS_H
+
+/* The maximum number of tasks that can wait on one set of event flags at the
+ * same time.  This bounds the time a set takes with interrupts masked. */
+#ifndef configEVENT_FLAGS_MAX_WAITERS
+    #define configEVENT_FLAGS_MAX_WAITERS    4
+#endif
+
+/* The task notification index used to wake waiting tasks.  Set this if the
+ * waiting tasks also use notification index 0 for something else. */
+#ifndef configEVENT_FLAGS_NOTIFY_INDEX
+    #define configEVENT_FLAGS_NOTIFY_INDEX    0
+#endif
+
+/*
+ * Event flags that an interrupt can set directly.  xEventGroupSetBitsFromISR()
+ * cannot walk an event group's list of waiting tasks from an interrupt, as the
+ * list has no bound, so it defers the set to the timer service task, which
+ * costs a second context switch before the waiting task runs.  Event flags
+ * hold at most configEVENT_FLAGS_MAX_WAITERS waiting tasks, so the interrupt
+ * sets the bits and sends a direct to task notification to each waiting task
+ * whose condition is met, and the waiting task runs next.
+ *
+ * Unlike an event group, bits a waiting task asked to clear on exit are
+ * cleared by that task when it runs, not by the set that unblocked it.  If two
+ * tasks wait for the same bit and both clear it on exit, only the first to run
+ * returns, and the other continues to wait.
+ */
+typedef struct EventFlagsWaiter
+{
+    TaskHandle_t xTask;             /* The waiting task, or NULL if the slot is free. */
+    EventBits_t uxBitsToWaitFor;
+    BaseType_t xWaitForAllBits;
+    BaseType_t xNotified;           /* pdTRUE once the task has been sent a notification it has not yet acted on. */
+} EventFlagsWaiter_t;
+
+typedef struct EventFlags
+{
+    volatile EventBits_t uxEventBits;
+    EventFlagsWaiter_t xWaiters[ configEVENT_FLAGS_MAX_WAITERS ];
+} EventFlags_t;
+
+void vEventFlagsInit( EventFlags_t * pxFlags );
+EventBits_t xEventFlagsSet( EventFlags_t * pxFlags,
+                            EventBits_t uxBitsToSet );
+EventBits_t xEventFlagsSetFromISR( EventFlags_t * pxFlags,
+                                   EventBits_t uxBitsToSet,
+                                   BaseType_t * pxHigherPriorityTaskWoken );
+EventBits_t xEventFlagsClear( EventFlags_t * pxFlags,
+                              EventBits_t uxBitsToClear );
+EventBits_t xEventFlagsGet( EventFlags_t * pxFlags );
+EventBits_t xEventFlagsWait( EventFlags_t * pxFlags,
+                             EventBits_t uxBitsToWaitFor,
+                             BaseType_t xClearOnExit,
+                             BaseType_t xWaitForAllBits,
+                             TickType_t xTicksToWait );
+
+/* The demo tasks that test the above and compare the latency from an
+ * interrupt to the waiting task with that of an event group. */
+void vStartEventFlagsTasks( void );
+BaseType_t xAreEventFlagsTasksStillRunning( void );
+void vEventFlagsSetFromISRTest( void );
+
+#endif /* EVENT_FLAGS_H */
@@ -0,0 +1,118 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef HEAP_BENCHMARK_H
+#define HEAP_BENCHMARK_H
+
+/* The number of blocks a workload can have allocated at once. */
+#ifndef hbMAX_SLOTS
+    #define hbMAX_SLOTS    128
+#endif
+
+/*
+ * A workload is a sequence of events, each of which either allocates a block
+ * and remembers it in a numbered slot, or frees the block held in a slot.
+ * Workloads can be generated by xHeapBenchmarkGenerateWorkload(), or recorded
+ * from an application, for example by logging the calls seen by the
+ * traceMALLOC() and traceFREE() hooks, and stored as a const array.
+ */
+typedef struct HeapBenchmarkEvent
+{
+    uint32_t ulSize; /* The number of bytes to allocate, or 0 to free the slot. */
+    uint16_t usSlot; /* Which block the event refers to, less than hbMAX_SLOTS. */
+} HeapBenchmarkEvent_t;
+
+/* The generated workloads.  Each models a number of concurrent network
+ * connections, see HeapBenchmark.c. */
+typedef enum
+{
+    eHeapBenchmarkTLS = 0, /* TLS sessions: record buffers, certificate parsing and bignums during the handshake. */
+    eHeapBenchmarkHTTP,    /* Plain HTTP: header and string buffers and short lived body chunks. */
+    eHeapBenchmarkMixed    /* Both at once. */
+} eHeapBenchmarkWorkload;
+
+/* The allocator being measured.  Each function is passed pvContext.  Either
+ * of the functions that report sizes can be NULL if the allocator cannot
+ * report it, in which case the measurements that need it are not made. */
+typedef struct HeapBenchmarkAllocator
+{
+    const char * pcName;
+    void * ( *pvMalloc )( void * pvContext,
+                          size_t xSize );
+    void ( * vFree )( void * pvContext,
+                      void * pv );
+    size_t ( * xGetFreeSize )( void * pvContext );
+    size_t ( * xGetLargestFreeBlockSize )( void * pvContext );
+    void * pvContext;
+} HeapBenchmarkAllocator_t;
+
+/* The results of replaying one workload.  Times are in the units of
+ * configHEAP_BENCHMARK_CYCLE_COUNT(). */
+typedef struct HeapBenchmarkResult
+{
+    uint32_t ulAllocations;
+    uint32_t ulFailedAllocations;
+    uint32_t ulFrees;
+    uint32_t ulMinAllocCycles;
+    uint32_t ulAverageAllocCycles;
+    uint32_t ulMaxAllocCycles;
+    uint32_t ulMinFreeCycles;
+    uint32_t ulAverageFreeCycles;
+    uint32_t ulMaxFreeCycles;
+    size_t xPeakRequestedBytes;      /* The most bytes the workload had allocated at once. */
+    size_t xMinimumFreeBytes;        /* The lowest free size reported, if known. */
+    uint32_t ulWorstFragmentation;   /* The highest percentage of free bytes that were not in the largest free block, if known. */
+} HeapBenchmarkResult_t;
+
+/*
+ * Fill pxEvents with a workload of at most xMaxEvents events that allocates
+ * and frees like eWorkload, and return the number of events written.  The
+ * same ulSeed always gives the same workload.  Every block allocated is freed
+ * by the end of the workload.
+ */
+size_t xHeapBenchmarkGenerateWorkload( eHeapBenchmarkWorkload eWorkload,
+                                       uint32_t ulSeed,
+                                       HeapBenchmarkEvent_t * pxEvents,
+                                       size_t xMaxEvents );
+
+/*
+ * Run the xEventCount events at pxEvents against pxAllocator, timing each
+ * allocation and free.  Not reentrant.
+ */
+void vHeapBenchmarkReplay( const HeapBenchmarkAllocator_t * pxAllocator,
+                           const HeapBenchmarkEvent_t * pxEvents,
+                           size_t xEventCount,
+                           HeapBenchmarkResult_t * pxResult );
+
+/*
+ * Create a task that replays each generated workload against the heap used by
+ * pvPortMalloc() and against a TLSF heap, reports the results through
+ * configDEMO_REPORT(), then deletes itself.
+ */
+void vStartHeapBenchmarkTask( UBaseType_t uxPriority );
+BaseType_t xAreHeapBenchmarksComplete( void );
+
+#endif /* HEAP_BENCHMARK_H */
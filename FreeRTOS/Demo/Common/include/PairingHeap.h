@@ -0,0 +1,86 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef PAIRING_HEAP_H
+#define PAIRING_HEAP_H
+
+/*
+ * An ordered collection with the same role as the kernel's sorted lists: items
+ * carry a TickType_t value and the item with the lowest value is always at the
+ * head.  vListInsert() walks the list to find the insertion point, so blocking
+ * with a timeout costs more the more tasks are already blocked.  Inserting into
+ * a pairing heap takes constant time and removing an item takes amortised
+ * logarithmic time.
+ *
+ * Items with equal values leave the heap in the order they were inserted, as
+ * they do from a list filled with vListInsert().
+ *
+ * Like the kernel lists, a heap does no locking; the caller provides any
+ * critical section needed.  Also like the kernel lists, values are compared
+ * without regard to tick count overflow, so a delayed list keeps a second heap
+ * for wake times that have overflowed.
+ */
+
+struct PairingHeap;
+
+typedef struct PairingHeapItem
+{
+    TickType_t xItemValue;                  /* The value the heap is ordered by. */
+    UBaseType_t uxInsertOrder;              /* Orders items with equal values. */
+    struct PairingHeapItem * pxChild;       /* The first child. */
+    struct PairingHeapItem * pxSibling;     /* The next sibling. */
+    struct PairingHeapItem * pxPrevious;    /* The previous sibling, or the parent of the first child. */
+    void * pvOwner;                         /* The object that contains the item, normally a TCB. */
+    struct PairingHeap * pxContainer;       /* The heap the item is in, or NULL. */
+} PairingHeapItem_t;
+
+typedef struct PairingHeap
+{
+    PairingHeapItem_t * pxRoot;             /* The item with the lowest value. */
+    UBaseType_t uxNumberOfItems;
+    UBaseType_t uxNextInsertOrder;
+} PairingHeap_t;
+
+/* Accessors matching the kernel's list macros. */
+#define phSET_ITEM_OWNER( pxItem, pxOwner )       ( ( pxItem )->pvOwner = ( void * ) ( pxOwner ) )
+#define phGET_ITEM_OWNER( pxItem )                ( ( pxItem )->pvOwner )
+#define phSET_ITEM_VALUE( pxItem, xValue )        ( ( pxItem )->xItemValue = ( xValue ) )
+#define phGET_ITEM_VALUE( pxItem )                ( ( pxItem )->xItemValue )
+#define phGET_HEAD_ENTRY( pxHeap )                ( ( pxHeap )->pxRoot )
+#define phGET_ITEM_VALUE_OF_HEAD_ENTRY( pxHeap )  ( ( pxHeap )->pxRoot->xItemValue )
+#define phGET_OWNER_OF_HEAD_ENTRY( pxHeap )       ( ( pxHeap )->pxRoot->pvOwner )
+#define phIS_EMPTY( pxHeap )                      ( ( ( pxHeap )->uxNumberOfItems == ( UBaseType_t ) 0 ) ? pdTRUE : pdFALSE )
+#define phCURRENT_HEAP_LENGTH( pxHeap )           ( ( pxHeap )->uxNumberOfItems )
+#define phIS_CONTAINED_WITHIN( pxHeap, pxItem )   ( ( ( pxItem )->pxContainer == ( pxHeap ) ) ? pdTRUE : pdFALSE )
+#define phGET_HEAP_ITEM_CONTAINER( pxItem )       ( ( pxItem )->pxContainer )
+
+void vPairingHeapInitialise( PairingHeap_t * const pxHeap );
+void vPairingHeapInitialiseItem( PairingHeapItem_t * const pxItem );
+void vPairingHeapInsert( PairingHeap_t * const pxHeap,
+                         PairingHeapItem_t * const pxNewItem );
+UBaseType_t uxPairingHeapRemove( PairingHeapItem_t * const pxItemToRemove );
+
+#endif /* PAIRING_HEAP_H */
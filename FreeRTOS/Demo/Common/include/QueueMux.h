@@ -0,0 +1,93 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef QUEUE_MUX_H
+#define QUEUE_MUX_H
+
+/* The maximum number of sources, normally queues, that one multiplexer can
+ * watch. */
+#ifndef configQUEUE_MUX_MAX_SOURCES
+    #define configQUEUE_MUX_MAX_SOURCES    64
+#endif
+
+/* The task notification index used to wake the task waiting on a multiplexer.
+ * Set this if the waiting task also uses notification index 0 for something
+ * else. */
+#ifndef configQUEUE_MUX_NOTIFY_INDEX
+    #define configQUEUE_MUX_NOTIFY_INDEX    0
+#endif
+
+#define qmuxBITMAP_WORDS    ( ( configQUEUE_MUX_MAX_SOURCES + 31 ) / 32 )
+
+/*
+ * A lighter alternative to a queue set, for one task that waits on many
+ * queues.  Each queue is given a source number.  Sending to the queue sets the
+ * source's bit in a bitmap, and the waiting task is sent a direct to task
+ * notification when the first bit is set.  The waiting task takes all the set
+ * bits in one operation, then empties the queue of each.  Unlike a queue set
+ * nothing is posted per item, so the multiplexer does not have to be sized for
+ * the sum of the member queue lengths - it is a single bitmap however many
+ * items are queued.
+ *
+ * A source's bit can be set when its queue is already empty, because an
+ * earlier bit caused the item to be received, so the waiting task must not
+ * treat an empty queue as an error.
+ */
+typedef struct QueueMux
+{
+    TaskHandle_t xWaitingTask;                      /* The task to notify, set by xQueueMuxWait(). */
+    volatile uint32_t ulReady[ qmuxBITMAP_WORDS ];  /* One bit per source that has been signalled since the last xQueueMuxWait(). */
+    volatile BaseType_t xNotified;                  /* pdTRUE if xWaitingTask has been notified since the last xQueueMuxWait(), so need not be notified again. */
+} QueueMux_t;
+
+void vQueueMuxInit( QueueMux_t * pxMux );
+void vQueueMuxSignal( QueueMux_t * pxMux,
+                      UBaseType_t uxSource );
+void vQueueMuxSignalFromISR( QueueMux_t * pxMux,
+                             UBaseType_t uxSource,
+                             BaseType_t * pxHigherPriorityTaskWoken );
+BaseType_t xQueueMuxSend( QueueMux_t * pxMux,
+                          UBaseType_t uxSource,
+                          QueueHandle_t xQueue,
+                          const void * pvItemToQueue,
+                          TickType_t xTicksToWait );
+BaseType_t xQueueMuxSendFromISR( QueueMux_t * pxMux,
+                                 UBaseType_t uxSource,
+                                 QueueHandle_t xQueue,
+                                 const void * pvItemToQueue,
+                                 BaseType_t * pxHigherPriorityTaskWoken );
+BaseType_t xQueueMuxWait( QueueMux_t * pxMux,
+                          uint32_t pulReady[ qmuxBITMAP_WORDS ],
+                          TickType_t xTicksToWait );
+BaseType_t xQueueMuxNextSource( uint32_t pulReady[ qmuxBITMAP_WORDS ],
+                                UBaseType_t * puxSource );
+
+/* The demo tasks that test the above. */
+void vStartQueueMuxTasks( void );
+BaseType_t xAreQueueMuxTasksStillRunning( void );
+void vQueueMuxAccessFromISR( void );
+
+#endif /* QUEUE_MUX_H */
@@ -0,0 +1,107 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef SEQLOCK_MAILBOX_H
+#define SEQLOCK_MAILBOX_H
+
+/*
+ * A mailbox that holds the latest value written to it, as a queue of length
+ * one used with xQueueOverwrite() and xQueuePeek() does, but that neither
+ * readers nor the writer lock.  Reading never blocks the writer, and neither
+ * reading nor writing disables interrupts, so a large value can be published
+ * often to many readers without a critical section around every copy.
+ *
+ * The mailbox keeps two copies of the value.  The writer fills the copy that
+ * readers are not being directed to, then publishes it by incrementing a
+ * sequence number.  A reader copies the value the sequence number points to,
+ * then checks the sequence number has not changed.  If it has, a write
+ * completed while the reader was copying, so the copy might have been
+ * overwritten part way through, and the reader tries again.  A reader that
+ * interrupts the writer part way through a write reads the previous value,
+ * which the writer is not touching, so a reader never waits for the writer.
+ *
+ * Only one task or interrupt may write to a mailbox.  If more than one does,
+ * the writers must be serialised by the application.  Any number of tasks and
+ * interrupts can read it.
+ */
+
+/* Orders the writes to, or reads from, the value with respect to the sequence
+ * number.  Defaults to a full barrier for GCC compatible compilers.  Other
+ * compilers must define it in FreeRTOSConfig.h to at least a compiler barrier,
+ * and to a hardware barrier on a multi-core target. */
+#ifndef configSEQLOCK_MAILBOX_MEMORY_BARRIER
+    #if defined( __GNUC__ )
+        #define configSEQLOCK_MAILBOX_MEMORY_BARRIER()    __sync_synchronize()
+    #else
+        #define configSEQLOCK_MAILBOX_MEMORY_BARRIER()
+    #endif
+#endif
+
+/* The number of bytes of storage a mailbox holding items of xItemSize bytes
+ * needs. */
+#define seqlockMAILBOX_STORAGE_SIZE( xItemSize )    ( 2U * ( xItemSize ) )
+
+typedef struct SeqLockMailbox
+{
+    volatile UBaseType_t uxSequence; /* The number of writes completed.  The latest value is in copy uxSequence & 1. */
+    size_t xItemSize;
+    uint8_t * pucStorage;            /* Two copies of the value, each xItemSize bytes. */
+} SeqLockMailbox_t;
+
+/*
+ * Initialise a mailbox that holds items of xItemSize bytes in pvStorage,
+ * which must be at least seqlockMAILBOX_STORAGE_SIZE( xItemSize ) bytes.  The
+ * mailbox is empty until it is first written.
+ */
+void vSeqLockMailboxInit( SeqLockMailbox_t * pxMailbox,
+                          void * pvStorage,
+                          size_t xItemSize );
+
+/*
+ * Copy the item at pvItem into the mailbox, replacing the value it holds.
+ * Never blocks, and can be called from an interrupt.
+ */
+void vSeqLockMailboxWrite( SeqLockMailbox_t * pxMailbox,
+                           const void * pvItem );
+
+/*
+ * Copy the latest value from the mailbox to pvBuffer without removing it.
+ * Returns pdFALSE, leaving pvBuffer unchanged, if the mailbox has never been
+ * written.  If puxSequence is not NULL it is set to the number of writes the
+ * value copied was the last of, so a reader can tell whether the value is new
+ * to it.  Never blocks, and can be called from an interrupt, but copies the
+ * value again if a write completes while it is copying.
+ */
+BaseType_t xSeqLockMailboxRead( SeqLockMailbox_t * pxMailbox,
+                                void * pvBuffer,
+                                UBaseType_t * puxSequence );
+
+/* The demo tasks that test the above. */
+void vStartSeqLockMailboxTasks( void );
+BaseType_t xAreSeqLockMailboxTasksStillRunning( void );
+void vSeqLockMailboxReadFromISRTest( void );
+
+#endif /* SEQLOCK_MAILBOX_H */
@@ -0,0 +1,175 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef STATIC_ARENA_H
+#define STATIC_ARENA_H
+
+/* The number of each type of object the arena holds.  Set these in
+ * FreeRTOSConfig.h to the number of objects the application creates from the
+ * arena.  The defaults are what the demo tasks below need. */
+#ifndef configSTATIC_ARENA_TASKS
+    #define configSTATIC_ARENA_TASKS         1
+#endif
+
+#ifndef configSTATIC_ARENA_QUEUES
+    #define configSTATIC_ARENA_QUEUES        1
+#endif
+
+#ifndef configSTATIC_ARENA_SEMAPHORES
+    #define configSTATIC_ARENA_SEMAPHORES    3
+#endif
+
+#ifndef configSTATIC_ARENA_TIMERS
+    #define configSTATIC_ARENA_TIMERS        1
+#endif
+
+#ifndef configSTATIC_ARENA_EVENT_GROUPS
+    #define configSTATIC_ARENA_EVENT_GROUPS    1
+#endif
+
+/* The total number of stack words shared by the tasks, and the total number of
+ * bytes shared by the queue storage areas. */
+#ifndef configSTATIC_ARENA_STACK_WORDS
+    #define configSTATIC_ARENA_STACK_WORDS    ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+#ifndef configSTATIC_ARENA_QUEUE_STORAGE_BYTES
+    #define configSTATIC_ARENA_QUEUE_STORAGE_BYTES    64
+#endif
+
+/* Every object, stack and queue storage area starts on a boundary of this many
+ * bytes, so set it to the cache line size.  It must be a power of two and at
+ * least portBYTE_ALIGNMENT. */
+#ifndef configSTATIC_ARENA_ALIGNMENT
+    #define configSTATIC_ARENA_ALIGNMENT    32
+#endif
+
+/*
+ * A compile time sized arena that RTOS objects are created from when
+ * configSUPPORT_DYNAMIC_ALLOCATION is 0.  Rather than the application declaring
+ * a StaticTask_t and a stack for each task, a StaticQueue_t and a storage area
+ * for each queue, and so on, the counts above are set once and the functions
+ * below take the memory for each object from the arena and pass it to the
+ * matching xXxxCreateStatic() function.
+ *
+ * The arena is a single static array split into one region per type of object
+ * plus one for stacks and one for queue storage.  Objects of the same type are
+ * next to each other, and each starts on a configSTATIC_ARENA_ALIGNMENT
+ * boundary so no two objects share a cache line.  Taking memory from a region
+ * only moves the region's next free offset, so creating an object takes the
+ * same time however many objects already exist.  The memory is never given
+ * back, so objects created from the arena are expected to exist for as long as
+ * the application runs and must not be deleted.  Stacks and queue storage areas
+ * are rounded up to a whole number of configSTATIC_ARENA_ALIGNMENT bytes, which
+ * configSTATIC_ARENA_STACK_WORDS and configSTATIC_ARENA_QUEUE_STORAGE_BYTES
+ * must allow for.
+ *
+ * Each function takes the same parameters as the dynamically allocating
+ * function it replaces and, like that function, fails without creating
+ * anything if there is not enough room left for the object.
+ */
+typedef enum
+{
+    eStaticArenaTasks = 0,
+    eStaticArenaQueues,
+    eStaticArenaSemaphores,
+    eStaticArenaTimers,
+    eStaticArenaEventGroups,
+    eStaticArenaStacks,
+    eStaticArenaQueueStorage,
+    eStaticArenaNumberOfRegions
+} StaticArenaRegion_t;
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+/*
+ * As xTaskCreate().  Returns errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY if either
+ * the task or the stack region is too full.
+ */
+    BaseType_t xStaticArenaTaskCreate( TaskFunction_t pxTaskCode,
+                                       const char * const pcName,
+                                       const configSTACK_DEPTH_TYPE uxStackDepth,
+                                       void * const pvParameters,
+                                       UBaseType_t uxPriority,
+                                       TaskHandle_t * const pxCreatedTask );
+
+/*
+ * As xQueueCreate().  Returns NULL if either the queue or the queue storage
+ * region is too full.
+ */
+    QueueHandle_t xStaticArenaQueueCreate( const UBaseType_t uxQueueLength,
+                                           const UBaseType_t uxItemSize );
+
+/*
+ * As xSemaphoreCreateBinary(), xSemaphoreCreateMutex(),
+ * xSemaphoreCreateRecursiveMutex() and xSemaphoreCreateCounting().  All take a
+ * StaticSemaphore_t from the semaphore region and return NULL if it is full.
+ */
+    SemaphoreHandle_t xStaticArenaSemaphoreCreateBinary( void );
+
+    #if ( configUSE_MUTEXES == 1 )
+        SemaphoreHandle_t xStaticArenaSemaphoreCreateMutex( void );
+    #endif
+
+    #if ( configUSE_RECURSIVE_MUTEXES == 1 )
+        SemaphoreHandle_t xStaticArenaSemaphoreCreateRecursiveMutex( void );
+    #endif
+
+    #if ( configUSE_COUNTING_SEMAPHORES == 1 )
+        SemaphoreHandle_t xStaticArenaSemaphoreCreateCounting( UBaseType_t uxMaxCount,
+                                                               UBaseType_t uxInitialCount );
+    #endif
+
+/*
+ * As xTimerCreate().  Returns NULL if the timer region is full.
+ */
+    #if ( configUSE_TIMERS == 1 )
+        TimerHandle_t xStaticArenaTimerCreate( const char * const pcTimerName,
+                                               const TickType_t xTimerPeriodInTicks,
+                                               const BaseType_t xAutoReload,
+                                               void * const pvTimerID,
+                                               TimerCallbackFunction_t pxCallbackFunction );
+    #endif
+
+/*
+ * As xEventGroupCreate().  Returns NULL if the event group region is full.
+ */
+    EventGroupHandle_t xStaticArenaEventGroupCreate( void );
+
+/*
+ * The number of bytes not yet taken from eRegion.  Use this to size the
+ * configSTATIC_ARENA_ settings once the application has created its objects.
+ */
+    size_t xStaticArenaGetFreeBytes( StaticArenaRegion_t eRegion );
+
+/* The demo task that creates one of each object from the arena and then uses
+ * them, checking each object is aligned and took exactly one slot. */
+    void vStartStaticArenaTasks( UBaseType_t uxPriority );
+    BaseType_t xAreStaticArenaTasksStillRunning( void );
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
+#endif /* STATIC_ARENA_H */
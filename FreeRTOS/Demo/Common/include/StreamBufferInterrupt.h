@@ -31,4 +31,8 @@ void vStartStreamBufferInterruptDemo( void );
 void vBasicStreamBufferSendFromISR( void );
 BaseType_t xIsInterruptStreamBufferDemoStillRunning( void );
 
+/* Called from the interrupt of the one shot timer started by
+ * sbiSTART_COALESCE_TIMER(), when sbiCOALESCE_BYTES is non-zero. */
+void vStreamBufferCoalesceTimeoutFromISR( BaseType_t * pxHigherPriorityTaskWoken );
+
 #endif /* STREAM_BUFFER_INTERRUPT_H */
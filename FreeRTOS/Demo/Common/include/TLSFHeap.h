@@ -0,0 +1,133 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TLSF_HEAP_H
+#define TLSF_HEAP_H
+
+/*
+ * A two level segregated fit (TLSF) allocator.  heap_2, heap_4 and heap_5 walk
+ * a list of free blocks to find one that fits, so the time taken by
+ * pvPortMalloc() depends on how many blocks are free.  TLSF keeps a free list
+ * for each range of block sizes and a bitmap of the lists that are not empty,
+ * so allocating and freeing take a bounded time whatever the state of the heap.
+ *
+ * Sizes are first split into power of two ranges (the first level), then each
+ * range is split into tlsfSL_INDEX_COUNT equal parts (the second level).  A
+ * request is rounded up to the start of the next second level range so that
+ * any block in the list found is big enough, which wastes at most 1/16th of
+ * the request.  Adjacent free blocks are merged as soon as they are freed.
+ *
+ * A TLSFHeap_t manages one region of memory passed to xTLSFHeapInitialise().
+ * It does no locking; the caller provides any mutual exclusion needed.  Set
+ * configUSE_TLSF_HEAP to 1 in FreeRTOSConfig.h, and build TLSFHeap.c in place
+ * of heap_n.c, to also have TLSFHeap.c provide pvPortMalloc() and vPortFree()
+ * from a configTOTAL_HEAP_SIZE byte array.
+ */
+
+/* Blocks are a multiple of tlsfALIGNMENT bytes, which is at least 8 so the
+ * two low bits of a block size are free for flags. */
+#if ( portBYTE_ALIGNMENT <= 8 )
+    #define tlsfALIGNMENT_LOG2    3
+#elif ( portBYTE_ALIGNMENT == 16 )
+    #define tlsfALIGNMENT_LOG2    4
+#elif ( portBYTE_ALIGNMENT == 32 )
+    #define tlsfALIGNMENT_LOG2    5
+#else
+    #error TLSFHeap.c does not support this value of portBYTE_ALIGNMENT.
+#endif
+#define tlsfALIGNMENT             ( ( size_t ) 1 << tlsfALIGNMENT_LOG2 )
+
+/* The number of lists each power of two range of sizes is split into. */
+#define tlsfSL_INDEX_COUNT_LOG2    4
+#define tlsfSL_INDEX_COUNT         ( 1U << tlsfSL_INDEX_COUNT_LOG2 )
+
+/* Blocks up to 2 ^ ( configTLSF_FL_INDEX_MAX + 1 ) bytes can be managed.  Each
+ * extra power of two costs tlsfSL_INDEX_COUNT list heads in the TLSFHeap_t, so
+ * lower it to the log2 of the region size to save RAM. */
+#ifndef configTLSF_FL_INDEX_MAX
+    #define configTLSF_FL_INDEX_MAX    24
+#endif
+
+#if ( configTLSF_FL_INDEX_MAX > 30 )
+    #error configTLSF_FL_INDEX_MAX must not be greater than 30.
+#endif
+
+/* Sizes below tlsfSMALL_BLOCK_SIZE all share the first list of the first
+ * level, split into tlsfSL_INDEX_COUNT lists of tlsfALIGNMENT bytes. */
+#define tlsfFL_INDEX_SHIFT     ( tlsfSL_INDEX_COUNT_LOG2 + tlsfALIGNMENT_LOG2 )
+#define tlsfFL_INDEX_COUNT     ( configTLSF_FL_INDEX_MAX - tlsfFL_INDEX_SHIFT + 2 )
+#define tlsfSMALL_BLOCK_SIZE   ( ( size_t ) 1 << tlsfFL_INDEX_SHIFT )
+
+#if ( tlsfFL_INDEX_COUNT < 2 )
+    #error configTLSF_FL_INDEX_MAX is too small for this value of portBYTE_ALIGNMENT.
+#endif
+
+struct TLSFBlock;
+
+typedef struct TLSFHeap
+{
+    uint32_t ulFirstLevelMap;                                                    /* Bit n is set if any list of first level n is not empty. */
+    uint32_t ulSecondLevelMap[ tlsfFL_INDEX_COUNT ];                             /* Bit m of entry n is set if list [ n ][ m ] is not empty. */
+    struct TLSFBlock * pxFreeLists[ tlsfFL_INDEX_COUNT ][ tlsfSL_INDEX_COUNT ]; /* The free blocks, by size. */
+    struct TLSFBlock * pxFirstBlock;                                             /* The lowest addressed block in the region. */
+    struct TLSFBlock * pxLastBlock;                                              /* The zero length block that marks the end of the region. */
+    size_t xFreeBytesRemaining;
+    size_t xMinimumEverFreeBytesRemaining;
+    size_t xNumberOfSuccessfulAllocations;
+    size_t xNumberOfSuccessfulFrees;
+} TLSFHeap_t;
+
+/*
+ * Prepare pxHeap to allocate from the xRegionSize bytes at pvRegion.  Returns
+ * pdFAIL if the region is too small to hold a block.
+ */
+BaseType_t xTLSFHeapInitialise( TLSFHeap_t * const pxHeap,
+                                void * pvRegion,
+                                size_t xRegionSize );
+
+/*
+ * Allocate and free blocks.  pvTLSFHeapMalloc() returns NULL if xWantedSize is
+ * zero or no free block is big enough.  Passing NULL to vTLSFHeapFree() does
+ * nothing.
+ */
+void * pvTLSFHeapMalloc( TLSFHeap_t * const pxHeap,
+                         size_t xWantedSize );
+void vTLSFHeapFree( TLSFHeap_t * const pxHeap,
+                    void * pv );
+
+/*
+ * Sizes, like those reported by heap_4, include the block headers.
+ * xTLSFHeapGetLargestFreeBlockSize() only searches the highest non-empty list,
+ * so it takes time proportional to the length of that one list.
+ * vTLSFHeapGetHeapStats() walks every block.
+ */
+size_t xTLSFHeapGetFreeSize( const TLSFHeap_t * const pxHeap );
+size_t xTLSFHeapGetMinimumEverFreeSize( const TLSFHeap_t * const pxHeap );
+size_t xTLSFHeapGetLargestFreeBlockSize( const TLSFHeap_t * const pxHeap );
+void vTLSFHeapGetHeapStats( const TLSFHeap_t * const pxHeap,
+                            HeapStats_t * pxHeapStats );
+
+#endif /* TLSF_HEAP_H */
@@ -0,0 +1,105 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TASK_NOTIFY_ANY_H
+#define TASK_NOTIFY_ANY_H
+
+/* The notification index used to tell a task which of its other indices have
+ * been notified.  It must not be used for anything else. */
+#ifndef configTASK_NOTIFY_ANY_INDEX
+    #define configTASK_NOTIFY_ANY_INDEX    ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+#endif
+
+/*
+ * Lets a task wait for any of a set of its notification indices, where the
+ * kernel only lets a task block on one index at a time.  Each index still
+ * holds its own value, so each event source keeps its own counting semaphore,
+ * event bits or mailbox, but a single task can wait for all of them without an
+ * event group or queue set on top.
+ *
+ * Notifications sent through the functions below also set the bit for the
+ * notified index in the value of configTASK_NOTIFY_ANY_INDEX.  That index acts
+ * as a doorbell.  ulTaskNotifyWaitAny() blocks on the doorbell, then clears and
+ * returns the bits for the indices it was waiting for.  The task then reads
+ * each index that fired in the usual way, for example with
+ * ulTaskNotifyTakeIndexed( uxIndex, pdTRUE, 0 ).  Doorbell bits for indices
+ * the task was not waiting for are left set for a later wait.
+ *
+ * Notifications sent directly with the kernel API do not ring the doorbell.
+ * As the value and the doorbell are updated one after the other, an index can
+ * be reported as fired after its value was already read along with an earlier
+ * notification, so a task must allow for finding nothing new at an index that
+ * fired.
+ *
+ * Requires configTASK_NOTIFICATION_ARRAY_ENTRIES to be at least 2, and only
+ * indices 0 to 31 can be waited for.
+ */
+
+/* The bit in the value returned by ulTaskNotifyWaitAny(), and in the mask
+ * passed to it, that represents uxIndex. */
+#define notifyANY_INDEX_BIT( uxIndex )    ( ( uint32_t ) 1U << ( uxIndex ) )
+
+/*
+ * As xTaskNotifyIndexed(), and then rings the doorbell for uxIndexToNotify.
+ * If eAction is eSetValueWithoutOverwrite and the index already holds a value
+ * the doorbell is not rung and pdFAIL is returned.
+ */
+BaseType_t xTaskNotifyAnyIndexed( TaskHandle_t xTaskToNotify,
+                                  UBaseType_t uxIndexToNotify,
+                                  uint32_t ulValue,
+                                  eNotifyAction eAction );
+
+/*
+ * The interrupt safe version of xTaskNotifyAnyIndexed().
+ */
+BaseType_t xTaskNotifyAnyIndexedFromISR( TaskHandle_t xTaskToNotify,
+                                         UBaseType_t uxIndexToNotify,
+                                         uint32_t ulValue,
+                                         eNotifyAction eAction,
+                                         BaseType_t * pxHigherPriorityTaskWoken );
+
+/* Use an index as a counting semaphore, as xTaskNotifyGiveIndexed() and
+ * vTaskNotifyGiveIndexedFromISR() do. */
+#define xTaskNotifyAnyGiveIndexed( xTaskToNotify, uxIndexToNotify ) \
+    xTaskNotifyAnyIndexed( ( xTaskToNotify ), ( uxIndexToNotify ), 0, eIncrement )
+#define vTaskNotifyAnyGiveIndexedFromISR( xTaskToNotify, uxIndexToNotify, pxHigherPriorityTaskWoken ) \
+    ( void ) xTaskNotifyAnyIndexedFromISR( ( xTaskToNotify ), ( uxIndexToNotify ), 0, eIncrement, ( pxHigherPriorityTaskWoken ) )
+
+/*
+ * Wait up to xTicksToWait for any of the indices whose bits are set in
+ * ulIndexMask to be notified through the functions above.  Returns the bits
+ * of those that were, which are cleared, or 0 if none were before the block
+ * time expired.
+ */
+uint32_t ulTaskNotifyWaitAny( uint32_t ulIndexMask,
+                              TickType_t xTicksToWait );
+
+/* The demo tasks that test the above. */
+void vStartTaskNotifyAnyTasks( void );
+BaseType_t xAreTaskNotifyAnyTasksStillRunning( void );
+void vTaskNotifyAnyISRTest( void );
+
+#endif /* TASK_NOTIFY_ANY_H */
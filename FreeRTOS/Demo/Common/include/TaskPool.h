@@ -0,0 +1,126 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+/* The task notification index a parked worker waits on for its next job.  Set
+ * this if the jobs run by the pool also use notification index 0. */
+#ifndef configTASK_POOL_NOTIFY_INDEX
+    #define configTASK_POOL_NOTIFY_INDEX    0
+#endif
+
+/*
+ * A pool of tasks that are created once and then reused.  Creating a task
+ * allocates its TCB and stack and fills the stack, and a task that deletes
+ * itself is not freed until the idle task runs.  A pool instead creates its
+ * workers up front and parks each, blocked on a task notification, until
+ * xTaskPoolRun() hands it a function to run.  When that function returns the
+ * worker goes back to the pool rather than being deleted, so the TCB and stack
+ * are ready for the next job without an allocation, a stack fill or idle task
+ * clean up.
+ *
+ * A job is written as a task function that returns when it is done.  It must
+ * not delete itself, and the handle xTaskPoolRun() returns must not be passed
+ * to vTaskDelete(), as the worker would then be lost to the pool.  A worker
+ * keeps its name, stack size, notification values and thread local storage
+ * pointers from one job to the next.
+ */
+struct TaskPool;
+
+typedef void (* TaskPoolFunction_t)( void * pvParameters );
+
+typedef struct TaskPoolWorker
+{
+    TaskHandle_t xTask;
+    TaskPoolFunction_t pxFunction;      /* The job being run, or NULL while the worker is parked. */
+    void * pvParameters;
+    struct TaskPool * pxPool;
+    struct TaskPoolWorker * pxNextFree; /* The next parked worker, if this one is parked. */
+} TaskPoolWorker_t;
+
+typedef struct TaskPool
+{
+    TaskPoolWorker_t * pxFreeWorkers;   /* The parked workers, most recently parked first. */
+    UBaseType_t uxFreeWorkers;
+    UBaseType_t uxParkedPriority;
+} TaskPool_t;
+
+/*
+ * Create uxNumberOfWorkers workers, using pxWorkers as an array of that many
+ * worker structures.  The workers wait at uxParkedPriority while they are
+ * parked.  Returns pdFAIL if any worker could not be created, in which case
+ * those that were created are in the pool.
+ */
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+    BaseType_t xTaskPoolCreate( TaskPool_t * pxPool,
+                                TaskPoolWorker_t * pxWorkers,
+                                UBaseType_t uxNumberOfWorkers,
+                                const char * const pcName,
+                                const configSTACK_DEPTH_TYPE uxStackDepth,
+                                UBaseType_t uxParkedPriority );
+#endif
+
+/*
+ * As xTaskPoolCreate(), but the workers use pxTaskBuffers, an array of
+ * uxNumberOfWorkers StaticTask_t, and puxStackBuffer, which is
+ * uxNumberOfWorkers * uxStackDepth words, so the pool uses no heap at all.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    BaseType_t xTaskPoolCreateStatic( TaskPool_t * pxPool,
+                                      TaskPoolWorker_t * pxWorkers,
+                                      UBaseType_t uxNumberOfWorkers,
+                                      const char * const pcName,
+                                      const configSTACK_DEPTH_TYPE uxStackDepth,
+                                      UBaseType_t uxParkedPriority,
+                                      StackType_t * puxStackBuffer,
+                                      StaticTask_t * pxTaskBuffers );
+#endif
+
+/*
+ * Run pxFunction( pvParameters ) at uxPriority on a parked worker, as
+ * xTaskCreate() would run it on a new task.  If pxCreatedTask is not NULL the
+ * worker's handle is returned through it.  Returns pdFAIL, without blocking,
+ * if no worker is parked.
+ */
+BaseType_t xTaskPoolRun( TaskPool_t * pxPool,
+                         TaskPoolFunction_t pxFunction,
+                         void * pvParameters,
+                         UBaseType_t uxPriority,
+                         TaskHandle_t * const pxCreatedTask );
+
+/*
+ * The number of workers parked in the pool.
+ */
+UBaseType_t uxTaskPoolGetFreeCount( const TaskPool_t * pxPool );
+
+/* The demo tasks that test the above and compare the time taken to start and
+ * finish a job on a pooled worker with that taken to create and delete a task,
+ * as the tasks in death.c do. */
+void vStartTaskPoolTasks( UBaseType_t uxPriority );
+BaseType_t xAreTaskPoolTasksStillRunning( void );
+
+#endif /* TASK_POOL_H */
@@ -0,0 +1,103 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+/* The number of bits of the expiry time resolved by the first level of the
+ * wheel, and by each level above it.  The first level has one slot per tick, so
+ * (1 << configTIMER_WHEEL_ROOT_BITS) slots. */
+#ifndef configTIMER_WHEEL_ROOT_BITS
+    #define configTIMER_WHEEL_ROOT_BITS    6
+#endif
+
+#ifndef configTIMER_WHEEL_LEVEL_BITS
+    #define configTIMER_WHEEL_LEVEL_BITS    6
+#endif
+
+/* The number of levels, including the first.  The default spans 2^24 ticks.
+ * Timers further in the future than that are held in the top level until they
+ * come within range. */
+#ifndef configTIMER_WHEEL_LEVELS
+    #define configTIMER_WHEEL_LEVELS    4
+#endif
+
+#define twROOT_SLOTS     ( ( UBaseType_t ) 1U << configTIMER_WHEEL_ROOT_BITS )
+#define twLEVEL_SLOTS    ( ( UBaseType_t ) 1U << configTIMER_WHEEL_LEVEL_BITS )
+
+struct WheelTimer;
+
+/* The prototype of the function called when a wheel timer expires. */
+typedef void (* WheelTimerCallback_t)( struct WheelTimer * pxTimer );
+
+/* A timer that is run by a timer wheel.  The memory is provided by the
+ * application and the members are only accessed through the functions
+ * below. */
+typedef struct WheelTimer
+{
+    struct WheelTimer * pxNext;        /* The next timer in the same slot. */
+    struct WheelTimer ** ppxPrevNext;  /* The pointer that points to this timer, so it can be removed without searching.  NULL when the timer is not active. */
+    TickType_t xExpiryTime;            /* The tick at which the timer expires. */
+    TickType_t xPeriod;                /* The reload period, or 0 for a one-shot timer. */
+    WheelTimerCallback_t pxCallback;   /* Called when the timer expires. */
+    void * pvTimerID;                  /* For use by the application. */
+} WheelTimer_t;
+
+/* A hierarchical timer wheel.  Starting and stopping a timer takes the same
+ * time however many timers are active, unlike the sorted lists used by the
+ * kernel's timer service, in which starting a timer walks the list. */
+typedef struct TimerWheel
+{
+    TickType_t xCurrentTick;                                                       /* The last tick processed by vTimerWheelAdvance(). */
+    UBaseType_t uxActiveTimers;                                                    /* The number of timers that are running. */
+    WheelTimer_t * pxRootSlots[ twROOT_SLOTS ];                                    /* Timers expiring in the next twROOT_SLOTS ticks, one slot per tick. */
+    WheelTimer_t * pxLevelSlots[ configTIMER_WHEEL_LEVELS - 1 ][ twLEVEL_SLOTS ];  /* Timers further away, moved down a level as their time approaches. */
+} TimerWheel_t;
+
+/*
+ * A timer wheel does no locking.  Every call for a wheel, including those made
+ * from timer callbacks, must be made from the same task, for example the task
+ * of the protocol stack whose timers it runs, or be serialised by the caller.
+ * vTimerWheelAdvance() would normally be called each tick, or on waking with
+ * the current tick count.
+ */
+void vTimerWheelInit( TimerWheel_t * pxWheel,
+                      TickType_t xNow );
+void vWheelTimerInit( WheelTimer_t * pxTimer,
+                      WheelTimerCallback_t pxCallback,
+                      void * pvTimerID );
+void vWheelTimerStart( TimerWheel_t * pxWheel,
+                       WheelTimer_t * pxTimer,
+                       TickType_t xDelay,
+                       TickType_t xPeriod );
+void vWheelTimerStop( TimerWheel_t * pxWheel,
+                      WheelTimer_t * pxTimer );
+BaseType_t xWheelTimerIsActive( const WheelTimer_t * pxTimer );
+void * pvWheelTimerGetID( const WheelTimer_t * pxTimer );
+void vTimerWheelAdvance( TimerWheel_t * pxWheel,
+                         TickType_t xNow );
+
+#endif /* TIMER_WHEEL_H */
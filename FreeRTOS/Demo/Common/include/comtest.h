@@ -35,5 +35,6 @@ void vStartComTestTasks( UBaseType_t uxPriority,
                          eBaud eBaudRate );
 BaseType_t xAreComTestTasksStillRunning( void );
 void vComTestUnsuspendTask( void );
+uint32_t ulComTestGetThroughput( void );
 
 #endif /* ifndef COMTEST_H */
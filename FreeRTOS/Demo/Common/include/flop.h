@@ -29,5 +29,6 @@
 
 void vStartMathTasks( UBaseType_t uxPriority );
 BaseType_t xAreMathsTaskStillRunning( void );
+void vStartMathSwitchBenchmark( UBaseType_t uxPriority );
 
 #endif
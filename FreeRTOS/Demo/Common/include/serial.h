@@ -103,6 +103,20 @@ signed portBASE_TYPE xSerialPutChar( xComPortHandle pxPort,
                                      signed char cOutChar,
                                      TickType_t xBlockTime );
 portBASE_TYPE xSerialWaitForSemaphore( xComPortHandle xPort );
+
+/* Block transfer functions, implemented by ports that move data by DMA so a
+ * buffer costs one call rather than a queue operation per character.
+ * xSerialPutBlock() returns the number of bytes accepted before xBlockTime
+ * expired.  xSerialGetBlock() returns as soon as any data is available, so can
+ * return fewer than xBufferLength bytes. */
+size_t xSerialPutBlock( xComPortHandle pxPort,
+                        const char * pcData,
+                        size_t xLength,
+                        TickType_t xBlockTime );
+size_t xSerialGetBlock( xComPortHandle pxPort,
+                        char * pcBuffer,
+                        size_t xBufferLength,
+                        TickType_t xBlockTime );
 void vSerialClose( xComPortHandle xPort );
 
 #endif /* ifndef SERIAL_COMMS_H */
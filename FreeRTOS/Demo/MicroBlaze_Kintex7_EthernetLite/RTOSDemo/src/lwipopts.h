@@ -175,6 +175,11 @@ a lot of data that needs to be copied, this should be set high. */
    link level header. */
 #define PBUF_LINK_HLEN			16
 
+/* LWIP_NETIF_TX_SINGLE_PBUF: build each outgoing packet in a single pbuf so
+   the Ethernet Lite driver can pass it straight to the MAC without first
+   copying it into a contiguous buffer. */
+#define LWIP_NETIF_TX_SINGLE_PBUF	1
+
 /** SYS_LIGHTWEIGHT_PROT
  * define SYS_LIGHTWEIGHT_PROT in lwipopts.h if you want inter-task protection
  * for certain critical regions during buffer allocation, deallocation and memory
@@ -58,6 +58,7 @@
 #define configUSE_ALTERNATIVE_API                  0
 #define configUSE_QUEUE_SETS                       1
 #define configUSE_TASK_NOTIFICATIONS               1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES      4                         /* Index 3 is the doorbell used by TaskNotifyAny.c. */
 #define configSUPPORT_STATIC_ALLOCATION            1
 #define configRECORD_STACK_HIGH_ADDRESS            1
 
@@ -72,11 +73,18 @@
 
 #define configMAX_PRIORITIES                       ( 7 )
 
-/* Run time stats gathering configuration options. */
-unsigned long ulGetRunTimeCounterValue( void ); /* Prototype of function that returns run time counter. */
-void vConfigureTimerForRunTimeStats( void );    /* Prototype of function that initialises the run time counter. */
+/* Run time stats gathering configuration options.  The counter is 64 bits so
+ * it does not overflow during long simulator runs. */
+#define configRUN_TIME_COUNTER_TYPE               uint64_t
+configRUN_TIME_COUNTER_TYPE ulGetRunTimeCounterValue( void ); /* Prototype of function that returns run time counter. */
+void vConfigureTimerForRunTimeStats( void );                  /* Prototype of function that initialises the run time counter. */
 #define configGENERATE_RUN_TIME_STATS             1
 
+/* The heap benchmark in main_benchmark.c times in nanoseconds.  heap_3.c does
+ * not provide vPortGetHeapStats(). */
+#define configHEAP_BENCHMARK_CYCLE_COUNT()        ( ( uint32_t ) ulGetRunTimeCounterValue() )
+#define hbUSE_HEAP_STATS                          0
+
 /* Co-routine related configuration options. */
 #define configUSE_CO_ROUTINES                     0
 #define configMAX_CO_ROUTINE_PRIORITIES           ( 2 )
@@ -166,6 +174,9 @@ extern void vAssertCalled( const char * const pcFileName,
 extern void vLoggingPrintf( const char * pcFormatString,
                             ... );
 
+/* Output the results of the benchmarks in Demo/Common/Minimal. */
+#define configDEMO_REPORT( X )    vLoggingPrintf X
+
 /* Set to 1 to print out debug messages.  If ipconfigHAS_DEBUG_PRINTF is set to
  * 1 then FreeRTOS_debug_printf should be defined to the function used to print
  * out the debugging messages. */
@@ -26,34 +26,261 @@
 
 /*-----------------------------------------------------------
 * Example console I/O wrappers.
+*
+* console_print() formats each message into a slot of a fixed size ring
+* buffer and returns without taking a lock or touching stdout.  A host
+* thread that is not known to the scheduler drains the ring and performs the
+* (potentially blocking) writes, so heavy logging does not stall the calling
+* task or skew the timing of the simulation.
+*
+* Any number of tasks may write concurrently: a slot is claimed with a
+* compare and swap on the enqueue index, and each slot carries a sequence
+* number that tells the writer thread when the producer has finished filling
+* it.  If the ring is full the message is dropped rather than waiting, and
+* the number of dropped messages is reported in-line the next time the ring
+* is drained.  Messages longer than consoleSLOT_SIZE - 1 bytes are truncated.
 *----------------------------------------------------------*/
 
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 
-#include <FreeRTOS.h>
-#include <semphr.h>
+#include "console.h"
 
-SemaphoreHandle_t xStdioMutex;
-StaticSemaphore_t xStdioMutexBuffer;
+/* The number of slots in the ring.  Must be a power of two. */
+#ifndef consoleSLOT_COUNT
+    #define consoleSLOT_COUNT    1024U
+#endif
+
+/* The size of each slot, including the terminating NULL. */
+#ifndef consoleSLOT_SIZE
+    #define consoleSLOT_SIZE     256U
+#endif
+
+#if ( ( consoleSLOT_COUNT & ( consoleSLOT_COUNT - 1U ) ) != 0 )
+    #error consoleSLOT_COUNT must be a power of two
+#endif
+
+#define consoleSLOT_MASK    ( ( size_t ) consoleSLOT_COUNT - 1U )
+
+typedef struct ConsoleSlot
+{
+    size_t xSequence; /* Accessed atomically. */
+    size_t xLength;
+    char cMessage[ consoleSLOT_SIZE ];
+} ConsoleSlot_t;
+
+static ConsoleSlot_t xSlots[ consoleSLOT_COUNT ];
+
+/* The next slot a producer will claim.  Accessed atomically. */
+static size_t xEnqueueIndex = 0;
+
+/* The next slot the writer thread will drain.  Only used by the writer
+ * thread, and by the exit handler once the writer thread has stopped. */
+static size_t xDequeueIndex = 0;
+
+/* Messages dropped because the ring was full, in total and as already
+ * reported by the writer thread.  ulDropped is accessed atomically. */
+static uint32_t ulDropped = 0;
+static uint32_t ulDroppedReported = 0;
+
+static sem_t xWriterWake;
+static pthread_t xWriterThread;
+static int xConsoleRunning = 0; /* Accessed atomically. */
+
+/*-----------------------------------------------------------*/
+
+/* Write out every message that is ready, then any drop count that has not
+ * yet been reported.  Returns the number of messages written. */
+static size_t prvConsoleDrain( void )
+{
+    ConsoleSlot_t * pxSlot;
+    size_t xWritten = 0;
+    uint32_t ulDroppedNow;
+
+    for( ; ; )
+    {
+        pxSlot = &( xSlots[ xDequeueIndex & consoleSLOT_MASK ] );
+
+        if( __atomic_load_n( &( pxSlot->xSequence ), __ATOMIC_ACQUIRE ) != ( xDequeueIndex + 1U ) )
+        {
+            /* Empty, or the producer of this slot has not finished with it
+             * yet.  Messages are written in the order their slots were
+             * claimed, so stop here rather than skipping ahead. */
+            break;
+        }
+
+        fwrite( pxSlot->cMessage, 1, pxSlot->xLength, stdout );
+
+        /* Hand the slot back to producers for the next lap of the ring. */
+        __atomic_store_n( &( pxSlot->xSequence ), xDequeueIndex + consoleSLOT_COUNT, __ATOMIC_RELEASE );
+        xDequeueIndex++;
+        xWritten++;
+    }
+
+    ulDroppedNow = __atomic_load_n( &ulDropped, __ATOMIC_RELAXED );
+
+    if( ulDroppedNow != ulDroppedReported )
+    {
+        fprintf( stdout, "[console: %lu message(s) dropped]\n", ( unsigned long ) ( ulDroppedNow - ulDroppedReported ) );
+        ulDroppedReported = ulDroppedNow;
+    }
+
+    fflush( stdout );
+
+    return xWritten;
+}
+/*-----------------------------------------------------------*/
+
+static void * prvConsoleWriterThread( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    while( __atomic_load_n( &xConsoleRunning, __ATOMIC_ACQUIRE ) != 0 )
+    {
+        /* Producers post once per message, so the count may run ahead of
+         * the messages drained here - that only costs an extra empty pass. */
+        while( sem_wait( &xWriterWake ) != 0 )
+        {
+        }
+
+        ( void ) prvConsoleDrain();
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsoleExit( void )
+{
+    /* Stop the writer thread, then write whatever it left behind from this
+     * thread so the last messages before exit() are not lost. */
+    if( __atomic_exchange_n( &xConsoleRunning, 0, __ATOMIC_ACQ_REL ) != 0 )
+    {
+        ( void ) sem_post( &xWriterWake );
+
+        if( pthread_equal( pthread_self(), xWriterThread ) == 0 )
+        {
+            ( void ) pthread_join( xWriterThread, NULL );
+        }
+
+        ( void ) prvConsoleDrain();
+    }
+}
+/*-----------------------------------------------------------*/
 
 void console_init( void )
 {
-    xStdioMutex = xSemaphoreCreateMutexStatic( &xStdioMutexBuffer );
+    size_t x;
+    sigset_t xAllSignals, xPreviousSignals;
+
+    for( x = 0; x < consoleSLOT_COUNT; x++ )
+    {
+        xSlots[ x ].xSequence = x;
+    }
+
+    if( sem_init( &xWriterWake, 0, 0 ) != 0 )
+    {
+        return;
+    }
+
+    __atomic_store_n( &xConsoleRunning, 1, __ATOMIC_RELEASE );
+
+    /* The writer thread must never take a signal meant for the scheduler, so
+     * create it with every signal blocked. */
+    sigfillset( &xAllSignals );
+    ( void ) pthread_sigmask( SIG_SETMASK, &xAllSignals, &xPreviousSignals );
+
+    if( pthread_create( &xWriterThread, NULL, prvConsoleWriterThread, NULL ) != 0 )
+    {
+        /* console_print() falls back to writing directly. */
+        __atomic_store_n( &xConsoleRunning, 0, __ATOMIC_RELEASE );
+    }
+    else
+    {
+        ( void ) atexit( prvConsoleExit );
+    }
+
+    ( void ) pthread_sigmask( SIG_SETMASK, &xPreviousSignals, NULL );
 }
+/*-----------------------------------------------------------*/
 
 void console_print( const char * fmt,
                     ... )
 {
     va_list vargs;
+    ConsoleSlot_t * pxSlot;
+    size_t xPosition, xSequence;
+    int iLength;
 
     va_start( vargs, fmt );
 
-    xSemaphoreTake( xStdioMutex, portMAX_DELAY );
+    if( __atomic_load_n( &xConsoleRunning, __ATOMIC_ACQUIRE ) == 0 )
+    {
+        /* Not initialised, or already shut down. */
+        vprintf( fmt, vargs );
+        va_end( vargs );
+        return;
+    }
+
+    xPosition = __atomic_load_n( &xEnqueueIndex, __ATOMIC_RELAXED );
 
-    vprintf( fmt, vargs );
+    for( ; ; )
+    {
+        pxSlot = &( xSlots[ xPosition & consoleSLOT_MASK ] );
+        xSequence = __atomic_load_n( &( pxSlot->xSequence ), __ATOMIC_ACQUIRE );
 
-    xSemaphoreGive( xStdioMutex );
+        if( xSequence == xPosition )
+        {
+            /* The slot is free for this lap - try to claim it.  On failure
+             * xPosition is updated to the current enqueue index. */
+            if( __atomic_compare_exchange_n( &xEnqueueIndex, &xPosition, xPosition + 1U, 0,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED ) != 0 )
+            {
+                break;
+            }
+        }
+        else if( ( ptrdiff_t ) ( xSequence - xPosition ) < 0 )
+        {
+            /* The writer thread has not drained this slot from the previous
+             * lap, so the ring is full. */
+            ( void ) __atomic_fetch_add( &ulDropped, 1U, __ATOMIC_RELAXED );
+            va_end( vargs );
+            return;
+        }
+        else
+        {
+            /* Another producer claimed the slot first. */
+            xPosition = __atomic_load_n( &xEnqueueIndex, __ATOMIC_RELAXED );
+        }
+    }
 
+    iLength = vsnprintf( pxSlot->cMessage, sizeof( pxSlot->cMessage ), fmt, vargs );
     va_end( vargs );
+
+    if( iLength < 0 )
+    {
+        iLength = 0;
+    }
+    else if( ( size_t ) iLength >= sizeof( pxSlot->cMessage ) )
+    {
+        iLength = ( int ) sizeof( pxSlot->cMessage ) - 1;
+    }
+
+    pxSlot->xLength = ( size_t ) iLength;
+
+    /* Publish the message to the writer thread. */
+    __atomic_store_n( &( pxSlot->xSequence ), xPosition + 1U, __ATOMIC_RELEASE );
+    ( void ) sem_post( &xWriterWake );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t console_dropped( void )
+{
+    return __atomic_load_n( &ulDropped, __ATOMIC_RELAXED );
 }
@@ -27,6 +27,8 @@
 #ifndef CONSOLE_H
     #define CONSOLE_H
 
+    #include <stdint.h>
+
     #ifdef __cplusplus
         extern "C" {
     #endif
@@ -39,6 +41,10 @@
     void console_print( const char * fmt,
                         ... );
 
+/* The number of messages console_print() has dropped because the output ring
+ * buffer was full. */
+    uint32_t console_dropped( void );
+
     #ifdef __cplusplus
         }
     #endif
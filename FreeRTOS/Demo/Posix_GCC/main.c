@@ -25,8 +25,9 @@
  */
 
 /******************************************************************************
- * This project provides two demo applications.  A simple blinky style project,
- * a more comprehensive test and demo application.
+ * This project provides three demo applications.  A simple blinky style
+ * project, a more comprehensive test and demo application, and a scheduler
+ * benchmark.
  * The mainSELECTED_APPLICATION setting is used to select between
  * the three
  *
@@ -36,6 +37,9 @@
  * If mainSELECTED_APPLICATION = FULL_DEMO the more comprehensive test and demo
  * application built. This is implemented and described in main_full.c.
  *
+ * If mainSELECTED_APPLICATION = BENCHMARK_DEMO the scheduler benchmark will be
+ * built.  This is implemented and described in main_benchmark.c.
+ *
  * This file implements the code that is not demo specific, including the
  * hardware setup and FreeRTOS hook functions.
  *
@@ -72,8 +76,9 @@
     #include <trcRecorder.h>
 #endif
 
-#define    BLINKY_DEMO    0
-#define    FULL_DEMO      1
+#define    BLINKY_DEMO       0
+#define    FULL_DEMO         1
+#define    BENCHMARK_DEMO    2
 
 #ifdef BUILD_DIR
     #define BUILD         BUILD_DIR
@@ -93,6 +98,7 @@
 /*-----------------------------------------------------------*/
 extern void main_blinky( void );
 extern void main_full( void );
+extern void main_benchmark( void );
 static void traceOnEnter( void );
 
 /*
@@ -101,6 +107,7 @@ static void traceOnEnter( void );
  */
 void vFullDemoTickHookFunction( void );
 void vFullDemoIdleFunction( void );
+void vBenchmarkTickHookFunction( void );
 
 /*
  * Prototypes for the standard FreeRTOS application hook (callback) functions
@@ -183,6 +190,11 @@ int main( void )
             console_print( "Starting full demo\n" );
             main_full();
         }
+    #elif ( mainSELECTED_APPLICATION == BENCHMARK_DEMO )
+        {
+            console_print( "Starting benchmark\n" );
+            main_benchmark();
+        }
     #else
         {
             #error "The selected demo is not valid"
@@ -207,7 +219,16 @@ void vApplicationMallocFailedHook( void )
      * (although it does not provide information on how the remaining heap might be
      * fragmented).  See http://www.freertos.org/a00111.html for more
      * information. */
-    vAssertCalled( __FILE__, __LINE__ );
+    #if ( mainSELECTED_APPLICATION == BENCHMARK_DEMO )
+        {
+            /* The benchmark creates tasks until the heap is exhausted, and
+             * handles the failure itself. */
+        }
+    #else
+        {
+            vAssertCalled( __FILE__, __LINE__ );
+        }
+    #endif
 }
 /*-----------------------------------------------------------*/
 
@@ -264,6 +285,10 @@ void vApplicationTickHook( void )
         {
             vFullDemoTickHookFunction();
         }
+    #elif ( mainSELECTED_APPLICATION == BENCHMARK_DEMO )
+        {
+            vBenchmarkTickHookFunction();
+        }
     #endif /* mainSELECTED_APPLICATION */
 }
 
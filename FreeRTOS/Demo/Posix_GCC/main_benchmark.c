@@ -0,0 +1,697 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/******************************************************************************
+ * NOTE 1: The FreeRTOS demo threads will not be running continuously, so
+ * absolute numbers measured by this benchmark say more about the host than
+ * about the kernel.  The benchmark is intended to be run on the same host
+ * before and after a change, so regressions in the scheduler show up as a
+ * change in the numbers.  Building with COVERAGE_TEST=1 removes the trace
+ * recorder, which otherwise adds its own cost to every measurement.
+ *
+ * NOTE 2:  This file only contains the source code that is specific to the
+ * benchmark.  Generic functions, such FreeRTOS hook functions, are defined in
+ * main.c.  The benchmark is selected by building with USER_DEMO=BENCHMARK_DEMO.
+ ******************************************************************************
+ *
+ * main_benchmark() creates a controlling task then starts the scheduler.  The
+ * controlling task creates mainbenchBACKGROUND_TASKS additional tasks, with
+ * each entry in uxBackgroundTaskCounts[] in turn, and with those tasks present
+ * measures:
+ *
+ * + yield - the average time for taskYIELD() to switch between two tasks of
+ *   equal priority.
+ * + notify_round_trip - the average time for a task to notify a higher
+ *   priority task and be notified back, which is two context switches.
+ * + timer_dispatch - the time from the tick interrupt expiring a software
+ *   timer to the timer service task executing the timer's callback, in the
+ *   same way TimerDemo.c uses one shot timers.
+ * + tick_overhead - the CPU time lost to a spinning task per tick while the
+ *   background tasks repeatedly delay for between 1 and
+ *   mainbenchDELAY_SPREAD ticks, which is the cost of processing the tick
+ *   and unblocking the tasks it wakes.  It is calculated from the number of
+ *   loop iterations the spinning task completes relative to the run without
+ *   background tasks.
+ *
+ * Once, after the measurements above, the TLS, HTTP and mixed workloads
+ * generated by Demo/Common/Minimal/HeapBenchmark.c are replayed against
+ * pvPortMalloc(), which is heap_3.c and so the C library's malloc(), and
+ * against a TLSF heap from Demo/Common/Minimal/TLSFHeap.c, measuring:
+ *
+ * + heap_malloc and heap_free - the time taken to allocate and to free each
+ *   block.
+ * + heap_fragmentation - for the TLSF heap only, as heap_3.c cannot report
+ *   it, the peak bytes the workload requested, the lowest free heap and the
+ *   highest percentage of the free heap that was not in the largest free
+ *   block.
+ *
+ * Each result is written to stdout as a single line JSON object, so the output
+ * can be parsed by a host CI system, for example:
+ *
+ * {"benchmark":"yield","tasks":100,"samples":20000,"min_ns":80,"avg_ns":95,"max_ns":3100}
+ * {"benchmark":"heap_malloc","workload":"tls","allocator":"tlsf","samples":32768,"failed":0,"min_ns":40,"avg_ns":70,"max_ns":900}
+ *
+ * Times are in nanoseconds of host wall clock time.  A line containing
+ * "complete" is written once all the benchmarks have run, after which the
+ * process exits with status 0.  If the heap cannot hold the number of
+ * background tasks requested the run at that task count is skipped.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* Demo includes. */
+#include "TLSFHeap.h"
+#include "HeapBenchmark.h"
+
+/* Local includes. */
+#include "console.h"
+
+/* Priorities at which the tasks are created.  The timer service task runs
+ * above all of them, at configTIMER_TASK_PRIORITY. */
+#define mainbenchSPIN_TASK_PRIORITY          ( tskIDLE_PRIORITY + 1 )
+#define mainbenchYIELD_TASK_PRIORITY         ( tskIDLE_PRIORITY + 2 )
+#define mainbenchBACKGROUND_TASK_PRIORITY    ( tskIDLE_PRIORITY + 2 )
+#define mainbenchCONTROL_TASK_PRIORITY       ( tskIDLE_PRIORITY + 4 )
+#define mainbenchECHO_TASK_PRIORITY          ( tskIDLE_PRIORITY + 5 )
+
+/* The number of times each task yields, and the number of notify round
+ * trips, per measurement. */
+#define mainbenchSWITCH_ITERATIONS           ( 20000UL )
+
+/* The number of software timer expiries measured. */
+#define mainbenchTIMER_SAMPLES               ( 200UL )
+
+/* The number of ticks over which the spinning task is measured. */
+#define mainbenchTICK_WINDOW                 pdMS_TO_TICKS( 1000UL )
+
+/* Background tasks delay for between 1 and mainbenchDELAY_SPREAD ticks while
+ * the tick overhead is being measured. */
+#define mainbenchDELAY_SPREAD                ( 10UL )
+
+/* The largest number of background tasks. */
+#define mainbenchMAX_BACKGROUND_TASKS        ( 1000UL )
+
+/* Time given to the idle task to free the memory of deleted tasks. */
+#define mainbenchCLEAN_UP_DELAY              pdMS_TO_TICKS( 100UL )
+
+#define mainbenchNS_PER_SECOND               ( 1000000000ULL )
+
+/* The number of events in each heap workload, and the size of the TLSF
+ * heap they are replayed against. */
+#define mainbenchHEAP_EVENTS                 ( 65536UL )
+#define mainbenchTLSF_HEAP_SIZE              ( 256UL * 1024UL )
+
+/*-----------------------------------------------------------*/
+
+/* Times collected for one measurement. */
+typedef struct BenchmarkStats
+{
+    uint64_t ullMin;
+    uint64_t ullMax;
+    uint64_t ullTotal;
+    uint32_t ulCount;
+} BenchmarkStats_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task that creates the background tasks and runs each measurement.
+ */
+static void prvControlTask( void * pvParameters );
+
+/*
+ * The measurements described at the top of this file.  Each creates the
+ * tasks it needs and deletes them again before returning.
+ */
+static void prvMeasureYield( uint32_t ulTasks );
+static void prvMeasureNotifyRoundTrip( uint32_t ulTasks );
+static void prvMeasureTimerDispatch( uint32_t ulTasks );
+static void prvMeasureTickOverhead( uint32_t ulTasks );
+static void prvMeasureHeap( void );
+
+/*
+ * The tasks and timer callback used by the measurements.
+ */
+static void prvYieldTask( void * pvParameters );
+static void prvEchoTask( void * pvParameters );
+static void prvSpinTask( void * pvParameters );
+static void prvBackgroundTask( void * pvParameters );
+static void prvTimerCallback( TimerHandle_t xTimer );
+
+/*
+ * The allocators the heap workloads are replayed against.
+ */
+static void * prvSystemMalloc( void * pvContext,
+                               size_t xSize );
+static void prvSystemFree( void * pvContext,
+                           void * pv );
+static void * prvTLSFMalloc( void * pvContext,
+                             size_t xSize );
+static void prvTLSFFree( void * pvContext,
+                         void * pv );
+static size_t prvTLSFGetFreeSize( void * pvContext );
+static size_t prvTLSFGetLargestFreeBlockSize( void * pvContext );
+
+/*
+ * Create and delete the background tasks.  prvCreateBackgroundTasks() returns
+ * the number of tasks it was able to create.
+ */
+static uint32_t prvCreateBackgroundTasks( uint32_t ulTasks );
+static void prvDeleteBackgroundTasks( uint32_t ulTasks );
+
+/*
+ * Helpers for timing and output.
+ */
+static uint64_t prvGetTimeNs( void );
+static void prvResetStats( BenchmarkStats_t * pxStats );
+static void prvAddSample( BenchmarkStats_t * pxStats,
+                          uint64_t ullNs );
+static void prvReport( const char * pcName,
+                       uint32_t ulTasks,
+                       const BenchmarkStats_t * pxStats );
+static void prvReportHeap( const char * pcWorkload,
+                           const HeapBenchmarkAllocator_t * pxAllocator,
+                           const HeapBenchmarkResult_t * pxResult );
+
+/*
+ * Called from the tick hook in main.c.
+ */
+void vBenchmarkTickHookFunction( void );
+
+/*-----------------------------------------------------------*/
+
+/* The numbers of background tasks each measurement is repeated with. */
+static const uint32_t ulBackgroundTaskCounts[] = { 0, 10, 100, mainbenchMAX_BACKGROUND_TASKS };
+
+/* The background tasks. */
+static TaskHandle_t xBackgroundTasks[ mainbenchMAX_BACKGROUND_TASKS ];
+
+/* Set while the background tasks should repeatedly delay, rather than wait
+ * for a notification that never comes. */
+static volatile BaseType_t xBackgroundTasksDelaying = pdFALSE;
+
+/* The controlling task, which the other tasks and the timer callback notify
+ * when they have finished. */
+static TaskHandle_t xControlTask = NULL;
+
+/* Written by the tick hook with the time at which the last tick was
+ * processed. */
+static volatile uint64_t ullLastTickNs = 0;
+
+/* The latency measured by the timer callback. */
+static volatile uint64_t ullTimerLatencyNs = 0;
+
+/* Loop iterations completed by the spinning task. */
+static volatile uint64_t ullSpinIterations = 0;
+
+/* The iterations the spinning task completes with no background tasks, which
+ * the other tick overhead runs are compared against. */
+static uint64_t ullBaselineSpinIterations = 0;
+
+/*-----------------------------------------------------------*/
+
+void main_benchmark( void )
+{
+    xTaskCreate( prvControlTask, "Bench", configMINIMAL_STACK_SIZE, NULL, mainbenchCONTROL_TASK_PRIORITY, &xControlTask );
+
+    vTaskStartScheduler();
+
+    /* If all is well, the scheduler will now be running, and the following
+     * line will never be reached. */
+    for( ; ; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkTickHookFunction( void )
+{
+    ullLastTickNs = prvGetTimeNs();
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    uint32_t ulTasks, ulCreated, x;
+
+    ( void ) pvParameters;
+
+    for( x = 0; x < ( sizeof( ulBackgroundTaskCounts ) / sizeof( ulBackgroundTaskCounts[ 0 ] ) ); x++ )
+    {
+        ulTasks = ulBackgroundTaskCounts[ x ];
+        ulCreated = prvCreateBackgroundTasks( ulTasks );
+
+        if( ulCreated == ulTasks )
+        {
+            prvMeasureYield( ulTasks );
+            prvMeasureNotifyRoundTrip( ulTasks );
+            prvMeasureTimerDispatch( ulTasks );
+            prvMeasureTickOverhead( ulTasks );
+        }
+        else
+        {
+            console_print( "{\"benchmark\":\"skipped\",\"tasks\":%lu,\"created\":%lu}\n",
+                           ( unsigned long ) ulTasks,
+                           ( unsigned long ) ulCreated );
+        }
+
+        prvDeleteBackgroundTasks( ulCreated );
+    }
+
+    prvMeasureHeap();
+
+    console_print( "{\"benchmark\":\"complete\"}\n" );
+    fflush( stdout );
+    exit( EXIT_SUCCESS );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureYield( uint32_t ulTasks )
+{
+    BenchmarkStats_t xStats;
+    uint64_t ullStart;
+
+    /* The yielding tasks have a lower priority so do not start until this
+     * task blocks. */
+    xTaskCreate( prvYieldTask, "Yield1", configMINIMAL_STACK_SIZE, NULL, mainbenchYIELD_TASK_PRIORITY, NULL );
+    xTaskCreate( prvYieldTask, "Yield2", configMINIMAL_STACK_SIZE, NULL, mainbenchYIELD_TASK_PRIORITY, NULL );
+
+    ullStart = prvGetTimeNs();
+    ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+    ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+
+    /* Only the average is meaningful as each yield is not timed
+     * individually. */
+    prvResetStats( &xStats );
+    xStats.ullTotal = prvGetTimeNs() - ullStart;
+    xStats.ulCount = mainbenchSWITCH_ITERATIONS * 2UL;
+    xStats.ullMin = xStats.ullTotal / xStats.ulCount;
+    xStats.ullMax = xStats.ullMin;
+
+    vTaskDelay( mainbenchCLEAN_UP_DELAY );
+    prvReport( "yield", ulTasks, &xStats );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureNotifyRoundTrip( uint32_t ulTasks )
+{
+    BenchmarkStats_t xStats;
+    TaskHandle_t xEchoTask;
+    uint64_t ullStart;
+    uint32_t x;
+
+    xTaskCreate( prvEchoTask, "Echo", configMINIMAL_STACK_SIZE, NULL, mainbenchECHO_TASK_PRIORITY, &xEchoTask );
+    prvResetStats( &xStats );
+
+    for( x = 0; x < mainbenchSWITCH_ITERATIONS; x++ )
+    {
+        /* The echo task has the higher priority, so runs and notifies this
+         * task back before xTaskNotifyGive() returns. */
+        ullStart = prvGetTimeNs();
+        xTaskNotifyGive( xEchoTask );
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        prvAddSample( &xStats, prvGetTimeNs() - ullStart );
+    }
+
+    vTaskDelete( xEchoTask );
+    vTaskDelay( mainbenchCLEAN_UP_DELAY );
+    prvReport( "notify_round_trip", ulTasks, &xStats );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureTimerDispatch( uint32_t ulTasks )
+{
+    BenchmarkStats_t xStats;
+    TimerHandle_t xTimer;
+    uint32_t x;
+
+    /* A one shot timer that expires on the next tick. */
+    xTimer = xTimerCreate( "Bench", 1, pdFALSE, NULL, prvTimerCallback );
+    configASSERT( xTimer );
+    prvResetStats( &xStats );
+
+    for( x = 0; x < mainbenchTIMER_SAMPLES; x++ )
+    {
+        xTimerStart( xTimer, portMAX_DELAY );
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        prvAddSample( &xStats, ullTimerLatencyNs );
+    }
+
+    xTimerDelete( xTimer, portMAX_DELAY );
+    vTaskDelay( mainbenchCLEAN_UP_DELAY );
+    prvReport( "timer_dispatch", ulTasks, &xStats );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureTickOverhead( uint32_t ulTasks )
+{
+    BenchmarkStats_t xStats;
+    TaskHandle_t xSpinTask;
+    uint64_t ullLost, ullTickNs;
+    uint32_t x;
+
+    /* Release the background tasks into their delay loop. */
+    xBackgroundTasksDelaying = pdTRUE;
+
+    for( x = 0; x < ulTasks; x++ )
+    {
+        xTaskNotifyGive( xBackgroundTasks[ x ] );
+    }
+
+    /* The spinning task runs whenever nothing else is. */
+    ullSpinIterations = 0;
+    xTaskCreate( prvSpinTask, "Spin", configMINIMAL_STACK_SIZE, NULL, mainbenchSPIN_TASK_PRIORITY, &xSpinTask );
+    vTaskDelay( mainbenchTICK_WINDOW );
+    vTaskDelete( xSpinTask );
+
+    xBackgroundTasksDelaying = pdFALSE;
+
+    if( ulTasks == 0 )
+    {
+        ullBaselineSpinIterations = ullSpinIterations;
+    }
+
+    /* Report the time per tick that was lost compared to running with no
+     * background tasks. */
+    ullTickNs = mainbenchNS_PER_SECOND / configTICK_RATE_HZ;
+    ullLost = 0;
+
+    if( ( ullBaselineSpinIterations != 0 ) && ( ullSpinIterations < ullBaselineSpinIterations ) )
+    {
+        ullLost = ( ( ullBaselineSpinIterations - ullSpinIterations ) * ullTickNs ) / ullBaselineSpinIterations;
+    }
+
+    prvResetStats( &xStats );
+    xStats.ullMin = ullLost;
+    xStats.ullMax = ullLost;
+    xStats.ullTotal = ullLost * mainbenchTICK_WINDOW;
+    xStats.ulCount = mainbenchTICK_WINDOW;
+
+    /* Give the background tasks time to return to waiting for a
+     * notification. */
+    vTaskDelay( mainbenchCLEAN_UP_DELAY );
+    prvReport( "tick_overhead", ulTasks, &xStats );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureHeap( void )
+{
+    static HeapBenchmarkEvent_t xEvents[ mainbenchHEAP_EVENTS ];
+    static uint8_t ucTLSFRegion[ mainbenchTLSF_HEAP_SIZE ];
+    static TLSFHeap_t xTLSFHeap;
+    static const char * const pcWorkloadNames[] = { "tls", "http", "mixed" };
+    HeapBenchmarkAllocator_t xSystemAllocator = { "heap_3", prvSystemMalloc, prvSystemFree, NULL, NULL, NULL };
+    HeapBenchmarkAllocator_t xTLSFAllocator = { "tlsf", prvTLSFMalloc, prvTLSFFree, prvTLSFGetFreeSize, prvTLSFGetLargestFreeBlockSize, &xTLSFHeap };
+    HeapBenchmarkResult_t xResult;
+    size_t xEventCount;
+    uint32_t x;
+
+    for( x = 0; x < ( sizeof( pcWorkloadNames ) / sizeof( pcWorkloadNames[ 0 ] ) ); x++ )
+    {
+        xEventCount = xHeapBenchmarkGenerateWorkload( ( eHeapBenchmarkWorkload ) x, x + 1UL, xEvents, mainbenchHEAP_EVENTS );
+
+        vHeapBenchmarkReplay( &xSystemAllocator, xEvents, xEventCount, &xResult );
+        prvReportHeap( pcWorkloadNames[ x ], &xSystemAllocator, &xResult );
+
+        /* Start each workload with an empty TLSF heap. */
+        ( void ) xTLSFHeapInitialise( &xTLSFHeap, ucTLSFRegion, sizeof( ucTLSFRegion ) );
+        vHeapBenchmarkReplay( &xTLSFAllocator, xEvents, xEventCount, &xResult );
+        prvReportHeap( pcWorkloadNames[ x ], &xTLSFAllocator, &xResult );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvYieldTask( void * pvParameters )
+{
+    uint32_t x;
+
+    ( void ) pvParameters;
+
+    for( x = 0; x < mainbenchSWITCH_ITERATIONS; x++ )
+    {
+        taskYIELD();
+    }
+
+    xTaskNotifyGive( xControlTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvEchoTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        xTaskNotifyGive( xControlTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSpinTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ullSpinIterations++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBackgroundTask( void * pvParameters )
+{
+    const TickType_t xDelay = ( TickType_t ) ( ( ( uintptr_t ) pvParameters % mainbenchDELAY_SPREAD ) + 1UL );
+
+    for( ; ; )
+    {
+        if( xBackgroundTasksDelaying != pdFALSE )
+        {
+            vTaskDelay( xDelay );
+        }
+        else
+        {
+            ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimerCallback( TimerHandle_t xTimer )
+{
+    ( void ) xTimer;
+
+    ullTimerLatencyNs = prvGetTimeNs() - ullLastTickNs;
+    xTaskNotifyGive( xControlTask );
+}
+/*-----------------------------------------------------------*/
+
+static void * prvSystemMalloc( void * pvContext,
+                               size_t xSize )
+{
+    ( void ) pvContext;
+
+    return pvPortMalloc( xSize );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSystemFree( void * pvContext,
+                           void * pv )
+{
+    ( void ) pvContext;
+
+    vPortFree( pv );
+}
+/*-----------------------------------------------------------*/
+
+static void * prvTLSFMalloc( void * pvContext,
+                             size_t xSize )
+{
+    void * pv;
+
+    /* Suspend the scheduler as heap_3.c does, so both include the cost. */
+    vTaskSuspendAll();
+    {
+        pv = pvTLSFHeapMalloc( ( TLSFHeap_t * ) pvContext, xSize );
+    }
+    ( void ) xTaskResumeAll();
+
+    return pv;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTLSFFree( void * pvContext,
+                         void * pv )
+{
+    vTaskSuspendAll();
+    {
+        vTLSFHeapFree( ( TLSFHeap_t * ) pvContext, pv );
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvTLSFGetFreeSize( void * pvContext )
+{
+    return xTLSFHeapGetFreeSize( ( TLSFHeap_t * ) pvContext );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvTLSFGetLargestFreeBlockSize( void * pvContext )
+{
+    return xTLSFHeapGetLargestFreeBlockSize( ( TLSFHeap_t * ) pvContext );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvCreateBackgroundTasks( uint32_t ulTasks )
+{
+    uint32_t x;
+
+    for( x = 0; x < ulTasks; x++ )
+    {
+        if( xTaskCreate( prvBackgroundTask, "Bkgnd", configMINIMAL_STACK_SIZE, ( void * ) ( uintptr_t ) x, mainbenchBACKGROUND_TASK_PRIORITY, &( xBackgroundTasks[ x ] ) ) != pdPASS )
+        {
+            break;
+        }
+    }
+
+    return x;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDeleteBackgroundTasks( uint32_t ulTasks )
+{
+    uint32_t x;
+
+    for( x = 0; x < ulTasks; x++ )
+    {
+        vTaskDelete( xBackgroundTasks[ x ] );
+    }
+
+    vTaskDelay( mainbenchCLEAN_UP_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvGetTimeNs( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( ( uint64_t ) xNow.tv_sec * mainbenchNS_PER_SECOND ) + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvResetStats( BenchmarkStats_t * pxStats )
+{
+    pxStats->ullMin = UINT64_MAX;
+    pxStats->ullMax = 0;
+    pxStats->ullTotal = 0;
+    pxStats->ulCount = 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddSample( BenchmarkStats_t * pxStats,
+                          uint64_t ullNs )
+{
+    if( ullNs < pxStats->ullMin )
+    {
+        pxStats->ullMin = ullNs;
+    }
+
+    if( ullNs > pxStats->ullMax )
+    {
+        pxStats->ullMax = ullNs;
+    }
+
+    pxStats->ullTotal += ullNs;
+    pxStats->ulCount++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char * pcName,
+                       uint32_t ulTasks,
+                       const BenchmarkStats_t * pxStats )
+{
+    uint64_t ullAverage = 0;
+
+    if( pxStats->ulCount != 0 )
+    {
+        ullAverage = pxStats->ullTotal / pxStats->ulCount;
+    }
+
+    console_print( "{\"benchmark\":\"%s\",\"tasks\":%lu,\"samples\":%lu,\"min_ns\":%llu,\"avg_ns\":%llu,\"max_ns\":%llu}\n",
+                   pcName,
+                   ( unsigned long ) ulTasks,
+                   ( unsigned long ) pxStats->ulCount,
+                   ( unsigned long long ) pxStats->ullMin,
+                   ( unsigned long long ) ullAverage,
+                   ( unsigned long long ) pxStats->ullMax );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportHeap( const char * pcWorkload,
+                           const HeapBenchmarkAllocator_t * pxAllocator,
+                           const HeapBenchmarkResult_t * pxResult )
+{
+    console_print( "{\"benchmark\":\"heap_malloc\",\"workload\":\"%s\",\"allocator\":\"%s\",\"samples\":%lu,\"failed\":%lu,\"min_ns\":%lu,\"avg_ns\":%lu,\"max_ns\":%lu}\n",
+                   pcWorkload,
+                   pxAllocator->pcName,
+                   ( unsigned long ) ( pxResult->ulAllocations - pxResult->ulFailedAllocations ),
+                   ( unsigned long ) pxResult->ulFailedAllocations,
+                   ( unsigned long ) pxResult->ulMinAllocCycles,
+                   ( unsigned long ) pxResult->ulAverageAllocCycles,
+                   ( unsigned long ) pxResult->ulMaxAllocCycles );
+
+    console_print( "{\"benchmark\":\"heap_free\",\"workload\":\"%s\",\"allocator\":\"%s\",\"samples\":%lu,\"min_ns\":%lu,\"avg_ns\":%lu,\"max_ns\":%lu}\n",
+                   pcWorkload,
+                   pxAllocator->pcName,
+                   ( unsigned long ) pxResult->ulFrees,
+                   ( unsigned long ) pxResult->ulMinFreeCycles,
+                   ( unsigned long ) pxResult->ulAverageFreeCycles,
+                   ( unsigned long ) pxResult->ulMaxFreeCycles );
+
+    if( pxAllocator->xGetLargestFreeBlockSize != NULL )
+    {
+        console_print( "{\"benchmark\":\"heap_fragmentation\",\"workload\":\"%s\",\"allocator\":\"%s\",\"peak_bytes\":%lu,\"min_free_bytes\":%lu,\"worst_pct\":%lu}\n",
+                       pcWorkload,
+                       pxAllocator->pcName,
+                       ( unsigned long ) pxResult->xPeakRequestedBytes,
+                       ( unsigned long ) pxResult->xMinimumFreeBytes,
+                       ( unsigned long ) pxResult->ulWorstFragmentation );
+    }
+}
+/*-----------------------------------------------------------*/
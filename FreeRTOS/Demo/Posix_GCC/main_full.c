@@ -79,6 +79,7 @@
 #include <queue.h>
 #include <timers.h>
 #include <semphr.h>
+#include <event_groups.h>
 
 /* Standard demo includes. */
 #include "BlockQ.h"
@@ -94,6 +95,11 @@
 #include "death.h"
 #include "dynamic.h"
 #include "QueueSet.h"
+#include "QueueMux.h"
+#include "EventFlags.h"
+#include "TaskPool.h"
+#include "SeqLockMailbox.h"
+#include "TaskNotifyAny.h"
 #include "QueueOverwrite.h"
 #include "EventGroupsDemo.h"
 #include "IntSemTest.h"
@@ -224,6 +230,11 @@ int main_full( void )
     vStartStreamBufferTasks();
     vStartStreamBufferInterruptDemo();
     vStartMessageBufferAMPTasks( configMINIMAL_STACK_SIZE );
+    vStartQueueMuxTasks();
+    vStartEventFlagsTasks();
+    vStartTaskPoolTasks( mainCREATOR_TASK_PRIORITY );
+    vStartSeqLockMailboxTasks();
+    vStartTaskNotifyAnyTasks();
 
     #if ( configUSE_QUEUE_SETS == 1 )
         {
@@ -404,6 +415,31 @@ static void prvCheckTask( void * pvParameters )
             pcStatusMessage = "Error: Message buffer AMP";
             xErrorCount++;
         }
+        else if( xAreQueueMuxTasksStillRunning() != pdPASS )
+        {
+            pcStatusMessage = "Error: Queue mux";
+            xErrorCount++;
+        }
+        else if( xAreEventFlagsTasksStillRunning() != pdPASS )
+        {
+            pcStatusMessage = "Error: Event flags";
+            xErrorCount++;
+        }
+        else if( xAreTaskPoolTasksStillRunning() != pdPASS )
+        {
+            pcStatusMessage = "Error: Task pool";
+            xErrorCount++;
+        }
+        else if( xAreSeqLockMailboxTasksStillRunning() != pdPASS )
+        {
+            pcStatusMessage = "Error: Seqlock mailbox";
+            xErrorCount++;
+        }
+        else if( xAreTaskNotifyAnyTasksStillRunning() != pdPASS )
+        {
+            pcStatusMessage = "Error: Task notify any";
+            xErrorCount++;
+        }
 
         #if ( configUSE_QUEUE_SETS == 1 )
             else if( xAreQueueSetTasksStillRunning() != pdPASS )
@@ -552,6 +588,18 @@ void vFullDemoTickHookFunction( void )
     /* Call the periodic queue overwrite from ISR demo. */
     vQueueOverwritePeriodicISRDemo();
 
+    /* Send to a queue watched by the queue multiplexer demo. */
+    vQueueMuxAccessFromISR();
+
+    /* Set event flags directly from an interrupt. */
+    vEventFlagsSetFromISRTest();
+
+    /* Read the seqlock mailbox from an interrupt. */
+    vSeqLockMailboxReadFromISRTest();
+
+    /* Notify one of several indices a task is waiting for from an interrupt. */
+    vTaskNotifyAnyISRTest();
+
     #if ( configUSE_QUEUE_SETS == 1 ) /* Remove the tests if queue sets are not defined. */
         {
             /* Write to a queue that is in use as part of the queue set demo to
@@ -28,40 +28,57 @@
  * Utility functions required to gather run time statistics.  See:
  * https://www.FreeRTOS.org/rtos-run-time-stats.html
  *
- * Note that this is a simulated port, where simulated time is a lot slower than
- * real time, therefore the run time counter values have no real meaningful
- * units.
+ * The counter is in nanoseconds and is 64 bits wide (configRUN_TIME_COUNTER_TYPE
+ * is set to uint64_t in FreeRTOSConfig.h), so it does not overflow however long
+ * the simulator runs.
  *
- * Also note that it is assumed this demo is going to be used for short periods
- * of time only, and therefore timer overflows are not handled.
+ * By default the counter is read from CLOCK_MONOTONIC_RAW, which is not adjusted
+ * by NTP and which Linux reads without a system call, as this function is
+ * called on every context switch.  That is wall clock time, so time the host
+ * spends running other processes is charged to whichever task was running.
+ * For soak tests on a busy host define projRUN_TIME_STATS_CLOCK as
+ * CLOCK_PROCESS_CPUTIME_ID, which only advances while the simulator process is
+ * running.  Only one FreeRTOS task runs at a time, so this gives each task the
+ * CPU time it actually used, at the cost of a system call on each read.
  */
 
+#include <stdint.h>
 #include <time.h>
 
 /* FreeRTOS includes. */
 #include <FreeRTOS.h>
 
+#ifndef projRUN_TIME_STATS_CLOCK
+    #ifdef CLOCK_MONOTONIC_RAW
+        #define projRUN_TIME_STATS_CLOCK    CLOCK_MONOTONIC_RAW
+    #else
+        #define projRUN_TIME_STATS_CLOCK    CLOCK_MONOTONIC
+    #endif
+#endif
+
 /* Time at start of day (in ns). */
-static unsigned long ulStartTimeNs;
+static uint64_t ullStartTimeNs;
 
 /*-----------------------------------------------------------*/
 
-void vConfigureTimerForRunTimeStats( void )
+static uint64_t prvGetTimeNs( void )
 {
     struct timespec xNow;
 
-    clock_gettime( CLOCK_MONOTONIC, &xNow );
-    ulStartTimeNs = xNow.tv_sec * 1000000000ul + xNow.tv_nsec;
+    clock_gettime( projRUN_TIME_STATS_CLOCK, &xNow );
+
+    return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
 }
 /*-----------------------------------------------------------*/
 
-unsigned long ulGetRunTimeCounterValue( void )
+void vConfigureTimerForRunTimeStats( void )
 {
-    struct timespec xNow;
-
-    /* Time at start. */
-    clock_gettime( CLOCK_MONOTONIC, &xNow );
+    ullStartTimeNs = prvGetTimeNs();
+}
+/*-----------------------------------------------------------*/
 
-    return xNow.tv_sec * 1000000000ul + xNow.tv_nsec - ulStartTimeNs;
+configRUN_TIME_COUNTER_TYPE ulGetRunTimeCounterValue( void )
+{
+    return ( configRUN_TIME_COUNTER_TYPE ) ( prvGetTimeNs() - ullStartTimeNs );
 }
 /*-----------------------------------------------------------*/
@@ -83,6 +83,17 @@ configTOTAL_HEAP_SIZE is not defined. */
 
 #define configMAX_PRIORITIES					( 7 )
 
+/* The objects StaticArena.c creates without a heap.  Each object starts on a
+cache line boundary. */
+#define configSTATIC_ARENA_TASKS				1
+#define configSTATIC_ARENA_QUEUES				1
+#define configSTATIC_ARENA_SEMAPHORES			3
+#define configSTATIC_ARENA_TIMERS				1
+#define configSTATIC_ARENA_EVENT_GROUPS			1
+#define configSTATIC_ARENA_STACK_WORDS			( configMINIMAL_STACK_SIZE * 2 )
+#define configSTATIC_ARENA_QUEUE_STORAGE_BYTES	64
+#define configSTATIC_ARENA_ALIGNMENT			64
+
 /* Run time stats gathering configuration options. */
 #define configGENERATE_RUN_TIME_STATS			0
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
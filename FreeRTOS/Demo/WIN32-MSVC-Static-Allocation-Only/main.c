@@ -48,9 +48,14 @@
 /* FreeRTOS kernel includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "event_groups.h"
 
 /* Standard demo includes. */
 #include "StaticAllocation.h"
+#include "StaticArena.h"
 
 
 /*-----------------------------------------------------------*/
@@ -98,9 +103,13 @@ int main( void )
      * of the heap files described on http://www.freertos.org/a00111.html */
     vStartStaticallyAllocatedTasks();
 
-    /* Start a task that periodically inspects the tasks created by
-     * vStartStaticallyAllocatedTasks() to ensure they are still running, and not
-     * reporting any errors. */
+    /* Create a task, and the objects it uses, from the arena sized by the
+     * configSTATIC_ARENA_ settings in FreeRTOSConfig.h rather than from
+     * individually declared buffers. */
+    vStartStaticArenaTasks( tskIDLE_PRIORITY + 1 );
+
+    /* Start a task that periodically inspects the tasks created above to
+     * ensure they are still running, and not reporting any errors. */
     prvStartCheckTask();
 
     /* Start the scheduler so the demo tasks start to execute. */
@@ -150,6 +159,10 @@ static void prvCheckTask( void * pvParameters )
         {
             pcStatusMessage = "Error: Static allocation";
         }
+        else if( xAreStaticArenaTasksStillRunning() != pdPASS )
+        {
+            pcStatusMessage = "Error: Static arena";
+        }
 
         /* This is the only task that uses stdout so its ok to call printf()
          * directly. */
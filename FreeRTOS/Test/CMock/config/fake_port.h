@@ -46,5 +46,6 @@ void vPortCurrentTaskDying( void * pxTaskToDelete,
                             volatile BaseType_t * pxPendYield );
 void portSetupTCB_CB( void * tcb );
 void vFakePortAssertIfISR();
+void vFakePortMemoryBarrier( void );
 
 #endif /* FAKE_PORT_H */
@@ -0,0 +1,9 @@
+# Included by the suites in this directory, after ../../makefile.in.
+# Their files under test are in $(DEMO_COMMON_DIR)/Minimal rather than the
+# kernel, so KERNEL_DIR, which ../../testdir.mk finds PROJECT_SRC in, is
+# pointed there.  KERNEL_INCLUDE_DIR keeps the kernel headers for mocking.
+KERNEL_INCLUDE_DIR  :=  $(KERNEL_DIR)/include
+KERNEL_DIR          :=  $(DEMO_COMMON_DIR)/Minimal
+
+CPPFLAGS            +=  -I$(DEMO_COMMON_DIR)/include
+CPPFLAGS            +=  -DportUSING_MPU_WRAPPERS=0
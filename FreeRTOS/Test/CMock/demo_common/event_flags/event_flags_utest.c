@@ -0,0 +1,410 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file event_flags_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* Event flags includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "task.h"
+#include "event_groups.h"
+#include "EventFlags.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "CException.h"
+
+/* Mock includes. */
+#include "mock_task.h"
+#include "mock_event_groups.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  DEFINES CONSTANTS  ========================== */
+#define BIT_0             ( 1 << 0 )
+#define BIT_1             ( 1 << 1 )
+#define BIT_2             ( 1 << 2 )
+
+/**
+ * @brief CException code for when a configASSERT should be intercepted.
+ */
+#define configASSERT_E    0xAA101
+
+/**
+ * @brief Expect a configASSERT from the function called.
+ *  Break out of the called function when this occurs.
+ * @details Use this macro when the call passed in as a parameter is expected
+ * to cause invalid memory access.
+ */
+#define EXPECT_ASSERT_BREAK( call )                  \
+    do                                               \
+    {                                                \
+        shouldAbortOnAssertion = true;               \
+        CEXCEPTION_T e = CEXCEPTION_NONE;            \
+        Try                                          \
+        {                                            \
+            call;                                    \
+            TEST_FAIL_MESSAGE( "Expected Assert!" ); \
+        }                                            \
+        Catch( e )                                   \
+        {                                            \
+            TEST_ASSERT_EQUAL( configASSERT_E, e );  \
+        }                                            \
+    } while( 0 )
+
+/* ===========================  GLOBAL VARIABLES  =========================== */
+static EventFlags_t xFlags;
+static TaskHandle_t xCurrentTask = ( TaskHandle_t ) 0x1000;
+static TaskHandle_t xOtherTask = ( TaskHandle_t ) 0x2000;
+static EventBits_t uxBitsSetWhileBlocked;
+static bool shouldAbortOnAssertion;
+static uint32_t assertionFailed;
+
+/* ===========================  EXTERN FUNCTIONS  =========================== */
+unsigned long ulGetRunTimeCounterValue( void )
+{
+    return 0;
+}
+
+/* ===========================  Static Functions  =========================== */
+
+static void vFakeAssertStub( bool x,
+                             char * file,
+                             int line,
+                             int cmock_num_calls )
+{
+    if( !x )
+    {
+        assertionFailed++;
+
+        if( shouldAbortOnAssertion == true )
+        {
+            Throw( configASSERT_E );
+        }
+    }
+}
+
+/*!
+ * @brief put a task in a waiter slot as xEventFlagsWait() would
+ */
+static void add_waiter( UBaseType_t uxSlot,
+                        TaskHandle_t xTask,
+                        EventBits_t uxBitsToWaitFor,
+                        BaseType_t xWaitForAllBits )
+{
+    xFlags.xWaiters[ uxSlot ].xTask = xTask;
+    xFlags.xWaiters[ uxSlot ].uxBitsToWaitFor = uxBitsToWaitFor;
+    xFlags.xWaiters[ uxSlot ].xWaitForAllBits = xWaitForAllBits;
+    xFlags.xWaiters[ uxSlot ].xNotified = pdFALSE;
+}
+
+/*!
+ * @brief stands in for the block in ulTaskNotifyTakeIndexed(); the calling task
+ *        must be registered in a waiter slot, then uxBitsSetWhileBlocked is set
+ *        as an interrupt would set it
+ */
+static uint32_t ulTaskGenericNotifyTake_SetBits( UBaseType_t uxIndexToWaitOn,
+                                                 BaseType_t xClearCountOnExit,
+                                                 TickType_t xTicksToWait,
+                                                 int cmock_num_calls )
+{
+    TEST_ASSERT_EQUAL( configEVENT_FLAGS_NOTIFY_INDEX, uxIndexToWaitOn );
+    TEST_ASSERT_EQUAL( pdTRUE, xClearCountOnExit );
+    TEST_ASSERT_EQUAL_PTR( xCurrentTask, xFlags.xWaiters[ 0 ].xTask );
+
+    xFlags.uxEventBits |= uxBitsSetWhileBlocked;
+    xFlags.xWaiters[ 0 ].xNotified = pdTRUE;
+
+    return 1;
+}
+
+/*!
+ * @brief as ulTaskGenericNotifyTake_SetBits(), but the first wake finds the bits
+ *        already cleared by another task
+ */
+static uint32_t ulTaskGenericNotifyTake_StaleThenSetBits( UBaseType_t uxIndexToWaitOn,
+                                                          BaseType_t xClearCountOnExit,
+                                                          TickType_t xTicksToWait,
+                                                          int cmock_num_calls )
+{
+    if( cmock_num_calls == 0 )
+    {
+        xFlags.xWaiters[ 0 ].xNotified = pdTRUE;
+    }
+    else
+    {
+        /* The task must have been made notifiable again. */
+        TEST_ASSERT_EQUAL( pdFALSE, xFlags.xWaiters[ 0 ].xNotified );
+        xFlags.uxEventBits |= uxBitsSetWhileBlocked;
+        xFlags.xWaiters[ 0 ].xNotified = pdTRUE;
+    }
+
+    return 1;
+}
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    vFakeAssert_StubWithCallback( vFakeAssertStub );
+    vFakePortEnterCriticalSection_Ignore();
+    vFakePortExitCriticalSection_Ignore();
+    ulFakePortSetInterruptMaskFromISR_IgnoreAndReturn( 0U );
+    vFakePortClearInterruptMaskFromISR_Ignore();
+    xTaskGetCurrentTaskHandle_IgnoreAndReturn( xCurrentTask );
+
+    shouldAbortOnAssertion = false;
+    assertionFailed = 0;
+    uxBitsSetWhileBlocked = 0;
+
+    vEventFlagsInit( &xFlags );
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    TEST_ASSERT_EQUAL( 0, assertionFailed );
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/*!
+ * @brief new event flags have no bits set and no waiting tasks
+ * @coverage vEventFlagsInit xEventFlagsGet
+ */
+void test_vEventFlagsInit_Success( void )
+{
+    UBaseType_t x;
+
+    TEST_ASSERT_EQUAL( 0, xEventFlagsGet( &xFlags ) );
+
+    for( x = 0; x < configEVENT_FLAGS_MAX_WAITERS; x++ )
+    {
+        TEST_ASSERT_NULL( xFlags.xWaiters[ x ].xTask );
+    }
+}
+
+/*!
+ * @brief the event flags and the bits waited for must be valid
+ * @coverage vEventFlagsInit xEventFlagsSet xEventFlagsSetFromISR xEventFlagsClear xEventFlagsGet xEventFlagsWait
+ */
+void test_EventFlags_InvalidArguments( void )
+{
+    EXPECT_ASSERT_BREAK( vEventFlagsInit( NULL ) );
+    EXPECT_ASSERT_BREAK( xEventFlagsSet( NULL, BIT_0 ) );
+    EXPECT_ASSERT_BREAK( xEventFlagsSetFromISR( NULL, BIT_0, NULL ) );
+    EXPECT_ASSERT_BREAK( xEventFlagsClear( NULL, BIT_0 ) );
+    EXPECT_ASSERT_BREAK( xEventFlagsGet( NULL ) );
+    EXPECT_ASSERT_BREAK( xEventFlagsWait( NULL, BIT_0, pdFALSE, pdFALSE, 0 ) );
+    EXPECT_ASSERT_BREAK( xEventFlagsWait( &xFlags, 0, pdFALSE, pdFALSE, 0 ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief setting bits with no task waiting notifies nobody
+ * @coverage xEventFlagsSet xEventFlagsClear
+ */
+void test_xEventFlagsSet_NoWaiters( void )
+{
+    TEST_ASSERT_EQUAL( BIT_0, xEventFlagsSet( &xFlags, BIT_0 ) );
+    TEST_ASSERT_EQUAL( BIT_0 | BIT_2, xEventFlagsSet( &xFlags, BIT_2 ) );
+
+    /* Clearing returns the bits as they were before the clear. */
+    TEST_ASSERT_EQUAL( BIT_0 | BIT_2, xEventFlagsClear( &xFlags, BIT_0 ) );
+    TEST_ASSERT_EQUAL( BIT_2, xEventFlagsGet( &xFlags ) );
+}
+
+/*!
+ * @brief a set notifies each waiting task whose condition it meets, once
+ * @coverage xEventFlagsSet
+ */
+void test_xEventFlagsSet_NotifiesWaitersWhoseConditionIsMet( void )
+{
+    add_waiter( 0, xCurrentTask, BIT_0 | BIT_1, pdFALSE );
+    add_waiter( 2, xOtherTask, BIT_0 | BIT_1, pdTRUE );
+
+    xTaskGenericNotify_ExpectAndReturn( xCurrentTask, configEVENT_FLAGS_NOTIFY_INDEX, 0, eIncrement, NULL, pdPASS );
+    ( void ) xEventFlagsSet( &xFlags, BIT_0 );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xFlags.xWaiters[ 0 ].xNotified );
+    TEST_ASSERT_EQUAL( pdFALSE, xFlags.xWaiters[ 2 ].xNotified );
+
+    /* The first task has already been notified, so only the second, now that
+     * all its bits are set. */
+    xTaskGenericNotify_ExpectAndReturn( xOtherTask, configEVENT_FLAGS_NOTIFY_INDEX, 0, eIncrement, NULL, pdPASS );
+    ( void ) xEventFlagsSet( &xFlags, BIT_1 );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xFlags.xWaiters[ 2 ].xNotified );
+}
+
+/*!
+ * @brief a set from an interrupt notifies waiting tasks directly
+ * @coverage xEventFlagsSetFromISR
+ */
+void test_xEventFlagsSetFromISR_NotifiesWaiterDirectly( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    add_waiter( 1, xCurrentTask, BIT_2, pdFALSE );
+
+    /* Bits nobody waits for do not notify. */
+    TEST_ASSERT_EQUAL( BIT_0, xEventFlagsSetFromISR( &xFlags, BIT_0, &xHigherPriorityTaskWoken ) );
+
+    vTaskGenericNotifyGiveFromISR_Expect( xCurrentTask, configEVENT_FLAGS_NOTIFY_INDEX, &xHigherPriorityTaskWoken );
+    TEST_ASSERT_EQUAL( BIT_0 | BIT_2, xEventFlagsSetFromISR( &xFlags, BIT_2, &xHigherPriorityTaskWoken ) );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xFlags.xWaiters[ 1 ].xNotified );
+}
+
+/*!
+ * @brief a wait whose condition is already met returns without blocking
+ * @coverage xEventFlagsWait
+ */
+void test_xEventFlagsWait_AlreadySet( void )
+{
+    vTaskSetTimeOutState_Ignore();
+
+    ( void ) xEventFlagsSet( &xFlags, BIT_0 | BIT_1 );
+
+    TEST_ASSERT_EQUAL( BIT_0 | BIT_1, xEventFlagsWait( &xFlags, BIT_0, pdFALSE, pdFALSE, portMAX_DELAY ) );
+    TEST_ASSERT_EQUAL( BIT_0 | BIT_1, xEventFlagsGet( &xFlags ) );
+
+    TEST_ASSERT_EQUAL( BIT_0 | BIT_1, xEventFlagsWait( &xFlags, BIT_0 | BIT_1, pdTRUE, pdTRUE, portMAX_DELAY ) );
+    TEST_ASSERT_EQUAL( 0, xEventFlagsGet( &xFlags ) );
+    TEST_ASSERT_NULL( xFlags.xWaiters[ 0 ].xTask );
+}
+
+/*!
+ * @brief a wait that times out returns the current bits and frees its slot
+ * @coverage xEventFlagsWait
+ */
+void test_xEventFlagsWait_Timeout( void )
+{
+    vTaskSetTimeOutState_Ignore();
+    ( void ) xEventFlagsSet( &xFlags, BIT_1 );
+
+    /* Without blocking. */
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdTRUE );
+    TEST_ASSERT_EQUAL( BIT_1, xEventFlagsWait( &xFlags, BIT_0, pdTRUE, pdFALSE, 0 ) );
+    TEST_ASSERT_NULL( xFlags.xWaiters[ 0 ].xTask );
+
+    /* After blocking. */
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdFALSE );
+    ulTaskGenericNotifyTake_ExpectAndReturn( configEVENT_FLAGS_NOTIFY_INDEX, pdTRUE, 10, 0 );
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdTRUE );
+    TEST_ASSERT_EQUAL( BIT_1, xEventFlagsWait( &xFlags, BIT_0 | BIT_1, pdTRUE, pdTRUE, 10 ) );
+    TEST_ASSERT_NULL( xFlags.xWaiters[ 0 ].xTask );
+    TEST_ASSERT_EQUAL( BIT_1, xEventFlagsGet( &xFlags ) );
+}
+
+/*!
+ * @brief a task that blocks is woken when the bits are set and clears them on exit
+ * @coverage xEventFlagsWait
+ */
+void test_xEventFlagsWait_BlocksUntilSet( void )
+{
+    vTaskSetTimeOutState_Ignore();
+    uxBitsSetWhileBlocked = BIT_0 | BIT_2;
+
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdFALSE );
+    ulTaskGenericNotifyTake_Stub( ulTaskGenericNotifyTake_SetBits );
+
+    TEST_ASSERT_EQUAL( BIT_0 | BIT_2, xEventFlagsWait( &xFlags, BIT_0 | BIT_2, pdTRUE, pdTRUE, portMAX_DELAY ) );
+    TEST_ASSERT_EQUAL( 0, xEventFlagsGet( &xFlags ) );
+    TEST_ASSERT_NULL( xFlags.xWaiters[ 0 ].xTask );
+}
+
+/*!
+ * @brief a task woken after another task cleared the bits waits again
+ * @coverage xEventFlagsWait
+ */
+void test_xEventFlagsWait_WokenButBitsCleared( void )
+{
+    vTaskSetTimeOutState_Ignore();
+    uxBitsSetWhileBlocked = BIT_1;
+
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdFALSE );
+    ulTaskGenericNotifyTake_Stub( ulTaskGenericNotifyTake_StaleThenSetBits );
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdFALSE );
+
+    TEST_ASSERT_EQUAL( BIT_1, xEventFlagsWait( &xFlags, BIT_1, pdFALSE, pdFALSE, portMAX_DELAY ) );
+    TEST_ASSERT_EQUAL( BIT_1, xEventFlagsGet( &xFlags ) );
+    TEST_ASSERT_NULL( xFlags.xWaiters[ 0 ].xTask );
+}
+
+/*!
+ * @brief waiting when every waiter slot is in use asserts and returns
+ * @coverage xEventFlagsWait
+ */
+void test_xEventFlagsWait_TooManyWaiters( void )
+{
+    UBaseType_t x;
+
+    vTaskSetTimeOutState_Ignore();
+
+    for( x = 0; x < configEVENT_FLAGS_MAX_WAITERS; x++ )
+    {
+        add_waiter( x, xOtherTask, BIT_2, pdFALSE );
+    }
+
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdFALSE );
+    TEST_ASSERT_EQUAL( 0, xEventFlagsWait( &xFlags, BIT_0, pdFALSE, pdFALSE, portMAX_DELAY ) );
+
+    TEST_ASSERT_EQUAL( 1, assertionFailed );
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief the demo creates its tasks, and reports an error if they stop running
+ * @coverage vStartEventFlagsTasks xAreEventFlagsTasksStillRunning
+ */
+void test_vStartEventFlagsTasks_Success( void )
+{
+    xEventGroupCreate_ExpectAndReturn( ( EventGroupHandle_t ) 0x3000 );
+    xTaskCreate_ExpectAnyArgsAndReturn( pdPASS );
+    xTaskCreate_ExpectAnyArgsAndReturn( pdPASS );
+    xTaskCreate_ExpectAnyArgsAndReturn( pdPASS );
+
+    vStartEventFlagsTasks();
+
+    /* No task has run, so no cycles have been counted. */
+    TEST_ASSERT_EQUAL( pdFAIL, xAreEventFlagsTasksStillRunning() );
+}
@@ -0,0 +1,402 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file pairing_heap_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* Pairing heap includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "PairingHeap.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "CException.h"
+
+/* Mock includes. */
+#include "mock_fake_assert.h"
+
+/* ===========================  DEFINES CONSTANTS  ========================== */
+#define MAX_ITEMS    5000 /*!< number of items for a few testcases*/
+
+/**
+ * @brief CException code for when a configASSERT should be intercepted.
+ */
+#define configASSERT_E    0xAA101
+
+/**
+ * @brief Expect a configASSERT from the function called.
+ *  Break out of the called function when this occurs.
+ * @details Use this macro when the call passed in as a parameter is expected
+ * to cause invalid memory access.
+ */
+#define EXPECT_ASSERT_BREAK( call )                  \
+    do                                               \
+    {                                                \
+        shouldAbortOnAssertion = true;               \
+        CEXCEPTION_T e = CEXCEPTION_NONE;            \
+        Try                                          \
+        {                                            \
+            call;                                    \
+            TEST_FAIL_MESSAGE( "Expected Assert!" ); \
+        }                                            \
+        Catch( e )                                   \
+        {                                            \
+            TEST_ASSERT_EQUAL( configASSERT_E, e );  \
+        }                                            \
+    } while( 0 )
+
+/* ===========================  GLOBAL VARIABLES  =========================== */
+static PairingHeap_t xHeap;
+static PairingHeapItem_t xItems[ MAX_ITEMS ];
+static bool shouldAbortOnAssertion;
+static uint32_t assertionFailed;
+
+/* ===========================  Static Functions  =========================== */
+
+static void vFakeAssertStub( bool x,
+                             char * file,
+                             int line,
+                             int cmock_num_calls )
+{
+    if( !x )
+    {
+        assertionFailed++;
+
+        if( shouldAbortOnAssertion == true )
+        {
+            Throw( configASSERT_E );
+        }
+    }
+}
+
+/*!
+ * @brief initialize count items, owned by their index, with the given values
+ * @param values item values, or NULL to use pseudo random values
+ * @param count the number of items
+ */
+static void initialise_items( const TickType_t * values,
+                              int count )
+{
+    uint32_t seed = 0x12345678;
+
+    for( int i = 0; i < count; i++ )
+    {
+        seed = ( seed * 1103515245U ) + 12345U;
+        vPairingHeapInitialiseItem( &xItems[ i ] );
+        phSET_ITEM_OWNER( &xItems[ i ], ( void * ) ( uintptr_t ) i );
+        phSET_ITEM_VALUE( &xItems[ i ], ( values != NULL ) ? values[ i ] : ( TickType_t ) ( ( seed >> 8 ) % 1000U ) );
+    }
+}
+
+/*!
+ * @brief remove every item from the head of the heap, checking that they come
+ *        out in value order and, for equal values, in insertion order
+ * @param count the number of items expected
+ */
+static void drain_and_validate( int count )
+{
+    PairingHeapItem_t * pxHead;
+    PairingHeapItem_t * pxPrevious = NULL;
+
+    for( int i = 0; i < count; i++ )
+    {
+        TEST_ASSERT_EQUAL( pdFALSE, phIS_EMPTY( &xHeap ) );
+        pxHead = phGET_HEAD_ENTRY( &xHeap );
+
+        if( pxPrevious != NULL )
+        {
+            TEST_ASSERT_TRUE( phGET_ITEM_VALUE( pxPrevious ) <= phGET_ITEM_VALUE( pxHead ) );
+
+            if( phGET_ITEM_VALUE( pxPrevious ) == phGET_ITEM_VALUE( pxHead ) )
+            {
+                TEST_ASSERT_TRUE( ( pxHead->uxInsertOrder - pxPrevious->uxInsertOrder ) <= ( ( ( UBaseType_t ) ~( UBaseType_t ) 0U ) >> 1 ) );
+            }
+        }
+
+        TEST_ASSERT_EQUAL( ( UBaseType_t ) ( count - i - 1 ), uxPairingHeapRemove( pxHead ) );
+        TEST_ASSERT_NULL( phGET_HEAP_ITEM_CONTAINER( pxHead ) );
+        pxPrevious = pxHead;
+    }
+
+    TEST_ASSERT_EQUAL( pdTRUE, phIS_EMPTY( &xHeap ) );
+    TEST_ASSERT_NULL( phGET_HEAD_ENTRY( &xHeap ) );
+}
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    vFakeAssert_StubWithCallback( vFakeAssertStub );
+
+    shouldAbortOnAssertion = false;
+    assertionFailed = 0;
+
+    vPairingHeapInitialise( &xHeap );
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    TEST_ASSERT_EQUAL( 0, assertionFailed );
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/*!
+ * @brief validate the initialization functions of a heap and of an item
+ * @coverage vPairingHeapInitialise vPairingHeapInitialiseItem
+ */
+void test_vPairingHeapInitialise_Success( void )
+{
+    PairingHeapItem_t xItem;
+
+    TEST_ASSERT_EQUAL( pdTRUE, phIS_EMPTY( &xHeap ) );
+    TEST_ASSERT_EQUAL( 0U, phCURRENT_HEAP_LENGTH( &xHeap ) );
+    TEST_ASSERT_NULL( phGET_HEAD_ENTRY( &xHeap ) );
+
+    vPairingHeapInitialiseItem( &xItem );
+    TEST_ASSERT_NULL( phGET_HEAP_ITEM_CONTAINER( &xItem ) );
+}
+
+/*!
+ * @brief the heap, items and containers must be valid
+ * @coverage vPairingHeapInitialise vPairingHeapInitialiseItem vPairingHeapInsert uxPairingHeapRemove
+ */
+void test_PairingHeap_InvalidArguments( void )
+{
+    initialise_items( NULL, 1 );
+
+    EXPECT_ASSERT_BREAK( vPairingHeapInitialise( NULL ) );
+    EXPECT_ASSERT_BREAK( vPairingHeapInitialiseItem( NULL ) );
+    EXPECT_ASSERT_BREAK( vPairingHeapInsert( NULL, &xItems[ 0 ] ) );
+    EXPECT_ASSERT_BREAK( vPairingHeapInsert( &xHeap, NULL ) );
+    EXPECT_ASSERT_BREAK( uxPairingHeapRemove( NULL ) );
+
+    /* Not in a heap. */
+    EXPECT_ASSERT_BREAK( uxPairingHeapRemove( &xItems[ 0 ] ) );
+
+    /* Already in a heap. */
+    vPairingHeapInsert( &xHeap, &xItems[ 0 ] );
+    EXPECT_ASSERT_BREAK( vPairingHeapInsert( &xHeap, &xItems[ 0 ] ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief a single item is the head until it is removed
+ * @coverage vPairingHeapInsert uxPairingHeapRemove
+ */
+void test_vPairingHeapInsert_Success_1_item( void )
+{
+    initialise_items( NULL, 1 );
+
+    vPairingHeapInsert( &xHeap, &xItems[ 0 ] );
+
+    TEST_ASSERT_EQUAL( 1U, phCURRENT_HEAP_LENGTH( &xHeap ) );
+    TEST_ASSERT_EQUAL_PTR( &xItems[ 0 ], phGET_HEAD_ENTRY( &xHeap ) );
+    TEST_ASSERT_EQUAL_PTR( ( void * ) 0, phGET_OWNER_OF_HEAD_ENTRY( &xHeap ) );
+    TEST_ASSERT_EQUAL( phGET_ITEM_VALUE( &xItems[ 0 ] ), phGET_ITEM_VALUE_OF_HEAD_ENTRY( &xHeap ) );
+    TEST_ASSERT_EQUAL( pdTRUE, phIS_CONTAINED_WITHIN( &xHeap, &xItems[ 0 ] ) );
+
+    TEST_ASSERT_EQUAL( 0U, uxPairingHeapRemove( &xItems[ 0 ] ) );
+    TEST_ASSERT_EQUAL( pdFALSE, phIS_CONTAINED_WITHIN( &xHeap, &xItems[ 0 ] ) );
+    TEST_ASSERT_EQUAL( pdTRUE, phIS_EMPTY( &xHeap ) );
+}
+
+/*!
+ * @brief items inserted in ascending, descending and random order come out sorted
+ * @coverage vPairingHeapInsert uxPairingHeapRemove
+ */
+void test_vPairingHeapInsert_Success_ordering( void )
+{
+    TickType_t xValues[ 8 ];
+    int i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        xValues[ i ] = ( TickType_t ) i;
+    }
+
+    initialise_items( xValues, 8 );
+
+    for( i = 0; i < 8; i++ )
+    {
+        vPairingHeapInsert( &xHeap, &xItems[ i ] );
+    }
+
+    drain_and_validate( 8 );
+
+    for( i = 7; i >= 0; i-- )
+    {
+        vPairingHeapInsert( &xHeap, &xItems[ i ] );
+    }
+
+    drain_and_validate( 8 );
+
+    initialise_items( NULL, MAX_ITEMS );
+
+    for( i = 0; i < MAX_ITEMS; i++ )
+    {
+        vPairingHeapInsert( &xHeap, &xItems[ i ] );
+    }
+
+    TEST_ASSERT_EQUAL( MAX_ITEMS, phCURRENT_HEAP_LENGTH( &xHeap ) );
+    drain_and_validate( MAX_ITEMS );
+}
+
+/*!
+ * @brief items with equal values come out in the order they were inserted, as
+ *        they do from a list filled by vListInsert()
+ * @coverage vPairingHeapInsert uxPairingHeapRemove
+ */
+void test_vPairingHeapInsert_Success_equal_values_fifo( void )
+{
+    TickType_t xValues[ 6 ] = { 5, 5, 3, 5, 3, 5 };
+    int xExpectedOrder[ 6 ] = { 2, 4, 0, 1, 3, 5 };
+    int i;
+
+    initialise_items( xValues, 6 );
+
+    for( i = 0; i < 6; i++ )
+    {
+        vPairingHeapInsert( &xHeap, &xItems[ i ] );
+    }
+
+    for( i = 0; i < 6; i++ )
+    {
+        TEST_ASSERT_EQUAL_PTR( ( void * ) ( uintptr_t ) xExpectedOrder[ i ], phGET_OWNER_OF_HEAD_ENTRY( &xHeap ) );
+        ( void ) uxPairingHeapRemove( phGET_HEAD_ENTRY( &xHeap ) );
+    }
+}
+
+/*!
+ * @brief insertion order still breaks ties after the insert counter wraps
+ * @coverage vPairingHeapInsert uxPairingHeapRemove
+ */
+void test_vPairingHeapInsert_Success_insert_order_overflow( void )
+{
+    int i;
+
+    xHeap.uxNextInsertOrder = ( ( UBaseType_t ) ~( UBaseType_t ) 0U ) - 2U;
+    initialise_items( NULL, 6 );
+
+    for( i = 0; i < 6; i++ )
+    {
+        phSET_ITEM_VALUE( &xItems[ i ], 10 );
+        vPairingHeapInsert( &xHeap, &xItems[ i ] );
+    }
+
+    for( i = 0; i < 6; i++ )
+    {
+        TEST_ASSERT_EQUAL_PTR( ( void * ) ( uintptr_t ) i, phGET_OWNER_OF_HEAD_ENTRY( &xHeap ) );
+        ( void ) uxPairingHeapRemove( phGET_HEAD_ENTRY( &xHeap ) );
+    }
+}
+
+/*!
+ * @brief items can be removed from anywhere in the heap, as an event list item
+ *        is when its task's timeout expires
+ * @coverage uxPairingHeapRemove
+ */
+void test_uxPairingHeapRemove_Success_arbitrary_items( void )
+{
+    int i, xRemaining = MAX_ITEMS;
+
+    initialise_items( NULL, MAX_ITEMS );
+
+    for( i = 0; i < MAX_ITEMS; i++ )
+    {
+        vPairingHeapInsert( &xHeap, &xItems[ i ] );
+    }
+
+    /* Settle the heap into a multi level shape, then put the item back. */
+    ( void ) uxPairingHeapRemove( &xItems[ 0 ] );
+    vPairingHeapInsert( &xHeap, &xItems[ 0 ] );
+
+    for( i = 0; i < MAX_ITEMS; i += 3 )
+    {
+        xRemaining--;
+        TEST_ASSERT_EQUAL( ( UBaseType_t ) xRemaining, uxPairingHeapRemove( &xItems[ i ] ) );
+        TEST_ASSERT_EQUAL( pdFALSE, phIS_CONTAINED_WITHIN( &xHeap, &xItems[ i ] ) );
+    }
+
+    drain_and_validate( xRemaining );
+}
+
+/*!
+ * @brief interleaved inserts and removes keep the heap ordered, as blocking and
+ *        unblocking tasks do
+ * @coverage vPairingHeapInsert uxPairingHeapRemove
+ */
+void test_PairingHeap_Success_interleaved( void )
+{
+    uint32_t seed = 1;
+    int i, j;
+
+    initialise_items( NULL, MAX_ITEMS );
+
+    for( i = 0; i < MAX_ITEMS; i++ )
+    {
+        vPairingHeapInsert( &xHeap, &xItems[ i ] );
+    }
+
+    for( i = 0; i < ( MAX_ITEMS * 4 ); i++ )
+    {
+        seed = ( seed * 1103515245U ) + 12345U;
+        j = ( int ) ( ( seed >> 8 ) % MAX_ITEMS );
+
+        ( void ) uxPairingHeapRemove( &xItems[ j ] );
+        phSET_ITEM_VALUE( &xItems[ j ], ( TickType_t ) ( seed % 1000U ) );
+        vPairingHeapInsert( &xHeap, &xItems[ j ] );
+
+        if( ( i % 7 ) == 0 )
+        {
+            /* Wake the task at the head, then block it again. */
+            PairingHeapItem_t * pxHead = phGET_HEAD_ENTRY( &xHeap );
+            TickType_t xHeadValue = phGET_ITEM_VALUE( pxHead );
+
+            ( void ) uxPairingHeapRemove( pxHead );
+            TEST_ASSERT_TRUE( xHeadValue <= phGET_ITEM_VALUE_OF_HEAD_ENTRY( &xHeap ) );
+            vPairingHeapInsert( &xHeap, pxHead );
+        }
+    }
+
+    drain_and_validate( MAX_ITEMS );
+}
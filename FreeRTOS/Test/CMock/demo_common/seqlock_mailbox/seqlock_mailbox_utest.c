@@ -0,0 +1,398 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file seqlock_mailbox_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Seqlock mailbox includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "task.h"
+#include "SeqLockMailbox.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "CException.h"
+
+/* Mock includes. */
+#include "mock_task.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  DEFINES CONSTANTS  ========================== */
+#define ITEM_WORDS           8
+
+/**
+ * @brief CException code for when a configASSERT should be intercepted.
+ */
+#define configASSERT_E       0xAA101
+
+/**
+ * @brief Expect a configASSERT from the function called.
+ *  Break out of the called function when this occurs.
+ * @details Use this macro when the call passed in as a parameter is expected
+ * to cause invalid memory access.
+ */
+#define EXPECT_ASSERT_BREAK( call )                  \
+    do                                               \
+    {                                                \
+        shouldAbortOnAssertion = true;               \
+        CEXCEPTION_T e = CEXCEPTION_NONE;            \
+        Try                                          \
+        {                                            \
+            call;                                    \
+            TEST_FAIL_MESSAGE( "Expected Assert!" ); \
+        }                                            \
+        Catch( e )                                   \
+        {                                            \
+            TEST_ASSERT_EQUAL( configASSERT_E, e );  \
+        }                                            \
+    } while( 0 )
+
+/* ===========================  TYPES  =========================== */
+typedef struct TestItem
+{
+    uint32_t ulWords[ ITEM_WORDS ];
+} TestItem_t;
+
+/* ===========================  GLOBAL VARIABLES  =========================== */
+static SeqLockMailbox_t xMailbox;
+static uint8_t ucStorage[ seqlockMAILBOX_STORAGE_SIZE( sizeof( TestItem_t ) ) ];
+
+/* Barrier hook state: at barrier number lBarrierToInterrupt, lWritesToInject
+ * writes are made, or a read is made if xReadInBarrier is set. */
+static int lBarrierToInterrupt;
+static int lWritesToInject;
+static bool xReadInBarrier;
+static bool xInBarrierHook;
+static BaseType_t xInjectedReadResult;
+static UBaseType_t uxInjectedReadSequence;
+static TestItem_t xInjectedReadItem;
+
+static bool shouldAbortOnAssertion;
+static uint32_t assertionFailed;
+
+/* ===========================  EXTERN FUNCTIONS  =========================== */
+unsigned long ulGetRunTimeCounterValue( void )
+{
+    return 0;
+}
+
+/* ===========================  Static Functions  =========================== */
+
+static void vFakeAssertStub( bool x,
+                             char * file,
+                             int line,
+                             int cmock_num_calls )
+{
+    if( !x )
+    {
+        assertionFailed++;
+
+        if( shouldAbortOnAssertion == true )
+        {
+            Throw( configASSERT_E );
+        }
+    }
+}
+
+/*!
+ * @brief fill every word of an item with ulValue
+ */
+static void fill_item( TestItem_t * pxItem,
+                       uint32_t ulValue )
+{
+    int i;
+
+    for( i = 0; i < ITEM_WORDS; i++ )
+    {
+        pxItem->ulWords[ i ] = ulValue;
+    }
+}
+
+/*!
+ * @brief write an item with every word set to ulValue
+ */
+static void write_value( uint32_t ulValue )
+{
+    TestItem_t xItem;
+
+    fill_item( &xItem, ulValue );
+    vSeqLockMailboxWrite( &xMailbox, &xItem );
+}
+
+/*!
+ * @brief assert every word of an item is ulValue
+ */
+static void assert_item( const TestItem_t * pxItem,
+                         uint32_t ulValue )
+{
+    int i;
+
+    for( i = 0; i < ITEM_WORDS; i++ )
+    {
+        TEST_ASSERT_EQUAL( ulValue, pxItem->ulWords[ i ] );
+    }
+}
+
+/*!
+ * @brief stands in for the memory barrier, and at the chosen barrier acts as a
+ *        writer or reader that interrupts the call in progress
+ */
+static void vFakePortMemoryBarrier_Interrupt( int cmock_num_calls )
+{
+    int i;
+
+    if( ( xInBarrierHook == false ) && ( cmock_num_calls == lBarrierToInterrupt ) )
+    {
+        xInBarrierHook = true;
+
+        if( xReadInBarrier == true )
+        {
+            xInjectedReadResult = xSeqLockMailboxRead( &xMailbox, &xInjectedReadItem, &uxInjectedReadSequence );
+        }
+
+        for( i = 0; i < lWritesToInject; i++ )
+        {
+            write_value( 0x100U + ( uint32_t ) i );
+        }
+
+        xInBarrierHook = false;
+    }
+}
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    vFakeAssert_StubWithCallback( vFakeAssertStub );
+    vFakePortMemoryBarrier_Ignore();
+
+    lBarrierToInterrupt = -1;
+    lWritesToInject = 0;
+    xReadInBarrier = false;
+    xInBarrierHook = false;
+    xInjectedReadResult = pdFALSE;
+    uxInjectedReadSequence = 0;
+
+    shouldAbortOnAssertion = false;
+    assertionFailed = 0;
+
+    memset( ucStorage, 0, sizeof( ucStorage ) );
+    vSeqLockMailboxInit( &xMailbox, ucStorage, sizeof( TestItem_t ) );
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    TEST_ASSERT_EQUAL( 0, assertionFailed );
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ===========================  Test Cases  =========================== */
+
+/*!
+ * @brief a mailbox needs somewhere to keep items of a non zero size
+ */
+void test_vSeqLockMailboxInit_invalid_parameters( void )
+{
+    EXPECT_ASSERT_BREAK( vSeqLockMailboxInit( NULL, ucStorage, sizeof( TestItem_t ) ) );
+    EXPECT_ASSERT_BREAK( vSeqLockMailboxInit( &xMailbox, NULL, sizeof( TestItem_t ) ) );
+    EXPECT_ASSERT_BREAK( vSeqLockMailboxInit( &xMailbox, ucStorage, 0 ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief reading a mailbox that has never been written fails and leaves the
+ *        buffer untouched
+ */
+void test_xSeqLockMailboxRead_empty( void )
+{
+    TestItem_t xItem;
+    UBaseType_t uxSequence = 0x55;
+
+    fill_item( &xItem, 0xA5A5A5A5U );
+
+    TEST_ASSERT_EQUAL( pdFALSE, xSeqLockMailboxRead( &xMailbox, &xItem, &uxSequence ) );
+    assert_item( &xItem, 0xA5A5A5A5U );
+    TEST_ASSERT_EQUAL( 0x55, uxSequence );
+}
+
+/*!
+ * @brief a read returns the last value written, and how many writes there
+ *        have been, without removing it
+ */
+void test_xSeqLockMailboxRead_latest_value( void )
+{
+    TestItem_t xItem;
+    UBaseType_t uxSequence;
+
+    write_value( 1 );
+    write_value( 2 );
+    write_value( 3 );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSeqLockMailboxRead( &xMailbox, &xItem, &uxSequence ) );
+    assert_item( &xItem, 3 );
+    TEST_ASSERT_EQUAL( 3, uxSequence );
+
+    fill_item( &xItem, 0 );
+    TEST_ASSERT_EQUAL( pdTRUE, xSeqLockMailboxRead( &xMailbox, &xItem, NULL ) );
+    assert_item( &xItem, 3 );
+}
+
+/*!
+ * @brief each write fills the copy readers are not directed to
+ */
+void test_vSeqLockMailboxWrite_alternates_copies( void )
+{
+    TestItem_t * pxCopies = ( TestItem_t * ) ucStorage;
+
+    write_value( 1 );
+    assert_item( &pxCopies[ 1 ], 1 );
+    assert_item( &pxCopies[ 0 ], 0 );
+
+    write_value( 2 );
+    assert_item( &pxCopies[ 0 ], 2 );
+    assert_item( &pxCopies[ 1 ], 1 );
+}
+
+/*!
+ * @brief writes and reads need a mailbox and an item
+ */
+void test_invalid_parameters( void )
+{
+    TestItem_t xItem;
+
+    EXPECT_ASSERT_BREAK( vSeqLockMailboxWrite( NULL, &xItem ) );
+    EXPECT_ASSERT_BREAK( vSeqLockMailboxWrite( &xMailbox, NULL ) );
+    EXPECT_ASSERT_BREAK( xSeqLockMailboxRead( NULL, &xItem, NULL ) );
+    EXPECT_ASSERT_BREAK( xSeqLockMailboxRead( &xMailbox, NULL, NULL ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief a read interrupted part way through a write returns the value
+ *        before the one being written
+ */
+void test_read_during_write_returns_previous_value( void )
+{
+    TestItem_t xItem;
+    UBaseType_t uxSequence;
+
+    write_value( 1 );
+
+    /* The write's only barrier comes after the new value is copied in, but
+     * before it is published. */
+    vFakePortMemoryBarrier_Stub( vFakePortMemoryBarrier_Interrupt );
+    lBarrierToInterrupt = 0;
+    xReadInBarrier = true;
+    write_value( 2 );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xInjectedReadResult );
+    assert_item( &xInjectedReadItem, 1 );
+    TEST_ASSERT_EQUAL( 1, uxInjectedReadSequence );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSeqLockMailboxRead( &xMailbox, &xItem, &uxSequence ) );
+    assert_item( &xItem, 2 );
+    TEST_ASSERT_EQUAL( 2, uxSequence );
+}
+
+/*!
+ * @brief a read that a write completes part way through copies the value
+ *        again
+ */
+void test_write_during_read_retries( void )
+{
+    TestItem_t xItem;
+    UBaseType_t uxSequence;
+
+    write_value( 1 );
+
+    /* The read's second barrier comes after the value has been copied. */
+    vFakePortMemoryBarrier_Stub( vFakePortMemoryBarrier_Interrupt );
+    lBarrierToInterrupt = 1;
+    lWritesToInject = 1;
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSeqLockMailboxRead( &xMailbox, &xItem, &uxSequence ) );
+    assert_item( &xItem, 0x100 );
+    TEST_ASSERT_EQUAL( 2, uxSequence );
+}
+
+/*!
+ * @brief a read that two writes complete part way through, the second of
+ *        which overwrites the copy being read, copies the value again
+ */
+void test_two_writes_during_read_retries( void )
+{
+    TestItem_t xItem;
+    UBaseType_t uxSequence;
+
+    write_value( 1 );
+
+    vFakePortMemoryBarrier_Stub( vFakePortMemoryBarrier_Interrupt );
+    lBarrierToInterrupt = 1;
+    lWritesToInject = 2;
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSeqLockMailboxRead( &xMailbox, &xItem, &uxSequence ) );
+    assert_item( &xItem, 0x101 );
+    TEST_ASSERT_EQUAL( 3, uxSequence );
+}
+
+/*!
+ * @brief the sequence number skips 0 when it wraps, so the mailbox never
+ *        appears empty again, and the copies keep alternating
+ */
+void test_sequence_wraps( void )
+{
+    TestItem_t * pxCopies = ( TestItem_t * ) ucStorage;
+    TestItem_t xItem;
+    UBaseType_t uxSequence;
+
+    xMailbox.uxSequence = ( UBaseType_t ) ~( UBaseType_t ) 0;
+    write_value( 7 );
+
+    TEST_ASSERT_EQUAL( 2, xMailbox.uxSequence );
+    assert_item( &pxCopies[ 0 ], 7 );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSeqLockMailboxRead( &xMailbox, &xItem, &uxSequence ) );
+    assert_item( &xItem, 7 );
+    TEST_ASSERT_EQUAL( 2, uxSequence );
+}
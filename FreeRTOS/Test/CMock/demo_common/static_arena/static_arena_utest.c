@@ -0,0 +1,464 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file static_arena_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* Static arena includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "event_groups.h"
+#include "StaticArena.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "CException.h"
+
+/* Mock includes. */
+#include "mock_task.h"
+#include "mock_queue.h"
+#include "mock_timers.h"
+#include "mock_event_groups.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  DEFINES CONSTANTS  ========================== */
+#define ALIGN_UP( x )        ( ( ( size_t ) ( x ) + configSTATIC_ARENA_ALIGNMENT - 1 ) & ~( ( size_t ) configSTATIC_ARENA_ALIGNMENT - 1 ) )
+#define TASK_SLOT            ALIGN_UP( sizeof( StaticTask_t ) )
+#define QUEUE_SLOT           ALIGN_UP( sizeof( StaticQueue_t ) )
+#define SEMAPHORE_SLOT       ALIGN_UP( sizeof( StaticSemaphore_t ) )
+#define TIMER_SLOT           ALIGN_UP( sizeof( StaticTimer_t ) )
+#define EVENT_GROUP_SLOT     ALIGN_UP( sizeof( StaticEventGroup_t ) )
+
+/* Each task takes a third of configSTATIC_ARENA_STACK_WORDS, which the
+ * Makefile sets to a multiple of the alignment. */
+#define STACK_DEPTH          ( ( configSTACK_DEPTH_TYPE ) ( configSTATIC_ARENA_STACK_WORDS / configSTATIC_ARENA_TASKS ) )
+#define TASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+
+/**
+ * @brief CException code for when a configASSERT should be intercepted.
+ */
+#define configASSERT_E       0xAA101
+
+/**
+ * @brief Expect a configASSERT from the function called.
+ *  Break out of the called function when this occurs.
+ * @details Use this macro when the call passed in as a parameter is expected
+ * to cause invalid memory access.
+ */
+#define EXPECT_ASSERT_BREAK( call )                  \
+    do                                               \
+    {                                                \
+        shouldAbortOnAssertion = true;               \
+        CEXCEPTION_T e = CEXCEPTION_NONE;            \
+        Try                                          \
+        {                                            \
+            call;                                    \
+            TEST_FAIL_MESSAGE( "Expected Assert!" ); \
+        }                                            \
+        Catch( e )                                   \
+        {                                            \
+            TEST_ASSERT_EQUAL( configASSERT_E, e );  \
+        }                                            \
+    } while( 0 )
+
+/* ===========================  GLOBAL VARIABLES  =========================== */
+
+/* The buffers passed to the last create call. */
+static void * pvLastObject;
+static void * pvLastStorage;
+static int taskCreateCalls;
+static bool shouldAbortOnAssertion;
+static uint32_t assertionFailed;
+
+/* ===========================  Static Functions  =========================== */
+
+static void vFakeAssertStub( bool x,
+                             char * file,
+                             int line,
+                             int cmock_num_calls )
+{
+    if( !x )
+    {
+        assertionFailed++;
+
+        if( shouldAbortOnAssertion == true )
+        {
+            Throw( configASSERT_E );
+        }
+    }
+}
+
+/*!
+ * @brief true if pv starts on an arena alignment boundary
+ */
+static bool is_aligned( const void * pv )
+{
+    return ( ( ( uintptr_t ) pv ) & ( configSTATIC_ARENA_ALIGNMENT - 1 ) ) == 0;
+}
+
+/*!
+ * @brief the task and timer functions given to the create calls
+ */
+static void dummy_task( void * pvParameters )
+{
+    ( void ) pvParameters;
+}
+
+static void dummy_timer_callback( TimerHandle_t xTimer )
+{
+    ( void ) xTimer;
+}
+
+/*!
+ * @brief records the buffers given to the task and returns the TCB as the handle
+ */
+static TaskHandle_t xTaskCreateStatic_Record( TaskFunction_t pxTaskCode,
+                                              const char * const pcName,
+                                              const uint32_t ulStackDepth,
+                                              void * const pvParameters,
+                                              UBaseType_t uxPriority,
+                                              StackType_t * const puxStackBuffer,
+                                              StaticTask_t * const pxTaskBuffer,
+                                              int cmock_num_calls )
+{
+    TEST_ASSERT_EQUAL_PTR( dummy_task, pxTaskCode );
+    TEST_ASSERT_EQUAL_STRING( "Arena", pcName );
+    TEST_ASSERT_EQUAL( STACK_DEPTH, ulStackDepth );
+    TEST_ASSERT_EQUAL( TASK_PRIORITY, uxPriority );
+    TEST_ASSERT_NOT_NULL( puxStackBuffer );
+    TEST_ASSERT_NOT_NULL( pxTaskBuffer );
+
+    pvLastObject = pxTaskBuffer;
+    pvLastStorage = puxStackBuffer;
+    taskCreateCalls++;
+
+    return ( TaskHandle_t ) pxTaskBuffer;
+}
+
+/*!
+ * @brief records the buffers given to the queue or semaphore and returns the
+ *        control block as the handle
+ */
+static QueueHandle_t xQueueGenericCreateStatic_Record( const UBaseType_t uxQueueLength,
+                                                       const UBaseType_t uxItemSize,
+                                                       uint8_t * pucQueueStorage,
+                                                       StaticQueue_t * pxStaticQueue,
+                                                       const uint8_t ucQueueType,
+                                                       int cmock_num_calls )
+{
+    TEST_ASSERT_NOT_NULL( pxStaticQueue );
+
+    /* xQueueCreateStatic() asserts that storage is given only for items. */
+    TEST_ASSERT_EQUAL( uxItemSize == 0, pucQueueStorage == NULL );
+
+    pvLastObject = pxStaticQueue;
+    pvLastStorage = pucQueueStorage;
+
+    return ( QueueHandle_t ) pxStaticQueue;
+}
+
+static QueueHandle_t xQueueCreateMutexStatic_Record( const uint8_t ucQueueType,
+                                                     StaticQueue_t * pxStaticQueue,
+                                                     int cmock_num_calls )
+{
+    TEST_ASSERT_NOT_NULL( pxStaticQueue );
+
+    pvLastObject = pxStaticQueue;
+
+    return ( QueueHandle_t ) pxStaticQueue;
+}
+
+static QueueHandle_t xQueueCreateCountingSemaphoreStatic_Record( const UBaseType_t uxMaxCount,
+                                                                 const UBaseType_t uxInitialCount,
+                                                                 StaticQueue_t * pxStaticQueue,
+                                                                 int cmock_num_calls )
+{
+    TEST_ASSERT_EQUAL( 3, uxMaxCount );
+    TEST_ASSERT_EQUAL( 1, uxInitialCount );
+    TEST_ASSERT_NOT_NULL( pxStaticQueue );
+
+    pvLastObject = pxStaticQueue;
+
+    return ( QueueHandle_t ) pxStaticQueue;
+}
+
+static TimerHandle_t xTimerCreateStatic_Record( const char * const pcTimerName,
+                                                const TickType_t xTimerPeriodInTicks,
+                                                const BaseType_t xAutoReload,
+                                                void * const pvTimerID,
+                                                TimerCallbackFunction_t pxCallbackFunction,
+                                                StaticTimer_t * pxTimerBuffer,
+                                                int cmock_num_calls )
+{
+    TEST_ASSERT_EQUAL_STRING( "Arena", pcTimerName );
+    TEST_ASSERT_EQUAL( 10, xTimerPeriodInTicks );
+    TEST_ASSERT_EQUAL( pdTRUE, xAutoReload );
+    TEST_ASSERT_EQUAL_PTR( dummy_timer_callback, pxCallbackFunction );
+    TEST_ASSERT_NOT_NULL( pxTimerBuffer );
+
+    pvLastObject = pxTimerBuffer;
+
+    return ( TimerHandle_t ) pxTimerBuffer;
+}
+
+static EventGroupHandle_t xEventGroupCreateStatic_Record( StaticEventGroup_t * pxEventGroupBuffer,
+                                                          int cmock_num_calls )
+{
+    TEST_ASSERT_NOT_NULL( pxEventGroupBuffer );
+
+    pvLastObject = pxEventGroupBuffer;
+
+    return ( EventGroupHandle_t ) pxEventGroupBuffer;
+}
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    vFakeAssert_StubWithCallback( vFakeAssertStub );
+    vFakePortEnterCriticalSection_Ignore();
+    vFakePortExitCriticalSection_Ignore();
+
+    pvLastObject = NULL;
+    pvLastStorage = NULL;
+    taskCreateCalls = 0;
+    shouldAbortOnAssertion = false;
+    assertionFailed = 0;
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    TEST_ASSERT_EQUAL( 0, assertionFailed );
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ===========================  Test Cases  =========================== */
+
+/* The arena cannot be emptied again, so each region is used by one test only,
+ * and this test runs first. */
+
+/*!
+ * @brief each region starts with room for its configured number of objects
+ */
+void test_xStaticArenaGetFreeBytes_initial( void )
+{
+    TEST_ASSERT_EQUAL( configSTATIC_ARENA_TASKS * TASK_SLOT, xStaticArenaGetFreeBytes( eStaticArenaTasks ) );
+    TEST_ASSERT_EQUAL( configSTATIC_ARENA_QUEUES * QUEUE_SLOT, xStaticArenaGetFreeBytes( eStaticArenaQueues ) );
+    TEST_ASSERT_EQUAL( configSTATIC_ARENA_SEMAPHORES * SEMAPHORE_SLOT, xStaticArenaGetFreeBytes( eStaticArenaSemaphores ) );
+    TEST_ASSERT_EQUAL( configSTATIC_ARENA_TIMERS * TIMER_SLOT, xStaticArenaGetFreeBytes( eStaticArenaTimers ) );
+    TEST_ASSERT_EQUAL( configSTATIC_ARENA_EVENT_GROUPS * EVENT_GROUP_SLOT, xStaticArenaGetFreeBytes( eStaticArenaEventGroups ) );
+    TEST_ASSERT_EQUAL( ALIGN_UP( configSTATIC_ARENA_STACK_WORDS * sizeof( StackType_t ) ), xStaticArenaGetFreeBytes( eStaticArenaStacks ) );
+    TEST_ASSERT_EQUAL( ALIGN_UP( configSTATIC_ARENA_QUEUE_STORAGE_BYTES ), xStaticArenaGetFreeBytes( eStaticArenaQueueStorage ) );
+}
+
+/*!
+ * @brief an invalid region is caught by an assert
+ */
+void test_xStaticArenaGetFreeBytes_invalid_region( void )
+{
+    EXPECT_ASSERT_BREAK( xStaticArenaGetFreeBytes( eStaticArenaNumberOfRegions ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief tasks are created from adjacent aligned TCBs and stacks until the
+ *        task region is full, and a stack that does not fit takes no TCB
+ */
+void test_xStaticArenaTaskCreate( void )
+{
+    TaskHandle_t xTask = NULL;
+    StaticTask_t * pxFirstTCB = NULL;
+    StackType_t * puxFirstStack = NULL;
+    UBaseType_t x;
+
+    /* Asking for more stack than the whole region fails without creating a
+     * task or taking a TCB. */
+    TEST_ASSERT_EQUAL( errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY,
+                       xStaticArenaTaskCreate( dummy_task, "Arena", configSTATIC_ARENA_STACK_WORDS + 1, NULL, TASK_PRIORITY, &xTask ) );
+    TEST_ASSERT_NULL( xTask );
+    TEST_ASSERT_EQUAL( configSTATIC_ARENA_TASKS * TASK_SLOT, xStaticArenaGetFreeBytes( eStaticArenaTasks ) );
+
+    xTaskCreateStatic_Stub( xTaskCreateStatic_Record );
+
+    for( x = 0; x < configSTATIC_ARENA_TASKS; x++ )
+    {
+        TEST_ASSERT_EQUAL( pdPASS, xStaticArenaTaskCreate( dummy_task, "Arena", STACK_DEPTH, NULL, TASK_PRIORITY, &xTask ) );
+        TEST_ASSERT_EQUAL_PTR( pvLastObject, xTask );
+        TEST_ASSERT_TRUE( is_aligned( pvLastObject ) );
+        TEST_ASSERT_TRUE( is_aligned( pvLastStorage ) );
+
+        if( x == 0 )
+        {
+            pxFirstTCB = ( StaticTask_t * ) pvLastObject;
+            puxFirstStack = ( StackType_t * ) pvLastStorage;
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL_PTR( ( uint8_t * ) pxFirstTCB + ( x * TASK_SLOT ), pvLastObject );
+            TEST_ASSERT_EQUAL_PTR( puxFirstStack + ( x * STACK_DEPTH ), pvLastStorage );
+        }
+    }
+
+    TEST_ASSERT_EQUAL( 0, xStaticArenaGetFreeBytes( eStaticArenaTasks ) );
+    TEST_ASSERT_EQUAL( 0, xStaticArenaGetFreeBytes( eStaticArenaStacks ) );
+
+    /* The pool is full, so xTaskCreateStatic() is not called again and
+     * pxCreatedTask is left alone. */
+    xTask = NULL;
+    TEST_ASSERT_EQUAL( errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY,
+                       xStaticArenaTaskCreate( dummy_task, "Arena", STACK_DEPTH, NULL, TASK_PRIORITY, &xTask ) );
+    TEST_ASSERT_NULL( xTask );
+    TEST_ASSERT_EQUAL( configSTATIC_ARENA_TASKS, taskCreateCalls );
+}
+
+/*!
+ * @brief a queue takes a control block and rounded up storage, a queue of
+ *        zero sized items takes no storage, and a queue that does not fit
+ *        takes nothing
+ */
+void test_xStaticArenaQueueCreate( void )
+{
+    QueueHandle_t xQueue;
+    size_t xStorageFree = xStaticArenaGetFreeBytes( eStaticArenaQueueStorage );
+
+    /* A length and item size whose product overflows, or is at least larger
+     * than the arena. */
+    TEST_ASSERT_NULL( xStaticArenaQueueCreate( 2, ( ( UBaseType_t ) -1 / 2 ) + 1 ) );
+
+    /* Storage that does not fit. */
+    TEST_ASSERT_NULL( xStaticArenaQueueCreate( 1, ( UBaseType_t ) xStorageFree + 1 ) );
+    TEST_ASSERT_EQUAL( configSTATIC_ARENA_QUEUES * QUEUE_SLOT, xStaticArenaGetFreeBytes( eStaticArenaQueues ) );
+    TEST_ASSERT_EQUAL( xStorageFree, xStaticArenaGetFreeBytes( eStaticArenaQueueStorage ) );
+
+    xQueueGenericCreateStatic_Stub( xQueueGenericCreateStatic_Record );
+
+    xQueue = xStaticArenaQueueCreate( 3, sizeof( uint32_t ) );
+    TEST_ASSERT_EQUAL_PTR( pvLastObject, xQueue );
+    TEST_ASSERT_TRUE( is_aligned( pvLastObject ) );
+    TEST_ASSERT_TRUE( is_aligned( pvLastStorage ) );
+    TEST_ASSERT_EQUAL( xStorageFree - ALIGN_UP( 3 * sizeof( uint32_t ) ), xStaticArenaGetFreeBytes( eStaticArenaQueueStorage ) );
+
+    xStorageFree = xStaticArenaGetFreeBytes( eStaticArenaQueueStorage );
+    xQueue = xStaticArenaQueueCreate( 3, 0 );
+    TEST_ASSERT_EQUAL_PTR( pvLastObject, xQueue );
+    TEST_ASSERT_NULL( pvLastStorage );
+    TEST_ASSERT_EQUAL( xStorageFree, xStaticArenaGetFreeBytes( eStaticArenaQueueStorage ) );
+
+    TEST_ASSERT_EQUAL( 0, xStaticArenaGetFreeBytes( eStaticArenaQueues ) );
+    TEST_ASSERT_NULL( xStaticArenaQueueCreate( 1, 1 ) );
+    TEST_ASSERT_EQUAL( xStorageFree, xStaticArenaGetFreeBytes( eStaticArenaQueueStorage ) );
+}
+
+/*!
+ * @brief every type of semaphore is taken from the one semaphore region
+ */
+void test_xStaticArenaSemaphoreCreate( void )
+{
+    SemaphoreHandle_t xSemaphore;
+    uint8_t * pucFirst;
+
+    xQueueGenericCreateStatic_Stub( xQueueGenericCreateStatic_Record );
+    xQueueCreateMutexStatic_Stub( xQueueCreateMutexStatic_Record );
+    xQueueCreateCountingSemaphoreStatic_Stub( xQueueCreateCountingSemaphoreStatic_Record );
+
+    xSemaphore = xStaticArenaSemaphoreCreateBinary();
+    TEST_ASSERT_EQUAL_PTR( pvLastObject, xSemaphore );
+    TEST_ASSERT_NULL( pvLastStorage );
+    TEST_ASSERT_TRUE( is_aligned( pvLastObject ) );
+    pucFirst = ( uint8_t * ) pvLastObject;
+
+    xSemaphore = xStaticArenaSemaphoreCreateMutex();
+    TEST_ASSERT_EQUAL_PTR( pucFirst + SEMAPHORE_SLOT, xSemaphore );
+
+    xSemaphore = xStaticArenaSemaphoreCreateRecursiveMutex();
+    TEST_ASSERT_EQUAL_PTR( pucFirst + ( 2 * SEMAPHORE_SLOT ), xSemaphore );
+
+    xSemaphore = xStaticArenaSemaphoreCreateCounting( 3, 1 );
+    TEST_ASSERT_EQUAL_PTR( pucFirst + ( 3 * SEMAPHORE_SLOT ), xSemaphore );
+
+    TEST_ASSERT_EQUAL( 0, xStaticArenaGetFreeBytes( eStaticArenaSemaphores ) );
+    TEST_ASSERT_NULL( xStaticArenaSemaphoreCreateBinary() );
+    TEST_ASSERT_NULL( xStaticArenaSemaphoreCreateMutex() );
+    TEST_ASSERT_NULL( xStaticArenaSemaphoreCreateRecursiveMutex() );
+    TEST_ASSERT_NULL( xStaticArenaSemaphoreCreateCounting( 3, 1 ) );
+}
+
+/*!
+ * @brief timers are created until the timer region is full
+ */
+void test_xStaticArenaTimerCreate( void )
+{
+    UBaseType_t x;
+
+    xTimerCreateStatic_Stub( xTimerCreateStatic_Record );
+
+    for( x = 0; x < configSTATIC_ARENA_TIMERS; x++ )
+    {
+        TEST_ASSERT_NOT_NULL( xStaticArenaTimerCreate( "Arena", 10, pdTRUE, NULL, dummy_timer_callback ) );
+        TEST_ASSERT_TRUE( is_aligned( pvLastObject ) );
+    }
+
+    TEST_ASSERT_EQUAL( 0, xStaticArenaGetFreeBytes( eStaticArenaTimers ) );
+    TEST_ASSERT_NULL( xStaticArenaTimerCreate( "Arena", 10, pdTRUE, NULL, dummy_timer_callback ) );
+}
+
+/*!
+ * @brief event groups are created until the event group region is full
+ */
+void test_xStaticArenaEventGroupCreate( void )
+{
+    UBaseType_t x;
+
+    xEventGroupCreateStatic_Stub( xEventGroupCreateStatic_Record );
+
+    for( x = 0; x < configSTATIC_ARENA_EVENT_GROUPS; x++ )
+    {
+        TEST_ASSERT_NOT_NULL( xStaticArenaEventGroupCreate() );
+        TEST_ASSERT_TRUE( is_aligned( pvLastObject ) );
+    }
+
+    TEST_ASSERT_EQUAL( 0, xStaticArenaGetFreeBytes( eStaticArenaEventGroups ) );
+    TEST_ASSERT_NULL( xStaticArenaEventGroupCreate() );
+}
@@ -0,0 +1,255 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file task_notify_any_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* Task notify any includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "task.h"
+#include "TaskNotifyAny.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "CException.h"
+
+/* Mock includes. */
+#include "mock_task.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  DEFINES CONSTANTS  ========================== */
+#define DOORBELL_INDEX    ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+#define BIT_INDEX_0       notifyANY_INDEX_BIT( 0 )
+#define BIT_INDEX_1       notifyANY_INDEX_BIT( 1 )
+#define BIT_INDEX_2       notifyANY_INDEX_BIT( 2 )
+#define BLOCK_TIME        ( ( TickType_t ) 10 )
+
+/**
+ * @brief CException code for when a configASSERT should be intercepted.
+ */
+#define configASSERT_E    0xAA101
+
+/**
+ * @brief Expect a configASSERT from the function called.
+ *  Break out of the called function when this occurs.
+ * @details Use this macro when the call passed in as a parameter is expected
+ * to cause invalid memory access.
+ */
+#define EXPECT_ASSERT_BREAK( call )                  \
+    do                                               \
+    {                                                \
+        shouldAbortOnAssertion = true;               \
+        CEXCEPTION_T e = CEXCEPTION_NONE;            \
+        Try                                          \
+        {                                            \
+            call;                                    \
+            TEST_FAIL_MESSAGE( "Expected Assert!" ); \
+        }                                            \
+        Catch( e )                                   \
+        {                                            \
+            TEST_ASSERT_EQUAL( configASSERT_E, e );  \
+        }                                            \
+    } while( 0 )
+
+/* ===========================  GLOBAL VARIABLES  =========================== */
+static TaskHandle_t xTask = ( TaskHandle_t ) 0x1000;
+static bool shouldAbortOnAssertion;
+static uint32_t assertionFailed;
+
+/* ===========================  Static Functions  =========================== */
+
+static void vFakeAssertStub( bool x,
+                             char * file,
+                             int line,
+                             int cmock_num_calls )
+{
+    if( !x )
+    {
+        assertionFailed++;
+
+        if( shouldAbortOnAssertion == true )
+        {
+            Throw( configASSERT_E );
+        }
+    }
+}
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    vFakeAssert_StubWithCallback( vFakeAssertStub );
+    vFakePortEnterCriticalSection_Ignore();
+    vFakePortExitCriticalSection_Ignore();
+    vTaskSetTimeOutState_Ignore();
+
+    shouldAbortOnAssertion = false;
+    assertionFailed = 0;
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    TEST_ASSERT_EQUAL( 0, assertionFailed );
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ===========================  Test Cases  =========================== */
+
+/*!
+ * @brief a notification updates the index, then rings its doorbell bit
+ */
+void test_xTaskNotifyAnyIndexed_rings_doorbell( void )
+{
+    xTaskGenericNotify_ExpectAndReturn( xTask, 1, 5, eSetValueWithOverwrite, NULL, pdPASS );
+    xTaskGenericNotify_ExpectAndReturn( xTask, DOORBELL_INDEX, BIT_INDEX_1, eSetBits, NULL, pdPASS );
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskNotifyAnyIndexed( xTask, 1, 5, eSetValueWithOverwrite ) );
+}
+
+/*!
+ * @brief giving an index increments it
+ */
+void test_xTaskNotifyAnyGiveIndexed( void )
+{
+    xTaskGenericNotify_ExpectAndReturn( xTask, 2, 0, eIncrement, NULL, pdPASS );
+    xTaskGenericNotify_ExpectAndReturn( xTask, DOORBELL_INDEX, BIT_INDEX_2, eSetBits, NULL, pdPASS );
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskNotifyAnyGiveIndexed( xTask, 2 ) );
+}
+
+/*!
+ * @brief a notification that does not update the index does not ring the
+ *        doorbell
+ */
+void test_xTaskNotifyAnyIndexed_without_overwrite_fails( void )
+{
+    xTaskGenericNotify_ExpectAndReturn( xTask, 0, 5, eSetValueWithoutOverwrite, NULL, pdFAIL );
+
+    TEST_ASSERT_EQUAL( pdFAIL, xTaskNotifyAnyIndexed( xTask, 0, 5, eSetValueWithoutOverwrite ) );
+}
+
+/*!
+ * @brief the interrupt safe version rings the doorbell from the interrupt,
+ *        passing on whether a task was woken
+ */
+void test_xTaskNotifyAnyIndexedFromISR_rings_doorbell( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    xTaskGenericNotifyFromISR_ExpectAndReturn( xTask, 0, 0, eIncrement, NULL, &xHigherPriorityTaskWoken, pdPASS );
+    xTaskGenericNotifyFromISR_ExpectAndReturn( xTask, DOORBELL_INDEX, BIT_INDEX_0, eSetBits, NULL, &xHigherPriorityTaskWoken, pdPASS );
+
+    vTaskNotifyAnyGiveIndexedFromISR( xTask, 0, &xHigherPriorityTaskWoken );
+}
+
+/*!
+ * @brief the doorbell index cannot itself be notified through it, nor an
+ *        index beyond the array
+ */
+void test_xTaskNotifyAnyIndexed_invalid_index( void )
+{
+    EXPECT_ASSERT_BREAK( xTaskNotifyAnyIndexed( xTask, DOORBELL_INDEX, 0, eIncrement ) );
+    EXPECT_ASSERT_BREAK( xTaskNotifyAnyIndexed( xTask, configTASK_NOTIFICATION_ARRAY_ENTRIES, 0, eIncrement ) );
+    EXPECT_ASSERT_BREAK( xTaskNotifyAnyIndexedFromISR( xTask, DOORBELL_INDEX, 0, eIncrement, NULL ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief indices that have already fired are returned without blocking, and
+ *        only those waited for are claimed
+ */
+void test_ulTaskNotifyWaitAny_already_fired( void )
+{
+    ulTaskGenericNotifyValueClear_ExpectAndReturn( NULL, DOORBELL_INDEX, BIT_INDEX_0 | BIT_INDEX_1, BIT_INDEX_1 | BIT_INDEX_2 );
+
+    TEST_ASSERT_EQUAL( BIT_INDEX_1, ulTaskNotifyWaitAny( BIT_INDEX_0 | BIT_INDEX_1, BLOCK_TIME ) );
+}
+
+/*!
+ * @brief the task blocks on the doorbell until an index it waits for fires
+ */
+void test_ulTaskNotifyWaitAny_blocks( void )
+{
+    ulTaskGenericNotifyValueClear_ExpectAndReturn( NULL, DOORBELL_INDEX, BIT_INDEX_0 | BIT_INDEX_1, 0 );
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdFALSE );
+    xTaskGenericNotifyWait_ExpectAndReturn( DOORBELL_INDEX, 0, 0, NULL, BLOCK_TIME, pdTRUE );
+    ulTaskGenericNotifyValueClear_ExpectAndReturn( NULL, DOORBELL_INDEX, BIT_INDEX_0 | BIT_INDEX_1, BIT_INDEX_0 );
+
+    TEST_ASSERT_EQUAL( BIT_INDEX_0, ulTaskNotifyWaitAny( BIT_INDEX_0 | BIT_INDEX_1, BLOCK_TIME ) );
+}
+
+/*!
+ * @brief a doorbell for an index not waited for wakes the task, which waits
+ *        again until the block time expires
+ */
+void test_ulTaskNotifyWaitAny_other_index_then_timeout( void )
+{
+    ulTaskGenericNotifyValueClear_ExpectAndReturn( NULL, DOORBELL_INDEX, BIT_INDEX_0, 0 );
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdFALSE );
+    xTaskGenericNotifyWait_ExpectAndReturn( DOORBELL_INDEX, 0, 0, NULL, BLOCK_TIME, pdTRUE );
+    ulTaskGenericNotifyValueClear_ExpectAndReturn( NULL, DOORBELL_INDEX, BIT_INDEX_0, BIT_INDEX_2 );
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdTRUE );
+
+    TEST_ASSERT_EQUAL( 0, ulTaskNotifyWaitAny( BIT_INDEX_0, BLOCK_TIME ) );
+}
+
+/*!
+ * @brief with no block time the wait returns straight away
+ */
+void test_ulTaskNotifyWaitAny_no_block_time( void )
+{
+    ulTaskGenericNotifyValueClear_ExpectAndReturn( NULL, DOORBELL_INDEX, BIT_INDEX_0, 0 );
+    xTaskCheckForTimeOut_ExpectAnyArgsAndReturn( pdTRUE );
+
+    TEST_ASSERT_EQUAL( 0, ulTaskNotifyWaitAny( BIT_INDEX_0, 0 ) );
+}
+
+/*!
+ * @brief a wait needs at least one index, and cannot wait for the doorbell
+ */
+void test_ulTaskNotifyWaitAny_invalid_mask( void )
+{
+    EXPECT_ASSERT_BREAK( ulTaskNotifyWaitAny( 0, BLOCK_TIME ) );
+    EXPECT_ASSERT_BREAK( ulTaskNotifyWaitAny( notifyANY_INDEX_BIT( DOORBELL_INDEX ), BLOCK_TIME ) );
+
+    assertionFailed = 0;
+}
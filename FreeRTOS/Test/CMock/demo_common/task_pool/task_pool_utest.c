@@ -0,0 +1,448 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file task_pool_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* Task pool includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "task.h"
+#include "TaskPool.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "CException.h"
+
+/* Mock includes. */
+#include "mock_task.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ===========================  DEFINES CONSTANTS  ========================== */
+#define NUM_WORKERS          3
+#define STACK_DEPTH          ( ( configSTACK_DEPTH_TYPE ) 50 )
+#define PARKED_PRIORITY      ( tskIDLE_PRIORITY + 1 )
+#define JOB_PRIORITY         ( tskIDLE_PRIORITY + 3 )
+
+/**
+ * @brief CException code for when a configASSERT should be intercepted.
+ */
+#define configASSERT_E       0xAA101
+
+/**
+ * @brief CException code used to break out of a worker's infinite loop.
+ */
+#define WORKER_LOOP_EXIT_E    0xAA102
+
+/**
+ * @brief Expect a configASSERT from the function called.
+ *  Break out of the called function when this occurs.
+ * @details Use this macro when the call passed in as a parameter is expected
+ * to cause invalid memory access.
+ */
+#define EXPECT_ASSERT_BREAK( call )                  \
+    do                                               \
+    {                                                \
+        shouldAbortOnAssertion = true;               \
+        CEXCEPTION_T e = CEXCEPTION_NONE;            \
+        Try                                          \
+        {                                            \
+            call;                                    \
+            TEST_FAIL_MESSAGE( "Expected Assert!" ); \
+        }                                            \
+        Catch( e )                                   \
+        {                                            \
+            TEST_ASSERT_EQUAL( configASSERT_E, e );  \
+        }                                            \
+    } while( 0 )
+
+/* ===========================  GLOBAL VARIABLES  =========================== */
+static TaskPool_t xPool;
+static TaskPoolWorker_t xWorkers[ NUM_WORKERS ];
+static StackType_t uxStackBuffer[ NUM_WORKERS * STACK_DEPTH ];
+static StaticTask_t xTaskBuffers[ NUM_WORKERS ];
+static TaskFunction_t pxWorkerFunction;
+static int xCreateCallToFail;
+static uint32_t ulNotificationsToDeliver;
+static int jobCalls;
+static void * pvJobParameters;
+static bool shouldAbortOnAssertion;
+static uint32_t assertionFailed;
+
+/* ===========================  EXTERN FUNCTIONS  =========================== */
+unsigned long ulGetRunTimeCounterValue( void )
+{
+    return 0;
+}
+
+/* ===========================  Static Functions  =========================== */
+
+static void vFakeAssertStub( bool x,
+                             char * file,
+                             int line,
+                             int cmock_num_calls )
+{
+    if( !x )
+    {
+        assertionFailed++;
+
+        if( shouldAbortOnAssertion == true )
+        {
+            Throw( configASSERT_E );
+        }
+    }
+}
+
+/*!
+ * @brief the handle given to the worker created by the nth create call
+ */
+static TaskHandle_t worker_handle( int cmock_num_calls )
+{
+    return ( TaskHandle_t ) ( uintptr_t ) ( ( 1 + cmock_num_calls ) * 0x1000 );
+}
+
+/*!
+ * @brief records the worker task function and hands out handles, failing the
+ *        create numbered xCreateCallToFail
+ */
+static BaseType_t xTaskCreate_Worker( TaskFunction_t pxTaskCode,
+                                      const char * const pcName,
+                                      const configSTACK_DEPTH_TYPE usStackDepth,
+                                      void * const pvParameters,
+                                      UBaseType_t uxPriority,
+                                      TaskHandle_t * const pxCreatedTask,
+                                      int cmock_num_calls )
+{
+    BaseType_t xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+
+    TEST_ASSERT_EQUAL_STRING( "Worker", pcName );
+    TEST_ASSERT_EQUAL( STACK_DEPTH, usStackDepth );
+    TEST_ASSERT_EQUAL_PTR( &xWorkers[ cmock_num_calls ], pvParameters );
+    TEST_ASSERT_EQUAL( PARKED_PRIORITY, uxPriority );
+
+    pxWorkerFunction = pxTaskCode;
+
+    if( cmock_num_calls != xCreateCallToFail )
+    {
+        *pxCreatedTask = worker_handle( cmock_num_calls );
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+
+/*!
+ * @brief checks each static worker is given its own slice of the buffers
+ */
+static TaskHandle_t xTaskCreateStatic_Worker( TaskFunction_t pxTaskCode,
+                                              const char * const pcName,
+                                              const uint32_t ulStackDepth,
+                                              void * const pvParameters,
+                                              UBaseType_t uxPriority,
+                                              StackType_t * const puxStackBuffer,
+                                              StaticTask_t * const pxTaskBuffer,
+                                              int cmock_num_calls )
+{
+    TEST_ASSERT_EQUAL( STACK_DEPTH, ulStackDepth );
+    TEST_ASSERT_EQUAL_PTR( &xWorkers[ cmock_num_calls ], pvParameters );
+    TEST_ASSERT_EQUAL( PARKED_PRIORITY, uxPriority );
+    TEST_ASSERT_EQUAL_PTR( &uxStackBuffer[ cmock_num_calls * STACK_DEPTH ], puxStackBuffer );
+    TEST_ASSERT_EQUAL_PTR( &xTaskBuffers[ cmock_num_calls ], pxTaskBuffer );
+
+    pxWorkerFunction = pxTaskCode;
+
+    return worker_handle( cmock_num_calls );
+}
+
+/*!
+ * @brief stands in for the worker blocking on its notification; returns
+ *        ulNotificationsToDeliver times, then breaks out of the worker's loop
+ */
+static uint32_t ulTaskGenericNotifyTake_Deliver( UBaseType_t uxIndexToWaitOn,
+                                                 BaseType_t xClearCountOnExit,
+                                                 TickType_t xTicksToWait,
+                                                 int cmock_num_calls )
+{
+    TEST_ASSERT_EQUAL( configTASK_POOL_NOTIFY_INDEX, uxIndexToWaitOn );
+    TEST_ASSERT_EQUAL( pdTRUE, xClearCountOnExit );
+    TEST_ASSERT_EQUAL( portMAX_DELAY, xTicksToWait );
+
+    if( ( uint32_t ) cmock_num_calls >= ulNotificationsToDeliver )
+    {
+        Throw( WORKER_LOOP_EXIT_E );
+    }
+
+    return 1;
+}
+
+/*!
+ * @brief a job run by a worker
+ */
+static void prvJob( void * pvParameters )
+{
+    jobCalls++;
+    pvJobParameters = pvParameters;
+}
+
+/*!
+ * @brief run the worker created for xWorkers[ uxWorker ] until it has taken
+ *        ulNotificationsToDeliver notifications
+ */
+static void run_worker( UBaseType_t uxWorker )
+{
+    CEXCEPTION_T e = CEXCEPTION_NONE;
+
+    ulTaskGenericNotifyTake_Stub( ulTaskGenericNotifyTake_Deliver );
+
+    Try
+    {
+        pxWorkerFunction( &xWorkers[ uxWorker ] );
+        TEST_FAIL_MESSAGE( "Expected the worker to block" );
+    }
+    Catch( e )
+    {
+        TEST_ASSERT_EQUAL( WORKER_LOOP_EXIT_E, e );
+    }
+}
+
+/*!
+ * @brief create a pool of NUM_WORKERS workers
+ */
+static void create_pool( void )
+{
+    xTaskCreate_Stub( xTaskCreate_Worker );
+    TEST_ASSERT_EQUAL( pdPASS, xTaskPoolCreate( &xPool, xWorkers, NUM_WORKERS, "Worker", STACK_DEPTH, PARKED_PRIORITY ) );
+}
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    vFakeAssert_StubWithCallback( vFakeAssertStub );
+    vFakePortEnterCriticalSection_Ignore();
+    vFakePortExitCriticalSection_Ignore();
+
+    xCreateCallToFail = -1;
+    ulNotificationsToDeliver = 0;
+    pxWorkerFunction = NULL;
+    jobCalls = 0;
+    pvJobParameters = NULL;
+    shouldAbortOnAssertion = false;
+    assertionFailed = 0;
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    TEST_ASSERT_EQUAL( 0, assertionFailed );
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ===========================  Test Cases  =========================== */
+
+/*!
+ * @brief creating a pool parks every worker, the last created first
+ */
+void test_xTaskPoolCreate_success( void )
+{
+    create_pool();
+
+    TEST_ASSERT_EQUAL( NUM_WORKERS, uxTaskPoolGetFreeCount( &xPool ) );
+    TEST_ASSERT_EQUAL( PARKED_PRIORITY, xPool.uxParkedPriority );
+    TEST_ASSERT_EQUAL_PTR( &xWorkers[ NUM_WORKERS - 1 ], xPool.pxFreeWorkers );
+    TEST_ASSERT_EQUAL_PTR( worker_handle( 0 ), xWorkers[ 0 ].xTask );
+    TEST_ASSERT_EQUAL_PTR( &xPool, xWorkers[ 0 ].pxPool );
+    TEST_ASSERT_NULL( xWorkers[ 0 ].pxFunction );
+    TEST_ASSERT_NULL( xWorkers[ 0 ].pxNextFree );
+    TEST_ASSERT_NOT_NULL( pxWorkerFunction );
+}
+
+/*!
+ * @brief a worker that cannot be created fails the create, keeping those
+ *        created before it
+ */
+void test_xTaskPoolCreate_create_fails( void )
+{
+    xCreateCallToFail = 1;
+    xTaskCreate_Stub( xTaskCreate_Worker );
+
+    TEST_ASSERT_EQUAL( pdFAIL, xTaskPoolCreate( &xPool, xWorkers, NUM_WORKERS, "Worker", STACK_DEPTH, PARKED_PRIORITY ) );
+    TEST_ASSERT_EQUAL( 1, uxTaskPoolGetFreeCount( &xPool ) );
+    TEST_ASSERT_EQUAL_PTR( &xWorkers[ 0 ], xPool.pxFreeWorkers );
+}
+
+/*!
+ * @brief the parked priority must be a valid priority
+ */
+void test_xTaskPoolCreate_invalid_priority( void )
+{
+    EXPECT_ASSERT_BREAK( xTaskPoolCreate( &xPool, xWorkers, NUM_WORKERS, "Worker", STACK_DEPTH, configMAX_PRIORITIES ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief a static pool gives each worker its own stack and TCB buffer
+ */
+void test_xTaskPoolCreateStatic_success( void )
+{
+    xTaskCreateStatic_Stub( xTaskCreateStatic_Worker );
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskPoolCreateStatic( &xPool, xWorkers, NUM_WORKERS, "Worker", STACK_DEPTH,
+                                                      PARKED_PRIORITY, uxStackBuffer, xTaskBuffers ) );
+    TEST_ASSERT_EQUAL( NUM_WORKERS, uxTaskPoolGetFreeCount( &xPool ) );
+}
+
+/*!
+ * @brief a static pool needs both buffers
+ */
+void test_xTaskPoolCreateStatic_null_buffers( void )
+{
+    EXPECT_ASSERT_BREAK( xTaskPoolCreateStatic( &xPool, xWorkers, NUM_WORKERS, "Worker", STACK_DEPTH,
+                                                PARKED_PRIORITY, NULL, xTaskBuffers ) );
+    EXPECT_ASSERT_BREAK( xTaskPoolCreateStatic( &xPool, xWorkers, NUM_WORKERS, "Worker", STACK_DEPTH,
+                                                PARKED_PRIORITY, uxStackBuffer, NULL ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief running a job raises a parked worker to the job's priority, then
+ *        notifies it
+ */
+void test_xTaskPoolRun_success( void )
+{
+    TaskHandle_t xHandle = NULL;
+    int xParameter;
+
+    create_pool();
+
+    vTaskPrioritySet_Expect( worker_handle( NUM_WORKERS - 1 ), JOB_PRIORITY );
+    xTaskGenericNotify_ExpectAndReturn( worker_handle( NUM_WORKERS - 1 ), configTASK_POOL_NOTIFY_INDEX, 0, eIncrement, NULL, pdPASS );
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskPoolRun( &xPool, prvJob, &xParameter, JOB_PRIORITY, &xHandle ) );
+    TEST_ASSERT_EQUAL_PTR( worker_handle( NUM_WORKERS - 1 ), xHandle );
+    TEST_ASSERT_EQUAL( NUM_WORKERS - 1, uxTaskPoolGetFreeCount( &xPool ) );
+    TEST_ASSERT_EQUAL_PTR( prvJob, xWorkers[ NUM_WORKERS - 1 ].pxFunction );
+    TEST_ASSERT_EQUAL_PTR( &xParameter, xWorkers[ NUM_WORKERS - 1 ].pvParameters );
+
+    /* The job does not run until the worker does. */
+    TEST_ASSERT_EQUAL( 0, jobCalls );
+}
+
+/*!
+ * @brief running a job fails without blocking once every worker is busy
+ */
+void test_xTaskPoolRun_empty( void )
+{
+    UBaseType_t x;
+
+    create_pool();
+    vTaskPrioritySet_Ignore();
+    xTaskGenericNotify_IgnoreAndReturn( pdPASS );
+
+    for( x = 0; x < NUM_WORKERS; x++ )
+    {
+        TEST_ASSERT_EQUAL( pdPASS, xTaskPoolRun( &xPool, prvJob, NULL, JOB_PRIORITY, NULL ) );
+    }
+
+    TEST_ASSERT_EQUAL( 0, uxTaskPoolGetFreeCount( &xPool ) );
+    TEST_ASSERT_EQUAL( pdFAIL, xTaskPoolRun( &xPool, prvJob, NULL, JOB_PRIORITY, NULL ) );
+}
+
+/*!
+ * @brief a job needs a function and a valid priority
+ */
+void test_xTaskPoolRun_invalid_parameters( void )
+{
+    create_pool();
+
+    EXPECT_ASSERT_BREAK( xTaskPoolRun( &xPool, NULL, NULL, JOB_PRIORITY, NULL ) );
+    EXPECT_ASSERT_BREAK( xTaskPoolRun( &xPool, prvJob, NULL, configMAX_PRIORITIES, NULL ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief a worker runs its job, then drops to the parked priority and
+ *        rejoins the pool
+ */
+void test_worker_runs_job_and_rejoins_pool( void )
+{
+    int xParameter;
+
+    create_pool();
+
+    vTaskPrioritySet_Expect( worker_handle( 0 ), JOB_PRIORITY );
+    xTaskGenericNotify_ExpectAndReturn( worker_handle( 0 ), configTASK_POOL_NOTIFY_INDEX, 0, eIncrement, NULL, pdPASS );
+
+    /* Take every other worker, so xWorkers[ 0 ] is the one that runs the
+     * job. */
+    xPool.pxFreeWorkers = &xWorkers[ 0 ];
+    xPool.uxFreeWorkers = 1;
+    xWorkers[ 0 ].pxNextFree = NULL;
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskPoolRun( &xPool, prvJob, &xParameter, JOB_PRIORITY, NULL ) );
+    TEST_ASSERT_EQUAL( 0, uxTaskPoolGetFreeCount( &xPool ) );
+
+    vTaskPrioritySet_Expect( NULL, PARKED_PRIORITY );
+    ulNotificationsToDeliver = 1;
+    run_worker( 0 );
+
+    TEST_ASSERT_EQUAL( 1, jobCalls );
+    TEST_ASSERT_EQUAL_PTR( &xParameter, pvJobParameters );
+    TEST_ASSERT_NULL( xWorkers[ 0 ].pxFunction );
+    TEST_ASSERT_EQUAL( 1, uxTaskPoolGetFreeCount( &xPool ) );
+    TEST_ASSERT_EQUAL_PTR( &xWorkers[ 0 ], xPool.pxFreeWorkers );
+}
+
+/*!
+ * @brief a notification that did not come from xTaskPoolRun() leaves a
+ *        parked worker parked
+ */
+void test_worker_ignores_stray_notification( void )
+{
+    create_pool();
+
+    ulNotificationsToDeliver = 2;
+    run_worker( 0 );
+
+    TEST_ASSERT_EQUAL( 0, jobCalls );
+    TEST_ASSERT_EQUAL( NUM_WORKERS, uxTaskPoolGetFreeCount( &xPool ) );
+}
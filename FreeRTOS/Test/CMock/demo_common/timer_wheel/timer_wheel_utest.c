@@ -0,0 +1,469 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file timer_wheel_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* Timer wheel includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "TimerWheel.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "CException.h"
+
+/* Mock includes. */
+#include "mock_fake_assert.h"
+
+/* ===========================  DEFINES CONSTANTS  ========================== */
+#define MAX_TIMERS        1000 /*!< number of timers for the stress testcases*/
+#define WHEEL_SPAN_TICKS                                                    \
+    ( ( TickType_t ) 1U << ( configTIMER_WHEEL_ROOT_BITS +                  \
+                             ( configTIMER_WHEEL_LEVEL_BITS *               \
+                               ( configTIMER_WHEEL_LEVELS - 1 ) ) ) ) /*!< ticks reached without refiling */
+
+/**
+ * @brief CException code for when a configASSERT should be intercepted.
+ */
+#define configASSERT_E    0xAA101
+
+/**
+ * @brief Expect a configASSERT from the function called.
+ *  Break out of the called function when this occurs.
+ * @details Use this macro when the call passed in as a parameter is expected
+ * to cause invalid memory access.
+ */
+#define EXPECT_ASSERT_BREAK( call )                  \
+    do                                               \
+    {                                                \
+        shouldAbortOnAssertion = true;               \
+        CEXCEPTION_T e = CEXCEPTION_NONE;            \
+        Try                                          \
+        {                                            \
+            call;                                    \
+            TEST_FAIL_MESSAGE( "Expected Assert!" ); \
+        }                                            \
+        Catch( e )                                   \
+        {                                            \
+            TEST_ASSERT_EQUAL( configASSERT_E, e );  \
+        }                                            \
+    } while( 0 )
+
+/* ===========================  GLOBAL VARIABLES  =========================== */
+static TimerWheel_t xWheel;
+static WheelTimer_t xTimers[ MAX_TIMERS ];
+static TickType_t xExpectedExpiry[ MAX_TIMERS ];
+static TickType_t xNow;
+static uint32_t ulCallbacks;
+static WheelTimer_t * pxLastExpired;
+static TickType_t xRestartDelay;
+static bool shouldAbortOnAssertion;
+static uint32_t assertionFailed;
+
+/* ===========================  Static Functions  =========================== */
+
+static void vFakeAssertStub( bool x,
+                             char * file,
+                             int line,
+                             int cmock_num_calls )
+{
+    if( !x )
+    {
+        assertionFailed++;
+
+        if( shouldAbortOnAssertion == true )
+        {
+            Throw( configASSERT_E );
+        }
+    }
+}
+
+/*!
+ * @brief timer callback that records the call and checks it is on time
+ */
+static void vCountingCallback( WheelTimer_t * pxTimer )
+{
+    TEST_ASSERT_EQUAL( xNow, pxTimer->xExpiryTime - pxTimer->xPeriod );
+    ulCallbacks++;
+    pxLastExpired = pxTimer;
+}
+
+/*!
+ * @brief timer callback that stops the timer given as its ID
+ */
+static void vStoppingCallback( WheelTimer_t * pxTimer )
+{
+    ulCallbacks++;
+    vWheelTimerStop( &xWheel, ( WheelTimer_t * ) pvWheelTimerGetID( pxTimer ) );
+}
+
+/*!
+ * @brief timer callback that restarts its own timer after xRestartDelay
+ */
+static void vRestartingCallback( WheelTimer_t * pxTimer )
+{
+    ulCallbacks++;
+    vWheelTimerStart( &xWheel, pxTimer, xRestartDelay, 0 );
+}
+
+/*!
+ * @brief timer callback that checks the timer fires at the tick recorded for it
+ */
+static void vCheckingCallback( WheelTimer_t * pxTimer )
+{
+    uint32_t ulIndex = ( uint32_t ) ( uintptr_t ) pvWheelTimerGetID( pxTimer );
+
+    TEST_ASSERT_EQUAL( xExpectedExpiry[ ulIndex ], xNow );
+    ulCallbacks++;
+}
+
+/*!
+ * @brief advance the wheel one tick at a time, as a tick hook would
+ */
+static void advance_ticks( TickType_t xTicks )
+{
+    while( xTicks > 0 )
+    {
+        xNow++;
+        vTimerWheelAdvance( &xWheel, xNow );
+        xTicks--;
+    }
+}
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    vFakeAssert_StubWithCallback( vFakeAssertStub );
+
+    xNow = 0;
+    ulCallbacks = 0;
+    pxLastExpired = NULL;
+    xRestartDelay = 0;
+    shouldAbortOnAssertion = false;
+    assertionFailed = 0;
+
+    vTimerWheelInit( &xWheel, xNow );
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    TEST_ASSERT_EQUAL( 0, assertionFailed );
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/*!
+ * @brief a new wheel has no timers and a new timer is not active
+ * @coverage vTimerWheelInit vWheelTimerInit xWheelTimerIsActive pvWheelTimerGetID
+ */
+void test_vTimerWheelInit_Success( void )
+{
+    uint32_t ulID = 0x1234;
+
+    vWheelTimerInit( &xTimers[ 0 ], vCountingCallback, &ulID );
+
+    TEST_ASSERT_EQUAL( 0, xWheel.uxActiveTimers );
+    TEST_ASSERT_EQUAL( pdFALSE, xWheelTimerIsActive( &xTimers[ 0 ] ) );
+    TEST_ASSERT_EQUAL_PTR( &ulID, pvWheelTimerGetID( &xTimers[ 0 ] ) );
+
+    advance_ticks( 1000 );
+    TEST_ASSERT_EQUAL( 0, ulCallbacks );
+}
+
+/*!
+ * @brief the wheel and timers must not be NULL
+ * @coverage vTimerWheelInit vWheelTimerInit vWheelTimerStart vWheelTimerStop vTimerWheelAdvance
+ */
+void test_TimerWheel_NullArguments( void )
+{
+    EXPECT_ASSERT_BREAK( vTimerWheelInit( NULL, 0 ) );
+    EXPECT_ASSERT_BREAK( vWheelTimerInit( NULL, vCountingCallback, NULL ) );
+    EXPECT_ASSERT_BREAK( vWheelTimerInit( &xTimers[ 0 ], NULL, NULL ) );
+    EXPECT_ASSERT_BREAK( vWheelTimerStart( NULL, &xTimers[ 0 ], 1, 0 ) );
+    EXPECT_ASSERT_BREAK( vWheelTimerStart( &xWheel, NULL, 1, 0 ) );
+    EXPECT_ASSERT_BREAK( vWheelTimerStop( NULL, &xTimers[ 0 ] ) );
+    EXPECT_ASSERT_BREAK( vWheelTimerStop( &xWheel, NULL ) );
+    EXPECT_ASSERT_BREAK( vTimerWheelAdvance( NULL, 1 ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief a one-shot timer expires at exactly the tick it was started for
+ * @coverage vWheelTimerStart vTimerWheelAdvance
+ */
+void test_vWheelTimerStart_OneShotExpiresOnTime( void )
+{
+    vWheelTimerInit( &xTimers[ 0 ], vCountingCallback, NULL );
+    vWheelTimerStart( &xWheel, &xTimers[ 0 ], 10, 0 );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xWheelTimerIsActive( &xTimers[ 0 ] ) );
+    TEST_ASSERT_EQUAL( 1, xWheel.uxActiveTimers );
+
+    advance_ticks( 9 );
+    TEST_ASSERT_EQUAL( 0, ulCallbacks );
+
+    advance_ticks( 1 );
+    TEST_ASSERT_EQUAL( 1, ulCallbacks );
+    TEST_ASSERT_EQUAL_PTR( &xTimers[ 0 ], pxLastExpired );
+    TEST_ASSERT_EQUAL( pdFALSE, xWheelTimerIsActive( &xTimers[ 0 ] ) );
+    TEST_ASSERT_EQUAL( 0, xWheel.uxActiveTimers );
+
+    advance_ticks( 100 );
+    TEST_ASSERT_EQUAL( 1, ulCallbacks );
+}
+
+/*!
+ * @brief a delay of zero expires at the next tick
+ * @coverage vWheelTimerStart
+ */
+void test_vWheelTimerStart_ZeroDelayExpiresNextTick( void )
+{
+    vWheelTimerInit( &xTimers[ 0 ], vCountingCallback, NULL );
+    vWheelTimerStart( &xWheel, &xTimers[ 0 ], 0, 0 );
+
+    advance_ticks( 1 );
+    TEST_ASSERT_EQUAL( 1, ulCallbacks );
+}
+
+/*!
+ * @brief starting an active timer restarts it from the current tick
+ * @coverage vWheelTimerStart
+ */
+void test_vWheelTimerStart_RestartActiveTimer( void )
+{
+    vWheelTimerInit( &xTimers[ 0 ], vCountingCallback, NULL );
+    vWheelTimerStart( &xWheel, &xTimers[ 0 ], 100, 0 );
+    advance_ticks( 50 );
+
+    vWheelTimerStart( &xWheel, &xTimers[ 0 ], 5000, 0 );
+    TEST_ASSERT_EQUAL( 1, xWheel.uxActiveTimers );
+
+    advance_ticks( 4999 );
+    TEST_ASSERT_EQUAL( 0, ulCallbacks );
+
+    advance_ticks( 1 );
+    TEST_ASSERT_EQUAL( 1, ulCallbacks );
+}
+
+/*!
+ * @brief a stopped timer does not expire, and stopping it again does nothing
+ * @coverage vWheelTimerStop
+ */
+void test_vWheelTimerStop_Success( void )
+{
+    vWheelTimerInit( &xTimers[ 0 ], vCountingCallback, NULL );
+    vWheelTimerInit( &xTimers[ 1 ], vCountingCallback, NULL );
+    vWheelTimerStart( &xWheel, &xTimers[ 0 ], 300, 0 );
+    vWheelTimerStart( &xWheel, &xTimers[ 1 ], 300, 0 );
+
+    vWheelTimerStop( &xWheel, &xTimers[ 0 ] );
+    TEST_ASSERT_EQUAL( pdFALSE, xWheelTimerIsActive( &xTimers[ 0 ] ) );
+    TEST_ASSERT_EQUAL( 1, xWheel.uxActiveTimers );
+
+    vWheelTimerStop( &xWheel, &xTimers[ 0 ] );
+    TEST_ASSERT_EQUAL( 1, xWheel.uxActiveTimers );
+
+    advance_ticks( 300 );
+    TEST_ASSERT_EQUAL( 1, ulCallbacks );
+    TEST_ASSERT_EQUAL_PTR( &xTimers[ 1 ], pxLastExpired );
+}
+
+/*!
+ * @brief a periodic timer reloads from its expiry time, across upper level slots
+ * @coverage vWheelTimerStart vTimerWheelAdvance
+ */
+void test_vWheelTimerStart_PeriodicDoesNotDrift( void )
+{
+    vWheelTimerInit( &xTimers[ 0 ], vCountingCallback, NULL );
+    vWheelTimerStart( &xWheel, &xTimers[ 0 ], 1000, 1000 );
+
+    advance_ticks( 10000 );
+    TEST_ASSERT_EQUAL( 10, ulCallbacks );
+    TEST_ASSERT_EQUAL( pdTRUE, xWheelTimerIsActive( &xTimers[ 0 ] ) );
+    TEST_ASSERT_EQUAL( 11000, xTimers[ 0 ].xExpiryTime );
+
+    vWheelTimerStop( &xWheel, &xTimers[ 0 ] );
+    advance_ticks( 1000 );
+    TEST_ASSERT_EQUAL( 10, ulCallbacks );
+}
+
+/*!
+ * @brief timers further away than the wheel reaches still expire on time
+ * @coverage vWheelTimerStart vTimerWheelAdvance
+ */
+void test_vWheelTimerStart_BeyondWheelSpan( void )
+{
+    TickType_t xDelay = WHEEL_SPAN_TICKS + ( WHEEL_SPAN_TICKS / 2U ) + 7U;
+
+    vWheelTimerInit( &xTimers[ 0 ], vCountingCallback, NULL );
+    vWheelTimerStart( &xWheel, &xTimers[ 0 ], xDelay, 0 );
+
+    advance_ticks( xDelay - 1U );
+    TEST_ASSERT_EQUAL( 0, ulCallbacks );
+
+    advance_ticks( 1 );
+    TEST_ASSERT_EQUAL( 1, ulCallbacks );
+}
+
+/*!
+ * @brief timers started just before the tick count wraps expire on time
+ * @coverage vTimerWheelInit vWheelTimerStart vTimerWheelAdvance
+ */
+void test_vTimerWheelAdvance_TickCountOverflow( void )
+{
+    xNow = portMAX_DELAY - 20U;
+    vTimerWheelInit( &xWheel, xNow );
+
+    vWheelTimerInit( &xTimers[ 0 ], vCountingCallback, NULL );
+    vWheelTimerInit( &xTimers[ 1 ], vCountingCallback, NULL );
+    vWheelTimerStart( &xWheel, &xTimers[ 0 ], 30, 0 );
+    vWheelTimerStart( &xWheel, &xTimers[ 1 ], 5000, 0 );
+
+    advance_ticks( 30 );
+    TEST_ASSERT_EQUAL( 1, ulCallbacks );
+    TEST_ASSERT_EQUAL_PTR( &xTimers[ 0 ], pxLastExpired );
+
+    advance_ticks( 4970 );
+    TEST_ASSERT_EQUAL( 2, ulCallbacks );
+    TEST_ASSERT_EQUAL_PTR( &xTimers[ 1 ], pxLastExpired );
+}
+
+/*!
+ * @brief processing several ticks in one call expires each timer in turn
+ * @coverage vTimerWheelAdvance
+ */
+void test_vTimerWheelAdvance_CatchUp( void )
+{
+    uint32_t i;
+
+    for( i = 0; i < 10; i++ )
+    {
+        vWheelTimerInit( &xTimers[ i ], vCheckingCallback, ( void * ) ( uintptr_t ) i );
+        vWheelTimerStart( &xWheel, &xTimers[ i ], ( i + 1U ) * 97U, 0 );
+        xExpectedExpiry[ i ] = ( i + 1U ) * 97U;
+    }
+
+    /* The callbacks check the tick against xNow, so step it with the wheel. */
+    for( i = 0; i < 10; i++ )
+    {
+        xNow = xExpectedExpiry[ i ];
+        vTimerWheelAdvance( &xWheel, xNow );
+    }
+
+    TEST_ASSERT_EQUAL( 10, ulCallbacks );
+    TEST_ASSERT_EQUAL( 0, xWheel.uxActiveTimers );
+}
+
+/*!
+ * @brief a callback can stop a timer that expires in the same tick
+ * @coverage vTimerWheelAdvance vWheelTimerStop
+ */
+void test_vTimerWheelAdvance_CallbackStopsTimerDueSameTick( void )
+{
+    /* Each timer stops the other, so whichever is called first, the other
+     * must not be called. */
+    vWheelTimerInit( &xTimers[ 0 ], vStoppingCallback, &xTimers[ 1 ] );
+    vWheelTimerInit( &xTimers[ 1 ], vStoppingCallback, &xTimers[ 0 ] );
+    vWheelTimerStart( &xWheel, &xTimers[ 0 ], 200, 0 );
+    vWheelTimerStart( &xWheel, &xTimers[ 1 ], 200, 0 );
+
+    advance_ticks( 200 );
+    TEST_ASSERT_EQUAL( 1, ulCallbacks );
+    TEST_ASSERT_EQUAL( 0, xWheel.uxActiveTimers );
+}
+
+/*!
+ * @brief a callback can restart its own timer
+ * @coverage vTimerWheelAdvance vWheelTimerStart
+ */
+void test_vTimerWheelAdvance_CallbackRestartsTimer( void )
+{
+    vWheelTimerInit( &xTimers[ 0 ], vRestartingCallback, NULL );
+    vWheelTimerStart( &xWheel, &xTimers[ 0 ], 10, 0 );
+    xRestartDelay = 70;
+
+    advance_ticks( 10 + ( 70 * 5 ) );
+    TEST_ASSERT_EQUAL( 6, ulCallbacks );
+    TEST_ASSERT_EQUAL( 1, xWheel.uxActiveTimers );
+}
+
+/*!
+ * @brief many timers with pseudo random delays and periods all expire on time
+ * @coverage vWheelTimerStart vWheelTimerStop vTimerWheelAdvance
+ */
+void test_vTimerWheelAdvance_ManyTimers( void )
+{
+    uint32_t i, ulExpected = 0;
+    uint32_t ulSeed = 0x12345678;
+    TickType_t xDelay;
+
+    for( i = 0; i < MAX_TIMERS; i++ )
+    {
+        ulSeed = ( ulSeed * 1103515245U ) + 12345U;
+        xDelay = ( TickType_t ) ( ( ulSeed >> 8 ) % 300000U );
+
+        vWheelTimerInit( &xTimers[ i ], vCheckingCallback, ( void * ) ( uintptr_t ) i );
+        vWheelTimerStart( &xWheel, &xTimers[ i ], xDelay, 0 );
+        xExpectedExpiry[ i ] = ( xDelay == 0 ) ? 1 : xDelay;
+    }
+
+    /* Stop every third timer. */
+    for( i = 0; i < MAX_TIMERS; i += 3 )
+    {
+        vWheelTimerStop( &xWheel, &xTimers[ i ] );
+    }
+
+    for( i = 0; i < MAX_TIMERS; i++ )
+    {
+        if( xWheelTimerIsActive( &xTimers[ i ] ) == pdTRUE )
+        {
+            ulExpected++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL( ulExpected, xWheel.uxActiveTimers );
+
+    advance_ticks( 300000 );
+    TEST_ASSERT_EQUAL( ulExpected, ulCallbacks );
+    TEST_ASSERT_EQUAL( 0, xWheel.uxActiveTimers );
+}
@@ -0,0 +1,502 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file tlsf_heap_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* TLSF heap includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "TLSFHeap.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "CException.h"
+
+/* Mock includes. */
+#include "mock_fake_assert.h"
+
+/* ===========================  DEFINES CONSTANTS  ========================== */
+#define REGION_SIZE    ( 64 * 1024 ) /*!< size of the region managed by the heap */
+#define MAX_BLOCKS     256           /*!< number of blocks held by the stress test */
+
+/**
+ * @brief CException code for when a configASSERT should be intercepted.
+ */
+#define configASSERT_E    0xAA101
+
+/**
+ * @brief Expect a configASSERT from the function called.
+ *  Break out of the called function when this occurs.
+ * @details Use this macro when the call passed in as a parameter is expected
+ * to cause invalid memory access.
+ */
+#define EXPECT_ASSERT_BREAK( call )                  \
+    do                                               \
+    {                                                \
+        shouldAbortOnAssertion = true;               \
+        CEXCEPTION_T e = CEXCEPTION_NONE;            \
+        Try                                          \
+        {                                            \
+            call;                                    \
+            TEST_FAIL_MESSAGE( "Expected Assert!" ); \
+        }                                            \
+        Catch( e )                                   \
+        {                                            \
+            TEST_ASSERT_EQUAL( configASSERT_E, e );  \
+        }                                            \
+    } while( 0 )
+
+/* ===========================  GLOBAL VARIABLES  =========================== */
+static TLSFHeap_t xHeap;
+static uint64_t ullRegion[ REGION_SIZE / sizeof( uint64_t ) ];
+static size_t xInitialFreeSize;
+static bool shouldAbortOnAssertion;
+static uint32_t assertionFailed;
+
+/* ===========================  Static Functions  =========================== */
+
+static void vFakeAssertStub( bool x,
+                             char * file,
+                             int line,
+                             int cmock_num_calls )
+{
+    if( !x )
+    {
+        assertionFailed++;
+
+        if( shouldAbortOnAssertion == true )
+        {
+            Throw( configASSERT_E );
+        }
+    }
+}
+
+/*!
+ * @brief a pseudo random number generator, so runs are repeatable
+ * @param seed the state of the generator
+ * @return the next number
+ */
+static uint32_t next_random( uint32_t * seed )
+{
+    *seed = ( *seed * 1103515245U ) + 12345U;
+    return *seed >> 8;
+}
+
+/*!
+ * @brief fill a block with a pattern that depends on its owner
+ * @param pv the block
+ * @param size the number of bytes to fill
+ * @param owner a value identifying the block
+ */
+static void fill_block( void * pv,
+                        size_t size,
+                        uint32_t owner )
+{
+    for( size_t i = 0; i < size; i++ )
+    {
+        ( ( uint8_t * ) pv )[ i ] = ( uint8_t ) ( owner + i );
+    }
+}
+
+/*!
+ * @brief check the pattern written by fill_block() is intact
+ * @param pv the block
+ * @param size the number of bytes to check
+ * @param owner the value the block was filled with
+ */
+static void check_block( const void * pv,
+                         size_t size,
+                         uint32_t owner )
+{
+    for( size_t i = 0; i < size; i++ )
+    {
+        TEST_ASSERT_EQUAL_HEX8( ( uint8_t ) ( owner + i ), ( ( const uint8_t * ) pv )[ i ] );
+    }
+}
+
+/*!
+ * @brief check that the heap is back to a single free block the size of the
+ *        whole region
+ */
+static void validate_empty_heap( void )
+{
+    HeapStats_t xStats;
+
+    vTLSFHeapGetHeapStats( &xHeap, &xStats );
+    TEST_ASSERT_EQUAL( xInitialFreeSize, xTLSFHeapGetFreeSize( &xHeap ) );
+    TEST_ASSERT_EQUAL( xInitialFreeSize, xTLSFHeapGetLargestFreeBlockSize( &xHeap ) );
+    TEST_ASSERT_EQUAL( 1, xStats.xNumberOfFreeBlocks );
+    TEST_ASSERT_EQUAL( xInitialFreeSize, xStats.xSizeOfLargestFreeBlockInBytes );
+    TEST_ASSERT_EQUAL( xStats.xNumberOfSuccessfulAllocations, xStats.xNumberOfSuccessfulFrees );
+}
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    vFakeAssert_StubWithCallback( vFakeAssertStub );
+
+    shouldAbortOnAssertion = false;
+    assertionFailed = 0;
+
+    TEST_ASSERT_EQUAL( pdPASS, xTLSFHeapInitialise( &xHeap, ullRegion, sizeof( ullRegion ) ) );
+    xInitialFreeSize = xTLSFHeapGetFreeSize( &xHeap );
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    TEST_ASSERT_EQUAL( 0, assertionFailed );
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/*!
+ * @brief a new heap is one free block that uses nearly all of the region
+ * @coverage xTLSFHeapInitialise xTLSFHeapGetFreeSize xTLSFHeapGetMinimumEverFreeSize xTLSFHeapGetLargestFreeBlockSize vTLSFHeapGetHeapStats
+ */
+void test_xTLSFHeapInitialise_Success( void )
+{
+    HeapStats_t xStats;
+
+    TEST_ASSERT_LESS_THAN( sizeof( ullRegion ), xInitialFreeSize );
+    TEST_ASSERT_GREATER_THAN( sizeof( ullRegion ) - 64U, xInitialFreeSize );
+    TEST_ASSERT_EQUAL( xInitialFreeSize, xTLSFHeapGetMinimumEverFreeSize( &xHeap ) );
+
+    vTLSFHeapGetHeapStats( &xHeap, &xStats );
+    TEST_ASSERT_EQUAL( xInitialFreeSize, xStats.xAvailableHeapSpaceInBytes );
+    TEST_ASSERT_EQUAL( xInitialFreeSize, xStats.xSizeOfSmallestFreeBlockInBytes );
+    TEST_ASSERT_EQUAL( 0, xStats.xNumberOfSuccessfulAllocations );
+
+    validate_empty_heap();
+}
+
+/*!
+ * @brief a region that does not start on an aligned address is aligned, and
+ *        one too small for a block is rejected
+ * @coverage xTLSFHeapInitialise
+ */
+void test_xTLSFHeapInitialise_unaligned_and_too_small( void )
+{
+    uint8_t * pucRegion = ( uint8_t * ) ullRegion;
+    void * pv;
+
+    TEST_ASSERT_EQUAL( pdPASS, xTLSFHeapInitialise( &xHeap, pucRegion + 3, 1024 ) );
+    pv = pvTLSFHeapMalloc( &xHeap, 1 );
+    TEST_ASSERT_NOT_NULL( pv );
+    TEST_ASSERT_EQUAL( 0, ( ( size_t ) pv ) & portBYTE_ALIGNMENT_MASK );
+    TEST_ASSERT_GREATER_OR_EQUAL( ( size_t ) ( pucRegion + 3 ), ( size_t ) pv );
+
+    TEST_ASSERT_EQUAL( pdFAIL, xTLSFHeapInitialise( &xHeap, pucRegion + 1, 2 ) );
+    TEST_ASSERT_EQUAL( pdFAIL, xTLSFHeapInitialise( &xHeap, pucRegion, 16 ) );
+}
+
+/*!
+ * @brief the heap and region must be valid, and a block must not be freed
+ *        twice or freed to a heap it did not come from
+ * @coverage xTLSFHeapInitialise pvTLSFHeapMalloc vTLSFHeapFree
+ */
+void test_TLSFHeap_InvalidArguments( void )
+{
+    uint64_t ullOther[ 16 ];
+    void * pv = pvTLSFHeapMalloc( &xHeap, 32 );
+
+    EXPECT_ASSERT_BREAK( xTLSFHeapInitialise( NULL, ullRegion, sizeof( ullRegion ) ) );
+    EXPECT_ASSERT_BREAK( xTLSFHeapInitialise( &xHeap, NULL, sizeof( ullRegion ) ) );
+    EXPECT_ASSERT_BREAK( pvTLSFHeapMalloc( NULL, 32 ) );
+    EXPECT_ASSERT_BREAK( vTLSFHeapFree( NULL, pv ) );
+
+    /* Not from this heap. */
+    EXPECT_ASSERT_BREAK( vTLSFHeapFree( &xHeap, &ullOther[ 8 ] ) );
+
+    /* Freed twice. */
+    vTLSFHeapFree( &xHeap, pv );
+    EXPECT_ASSERT_BREAK( vTLSFHeapFree( &xHeap, pv ) );
+
+    assertionFailed = 0;
+}
+
+/*!
+ * @brief zero sized and oversized requests fail, and freeing NULL does nothing
+ * @coverage pvTLSFHeapMalloc vTLSFHeapFree
+ */
+void test_pvTLSFHeapMalloc_invalid_sizes( void )
+{
+    TEST_ASSERT_NULL( pvTLSFHeapMalloc( &xHeap, 0 ) );
+    TEST_ASSERT_NULL( pvTLSFHeapMalloc( &xHeap, sizeof( ullRegion ) ) );
+    TEST_ASSERT_NULL( pvTLSFHeapMalloc( &xHeap, ( size_t ) -1 ) );
+
+    vTLSFHeapFree( &xHeap, NULL );
+
+    validate_empty_heap();
+    TEST_ASSERT_EQUAL( xInitialFreeSize, xTLSFHeapGetMinimumEverFreeSize( &xHeap ) );
+}
+
+/*!
+ * @brief blocks are aligned, do not overlap, and are returned to the heap
+ * @coverage pvTLSFHeapMalloc vTLSFHeapFree xTLSFHeapGetFreeSize
+ */
+void test_pvTLSFHeapMalloc_Success_sizes( void )
+{
+    static const size_t xSizes[] = { 1, 7, 8, 9, 15, 16, 17, 100, 127, 128, 129, 255, 256, 257, 1000, 1023, 1024, 1025, 4095, 4096, 4097, 10000 };
+    void * pvBlocks[ sizeof( xSizes ) / sizeof( xSizes[ 0 ] ) ];
+    size_t x, xFree = xInitialFreeSize;
+
+    for( x = 0; x < ( sizeof( xSizes ) / sizeof( xSizes[ 0 ] ) ); x++ )
+    {
+        pvBlocks[ x ] = pvTLSFHeapMalloc( &xHeap, xSizes[ x ] );
+        TEST_ASSERT_NOT_NULL( pvBlocks[ x ] );
+        TEST_ASSERT_EQUAL( 0, ( ( size_t ) pvBlocks[ x ] ) & portBYTE_ALIGNMENT_MASK );
+        TEST_ASSERT_GREATER_OR_EQUAL( ( size_t ) ullRegion, ( size_t ) pvBlocks[ x ] );
+        TEST_ASSERT_LESS_OR_EQUAL( ( size_t ) ullRegion + sizeof( ullRegion ), ( size_t ) pvBlocks[ x ] + xSizes[ x ] );
+
+        /* At least the size requested is taken from the free size. */
+        TEST_ASSERT_LESS_OR_EQUAL( xFree - xSizes[ x ], xTLSFHeapGetFreeSize( &xHeap ) );
+        xFree = xTLSFHeapGetFreeSize( &xHeap );
+
+        fill_block( pvBlocks[ x ], xSizes[ x ], ( uint32_t ) x );
+    }
+
+    for( x = 0; x < ( sizeof( xSizes ) / sizeof( xSizes[ 0 ] ) ); x++ )
+    {
+        check_block( pvBlocks[ x ], xSizes[ x ], ( uint32_t ) x );
+    }
+
+    /* Free every other block, then the rest, so blocks are merged with the
+     * free blocks both before and after them. */
+    for( x = 0; x < ( sizeof( xSizes ) / sizeof( xSizes[ 0 ] ) ); x += 2 )
+    {
+        vTLSFHeapFree( &xHeap, pvBlocks[ x ] );
+    }
+
+    for( x = 1; x < ( sizeof( xSizes ) / sizeof( xSizes[ 0 ] ) ); x += 2 )
+    {
+        vTLSFHeapFree( &xHeap, pvBlocks[ x ] );
+    }
+
+    validate_empty_heap();
+}
+
+/*!
+ * @brief nearly all of the free size can be allocated as one block
+ * @coverage pvTLSFHeapMalloc vTLSFHeapFree xTLSFHeapGetLargestFreeBlockSize xTLSFHeapGetMinimumEverFreeSize
+ */
+void test_pvTLSFHeapMalloc_Success_whole_heap( void )
+{
+    size_t xLargest = xTLSFHeapGetLargestFreeBlockSize( &xHeap );
+    size_t xPayload;
+    void * pv = NULL;
+
+    /* Requests are rounded up to the start of the next list, so the largest
+     * request that succeeds can be a little smaller than the block. */
+    for( xPayload = xLargest; xPayload > 0; xPayload -= 8U )
+    {
+        pv = pvTLSFHeapMalloc( &xHeap, xPayload );
+
+        if( pv != NULL )
+        {
+            break;
+        }
+    }
+
+    TEST_ASSERT_NOT_NULL( pv );
+    TEST_ASSERT_GREATER_THAN( ( xLargest * 15U ) / 16U, xPayload );
+    TEST_ASSERT_LESS_THAN( xLargest / 16U, xTLSFHeapGetFreeSize( &xHeap ) );
+    TEST_ASSERT_EQUAL( xTLSFHeapGetFreeSize( &xHeap ), xTLSFHeapGetMinimumEverFreeSize( &xHeap ) );
+    TEST_ASSERT_NULL( pvTLSFHeapMalloc( &xHeap, xLargest / 16U ) );
+
+    vTLSFHeapFree( &xHeap, pv );
+    validate_empty_heap();
+    TEST_ASSERT_LESS_THAN( xLargest / 16U, xTLSFHeapGetMinimumEverFreeSize( &xHeap ) );
+}
+
+/*!
+ * @brief filling the heap with small blocks fails cleanly when it is full,
+ *        and freeing them all leaves a single block again
+ * @coverage pvTLSFHeapMalloc vTLSFHeapFree vTLSFHeapGetHeapStats
+ */
+void test_pvTLSFHeapMalloc_Success_exhaust( void )
+{
+    static void * pvBlocks[ REGION_SIZE / 16 ];
+    HeapStats_t xStats;
+    size_t x, xCount = 0;
+
+    while( ( pvBlocks[ xCount ] = pvTLSFHeapMalloc( &xHeap, 24 ) ) != NULL )
+    {
+        xCount++;
+        TEST_ASSERT_LESS_THAN( sizeof( pvBlocks ) / sizeof( pvBlocks[ 0 ] ), xCount );
+    }
+
+    /* The space left over is smaller than a block. */
+    TEST_ASSERT_LESS_THAN( 64U, xTLSFHeapGetFreeSize( &xHeap ) );
+
+    vTLSFHeapGetHeapStats( &xHeap, &xStats );
+    TEST_ASSERT_EQUAL( xCount, xStats.xNumberOfSuccessfulAllocations );
+
+    /* Free every other block, then the rest from the end, so blocks are
+     * merged with free blocks on either side. */
+    for( x = 0; x < xCount; x += 2U )
+    {
+        vTLSFHeapFree( &xHeap, pvBlocks[ x ] );
+    }
+
+    for( x = xCount; x > 0U; x-- )
+    {
+        if( ( ( x - 1U ) % 2U ) != 0U )
+        {
+            vTLSFHeapFree( &xHeap, pvBlocks[ x - 1U ] );
+        }
+    }
+
+    validate_empty_heap();
+}
+
+/*!
+ * @brief a free block is found for a request even when the free blocks are
+ *        in lists above and below it, and a request bigger than every free
+ *        block fails even though the total free size is enough
+ * @coverage pvTLSFHeapMalloc vTLSFHeapFree xTLSFHeapGetLargestFreeBlockSize
+ */
+void test_pvTLSFHeapMalloc_fragmented( void )
+{
+    static void * pvBlocks[ 64 ];
+    HeapStats_t xStats;
+    size_t x, xLargest;
+    void * pv;
+
+    /* 64 blocks of 512 bytes, then a block that takes the rest. */
+    for( x = 0; x < 64U; x++ )
+    {
+        pvBlocks[ x ] = pvTLSFHeapMalloc( &xHeap, 512 );
+        TEST_ASSERT_NOT_NULL( pvBlocks[ x ] );
+    }
+
+    pv = pvTLSFHeapMalloc( &xHeap, xTLSFHeapGetLargestFreeBlockSize( &xHeap ) - 4096U );
+    TEST_ASSERT_NOT_NULL( pv );
+
+    /* Free every other 512 byte block, leaving holes that cannot merge. */
+    for( x = 0; x < 64U; x += 2U )
+    {
+        vTLSFHeapFree( &xHeap, pvBlocks[ x ] );
+        pvBlocks[ x ] = NULL;
+    }
+
+    vTLSFHeapGetHeapStats( &xHeap, &xStats );
+    TEST_ASSERT_GREATER_OR_EQUAL( 32, xStats.xNumberOfFreeBlocks );
+    xLargest = xTLSFHeapGetLargestFreeBlockSize( &xHeap );
+    TEST_ASSERT_EQUAL( xStats.xSizeOfLargestFreeBlockInBytes, xLargest );
+    TEST_ASSERT_GREATER_THAN( 2048U, xTLSFHeapGetFreeSize( &xHeap ) );
+    TEST_ASSERT_NULL( pvTLSFHeapMalloc( &xHeap, xLargest + 64U ) );
+
+    /* Holes are reused for requests that fit them. */
+    for( x = 0; x < 64U; x += 2U )
+    {
+        pvBlocks[ x ] = pvTLSFHeapMalloc( &xHeap, 500 );
+        TEST_ASSERT_NOT_NULL( pvBlocks[ x ] );
+    }
+
+    for( x = 0; x < 64U; x++ )
+    {
+        vTLSFHeapFree( &xHeap, pvBlocks[ x ] );
+    }
+
+    vTLSFHeapFree( &xHeap, pv );
+    validate_empty_heap();
+}
+
+/*!
+ * @brief random allocations and frees of mixed sizes never corrupt each
+ *        other, and the accounting matches a walk of the heap throughout
+ * @coverage pvTLSFHeapMalloc vTLSFHeapFree xTLSFHeapGetFreeSize xTLSFHeapGetLargestFreeBlockSize vTLSFHeapGetHeapStats
+ */
+void test_TLSFHeap_Success_random( void )
+{
+    static void * pvBlocks[ MAX_BLOCKS ];
+    static size_t xSizes[ MAX_BLOCKS ];
+    HeapStats_t xStats;
+    uint32_t seed = 0x12345678;
+    uint32_t i, x;
+
+    memset( pvBlocks, 0x00, sizeof( pvBlocks ) );
+
+    for( i = 0; i < 50000U; i++ )
+    {
+        x = next_random( &seed ) % MAX_BLOCKS;
+
+        if( pvBlocks[ x ] != NULL )
+        {
+            check_block( pvBlocks[ x ], xSizes[ x ], x );
+            vTLSFHeapFree( &xHeap, pvBlocks[ x ] );
+            pvBlocks[ x ] = NULL;
+        }
+        else
+        {
+            /* Mostly small blocks, with some large ones. */
+            xSizes[ x ] = ( ( next_random( &seed ) % 4U ) != 0U ) ? ( ( next_random( &seed ) % 256U ) + 1U ) : ( ( next_random( &seed ) % 4096U ) + 1U );
+            pvBlocks[ x ] = pvTLSFHeapMalloc( &xHeap, xSizes[ x ] );
+
+            if( pvBlocks[ x ] != NULL )
+            {
+                TEST_ASSERT_EQUAL( 0, ( ( size_t ) pvBlocks[ x ] ) & portBYTE_ALIGNMENT_MASK );
+                fill_block( pvBlocks[ x ], xSizes[ x ], x );
+            }
+        }
+
+        if( ( i % 1000U ) == 0U )
+        {
+            vTLSFHeapGetHeapStats( &xHeap, &xStats );
+            TEST_ASSERT_EQUAL( xStats.xAvailableHeapSpaceInBytes, xTLSFHeapGetFreeSize( &xHeap ) );
+            TEST_ASSERT_EQUAL( xStats.xSizeOfLargestFreeBlockInBytes, xTLSFHeapGetLargestFreeBlockSize( &xHeap ) );
+            TEST_ASSERT_LESS_OR_EQUAL( xStats.xAvailableHeapSpaceInBytes, xTLSFHeapGetMinimumEverFreeSize( &xHeap ) );
+        }
+    }
+
+    for( x = 0; x < MAX_BLOCKS; x++ )
+    {
+        if( pvBlocks[ x ] != NULL )
+        {
+            check_block( pvBlocks[ x ], xSizes[ x ], x );
+            vTLSFHeapFree( &xHeap, pvBlocks[ x ] );
+        }
+    }
+
+    validate_empty_heap();
+}
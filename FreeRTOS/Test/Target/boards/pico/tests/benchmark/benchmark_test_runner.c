@@ -0,0 +1,138 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file benchmark_test_runner.c
+ * @brief The implementation of test runner task which runs the benchmarks.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h" /* Must come first. */
+#include "task.h"     /* RTOS task related API prototypes. */
+
+/* Unity includes. */
+#include "unity.h"
+
+/* Benchmark includes. */
+#include "benchmark.h"
+
+/* Pico includes. */
+#include "pico/multicore.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/irq.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The task that runs the test.
+ */
+static void prvTestRunnerTask( void * pvParameters );
+
+/**
+ * @brief Returns a free running count of CPU cycles, used by the benchmarks
+ *        to measure time.
+ *
+ * The RP2040 has no cycle counter, so the 1MHz system timer is scaled to
+ * system clock cycles.  The IPC benchmarks time many operations at a time,
+ * but the interrupt latency benchmarks time one interrupt per sample, so
+ * their results are only accurate to a microsecond.
+ */
+uint32_t ulTestGetCycleCount( void );
+
+/**
+ * @brief Pend the interrupt the interrupt latency benchmarks time.
+ */
+static void prvTriggerInterrupt( void );
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The board description reported with the results.
+ */
+static BenchmarkBoard_t xBoard =
+{
+    .pcName             = "pico",
+    .ulCycleHz          = 0,  /* Set once the clocks are running. */
+    .pxTriggerInterrupt = prvTriggerInterrupt,
+    .pxBenchmarks       = NULL,
+    .uxBenchmarks       = 0
+};
+
+/**
+ * @brief The user interrupt claimed for the benchmarks.
+ */
+static uint32_t ulBenchmarkIrq = 0;
+/*-----------------------------------------------------------*/
+
+uint32_t ulTestGetCycleCount( void )
+{
+    return ( uint32_t ) ( time_us_64() * ( clock_get_hz( clk_sys ) / 1000000U ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTriggerInterrupt( void )
+{
+    irq_set_pending( ulBenchmarkIrq );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTestRunnerTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    /* Move to the core the benchmarks run on before enabling the interrupt,
+     * which is only enabled on the calling core. */
+    vTaskCoreAffinitySet( NULL, benchmarkCORE_AFFINITY );
+
+    /* The user interrupts are only raised by software, so one can be used
+     * without affecting any peripheral. */
+    ulBenchmarkIrq = ( uint32_t ) user_irq_claim_unused( true );
+    irq_set_exclusive_handler( ulBenchmarkIrq, vBenchmarkInterruptHandler );
+    irq_set_enabled( ulBenchmarkIrq, true );
+
+    xBoard.ulCycleHz = clock_get_hz( clk_sys );
+
+    /* Run the benchmarks. */
+    vRunBenchmarks( &xBoard );
+
+    irq_set_enabled( ulBenchmarkIrq, false );
+    irq_remove_handler( ulBenchmarkIrq, vBenchmarkInterruptHandler );
+    user_irq_unclaim( ulBenchmarkIrq );
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vRunTest( void )
+{
+    xTaskCreate( prvTestRunnerTask,
+                 "testRunner",
+                 configMINIMAL_STACK_SIZE * 4, /* The test calls printf(). */
+                 NULL,
+                 configMAX_PRIORITIES - 1,
+                 NULL );
+}
+/*-----------------------------------------------------------*/
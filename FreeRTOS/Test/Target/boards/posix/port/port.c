@@ -0,0 +1,619 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file port.c
+ * @brief Posix SMP simulation port.
+ *
+ * Each task runs on its own host pthread.  A simulated core is simply the
+ * task thread the scheduler selected for it, so the threads of the
+ * configNUMBER_OF_CORES running tasks execute in parallel while every other
+ * task thread sleeps on its own condition variable.
+ *
+ * Interrupts are modelled with a single signal.  Masking interrupts blocks the
+ * signal on the calling thread, and a core is interrupted by sending the
+ * signal to the thread currently running on it.  What the interrupt does is
+ * recorded in per-core flags before the signal is sent:
+ *   - The tick thread counts pending ticks, which are processed by whichever
+ *     thread is running on configTICK_CORE.
+ *   - portYIELD_CORE() requests a context switch on a core.  A core switches
+ *     context from within the signal handler by selecting the next task,
+ *     resuming its thread and then sleeping until it is selected again.
+ *
+ * Signals that reach a thread after it stopped running on the core they were
+ * meant for are harmless, as the handler only acts on the flags of the core
+ * the thread is running on when it takes the signal.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+/*-----------------------------------------------------------*/
+
+#if ( configNUMBER_OF_CORES < 2 )
+    #error The Posix SMP simulation port requires configNUMBER_OF_CORES to be at least 2.
+#endif
+
+#if ( INCLUDE_xTaskGetCurrentTaskHandle != 1 )
+    #error The Posix SMP simulation port requires INCLUDE_xTaskGetCurrentTaskHandle to be set to 1.
+#endif
+
+/* The signal used to simulate interrupts. */
+#define portINTERRUPT_SIGNAL    SIGUSR1
+
+#define portNANOSECONDS_PER_SECOND    ( 1000000000L )
+#define portNANOSECONDS_PER_TICK      ( portNANOSECONDS_PER_SECOND / ( long ) configTICK_RATE_HZ )
+/*-----------------------------------------------------------*/
+
+/* The host thread backing a task.  It is stored at the top of the task's
+ * stack, see pxPortInitialiseStack(). */
+typedef struct THREAD
+{
+    pthread_t xPthread;
+    TaskFunction_t pxCode;
+    void * pvParams;
+
+    /* Protects the fields below. */
+    pthread_mutex_t xMutex;
+    pthread_cond_t xCond;
+    BaseType_t xResumed; /* Set when the task was selected to run. */
+    BaseType_t xCoreID;  /* The core the task was selected to run on. */
+    BaseType_t xDying;   /* Set when the task was deleted. */
+} Thread_t;
+/*-----------------------------------------------------------*/
+
+/*
+ * Returns the thread backing xTask.
+ */
+static Thread_t * prvGetThreadFromTask( TaskHandle_t xTask );
+
+/*
+ * Blocks or unblocks the interrupt signal on the calling thread.
+ */
+static void prvSetInterruptSignalMask( int iHow,
+                                       sigset_t * pxOldMask );
+
+/*
+ * Marks pxThread as selected to run on xCoreID and wakes it.
+ */
+static void prvResumeThread( Thread_t * pxThread,
+                             BaseType_t xCoreID );
+
+/*
+ * Sleeps until the calling thread is selected to run again, then adopts the
+ * core it was selected for.  Exits the thread if its task was deleted.
+ */
+static void prvSuspendSelf( Thread_t * pxThread );
+
+/*
+ * Sends the interrupt signal to the thread running on xCoreID.
+ */
+static void prvInterruptCore( BaseType_t xCoreID );
+
+/*
+ * Returns pdTRUE if an interrupt is pending on xCoreID.
+ */
+static BaseType_t prvInterruptPending( BaseType_t xCoreID );
+
+/*
+ * Processes the ticks counted by the tick thread.  Runs on configTICK_CORE.
+ */
+static void prvProcessTicks( BaseType_t xCoreID );
+
+/*
+ * Selects the next task to run on xCoreID and, if it is not the calling
+ * task, hands the core over to it.
+ */
+static void prvSwitchContext( BaseType_t xCoreID );
+
+/*
+ * The simulated interrupt handler.
+ */
+static void prvInterruptHandler( int iSignal );
+
+/*
+ * Entry points of the task threads and of the tick thread.
+ */
+static void * prvThreadStart( void * pvParams );
+static void * prvTickThread( void * pvParams );
+/*-----------------------------------------------------------*/
+
+/* Critical nesting count of each core, used by the kernel through
+ * portGET_CRITICAL_NESTING_COUNT() and friends. */
+UBaseType_t uxPortCriticalNesting[ configNUMBER_OF_CORES ] = { 0 };
+
+/* The thread currently running on each core.  Only written by the thread
+ * handing a core over in prvSwitchContext(), or before the scheduler starts. */
+static Thread_t * pxCoreThreads[ configNUMBER_OF_CORES ] = { NULL };
+
+/* Context switches requested on each core and not yet performed. */
+static BaseType_t xYieldRequests[ configNUMBER_OF_CORES ] = { pdFALSE };
+
+/* Ticks counted by the tick thread and not yet processed. */
+static UBaseType_t uxPendingTicks = 0;
+
+/* The recursive task and ISR locks. */
+static pthread_mutex_t xTaskLock;
+static pthread_mutex_t xISRLock;
+
+/* Interrupting a core reads pxCoreThreads[] and signals the thread, which
+ * must not be reclaimed in between.  Held for reading when signalling and for
+ * writing when reclaiming a deleted task's thread. */
+static pthread_rwlock_t xThreadLifetimeLock = PTHREAD_RWLOCK_INITIALIZER;
+
+/* Used by vPortEndScheduler() to return from xPortStartScheduler(). */
+static pthread_mutex_t xEndSchedulerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xEndSchedulerCond = PTHREAD_COND_INITIALIZER;
+static BaseType_t xSchedulerEnded = pdFALSE;
+
+/* Per thread state.  The thread that creates the tasks and starts the
+ * scheduler runs on core 0 until the scheduler starts. */
+static __thread BaseType_t xThisCoreID = 0;
+static __thread Thread_t * pxThisThread = NULL;
+static __thread UBaseType_t uxInterruptsMasked = pdFALSE;
+static __thread BaseType_t xInInterrupt = pdFALSE;
+/*-----------------------------------------------------------*/
+
+StackType_t * pxPortInitialiseStack( StackType_t * pxTopOfStack,
+                                     TaskFunction_t pxCode,
+                                     void * pvParameters )
+{
+    Thread_t * pxThread;
+    sigset_t xOldMask;
+    int iResult;
+
+    /* Keep the thread data at the top of the stack.  The thread itself runs on
+     * a stack allocated by the host, so the rest of the task's stack is
+     * unused. */
+    pxThread = ( Thread_t * ) ( pxTopOfStack + 1 ) - 1;
+    pxTopOfStack = ( StackType_t * ) pxThread - 1;
+
+    memset( pxThread, 0, sizeof( Thread_t ) );
+    pxThread->pxCode = pxCode;
+    pxThread->pvParams = pvParameters;
+    ( void ) pthread_mutex_init( &( pxThread->xMutex ), NULL );
+    ( void ) pthread_cond_init( &( pxThread->xCond ), NULL );
+
+    /* The new thread inherits the signal mask, so block the interrupt signal
+     * while creating it.  It is unblocked when the task first runs. */
+    prvSetInterruptSignalMask( SIG_BLOCK, &xOldMask );
+    iResult = pthread_create( &( pxThread->xPthread ), NULL, prvThreadStart, pxThread );
+    ( void ) pthread_sigmask( SIG_SETMASK, &xOldMask, NULL );
+
+    configASSERT( iResult == 0 );
+    ( void ) iResult;
+
+    return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+    pthread_mutexattr_t xMutexAttributes;
+    struct sigaction xSigAction;
+    pthread_t xTickThread;
+    BaseType_t xCoreID;
+
+    ( void ) pthread_mutexattr_init( &xMutexAttributes );
+    ( void ) pthread_mutexattr_settype( &xMutexAttributes, PTHREAD_MUTEX_RECURSIVE );
+    ( void ) pthread_mutex_init( &xTaskLock, &xMutexAttributes );
+    ( void ) pthread_mutex_init( &xISRLock, &xMutexAttributes );
+    ( void ) pthread_mutexattr_destroy( &xMutexAttributes );
+
+    /* This thread never runs a task, so it never takes an interrupt.  The tick
+     * thread created below inherits the mask. */
+    ( void ) uxPortSetInterruptMask();
+
+    memset( &xSigAction, 0, sizeof( xSigAction ) );
+    xSigAction.sa_handler = prvInterruptHandler;
+    xSigAction.sa_flags = SA_RESTART;
+    ( void ) sigfillset( &( xSigAction.sa_mask ) );
+    ( void ) sigaction( portINTERRUPT_SIGNAL, &xSigAction, NULL );
+
+    /* The kernel has already assigned a task to every core. */
+    for( xCoreID = 0; xCoreID < configNUMBER_OF_CORES; xCoreID++ )
+    {
+        __atomic_store_n( &( pxCoreThreads[ xCoreID ] ),
+                          prvGetThreadFromTask( xTaskGetCurrentTaskHandleForCore( xCoreID ) ),
+                          __ATOMIC_SEQ_CST );
+    }
+
+    for( xCoreID = 0; xCoreID < configNUMBER_OF_CORES; xCoreID++ )
+    {
+        prvResumeThread( pxCoreThreads[ xCoreID ], xCoreID );
+    }
+
+    ( void ) pthread_create( &xTickThread, NULL, prvTickThread, NULL );
+
+    ( void ) pthread_mutex_lock( &xEndSchedulerMutex );
+
+    while( xSchedulerEnded == pdFALSE )
+    {
+        ( void ) pthread_cond_wait( &xEndSchedulerCond, &xEndSchedulerMutex );
+    }
+
+    ( void ) pthread_mutex_unlock( &xEndSchedulerMutex );
+
+    ( void ) pthread_join( xTickThread, NULL );
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+    /* The tasks are left running; the application is expected to exit. */
+    ( void ) pthread_mutex_lock( &xEndSchedulerMutex );
+    __atomic_store_n( &xSchedulerEnded, pdTRUE, __ATOMIC_SEQ_CST );
+    ( void ) pthread_cond_signal( &xEndSchedulerCond );
+    ( void ) pthread_mutex_unlock( &xEndSchedulerMutex );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortGetCoreID( void )
+{
+    return xThisCoreID;
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldCore( BaseType_t xCoreID )
+{
+    __atomic_store_n( &( xYieldRequests[ xCoreID ] ), pdTRUE, __ATOMIC_SEQ_CST );
+    prvInterruptCore( xCoreID );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortSetInterruptMask( void )
+{
+    UBaseType_t uxPreviouslyMasked = uxInterruptsMasked;
+
+    if( uxPreviouslyMasked == pdFALSE )
+    {
+        prvSetInterruptSignalMask( SIG_BLOCK, NULL );
+        uxInterruptsMasked = pdTRUE;
+    }
+
+    return uxPreviouslyMasked;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxMask )
+{
+    if( ( uxMask == pdFALSE ) && ( uxInterruptsMasked != pdFALSE ) )
+    {
+        uxInterruptsMasked = pdFALSE;
+
+        /* Any interrupt that arrived while masked is taken here. */
+        prvSetInterruptSignalMask( SIG_UNBLOCK, NULL );
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortCheckIfInISR( void )
+{
+    return xInInterrupt;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetTaskLock( void )
+{
+    ( void ) pthread_mutex_lock( &xTaskLock );
+}
+/*-----------------------------------------------------------*/
+
+void vPortReleaseTaskLock( void )
+{
+    ( void ) pthread_mutex_unlock( &xTaskLock );
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetISRLock( void )
+{
+    ( void ) pthread_mutex_lock( &xISRLock );
+}
+/*-----------------------------------------------------------*/
+
+void vPortReleaseISRLock( void )
+{
+    ( void ) pthread_mutex_unlock( &xISRLock );
+}
+/*-----------------------------------------------------------*/
+
+void vPortCancelThread( void * pxTaskToDelete )
+{
+    Thread_t * pxThread = prvGetThreadFromTask( ( TaskHandle_t ) pxTaskToDelete );
+    UBaseType_t uxSavedInterruptStatus;
+
+    /* The kernel only frees a task that is not running, so its thread is
+     * asleep in prvSuspendSelf(), or about to be.  Interrupts stay masked so
+     * this thread cannot be switched out while holding the lifetime lock. */
+    uxSavedInterruptStatus = uxPortSetInterruptMask();
+    ( void ) pthread_rwlock_wrlock( &xThreadLifetimeLock );
+
+    ( void ) pthread_mutex_lock( &( pxThread->xMutex ) );
+    pxThread->xDying = pdTRUE;
+    ( void ) pthread_cond_signal( &( pxThread->xCond ) );
+    ( void ) pthread_mutex_unlock( &( pxThread->xMutex ) );
+
+    ( void ) pthread_join( pxThread->xPthread, NULL );
+
+    ( void ) pthread_rwlock_unlock( &xThreadLifetimeLock );
+    vPortClearInterruptMask( uxSavedInterruptStatus );
+
+    ( void ) pthread_cond_destroy( &( pxThread->xCond ) );
+    ( void ) pthread_mutex_destroy( &( pxThread->xMutex ) );
+}
+/*-----------------------------------------------------------*/
+
+static Thread_t * prvGetThreadFromTask( TaskHandle_t xTask )
+{
+    /* The first member of the TCB is the value pxPortInitialiseStack()
+     * returned, which sits just below the thread data. */
+    StackType_t * pxTopOfStack = *( StackType_t ** ) xTask;
+
+    return ( Thread_t * ) ( pxTopOfStack + 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetInterruptSignalMask( int iHow,
+                                       sigset_t * pxOldMask )
+{
+    sigset_t xSignals;
+
+    ( void ) sigemptyset( &xSignals );
+    ( void ) sigaddset( &xSignals, portINTERRUPT_SIGNAL );
+    ( void ) pthread_sigmask( iHow, &xSignals, pxOldMask );
+}
+/*-----------------------------------------------------------*/
+
+static void prvResumeThread( Thread_t * pxThread,
+                             BaseType_t xCoreID )
+{
+    ( void ) pthread_mutex_lock( &( pxThread->xMutex ) );
+    pxThread->xCoreID = xCoreID;
+    pxThread->xResumed = pdTRUE;
+    ( void ) pthread_cond_signal( &( pxThread->xCond ) );
+    ( void ) pthread_mutex_unlock( &( pxThread->xMutex ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendSelf( Thread_t * pxThread )
+{
+    BaseType_t xDying;
+
+    /* The thread may already have been selected again by another core, in
+     * which case xResumed is set and this returns straight away. */
+    ( void ) pthread_mutex_lock( &( pxThread->xMutex ) );
+
+    while( ( pxThread->xResumed == pdFALSE ) && ( pxThread->xDying == pdFALSE ) )
+    {
+        ( void ) pthread_cond_wait( &( pxThread->xCond ), &( pxThread->xMutex ) );
+    }
+
+    pxThread->xResumed = pdFALSE;
+    xDying = pxThread->xDying;
+    xThisCoreID = pxThread->xCoreID;
+
+    ( void ) pthread_mutex_unlock( &( pxThread->xMutex ) );
+
+    if( xDying != pdFALSE )
+    {
+        pthread_exit( NULL );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptCore( BaseType_t xCoreID )
+{
+    Thread_t * pxThread;
+
+    /* The request flag is written before the running thread is read, and a
+     * thread handing over a core writes pxCoreThreads[] before resuming the
+     * next thread, which checks the flags once it runs.  So either the signal
+     * reaches the new thread, or the new thread sees the flag anyway. */
+    ( void ) pthread_rwlock_rdlock( &xThreadLifetimeLock );
+
+    pxThread = __atomic_load_n( &( pxCoreThreads[ xCoreID ] ), __ATOMIC_SEQ_CST );
+
+    if( pxThread != NULL )
+    {
+        ( void ) pthread_kill( pxThread->xPthread, portINTERRUPT_SIGNAL );
+    }
+
+    ( void ) pthread_rwlock_unlock( &xThreadLifetimeLock );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvInterruptPending( BaseType_t xCoreID )
+{
+    BaseType_t xPending = __atomic_load_n( &( xYieldRequests[ xCoreID ] ), __ATOMIC_SEQ_CST );
+
+    if( ( xCoreID == configTICK_CORE ) &&
+        ( __atomic_load_n( &uxPendingTicks, __ATOMIC_SEQ_CST ) != 0U ) )
+    {
+        xPending = pdTRUE;
+    }
+
+    return xPending;
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessTicks( BaseType_t xCoreID )
+{
+    UBaseType_t uxTicks = __atomic_exchange_n( &uxPendingTicks, 0, __ATOMIC_SEQ_CST );
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t xSwitchRequired = pdFALSE;
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        /* Ticks missed while the host did not schedule this thread are
+         * caught up here rather than lost. */
+        while( uxTicks > 0U )
+        {
+            if( xTaskIncrementTick() != pdFALSE )
+            {
+                xSwitchRequired = pdTRUE;
+            }
+
+            uxTicks--;
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    if( xSwitchRequired != pdFALSE )
+    {
+        __atomic_store_n( &( xYieldRequests[ xCoreID ] ), pdTRUE, __ATOMIC_SEQ_CST );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchContext( BaseType_t xCoreID )
+{
+    Thread_t * pxCurrentThread = pxThisThread;
+    Thread_t * pxNextThread;
+
+    vTaskSwitchContext( xCoreID );
+
+    /* Only the thread running on xCoreID switches its context, so the
+     * selected task cannot change under our feet. */
+    pxNextThread = prvGetThreadFromTask( xTaskGetCurrentTaskHandleForCore( xCoreID ) );
+
+    if( pxNextThread != pxCurrentThread )
+    {
+        __atomic_store_n( &( pxCoreThreads[ xCoreID ] ), pxNextThread, __ATOMIC_SEQ_CST );
+        prvResumeThread( pxNextThread, xCoreID );
+
+        /* Returns when this task is selected again, possibly on another
+         * core. */
+        prvSuspendSelf( pxCurrentThread );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptHandler( int iSignal )
+{
+    UBaseType_t uxSavedInterruptsMasked = uxInterruptsMasked;
+    BaseType_t xSavedInInterrupt = xInInterrupt;
+    BaseType_t xCoreID;
+    BaseType_t xWorkDone;
+
+    ( void ) iSignal;
+
+    /* All signals are blocked while the handler runs. */
+    uxInterruptsMasked = pdTRUE;
+    xInInterrupt = pdTRUE;
+
+    do
+    {
+        /* Re-read each time as a context switch can resume this thread on a
+         * different core. */
+        xCoreID = xThisCoreID;
+        xWorkDone = pdFALSE;
+
+        if( ( xCoreID == configTICK_CORE ) &&
+            ( __atomic_load_n( &uxPendingTicks, __ATOMIC_SEQ_CST ) != 0U ) )
+        {
+            prvProcessTicks( xCoreID );
+            xWorkDone = pdTRUE;
+        }
+
+        if( __atomic_exchange_n( &( xYieldRequests[ xCoreID ] ), pdFALSE, __ATOMIC_SEQ_CST ) != pdFALSE )
+        {
+            prvSwitchContext( xCoreID );
+            xWorkDone = pdTRUE;
+        }
+    } while( xWorkDone != pdFALSE );
+
+    xInInterrupt = xSavedInInterrupt;
+    uxInterruptsMasked = uxSavedInterruptsMasked;
+}
+/*-----------------------------------------------------------*/
+
+static void * prvThreadStart( void * pvParams )
+{
+    Thread_t * pxThread = ( Thread_t * ) pvParams;
+
+    pxThisThread = pxThread;
+    uxInterruptsMasked = pdTRUE;
+
+    /* Wait to be selected to run for the first time. */
+    prvSuspendSelf( pxThread );
+
+    /* An interrupt raised while the core was being handed over may have been
+     * sent to the previous thread, so look for one before enabling
+     * interrupts. */
+    if( prvInterruptPending( xThisCoreID ) != pdFALSE )
+    {
+        ( void ) pthread_kill( pthread_self(), portINTERRUPT_SIGNAL );
+    }
+
+    vPortClearInterruptMask( pdFALSE );
+
+    pxThread->pxCode( pxThread->pvParams );
+
+    /* A task function must not return, but if it does delete the task.  The
+     * thread exits once the kernel reclaims the task. */
+    vTaskDelete( NULL );
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void * prvTickThread( void * pvParams )
+{
+    struct timespec xNextTick;
+
+    ( void ) pvParams;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNextTick );
+
+    while( __atomic_load_n( &xSchedulerEnded, __ATOMIC_SEQ_CST ) == pdFALSE )
+    {
+        xNextTick.tv_nsec += portNANOSECONDS_PER_TICK;
+
+        if( xNextTick.tv_nsec >= portNANOSECONDS_PER_SECOND )
+        {
+            xNextTick.tv_nsec -= portNANOSECONDS_PER_SECOND;
+            xNextTick.tv_sec++;
+        }
+
+        while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &xNextTick, NULL ) == EINTR )
+        {
+        }
+
+        ( void ) __atomic_add_fetch( &uxPendingTicks, 1U, __ATOMIC_SEQ_CST );
+        prvInterruptCore( configTICK_CORE );
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,186 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file portmacro.h
+ * @brief Port definitions for the Posix SMP simulation port.
+ *
+ * Every FreeRTOS task is backed by a host pthread and every simulated core
+ * is whichever task thread the scheduler last selected for it, so up to
+ * configNUMBER_OF_CORES tasks execute truly in parallel on the host.  The
+ * interrupt controller is modelled with a single signal (see port.c).
+ *
+ * The port implements the V11 SMP port interface: portGET_CORE_ID(),
+ * portYIELD_CORE(), the recursive task and ISR locks and the per-core
+ * critical nesting counts.
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+#include <stdint.h>
+
+/*-----------------------------------------------------------
+ * Port specific definitions.
+ *
+ * The settings in this file configure FreeRTOS correctly for the given
+ * hardware and compiler.
+ *
+ * These settings should not be altered.
+ *-----------------------------------------------------------
+ */
+
+/* Type definitions. */
+#define portCHAR                   char
+#define portFLOAT                  float
+#define portDOUBLE                 double
+#define portLONG                   long
+#define portSHORT                  short
+#define portSTACK_TYPE             uintptr_t
+#define portBASE_TYPE              long
+#define portPOINTER_SIZE_TYPE      uintptr_t
+
+typedef portSTACK_TYPE   StackType_t;
+typedef long             BaseType_t;
+typedef unsigned long    UBaseType_t;
+
+typedef uint32_t         TickType_t;
+#define portMAX_DELAY              ( TickType_t ) 0xffffffffUL
+
+/* 32-bit tick type on a 32 or 64-bit architecture, so reads of the tick
+ * count do not need to be guarded with a critical section. */
+#define portTICK_TYPE_IS_ATOMIC    1
+/*-----------------------------------------------------------*/
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH           ( -1 )
+#define portTICK_PERIOD_MS         ( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT         8
+#define portNOP()                  __asm volatile ( "nop" )
+#define portMEMORY_BARRIER()       __sync_synchronize()
+/*-----------------------------------------------------------*/
+
+/* Multi-core. */
+#define portMAX_CORE_COUNT         16
+
+#if ( configNUMBER_OF_CORES > portMAX_CORE_COUNT )
+    #error The Posix SMP simulation port supports at most portMAX_CORE_COUNT cores.
+#endif
+
+BaseType_t xPortGetCoreID( void );
+void vPortYieldCore( BaseType_t xCoreID );
+
+#define portGET_CORE_ID()          xPortGetCoreID()
+#define portYIELD_CORE( xCoreID )  vPortYieldCore( xCoreID )
+/*-----------------------------------------------------------*/
+
+/* Scheduler utilities. */
+#define portYIELD()                vPortYieldCore( xPortGetCoreID() )
+
+#define portEND_SWITCHING_ISR( xSwitchRequired ) \
+    do {                                         \
+        if( ( xSwitchRequired ) != pdFALSE )     \
+        {                                        \
+            portYIELD();                         \
+        }                                        \
+    } while( 0 )
+#define portYIELD_FROM_ISR( x )    portEND_SWITCHING_ISR( x )
+/*-----------------------------------------------------------*/
+
+/* Interrupt masking.  Masking blocks the simulated interrupt signal on the
+ * calling thread only, exactly as masking interrupts on a real core leaves the
+ * other cores free to take interrupts. */
+UBaseType_t uxPortSetInterruptMask( void );
+void vPortClearInterruptMask( UBaseType_t uxMask );
+BaseType_t xPortCheckIfInISR( void );
+
+#define portSET_INTERRUPT_MASK()                 uxPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK( uxMask )       vPortClearInterruptMask( uxMask )
+#define portSET_INTERRUPT_MASK_FROM_ISR()        uxPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )   vPortClearInterruptMask( x )
+#define portDISABLE_INTERRUPTS()                 ( void ) uxPortSetInterruptMask()
+#define portENABLE_INTERRUPTS()                  vPortClearInterruptMask( pdFALSE )
+#define portCHECK_IF_IN_ISR()                    xPortCheckIfInISR()
+/*-----------------------------------------------------------*/
+
+/* Critical sections.  The SMP kernel implements these in terms of the
+ * interrupt mask, the locks and the nesting counts below. */
+extern void vTaskEnterCritical( void );
+extern void vTaskExitCritical( void );
+extern UBaseType_t vTaskEnterCriticalFromISR( void );
+extern void vTaskExitCriticalFromISR( UBaseType_t uxSavedInterruptStatus );
+
+#define portENTER_CRITICAL()                     vTaskEnterCritical()
+#define portEXIT_CRITICAL()                      vTaskExitCritical()
+#define portENTER_CRITICAL_FROM_ISR()            vTaskEnterCriticalFromISR()
+#define portEXIT_CRITICAL_FROM_ISR( x )          vTaskExitCriticalFromISR( x )
+
+extern UBaseType_t uxPortCriticalNesting[ configNUMBER_OF_CORES ];
+
+#define portGET_CRITICAL_NESTING_COUNT()         ( uxPortCriticalNesting[ portGET_CORE_ID() ] )
+#define portSET_CRITICAL_NESTING_COUNT( x )      ( uxPortCriticalNesting[ portGET_CORE_ID() ] = ( x ) )
+#define portINCREMENT_CRITICAL_NESTING_COUNT()   ( uxPortCriticalNesting[ portGET_CORE_ID() ]++ )
+#define portDECREMENT_CRITICAL_NESTING_COUNT()   ( uxPortCriticalNesting[ portGET_CORE_ID() ]-- )
+/*-----------------------------------------------------------*/
+
+/* Locks.  Both locks are recursive, as the kernel may take them again on the
+ * same core, for example when the tick interrupt arrives while the scheduler
+ * is suspended. */
+void vPortGetTaskLock( void );
+void vPortReleaseTaskLock( void );
+void vPortGetISRLock( void );
+void vPortReleaseISRLock( void );
+
+#define portGET_TASK_LOCK()                      vPortGetTaskLock()
+#define portRELEASE_TASK_LOCK()                  vPortReleaseTaskLock()
+#define portGET_ISR_LOCK()                       vPortGetISRLock()
+#define portRELEASE_ISR_LOCK()                   vPortReleaseISRLock()
+/*-----------------------------------------------------------*/
+
+/* Task deletion.  The thread backing a deleted task is reclaimed when the
+ * kernel frees the task. */
+void vPortCancelThread( void * pxTaskToDelete );
+#define portCLEAN_UP_TCB( pxTCB )                vPortCancelThread( pxTCB )
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters )    void vFunction( void * pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters )          void vFunction( void * pvParameters )
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,57 @@
+# Builds the FreeRTOS kernel for the Posix SMP simulation port in ./port.
+#
+# Unlike the kernel's own Posix port, which only ever runs one task at a time,
+# this port runs configNUMBER_OF_CORES tasks in parallel on host threads, so
+# the SMP tests exercise real concurrency on a Linux host.
+# It should be include()ed after project().
+
+set(BOARD_LINK_LIBRARIES unity Threads::Threads)
+set(BOARD_DEFINES "")
+set(BOARD_INCLUDE_PATHS "${UNITY_DIR}/src/"
+                        ${CMAKE_CURRENT_LIST_DIR})
+set(BOARD_LIBRARY_DIR ${CMAKE_CURRENT_LIST_DIR} CACHE INTERNAL "")
+
+if (DEFINED ENV{FREERTOS_KERNEL_PATH} AND (NOT FREERTOS_KERNEL_PATH))
+    set(FREERTOS_KERNEL_PATH $ENV{FREERTOS_KERNEL_PATH})
+    message("Using FREERTOS_KERNEL_PATH from environment ('${FREERTOS_KERNEL_PATH}')")
+endif ()
+
+if (NOT FREERTOS_KERNEL_PATH)
+    get_filename_component(FREERTOS_KERNEL_PATH ${CMAKE_CURRENT_LIST_DIR}/../../../../Source REALPATH)
+endif ()
+
+if (NOT EXISTS ${FREERTOS_KERNEL_PATH}/tasks.c)
+    message(FATAL_ERROR "Directory '${FREERTOS_KERNEL_PATH}' does not contain the FreeRTOS kernel. Please set FREERTOS_KERNEL_PATH.")
+endif ()
+
+set(FREERTOS_KERNEL_PATH ${FREERTOS_KERNEL_PATH} CACHE PATH "Path to the FreeRTOS Kernel" FORCE)
+
+set(THREADS_PREFER_PTHREAD_FLAG ON)
+find_package(Threads REQUIRED)
+
+# The kernel is compiled into each test, as every test has its own test_config.h.
+add_library(FreeRTOS-Kernel INTERFACE)
+target_sources(FreeRTOS-Kernel INTERFACE
+        ${FREERTOS_KERNEL_PATH}/event_groups.c
+        ${FREERTOS_KERNEL_PATH}/list.c
+        ${FREERTOS_KERNEL_PATH}/queue.c
+        ${FREERTOS_KERNEL_PATH}/stream_buffer.c
+        ${FREERTOS_KERNEL_PATH}/tasks.c
+        ${FREERTOS_KERNEL_PATH}/timers.c
+        ${CMAKE_CURRENT_LIST_DIR}/port/port.c)
+target_include_directories(FreeRTOS-Kernel INTERFACE
+        ${FREERTOS_KERNEL_PATH}/include
+        ${CMAKE_CURRENT_LIST_DIR}/port)
+target_link_libraries(FreeRTOS-Kernel INTERFACE Threads::Threads)
+
+add_library(FreeRTOS-Kernel-Heap4 INTERFACE)
+target_sources(FreeRTOS-Kernel-Heap4 INTERFACE
+        ${FREERTOS_KERNEL_PATH}/portable/MemMang/heap_4.c)
+
+macro(enable_board_functions EXECUTABLE_NAME)
+    # The sources come from the test's INTERFACE library, but CMake needs the
+    # executable to name at least one itself. CMake builds main.c only once.
+    target_sources(${EXECUTABLE_NAME} PRIVATE ${BOARD_LIBRARY_DIR}/main.c)
+    add_test(NAME ${EXECUTABLE_NAME} COMMAND ${EXECUTABLE_NAME})
+    set_tests_properties(${EXECUTABLE_NAME} PROPERTIES TIMEOUT 300)
+endmacro()
@@ -0,0 +1,109 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file benchmark_test_runner.c
+ * @brief The implementation of test runner task which runs the benchmarks.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h" /* Must come first. */
+#include "task.h"     /* RTOS task related API prototypes. */
+
+/* Unity includes. */
+#include "unity.h"
+
+/* Benchmark includes. */
+#include "benchmark.h"
+
+/* Standard includes. */
+#include <stdlib.h>
+#include <time.h>
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The task that runs the test.
+ */
+static void prvTestRunnerTask( void * pvParameters );
+
+/**
+ * @brief Returns a free running count of CPU cycles, used by the benchmarks
+ *        to measure time.
+ *
+ * The host clock frequency is not known, so nanoseconds of the monotonic
+ * clock are reported instead, i.e. cycles of a nominal 1GHz core.
+ */
+uint32_t ulTestGetCycleCount( void );
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The board description reported with the results.  The POSIX port
+ *        has no interrupt the test can trigger, so the interrupt latency
+ *        benchmarks are skipped.
+ */
+static const BenchmarkBoard_t xBoard =
+{
+    .pcName             = "posix",
+    .ulCycleHz          = 1000000000UL,
+    .pxTriggerInterrupt = NULL,
+    .pxBenchmarks       = NULL,
+    .uxBenchmarks       = 0
+};
+/*-----------------------------------------------------------*/
+
+uint32_t ulTestGetCycleCount( void )
+{
+    struct timespec xNow;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint32_t ) ( ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTestRunnerTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    /* Run the benchmarks. */
+    vRunBenchmarks( &xBoard );
+
+    /* Report the result to the test driver through the exit status. */
+    exit( ( Unity.TestFailures == 0U ) ? EXIT_SUCCESS : EXIT_FAILURE );
+}
+/*-----------------------------------------------------------*/
+
+void vRunTest( void )
+{
+    xTaskCreate( prvTestRunnerTask,
+                 "testRunner",
+                 configMINIMAL_STACK_SIZE * 4, /* The test calls printf(). */
+                 NULL,
+                 configMAX_PRIORITIES - 1,
+                 NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,768 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file benchmark.c
+ * @brief Run performance benchmarks on a board and report the results in a
+ *        machine readable form, so runs can be compared between releases.
+ *
+ * Procedure:
+ *   - The runner lowers its own priority to benchmarkRUNNER_PRIORITY and, on
+ *     an SMP build, pins itself and every task it creates to core 0.
+ *   - Each registered benchmark fills benchmarkSAMPLES samples, in cycles.
+ *     Benchmarks that repeat an operation average benchmarkITERATIONS
+ *     operations in each sample.
+ *   - The kernel benchmarks are:
+ *       - ipc/queue_send_receive: send to and receive from a queue, without a
+ *         context switch.
+ *       - ipc/queue_round_trip: send a value to a higher priority task that
+ *         returns it on a second queue.
+ *       - ipc/semaphore_round_trip: as above with binary semaphores.
+ *       - ipc/notify_round_trip: as above with direct to task notifications.
+ *       - ipc/mutex_take_give: take and give a mutex nobody else holds.
+ *       - isr_latency/isr_entry: from triggering an interrupt to its handler
+ *         running.
+ *       - isr_latency/isr_to_task: from the handler giving a semaphore to the
+ *         higher priority task blocked on it running.
+ *   - The board's own benchmarks, if any, are run after the kernel ones.
+ *   - Each benchmark is run as a Unity test, so a failed assertion fails the
+ *     test run.
+ * Expected:
+ *   - Every operation completes with the expected value.
+ *
+ * Results are printed one per line, each line being a keyword followed by a
+ * JSON object, so they can be picked out of other console output:
+ *
+ *   BENCHMARK_START {"format":1,"board":"posix","kernel":"V11.0.0",...}
+ *   BENCHMARK_RESULT {"suite":"ipc","name":"queue_round_trip","unit":"cycles",
+ *                     "samples":32,"min":..,"median":..,"mean":..,"max":..}
+ *   BENCHMARK_SKIPPED {"suite":"isr_latency","name":"isr_entry"}
+ *   BENCHMARK_FAILED {"suite":..,"name":..}
+ *   BENCHMARK_END {"results":7,"skipped":0,"failed":0}
+ *
+ * (A result is printed on a single line.)  ../../tools/benchmark.py
+ * collects these lines from a console log and compares two runs.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h" /* Must come first. */
+#include "task.h"     /* RTOS task related API prototypes. */
+#include "queue.h"    /* RTOS queue related API prototypes. */
+#include "semphr.h"   /* Semaphore related API prototypes. */
+
+/* Unity includes. */
+#include "unity.h"
+
+/* Benchmark includes. */
+#include "benchmark.h"
+/*-----------------------------------------------------------*/
+
+#ifndef TEST_CONFIG_H
+    #error test_config.h must be included at the end of FreeRTOSConfig.h.
+#endif
+
+#if ( configMAX_PRIORITIES <= 3 )
+    #error configMAX_PRIORITIES must be larger than 3 so the benchmark tasks run above the idle task.
+#endif /* if ( configMAX_PRIORITIES <= 3 ) */
+
+#if ( configUSE_MUTEXES != 1 )
+    #error configUSE_MUTEXES must be set to 1 for this test.
+#endif /* if ( configUSE_MUTEXES != 1 ) */
+
+#if ( INCLUDE_vTaskPrioritySet != 1 )
+    #error INCLUDE_vTaskPrioritySet must be set to 1 for this test.
+#endif /* if ( INCLUDE_vTaskPrioritySet != 1 ) */
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Version of the output format.  Increment it if a change would stop
+ *        results being compared with those from an earlier version.
+ */
+#define benchmarkFORMAT_VERSION         ( 1 )
+
+/**
+ * @brief Priority of the task running the benchmarks, and of the task it
+ *        exchanges messages with, which runs as soon as it is unblocked.
+ */
+#define benchmarkRUNNER_PRIORITY        ( configMAX_PRIORITIES - 3 )
+#define benchmarkPARTNER_PRIORITY       ( configMAX_PRIORITIES - 2 )
+
+/**
+ * @brief Longest time any single operation may take before the benchmark
+ *        fails.
+ */
+#define benchmarkTIMEOUT                pdMS_TO_TICKS( 1000 )
+
+/**
+ * @brief Time given to the idle task to free the memory of deleted tasks.
+ */
+#define benchmarkCLEAN_UP_DELAY         pdMS_TO_TICKS( 20 )
+
+/**
+ * @brief Number of cores, reported with the results.
+ */
+#ifdef configNUMBER_OF_CORES
+    #define benchmarkNUMBER_OF_CORES    ( configNUMBER_OF_CORES )
+#else
+    #define benchmarkNUMBER_OF_CORES    ( 1 )
+#endif
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief What the partner task does each time it is unblocked.
+ */
+typedef enum
+{
+    eEchoQueue,     /* Receive from xRequestQueue, send to xReplyQueue. */
+    eEchoSemaphore, /* Take xRequestSemaphore, give xReplySemaphore. */
+    eEchoNotify,    /* Take a notification, notify the runner. */
+    eWakeFromISR    /* Take xInterruptSemaphore, record the time, notify the runner. */
+} PartnerMode_t;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The task the runner exchanges messages with.
+ */
+static void prvPartnerTask( void * pvParameters );
+
+/**
+ * @brief Create the partner task in eMode, pinned as the runner is.
+ */
+static void prvCreatePartner( PartnerMode_t eMode );
+
+/**
+ * @brief Delete the partner task and let the idle task free it.
+ */
+static void prvDeletePartner( void );
+
+/**
+ * @brief Run the benchmark in pxCurrentBenchmark, as a Unity test.
+ */
+static void prvRunCurrentBenchmark( void );
+
+/**
+ * @brief Report the samples of a completed benchmark.
+ */
+static void prvReportResult( const Benchmark_t * pxBenchmark,
+                             uint32_t * pulSamples,
+                             UBaseType_t uxSamples );
+
+/**
+ * @brief Report a benchmark that was skipped or failed.
+ */
+static void prvReportOutcome( const char * pcKeyword,
+                              const Benchmark_t * pxBenchmark );
+
+/**
+ * @brief Time one interrupt, returning the cycles from triggering it to the
+ *        handler running through pulEntry, and from the handler running to
+ *        the task it woke running through pulWake.
+ */
+static void prvTimeInterrupt( uint32_t * pulEntry,
+                              uint32_t * pulWake );
+
+/**
+ * @brief Kernel benchmarks.
+ */
+static BaseType_t prvQueueSendReceive( uint32_t * pulSamples,
+                                       UBaseType_t uxSamples );
+static BaseType_t prvQueueRoundTrip( uint32_t * pulSamples,
+                                     UBaseType_t uxSamples );
+static BaseType_t prvSemaphoreRoundTrip( uint32_t * pulSamples,
+                                         UBaseType_t uxSamples );
+static BaseType_t prvNotifyRoundTrip( uint32_t * pulSamples,
+                                      UBaseType_t uxSamples );
+static BaseType_t prvMutexTakeGive( uint32_t * pulSamples,
+                                    UBaseType_t uxSamples );
+static BaseType_t prvInterruptEntry( uint32_t * pulSamples,
+                                     UBaseType_t uxSamples );
+static BaseType_t prvInterruptToTask( uint32_t * pulSamples,
+                                      UBaseType_t uxSamples );
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The benchmarks run on every board.
+ */
+static const Benchmark_t xKernelBenchmarks[] =
+{
+    { "ipc",         "queue_send_receive",   prvQueueSendReceive   },
+    { "ipc",         "queue_round_trip",     prvQueueRoundTrip     },
+    { "ipc",         "semaphore_round_trip", prvSemaphoreRoundTrip },
+    { "ipc",         "notify_round_trip",    prvNotifyRoundTrip    },
+    { "ipc",         "mutex_take_give",      prvMutexTakeGive      },
+    { "isr_latency", "isr_entry",            prvInterruptEntry     },
+    { "isr_latency", "isr_to_task",          prvInterruptToTask    }
+};
+
+/**
+ * @brief The board being benchmarked.
+ */
+static const BenchmarkBoard_t * pxCurrentBoard = NULL;
+
+/**
+ * @brief The benchmark being run, and what it returned.
+ */
+static const Benchmark_t * pxCurrentBenchmark = NULL;
+static BaseType_t xCurrentOutcome = benchmarkSKIPPED;
+
+/**
+ * @brief Samples of the benchmark being run.
+ */
+static uint32_t ulSamples[ benchmarkSAMPLES ];
+
+/**
+ * @brief The task running the benchmarks, and its partner.
+ */
+static TaskHandle_t xRunnerTask = NULL;
+static TaskHandle_t xPartnerTask = NULL;
+
+/**
+ * @brief Objects the runner and its partner exchange messages through.
+ */
+static QueueHandle_t xRequestQueue = NULL;
+static QueueHandle_t xReplyQueue = NULL;
+static SemaphoreHandle_t xRequestSemaphore = NULL;
+static SemaphoreHandle_t xReplySemaphore = NULL;
+static SemaphoreHandle_t xInterruptSemaphore = NULL;
+static SemaphoreHandle_t xMutex = NULL;
+
+/**
+ * @brief Set if the partner task received an unexpected value.
+ */
+static volatile BaseType_t xPartnerError = pdFALSE;
+
+/**
+ * @brief Cycle counts written by the interrupt handler and by the partner
+ *        task it wakes.
+ */
+static volatile uint32_t ulInterruptEntryTime = 0;
+static volatile uint32_t ulPartnerWakeTime = 0;
+
+/**
+ * @brief Number of benchmarks reported each way.
+ */
+static UBaseType_t uxResults = 0;
+static UBaseType_t uxSkipped = 0;
+static UBaseType_t uxFailed = 0;
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvQueueSendReceive( uint32_t * pulSamples,
+                                       UBaseType_t uxSamples )
+{
+    UBaseType_t uxSample;
+    uint32_t x, ulValue, ulStart;
+
+    for( uxSample = 0; uxSample < uxSamples; uxSample++ )
+    {
+        ulStart = ulTestGetCycleCount();
+
+        for( x = 0; x < benchmarkITERATIONS; x++ )
+        {
+            ( void ) xQueueSend( xRequestQueue, &x, 0 );
+            ( void ) xQueueReceive( xRequestQueue, &ulValue, 0 );
+        }
+
+        pulSamples[ uxSample ] = ( ulTestGetCycleCount() - ulStart ) / benchmarkITERATIONS;
+
+        /* Checked once per sample, outside the timed loop. */
+        TEST_ASSERT_EQUAL_UINT32( benchmarkITERATIONS - 1U, ulValue );
+    }
+
+    return benchmarkCOMPLETE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvQueueRoundTrip( uint32_t * pulSamples,
+                                     UBaseType_t uxSamples )
+{
+    UBaseType_t uxSample;
+    uint32_t x, ulValue = 0, ulStart;
+    BaseType_t xResult = pdPASS;
+
+    prvCreatePartner( eEchoQueue );
+
+    for( uxSample = 0; uxSample < uxSamples; uxSample++ )
+    {
+        ulStart = ulTestGetCycleCount();
+
+        for( x = 0; ( x < benchmarkITERATIONS ) && ( xResult == pdPASS ); x++ )
+        {
+            ( void ) xQueueSend( xRequestQueue, &x, benchmarkTIMEOUT );
+            xResult = xQueueReceive( xReplyQueue, &ulValue, benchmarkTIMEOUT );
+        }
+
+        pulSamples[ uxSample ] = ( ulTestGetCycleCount() - ulStart ) / benchmarkITERATIONS;
+
+        TEST_ASSERT_EQUAL_MESSAGE( pdPASS, xResult, "Partner did not reply." );
+        TEST_ASSERT_EQUAL_UINT32( benchmarkITERATIONS - 1U, ulValue );
+    }
+
+    prvDeletePartner();
+
+    return benchmarkCOMPLETE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSemaphoreRoundTrip( uint32_t * pulSamples,
+                                         UBaseType_t uxSamples )
+{
+    UBaseType_t uxSample;
+    uint32_t x, ulStart;
+    BaseType_t xResult = pdPASS;
+
+    prvCreatePartner( eEchoSemaphore );
+
+    for( uxSample = 0; uxSample < uxSamples; uxSample++ )
+    {
+        ulStart = ulTestGetCycleCount();
+
+        for( x = 0; ( x < benchmarkITERATIONS ) && ( xResult == pdPASS ); x++ )
+        {
+            ( void ) xSemaphoreGive( xRequestSemaphore );
+            xResult = xSemaphoreTake( xReplySemaphore, benchmarkTIMEOUT );
+        }
+
+        pulSamples[ uxSample ] = ( ulTestGetCycleCount() - ulStart ) / benchmarkITERATIONS;
+
+        TEST_ASSERT_EQUAL_MESSAGE( pdPASS, xResult, "Partner did not reply." );
+    }
+
+    prvDeletePartner();
+
+    return benchmarkCOMPLETE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNotifyRoundTrip( uint32_t * pulSamples,
+                                      UBaseType_t uxSamples )
+{
+    UBaseType_t uxSample;
+    uint32_t x, ulStart, ulNotified = 1;
+
+    prvCreatePartner( eEchoNotify );
+
+    for( uxSample = 0; uxSample < uxSamples; uxSample++ )
+    {
+        ulStart = ulTestGetCycleCount();
+
+        for( x = 0; ( x < benchmarkITERATIONS ) && ( ulNotified != 0U ); x++ )
+        {
+            ( void ) xTaskNotifyGive( xPartnerTask );
+            ulNotified = ulTaskNotifyTake( pdTRUE, benchmarkTIMEOUT );
+        }
+
+        pulSamples[ uxSample ] = ( ulTestGetCycleCount() - ulStart ) / benchmarkITERATIONS;
+
+        TEST_ASSERT_NOT_EQUAL_MESSAGE( 0U, ulNotified, "Partner did not reply." );
+    }
+
+    prvDeletePartner();
+
+    return benchmarkCOMPLETE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvMutexTakeGive( uint32_t * pulSamples,
+                                    UBaseType_t uxSamples )
+{
+    UBaseType_t uxSample;
+    uint32_t x, ulStart;
+    BaseType_t xResult = pdPASS;
+
+    for( uxSample = 0; uxSample < uxSamples; uxSample++ )
+    {
+        ulStart = ulTestGetCycleCount();
+
+        for( x = 0; ( x < benchmarkITERATIONS ) && ( xResult == pdPASS ); x++ )
+        {
+            xResult = xSemaphoreTake( xMutex, 0 );
+            ( void ) xSemaphoreGive( xMutex );
+        }
+
+        pulSamples[ uxSample ] = ( ulTestGetCycleCount() - ulStart ) / benchmarkITERATIONS;
+
+        TEST_ASSERT_EQUAL_MESSAGE( pdPASS, xResult, "Mutex was not available." );
+    }
+
+    return benchmarkCOMPLETE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimeInterrupt( uint32_t * pulEntry,
+                              uint32_t * pulWake )
+{
+    uint32_t ulStart;
+
+    ulInterruptEntryTime = 0;
+    ulPartnerWakeTime = 0;
+    ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+
+    ulStart = ulTestGetCycleCount();
+    pxCurrentBoard->pxTriggerInterrupt();
+
+    /* The partner notifies once it has recorded when it ran. */
+    TEST_ASSERT_NOT_EQUAL_MESSAGE( 0U, ulTaskNotifyTake( pdTRUE, benchmarkTIMEOUT ), "Interrupt did not wake the partner." );
+
+    *pulEntry = ulInterruptEntryTime - ulStart;
+    *pulWake = ulPartnerWakeTime - ulInterruptEntryTime;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvInterruptEntry( uint32_t * pulSamples,
+                                     UBaseType_t uxSamples )
+{
+    UBaseType_t uxSample;
+    uint32_t ulWake;
+    BaseType_t xReturn = benchmarkSKIPPED;
+
+    if( pxCurrentBoard->pxTriggerInterrupt != NULL )
+    {
+        prvCreatePartner( eWakeFromISR );
+
+        for( uxSample = 0; uxSample < uxSamples; uxSample++ )
+        {
+            prvTimeInterrupt( &( pulSamples[ uxSample ] ), &ulWake );
+        }
+
+        prvDeletePartner();
+        xReturn = benchmarkCOMPLETE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvInterruptToTask( uint32_t * pulSamples,
+                                      UBaseType_t uxSamples )
+{
+    UBaseType_t uxSample;
+    uint32_t ulEntry;
+    BaseType_t xReturn = benchmarkSKIPPED;
+
+    if( pxCurrentBoard->pxTriggerInterrupt != NULL )
+    {
+        prvCreatePartner( eWakeFromISR );
+
+        for( uxSample = 0; uxSample < uxSamples; uxSample++ )
+        {
+            prvTimeInterrupt( &ulEntry, &( pulSamples[ uxSample ] ) );
+        }
+
+        prvDeletePartner();
+        xReturn = benchmarkCOMPLETE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkInterruptHandler( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    ulInterruptEntryTime = ulTestGetCycleCount();
+
+    if( xInterruptSemaphore != NULL )
+    {
+        ( void ) xSemaphoreGiveFromISR( xInterruptSemaphore, &xHigherPriorityTaskWoken );
+    }
+
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPartnerTask( void * pvParameters )
+{
+    PartnerMode_t eMode = ( PartnerMode_t ) ( ( UBaseType_t ) pvParameters );
+    uint32_t ulValue;
+
+    for( ; ; )
+    {
+        switch( eMode )
+        {
+            case eEchoQueue:
+
+                if( xQueueReceive( xRequestQueue, &ulValue, portMAX_DELAY ) == pdPASS )
+                {
+                    ( void ) xQueueSend( xReplyQueue, &ulValue, portMAX_DELAY );
+                }
+
+                break;
+
+            case eEchoSemaphore:
+
+                if( xSemaphoreTake( xRequestSemaphore, portMAX_DELAY ) == pdPASS )
+                {
+                    ( void ) xSemaphoreGive( xReplySemaphore );
+                }
+
+                break;
+
+            case eEchoNotify:
+
+                if( ulTaskNotifyTake( pdTRUE, portMAX_DELAY ) != 0U )
+                {
+                    ( void ) xTaskNotifyGive( xRunnerTask );
+                }
+
+                break;
+
+            case eWakeFromISR:
+
+                if( xSemaphoreTake( xInterruptSemaphore, portMAX_DELAY ) == pdPASS )
+                {
+                    ulPartnerWakeTime = ulTestGetCycleCount();
+                    ( void ) xTaskNotifyGive( xRunnerTask );
+                }
+
+                break;
+
+            default:
+                xPartnerError = pdTRUE;
+                vTaskSuspend( NULL );
+                break;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCreatePartner( PartnerMode_t eMode )
+{
+    BaseType_t xResult;
+
+    xPartnerError = pdFALSE;
+
+    #if ( configUSE_CORE_AFFINITY == 1 )
+    {
+        xResult = xTaskCreateAffinitySet( prvPartnerTask, "Partner", configMINIMAL_STACK_SIZE, ( void * ) ( UBaseType_t ) eMode,
+                                          benchmarkPARTNER_PRIORITY, benchmarkCORE_AFFINITY, &xPartnerTask );
+    }
+    #else
+    {
+        xResult = xTaskCreate( prvPartnerTask, "Partner", configMINIMAL_STACK_SIZE, ( void * ) ( UBaseType_t ) eMode,
+                               benchmarkPARTNER_PRIORITY, &xPartnerTask );
+    }
+    #endif
+
+    TEST_ASSERT_EQUAL_MESSAGE( pdPASS, xResult, "Task creation failed." );
+}
+/*-----------------------------------------------------------*/
+
+static void prvDeletePartner( void )
+{
+    TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xPartnerError, "Partner task failed." );
+
+    vTaskDelete( xPartnerTask );
+    xPartnerTask = NULL;
+
+    vTaskDelay( benchmarkCLEAN_UP_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportResult( const Benchmark_t * pxBenchmark,
+                             uint32_t * pulSamples,
+                             UBaseType_t uxSamples )
+{
+    UBaseType_t x, y;
+    uint32_t ulSample;
+    uint64_t ullTotal = 0;
+
+    /* Sort the samples, for the median.  There are few of them. */
+    for( x = 1; x < uxSamples; x++ )
+    {
+        ulSample = pulSamples[ x ];
+
+        for( y = x; ( y > 0 ) && ( pulSamples[ y - 1 ] > ulSample ); y-- )
+        {
+            pulSamples[ y ] = pulSamples[ y - 1 ];
+        }
+
+        pulSamples[ y ] = ulSample;
+    }
+
+    for( x = 0; x < uxSamples; x++ )
+    {
+        ullTotal += pulSamples[ x ];
+    }
+
+    printf( "BENCHMARK_RESULT {\"suite\":\"%s\",\"name\":\"%s\",\"unit\":\"cycles\",\"samples\":%u,"
+            "\"min\":%lu,\"median\":%lu,\"mean\":%lu,\"max\":%lu}\n",
+            pxBenchmark->pcSuite,
+            pxBenchmark->pcName,
+            ( unsigned ) uxSamples,
+            ( unsigned long ) pulSamples[ 0 ],
+            ( unsigned long ) pulSamples[ uxSamples / 2U ],
+            ( unsigned long ) ( ullTotal / uxSamples ),
+            ( unsigned long ) pulSamples[ uxSamples - 1U ] );
+
+    uxResults++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportOutcome( const char * pcKeyword,
+                              const Benchmark_t * pxBenchmark )
+{
+    printf( "%s {\"suite\":\"%s\",\"name\":\"%s\"}\n",
+            pcKeyword,
+            pxBenchmark->pcSuite,
+            pxBenchmark->pcName );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunCurrentBenchmark( void )
+{
+    xCurrentOutcome = pxCurrentBenchmark->pxFunction( ulSamples, benchmarkSAMPLES );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunBenchmark( const Benchmark_t * pxBenchmark )
+{
+    UNITY_COUNTER_TYPE xFailuresBefore = Unity.TestFailures;
+
+    pxCurrentBenchmark = pxBenchmark;
+    xCurrentOutcome = benchmarkSKIPPED;
+
+    /* As RUN_TEST(), but named after the benchmark. */
+    UnityDefaultTestRun( prvRunCurrentBenchmark, pxBenchmark->pcName, __LINE__ );
+
+    if( Unity.TestFailures != xFailuresBefore )
+    {
+        prvReportOutcome( "BENCHMARK_FAILED", pxBenchmark );
+        uxFailed++;
+
+        /* A failed benchmark may have left its partner running. */
+        if( xPartnerTask != NULL )
+        {
+            vTaskDelete( xPartnerTask );
+            xPartnerTask = NULL;
+            vTaskDelay( benchmarkCLEAN_UP_DELAY );
+        }
+    }
+    else if( xCurrentOutcome == benchmarkSKIPPED )
+    {
+        prvReportOutcome( "BENCHMARK_SKIPPED", pxBenchmark );
+        uxSkipped++;
+    }
+    else
+    {
+        prvReportResult( pxBenchmark, ulSamples, benchmarkSAMPLES );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Runs before every test, put init calls here. */
+void setUp( void )
+{
+    xRequestQueue = xQueueCreate( 1, sizeof( uint32_t ) );
+    xReplyQueue = xQueueCreate( 1, sizeof( uint32_t ) );
+    xRequestSemaphore = xSemaphoreCreateBinary();
+    xReplySemaphore = xSemaphoreCreateBinary();
+    xInterruptSemaphore = xSemaphoreCreateBinary();
+    xMutex = xSemaphoreCreateMutex();
+
+    TEST_ASSERT_NOT_NULL_MESSAGE( xRequestQueue, "Queue creation failed." );
+    TEST_ASSERT_NOT_NULL_MESSAGE( xReplyQueue, "Queue creation failed." );
+    TEST_ASSERT_NOT_NULL_MESSAGE( xRequestSemaphore, "Semaphore creation failed." );
+    TEST_ASSERT_NOT_NULL_MESSAGE( xReplySemaphore, "Semaphore creation failed." );
+    TEST_ASSERT_NOT_NULL_MESSAGE( xInterruptSemaphore, "Semaphore creation failed." );
+    TEST_ASSERT_NOT_NULL_MESSAGE( xMutex, "Mutex creation failed." );
+}
+/*-----------------------------------------------------------*/
+
+/* Runs after every test, put clean-up calls here. */
+void tearDown( void )
+{
+    SemaphoreHandle_t xSemaphore;
+
+    /* The interrupt handler may run until the semaphore is cleared. */
+    taskENTER_CRITICAL();
+    {
+        xSemaphore = xInterruptSemaphore;
+        xInterruptSemaphore = NULL;
+    }
+    taskEXIT_CRITICAL();
+
+    vQueueDelete( xRequestQueue );
+    vQueueDelete( xReplyQueue );
+    vSemaphoreDelete( xRequestSemaphore );
+    vSemaphoreDelete( xReplySemaphore );
+    vSemaphoreDelete( xSemaphore );
+    vSemaphoreDelete( xMutex );
+}
+/*-----------------------------------------------------------*/
+
+void vRunBenchmarks( const BenchmarkBoard_t * pxBoard )
+{
+    UBaseType_t x;
+
+    configASSERT( pxBoard != NULL );
+
+    pxCurrentBoard = pxBoard;
+    xRunnerTask = xTaskGetCurrentTaskHandle();
+    uxResults = 0;
+    uxSkipped = 0;
+    uxFailed = 0;
+
+    #if ( configUSE_CORE_AFFINITY == 1 )
+    {
+        vTaskCoreAffinitySet( NULL, benchmarkCORE_AFFINITY );
+    }
+    #endif
+    vTaskPrioritySet( NULL, benchmarkRUNNER_PRIORITY );
+
+    printf( "BENCHMARK_START {\"format\":%d,\"board\":\"%s\",\"kernel\":\"%s\",\"cores\":%u,"
+            "\"cycle_hz\":%lu,\"samples\":%u,\"iterations\":%u}\n",
+            benchmarkFORMAT_VERSION,
+            pxBoard->pcName,
+            tskKERNEL_VERSION_NUMBER,
+            ( unsigned ) benchmarkNUMBER_OF_CORES,
+            ( unsigned long ) pxBoard->ulCycleHz,
+            ( unsigned ) benchmarkSAMPLES,
+            ( unsigned ) benchmarkITERATIONS );
+
+    UNITY_BEGIN();
+
+    for( x = 0; x < ( sizeof( xKernelBenchmarks ) / sizeof( xKernelBenchmarks[ 0 ] ) ); x++ )
+    {
+        prvRunBenchmark( &( xKernelBenchmarks[ x ] ) );
+    }
+
+    for( x = 0; x < pxBoard->uxBenchmarks; x++ )
+    {
+        prvRunBenchmark( &( pxBoard->pxBenchmarks[ x ] ) );
+    }
+
+    printf( "BENCHMARK_END {\"results\":%u,\"skipped\":%u,\"failed\":%u}\n",
+            ( unsigned ) uxResults,
+            ( unsigned ) uxSkipped,
+            ( unsigned ) uxFailed );
+
+    UNITY_END();
+}
+/*-----------------------------------------------------------*/
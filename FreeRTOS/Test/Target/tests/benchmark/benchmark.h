@@ -0,0 +1,130 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file benchmark.h
+ * @brief The interface between the benchmark runner and the board.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Number of samples taken of each benchmark.  The minimum, median,
+ *        mean and maximum of the samples are reported.
+ */
+#ifndef benchmarkSAMPLES
+    #define benchmarkSAMPLES       ( 32U )
+#endif
+
+/**
+ * @brief Number of operations averaged in each sample of a benchmark that
+ *        repeats an operation.
+ */
+#ifndef benchmarkITERATIONS
+    #define benchmarkITERATIONS    ( 1000U )
+#endif
+
+/**
+ * @brief The cores the benchmark tasks are pinned to on an SMP build, so
+ *        results do not depend on where the scheduler places them.
+ */
+#ifndef benchmarkCORE_AFFINITY
+    #define benchmarkCORE_AFFINITY    ( 1U << 0 )
+#endif
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Values returned by a benchmark function.
+ */
+#define benchmarkCOMPLETE    ( pdPASS )
+#define benchmarkSKIPPED     ( pdFAIL )
+
+/**
+ * @brief A benchmark function.  It fills pulSamples with uxSamples
+ *        measurements, in cycles, and returns benchmarkCOMPLETE, or returns
+ *        benchmarkSKIPPED if the board cannot run it.  It uses Unity
+ *        assertions to fail the benchmark.
+ */
+typedef BaseType_t ( * BenchmarkFunction_t )( uint32_t * pulSamples,
+                                              UBaseType_t uxSamples );
+
+/**
+ * @brief A registered benchmark.  pcSuite groups related benchmarks, for
+ *        example "ipc", and pcName names the operation measured.
+ */
+typedef struct Benchmark
+{
+    const char * pcSuite;
+    const char * pcName;
+    BenchmarkFunction_t pxFunction;
+} Benchmark_t;
+
+/**
+ * @brief What the board tells the runner about itself.
+ *
+ * pcName identifies the board in the results, so runs on the same board can
+ * be compared.  ulCycleHz is the rate at which ulTestGetCycleCount() counts.
+ *
+ * If pxTriggerInterrupt is not NULL it must cause an interrupt, at a priority
+ * from which FreeRTOS API functions can be called, whose handler calls
+ * vBenchmarkInterruptHandler(), on the core in benchmarkCORE_AFFINITY on an
+ * SMP build.  Otherwise the interrupt latency benchmarks
+ * are skipped.
+ *
+ * pxBenchmarks lists uxBenchmarks further benchmarks to run after the kernel
+ * benchmarks, for libraries only some boards build, such as a file system, a
+ * TLS stack or the trace recorder.
+ */
+typedef struct BenchmarkBoard
+{
+    const char * pcName;
+    uint32_t ulCycleHz;
+    void ( * pxTriggerInterrupt )( void );
+    const Benchmark_t * pxBenchmarks;
+    UBaseType_t uxBenchmarks;
+} BenchmarkBoard_t;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Returns a free running count of CPU cycles.  Provided by the board.
+ */
+extern uint32_t ulTestGetCycleCount( void );
+
+/**
+ * @brief Run the kernel benchmarks and then the board's benchmarks, reporting
+ *        each on the console.  Must be called from a FreeRTOS task.
+ */
+void vRunBenchmarks( const BenchmarkBoard_t * pxBoard );
+
+/**
+ * @brief Called by the handler of the interrupt pxTriggerInterrupt causes.
+ */
+void vBenchmarkInterruptHandler( void );
+
+#endif /* BENCHMARK_H */
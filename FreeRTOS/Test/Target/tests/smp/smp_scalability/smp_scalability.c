@@ -0,0 +1,625 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file smp_scalability.c
+ * @brief Measure how the cost of scheduler operations scales with the number
+ *        of cores in use.
+ *
+ * Procedure:
+ *   - Cross-core queue ping-pong: two tasks pinned to core 0 and core N pass a
+ *     value back and forth over two queues.  Core 0 to core 0 is measured for
+ *     comparison.
+ *   - Critical section contention: one task pinned to each of the first N
+ *     cores repeatedly enters and exits a critical section, incrementing a
+ *     shared counter.
+ *   - Scheduler lock contention: as above, using vTaskSuspendAll() and
+ *     xTaskResumeAll().
+ *   - Load balancing: 2 * N CPU-bound tasks of equal priority, allowed to run
+ *     on the first N cores, count loop iterations for a fixed time.
+ *   - Core affinity migration: a task moves itself round the first N cores by
+ *     changing its own core affinity.
+ *   - Yield storm: two tasks pinned to each of the first N cores repeatedly
+ *     call taskYIELD().
+ *   - Each measurement is reported as cycles per operation for each core
+ *     count, on a line starting "SMP_SCALABILITY".  For the contention tests
+ *     the cycles are the time each core takes per operation, so perfect
+ *     scaling gives the same number for every core count.
+ * Expected:
+ *   - Every operation completes, ping-pong values are echoed unchanged, the
+ *     critical section protects the shared counter, no load balancing task is
+ *     starved, and migrating tasks run on the core they moved to.
+ *
+ * Cycles are read with ulTestGetCycleCount(), which the board must provide.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h" /* Must come first. */
+#include "task.h"     /* RTOS task related API prototypes. */
+#include "queue.h"    /* RTOS queue related API prototypes. */
+
+/* Unity includes. */
+#include "unity.h"
+/*-----------------------------------------------------------*/
+
+#ifndef TEST_CONFIG_H
+    #error test_config.h must be included at the end of FreeRTOSConfig.h.
+#endif
+
+#if ( configNUMBER_OF_CORES < 2 )
+    #error This test is for FreeRTOS SMP and therefore, requires at least 2 cores.
+#endif /* if configNUMBER_OF_CORES != 2 */
+
+#if ( configUSE_CORE_AFFINITY != 1 )
+    #error configUSE_CORE_AFFINITY must be set to 1 for this test.
+#endif /* if ( configUSE_CORE_AFFINITY != 1 ) */
+
+#if ( configMAX_PRIORITIES <= 2 )
+    #error configMAX_PRIORITIES must be larger than 2 to avoid scheduling idle tasks unexpectedly.
+#endif /* if ( configMAX_PRIORITIES <= 2 ) */
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Number of operations each task performs in each measurement.
+ */
+#ifndef smpSCALABILITY_ITERATIONS
+    #define smpSCALABILITY_ITERATIONS    ( 10000UL )
+#endif
+
+/**
+ * @brief Time for which the load balancing tasks run.
+ */
+#ifndef smpSCALABILITY_LOAD_TIME_MS
+    #define smpSCALABILITY_LOAD_TIME_MS    ( 500UL )
+#endif
+
+/**
+ * @brief Number of tasks pinned to each core for the yield storm.
+ */
+#define smpSCALABILITY_YIELD_TASKS_PER_CORE    ( 2 )
+
+/**
+ * @brief Number of load balancing tasks per core in use.
+ */
+#define smpSCALABILITY_LOAD_TASKS_PER_CORE     ( 2 )
+
+/**
+ * @brief The most worker tasks any measurement uses.
+ */
+#define smpSCALABILITY_MAX_WORKERS             ( configNUMBER_OF_CORES * 2 )
+
+/**
+ * @brief Priority of the worker tasks, below the test runner.
+ */
+#define smpSCALABILITY_WORKER_PRIORITY         ( configMAX_PRIORITIES - 2 )
+
+/**
+ * @brief Time given to the idle tasks to free the memory of deleted tasks.
+ */
+#define smpSCALABILITY_CLEAN_UP_DELAY          pdMS_TO_TICKS( 20 )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The operation a worker task repeats.
+ */
+typedef void ( * WorkerFunction_t )( void );
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Returns a free running count of CPU cycles.  Provided by the board.
+ */
+extern uint32_t ulTestGetCycleCount( void );
+
+/**
+ * @brief Create one or more worker tasks pinned to each of the first
+ *        uxCores cores, let them each call pxWorkerFunction
+ *        smpSCALABILITY_ITERATIONS times, and return the cycles between the
+ *        first worker starting and the last one finishing.
+ */
+static uint32_t prvRunPinnedWorkers( UBaseType_t uxCores,
+                                     UBaseType_t uxTasksPerCore,
+                                     WorkerFunction_t pxWorkerFunction );
+
+/**
+ * @brief Wait for uxCount worker tasks to notify the test runner that they
+ *        have finished.
+ */
+static void prvWaitForWorkers( UBaseType_t uxCount );
+
+/**
+ * @brief Output a result.
+ */
+static void prvReport( const char * pcName,
+                       UBaseType_t uxCores,
+                       uint32_t ulCycles,
+                       uint32_t ulOperations );
+
+/**
+ * @brief Worker tasks.
+ */
+static void prvPinnedWorkerTask( void * pvParameters );
+static void prvPingTask( void * pvParameters );
+static void prvPongTask( void * pvParameters );
+static void prvLoadTask( void * pvParameters );
+static void prvMigrateTask( void * pvParameters );
+
+/**
+ * @brief Operations repeated by prvPinnedWorkerTask().
+ */
+static void prvCriticalSectionOperation( void );
+static void prvSuspendAllOperation( void );
+static void prvYieldOperation( void );
+
+/**
+ * @brief Test cases.
+ */
+static void Test_CrossCorePingPong( void );
+static void Test_CriticalSectionContention( void );
+static void Test_SchedulerLockContention( void );
+static void Test_LoadBalancing( void );
+static void Test_CoreAffinityMigration( void );
+static void Test_YieldStorm( void );
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The task running the test cases, which the workers notify.
+ */
+static TaskHandle_t xTestRunnerTask = NULL;
+
+/**
+ * @brief The operation repeated by prvPinnedWorkerTask().
+ */
+static WorkerFunction_t pxCurrentWorkerFunction = NULL;
+
+/**
+ * @brief Set to start the workers together, and to stop the load balancing
+ *        tasks.
+ */
+static volatile BaseType_t xWorkersStart = pdFALSE;
+static volatile BaseType_t xWorkersStop = pdFALSE;
+
+/**
+ * @brief The cycle count at which each worker started and finished.
+ */
+static volatile uint32_t ulWorkerStart[ smpSCALABILITY_MAX_WORKERS ];
+static volatile uint32_t ulWorkerEnd[ smpSCALABILITY_MAX_WORKERS ];
+
+/**
+ * @brief Loop iterations completed by each load balancing task.
+ */
+static volatile uint32_t ulLoadIterations[ smpSCALABILITY_MAX_WORKERS ];
+
+/**
+ * @brief Counter incremented inside the critical section.
+ */
+static volatile uint32_t ulSharedCounter = 0;
+
+/**
+ * @brief Queues used by the ping-pong tasks.
+ */
+static QueueHandle_t xPingQueue = NULL;
+static QueueHandle_t xPongQueue = NULL;
+
+/**
+ * @brief Set if a ping-pong value was corrupted or a migrating task ran on
+ *        the wrong core.
+ */
+static volatile BaseType_t xWorkerError = pdFALSE;
+
+/**
+ * @brief The number of cores the migrating task moves around.
+ */
+static UBaseType_t uxMigrationCores = 0;
+/*-----------------------------------------------------------*/
+
+static void Test_CrossCorePingPong( void )
+{
+    UBaseType_t uxCore;
+    uint32_t ulStart;
+
+    for( uxCore = 0; uxCore < configNUMBER_OF_CORES; uxCore++ )
+    {
+        xWorkerError = pdFALSE;
+
+        /* The pong task is created first so it is waiting when the ping task
+         * starts. */
+        TEST_ASSERT_EQUAL_MESSAGE( pdPASS,
+                                   xTaskCreateAffinitySet( prvPongTask, "Pong", configMINIMAL_STACK_SIZE, NULL,
+                                                           smpSCALABILITY_WORKER_PRIORITY, ( 1U << uxCore ), NULL ),
+                                   "Task creation failed." );
+
+        ulStart = ulTestGetCycleCount();
+        TEST_ASSERT_EQUAL_MESSAGE( pdPASS,
+                                   xTaskCreateAffinitySet( prvPingTask, "Ping", configMINIMAL_STACK_SIZE, NULL,
+                                                           smpSCALABILITY_WORKER_PRIORITY, ( 1U << 0 ), NULL ),
+                                   "Task creation failed." );
+
+        /* Both tasks notify when they finish. */
+        prvWaitForWorkers( 2 );
+
+        TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xWorkerError, "Ping-pong value corrupted." );
+
+        /* Report against the core the pong task ran on, so 0 is the same core
+         * case. */
+        prvReport( "ping_pong_to_core", uxCore, ulTestGetCycleCount() - ulStart, smpSCALABILITY_ITERATIONS );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void Test_CriticalSectionContention( void )
+{
+    UBaseType_t uxCores;
+    uint32_t ulCycles;
+
+    for( uxCores = 1; uxCores <= configNUMBER_OF_CORES; uxCores++ )
+    {
+        ulSharedCounter = 0;
+        ulCycles = prvRunPinnedWorkers( uxCores, 1, prvCriticalSectionOperation );
+
+        TEST_ASSERT_EQUAL_MESSAGE( uxCores * smpSCALABILITY_ITERATIONS, ulSharedCounter, "Critical section did not protect the counter." );
+        prvReport( "critical_section", uxCores, ulCycles, smpSCALABILITY_ITERATIONS );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void Test_SchedulerLockContention( void )
+{
+    UBaseType_t uxCores;
+    uint32_t ulCycles;
+
+    for( uxCores = 1; uxCores <= configNUMBER_OF_CORES; uxCores++ )
+    {
+        ulCycles = prvRunPinnedWorkers( uxCores, 1, prvSuspendAllOperation );
+        prvReport( "suspend_all", uxCores, ulCycles, smpSCALABILITY_ITERATIONS );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void Test_LoadBalancing( void )
+{
+    UBaseType_t uxCores, uxTasks, x;
+    uint32_t ulMin, ulMax, ulTotal, ulStart, ulCycles;
+    BaseType_t xResult;
+
+    for( uxCores = 1; uxCores <= configNUMBER_OF_CORES; uxCores++ )
+    {
+        uxTasks = uxCores * smpSCALABILITY_LOAD_TASKS_PER_CORE;
+        xWorkersStop = pdFALSE;
+
+        for( x = 0; x < uxTasks; x++ )
+        {
+            ulLoadIterations[ x ] = 0;
+            xResult = xTaskCreateAffinitySet( prvLoadTask, "Load", configMINIMAL_STACK_SIZE, ( void * ) x,
+                                              smpSCALABILITY_WORKER_PRIORITY, ( ( 1U << uxCores ) - 1U ), NULL );
+            TEST_ASSERT_EQUAL_MESSAGE( pdPASS, xResult, "Task creation failed." );
+        }
+
+        ulStart = ulTestGetCycleCount();
+        vTaskDelay( pdMS_TO_TICKS( smpSCALABILITY_LOAD_TIME_MS ) );
+        xWorkersStop = pdTRUE;
+        ulCycles = ulTestGetCycleCount() - ulStart;
+
+        prvWaitForWorkers( uxTasks );
+
+        ulMin = UINT32_MAX;
+        ulMax = 0;
+        ulTotal = 0;
+
+        for( x = 0; x < uxTasks; x++ )
+        {
+            ulMin = ( ulLoadIterations[ x ] < ulMin ) ? ulLoadIterations[ x ] : ulMin;
+            ulMax = ( ulLoadIterations[ x ] > ulMax ) ? ulLoadIterations[ x ] : ulMax;
+            ulTotal += ulLoadIterations[ x ];
+        }
+
+        TEST_ASSERT_MESSAGE( ulMin > 0, "A load balancing task was starved." );
+
+        /* The cycles per loop iteration across all the cores, which halves
+         * each time the number of cores doubles if the load is balanced, and
+         * the least and most work done by one task as a percentage of the
+         * average. */
+        prvReport( "load_balance", uxCores, ulCycles, ulTotal );
+        printf( "SMP_SCALABILITY load_balance_spread cores:%u min_pct:%u max_pct:%u\n",
+                ( unsigned ) uxCores,
+                ( unsigned ) ( ( ( uint64_t ) ulMin * 100U * uxTasks ) / ulTotal ),
+                ( unsigned ) ( ( ( uint64_t ) ulMax * 100U * uxTasks ) / ulTotal ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void Test_CoreAffinityMigration( void )
+{
+    uint32_t ulStart;
+
+    for( uxMigrationCores = 2; uxMigrationCores <= configNUMBER_OF_CORES; uxMigrationCores++ )
+    {
+        xWorkerError = pdFALSE;
+
+        ulStart = ulTestGetCycleCount();
+        TEST_ASSERT_EQUAL_MESSAGE( pdPASS,
+                                   xTaskCreateAffinitySet( prvMigrateTask, "Migrate", configMINIMAL_STACK_SIZE, NULL,
+                                                           smpSCALABILITY_WORKER_PRIORITY, ( 1U << 0 ), NULL ),
+                                   "Task creation failed." );
+        prvWaitForWorkers( 1 );
+
+        TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xWorkerError, "Task did not run on the core it migrated to." );
+        prvReport( "migration", uxMigrationCores, ulTestGetCycleCount() - ulStart, smpSCALABILITY_ITERATIONS );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void Test_YieldStorm( void )
+{
+    UBaseType_t uxCores;
+    uint32_t ulCycles;
+
+    for( uxCores = 1; uxCores <= configNUMBER_OF_CORES; uxCores++ )
+    {
+        ulCycles = prvRunPinnedWorkers( uxCores, smpSCALABILITY_YIELD_TASKS_PER_CORE, prvYieldOperation );
+
+        /* The tasks sharing a core take turns, so each core performs every
+         * one of its tasks' yields. */
+        prvReport( "yield_storm", uxCores, ulCycles, smpSCALABILITY_ITERATIONS * smpSCALABILITY_YIELD_TASKS_PER_CORE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRunPinnedWorkers( UBaseType_t uxCores,
+                                     UBaseType_t uxTasksPerCore,
+                                     WorkerFunction_t pxWorkerFunction )
+{
+    UBaseType_t uxWorker, uxWorkers = uxCores * uxTasksPerCore;
+    uint32_t ulFirstStart, ulLastEnd;
+    BaseType_t xResult;
+
+    pxCurrentWorkerFunction = pxWorkerFunction;
+    xWorkersStart = pdFALSE;
+
+    for( uxWorker = 0; uxWorker < uxWorkers; uxWorker++ )
+    {
+        xResult = xTaskCreateAffinitySet( prvPinnedWorkerTask, "Worker", configMINIMAL_STACK_SIZE, ( void * ) uxWorker,
+                                          smpSCALABILITY_WORKER_PRIORITY, ( 1U << ( uxWorker % uxCores ) ), NULL );
+        TEST_ASSERT_EQUAL_MESSAGE( pdPASS, xResult, "Task creation failed." );
+    }
+
+    /* Release the workers together, then wait for them all to finish. */
+    xWorkersStart = pdTRUE;
+    prvWaitForWorkers( uxWorkers );
+
+    ulFirstStart = ulWorkerStart[ 0 ];
+    ulLastEnd = ulWorkerEnd[ 0 ];
+
+    for( uxWorker = 1; uxWorker < uxWorkers; uxWorker++ )
+    {
+        /* Compare differences rather than values so wrapping counters are
+         * handled. */
+        if( ( int32_t ) ( ulWorkerStart[ uxWorker ] - ulFirstStart ) < 0 )
+        {
+            ulFirstStart = ulWorkerStart[ uxWorker ];
+        }
+
+        if( ( int32_t ) ( ulWorkerEnd[ uxWorker ] - ulLastEnd ) > 0 )
+        {
+            ulLastEnd = ulWorkerEnd[ uxWorker ];
+        }
+    }
+
+    return ulLastEnd - ulFirstStart;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitForWorkers( UBaseType_t uxCount )
+{
+    UBaseType_t x;
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        ( void ) ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+    }
+
+    /* Let the idle tasks free the workers, which have deleted themselves. */
+    vTaskDelay( smpSCALABILITY_CLEAN_UP_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char * pcName,
+                       UBaseType_t uxCores,
+                       uint32_t ulCycles,
+                       uint32_t ulOperations )
+{
+    printf( "SMP_SCALABILITY %s cores:%u cycles_per_op:%lu\n",
+            pcName,
+            ( unsigned ) uxCores,
+            ( unsigned long ) ( ulCycles / ulOperations ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPinnedWorkerTask( void * pvParameters )
+{
+    UBaseType_t uxWorker = ( UBaseType_t ) pvParameters;
+    uint32_t x;
+
+    while( xWorkersStart == pdFALSE )
+    {
+        /* Wait for the other workers to be created. */
+        __asm volatile ( "nop" );
+    }
+
+    ulWorkerStart[ uxWorker ] = ulTestGetCycleCount();
+
+    for( x = 0; x < smpSCALABILITY_ITERATIONS; x++ )
+    {
+        pxCurrentWorkerFunction();
+    }
+
+    ulWorkerEnd[ uxWorker ] = ulTestGetCycleCount();
+
+    xTaskNotifyGive( xTestRunnerTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCriticalSectionOperation( void )
+{
+    taskENTER_CRITICAL();
+    {
+        ulSharedCounter++;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendAllOperation( void )
+{
+    vTaskSuspendAll();
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+static void prvYieldOperation( void )
+{
+    taskYIELD();
+}
+/*-----------------------------------------------------------*/
+
+static void prvPingTask( void * pvParameters )
+{
+    uint32_t x, ulValue;
+
+    ( void ) pvParameters;
+
+    for( x = 0; x < smpSCALABILITY_ITERATIONS; x++ )
+    {
+        xQueueSend( xPingQueue, &x, portMAX_DELAY );
+        xQueueReceive( xPongQueue, &ulValue, portMAX_DELAY );
+
+        if( ulValue != x )
+        {
+            xWorkerError = pdTRUE;
+        }
+    }
+
+    xTaskNotifyGive( xTestRunnerTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPongTask( void * pvParameters )
+{
+    uint32_t x, ulValue;
+
+    ( void ) pvParameters;
+
+    for( x = 0; x < smpSCALABILITY_ITERATIONS; x++ )
+    {
+        xQueueReceive( xPingQueue, &ulValue, portMAX_DELAY );
+        xQueueSend( xPongQueue, &ulValue, portMAX_DELAY );
+    }
+
+    xTaskNotifyGive( xTestRunnerTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoadTask( void * pvParameters )
+{
+    UBaseType_t uxTask = ( UBaseType_t ) pvParameters;
+
+    while( xWorkersStop == pdFALSE )
+    {
+        ulLoadIterations[ uxTask ]++;
+    }
+
+    xTaskNotifyGive( xTestRunnerTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMigrateTask( void * pvParameters )
+{
+    UBaseType_t uxCore;
+    uint32_t x;
+
+    ( void ) pvParameters;
+
+    for( x = 1; x <= smpSCALABILITY_ITERATIONS; x++ )
+    {
+        /* Changing the affinity of the running task so it excludes the
+         * current core moves the task to the new core before
+         * vTaskCoreAffinitySet() returns. */
+        uxCore = ( UBaseType_t ) ( x % uxMigrationCores );
+        vTaskCoreAffinitySet( NULL, ( 1U << uxCore ) );
+
+        if( ( UBaseType_t ) portGET_CORE_ID() != uxCore )
+        {
+            xWorkerError = pdTRUE;
+        }
+    }
+
+    xTaskNotifyGive( xTestRunnerTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+/* Runs before every test, put init calls here. */
+void setUp( void )
+{
+    xTestRunnerTask = xTaskGetCurrentTaskHandle();
+
+    xPingQueue = xQueueCreate( 1, sizeof( uint32_t ) );
+    xPongQueue = xQueueCreate( 1, sizeof( uint32_t ) );
+
+    TEST_ASSERT_NOT_NULL_MESSAGE( xPingQueue, "Queue creation failed." );
+    TEST_ASSERT_NOT_NULL_MESSAGE( xPongQueue, "Queue creation failed." );
+}
+/*-----------------------------------------------------------*/
+
+/* Runs after every test, put clean-up calls here. */
+void tearDown( void )
+{
+    /* The worker tasks delete themselves. */
+    vQueueDelete( xPingQueue );
+    vQueueDelete( xPongQueue );
+}
+/*-----------------------------------------------------------*/
+
+void vRunSmpScalabilityTest( void )
+{
+    UNITY_BEGIN();
+
+    RUN_TEST( Test_CrossCorePingPong );
+    RUN_TEST( Test_CriticalSectionContention );
+    RUN_TEST( Test_SchedulerLockContention );
+    RUN_TEST( Test_LoadBalancing );
+    RUN_TEST( Test_CoreAffinityMigration );
+    RUN_TEST( Test_YieldStorm );
+
+    UNITY_END();
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+###############################################################################
+# FreeRTOS
+# Copyright (C) 2022 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# https://www.FreeRTOS.org
+# https://github.com/FreeRTOS
+###############################################################################
+"""Collect and compare the results of the target benchmarks.
+
+The benchmark test (tests/benchmark) prints one line per result, a keyword
+followed by a JSON object.  This script picks those lines out of a console
+log, so the log may also contain other output, and stores them as a baseline
+or compares them with one.
+
+    benchmark.py extract console.log -o baseline.json
+    benchmark.py compare baseline.json console.log --threshold 10
+
+compare exits with 1 if any benchmark is slower than the baseline by more
+than the threshold, failed, or is missing, so it can gate a CI job.
+"""
+import argparse
+import json
+import re
+import sys
+
+FORMAT_VERSION = 1
+
+LINE_PATTERN = re.compile(
+    r"(BENCHMARK_START|BENCHMARK_RESULT|BENCHMARK_SKIPPED|BENCHMARK_FAILED|BENCHMARK_END)"
+    r"\s+(\{.*\})"
+)
+
+METRICS = ("min", "median", "mean", "max")
+
+
+def parse_log(lines):
+    """Return the run information and the results found in a console log."""
+    run = None
+    results = {}
+
+    for line in lines:
+        match = LINE_PATTERN.search(line)
+        if match is None:
+            continue
+
+        keyword, body = match.groups()
+        try:
+            record = json.loads(body)
+        except ValueError:
+            print("Ignoring malformed line: " + line.strip(), file=sys.stderr)
+            continue
+
+        if keyword == "BENCHMARK_START":
+            if record.get("format") != FORMAT_VERSION:
+                raise ValueError(
+                    "Unsupported result format {}".format(record.get("format"))
+                )
+            run = record
+        elif keyword == "BENCHMARK_END":
+            pass
+        else:
+            key = "{}/{}".format(record["suite"], record["name"])
+            if keyword == "BENCHMARK_SKIPPED":
+                record["status"] = "skipped"
+            elif keyword == "BENCHMARK_FAILED":
+                record["status"] = "failed"
+            else:
+                record["status"] = "passed"
+            results[key] = record
+
+    if run is None:
+        raise ValueError("No BENCHMARK_START line found")
+
+    return {"run": run, "results": results}
+
+
+def load(path):
+    """Load results from a console log or from a file written by extract."""
+    with open(path, "r", errors="replace") as file:
+        text = file.read()
+
+    try:
+        data = json.loads(text)
+        if isinstance(data, dict) and "results" in data:
+            return data
+    except ValueError:
+        pass
+
+    return parse_log(text.splitlines())
+
+
+def extract(args):
+    data = load(args.log)
+
+    if args.output is None:
+        json.dump(data, sys.stdout, indent=4, sort_keys=True)
+        print()
+    else:
+        with open(args.output, "w") as file:
+            json.dump(data, file, indent=4, sort_keys=True)
+            file.write("\n")
+
+    return 0
+
+
+def compare(args):
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = 0
+
+    for field in ("board", "cycle_hz", "samples", "iterations"):
+        if baseline["run"].get(field) != current["run"].get(field):
+            print(
+                "Warning: {} differs, {} in the baseline and {} now".format(
+                    field, baseline["run"].get(field), current["run"].get(field)
+                )
+            )
+
+    print(
+        "{:<40} {:>12} {:>12} {:>9}  {}".format(
+            "benchmark", "baseline", "current", "change", "status"
+        )
+    )
+
+    for key in sorted(set(baseline["results"]) | set(current["results"])):
+        old = baseline["results"].get(key)
+        new = current["results"].get(key)
+        old_value = ""
+        new_value = ""
+        change = ""
+
+        if new is None:
+            status = "MISSING"
+            regressions += 1
+        elif new["status"] == "failed":
+            status = "FAILED"
+            regressions += 1
+        elif new["status"] == "skipped":
+            status = "skipped"
+        elif old is None or old["status"] != "passed":
+            status = "new"
+            new_value = new[args.metric]
+        else:
+            old_value = old[args.metric]
+            new_value = new[args.metric]
+            percent = 0.0
+            if old_value != 0:
+                percent = 100.0 * (new_value - old_value) / old_value
+            change = "{:+.1f}%".format(percent)
+
+            if percent > args.threshold:
+                status = "REGRESSION"
+                regressions += 1
+            elif percent < -args.threshold:
+                status = "improved"
+            else:
+                status = "ok"
+
+        print(
+            "{:<40} {:>12} {:>12} {:>9}  {}".format(
+                key, old_value, new_value, change, status
+            )
+        )
+
+    if regressions != 0:
+        print(
+            "{} benchmark(s) regressed by more than {}% of the {}, failed or are missing.".format(
+                regressions, args.threshold, args.metric
+            )
+        )
+        return 1
+
+    return 0
+
+
+def main():
+    arg_parser = argparse.ArgumentParser(
+        description="Collect and compare the results of the target benchmarks"
+    )
+    sub_parsers = arg_parser.add_subparsers(dest="command", required=True)
+
+    extract_parser = sub_parsers.add_parser(
+        "extract", help="store the results found in a console log as JSON"
+    )
+    extract_parser.add_argument("log", help="console log of a benchmark run")
+    extract_parser.add_argument(
+        "-o", "--output", help="file to write, standard output if omitted"
+    )
+    extract_parser.set_defaults(function=extract)
+
+    compare_parser = sub_parsers.add_parser(
+        "compare", help="compare a run with a baseline"
+    )
+    compare_parser.add_argument(
+        "baseline", help="baseline, as a console log or written by extract"
+    )
+    compare_parser.add_argument(
+        "current", help="run to check, as a console log or written by extract"
+    )
+    compare_parser.add_argument(
+        "-t",
+        "--threshold",
+        type=float,
+        default=10.0,
+        help="percentage increase allowed before a benchmark regresses (default 10)",
+    )
+    compare_parser.add_argument(
+        "-m",
+        "--metric",
+        choices=METRICS,
+        default="median",
+        help="statistic compared (default median)",
+    )
+    compare_parser.set_defaults(function=compare)
+
+    args = arg_parser.parse_args()
+
+    try:
+        return args.function(args)
+    except (OSError, ValueError) as error:
+        print(error, file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Decode tokenized log records produced by logging_tokenized.h.
+
+The format strings are read from the LOG_TOKEN_SECTION section (".log_tokens"
+by default) of the ELF file the target was built from.  Each record in the
+input is one byte holding the number of 32-bit words, followed by the words in
+little endian byte order: the token, then one word per argument.
+
+Usage:
+    detokenize.py firmware.elf [log.bin]
+
+Reads the records from log.bin, or from stdin if no file is given, and prints
+one line per record.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+# A printf conversion: flags, width, precision, length modifier, conversion.
+# The width and precision may be "*", each taking an int argument word before
+# the value, e.g. "%.*s" for the length and address of a string.
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d*)(\.(?:\*|\d*))?(hh|h|ll|l|z|j|t)?([diouxXcspf%eEgG])")
+
+
+class Elf:
+    """Just enough of an ELF reader to find sections and read their bytes."""
+
+    def __init__(self, path):
+        with open(path, "rb") as elf_file:
+            self.data = elf_file.read()
+
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError("%s is not an ELF file" % path)
+
+        is_64 = self.data[4] == 2
+        self.endian = "<" if self.data[5] == 1 else ">"
+
+        if is_64:
+            shoff, = struct.unpack_from(self.endian + "Q", self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.endian + "HHH", self.data, 0x3A)
+            header = self.endian + "IIQQQQIIQQ"
+        else:
+            shoff, = struct.unpack_from(self.endian + "I", self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.endian + "HHH", self.data, 0x2E)
+            header = self.endian + "IIIIIIIIII"
+
+        raw = [struct.unpack_from(header, self.data, shoff + i * shentsize) for i in range(shnum)]
+        names = raw[shstrndx]
+        self.sections = []
+
+        for name, sh_type, flags, addr, offset, size, _, _, _, _ in raw:
+            start = names[4] + name
+            self.sections.append({
+                "name": self.data[start:self.data.index(b"\0", start)].decode(),
+                "type": sh_type,
+                "flags": flags,
+                "addr": addr,
+                "offset": offset,
+                "size": size,
+            })
+
+    def section(self, name):
+        for section in self.sections:
+            if section["name"] == name:
+                return section
+        return None
+
+    def string_at(self, section, position):
+        start = section["offset"] + position
+        end = self.data.index(b"\0", start)
+        return self.data[start:end].decode("utf-8", "replace")
+
+    def constant_string(self, address):
+        """Return the string at a target address if it is constant data."""
+        for section in self.sections:
+            if (section["flags"] & SHF_ALLOC) and section["type"] != SHT_NOBITS and \
+                    ((address - section["addr"]) & 0xFFFFFFFF) < section["size"]:
+                return self.string_at(section, (address - section["addr"]) & 0xFFFFFFFF)
+        return None
+
+
+def signed(value):
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def format_record(elf, tokens, words):
+    token_offset = (words[0] - tokens["addr"]) & 0xFFFFFFFF
+
+    if token_offset >= tokens["size"]:
+        return "[unknown token 0x%08x]%s" % (words[0], "".join(" 0x%08x" % w for w in words[1:]))
+
+    arguments = iter(words[1:])
+
+    def convert(match):
+        flags, width, precision, _, conversion = match.groups()
+
+        if conversion == "%":
+            return "%"
+
+        # As printf, a negative "*" width left-justifies and a negative "*"
+        # precision is taken as if none was given.
+        if width == "*":
+            width = next(arguments, None)
+
+            if width is None:
+                return "<missing>"
+
+            width = signed(width)
+
+            if width < 0:
+                flags += "-"
+
+            width = str(abs(width))
+
+        if precision == ".*":
+            precision = next(arguments, None)
+
+            if precision is None:
+                return "<missing>"
+
+            precision = signed(precision)
+            precision = "." + str(precision) if precision >= 0 else None
+
+        spec = "%" + flags + width + (precision or "")
+        value = next(arguments, None)
+
+        if value is None:
+            return "<missing>"
+        if conversion in "di":
+            return (spec + "d") % signed(value)
+        if conversion in "ouxX":
+            return (spec + conversion.replace("u", "d")) % value
+        if conversion == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conversion == "s":
+            # The precision applies to the string only, not to the address
+            # shown when the string is not constant data.
+            string = elf.constant_string(value)
+            return (spec + "s") % string if string is not None else "<0x%08x>" % value
+        if conversion == "p":
+            return "0x%08x" % value
+        return "<0x%08x>" % value
+
+    return CONVERSION.sub(convert, elf.string_at(tokens, token_offset))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode tokenized FreeRTOS log records.")
+    parser.add_argument("elf", help="ELF file the target was built from")
+    parser.add_argument("log", nargs="?", help="binary log records, stdin if omitted")
+    parser.add_argument("--section", default=".log_tokens", help="section holding the format strings")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    tokens = elf.section(args.section)
+
+    if tokens is None:
+        sys.exit("%s has no %s section" % (args.elf, args.section))
+
+    stream = open(args.log, "rb") if args.log else sys.stdin.buffer
+
+    with stream:
+        while True:
+            count = stream.read(1)
+
+            if not count or count[0] == 0:
+                break
+
+            body = stream.read(4 * count[0])
+
+            if len(body) < 4 * count[0]:
+                break
+
+            words = struct.unpack("<%dI" % count[0], body)
+            sys.stdout.write(format_record(elf, tokens, words).rstrip("\r\n") + "\n")
+
+
+if __name__ == "__main__":
+    main()
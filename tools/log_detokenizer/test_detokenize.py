@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""Tests for detokenize.py.
+
+Run from this directory with:
+    python3 -m unittest test_detokenize
+"""
+
+import unittest
+
+from detokenize import format_record
+
+TOKEN = 0x20001000
+TOPIC = 0x08004000
+
+
+class FakeElf:
+    """Stands in for Elf: one format string at TOKEN and constant strings."""
+
+    def __init__(self, format_string, strings=None):
+        self.format_string = format_string
+        self.strings = strings or {}
+
+    def string_at(self, section, position):
+        assert position == 0
+        return self.format_string
+
+    def constant_string(self, address):
+        return self.strings.get(address)
+
+
+TOKENS = {"addr": TOKEN, "size": 0x100}
+
+
+def decode(format_string, *arguments, strings=None):
+    return format_record(FakeElf(format_string, strings), TOKENS, (TOKEN,) + arguments)
+
+
+class FormatRecordTest(unittest.TestCase):
+
+    def test_integers(self):
+        self.assertEqual(decode("%d %u %x %5d|", 0xFFFFFFFF, 7, 255, 42), "-1 7 ff    42|")
+
+    def test_constant_string(self):
+        self.assertEqual(decode("Topic: %s", TOPIC, strings={TOPIC: "dev/1"}), "Topic: dev/1")
+
+    def test_string_not_constant(self):
+        self.assertEqual(decode("Topic: %s", 0x20002000), "Topic: <0x20002000>")
+
+    def test_precision_from_argument(self):
+        # LogError( ( "Topic: %.*s, id=%d", len, topic, 42 ) )
+        self.assertEqual(decode("Topic: %.*s, id=%d", 3, TOPIC, 42, strings={TOPIC: "dev/1/status"}),
+                         "Topic: dev, id=42")
+
+    def test_precision_from_argument_string_not_constant(self):
+        self.assertEqual(decode("Topic: %.*s, id=%d", 3, 0x20002000, 42), "Topic: <0x20002000>, id=42")
+
+    def test_negative_precision_from_argument(self):
+        self.assertEqual(decode("%.*s|", 0xFFFFFFFF, TOPIC, strings={TOPIC: "dev/1"}), "dev/1|")
+
+    def test_width_from_argument(self):
+        self.assertEqual(decode("%*d|%*d|", 4, 7, 0xFFFFFFFC, 7), "   7|7   |")
+
+    def test_width_and_precision_from_arguments(self):
+        self.assertEqual(decode("%*.*s|", 5, 2, TOPIC, strings={TOPIC: "dev/1"}), "   de|")
+
+    def test_missing_arguments(self):
+        self.assertEqual(decode("%.*s %d", 3), "<missing> <missing>")
+
+    def test_percent(self):
+        self.assertEqual(decode("100%% %d", 1), "100% 1")
+
+    def test_unknown_token(self):
+        self.assertEqual(format_record(FakeElf(""), TOKENS, (0x1234, 5)), "[unknown token 0x00001234] 0x00000005")
+
+
+if __name__ == "__main__":
+    unittest.main()